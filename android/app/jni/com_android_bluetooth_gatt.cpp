@@ -21,8 +21,12 @@
 #include <cutils/log.h>
 #include <string.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 
 #include "com_android_bluetooth.h"
@@ -112,6 +116,7 @@ namespace android {
 static jmethodID method_onClientRegistered;
 static jmethodID method_onScannerRegistered;
 static jmethodID method_onScanResult;
+static jmethodID method_onScanResultBatch;
 static jmethodID method_onConnected;
 static jmethodID method_onDisconnected;
 static jmethodID method_onReadCharacteristic;
@@ -121,6 +126,7 @@ static jmethodID method_onSearchCompleted;
 static jmethodID method_onReadDescriptor;
 static jmethodID method_onWriteDescriptor;
 static jmethodID method_onNotify;
+static jmethodID method_onNotifyRing;
 static jmethodID method_onRegisterForNotifications;
 static jmethodID method_onReadRemoteRssi;
 static jmethodID method_onConfigureMTU;
@@ -206,6 +212,118 @@ void btgattc_register_app_cb(int status, int clientIf, const Uuid& app_uuid) {
                                clientIf, UUID_PARAMS(app_uuid));
 }
 
+/**
+ * Scan results are packed into batches and handed to ScanManager as one
+ * direct ByteBuffer, instead of one JNI call with three Java objects per
+ * advertising report. Each report is laid out, little endian:
+ *   event_type (2), addr_type (1), address (6), primary_phy (1),
+ *   secondary_phy (1), advertising_sid (1), tx_power (1), rssi (1),
+ *   periodic_adv_int (2), original_address (6), adv_data_len (2), adv_data
+ * A batch is delivered from the JNI thread when it holds max_reports reports,
+ * or when a report arrives after its oldest one is older than the interval.
+ * ScanManager pulls the remaining reports on the same interval with
+ * gattClientFlushScanResultBatchNative(). An interval of 0 turns batching off.
+ */
+class ScanResultBatch {
+ public:
+  static constexpr size_t kReportHeaderSize = 24;
+
+  void Configure(size_t max_reports, std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_reports_ = max_reports;
+    interval_ = interval;
+  }
+
+  bool IsEnabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return interval_.count() > 0 && max_reports_ > 0;
+  }
+
+  // Add a report, returns true when the batch is due for delivery
+  bool Add(uint16_t event_type, uint8_t addr_type, const RawAddress& bda,
+           uint8_t primary_phy, uint8_t secondary_phy, uint8_t advertising_sid,
+           int8_t tx_power, int8_t rssi, uint16_t periodic_adv_int,
+           const std::vector<uint8_t>& adv_data,
+           const RawAddress& original_bda) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (num_reports_ == 0) oldest_report_ = now;
+    uint16_t adv_data_len = std::min(adv_data.size(), size_t{UINT16_MAX});
+    pending_.reserve(pending_.size() + kReportHeaderSize + adv_data_len);
+    AppendUint16(event_type);
+    pending_.push_back(addr_type);
+    pending_.insert(pending_.end(), bda.address, bda.address + 6);
+    pending_.push_back(primary_phy);
+    pending_.push_back(secondary_phy);
+    pending_.push_back(advertising_sid);
+    pending_.push_back(static_cast<uint8_t>(tx_power));
+    pending_.push_back(static_cast<uint8_t>(rssi));
+    AppendUint16(periodic_adv_int);
+    pending_.insert(pending_.end(), original_bda.address,
+                    original_bda.address + 6);
+    AppendUint16(adv_data_len);
+    pending_.insert(pending_.end(), adv_data.begin(),
+                    adv_data.begin() + adv_data_len);
+    num_reports_++;
+    return num_reports_ >= max_reports_ || now - oldest_report_ >= interval_;
+  }
+
+  // Move the pending reports into |out|, which keeps its capacity across
+  // batches. Returns false if there were none.
+  bool Take(std::vector<uint8_t>* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out->clear();
+    if (num_reports_ == 0) return false;
+    std::swap(*out, pending_);
+    num_reports_ = 0;
+    return true;
+  }
+
+ private:
+  void AppendUint16(uint16_t value) {
+    pending_.push_back(value & 0xff);
+    pending_.push_back(value >> 8);
+  }
+
+  std::mutex mutex_;
+  size_t max_reports_ = 0;
+  std::chrono::milliseconds interval_{0};
+  std::vector<uint8_t> pending_;
+  size_t num_reports_ = 0;
+  std::chrono::steady_clock::time_point oldest_report_;
+};
+
+static ScanResultBatch scan_result_batch;
+// Buffer behind the batch delivered by the JNI thread
+static std::vector<uint8_t> scan_result_batch_delivered;
+// Buffer behind the batch pulled by ScanManager, valid until its next pull
+static std::vector<uint8_t> scan_result_batch_pulled;
+
+// Called on the JNI thread, with callbacks_mutex held
+static void deliver_scan_result_batch(CallbackEnv& sCallbackEnv) {
+  if (!scan_result_batch.Take(&scan_result_batch_delivered)) return;
+  ScopedLocalRef<jobject> batch(
+      sCallbackEnv.get(),
+      sCallbackEnv->NewDirectByteBuffer(scan_result_batch_delivered.data(),
+                                        scan_result_batch_delivered.size()));
+  // The reports are decoded before the call returns, the buffer can be reused
+  sCallbackEnv->CallVoidMethod(mCallbacksObj, method_onScanResultBatch,
+                               batch.get());
+}
+
+static void scan_result_batch_add(
+    CallbackEnv& sCallbackEnv, uint16_t event_type, uint8_t addr_type,
+    const RawAddress& bda, uint8_t primary_phy, uint8_t secondary_phy,
+    uint8_t advertising_sid, int8_t tx_power, int8_t rssi,
+    uint16_t periodic_adv_int, const std::vector<uint8_t>& adv_data,
+    const RawAddress& original_bda) {
+  if (scan_result_batch.Add(event_type, addr_type, bda, primary_phy,
+                            secondary_phy, advertising_sid, tx_power, rssi,
+                            periodic_adv_int, adv_data, original_bda)) {
+    deliver_scan_result_batch(sCallbackEnv);
+  }
+}
+
 void btgattc_scan_result_cb(uint16_t event_type, uint8_t addr_type,
                             RawAddress* bda, uint8_t primary_phy,
                             uint8_t secondary_phy, uint8_t advertising_sid,
@@ -217,6 +335,14 @@ void btgattc_scan_result_cb(uint16_t event_type, uint8_t addr_type,
   CallbackEnv sCallbackEnv(__func__);
   if (!sCallbackEnv.valid() || !mCallbacksObj) return;
 
+  if (scan_result_batch.IsEnabled()) {
+    scan_result_batch_add(sCallbackEnv, event_type, addr_type, *bda,
+                          primary_phy, secondary_phy, advertising_sid,
+                          tx_power, rssi, periodic_adv_int, adv_data,
+                          original_bda ? *original_bda : RawAddress::kEmpty);
+    return;
+  }
+
   ScopedLocalRef<jstring> address(sCallbackEnv.get(),
                                   bdaddr2newjstr(sCallbackEnv.get(), bda));
   ScopedLocalRef<jbyteArray> jb(sCallbackEnv.get(),
@@ -276,11 +402,92 @@ void btgattc_register_for_notification_cb(int conn_id, int registered,
                                conn_id, status, registered, handle);
 }
 
+/**
+ * Opt-in delivery of the notifications of a connection through a ring in a
+ * direct ByteBuffer allocated by GattService. The address jstring is cached
+ * per connection, and the value is copied into the ring instead of a new
+ * jbyteArray. GattService still copies the value into a byte[] per
+ * notification, as the app callback takes one over binder, so this saves the
+ * JNI allocations and local refs only. Each record is laid out, little endian:
+ *   handle (2), is_notify (1), reserved (1), value_len (2), value
+ * A record which does not fit before the end of the ring is written at its
+ * start. The doorbell passes the ring and the offset of the record, which
+ * GattService consumes before the call returns.
+ */
+struct NotificationRing {
+  static constexpr size_t kRecordHeaderSize = 6;
+
+  jobject buffer;  // Global ref
+  uint8_t* data;
+  size_t capacity;
+  size_t write_offset;
+  RawAddress bda;
+  jstring address;  // Global ref, cached on the first notification
+};
+
+static std::mutex notification_rings_mutex;
+static std::map<int, NotificationRing> notification_rings;
+
+static void release_notification_ring(JNIEnv* env, NotificationRing& ring) {
+  env->DeleteGlobalRef(ring.buffer);
+  if (ring.address != nullptr) env->DeleteGlobalRef(ring.address);
+}
+
+// Returns false if the notification has to take the regular path
+static bool notify_through_ring(CallbackEnv& sCallbackEnv, int conn_id,
+                                const btgatt_notify_params_t& p_data) {
+  JNIEnv* env = sCallbackEnv.get();
+  size_t offset;
+  // Local refs, so that the ring can be disabled during the upcall
+  ScopedLocalRef<jobject> buffer(env, nullptr);
+  ScopedLocalRef<jstring> address(env, nullptr);
+  {
+    std::lock_guard<std::mutex> lock(notification_rings_mutex);
+    auto it = notification_rings.find(conn_id);
+    if (it == notification_rings.end()) return false;
+    NotificationRing& ring = it->second;
+    size_t record_size = NotificationRing::kRecordHeaderSize + p_data.len;
+    if (record_size > ring.capacity) return false;
+
+    if (ring.address == nullptr || ring.bda != p_data.bda) {
+      if (ring.address != nullptr) env->DeleteGlobalRef(ring.address);
+      ScopedLocalRef<jstring> bda_address(env,
+                                          bdaddr2newjstr(env, &p_data.bda));
+      ring.address = (jstring)env->NewGlobalRef(bda_address.get());
+      ring.bda = p_data.bda;
+    }
+
+    // The records are written on the callback thread only, so the ring is not
+    // written again before GattService consumed this record
+    if (ring.write_offset + record_size > ring.capacity) ring.write_offset = 0;
+    offset = ring.write_offset;
+    uint8_t* record = ring.data + offset;
+    record[0] = p_data.handle & 0xff;
+    record[1] = p_data.handle >> 8;
+    record[2] = p_data.is_notify;
+    record[3] = 0;
+    record[4] = p_data.len & 0xff;
+    record[5] = p_data.len >> 8;
+    memcpy(record + NotificationRing::kRecordHeaderSize, p_data.value,
+           p_data.len);
+    ring.write_offset += record_size;
+
+    buffer.reset(env->NewLocalRef(ring.buffer));
+    address.reset((jstring)env->NewLocalRef(ring.address));
+  }
+
+  sCallbackEnv->CallVoidMethod(mCallbacksObj, method_onNotifyRing, conn_id,
+                               address.get(), buffer.get(), (jint)offset);
+  return true;
+}
+
 void btgattc_notify_cb(int conn_id, const btgatt_notify_params_t& p_data) {
   std::shared_lock<std::shared_mutex> lock(callbacks_mutex);
   CallbackEnv sCallbackEnv(__func__);
   if (!sCallbackEnv.valid() || !mCallbacksObj) return;
 
+  if (notify_through_ring(sCallbackEnv, conn_id, p_data)) return;
+
   ScopedLocalRef<jstring> address(
       sCallbackEnv.get(), bdaddr2newjstr(sCallbackEnv.get(), &p_data.bda));
   ScopedLocalRef<jbyteArray> jb(sCallbackEnv.get(),
@@ -951,6 +1158,16 @@ class JniScanningCallbacks : ScanningCallbacks {
     CallbackEnv sCallbackEnv(__func__);
     if (!sCallbackEnv.valid() || !mCallbacksObj) return;
 
+    if (scan_result_batch.IsEnabled()) {
+      // TODO(optedoblivion): Figure out original address for here, use empty
+      // for now
+      scan_result_batch_add(sCallbackEnv, event_type, addr_type, bda,
+                            primary_phy, secondary_phy, advertising_sid,
+                            tx_power, rssi, periodic_adv_int, adv_data,
+                            RawAddress::kEmpty);
+      return;
+    }
+
     ScopedLocalRef<jstring> address(sCallbackEnv.get(),
                                     bdaddr2newjstr(sCallbackEnv.get(), &bda));
     ScopedLocalRef<jbyteArray> jb(sCallbackEnv.get(),
@@ -1112,6 +1329,8 @@ static void classInitNative(JNIEnv* env, jclass clazz) {
   method_onScanResult =
       env->GetMethodID(clazz, "onScanResult",
                        "(IILjava/lang/String;IIIIII[BLjava/lang/String;)V");
+  method_onScanResultBatch =
+      env->GetMethodID(clazz, "onScanResultBatch", "(Ljava/nio/ByteBuffer;)V");
   method_onConnected =
       env->GetMethodID(clazz, "onConnected", "(IIILjava/lang/String;)V");
   method_onDisconnected =
@@ -1130,6 +1349,9 @@ static void classInitNative(JNIEnv* env, jclass clazz) {
       env->GetMethodID(clazz, "onWriteDescriptor", "(III[B)V");
   method_onNotify =
       env->GetMethodID(clazz, "onNotify", "(ILjava/lang/String;IZ[B)V");
+  method_onNotifyRing =
+      env->GetMethodID(clazz, "onNotifyRing",
+                       "(ILjava/lang/String;Ljava/nio/ByteBuffer;I)V");
   method_onRegisterForNotifications =
       env->GetMethodID(clazz, "onRegisterForNotifications", "(IIII)V");
   method_onReadRemoteRssi =
@@ -1272,6 +1494,14 @@ static void cleanupNative(JNIEnv* env, jobject object) {
     env->DeleteGlobalRef(mCallbacksObj);
     mCallbacksObj = NULL;
   }
+
+  {
+    std::lock_guard<std::mutex> rings_lock(notification_rings_mutex);
+    for (auto& [conn_id, ring] : notification_rings) {
+      release_notification_ring(env, ring);
+    }
+    notification_rings.clear();
+  }
   btIf = NULL;
 }
 
@@ -1329,6 +1559,20 @@ static void gattClientScanNative(JNIEnv* env, jobject object, jboolean start) {
   sGattIf->scanner->Scan(start);
 }
 
+static void gattClientConfigScanResultBatchNative(JNIEnv* env, jobject object,
+                                                  jint max_reports,
+                                                  jint interval_ms) {
+  scan_result_batch.Configure(std::max(max_reports, 0),
+                              std::chrono::milliseconds(interval_ms));
+}
+
+static jobject gattClientFlushScanResultBatchNative(JNIEnv* env,
+                                                    jobject object) {
+  if (!scan_result_batch.Take(&scan_result_batch_pulled)) return nullptr;
+  return env->NewDirectByteBuffer(scan_result_batch_pulled.data(),
+                                  scan_result_batch_pulled.size());
+}
+
 static void gattClientConnectNative(JNIEnv* env, jobject object, jint clientif,
                                     jstring address, jboolean isDirect,
                                     jint transport, jboolean opportunistic,
@@ -1403,6 +1647,42 @@ static void gattClientDiscoverServiceByUuidNative(JNIEnv* env, jobject object,
   sGattIf->client->btif_gattc_discover_service_by_uuid(conn_id, uuid);
 }
 
+static void gattClientEnableNotificationRingNative(JNIEnv* env,
+                                                  jobject object, jint conn_id,
+                                                  jobject buffer) {
+  uint8_t* data = (uint8_t*)env->GetDirectBufferAddress(buffer);
+  jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (data == nullptr || capacity <= 0) {
+    ALOGE("%s: not a direct buffer", __func__);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(notification_rings_mutex);
+  auto it = notification_rings.find(conn_id);
+  if (it != notification_rings.end()) {
+    release_notification_ring(env, it->second);
+    notification_rings.erase(it);
+  }
+  notification_rings.emplace(
+      conn_id,
+      NotificationRing{.buffer = env->NewGlobalRef(buffer),
+                       .data = data,
+                       .capacity = static_cast<size_t>(capacity),
+                       .write_offset = 0,
+                       .bda = RawAddress::kEmpty,
+                       .address = nullptr});
+}
+
+static void gattClientDisableNotificationRingNative(JNIEnv* env,
+                                                   jobject object,
+                                                   jint conn_id) {
+  std::lock_guard<std::mutex> lock(notification_rings_mutex);
+  auto it = notification_rings.find(conn_id);
+  if (it == notification_rings.end()) return;
+  release_notification_ring(env, it->second);
+  notification_rings.erase(it);
+}
+
 static void gattClientGetGattDbNative(JNIEnv* env, jobject object,
                                       jint conn_id) {
   if (!sGattIf) return;
@@ -2484,6 +2764,10 @@ static JNINativeMethod sScanMethods[] = {
     {"registerScannerNative", "(JJ)V", (void*)registerScannerNative},
     {"unregisterScannerNative", "(I)V", (void*)unregisterScannerNative},
     {"gattClientScanNative", "(Z)V", (void*)gattClientScanNative},
+    {"gattClientConfigScanResultBatchNative", "(II)V",
+     (void*)gattClientConfigScanResultBatchNative},
+    {"gattClientFlushScanResultBatchNative", "()Ljava/nio/ByteBuffer;",
+     (void*)gattClientFlushScanResultBatchNative},
     // Batch scan JNI functions.
     {"gattClientConfigBatchScanStorageNative", "(IIII)V",
      (void*)gattClientConfigBatchScanStorageNative},
@@ -2527,6 +2811,10 @@ static JNINativeMethod sMethods[] = {
      (void*)gattClientConnectNative},
     {"gattClientDisconnectNative", "(ILjava/lang/String;I)V",
      (void*)gattClientDisconnectNative},
+    {"gattClientEnableNotificationRingNative", "(ILjava/nio/ByteBuffer;)V",
+     (void*)gattClientEnableNotificationRingNative},
+    {"gattClientDisableNotificationRingNative", "(I)V",
+     (void*)gattClientDisableNotificationRingNative},
     {"gattClientSetPreferredPhyNative", "(ILjava/lang/String;III)V",
      (void*)gattClientSetPreferredPhyNative},
     {"gattClientReadPhyNative", "(ILjava/lang/String;)V",
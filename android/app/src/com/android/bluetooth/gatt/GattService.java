@@ -87,6 +87,8 @@ import com.android.modules.utils.SynchronousResultReceiver;
 
 import libcore.util.HexEncoding;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.ArrayDeque;
 import java.util.ArrayList;
 import java.util.Arrays;
@@ -97,6 +99,7 @@ import java.util.List;
 import java.util.Map;
 import java.util.Set;
 import java.util.UUID;
+import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicBoolean;
 import java.util.function.Predicate;
@@ -274,6 +277,16 @@ public class GattService extends ProfileService {
      */
     private final HashMap<String, Integer> mPermits = new HashMap<>();
 
+    /**
+     * Rings through which the native stack delivers the notifications of a connection, when
+     * enabled with the gatt_notification_ring device config. The record layout is described in
+     * com_android_bluetooth_gatt.cpp.
+     */
+    private static final int NOTIFICATION_RING_SIZE = 8192;
+    private static final int NOTIFICATION_RECORD_HEADER_LENGTH = 6;
+    private boolean mNotificationRingEnabled;
+    private final Map<Integer, ByteBuffer> mNotificationRings = new ConcurrentHashMap<>();
+
     private AdapterService mAdapterService;
     private BluetoothAdapterProxy mBluetoothAdapterProxy;
     @VisibleForTesting
@@ -336,6 +349,8 @@ public class GattService extends ProfileService {
                 getContentResolver(), "bluetooth_sanitized_exposure_notification_supported", 1);
 
         initializeNative();
+        mNotificationRingEnabled = DeviceConfig.getBoolean(DeviceConfig.NAMESPACE_BLUETOOTH,
+                "gatt_notification_ring", false);
         mAdapterService = AdapterService.getAdapterService();
         mBluetoothAdapterProxy = BluetoothAdapterProxy.getInstance();
         mCompanionManager = getSystemService(CompanionDeviceManager.class);
@@ -1795,6 +1810,10 @@ public class GattService extends ProfileService {
                 advertisingSid, txPower, rssi, periodicAdvInt, advData, originalAddress);
     }
 
+    void onScanResultBatch(ByteBuffer batch) {
+        mScanManager.deliverScanResultBatch(batch);
+    }
+
     void onScanResultInternal(int eventType, int addressType, String address, int primaryPhy,
             int secondaryPhy, int advertisingSid, int txPower, int rssi, int periodicAdvInt,
             byte[] advData, String originalAddress) {
@@ -2039,6 +2058,13 @@ public class GattService extends ProfileService {
         if (status == 0) {
             mClientMap.addConnection(clientIf, connId, address);
 
+            if (mNotificationRingEnabled) {
+                ByteBuffer ring = ByteBuffer.allocateDirect(NOTIFICATION_RING_SIZE)
+                        .order(ByteOrder.LITTLE_ENDIAN);
+                mNotificationRings.put(connId, ring);
+                gattClientEnableNotificationRingNative(connId, ring);
+            }
+
             // Allow one writeCharacteristic operation at a time for each connected remote device.
             synchronized (mPermits) {
                 Log.d(TAG, "onConnected() - adding permit for address="
@@ -2066,6 +2092,9 @@ public class GattService extends ProfileService {
         }
 
         mClientMap.removeConnection(clientIf, connId);
+        if (mNotificationRings.remove(connId) != null) {
+            gattClientDisableNotificationRingNative(connId);
+        }
         ClientMap.App app = mClientMap.getById(clientIf);
 
         // Remove AtomicBoolean representing permit if no other connections rely on this remote device.
@@ -2366,6 +2395,24 @@ public class GattService extends ProfileService {
         }
     }
 
+    /**
+     * Doorbell of the notification ring of a connection, the record at offset is consumed before
+     * returning. The ring is passed along, as the connection may have been given another one
+     * since the record was written.
+     */
+    void onNotifyRing(int connId, String address, ByteBuffer ring, int offset)
+            throws RemoteException {
+        int handle = ring.getShort(offset) & 0xFFFF;
+        boolean isNotify = ring.get(offset + 2) != 0;
+        int length = ring.getShort(offset + 4) & 0xFFFF;
+        // The app callback takes the value as a byte array over binder, so one is still
+        // allocated per notification
+        byte[] data = new byte[length];
+        ring.position(offset + NOTIFICATION_RECORD_HEADER_LENGTH);
+        ring.get(data);
+        onNotify(connId, address, handle, isNotify, data);
+    }
+
     void onReadCharacteristic(int connId, int status, int handle, byte[] data)
             throws RemoteException {
         String address = mClientMap.addressByConnId(connId);
@@ -4775,6 +4822,10 @@ public class GattService extends ProfileService {
 
     private native void gattClientDisconnectNative(int clientIf, String address, int connId);
 
+    private native void gattClientEnableNotificationRingNative(int connId, ByteBuffer ring);
+
+    private native void gattClientDisableNotificationRingNative(int connId);
+
     private native void gattClientSetPreferredPhyNative(int clientIf, String address, int txPhy,
             int rxPhy, int phyOptions);
 
@@ -36,6 +36,7 @@ import android.os.Looper;
 import android.os.Message;
 import android.os.RemoteException;
 import android.os.SystemClock;
+import android.provider.DeviceConfig;
 import android.provider.Settings;
 import android.util.Log;
 import android.util.SparseBooleanArray;
@@ -47,6 +48,8 @@ import com.android.bluetooth.btservice.AdapterService;
 import com.android.bluetooth.btservice.BluetoothAdapterProxy;
 import com.android.internal.annotations.VisibleForTesting;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.ArrayDeque;
 import java.util.Collections;
 import java.util.Deque;
@@ -99,6 +102,7 @@ public class ScanManager {
     static final int MSG_SCREEN_ON = 7;
     static final int MSG_SCREEN_OFF = 8;
     static final int MSG_REVERT_SCAN_MODE_UPGRADE = 9;
+    static final int MSG_FLUSH_SCAN_RESULT_BATCH = 10;
     private static final String ACTION_REFRESH_BATCHED_SCAN =
             "com.android.bluetooth.gatt.REFRESH_BATCHED_SCAN";
 
@@ -106,6 +110,16 @@ public class ScanManager {
     private static final int OPERATION_TIME_OUT_MILLIS = 500;
     private static final int MAX_IS_UID_FOREGROUND_MAP_SIZE = 500;
 
+    // Regular scan results are delivered by the native stack in batches of at most this many
+    // reports, at least every scan_result_batch_interval_ms. An interval of 0 delivers each report
+    // on its own.
+    private static final int SCAN_RESULT_BATCH_MAX_REPORTS = 64;
+    private static final int DEFAULT_SCAN_RESULT_BATCH_INTERVAL_MS = 20;
+    // Fixed part of a report in a batch, the layout is described in com_android_bluetooth_gatt.cpp
+    @VisibleForTesting
+    static final int SCAN_RESULT_BATCH_REPORT_HEADER_LENGTH = 24;
+    private int mScanResultBatchIntervalMillis;
+
     private int mLastConfiguredScanSetting = Integer.MIN_VALUE;
     // Scan parameters for batch scan.
     private BatchScanParams mBatchScanParms;
@@ -178,6 +192,11 @@ public class ScanManager {
         HandlerThread thread = new HandlerThread("BluetoothScanManager");
         thread.start();
         mHandler = new ClientHandler(thread.getLooper());
+        mScanResultBatchIntervalMillis = Math.max(0, DeviceConfig.getInt(
+                DeviceConfig.NAMESPACE_BLUETOOTH, "scan_result_batch_interval_ms",
+                DEFAULT_SCAN_RESULT_BATCH_INTERVAL_MS));
+        mScanNative.gattClientConfigScanResultBatchNative(SCAN_RESULT_BATCH_MAX_REPORTS,
+                mScanResultBatchIntervalMillis);
         if (mDm != null) {
             mDm.registerDisplayListener(mDisplayListener, null);
         }
@@ -302,6 +321,41 @@ public class ScanManager {
         // TODO: add a callback for scan failure.
     }
 
+    /**
+     * Decodes a batch of scan results packed by the native stack, and delivers each of them to
+     * {@link GattService#onScanResult}. The buffer is only valid during this call.
+     */
+    void deliverScanResultBatch(ByteBuffer batch) {
+        batch.order(ByteOrder.LITTLE_ENDIAN);
+        byte[] address = new byte[6];
+        byte[] originalAddress = new byte[6];
+        while (batch.remaining() >= SCAN_RESULT_BATCH_REPORT_HEADER_LENGTH) {
+            int eventType = batch.getShort() & 0xFFFF;
+            int addressType = batch.get() & 0xFF;
+            batch.get(address);
+            int primaryPhy = batch.get() & 0xFF;
+            int secondaryPhy = batch.get() & 0xFF;
+            int advertisingSid = batch.get() & 0xFF;
+            int txPower = batch.get();
+            int rssi = batch.get();
+            int periodicAdvInt = batch.getShort() & 0xFFFF;
+            batch.get(originalAddress);
+            int advDataLength = batch.getShort() & 0xFFFF;
+            if (batch.remaining() < advDataLength) {
+                Log.e(TAG, "deliverScanResultBatch: truncated report, dropping the rest");
+                return;
+            }
+            byte[] advData = new byte[advDataLength];
+            batch.get(advData);
+            mService.onScanResult(eventType, addressType, Utils.getAddressStringFromByte(address),
+                    primaryPhy, secondaryPhy, advertisingSid, txPower, rssi, periodicAdvInt,
+                    advData, Utils.getAddressStringFromByte(originalAddress));
+        }
+        if (batch.hasRemaining()) {
+            Log.e(TAG, "deliverScanResultBatch: " + batch.remaining() + " trailing bytes");
+        }
+    }
+
     private void sendMessage(int what, ScanClient client) {
         final ClientHandler handler = mHandler;
         if (handler == null) {
@@ -362,6 +416,9 @@ public class ScanManager {
                 case MSG_IMPORTANCE_CHANGE:
                     handleImportanceChange((UidImportance) msg.obj);
                     break;
+                case MSG_FLUSH_SCAN_RESULT_BATCH:
+                    handleFlushScanResultBatch();
+                    break;
                 default:
                     // Shouldn't happen.
                     Log.e(TAG, "received an unkown message : " + msg.what);
@@ -411,6 +468,7 @@ public class ScanManager {
             } else {
                 updateScanModeBeforeStart(client);
                 mRegularScanClients.add(client);
+                scheduleScanResultBatchFlush();
                 mScanNative.startRegularScan(client);
                 if (!mScanNative.isOpportunisticScanClient(client)) {
                     mScanNative.configureRegularScanParams();
@@ -472,6 +530,24 @@ public class ScanManager {
             }
         }
 
+        // Deliver the scan results which did not fill a batch, until the regular scans stop
+        void handleFlushScanResultBatch() {
+            ByteBuffer batch = mScanNative.gattClientFlushScanResultBatchNative();
+            if (batch != null) {
+                deliverScanResultBatch(batch);
+            }
+            if (!mRegularScanClients.isEmpty()) {
+                scheduleScanResultBatchFlush();
+            }
+        }
+
+        private void scheduleScanResultBatchFlush() {
+            if (mScanResultBatchIntervalMillis > 0 && !hasMessages(MSG_FLUSH_SCAN_RESULT_BATCH)) {
+                sendEmptyMessageDelayed(MSG_FLUSH_SCAN_RESULT_BATCH,
+                        mScanResultBatchIntervalMillis);
+            }
+        }
+
         void handleFlushBatchResults(ScanClient client) {
             if (!mBatchClients.contains(client)) {
                 return;
@@ -1550,6 +1626,11 @@ public class ScanManager {
 
         private native void gattClientScanNative(boolean start);
 
+        private native void gattClientConfigScanResultBatchNative(int maxReports, int intervalMs);
+
+        // The returned buffer is only valid until the next call
+        private native ByteBuffer gattClientFlushScanResultBatchNative();
+
         private native void gattSetScanParametersNative(int clientIf, int scanInterval,
                 int scanWindow);
 
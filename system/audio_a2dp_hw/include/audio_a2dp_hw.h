@@ -85,6 +85,8 @@ typedef enum {
   A2DP_CTRL_GET_OUTPUT_AUDIO_CONFIG,
   A2DP_CTRL_SET_OUTPUT_AUDIO_CONFIG,
   A2DP_CTRL_GET_PRESENTATION_POSITION,
+  // Moves the audio data to a shared memory ring, see audio_a2dp_hw_ring.h
+  A2DP_CTRL_CMD_OPEN_AUDIO_RING,
 } tA2DP_CTRL_CMD;
 
 typedef enum {
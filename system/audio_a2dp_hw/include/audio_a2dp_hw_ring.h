@@ -0,0 +1,127 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/*****************************************************************************
+ *
+ *  Filename:      audio_a2dp_hw_ring.h
+ *
+ *  Description:   Shared memory ring carrying the PCM data from the legacy
+ *                 A2DP audio HAL to the stack, in place of the audio socket.
+ *
+ *                 The stack creates the ring when the audio HAL sends
+ *                 A2DP_CTRL_CMD_OPEN_AUDIO_RING, and passes the file
+ *                 descriptor back over the control socket. The audio HAL is
+ *                 the only producer and the stack the only consumer: the
+ *                 audio HAL waits on a futex when the ring is full, and the
+ *                 stack wakes it up after each read. The stack also publishes
+ *                 the presentation position in the ring, so that the audio
+ *                 HAL reads it without a round trip on the control socket.
+ *
+ *****************************************************************************/
+
+#ifndef AUDIO_A2DP_HW_RING_H
+#define AUDIO_A2DP_HW_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <atomic>
+
+/*****************************************************************************
+ *  Constants & Macros
+ *****************************************************************************/
+
+// Size of the PCM data in the ring, a power of two larger than twice
+// AUDIO_STREAM_OUTPUT_BUFFER_SZ so that the ring holds as much data as the
+// socket buffers did.
+#define A2DP_AUDIO_RING_DATA_SZ (32 * 1024)
+
+/*****************************************************************************
+ *  Type definitions and return values
+ *****************************************************************************/
+
+// Layout of the shared memory. The positions count the bytes written and
+// read since the ring was created, modulo 2^32.
+struct a2dp_audio_ring {
+  std::atomic<uint32_t> write_pos;
+  std::atomic<uint32_t> read_pos;
+  // Set once either side stops using the ring
+  std::atomic<uint32_t> closed;
+
+  // Presentation position, guarded by the sequence count: it is odd while the
+  // stack updates the position.
+  std::atomic<uint32_t> position_seq;
+  std::atomic<uint64_t> total_bytes_read;
+  std::atomic<uint32_t> timestamp_sec;
+  std::atomic<uint32_t> timestamp_nsec;
+  std::atomic<uint16_t> audio_delay;
+
+  uint8_t data[A2DP_AUDIO_RING_DATA_SZ];
+};
+
+/*****************************************************************************
+ *  Functions
+ *****************************************************************************/
+
+// Creates the shared memory of an empty ring.
+// Returns the file descriptor of the shared memory, or -1 on failure.
+int a2dp_audio_ring_create(void);
+
+// Maps the ring shared through the file descriptor |fd|. The descriptor can
+// be closed once mapped.
+// Returns the ring, or NULL if |fd| is not a valid ring.
+struct a2dp_audio_ring* a2dp_audio_ring_map(int fd);
+
+// Unmaps |ring|.
+void a2dp_audio_ring_unmap(struct a2dp_audio_ring* ring);
+
+// Marks |ring| as closed, and wakes up the audio HAL if it is waiting for
+// room in the ring.
+void a2dp_audio_ring_close(struct a2dp_audio_ring* ring);
+
+// Copies the |len| bytes of |buffer| to |ring|, waiting at most |timeout_ms|
+// for the stack to make room when the ring is full. Called by the audio HAL.
+// Returns the number of bytes written, less than |len| on timeout or if the
+// ring is closed.
+size_t a2dp_audio_ring_write(struct a2dp_audio_ring* ring, const void* buffer,
+                             size_t len, int timeout_ms);
+
+// Copies at most |len| bytes from |ring| to |buffer|, without waiting.
+// Called by the stack.
+// Returns the number of bytes read.
+size_t a2dp_audio_ring_read(struct a2dp_audio_ring* ring, void* buffer,
+                            size_t len);
+
+// Drops the data pending in |ring|. Called by the stack.
+void a2dp_audio_ring_flush(struct a2dp_audio_ring* ring);
+
+// Publishes the presentation position in |ring|: |bytes| is the number of
+// bytes consumed by the stack at time |timestamp|, and |delay| the audio
+// delay reported by the remote device in units of 1/10ms. Called by the stack.
+void a2dp_audio_ring_set_position(struct a2dp_audio_ring* ring, uint64_t bytes,
+                                  uint16_t delay,
+                                  const struct timespec* timestamp);
+
+// Reads the presentation position last published in |ring|. Called by the
+// audio HAL.
+void a2dp_audio_ring_get_position(struct a2dp_audio_ring* ring,
+                                  uint64_t* bytes, uint16_t* delay,
+                                  struct timespec* timestamp);
+
+#endif /* AUDIO_A2DP_HW_RING_H */
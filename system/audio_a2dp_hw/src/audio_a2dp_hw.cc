@@ -49,6 +49,7 @@
 #include "osi/include/socket_utils/sockets.h"
 
 #include "audio_a2dp_hw.h"
+#include "audio_a2dp_hw_ring.h"
 
 /*****************************************************************************
  *  Constants & Macros
@@ -125,6 +126,10 @@ struct a2dp_stream_common {
   std::recursive_mutex* mutex;  // See note below on mutex acquisition order.
   int ctrl_fd;
   int audio_fd;
+  // The shared memory ring carrying the output audio data if the stack
+  // supports it, otherwise the data is sent over |audio_fd|. Only mapped and
+  // unmapped by the thread writing the audio data.
+  struct a2dp_audio_ring* audio_ring;
   size_t buffer_sz;
   struct a2dp_config cfg;
   a2dp_state_t state;
@@ -762,6 +767,12 @@ static int a2dp_get_presentation_position_cmd(struct a2dp_stream_common* common,
     return -1;
   }
 
+  // The stack publishes the position in the audio ring when there is one
+  if (common->audio_ring != NULL) {
+    a2dp_audio_ring_get_position(common->audio_ring, bytes, delay, timestamp);
+    return 0;
+  }
+
   if (a2dp_command(common, A2DP_CTRL_GET_PRESENTATION_POSITION) < 0) {
     return -1;
   }
@@ -789,6 +800,80 @@ static int a2dp_get_presentation_position_cmd(struct a2dp_stream_common* common,
   return 0;
 }
 
+// Receives the file descriptor passed by the stack on the control channel of
+// stream |common|.
+// Returns the file descriptor, or -1 on failure.
+static int a2dp_ctrl_receive_fd(struct a2dp_stream_common* common) {
+  uint8_t data;
+  struct iovec iov;
+  iov.iov_base = &data;
+  iov.iov_len = sizeof(data);
+  union {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof(int))];
+  } control = {};
+  struct msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+
+  ssize_t ret;
+  OSI_NO_INTR(ret = recvmsg(common->ctrl_fd, &msg, MSG_CMSG_CLOEXEC));
+  if (ret <= 0) {
+    ERROR("receive fd failed: error(%s)", strerror(errno));
+    skt_disconnect(common->ctrl_fd);
+    common->ctrl_fd = AUDIO_SKT_DISCONNECTED;
+    return -1;
+  }
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(int))) {
+    ERROR("receive fd failed: no file descriptor");
+    return -1;
+  }
+
+  int fd;
+  memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
+  return fd;
+}
+
+static void a2dp_unmap_audio_ring(struct a2dp_stream_common* common) {
+  a2dp_audio_ring_unmap(common->audio_ring);
+  common->audio_ring = NULL;
+}
+
+// Asks the stack to carry the audio data of the started stream |common| over
+// a new shared memory ring. The audio socket is used when the stack doesn't
+// support it.
+static void a2dp_open_audio_ring(struct a2dp_stream_common* common) {
+  a2dp_unmap_audio_ring(common);
+
+  if (a2dp_command(common, A2DP_CTRL_CMD_OPEN_AUDIO_RING) < 0) {
+    INFO("audio ring not supported, using the audio socket");
+    return;
+  }
+
+  int fd = a2dp_ctrl_receive_fd(common);
+  if (fd < 0) return;
+
+  common->audio_ring = a2dp_audio_ring_map(fd);
+  close(fd);
+  if (common->audio_ring == NULL) {
+    ERROR("failed to map the audio ring, using the audio socket");
+    return;
+  }
+  INFO("audio data carried over the audio ring");
+}
+
+// Stops the audio data on the ring of stream |common|: a write in progress
+// returns early, and the ring is unmapped on the next write.
+static void a2dp_close_audio_ring(struct a2dp_stream_common* common) {
+  if (common->audio_ring != NULL) a2dp_audio_ring_close(common->audio_ring);
+}
+
 static void a2dp_open_ctrl_path(struct a2dp_stream_common* common) {
   int i;
 
@@ -826,6 +911,7 @@ static void a2dp_stream_common_init(struct a2dp_stream_common* common) {
 
   common->ctrl_fd = AUDIO_SKT_DISCONNECTED;
   common->audio_fd = AUDIO_SKT_DISCONNECTED;
+  common->audio_ring = NULL;
   common->state = AUDIO_A2DP_STATE_STOPPED;
 
   /* manages max capacity of socket pipe */
@@ -835,6 +921,7 @@ static void a2dp_stream_common_init(struct a2dp_stream_common* common) {
 static void a2dp_stream_common_destroy(struct a2dp_stream_common* common) {
   FNLOG();
 
+  a2dp_unmap_audio_ring(common);
   delete common->mutex;
   common->mutex = NULL;
 }
@@ -894,6 +981,7 @@ static int stop_audio_datapath(struct a2dp_stream_common* common) {
   /* disconnect audio path */
   skt_disconnect(common->audio_fd);
   common->audio_fd = AUDIO_SKT_DISCONNECTED;
+  a2dp_close_audio_ring(common);
 
   return 0;
 }
@@ -915,6 +1003,7 @@ static int suspend_audio_datapath(struct a2dp_stream_common* common,
   skt_disconnect(common->audio_fd);
 
   common->audio_fd = AUDIO_SKT_DISCONNECTED;
+  a2dp_close_audio_ring(common);
 
   return 0;
 }
@@ -946,6 +1035,8 @@ static ssize_t out_write(struct audio_stream_out* stream, const void* buffer,
     if (start_audio_datapath(&out->common) < 0) {
       goto finish;
     }
+    /* the data socket is kept open to signal the stream state to the stack */
+    a2dp_open_audio_ring(&out->common);
   } else if (out->common.state != AUDIO_A2DP_STATE_STARTED) {
     ERROR("stream not in stopped or standby");
     goto finish;
@@ -965,12 +1056,20 @@ static ssize_t out_write(struct audio_stream_out* stream, const void* buffer,
   }
 
   lock.unlock();
-  sent = skt_write(out->common.audio_fd, buffer, write_bytes);
+  if (out->common.audio_ring != NULL) {
+    size_t written = a2dp_audio_ring_write(out->common.audio_ring, buffer,
+                                           write_bytes, SOCK_SEND_TIMEOUT_MS);
+    if (written < write_bytes) WARN("write stopped, sent %zu bytes", written);
+    sent = (written == write_bytes) ? (int)written : -1;
+  } else {
+    sent = skt_write(out->common.audio_fd, buffer, write_bytes);
+  }
   lock.lock();
 
   if (sent == -1) {
     skt_disconnect(out->common.audio_fd);
     out->common.audio_fd = AUDIO_SKT_DISCONNECTED;
+    a2dp_unmap_audio_ring(&out->common);
     if ((out->common.state != AUDIO_A2DP_STATE_SUSPENDED) &&
         (out->common.state != AUDIO_A2DP_STATE_STOPPING)) {
       out->common.state = AUDIO_A2DP_STATE_STOPPED;
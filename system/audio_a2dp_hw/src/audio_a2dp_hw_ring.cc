@@ -0,0 +1,182 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "audio_a2dp_hw_ring.h"
+
+#include <linux/futex.h>
+#include <linux/memfd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#define NSEC_PER_MSEC 1000000L
+#define NSEC_PER_SEC 1000000000L
+
+static_assert((A2DP_AUDIO_RING_DATA_SZ & (A2DP_AUDIO_RING_DATA_SZ - 1)) == 0,
+              "The ring size must be a power of two");
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "The ring is shared between processes");
+
+// The futex is shared between the audio HAL and the stack processes, so it
+// can't use the FUTEX_PRIVATE_FLAG variants.
+static void futex_wait(std::atomic<uint32_t>* addr, uint32_t value,
+                       const struct timespec* timeout) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, value,
+          timeout, NULL, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>* addr) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT32_MAX,
+          NULL, NULL, 0);
+}
+
+static int64_t monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+int a2dp_audio_ring_create(void) {
+  int fd = syscall(SYS_memfd_create, "a2dp_audio_ring", MFD_CLOEXEC);
+  if (fd < 0) return -1;
+
+  // The memory is zero filled: the ring starts empty
+  if (ftruncate(fd, sizeof(struct a2dp_audio_ring)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+struct a2dp_audio_ring* a2dp_audio_ring_map(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) < 0 ||
+      st.st_size != (off_t)sizeof(struct a2dp_audio_ring)) {
+    return NULL;
+  }
+
+  void* addr = mmap(NULL, sizeof(struct a2dp_audio_ring),
+                    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) return NULL;
+  return static_cast<struct a2dp_audio_ring*>(addr);
+}
+
+void a2dp_audio_ring_unmap(struct a2dp_audio_ring* ring) {
+  if (ring != NULL) munmap(ring, sizeof(struct a2dp_audio_ring));
+}
+
+void a2dp_audio_ring_close(struct a2dp_audio_ring* ring) {
+  ring->closed.store(1, std::memory_order_release);
+  futex_wake(&ring->read_pos);
+}
+
+size_t a2dp_audio_ring_write(struct a2dp_audio_ring* ring, const void* buffer,
+                             size_t len, int timeout_ms) {
+  const uint8_t* p = static_cast<const uint8_t*>(buffer);
+  const int64_t deadline_ns =
+      monotonic_ns() + (int64_t)timeout_ms * NSEC_PER_MSEC;
+  uint32_t write_pos = ring->write_pos.load(std::memory_order_relaxed);
+  size_t count = 0;
+
+  while (count < len && !ring->closed.load(std::memory_order_acquire)) {
+    uint32_t read_pos = ring->read_pos.load(std::memory_order_acquire);
+    size_t space = A2DP_AUDIO_RING_DATA_SZ - (uint32_t)(write_pos - read_pos);
+    if (space == 0) {
+      // Wait for the stack to read, unless it already did since |read_pos|
+      // was loaded
+      int64_t remaining_ns = deadline_ns - monotonic_ns();
+      if (remaining_ns <= 0) break;
+      struct timespec timeout;
+      timeout.tv_sec = remaining_ns / NSEC_PER_SEC;
+      timeout.tv_nsec = remaining_ns % NSEC_PER_SEC;
+      futex_wait(&ring->read_pos, read_pos, &timeout);
+      continue;
+    }
+
+    size_t offset = write_pos & (A2DP_AUDIO_RING_DATA_SZ - 1);
+    size_t n =
+        std::min({len - count, space, A2DP_AUDIO_RING_DATA_SZ - offset});
+    memcpy(&ring->data[offset], p + count, n);
+    write_pos += n;
+    count += n;
+    ring->write_pos.store(write_pos, std::memory_order_release);
+  }
+  return count;
+}
+
+size_t a2dp_audio_ring_read(struct a2dp_audio_ring* ring, void* buffer,
+                            size_t len) {
+  uint8_t* p = static_cast<uint8_t*>(buffer);
+  uint32_t read_pos = ring->read_pos.load(std::memory_order_relaxed);
+  uint32_t write_pos = ring->write_pos.load(std::memory_order_acquire);
+  size_t available = (uint32_t)(write_pos - read_pos);
+
+  // A corrupted write position is handled as an empty ring
+  if (available > A2DP_AUDIO_RING_DATA_SZ) return 0;
+
+  size_t count = std::min(len, available);
+  if (count == 0) return 0;
+
+  size_t offset = read_pos & (A2DP_AUDIO_RING_DATA_SZ - 1);
+  size_t n = std::min(count, A2DP_AUDIO_RING_DATA_SZ - offset);
+  memcpy(p, &ring->data[offset], n);
+  memcpy(p + n, &ring->data[0], count - n);
+
+  ring->read_pos.store(read_pos + count, std::memory_order_release);
+  futex_wake(&ring->read_pos);
+  return count;
+}
+
+void a2dp_audio_ring_flush(struct a2dp_audio_ring* ring) {
+  ring->read_pos.store(ring->write_pos.load(std::memory_order_acquire),
+                       std::memory_order_release);
+  futex_wake(&ring->read_pos);
+}
+
+void a2dp_audio_ring_set_position(struct a2dp_audio_ring* ring, uint64_t bytes,
+                                  uint16_t delay,
+                                  const struct timespec* timestamp) {
+  uint32_t seq = ring->position_seq.load(std::memory_order_relaxed);
+  ring->position_seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  ring->total_bytes_read.store(bytes, std::memory_order_relaxed);
+  ring->audio_delay.store(delay, std::memory_order_relaxed);
+  ring->timestamp_sec.store(timestamp->tv_sec, std::memory_order_relaxed);
+  ring->timestamp_nsec.store(timestamp->tv_nsec, std::memory_order_relaxed);
+  ring->position_seq.store(seq + 2, std::memory_order_release);
+}
+
+void a2dp_audio_ring_get_position(struct a2dp_audio_ring* ring,
+                                  uint64_t* bytes, uint16_t* delay,
+                                  struct timespec* timestamp) {
+  uint32_t seq;
+  do {
+    seq = ring->position_seq.load(std::memory_order_acquire);
+    *bytes = ring->total_bytes_read.load(std::memory_order_relaxed);
+    *delay = ring->audio_delay.load(std::memory_order_relaxed);
+    timestamp->tv_sec = ring->timestamp_sec.load(std::memory_order_relaxed);
+    timestamp->tv_nsec = ring->timestamp_nsec.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) != 0 ||
+           seq != ring->position_seq.load(std::memory_order_relaxed));
+}
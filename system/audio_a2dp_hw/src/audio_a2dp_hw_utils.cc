@@ -34,6 +34,7 @@ const char* audio_a2dp_hw_dump_ctrl_event(tA2DP_CTRL_CMD event) {
     CASE_RETURN_STR(A2DP_CTRL_GET_OUTPUT_AUDIO_CONFIG)
     CASE_RETURN_STR(A2DP_CTRL_SET_OUTPUT_AUDIO_CONFIG)
     CASE_RETURN_STR(A2DP_CTRL_GET_PRESENTATION_POSITION)
+    CASE_RETURN_STR(A2DP_CTRL_CMD_OPEN_AUDIO_RING)
   }
 
   return "UNKNOWN A2DP_CTRL_CMD";
@@ -17,8 +17,14 @@
  ******************************************************************************/
 
 #include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include "audio_a2dp_hw/include/audio_a2dp_hw.h"
+#include "audio_a2dp_hw/include/audio_a2dp_hw_ring.h"
 
 namespace {
 static uint32_t codec_sample_rate2value(
@@ -144,3 +150,102 @@ TEST_F(AudioA2dpHwTest, test_compute_buffer_size) {
     }
   }
 }
+
+class AudioA2dpHwRingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    int fd = a2dp_audio_ring_create();
+    ASSERT_GE(fd, 0);
+    // Map the ring twice, as the stack and the audio HAL do
+    stack_ring_ = a2dp_audio_ring_map(fd);
+    hal_ring_ = a2dp_audio_ring_map(fd);
+    close(fd);
+    ASSERT_NE(stack_ring_, nullptr);
+    ASSERT_NE(hal_ring_, nullptr);
+  }
+
+  void TearDown() override {
+    a2dp_audio_ring_unmap(stack_ring_);
+    a2dp_audio_ring_unmap(hal_ring_);
+  }
+
+  struct a2dp_audio_ring* stack_ring_ = nullptr;
+  struct a2dp_audio_ring* hal_ring_ = nullptr;
+};
+
+TEST_F(AudioA2dpHwRingTest, test_map_invalid_fd) {
+  EXPECT_EQ(a2dp_audio_ring_map(-1), nullptr);
+}
+
+TEST_F(AudioA2dpHwRingTest, test_write_read_wraps_around) {
+  std::vector<uint8_t> data(A2DP_AUDIO_RING_DATA_SZ / 3);
+  std::vector<uint8_t> read(data.size());
+  uint8_t value = 0;
+
+  // Enough iterations for the positions to wrap around the ring
+  for (int i = 0; i < 10; i++) {
+    for (auto& byte : data) byte = value++;
+    ASSERT_EQ(a2dp_audio_ring_write(hal_ring_, data.data(), data.size(), 0),
+              data.size());
+    ASSERT_EQ(a2dp_audio_ring_read(stack_ring_, read.data(), read.size()),
+              read.size());
+    ASSERT_EQ(read, data);
+  }
+  EXPECT_EQ(a2dp_audio_ring_read(stack_ring_, read.data(), read.size()), 0u);
+}
+
+TEST_F(AudioA2dpHwRingTest, test_write_full_ring_times_out) {
+  std::vector<uint8_t> data(A2DP_AUDIO_RING_DATA_SZ + 100);
+  EXPECT_EQ(a2dp_audio_ring_write(hal_ring_, data.data(), data.size(), 10),
+            static_cast<size_t>(A2DP_AUDIO_RING_DATA_SZ));
+
+  a2dp_audio_ring_flush(stack_ring_);
+  EXPECT_EQ(a2dp_audio_ring_read(stack_ring_, data.data(), data.size()), 0u);
+  EXPECT_EQ(a2dp_audio_ring_write(hal_ring_, data.data(), 100, 0), 100u);
+}
+
+TEST_F(AudioA2dpHwRingTest, test_write_waits_for_read) {
+  std::vector<uint8_t> data(2 * A2DP_AUDIO_RING_DATA_SZ);
+  std::thread stack([this]() {
+    std::vector<uint8_t> read(A2DP_AUDIO_RING_DATA_SZ / 4);
+    size_t total = 0;
+    while (total < 2 * A2DP_AUDIO_RING_DATA_SZ) {
+      total += a2dp_audio_ring_read(stack_ring_, read.data(), read.size());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  EXPECT_EQ(a2dp_audio_ring_write(hal_ring_, data.data(), data.size(), 5000),
+            data.size());
+  stack.join();
+}
+
+TEST_F(AudioA2dpHwRingTest, test_close_wakes_up_write) {
+  std::vector<uint8_t> data(2 * A2DP_AUDIO_RING_DATA_SZ);
+  std::thread stack([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    a2dp_audio_ring_close(stack_ring_);
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(a2dp_audio_ring_write(hal_ring_, data.data(), data.size(), 5000),
+            static_cast<size_t>(A2DP_AUDIO_RING_DATA_SZ));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  stack.join();
+}
+
+TEST_F(AudioA2dpHwRingTest, test_presentation_position) {
+  struct timespec timestamp;
+  timestamp.tv_sec = 12;
+  timestamp.tv_nsec = 345;
+  a2dp_audio_ring_set_position(stack_ring_, 0x123456789, 1500, &timestamp);
+
+  uint64_t bytes;
+  uint16_t delay;
+  struct timespec read_timestamp;
+  a2dp_audio_ring_get_position(hal_ring_, &bytes, &delay, &read_timestamp);
+  EXPECT_EQ(bytes, 0x123456789u);
+  EXPECT_EQ(delay, 1500);
+  EXPECT_EQ(read_timestamp.tv_sec, 12);
+  EXPECT_EQ(read_timestamp.tv_nsec, 345);
+}
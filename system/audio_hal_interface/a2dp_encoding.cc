@@ -34,6 +34,14 @@ bool update_codec_offloading_capabilities(
   return aidl::a2dp::update_codec_offloading_capabilities(framework_preference);
 }
 
+bool is_codec_offloading_supported(btav_a2dp_codec_index_t codec_index) {
+  if (HalVersionManager::GetHalTransport() ==
+      BluetoothAudioHalTransport::HIDL) {
+    return hidl::a2dp::is_codec_offloading_supported(codec_index);
+  }
+  return aidl::a2dp::is_codec_offloading_supported(codec_index);
+}
+
 // Check if new bluetooth_audio is enabled
 bool is_hal_enabled() {
   if (HalVersionManager::GetHalTransport() ==
@@ -127,6 +135,14 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return aidl::a2dp::read(p_buf, len);
 }
 
+size_t available_to_read() {
+  if (HalVersionManager::GetHalTransport() ==
+      BluetoothAudioHalTransport::HIDL) {
+    return hidl::a2dp::available_to_read();
+  }
+  return aidl::a2dp::available_to_read();
+}
+
 // Update A2DP delay report to BluetoothAudio HAL
 void set_remote_delay(uint16_t delay_report) {
   if (HalVersionManager::GetHalTransport() ==
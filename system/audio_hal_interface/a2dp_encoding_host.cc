@@ -19,6 +19,7 @@
 #include <base/logging.h>
 #include <errno.h>
 #include <grp.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 
 #include <memory>
@@ -202,6 +203,10 @@ bool update_codec_offloading_capabilities(
   return false;
 }
 
+bool is_codec_offloading_supported(btav_a2dp_codec_index_t codec_index) {
+  return false;
+}
+
 // Checking if new bluetooth_audio is enabled
 bool is_hal_enabled() { return true; }
 
@@ -272,6 +277,15 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return bytes_read;
 }
 
+// Number of bytes queued on the UIPC audio channel
+size_t available_to_read() {
+  if (a2dp_uipc == nullptr) return 0;
+  int fd = a2dp_uipc->ch[UIPC_CH_ID_AV_AUDIO].fd;
+  int bytes = 0;
+  if (fd < 0 || ioctl(fd, FIONREAD, &bytes) < 0 || bytes < 0) return 0;
+  return bytes;
+}
+
 // Check if OPUS codec is supported
 bool is_opus_supported() { return true; }
 
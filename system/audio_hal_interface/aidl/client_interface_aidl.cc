@@ -463,6 +463,43 @@ size_t BluetoothAudioSinkClientInterface::ReadAudioData(uint8_t* p_buf,
   return total_read;
 }
 
+size_t BluetoothAudioSinkClientInterface::AvailableToReadAudioData() {
+  if (!IsValid()) return 0;
+
+  std::lock_guard<std::mutex> guard(internal_mutex_);
+  if (data_mq_ == nullptr || !data_mq_->isValid()) return 0;
+  return data_mq_->availableToRead();
+}
+
+bool BluetoothAudioSinkClientInterface::ReadAudioDataInPlace(
+    uint32_t len, const AudioDataConsumer& consume) {
+  if (!IsValid()) {
+    LOG(ERROR) << __func__ << ": BluetoothAudioHal is not valid";
+    return false;
+  }
+  if (len == 0) return false;
+
+  std::lock_guard<std::mutex> guard(internal_mutex_);
+  if (data_mq_ == nullptr || !data_mq_->isValid()) return false;
+  if (data_mq_->availableToRead() < len) return false;
+
+  DataMQ::MemTransaction tx;
+  if (!data_mq_->beginRead(len, &tx)) {
+    LOG(WARNING) << __func__ << ": len=" << len << " failed";
+    return false;
+  }
+  auto first = tx.getFirstRegion();
+  auto second = tx.getSecondRegion();
+  consume({reinterpret_cast<const uint8_t*>(first.getAddress()),
+           first.getLength()},
+          {reinterpret_cast<const uint8_t*>(second.getAddress()),
+           second.getLength()});
+  data_mq_->commitRead(len);
+
+  sink_->LogBytesRead(len);
+  return true;
+}
+
 void BluetoothAudioClientInterface::RenewAudioProviderAndSession() {
   // NOTE: must be invoked on the same thread where this
   // BluetoothAudioClientInterface is running
@@ -25,6 +25,7 @@
 
 #include "audio_aidl_interfaces.h"
 #include "audio_ctrl_ack.h"
+#include "audio_hal_interface/audio_data_span.h"
 #include "bluetooth_audio_port_impl.h"
 #include "common/message_loop_thread.h"
 #include "transport_instance.h"
@@ -150,6 +151,18 @@ class BluetoothAudioSinkClientInterface : public BluetoothAudioClientInterface {
    ***/
   size_t ReadAudioData(uint8_t* p_buf, uint32_t len);
 
+  /***
+   * Number of bytes in the fmq that can be read without waiting
+   ***/
+  size_t AvailableToReadAudioData();
+
+  /***
+   * Give the next |len| bytes of the fmq in place to |consume|, then remove
+   * them from the fmq. Return false without waiting for data, and without
+   * calling |consume|, if the fmq holds less than |len| bytes.
+   ***/
+  bool ReadAudioDataInPlace(uint32_t len, const AudioDataConsumer& consume);
+
  private:
   IBluetoothSinkTransportInstance* sink_;
 
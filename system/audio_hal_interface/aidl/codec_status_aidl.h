@@ -58,6 +58,12 @@ bool UpdateOffloadingCapabilities(
  ***/
 bool IsCodecOffloadingEnabled(const CodecConfiguration& codec_config);
 
+/***
+ * Check whether the offloading capabilities allow the source codec
+ * |codec_index| with at least one of its configurations.
+ ***/
+bool IsCodecOffloadingSupported(btav_a2dp_codec_index_t codec_index);
+
 }  // namespace codec
 }  // namespace aidl
 }  // namespace audio
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+
+namespace bluetooth {
+namespace audio {
+
+// A contiguous region of the audio data read in place from the audio HAL
+struct AudioDataSpan {
+  const uint8_t* data;
+  size_t size;
+};
+
+// Consumes audio data in place. The data is given as two regions, as it may
+// wrap around the end of the HAL queue; |second| is empty when it doesn't.
+// The regions are only valid during the call.
+using AudioDataConsumer =
+    std::function<void(AudioDataSpan first, AudioDataSpan second)>;
+
+}  // namespace audio
+}  // namespace bluetooth
@@ -336,6 +336,11 @@ bool update_codec_offloading_capabilities(
       framework_preference);
 }
 
+bool is_codec_offloading_supported(btav_a2dp_codec_index_t codec_index) {
+  return ::bluetooth::audio::hidl::codec::IsCodecOffloadingSupported(
+      codec_index);
+}
+
 // Checking if new bluetooth_audio is enabled
 bool is_hal_2_0_enabled() { return active_hal_interface != nullptr; }
 
@@ -537,6 +542,12 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   return active_hal_interface->ReadAudioData(p_buf, len);
 }
 
+// Number of bytes in the FMQ of BluetoothAudio HAL that can be read at once
+size_t available_to_read() {
+  if (!is_hal_2_0_enabled() || is_hal_2_0_offloading()) return 0;
+  return active_hal_interface->AvailableToReadAudioData();
+}
+
 // Update A2DP delay report to BluetoothAudio HAL
 void set_remote_delay(uint16_t delay_report) {
   if (!is_hal_2_0_enabled()) {
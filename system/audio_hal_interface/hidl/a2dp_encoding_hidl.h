@@ -29,6 +29,9 @@ namespace a2dp {
 bool update_codec_offloading_capabilities(
     const std::vector<btav_a2dp_codec_config_t>& framework_preference);
 
+// Check if the source codec can be offloaded
+bool is_codec_offloading_supported(btav_a2dp_codec_index_t codec_index);
+
 // Check if new bluetooth_audio is enabled
 bool is_hal_2_0_enabled();
 
@@ -54,6 +57,9 @@ void ack_stream_suspended(const tA2DP_CTRL_ACK& status);
 // Read from the FMQ of BluetoothAudio HAL
 size_t read(uint8_t* p_buf, uint32_t len);
 
+// Number of bytes in the FMQ of BluetoothAudio HAL that can be read at once
+size_t available_to_read();
+
 // Update A2DP delay report to BluetoothAudio HAL
 void set_remote_delay(uint16_t delay_report);
 
@@ -812,6 +812,41 @@ size_t BluetoothAudioSinkClientInterface::ReadAudioData(uint8_t* p_buf,
   return total_read;
 }
 
+size_t BluetoothAudioSinkClientInterface::AvailableToReadAudioData() {
+  if (!IsValid()) return 0;
+
+  std::lock_guard<std::mutex> guard(internal_mutex_);
+  if (mDataMQ == nullptr || !mDataMQ->isValid()) return 0;
+  return mDataMQ->availableToRead();
+}
+
+bool BluetoothAudioSinkClientInterface::ReadAudioDataInPlace(
+    uint32_t len, const AudioDataConsumer& consume) {
+  if (!IsValid()) {
+    LOG(ERROR) << __func__ << ": BluetoothAudioHal is not valid";
+    return false;
+  }
+  if (len == 0) return false;
+
+  std::lock_guard<std::mutex> guard(internal_mutex_);
+  if (mDataMQ == nullptr || !mDataMQ->isValid()) return false;
+  if (mDataMQ->availableToRead() < len) return false;
+
+  DataMQ::MemTransaction tx;
+  if (!mDataMQ->beginRead(len, &tx)) {
+    LOG(WARNING) << __func__ << ": len=" << len << " failed";
+    return false;
+  }
+  auto first = tx.getFirstRegion();
+  auto second = tx.getSecondRegion();
+  consume({first.getAddress(), first.getLength()},
+          {second.getAddress(), second.getLength()});
+  mDataMQ->commitRead(len);
+
+  sink_->LogBytesRead(len);
+  return true;
+}
+
 void BluetoothAudioClientInterface::RenewAudioProviderAndSession() {
   // NOTE: must be invoked on the same thread where this
   // BluetoothAudioClientInterface is running
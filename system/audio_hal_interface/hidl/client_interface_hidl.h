@@ -25,6 +25,7 @@
 #include <mutex>
 #include <vector>
 
+#include "audio_hal_interface/audio_data_span.h"
 #include "common/message_loop_thread.h"
 
 #define BLUETOOTH_AUDIO_HAL_PROP_DISABLED \
@@ -265,6 +266,14 @@ class BluetoothAudioSinkClientInterface : public BluetoothAudioClientInterface {
   // Read data from audio  HAL through fmq
   size_t ReadAudioData(uint8_t* p_buf, uint32_t len);
 
+  // Number of bytes in the fmq that can be read without waiting
+  size_t AvailableToReadAudioData();
+
+  // Give the next |len| bytes of the fmq in place to |consume|, then remove
+  // them from the fmq. Return false without waiting for data, and without
+  // calling |consume|, if the fmq holds less than |len| bytes.
+  bool ReadAudioDataInPlace(uint32_t len, const AudioDataConsumer& consume);
+
  private:
   IBluetoothSinkTransportInstance* sink_;
 };
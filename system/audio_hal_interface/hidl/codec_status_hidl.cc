@@ -568,6 +568,33 @@ bool IsCodecOffloadingEnabled(const CodecConfiguration& codec_config) {
   return false;
 }
 
+bool IsCodecOffloadingSupported(btav_a2dp_codec_index_t codec_index) {
+  CodecType codec_type;
+  switch (codec_index) {
+    case BTAV_A2DP_CODEC_INDEX_SOURCE_SBC:
+      codec_type = CodecType::SBC;
+      break;
+    case BTAV_A2DP_CODEC_INDEX_SOURCE_AAC:
+      codec_type = CodecType::AAC;
+      break;
+    case BTAV_A2DP_CODEC_INDEX_SOURCE_APTX:
+      codec_type = CodecType::APTX;
+      break;
+    case BTAV_A2DP_CODEC_INDEX_SOURCE_APTX_HD:
+      codec_type = CodecType::APTX_HD;
+      break;
+    case BTAV_A2DP_CODEC_INDEX_SOURCE_LDAC:
+      codec_type = CodecType::LDAC;
+      break;
+    default:
+      return false;
+  }
+  for (auto& preference : offloading_preference) {
+    if (preference.codecCapabilities().codecType == codec_type) return true;
+  }
+  return false;
+}
+
 }  // namespace codec
 }  // namespace hidl
 }  // namespace audio
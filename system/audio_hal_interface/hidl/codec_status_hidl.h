@@ -56,6 +56,10 @@ bool UpdateOffloadingCapabilities(
 // by prefernece of framework / Bluetooth SoC / runtime property.
 bool IsCodecOffloadingEnabled(const CodecConfiguration& codec_config);
 
+// Check whether the offloading capabilities allow the source codec
+// |codec_index| with at least one of its configurations.
+bool IsCodecOffloadingSupported(btav_a2dp_codec_index_t codec_index);
+
 }  // namespace codec
 }  // namespace hidl
 }  // namespace audio
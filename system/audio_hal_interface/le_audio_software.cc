@@ -368,6 +368,17 @@ size_t LeAudioClientInterface::Sink::Read(uint8_t* p_buf, uint32_t len) {
   return get_aidl_client_interface(is_broadcaster_)->ReadAudioData(p_buf, len);
 }
 
+bool LeAudioClientInterface::Sink::ReadInPlace(
+    uint32_t len, const AudioDataConsumer& consume) {
+  if (HalVersionManager::GetHalTransport() ==
+      BluetoothAudioHalTransport::HIDL) {
+    return hidl::le_audio::LeAudioSinkTransport::interface
+        ->ReadAudioDataInPlace(len, consume);
+  }
+  return get_aidl_client_interface(is_broadcaster_)
+      ->ReadAudioDataInPlace(len, consume);
+}
+
 void LeAudioClientInterface::Source::Cleanup() {
   LOG(INFO) << __func__ << " source";
   StopSession();
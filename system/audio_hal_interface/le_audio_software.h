@@ -20,6 +20,7 @@
 
 #include <functional>
 
+#include "audio_hal_interface/audio_data_span.h"
 #include "bta/le_audio/codec_manager.h"
 #include "bta/le_audio/le_audio_types.h"
 #include "common/message_loop_thread.h"
@@ -107,6 +108,9 @@ class LeAudioClientInterface {
     void ReconfigurationComplete() override;
     // Read the stream of bytes sinked to us by the upper layers
     size_t Read(uint8_t* p_buf, uint32_t len);
+    // Give the next |len| bytes of the stream in place to |consume|. Return
+    // false without waiting, if less than |len| bytes are available.
+    bool ReadInPlace(uint32_t len, const AudioDataConsumer& consume);
     bool IsBroadcaster() { return is_broadcaster_; }
 
    private:
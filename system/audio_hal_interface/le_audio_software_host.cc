@@ -54,6 +54,11 @@ size_t LeAudioClientInterface::Sink::Read(uint8_t* p_buf, uint32_t len) {
   return 0;
 }
 
+bool LeAudioClientInterface::Sink::ReadInPlace(
+    uint32_t len, const AudioDataConsumer& consume) {
+  return false;
+}
+
 LeAudioClientInterface::Source* LeAudioClientInterface::GetSource(
     StreamCallbacks stream_cb,
     bluetooth::common::MessageLoopThread* message_loop) {
@@ -69,6 +69,11 @@ void bta_ag_at_reinit(tBTA_AG_AT_CB* p_cb) {
   p_cb->cmd_pos = 0;
 }
 
+/* uppercase a command character, as utl_strucmp does */
+static char bta_ag_at_upper(char c) {
+  return (c >= 'a' && c <= 'z') ? (char)(c - 0x20) : c;
+}
+
 /******************************************************************************
  *
  * Function         bta_ag_process_at
@@ -86,9 +91,17 @@ void bta_ag_process_at(tBTA_AG_AT_CB* p_cb, char* p_end) {
   uint8_t arg_type;
   char* p_arg;
   int16_t int_arg = 0;
+  /* uppercase the first two characters of the command once, so that the
+   * table entries of other commands are rejected without a full compare */
+  char c0 = bta_ag_at_upper(p_cb->p_cmd_buf[0]);
+  char c1 = (c0 == 0) ? 0 : bta_ag_at_upper(p_cb->p_cmd_buf[1]);
   /* loop through at command table looking for match */
   for (idx = 0; p_cb->p_at_tbl[idx].p_cmd[0] != 0; idx++) {
-    if (!utl_strucmp(p_cb->p_at_tbl[idx].p_cmd, p_cb->p_cmd_buf)) {
+    const char* p_cmd = p_cb->p_at_tbl[idx].p_cmd;
+    if (p_cmd[0] != c0 || (p_cmd[1] != 0 && p_cmd[1] != c1)) {
+      continue;
+    }
+    if (!utl_strucmp(p_cmd, p_cb->p_cmd_buf)) {
       break;
     }
   }
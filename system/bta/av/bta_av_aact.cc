@@ -1885,7 +1885,6 @@ void bta_av_str_stopped(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
   tBTA_AV_SUSPEND suspend_rsp;
   uint8_t start = p_scb->started;
   bool sus_evt = true;
-  BT_HDR* p_buf;
 
   APPL_TRACE_ERROR(
       "%s: peer %s bta_handle:0x%x audio_open_cnt:%d, p_data %p start:%d",
@@ -1914,9 +1913,10 @@ void bta_av_str_stopped(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
   /* if q_info.a2dp_list is not empty, drop it now */
   if (BTA_AV_CHNL_AUDIO == p_scb->chnl) {
     while (!list_is_empty(p_scb->a2dp_list)) {
-      p_buf = (BT_HDR*)list_front(p_scb->a2dp_list);
-      list_remove(p_scb->a2dp_list, p_buf);
-      osi_free(p_buf);
+      tBTA_AV_MEDIA_PKT* p_pkt =
+          (tBTA_AV_MEDIA_PKT*)list_front(p_scb->a2dp_list);
+      list_remove(p_scb->a2dp_list, p_pkt);
+      bta_av_media_pkt_free(p_pkt);
     }
 
     /* drop the audio buffers queued in L2CAP */
@@ -2066,7 +2066,7 @@ void bta_av_reconfig(tBTA_AV_SCB* p_scb, tBTA_AV_DATA* p_data) {
  *
  ******************************************************************************/
 void bta_av_data_path(tBTA_AV_SCB* p_scb, UNUSED_ATTR tBTA_AV_DATA* p_data) {
-  BT_HDR* p_buf = NULL;
+  tBTA_AV_MEDIA_PKT* p_pkt = NULL;
   uint32_t timestamp;
   bool new_buf = false;
   uint8_t m_pt = 0x60;
@@ -2085,30 +2085,29 @@ void bta_av_data_path(tBTA_AV_SCB* p_scb, UNUSED_ATTR tBTA_AV_DATA* p_data) {
       (uint8_t)L2CA_FlushChannel(p_scb->l2c_cid, L2CAP_FLUSH_CHANS_GET);
 
   if (!list_is_empty(p_scb->a2dp_list)) {
-    p_buf = (BT_HDR*)list_front(p_scb->a2dp_list);
-    list_remove(p_scb->a2dp_list, p_buf);
-    /* use q_info.a2dp data, read the timestamp */
-    timestamp = *(uint32_t*)(p_buf + 1);
+    p_pkt = (tBTA_AV_MEDIA_PKT*)list_front(p_scb->a2dp_list);
+    list_remove(p_scb->a2dp_list, p_pkt);
   } else {
     new_buf = true;
     /* A2DP_list empty, call co_data, dup data to other channels */
-    p_buf = p_scb->p_cos->data(p_scb->cfg.codec_info, &timestamp);
+    BT_HDR* p_buf = p_scb->p_cos->data(p_scb->cfg.codec_info, &timestamp);
 
     if (p_buf) {
-      /* use the offset area for the time stamp */
-      *(uint32_t*)(p_buf + 1) = timestamp;
+      p_pkt = bta_av_media_pkt_new(p_buf, timestamp);
 
       /* dup the data to other channels */
-      bta_av_dup_audio_buf(p_scb, p_buf);
+      bta_av_dup_audio_buf(p_scb, p_pkt);
     }
   }
 
-  if (p_buf) {
+  if (p_pkt) {
     if (p_scb->l2c_bufs < (BTA_AV_QUEUE_DATA_CHK_NUM)) {
       /* There's a buffer, just queue it to L2CAP.
        * There's no need to increment it here, it is always read from
        * L2CAP (see above).
        */
+      timestamp = p_pkt->timestamp;
+      BT_HDR* p_buf = bta_av_media_pkt_take(p_pkt);
 
       /* opt is a bit mask, it could have several options set */
       opt = AVDT_DATA_OPT_NONE;
@@ -2166,16 +2165,16 @@ void bta_av_data_path(tBTA_AV_SCB* p_scb, UNUSED_ATTR tBTA_AV_DATA* p_data) {
       if (new_buf) {
         /* just got this buffer from co_data,
          * put it in queue */
-        list_append(p_scb->a2dp_list, p_buf);
+        list_append(p_scb->a2dp_list, p_pkt);
       } else {
         /* just dequeue it from the a2dp_list */
         if (list_length(p_scb->a2dp_list) < 3) {
           /* put it back to the queue */
-          list_prepend(p_scb->a2dp_list, p_buf);
+          list_prepend(p_scb->a2dp_list, p_pkt);
         } else {
           /* too many buffers in a2dp_list, drop it. */
           bta_av_co_audio_drop(p_scb->hndl, p_scb->PeerAddress());
-          osi_free(p_buf);
+          bta_av_media_pkt_free(p_pkt);
         }
       }
     }
@@ -2291,7 +2291,6 @@ void bta_av_dereg_comp(tBTA_AV_DATA* p_data) {
   tBTA_AV_SCB* p_scb;
   tBTA_UTL_COD cod;
   uint8_t mask;
-  BT_HDR* p_buf;
 
   /* find the stream control block */
   p_scb = bta_av_hndl_to_scb(p_data->hdr.layer_specific);
@@ -2310,9 +2309,10 @@ void bta_av_dereg_comp(tBTA_AV_DATA* p_data) {
     if (p_scb->q_tag == BTA_AV_Q_TAG_STREAM && p_scb->a2dp_list) {
       /* make sure no buffers are in a2dp_list */
       while (!list_is_empty(p_scb->a2dp_list)) {
-        p_buf = (BT_HDR*)list_front(p_scb->a2dp_list);
-        list_remove(p_scb->a2dp_list, p_buf);
-        osi_free(p_buf);
+        tBTA_AV_MEDIA_PKT* p_pkt =
+            (tBTA_AV_MEDIA_PKT*)list_front(p_scb->a2dp_list);
+        list_remove(p_scb->a2dp_list, p_pkt);
+        bta_av_media_pkt_free(p_pkt);
       }
     }
 
@@ -462,6 +462,16 @@ union tBTA_AV_DATA {
   tBTA_AV_API_STATUS_RSP api_status_rsp;
 };
 
+/* Encoded media packet queued to the audio channels. When streaming to
+ * several channels, the channels share one packet and each one holds a
+ * reference to it.
+ */
+typedef struct {
+  BT_HDR* p_buf;      /* the encoded payload, with the encoder headroom */
+  uint32_t timestamp; /* the media timestamp of the payload */
+  uint8_t ref_count;  /* number of channels still to send the packet */
+} tBTA_AV_MEDIA_PKT;
+
 typedef union {
   tBTA_AV_API_OPEN open; /* used only before open and role switch
                             is needed on another AV channel */
@@ -503,7 +513,7 @@ struct tBTA_AV_SCB final {
   bool sdp_discovery_started; /* variable to determine whether SDP is started */
   tBTA_AV_SEP seps[BTAV_A2DP_CODEC_INDEX_MAX];
   AvdtpSepConfig peer_cap; /* buffer used for get capabilities */
-  list_t* a2dp_list; /* used for audio channels only */
+  list_t* a2dp_list; /* tBTA_AV_MEDIA_PKT, used for audio channels only */
   tBTA_AV_Q_INFO q_info;
   tAVDT_SEP_INFO sep_info[BTA_AV_NUM_SEPS]; /* stream discovery results */
   AvdtpSepConfig cfg;                       /* local SEP configuration */
@@ -727,7 +737,12 @@ extern void bta_av_free_scb(tBTA_AV_SCB* p_scb);
 
 /* main functions */
 extern void bta_av_api_deregister(tBTA_AV_DATA* p_data);
-extern void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BT_HDR* p_buf);
+extern void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb,
+                                 tBTA_AV_MEDIA_PKT* p_pkt);
+extern tBTA_AV_MEDIA_PKT* bta_av_media_pkt_new(BT_HDR* p_buf,
+                                               uint32_t timestamp);
+extern BT_HDR* bta_av_media_pkt_take(tBTA_AV_MEDIA_PKT* p_pkt);
+extern void bta_av_media_pkt_free(tBTA_AV_MEDIA_PKT* p_pkt);
 extern void bta_av_sm_execute(tBTA_AV_CB* p_cb, uint16_t event,
                               tBTA_AV_DATA* p_data);
 extern void bta_av_ssm_execute(tBTA_AV_SCB* p_scb, uint16_t event,
@@ -1051,21 +1051,88 @@ bool bta_av_link_role_ok(tBTA_AV_SCB* p_scb, uint8_t bits) {
   return true;
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_av_media_pkt_new
+ *
+ * Description      Wrap the encoded media packet p_buf, so that it can be
+ *                  queued to several audio channels without being copied.
+ *
+ * Returns          The media packet, with one reference
+ *
+ ******************************************************************************/
+tBTA_AV_MEDIA_PKT* bta_av_media_pkt_new(BT_HDR* p_buf, uint32_t timestamp) {
+  tBTA_AV_MEDIA_PKT* p_pkt =
+      (tBTA_AV_MEDIA_PKT*)osi_malloc(sizeof(tBTA_AV_MEDIA_PKT));
+  p_pkt->p_buf = p_buf;
+  p_pkt->timestamp = timestamp;
+  p_pkt->ref_count = 1;
+  return p_pkt;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_av_media_pkt_take
+ *
+ * Description      Release one reference to the media packet, and get the
+ *                  buffer to send to one audio channel with
+ *                  AVDT_WriteReqOpt(). The stack owns this buffer and builds
+ *                  the protocol headers in its headroom: the last reference
+ *                  gets the encoded buffer itself, the others get a copy of
+ *                  the header and payload, with the same headroom.
+ *
+ * Returns          The buffer to send
+ *
+ ******************************************************************************/
+BT_HDR* bta_av_media_pkt_take(tBTA_AV_MEDIA_PKT* p_pkt) {
+  BT_HDR* p_buf = p_pkt->p_buf;
+  if (--p_pkt->ref_count == 0) {
+    osi_free(p_pkt);
+    return p_buf;
+  }
+
+  BT_HDR* p_new =
+      (BT_HDR*)osi_malloc(BT_HDR_SIZE + p_buf->offset + p_buf->len);
+  p_new->event = p_buf->event;
+  p_new->len = p_buf->len;
+  p_new->offset = p_buf->offset;
+  p_new->layer_specific = p_buf->layer_specific;
+  memcpy(p_new->data + p_new->offset, p_buf->data + p_buf->offset,
+         p_buf->len);
+  return p_new;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_av_media_pkt_free
+ *
+ * Description      Release one reference to the media packet, when it is
+ *                  dropped by an audio channel.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void bta_av_media_pkt_free(tBTA_AV_MEDIA_PKT* p_pkt) {
+  if (--p_pkt->ref_count > 0) return;
+  osi_free(p_pkt->p_buf);
+  osi_free(p_pkt);
+}
+
 /*******************************************************************************
  *
  * Function         bta_av_dup_audio_buf
  *
- * Description      dup the audio data to the q_info.a2dp of other audio
- *                  channels
+ * Description      Queue the media packet to the a2dp_list of the other audio
+ *                  channels. The channels share the packet, and only get
+ *                  their own copy when they send it.
  *
  * Returns          void
  *
  ******************************************************************************/
-void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BT_HDR* p_buf) {
+void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, tBTA_AV_MEDIA_PKT* p_pkt) {
   /* Test whether there is more than one audio channel connected */
-  if ((p_buf == NULL) || (bta_av_cb.audio_open_cnt < 2)) return;
+  if ((p_pkt == NULL) || (bta_av_cb.audio_open_cnt < 2)) return;
 
-  uint16_t copy_size = BT_HDR_SIZE + p_buf->len + p_buf->offset;
   for (int i = 0; i < BTA_AV_NUM_STRS; i++) {
     tBTA_AV_SCB* p_scbi = bta_av_cb.p_scb[i];
 
@@ -1074,18 +1141,20 @@ void bta_av_dup_audio_buf(tBTA_AV_SCB* p_scb, BT_HDR* p_buf) {
       continue; /* Ignore if SCB is not used or started */
     if (!(bta_av_cb.conn_audio & BTA_AV_HNDL_TO_MSK(i)))
       continue; /* Audio is not connected */
+    if (!A2DP_CodecEquals(p_scbi->cfg.codec_info, p_scb->cfg.codec_info))
+      continue; /* Encoded for another codec configuration */
 
     /* Enqueue the data */
-    BT_HDR* p_new = (BT_HDR*)osi_malloc(copy_size);
-    memcpy(p_new, p_buf, copy_size);
-    list_append(p_scbi->a2dp_list, p_new);
+    p_pkt->ref_count++;
+    list_append(p_scbi->a2dp_list, p_pkt);
 
     if (list_length(p_scbi->a2dp_list) > p_bta_av_cfg->audio_mqs) {
       // Drop the oldest packet
       bta_av_co_audio_drop(p_scbi->hndl, p_scbi->PeerAddress());
-      BT_HDR* p_buf_drop = static_cast<BT_HDR*>(list_front(p_scbi->a2dp_list));
-      list_remove(p_scbi->a2dp_list, p_buf_drop);
-      osi_free(p_buf_drop);
+      tBTA_AV_MEDIA_PKT* p_pkt_drop =
+          static_cast<tBTA_AV_MEDIA_PKT*>(list_front(p_scbi->a2dp_list));
+      list_remove(p_scbi->a2dp_list, p_pkt_drop);
+      bta_av_media_pkt_free(p_pkt_drop);
     }
   }
 }
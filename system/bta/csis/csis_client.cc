@@ -23,7 +23,9 @@
 #include <hardware/bt_gatt_types.h>
 
 #include <list>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "advertise_data_parser.h"
@@ -1170,6 +1172,25 @@ class CsisClientImpl : public CsisClient {
     return std::move(devices);
   }
 
+  /* Each member advertises the same RSI until its address rotates, so the
+   * reports of the active and background scans keep repeating a few RSIs.
+   * Resolve each RSI once against each SIRK instead of running the sih
+   * function on every report.
+   */
+  bool IsRsiMatchingGroup(const RawAddress& rsi,
+                          const std::shared_ptr<CsisGroup>& csis_group) {
+    auto key = std::make_pair(rsi, csis_group->GetSirk());
+    auto cached = rsi_resolution_cache_.find(key);
+    if (cached != rsi_resolution_cache_.end()) return cached->second;
+
+    bool matching = csis_group->IsRsiMatching(rsi);
+    /* RSIs of devices nearby keep rotating, start over when full */
+    if (rsi_resolution_cache_.size() >= kRsiResolutionCacheSize)
+      rsi_resolution_cache_.clear();
+    rsi_resolution_cache_.emplace(std::move(key), matching);
+    return matching;
+  }
+
   void OnActiveScanResult(const tBTA_DM_INQ_RES* result) {
     auto csis_device = FindDeviceByAddress(result->bd_addr);
     if (csis_device) {
@@ -1189,8 +1210,8 @@ class CsisClientImpl : public CsisClient {
     }
 
     auto discovered_group_rsi = std::find_if(
-        all_rsi.cbegin(), all_rsi.cend(), [&csis_group](const auto& rsi) {
-          return csis_group->IsRsiMatching(rsi);
+        all_rsi.cbegin(), all_rsi.cend(), [this, &csis_group](const auto& rsi) {
+          return IsRsiMatchingGroup(rsi, csis_group);
         });
     if (discovered_group_rsi != all_rsi.cend()) {
       DLOG(INFO) << "Found set member " << result->bd_addr;
@@ -1252,7 +1273,7 @@ class CsisClientImpl : public CsisClient {
     for (tBTM_INQ_INFO* inq_ent = BTM_InqDbFirst(); inq_ent != nullptr;
          inq_ent = BTM_InqDbNext(inq_ent)) {
       RawAddress rsi = inq_ent->results.ble_ad_rsi;
-      if (!csis_group->IsRsiMatching(rsi)) continue;
+      if (!IsRsiMatchingGroup(rsi, csis_group)) continue;
 
       RawAddress address = inq_ent->results.remote_bd_addr;
       auto device = FindDeviceByAddress(address);
@@ -1302,7 +1323,7 @@ class CsisClientImpl : public CsisClient {
     /* Notify all the groups this device belongs to. */
     for (auto& group : csis_groups_) {
       for (auto& rsi : all_rsi) {
-        if (group->IsRsiMatching(rsi)) {
+        if (IsRsiMatchingGroup(rsi, group)) {
           LOG_INFO("Device %s match to group id %d",
                    result->bd_addr.ToString().c_str(), group->GetGroupId());
           if (group->GetDesiredSize() > 0 &&
@@ -1977,6 +1998,10 @@ class CsisClientImpl : public CsisClient {
   std::list<std::shared_ptr<CsisGroup>> csis_groups_;
   DeviceGroups* dev_groups_;
   int discovering_group_ = -1;
+
+  /* Results of the RSI resolutions, by RSI and SIRK */
+  static constexpr size_t kRsiResolutionCacheSize = 256;
+  std::map<std::pair<RawAddress, Octet16>, bool> rsi_resolution_cache_;
 };
 
 class DeviceGroupsCallbacksImpl : public DeviceGroupsCallbacks {
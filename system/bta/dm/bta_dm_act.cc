@@ -30,7 +30,11 @@
 #include <bta.sysprop.h>
 #endif
 
+#include <cinttypes>
 #include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 
 #include "bta/dm/bta_dm_int.h"
 #include "bta/gatt/bta_gattc_int.h"
@@ -39,6 +43,7 @@
 #include "btif/include/btif_dm.h"
 #include "btif/include/btif_storage.h"
 #include "btif/include/stack_manager.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "device/include/interop.h"
 #include "gd/common/init_flags.h"
@@ -130,6 +135,12 @@ static void bta_dm_ble_id_key_cback(uint8_t key_type,
 static void bta_dm_gattc_register(void);
 static void btm_dm_start_gatt_discovery(const RawAddress& bd_addr);
 static void bta_dm_gattc_callback(tBTA_GATTC_EVT event, tBTA_GATTC* p_data);
+static void bta_dm_disc_prefetch_queued(void);
+static void bta_dm_disc_prefetch_release(const RawAddress& bd_addr);
+static void bta_dm_disc_timing_start(void);
+static void bta_dm_disc_timing_record(const tBTA_DM_DISC_RES& disc_res);
+static tBT_TRANSPORT bta_dm_determine_discovery_transport(
+    const RawAddress& bd_addr, tBT_TRANSPORT transport);
 extern tBTM_CONTRL_STATE bta_dm_pm_obtain_controller_state(void);
 #if (BLE_VND_INCLUDED == TRUE)
 static void bta_dm_ctrl_features_rd_cmpl_cback(tHCI_STATUS result);
@@ -160,6 +171,11 @@ static void bta_dm_ctrl_features_rd_cmpl_cback(tHCI_STATUS result);
 #define BTA_DM_SWITCH_DELAY_TIMER_MS 500
 #endif
 
+/* Delay of the EIR write after a service UUID change (in milliseconds) */
+#ifndef BTA_DM_EIR_UPDATE_DELAY_MS
+#define BTA_DM_EIR_UPDATE_DELAY_MS 100
+#endif
+
 // Time to wait after receiving shutdown request to delay the actual shutdown
 // process. This time may be zero which invokes immediate shutdown.
 static uint64_t get_DisableDelayTimerInMs() {
@@ -171,6 +187,19 @@ static uint64_t get_DisableDelayTimerInMs() {
   return kDisableDelayTimerInMs;
 #endif
 }
+// Number of LE connections opened ahead of time for the queued discoveries,
+// on top of the connection of the ongoing one. Zero discovers the devices
+// strictly one after another.
+static size_t get_DiscoveryPrefetchMax() {
+#ifndef OS_ANDROID
+  return 2;
+#else
+  static const size_t kDiscoveryPrefetchMax =
+      android::sysprop::bluetooth::Bta::discovery_prefetch_max().value_or(2);
+  return kDiscoveryPrefetchMax;
+#endif
+}
+
 namespace {
 
 struct WaitForAllAclConnectionsToDrain {
@@ -261,6 +290,25 @@ const tBTM_APPL_INFO bta_security = {
 #define MAX_DISC_RAW_DATA_BUF (4096)
 uint8_t g_disc_raw_data_buf[MAX_DISC_RAW_DATA_BUF];
 
+/* LE connections opened ahead of the queued discoveries, by peer address:
+ * the connection id, or GATT_INVALID_CONN_ID while it is opening */
+static std::unordered_map<RawAddress, uint16_t> bta_dm_disc_prefetch;
+
+#define BTA_DM_DISCOVERY_RECORDS_MAX 16
+
+typedef struct {
+  RawAddress bd_addr;
+  tBT_TRANSPORT transport;
+  bool prefetched;
+  uint64_t name_ms;     /* remote name stage */
+  uint64_t services_ms; /* SDP or GATT stage */
+  tBTA_STATUS result;
+} tBTA_DM_DISCOVERY_RECORD;
+
+/* most recent discoveries first, also read by dumpsys from another thread */
+static std::deque<tBTA_DM_DISCOVERY_RECORD> bta_dm_discovery_records;
+static std::mutex bta_dm_discovery_records_mutex;
+
 // Stores the local Input/Output Capabilities of the Bluetooth device.
 static uint8_t btm_local_io_caps;
 
@@ -288,6 +336,7 @@ void bta_dm_init_cb(void) {
   bta_dm_cb = {};
   bta_dm_cb.disable_timer = alarm_new("bta_dm.disable_timer");
   bta_dm_cb.switch_delay_timer = alarm_new("bta_dm.switch_delay_timer");
+  bta_dm_cb.eir_update_timer = alarm_new("bta_dm.eir_update_timer");
   for (size_t i = 0; i < BTA_DM_NUM_PM_TIMER; i++) {
     for (size_t j = 0; j < BTA_DM_PM_MODE_TIMER_MAX; j++) {
       bta_dm_cb.pm_timer[i].timer[j] = alarm_new("bta_dm.pm_timer");
@@ -312,6 +361,7 @@ void bta_dm_deinit_cb(void) {
    */
   alarm_free(bta_dm_cb.disable_timer);
   alarm_free(bta_dm_cb.switch_delay_timer);
+  alarm_free(bta_dm_cb.eir_update_timer);
   for (size_t i = 0; i < BTA_DM_NUM_PM_TIMER; i++) {
     for (size_t j = 0; j < BTA_DM_PM_MODE_TIMER_MAX; j++) {
       alarm_free(bta_dm_cb.pm_timer[i].timer[j]);
@@ -332,6 +382,7 @@ void BTA_dm_on_hw_off() {
   osi_free(bta_dm_search_cb.p_pending_search);
   fixed_queue_free(bta_dm_search_cb.pending_discovery_queue, osi_free);
   memset(&bta_dm_search_cb, 0, sizeof(bta_dm_search_cb));
+  bta_dm_disc_prefetch.clear();
 }
 
 void BTA_dm_on_hw_on() {
@@ -353,6 +404,7 @@ void BTA_dm_on_hw_on() {
   osi_free(bta_dm_search_cb.p_pending_search);
   fixed_queue_free(bta_dm_search_cb.pending_discovery_queue, osi_free);
   memset(&bta_dm_search_cb, 0, sizeof(bta_dm_search_cb));
+  bta_dm_disc_prefetch.clear();
   /*
    * TODO: Should alarm_free() the bta_dm_search_cb timers during
    * graceful shutdown.
@@ -925,11 +977,13 @@ void bta_dm_discover(tBTA_DM_MSG* p_data) {
   bta_dm_search_cb.transport = p_data->discover.transport;
 
   bta_dm_search_cb.name_discover_done = false;
+  bta_dm_disc_timing_start();
 
   LOG_INFO("bta_dm_discovery: starting service discovery to %s , transport: %s",
            PRIVATE_ADDRESS(p_data->discover.bd_addr),
            bt_transport_text(p_data->discover.transport).c_str());
   bta_dm_discover_device(p_data->discover.bd_addr);
+  bta_dm_disc_prefetch_queued();
 }
 
 /*******************************************************************************
@@ -1032,6 +1086,7 @@ void bta_dm_inq_cmpl(uint8_t num) {
      */
     bta_dm_search_cb.name_discover_done = false;
     bta_dm_search_cb.peer_name[0] = 0;
+    bta_dm_disc_timing_start();
     bta_dm_discover_device(
         bta_dm_search_cb.p_btm_inq_info->results.remote_bd_addr);
   } else {
@@ -1376,6 +1431,8 @@ void bta_dm_search_cmpl() {
 void bta_dm_disc_result(tBTA_DM_MSG* p_data) {
   APPL_TRACE_EVENT("%s", __func__);
 
+  bta_dm_disc_timing_record(p_data->disc_result.result.disc_res);
+
   /* disc_res.device_type is set only when GATT discovery is finished in
    * bta_dm_gatt_disc_complete */
   bool is_gatt_over_ble = ((p_data->disc_result.result.disc_res.device_type &
@@ -1405,6 +1462,8 @@ void bta_dm_search_result(tBTA_DM_MSG* p_data) {
                    bta_dm_search_cb.services,
                    p_data->disc_result.result.disc_res.services);
 
+  bta_dm_disc_timing_record(p_data->disc_result.result.disc_res);
+
   /* call back if application wants name discovery or found services that
    * application is searching */
   if ((!bta_dm_search_cb.services) ||
@@ -1492,6 +1551,8 @@ void bta_dm_queue_disc(tBTA_DM_MSG* p_data) {
            p_pending_discovery->discover.bd_addr.ToString().c_str());
   fixed_queue_enqueue(bta_dm_search_cb.pending_discovery_queue,
                       p_pending_discovery);
+  if (bta_dm_search_cb.state == BTA_DM_DISCOVER_ACTIVE)
+    bta_dm_disc_prefetch_queued();
 }
 
 /*******************************************************************************
@@ -1545,6 +1606,10 @@ void bta_dm_search_clear_queue() {
   if (bluetooth::common::InitFlags::
           IsBtmDmFlushDiscoveryQueueOnSearchCancel()) {
     fixed_queue_flush(bta_dm_search_cb.pending_discovery_queue, osi_free);
+    /* The connections opened for the flushed requests are not needed */
+    while (!bta_dm_disc_prefetch.empty()) {
+      bta_dm_disc_prefetch_release(bta_dm_disc_prefetch.begin()->first);
+    }
   }
 }
 
@@ -1676,6 +1741,7 @@ static void bta_dm_discover_next_device(void) {
   if (bta_dm_search_cb.p_btm_inq_info != NULL) {
     bta_dm_search_cb.name_discover_done = false;
     bta_dm_search_cb.peer_name[0] = 0;
+    bta_dm_disc_timing_start();
     bta_dm_discover_device(
         bta_dm_search_cb.p_btm_inq_info->results.remote_bd_addr);
   } else {
@@ -1689,6 +1755,29 @@ static void bta_dm_discover_next_device(void) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_dm_determine_discovery_transport
+ *
+ * Description      Resolves the transport of a discovery requested with
+ *                  |transport|, BT_TRANSPORT_AUTO or not.
+ *
+ * Returns          BT_TRANSPORT_BR_EDR or BT_TRANSPORT_LE
+ *
+ ******************************************************************************/
+static tBT_TRANSPORT bta_dm_determine_discovery_transport(
+    const RawAddress& bd_addr, tBT_TRANSPORT transport) {
+  if (transport != BT_TRANSPORT_AUTO) return transport;
+
+  tBT_DEVICE_TYPE dev_type;
+  tBLE_ADDR_TYPE addr_type;
+
+  BTM_ReadDevInfo(bd_addr, &dev_type, &addr_type);
+  if (dev_type == BT_DEVICE_TYPE_BLE || addr_type == BLE_ADDR_RANDOM)
+    return BT_TRANSPORT_LE;
+  return BT_TRANSPORT_BR_EDR;
+}
+
 /*******************************************************************************
  *
  * Function         bta_dm_discover_device
@@ -1699,17 +1788,8 @@ static void bta_dm_discover_next_device(void) {
  *
  ******************************************************************************/
 static void bta_dm_discover_device(const RawAddress& remote_bd_addr) {
-  tBT_TRANSPORT transport = BT_TRANSPORT_BR_EDR;
-  if (bta_dm_search_cb.transport == BT_TRANSPORT_AUTO) {
-    tBT_DEVICE_TYPE dev_type;
-    tBLE_ADDR_TYPE addr_type;
-
-    BTM_ReadDevInfo(remote_bd_addr, &dev_type, &addr_type);
-    if (dev_type == BT_DEVICE_TYPE_BLE || addr_type == BLE_ADDR_RANDOM)
-      transport = BT_TRANSPORT_LE;
-  } else {
-    transport = bta_dm_search_cb.transport;
-  }
+  tBT_TRANSPORT transport = bta_dm_determine_discovery_transport(
+      remote_bd_addr, bta_dm_search_cb.transport);
 
   VLOG(1) << __func__ << " BDA: " << remote_bd_addr;
 
@@ -1762,6 +1842,7 @@ static void bta_dm_discover_device(const RawAddress& remote_bd_addr) {
 
   /* Reset transport state for next discovery */
   bta_dm_search_cb.transport = BT_TRANSPORT_AUTO;
+  bta_dm_search_cb.disc_transport = transport;
 
   /* if application wants to discover service */
   if (bta_dm_search_cb.services) {
@@ -1798,6 +1879,8 @@ static void bta_dm_discover_device(const RawAddress& remote_bd_addr) {
           // set the raw data buffer here
           memset(g_disc_raw_data_buf, 0, sizeof(g_disc_raw_data_buf));
           /* start GATT for service discovery */
+          bta_dm_search_cb.services_start_ms =
+              bluetooth::common::time_get_os_boottime_ms();
           btm_dm_start_gatt_discovery(bta_dm_search_cb.peer_bdaddr);
           return;
         }
@@ -1805,6 +1888,8 @@ static void bta_dm_discover_device(const RawAddress& remote_bd_addr) {
         LOG_INFO("bta_dm_discovery: starting SDP discovery on %s",
                  PRIVATE_ADDRESS(bta_dm_search_cb.peer_bdaddr));
         bta_dm_search_cb.sdp_results = false;
+        bta_dm_search_cb.services_start_ms =
+            bluetooth::common::time_get_os_boottime_ms();
         bta_dm_find_services(bta_dm_search_cb.peer_bdaddr);
         return;
       }
@@ -2505,6 +2590,9 @@ void bta_dm_acl_up(const RawAddress& bd_addr, tBT_TRANSPORT transport) {
   device->pref_role = BTA_ANY_ROLE;
   device->info = BTA_DM_DI_NONE;
   device->transport = transport;
+  device->sniff_entered_ms = 0;
+  device->active_requested_ms = 0;
+  device->sniff_delay_shift = 0;
 
   if (controller_get_interface()->supports_sniff_subrating() &&
       acl_peer_supports_sniff_subrating(bd_addr)) {
@@ -3184,10 +3272,44 @@ static void bta_dm_set_eir(char* local_name) {
   if (free_eir_length)
     UINT8_TO_STREAM(p, 0); /* terminator of significant part */
 
+  /* The controller already has this EIR, skip the HCI command */
+  const uint8_t* p_eir = (uint8_t*)p_buf + BTM_HCI_EIR_OFFSET;
+  if (bta_dm_cb.eir_written &&
+      memcmp(bta_dm_cb.written_eir, p_eir, HCI_EXT_INQ_RESPONSE_LEN) == 0) {
+    osi_free(p_buf);
+    return;
+  }
+  memcpy(bta_dm_cb.written_eir, p_eir, HCI_EXT_INQ_RESPONSE_LEN);
+  bta_dm_cb.eir_written = true;
+
   get_btm_client_interface().eir.BTM_WriteEIR(p_buf);
 }
 
 #if (BTA_EIR_CANNED_UUID_LIST != TRUE)
+static void bta_dm_eir_update_timer_cback(UNUSED_ATTR void* data) {
+  bta_dm_set_eir(NULL);
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_dm_schedule_eir_update
+ *
+ * Description      This function writes the EIR BTA_DM_EIR_UPDATE_DELAY_MS
+ *                  after the last of a series of service UUID changes.
+ *
+ * Returns          None
+ *
+ ******************************************************************************/
+static void bta_dm_schedule_eir_update() {
+  /* Before bta_dm_init_cb() there is no timer to wait with */
+  if (bta_dm_cb.eir_update_timer == nullptr) {
+    bta_dm_set_eir(NULL);
+    return;
+  }
+  alarm_set_on_mloop(bta_dm_cb.eir_update_timer, BTA_DM_EIR_UPDATE_DELAY_MS,
+                     bta_dm_eir_update_timer_cback, NULL);
+}
+
 /*******************************************************************************
  *
  * Function         bta_dm_get_cust_uuid_index
@@ -3259,7 +3381,7 @@ void bta_dm_eir_update_cust_uuid(const tBTA_CUSTOM_UUID& curr, bool adding) {
 
   /* Update EIR when UUIDs are changed */
   if (c_uu_idx <= BTA_EIR_SERVER_NUM_CUSTOM_UUID) {
-    bta_dm_set_eir(NULL);
+    bta_dm_schedule_eir_update();
   }
 #endif
 }
@@ -3288,7 +3410,7 @@ void bta_dm_eir_update_uuid(uint16_t uuid16, bool adding) {
                                                         uuid16);
   }
 
-  bta_dm_set_eir(NULL);
+  bta_dm_schedule_eir_update();
 }
 #endif
 
@@ -4064,6 +4186,144 @@ void bta_dm_close_gatt_conn(UNUSED_ATTR tBTA_DM_MSG* p_data) {
   bta_dm_search_cb.pending_close_bda = RawAddress::kEmpty;
   bta_dm_search_cb.conn_id = GATT_INVALID_CONN_ID;
 }
+
+/*******************************************************************************
+ *
+ * Function         bta_dm_disc_prefetch_queued
+ *
+ * Description      Opens ahead of time the LE connections of the queued
+ *                  discoveries, so that connection establishment overlaps
+ *                  the ongoing discovery. At most get_DiscoveryPrefetchMax()
+ *                  connections are opened or kept for this.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_dm_disc_prefetch_queued(void) {
+  const size_t max_prefetch = get_DiscoveryPrefetchMax();
+
+  if (bta_dm_search_cb.client_if == BTA_GATTS_INVALID_IF) return;
+  if (bta_dm_disc_prefetch.size() >= max_prefetch) return;
+
+  list_t* queue =
+      fixed_queue_get_list(bta_dm_search_cb.pending_discovery_queue);
+  if (queue == nullptr) return;
+
+  for (const list_node_t* node = list_begin(queue);
+       node != list_end(queue) && bta_dm_disc_prefetch.size() < max_prefetch;
+       node = list_next(node)) {
+    const tBTA_DM_API_DISCOVER* p_disc =
+        (const tBTA_DM_API_DISCOVER*)list_node(node);
+    const RawAddress& bd_addr = p_disc->bd_addr;
+
+    if (bd_addr == bta_dm_search_cb.peer_bdaddr ||
+        bta_dm_disc_prefetch.count(bd_addr) != 0)
+      continue;
+    if (bta_dm_determine_discovery_transport(bd_addr, p_disc->transport) !=
+            BT_TRANSPORT_LE ||
+        BTM_IsAclConnectionUp(bd_addr, BT_TRANSPORT_LE))
+      continue;
+
+    LOG_INFO("bta_dm_discovery: connecting ahead of discovery to %s",
+             PRIVATE_ADDRESS(bd_addr));
+    bta_dm_disc_prefetch[bd_addr] = GATT_INVALID_CONN_ID;
+    BTA_GATTC_Open(bta_dm_search_cb.client_if, bd_addr,
+                   BTM_BLE_DIRECT_CONNECTION, false);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_dm_disc_prefetch_release
+ *
+ * Description      Closes, or stops opening, the connection opened ahead of
+ *                  the discovery of |bd_addr|, if any.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_dm_disc_prefetch_release(const RawAddress& bd_addr) {
+  auto prefetch = bta_dm_disc_prefetch.find(bd_addr);
+  if (prefetch == bta_dm_disc_prefetch.end()) return;
+
+  if (prefetch->second != GATT_INVALID_CONN_ID) {
+    BTA_GATTC_Close(prefetch->second);
+  } else {
+    BTA_GATTC_CancelOpen(bta_dm_search_cb.client_if, bd_addr, true);
+  }
+  bta_dm_disc_prefetch.erase(prefetch);
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_dm_disc_timing_start
+ *
+ * Description      Starts timing the stages of the discovery of a device.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_dm_disc_timing_start(void) {
+  bta_dm_search_cb.disc_start_ms = bluetooth::common::time_get_os_boottime_ms();
+  bta_dm_search_cb.services_start_ms = 0;
+  bta_dm_search_cb.disc_transport = BT_TRANSPORT_AUTO;
+  bta_dm_search_cb.disc_prefetched = false;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_dm_disc_timing_record
+ *
+ * Description      Logs and keeps the stage timings of the discovery of a
+ *                  device, when its result is reported.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_dm_disc_timing_record(const tBTA_DM_DISC_RES& disc_res) {
+  bta_dm_disc_prefetch_release(disc_res.bd_addr);
+  if (bta_dm_search_cb.disc_start_ms == 0) return;
+
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  uint64_t services_start_ms = bta_dm_search_cb.services_start_ms != 0
+                                   ? bta_dm_search_cb.services_start_ms
+                                   : now_ms;
+  tBTA_DM_DISCOVERY_RECORD record = {
+      .bd_addr = disc_res.bd_addr,
+      .transport = bta_dm_search_cb.disc_transport,
+      .prefetched = bta_dm_search_cb.disc_prefetched,
+      .name_ms = services_start_ms - bta_dm_search_cb.disc_start_ms,
+      .services_ms = now_ms - services_start_ms,
+      .result = disc_res.result,
+  };
+  bta_dm_search_cb.disc_start_ms = 0;
+
+  LOG_INFO("bta_dm_discovery: %s done, name %" PRIu64 " ms, services %" PRIu64
+           " ms%s",
+           PRIVATE_ADDRESS(record.bd_addr), record.name_ms, record.services_ms,
+           record.prefetched ? ", connected ahead" : "");
+
+  std::lock_guard<std::mutex> lock(bta_dm_discovery_records_mutex);
+  bta_dm_discovery_records.push_front(record);
+  if (bta_dm_discovery_records.size() > BTA_DM_DISCOVERY_RECORDS_MAX) {
+    bta_dm_discovery_records.pop_back();
+  }
+}
+
+/** Dump the recent discoveries */
+void bta_dm_dump_discovery_records(int fd) {
+  std::lock_guard<std::mutex> lock(bta_dm_discovery_records_mutex);
+  dprintf(fd, "\nBTA DM discoveries (most recent first):\n");
+  for (const auto& record : bta_dm_discovery_records) {
+    dprintf(fd,
+            "  %s: %s, name %" PRIu64 " ms, services %" PRIu64
+            " ms%s, result=%d\n",
+            record.bd_addr.ToString().c_str(),
+            bt_transport_text(record.transport).c_str(), record.name_ms,
+            record.services_ms, record.prefetched ? ", connected ahead" : "",
+            record.result);
+  }
+}
 /*******************************************************************************
  *
  * Function         btm_dm_start_gatt_discovery
@@ -4077,6 +4337,20 @@ void bta_dm_close_gatt_conn(UNUSED_ATTR tBTA_DM_MSG* p_data) {
 void btm_dm_start_gatt_discovery(const RawAddress& bd_addr) {
   bta_dm_search_cb.gatt_disc_active = true;
 
+  /* connection opened ahead of time, or still opening: its open event is
+   * processed as the one of this discovery */
+  auto prefetch = bta_dm_disc_prefetch.find(bd_addr);
+  if (prefetch != bta_dm_disc_prefetch.end()) {
+    uint16_t conn_id = prefetch->second;
+    bta_dm_disc_prefetch.erase(prefetch);
+    bta_dm_search_cb.disc_prefetched = true;
+    if (conn_id != GATT_INVALID_CONN_ID) {
+      bta_dm_search_cb.conn_id = conn_id;
+      BTA_GATTC_ServiceSearchRequest(conn_id, nullptr);
+    }
+    return;
+  }
+
   /* connection is already open */
   if (bta_dm_search_cb.pending_close_bda == bd_addr &&
       bta_dm_search_cb.conn_id != GATT_INVALID_CONN_ID) {
@@ -4111,6 +4385,16 @@ void bta_dm_proc_open_evt(tBTA_GATTC_OPEN* p_data) {
   APPL_TRACE_DEBUG("BTA_GATTC_OPEN_EVT conn_id = %d client_if=%d status = %d",
                    p_data->conn_id, p_data->client_if, p_data->status);
 
+  /* connection opened for a queued discovery: kept until its turn */
+  auto prefetch = bta_dm_disc_prefetch.find(p_data->remote_bda);
+  if (prefetch != bta_dm_disc_prefetch.end()) {
+    if (p_data->status == GATT_SUCCESS)
+      prefetch->second = p_data->conn_id;
+    else
+      bta_dm_disc_prefetch.erase(prefetch);
+    return;
+  }
+
   bta_dm_search_cb.conn_id = p_data->conn_id;
 
   if (p_data->status == GATT_SUCCESS) {
@@ -4177,6 +4461,8 @@ static void bta_dm_gattc_callback(tBTA_GATTC_EVT event, tBTA_GATTC* p_data) {
     case BTA_GATTC_CLOSE_EVT:
       LOG_INFO("BTA_GATTC_CLOSE_EVT reason = %d", p_data->close.reason);
 
+      if (bta_dm_disc_prefetch.erase(p_data->close.remote_bda)) break;
+
       /* in case of disconnect before search is completed */
       if ((bta_dm_search_cb.state != BTA_DM_SEARCH_IDLE) &&
           (bta_dm_search_cb.state != BTA_DM_SEARCH_ACTIVE) &&
@@ -145,6 +145,36 @@ void BTA_DmDiscover(const RawAddress& bd_addr, tBTA_DM_SEARCH_CBACK* p_cback,
   bta_sys_sendmsg(p_msg);
 }
 
+/*******************************************************************************
+ *
+ * Function         BTA_DmDumpDiscoveryStatistics
+ *
+ * Description      Dump the stage timings of the recent name and service
+ *                  discoveries of the remote devices
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTA_DmDumpDiscoveryStatistics(int fd) {
+  bta_dm_dump_discovery_records(fd);
+}
+
+/*******************************************************************************
+ *
+ * Function         BTA_DmDumpPowerModeStatistics
+ *
+ * Description      Dump the power mode transitions of the ACL links and the
+ *                  time taken to wake them up from sniff
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTA_DmDumpPowerModeStatistics(int fd) { bta_dm_pm_dump(fd); }
+
 /** This function initiates a bonding procedure with a peer device */
 void BTA_DmBond(const RawAddress& bd_addr, tBLE_ADDR_TYPE addr_type,
                 tBT_TRANSPORT transport, tBT_DEVICE_TYPE device_type) {
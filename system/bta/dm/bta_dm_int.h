@@ -36,6 +36,7 @@
 #include "main/shim/dumpsys.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_octets.h"
+#include "stack/include/hcidefs.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
 
@@ -262,6 +263,13 @@ struct tBTA_DM_PEER_DEVICE {
   tBTA_DM_PM_ACTION pm_mode_failed;
   bool remove_dev_pending;
   tBT_TRANSPORT transport;
+  /* boot time the link entered sniff, 0 when not in sniff */
+  uint64_t sniff_entered_ms;
+  /* boot time active mode was requested from sniff, 0 when not pending */
+  uint64_t active_requested_ms;
+  /* the sniff timers of the link are multiplied by 1 << sniff_delay_shift,
+   * raised each time traffic wakes the link up soon after sniff */
+  uint8_t sniff_delay_shift;
 };
 
 /* structure to store list of
@@ -354,6 +362,13 @@ typedef struct {
 
   tBTA_DM_ENCRYPT_CBACK* p_encrypt_cback;
   alarm_t* switch_delay_timer;
+
+  /* Delays the EIR write of a UUID change, so that the UUIDs the profiles
+   * register while starting up are written at once */
+  alarm_t* eir_update_timer;
+  /* EIR last written to the controller, valid if eir_written is set */
+  bool eir_written;
+  uint8_t written_eir[HCI_EXT_INQ_RESPONSE_LEN];
 } tBTA_DM_CB;
 
 /* DM search control block */
@@ -385,6 +400,11 @@ typedef struct {
   uint16_t conn_id;
   alarm_t* gatt_close_timer; /* GATT channel close delay timer */
   RawAddress pending_close_bda; /* pending GATT channel remote device address */
+  /* Stage timings of the discovery of peer_bdaddr */
+  uint64_t disc_start_ms;
+  uint64_t services_start_ms; /* start of SDP or GATT, 0 before */
+  tBT_TRANSPORT disc_transport;
+  bool disc_prefetched; /* GATT used a connection opened ahead of time */
 
 } tBTA_DM_SEARCH_CB;
 
@@ -552,6 +572,7 @@ extern void bta_dm_ci_rmt_oob_act(std::unique_ptr<tBTA_DM_CI_RMT_OOB> msg);
 
 extern void bta_dm_init_pm(void);
 extern void bta_dm_disable_pm(void);
+extern void bta_dm_pm_dump(int fd);
 
 extern uint8_t bta_dm_get_av_count(void);
 extern void bta_dm_search_start(tBTA_DM_MSG* p_data);
@@ -570,6 +591,7 @@ extern void bta_dm_queue_disc(tBTA_DM_MSG* p_data);
 extern void bta_dm_execute_queued_request();
 extern bool bta_dm_is_search_request_queued();
 extern void bta_dm_search_clear_queue();
+extern void bta_dm_dump_discovery_records(int fd);
 extern void bta_dm_search_cancel_notify();
 extern void bta_dm_disc_rmt_name(tBTA_DM_MSG* p_data);
 extern tBTA_DM_PEER_DEVICE* bta_dm_find_peer_device(
@@ -24,6 +24,8 @@
  ******************************************************************************/
 
 #include <base/bind.h>
+#include <algorithm>
+#include <cinttypes>
 #include <cstdint>
 #include <mutex>
 
@@ -31,6 +33,7 @@
 #include "bta/include/bta_api.h"
 #include "bta/include/bta_dm_api.h"
 #include "bta/sys/bta_sys.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "main/shim/dumpsys.h"
 #include "osi/include/log.h"
@@ -63,6 +66,26 @@ tBTA_DM_CONNECTED_SRVCS bta_dm_conn_srvcs;
 static std::recursive_mutex pm_timer_schedule_mutex;
 static std::recursive_mutex pm_timer_state_mutex;
 
+/* A link woken up sooner than this after entering sniff had its sniff timer
+ * expire in the middle of bursty traffic, its next sniff timers are doubled.
+ * A link staying longer than BTA_DM_PM_LONG_SNIFF_MS in sniff gets its timers
+ * halved back. */
+#define BTA_DM_PM_EARLY_WAKE_MS 1000
+#define BTA_DM_PM_LONG_SNIFF_MS 30000
+#define BTA_DM_PM_MAX_SNIFF_DELAY_SHIFT 3
+
+/* power mode transitions of all the links, also read by dumpsys from another
+ * thread */
+static struct {
+  uint64_t sniff_count;
+  uint64_t active_count;
+  uint64_t early_wake_count;
+  uint64_t wake_count;
+  uint64_t wake_total_ms;
+  uint64_t wake_max_ms;
+} bta_dm_pm_stats;
+static std::mutex bta_dm_pm_stats_mutex;
+
 /*******************************************************************************
  *
  * Function         bta_dm_init_pm
@@ -586,6 +609,11 @@ static void bta_dm_pm_set_mode(const RawAddress& peer_addr,
       }
     }
   }
+  /* delay the sniff of the links whose traffic came back soon after sniff */
+  if ((pm_action & BTA_DM_PM_SNIFF) && p_peer_device->sniff_delay_shift) {
+    timeout_ms <<= p_peer_device->sniff_delay_shift;
+  }
+
   /* if need to start a timer */
   if ((pm_req != BTA_DM_PM_EXECUTE) && (timeout_ms > 0)) {
     for (i = 0; i < BTA_DM_NUM_PM_TIMER; i++) {
@@ -857,10 +885,16 @@ void bta_dm_pm_active(const RawAddress& peer_addr) {
       LOG_DEBUG("Active power mode stored for execution later for remote:%s",
                 PRIVATE_ADDRESS(peer_addr));
       break;
-    case BTM_CMD_STARTED:
+    case BTM_CMD_STARTED: {
       LOG_DEBUG("Active power mode started for remote:%s",
                 PRIVATE_ADDRESS(peer_addr));
-      break;
+      /* time the wake up, until the mode change event */
+      tBTA_DM_PEER_DEVICE* p_dev = bta_dm_find_peer_device(peer_addr);
+      if (p_dev != nullptr && p_dev->active_requested_ms == 0) {
+        p_dev->active_requested_ms =
+            bluetooth::common::time_get_os_boottime_ms();
+      }
+    } break;
     case BTM_SUCCESS:
       LOG_DEBUG("Active power mode already set for device:%s",
                 PRIVATE_ADDRESS(peer_addr));
@@ -922,6 +956,61 @@ static void bta_dm_pm_timer_cback(void* data) {
                             bta_dm_cb.pm_timer[i].pm_action[j]));
 }
 
+/* Account for a link back to active mode, and adapt its next sniff timers to
+ * how long it stayed in sniff */
+static void bta_dm_pm_on_active(tBTA_DM_PEER_DEVICE* p_dev) {
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  bool early_wake = false;
+
+  if (p_dev->sniff_entered_ms != 0) {
+    uint64_t sniff_ms = now_ms - p_dev->sniff_entered_ms;
+    if (sniff_ms < BTA_DM_PM_EARLY_WAKE_MS) {
+      early_wake = true;
+      if (p_dev->sniff_delay_shift < BTA_DM_PM_MAX_SNIFF_DELAY_SHIFT) {
+        p_dev->sniff_delay_shift++;
+      }
+    } else if (sniff_ms > BTA_DM_PM_LONG_SNIFF_MS &&
+               p_dev->sniff_delay_shift > 0) {
+      p_dev->sniff_delay_shift--;
+    }
+    LOG_DEBUG("peer:%s left sniff after %" PRIu64 " ms, sniff delay x%d",
+              PRIVATE_ADDRESS(p_dev->peer_bdaddr), sniff_ms,
+              1 << p_dev->sniff_delay_shift);
+  }
+
+  std::lock_guard<std::mutex> lock(bta_dm_pm_stats_mutex);
+  bta_dm_pm_stats.active_count++;
+  if (early_wake) bta_dm_pm_stats.early_wake_count++;
+  if (p_dev->active_requested_ms != 0) {
+    uint64_t wake_ms = now_ms - p_dev->active_requested_ms;
+    bta_dm_pm_stats.wake_count++;
+    bta_dm_pm_stats.wake_total_ms += wake_ms;
+    bta_dm_pm_stats.wake_max_ms =
+        std::max(bta_dm_pm_stats.wake_max_ms, wake_ms);
+  }
+  p_dev->sniff_entered_ms = 0;
+  p_dev->active_requested_ms = 0;
+}
+
+/** Dump the power mode transitions of the links */
+void bta_dm_pm_dump(int fd) {
+  std::lock_guard<std::mutex> lock(bta_dm_pm_stats_mutex);
+  dprintf(fd, "\nBTA DM power modes:\n");
+  dprintf(fd,
+          "  to sniff: %" PRIu64 ", to active: %" PRIu64
+          ", woken up within %d ms of sniff: %" PRIu64 "\n",
+          bta_dm_pm_stats.sniff_count, bta_dm_pm_stats.active_count,
+          BTA_DM_PM_EARLY_WAKE_MS, bta_dm_pm_stats.early_wake_count);
+  if (bta_dm_pm_stats.wake_count != 0) {
+    dprintf(fd,
+            "  host wake ups: %" PRIu64 ", average %" PRIu64
+            " ms, max %" PRIu64 " ms\n",
+            bta_dm_pm_stats.wake_count,
+            bta_dm_pm_stats.wake_total_ms / bta_dm_pm_stats.wake_count,
+            bta_dm_pm_stats.wake_max_ms);
+  }
+}
+
 /** Process pm status event from btm */
 void bta_dm_pm_btm_status(const RawAddress& bd_addr, tBTM_PM_STATUS status,
                           uint16_t interval, tHCI_STATUS hci_status) {
@@ -956,6 +1045,7 @@ void bta_dm_pm_btm_status(const RawAddress& bd_addr, tBTM_PM_STATUS status,
           bta_dm_pm_set_mode(bd_addr, BTA_DM_PM_NO_ACTION, BTA_DM_PM_RESTART);
         }
       } else {
+        bta_dm_pm_on_active(p_dev);
         if (p_dev->prev_low) {
           /* need to send the SSR paramaters to controller again */
           bta_dm_pm_ssr(p_dev->peer_bdaddr, BTA_DM_PM_SSR0);
@@ -992,6 +1082,11 @@ void bta_dm_pm_btm_status(const RawAddress& bd_addr, tBTM_PM_STATUS status,
       break;
     case BTM_PM_STS_SNIFF:
       if (hci_status == 0) {
+        p_dev->sniff_entered_ms = bluetooth::common::time_get_os_boottime_ms();
+        {
+          std::lock_guard<std::mutex> lock(bta_dm_pm_stats_mutex);
+          bta_dm_pm_stats.sniff_count++;
+        }
         /* Stop PM timer now if already active for
          * particular device since link is already
          * put in sniff mode by remote device, and
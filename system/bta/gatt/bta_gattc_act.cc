@@ -33,6 +33,7 @@
 #include "bta/gatt/bta_gattc_int.h"
 #include "bta/hh/bta_hh_int.h"
 #include "btif/include/btif_debug_conn.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "device/include/interop.h"
 #include "main/shim/dumpsys.h"
@@ -784,6 +785,10 @@ void bta_gattc_start_discover(tBTA_GATTC_CLCB* p_clcb,
       p_clcb->p_srcb->srvc_hdl_chg = false;
       p_clcb->p_srcb->update_count = 0;
       p_clcb->p_srcb->state = BTA_GATTC_SERV_DISC_ACT;
+      p_clcb->p_srcb->full_range_discovery = false;
+      p_clcb->p_srcb->disc_max_procedures = 1;
+      p_clcb->p_srcb->disc_start_ms =
+          bluetooth::common::time_get_os_boottime_ms();
 
       /* This is workaround for the embedded devices being already on the market
        * and having a serious problem with handle Read By Type with
@@ -848,6 +853,8 @@ void bta_gattc_disc_cmpl(tBTA_GATTC_CLCB* p_clcb,
 
   VLOG(1) << __func__ << ": conn_id=" << loghex(p_clcb->bta_conn_id);
 
+  bta_gattc_record_discovery(p_clcb);
+
   if (p_clcb->transport == BT_TRANSPORT_LE)
     L2CA_EnableUpdateBleConnParams(p_clcb->p_srcb->server_bda, true);
   p_clcb->p_srcb->state = BTA_GATTC_SERV_IDLE;
@@ -941,8 +948,11 @@ void bta_gattc_read_multi(tBTA_GATTC_CLCB* p_clcb,
   memcpy(&read_param.read_multiple.handles, p_data->api_read_multi.handles,
          sizeof(uint16_t) * p_data->api_read_multi.num_attr);
 
+  tGATT_READ_TYPE read_type = p_data->api_read_multi.variable_len
+                                  ? GATT_READ_MULTIPLE_VAR_LEN
+                                  : GATT_READ_MULTIPLE;
   tGATT_STATUS status =
-      GATTC_Read(p_clcb->bta_conn_id, GATT_READ_MULTIPLE, &read_param);
+      GATTC_Read(p_clcb->bta_conn_id, read_type, &read_param);
   /* read fail */
   if (status != GATT_SUCCESS) {
     /* Dequeue the data, if it was enqueued */
@@ -1037,6 +1047,26 @@ static void bta_gattc_read_cmpl(tBTA_GATTC_CLCB* p_clcb,
   }
 }
 
+/** read multiple complete */
+static void bta_gattc_read_multi_cmpl(tBTA_GATTC_CLCB* p_clcb,
+                                      const tBTA_GATTC_OP_CMPL* p_data) {
+  GATT_READ_MULTI_OP_CB cb = p_clcb->p_q_cmd->api_read_multi.read_cb;
+  void* my_cb_data = p_clcb->p_q_cmd->api_read_multi.read_cb_data;
+
+  tBTA_GATTC_MULTI handles;
+  handles.num_attr = p_clcb->p_q_cmd->api_read_multi.num_attr;
+  memcpy(handles.handles, p_clcb->p_q_cmd->api_read_multi.handles,
+         sizeof(uint16_t) * handles.num_attr);
+
+  osi_free_and_reset((void**)&p_clcb->p_q_cmd);
+
+  if (cb) {
+    cb(p_clcb->bta_conn_id, p_data->status, handles,
+       p_data->p_cmpl->att_value.len, p_data->p_cmpl->att_value.value,
+       my_cb_data);
+  }
+}
+
 /** write complete */
 static void bta_gattc_write_cmpl(tBTA_GATTC_CLCB* p_clcb,
                                  const tBTA_GATTC_OP_CMPL* p_data) {
@@ -1131,8 +1161,12 @@ void bta_gattc_op_cmpl(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
       return;
   }
 
-  if (p_clcb->p_q_cmd->hdr.event !=
-      bta_gattc_opcode_to_int_evt[op - GATTC_OPTYPE_READ]) {
+  const bool is_read_multi =
+      op == GATTC_OPTYPE_READ &&
+      p_clcb->p_q_cmd->hdr.event == BTA_GATTC_API_READ_MULTI_EVT;
+  if (!is_read_multi &&
+      p_clcb->p_q_cmd->hdr.event !=
+          bta_gattc_opcode_to_int_evt[op - GATTC_OPTYPE_READ]) {
     uint8_t mapped_op =
         p_clcb->p_q_cmd->hdr.event - BTA_GATTC_API_READ_EVT + GATTC_OPTYPE_READ;
     if (mapped_op > GATTC_OPTYPE_INDICATION) mapped_op = 0;
@@ -1156,7 +1190,10 @@ void bta_gattc_op_cmpl(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
   }
 
   /* service handle change void the response, discard it */
-  if (op == GATTC_OPTYPE_READ)
+  if (is_read_multi)
+    bta_gattc_read_multi_cmpl(p_clcb, &p_data->op_cmpl);
+
+  else if (op == GATTC_OPTYPE_READ)
     bta_gattc_read_cmpl(p_clcb, &p_data->op_cmpl);
 
   else if (op == GATTC_OPTYPE_WRITE)
@@ -452,12 +452,16 @@ void BTA_GATTC_ReadCharDescr(uint16_t conn_id, uint16_t handle,
  *
  * Parameters       conn_id - connectino ID.
  *                    p_read_multi - pointer to the read multiple parameter.
+ *                  variable_len - use the Read Multiple Variable Length
+ *                                 request.
+ *                  callback - called with the raw response value.
  *
  * Returns          None
  *
  ******************************************************************************/
 void BTA_GATTC_ReadMultiple(uint16_t conn_id, tBTA_GATTC_MULTI* p_read_multi,
-                            tGATT_AUTH_REQ auth_req) {
+                            tGATT_AUTH_REQ auth_req, bool variable_len,
+                            GATT_READ_MULTI_OP_CB callback, void* cb_data) {
   tBTA_GATTC_API_READ_MULTI* p_buf =
       (tBTA_GATTC_API_READ_MULTI*)osi_calloc(sizeof(tBTA_GATTC_API_READ_MULTI));
 
@@ -465,6 +469,9 @@ void BTA_GATTC_ReadMultiple(uint16_t conn_id, tBTA_GATTC_MULTI* p_read_multi,
   p_buf->hdr.layer_specific = conn_id;
   p_buf->auth_req = auth_req;
   p_buf->num_attr = p_read_multi->num_attr;
+  p_buf->variable_len = variable_len;
+  p_buf->read_cb = callback;
+  p_buf->read_cb_data = cb_data;
 
   if (p_buf->num_attr > 0)
     memcpy(p_buf->handles, p_read_multi->handles,
@@ -760,3 +767,38 @@ void BTA_GATTC_Refresh(const RawAddress& remote_bda) {
   do_in_main_thread(FROM_HERE,
                     base::Bind(&bta_gattc_process_api_refresh, remote_bda));
 }
+
+/*******************************************************************************
+ *
+ * Function         BTA_GATTC_SetConnectionProfile
+ *
+ * Description      Set the LE connection parameter profile applied to the
+ *                  links used by a client application
+ *
+ * Parameters       client_if: client interface.
+ *                  profile: connection parameter profile.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTA_GATTC_SetConnectionProfile(tGATT_IF client_if,
+                                    tGATT_CONN_PROFILE profile) {
+  do_in_main_thread(FROM_HERE,
+                    base::Bind(&GATT_SetConnectionProfile, client_if, profile));
+}
+
+/*******************************************************************************
+ *
+ * Function         BTA_GATTC_DumpDiscoveryStatistics
+ *
+ * Description      Dump the wall time and strategy of the recent service
+ *                  discoveries of the remote devices
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTA_GATTC_DumpDiscoveryStatistics(int fd) {
+  bta_gattc_dump_discovery_records(fd);
+}
@@ -29,13 +29,17 @@
 #include <base/strings/string_number_conversions.h>
 #include <base/strings/stringprintf.h>
 
+#include <cinttypes>
 #include <cstdint>
 #include <cstdio>
+#include <deque>
+#include <mutex>
 #include <sstream>
 
 #include "bt_target.h"  // Must be first to define build configuration
 #include "bta/gatt/bta_gattc_int.h"
 #include "bta/gatt/database.h"
+#include "common/time_util.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "stack/btm/btm_sec.h"
@@ -60,6 +64,10 @@ const Characteristic* bta_gattc_get_characteristic_srcb(tBTA_GATTC_SERV* p_srcb,
                                                         uint16_t handle);
 static void bta_gattc_explore_srvc_finished(uint16_t conn_id,
                                             tBTA_GATTC_SERV* p_srvc_cb);
+static void bta_gattc_explore_all_characteristics(uint16_t conn_id,
+                                                  tBTA_GATTC_SERV* p_srvc_cb);
+static void bta_gattc_explore_all_descriptors(uint16_t conn_id,
+                                              tBTA_GATTC_SERV* p_srvc_cb);
 
 static void bta_gattc_read_db_hash_cmpl(tBTA_GATTC_CLCB* p_clcb,
                                         const tBTA_GATTC_OP_CMPL* p_data,
@@ -73,6 +81,9 @@ static void bta_gattc_read_ext_prop_desc_cmpl(tBTA_GATTC_CLCB* p_clcb,
 
 #define BTA_GATT_SDP_DB_SIZE 4096
 
+// define the number of discoveries kept for dumpsys
+#define BTA_GATTC_DISCOVERY_RECORDS_MAX 16
+
 /*****************************************************************************
  *  Constants and data types
  ****************************************************************************/
@@ -82,6 +93,19 @@ typedef struct {
   uint16_t sdp_conn_id;
 } tBTA_GATTC_CB_DATA;
 
+typedef struct {
+  RawAddress server_bda;
+  const char* strategy;
+  uint8_t max_procedures;
+  size_t num_services;
+  uint64_t duration_ms;
+  tGATT_STATUS status;
+} tBTA_GATTC_DISCOVERY_RECORD;
+
+/* most recent discoveries first, also read by dumpsys from another thread */
+static std::deque<tBTA_GATTC_DISCOVERY_RECORD> bta_gattc_discovery_records;
+static std::mutex bta_gattc_discovery_records_mutex;
+
 #if (BTA_GATT_DEBUG == TRUE)
 /* utility functions */
 
@@ -110,6 +134,9 @@ static void bta_gattc_display_explore_record(const DatabaseBuilder& database) {
 void bta_gattc_init_cache(tBTA_GATTC_SERV* p_srvc_cb) {
   p_srvc_cb->gatt_database = gatt::Database();
   p_srvc_cb->pending_discovery.Clear();
+  p_srvc_cb->full_range_discovery = false;
+  p_srvc_cb->disc_procedures_pending = 0;
+  p_srvc_cb->disc_max_procedures = 1;
 }
 
 const Service* bta_gattc_find_matching_service(
@@ -268,6 +295,76 @@ descriptor_discovery_done:
   return;
 }
 
+/** Explore all services at once, rather than one by one: discover included
+ * services over the full handle range, then the characteristics and the
+ * descriptors with Read By Type and Find Information procedures running in
+ * parallel on the ATT bearers */
+static void bta_gattc_explore_all_services(uint16_t conn_id,
+                                           tBTA_GATTC_SERV* p_srvc_cb) {
+  if (!p_srvc_cb->pending_discovery.InProgress()) {
+    /* no service found at all */
+    bta_gattc_explore_next_service(conn_id, p_srvc_cb);
+    return;
+  }
+
+  uint8_t bearers = GATTC_GetBearerCount(conn_id);
+  p_srvc_cb->full_range_discovery = true;
+  p_srvc_cb->disc_max_procedures = std::max(bearers, (uint8_t)1);
+  LOG_INFO("Explore all services of conn_id=0x%04x on %d bearers", conn_id,
+           p_srvc_cb->disc_max_procedures);
+
+  /* included services first, as the characteristic discovery needs to know
+   * the secondary services */
+  if (GATTC_Discover(conn_id, GATT_DISC_INC_SRVC, 0x0001, 0xFFFF) ==
+      GATT_SUCCESS) {
+    p_srvc_cb->disc_procedures_pending++;
+    return;
+  }
+
+  bta_gattc_explore_all_characteristics(conn_id, p_srvc_cb);
+}
+
+/** Discover the characteristics of all services, in parallel over ranges of
+ * services */
+static void bta_gattc_explore_all_characteristics(uint16_t conn_id,
+                                                  tBTA_GATTC_SERV* p_srvc_cb) {
+  auto ranges = p_srvc_cb->pending_discovery.StartFullRangeExploration(
+      p_srvc_cb->disc_max_procedures);
+  for (const auto& range : ranges) {
+    if (GATTC_Discover(conn_id, GATT_DISC_CHAR, range.first, range.second) ==
+        GATT_SUCCESS) {
+      p_srvc_cb->disc_procedures_pending++;
+    }
+  }
+
+  if (p_srvc_cb->disc_procedures_pending == 0) {
+    bta_gattc_explore_all_descriptors(conn_id, p_srvc_cb);
+  }
+}
+
+/** Discover the descriptors of all characteristics, keeping up to
+ * disc_max_procedures discoveries running in parallel */
+static void bta_gattc_explore_all_descriptors(uint16_t conn_id,
+                                              tBTA_GATTC_SERV* p_srvc_cb) {
+  while (p_srvc_cb->disc_procedures_pending < p_srvc_cb->disc_max_procedures) {
+    std::pair<uint16_t, uint16_t> range =
+        p_srvc_cb->pending_discovery.NextFullRangeDescriptorRangeToExplore();
+    if (range == DatabaseBuilder::EXPLORE_END) break;
+
+    if (GATTC_Discover(conn_id, GATT_DISC_CHAR_DSCPT, range.first,
+                       range.second) == GATT_SUCCESS) {
+      p_srvc_cb->disc_procedures_pending++;
+    }
+  }
+
+  if (p_srvc_cb->disc_procedures_pending > 0) return;
+
+  /* all characteristics explored, no service is left to explore: read the
+   * extended properties and finish */
+  DVLOG(3) << "all characteristics explored";
+  bta_gattc_explore_next_service(conn_id, p_srvc_cb);
+}
+
 /* Process the discovery result from sdp */
 void bta_gattc_sdp_callback(tSDP_STATUS sdp_status, const void* user_data) {
   tBTA_GATTC_CB_DATA* cb_data = (tBTA_GATTC_CB_DATA*)user_data;
@@ -440,6 +537,17 @@ void bta_gattc_disc_cmpl_cback(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
   tBTA_GATTC_CLCB* p_clcb = bta_gattc_find_clcb_by_conn_id(conn_id);
   tBTA_GATTC_SERV* p_srvc_cb = bta_gattc_find_scb_by_cid(conn_id);
 
+  /* Procedures running in parallel complete in any order: on failure, wait
+   * for the other ones before reporting the first failure */
+  if (p_srvc_cb && p_srvc_cb->disc_procedures_pending > 0) {
+    p_srvc_cb->disc_procedures_pending--;
+    if (p_clcb && p_clcb->status == GATT_SUCCESS) p_clcb->status = status;
+    if (p_clcb && p_clcb->status != GATT_SUCCESS) {
+      if (p_srvc_cb->disc_procedures_pending > 0) return;
+      status = p_clcb->status;
+    }
+  }
+
   if (p_clcb && (status != GATT_SUCCESS || p_clcb->status != GATT_SUCCESS)) {
     if (status == GATT_SUCCESS) p_clcb->status = status;
 
@@ -471,10 +579,14 @@ void bta_gattc_disc_cmpl_cback(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
 #if (BTA_GATT_DEBUG == TRUE)
       bta_gattc_display_explore_record(p_srvc_cb->pending_discovery);
 #endif
-      bta_gattc_explore_next_service(conn_id, p_srvc_cb);
+      bta_gattc_explore_all_services(conn_id, p_srvc_cb);
       break;
 
     case GATT_DISC_INC_SRVC: {
+      if (p_srvc_cb->full_range_discovery) {
+        bta_gattc_explore_all_characteristics(conn_id, p_srvc_cb);
+        break;
+      }
       auto& service = p_srvc_cb->pending_discovery.CurrentlyExploredService();
       /* start discovering characteristic */
       GATTC_Discover(conn_id, GATT_DISC_CHAR, service.first, service.second);
@@ -482,6 +594,15 @@ void bta_gattc_disc_cmpl_cback(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
     }
 
     case GATT_DISC_CHAR: {
+      if (p_srvc_cb->full_range_discovery) {
+        /* wait for the characteristics of all services */
+        if (p_srvc_cb->disc_procedures_pending > 0) break;
+#if (BTA_GATT_DEBUG == TRUE)
+        bta_gattc_display_explore_record(p_srvc_cb->pending_discovery);
+#endif
+        bta_gattc_explore_all_descriptors(conn_id, p_srvc_cb);
+        break;
+      }
 #if (BTA_GATT_DEBUG == TRUE)
       bta_gattc_display_explore_record(p_srvc_cb->pending_discovery);
 #endif
@@ -490,6 +611,10 @@ void bta_gattc_disc_cmpl_cback(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
     }
 
     case GATT_DISC_CHAR_DSCPT:
+      if (p_srvc_cb->full_range_discovery) {
+        bta_gattc_explore_all_descriptors(conn_id, p_srvc_cb);
+        break;
+      }
       /* start discovering next characteristic for char descriptor */
       bta_gattc_start_disc_char_dscp(conn_id, p_srvc_cb);
       break;
@@ -797,6 +922,50 @@ static void bta_gattc_read_ext_prop_desc_cmpl(
   bta_gattc_explore_next_service(p_clcb->bta_conn_id, p_srvc_cb);
 }
 
+/** Record the wall time of the discovery of a server for dumpsys, once it is
+ * completed */
+void bta_gattc_record_discovery(tBTA_GATTC_CLCB* p_clcb) {
+  tBTA_GATTC_SERV* p_srcb = p_clcb->p_srcb;
+  if (p_srcb == nullptr || p_srcb->disc_start_ms == 0) return;
+
+  const char* strategy = "cached";
+  if (p_srcb->full_range_discovery) {
+    strategy = "full range";
+  } else if (p_clcb->disc_active) {
+    strategy = (p_clcb->transport == BT_TRANSPORT_LE) ? "per service" : "sdp";
+  }
+
+  std::lock_guard<std::mutex> lock(bta_gattc_discovery_records_mutex);
+  bta_gattc_discovery_records.push_front(tBTA_GATTC_DISCOVERY_RECORD{
+      .server_bda = p_srcb->server_bda,
+      .strategy = strategy,
+      .max_procedures = p_srcb->disc_max_procedures,
+      .num_services = p_srcb->gatt_database.Services().size(),
+      .duration_ms = bluetooth::common::time_get_os_boottime_ms() -
+                     p_srcb->disc_start_ms,
+      .status = p_clcb->status,
+  });
+  if (bta_gattc_discovery_records.size() > BTA_GATTC_DISCOVERY_RECORDS_MAX) {
+    bta_gattc_discovery_records.pop_back();
+  }
+
+  p_srcb->disc_start_ms = 0;
+}
+
+/** Dump the recent discoveries */
+void bta_gattc_dump_discovery_records(int fd) {
+  std::lock_guard<std::mutex> lock(bta_gattc_discovery_records_mutex);
+  dprintf(fd, "\nBTA GATT Client discoveries (most recent first):\n");
+  for (const auto& record : bta_gattc_discovery_records) {
+    dprintf(fd,
+            "  %s: %s, %zu services, %d bearers, %" PRIu64
+            " ms, status=0x%02x\n",
+            record.server_bda.ToString().c_str(), record.strategy,
+            record.num_services, record.max_procedures, record.duration_ms,
+            record.status);
+  }
+}
+
 /*******************************************************************************
  *
  * Function         bta_gattc_fill_gatt_db_el
@@ -21,7 +21,11 @@
 #include <base/logging.h>
 #include <base/strings/string_number_conversions.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
 
 #include <string>
 #include <vector>
@@ -34,7 +38,10 @@ using std::string;
 using std::vector;
 
 #define GATT_CACHE_PREFIX "/data/misc/bluetooth/gatt_cache_"
-#define GATT_CACHE_VERSION 6
+/* Version 7 stores the compact serialization of gatt::Database, version 6
+ * files, holding an array of StoredAttribute, are still read */
+#define GATT_CACHE_VERSION 7
+#define GATT_CACHE_LEGACY_VERSION 6
 
 #define GATT_HASH_MAX_SIZE 30
 #define GATT_HASH_PATH_PREFIX "/data/misc/bluetooth/gatt_hash_"
@@ -61,11 +68,52 @@ static void bta_gattc_generate_hash_file_name(char* buffer, size_t buffer_len,
 
 static gatt::Database EMPTY_DB;
 
+/* Return true if |fname| exists and holds a database in the current format */
+static bool bta_gattc_hash_file_is_current(const char* fname) {
+  FILE* fd = fopen(fname, "rb");
+  if (!fd) return false;
+  uint16_t cache_ver = 0;
+  bool is_current = fread(&cache_ver, sizeof(uint16_t), 1, fd) == 1 &&
+                    cache_ver == GATT_CACHE_VERSION;
+  fclose(fd);
+  return is_current;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_load_legacy_db
+ *
+ * Description      Load GATT database stored as an array of StoredAttribute.
+ *
+ * Parameter        data, len: file content following the version
+ *
+ * Returns          non-empty GATT database on success, empty GATT database
+ *                  otherwise
+ *
+ ******************************************************************************/
+static gatt::Database bta_gattc_load_legacy_db(const uint8_t* data,
+                                               size_t len) {
+  uint16_t num_attr = 0;
+  if (len < sizeof(uint16_t)) return EMPTY_DB;
+  memcpy(&num_attr, data, sizeof(uint16_t));
+  if (len - sizeof(uint16_t) < num_attr * sizeof(StoredAttribute)) {
+    return EMPTY_DB;
+  }
+
+  std::vector<StoredAttribute> attr(num_attr);
+  memcpy(attr.data(), data + sizeof(uint16_t),
+         num_attr * sizeof(StoredAttribute));
+  bool success = false;
+  gatt::Database result = gatt::Database::Deserialize(attr, &success);
+  return success ? result : EMPTY_DB;
+}
+
 /*******************************************************************************
  *
  * Function         bta_gattc_load_db
  *
- * Description      Load GATT database from storage.
+ * Description      Load GATT database from storage. The file is mapped in
+ *                  memory and the database is built straight from it.
  *
  * Parameter        fname: input file name
  *
@@ -74,49 +122,51 @@ static gatt::Database EMPTY_DB;
  *
  ******************************************************************************/
 static gatt::Database bta_gattc_load_db(const char* fname) {
-  FILE* fd = fopen(fname, "rb");
-  if (!fd) {
+  int fd = open(fname, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
     LOG(ERROR) << __func__ << ": can't open GATT cache file " << fname
                << " for reading, error: " << strerror(errno);
     return EMPTY_DB;
   }
 
-  uint16_t cache_ver = 0;
-  uint16_t num_attr = 0;
-
-  if (fread(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
+  struct stat buf;
+  if (fstat(fd, &buf) == -1 || buf.st_size < (off_t)sizeof(uint16_t)) {
     LOG(ERROR) << __func__ << ": can't read GATT cache version from: " << fname;
-    goto done;
-  }
-
-  if (cache_ver != GATT_CACHE_VERSION) {
-    LOG(ERROR) << __func__ << ": wrong GATT cache version: " << fname;
-    goto done;
+    close(fd);
+    return EMPTY_DB;
   }
 
-  if (fread(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__
-               << ": can't read number of GATT attributes: " << fname;
-    goto done;
+  size_t len = buf.st_size;
+  void* map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    LOG(ERROR) << __func__ << ": can't map GATT cache file " << fname
+               << ", error: " << strerror(errno);
+    return EMPTY_DB;
   }
 
-  {
-    std::vector<StoredAttribute> attr(num_attr);
+  const uint8_t* data = static_cast<const uint8_t*>(map);
+  uint16_t cache_ver = 0;
+  memcpy(&cache_ver, data, sizeof(uint16_t));
+  data += sizeof(uint16_t);
+  len -= sizeof(uint16_t);
 
-    if (fread(attr.data(), sizeof(StoredAttribute), num_attr, fd) != num_attr) {
+  gatt::Database result = EMPTY_DB;
+  if (cache_ver == GATT_CACHE_VERSION) {
+    bool success = false;
+    result = gatt::Database::DeserializeCompact(data, len, &success);
+    if (!success) {
       LOG(ERROR) << __func__ << ": can't read GATT attributes: " << fname;
-      goto done;
+      result.Clear();
     }
-    fclose(fd);
-
-    bool success = false;
-    gatt::Database result = gatt::Database::Deserialize(attr, &success);
-    return success ? result : EMPTY_DB;
+  } else if (cache_ver == GATT_CACHE_LEGACY_VERSION) {
+    result = bta_gattc_load_legacy_db(data, len);
+  } else {
+    LOG(ERROR) << __func__ << ": wrong GATT cache version: " << fname;
   }
 
-done:
-  fclose(fd);
-  return EMPTY_DB;
+  munmap(map, buf.st_size);
+  return result;
 }
 
 /*******************************************************************************
@@ -162,13 +212,13 @@ gatt::Database bta_gattc_hash_load(const Octet16& hash) {
  * Description      Storess GATT db.
  *
  * Parameter        fname: output file name
- *                  attr: attributes to save.
+ *                  database: database to save.
  *
  * Returns          true on success, false otherwise
  *
  ******************************************************************************/
 static bool bta_gattc_store_db(const char* fname,
-                               const std::vector<StoredAttribute>& attr) {
+                               const gatt::Database& database) {
   FILE* fd = fopen(fname, "wb");
   if (!fd) {
     LOG(ERROR) << __func__
@@ -183,15 +233,8 @@ static bool bta_gattc_store_db(const char* fname,
     return false;
   }
 
-  uint16_t num_attr = attr.size();
-  if (fwrite(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__
-               << ": can't write GATT cache attribute count: " << fname;
-    fclose(fd);
-    return false;
-  }
-
-  if (fwrite(attr.data(), sizeof(StoredAttribute), num_attr, fd) != num_attr) {
+  std::vector<uint8_t> blob = database.SerializeCompact();
+  if (fwrite(blob.data(), 1, blob.size(), fd) != blob.size()) {
     LOG(ERROR) << __func__ << ": can't write GATT cache attributes: " << fname;
     fclose(fd);
     return false;
@@ -270,8 +313,16 @@ void bta_gattc_cache_link(const RawAddress& server_bda, const Octet16& hash) {
 bool bta_gattc_hash_write(const Octet16& hash, const gatt::Database& database) {
   char fname[255] = {0};
   bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
+  // The file name is the hash of the content: peers with the same database
+  // share the stored one, only refreshed for the least recently used policy
+  if (bta_gattc_hash_file_is_current(fname)) {
+    if (utimes(fname, nullptr) == -1) {
+      LOG_WARN("can't refresh %s, errno=%d", fname, errno);
+    }
+    return true;
+  }
   bta_gattc_hash_remove_least_recently_used_if_possible();
-  return bta_gattc_store_db(fname, database.Serialize());
+  return bta_gattc_store_db(fname, database);
 }
 
 /*******************************************************************************
@@ -161,6 +161,9 @@ typedef struct {
   tGATT_AUTH_REQ auth_req;
   uint8_t num_attr;
   uint16_t handles[GATT_MAX_READ_MULTI_HANDLES];
+  bool variable_len;
+  GATT_READ_MULTI_OP_CB read_cb;
+  void* read_cb_data;
 } tBTA_GATTC_API_READ_MULTI;
 
 typedef struct {
@@ -225,6 +228,14 @@ typedef struct {
    * Properties */
   bool read_multiple_not_supported;
 
+  /* used only during service discovery: whether all services are explored at
+   * once, and the number of discovery procedures running in parallel on the
+   * ATT bearers, out of at most disc_max_procedures */
+  bool full_range_discovery;
+  uint8_t disc_procedures_pending;
+  uint8_t disc_max_procedures;
+  uint64_t disc_start_ms; /* start of the discovery, for dumpsys */
+
   uint8_t srvc_hdl_chg; /* service handle change indication pending */
   bool srvc_hdl_db_hash;   /* read db hash pending */
   uint8_t srvc_disc_count; /* current discovery retry count */
@@ -499,6 +510,8 @@ extern bool bta_gattc_conn_dealloc(const RawAddress& remote_bda);
 
 /* bta_gattc_cache */
 extern bool bta_gattc_read_db_hash(tBTA_GATTC_CLCB* p_clcb, bool is_svc_chg);
+extern void bta_gattc_record_discovery(tBTA_GATTC_CLCB* p_clcb);
+extern void bta_gattc_dump_discovery_records(int fd);
 
 /* bta_gattc_db_storage */
 extern gatt::Database bta_gattc_hash_load(const Octet16& hash);
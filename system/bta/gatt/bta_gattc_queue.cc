@@ -21,9 +21,14 @@
 #include <unordered_set>
 
 #include "osi/include/allocator.h"
+#include "osi/include/log.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/gatt_api.h"
 
 #include <base/logging.h>
 
+extern bool gatt_profile_get_eatt_support(const RawAddress& remote_bda);
+
 using gatt_operation = BtaGattQueue::gatt_operation;
 
 constexpr uint8_t GATT_READ_CHAR = 1;
@@ -40,6 +45,10 @@ struct gatt_read_op_data {
 std::unordered_map<uint16_t, std::list<gatt_operation>>
     BtaGattQueue::gatt_op_queue;
 std::unordered_set<uint16_t> BtaGattQueue::gatt_op_queue_executing;
+std::unordered_map<uint16_t, uint8_t>
+    BtaGattQueue::gatt_op_queue_pipelined_writes;
+std::unordered_set<uint16_t> BtaGattQueue::gatt_op_queue_congested;
+std::unordered_set<uint16_t> BtaGattQueue::gatt_op_queue_no_read_multi;
 
 void BtaGattQueue::mark_as_not_executing(uint16_t conn_id) {
   gatt_op_queue_executing.erase(conn_id);
@@ -63,6 +72,80 @@ void BtaGattQueue::gatt_read_op_finished(uint16_t conn_id, tGATT_STATUS status,
   }
 }
 
+struct gatt_read_multi_op_data {
+  uint8_t type[GATT_MAX_READ_MULTI_HANDLES];
+  gatt_read_op_data ops[GATT_MAX_READ_MULTI_HANDLES];
+};
+
+void BtaGattQueue::gatt_read_multi_op_finished(uint16_t conn_id,
+                                               tGATT_STATUS status,
+                                               const tBTA_GATTC_MULTI& handles,
+                                               uint16_t len, uint8_t* value,
+                                               void* data) {
+  gatt_read_multi_op_data tmp = *(gatt_read_multi_op_data*)data;
+  osi_free(data);
+
+  /* Split the response into the length prefixed values. The last one is
+   * truncated when the response does not fit in the MTU. */
+  uint16_t value_lens[GATT_MAX_READ_MULTI_HANDLES];
+  uint8_t* values[GATT_MAX_READ_MULTI_HANDLES];
+  uint8_t num_done = 0;
+  if (status == GATT_SUCCESS) {
+    uint8_t* p = value;
+    uint16_t remaining = len;
+    while (num_done < handles.num_attr && remaining >= 2) {
+      uint16_t value_len;
+      STREAM_TO_UINT16(value_len, p);
+      remaining -= 2;
+      if (value_len > remaining) break;
+
+      value_lens[num_done] = value_len;
+      values[num_done] = p;
+      p += value_len;
+      remaining -= value_len;
+      num_done++;
+    }
+  } else {
+    LOG_WARN("Read multiple failed, status=0x%02x, conn_id=0x%04x", status,
+             conn_id);
+    gatt_op_queue_no_read_multi.insert(conn_id);
+  }
+
+  /* Queue the reads of the missing values again, ahead of the other queued
+   * operations. The truncated value is read alone, so that it is read in full.
+   * When the queue was cleaned, just report the status. */
+  auto map_ptr = gatt_op_queue.find(conn_id);
+  bool cleaned = map_ptr == gatt_op_queue.end();
+  if (!cleaned && num_done < handles.num_attr) {
+    for (uint8_t i = handles.num_attr; i-- > num_done;) {
+      map_ptr->second.push_front({.type = tmp.type[i],
+                                  .handle = handles.handles[i],
+                                  .read_cb = tmp.ops[i].cb,
+                                  .read_cb_data = tmp.ops[i].cb_data,
+                                  .no_read_multi = (i == num_done)});
+    }
+  }
+
+  mark_as_not_executing(conn_id);
+  gatt_execute_next_op(conn_id);
+
+  for (uint8_t i = 0; i < num_done; i++) {
+    if (tmp.ops[i].cb) {
+      tmp.ops[i].cb(conn_id, GATT_SUCCESS, handles.handles[i], value_lens[i],
+                    values[i], tmp.ops[i].cb_data);
+    }
+  }
+
+  if (!cleaned) return;
+
+  for (uint8_t i = num_done; i < handles.num_attr; i++) {
+    if (tmp.ops[i].cb) {
+      tmp.ops[i].cb(conn_id, status, handles.handles[i], 0, nullptr,
+                    tmp.ops[i].cb_data);
+    }
+  }
+}
+
 struct gatt_write_op_data {
   GATT_WRITE_OP_CB cb;
   void* cb_data;
@@ -86,6 +169,38 @@ void BtaGattQueue::gatt_write_op_finished(uint16_t conn_id, tGATT_STATUS status,
   }
 }
 
+void BtaGattQueue::gatt_write_no_rsp_op_finished(uint16_t conn_id,
+                                                 tGATT_STATUS status,
+                                                 uint16_t handle, uint16_t len,
+                                                 const uint8_t* value,
+                                                 void* data) {
+  gatt_write_op_data* tmp = (gatt_write_op_data*)data;
+  GATT_WRITE_OP_CB tmp_cb = tmp->cb;
+  void* tmp_cb_data = tmp->cb_data;
+
+  osi_free(data);
+
+  auto writes_ptr = gatt_op_queue_pipelined_writes.find(conn_id);
+  if (writes_ptr != gatt_op_queue_pipelined_writes.end() &&
+      writes_ptr->second > 0) {
+    writes_ptr->second--;
+  }
+
+  /* Stop pipelining while the link is congested */
+  if (status == GATT_CONGESTED) {
+    gatt_op_queue_congested.insert(conn_id);
+  } else {
+    gatt_op_queue_congested.erase(conn_id);
+  }
+
+  gatt_execute_next_op(conn_id);
+
+  if (tmp_cb) {
+    tmp_cb(conn_id, status, handle, len, value, tmp_cb_data);
+    return;
+  }
+}
+
 struct gatt_configure_mtu_op_data {
   GATT_CONFIGURE_MTU_OP_CB cb;
   void* cb_data;
@@ -109,6 +224,47 @@ void BtaGattQueue::gatt_configure_mtu_op_finished(uint16_t conn_id,
   }
 }
 
+bool BtaGattQueue::can_coalesce_reads(uint16_t conn_id) {
+  if (gatt_op_queue_no_read_multi.count(conn_id)) return false;
+
+  /* Read Multiple Variable Length is mandatory for servers supporting EATT */
+  tGATT_IF gatt_if;
+  RawAddress remote_bda;
+  tBT_TRANSPORT transport;
+  if (!GATT_GetConnectionInfor(conn_id, &gatt_if, remote_bda, &transport) ||
+      transport != BT_TRANSPORT_LE) {
+    return false;
+  }
+  return gatt_profile_get_eatt_support(remote_bda);
+}
+
+void BtaGattQueue::gatt_execute_read_multi(
+    uint16_t conn_id, std::list<gatt_operation>& gatt_ops) {
+  tBTA_GATTC_MULTI handles;
+  gatt_read_multi_op_data* data =
+      (gatt_read_multi_op_data*)osi_malloc(sizeof(gatt_read_multi_op_data));
+
+  handles.num_attr = 0;
+  while (!gatt_ops.empty() && handles.num_attr < GATT_MAX_READ_MULTI_HANDLES) {
+    gatt_operation& op = gatt_ops.front();
+    if (op.type != GATT_READ_CHAR && op.type != GATT_READ_DESC) break;
+    if (op.no_read_multi) break;
+
+    handles.handles[handles.num_attr] = op.handle;
+    data->type[handles.num_attr] = op.type;
+    data->ops[handles.num_attr].cb = op.read_cb;
+    data->ops[handles.num_attr].cb_data = op.read_cb_data;
+    handles.num_attr++;
+    gatt_ops.pop_front();
+  }
+
+  APPL_TRACE_DEBUG("%s: conn_id=0x%x, coalesced %d reads", __func__, conn_id,
+                   handles.num_attr);
+  BTA_GATTC_ReadMultiple(conn_id, &handles, GATT_AUTH_REQ_NONE,
+                         true /* variable_len */, gatt_read_multi_op_finished,
+                         data);
+}
+
 void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
   APPL_TRACE_DEBUG("%s: conn_id=0x%x", __func__, conn_id);
   if (gatt_op_queue.empty()) {
@@ -128,12 +284,58 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
     return;
   }
 
-  gatt_op_queue_executing.insert(conn_id);
-
   std::list<gatt_operation>& gatt_ops = map_ptr->second;
 
   gatt_operation& op = gatt_ops.front();
 
+  auto writes_ptr = gatt_op_queue_pipelined_writes.find(conn_id);
+  uint8_t pipelined_writes =
+      writes_ptr == gatt_op_queue_pipelined_writes.end() ? 0
+                                                         : writes_ptr->second;
+
+  /* Writes without response do not wait for the previous ones to complete */
+  if (op.type == GATT_WRITE_CHAR && op.write_type == GATT_WRITE_NO_RSP) {
+    uint8_t max_writes =
+        gatt_op_queue_congested.count(conn_id) ? 1 : kMaxPipelinedWrites;
+    if (pipelined_writes >= max_writes) {
+      APPL_TRACE_DEBUG("%s: can't enqueue next op, %d writes in flight",
+                       __func__, pipelined_writes);
+      return;
+    }
+
+    gatt_op_queue_pipelined_writes[conn_id] = pipelined_writes + 1;
+
+    gatt_write_op_data* data =
+        (gatt_write_op_data*)osi_malloc(sizeof(gatt_write_op_data));
+    data->cb = op.write_cb;
+    data->cb_data = op.write_cb_data;
+    BTA_GATTC_WriteCharValue(conn_id, op.handle, op.write_type,
+                             std::move(op.value), GATT_AUTH_REQ_NONE,
+                             gatt_write_no_rsp_op_finished, data);
+    gatt_ops.pop_front();
+
+    gatt_execute_next_op(conn_id);
+    return;
+  }
+
+  if (pipelined_writes > 0) {
+    APPL_TRACE_DEBUG("%s: can't enqueue next op, waiting for %d writes",
+                     __func__, pipelined_writes);
+    return;
+  }
+
+  gatt_op_queue_executing.insert(conn_id);
+
+  if ((op.type == GATT_READ_CHAR || op.type == GATT_READ_DESC) &&
+      !op.no_read_multi && gatt_ops.size() > 1) {
+    auto next = std::next(gatt_ops.begin());
+    if ((next->type == GATT_READ_CHAR || next->type == GATT_READ_DESC) &&
+        !next->no_read_multi && can_coalesce_reads(conn_id)) {
+      gatt_execute_read_multi(conn_id, gatt_ops);
+      return;
+    }
+  }
+
   if (op.type == GATT_READ_CHAR) {
     gatt_read_op_data* data =
         (gatt_read_op_data*)osi_malloc(sizeof(gatt_read_op_data));
@@ -182,6 +384,9 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
 void BtaGattQueue::Clean(uint16_t conn_id) {
   gatt_op_queue.erase(conn_id);
   gatt_op_queue_executing.erase(conn_id);
+  gatt_op_queue_pipelined_writes.erase(conn_id);
+  gatt_op_queue_congested.erase(conn_id);
+  gatt_op_queue_no_read_multi.erase(conn_id);
 }
 
 void BtaGattQueue::ReadCharacteristic(uint16_t conn_id, uint16_t handle,
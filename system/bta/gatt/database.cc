@@ -213,6 +213,236 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
   return result;
 }
 
+namespace {
+/* Attribute types of the compact serialization */
+enum : uint8_t {
+  COMPACT_PRIMARY_SERVICE = 0,
+  COMPACT_SECONDARY_SERVICE = 1,
+  COMPACT_INCLUDED_SERVICE = 2,
+  COMPACT_CHARACTERISTIC = 3,
+  COMPACT_DESCRIPTOR = 4,
+  COMPACT_EXTENDED_PROPERTIES_DESCRIPTOR = 5,
+};
+
+void AppendUint16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(value & 0xff);
+  out.push_back(value >> 8);
+}
+
+/* UUIDs are prefixed by their size, 2 or 16 bytes, little endian */
+void AppendUuid(std::vector<uint8_t>& out, const Uuid& uuid) {
+  if (UuidSize(uuid) == Uuid::kNumBytes16) {
+    out.push_back(Uuid::kNumBytes16);
+    AppendUint16(out, uuid.As16Bit());
+  } else {
+    out.push_back(Uuid::kNumBytes128);
+    auto le = uuid.To128BitLE();
+    out.insert(out.end(), le.begin(), le.end());
+  }
+}
+
+/* Bounds checked reads of a compact blob; once a read fails, all do */
+class CompactReader {
+ public:
+  CompactReader(const uint8_t* data, size_t len)
+      : p_(data), end_(data + len) {}
+
+  bool AtEnd() const { return p_ == end_; }
+
+  bool ReadUint8(uint8_t* value) {
+    if (end_ - p_ < 1) return Fail();
+    *value = *p_++;
+    return true;
+  }
+
+  bool ReadUint16(uint16_t* value) {
+    if (end_ - p_ < 2) return Fail();
+    *value = p_[0] | (p_[1] << 8);
+    p_ += 2;
+    return true;
+  }
+
+  bool ReadUuid(Uuid* uuid) {
+    uint8_t size;
+    if (!ReadUint8(&size)) return false;
+    if (size == Uuid::kNumBytes16) {
+      uint16_t uuid16;
+      if (!ReadUint16(&uuid16)) return false;
+      *uuid = Uuid::From16Bit(uuid16);
+      return true;
+    }
+    if (size != Uuid::kNumBytes128 || end_ - p_ < (int)Uuid::kNumBytes128) {
+      return Fail();
+    }
+    *uuid = Uuid::From128BitLE(p_);
+    p_ += Uuid::kNumBytes128;
+    return true;
+  }
+
+ private:
+  bool Fail() {
+    p_ = end_;
+    return false;
+  }
+
+  const uint8_t* p_;
+  const uint8_t* end_;
+};
+}  // namespace
+
+std::vector<uint8_t> Database::SerializeCompact() const {
+  std::vector<uint8_t> out;
+
+  /* Services come first so that included services can refer to any of them,
+   * then the attributes of each service in handle order. Both are counted so
+   * that a truncated blob is never taken for a smaller database. */
+  uint16_t attribute_count = 0;
+  for (const Service& service : services) {
+    attribute_count += service.included_services.size();
+    for (const Characteristic& charac : service.characteristics) {
+      attribute_count += 1 + charac.descriptors.size();
+    }
+  }
+  AppendUint16(out, services.size());
+  AppendUint16(out, attribute_count);
+  for (const Service& service : services) {
+    out.push_back(service.is_primary ? COMPACT_PRIMARY_SERVICE
+                                     : COMPACT_SECONDARY_SERVICE);
+    AppendUint16(out, service.handle);
+    AppendUint16(out, service.end_handle);
+    AppendUuid(out, service.uuid);
+  }
+
+  for (const Service& service : services) {
+    for (const IncludedService& p_isvc : service.included_services) {
+      out.push_back(COMPACT_INCLUDED_SERVICE);
+      AppendUint16(out, p_isvc.handle);
+      AppendUint16(out, p_isvc.start_handle);
+      AppendUint16(out, p_isvc.end_handle);
+      AppendUuid(out, p_isvc.uuid);
+    }
+
+    for (const Characteristic& charac : service.characteristics) {
+      out.push_back(COMPACT_CHARACTERISTIC);
+      AppendUint16(out, charac.declaration_handle);
+      out.push_back(charac.properties);
+      AppendUint16(out, charac.value_handle);
+      AppendUuid(out, charac.uuid);
+
+      for (const Descriptor& desc : charac.descriptors) {
+        if (desc.uuid == CHARACTERISTIC_EXTENDED_PROPERTIES) {
+          out.push_back(COMPACT_EXTENDED_PROPERTIES_DESCRIPTOR);
+          AppendUint16(out, desc.handle);
+          AppendUint16(out, desc.characteristic_extended_properties);
+        } else {
+          out.push_back(COMPACT_DESCRIPTOR);
+          AppendUint16(out, desc.handle);
+          AppendUuid(out, desc.uuid);
+        }
+      }
+    }
+  }
+
+  return out;
+}
+
+Database Database::DeserializeCompact(const uint8_t* data, size_t len,
+                                      bool* success) {
+  Database result;
+  CompactReader reader(data, len);
+  *success = false;
+
+  uint16_t service_count;
+  uint16_t attribute_count;
+  if (!reader.ReadUint16(&service_count) ||
+      !reader.ReadUint16(&attribute_count)) {
+    return result;
+  }
+  for (uint16_t i = 0; i < service_count; i++) {
+    uint8_t type;
+    Service service{};
+    if (!reader.ReadUint8(&type) || !reader.ReadUint16(&service.handle) ||
+        !reader.ReadUint16(&service.end_handle) ||
+        !reader.ReadUuid(&service.uuid)) {
+      LOG(ERROR) << __func__ << ": truncated service";
+      return result;
+    }
+    if (type != COMPACT_PRIMARY_SERVICE && type != COMPACT_SECONDARY_SERVICE) {
+      LOG(ERROR) << __func__ << ": unexpected attribute type " << +type;
+      return result;
+    }
+    service.is_primary = (type == COMPACT_PRIMARY_SERVICE);
+    result.services.push_back(std::move(service));
+  }
+
+  auto current_service_it = result.services.begin();
+  for (uint16_t i = 0; i < attribute_count; i++) {
+    uint8_t type;
+    uint16_t handle;
+    if (!reader.ReadUint8(&type) || !reader.ReadUint16(&handle)) {
+      LOG(ERROR) << __func__ << ": truncated attribute";
+      return result;
+    }
+
+    // attributes are stored in handle order, as in Deserialize
+    while (current_service_it != result.services.end() &&
+           current_service_it->end_handle < handle) {
+      current_service_it++;
+    }
+    if (current_service_it == result.services.end() ||
+        !HandleInRange(*current_service_it, handle)) {
+      LOG(ERROR) << "Can't find service for attribute with handle: "
+                 << loghex(handle);
+      return result;
+    }
+
+    bool read = false;
+    if (type == COMPACT_INCLUDED_SERVICE) {
+      IncludedService included{.handle = handle};
+      read = reader.ReadUint16(&included.start_handle) &&
+             reader.ReadUint16(&included.end_handle) &&
+             reader.ReadUuid(&included.uuid);
+      if (read && !FindService(result.services, included.start_handle)) {
+        LOG(ERROR) << __func__ << ": Non-existing included service!";
+        return result;
+      }
+      current_service_it->included_services.push_back(included);
+    } else if (type == COMPACT_CHARACTERISTIC) {
+      Characteristic charac{.declaration_handle = handle};
+      read = reader.ReadUint8(&charac.properties) &&
+             reader.ReadUint16(&charac.value_handle) &&
+             reader.ReadUuid(&charac.uuid);
+      current_service_it->characteristics.push_back(std::move(charac));
+    } else if (type == COMPACT_DESCRIPTOR ||
+               type == COMPACT_EXTENDED_PROPERTIES_DESCRIPTOR) {
+      if (current_service_it->characteristics.empty()) {
+        LOG(ERROR) << __func__ << ": descriptor without characteristic";
+        return result;
+      }
+      Descriptor desc{.handle = handle};
+      if (type == COMPACT_EXTENDED_PROPERTIES_DESCRIPTOR) {
+        desc.uuid = CHARACTERISTIC_EXTENDED_PROPERTIES;
+        read = reader.ReadUint16(&desc.characteristic_extended_properties);
+      } else {
+        read = reader.ReadUuid(&desc.uuid);
+      }
+      current_service_it->characteristics.back().descriptors.push_back(desc);
+    }
+    if (!read) {
+      LOG(ERROR) << __func__ << ": malformed attribute with handle: "
+                 << loghex(handle);
+      return result;
+    }
+  }
+
+  if (!reader.AtEnd()) {
+    LOG(ERROR) << __func__ << ": unexpected data after attributes";
+    return result;
+  }
+  *success = true;
+  return result;
+}
+
 Octet16 Database::Hash() const {
   int len = 0;
   // Compute how much space we need to actually hold the data.
@@ -304,8 +534,9 @@ Octet16 Database::Hash() const {
     }
   }
 
+  /* The database hash key is all zeros, its key schedule is kept */
+  static const crypto_toolbox::AesCmacKey db_hash_key(Octet16{0});
   std::reverse(serialized.begin(), serialized.end());
-  return crypto_toolbox::aes_cmac(Octet16{0}, serialized.data(),
-                                  serialized.size());
+  return db_hash_key.Cmac(serialized.data(), serialized.size());
 }
 }  // namespace gatt
@@ -119,6 +119,15 @@ class Database {
   static Database Deserialize(const std::vector<gatt::StoredAttribute>& nv_attr,
                               bool* success);
 
+  /* Serialize into a compact binary blob, where 16-bit UUIDs take 2 bytes
+   * instead of 16 and each attribute only stores the fields of its type. */
+  std::vector<uint8_t> SerializeCompact() const;
+
+  /* Build the database straight from a blob made by SerializeCompact, e.g.
+   * mapped from a file, without an intermediate attribute vector. */
+  static Database DeserializeCompact(const uint8_t* data, size_t len,
+                                     bool* success);
+
   /* Return 128 bit unique identifier of this GATT database */
   Octet16 Hash() const;
 
@@ -161,14 +161,10 @@ DatabaseBuilder::CurrentlyExploredService() {
   return pending_service;
 }
 
-std::pair<uint16_t, uint16_t> DatabaseBuilder::NextDescriptorRangeToExplore() {
-  Service* service = FindService(database.services, pending_service.first);
-  if (!service || service->characteristics.empty()) {
-    return {HANDLE_MAX, HANDLE_MAX};
-  }
-
-  for (auto it = service->characteristics.cbegin();
-       it != service->characteristics.cend(); it++) {
+std::pair<uint16_t, uint16_t> DatabaseBuilder::NextDescriptorRangeInService(
+    const Service& service) {
+  for (auto it = service.characteristics.cbegin();
+       it != service.characteristics.cend(); it++) {
     if (it->declaration_handle > pending_characteristic) {
       auto next = std::next(it);
 
@@ -177,10 +173,10 @@ std::pair<uint16_t, uint16_t> DatabaseBuilder::NextDescriptorRangeToExplore() {
        * Part G 3.3.2 and 3.3.3 */
       uint16_t start = it->declaration_handle + 2;
       uint16_t end;
-      if (next != service->characteristics.end())
+      if (next != service.characteristics.end())
         end = next->declaration_handle - 1;
       else
-        end = service->end_handle;
+        end = service.end_handle;
 
       // No place for descriptor - skip to next characteristic
       if (start > end) continue;
@@ -190,8 +186,52 @@ std::pair<uint16_t, uint16_t> DatabaseBuilder::NextDescriptorRangeToExplore() {
     }
   }
 
+  return EXPLORE_END;
+}
+
+std::pair<uint16_t, uint16_t> DatabaseBuilder::NextDescriptorRangeToExplore() {
+  Service* service = FindService(database.services, pending_service.first);
+  if (!service || service->characteristics.empty()) {
+    return {HANDLE_MAX, HANDLE_MAX};
+  }
+
+  auto range = NextDescriptorRangeInService(*service);
+  if (range == EXPLORE_END) pending_characteristic = HANDLE_MAX;
+  return range;
+}
+
+std::vector<std::pair<uint16_t, uint16_t>>
+DatabaseBuilder::StartFullRangeExploration(size_t count) {
+  services_to_discover.clear();
+  pending_service = {HANDLE_MIN, HANDLE_MAX};
+  pending_characteristic = HANDLE_MIN;
+
+  std::vector<std::pair<uint16_t, uint16_t>> ranges;
+  if (database.services.empty() || count == 0) return ranges;
+
+  size_t services_per_range = (database.services.size() + count - 1) / count;
+  size_t i = 0;
+  for (const Service& service : database.services) {
+    if (i++ % services_per_range == 0) {
+      ranges.emplace_back(service.handle, service.end_handle);
+    } else {
+      ranges.back().second = service.end_handle;
+    }
+  }
+  return ranges;
+}
+
+std::pair<uint16_t, uint16_t>
+DatabaseBuilder::NextFullRangeDescriptorRangeToExplore() {
+  for (const Service& service : database.services) {
+    if (service.end_handle <= pending_characteristic) continue;
+
+    auto range = NextDescriptorRangeInService(service);
+    if (range != EXPLORE_END) return range;
+  }
+
   pending_characteristic = HANDLE_MAX;
-  return {HANDLE_MAX, HANDLE_MAX};
+  return EXPLORE_END;
 }
 
 Descriptor* FindDescriptorByHandle(std::list<Service>& services,
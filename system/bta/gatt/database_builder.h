@@ -51,6 +51,19 @@ class DatabaseBuilder {
    */
   std::pair<uint16_t, uint16_t> NextDescriptorRangeToExplore();
 
+  /* Start the exploration of all services at once, instead of one by one.
+   * Return the handle range of all services, split into at most |count|
+   * ranges made of whole services, whose characteristics can be discovered in
+   * parallel. */
+  std::vector<std::pair<uint16_t, uint16_t>> StartFullRangeExploration(
+      size_t count);
+
+  /* Return pair with start and end handle of the descriptor range to discover
+   * in any service, or DatabaseBuilder::EXPLORE_END if no more descriptors
+   * left. Used after |StartFullRangeExploration()|.
+   */
+  std::pair<uint16_t, uint16_t> NextFullRangeDescriptorRangeToExplore();
+
   /* Return vector of "Characteristic Extended Properties" descriptors that must
    * be read as part of service discovery process */
   std::vector<uint16_t> DescriptorHandlesToRead() {
@@ -80,6 +93,11 @@ class DatabaseBuilder {
   std::string ToString() const;
 
  private:
+  /* Return the descriptor range of the first characteristic of |service|
+   * after pending_characteristic, or EXPLORE_END */
+  std::pair<uint16_t, uint16_t> NextDescriptorRangeInService(
+      const Service& service);
+
   Database database;
   /* Start and end handle of service that is currently being discovered on the
    * remote device */
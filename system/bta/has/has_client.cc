@@ -404,6 +404,10 @@ class HasClientImpl : public HasClient {
     UpdateJournalOpEntryStatus(*device, context, status);
 
     auto op_opt = ExtractPendingCtpOp(context.ctp_op_id);
+    if (op_opt.has_value() && IsActivePresetSelection(op_opt->opcode)) {
+      OnActivePresetSelectionWritten(op_opt->addr_or_group,
+                                     status == GATT_SUCCESS);
+    }
     if (status == GATT_SUCCESS) return;
 
     /* This could be one of the coordinated group preset change request */
@@ -503,6 +507,9 @@ class HasClientImpl : public HasClient {
 
     /* Write to control point */
     EnqueueCtpOp(operation);
+    if (IsActivePresetSelection(operation.opcode)) {
+      preset_selections_[operation.addr_or_group].writes_in_flight++;
+    }
     BtaGattQueue::WriteCharacteristic(
         device.conn_id, device.cp_handle, operation.ToCharacteristicValue(),
         GATT_WRITE,
@@ -800,10 +807,40 @@ class HasClientImpl : public HasClient {
     return false;
   }
 
+  static bool IsActivePresetSelection(PresetCtpOpcode opcode) {
+    return opcode == PresetCtpOpcode::SET_ACTIVE_PRESET ||
+           opcode == PresetCtpOpcode::SET_ACTIVE_PRESET_SYNC;
+  }
+
+  /* Send the latest selection made while the previous one was written, once
+   * all the writes of the previous one completed. */
+  void OnActivePresetSelectionWritten(
+      std::variant<RawAddress, int> addr_or_group_id, bool success) {
+    auto selection = preset_selections_.find(addr_or_group_id);
+    if (selection == preset_selections_.end()) return;
+    if (--selection->second.writes_in_flight > 0) return;
+
+    auto deferred_index = selection->second.deferred_index;
+    preset_selections_.erase(selection);
+    if (success && deferred_index.has_value()) {
+      SelectActivePreset(addr_or_group_id, deferred_index.value());
+    }
+  }
+
   void SelectActivePreset(std::variant<RawAddress, int> addr_or_group_id,
                           uint8_t preset_index) override {
     DLOG(INFO) << __func__;
 
+    /* Coalesce the selections made while one is being written, e.g. when
+     * scrolling through the presets, so that only the latest is sent. */
+    auto selection = preset_selections_.find(addr_or_group_id);
+    if (selection != preset_selections_.end() &&
+        selection->second.writes_in_flight > 0) {
+      DLOG(INFO) << __func__ << " deferred preset idx: " << +preset_index;
+      selection->second.deferred_index = preset_index;
+      return;
+    }
+
     auto opcode = shouldRequestSyncedOp(addr_or_group_id,
                                         PresetCtpOpcode::SET_ACTIVE_PRESET_SYNC)
                       ? PresetCtpOpcode::SET_ACTIVE_PRESET_SYNC
@@ -892,6 +929,7 @@ class HasClientImpl : public HasClient {
 
     devices_.clear();
     pending_operations_.clear();
+    preset_selections_.clear();
   }
 
   void Dump(int fd) const {
@@ -1588,6 +1626,18 @@ class HasClientImpl : public HasClient {
             }),
         pending_operations_.end());
 
+    /* The writes of the device will not complete. The group selections are
+     * dropped too, as they need all the group members. */
+    for (auto it = preset_selections_.begin();
+         it != preset_selections_.end();) {
+      if (std::holds_alternative<int>(it->first) ||
+          std::get<RawAddress>(it->first) == addr) {
+        it = preset_selections_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
     device.ConnectionCleanUp();
   }
 
@@ -2076,6 +2126,14 @@ class HasClientImpl : public HasClient {
   std::list<HasDevice> devices_;
   std::list<HasCtpOp> pending_operations_;
 
+  /* Active preset selection writes in flight, and the latest selection made
+   * meanwhile, per device or group */
+  struct PresetSelection {
+    int writes_in_flight = 0;
+    std::optional<uint8_t> deferred_index;
+  };
+  std::map<std::variant<RawAddress, int>, PresetSelection> preset_selections_;
+
   typedef std::map<decltype(HasCtpOp::op_id), HasCtpGroupOpCoordinator>
       has_operation_timeouts_t;
   has_operation_timeouts_t pending_group_operation_timeouts_;
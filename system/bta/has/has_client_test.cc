@@ -2312,6 +2312,48 @@ TEST_F(HasClientTest, test_select_preset_valid) {
   ASSERT_EQ(preset_details.back().preset_index, new_active_preset_index);
 }
 
+TEST_F(HasClientTest, test_select_preset_coalesced) {
+  const RawAddress test_address = GetTestAddress(1);
+  uint16_t test_conn_id = GetTestConnId(test_address);
+
+  std::set<HasPreset, HasPreset::ComparatorDesc> presets = {{
+      HasPreset(1, HasPreset::kPropertyAvailable, "Universal"),
+      HasPreset(2, HasPreset::kPropertyAvailable, "Preset2"),
+      HasPreset(3, HasPreset::kPropertyAvailable, "Preset3"),
+  }};
+  SetSampleDatabaseHasPresetsNtf(
+      test_address, bluetooth::has::kFeatureBitHearingAidTypeBanded, presets);
+  TestConnect(test_address);
+
+  /* Hold the control point write responses */
+  std::vector<std::vector<uint8_t>> written_values;
+  GATT_WRITE_OP_CB write_cb = nullptr;
+  void* write_cb_data = nullptr;
+  EXPECT_CALL(gatt_queue,
+              WriteCharacteristic(test_conn_id, HasDbBuilder::kPresetsCtpValHdl,
+                                  _, GATT_WRITE, _, _))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([&](uint16_t conn_id, uint16_t handle,
+                     std::vector<uint8_t> value, tGATT_WRITE_TYPE write_type,
+                     GATT_WRITE_OP_CB cb, void* cb_data) {
+            written_values.push_back(value);
+            write_cb = cb;
+            write_cb_data = cb_data;
+          }));
+
+  HasClient::Get()->SelectActivePreset(test_address, 1);
+  HasClient::Get()->SelectActivePreset(test_address, 2);
+  HasClient::Get()->SelectActivePreset(test_address, 3);
+  ASSERT_EQ(1u, written_values.size());
+
+  /* Only the latest selection is written once the first write completes */
+  write_cb(test_conn_id, GATT_SUCCESS, HasDbBuilder::kPresetsCtpValHdl, 0,
+           nullptr, write_cb_data);
+  ASSERT_EQ(2u, written_values.size());
+  ASSERT_EQ(3, written_values.back().back());
+}
+
 TEST_F(HasClientTest, test_select_group_preset_invalid_group) {
   const RawAddress test_address1 = GetTestAddress(1);
   SetSampleDatabaseHasPresetsNtf(test_address1);
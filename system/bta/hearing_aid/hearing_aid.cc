@@ -1237,6 +1237,12 @@ class HearingAidImpl : public HearingAid {
     return diff_credit < (init_credit / 2 - 1);
   }
 
+  /* Return true if the peer has no LE CoC credit left for the device */
+  bool IsStarved(HearingDevice* device) {
+    return L2CA_GetPeerLECocCredit(
+               device->address, GAP_ConnGetL2CAPCid(device->gap_handle)) == 0;
+  }
+
   void OnAudioDataReady(const std::vector<uint8_t>& data) {
     /* For now we assume data comes in as 16bit per sample 16kHz PCM stereo */
     bool need_drop = false;
@@ -1266,53 +1272,20 @@ class HearingAidImpl : public HearingAid {
       return;
     }
 
-    std::vector<uint16_t> chan_left;
-    std::vector<uint16_t> chan_right;
-    if (left == nullptr || right == nullptr) {
-      for (int i = 0; i < num_samples; i++) {
-        const uint8_t* sample = data.data() + i * 4;
-
-        int16_t left = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-
-        sample += 2;
-        int16_t right = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-
-        uint16_t mono_data = (int16_t)(((uint32_t)left + (uint32_t)right) >> 1);
-        chan_left.push_back(mono_data);
-        chan_right.push_back(mono_data);
-      }
-    } else {
-      for (int i = 0; i < num_samples; i++) {
-        const uint8_t* sample = data.data() + i * 4;
-
-        uint16_t left = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_left.push_back(left);
-
-        sample += 2;
-        uint16_t right = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_right.push_back(right);
-      }
-    }
-
-    // TODO: monural, binarual check
-
-    // divide encoded data into packets, add header, send.
+    // A side which had to be flushed and has no credit left would only queue
+    // packets to be flushed at the next frame: its packets are not built.
+    bool skip_left = false;
+    bool skip_right = false;
 
-    // TODO: make those buffers static and global to prevent constant
-    // reallocations
-    // TODO: this should basically fit the encoded data, tune the size later
-    std::vector<uint8_t> encoded_data_left;
+    // The flush or drop decision of each side doesn't depend on the encoded
+    // data, so it is made first, and the audio encoded straight into the L2CAP
+    // buffers.
     if (left) {
-      // TODO: instead of a magic number, we need to figure out the correct
-      // buffer size
-      encoded_data_left.resize(4000);
-      int encoded_size =
-          g722_encode(encoder_state_left, encoded_data_left.data(),
-                      (const int16_t*)chan_left.data(), chan_left.size());
-      encoded_data_left.resize(encoded_size);
-
       uint16_t cid = GAP_ConnGetL2CAPCid(left->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
+      left->audio_stats.max_queued_packets =
+          std::max(left->audio_stats.max_queued_packets,
+                   (size_t)packets_in_chans);
       if (packets_in_chans) {
         // Compare the two sides LE CoC credit value to confirm need to drop or
         // skip audio packet.
@@ -1329,24 +1302,19 @@ class HearingAidImpl : public HearingAid {
           left->audio_stats.packet_flush_count += packets_in_chans;
           left->audio_stats.frame_flush_count++;
           L2CA_FlushChannel(cid, 0xffff);
+          skip_left = IsStarved(left);
         }
         hearingDevices.StartRssiLog();
       }
       check_and_do_rssi_read(left);
     }
 
-    std::vector<uint8_t> encoded_data_right;
     if (right) {
-      // TODO: instead of a magic number, we need to figure out the correct
-      // buffer size
-      encoded_data_right.resize(4000);
-      int encoded_size =
-          g722_encode(encoder_state_right, encoded_data_right.data(),
-                      (const int16_t*)chan_right.data(), chan_right.size());
-      encoded_data_right.resize(encoded_size);
-
       uint16_t cid = GAP_ConnGetL2CAPCid(right->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
+      right->audio_stats.max_queued_packets =
+          std::max(right->audio_stats.max_queued_packets,
+                   (size_t)packets_in_chans);
       if (packets_in_chans) {
         // Compare the two sides LE CoC credit value to confirm need to drop or
         // skip audio packet.
@@ -1363,19 +1331,25 @@ class HearingAidImpl : public HearingAid {
           right->audio_stats.packet_flush_count += packets_in_chans;
           right->audio_stats.frame_flush_count++;
           L2CA_FlushChannel(cid, 0xffff);
+          skip_right = IsStarved(right);
         }
         hearingDevices.StartRssiLog();
       }
       check_and_do_rssi_read(right);
     }
 
-    size_t encoded_data_size =
-        std::max(encoded_data_left.size(), encoded_data_right.size());
-
-    uint16_t packet_size =
-        CalcCompressedAudioPacketSize(codec_in_use, default_data_interval_ms);
+    // Both channels are encoded in one pass over the interleaved samples, with
+    // the mono mix sent to a single device.
+    g722_encode_state_t* state_left = left ? encoder_state_left : nullptr;
+    g722_encode_state_t* state_right = right ? encoder_state_right : nullptr;
+    const int16_t* pcm = (const int16_t*)data.data();
 
     if (need_drop) {
+      // The encoders still have to follow the audio stream
+      std::vector<uint8_t> dropped(num_samples);
+      g722_encode_stereo(state_left, state_right, dropped.data(),
+                         dropped.data() + num_samples / 2, pcm, num_samples,
+                         1);
       if (left) {
         left->audio_stats.packet_drop_count++;
       }
@@ -1385,14 +1359,56 @@ class HearingAidImpl : public HearingAid {
       return;
     }
 
-    for (size_t i = 0; i < encoded_data_size; i += packet_size) {
-      if (left) {
+    uint16_t packet_size =
+        CalcCompressedAudioPacketSize(codec_in_use, default_data_interval_ms);
+    // G.722 encodes two samples in each byte
+    int packet_samples = 2 * packet_size;
+
+    // The encoder of a skipped side still has to follow the audio stream
+    std::vector<uint8_t> skipped;
+    if (skip_left || skip_right) skipped.resize(packet_size);
+
+    for (int i = 0; i < num_samples; i += packet_samples) {
+      int samples = std::min(packet_samples, num_samples - i);
+      BT_HDR* packet_left = nullptr;
+      BT_HDR* packet_right = nullptr;
+      uint8_t* p_left = nullptr;
+      uint8_t* p_right = nullptr;
+      if (left && skip_left) {
+        p_left = skipped.data();
+      } else if (left) {
+        packet_left = malloc_l2cap_buf(packet_size + 1);
+        p_left = get_l2cap_sdu_start_ptr(packet_left);
+        *p_left++ = seq_counter;
+      }
+      if (right && skip_right) {
+        p_right = skipped.data();
+      } else if (right) {
+        packet_right = malloc_l2cap_buf(packet_size + 1);
+        p_right = get_l2cap_sdu_start_ptr(packet_right);
+        *p_right++ = seq_counter;
+      }
+
+      int encoded_size = g722_encode_stereo(state_left, state_right, p_left,
+                                            p_right, pcm + 2 * i, samples, 1);
+      // The last packet of the frame is padded with silence
+      if (encoded_size < packet_size) {
+        size_t padding = packet_size - encoded_size;
+        if (p_left) memset(p_left + encoded_size, 0, padding);
+        if (p_right) memset(p_right + encoded_size, 0, padding);
+      }
+
+      if (packet_left) {
         left->audio_stats.packet_send_count++;
-        SendAudio(encoded_data_left.data() + i, packet_size, left);
+        SendAudio(packet_left, left);
+      } else if (left) {
+        left->audio_stats.packet_skip_count++;
       }
-      if (right) {
+      if (packet_right) {
         right->audio_stats.packet_send_count++;
-        SendAudio(encoded_data_right.data() + i, packet_size, right);
+        SendAudio(packet_right, right);
+      } else if (right) {
+        right->audio_stats.packet_skip_count++;
       }
       seq_counter++;
     }
@@ -1400,23 +1416,18 @@ class HearingAidImpl : public HearingAid {
     if (right) right->audio_stats.frame_send_count++;
   }
 
-  void SendAudio(uint8_t* encoded_data, uint16_t packet_size,
-                 HearingDevice* hearingAid) {
+  void SendAudio(BT_HDR* audio_packet, HearingDevice* hearingAid) {
     if (!hearingAid->playback_started || !hearingAid->command_acked) {
       LOG_DEBUG("Playback stalled, device=%s,cmd send=%i, cmd acked=%i",
                 hearingAid->address.ToStringForLogging().c_str(),
                 hearingAid->playback_started, hearingAid->command_acked);
+      osi_free(audio_packet);
       return;
     }
 
-    BT_HDR* audio_packet = malloc_l2cap_buf(packet_size + 1);
-    uint8_t* p = get_l2cap_sdu_start_ptr(audio_packet);
-    *p = seq_counter;
-    p++;
-    memcpy(p, encoded_data, packet_size);
-
+    uint8_t* p = get_l2cap_sdu_start_ptr(audio_packet) + 1;
     LOG_DEBUG("%s : %s", hearingAid->address.ToStringForLogging().c_str(),
-              base::HexEncode(p, packet_size).c_str());
+              base::HexEncode(p, audio_packet->len - 1).c_str());
 
     uint16_t result = GAP_ConnWriteData(hearingAid->gap_handle, audio_packet);
 
@@ -1579,9 +1590,12 @@ class HearingAidImpl : public HearingAid {
           << device.audio_stats.trigger_drop_count
           << "\n    Packet dropped counts                                  : "
           << device.audio_stats.packet_drop_count
-          << "\n    Packet counts (send/flush)                             : "
+          << "\n    Packet counts (send/flush/skip)                        : "
           << device.audio_stats.packet_send_count << " / "
-          << device.audio_stats.packet_flush_count
+          << device.audio_stats.packet_flush_count << " / "
+          << device.audio_stats.packet_skip_count
+          << "\n    Max queued packets                                     : "
+          << device.audio_stats.max_queued_packets
           << "\n    Frame counts (sent/flush)                              : "
           << device.audio_stats.frame_send_count << " / "
           << device.audio_stats.frame_flush_count << std::endl;
@@ -1560,26 +1560,57 @@ static char* bta_hf_client_process_unknown(tBTA_HF_CLIENT_CB* client_cb,
  */
 typedef char* (*tBTA_HF_CLIENT_PARSER_CALLBACK)(tBTA_HF_CLIENT_CB*, char*);
 
-static const tBTA_HF_CLIENT_PARSER_CALLBACK bta_hf_client_parser_cb[] = {
-    bta_hf_client_parse_ok,        bta_hf_client_parse_error,
-    bta_hf_client_parse_ring,      bta_hf_client_parse_brsf,
-    bta_hf_client_parse_cind,      bta_hf_client_parse_ciev,
-    bta_hf_client_parse_chld,      bta_hf_client_parse_bcs,
-    bta_hf_client_parse_bsir,      bta_hf_client_parse_cmeerror,
-    bta_hf_client_parse_vgm,       bta_hf_client_parse_vgme,
-    bta_hf_client_parse_vgs,       bta_hf_client_parse_vgse,
-    bta_hf_client_parse_bvra,      bta_hf_client_parse_clip,
-    bta_hf_client_parse_ccwa,      bta_hf_client_parse_cops,
-    bta_hf_client_parse_binp,      bta_hf_client_parse_clcc,
-    bta_hf_client_parse_cnum,      bta_hf_client_parse_btrh,
-    bta_hf_client_parse_bind,      bta_hf_client_parse_busy,
-    bta_hf_client_parse_delayed,   bta_hf_client_parse_no_carrier,
-    bta_hf_client_parse_no_answer, bta_hf_client_parse_rejectlisted,
-    bta_hf_client_process_unknown};
+typedef struct {
+  /* Event matched by the parser, as in its AT_CHECK_EVENT. NULL for the
+   * parser of unknown events. */
+  const char* event;
+  tBTA_HF_CLIENT_PARSER_CALLBACK parse;
+} tBTA_HF_CLIENT_PARSER;
+
+static const tBTA_HF_CLIENT_PARSER bta_hf_client_parser[] = {
+    {"OK", bta_hf_client_parse_ok},
+    {"ERROR", bta_hf_client_parse_error},
+    {"RING", bta_hf_client_parse_ring},
+    {"+BRSF:", bta_hf_client_parse_brsf},
+    {"+CIND:", bta_hf_client_parse_cind},
+    {"+CIEV:", bta_hf_client_parse_ciev},
+    {"+CHLD:", bta_hf_client_parse_chld},
+    {"+BCS:", bta_hf_client_parse_bcs},
+    {"+BSIR:", bta_hf_client_parse_bsir},
+    {"+CME ERROR:", bta_hf_client_parse_cmeerror},
+    {"+VGM:", bta_hf_client_parse_vgm},
+    {"+VGM=", bta_hf_client_parse_vgme},
+    {"+VGS:", bta_hf_client_parse_vgs},
+    {"+VGS=", bta_hf_client_parse_vgse},
+    {"+BVRA:", bta_hf_client_parse_bvra},
+    {"+CLIP:", bta_hf_client_parse_clip},
+    {"+CCWA:", bta_hf_client_parse_ccwa},
+    {"+COPS:", bta_hf_client_parse_cops},
+    {"+BINP:", bta_hf_client_parse_binp},
+    {"+CLCC:", bta_hf_client_parse_clcc},
+    {"+CNUM:", bta_hf_client_parse_cnum},
+    {"+BTRH:", bta_hf_client_parse_btrh},
+    {"+BIND:", bta_hf_client_parse_bind},
+    {"BUSY", bta_hf_client_parse_busy},
+    {"DELAYED", bta_hf_client_parse_delayed},
+    {"NO CARRIER", bta_hf_client_parse_no_carrier},
+    {"NO ANSWER", bta_hf_client_parse_no_answer},
+    {"REJECTLISTED", bta_hf_client_parse_rejectlisted},
+    {NULL, bta_hf_client_process_unknown}};
 
 /* calculate supported event list length */
-static const uint16_t bta_hf_client_parser_cb_count =
-    sizeof(bta_hf_client_parser_cb) / sizeof(bta_hf_client_parser_cb[0]);
+static const uint16_t bta_hf_client_parser_count =
+    sizeof(bta_hf_client_parser) / sizeof(bta_hf_client_parser[0]);
+
+/* Check the first two characters of the event name, which all the events
+ * have, so that the parsers of the other events are not called. The parser
+ * still checks the whole name. */
+static bool bta_hf_client_may_match_event(const char* buf, const char* event) {
+  if (event == NULL) return true;
+
+  return buf[0] == '\r' && buf[1] == '\n' && buf[2] == event[0] &&
+         buf[3] == event[1];
+}
 
 #ifdef BTA_HF_CLIENT_AT_DUMP
 static void bta_hf_client_dump_at(tBTA_HF_CLIENT_CB* client_cb) {
@@ -1622,8 +1653,11 @@ static void bta_hf_client_at_parse_start(tBTA_HF_CLIENT_CB* client_cb) {
     int i;
     char* tmp = NULL;
 
-    for (i = 0; i < bta_hf_client_parser_cb_count; i++) {
-      tmp = bta_hf_client_parser_cb[i](client_cb, buf);
+    for (i = 0; i < bta_hf_client_parser_count; i++) {
+      if (!bta_hf_client_may_match_event(buf, bta_hf_client_parser[i].event))
+        continue;
+
+      tmp = bta_hf_client_parser[i].parse(client_cb, buf);
       if (tmp == NULL) {
         APPL_TRACE_ERROR("HFPCient: AT event/reply parsing failed, skipping");
         tmp = bta_hf_client_skip_unknown(client_cb, buf);
@@ -27,6 +27,7 @@
 #include "bta/hh/bta_hh_int.h"
 #include "bta/include/bta_gatt_queue.h"
 #include "bta/include/bta_hh_co.h"
+#include "common/time_util.h"
 #include "device/include/interop.h"
 #include "main/shim/dumpsys.h"
 #include "main/shim/shim.h"
@@ -358,6 +359,23 @@ static tBTA_HH_LE_RPT* bta_hh_le_find_report_entry(
   return NULL;
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_hh_le_find_rpt_by_handle
+ *
+ * Description      find the report entry of the characteristic value handle
+ *
+ ******************************************************************************/
+static tBTA_HH_LE_RPT* bta_hh_le_find_rpt_by_handle(tBTA_HH_DEV_CB* p_cb,
+                                                    uint16_t handle) {
+  tBTA_HH_LE_RPT* p_rpt = &p_cb->hid_srvc.report[0];
+
+  for (uint8_t i = 0; i < BTA_HH_LE_RPT_MAX; i++, p_rpt++) {
+    if (p_rpt->in_use && p_rpt->char_inst_id == handle) return p_rpt;
+  }
+  return NULL;
+}
+
 /*******************************************************************************
  *
  * Function         bta_hh_le_find_rpt_by_idtype
@@ -1529,9 +1547,9 @@ static void bta_hh_le_srvc_search_cmpl(tBTA_GATTC_SEARCH_CMPL* p_data) {
  *
  ******************************************************************************/
 static void bta_hh_le_input_rpt_notify(tBTA_GATTC_NOTIFY* p_data) {
+  uint64_t rx_time_us = bluetooth::common::time_get_os_boottime_us();
   tBTA_HH_DEV_CB* p_dev_cb = bta_hh_le_find_dev_cb_by_conn_id(p_data->conn_id);
   uint8_t app_id;
-  uint8_t* p_buf;
   tBTA_HH_LE_RPT* p_rpt;
 
   if (p_dev_cb == NULL) {
@@ -1541,54 +1559,29 @@ static void bta_hh_le_input_rpt_notify(tBTA_GATTC_NOTIFY* p_data) {
     return;
   }
 
-  const gatt::Characteristic* p_char =
-      BTA_GATTC_GetCharacteristic(p_dev_cb->conn_id, p_data->handle);
-  if (p_char == NULL) {
+  /* The report entries keep the value handle of their characteristic, which
+   * is enough to find the report without looking up the GATT database. */
+  p_rpt = bta_hh_le_find_rpt_by_handle(p_dev_cb, p_data->handle);
+  if (p_rpt == NULL) {
     APPL_TRACE_ERROR(
-        "%s: notification received for Unknown Characteristic, conn_id: "
-        "0x%04x, handle: 0x%04x",
+        "%s: notification received for Unknown Report, conn_id: 0x%04x, "
+        "handle: 0x%04x",
         __func__, p_dev_cb->conn_id, p_data->handle);
     return;
   }
 
   app_id = p_dev_cb->app_id;
-
-  const gatt::Service* p_svc =
-      BTA_GATTC_GetOwningService(p_dev_cb->conn_id, p_char->value_handle);
-
-  p_rpt = bta_hh_le_find_report_entry(
-      p_dev_cb, p_svc->handle, p_char->uuid.As16Bit(), p_char->value_handle);
-  if (p_rpt == NULL) {
-    APPL_TRACE_ERROR(
-        "%s: notification received for Unknown Report, uuid: %s, handle: "
-        "0x%04x",
-        __func__, p_char->uuid.ToString().c_str(), p_char->value_handle);
-    return;
-  }
-
-  if (p_char->uuid == Uuid::From16Bit(GATT_UUID_HID_BT_MOUSE_INPUT))
+  if (p_rpt->uuid == GATT_UUID_HID_BT_MOUSE_INPUT)
     app_id = BTA_HH_APP_ID_MI;
-  else if (p_char->uuid == Uuid::From16Bit(GATT_UUID_HID_BT_KB_INPUT))
+  else if (p_rpt->uuid == GATT_UUID_HID_BT_KB_INPUT)
     app_id = BTA_HH_APP_ID_KB;
 
-  APPL_TRACE_DEBUG("Notification received on report ID: %d", p_rpt->rpt_id);
-
-  /* need to append report ID to the head of data */
-  if (p_rpt->rpt_id != 0) {
-    p_buf = (uint8_t*)osi_malloc(p_data->len + 1);
-
-    p_buf[0] = p_rpt->rpt_id;
-    memcpy(&p_buf[1], p_data->value, p_data->len);
-    ++p_data->len;
-  } else {
-    p_buf = p_data->value;
-  }
-
-  bta_hh_co_data((uint8_t)p_dev_cb->hid_handle, p_buf, p_data->len,
-                 p_dev_cb->mode, 0, /* no sub class*/
-                 p_dev_cb->dscp_info.ctry_code, p_dev_cb->addr, app_id);
+  APPL_TRACE_DEBUG("Notification received on report ID: %d, app_id: %d",
+                   p_rpt->rpt_id, app_id);
 
-  if (p_buf != p_data->value) osi_free(p_buf);
+  /* the report ID is prepended to the data while it is copied to uhid */
+  bta_hh_co_input_report((uint8_t)p_dev_cb->hid_handle, p_rpt->rpt_id,
+                         p_data->value, p_data->len, rx_time_us);
 }
 
 /*******************************************************************************
@@ -756,6 +756,34 @@ extern void BTA_DmDiscover(const RawAddress& bd_addr,
                            tBTA_DM_SEARCH_CBACK* p_cback,
                            tBT_TRANSPORT transport);
 
+/*******************************************************************************
+ *
+ * Function         BTA_DmDumpDiscoveryStatistics
+ *
+ * Description      Dump the stage timings of the recent name and service
+ *                  discoveries of the remote devices
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+extern void BTA_DmDumpDiscoveryStatistics(int fd);
+
+/*******************************************************************************
+ *
+ * Function         BTA_DmDumpPowerModeStatistics
+ *
+ * Description      Dump the power mode transitions of the ACL links and the
+ *                  time taken to wake them up from sniff
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+extern void BTA_DmDumpPowerModeStatistics(int fd);
+
 /*******************************************************************************
  *
  * Function         BTA_DmGetCachedRemoteName
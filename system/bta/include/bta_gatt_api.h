@@ -593,6 +593,10 @@ typedef void (*GATT_WRITE_OP_CB)(uint16_t conn_id, tGATT_STATUS status,
                                  const uint8_t* value, void* data);
 typedef void (*GATT_CONFIGURE_MTU_OP_CB)(uint16_t conn_id, tGATT_STATUS status,
                                          void* data);
+typedef void (*GATT_READ_MULTI_OP_CB)(uint16_t conn_id, tGATT_STATUS status,
+                                      const tBTA_GATTC_MULTI& handles,
+                                      uint16_t len, uint8_t* value,
+                                      void* data);
 
 /*******************************************************************************
  *
@@ -765,13 +769,19 @@ extern void BTA_GATTC_ExecuteWrite(uint16_t conn_id, bool is_execute);
  *
  * Parameters       conn_id - connectino ID.
  *                    p_read_multi - read multiple parameters.
+ *                  variable_len - use the Read Multiple Variable Length
+ *                                 request, where each value is preceded by
+ *                                 its length.
+ *                  callback - called with the raw response value.
  *
  * Returns          None
  *
  ******************************************************************************/
 extern void BTA_GATTC_ReadMultiple(uint16_t conn_id,
                                    tBTA_GATTC_MULTI* p_read_multi,
-                                   tGATT_AUTH_REQ auth_req);
+                                   tGATT_AUTH_REQ auth_req, bool variable_len,
+                                   GATT_READ_MULTI_OP_CB callback,
+                                   void* cb_data);
 
 /*******************************************************************************
  *
@@ -786,6 +796,36 @@ extern void BTA_GATTC_ReadMultiple(uint16_t conn_id,
  ******************************************************************************/
 extern void BTA_GATTC_Refresh(const RawAddress& remote_bda);
 
+/*******************************************************************************
+ *
+ * Function         BTA_GATTC_SetConnectionProfile
+ *
+ * Description      Set the LE connection parameter profile applied to the
+ *                  links used by a client application
+ *
+ * Parameters       client_if: client interface.
+ *                  profile: connection parameter profile.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+extern void BTA_GATTC_SetConnectionProfile(tGATT_IF client_if,
+                                           tGATT_CONN_PROFILE profile);
+
+/*******************************************************************************
+ *
+ * Function         BTA_GATTC_DumpDiscoveryStatistics
+ *
+ * Description      Dump the wall time and strategy of the recent service
+ *                  discoveries of the remote devices
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+extern void BTA_GATTC_DumpDiscoveryStatistics(int fd);
+
 /*******************************************************************************
  *
  * Function         BTA_GATTC_ConfigureMTU
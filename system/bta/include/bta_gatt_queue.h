@@ -32,6 +32,12 @@
  *
  * If you decide to use those methods in your app, make sure to not mix it with
  * existing BTA_GATTC_* API.
+ *
+ * When the peer supports EATT, consecutive queued reads are coalesced into a
+ * single Read Multiple Variable Length request, and the callback of each read
+ * is called with its own value. Up to kMaxPipelinedWrites characteristic
+ * writes without response are handed to BTA without waiting for the previous
+ * ones to complete; the other operations still wait for them.
  */
 class BtaGattQueue {
  public:
@@ -64,17 +70,34 @@ class BtaGattQueue {
     /* write-specific fields */
     tGATT_WRITE_TYPE write_type;
     std::vector<uint8_t> value;
+
+    /* read-specific fields */
+    bool no_read_multi;
   };
 
  private:
+  static constexpr uint8_t kMaxPipelinedWrites = 5;
+
   static void mark_as_not_executing(uint16_t conn_id);
+  static bool can_coalesce_reads(uint16_t conn_id);
+  static void gatt_execute_read_multi(uint16_t conn_id,
+                                      std::list<gatt_operation>& gatt_ops);
   static void gatt_execute_next_op(uint16_t conn_id);
   static void gatt_read_op_finished(uint16_t conn_id, tGATT_STATUS status,
                                     uint16_t handle, uint16_t len,
                                     uint8_t* value, void* data);
+  static void gatt_read_multi_op_finished(uint16_t conn_id,
+                                          tGATT_STATUS status,
+                                          const tBTA_GATTC_MULTI& handles,
+                                          uint16_t len, uint8_t* value,
+                                          void* data);
   static void gatt_write_op_finished(uint16_t conn_id, tGATT_STATUS status,
                                      uint16_t handle, uint16_t len,
                                      const uint8_t* value, void* data);
+  static void gatt_write_no_rsp_op_finished(uint16_t conn_id,
+                                            tGATT_STATUS status,
+                                            uint16_t handle, uint16_t len,
+                                            const uint8_t* value, void* data);
   static void gatt_configure_mtu_op_finished(uint16_t conn_id,
                                              tGATT_STATUS status, void* data);
 
@@ -82,4 +105,12 @@ class BtaGattQueue {
   static std::unordered_map<uint16_t, std::list<gatt_operation>> gatt_op_queue;
   // contain connection ids that currently execute operations
   static std::unordered_set<uint16_t> gatt_op_queue_executing;
+  // maps connection id to the number of writes without response in flight
+  static std::unordered_map<uint16_t, uint8_t> gatt_op_queue_pipelined_writes;
+  // contain connection ids whose last write without response was congested,
+  // and which pipeline a single write until it is not
+  static std::unordered_set<uint16_t> gatt_op_queue_congested;
+  // contain connection ids on which a coalesced read failed, and which read
+  // the attributes one by one
+  static std::unordered_set<uint16_t> gatt_op_queue_no_read_multi;
 };
@@ -78,6 +78,8 @@ struct AudioStats {
   size_t packet_drop_count;
   size_t packet_send_count;
   size_t packet_flush_count;
+  size_t packet_skip_count;
+  size_t max_queued_packets;
   size_t frame_send_count;
   size_t frame_flush_count;
   std::deque<rssi_log> rssi_history;
@@ -89,6 +91,8 @@ struct AudioStats {
     packet_drop_count = 0;
     packet_send_count = 0;
     packet_flush_count = 0;
+    packet_skip_count = 0;
+    max_queued_packets = 0;
     frame_send_count = 0;
     frame_flush_count = 0;
   }
@@ -54,6 +54,23 @@ extern void bta_hh_co_data(uint8_t dev_handle, uint8_t* p_rpt, uint16_t len,
                            uint8_t ctry_code, const RawAddress& peer_addr,
                            uint8_t app_id);
 
+/*******************************************************************************
+ *
+ * Function         bta_hh_co_input_report
+ *
+ * Description      This callout function is executed by HH when an LE HID
+ *                  device notifies an input report. The report ID |rpt_id|,
+ *                  unless it is 0, is written ahead of the |len| bytes of
+ *                  |p_data|. |rx_time_us| is the boot time at which the
+ *                  notification was received.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+extern void bta_hh_co_input_report(uint8_t dev_handle, uint8_t rpt_id,
+                                   const uint8_t* p_data, uint16_t len,
+                                   uint64_t rx_time_us);
+
 /*******************************************************************************
  *
  * Function         bta_hh_co_open
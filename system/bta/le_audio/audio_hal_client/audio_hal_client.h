@@ -139,6 +139,12 @@ class LeAudioSourceAudioHalClient {
    public:
     virtual ~Callbacks() = default;
     virtual void OnAudioDataReady(const std::vector<uint8_t>& data) = 0;
+    /* Same as OnAudioDataReady(), with the Audio HAL data given in place: it
+     * is only valid during the call.
+     */
+    virtual void OnAudioDataReadyInPlace(const uint8_t* data, size_t size) {
+      OnAudioDataReady(std::vector<uint8_t>(data, data + size));
+    }
     virtual void OnAudioSuspend(std::promise<void> do_suspend_promise) = 0;
     virtual void OnAudioResume(void) = 0;
     virtual void OnAudioMetadataUpdate(
@@ -98,6 +98,9 @@ class MockLeAudioClientInterfaceSink : public LeAudioClientInterface::Sink {
   MOCK_METHOD((void), UpdateBroadcastAudioConfigToHal,
               (const ::le_audio::broadcast_offload_config&));
   MOCK_METHOD((size_t), Read, (uint8_t * p_buf, uint32_t len));
+  MOCK_METHOD((bool), ReadInPlace,
+              (uint32_t len,
+               const bluetooth::audio::AudioDataConsumer& consume));
 };
 
 class MockLeAudioClientInterfaceSource : public LeAudioClientInterface::Source {
@@ -199,6 +202,11 @@ size_t LeAudioClientInterface::Source::Write(const uint8_t* p_buf,
 size_t LeAudioClientInterface::Sink::Read(uint8_t* p_buf, uint32_t len) {
   return sink_mock->Read(p_buf, len);
 }
+
+bool LeAudioClientInterface::Sink::ReadInPlace(
+    uint32_t len, const AudioDataConsumer& consume) {
+  return sink_mock->ReadInPlace(len, consume);
+}
 }  // namespace le_audio
 }  // namespace audio
 }  // namespace bluetooth
@@ -534,6 +542,55 @@ TEST_F(LeAudioClientAudioTest, testAudioHalClientResumeStartSourceTask) {
   ASSERT_EQ(media_data_to_send.size(), calculated_bytes_per_tick);
 }
 
+TEST_F(LeAudioClientAudioTest, testAudioHalClientReadsAudioDataInPlace) {
+  ASSERT_TRUE(AcquireLeAudioSourceHalClient());
+  ASSERT_TRUE(audio_source_instance_->Start(default_codec_conf,
+                                            &mock_hal_sink_event_receiver_));
+
+  /* The data of each tick wraps around the end of the HAL queue */
+  EXPECT_CALL(mock_hal_interface_audio_sink_, Read(_, _)).Times(0);
+  EXPECT_CALL(mock_hal_interface_audio_sink_, ReadInPlace(_, _))
+      .Times(AtLeast(1))
+      .WillRepeatedly(
+          Invoke([](uint32_t len,
+                    const bluetooth::audio::AudioDataConsumer& consume) {
+            std::vector<uint8_t> hal_data(len);
+            for (uint32_t i = 0u; i < len; ++i) {
+              hal_data[i] = i;
+            }
+            consume({hal_data.data(), len / 2},
+                    {hal_data.data() + len / 2, len - len / 2});
+            return true;
+          }));
+
+  std::promise<void> data_promise;
+  auto data_future = data_promise.get_future();
+
+  std::vector<uint8_t> media_data_to_send;
+  EXPECT_CALL(mock_hal_sink_event_receiver_, OnAudioDataReady(_))
+      .Times(AtLeast(1))
+      .WillOnce(Invoke([&](const std::vector<uint8_t>& data) -> void {
+        media_data_to_send = data;
+        data_promise.set_value();
+      }))
+      .WillRepeatedly(DoDefault());
+
+  ASSERT_NE(sink_audio_hal_stream_cb.on_resume_, nullptr);
+  EXPECT_CALL(mock_hal_sink_event_receiver_, OnAudioResume()).Times(1);
+  bool start_media_task = true;
+  ASSERT_TRUE(sink_audio_hal_stream_cb.on_resume_(start_media_task));
+  audio_source_instance_->ConfirmStreamingRequest();
+
+  ASSERT_EQ(data_future.wait_for(std::chrono::seconds(1)),
+            std::future_status::ready);
+
+  /* Both regions are given back in order */
+  ASSERT_FALSE(media_data_to_send.empty());
+  for (size_t i = 0u; i < media_data_to_send.size(); ++i) {
+    ASSERT_EQ(media_data_to_send[i], (uint8_t)i);
+  }
+}
+
 TEST_F(LeAudioClientAudioTest, testAudioHalClientResume) {
   ASSERT_TRUE(AcquireLeAudioSourceHalClient());
   ASSERT_TRUE(audio_source_instance_->Start(default_codec_conf,
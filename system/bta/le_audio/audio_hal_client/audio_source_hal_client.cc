@@ -18,6 +18,8 @@
  *
  ******************************************************************************/
 
+#include <algorithm>
+
 #include "audio_hal_client.h"
 #include "audio_hal_interface/le_audio_software.h"
 #include "bta/le_audio/codec_manager.h"
@@ -93,6 +95,8 @@ class SourceImpl : public LeAudioSourceAudioHalClient {
       nullptr;
   LeAudioSourceAudioHalClient::Callbacks* audioSourceCallbacks_ = nullptr;
   std::mutex audioSourceCallbacksMutex_;
+  /* Audio data copied out of the HAL when it can't be used in place */
+  std::vector<uint8_t> audio_data_;
 };
 
 bool SourceImpl::Acquire() {
@@ -185,19 +189,45 @@ void SourceImpl::SendAudioData() {
       (source_codec_config_.num_channels * source_codec_config_.sample_rate *
        source_codec_config_.data_interval_us / 1000 * bytes_per_sample) /
       1000;
-  std::vector<uint8_t> data(bytes_per_tick);
 
-  uint32_t bytes_read = halSinkInterface_->Read(data.data(), bytes_per_tick);
+  /* Encode the data in place in the HAL queue when it is all there, and only
+   * copy it when it wraps around the end of the queue.
+   */
+  std::unique_lock<std::mutex> guard(audioSourceCallbacksMutex_);
+  bool read_in_place = halSinkInterface_->ReadInPlace(
+      bytes_per_tick, [this](bluetooth::audio::AudioDataSpan first,
+                             bluetooth::audio::AudioDataSpan second) {
+        if (audioSourceCallbacks_ == nullptr) return;
+        if (second.size == 0) {
+          audioSourceCallbacks_->OnAudioDataReadyInPlace(first.data,
+                                                         first.size);
+          return;
+        }
+        audio_data_.resize(first.size + second.size);
+        std::copy(first.data, first.data + first.size, audio_data_.begin());
+        std::copy(second.data, second.data + second.size,
+                  audio_data_.begin() + first.size);
+        audioSourceCallbacks_->OnAudioDataReadyInPlace(audio_data_.data(),
+                                                       audio_data_.size());
+      });
+  if (read_in_place) return;
+  guard.unlock();
+
+  audio_data_.resize(bytes_per_tick);
+  uint32_t bytes_read =
+      halSinkInterface_->Read(audio_data_.data(), bytes_per_tick);
   if (bytes_read < bytes_per_tick) {
     sStats.media_read_total_underflow_bytes += bytes_per_tick - bytes_read;
     sStats.media_read_total_underflow_count++;
     sStats.media_read_last_underflow_us =
         bluetooth::common::time_get_os_boottime_us();
+    std::fill(audio_data_.begin() + bytes_read, audio_data_.end(), 0);
   }
 
-  std::lock_guard<std::mutex> guard(audioSourceCallbacksMutex_);
+  guard.lock();
   if (audioSourceCallbacks_ != nullptr) {
-    audioSourceCallbacks_->OnAudioDataReady(data);
+    audioSourceCallbacks_->OnAudioDataReadyInPlace(audio_data_.data(),
+                                                   audio_data_.size());
   }
 }
 
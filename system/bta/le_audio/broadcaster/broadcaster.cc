@@ -17,11 +17,18 @@
 
 #include <base/bind.h>
 
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <mutex>
+
 #include "bta/include/bta_le_audio_api.h"
 #include "bta/include/bta_le_audio_broadcaster_api.h"
 #include "bta/le_audio/broadcaster/state_machine.h"
 #include "bta/le_audio/le_audio_types.h"
 #include "bta/le_audio/le_audio_utils.h"
+#include "common/message_loop_thread.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "embdrv/lc3/include/lc3.h"
 #include "gd/common/strings.h"
@@ -120,6 +127,7 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       le_audio_source_hal_client_->Stop();
       le_audio_source_hal_client_.reset();
     }
+    audio_receiver_.StopEncoderWorkers();
   }
 
   void Stop() {
@@ -607,6 +615,7 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       auto& broadcast = broadcast_pair.second;
       if (broadcast) stream << *broadcast;
     }
+    audio_receiver_.Dump(stream);
 
     dprintf(fd, "%s", stream.str().c_str());
   }
@@ -758,6 +767,56 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
         encoders_.emplace_back(
             lc3_setup_encoder(dt_us, sr_hz, 0, encoders_mem_.back().get()));
       }
+
+      StartEncoderWorkers();
+    }
+
+    /* The audio thread encodes the first channel itself, and each of the
+     * other channels gets its own worker thread.
+     */
+    void StartEncoderWorkers() {
+      size_t num_workers = 0;
+      if (osi_property_get_bool(kParallelEncodingProperty, true) &&
+          codec_wrapper_.GetNumChannels() > 1) {
+        num_workers = std::min<size_t>(codec_wrapper_.GetNumChannels() - 1,
+                                       kMaxEncoderWorkers);
+      }
+      if (encoder_workers_.size() == num_workers) return;
+
+      StopEncoderWorkers();
+      while (encoder_workers_.size() < num_workers) {
+        auto worker = std::make_unique<bluetooth::common::MessageLoopThread>(
+            "bt_le_audio_broadcast_encoder_thread");
+        worker->StartUp();
+        if (!worker->IsRunning()) {
+          LOG_ERROR("Unable to start up the encoder worker thread");
+          break;
+        }
+        if (!worker->EnableRealTimeScheduling()) {
+          LOG_WARN("Unable to increase the encoder worker thread priority");
+        }
+        encoder_workers_.push_back(std::move(worker));
+      }
+      LOG_INFO("Encoding with %zu worker threads", encoder_workers_.size());
+    }
+
+    void StopEncoderWorkers() {
+      for (auto& worker : encoder_workers_) worker->ShutDown();
+      encoder_workers_.clear();
+    }
+
+    void Dump(std::stringstream& stream) const {
+      stream << "    Encoding threads: " << encoder_workers_.size() + 1
+             << "\n";
+      uint64_t intervals = encoding_stats_.intervals.load();
+      stream << "    Encoded intervals: " << intervals
+             << ", late: " << encoding_stats_.late_intervals.load() << "\n";
+      if (intervals != 0) {
+        stream << "    Encoding time (last/avg/max): "
+               << encoding_stats_.last_us.load() << "/"
+               << encoding_stats_.total_us.load() / intervals << "/"
+               << encoding_stats_.max_us.load() << " us\n";
+      }
     }
 
     const BroadcastCodecWrapper& getCurrentCodecConfig(void) const {
@@ -770,12 +829,11 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
 
     void encodeLc3Channel(lc3_encoder_t encoder,
                           std::vector<uint8_t>& out_buffer,
-                          const std::vector<uint8_t>& data,
-                          int initial_channel_offset, int pitch_samples,
-                          int num_channels) {
+                          const uint8_t* data, int initial_channel_offset,
+                          int pitch_samples, int num_channels) {
       auto encoder_status =
           lc3_encode(encoder, LC3_PCM_FORMAT_S16,
-                     (int16_t*)(data.data() + initial_channel_offset),
+                     (const int16_t*)(data + initial_channel_offset),
                      pitch_samples, out_buffer.size(), out_buffer.data());
       if (encoder_status != 0) {
         LOG_ERROR("Encoding error=%d", encoder_status);
@@ -808,20 +866,17 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
     }
 
     virtual void OnAudioDataReady(const std::vector<uint8_t>& data) override {
-      if (!instance) return;
+      OnAudioDataReadyInPlace(data.data(), data.size());
+    }
 
-      LOG_VERBOSE("Received %zu bytes.", data.size());
+    virtual void OnAudioDataReadyInPlace(const uint8_t* data,
+                                         size_t size) override {
+      if (!instance) return;
 
-      /* Constants for the channel data configuration */
-      const auto num_channels = codec_wrapper_.GetNumChannels();
-      const auto bytes_per_sample = (codec_wrapper_.GetBitsPerSample() / 8);
+      LOG_VERBOSE("Received %zu bytes.", size);
 
       /* Prepare encoded data for all channels */
-      for (uint8_t chan = 0; chan < num_channels; ++chan) {
-        /* TODO: Use encoder agnostic wrapper */
-        encodeLc3Channel(encoders_[chan], enc_audio_buffers_[chan], data,
-                         chan * bytes_per_sample, num_channels, num_channels);
-      }
+      encodeAllChannels(data);
 
       /* Currently there is no way to broadcast multiple distinct streams.
        * We just receive all system sounds mixed into a one stream and each
@@ -882,10 +937,97 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
     }
 
    private:
+    static constexpr char kParallelEncodingProperty[] =
+        "persist.bluetooth.leaudio.broadcast.parallel_encoding";
+    static constexpr size_t kMaxEncoderWorkers = 3;
+
+    void encodeChannel(const uint8_t* data, uint8_t chan) {
+      const auto num_channels = codec_wrapper_.GetNumChannels();
+      const auto bytes_per_sample = (codec_wrapper_.GetBitsPerSample() / 8);
+
+      /* TODO: Use encoder agnostic wrapper */
+      encodeLc3Channel(encoders_[chan], enc_audio_buffers_[chan], data,
+                       chan * bytes_per_sample, num_channels, num_channels);
+    }
+
+    void encodeChannelOnWorker(const uint8_t* data, uint8_t chan) {
+      encodeChannel(data, chan);
+
+      std::lock_guard<std::mutex> lock(encode_mutex_);
+      if (--pending_encodes_ == 0) encode_done_.notify_one();
+    }
+
+    /* Encode all the channels, spread over the audio thread and the encoder
+     * workers, and wait for all of them since they read |data|. An interval
+     * which took longer than the SDU interval is still sent, since dropping it
+     * would leave an audible gap, and is only counted as late.
+     */
+    void encodeAllChannels(const uint8_t* data) {
+      const auto num_channels = codec_wrapper_.GetNumChannels();
+      const size_t num_threads = encoder_workers_.size() + 1;
+      uint64_t start_us = bluetooth::common::time_get_os_boottime_us();
+
+      for (uint8_t chan = 0; chan < num_channels; ++chan) {
+        size_t thread = chan % num_threads;
+        if (thread == 0) continue;
+
+        {
+          std::lock_guard<std::mutex> lock(encode_mutex_);
+          pending_encodes_++;
+        }
+        if (!encoder_workers_[thread - 1]->DoInThread(
+                FROM_HERE,
+                base::BindOnce(
+                    &LeAudioSourceCallbacksImpl::encodeChannelOnWorker,
+                    base::Unretained(this), data, chan))) {
+          encodeChannelOnWorker(data, chan);
+        }
+      }
+
+      for (uint8_t chan = 0; chan < num_channels; chan += num_threads) {
+        encodeChannel(data, chan);
+      }
+
+      {
+        std::unique_lock<std::mutex> lock(encode_mutex_);
+        encode_done_.wait(lock, [this] { return pending_encodes_ == 0; });
+      }
+
+      uint64_t encode_us =
+          bluetooth::common::time_get_os_boottime_us() - start_us;
+      encoding_stats_.intervals++;
+      encoding_stats_.total_us += encode_us;
+      encoding_stats_.last_us = encode_us;
+      /* Only the audio thread writes the stats */
+      if (encode_us > encoding_stats_.max_us) {
+        encoding_stats_.max_us = encode_us;
+      }
+      if (encode_us > codec_wrapper_.GetDataIntervalUs()) {
+        LOG_WARN("Encoding missed the SDU interval by %" PRIu64 " us",
+                 encode_us - codec_wrapper_.GetDataIntervalUs());
+        encoding_stats_.late_intervals++;
+      }
+    }
+
     BroadcastCodecWrapper codec_wrapper_;
     std::vector<lc3_encoder_t> encoders_;
     std::vector<std::unique_ptr<void, decltype(&std::free)>> encoders_mem_;
     std::vector<std::vector<uint8_t>> enc_audio_buffers_;
+
+    std::vector<std::unique_ptr<bluetooth::common::MessageLoopThread>>
+        encoder_workers_;
+    std::mutex encode_mutex_;
+    std::condition_variable encode_done_;
+    size_t pending_encodes_ = 0;
+
+    /* Written on the audio thread, read by Dump() on the main thread */
+    struct {
+      std::atomic<uint64_t> intervals{0};
+      std::atomic<uint64_t> late_intervals{0};
+      std::atomic<uint64_t> total_us{0};
+      std::atomic<uint64_t> last_us{0};
+      std::atomic<uint64_t> max_us{0};
+    } encoding_stats_;
   } audio_receiver_;
 
   bluetooth::le_audio::LeAudioBroadcasterCallbacks* callbacks_;
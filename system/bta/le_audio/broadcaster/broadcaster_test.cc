@@ -20,6 +20,8 @@
 #include <hardware/audio.h>
 
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 
 #include "bta/include/bta_le_audio_api.h"
 #include "bta/include/bta_le_audio_broadcaster_api.h"
@@ -362,6 +364,46 @@ TEST_F(BroadcasterTest, StartAudioBroadcastMedia) {
   audio_receiver->OnAudioDataReady(sample_data);
 }
 
+TEST_F(BroadcasterTest, StartAudioBroadcastMediaParallelEncoding) {
+  auto broadcast_id = InstantiateBroadcast(media_metadata);
+  LeAudioBroadcaster::Get()->StopAudioBroadcast(broadcast_id);
+
+  LeAudioSourceAudioHalClient::Callbacks* audio_receiver;
+  EXPECT_CALL(*mock_audio_source_, Start)
+      .WillOnce(DoAll(SaveArg<1>(&audio_receiver), Return(true)));
+
+  LeAudioBroadcaster::Get()->StartAudioBroadcast(broadcast_id);
+  ASSERT_NE(audio_receiver, nullptr);
+
+  BigConfig big_cfg;
+  big_cfg.big_id =
+      MockBroadcastStateMachine::GetLastInstance()->GetAdvertisingSid();
+  big_cfg.connection_handles = {0x10, 0x12};
+  big_cfg.max_pdu = 128;
+  MockBroadcastStateMachine::GetLastInstance()->SetExpectedBigConfig(big_cfg);
+
+  // Both channels are sent on every interval, the second one being encoded by
+  // the encoder worker thread.
+  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoData(0x10, _, _))
+      .Times(3);
+  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoData(0x12, _, _))
+      .Times(3);
+  std::vector<uint8_t> sample_data(1920, 0);
+  for (int i = 0; i < 3; ++i) audio_receiver->OnAudioDataReady(sample_data);
+
+  // The encoding threads and times are reported in the dump
+  FILE* dump = tmpfile();
+  ASSERT_NE(dump, nullptr);
+  LeAudioBroadcaster::DebugDump(fileno(dump));
+  rewind(dump);
+  char buffer[1024] = {0};
+  size_t dump_size = fread(buffer, 1, sizeof(buffer) - 1, dump);
+  fclose(dump);
+  ASSERT_GT(dump_size, 0u);
+  ASSERT_NE(strstr(buffer, "Encoding threads: 2"), nullptr);
+  ASSERT_NE(strstr(buffer, "Encoding time (last/avg/max)"), nullptr);
+}
+
 TEST_F(BroadcasterTest, StopAudioBroadcast) {
   auto broadcast_id = InstantiateBroadcast();
   LeAudioBroadcaster::Get()->StartAudioBroadcast(broadcast_id);
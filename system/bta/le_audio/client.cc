@@ -18,7 +18,9 @@
 #include <base/bind.h>
 #include <base/strings/string_number_conversions.h>
 
+#include <algorithm>
 #include <deque>
+#include <memory>
 #include <optional>
 
 #include "advertise_data_parser.h"
@@ -41,6 +43,8 @@
 #include "embdrv/lc3/include/lc3.h"
 #include "gatt/bta_gattc_int.h"
 #include "gd/common/strings.h"
+#include "gd/metrics/latency_histogram.h"
+#include "gd/os/trace.h"
 #include "internal_include/stack_config.h"
 #include "le_audio_set_configuration_provider.h"
 #include "le_audio_types.h"
@@ -176,6 +180,68 @@ inline lc3_pcm_format bits_to_lc3_bits(uint8_t bits_per_sample) {
   return LC3_PCM_FORMAT_S16;
 }
 
+/* LC3 encoders of the unicast sink streams, with their per frame buffers.
+ * Only the audio worker thread uses them, once they are set up.
+ */
+struct SinkEncoders {
+  SinkEncoders(const LeAudioCodecConfiguration& codec_config,
+               const LeAudioCodecConfiguration& af_config,
+               uint16_t octets_per_frame) {
+    int dt_us = codec_config.data_interval_us;
+    int sr_hz = codec_config.sample_rate;
+    int af_hz = af_config.sample_rate;
+    unsigned enc_size = lc3_encoder_size(dt_us, af_hz);
+
+    left_mem = malloc(enc_size);
+    right_mem = malloc(enc_size);
+    left = lc3_setup_encoder(dt_us, sr_hz, af_hz, left_mem);
+    right = lc3_setup_encoder(dt_us, sr_hz, af_hz, right_mem);
+
+    /* The buffers are reused for every frame, size them once here */
+    encoded_left.reserve(2 /* channels */ * octets_per_frame);
+    encoded_right.reserve(octets_per_frame);
+    mono_blend.reserve(lc3_frame_samples(dt_us, af_hz) *
+                       bits_to_bytes_per_sample(af_config.bits_per_sample));
+  }
+  SinkEncoders(const SinkEncoders&) = delete;
+  SinkEncoders& operator=(const SinkEncoders&) = delete;
+  ~SinkEncoders() {
+    free(left_mem);
+    free(right_mem);
+  }
+
+  void* left_mem;
+  void* right_mem;
+  lc3_encoder_t left;
+  lc3_encoder_t right;
+
+  std::vector<uint8_t> encoded_left;
+  std::vector<uint8_t> encoded_right;
+  std::vector<uint8_t> mono_blend;
+};
+
+/* Snapshot of the unicast sink stream configuration, for the audio worker
+ * thread which encodes the audio and sends it to the CISes. The main thread
+ * publishes a new snapshot whenever the streams change, and the worker thread
+ * takes the latest one for each frame, so it never reads the group state.
+ */
+struct SinkDataPath {
+  /* Two CISes, for one or two devices, each one getting one channel */
+  bool two_cises;
+  uint16_t left_cis_handle;
+  uint16_t right_cis_handle;
+  /* Otherwise a single CIS, getting |num_channels| channels */
+  uint16_t cis_handle;
+  uint8_t num_channels;
+
+  uint16_t octets_per_frame;
+  uint16_t frame_samples;
+  lc3_pcm_format bits_per_sample;
+  uint8_t bytes_per_sample;
+
+  std::shared_ptr<SinkEncoders> encoders;
+};
+
 class LeAudioClientImpl;
 LeAudioClientImpl* instance;
 LeAudioSourceAudioHalClient::Callbacks* audioSinkReceiver;
@@ -239,8 +305,6 @@ class LeAudioClientImpl : public LeAudioClient {
         in_call_(false),
         current_source_codec_config({0, 0, 0, 0}),
         current_sink_codec_config({0, 0, 0, 0}),
-        lc3_encoder_left_mem(nullptr),
-        lc3_encoder_right_mem(nullptr),
         lc3_decoder_left_mem(nullptr),
         lc3_decoder_right_mem(nullptr),
         lc3_decoder_left(nullptr),
@@ -442,6 +506,17 @@ class LeAudioClientImpl : public LeAudioClient {
     group_remove_node(group, address);
   }
 
+  /* The CISes of the group changed, e.g. when a device joins or leaves the
+   * stream */
+  void OnUpdatedCisConfiguration(int group_id, uint8_t direction) {
+    if (group_id != active_group_id_ ||
+        direction != le_audio::types::kLeAudioDirectionSink) {
+      return;
+    }
+
+    UpdateSinkDataPath(aseGroups_.FindById(group_id));
+  }
+
   /* This callback happens if kLeAudioDeviceSetStateTimeoutMs timeout happens
    * during transition from origin to target state
    */
@@ -1079,6 +1154,7 @@ class LeAudioClientImpl : public LeAudioClient {
                         &current_sink_codec_config);
     } else {
       /* In case there was an active group. Stop the stream */
+      UpdateSinkDataPath(nullptr);
       GroupStop(active_group_id_);
       callbacks_->OnGroupStatus(active_group_id_, GroupStatus::INACTIVE);
     }
@@ -2508,148 +2584,114 @@ class LeAudioClientImpl : public LeAudioClient {
   }
 
   // mix stero signal into mono
-  std::vector<uint8_t> mono_blend(const std::vector<uint8_t>& buf,
-                                  int bytes_per_sample, size_t frames) {
-    std::vector<uint8_t> mono_out;
-    mono_out.resize(frames * bytes_per_sample);
-
-    if (bytes_per_sample == 2) {
-      int16_t* out = (int16_t*)mono_out.data();
-      const int16_t* in = (int16_t*)(buf.data());
-      for (size_t i = 0; i < frames; ++i) {
-        int accum = 0;
-        accum += *in++;
-        accum += *in++;
-        accum /= 2;  // round to 0
-        *out++ = accum;
-      }
-    } else if (bytes_per_sample == 4) {
-      int32_t* out = (int32_t*)mono_out.data();
-      const int32_t* in = (int32_t*)(buf.data());
-      for (size_t i = 0; i < frames; ++i) {
-        int accum = 0;
-        accum += *in++;
-        accum += *in++;
-        accum /= 2;  // round to 0
-        *out++ = accum;
-      }
-    } else {
-      LOG_ERROR("Don't know how to mono blend that %d!", bytes_per_sample);
-    }
-    return mono_out;
-  }
-
-  void PrepareAndSendToTwoCises(
-      const std::vector<uint8_t>& data,
-      struct le_audio::stream_configuration* stream_conf) {
-    uint16_t byte_count = stream_conf->sink_octets_per_codec_frame;
-    uint16_t left_cis_handle = 0;
-    uint16_t right_cis_handle = 0;
-    uint16_t number_of_required_samples_per_channel;
-
-    int dt_us = current_source_codec_config.data_interval_us;
-    int af_hz = audio_framework_source_config.sample_rate;
-    number_of_required_samples_per_channel = lc3_frame_samples(dt_us, af_hz);
-
-    lc3_pcm_format bits_per_sample =
-        bits_to_lc3_bits(audio_framework_source_config.bits_per_sample);
-    uint8_t bytes_per_sample =
-        bits_to_bytes_per_sample(audio_framework_source_config.bits_per_sample);
-
-    for (auto [cis_handle, audio_location] : stream_conf->sink_streams) {
-      if (audio_location & le_audio::codec_spec_conf::kLeAudioLocationAnyLeft)
-        left_cis_handle = cis_handle;
-      if (audio_location & le_audio::codec_spec_conf::kLeAudioLocationAnyRight)
-        right_cis_handle = cis_handle;
-    }
-
-    if (data.size() < bytes_per_sample * 2 /* channels */ *
-                          number_of_required_samples_per_channel) {
-      LOG(ERROR) << __func__ << " Missing samples. Data size: " << +data.size()
+  const uint8_t* mono_blend(const SinkDataPath& data_path, const uint8_t* buf) {
+    std::vector<uint8_t>& mono_blend_data = data_path.encoders->mono_blend;
+    mono_blend_data.resize(data_path.frame_samples *
+                           data_path.bytes_per_sample);
+    if (!le_audio::utils::MonoBlend(buf, data_path.bytes_per_sample,
+                                    data_path.frame_samples,
+                                    mono_blend_data.data())) {
+      LOG_ERROR("Don't know how to mono blend that %d!",
+                data_path.bytes_per_sample);
+      std::fill(mono_blend_data.begin(), mono_blend_data.end(), 0);
+    }
+    return mono_blend_data.data();
+  }
+
+  void PrepareAndSendToTwoCises(const uint8_t* data, size_t size,
+                                const SinkDataPath& data_path) {
+    uint16_t byte_count = data_path.octets_per_frame;
+    uint16_t left_cis_handle = data_path.left_cis_handle;
+    uint16_t right_cis_handle = data_path.right_cis_handle;
+    uint16_t number_of_required_samples_per_channel = data_path.frame_samples;
+
+    lc3_pcm_format bits_per_sample = data_path.bits_per_sample;
+    uint8_t bytes_per_sample = data_path.bytes_per_sample;
+    SinkEncoders* encoders = data_path.encoders.get();
+
+    if (size < bytes_per_sample * 2 /* channels */ *
+                   number_of_required_samples_per_channel) {
+      LOG(ERROR) << __func__ << " Missing samples. Data size: " << +size
                  << " expected: "
                  << bytes_per_sample * 2 *
                         number_of_required_samples_per_channel;
       return;
     }
 
-    std::vector<uint8_t> chan_left_enc(byte_count, 0);
-    std::vector<uint8_t> chan_right_enc(byte_count, 0);
+    std::vector<uint8_t>& chan_left_enc = encoders->encoded_left;
+    std::vector<uint8_t>& chan_right_enc = encoders->encoded_right;
+    chan_left_enc.resize(byte_count);
+    chan_right_enc.resize(byte_count);
 
     bool mono = (left_cis_handle == 0) || (right_cis_handle == 0);
 
     if (!mono) {
-      lc3_encode(lc3_encoder_left, bits_per_sample, data.data(), 2,
+      lc3_encode(encoders->left, bits_per_sample, data, 2,
                  chan_left_enc.size(), chan_left_enc.data());
-      lc3_encode(lc3_encoder_right, bits_per_sample,
-                 data.data() + bytes_per_sample, 2, chan_right_enc.size(),
-                 chan_right_enc.data());
+      lc3_encode(encoders->right, bits_per_sample, data + bytes_per_sample, 2,
+                 chan_right_enc.size(), chan_right_enc.data());
     } else {
-      std::vector<uint8_t> mono = mono_blend(
-          data, bytes_per_sample, number_of_required_samples_per_channel);
+      const uint8_t* mono = mono_blend(data_path, data);
       if (left_cis_handle) {
-        lc3_encode(lc3_encoder_left, bits_per_sample, mono.data(), 1,
+        lc3_encode(encoders->left, bits_per_sample, mono, 1,
                    chan_left_enc.size(), chan_left_enc.data());
       }
 
       if (right_cis_handle) {
-        lc3_encode(lc3_encoder_right, bits_per_sample, mono.data(), 1,
+        lc3_encode(encoders->right, bits_per_sample, mono, 1,
                    chan_right_enc.size(), chan_right_enc.data());
       }
     }
 
     DLOG(INFO) << __func__ << " left_cis_handle: " << +left_cis_handle
                << " right_cis_handle: " << right_cis_handle;
-    /* Send data to the controller */
+    /* Send data to the controller, both CISes with the same time stamp */
+    bluetooth::hci::iso_manager::iso_sdu sdus[2];
+    uint8_t num_sdus = 0;
     if (left_cis_handle)
-      IsoManager::GetInstance()->SendIsoData(
-          left_cis_handle, chan_left_enc.data(), chan_left_enc.size());
+      sdus[num_sdus++] = {left_cis_handle, chan_left_enc.data(),
+                          (uint16_t)chan_left_enc.size()};
 
     if (right_cis_handle)
-      IsoManager::GetInstance()->SendIsoData(
-          right_cis_handle, chan_right_enc.data(), chan_right_enc.size());
-  }
+      sdus[num_sdus++] = {right_cis_handle, chan_right_enc.data(),
+                          (uint16_t)chan_right_enc.size()};
 
-  void PrepareAndSendToSingleCis(
-      const std::vector<uint8_t>& data,
-      struct le_audio::stream_configuration* stream_conf) {
-    int num_channels = stream_conf->sink_num_of_channels;
-    uint16_t byte_count = stream_conf->sink_octets_per_codec_frame;
-    auto cis_handle = stream_conf->sink_streams.front().first;
-    uint16_t number_of_required_samples_per_channel;
+    IsoManager::GetInstance()->SendIsoDataBatch(sdus, num_sdus);
+  }
 
-    int dt_us = current_source_codec_config.data_interval_us;
-    int af_hz = audio_framework_source_config.sample_rate;
-    number_of_required_samples_per_channel = lc3_frame_samples(dt_us, af_hz);
-    lc3_pcm_format bits_per_sample =
-        bits_to_lc3_bits(audio_framework_source_config.bits_per_sample);
-    uint8_t bytes_per_sample =
-        bits_to_bytes_per_sample(audio_framework_source_config.bits_per_sample);
+  void PrepareAndSendToSingleCis(const uint8_t* data, size_t size,
+                                 const SinkDataPath& data_path) {
+    int num_channels = data_path.num_channels;
+    uint16_t byte_count = data_path.octets_per_frame;
+    auto cis_handle = data_path.cis_handle;
+    uint16_t number_of_required_samples_per_channel = data_path.frame_samples;
+    lc3_pcm_format bits_per_sample = data_path.bits_per_sample;
+    SinkEncoders* encoders = data_path.encoders.get();
 
-    if ((int)data.size() < (2 /* bytes per sample */ * num_channels *
-                            number_of_required_samples_per_channel)) {
+    if ((int)size < (2 /* bytes per sample */ * num_channels *
+                     number_of_required_samples_per_channel)) {
       LOG(ERROR) << __func__ << "Missing samples";
       return;
     }
-    std::vector<uint8_t> chan_encoded(num_channels * byte_count, 0);
+    std::vector<uint8_t>& chan_encoded = encoders->encoded_left;
+    chan_encoded.resize(num_channels * byte_count);
 
     if (num_channels == 1) {
       /* Since we always get two channels from framework, lets make it mono here
        */
-      std::vector<uint8_t> mono = mono_blend(
-          data, bytes_per_sample, number_of_required_samples_per_channel);
+      const uint8_t* mono = mono_blend(data_path, data);
 
-      auto err = lc3_encode(lc3_encoder_left, bits_per_sample, mono.data(), 1,
+      auto err = lc3_encode(encoders->left, bits_per_sample, mono, 1,
                             byte_count, chan_encoded.data());
 
       if (err < 0) {
         LOG(ERROR) << " error while encoding, error code: " << +err;
       }
     } else {
-      lc3_encode(lc3_encoder_left, bits_per_sample, (const int16_t*)data.data(),
-                 2, byte_count, chan_encoded.data());
-      lc3_encode(lc3_encoder_right, bits_per_sample,
-                 (const int16_t*)data.data() + 1, 2, byte_count,
-                 chan_encoded.data() + byte_count);
+      lc3_encode(encoders->left, bits_per_sample, (const int16_t*)data, 2,
+                 byte_count, chan_encoded.data());
+      lc3_encode(encoders->right, bits_per_sample, (const int16_t*)data + 1, 2,
+                 byte_count, chan_encoded.data() + byte_count);
     }
 
     /* Send data to the controller */
@@ -2657,52 +2699,95 @@ class LeAudioClientImpl : public LeAudioClient {
                                            chan_encoded.size());
   }
 
-  const struct le_audio::stream_configuration* GetStreamSinkConfiguration(
-      LeAudioDeviceGroup* group) {
-    const struct le_audio::stream_configuration* stream_conf =
-        &group->stream_conf;
-    LOG_INFO("group_id: %d", group->group_id_);
-    if (stream_conf->sink_streams.size() == 0) {
-      return nullptr;
+  /* Publishes the sink stream configuration of |group| to the audio worker
+   * thread, or stops the encoding when |group| is null or the configuration
+   * is not valid. Runs on the main thread.
+   */
+  void UpdateSinkDataPath(LeAudioDeviceGroup* group) {
+    std::shared_ptr<const SinkDataPath> data_path;
+
+    if (group && sink_encoders_) {
+      const auto& stream_conf = group->stream_conf;
+      if ((stream_conf.sink_num_of_devices > 2) ||
+          (stream_conf.sink_num_of_devices == 0) ||
+          stream_conf.sink_streams.empty()) {
+        LOG_DEBUG("No valid sink stream configuration, %d devices",
+                  stream_conf.sink_num_of_devices);
+      } else {
+        auto new_data_path = std::make_shared<SinkDataPath>();
+        /* Streaming to two devices, or to one device but 2 CISes */
+        new_data_path->two_cises = (stream_conf.sink_num_of_devices == 2) ||
+                                   (stream_conf.sink_streams.size() == 2);
+        new_data_path->left_cis_handle = 0;
+        new_data_path->right_cis_handle = 0;
+        for (auto [cis_handle, audio_location] : stream_conf.sink_streams) {
+          if (audio_location &
+              le_audio::codec_spec_conf::kLeAudioLocationAnyLeft)
+            new_data_path->left_cis_handle = cis_handle;
+          if (audio_location &
+              le_audio::codec_spec_conf::kLeAudioLocationAnyRight)
+            new_data_path->right_cis_handle = cis_handle;
+        }
+        new_data_path->cis_handle = stream_conf.sink_streams.front().first;
+        new_data_path->num_channels = stream_conf.sink_num_of_channels;
+        new_data_path->octets_per_frame =
+            stream_conf.sink_octets_per_codec_frame;
+        new_data_path->frame_samples =
+            lc3_frame_samples(current_source_codec_config.data_interval_us,
+                              audio_framework_source_config.sample_rate);
+        new_data_path->bits_per_sample =
+            bits_to_lc3_bits(audio_framework_source_config.bits_per_sample);
+        new_data_path->bytes_per_sample = bits_to_bytes_per_sample(
+            audio_framework_source_config.bits_per_sample);
+        new_data_path->encoders = sink_encoders_;
+        data_path = std::move(new_data_path);
+      }
     }
 
-    LOG_INFO("configuration: %s", stream_conf->conf->name.c_str());
-    return stream_conf;
+    std::atomic_store(&sink_data_path_, std::move(data_path));
   }
 
-  void OnAudioDataReady(const std::vector<uint8_t>& data) {
-    if ((active_group_id_ == bluetooth::groups::kGroupUnknown) ||
-        (audio_sender_state_ != AudioState::STARTED))
-      return;
+  /* Runs on the audio worker thread of |le_audio_source_hal_client_| */
+  void OnAudioDataReady(const uint8_t* data, size_t size) {
+    if (audio_sender_state_ != AudioState::STARTED) return;
 
-    LeAudioDeviceGroup* group = aseGroups_.FindById(active_group_id_);
-    if (!group) {
+    /* Keep the snapshot, and the encoders, for the duration of the frame */
+    std::shared_ptr<const SinkDataPath> data_path =
+        std::atomic_load(&sink_data_path_);
+    if (!data_path) {
       LOG(ERROR) << __func__ << "There is no streaming group available";
       return;
     }
 
-    auto stream_conf = group->stream_conf;
-    if ((stream_conf.sink_num_of_devices > 2) ||
-        (stream_conf.sink_num_of_devices == 0) ||
-        stream_conf.sink_streams.empty()) {
-      LOG(ERROR) << __func__ << " Stream configufation is not valid.";
-      return;
+    static auto& encode_latency =
+        bluetooth::metrics::LatencyHistogram::Get("le_audio.sink_encode");
+    bluetooth::metrics::ScopedLatency scoped_latency(encode_latency);
+    bluetooth::os::ScopedTrace trace("LE Audio sink encode");
+    if (data_path->two_cises) {
+      PrepareAndSendToTwoCises(data, size, *data_path);
+    } else {
+      PrepareAndSendToSingleCis(data, size, *data_path);
     }
+  }
 
-    if (stream_conf.sink_num_of_devices == 2) {
-      PrepareAndSendToTwoCises(data, &stream_conf);
-    } else if (stream_conf.sink_streams.size() == 2) {
-      /* Streaming to one device but 2 CISes */
-      PrepareAndSendToTwoCises(data, &stream_conf);
-    } else {
-      PrepareAndSendToSingleCis(data, &stream_conf);
+  const struct le_audio::stream_configuration* GetStreamSinkConfiguration(
+      LeAudioDeviceGroup* group) {
+    const struct le_audio::stream_configuration* stream_conf =
+        &group->stream_conf;
+    LOG_INFO("group_id: %d", group->group_id_);
+    if (stream_conf->sink_streams.size() == 0) {
+      return nullptr;
     }
+
+    LOG_INFO("configuration: %s", stream_conf->conf->name.c_str());
+    return stream_conf;
   }
 
   void CleanCachedMicrophoneData() {
     cached_channel_data_.clear();
     cached_channel_timestamp_ = 0;
     cached_channel_is_left_ = false;
+    cached_channel_present_ = false;
   }
 
   /* Handles audio data packets coming from the controller */
@@ -2768,10 +2853,6 @@ class LeAudioClientImpl : public LeAudioClient {
       return;
     }
 
-    std::vector<int16_t> pcm_data_decoded(pcm_size, 0);
-
-    int err = 0;
-
     if (required_for_channel_byte_count != size) {
       LOG(INFO) << "Insufficient data for decoding and send, required: "
                 << int(required_for_channel_byte_count)
@@ -2780,51 +2861,43 @@ class LeAudioClientImpl : public LeAudioClient {
       data = nullptr;
     }
 
-    lc3_decoder_t decoder_to_use =
-        is_left ? lc3_decoder_left : lc3_decoder_right;
-
-    err = lc3_decode(decoder_to_use, data, size, bits_per_sample,
-                     pcm_data_decoded.data(), 1 /* pitch */);
-
-    if (err < 0) {
-      LOG(ERROR) << " bad decoding parameters: " << static_cast<int>(err);
-      return;
-    }
-
     /* AF == Audio Framework */
     bool af_is_stereo = (audio_framework_sink_config.num_channels == 2);
 
+    ChannelFrame frame = {.is_left = is_left, .data = data, .size = size};
+
     if (!left_cis_handle || !right_cis_handle) {
       /* mono or just one device connected */
-      SendAudioDataToAF(false /* bt_got_stereo */, af_is_stereo,
-                        &pcm_data_decoded, nullptr);
+      DecodeAndSendAudioDataToAF(&frame, 1, pcm_size, bits_per_sample,
+                                 af_is_stereo);
       return;
     }
     /* both devices are connected */
 
-    if (cached_channel_timestamp_ == 0 && cached_channel_data_.empty()) {
+    if (!cached_channel_present_) {
       /* First packet received, cache it. We need both channel data to send it
        * to AF. */
-      cached_channel_data_ = pcm_data_decoded;
-      cached_channel_timestamp_ = timestamp;
-      cached_channel_is_left_ = is_left;
+      CacheMicrophoneData(frame, timestamp);
       return;
     }
 
     /* We received either data for the other audio channel, or another
      * packet for same channel */
 
+    ChannelFrame cached_frame = {
+        .is_left = cached_channel_is_left_,
+        .data = cached_channel_data_.empty() ? nullptr
+                                             : cached_channel_data_.data(),
+        .size = static_cast<uint16_t>(cached_channel_data_.size())};
+
     if (cached_channel_is_left_ != is_left) {
       /* It's data for the 2nd channel */
       if (timestamp == cached_channel_timestamp_) {
-        /* Ready to mix data and send out to AF */
-        if (is_left) {
-          SendAudioDataToAF(true /* bt_got_stereo */, af_is_stereo,
-                            &cached_channel_data_, &pcm_data_decoded);
-        } else {
-          SendAudioDataToAF(true /* bt_got_stereo */, af_is_stereo,
-                            &pcm_data_decoded, &cached_channel_data_);
-        }
+        /* Ready to decode both channels and send out to AF */
+        ChannelFrame frames[2] = {is_left ? frame : cached_frame,
+                                  is_left ? cached_frame : frame};
+        DecodeAndSendAudioDataToAF(frames, 2, pcm_size, bits_per_sample,
+                                   af_is_stereo);
 
         CleanCachedMicrophoneData();
         return;
@@ -2833,74 +2906,91 @@ class LeAudioClientImpl : public LeAudioClient {
       /* 2nd Channel is in the future compared to the cached data.
        Send the cached data to AF, and keep the new channel data in cache.
        This should happen only during stream setup */
-
-      if (cached_channel_is_left_) {
-        SendAudioDataToAF(false /* bt_got_stereo */, af_is_stereo,
-                          &cached_channel_data_, nullptr);
-      } else {
-        SendAudioDataToAF(false /* bt_got_stereo */, af_is_stereo, nullptr,
-                          &cached_channel_data_);
-      }
-
-      cached_channel_data_ = pcm_data_decoded;
-      cached_channel_timestamp_ = timestamp;
-      cached_channel_is_left_ = is_left;
-      return;
     }
 
-    /* Data for same channel received. 2nd channel is down/not sending
-     * data */
+    /* Otherwise data for same channel received. 2nd channel is down/not
+     * sending data */
 
     /* Send the cached data out */
-    if (cached_channel_is_left_) {
-      SendAudioDataToAF(false /* bt_got_stereo */, af_is_stereo,
-                        &cached_channel_data_, nullptr);
-    } else {
-      SendAudioDataToAF(false /* bt_got_stereo */, af_is_stereo, nullptr,
-                        &cached_channel_data_);
-    }
+    DecodeAndSendAudioDataToAF(&cached_frame, 1, pcm_size, bits_per_sample,
+                               af_is_stereo);
 
     /* Cache the data in case 2nd channel connects */
-    cached_channel_data_ = pcm_data_decoded;
+    CacheMicrophoneData(frame, timestamp);
+  }
+
+  /* Encoded frame of a microphone channel, without data when it is lost */
+  struct ChannelFrame {
+    bool is_left;
+    const uint8_t* data;
+    uint16_t size;
+  };
+
+  void CacheMicrophoneData(const ChannelFrame& frame, uint32_t timestamp) {
+    cached_channel_data_.assign(frame.data, frame.data + frame.size);
     cached_channel_timestamp_ = timestamp;
-    cached_channel_is_left_ = is_left;
+    cached_channel_is_left_ = frame.is_left;
+    cached_channel_present_ = true;
   }
 
+  /* Decodes the frames of one channel, or of the left and right channels in
+   * a single call, and sends the decoded audio to AF */
+  void DecodeAndSendAudioDataToAF(const ChannelFrame* frames, int num_channels,
+                                  int pcm_size, lc3_pcm_format bits_per_sample,
+                                  bool af_is_stereo) {
+    lc3_decoder_t decoders[2];
+    const void* in[2];
+    int nbytes[2];
+
+    for (int ch = 0; ch < num_channels; ch++) {
+      decoders[ch] = frames[ch].is_left ? lc3_decoder_left : lc3_decoder_right;
+      in[ch] = frames[ch].data;
+      nbytes[ch] = frames[ch].size;
+    }
+
+    pcm_data_decoded_.resize(num_channels * pcm_size);
+
+    int err = lc3_decode_channels(decoders, num_channels, in, nbytes,
+                                  bits_per_sample, pcm_data_decoded_.data());
+
+    if (err < 0) {
+      LOG(ERROR) << " bad decoding parameters: " << static_cast<int>(err);
+      return;
+    }
+
+    SendAudioDataToAF(num_channels == 2 /* bt_got_stereo */, af_is_stereo,
+                      pcm_size);
+  }
+
+  /* Sends the |frames| frames decoded in |pcm_data_decoded_|, interleaved
+   * when |bt_got_stereo| is set */
   void SendAudioDataToAF(bool bt_got_stereo, bool af_is_stereo,
-                         std::vector<int16_t>* left,
-                         std::vector<int16_t>* right) {
+                         size_t frames) {
+    int16_t* pcm = pcm_data_decoded_.data();
     uint16_t to_write = 0;
     uint16_t written = 0;
-    if (!af_is_stereo) {
-      if (!bt_got_stereo) {
-        std::vector<int16_t>* mono = left ? left : right;
-        /* mono audio over bluetooth, audio framework expects mono */
-        to_write = sizeof(int16_t) * mono->size();
-        written = le_audio_sink_hal_client_->SendData((uint8_t*)mono->data(),
-                                                      to_write);
-      } else {
-        /* stereo audio over bluetooth, audio framework expects mono */
-        for (size_t i = 0; i < left->size(); i++) {
-          (*left)[i] = ((*left)[i] + (*right)[i]) / 2;
-        }
-        to_write = sizeof(int16_t) * left->size();
-        written = le_audio_sink_hal_client_->SendData((uint8_t*)left->data(),
-                                                      to_write);
+    if (af_is_stereo == bt_got_stereo) {
+      /* the audio framework expects the decoded channels */
+      to_write = sizeof(int16_t) * pcm_data_decoded_.size();
+      written = le_audio_sink_hal_client_->SendData((uint8_t*)pcm, to_write);
+    } else if (!af_is_stereo) {
+      /* stereo audio over bluetooth, audio framework expects mono */
+      for (size_t i = 0; i < frames; i++) {
+        pcm[i] = (pcm[2 * i] + pcm[2 * i + 1]) / 2;
       }
+      to_write = sizeof(int16_t) * frames;
+      written = le_audio_sink_hal_client_->SendData((uint8_t*)pcm, to_write);
     } else {
-      /* mono audio over bluetooth, audio framework expects stereo
-       * Here we handle stream without checking bt_got_stereo flag.
-       */
-      const size_t mono_size = left ? left->size() : right->size();
-      std::vector<uint16_t> mixed(mono_size * 2);
+      /* mono audio over bluetooth, audio framework expects stereo */
+      mixed_data_decoded_.resize(frames * 2);
 
-      for (size_t i = 0; i < mono_size; i++) {
-        mixed[2 * i] = left ? (*left)[i] : (*right)[i];
-        mixed[2 * i + 1] = right ? (*right)[i] : (*left)[i];
+      for (size_t i = 0; i < frames; i++) {
+        mixed_data_decoded_[2 * i] = pcm[i];
+        mixed_data_decoded_[2 * i + 1] = pcm[i];
       }
-      to_write = sizeof(int16_t) * mixed.size();
-      written =
-          le_audio_sink_hal_client_->SendData((uint8_t*)mixed.data(), to_write);
+      to_write = sizeof(int16_t) * mixed_data_decoded_.size();
+      written = le_audio_sink_hal_client_->SendData(
+          (uint8_t*)mixed_data_decoded_.data(), to_write);
     }
 
     /* TODO: What to do if not all data sinked ? */
@@ -2939,26 +3029,16 @@ class LeAudioClientImpl : public LeAudioClient {
         group->GetRemoteDelay(le_audio::types::kLeAudioDirectionSink);
     if (CodecManager::GetInstance()->GetCodecLocation() ==
         le_audio::types::CodecLocation::HOST) {
-      if (lc3_encoder_left_mem) {
+      if (sink_encoders_) {
         LOG(WARNING)
             << " The encoder instance should have been already released.";
-        free(lc3_encoder_left_mem);
-        lc3_encoder_left_mem = nullptr;
-        free(lc3_encoder_right_mem);
-        lc3_encoder_right_mem = nullptr;
       }
-      int dt_us = current_source_codec_config.data_interval_us;
-      int sr_hz = current_source_codec_config.sample_rate;
-      int af_hz = audio_framework_source_config.sample_rate;
-      unsigned enc_size = lc3_encoder_size(dt_us, af_hz);
-
-      lc3_encoder_left_mem = malloc(enc_size);
-      lc3_encoder_right_mem = malloc(enc_size);
-
-      lc3_encoder_left =
-          lc3_setup_encoder(dt_us, sr_hz, af_hz, lc3_encoder_left_mem);
-      lc3_encoder_right =
-          lc3_setup_encoder(dt_us, sr_hz, af_hz, lc3_encoder_right_mem);
+      /* The worker thread may still use the previous encoders until it takes
+       * the new configuration */
+      sink_encoders_ = std::make_shared<SinkEncoders>(
+          current_source_codec_config, audio_framework_source_config,
+          stream_conf->sink_octets_per_codec_frame);
+      UpdateSinkDataPath(group);
     }
 
     le_audio_source_hal_client_->UpdateRemoteDelay(remote_delay_ms);
@@ -3039,12 +3119,9 @@ class LeAudioClientImpl : public LeAudioClient {
   void SuspendAudio(void) {
     CancelStreamingRequest();
 
-    if (lc3_encoder_left_mem) {
-      free(lc3_encoder_left_mem);
-      lc3_encoder_left_mem = nullptr;
-      free(lc3_encoder_right_mem);
-      lc3_encoder_right_mem = nullptr;
-    }
+    /* The encoders are freed once the worker thread is done with them */
+    sink_encoders_.reset();
+    UpdateSinkDataPath(nullptr);
 
     if (lc3_decoder_left_mem) {
       free(lc3_decoder_left_mem);
@@ -4408,11 +4485,11 @@ class LeAudioClientImpl : public LeAudioClient {
       .data_interval_us = LeAudioCodecConfiguration::kInterval10000Us,
   };
 
-  void* lc3_encoder_left_mem;
-  void* lc3_encoder_right_mem;
-
-  lc3_encoder_t lc3_encoder_left;
-  lc3_encoder_t lc3_encoder_right;
+  /* LC3 encoders of the current sink streams, and the configuration of the
+   * streams published to the audio worker thread, accessed with
+   * std::atomic_load() and std::atomic_store() */
+  std::shared_ptr<SinkEncoders> sink_encoders_;
+  std::shared_ptr<const SinkDataPath> sink_data_path_;
 
   void* lc3_decoder_left_mem;
   void* lc3_decoder_right_mem;
@@ -4432,9 +4509,15 @@ class LeAudioClientImpl : public LeAudioClient {
   alarm_t* disable_timer_;
   static constexpr uint64_t kDeviceAttachDelayMs = 500;
 
-  std::vector<int16_t> cached_channel_data_;
+  /* Encoded frame of the first channel received, until the frame of the
+   * other channel with the same timestamp is received */
+  std::vector<uint8_t> cached_channel_data_;
   uint32_t cached_channel_timestamp_ = 0;
   uint32_t cached_channel_is_left_;
+  bool cached_channel_present_ = false;
+  /* Per frame buffers of the LC3 decoding path */
+  std::vector<int16_t> pcm_data_decoded_;
+  std::vector<int16_t> mixed_data_decoded_;
 
   void ClientAudioIntefraceRelease() {
     if (le_audio_source_hal_client_) {
@@ -4560,6 +4643,10 @@ class CallbacksImpl : public LeAudioGroupStateMachine::Callbacks {
   void OnStateTransitionTimeout(int group_id) override {
     if (instance) instance->OnLeAudioDeviceSetStateTimeout(group_id);
   }
+
+  void OnUpdatedCisConfiguration(int group_id, uint8_t direction) override {
+    if (instance) instance->OnUpdatedCisConfiguration(group_id, direction);
+  }
 };
 
 CallbacksImpl stateMachineCallbacksImpl;
@@ -4567,7 +4654,10 @@ CallbacksImpl stateMachineCallbacksImpl;
 class SourceCallbacksImpl : public LeAudioSourceAudioHalClient::Callbacks {
  public:
   void OnAudioDataReady(const std::vector<uint8_t>& data) override {
-    if (instance) instance->OnAudioDataReady(data);
+    if (instance) instance->OnAudioDataReady(data.data(), data.size());
+  }
+  void OnAudioDataReadyInPlace(const uint8_t* data, size_t size) override {
+    if (instance) instance->OnAudioDataReady(data, size);
   }
   void OnAudioSuspend(std::promise<void> do_suspend_promise) override {
     if (instance) instance->OnLocalAudioSourceSuspend();
@@ -358,6 +358,30 @@ bool LeAudioDeviceGroup::HaveAllActiveDevicesAsesTheSameState(AseState state) {
   return iter == leAudioDevices_.end();
 }
 
+bool LeAudioDeviceGroup::HaveAnyActiveDeviceInUnconfiguredState(void) {
+  auto iter = std::find_if(
+      leAudioDevices_.begin(), leAudioDevices_.end(), [](auto& d) {
+        if (d.expired())
+          return false;
+        else
+          return (((d.lock()).get())->HaveAnyUnconfiguredAses());
+      });
+
+  return iter != leAudioDevices_.end();
+}
+
+bool LeAudioDeviceGroup::HaveAllActiveDevicesReadyToCreateStream(void) {
+  auto iter = std::find_if(
+      leAudioDevices_.begin(), leAudioDevices_.end(), [](auto& d) {
+        if (d.expired())
+          return false;
+        else
+          return !(((d.lock()).get())->IsReadyToCreateStream());
+      });
+
+  return iter == leAudioDevices_.end();
+}
+
 LeAudioDevice* LeAudioDeviceGroup::GetFirstActiveDevice(void) {
   auto iter =
       std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(), [](auto& d) {
@@ -1909,12 +1933,89 @@ bool LeAudioDeviceGroup::IsConfigurationSupported(
   return false;
 }
 
+/* Serializes the state of the group members which IsConfigurationSupported()
+ * depends on for the given context type: the connection and available context
+ * of each device, its audio locations, ASEs and PACs, and the group size and
+ * audio locations used to pick the group strategy.
+ */
+std::vector<uint8_t> LeAudioDeviceGroup::GetConfigurationLookupKey(
+    LeAudioContextType context_type) {
+  std::vector<uint8_t> key;
+  auto append_u32 = [&key](uint32_t value) {
+    for (int i = 0; i < 4; i++) key.push_back((value >> (8 * i)) & 0xff);
+  };
+  auto append_pacs = [&key, &append_u32](
+                         const types::PublishedAudioCapabilities& pacs) {
+    for (const auto& pac_tuple : pacs) {
+      for (const auto& pac : std::get<1>(pac_tuple)) {
+        auto caps = pac.codec_spec_caps.RawPacket();
+        key.push_back(pac.codec_id.coding_format);
+        append_u32(pac.codec_id.vendor_company_id);
+        append_u32(pac.codec_id.vendor_codec_id);
+        append_u32(caps.size());
+        key.insert(key.end(), caps.begin(), caps.end());
+      }
+    }
+    /* Marks the end of the list */
+    key.push_back(0xff);
+  };
+
+  append_u32(Size());
+  append_u32(snk_audio_locations_.to_ulong());
+
+  for (const auto& device_iter : leAudioDevices_) {
+    auto device = device_iter.lock();
+    if (!device) {
+      key.push_back(0);
+      continue;
+    }
+
+    key.push_back(1);
+    key.push_back(device->conn_id_ != GATT_INVALID_CONN_ID);
+    key.push_back(device->GetAvailableContexts().test(context_type));
+    append_u32(device->GetAseCount(types::kLeAudioDirectionSink));
+    append_u32(device->GetAseCount(types::kLeAudioDirectionSource));
+    append_u32(device->snk_audio_locations_.to_ulong());
+    append_u32(device->src_audio_locations_.to_ulong());
+    append_pacs(device->snk_pacs_);
+    append_pacs(device->src_pacs_);
+  }
+
+  return key;
+}
+
 const set_configurations::AudioSetConfiguration*
 LeAudioDeviceGroup::FindFirstSupportedConfiguration(
     LeAudioContextType context_type) {
   const set_configurations::AudioSetConfigurations* confs =
       AudioSetConfigurationProvider::Get()->GetConfigurations(context_type);
 
+  /* Matching every configuration against the PACs of every device is costly,
+   * and the availability of all the context types is checked again on each
+   * context change of any group member. Reuse the previous result while the
+   * group members involved did not change.
+   */
+  auto key = GetConfigurationLookupKey(context_type);
+  auto cached = configuration_lookup_cache_.find(context_type);
+  if (cached != configuration_lookup_cache_.end() &&
+      cached->second.confs == confs && cached->second.key == key) {
+    LOG_DEBUG("context type: %s, reusing configuration: %s",
+              bluetooth::common::ToString(context_type).c_str(),
+              cached->second.conf ? cached->second.conf->name.c_str()
+                                  : "none");
+    return cached->second.conf;
+  }
+
+  auto conf = MatchFirstSupportedConfiguration(confs, context_type);
+  configuration_lookup_cache_[context_type] = {
+      .confs = confs, .key = std::move(key), .conf = conf};
+  return conf;
+}
+
+const set_configurations::AudioSetConfiguration*
+LeAudioDeviceGroup::MatchFirstSupportedConfiguration(
+    const set_configurations::AudioSetConfigurations* confs,
+    LeAudioContextType context_type) {
   LOG_DEBUG("context type: %s,  number of connected devices: %d",
             bluetooth::common::ToString(context_type).c_str(),
             +NumOfConnected());
@@ -2677,6 +2778,7 @@ void LeAudioDevice::DeactivateAllAses(void) {
     ase.state = AseState::BTA_LE_AUDIO_ASE_STATE_IDLE;
     ase.data_path_state = AudioStreamDataPathState::IDLE;
     ase.active = false;
+    ase.confirmed_codec_config.reset();
     ase.cis_id = le_audio::kInvalidCisId;
     ase.cis_conn_hdl = 0;
   }
@@ -2798,9 +2900,27 @@ void LeAudioDevices::Remove(const RawAddress& address) {
     return;
   }
 
+  RemoveFromIndexes(iter->get());
   leAudioDevices_.erase(iter);
 }
 
+void LeAudioDevices::RemoveFromIndexes(const LeAudioDevice* leAudioDevice) {
+  auto remove_device = [leAudioDevice](auto& index) {
+    for (auto it = index.begin(); it != index.end();) {
+      if (it->second == leAudioDevice) {
+        /* Erasing invalidates the iterators, start over */
+        index.erase(it);
+        it = index.begin();
+      } else {
+        ++it;
+      }
+    }
+  };
+
+  remove_device(conn_id_index_);
+  remove_device(cis_conn_hdl_index_);
+}
+
 LeAudioDevice* LeAudioDevices::FindByAddress(const RawAddress& address) {
   auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
                            [&address](auto const& leAudioDevice) {
@@ -2821,16 +2941,40 @@ std::shared_ptr<LeAudioDevice> LeAudioDevices::GetByAddress(
 }
 
 LeAudioDevice* LeAudioDevices::FindByConnId(uint16_t conn_id) {
+  /* All the disconnected devices share the invalid connection ID */
+  bool indexed = (conn_id != GATT_INVALID_CONN_ID);
+  if (indexed) {
+    auto index = conn_id_index_.find(conn_id);
+    if (index != conn_id_index_.end() && index->second->conn_id_ == conn_id)
+      return index->second;
+  }
+
   auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
                            [&conn_id](auto const& leAudioDevice) {
                              return leAudioDevice->conn_id_ == conn_id;
                            });
 
-  return (iter == leAudioDevices_.end()) ? nullptr : iter->get();
+  if (iter == leAudioDevices_.end()) {
+    if (indexed) conn_id_index_.erase(conn_id);
+    return nullptr;
+  }
+
+  if (indexed) conn_id_index_[conn_id] = iter->get();
+  return iter->get();
 }
 
 LeAudioDevice* LeAudioDevices::FindByCisConnHdl(uint8_t cig_id,
                                                 uint16_t conn_hdl) {
+  uint32_t key = (static_cast<uint32_t>(cig_id) << 16) | conn_hdl;
+  auto index = cis_conn_hdl_index_.find(key);
+  if (index != cis_conn_hdl_index_.end()) {
+    LeAudioDevice* dev = index->second;
+    if (dev->group_id_ == cig_id) {
+      BidirectAsesPair ases = dev->GetAsesByCisConnHdl(conn_hdl);
+      if (ases.sink || ases.source) return dev;
+    }
+  }
+
   auto iter = std::find_if(leAudioDevices_.begin(), leAudioDevices_.end(),
                            [&conn_hdl, &cig_id](auto& d) {
                              LeAudioDevice* dev;
@@ -2848,8 +2992,12 @@ LeAudioDevice* LeAudioDevices::FindByCisConnHdl(uint8_t cig_id,
                                return false;
                            });
 
-  if (iter == leAudioDevices_.end()) return nullptr;
+  if (iter == leAudioDevices_.end()) {
+    cis_conn_hdl_index_.erase(key);
+    return nullptr;
+  }
 
+  cis_conn_hdl_index_[key] = iter->get();
   return iter->get();
 }
 
@@ -2915,6 +3063,8 @@ void LeAudioDevices::Cleanup(tGATT_IF client_if) {
     }
   }
   leAudioDevices_.clear();
+  conn_id_index_.clear();
+  cis_conn_hdl_index_.clear();
 }
 
 }  // namespace le_audio
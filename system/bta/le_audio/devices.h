@@ -28,6 +28,7 @@
 #include "bta_groups.h"
 #include "btm_iso_api_types.h"
 #include "gatt_api.h"
+#include "gd/common/flat_hash_map.h"
 #include "le_audio_types.h"
 #include "osi/include/alarm.h"
 #include "osi/include/properties.h"
@@ -215,7 +216,16 @@ class LeAudioDevices {
   void Cleanup(tGATT_IF client_if);
 
  private:
+  void RemoveFromIndexes(const LeAudioDevice* leAudioDevice);
+
   std::vector<std::shared_ptr<LeAudioDevice>> leAudioDevices_;
+  /* Devices by connection ID and by CIG ID and CIS connection handle, for the
+   * lookups done on every GATT notification and ISO event. The connection ID
+   * and the CIS handles are updated directly on the devices, so an entry is
+   * checked against its device on lookup and refreshed by a scan when stale.
+   */
+  bluetooth::common::FlatHashMap<uint16_t, LeAudioDevice*> conn_id_index_;
+  bluetooth::common::FlatHashMap<uint32_t, LeAudioDevice*> cis_conn_hdl_index_;
 };
 
 /* LeAudioDeviceGroup class represents group of LeAudioDevices and allows to
@@ -285,6 +295,8 @@ class LeAudioDeviceGroup {
       types::AudioStreamDataPathState data_path_state);
   bool IsDeviceInTheGroup(LeAudioDevice* leAudioDevice);
   bool HaveAllActiveDevicesAsesTheSameState(types::AseState state);
+  bool HaveAnyActiveDeviceInUnconfiguredState(void);
+  bool HaveAllActiveDevicesReadyToCreateStream(void);
   bool IsGroupStreamReady(void);
   bool HaveAllCisesDisconnected(void);
   uint8_t GetFirstFreeCisId(void);
@@ -383,6 +395,10 @@ class LeAudioDeviceGroup {
 
   const set_configurations::AudioSetConfiguration*
   FindFirstSupportedConfiguration(types::LeAudioContextType context_type);
+  const set_configurations::AudioSetConfiguration*
+  MatchFirstSupportedConfiguration(
+      const set_configurations::AudioSetConfigurations* confs,
+      types::LeAudioContextType context_type);
   bool ConfigureAses(
       const set_configurations::AudioSetConfiguration* audio_set_conf,
       types::LeAudioContextType context_type,
@@ -392,6 +408,8 @@ class LeAudioDeviceGroup {
       const set_configurations::AudioSetConfiguration* audio_set_configuration,
       types::LeAudioContextType context_type);
   uint32_t GetTransportLatencyUs(uint8_t direction);
+  std::vector<uint8_t> GetConfigurationLookupKey(
+      types::LeAudioContextType context_type);
 
   /* Current configuration and metadata context types */
   types::LeAudioContextType configuration_context_type_;
@@ -416,6 +434,18 @@ class LeAudioDeviceGroup {
            const set_configurations::AudioSetConfiguration*>
       available_context_to_configuration_map;
 
+  /* Result of the last configuration lookup for each context type. The lookup
+   * key holds everything from the group members that the matching depends on,
+   * so that the result is reused until one of them changes.
+   */
+  struct ConfigurationLookup {
+    const set_configurations::AudioSetConfigurations* confs;
+    std::vector<uint8_t> key;
+    const set_configurations::AudioSetConfiguration* conf;
+  };
+  std::map<types::LeAudioContextType, ConfigurationLookup>
+      configuration_lookup_cache_;
+
   types::AseState target_state_;
   types::AseState current_state_;
   std::vector<std::weak_ptr<LeAudioDevice>> leAudioDevices_;
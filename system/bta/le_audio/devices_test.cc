@@ -165,6 +165,28 @@ TEST_F(LeAudioDevicesTest, test_find_by_conn_id_failed) {
   ASSERT_EQ(nullptr, devices_->FindByConnId(0x0006));
 }
 
+TEST_F(LeAudioDevicesTest, test_find_by_conn_id_after_change) {
+  devices_->Add(GetTestAddress(0), DeviceConnectState::CONNECTING_BY_USER);
+  devices_->Add(GetTestAddress(1), DeviceConnectState::CONNECTING_BY_USER);
+  LeAudioDevice* device_0 = devices_->FindByAddress(GetTestAddress(0));
+  LeAudioDevice* device_1 = devices_->FindByAddress(GetTestAddress(1));
+  device_0->conn_id_ = 0x0005;
+  ASSERT_EQ(device_0, devices_->FindByConnId(0x0005));
+
+  /* The connection ID is reused by another device */
+  device_0->conn_id_ = GATT_INVALID_CONN_ID;
+  device_1->conn_id_ = 0x0005;
+  ASSERT_EQ(device_1, devices_->FindByConnId(0x0005));
+
+  device_1->conn_id_ = GATT_INVALID_CONN_ID;
+  ASSERT_EQ(nullptr, devices_->FindByConnId(0x0005));
+
+  device_0->conn_id_ = 0x0006;
+  ASSERT_EQ(device_0, devices_->FindByConnId(0x0006));
+  devices_->Remove(GetTestAddress(0));
+  ASSERT_EQ(nullptr, devices_->FindByConnId(0x0006));
+}
+
 /* TODO: Add FindByCisConnHdl test cases (ASE) */
 
 }  // namespace
@@ -1120,6 +1142,47 @@ TEST_F(LeAudioAseConfigurationTest, test_unsupported_codec) {
   TestAsesInactive();
 }
 
+TEST_F(LeAudioAseConfigurationTest, test_pacs_change_updates_configuration) {
+  LeAudioDevice* device = AddTestDevice(1, 0);
+  auto context_type = LeAudioContextType::RINGTONE;
+
+  PublishedAudioCapabilitiesBuilder supported_builder;
+  supported_builder.Add(LeAudioCodecIdLc3,
+                        GetSamplingFrequency(Lc3SettingId::LC3_16_2),
+                        GetFrameDuration(Lc3SettingId::LC3_16_2),
+                        kLeAudioCodecLC3ChannelCountSingleChannel,
+                        GetOctetsPerCodecFrame(Lc3SettingId::LC3_16_2));
+  PublishedAudioCapabilitiesBuilder unsupported_builder;
+  unsupported_builder.Add(LeAudioCodecIdLc3,
+                          GetSamplingFrequency(Lc3SettingId::LC3_16_2),
+                          GetFrameDuration(Lc3SettingId::LC3_16_2),
+                          kLeAudioCodecLC3ChannelCountSingleChannel,
+                          GetOctetsPerCodecFrame(Lc3SettingId::LC3_16_2) / 2);
+
+  /* The result of an earlier lookup must not be reused once the PACs of a
+   * group member have changed
+   */
+  device->snk_pacs_ = supported_builder.Get();
+  group_->UpdateAudioContextTypeAvailability(AudioContexts(context_type));
+  ASSERT_TRUE(group_->Configure(context_type, AudioContexts(context_type)));
+  group_->Deactivate();
+
+  device->snk_pacs_ = unsupported_builder.Get();
+  ASSERT_TRUE(
+      group_->UpdateAudioContextTypeAvailability(AudioContexts(context_type)));
+  ASSERT_FALSE(group_->Configure(context_type, AudioContexts(context_type)));
+  TestAsesInactive();
+
+  /* Nothing changed, so is the availability */
+  ASSERT_FALSE(
+      group_->UpdateAudioContextTypeAvailability(AudioContexts(context_type)));
+
+  device->snk_pacs_ = supported_builder.Get();
+  ASSERT_TRUE(
+      group_->UpdateAudioContextTypeAvailability(AudioContexts(context_type)));
+  ASSERT_TRUE(group_->Configure(context_type, AudioContexts(context_type)));
+}
+
 TEST_F(LeAudioAseConfigurationTest, test_reconnection_media) {
   LeAudioDevice* left = AddTestDevice(2, 1);
   LeAudioDevice* right = AddTestDevice(2, 1);
@@ -706,8 +706,8 @@ class UnicastTestNoInit : public Test {
         });
 
     ON_CALL(mock_state_machine_, AttachToStream(_, _))
-        .WillByDefault([](LeAudioDeviceGroup* group,
-                          LeAudioDevice* leAudioDevice) {
+        .WillByDefault([this](LeAudioDeviceGroup* group,
+                              LeAudioDevice* leAudioDevice) {
           if (group->GetState() !=
               types::AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING) {
             return false;
@@ -789,6 +789,11 @@ class UnicastTestNoInit : public Test {
             }
           }
 
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSink);
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSource);
+
           return true;
         });
 
@@ -979,6 +984,11 @@ class UnicastTestNoInit : public Test {
             }
           }
 
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSink);
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSource);
+
           // Inject the state
           group->SetTargetState(
               types::AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING);
@@ -1074,6 +1084,10 @@ class UnicastTestNoInit : public Test {
           }
 
           group->CigUnassignCis(leAudioDevice);
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSink);
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSource);
 
           if (group->IsEmpty()) {
             group->cig_state_ = le_audio::types::CigState::NONE;
@@ -1083,8 +1097,9 @@ class UnicastTestNoInit : public Test {
 
     ON_CALL(mock_state_machine_, ProcessHciNotifCisDisconnected(_, _, _))
         .WillByDefault(
-            [](LeAudioDeviceGroup* group, LeAudioDevice* leAudioDevice,
-               const bluetooth::hci::iso_manager::cis_disconnected_evt* event) {
+            [this](LeAudioDeviceGroup* group, LeAudioDevice* leAudioDevice,
+                   const bluetooth::hci::iso_manager::cis_disconnected_evt*
+                       event) {
               if (!group) return;
               auto ases_pair =
                   leAudioDevice->GetAsesByCisConnHdl(event->cis_conn_hdl);
@@ -1158,6 +1173,10 @@ class UnicastTestNoInit : public Test {
               }
 
               group->CigUnassignCis(leAudioDevice);
+              state_machine_callbacks_->OnUpdatedCisConfiguration(
+                  group->group_id_, le_audio::types::kLeAudioDirectionSink);
+              state_machine_callbacks_->OnUpdatedCisConfiguration(
+                  group->group_id_, le_audio::types::kLeAudioDirectionSource);
             });
 
     ON_CALL(mock_state_machine_, StopStream(_))
@@ -1232,6 +1251,11 @@ class UnicastTestNoInit : public Test {
             }
           }
 
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSink);
+          state_machine_callbacks_->OnUpdatedCisConfiguration(
+              group->group_id_, le_audio::types::kLeAudioDirectionSource);
+
           // Inject the state
           group->SetTargetState(types::AseState::BTA_LE_AUDIO_ASE_STATE_IDLE);
           group->SetState(group->GetTargetState());
@@ -15,8 +15,14 @@
  *
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <string>
 #include <string_view>
+#include <tuple>
 
 #include "audio_set_configurations_generated.h"
 #include "audio_set_scenarios_generated.h"
@@ -26,6 +32,7 @@
 #include "le_audio_set_configuration_provider.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/properties.h"
 
 using le_audio::set_configurations::AudioSetConfiguration;
 using le_audio::set_configurations::AudioSetConfigurations;
@@ -38,31 +45,41 @@ using le_audio::types::LeAudioContextType;
 namespace le_audio {
 using ::le_audio::CodecManager;
 
+using LeAudioFlatFiles =
+    std::tuple<const char* /*binary*/, const char* /*schema*/,
+               const char* /*content*/>;
+
 #ifdef OS_ANDROID
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
-         "audio_set_configurations.bfbs",
-         "/apex/com.android.btservices/etc/bluetooth/le_audio/"
-         "audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {{"/apex/com.android.btservices/etc/bluetooth/"
-                             "le_audio/audio_set_scenarios.bfbs",
-                             "/apex/com.android.btservices/etc/bluetooth/"
-                             "le_audio/audio_set_scenarios.json"}};
+static const std::vector<LeAudioFlatFiles> kLeAudioSetConfigs = {
+    {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.bin",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.bfbs",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_configurations.json"}};
+static const std::vector<LeAudioFlatFiles> kLeAudioSetScenarios = {
+    {"/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.bin",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.bfbs",
+     "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+     "audio_set_scenarios.json"}};
 #else
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetConfigs = {
-        {"audio_set_configurations.bfbs", "audio_set_configurations.json"}};
-static const std::vector<
-    std::pair<const char* /*schema*/, const char* /*content*/>>
-    kLeAudioSetScenarios = {
-        {"audio_set_scenarios.bfbs", "audio_set_scenarios.json"}};
+static const std::vector<LeAudioFlatFiles> kLeAudioSetConfigs = {
+    {"audio_set_configurations.bin", "audio_set_configurations.bfbs",
+     "audio_set_configurations.json"}};
+static const std::vector<LeAudioFlatFiles> kLeAudioSetScenarios = {
+    {"audio_set_scenarios.bin", "audio_set_scenarios.bfbs",
+     "audio_set_scenarios.json"}};
 #endif
 
+/* The binary files are generated from the JSON files at build time. Setting
+ * this property loads the JSON files instead, so that they can be modified
+ * on a development device.
+ */
+static const char kLeAudioSetConfigsFromJsonProperty[] =
+    "persist.bluetooth.leaudio.set_configurations_from_json";
+
 /** Provides a set configurations for the given context type */
 struct AudioSetConfigurationProviderJson {
   static constexpr auto kDefaultScenario = "Media";
@@ -417,8 +434,13 @@ struct AudioSetConfigurationProviderJson {
     if (!ok) return ok;
 
     /* Import from flatbuffers */
-    auto configurations_root = bluetooth::le_audio::GetAudioSetConfigurations(
-        configurations_parser_.builder_.GetBufferPointer());
+    return LoadConfigurationsFromFlat(
+        bluetooth::le_audio::GetAudioSetConfigurations(
+            configurations_parser_.builder_.GetBufferPointer()));
+  }
+
+  bool LoadConfigurationsFromFlat(
+      const bluetooth::le_audio::AudioSetConfigurations* configurations_root) {
     if (!configurations_root) return false;
 
     auto flat_qos_configs = configurations_root->qos_configurations();
@@ -494,8 +516,12 @@ struct AudioSetConfigurationProviderJson {
     if (!ok) return ok;
 
     /* Import from flatbuffers */
-    auto scenarios_root = bluetooth::le_audio::GetAudioSetScenarios(
-        scenarios_parser_.builder_.GetBufferPointer());
+    return LoadScenariosFromFlat(bluetooth::le_audio::GetAudioSetScenarios(
+        scenarios_parser_.builder_.GetBufferPointer()));
+  }
+
+  bool LoadScenariosFromFlat(
+      const bluetooth::le_audio::AudioSetScenarios* scenarios_root) {
     if (!scenarios_root) return false;
 
     auto flat_scenarios = scenarios_root->scenarios();
@@ -515,16 +541,67 @@ struct AudioSetConfigurationProviderJson {
     return true;
   }
 
-  bool LoadContent(
-      std::vector<std::pair<const char* /*schema*/, const char* /*content*/>>
-          config_files,
-      std::vector<std::pair<const char* /*schema*/, const char* /*content*/>>
-          scenario_files) {
-    for (auto [schema, content] : config_files) {
+  /* Maps the |binary_file| flatbuffer in memory and, once it is verified to
+   * hold a valid |Root| table, imports it with |load| without any parsing.
+   */
+  template <typename Root, typename Loader>
+  static bool LoadFromBinaryFile(const char* binary_file, Loader load) {
+    int fd = open(binary_file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      LOG_WARN("Unable to open %s", binary_file);
+      return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+      LOG_WARN("Unable to get the size of %s", binary_file);
+      close(fd);
+      return false;
+    }
+
+    size_t size = st.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      LOG_WARN("Unable to map %s", binary_file);
+      return false;
+    }
+
+    flatbuffers::Verifier verifier(static_cast<const uint8_t*>(data), size);
+    bool ok = verifier.VerifyBuffer<Root>(nullptr);
+    if (ok) {
+      ok = load(flatbuffers::GetRoot<Root>(data));
+    } else {
+      LOG_ERROR("%s is not a valid flatbuffer", binary_file);
+    }
+
+    munmap(data, size);
+    return ok;
+  }
+
+  bool LoadContent(const std::vector<LeAudioFlatFiles>& config_files,
+                   const std::vector<LeAudioFlatFiles>& scenario_files) {
+    bool from_json =
+        osi_property_get_bool(kLeAudioSetConfigsFromJsonProperty, false);
+
+    /* The JSON files remain a fallback for the binary ones */
+    for (auto [binary, schema, content] : config_files) {
+      if (!from_json &&
+          LoadFromBinaryFile<bluetooth::le_audio::AudioSetConfigurations>(
+              binary, [this](const auto* root) {
+                return LoadConfigurationsFromFlat(root);
+              }))
+        continue;
       if (!LoadConfigurationsFromFiles(schema, content)) return false;
     }
 
-    for (auto [schema, content] : scenario_files) {
+    for (auto [binary, schema, content] : scenario_files) {
+      if (!from_json &&
+          LoadFromBinaryFile<bluetooth::le_audio::AudioSetScenarios>(
+              binary, [this](const auto* root) {
+                return LoadScenariosFromFlat(root);
+              }))
+        continue;
       if (!LoadScenariosFromFiles(schema, content)) return false;
     }
     return true;
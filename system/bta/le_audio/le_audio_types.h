@@ -665,6 +665,20 @@ struct ase {
 
   std::vector<uint8_t> metadata;
 
+  /* Codec configuration the server confirmed for this ASE on our Codec
+   * Configure, with the QoS it prefers for it. A Codec Configure of the same
+   * configuration is not sent again while the server keeps it.
+   */
+  struct ConfirmedCodecConfig {
+    LeAudioCodecId codec_id;
+    std::vector<uint8_t> codec_spec_conf;
+    uint8_t target_latency;
+    uint8_t target_phy;
+    uint8_t preferred_retrans_nb;
+    uint16_t max_transport_latency;
+  };
+  std::optional<ConfirmedCodecConfig> confirmed_codec_config;
+
   AseState state;
 };
 
@@ -21,6 +21,14 @@
 #include "le_audio_types.h"
 #include "osi/include/log.h"
 
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define LE_AUDIO_MONO_BLEND_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LE_AUDIO_MONO_BLEND_SSE2
+#endif
+
 using bluetooth::common::ToString;
 using le_audio::types::AudioContexts;
 using le_audio::types::LeAudioContextType;
@@ -242,5 +250,71 @@ std::vector<uint8_t> GetAllCcids(const AudioContexts& contexts) {
   return ccid_vec;
 }
 
+/* Mix the 16 bit frames with NEON or SSE2, 8 frames at a time. The sum of the
+ * two samples is computed on 32 bits, and its sign bit is added before the
+ * shift so that the division rounds to 0 like the C code. Returns the number
+ * of frames mixed.
+ */
+static size_t MonoBlendS16Simd(const int16_t* in, size_t frames,
+                               int16_t* out) {
+  size_t i = 0;
+#if defined(LE_AUDIO_MONO_BLEND_NEON)
+  for (; i + 8 <= frames; i += 8, in += 16, out += 8) {
+    int16x8x2_t lr = vld2q_s16(in);
+    int32x4_t lo = vaddl_s16(vget_low_s16(lr.val[0]), vget_low_s16(lr.val[1]));
+    int32x4_t hi =
+        vaddl_s16(vget_high_s16(lr.val[0]), vget_high_s16(lr.val[1]));
+    uint32x4_t lo_sign = vshrq_n_u32(vreinterpretq_u32_s32(lo), 31);
+    uint32x4_t hi_sign = vshrq_n_u32(vreinterpretq_u32_s32(hi), 31);
+    lo = vaddq_s32(lo, vreinterpretq_s32_u32(lo_sign));
+    hi = vaddq_s32(hi, vreinterpretq_s32_u32(hi_sign));
+    vst1q_s16(out, vcombine_s16(vshrn_n_s32(lo, 1), vshrn_n_s32(hi, 1)));
+  }
+#elif defined(LE_AUDIO_MONO_BLEND_SSE2)
+  for (; i + 8 <= frames; i += 8, in += 16, out += 8) {
+    __m128i a = _mm_loadu_si128((const __m128i*)in);
+    __m128i b = _mm_loadu_si128((const __m128i*)(in + 8));
+    /* Left samples are in the low half of each 32 bit lane */
+    __m128i lo = _mm_add_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                               _mm_srai_epi32(a, 16));
+    __m128i hi = _mm_add_epi32(_mm_srai_epi32(_mm_slli_epi32(b, 16), 16),
+                               _mm_srai_epi32(b, 16));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, _mm_srli_epi32(lo, 31)), 1);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, _mm_srli_epi32(hi, 31)), 1);
+    _mm_storeu_si128((__m128i*)out, _mm_packs_epi32(lo, hi));
+  }
+#endif
+  return i;
+}
+
+bool MonoBlend(const uint8_t* in, int bytes_per_sample, size_t frames,
+               uint8_t* out) {
+  if (bytes_per_sample == 2) {
+    const int16_t* in16 = (const int16_t*)in;
+    int16_t* out16 = (int16_t*)out;
+    size_t i = MonoBlendS16Simd(in16, frames, out16);
+    for (in16 += 2 * i; i < frames; ++i) {
+      int accum = 0;
+      accum += *in16++;
+      accum += *in16++;
+      accum /= 2;  // round to 0
+      out16[i] = accum;
+    }
+  } else if (bytes_per_sample == 4) {
+    const int32_t* in32 = (const int32_t*)in;
+    int32_t* out32 = (int32_t*)out;
+    for (size_t i = 0; i < frames; ++i) {
+      int accum = 0;
+      accum += *in32++;
+      accum += *in32++;
+      accum /= 2;  // round to 0
+      *out32++ = accum;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
 }  // namespace utils
 }  // namespace le_audio
@@ -19,6 +19,8 @@
 #include <hardware/audio.h>
 
 #include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "le_audio_types.h"
@@ -35,6 +37,14 @@ types::AudioContexts GetAllowedAudioContextsFromSinkMetadata(
     types::AudioContexts allowed_contexts);
 std::vector<uint8_t> GetAllCcids(const types::AudioContexts& contexts);
 
+/* Mix |frames| interleaved stereo frames of 16 or 32 bit samples from |in|
+ * into |frames| mono samples in |out|. Each output sample is the average of
+ * the two input samples, rounded to 0. Returns false for any other sample
+ * size.
+ */
+bool MonoBlend(const uint8_t* in, int bytes_per_sample, size_t frames,
+               uint8_t* out);
+
 static inline bool IsContextForAudioSource(types::LeAudioContextType c) {
   if (c == types::LeAudioContextType::CONVERSATIONAL ||
       c == types::LeAudioContextType::VOICEASSISTANTS ||
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "le_audio_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace le_audio {
+namespace utils {
+
+TEST(LeAudioUtilsTest, test_mono_blend_s16) {
+  /* Odd frame count, so that both the SIMD and the scalar code are used */
+  const size_t frames = 4 * 8 + 3;
+  std::vector<int16_t> stereo(2 * frames);
+  uint32_t seed = 0x12345678;
+  for (auto& sample : stereo) {
+    seed = seed * 1664525 + 1013904223;
+    sample = (int16_t)(seed >> 16);
+  }
+  stereo[0] = stereo[1] = INT16_MIN;
+  stereo[2] = stereo[3] = INT16_MAX;
+  stereo[4] = -3;
+  stereo[5] = 0;
+
+  std::vector<int16_t> mono(frames);
+  ASSERT_TRUE(MonoBlend((const uint8_t*)stereo.data(), 2, frames,
+                        (uint8_t*)mono.data()));
+  for (size_t i = 0; i < frames; ++i) {
+    ASSERT_EQ(mono[i], (stereo[2 * i] + stereo[2 * i + 1]) / 2) << i;
+  }
+}
+
+TEST(LeAudioUtilsTest, test_mono_blend_s32) {
+  std::vector<int32_t> stereo = {-3, 0, 100, 200, -1000000, 3000000};
+  std::vector<int32_t> mono(stereo.size() / 2);
+  ASSERT_TRUE(MonoBlend((const uint8_t*)stereo.data(), 4, mono.size(),
+                        (uint8_t*)mono.data()));
+  ASSERT_EQ(mono, std::vector<int32_t>({-1, 150, 1000000}));
+}
+
+TEST(LeAudioUtilsTest, test_mono_blend_unsupported_sample_size) {
+  uint8_t stereo[6] = {0};
+  uint8_t mono[3];
+  ASSERT_FALSE(MonoBlend(stereo, 3, 1, mono));
+}
+
+}  // namespace utils
+}  // namespace le_audio
@@ -283,6 +283,39 @@ void MetricsCollector::OnStreamEnded(int32_t group_id) {
   }
 }
 
+void MetricsCollector::OnAseConfigurationPhaseStarted(
+    int32_t group_id, AseConfigurationPhase phase) {
+  if (group_id <= 0) return;
+  ase_configuration_timings_[group_id].started[static_cast<size_t>(phase)] =
+      std::chrono::steady_clock::now();
+}
+
+void MetricsCollector::OnAseConfigurationPhaseCompleted(
+    int32_t group_id, AseConfigurationPhase phase) {
+  auto it = ase_configuration_timings_.find(group_id);
+  if (it == ase_configuration_timings_.end()) return;
+
+  auto& started = it->second.started[static_cast<size_t>(phase)];
+  // The phase was not started for the whole group, e.g. on a reconnection
+  if (started == std::chrono::steady_clock::time_point{}) return;
+
+  int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - started)
+                      .count();
+  it->second.last_nanos[static_cast<size_t>(phase)] = nanos;
+  started = std::chrono::steady_clock::time_point{};
+  LOG(INFO) << __func__ << ": group " << group_id << " phase "
+            << static_cast<int32_t>(phase) << " took " << nanos / 1000
+            << " us";
+}
+
+int64_t MetricsCollector::GetAseConfigurationPhaseNanos(
+    int32_t group_id, AseConfigurationPhase phase) const {
+  auto it = ase_configuration_timings_.find(group_id);
+  if (it == ase_configuration_timings_.end()) return -1;
+  return it->second.last_nanos[static_cast<size_t>(phase)];
+}
+
 void MetricsCollector::Flush() {
   LOG(INFO) << __func__;
   for (auto& p : opened_groups_) {
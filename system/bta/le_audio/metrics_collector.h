@@ -18,6 +18,8 @@
 
 #include <hardware/bt_le_audio.h>
 
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <unordered_map>
@@ -51,6 +53,13 @@ enum class LeAudioMetricsContextType : int32_t {
   RFU = 13,
 };
 
+/* Phases of the ASE configuration of a group, before it streams */
+enum class AseConfigurationPhase : int32_t {
+  CODEC_CONFIGURE = 0,
+  QOS_CONFIGURE = 1,
+  ENABLE = 2,
+};
+
 class GroupMetrics {
  public:
   GroupMetrics() {}
@@ -116,6 +125,36 @@ class MetricsCollector {
    */
   void OnStreamEnded(int32_t group_id);
 
+  /**
+   * When the ASE control point writes of a configuration phase are sent to
+   * the group
+   *
+   * @param group_id ID of target group
+   * @param phase The configuration phase
+   */
+  void OnAseConfigurationPhaseStarted(int32_t group_id,
+                                      AseConfigurationPhase phase);
+
+  /**
+   * When all the devices of the group notified the end of a configuration
+   * phase
+   *
+   * @param group_id ID of target group
+   * @param phase The configuration phase
+   */
+  void OnAseConfigurationPhaseCompleted(int32_t group_id,
+                                        AseConfigurationPhase phase);
+
+  /**
+   * Duration of the last completed configuration phase of a group
+   *
+   * @param group_id ID of target group
+   * @param phase The configuration phase
+   * @return duration in nanoseconds, -1 if the phase never completed
+   */
+  int64_t GetAseConfigurationPhaseNanos(int32_t group_id,
+                                        AseConfigurationPhase phase) const;
+
   /**
    * Flush all log to statsd
    *
@@ -131,6 +170,14 @@ class MetricsCollector {
 
   std::unordered_map<int32_t, std::unique_ptr<GroupMetrics>> opened_groups_;
   std::unordered_map<int32_t, int32_t> group_size_table_;
+
+  struct AseConfigurationTimings {
+    static constexpr size_t kNumPhases = 3;
+    std::array<std::chrono::steady_clock::time_point, kNumPhases> started{};
+    std::array<int64_t, kNumPhases> last_nanos{-1, -1, -1};
+  };
+  std::unordered_map<int32_t, AseConfigurationTimings>
+      ase_configuration_timings_;
 };
 
 }  // namespace le_audio
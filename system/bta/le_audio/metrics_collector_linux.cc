@@ -40,6 +40,17 @@ void MetricsCollector::OnStreamStarted(
 
 void MetricsCollector::OnStreamEnded(int32_t group_id) {}
 
+void MetricsCollector::OnAseConfigurationPhaseStarted(
+    int32_t group_id, AseConfigurationPhase phase) {}
+
+void MetricsCollector::OnAseConfigurationPhaseCompleted(
+    int32_t group_id, AseConfigurationPhase phase) {}
+
+int64_t MetricsCollector::GetAseConfigurationPhaseNanos(
+    int32_t group_id, AseConfigurationPhase phase) const {
+  return -1;
+}
+
 void MetricsCollector::Flush() {}
 
 }  // namespace le_audio
@@ -367,4 +367,39 @@ TEST_F(MetricsCollectorTest, StreamingSessions) {
             static_cast<int32_t>(LeAudioMetricsContextType::COMMUNICATION));
 }
 
+TEST_F(MetricsCollectorTest, AseConfigurationPhases) {
+  ASSERT_EQ(collector->GetAseConfigurationPhaseNanos(
+                group_id1, AseConfigurationPhase::CODEC_CONFIGURE),
+            -1L);
+
+  collector->OnAseConfigurationPhaseStarted(
+      group_id1, AseConfigurationPhase::CODEC_CONFIGURE);
+  collector->OnAseConfigurationPhaseCompleted(
+      group_id1, AseConfigurationPhase::CODEC_CONFIGURE);
+  collector->OnAseConfigurationPhaseStarted(
+      group_id1, AseConfigurationPhase::QOS_CONFIGURE);
+  collector->OnAseConfigurationPhaseCompleted(
+      group_id1, AseConfigurationPhase::QOS_CONFIGURE);
+
+  /* Completion without a start, as on a reconnection, is not measured */
+  collector->OnAseConfigurationPhaseCompleted(group_id1,
+                                              AseConfigurationPhase::ENABLE);
+  collector->OnAseConfigurationPhaseCompleted(
+      group_id2, AseConfigurationPhase::CODEC_CONFIGURE);
+
+  ASSERT_GE(collector->GetAseConfigurationPhaseNanos(
+                group_id1, AseConfigurationPhase::CODEC_CONFIGURE),
+            0L);
+  ASSERT_GE(collector->GetAseConfigurationPhaseNanos(
+                group_id1, AseConfigurationPhase::QOS_CONFIGURE),
+            0L);
+  ASSERT_EQ(collector->GetAseConfigurationPhaseNanos(
+                group_id1, AseConfigurationPhase::ENABLE),
+            -1L);
+  ASSERT_EQ(collector->GetAseConfigurationPhaseNanos(
+                group_id2, AseConfigurationPhase::CODEC_CONFIGURE),
+            -1L);
+  ASSERT_EQ(log_count, 0);
+}
+
 }  // namespace le_audio
\ No newline at end of file
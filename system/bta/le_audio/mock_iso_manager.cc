@@ -95,6 +95,14 @@ void IsoManager::SendIsoData(uint16_t iso_handle, const uint8_t* data,
   pimpl_->SendIsoData(iso_handle, data, data_len);
 }
 
+void IsoManager::SendIsoDataBatch(const iso_manager::iso_sdu* sdus,
+                                  uint8_t num_sdus) {
+  if (!pimpl_) return;
+  for (uint8_t i = 0; i < num_sdus; ++i) {
+    pimpl_->SendIsoData(sdus[i].conn_handle, sdus[i].data, sdus[i].data_len);
+  }
+}
+
 void IsoManager::CreateBig(uint8_t big_id,
                            struct iso_manager::big_create_params big_params) {
   if (!pimpl_) return;
@@ -33,6 +33,7 @@
 #include "gd/common/strings.h"
 #include "hcimsgs.h"
 #include "le_audio_types.h"
+#include "metrics_collector.h"
 #include "osi/include/alarm.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
@@ -92,10 +93,12 @@
 using bluetooth::common::ToString;
 using bluetooth::hci::IsoManager;
 using bluetooth::le_audio::GroupStreamStatus;
+using le_audio::AseConfigurationPhase;
 using le_audio::CodecManager;
 using le_audio::LeAudioDevice;
 using le_audio::LeAudioDeviceGroup;
 using le_audio::LeAudioGroupStateMachine;
+using le_audio::MetricsCollector;
 
 using le_audio::types::ase;
 using le_audio::types::AseState;
@@ -123,7 +126,9 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
  public:
   LeAudioGroupStateMachineImpl(Callbacks* state_machine_callbacks_)
       : state_machine_callbacks_(state_machine_callbacks_),
-        watchdog_(alarm_new("LeAudioStateMachineTimer")) {}
+        watchdog_(alarm_new("LeAudioStateMachineTimer")),
+        parallel_ase_configuration_(
+            osi_property_get_bool(kParallelAseConfigurationProp, false)) {}
 
   ~LeAudioGroupStateMachineImpl() {
     alarm_free(watchdog_);
@@ -196,7 +201,7 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
         group->CigGenerateCisIds(context_type);
         /* All ASEs should aim to achieve target state */
         SetTargetState(group, AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING);
-        PrepareAndSendCodecConfigure(group, group->GetFirstActiveDevice());
+        SendCodecConfigureToGroup(group);
         break;
 
       case AseState::BTA_LE_AUDIO_ASE_STATE_QOS_CONFIGURED: {
@@ -208,7 +213,7 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
 
         /* All ASEs should aim to achieve target state */
         SetTargetState(group, AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING);
-        PrepareAndSendEnable(leAudioDevice);
+        SendEnableToGroup(group);
         break;
       }
 
@@ -265,7 +270,7 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
 
     group->CigGenerateCisIds(context_type);
     SetTargetState(group, AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED);
-    PrepareAndSendCodecConfigure(group, group->GetFirstActiveDevice());
+    SendCodecConfigureToGroup(group);
 
     return true;
   }
@@ -593,6 +598,10 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
     }
 
     group->CigClearCis();
+    state_machine_callbacks_->OnUpdatedCisConfiguration(
+        group->group_id_, le_audio::types::kLeAudioDirectionSink);
+    state_machine_callbacks_->OnUpdatedCisConfiguration(
+        group->group_id_, le_audio::types::kLeAudioDirectionSource);
   }
 
   void RemoveCigForGroup(LeAudioDeviceGroup* group) {
@@ -963,8 +972,15 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
   static constexpr uint64_t kStateTransitionTimeoutMs = 3500;
   static constexpr char kStateTransitionTimeoutMsProp[] =
       "persist.bluetooth.leaudio.device.set.state.timeoutms";
+  static constexpr char kParallelAseConfigurationProp[] =
+      "persist.bluetooth.leaudio.parallel_ase_configuration";
   Callbacks* state_machine_callbacks_;
   alarm_t* watchdog_;
+  /* Send each configuration phase to all the active devices of the group at
+   * once and wait for all of them, instead of configuring one device after
+   * the other.
+   */
+  bool parallel_ase_configuration_;
 
   /* This callback is called on timeout during transition to target state */
   void OnStateTransitionTimeout(int group_id) {
@@ -1143,6 +1159,9 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
 
     /* Update offloader streams */
     group->CreateStreamVectorForOffloader(ase->direction);
+
+    state_machine_callbacks_->OnUpdatedCisConfiguration(group->group_id_,
+                                                        ase->direction);
   }
 
   void RemoveCisFromStreamConfiguration(LeAudioDeviceGroup* group,
@@ -1226,6 +1245,15 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
     }
 
     group->CigUnassignCis(leAudioDevice);
+
+    if (sink_channels > stream_conf->sink_num_of_channels) {
+      state_machine_callbacks_->OnUpdatedCisConfiguration(
+          group->group_id_, le_audio::types::kLeAudioDirectionSink);
+    }
+    if (source_channels > stream_conf->source_num_of_channels) {
+      state_machine_callbacks_->OnUpdatedCisConfiguration(
+          group->group_id_, le_audio::types::kLeAudioDirectionSource);
+    }
   }
 
   bool CigCreate(LeAudioDeviceGroup* group) {
@@ -1467,6 +1495,9 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
   void AseStateMachineProcessIdle(
       struct le_audio::client_parser::ascs::ase_rsp_hdr& arh, struct ase* ase,
       LeAudioDeviceGroup* group, LeAudioDevice* leAudioDevice) {
+    /* The server does not keep the codec configuration in Idle */
+    ase->confirmed_codec_config.reset();
+
     switch (ase->state) {
       case AseState::BTA_LE_AUDIO_ASE_STATE_IDLE:
       case AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED:
@@ -1540,6 +1571,33 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
     }
   }
 
+  /* Next device to continue the current configuration phase with. There is
+   * none in the parallel mode, as the phase was sent to all the devices.
+   */
+  LeAudioDevice* GetNextActiveDeviceForPhase(LeAudioDeviceGroup* group,
+                                             LeAudioDevice* leAudioDevice) {
+    if (parallel_ase_configuration_) return nullptr;
+    return group->GetNextActiveDevice(leAudioDevice);
+  }
+
+  void SendCodecConfigureToGroup(LeAudioDeviceGroup* group) {
+    MetricsCollector::Get()->OnAseConfigurationPhaseStarted(
+        group->group_id_, AseConfigurationPhase::CODEC_CONFIGURE);
+
+    LeAudioDevice* leAudioDevice = group->GetFirstActiveDevice();
+    if (!parallel_ase_configuration_) {
+      PrepareAndSendCodecConfigure(group, leAudioDevice);
+      return;
+    }
+
+    /* Stop sending if the group was stopped in the meantime */
+    auto target_state = group->GetTargetState();
+    for (; leAudioDevice && group->GetTargetState() == target_state;
+         leAudioDevice = group->GetNextActiveDevice(leAudioDevice)) {
+      PrepareAndSendCodecConfigure(group, leAudioDevice);
+    }
+  }
+
   void StartConfigQoSForTheGroup(LeAudioDeviceGroup* group) {
     LeAudioDevice* leAudioDevice = group->GetFirstActiveDevice();
     if (!leAudioDevice) {
@@ -1548,7 +1606,39 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
       return;
     }
 
-    PrepareAndSendConfigQos(group, leAudioDevice);
+    MetricsCollector::Get()->OnAseConfigurationPhaseStarted(
+        group->group_id_, AseConfigurationPhase::QOS_CONFIGURE);
+
+    if (!parallel_ase_configuration_) {
+      PrepareAndSendConfigQos(group, leAudioDevice);
+      return;
+    }
+
+    auto target_state = group->GetTargetState();
+    for (; leAudioDevice && group->GetTargetState() == target_state;
+         leAudioDevice = group->GetNextActiveDevice(leAudioDevice)) {
+      PrepareAndSendConfigQos(group, leAudioDevice);
+    }
+  }
+
+  void SendEnableToGroup(LeAudioDeviceGroup* group) {
+    LeAudioDevice* leAudioDevice = group->GetFirstActiveDevice();
+    LOG_ASSERT(leAudioDevice)
+        << __func__ << " Shouldn't be called without an active device.";
+
+    MetricsCollector::Get()->OnAseConfigurationPhaseStarted(
+        group->group_id_, AseConfigurationPhase::ENABLE);
+
+    if (!parallel_ase_configuration_) {
+      PrepareAndSendEnable(leAudioDevice);
+      return;
+    }
+
+    auto target_state = group->GetTargetState();
+    for (; leAudioDevice && group->GetTargetState() == target_state;
+         leAudioDevice = group->GetNextActiveDevice(leAudioDevice)) {
+      PrepareAndSendEnable(leAudioDevice);
+    }
   }
 
   void PrepareAndSendCodecConfigure(LeAudioDeviceGroup* group,
@@ -1572,6 +1662,13 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
       LOG_DEBUG("device: %s, ase_id: %d, cis_id: %d, ase state: %s",
                 leAudioDevice->address_.ToString().c_str(), ase->id,
                 ase->cis_id, ToString(ase->state).c_str());
+      if (IsCodecConfigConfirmed(group, ase)) {
+        LOG_INFO("device: %s, ase_id: %d already has the codec configuration",
+                 leAudioDevice->address_.ToString().c_str(), ase->id);
+        ApplyConfirmedCodecConfig(ase);
+        continue;
+      }
+
       conf.ase_id = ase->id;
       conf.target_latency = ase->target_latency;
       conf.target_phy = group->GetTargetPhy(ase->direction);
@@ -1580,6 +1677,12 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
       confs.push_back(conf);
     }
 
+    if (confs.empty()) {
+      /* Nothing to write, the device keeps its codec configuration */
+      ProcessDeviceCodecConfigured(group, leAudioDevice);
+      return;
+    }
+
     std::vector<uint8_t> value;
     le_audio::client_parser::ascs::PrepareAseCtpCodecConfig(confs, value);
     BtaGattQueue::WriteCharacteristic(leAudioDevice->conn_id_,
@@ -1587,6 +1690,106 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
                                       GATT_WRITE_NO_RSP, NULL, NULL);
   }
 
+  /* True if the server confirmed the codec configuration the ASE is about to
+   * be configured with, and keeps it.
+   */
+  bool IsCodecConfigConfirmed(LeAudioDeviceGroup* group, struct ase* ase) {
+    if (ase->state != AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED ||
+        !ase->confirmed_codec_config)
+      return false;
+
+    auto& confirmed = *ase->confirmed_codec_config;
+    return confirmed.codec_id == ase->codec_id &&
+           confirmed.target_latency == ase->target_latency &&
+           confirmed.target_phy == group->GetTargetPhy(ase->direction) &&
+           confirmed.codec_spec_conf ==
+               ase->codec_config.GetAsLtvMap().RawPacket();
+  }
+
+  void StoreConfirmedCodecConfig(
+      LeAudioDeviceGroup* group, struct ase* ase,
+      const struct le_audio::client_parser::ascs::
+          ase_codec_configured_state_params& rsp) {
+    ase->confirmed_codec_config = {
+        .codec_id = ase->codec_id,
+        .codec_spec_conf = ase->codec_config.GetAsLtvMap().RawPacket(),
+        .target_latency = ase->target_latency,
+        .target_phy = group->GetTargetPhy(ase->direction),
+        .preferred_retrans_nb = rsp.preferred_retrans_nb,
+        .max_transport_latency = rsp.max_transport_latency,
+    };
+  }
+
+  /* Use the QoS preferences notified with the confirmed configuration, as the
+   * Codec Configured notification would have done.
+   */
+  void ApplyConfirmedCodecConfig(struct ase* ase) {
+    auto& confirmed = *ase->confirmed_codec_config;
+    if ((!ase->max_transport_latency ||
+         ase->max_transport_latency > confirmed.max_transport_latency) ||
+        !ase->retrans_nb) {
+      ase->max_transport_latency = confirmed.max_transport_latency;
+      ase->retrans_nb = confirmed.preferred_retrans_nb;
+    }
+    ase->reconfigure = false;
+  }
+
+  /* All the active ASEs of the device are codec configured */
+  void ProcessDeviceCodecConfigured(LeAudioDeviceGroup* group,
+                                    LeAudioDevice* leAudioDevice) {
+    if (group->GetState() == AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING) {
+      /* We are here because of the reconnection of the single device. */
+      PrepareAndSendConfigQos(group, leAudioDevice);
+      return;
+    }
+
+    if (parallel_ase_configuration_ &&
+        group->HaveAnyActiveDeviceInUnconfiguredState()) {
+      /* Waiting for the other devices configured in parallel */
+      return;
+    }
+
+    LeAudioDevice* leAudioDeviceNext =
+        GetNextActiveDeviceForPhase(group, leAudioDevice);
+
+    /* Configure ASEs for next device in group */
+    if (leAudioDeviceNext) {
+      PrepareAndSendCodecConfigure(group, leAudioDeviceNext);
+    } else {
+      /* Last node configured, process group to codec configured state */
+      group->SetState(AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED);
+      MetricsCollector::Get()->OnAseConfigurationPhaseCompleted(
+          group->group_id_, AseConfigurationPhase::CODEC_CONFIGURE);
+
+      if (group->GetTargetState() ==
+          AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING) {
+        if (!CigCreate(group)) {
+          LOG_ERROR("Could not create CIG. Stop the stream for group %d",
+                    group->group_id_);
+          StopStream(group);
+        }
+        return;
+      }
+
+      if (group->GetTargetState() ==
+              AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED &&
+          group->IsPendingConfiguration()) {
+        LOG_INFO(" Configured state completed ");
+        group->ClearPendingConfiguration();
+        state_machine_callbacks_->StatusReportCb(
+            group->group_id_, GroupStreamStatus::CONFIGURED_BY_USER);
+
+        /* No more transition for group */
+        alarm_cancel(watchdog_);
+        return;
+      }
+
+      LOG_ERROR(", Autonomouse change, from: %s to %s",
+                ToString(group->GetState()).c_str(),
+                ToString(group->GetTargetState()).c_str());
+    }
+  }
+
   void AseStateMachineProcessCodecConfigured(
       struct le_audio::client_parser::ascs::ase_rsp_hdr& arh, struct ase* ase,
       uint8_t* data, uint16_t len, LeAudioDeviceGroup* group,
@@ -1665,9 +1868,12 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
           /* This is autonomus change of the remote device */
           LOG_DEBUG("Autonomus change for device %s, ase id %d. Just store it.",
                     leAudioDevice->address_.ToString().c_str(), ase->id);
+          ase->confirmed_codec_config.reset();
           return;
         }
 
+        StoreConfirmedCodecConfig(group, ase, rsp);
+
         if (leAudioDevice->HaveAnyUnconfiguredAses()) {
           /* More ASEs notification from this device has to come for this group
            */
@@ -1682,7 +1888,13 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
           return;
         }
 
-        leAudioDeviceNext = group->GetNextActiveDevice(leAudioDevice);
+        if (parallel_ase_configuration_ &&
+            group->HaveAnyActiveDeviceInUnconfiguredState()) {
+          /* Waiting for the other devices configured in parallel */
+          return;
+        }
+
+        leAudioDeviceNext = GetNextActiveDeviceForPhase(group, leAudioDevice);
 
         /* Configure ASEs for next device in group */
         if (leAudioDeviceNext) {
@@ -1690,6 +1902,8 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
         } else {
           /* Last node configured, process group to codec configured state */
           group->SetState(AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED);
+          MetricsCollector::Get()->OnAseConfigurationPhaseCompleted(
+              group->group_id_, AseConfigurationPhase::CODEC_CONFIGURE);
 
           if (group->GetTargetState() ==
               AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING) {
@@ -1770,6 +1984,11 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
         ase->preferred_pres_delay_max = rsp.preferred_pres_delay_max;
 
         /* This may be a notification from a re-configured ASE */
+        if (ase->reconfigure) {
+          StoreConfirmedCodecConfig(group, ase, rsp);
+        } else {
+          ase->confirmed_codec_config.reset();
+        }
         ase->reconfigure = false;
 
         if (leAudioDevice->HaveAnyUnconfiguredAses()) {
@@ -1777,49 +1996,7 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
           return;
         }
 
-        if (group->GetState() == AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING) {
-          /* We are here because of the reconnection of the single device. */
-          PrepareAndSendConfigQos(group, leAudioDevice);
-          return;
-        }
-
-        LeAudioDevice* leAudioDeviceNext =
-            group->GetNextActiveDevice(leAudioDevice);
-
-        /* Configure ASEs for next device in group */
-        if (leAudioDeviceNext) {
-          PrepareAndSendCodecConfigure(group, leAudioDeviceNext);
-        } else {
-          /* Last node configured, process group to codec configured state */
-          group->SetState(AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED);
-
-          if (group->GetTargetState() ==
-              AseState::BTA_LE_AUDIO_ASE_STATE_STREAMING) {
-            if (!CigCreate(group)) {
-              LOG_ERROR("Could not create CIG. Stop the stream for group %d",
-                        group->group_id_);
-              StopStream(group);
-            }
-            return;
-          }
-
-          if (group->GetTargetState() ==
-                  AseState::BTA_LE_AUDIO_ASE_STATE_CODEC_CONFIGURED &&
-              group->IsPendingConfiguration()) {
-            LOG_INFO(" Configured state completed ");
-            group->ClearPendingConfiguration();
-            state_machine_callbacks_->StatusReportCb(
-                group->group_id_, GroupStreamStatus::CONFIGURED_BY_USER);
-
-            /* No more transition for group */
-            alarm_cancel(watchdog_);
-            return;
-          }
-
-          LOG_ERROR(", Autonomouse change, from: %s to %s",
-                    ToString(group->GetState()).c_str(),
-                    ToString(group->GetTargetState()).c_str());
-        }
+        ProcessDeviceCodecConfigured(group, leAudioDevice);
 
         break;
       }
@@ -1915,17 +2092,23 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
           return;
         }
 
+        if (parallel_ase_configuration_ &&
+            !group->HaveAllActiveDevicesAsesTheSameState(
+                AseState::BTA_LE_AUDIO_ASE_STATE_QOS_CONFIGURED)) {
+          /* Waiting for the other devices configured in parallel */
+          return;
+        }
+
         LeAudioDevice* leAudioDeviceNext =
-            group->GetNextActiveDevice(leAudioDevice);
+            GetNextActiveDeviceForPhase(group, leAudioDevice);
 
         /* Configure ASEs qos for next device in group */
         if (leAudioDeviceNext) {
           PrepareAndSendConfigQos(group, leAudioDeviceNext);
         } else {
-          leAudioDevice = group->GetFirstActiveDevice();
-          LOG_ASSERT(leAudioDevice)
-              << __func__ << " Shouldn't be called without an active device.";
-          PrepareAndSendEnable(leAudioDevice);
+          MetricsCollector::Get()->OnAseConfigurationPhaseCompleted(
+              group->group_id_, AseConfigurationPhase::QOS_CONFIGURE);
+          SendEnableToGroup(group);
         }
 
         break;
@@ -2475,13 +2658,22 @@ class LeAudioGroupStateMachineImpl : public LeAudioGroupStateMachine {
   }
 
   void ProcessGroupEnable(LeAudioDeviceGroup* group, LeAudioDevice* device) {
+    if (parallel_ase_configuration_ &&
+        !group->HaveAllActiveDevicesReadyToCreateStream()) {
+      /* Waiting for the other devices enabled in parallel */
+      return;
+    }
+
     /* Enable ASEs for next device in group. */
-    LeAudioDevice* deviceNext = group->GetNextActiveDevice(device);
+    LeAudioDevice* deviceNext = GetNextActiveDeviceForPhase(group, device);
     if (deviceNext) {
       PrepareAndSendEnable(deviceNext);
       return;
     }
 
+    MetricsCollector::Get()->OnAseConfigurationPhaseCompleted(
+        group->group_id_, AseConfigurationPhase::ENABLE);
+
     /* At this point all of the active ASEs within group are enabled. The server
      * might perform autonomous state transition for Sink ASE and skip Enabling
      * state notification and transit to Streaming directly. So check the group
@@ -37,6 +37,8 @@ class LeAudioGroupStateMachine {
     virtual void StatusReportCb(
         int group_id, bluetooth::le_audio::GroupStreamStatus status) = 0;
     virtual void OnStateTransitionTimeout(int group_id) = 0;
+    /* The CISes of the stream configuration in |direction| have changed */
+    virtual void OnUpdatedCisConfiguration(int group_id, uint8_t direction) = 0;
   };
 
   virtual ~LeAudioGroupStateMachine() = default;
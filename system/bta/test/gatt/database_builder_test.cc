@@ -178,4 +178,36 @@ TEST(DatabaseBuilderTest, SecondaryServiceOutOfOrderTest) {
   ASSERT_EQ(service, result.Services().end());
 }
 
+/* Verify that the full range exploration splits the services in ranges, and
+ * walks the descriptor ranges of all services */
+TEST(DatabaseBuilderTest, FullRangeExplorationTest) {
+  DatabaseBuilder builder;
+
+  builder.AddService(0x0001, 0x000f, SERVICE_1_UUID, true);
+  builder.AddService(0x0010, 0x001f, SERVICE_2_UUID, true);
+  builder.AddService(0x0020, 0x002f, SERVICE_3_UUID, true);
+
+  auto ranges = builder.StartFullRangeExploration(2);
+  ASSERT_EQ(ranges.size(), (size_t)2);
+  ASSERT_EQ(ranges[0], make_pair_u16(0x0001, 0x001f));
+  ASSERT_EQ(ranges[1], make_pair_u16(0x0020, 0x002f));
+  EXPECT_FALSE(builder.StartNextServiceExploration());
+
+  // Characteristics of different services come in any order
+  builder.AddCharacteristic(0x0022, 0x0023, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddCharacteristic(0x0002, 0x0003, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddCharacteristic(0x0004, 0x0005, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddCharacteristic(0x0012, 0x0013, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddCharacteristic(0x0014, 0x0015, SERVICE_1_CHAR_1_UUID, 0x02);
+
+  ASSERT_EQ(builder.NextFullRangeDescriptorRangeToExplore(),
+            make_pair_u16(0x0006, 0x000f));
+  ASSERT_EQ(builder.NextFullRangeDescriptorRangeToExplore(),
+            make_pair_u16(0x0016, 0x001f));
+  ASSERT_EQ(builder.NextFullRangeDescriptorRangeToExplore(),
+            make_pair_u16(0x0024, 0x002f));
+  ASSERT_EQ(builder.NextFullRangeDescriptorRangeToExplore(),
+            DatabaseBuilder::EXPLORE_END);
+}
+
 }  // namespace gatt
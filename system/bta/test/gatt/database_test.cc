@@ -285,4 +285,42 @@ TEST(GattCacheTest,
   // LOG(ERROR) << " " << base::HexEncode(&attr, len);
   EXPECT_EQ(memcmp(binary_form, &attr, len), 0);
 }
+/* This test makes sure that each possible GATT cache element survives the
+ * compact serialization, and that 16-bit UUIDs are stored in 2 bytes */
+TEST(GattDatabaseTest, serialize_deserialize_compact_test) {
+  Uuid char_2_uuid = Uuid::FromString("00001234-0000-1000-8000-00805f9b34fc");
+  DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x000f, SERVICE_1_UUID, true);
+  builder.AddService(0x0010, 0x001f, SERVICE_2_UUID, false);
+  builder.AddIncludedService(0x0002, SERVICE_2_UUID, 0x0010, 0x001f);
+  builder.AddCharacteristic(0x0003, 0x0004, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddDescriptor(0x0005, SERVICE_1_CHAR_1_DESC_1_UUID);
+  builder.AddDescriptor(0x0006, CHARACTERISTIC_EXTENDED_PROPERTIES);
+  builder.AddCharacteristic(0x0011, 0x0012, char_2_uuid, 0x0a);
+  builder.SetValueOfDescriptors({0x0001});
+  Database db = builder.Build();
+
+  std::vector<uint8_t> blob = db.SerializeCompact();
+  /* counts, 2 services, included service, 2 characteristics with one 128-bit
+   * UUID, descriptor and extended properties descriptor */
+  EXPECT_EQ(blob.size(), 4u + 2 * 8 + 10 + 9 + 23 + 6 + 5);
+
+  bool success = false;
+  Database result =
+      Database::DeserializeCompact(blob.data(), blob.size(), &success);
+  ASSERT_TRUE(success);
+  EXPECT_EQ(result.ToString(), db.ToString());
+  EXPECT_EQ(result.Hash(), db.Hash());
+  const Descriptor& ext_prop =
+      result.Services().front().characteristics.front().descriptors.back();
+  EXPECT_EQ(ext_prop.uuid, CHARACTERISTIC_EXTENDED_PROPERTIES);
+  EXPECT_EQ(ext_prop.characteristic_extended_properties, 0x0001);
+
+  /* A truncated blob is rejected */
+  for (size_t len = 0; len < blob.size(); len++) {
+    Database::DeserializeCompact(blob.data(), len, &success);
+    EXPECT_FALSE(success) << "len=" << len;
+  }
+}
+
 }  // namespace gatt
@@ -23,6 +23,7 @@
  *
  ******************************************************************************/
 
+#include <map>
 #include <mutex>
 #include <vector>
 
@@ -94,6 +95,7 @@ class BtaAvCoPeer {
         acceptor(false),
         reconfig_needed(false),
         opened(false),
+        sinks_from_cache(false),
         mtu(0),
         uuid_to_connect(0),
         bta_av_handle_(0),
@@ -151,6 +153,7 @@ class BtaAvCoPeer {
   bool acceptor;                          // True if acceptor
   bool reconfig_needed;                   // True if reconfiguration is needed
   bool opened;                            // True if opened
+  bool sinks_from_cache;                  // True if sinks were restored
   uint16_t mtu;                           // Maximum Transmit Unit size
   uint16_t uuid_to_connect;               // UUID of peer device
 
@@ -200,6 +203,15 @@ class BtaAvCo {
    */
   A2dpCodecConfig* GetPeerCurrentCodec(const RawAddress& peer_address);
 
+  /**
+   * Check whether a peer uses the codec configuration of the active peer.
+   *
+   * @param peer_address the peer address
+   * @return true if the peer is opened, is not the active peer and uses the
+   * same codec configuration as the active peer, otherwise false
+   */
+  bool PeerSharesActiveCodec(const RawAddress& peer_address);
+
   /**
    * Find the peer UUID for a given BTA AV handle.
    *
@@ -689,8 +701,42 @@ class BtaAvCo {
   static bool AudioProtectHasScmst(uint8_t num_protect,
                                    const uint8_t* p_protect_info);
 
+  /**
+   * Restore the Sink SEPs cached for a peer, if the first Sink SEP received
+   * matches the cache, so that no other Get Capabilities is needed.
+   *
+   * @param p_peer the peer to use
+   * @param received the Sink SEP received from the peer
+   * @return true if the Sink SEPs were restored, otherwise false
+   */
+  bool RestoreCachedPeerSinks(BtaAvCoPeer* p_peer, const BtaAvCoSep& received);
+
+  /**
+   * Cache the Sink SEPs of a peer once the stream is opened.
+   *
+   * @param p_peer the peer to use
+   */
+  void CachePeerSinks(const BtaAvCoPeer* p_peer);
+
+  /**
+   * Forget the Sink SEPs cached for a peer.
+   *
+   * @param peer_address the peer address to use
+   */
+  void ForgetCachedPeerSinks(const RawAddress& peer_address);
+
   bool ContentProtectEnabled() const { return content_protect_enabled_; }
 
+  // Sink SEPs of a peer at the last opened stream
+  struct PeerSinkCache {
+    uint8_t num_seps;
+    uint8_t num_sinks;
+    std::vector<BtaAvCoSep> sinks;
+  };
+
+  // Maximum number of peers whose Sink SEPs are cached
+  static constexpr size_t kMaxPeerSinkCacheSize = 16;
+
   std::recursive_mutex codec_lock_;  // Protect access to the codec state
   std::vector<btav_a2dp_codec_config_t> codec_priorities_;  // Configured
   BtaAvCoPeer peers_[BTA_AV_NUM_STRS];     // Connected peer information
@@ -698,6 +744,7 @@ class BtaAvCo {
   uint8_t codec_config_[AVDT_CODEC_SIZE];  // Current codec configuration
   const bool content_protect_enabled_;     // True if Content Protect is enabled
   uint8_t content_protect_flag_;           // Content Protect flag
+  std::map<RawAddress, PeerSinkCache> peer_sink_cache_;  // Per peer address
 };
 
 // SCMS-T protect info
@@ -743,6 +790,7 @@ void BtaAvCoPeer::Reset(tBTA_AV_HNDL bta_av_handle) {
   acceptor = false;
   reconfig_needed = false;
   opened = false;
+  sinks_from_cache = false;
   mtu = 0;
   uuid_to_connect = 0;
 
@@ -773,6 +821,7 @@ void BtaAvCo::Reset() {
   active_peer_ = nullptr;
   content_protect_flag_ = 0;
   memset(codec_config_, 0, sizeof(codec_config_));
+  peer_sink_cache_.clear();
 
   if (ContentProtectEnabled()) {
     SetContentProtectFlag(AVDT_CP_SCMS_COPY_NEVER);
@@ -814,6 +863,17 @@ A2dpCodecConfig* BtaAvCo::GetPeerCurrentCodec(const RawAddress& peer_address) {
   return peer->GetCodecs()->getCurrentCodecConfig();
 }
 
+bool BtaAvCo::PeerSharesActiveCodec(const RawAddress& peer_address) {
+  std::lock_guard<std::recursive_mutex> lock(codec_lock_);
+
+  BtaAvCoPeer* p_peer = FindPeer(peer_address);
+  if (p_peer == nullptr || active_peer_ == nullptr || p_peer == active_peer_ ||
+      !p_peer->opened || !active_peer_->opened) {
+    return false;
+  }
+  return A2DP_CodecEquals(p_peer->codec_config, active_peer_->codec_config);
+}
+
 BtaAvCoPeer* BtaAvCo::FindPeer(const RawAddress& peer_address) {
   for (size_t i = 0; i < BTA_AV_CO_NUM_ELEMENTS(peers_); i++) {
     BtaAvCoPeer* p_peer = &peers_[i];
@@ -894,6 +954,12 @@ void BtaAvCo::ProcessDiscoveryResult(tBTA_AV_HNDL bta_av_handle,
                      peer_address.ToString().c_str());
   }
 
+  // The previous attempt with the cached Sink SEPs did not open the stream
+  if (p_peer->sinks_from_cache && !p_peer->opened) {
+    ForgetCachedPeerSinks(peer_address);
+  }
+  p_peer->sinks_from_cache = false;
+
   /* Copy the discovery results */
   p_peer->addr = peer_address;
   p_peer->num_sinks = num_sinks;
@@ -952,6 +1018,13 @@ tA2DP_STATUS BtaAvCo::ProcessSourceGetConfig(
       p_sink->seid = seid;
       p_sink->num_protect = *p_num_protect;
       memcpy(p_sink->protect_info, p_protect_info, AVDT_CP_INFO_LEN);
+
+      // On reconnection, skip the Get Capabilities of the other Sink SEPs
+      if (!p_peer->acceptor && p_peer->num_rx_sinks == 1 &&
+          RestoreCachedPeerSinks(p_peer, *p_sink)) {
+        LOG(INFO) << __func__ << ": restored " << +p_peer->num_sup_sinks
+                  << " cached Sink SEPs of peer " << p_peer->addr;
+      }
     } else {
       APPL_TRACE_ERROR("%s: peer %s : no more room for Sink info", __func__,
                        p_peer->addr.ToString().c_str());
@@ -1305,6 +1378,7 @@ void BtaAvCo::ProcessOpen(tBTA_AV_HNDL bta_av_handle,
   }
   p_peer->opened = true;
   p_peer->mtu = mtu;
+  CachePeerSinks(p_peer);
 
   // The first connected peer becomes the active peer
   if (active_peer_ == nullptr) {
@@ -1330,6 +1404,10 @@ void BtaAvCo::ProcessClose(tBTA_AV_HNDL bta_av_handle,
   if (active_peer_ == p_peer) {
     active_peer_ = nullptr;
   }
+  // Fall back to the full discovery if the cached Sink SEPs were rejected
+  if (p_peer->sinks_from_cache && !p_peer->opened) {
+    ForgetCachedPeerSinks(peer_address);
+  }
   // Mark the peer closed and clean the peer info
   p_peer->Init(codec_priorities_);
 }
@@ -1769,6 +1847,72 @@ bool BtaAvCo::AudioProtectHasScmst(uint8_t num_protect,
   return false;
 }
 
+bool BtaAvCo::RestoreCachedPeerSinks(BtaAvCoPeer* p_peer,
+                                     const BtaAvCoSep& received) {
+  auto it = peer_sink_cache_.find(p_peer->addr);
+  if (it == peer_sink_cache_.end()) {
+    return false;
+  }
+  const PeerSinkCache& cache = it->second;
+
+  // The peer must report the same SEPs as when they were cached
+  bool match = cache.num_seps == p_peer->num_seps &&
+               cache.num_sinks == p_peer->num_sinks &&
+               cache.sinks.size() <= BTA_AV_CO_NUM_ELEMENTS(p_peer->sinks);
+  if (match) {
+    match = false;
+    for (const BtaAvCoSep& sink : cache.sinks) {
+      if (sink.sep_info_idx == received.sep_info_idx &&
+          sink.seid == received.seid &&
+          memcmp(sink.codec_caps, received.codec_caps, AVDT_CODEC_SIZE) == 0 &&
+          sink.num_protect == received.num_protect &&
+          memcmp(sink.protect_info, received.protect_info, AVDT_CP_INFO_LEN) ==
+              0) {
+        match = true;
+        break;
+      }
+    }
+  }
+  if (!match) {
+    APPL_TRACE_DEBUG("%s: cached Sink SEPs of peer %s are stale", __func__,
+                     p_peer->addr.ToString().c_str());
+    peer_sink_cache_.erase(it);
+    return false;
+  }
+
+  for (size_t i = 0; i < cache.sinks.size(); i++) {
+    p_peer->sinks[i] = cache.sinks[i];
+  }
+  p_peer->num_sup_sinks = cache.sinks.size();
+  p_peer->num_rx_sinks = p_peer->num_sinks;
+  p_peer->sinks_from_cache = true;
+  return true;
+}
+
+void BtaAvCo::CachePeerSinks(const BtaAvCoPeer* p_peer) {
+  // Only cache the peers whose Sink SEPs were all retrieved
+  if (p_peer->uuid_to_connect != UUID_SERVCLASS_AUDIO_SINK ||
+      p_peer->num_sup_sinks == 0 ||
+      p_peer->num_rx_sinks != p_peer->num_sinks) {
+    return;
+  }
+
+  if (peer_sink_cache_.find(p_peer->addr) == peer_sink_cache_.end() &&
+      peer_sink_cache_.size() >= kMaxPeerSinkCacheSize) {
+    peer_sink_cache_.erase(peer_sink_cache_.begin());
+  }
+
+  PeerSinkCache& cache = peer_sink_cache_[p_peer->addr];
+  cache.num_seps = p_peer->num_seps;
+  cache.num_sinks = p_peer->num_sinks;
+  cache.sinks.assign(p_peer->sinks, p_peer->sinks + p_peer->num_sup_sinks);
+}
+
+void BtaAvCo::ForgetCachedPeerSinks(const RawAddress& peer_address) {
+  APPL_TRACE_DEBUG("%s: peer %s", __func__, peer_address.ToString().c_str());
+  peer_sink_cache_.erase(peer_address);
+}
+
 bool BtaAvCo::AudioSepHasContentProtection(const BtaAvCoSep* p_sep) {
   APPL_TRACE_DEBUG("%s", __func__);
 
@@ -2103,6 +2247,10 @@ A2dpCodecConfig* bta_av_get_a2dp_peer_current_codec(
   return bta_av_co_cb.GetPeerCurrentCodec(peer_address);
 }
 
+bool bta_av_co_peer_shares_active_codec(const RawAddress& peer_address) {
+  return bta_av_co_cb.PeerSharesActiveCodec(peer_address);
+}
+
 bool bta_av_co_audio_init(btav_a2dp_codec_index_t codec_index,
                           AvdtpSepConfig* p_cfg) {
   return A2DP_InitCodecConfig(codec_index, p_cfg);
@@ -30,10 +30,13 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "bta_api.h"
 #include "bta_hh_api.h"
 #include "btif_hh.h"
 #include "btif_util.h"
+#include "common/time_util.h"
 #include "osi/include/allocator.h"
 #include "osi/include/compat.h"
 #include "osi/include/osi.h"
@@ -80,6 +83,19 @@ static int uhid_write(int fd, const struct uhid_event* ev) {
   return 0;
 }
 
+/* Waits a maximum of MAX_POLLING_ATTEMPTS x POLLING_SLEEP_DURATION for uhid
+ * to be ready, in case device creation is pending. */
+static bool uhid_wait_ready(btif_hh_device_t* p_dev) {
+  if (p_dev->fd < 0) return false;
+
+  uint32_t polling_attempts = 0;
+  while (!p_dev->ready_for_data &&
+         polling_attempts++ < BTIF_HH_MAX_POLLING_ATTEMPTS) {
+    usleep(BTIF_HH_POLLING_SLEEP_DURATION_US);
+  }
+  return p_dev->ready_for_data;
+}
+
 /* Internal function to parse the events received from UHID driver*/
 static int uhid_read_event(btif_hh_device_t* p_dev) {
   CHECK(p_dev);
@@ -415,6 +431,7 @@ void bta_hh_co_open(uint8_t dev_handle, uint8_t sub_class,
   }
 
   p_dev->dev_status = BTHH_CONN_STATE_CONNECTED;
+  p_dev->input_stats = {};
   p_dev->get_rpt_id_queue = fixed_queue_new(SIZE_MAX);
   CHECK(p_dev->get_rpt_id_queue);
 #ifdef OS_ANDROID  // Host kernel does not support UHID_SET_REPORT
@@ -505,18 +522,8 @@ void bta_hh_co_data(uint8_t dev_handle, uint8_t* p_rpt, uint16_t len,
     return;
   }
 
-  // Wait a maximum of MAX_POLLING_ATTEMPTS x POLLING_SLEEP_DURATION in case
-  // device creation is pending.
-  if (p_dev->fd >= 0) {
-    uint32_t polling_attempts = 0;
-    while (!p_dev->ready_for_data &&
-           polling_attempts++ < BTIF_HH_MAX_POLLING_ATTEMPTS) {
-      usleep(BTIF_HH_POLLING_SLEEP_DURATION_US);
-    }
-  }
-
   // Send the HID data to the kernel.
-  if ((p_dev->fd >= 0) && p_dev->ready_for_data) {
+  if (uhid_wait_ready(p_dev)) {
     bta_hh_co_write(p_dev->fd, p_rpt, len);
   } else {
     APPL_TRACE_WARNING("%s: Error: fd = %d, ready %d, len = %d", __func__,
@@ -524,6 +531,64 @@ void bta_hh_co_data(uint8_t dev_handle, uint8_t* p_rpt, uint16_t len,
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_hh_co_input_report
+ *
+ * Description      This callout function is executed by HH when an LE HID
+ *                  device notifies an input report. The report is copied
+ *                  once, from the notification into the uhid event.
+ *
+ * Returns          void.
+ ******************************************************************************/
+void bta_hh_co_input_report(uint8_t dev_handle, uint8_t rpt_id,
+                            const uint8_t* p_data, uint16_t len,
+                            uint64_t rx_time_us) {
+  /* Only used from the main thread. It is kept between the reports to skip
+   * clearing the whole event, as only the header and the report are read by
+   * the kernel. */
+  static struct uhid_event input_ev;
+
+  btif_hh_device_t* p_dev = btif_hh_find_connected_dev_by_handle(dev_handle);
+  if (p_dev == NULL) {
+    APPL_TRACE_WARNING("%s: Error: unknown HID device handle %d", __func__,
+                       dev_handle);
+    return;
+  }
+
+  btif_hh_input_stats_t* p_stats = &p_dev->input_stats;
+  uint32_t size = len + (rpt_id != 0 ? 1 : 0);
+  if (size > sizeof(input_ev.u.input.data)) {
+    APPL_TRACE_WARNING("%s: Report size greater than allowed size", __func__);
+    p_stats->dropped++;
+    return;
+  }
+
+  if (!uhid_wait_ready(p_dev)) {
+    APPL_TRACE_WARNING("%s: Error: fd = %d, ready %d, len = %d", __func__,
+                       p_dev->fd, p_dev->ready_for_data, len);
+    p_stats->dropped++;
+    return;
+  }
+
+  input_ev.type = UHID_INPUT;
+  input_ev.u.input.size = size;
+  uint8_t* p = input_ev.u.input.data;
+  if (rpt_id != 0) *p++ = rpt_id;
+  memcpy(p, p_data, len);
+
+  if (uhid_write(p_dev->fd, &input_ev) < 0) {
+    p_stats->dropped++;
+    return;
+  }
+
+  uint64_t latency_us = bluetooth::common::time_get_os_boottime_us() -
+                        rx_time_us;
+  p_stats->count++;
+  p_stats->total_latency_us += latency_us;
+  p_stats->max_latency_us = std::max(p_stats->max_latency_us, latency_us);
+}
+
 /*******************************************************************************
  *
  * Function         bta_hh_co_send_hid_info
@@ -34,6 +34,15 @@ void btif_a2dp_control_cleanup(void);
 // |status| is the acknowledement status - see |tA2DP_CTRL_ACK|.
 void btif_a2dp_command_ack(tA2DP_CTRL_ACK status);
 
+// Read up to |len| bytes of audio data from the audio HAL into |p_buf|, from
+// the shared memory ring if the audio HAL opened one or else from the audio
+// socket.
+// Returns the number of bytes read.
+uint32_t btif_a2dp_control_read_audio(uint8_t* p_buf, uint32_t len);
+
+// Drop the audio data pending from the audio HAL.
+void btif_a2dp_control_flush_audio(void);
+
 // Increment the total number audio data bytes that have been encoded since
 // last encoding attempt.
 // |bytes_read| is the number of bytes to increment by.
@@ -0,0 +1,159 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Adaptive jitter buffer of the A2DP Sink.
+//
+// The encoded packets are kept in the receive queue of the A2DP Sink, and
+// this class decides how many of them are decoded at each decode tick:
+//  - The variance of the packet inter-arrival times, and the longest recent
+//    arrival gap, set the target depth of the queue.
+//  - Each tick decodes as much audio as was played since the previous tick,
+//    so that the queue keeps its depth. When the queue runs empty, decoding
+//    pauses until the target depth is buffered again.
+//  - The depth is steered to the target by time-stretching the decoded audio
+//    by a few percent: silent blocks are dropped or repeated first, and the
+//    other blocks are shortened or lengthened with a cross-fade.
+//
+// The methods are not thread safe: the A2DP Sink calls them under its lock.
+class BtifA2dpSinkJitterBuffer {
+ public:
+  // Shortest and longest target depth of the queue
+  static constexpr uint64_t kMinTargetDepthUs = 40000;
+  static constexpr uint64_t kMaxTargetDepthUs = 250000;
+  // The decoded blocks which are not silent are time-stretched with a
+  // cross-fade over 1 / kOverlapDivisor of their length, by one up to
+  // kMaxShiftOverlaps times the cross-fade length.
+  static constexpr size_t kOverlapDivisor = 64;
+  static constexpr size_t kMaxShiftOverlaps = 4;
+
+  struct Stats {
+    size_t packets_received = 0;
+    size_t packets_decoded = 0;
+    // Packets dropped because the queue was full
+    size_t packets_dropped = 0;
+    // Decode ticks which found the queue empty, and had to buffer again
+    size_t underruns = 0;
+    // Decode ticks which decoded ahead of time, because the queue was almost
+    // full
+    size_t overruns = 0;
+    // Audio frames removed or added by the time-stretching
+    uint64_t silence_dropped_frames = 0;
+    uint64_t silence_inserted_frames = 0;
+    uint64_t compressed_frames = 0;
+    uint64_t stretched_frames = 0;
+  };
+
+  // |max_queue_length| is the capacity of the receive queue, and
+  // |decode_tick_us| the period of the decode ticks.
+  BtifA2dpSinkJitterBuffer(size_t max_queue_length, uint64_t decode_tick_us);
+
+  // Configures the format of the decoded audio, and restarts the estimation
+  // of the network jitter.
+  void Configure(uint32_t sample_rate, uint8_t bits_per_sample,
+                 uint8_t channel_count);
+
+  // Restarts the buffering after the queue is flushed, or when decoding
+  // starts at |now_us|.
+  void Restart(uint64_t now_us);
+
+  // Called when a packet is received at |now_us|, before it is queued.
+  void OnPacketReceived(uint64_t now_us);
+
+  // Returns true if the receive queue should trigger a decode tick ahead of
+  // time, because it holds |queue_length| packets.
+  bool IsOverrun(size_t queue_length) const;
+
+  // Called when a packet is dropped because the queue is full.
+  void OnPacketDropped() { stats_.packets_dropped++; }
+
+  // Called at the start of each decode tick at |now_us|.
+  void OnDecodeTick(uint64_t now_us);
+
+  // Returns whether one more packet should be decoded during this tick, with
+  // |queue_length| packets in the queue.
+  bool ShouldDecodePacket(size_t queue_length);
+
+  // Time-stretches the decoded audio |data| of |len| bytes, if needed.
+  // Returns the number of bytes of the adjusted audio, and sets |output| to
+  // either |data| or an internal buffer, valid until the next call.
+  size_t ProcessAudio(const uint8_t* data, size_t len, const uint8_t** output);
+
+  // Called when a packet has been decoded, after its audio was processed.
+  void OnPacketDecoded();
+
+  uint64_t GetTargetDepthUs() const { return target_depth_us_; }
+  // Depth of the queue at the last decision, or 0 when unknown
+  uint64_t GetDepthUs() const { return depth_us_; }
+  uint64_t GetPacketDurationUs() const { return packet_duration_us_; }
+  uint64_t GetMeanArrivalIntervalUs() const;
+  uint64_t GetArrivalJitterUs() const;
+  uint64_t GetPeakArrivalIntervalUs() const;
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  enum class Adjustment { kNone, kCompress, kStretch };
+
+  void UpdateTargetDepth();
+  Adjustment GetAdjustment() const;
+  bool IsSilent(const uint8_t* data, size_t frames) const;
+  // Returns the number of frames to skip or repeat in |data|, between one
+  // and kMaxShiftOverlaps times |overlap|.
+  size_t FindShift(const uint8_t* data, size_t overlap) const;
+  int32_t ReadSample(const uint8_t* p) const;
+  void WriteSample(uint8_t* p, int32_t sample) const;
+  // Writes to |out| the |frames| frames cross-fading from |from| to |to|.
+  void CrossFade(const uint8_t* from, const uint8_t* to, size_t frames,
+                 uint8_t* out) const;
+  uint64_t FramesToUs(uint64_t frames) const;
+
+  size_t max_queue_length_;
+  uint64_t decode_tick_us_;
+
+  uint32_t sample_rate_ = 0;
+  uint8_t bytes_per_sample_ = 0;
+  uint8_t channel_count_ = 0;
+
+  // Exponentially weighted mean and variance of the inter-arrival times, and
+  // the longest recent inter-arrival time, decaying with each packet.
+  uint64_t last_arrival_us_ = 0;
+  double interval_mean_us_ = 0;
+  double interval_variance_us2_ = 0;
+  double peak_interval_us_ = 0;
+  uint64_t target_depth_us_ = kMinTargetDepthUs;
+
+  // Average audio duration of the packets, from their decoded audio
+  uint64_t packet_duration_us_ = 0;
+  uint64_t pending_frames_ = 0;
+
+  // Decoding waits for the target depth when |buffering_| is set. Otherwise
+  // |credit_us_| is the duration of audio still to be decoded in this tick.
+  bool buffering_ = true;
+  bool overrun_ = false;
+  uint64_t last_tick_us_ = 0;
+  int64_t credit_us_ = 0;
+  uint64_t depth_us_ = 0;
+
+  std::vector<uint8_t> output_;
+  Stats stats_;
+};
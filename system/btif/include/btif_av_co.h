@@ -82,6 +82,12 @@ A2dpCodecConfig* bta_av_get_a2dp_current_codec(void);
 A2dpCodecConfig* bta_av_get_a2dp_peer_current_codec(
     const RawAddress& peer_address);
 
+// Checks whether the peer |peer_address| is opened and uses the same codec
+// configuration as the active peer, so that the packets encoded for the
+// active peer can be sent to it as well.
+// Returns true if the codec configurations are equal, otherwise false.
+bool bta_av_co_peer_shares_active_codec(const RawAddress& peer_address);
+
 // Gets the A2DP effective frame size from the current encoder.
 // Returns the effective frame size if the encoder is configured, otherwise 0.
 int bta_av_co_get_encoder_effective_frame_size();
@@ -34,9 +34,12 @@
  * The ownership of the handle is maintained by the caller of this API and it
  * should eventually be
  * deleted using BtifAvrcpAudioTrackDelete (see below).
+ *
+ * |burstMs| is the longest audio, in milliseconds, the caller writes at once;
+ * the track buffers enough samples to take it without dropping any.
  */
 void* BtifAvrcpAudioTrackCreate(int trackFreq, int bitsPerSample,
-                                int channelCount);
+                                int channelCount, int burstMs);
 
 /**
  * Starts the audio track.
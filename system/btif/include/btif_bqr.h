@@ -119,6 +119,17 @@ static constexpr const char* kpPropertyEventMask =
 // The Property of BQR minimum report interval configuration.
 static constexpr const char* kpPropertyMinReportIntervalMs =
     "persist.bluetooth.bqr.min_interval_ms";
+// Default minimum time interval (in ms) between two Quality Monitoring Mode
+// reports of a connection which are logged and forwarded to the framework. The
+// reports in between only update the link statistics.
+static constexpr uint32_t kDefaultMonitorModeLogIntervalMs = 1000;
+// The Property of the minimum time interval (in ms) between two Quality
+// Monitoring Mode reports of a connection which are logged and forwarded.
+static constexpr const char* kpPropertyMonitorModeLogIntervalMs =
+    "persist.bluetooth.bqr.log_interval_ms";
+// Weight of a new report in the rolling averages of the link statistics is
+// 1 / kLinkStatsAverageWeight.
+static constexpr int kLinkStatsAverageWeight = 8;
 // Path of the LMP/LL message trace log file.
 static constexpr const char* kpLmpLlMessageTraceLogPath =
     "/data/misc/bluetooth/logs/lmp_ll_message_trace.log";
@@ -328,6 +339,31 @@ class BqrVseSubEvt {
   std::tm tm_timestamp_ = {};
 };
 
+// Rolling link quality statistics of a connection, updated by each of its Link
+// Quality related BQR events.
+typedef struct {
+  // Count of the reports received, and of the reports which were neither
+  // logged nor forwarded because of the rate limit.
+  uint32_t report_count;
+  uint32_t suppressed_count;
+  // RSSI and SNR of the last report, and their rolling averages.
+  int8_t rssi;
+  uint8_t snr;
+  float average_rssi;
+  float average_snr;
+  int8_t min_rssi;
+  int8_t max_rssi;
+  // Sums of the per report counts.
+  uint64_t retransmission_count;
+  uint64_t no_rx_count;
+  uint64_t nak_count;
+  uint64_t flow_off_count;
+  // Boot time (in ms) of the last report, and of the last Quality Monitoring
+  // Mode report which was logged.
+  uint64_t last_report_ms;
+  uint64_t last_logged_ms;
+} BqrLinkStats;
+
 // Get a string representation of the Quality Report ID.
 //
 // @param quality_report_id The quality report ID to convert.
@@ -370,7 +406,9 @@ void BqrVscCompleteCallback(tBTM_VSC_CMPL* p_vsc_cmpl_params);
 //   the Bluetooth controller.
 void ConfigureBqrCmpl(uint32_t current_evt_mask);
 
-// Categorize the incoming Bluetooth Quality Report.
+// Categorize the incoming Bluetooth Quality Report. The report is copied and
+// handled on the BQR thread, so that parsing, logging and file writes stay off
+// the main thread.
 //
 // @param length Lengths of the quality report sent from the Bluetooth
 //   controller.
@@ -378,7 +416,10 @@ void ConfigureBqrCmpl(uint32_t current_evt_mask);
 //   Bluetooth controller.
 void CategorizeBqrEvent(uint8_t length, const uint8_t* p_bqr_event);
 
-// Record a new incoming Link Quality related BQR event in quality event queue.
+// Record a new incoming Link Quality related BQR event in the link statistics,
+// then log it, report it and add it to the quality event queue unless it is a
+// Quality Monitoring Mode report within the log interval of the previous one
+// of the same connection. Runs on the BQR thread.
 //
 // @param length Lengths of the Link Quality related BQR event.
 // @param p_link_quality_event A pointer to the Link Quality related BQR event.
@@ -78,6 +78,17 @@ inline std::string btif_hh_status_text(const BTIF_HH_STATUS& status) {
 }
 #undef CASE_RETURN_TEXT
 
+/* Statistics of the input reports notified by an LE HID device */
+typedef struct {
+  uint32_t count;
+  /* Reports not written to uhid, because it was not ready or failed */
+  uint32_t dropped;
+  /* Time from the reception of the notification to the end of the uhid
+   * write */
+  uint64_t total_latency_us;
+  uint64_t max_latency_us;
+} btif_hh_input_stats_t;
+
 // Shared with uhid polling thread
 typedef struct {
   bthh_connection_state_t dev_status;
@@ -99,6 +110,7 @@ typedef struct {
 #endif  // OS_ANDROID
   uint8_t get_rpt_snt;
   bool local_vup;  // Indicated locally initiated VUP
+  btif_hh_input_stats_t input_stats;
 } btif_hh_device_t;
 
 /* Control block to maintain properties of devices */
@@ -142,5 +154,6 @@ extern void btif_hh_getreport(btif_hh_device_t* p_dev,
                               bthh_report_type_t r_type, uint8_t reportId,
                               uint16_t bufferSize);
 extern void btif_hh_service_registration(bool enable);
+extern void btif_debug_hh_dump(int fd);
 
 #endif
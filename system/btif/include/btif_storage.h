@@ -22,6 +22,10 @@
 #include <bluetooth/uuid.h>
 #include <hardware/bluetooth.h>
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "bt_target.h"
 #include "stack/include/bt_device_type.h"
 #include "stack/include/bt_octets.h"
@@ -169,6 +173,24 @@ bt_status_t btif_storage_add_bonded_device(RawAddress* remote_bd_addr,
  ******************************************************************************/
 bt_status_t btif_storage_remove_bonded_device(const RawAddress* remote_bd_addr);
 
+/* Restores the state of a profile for one bonded device, given its address and
+ * the name of its config section */
+typedef std::function<void(const RawAddress& bd_addr, const std::string& name)>
+    btif_storage_device_loader_t;
+
+/*******************************************************************************
+ *
+ * Function         btif_storage_visit_bonded_devices
+ *
+ * Description      BTIF storage API - Goes once through the bonded devices in
+ *                  NVRAM, and calls each of |loaders| in order on each of
+ *                  them, so that the state of several profiles is restored
+ *                  in a single pass.
+ *
+ ******************************************************************************/
+void btif_storage_visit_bonded_devices(
+    const std::vector<btif_storage_device_loader_t>& loaders);
+
 /*******************************************************************************
  *
  * Function         btif_storage_load_le_devices
@@ -198,6 +220,19 @@ void btif_storage_load_le_devices(void);
  ******************************************************************************/
 bt_status_t btif_storage_load_bonded_devices(void);
 
+/*******************************************************************************
+ *
+ * Function         btif_storage_load_bonded_and_le_devices
+ *
+ * Description      BTIF storage API - Does what btif_storage_load_le_devices
+ *                  and then btif_storage_load_bonded_devices do, fetching the
+ *                  bonded devices from NVRAM and adding them to the BTA once.
+ *
+ * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ *
+ ******************************************************************************/
+bt_status_t btif_storage_load_bonded_and_le_devices(void);
+
 /*******************************************************************************
  *
  * Function         btif_storage_add_hid_device_info
@@ -33,6 +33,20 @@ typedef struct {
 
 const stack_manager_t* stack_manager_get_interface();
 
+// Profiles whose stack layer is initialized at start up only when the product
+// config enables them, and otherwise when their btif layer is first enabled
+typedef enum {
+  STACK_PROFILE_PAN,
+  STACK_PROFILE_HID_HOST,
+  STACK_PROFILE_A2DP,
+  STACK_PROFILE_MAX,
+} stack_profile_t;
+
+// Initialize the stack layer of |profile| on the main thread, unless it was
+// already initialized since the stack started. Called by the btif layer of the
+// profile before it enables the profile.
+void stack_manager_init_profile(stack_profile_t profile);
+
 // TODO(zachoverflow): remove this terrible hack once the startup sequence is
 // more sane
 future_t* stack_manager_get_hack_future();
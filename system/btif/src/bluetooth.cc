@@ -51,6 +51,7 @@
 #include "audio_hal_interface/a2dp_encoding.h"
 #include "bt_utils.h"
 #include "bta/include/bta_csis_api.h"
+#include "bta/include/bta_gatt_api.h"
 #include "bta/include/bta_has_api.h"
 #include "bta/include/bta_hearing_aid_api.h"
 #include "bta/include/bta_hf_client_api.h"
@@ -68,6 +69,7 @@
 #include "btif_config.h"
 #include "btif_debug_conn.h"
 #include "btif_hf.h"
+#include "btif_hh.h"
 #include "btif_keystore.h"
 #include "btif_metrics_logging.h"
 #include "btif_storage.h"
@@ -85,6 +87,7 @@
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/properties.h"
 #include "osi/include/wakelock.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/include/avdt_api.h"
@@ -191,6 +194,8 @@ static int init(bt_callbacks_t* callbacks, bool start_restricted,
 #ifdef BLUEDROID_DEBUG
   allocation_tracker_init();
 #endif
+  osi_buffer_pool_init(
+      osi_property_get_bool("bluetooth.osi.buffer_pool.enabled", true));
 
   set_hal_cbacks(callbacks);
 
@@ -433,12 +438,17 @@ static void dump(int fd, const char** arguments) {
   btif_debug_linkkey_type_dump(fd);
   btif_debug_a2dp_dump(fd);
   btif_debug_av_dump(fd);
+  btif_debug_hh_dump(fd);
   bta_debug_av_dump(fd);
   stack_debug_avdtp_api_dump(fd);
   btif_sock_dump(fd);
   bluetooth::avrcp::AvrcpService::DebugDump(fd);
   btif_debug_config_dump(fd);
   BTA_HfClientDumpStatistics(fd);
+  BTA_GATTC_DumpDiscoveryStatistics(fd);
+  BTA_DmDumpDiscoveryStatistics(fd);
+  BTA_DmDumpPowerModeStatistics(fd);
+  BTM_DumpScoStatistics(fd);
   wakelock_debug_dump(fd);
   osi_allocator_debug_dump(fd);
   alarm_debug_dump(fd);
@@ -453,6 +463,7 @@ static void dump(int fd, const char** arguments) {
   VolumeControl::DebugDump(fd);
 #endif
   connection_manager::dump(fd);
+  GATT_DumpConnectionStatistics(fd);
   bluetooth::bqr::DebugDump(fd);
   bluetooth::shim::Dump(fd, arguments);
 }
@@ -24,8 +24,12 @@
 #include <base/logging.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <unistd.h>
+
+#include <mutex>
 
 #include "audio_a2dp_hw/include/audio_a2dp_hw.h"
+#include "audio_a2dp_hw/include/audio_a2dp_hw_ring.h"
 #include "btif_a2dp.h"
 #include "btif_a2dp_sink.h"
 #include "btif_a2dp_source.h"
@@ -46,6 +50,12 @@ struct {
 
 static void btif_a2dp_data_cb(tUIPC_CH_ID ch_id, tUIPC_EVENT event);
 static void btif_a2dp_ctrl_cb(tUIPC_CH_ID ch_id, tUIPC_EVENT event);
+static void btif_a2dp_control_close_audio_ring(void);
+
+/* The shared memory ring carrying the audio data, if the audio HAL opened one.
+ * It is read by the media task and replaced by the UIPC thread. */
+static std::mutex audio_ring_mutex;
+static struct a2dp_audio_ring* audio_ring = nullptr;
 
 /* We can have max one command pending */
 static tA2DP_CTRL_CMD a2dp_cmd_pending = A2DP_CTRL_CMD_NONE;
@@ -61,6 +71,7 @@ void btif_a2dp_control_cleanup(void) {
   if (a2dp_uipc != nullptr) {
     UIPC_Close(*a2dp_uipc, UIPC_CH_ID_ALL);
   }
+  btif_a2dp_control_close_audio_ring();
 }
 
 static tA2DP_CTRL_ACK btif_a2dp_control_on_check_ready() {
@@ -257,6 +268,49 @@ static void btif_a2dp_control_on_get_presentation_position() {
   UIPC_Send(*a2dp_uipc, UIPC_CH_ID_AV_CTRL, 0, (uint8_t*)&nsec, sizeof(nsec));
 }
 
+static void btif_a2dp_control_publish_position_locked(void) {
+  if (audio_ring == nullptr) return;
+  a2dp_audio_ring_set_position(audio_ring, delay_report_stats.total_bytes_read,
+                               delay_report_stats.audio_delay,
+                               &delay_report_stats.timestamp);
+}
+
+static void btif_a2dp_control_close_audio_ring(void) {
+  std::lock_guard<std::mutex> lock(audio_ring_mutex);
+  if (audio_ring == nullptr) return;
+  a2dp_audio_ring_close(audio_ring);
+  a2dp_audio_ring_unmap(audio_ring);
+  audio_ring = nullptr;
+}
+
+static void btif_a2dp_control_on_open_audio_ring() {
+  /* The ring only carries the audio data towards the stack */
+  if (btif_av_get_peer_sep() != AVDT_TSEP_SNK) {
+    btif_a2dp_command_ack(A2DP_CTRL_ACK_UNSUPPORTED);
+    return;
+  }
+
+  int fd = a2dp_audio_ring_create();
+  struct a2dp_audio_ring* ring = (fd < 0) ? nullptr : a2dp_audio_ring_map(fd);
+  if (ring == nullptr) {
+    APPL_TRACE_ERROR("%s: Error creating the audio ring", __func__);
+    if (fd >= 0) close(fd);
+    btif_a2dp_command_ack(A2DP_CTRL_ACK_FAILURE);
+    return;
+  }
+
+  btif_a2dp_control_close_audio_ring();
+  {
+    std::lock_guard<std::mutex> lock(audio_ring_mutex);
+    audio_ring = ring;
+    btif_a2dp_control_publish_position_locked();
+  }
+
+  btif_a2dp_command_ack(A2DP_CTRL_ACK_SUCCESS);
+  UIPC_SendFd(*a2dp_uipc, UIPC_CH_ID_AV_CTRL, fd);
+  close(fd);
+}
+
 static void btif_a2dp_recv_ctrl_data(void) {
   tA2DP_CTRL_CMD cmd = A2DP_CTRL_CMD_NONE;
   int n;
@@ -316,6 +370,10 @@ static void btif_a2dp_recv_ctrl_data(void) {
       btif_a2dp_control_on_get_presentation_position();
       break;
 
+    case A2DP_CTRL_CMD_OPEN_AUDIO_RING:
+      btif_a2dp_control_on_open_audio_ring();
+      break;
+
     default:
       APPL_TRACE_ERROR("%s: UNSUPPORTED CMD (%d)", __func__, cmd);
       btif_a2dp_command_ack(A2DP_CTRL_ACK_FAILURE);
@@ -393,6 +451,7 @@ static void btif_a2dp_data_cb(UNUSED_ATTR tUIPC_CH_ID ch_id,
 
     case UIPC_CLOSE_EVT:
       APPL_TRACE_EVENT("%s: ## AUDIO PATH DETACHED ##", __func__);
+      btif_a2dp_control_close_audio_ring();
       btif_a2dp_command_ack(A2DP_CTRL_ACK_SUCCESS);
       /*
        * Send stop request only if we are actively streaming and haven't
@@ -440,19 +499,53 @@ void btif_a2dp_command_ack(tA2DP_CTRL_ACK status) {
   }
 }
 
+uint32_t btif_a2dp_control_read_audio(uint8_t* p_buf, uint32_t len) {
+  uint32_t bytes_read = 0;
+  {
+    std::lock_guard<std::mutex> lock(audio_ring_mutex);
+    if (audio_ring != nullptr) {
+      bytes_read = a2dp_audio_ring_read(audio_ring, p_buf, len);
+    }
+  }
+
+  /* Without a ring the data comes from the audio socket. With one, the socket
+   * is still read on underflow to notice the audio HAL detaching. */
+  if (bytes_read < len && a2dp_uipc != nullptr) {
+    bytes_read += UIPC_Read(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, p_buf + bytes_read,
+                            len - bytes_read);
+  }
+  return bytes_read;
+}
+
+void btif_a2dp_control_flush_audio(void) {
+  {
+    std::lock_guard<std::mutex> lock(audio_ring_mutex);
+    if (audio_ring != nullptr) a2dp_audio_ring_flush(audio_ring);
+  }
+  if (a2dp_uipc != nullptr) {
+    UIPC_Ioctl(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, UIPC_REQ_RX_FLUSH, nullptr);
+  }
+}
+
 void btif_a2dp_control_log_bytes_read(uint32_t bytes_read) {
+  std::lock_guard<std::mutex> lock(audio_ring_mutex);
   delay_report_stats.total_bytes_read += bytes_read;
   clock_gettime(CLOCK_MONOTONIC, &delay_report_stats.timestamp);
+  btif_a2dp_control_publish_position_locked();
 }
 
 void btif_a2dp_control_set_audio_delay(uint16_t delay) {
   APPL_TRACE_DEBUG("%s: DELAY: %.1f ms", __func__, (float)delay / 10);
+  std::lock_guard<std::mutex> lock(audio_ring_mutex);
   delay_report_stats.audio_delay = delay;
+  btif_a2dp_control_publish_position_locked();
 }
 
 void btif_a2dp_control_reset_audio_delay(void) {
   APPL_TRACE_DEBUG("%s", __func__);
+  std::lock_guard<std::mutex> lock(audio_ring_mutex);
   delay_report_stats.audio_delay = 0;
   delay_report_stats.total_bytes_read = 0;
   delay_report_stats.timestamp = {};
+  btif_a2dp_control_publish_position_locked();
 }
@@ -29,16 +29,18 @@
 #include <string>
 
 #include "bt_target.h"  // Must be first to define build configuration
+#include "btif/include/btif_a2dp_sink_jitter_buffer.h"
 #include "btif/include/btif_av.h"
 #include "btif/include/btif_av_co.h"
 #include "btif/include/btif_avrcp_audio_track.h"
 #include "btif/include/btif_util.h"  // CASE_RETURN_STR
 #include "common/message_loop_thread.h"
+#include "common/time_util.h"
 #include "osi/include/alarm.h"
 #include "osi/include/allocator.h"
-#include "osi/include/fixed_queue.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"  // UNUSED_ATTR
+#include "osi/include/spmc_queue.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_types.h"
 #include "types/raw_address.h"
@@ -90,6 +92,9 @@ class BtifA2dpSinkControlBlock {
       : worker_thread(thread_name),
         rx_audio_queue(nullptr),
         rx_flush(false),
+        decode_ahead_pending(false),
+        jitter_buffer(MAX_INPUT_A2DP_FRAME_QUEUE_SZ,
+                      BTIF_SINK_MEDIA_TIME_TICK_MS * 1000),
         decode_alarm(nullptr),
         sample_rate(0),
         channel_count(0),
@@ -103,11 +108,14 @@ class BtifA2dpSinkControlBlock {
       BtifAvrcpAudioTrackDelete(audio_track);
     }
     audio_track = nullptr;
-    fixed_queue_free(rx_audio_queue, nullptr);
+    spmc_queue_free(rx_audio_queue, nullptr);
     rx_audio_queue = nullptr;
     alarm_free(decode_alarm);
     decode_alarm = nullptr;
     rx_flush = false;
+    decode_ahead_pending = false;
+    jitter_buffer = BtifA2dpSinkJitterBuffer(
+        MAX_INPUT_A2DP_FRAME_QUEUE_SZ, BTIF_SINK_MEDIA_TIME_TICK_MS * 1000);
     rx_focus_state = BTIF_A2DP_SINK_FOCUS_NOT_GRANTED;
     sample_rate = 0;
     channel_count = 0;
@@ -115,8 +123,10 @@ class BtifA2dpSinkControlBlock {
   }
 
   MessageLoopThread worker_thread;
-  fixed_queue_t* rx_audio_queue;
+  spmc_queue_t* rx_audio_queue;
   bool rx_flush; /* discards any incoming data when true */
+  bool decode_ahead_pending; /* a decode tick is posted for a full queue */
+  BtifA2dpSinkJitterBuffer jitter_buffer;
   alarm_t* decode_alarm;
   tA2DP_SAMPLE_RATE sample_rate;
   tA2DP_BITS_PER_SAMPLE bits_per_sample;
@@ -192,7 +202,8 @@ bool btif_a2dp_sink_init() {
     return false;
   }
 
-  btif_a2dp_sink_cb.rx_audio_queue = fixed_queue_new(SIZE_MAX);
+  btif_a2dp_sink_cb.rx_audio_queue =
+      spmc_queue_new(MAX_INPUT_A2DP_FRAME_QUEUE_SZ);
 
   /* Schedule the rest of the operations */
   if (!btif_a2dp_sink_cb.worker_thread.EnableRealTimeScheduling()) {
@@ -334,7 +345,7 @@ static void btif_a2dp_sink_cleanup_delayed() {
   LOG_INFO("%s", __func__);
   LockGuard lock(g_mutex);
 
-  fixed_queue_free(btif_a2dp_sink_cb.rx_audio_queue, nullptr);
+  spmc_queue_free(btif_a2dp_sink_cb.rx_audio_queue, nullptr);
   btif_a2dp_sink_cb.rx_audio_queue = nullptr;
   btif_a2dp_sink_state = BTIF_A2DP_SINK_STATE_OFF;
 }
@@ -514,14 +525,21 @@ static void btif_a2dp_sink_audio_handle_start_decoding() {
     LOG_ERROR("%s: unable to allocate decode alarm", __func__);
     return;
   }
+  btif_a2dp_sink_cb.jitter_buffer.Restart(
+      bluetooth::common::time_get_os_boottime_us());
   alarm_set(btif_a2dp_sink_cb.decode_alarm, BTIF_SINK_MEDIA_TIME_TICK_MS,
             btif_decode_alarm_cb, nullptr);
 }
 
+// Must be called while locked.
 static void btif_a2dp_sink_on_decode_complete(uint8_t* data, uint32_t len) {
+  const uint8_t* output;
+  size_t output_len =
+      btif_a2dp_sink_cb.jitter_buffer.ProcessAudio(data, len, &output);
+  if (output_len == 0) return;
 #ifndef OS_GENERIC
   BtifAvrcpAudioTrackWriteData(btif_a2dp_sink_cb.audio_track,
-                               reinterpret_cast<void*>(data), len);
+                               const_cast<uint8_t*>(output), output_len);
 #endif
 }
 
@@ -541,10 +559,15 @@ static void btif_a2dp_sink_handle_inc_media(BT_HDR* p_msg) {
 
 static void btif_a2dp_sink_avk_handle_timer() {
   LockGuard lock(g_mutex);
+  BtifA2dpSinkJitterBuffer& jitter_buffer = btif_a2dp_sink_cb.jitter_buffer;
+  btif_a2dp_sink_cb.decode_ahead_pending = false;
+  jitter_buffer.OnDecodeTick(bluetooth::common::time_get_os_boottime_us());
 
   BT_HDR* p_msg;
-  if (fixed_queue_is_empty(btif_a2dp_sink_cb.rx_audio_queue)) {
+  if (spmc_queue_is_empty(btif_a2dp_sink_cb.rx_audio_queue)) {
     APPL_TRACE_DEBUG("%s: empty queue", __func__);
+    // Lets the jitter buffer account for the underrun
+    jitter_buffer.ShouldDecodePacket(0);
     return;
   }
 
@@ -556,21 +579,26 @@ static void btif_a2dp_sink_avk_handle_timer() {
   }
   /* Play only in BTIF_A2DP_SINK_FOCUS_GRANTED case */
   if (btif_a2dp_sink_cb.rx_flush) {
-    fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+    spmc_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+    jitter_buffer.Restart(bluetooth::common::time_get_os_boottime_us());
     return;
   }
 
   APPL_TRACE_DEBUG("%s: process frames begin", __func__);
-  while (true) {
-    p_msg = (BT_HDR*)fixed_queue_try_dequeue(btif_a2dp_sink_cb.rx_audio_queue);
+  // The jitter buffer decodes the audio played since the previous tick, and
+  // keeps the rest of the queue to absorb the jitter of the arrivals
+  while (jitter_buffer.ShouldDecodePacket(
+      spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue))) {
+    p_msg = (BT_HDR*)spmc_queue_try_dequeue(btif_a2dp_sink_cb.rx_audio_queue);
     if (p_msg == NULL) {
       break;
     }
     APPL_TRACE_DEBUG("%s: number of packets in queue %zu", __func__,
-                     fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue));
+                     spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue));
 
     /* Queue packet has less frames */
     btif_a2dp_sink_handle_inc_media(p_msg);
+    jitter_buffer.OnPacketDecoded();
     osi_free(p_msg);
   }
   APPL_TRACE_DEBUG("%s: process frames end", __func__);
@@ -588,7 +616,9 @@ static void btif_a2dp_sink_audio_rx_flush_event() {
   LOG_INFO("%s", __func__);
   LockGuard lock(g_mutex);
   // Flush all received encoded audio buffers
-  fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+  spmc_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+  btif_a2dp_sink_cb.jitter_buffer.Restart(
+      bluetooth::common::time_get_os_boottime_us());
 }
 
 static void btif_a2dp_sink_decoder_update_event(
@@ -623,6 +653,8 @@ static void btif_a2dp_sink_decoder_update_event(
   btif_a2dp_sink_cb.sample_rate = sample_rate;
   btif_a2dp_sink_cb.bits_per_sample = bits_per_sample;
   btif_a2dp_sink_cb.channel_count = channel_count;
+  btif_a2dp_sink_cb.jitter_buffer.Configure(sample_rate, bits_per_sample,
+                                            channel_count);
 
   btif_a2dp_sink_cb.rx_flush = false;
   APPL_TRACE_DEBUG("%s: reset to Sink role", __func__);
@@ -646,7 +678,8 @@ static void btif_a2dp_sink_decoder_update_event(
   APPL_TRACE_DEBUG("%s: create audio track", __func__);
   btif_a2dp_sink_cb.audio_track =
 #ifndef OS_GENERIC
-      BtifAvrcpAudioTrackCreate(sample_rate, bits_per_sample, channel_count);
+      BtifAvrcpAudioTrackCreate(sample_rate, bits_per_sample, channel_count,
+                                BTIF_SINK_MEDIA_TIME_TICK_MS);
 #else
       NULL;
 #endif
@@ -659,12 +692,16 @@ static void btif_a2dp_sink_decoder_update_event(
 uint8_t btif_a2dp_sink_enqueue_buf(BT_HDR* p_pkt) {
   LockGuard lock(g_mutex);
   if (btif_a2dp_sink_cb.rx_flush) /* Flush enabled, do not enqueue */
-    return fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
+    return spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
+
+  BtifA2dpSinkJitterBuffer& jitter_buffer = btif_a2dp_sink_cb.jitter_buffer;
+  jitter_buffer.OnPacketReceived(bluetooth::common::time_get_os_boottime_us());
 
-  if (fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue) ==
+  if (spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue) ==
       MAX_INPUT_A2DP_FRAME_QUEUE_SZ) {
-    uint8_t ret = fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
-    osi_free(fixed_queue_try_dequeue(btif_a2dp_sink_cb.rx_audio_queue));
+    uint8_t ret = spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
+    spmc_queue_drop_oldest(btif_a2dp_sink_cb.rx_audio_queue, 1, osi_free);
+    jitter_buffer.OnPacketDropped();
     return ret;
   }
 
@@ -675,19 +712,33 @@ uint8_t btif_a2dp_sink_enqueue_buf(BT_HDR* p_pkt) {
   memcpy(p_msg, p_pkt, sizeof(*p_msg));
   p_msg->offset = 0;
   memcpy(p_msg->data, p_pkt->data + p_pkt->offset, p_pkt->len);
-  fixed_queue_enqueue(btif_a2dp_sink_cb.rx_audio_queue, p_msg);
-  if (fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue) ==
+  // The queue has room: only this function enqueues, under |g_mutex|
+  bool enqueued =
+      spmc_queue_try_enqueue(btif_a2dp_sink_cb.rx_audio_queue, p_msg);
+  CHECK(enqueued);
+  if (spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue) ==
       MAX_A2DP_DELAYED_START_FRAME_COUNT) {
     BTIF_TRACE_DEBUG("%s: Initiate decoding", __func__);
     btif_a2dp_sink_audio_handle_start_decoding();
   }
 
-  return fixed_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
+  // A burst of packets almost filled the queue: decode ahead of the next tick
+  // rather than drop packets
+  if (btif_a2dp_sink_cb.decode_alarm != nullptr &&
+      !btif_a2dp_sink_cb.decode_ahead_pending &&
+      jitter_buffer.IsOverrun(
+          spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue))) {
+    btif_a2dp_sink_cb.decode_ahead_pending = true;
+    btif_a2dp_sink_cb.worker_thread.DoInThread(
+        FROM_HERE, base::BindOnce(btif_a2dp_sink_avk_handle_timer));
+  }
+
+  return spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue);
 }
 
 void btif_a2dp_sink_audio_rx_flush_req() {
   LOG_INFO("%s", __func__);
-  if (fixed_queue_is_empty(btif_a2dp_sink_cb.rx_audio_queue)) {
+  if (spmc_queue_is_empty(btif_a2dp_sink_cb.rx_audio_queue)) {
     /* Queue is already empty */
     return;
   }
@@ -699,8 +750,64 @@ void btif_a2dp_sink_audio_rx_flush_req() {
       FROM_HERE, base::BindOnce(btif_a2dp_sink_command_ready, p_buf));
 }
 
-void btif_a2dp_sink_debug_dump(UNUSED_ATTR int fd) {
-  // Nothing to do
+void btif_a2dp_sink_debug_dump(int fd) {
+  LockGuard lock(g_mutex);
+  const BtifA2dpSinkJitterBuffer& jitter_buffer =
+      btif_a2dp_sink_cb.jitter_buffer;
+  const BtifA2dpSinkJitterBuffer::Stats& stats = jitter_buffer.GetStats();
+  uint32_t sample_rate =
+      (btif_a2dp_sink_cb.sample_rate > 0) ? btif_a2dp_sink_cb.sample_rate : 1;
+
+  dprintf(fd, "\nA2DP Sink State:\n");
+  dprintf(fd, "  RxQueue:\n");
+
+  dprintf(fd,
+          "  Counts (received/decoded/dropped)                       : %zu / "
+          "%zu / %zu\n",
+          stats.packets_received, stats.packets_decoded,
+          stats.packets_dropped);
+
+  dprintf(fd,
+          "  Counts (underruns/decoded ahead)                        : %zu / "
+          "%zu\n",
+          stats.underruns, stats.overruns);
+
+  dprintf(fd,
+          "  Packets in queue (current/max)                          : %zu / "
+          "%d\n",
+          spmc_queue_length(btif_a2dp_sink_cb.rx_audio_queue),
+          MAX_INPUT_A2DP_FRAME_QUEUE_SZ);
+
+  dprintf(fd,
+          "  Jitter buffer depth in ms (current/target)              : %llu / "
+          "%llu\n",
+          (unsigned long long)jitter_buffer.GetDepthUs() / 1000,
+          (unsigned long long)jitter_buffer.GetTargetDepthUs() / 1000);
+
+  dprintf(fd,
+          "  Packet duration in ms                                   : %llu\n",
+          (unsigned long long)jitter_buffer.GetPacketDurationUs() / 1000);
+
+  dprintf(fd,
+          "  Arrival interval in ms (mean/deviation/peak)            : %llu / "
+          "%llu / %llu\n",
+          (unsigned long long)jitter_buffer.GetMeanArrivalIntervalUs() / 1000,
+          (unsigned long long)jitter_buffer.GetArrivalJitterUs() / 1000,
+          (unsigned long long)jitter_buffer.GetPeakArrivalIntervalUs() / 1000);
+
+  dprintf(fd,
+          "  Silence in ms (dropped/inserted)                        : %llu / "
+          "%llu\n",
+          (unsigned long long)(stats.silence_dropped_frames * 1000 /
+                               sample_rate),
+          (unsigned long long)(stats.silence_inserted_frames * 1000 /
+                               sample_rate));
+
+  dprintf(fd,
+          "  Time-stretching in ms (compressed/stretched)            : %llu / "
+          "%llu\n",
+          (unsigned long long)(stats.compressed_frames * 1000 / sample_rate),
+          (unsigned long long)(stats.stretched_frames * 1000 / sample_rate));
 }
 
 void btif_a2dp_sink_set_focus_state_req(btif_a2dp_sink_focus_state_t state) {
@@ -723,7 +830,9 @@ static void btif_a2dp_sink_set_focus_state_event(
   APPL_TRACE_DEBUG("%s: setting focus state to %d", __func__, state);
   btif_a2dp_sink_cb.rx_focus_state = state;
   if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_NOT_GRANTED) {
-    fixed_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+    spmc_queue_flush(btif_a2dp_sink_cb.rx_audio_queue, osi_free);
+    btif_a2dp_sink_cb.jitter_buffer.Restart(
+        bluetooth::common::time_get_os_boottime_us());
     btif_a2dp_sink_cb.rx_flush = true;
   } else if (btif_a2dp_sink_cb.rx_focus_state == BTIF_A2DP_SINK_FOCUS_GRANTED) {
     btif_a2dp_sink_cb.rx_flush = false;
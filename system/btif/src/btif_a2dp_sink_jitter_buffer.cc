@@ -0,0 +1,347 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "btif/include/btif_a2dp_sink_jitter_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Weight of each new inter-arrival time in the mean and variance
+constexpr double kIntervalWeight = 1.0 / 16;
+// The peak inter-arrival time decays by this fraction with each packet, i.e.
+// it is forgotten after a few hundred packets.
+constexpr double kPeakIntervalDecay = 1.0 / 256;
+// Number of standard deviations of the inter-arrival times covered by the
+// target depth
+constexpr double kJitterDeviations = 2.0;
+// Weight of each new packet in the average packet duration
+constexpr uint64_t kPacketDurationWeight = 8;
+// Decoded blocks below -60 dBFS are silent
+constexpr int kSilenceThresholdShift = 11;
+
+}  // namespace
+
+BtifA2dpSinkJitterBuffer::BtifA2dpSinkJitterBuffer(size_t max_queue_length,
+                                                   uint64_t decode_tick_us)
+    : max_queue_length_(max_queue_length), decode_tick_us_(decode_tick_us) {}
+
+void BtifA2dpSinkJitterBuffer::Configure(uint32_t sample_rate,
+                                         uint8_t bits_per_sample,
+                                         uint8_t channel_count) {
+  sample_rate_ = sample_rate;
+  bytes_per_sample_ = bits_per_sample / 8;
+  if (bytes_per_sample_ < 2 || bytes_per_sample_ > 4) bytes_per_sample_ = 0;
+  channel_count_ = channel_count;
+
+  last_arrival_us_ = 0;
+  interval_mean_us_ = 0;
+  interval_variance_us2_ = 0;
+  peak_interval_us_ = 0;
+  target_depth_us_ = kMinTargetDepthUs;
+  packet_duration_us_ = 0;
+  pending_frames_ = 0;
+  Restart(0);
+}
+
+void BtifA2dpSinkJitterBuffer::Restart(uint64_t now_us) {
+  buffering_ = true;
+  overrun_ = false;
+  last_tick_us_ = now_us;
+  credit_us_ = 0;
+  depth_us_ = 0;
+}
+
+void BtifA2dpSinkJitterBuffer::OnPacketReceived(uint64_t now_us) {
+  stats_.packets_received++;
+
+  uint64_t last_arrival_us = last_arrival_us_;
+  last_arrival_us_ = now_us;
+  if (last_arrival_us == 0 || now_us < last_arrival_us) return;
+  uint64_t interval_us = now_us - last_arrival_us;
+  // Longer gaps can't be covered by the queue: they are outages of the
+  // stream, after which the decoding buffers again
+  if (interval_us > kMaxTargetDepthUs) return;
+
+  if (interval_mean_us_ == 0) {
+    interval_mean_us_ = interval_us;
+  } else {
+    double diff = interval_us - interval_mean_us_;
+    interval_mean_us_ += kIntervalWeight * diff;
+    interval_variance_us2_ = (1 - kIntervalWeight) *
+                             (interval_variance_us2_ +
+                              kIntervalWeight * diff * diff);
+  }
+  peak_interval_us_ = std::max<double>(
+      interval_us, peak_interval_us_ * (1 - kPeakIntervalDecay));
+  UpdateTargetDepth();
+}
+
+void BtifA2dpSinkJitterBuffer::UpdateTargetDepth() {
+  // The queue must hold the audio played during the longest recent arrival
+  // gap, and during one decode tick since it is only refilled between ticks.
+  double gap_us = std::max(peak_interval_us_,
+                           interval_mean_us_ +
+                               kJitterDeviations *
+                                   std::sqrt(interval_variance_us2_));
+  target_depth_us_ = std::clamp<uint64_t>(gap_us + decode_tick_us_,
+                                          kMinTargetDepthUs, kMaxTargetDepthUs);
+}
+
+bool BtifA2dpSinkJitterBuffer::IsOverrun(size_t queue_length) const {
+  return queue_length >= max_queue_length_ - max_queue_length_ / 4;
+}
+
+void BtifA2dpSinkJitterBuffer::OnDecodeTick(uint64_t now_us) {
+  // A late tick catches up with the played audio, but not further than a few
+  // ticks
+  uint64_t elapsed_us = 0;
+  if (now_us > last_tick_us_) {
+    elapsed_us = std::min(now_us - last_tick_us_, 4 * decode_tick_us_);
+  }
+  last_tick_us_ = now_us;
+  overrun_ = false;
+
+  if (buffering_) {
+    credit_us_ = 0;
+    return;
+  }
+  // The audio decoded ahead of time is accounted, within the longest depth
+  credit_us_ = std::max<int64_t>(credit_us_ + elapsed_us,
+                                 -(int64_t)kMaxTargetDepthUs);
+}
+
+bool BtifA2dpSinkJitterBuffer::ShouldDecodePacket(size_t queue_length) {
+  depth_us_ = queue_length * packet_duration_us_;
+
+  if (queue_length == 0) {
+    if (!buffering_ && credit_us_ > 0 && packet_duration_us_ != 0) {
+      stats_.underruns++;
+      buffering_ = true;
+      credit_us_ = 0;
+    }
+    return false;
+  }
+
+  if (buffering_) {
+    // Until the duration of the packets is known, decoding starts right away
+    if (packet_duration_us_ != 0 && depth_us_ < target_depth_us_) return false;
+    buffering_ = false;
+    credit_us_ = decode_tick_us_;
+  }
+
+  if (credit_us_ > 0) return true;
+
+  if (IsOverrun(queue_length)) {
+    if (!overrun_) stats_.overruns++;
+    overrun_ = true;
+    return true;
+  }
+  return false;
+}
+
+BtifA2dpSinkJitterBuffer::Adjustment BtifA2dpSinkJitterBuffer::GetAdjustment()
+    const {
+  if (overrun_) return Adjustment::kCompress;
+  if (packet_duration_us_ == 0) return Adjustment::kNone;
+
+  // The depth is only known to one packet
+  if (depth_us_ > target_depth_us_ + packet_duration_us_) {
+    return Adjustment::kCompress;
+  }
+  if (depth_us_ + packet_duration_us_ < target_depth_us_) {
+    return Adjustment::kStretch;
+  }
+  return Adjustment::kNone;
+}
+
+size_t BtifA2dpSinkJitterBuffer::ProcessAudio(const uint8_t* data, size_t len,
+                                              const uint8_t** output) {
+  *output = data;
+  size_t frame_size = bytes_per_sample_ * channel_count_;
+  if (frame_size == 0 || sample_rate_ == 0 || len % frame_size != 0) {
+    return len;
+  }
+
+  size_t frames = len / frame_size;
+  pending_frames_ += frames;
+
+  size_t output_frames = frames;
+  size_t overlap = frames / kOverlapDivisor;
+  switch (GetAdjustment()) {
+    case Adjustment::kNone:
+      break;
+
+    case Adjustment::kCompress:
+      if (IsSilent(data, frames)) {
+        stats_.silence_dropped_frames += frames;
+        output_frames = 0;
+      } else if (overlap != 0) {
+        // The first frames are cross-faded into the frames |shift| later:
+        // the |shift| frames in between are skipped
+        size_t shift = FindShift(data, overlap);
+        output_frames = frames - shift;
+        output_.resize(output_frames * frame_size);
+        CrossFade(data, data + shift * frame_size, overlap, output_.data());
+        memcpy(output_.data() + overlap * frame_size,
+               data + (shift + overlap) * frame_size,
+               (frames - shift - overlap) * frame_size);
+        stats_.compressed_frames += shift;
+        *output = output_.data();
+      }
+      break;
+
+    case Adjustment::kStretch:
+      if (IsSilent(data, frames)) {
+        // The block is played twice
+        output_frames = 2 * frames;
+        output_.resize(output_frames * frame_size);
+        memcpy(output_.data(), data, len);
+        memcpy(output_.data() + len, data, len);
+        stats_.silence_inserted_frames += frames;
+        *output = output_.data();
+      } else if (overlap != 0) {
+        // The frames |shift| later are cross-faded back into the first
+        // frames: the |shift| frames in between are played twice
+        size_t shift = FindShift(data, overlap);
+        output_frames = frames + shift;
+        output_.resize(output_frames * frame_size);
+        memcpy(output_.data(), data, shift * frame_size);
+        CrossFade(data + shift * frame_size, data, overlap,
+                  output_.data() + shift * frame_size);
+        memcpy(output_.data() + (shift + overlap) * frame_size,
+               data + overlap * frame_size, (frames - overlap) * frame_size);
+        stats_.stretched_frames += shift;
+        *output = output_.data();
+      }
+      break;
+  }
+
+  credit_us_ -= FramesToUs(output_frames);
+  return output_frames * frame_size;
+}
+
+void BtifA2dpSinkJitterBuffer::OnPacketDecoded() {
+  stats_.packets_decoded++;
+  if (pending_frames_ == 0) return;
+
+  uint64_t duration_us = FramesToUs(pending_frames_);
+  pending_frames_ = 0;
+  if (packet_duration_us_ == 0) {
+    packet_duration_us_ = duration_us;
+  } else {
+    packet_duration_us_ =
+        ((kPacketDurationWeight - 1) * packet_duration_us_ + duration_us) /
+        kPacketDurationWeight;
+  }
+}
+
+uint64_t BtifA2dpSinkJitterBuffer::GetMeanArrivalIntervalUs() const {
+  return std::lrint(interval_mean_us_);
+}
+
+uint64_t BtifA2dpSinkJitterBuffer::GetArrivalJitterUs() const {
+  return std::lrint(std::sqrt(interval_variance_us2_));
+}
+
+uint64_t BtifA2dpSinkJitterBuffer::GetPeakArrivalIntervalUs() const {
+  return std::lrint(peak_interval_us_);
+}
+
+bool BtifA2dpSinkJitterBuffer::IsSilent(const uint8_t* data,
+                                        size_t frames) const {
+  const int32_t threshold = 1 << (8 * bytes_per_sample_ -
+                                  kSilenceThresholdShift);
+  size_t samples = frames * channel_count_;
+  for (size_t i = 0; i < samples; i++) {
+    int32_t sample = ReadSample(data + i * bytes_per_sample_);
+    if (sample >= threshold || sample <= -threshold) return false;
+  }
+  return true;
+}
+
+int32_t BtifA2dpSinkJitterBuffer::ReadSample(const uint8_t* p) const {
+  switch (bytes_per_sample_) {
+    case 2:
+      return (int16_t)(p[0] | (p[1] << 8));
+    case 3:
+      return p[0] | (p[1] << 8) | ((int8_t)p[2] * 65536);
+    default:
+      return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                       ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+  }
+}
+
+void BtifA2dpSinkJitterBuffer::WriteSample(uint8_t* p, int32_t sample) const {
+  for (uint8_t i = 0; i < bytes_per_sample_; i++) {
+    p[i] = (uint32_t)sample >> (8 * i);
+  }
+}
+
+size_t BtifA2dpSinkJitterBuffer::FindShift(const uint8_t* data,
+                                           size_t overlap) const {
+  // The cross-fade is the least audible between similar waveforms: the shift
+  // maximizes the normalized correlation of the first |overlap| frames with
+  // the frames |shift| later, e.g. a multiple of the pitch period.
+  size_t samples = overlap * channel_count_;
+  size_t best_shift = overlap;
+  double best_score = -2;
+  for (size_t shift = overlap; shift <= kMaxShiftOverlaps * overlap; shift++) {
+    const uint8_t* shifted = data + shift * channel_count_ * bytes_per_sample_;
+    double dot = 0;
+    double energy_a = 0;
+    double energy_b = 0;
+    for (size_t i = 0; i < samples; i++) {
+      double a = ReadSample(data + i * bytes_per_sample_);
+      double b = ReadSample(shifted + i * bytes_per_sample_);
+      dot += a * b;
+      energy_a += a * a;
+      energy_b += b * b;
+    }
+    double score = (energy_a == 0 || energy_b == 0)
+                       ? 0
+                       : dot / std::sqrt(energy_a * energy_b);
+    if (score > best_score) {
+      best_score = score;
+      best_shift = shift;
+    }
+  }
+  return best_shift;
+}
+
+void BtifA2dpSinkJitterBuffer::CrossFade(const uint8_t* from,
+                                         const uint8_t* to, size_t frames,
+                                         uint8_t* out) const {
+  size_t frame_size = bytes_per_sample_ * channel_count_;
+  for (size_t i = 0; i < frames; i++) {
+    for (uint8_t c = 0; c < channel_count_; c++) {
+      size_t offset = i * frame_size + c * bytes_per_sample_;
+      int64_t a = ReadSample(from + offset);
+      int64_t b = ReadSample(to + offset);
+      WriteSample(out + offset,
+                  (int32_t)((a * (int64_t)(frames - i) + b * (int64_t)i) /
+                            (int64_t)frames));
+    }
+  }
+}
+
+uint64_t BtifA2dpSinkJitterBuffer::FramesToUs(uint64_t frames) const {
+  return frames * 1000000 / sample_rate_;
+}
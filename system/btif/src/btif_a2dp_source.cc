@@ -46,10 +46,14 @@
 #include "common/metrics.h"
 #include "common/repeating_timer.h"
 #include "common/time_util.h"
+#include "gd/metrics/latency_histogram.h"
+#include "gd/os/trace.h"
+#include "internal_include/bt_target.h"
 #include "osi/include/allocator.h"
-#include "osi/include/fixed_queue.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/properties.h"
+#include "osi/include/spmc_queue.h"
 #include "osi/include/wakelock.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/acl_api_types.h"
@@ -70,6 +74,27 @@ extern std::unique_ptr<tUIPC_STATE> a2dp_uipc;
  */
 #define MAX_OUTPUT_A2DP_FRAME_QUEUE_SZ (MAX_PCM_FRAME_NUM_PER_TICK * 2)
 
+/**
+ * Capacity of the tx queue: its length is kept within the dynamic audio
+ * buffer size, which is at most UINT8_MAX, plus the buffer being enqueued.
+ */
+#define TX_AUDIO_QUEUE_CAPACITY (UINT8_MAX + 1)
+
+/**
+ * Number of buffers taken out of the tx queue at a time when it overflows.
+ */
+#define TX_AUDIO_QUEUE_DROP_BATCH 16
+
+/**
+ * With HAL pacing, the encoder runs once the audio HAL has written the audio
+ * data of a whole encoder interval, within a window of the interval divided
+ * by HAL_PACING_JITTER_DIVISOR around the expected time, and the HAL is
+ * polled HAL_PACING_POLLS_PER_INTERVAL times per encoder interval.
+ */
+#define HAL_PACING_PROPERTY "bluetooth.a2dp.source.hal_pacing.enabled"
+#define HAL_PACING_JITTER_DIVISOR 4
+#define HAL_PACING_POLLS_PER_INTERVAL 8
+
 class SchedulingStats {
  public:
   SchedulingStats() { Reset(); }
@@ -140,6 +165,8 @@ class BtifMediaStats {
     media_read_total_underflow_bytes = 0;
     media_read_total_underflow_count = 0;
     media_read_last_underflow_us = 0;
+    hal_pacing_data_ready_ticks = 0;
+    hal_pacing_deadline_ticks = 0;
     codec_index = -1;
   }
 
@@ -170,6 +197,9 @@ class BtifMediaStats {
   size_t media_read_total_underflow_count;
   uint64_t media_read_last_underflow_us;
 
+  size_t hal_pacing_data_ready_ticks;  // Ticks run when the HAL data was ready
+  size_t hal_pacing_deadline_ticks;    // Ticks run when the window elapsed
+
   int codec_index = -1;
 };
 
@@ -187,16 +217,24 @@ class BtifA2dpSource {
         tx_flush(false),
         encoder_interface(nullptr),
         encoder_interval_ms(0),
+        packet_pool(),
+        hal_pacing(false),
+        hal_pacing_tick_bytes(0),
+        hal_pacing_last_tick_us(0),
         state_(kStateOff) {}
 
   void Reset() {
-    fixed_queue_free(tx_audio_queue, nullptr);
+    spmc_queue_free(tx_audio_queue, nullptr);
     tx_audio_queue = nullptr;
     tx_flush = false;
     media_alarm.CancelAndWait();
     wakelock_release();
     encoder_interface = nullptr;
     encoder_interval_ms = 0;
+    FreePacketPool();
+    hal_pacing = false;
+    hal_pacing_tick_bytes = 0;
+    hal_pacing_last_tick_us = 0;
     stats.Reset();
     accumulated_stats.Reset();
     state_ = kStateOff;
@@ -218,11 +256,30 @@ class BtifA2dpSource {
 
   void SetState(BtifA2dpSource::RunState state) { state_ = state; }
 
-  fixed_queue_t* tx_audio_queue;
+  // Tops up the packet buffers given to the encoder on each tick
+  void FillPacketPool() {
+    packet_pool.buffer_size = BT_DEFAULT_BUFFER_SIZE;
+    while (packet_pool.count < A2DP_ENCODER_PACKET_POOL_SIZE) {
+      packet_pool.packets[packet_pool.count++] =
+          (BT_HDR*)osi_buffer_alloc(packet_pool.buffer_size);
+    }
+  }
+
+  void FreePacketPool() {
+    while (packet_pool.count > 0) {
+      osi_free(packet_pool.packets[--packet_pool.count]);
+    }
+  }
+
+  spmc_queue_t* tx_audio_queue;
   bool tx_flush; /* Discards any outgoing data when true */
   RepeatingTimer media_alarm;
   const tA2DP_ENCODER_INTERFACE* encoder_interface;
   uint64_t encoder_interval_ms; /* Local copy of the encoder interval */
+  tA2DP_ENCODER_PACKET_POOL packet_pool; /* Buffers for send_frames_batch */
+  bool hal_pacing; /* The encoder is paced by the audio HAL data */
+  size_t hal_pacing_tick_bytes;     /* Audio data bytes of an encoder tick */
+  uint64_t hal_pacing_last_tick_us; /* Time of the last HAL-paced tick */
   BtifMediaStats stats;
   BtifMediaStats accumulated_stats;
 
@@ -248,6 +305,8 @@ static void btif_a2dp_source_cleanup_delayed(void);
 static void btif_a2dp_source_audio_tx_start_event(void);
 static void btif_a2dp_source_audio_tx_stop_event(void);
 static void btif_a2dp_source_audio_tx_flush_event(void);
+static bool btif_a2dp_source_hal_pacing_setup(void);
+static void btif_a2dp_source_audio_handle_hal_poll(void);
 // Set up the A2DP Source codec, and prepare the encoder.
 // The peer address is |peer_addr|.
 // This function should be called prior to starting A2DP streaming.
@@ -319,6 +378,8 @@ void btif_a2dp_source_accumulate_stats(BtifMediaStats* src,
   dst->media_read_total_underflow_count +=
       src->media_read_total_underflow_count;
   dst->media_read_last_underflow_us = src->media_read_last_underflow_us;
+  dst->hal_pacing_data_ready_ticks += src->hal_pacing_data_ready_ticks;
+  dst->hal_pacing_deadline_ticks += src->hal_pacing_deadline_ticks;
   if (dst->codec_index < 0) dst->codec_index = src->codec_index;
   btif_a2dp_source_accumulate_scheduling_stats(&src->tx_queue_enqueue_stats,
                                                &dst->tx_queue_enqueue_stats);
@@ -352,7 +413,8 @@ bool btif_a2dp_source_startup(void) {
 
   btif_a2dp_source_cb.Reset();
   btif_a2dp_source_cb.SetState(BtifA2dpSource::kStateStartingUp);
-  btif_a2dp_source_cb.tx_audio_queue = fixed_queue_new(SIZE_MAX);
+  btif_a2dp_source_cb.tx_audio_queue =
+      spmc_queue_new(TX_AUDIO_QUEUE_CAPACITY);
 
   // Schedule the rest of the operations
   btif_a2dp_source_thread.DoInThread(
@@ -513,7 +575,7 @@ static void btif_a2dp_source_shutdown_delayed(
   } else {
     btif_a2dp_control_cleanup();
   }
-  fixed_queue_free(btif_a2dp_source_cb.tx_audio_queue, nullptr);
+  spmc_queue_free(btif_a2dp_source_cb.tx_audio_queue, nullptr);
   btif_a2dp_source_cb.tx_audio_queue = nullptr;
 
   btif_a2dp_source_cb.SetState(BtifA2dpSource::kStateOff);
@@ -812,16 +874,27 @@ static void btif_a2dp_source_audio_tx_start_event(void) {
   /* audio engine starting, reset tx suspended flag */
   btif_a2dp_source_cb.tx_flush = false;
 
+  // With HAL pacing, poll the audio HAL for data several times per interval
+  uint64_t alarm_period_ms =
+      btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms();
+  btif_a2dp_source_cb.hal_pacing = btif_a2dp_source_hal_pacing_setup();
+  if (btif_a2dp_source_cb.hal_pacing) {
+    alarm_period_ms = std::max<uint64_t>(
+        alarm_period_ms / HAL_PACING_POLLS_PER_INTERVAL, 1);
+  }
+
   wakelock_acquire();
   btif_a2dp_source_cb.media_alarm.SchedulePeriodic(
       btif_a2dp_source_thread.GetWeakPtr(), FROM_HERE,
-      base::Bind(&btif_a2dp_source_audio_handle_timer),
+      base::Bind(btif_a2dp_source_cb.hal_pacing
+                     ? &btif_a2dp_source_audio_handle_hal_poll
+                     : &btif_a2dp_source_audio_handle_timer),
 #if BASE_VER < 931007
       base::TimeDelta::FromMilliseconds(
 #else
       base::Milliseconds(
 #endif
-          btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms()));
+          alarm_period_ms));
 
   btif_a2dp_source_cb.stats.Reset();
   // Assign session_start_us to 1 when
@@ -862,7 +935,7 @@ static void btif_a2dp_source_audio_tx_stop_event(void) {
         bluetooth::audio::a2dp::read(p_buf, sizeof(p_buf)));
   } else if (a2dp_uipc != nullptr) {
     btif_a2dp_control_log_bytes_read(
-        UIPC_Read(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, p_buf, sizeof(p_buf)));
+        btif_a2dp_control_read_audio(p_buf, sizeof(p_buf)));
   }
 
   /* Stop the timer first */
@@ -896,6 +969,70 @@ static void btif_a2dp_source_audio_tx_stop_event(void) {
   /* Reset the media feeding state */
   if (btif_a2dp_source_cb.encoder_interface != nullptr)
     btif_a2dp_source_cb.encoder_interface->feeding_reset();
+
+  btif_a2dp_source_cb.FreePacketPool();
+}
+
+// Gets the size of the audio data of an encoder interval when the HAL pacing
+// is enabled. Returns true if the encoder is to be paced by the audio HAL.
+static bool btif_a2dp_source_hal_pacing_setup(void) {
+  btif_a2dp_source_cb.hal_pacing_tick_bytes = 0;
+  btif_a2dp_source_cb.hal_pacing_last_tick_us = 0;
+  if (!osi_property_get_bool(HAL_PACING_PROPERTY, false) ||
+      !bluetooth::audio::a2dp::is_hal_enabled()) {
+    return false;
+  }
+
+  A2dpCodecConfig* codec_config = bta_av_get_a2dp_current_codec();
+  uint8_t codec_info[AVDT_CODEC_SIZE];
+  if (codec_config == nullptr ||
+      !codec_config->copyOutOtaCodecConfig(codec_info)) {
+    LOG_WARN("%s: no current codec, using the timer pacing", __func__);
+    return false;
+  }
+  int sample_rate = A2DP_GetTrackSampleRate(codec_info);
+  int channel_count = A2DP_GetTrackChannelCount(codec_info);
+  int bits_per_sample = codec_config->getAudioBitsPerSample();
+  if (sample_rate <= 0 || channel_count <= 0 || bits_per_sample == 0) {
+    LOG_WARN("%s: unknown audio format, using the timer pacing", __func__);
+    return false;
+  }
+
+  btif_a2dp_source_cb.hal_pacing_tick_bytes =
+      (uint64_t)sample_rate * channel_count * (bits_per_sample / 8) *
+      btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms() / 1000;
+  LOG_INFO("%s: %zu bytes per tick", __func__,
+           btif_a2dp_source_cb.hal_pacing_tick_bytes);
+  return true;
+}
+
+// Runs the encoder tick once the audio HAL has the data of a whole encoder
+// interval. The tick is held back until the window around its expected time
+// opens, and runs when the window closes even if the data is not there, so
+// that the jitter of the HAL writes neither bursts nor starves the reads.
+static void btif_a2dp_source_audio_handle_hal_poll(void) {
+  if (btif_av_is_a2dp_offload_running()) return;
+
+  uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+  uint64_t interval_us = btif_a2dp_source_cb.encoder_interval_ms * 1000;
+  uint64_t jitter_us = interval_us / HAL_PACING_JITTER_DIVISOR;
+  uint64_t last_us = btif_a2dp_source_cb.hal_pacing_last_tick_us;
+
+  if (last_us != 0) {
+    uint64_t elapsed_us = now_us - last_us;
+    if (elapsed_us + jitter_us < interval_us) return;
+    if (elapsed_us < interval_us + jitter_us) {
+      if (bluetooth::audio::a2dp::available_to_read() <
+          btif_a2dp_source_cb.hal_pacing_tick_bytes) {
+        return;
+      }
+      btif_a2dp_source_cb.stats.hal_pacing_data_ready_ticks++;
+    } else {
+      btif_a2dp_source_cb.stats.hal_pacing_deadline_ticks++;
+    }
+  }
+  btif_a2dp_source_cb.hal_pacing_last_tick_us = now_us;
+  btif_a2dp_source_audio_handle_timer();
 }
 
 static void btif_a2dp_source_audio_handle_timer(void) {
@@ -910,7 +1047,7 @@ static void btif_a2dp_source_audio_handle_timer(void) {
   }
   CHECK(btif_a2dp_source_cb.encoder_interface != nullptr);
   size_t transmit_queue_length =
-      fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue);
+      spmc_queue_length(btif_a2dp_source_cb.tx_audio_queue);
 #ifndef OS_GENERIC
   ATRACE_INT("btif TX queue", transmit_queue_length);
 #endif
@@ -919,7 +1056,20 @@ static void btif_a2dp_source_audio_handle_timer(void) {
     btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length(
         transmit_queue_length);
   }
-  btif_a2dp_source_cb.encoder_interface->send_frames(timestamp_us);
+  {
+    static auto& encode_latency =
+        bluetooth::metrics::LatencyHistogram::Get("a2dp_source.encode");
+    bluetooth::metrics::ScopedLatency scoped_latency(encode_latency);
+    bluetooth::os::ScopedTrace trace("A2DP source encode");
+    if (btif_a2dp_source_cb.encoder_interface->send_frames_batch != nullptr) {
+      // Reuse the packet buffers the encoder didn't fill on the previous tick
+      btif_a2dp_source_cb.FillPacketPool();
+      btif_a2dp_source_cb.encoder_interface->send_frames_batch(
+          timestamp_us, &btif_a2dp_source_cb.packet_pool);
+    } else {
+      btif_a2dp_source_cb.encoder_interface->send_frames(timestamp_us);
+    }
+  }
   bta_av_ci_src_data_ready(BTA_AV_CHNL_AUDIO);
   update_scheduling_stats(&btif_a2dp_source_cb.stats.tx_queue_enqueue_stats,
                           timestamp_us,
@@ -932,7 +1082,7 @@ static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len) {
   if (bluetooth::audio::a2dp::is_hal_enabled()) {
     bytes_read = bluetooth::audio::a2dp::read(p_buf, len);
   } else if (a2dp_uipc != nullptr) {
-    bytes_read = UIPC_Read(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, p_buf, len);
+    bytes_read = btif_a2dp_control_read_audio(p_buf, len);
   }
 
   if (bytes_read < len) {
@@ -967,9 +1117,8 @@ static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
     LOG_VERBOSE("%s: tx suspended, discarded frame", __func__);
 
     btif_a2dp_source_cb.stats.tx_queue_total_flushed_messages +=
-        fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue);
+        spmc_queue_flush(btif_a2dp_source_cb.tx_audio_queue, osi_free);
     btif_a2dp_source_cb.stats.tx_queue_last_flushed_us = now_us;
-    fixed_queue_flush(btif_a2dp_source_cb.tx_audio_queue, osi_free);
 
     osi_free(p_buf);
     return false;
@@ -977,30 +1126,32 @@ static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
 
   // Check for TX queue overflow
   // TODO: Using frames_n here is probably wrong: should be "+ 1" instead.
-  if (fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue) + frames_n >
+  if (spmc_queue_length(btif_a2dp_source_cb.tx_audio_queue) + frames_n >
       btif_a2dp_source_dynamic_audio_buffer_size) {
     LOG_WARN("%s: TX queue buffer size now=%u adding=%u max=%d", __func__,
-             (uint32_t)fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue),
+             (uint32_t)spmc_queue_length(btif_a2dp_source_cb.tx_audio_queue),
              (uint32_t)frames_n, btif_a2dp_source_dynamic_audio_buffer_size);
     // Keep track of drop-outs
     btif_a2dp_source_cb.stats.tx_queue_dropouts++;
     btif_a2dp_source_cb.stats.tx_queue_last_dropouts_us = now_us;
 
     // Flush all queued buffers
-    size_t drop_n = fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue);
+    size_t drop_n = spmc_queue_length(btif_a2dp_source_cb.tx_audio_queue);
     btif_a2dp_source_cb.stats.tx_queue_max_dropped_messages = std::max(
         drop_n, btif_a2dp_source_cb.stats.tx_queue_max_dropped_messages);
     int num_dropped_encoded_bytes = 0;
     int num_dropped_encoded_frames = 0;
-    while (fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue)) {
-      btif_a2dp_source_cb.stats.tx_queue_total_dropped_messages++;
-      void* p_data =
-          fixed_queue_try_dequeue(btif_a2dp_source_cb.tx_audio_queue);
-      if (p_data != nullptr) {
-        auto p_dropped_buf = static_cast<BT_HDR*>(p_data);
+    void* p_dropped[TX_AUDIO_QUEUE_DROP_BATCH];
+    size_t dropped_n;
+    while ((dropped_n = spmc_queue_try_dequeue_batch(
+                btif_a2dp_source_cb.tx_audio_queue, p_dropped,
+                TX_AUDIO_QUEUE_DROP_BATCH)) > 0) {
+      btif_a2dp_source_cb.stats.tx_queue_total_dropped_messages += dropped_n;
+      for (size_t i = 0; i < dropped_n; i++) {
+        auto p_dropped_buf = static_cast<BT_HDR*>(p_dropped[i]);
         num_dropped_encoded_bytes += p_dropped_buf->len;
         num_dropped_encoded_frames += p_dropped_buf->layer_specific;
-        osi_free(p_data);
+        osi_free(p_dropped_buf);
       }
     }
     log_a2dp_audio_overrun_event(btif_av_source_active_peer(), drop_n,
@@ -1033,7 +1184,11 @@ static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
       frames_n, btif_a2dp_source_cb.stats.tx_queue_max_frames_per_packet);
   CHECK(btif_a2dp_source_cb.encoder_interface != nullptr);
 
-  fixed_queue_enqueue(btif_a2dp_source_cb.tx_audio_queue, p_buf);
+  if (!spmc_queue_try_enqueue(btif_a2dp_source_cb.tx_audio_queue, p_buf)) {
+    LOG_WARN("%s: TX queue full, discarded frame", __func__);
+    osi_free(p_buf);
+    return false;
+  }
 
   return true;
 }
@@ -1047,13 +1202,12 @@ static void btif_a2dp_source_audio_tx_flush_event(void) {
     btif_a2dp_source_cb.encoder_interface->feeding_flush();
 
   btif_a2dp_source_cb.stats.tx_queue_total_flushed_messages +=
-      fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue);
+      spmc_queue_flush(btif_a2dp_source_cb.tx_audio_queue, osi_free);
   btif_a2dp_source_cb.stats.tx_queue_last_flushed_us =
       bluetooth::common::time_get_os_boottime_us();
-  fixed_queue_flush(btif_a2dp_source_cb.tx_audio_queue, osi_free);
 
   if (!bluetooth::audio::a2dp::is_hal_enabled() && a2dp_uipc != nullptr) {
-    UIPC_Ioctl(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, UIPC_REQ_RX_FLUSH, nullptr);
+    btif_a2dp_control_flush_audio();
   }
 }
 
@@ -1068,7 +1222,7 @@ static bool btif_a2dp_source_audio_tx_flush_req(void) {
 BT_HDR* btif_a2dp_source_audio_readbuf(void) {
   uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
   BT_HDR* p_buf =
-      (BT_HDR*)fixed_queue_try_dequeue(btif_a2dp_source_cb.tx_audio_queue);
+      (BT_HDR*)spmc_queue_try_dequeue(btif_a2dp_source_cb.tx_audio_queue);
 
   btif_a2dp_source_cb.stats.tx_queue_total_readbuf_calls++;
   btif_a2dp_source_cb.stats.tx_queue_last_readbuf_us = now_us;
@@ -1087,7 +1241,7 @@ static void log_tstamps_us(const char* comment, uint64_t timestamp_us) {
   APPL_TRACE_DEBUG("%s: [%s] ts %08" PRIu64 ", diff : %08" PRIu64
                    ", queue sz %zu",
                    __func__, comment, timestamp_us, timestamp_us - prev_us,
-                   fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue));
+                   spmc_queue_length(btif_a2dp_source_cb.tx_audio_queue));
   prev_us = timestamp_us;
 }
 
@@ -1201,6 +1355,16 @@ void btif_a2dp_source_debug_dump(int fd) {
                 1000
           : 0);
 
+  dprintf(fd,
+          "  Pacing                                                  : %s\n",
+          btif_a2dp_source_cb.hal_pacing ? "audio HAL data" : "timer");
+
+  dprintf(fd,
+          "  Counts (HAL data ready/HAL deadline ticks)              : %zu / "
+          "%zu\n",
+          accumulated_stats->hal_pacing_data_ready_ticks,
+          accumulated_stats->hal_pacing_deadline_ticks);
+
   dprintf(fd,
           "  Counts (underflow)                                      : %zu\n",
           accumulated_stats->media_read_total_underflow_count);
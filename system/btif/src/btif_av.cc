@@ -45,6 +45,7 @@
 #include "btif/include/btif_profile_queue.h"
 #include "btif/include/btif_rc.h"
 #include "btif/include/btif_util.h"
+#include "btif/include/stack_manager.h"
 #include "btif_metrics_logging.h"
 #include "common/metrics.h"
 #include "common/state_machine.h"
@@ -757,6 +758,16 @@ static BtifAvPeer* btif_av_find_active_peer() {
  * Local helper functions
  *****************************************************************************/
 
+// In the A2DP multi-sink mode, the packets encoded once for the active Sink
+// peer are also sent to the other started Sink peers with the same codec
+// configuration, instead of suspending their stream.
+static bool btif_av_is_multi_sink_peer(const BtifAvPeer& peer) {
+  static const bool multi_sink_enabled = osi_property_get_bool(
+      "persist.bluetooth.a2dp_source.multi_sink.enabled", false);
+  return multi_sink_enabled && peer.IsSink() && !peer.IsActivePeer() &&
+         bta_av_co_peer_shares_active_codec(peer.PeerAddress());
+}
+
 const char* dump_av_sm_event_name(btif_av_sm_event_t event) {
   switch ((int)event) {
     CASE_RETURN_STR(BTA_AV_ENABLE_EVT)
@@ -1025,6 +1036,7 @@ bt_status_t BtifAvSource::Init(
   if (!btif_a2dp_source_init()) {
     return BT_STATUS_FAIL;
   }
+  stack_manager_init_profile(STACK_PROFILE_A2DP);
   btif_enable_service(BTA_A2DP_SOURCE_SERVICE_ID);
   enabled_ = true;
   return BT_STATUS_SUCCESS;
@@ -1230,6 +1242,7 @@ bt_status_t BtifAvSink::Init(btav_sink_callbacks_t* callbacks,
   if (!btif_a2dp_sink_init()) {
     return BT_STATUS_FAIL;
   }
+  stack_manager_init_profile(STACK_PROFILE_A2DP);
   btif_enable_service(BTA_A2DP_SINK_SERVICE_ID);
   enabled_ = true;
   return BT_STATUS_SUCCESS;
@@ -1970,7 +1983,12 @@ bool BtifAvStateMachine::StateOpened::ProcessEvent(uint32_t event,
       // If remote tries to start A2DP when DUT is A2DP Source, then Suspend.
       // If A2DP is Sink and call is active, then disconnect the AVDTP channel.
       bool should_suspend = false;
-      if (peer_.IsSink()) {
+      if (btif_av_is_multi_sink_peer(peer_)) {
+        // The encoder already runs for the active peer
+        LOG(INFO) << __PRETTY_FUNCTION__ << ": Peer " << peer_.PeerAddress()
+                  << " : keep streaming as multi-sink";
+        peer_.ClearFlags(BtifAvPeer::kFlagPendingStart);
+      } else if (peer_.IsSink()) {
         if (!peer_.CheckFlags(BtifAvPeer::kFlagPendingStart |
                               BtifAvPeer::kFlagRemoteSuspend)) {
           LOG(WARNING) << __PRETTY_FUNCTION__ << ": Peer "
@@ -21,30 +21,73 @@
 
 #include <aaudio/AAudio.h>
 #include <base/logging.h>
+#include <string.h>
 #include <utils/StrongPointer.h>
 
+#include <algorithm>
+#include <atomic>
+
 #include "bt_target.h"
 #include "osi/include/log.h"
+#include "osi/include/spsc_ringbuffer.h"
 
 using namespace android;
 
+// The decoded samples are transcoded straight into |ring|, which the AAudio
+// data callback drains. Writing never blocks the A2DP sink thread, which
+// holds the sink lock while it decodes.
 typedef struct {
   AAudioStream* stream;
   int bitsPerSample;
   int channelCount;
-  float* buffer;
-  size_t bufferLength;
+  spsc_ringbuffer_t* ring;
+  // Set by Pause, the callback drops the queued samples
+  std::atomic<bool> flush;
 } BtifAvrcpAudioTrack;
 
+// Number of decode bursts of samples |ring| holds on top of the AAudio buffer:
+// one being played while the next one is written
+constexpr size_t kRingBurstCount = 2;
+
 #if (DUMP_PCM_DATA == TRUE)
 FILE* outputPcmSampleFile;
 char outputFilename[50] = "/data/misc/bluedroid/output_sample.pcm";
 #endif
 
+static aaudio_data_callback_result_t AudioDataCallback(AAudioStream* stream,
+                                                       void* userData,
+                                                       void* audioData,
+                                                       int32_t numFrames) {
+  BtifAvrcpAudioTrack* trackHolder =
+      static_cast<BtifAvrcpAudioTrack*>(userData);
+  size_t length = numFrames * trackHolder->channelCount * sizeof(float);
+
+  if (trackHolder->flush.exchange(false)) {
+    size_t queued;
+    do {
+      spsc_ringbuffer_read_reserve(trackHolder->ring, &queued);
+      spsc_ringbuffer_read_commit(trackHolder->ring, queued);
+    } while (queued > 0);
+  }
+
+  // Play silence on underrun
+  size_t count = spsc_ringbuffer_pop(trackHolder->ring,
+                                     static_cast<uint8_t*>(audioData), length);
+  memset(static_cast<uint8_t*>(audioData) + count, 0, length - count);
+  return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
 void* BtifAvrcpAudioTrackCreate(int trackFreq, int bitsPerSample,
-                                int channelCount) {
-  LOG_VERBOSE("%s Track.cpp: btCreateTrack freq %d bps %d channel %d ",
-              __func__, trackFreq, bitsPerSample, channelCount);
+                                int channelCount, int burstMs) {
+  LOG_VERBOSE(
+      "%s Track.cpp: btCreateTrack freq %d bps %d channel %d burst %d ms",
+      __func__, trackFreq, bitsPerSample, channelCount, burstMs);
+
+  BtifAvrcpAudioTrack* trackHolder = new BtifAvrcpAudioTrack;
+  CHECK(trackHolder != NULL);
+  trackHolder->bitsPerSample = bitsPerSample;
+  trackHolder->channelCount = channelCount;
+  trackHolder->flush = false;
 
   AAudioStreamBuilder* builder;
   AAudioStream* stream;
@@ -55,18 +98,20 @@ void* BtifAvrcpAudioTrackCreate(int trackFreq, int bitsPerSample,
   AAudioStreamBuilder_setSessionId(builder, AAUDIO_SESSION_ID_ALLOCATE);
   AAudioStreamBuilder_setPerformanceMode(builder,
                                          AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+  AAudioStreamBuilder_setDataCallback(builder, AudioDataCallback, trackHolder);
   result = AAudioStreamBuilder_openStream(builder, &stream);
   CHECK(result == AAUDIO_OK);
   AAudioStreamBuilder_delete(builder);
 
-  BtifAvrcpAudioTrack* trackHolder = new BtifAvrcpAudioTrack;
-  CHECK(trackHolder != NULL);
   trackHolder->stream = stream;
-  trackHolder->bitsPerSample = bitsPerSample;
-  trackHolder->channelCount = channelCount;
-  trackHolder->bufferLength =
-      trackHolder->channelCount * AAudioStream_getBufferSizeInFrames(stream);
-  trackHolder->buffer = new float[trackHolder->bufferLength]();
+  // A late tick decodes its whole burst at once: |ring| must take it while the
+  // AAudio buffer still holds the previous one
+  size_t burstFrames = (size_t)trackFreq * burstMs / 1000;
+  size_t ringFrames = kRingBurstCount * burstFrames +
+                      AAudioStream_getBufferSizeInFrames(stream);
+  trackHolder->ring =
+      spsc_ringbuffer_init(ringFrames * channelCount * sizeof(float));
+  CHECK(trackHolder->ring != NULL);
 
 #if (DUMP_PCM_DATA == TRUE)
   outputPcmSampleFile = fopen(outputFilename, "ab");
@@ -107,7 +152,7 @@ void BtifAvrcpAudioTrackDelete(void* handle) {
   if (trackHolder != NULL && trackHolder->stream != NULL) {
     LOG_VERBOSE("%s Track.cpp: btStartTrack", __func__);
     AAudioStream_close(trackHolder->stream);
-    delete trackHolder->buffer;
+    spsc_ringbuffer_free(trackHolder->ring);
     delete trackHolder;
   }
 
@@ -129,6 +174,7 @@ void BtifAvrcpAudioTrackPause(void* handle) {
     LOG_VERBOSE("%s Track.cpp: btPauseTrack", __func__);
     AAudioStream_requestPause(trackHolder->stream);
     AAudioStream_requestFlush(trackHolder->stream);
+    trackHolder->flush = true;
   }
 }
 
@@ -148,79 +194,84 @@ static size_t sampleSizeFor(BtifAvrcpAudioTrack* trackHolder) {
   return trackHolder->bitsPerSample / 8;
 }
 
-static size_t transcodeQ15ToFloat(uint8_t* buffer, size_t length,
-                                  BtifAvrcpAudioTrack* trackHolder) {
-  size_t sampleSize = sampleSizeFor(trackHolder);
-  size_t i = 0;
-  for (; i <= length / sampleSize; i++) {
-    trackHolder->buffer[i] = ((int16_t*)buffer)[i] * kScaleQ15ToFloat;
+// The transcoders convert |count| samples of |buffer| into |out|
+
+static void transcodeQ15ToFloat(const uint8_t* buffer, size_t count,
+                                float* out) {
+  for (size_t i = 0; i < count; i++) {
+    out[i] = ((const int16_t*)buffer)[i] * kScaleQ15ToFloat;
   }
-  return i * sampleSize;
 }
 
-static size_t transcodeQ23ToFloat(uint8_t* buffer, size_t length,
-                                  BtifAvrcpAudioTrack* trackHolder) {
-  size_t sampleSize = sampleSizeFor(trackHolder);
-  size_t i = 0;
-  for (; i <= length / sampleSize; i++) {
-    size_t offset = i * sampleSize;
-    int32_t sample = *((int32_t*)(buffer + offset - 1)) & 0x00FFFFFF;
-    trackHolder->buffer[i] = sample * kScaleQ23ToFloat;
+static void transcodeQ23ToFloat(const uint8_t* buffer, size_t count,
+                                float* out) {
+  for (size_t i = 0; i < count; i++) {
+    // Little endian 24 bit samples: the 3 bytes are assembled in the high
+    // bytes, then shifted down to extend the sign
+    const uint8_t* p = buffer + i * 3;
+    int32_t sample = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 |
+                               (uint32_t)p[2] << 24) >>
+                     8;
+    out[i] = sample * kScaleQ23ToFloat;
   }
-  return i * sampleSize;
 }
 
-static size_t transcodeQ31ToFloat(uint8_t* buffer, size_t length,
-                                  BtifAvrcpAudioTrack* trackHolder) {
-  size_t sampleSize = sampleSizeFor(trackHolder);
-  size_t i = 0;
-  for (; i <= length / sampleSize; i++) {
-    trackHolder->buffer[i] = ((int32_t*)buffer)[i] * kScaleQ31ToFloat;
+static void transcodeQ31ToFloat(const uint8_t* buffer, size_t count,
+                                float* out) {
+  for (size_t i = 0; i < count; i++) {
+    out[i] = ((const int32_t*)buffer)[i] * kScaleQ31ToFloat;
   }
-  return i * sampleSize;
 }
 
-static size_t transcodeToPcmFloat(uint8_t* buffer, size_t length,
-                                  BtifAvrcpAudioTrack* trackHolder) {
+static void transcodeToPcmFloat(const uint8_t* buffer, size_t count,
+                                float* out, BtifAvrcpAudioTrack* trackHolder) {
   switch (trackHolder->bitsPerSample) {
     case 16:
-      return transcodeQ15ToFloat(buffer, length, trackHolder);
+      transcodeQ15ToFloat(buffer, count, out);
+      break;
     case 24:
-      return transcodeQ23ToFloat(buffer, length, trackHolder);
+      transcodeQ23ToFloat(buffer, count, out);
+      break;
     case 32:
-      return transcodeQ31ToFloat(buffer, length, trackHolder);
+      transcodeQ31ToFloat(buffer, count, out);
+      break;
   }
-  return -1;
 }
 
-constexpr int64_t kTimeoutNanos = 100 * 1000 * 1000;  // 100 ms
-
 int BtifAvrcpAudioTrackWriteData(void* handle, void* audioBuffer,
                                  int bufferLength) {
   BtifAvrcpAudioTrack* trackHolder = static_cast<BtifAvrcpAudioTrack*>(handle);
   CHECK(trackHolder != NULL);
   CHECK(trackHolder->stream != NULL);
-  aaudio_result_t retval = -1;
 #if (DUMP_PCM_DATA == TRUE)
   if (outputPcmSampleFile) {
     fwrite((audioBuffer), 1, (size_t)bufferLength, outputPcmSampleFile);
   }
 #endif
 
+  // Only whole frames are queued, so that the callback never splits one
   size_t sampleSize = sampleSizeFor(trackHolder);
-  int transcodedCount = 0;
-  do {
-    transcodedCount +=
-        transcodeToPcmFloat(((uint8_t*)audioBuffer) + transcodedCount,
-                            bufferLength - transcodedCount, trackHolder);
-
-    retval = AAudioStream_write(
-        trackHolder->stream, trackHolder->buffer,
-        transcodedCount / (sampleSize * trackHolder->channelCount),
-        kTimeoutNanos);
-    LOG_VERBOSE("%s Track.cpp: btWriteData len = %d ret = %d", __func__,
-                bufferLength, retval);
-  } while (transcodedCount < bufferLength);
-
-  return transcodedCount;
+  size_t frameSize = trackHolder->channelCount;
+  size_t samples = bufferLength / sampleSize;
+  size_t transcoded = 0;
+  while (transcoded < samples) {
+    size_t reserved;
+    float* out = reinterpret_cast<float*>(
+        spsc_ringbuffer_write_reserve(trackHolder->ring, &reserved));
+    size_t count = std::min(reserved / sizeof(float), samples - transcoded);
+    count -= count % frameSize;
+    if (count == 0) break;
+    transcodeToPcmFloat((const uint8_t*)audioBuffer + transcoded * sampleSize,
+                        count, out, trackHolder);
+    spsc_ringbuffer_write_commit(trackHolder->ring, count * sizeof(float));
+    transcoded += count;
+  }
+
+  if (transcoded < samples) {
+    LOG_WARN("%s: audio track overrun, dropped %zu samples", __func__,
+             samples - transcoded);
+  }
+  LOG_VERBOSE("%s Track.cpp: btWriteData len = %d queued = %zu", __func__,
+              bufferLength, transcoded * sampleSize);
+  return transcoded * sampleSize;
 }
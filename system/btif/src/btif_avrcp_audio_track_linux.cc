@@ -17,7 +17,7 @@
 #include "btif_avrcp_audio_track.h"
 
 void* BtifAvrcpAudioTrackCreate(int trackFreq, int bits_per_sample,
-                                int channelType) {
+                                int channelType, int burstMs) {
   return nullptr;
 }
 
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <base/bind.h>
 #include <base/logging.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -23,11 +24,18 @@
 #include <stdio.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include "btif_bqr.h"
 #include "btif_common.h"
 #include "btm_api.h"
 #include "btm_ble_api.h"
 #include "common/leaky_bonded_queue.h"
+#include "common/message_loop_thread.h"
 #include "common/time_util.h"
 #include "osi/include/properties.h"
 
@@ -43,6 +51,75 @@ static std::unique_ptr<LeakyBondedQueue<BqrVseSubEvt>> kpBqrEventQueue(
 
 static uint16_t vendor_cap_supported_version;
 
+// Parses, logs and records the BQR events, and writes the trace log files
+static bluetooth::common::MessageLoopThread bqr_thread("bt_bqr_thread");
+
+// Link statistics by connection handle, written on the BQR thread and read by
+// DebugDump
+static std::mutex link_stats_mutex;
+static std::map<uint16_t, BqrLinkStats> link_stats;
+static uint32_t monitor_mode_log_interval_ms = kDefaultMonitorModeLogIntervalMs;
+
+static void DoInBqrThread(base::OnceClosure task) {
+  if (!bqr_thread.IsRunning()) {
+    std::move(task).Run();
+    return;
+  }
+  bqr_thread.DoInThread(FROM_HERE, std::move(task));
+}
+
+// Handle a copy of the event on the BQR thread, the event buffer is only valid
+// during the call
+static void DoInBqrThread(void (*handler)(uint8_t, const uint8_t*),
+                          uint8_t length, const uint8_t* p_event) {
+  DoInBqrThread(base::BindOnce(
+      [](void (*handler)(uint8_t, const uint8_t*),
+         std::vector<uint8_t> event) { handler(event.size(), event.data()); },
+      handler, std::vector<uint8_t>(p_event, p_event + length)));
+}
+
+// Update the statistics of the link with |event|, return true if the event is
+// to be logged and forwarded
+static bool UpdateLinkStats(const BqrLinkQualityEvent& event) {
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  std::lock_guard<std::mutex> lock(link_stats_mutex);
+  BqrLinkStats& stats = link_stats[event.connection_handle];
+  if (stats.report_count == 0) {
+    stats.average_rssi = event.rssi;
+    stats.average_snr = event.snr;
+    stats.min_rssi = event.rssi;
+    stats.max_rssi = event.rssi;
+  } else {
+    stats.average_rssi +=
+        (event.rssi - stats.average_rssi) / kLinkStatsAverageWeight;
+    stats.average_snr +=
+        (event.snr - stats.average_snr) / kLinkStatsAverageWeight;
+    stats.min_rssi = std::min(stats.min_rssi, event.rssi);
+    stats.max_rssi = std::max(stats.max_rssi, event.rssi);
+  }
+  stats.report_count++;
+  stats.rssi = event.rssi;
+  stats.snr = event.snr;
+  stats.retransmission_count += event.retransmission_count;
+  stats.no_rx_count += event.no_rx_count;
+  stats.nak_count += event.nak_count;
+  stats.flow_off_count += event.flow_off_count;
+  stats.last_report_ms = now_ms;
+
+  // Only the periodic reports are rate limited, the reports of a problem are
+  // always forwarded
+  if (event.quality_report_id != QUALITY_REPORT_ID_MONITOR_MODE) {
+    return true;
+  }
+  if (stats.last_logged_ms != 0 &&
+      now_ms - stats.last_logged_ms < monitor_mode_log_interval_ms) {
+    stats.suppressed_count++;
+    return false;
+  }
+  stats.last_logged_ms = now_ms;
+  return true;
+}
+
 void BqrVseSubEvt::ParseBqrLinkQualityEvt(uint8_t length,
                                           const uint8_t* p_param_buf) {
   if (length < kLinkQualityParamTotalLen) {
@@ -290,6 +367,24 @@ void EnableBtQualityReport(bool is_enable) {
   BqrConfiguration bqr_config = {};
 
   if (is_enable) {
+    if (!bqr_thread.IsRunning()) {
+      bqr_thread.StartUp();
+    }
+    char bqr_prop_log_interval_ms[PROPERTY_VALUE_MAX] = {0};
+    osi_property_get(kpPropertyMonitorModeLogIntervalMs,
+                     bqr_prop_log_interval_ms, "");
+    uint32_t log_interval_ms =
+        strlen(bqr_prop_log_interval_ms) == 0
+            ? kDefaultMonitorModeLogIntervalMs
+            : static_cast<uint32_t>(atoi(bqr_prop_log_interval_ms));
+    DoInBqrThread(base::BindOnce(
+        [](uint32_t log_interval_ms) {
+          monitor_mode_log_interval_ms = log_interval_ms;
+          std::lock_guard<std::mutex> lock(link_stats_mutex);
+          link_stats.clear();
+        },
+        log_interval_ms));
+
     bqr_config.report_action = REPORT_ACTION_ADD;
     bqr_config.quality_event_mask =
         static_cast<uint32_t>(atoi(bqr_prop_evtmask));
@@ -371,18 +466,7 @@ void BqrVscCompleteCallback(tBTM_VSC_CMPL* p_vsc_cmpl_params) {
   ConfigureBqrCmpl(current_quality_event_mask);
 }
 
-void ConfigureBqrCmpl(uint32_t current_evt_mask) {
-  LOG(INFO) << __func__ << ": current_evt_mask: " << loghex(current_evt_mask);
-  // (Un)Register for VSE of Bluetooth Quality Report sub event
-  tBTM_STATUS btm_status = BTM_BT_Quality_Report_VSE_Register(
-      current_evt_mask > kQualityEventMaskAllOff, CategorizeBqrEvent);
-
-  if (btm_status != BTM_SUCCESS) {
-    LOG(ERROR) << __func__ << ": Fail to (un)register VSE of BQR sub event."
-               << " status: " << btm_status;
-    return;
-  }
-
+static void CloseTraceLogFiles(uint32_t current_evt_mask) {
   if (LmpLlMessageTraceLogFd != INVALID_FD &&
       (current_evt_mask & kQualityEventMaskLmpMessageTrace) == 0) {
     LOG(INFO) << __func__ << ": Closing LMP/LL log file.";
@@ -397,6 +481,22 @@ void ConfigureBqrCmpl(uint32_t current_evt_mask) {
   }
 }
 
+void ConfigureBqrCmpl(uint32_t current_evt_mask) {
+  LOG(INFO) << __func__ << ": current_evt_mask: " << loghex(current_evt_mask);
+  // (Un)Register for VSE of Bluetooth Quality Report sub event
+  tBTM_STATUS btm_status = BTM_BT_Quality_Report_VSE_Register(
+      current_evt_mask > kQualityEventMaskAllOff, CategorizeBqrEvent);
+
+  if (btm_status != BTM_SUCCESS) {
+    LOG(ERROR) << __func__ << ": Fail to (un)register VSE of BQR sub event."
+               << " status: " << btm_status;
+    return;
+  }
+
+  // The log files are written on the BQR thread
+  DoInBqrThread(base::BindOnce(&CloseTraceLogFiles, current_evt_mask));
+}
+
 void CategorizeBqrEvent(uint8_t length, const uint8_t* p_bqr_event) {
   if (length == 0) {
     LOG(WARNING) << __func__ << ": Lengths of all of the parameters are zero.";
@@ -418,7 +518,7 @@ void CategorizeBqrEvent(uint8_t length, const uint8_t* p_bqr_event) {
         return;
       }
 
-      AddLinkQualityEventToQueue(length, p_bqr_event);
+      DoInBqrThread(AddLinkQualityEventToQueue, length, p_bqr_event);
       break;
 
     // The Root Inflammation and Log Dump related event should be handled and
@@ -441,6 +541,9 @@ void AddLinkQualityEventToQueue(uint8_t length,
                                 const uint8_t* p_link_quality_event) {
   std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
   p_bqr_event->ParseBqrLinkQualityEvt(length, p_link_quality_event);
+  if (!UpdateLinkStats(p_bqr_event->bqr_link_quality_event_)) {
+    return;
+  }
 
   LOG(WARNING) << *p_bqr_event;
   invoke_link_quality_report_cb(
@@ -484,7 +587,8 @@ void AddLinkQualityEventToQueue(uint8_t length,
   kpBqrEventQueue->Enqueue(p_bqr_event.release());
 }
 
-void DumpLmpLlMessage(uint8_t length, const uint8_t* p_lmp_ll_message_event) {
+static void WriteLmpLlMessage(uint8_t length,
+                              const uint8_t* p_lmp_ll_message_event) {
   std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
 
   if (LmpLlMessageTraceLogFd == INVALID_FD ||
@@ -497,6 +601,10 @@ void DumpLmpLlMessage(uint8_t length, const uint8_t* p_lmp_ll_message_event) {
   }
 }
 
+void DumpLmpLlMessage(uint8_t length, const uint8_t* p_lmp_ll_message_event) {
+  DoInBqrThread(WriteLmpLlMessage, length, p_lmp_ll_message_event);
+}
+
 int OpenLmpLlTraceLogFile() {
   if (rename(kpLmpLlMessageTraceLogPath, kpLmpLlMessageTraceLastLogPath) != 0 &&
       errno != ENOENT) {
@@ -519,7 +627,8 @@ int OpenLmpLlTraceLogFile() {
   return logfile_fd;
 }
 
-void DumpBtScheduling(uint8_t length, const uint8_t* p_bt_scheduling_event) {
+static void WriteBtScheduling(uint8_t length,
+                              const uint8_t* p_bt_scheduling_event) {
   std::unique_ptr<BqrVseSubEvt> p_bqr_event = std::make_unique<BqrVseSubEvt>();
 
   if (BtSchedulingTraceLogFd == INVALID_FD ||
@@ -532,6 +641,10 @@ void DumpBtScheduling(uint8_t length, const uint8_t* p_bt_scheduling_event) {
   }
 }
 
+void DumpBtScheduling(uint8_t length, const uint8_t* p_bt_scheduling_event) {
+  DoInBqrThread(WriteBtScheduling, length, p_bt_scheduling_event);
+}
+
 int OpenBtSchedulingTraceLogFile() {
   if (rename(kpBtSchedulingTraceLogPath, kpBtSchedulingTraceLastLogPath) != 0 &&
       errno != ENOENT) {
@@ -554,7 +667,30 @@ int OpenBtSchedulingTraceLogFile() {
   return logfile_fd;
 }
 
+static void DumpLinkStats(int fd) {
+  std::lock_guard<std::mutex> lock(link_stats_mutex);
+  if (link_stats.empty()) {
+    return;
+  }
+  dprintf(fd, "\nBT Quality Report Link Statistics: \n");
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  for (const auto& [handle, stats] : link_stats) {
+    dprintf(fd,
+            "  Handle: 0x%04x, Reports: %u (%u suppressed), Last: %" PRIu64
+            " ms ago, RSSI: %d (avg %.1f, min %d, max %d), SNR: %u "
+            "(avg %.1f), ReTx: %" PRIu64 ", NoRX: %" PRIu64 ", NAK: %" PRIu64
+            ", FlowOff: %" PRIu64 "\n",
+            handle, stats.report_count, stats.suppressed_count,
+            now_ms - stats.last_report_ms, stats.rssi, stats.average_rssi,
+            stats.min_rssi, stats.max_rssi, stats.snr, stats.average_snr,
+            stats.retransmission_count, stats.no_rx_count, stats.nak_count,
+            stats.flow_off_count);
+  }
+}
+
 void DebugDump(int fd) {
+  DumpLinkStats(fd);
+
   dprintf(fd, "\nBT Quality Report Events: \n");
 
   if (kpBqrEventQueue->Empty()) {
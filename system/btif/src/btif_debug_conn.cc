@@ -19,33 +19,30 @@
 #include "btif/include/btif_debug_conn.h"
 
 #include <stdio.h>
-#include <string.h>
 #include <time.h>
 
-#include "common/time_util.h"
+#include "gd/common/event_log.h"
 #include "types/raw_address.h"
 
 #define NUM_CONNECTION_EVENTS 16
 #define TEMP_BUFFER_SIZE 30
 
 typedef struct conn_event_t {
-  uint64_t ts;
   btif_debug_conn_state_t state;
   RawAddress bda;
   tGATT_DISCONN_REASON disconnect_reason;
 } conn_event_t;
 
-static conn_event_t connection_events[NUM_CONNECTION_EVENTS];
-static uint8_t current_event = 0;
+static bluetooth::common::EventLog<conn_event_t, NUM_CONNECTION_EVENTS>
+    connection_events;
 
-static char* format_ts(const uint64_t ts, char* buffer, int len) {
-  const uint64_t ms = ts / 1000;
-  const time_t secs = ms / 1000;
+static char* format_ts(const long long ts_ms, char* buffer, int len) {
+  const time_t secs = ts_ms / 1000;
   struct tm* ptm = localtime(&secs);
 
   char tempbuff[20];
   strftime(tempbuff, sizeof(tempbuff), "%m-%d %H:%M:%S", ptm);
-  snprintf(buffer, len, "%s.%03u", tempbuff, (uint16_t)(ms % 1000));
+  snprintf(buffer, len, "%s.%03u", tempbuff, (uint16_t)(ts_ms % 1000));
 
   return buffer;
 }
@@ -60,47 +57,31 @@ static const char* format_state(const btif_debug_conn_state_t state) {
   return "UNKNOWN";
 }
 
-static void next_event() {
-  ++current_event;
-  if (current_event == NUM_CONNECTION_EVENTS) current_event = 0;
-}
-
 void btif_debug_conn_state(const RawAddress& bda,
                            const btif_debug_conn_state_t state,
                            const tGATT_DISCONN_REASON disconnect_reason) {
-  next_event();
-
-  conn_event_t* evt = &connection_events[current_event];
-  evt->ts = bluetooth::common::time_gettimeofday_us();
-  evt->state = state;
-  evt->disconnect_reason = disconnect_reason;
-  evt->bda = bda;
+  conn_event_t evt;
+  evt.state = state;
+  evt.disconnect_reason = disconnect_reason;
+  evt.bda = bda;
+  connection_events.Record(evt);
 }
 
 void btif_debug_conn_dump(int fd) {
-  const uint8_t current_event_local =
-      current_event;  // Cache to avoid threading issues
-  uint8_t dump_event = current_event_local;
+  auto events = connection_events.Pull();
   char ts_buffer[TEMP_BUFFER_SIZE] = {0};
 
   dprintf(fd, "\nConnection Events:\n");
-  if (connection_events[dump_event].ts == 0) dprintf(fd, "  None\n");
+  if (events.empty()) dprintf(fd, "  None\n");
 
-  while (connection_events[dump_event].ts) {
-    conn_event_t* evt = &connection_events[dump_event];
-    dprintf(fd, "  %s %s %s", format_ts(evt->ts, ts_buffer, sizeof(ts_buffer)),
+  // Most recent event first
+  for (auto it = events.rbegin(); it != events.rend(); ++it) {
+    const conn_event_t* evt = &it->record;
+    dprintf(fd, "  %s %s %s",
+            format_ts(it->timestamp, ts_buffer, sizeof(ts_buffer)),
             format_state(evt->state), evt->bda.ToString().c_str());
     if (evt->state == BTIF_DEBUG_DISCONNECTED)
       dprintf(fd, " reason=%d", evt->disconnect_reason);
     dprintf(fd, "\n");
-
-    // Go to previous event; wrap if needed
-    if (dump_event > 0)
-      --dump_event;
-    else
-      dump_event = NUM_CONNECTION_EVENTS - 1;
-
-    // Check if we dumped all events
-    if (dump_event == current_event_local) break;
   }
 }
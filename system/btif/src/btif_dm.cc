@@ -80,6 +80,7 @@
 #include "device/include/controller.h"
 #include "device/include/interop.h"
 #include "gd/common/lru_cache.h"
+#include "gd/os/system_properties.h"
 #include "internal_include/stack_config.h"
 #include "main/shim/dumpsys.h"
 #include "main/shim/shim.h"
@@ -111,6 +112,10 @@ const Uuid UUID_BATTERY = Uuid::FromString("180F");
 const Uuid UUID_A2DP_SINK = Uuid::FromString("110B");
 const bool enable_address_consolidate = true;  // TODO remove
 
+// Checked for every inquiry result
+constexpr bluetooth::os::SystemPropertyKey<bool> kRestrictDiscoveredDevice{
+    "bluetooth.restrict_discovered_device.enabled", false};
+
 #define COD_UNCLASSIFIED ((0x1F) << 8)
 #define COD_HID_KEYBOARD 0x0540
 #define COD_HID_POINTING 0x0580
@@ -1382,8 +1387,8 @@ static void btif_dm_search_devices_evt(tBTA_DM_SEARCH_EVT event,
         ASSERTC(status == BT_STATUS_SUCCESS,
                 "failed to save remote addr type (inquiry)", status);
 
-        bool restrict_report = osi_property_get_bool(
-            "bluetooth.restrict_discovered_device.enabled", false);
+        bool restrict_report =
+            bluetooth::os::GetCachedSystemProperty<kRestrictDiscoveredDevice>();
         if (restrict_report &&
             p_search_data->inq_res.device_type == BT_DEVICE_TYPE_BLE &&
             !(p_search_data->inq_res.ble_evt_type & BTM_BLE_CONNECTABLE_MASK)) {
@@ -1787,15 +1792,15 @@ void BTIF_dm_enable() {
   /* clear control blocks */
   pairing_cb = {};
   pairing_cb.bond_type = tBTM_SEC_DEV_REC::BOND_TYPE_PERSISTENT;
-  if (enable_address_consolidate) {
-    LOG_INFO("enable address consolidate");
-    btif_storage_load_le_devices();
-  }
-
   /* This function will also trigger the adapter_properties_cb
   ** and bonded_devices_info_cb
   */
-  btif_storage_load_bonded_devices();
+  if (enable_address_consolidate) {
+    LOG_INFO("enable address consolidate");
+    btif_storage_load_bonded_and_le_devices();
+  } else {
+    btif_storage_load_bonded_devices();
+  }
   bluetooth::bqr::EnableBtQualityReport(true);
   btif_enable_bluetooth_evt();
 }
@@ -37,6 +37,7 @@
 #include "btif/include/btif_common.h"
 #include "btif/include/btif_storage.h"
 #include "btif/include/btif_util.h"
+#include "btif/include/stack_manager.h"
 #include "include/hardware/bt_hh.h"
 #include "main/shim/dumpsys.h"
 #include "osi/include/allocator.h"
@@ -1304,6 +1305,7 @@ static bt_status_t init(bthh_callbacks_t* callbacks) {
   for (i = 0; i < BTIF_HH_MAX_HID; i++) {
     btif_hh_cb.devices[i].dev_status = BTHH_CONN_STATE_UNKNOWN;
   }
+  stack_manager_init_profile(STACK_PROFILE_HID_HOST);
   /* Invoke the enable service API to the core to set the appropriate service_id
    */
   btif_enable_service(BTA_HID_SERVICE_ID);
@@ -1798,3 +1800,30 @@ const bthh_interface_t* btif_hh_get_interface() {
   BTIF_TRACE_EVENT("%s", __func__);
   return &bthhInterface;
 }
+
+/*******************************************************************************
+ *
+ * Function         btif_debug_hh_dump
+ *
+ * Description      Dump the input report statistics of the connected devices
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btif_debug_hh_dump(int fd) {
+  dprintf(fd, "\nHID Host input reports:\n");
+  for (uint32_t i = 0; i < BTIF_HH_MAX_HID; i++) {
+    const btif_hh_device_t* p_dev = &btif_hh_cb.devices[i];
+    if (p_dev->dev_status != BTHH_CONN_STATE_CONNECTED) continue;
+    const btif_hh_input_stats_t& stats = p_dev->input_stats;
+    dprintf(fd,
+            "  %s handle:%d le:%d reports:%u dropped:%u "
+            "avg_latency_us:%llu max_latency_us:%llu\n",
+            PRIVATE_ADDRESS(p_dev->bd_addr), p_dev->dev_handle, p_dev->le_hid,
+            stats.count, stats.dropped,
+            (unsigned long long)(stats.count
+                                     ? stats.total_latency_us / stats.count
+                                     : 0),
+            (unsigned long long)stats.max_latency_us);
+  }
+}
@@ -99,8 +99,11 @@ class BluetoothKeystoreInterfaceImpl
     std::map<std::string, std::string>::iterator iter = key_map.find(prefix);
     if (iter == key_map.end()) {
       decryptedString = callbacks->get_key(prefix);
-      // Save the value into a map.
-      key_map[prefix] = decryptedString;
+      // Save the value into a map, unless the keystore does not have it yet so
+      // that the next use of the key asks again.
+      if (!decryptedString.empty()) {
+        key_map[prefix] = decryptedString;
+      }
       VLOG(2) << __func__ << ": get key from bluetoothkeystore.";
     } else {
       decryptedString = iter->second;
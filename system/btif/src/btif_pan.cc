@@ -37,8 +37,8 @@
 #ifdef OS_ANDROID
 #include <pan.sysprop.h>
 #endif
-#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "bt_target.h"  // Must be first to define build configuration
@@ -46,6 +46,7 @@
 #include "btif/include/btif_common.h"
 #include "btif/include/btif_pan_internal.h"
 #include "btif/include/btif_sock_thread.h"
+#include "btif/include/stack_manager.h"
 #include "device/include/controller.h"
 #include "include/hardware/bt_pan.h"
 #include "osi/include/allocator.h"
@@ -122,6 +123,7 @@ void btif_pan_init() {
 
   if (jni_initialized && !btpan_cb.enabled) {
     BTIF_TRACE_DEBUG("Enabling PAN....");
+    stack_manager_init_profile(STACK_PROFILE_PAN);
     memset(&btpan_cb, 0, sizeof(btpan_cb));
     btpan_cb.tap_fd = INVALID_FD;
     btpan_cb.flow = 1;
@@ -405,17 +407,20 @@ int btpan_tap_send(int tap_fd, const RawAddress& src, const RawAddress& dst,
     eth_hdr.h_dest = dst;
     eth_hdr.h_src = src;
     eth_hdr.h_proto = htons(proto);
-    char packet[TAP_MAX_PKT_WRITE_LEN + sizeof(tETH_HDR)];
-    memcpy(packet, &eth_hdr, sizeof(tETH_HDR));
     if (len > TAP_MAX_PKT_WRITE_LEN) {
       LOG_ERROR("btpan_tap_send eth packet size:%d is exceeded limit!", len);
       return -1;
     }
-    memcpy(packet + sizeof(tETH_HDR), buf, len);
 
-    /* Send data to network interface */
+    /* Send data to network interface, gathering the header and the payload
+     * into one frame */
+    struct iovec iov[2];
+    iov[0].iov_base = &eth_hdr;
+    iov[0].iov_len = sizeof(tETH_HDR);
+    iov[1].iov_base = (void*)buf;
+    iov[1].iov_len = len;
     ssize_t ret;
-    OSI_NO_INTR(ret = write(tap_fd, packet, len + sizeof(tETH_HDR)));
+    OSI_NO_INTR(ret = writev(tap_fd, iov, 2));
     BTIF_TRACE_DEBUG("ret:%d", ret);
     return (int)ret;
   }
@@ -651,54 +656,43 @@ static void bta_pan_callback(tBTA_PAN_EVT event, tBTA_PAN* p_data) {
                         sizeof(tBTA_PAN), NULL);
 }
 
-#define IS_EXCEPTION(e) ((e) & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL))
 static void btu_exec_tap_fd_read(int fd) {
-  struct pollfd ufd;
-
   if (fd == INVALID_FD || fd != btpan_cb.tap_fd) return;
 
+  // The frames are read straight into the buffers given to BNEP, after the
+  // headroom of the BNEP and L2CAP headers, so that the headers are added in
+  // place. The TAP fd is non blocking: the loop ends on the first read that
+  // would block, with no poll in between the frames.
+  //
   // Don't occupy BTU context too long, avoid buffer overruns and
   // give other profiles a chance to run by limiting the amount of memory
   // PAN can use.
+  BT_HDR* buffer = NULL;
   for (int i = 0; i < PAN_BUF_MAX && btif_is_enabled() && btpan_cb.flow; i++) {
-    BT_HDR* buffer = (BT_HDR*)osi_malloc(PAN_BUF_SIZE);
+    // A buffer whose frame was dropped is used again for the next frame
+    if (buffer == NULL) buffer = (BT_HDR*)osi_malloc(PAN_BUF_SIZE);
     buffer->offset = PAN_MINIMUM_OFFSET;
-    buffer->len = PAN_BUF_SIZE - sizeof(BT_HDR) - buffer->offset;
 
     uint8_t* packet = (uint8_t*)buffer + sizeof(BT_HDR) + buffer->offset;
 
-    // If we don't have an undelivered packet left over, pull one from the TAP
-    // driver.
-    // We save it in the congest_packet right away in case we can't deliver it
-    // in this
-    // attempt.
-    if (!btpan_cb.congest_packet_size) {
-      ssize_t ret;
-      OSI_NO_INTR(ret = read(fd, btpan_cb.congest_packet,
-                             sizeof(btpan_cb.congest_packet)));
-      switch (ret) {
-        case -1:
-          BTIF_TRACE_ERROR("%s unable to read from driver: %s", __func__,
-                           strerror(errno));
-          osi_free(buffer);
-          // add fd back to monitor thread to try it again later
-          btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
-          return;
-        case 0:
-          BTIF_TRACE_WARNING("%s end of file reached.", __func__);
-          osi_free(buffer);
-          // add fd back to monitor thread to process the exception
-          btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
-          return;
-        default:
-          btpan_cb.congest_packet_size = ret;
-          break;
+    ssize_t ret;
+    OSI_NO_INTR(ret = read(fd, packet,
+                           PAN_BUF_SIZE - sizeof(BT_HDR) - buffer->offset));
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    if (ret <= 0) {
+      if (ret < 0) {
+        BTIF_TRACE_ERROR("%s unable to read from driver: %s", __func__,
+                         strerror(errno));
+      } else {
+        BTIF_TRACE_WARNING("%s end of file reached.", __func__);
       }
+      osi_free(buffer);
+      // add fd back to monitor thread to try again later, or to process the
+      // exception
+      btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
+      return;
     }
-
-    memcpy(packet, btpan_cb.congest_packet,
-           MIN(btpan_cb.congest_packet_size, buffer->len));
-    buffer->len = MIN(btpan_cb.congest_packet_size, buffer->len);
+    buffer->len = ret;
 
     if (buffer->len > sizeof(tETH_HDR) && should_forward((tETH_HDR*)packet)) {
       // Extract the ethernet header from the buffer since the PAN_WriteBuf
@@ -711,24 +705,16 @@ static void btu_exec_tap_fd_read(int fd) {
       // Skip the ethernet header.
       buffer->len -= sizeof(tETH_HDR);
       buffer->offset += sizeof(tETH_HDR);
-      if (forward_bnep(&hdr, buffer) != FORWARD_CONGEST)
-        btpan_cb.congest_packet_size = 0;
+      // The buffer is consumed, even when the BNEP queue is full: the flow
+      // is turned off before that happens.
+      forward_bnep(&hdr, buffer);
+      buffer = NULL;
     } else {
       BTIF_TRACE_WARNING("%s dropping packet of length %d", __func__,
                          buffer->len);
-      btpan_cb.congest_packet_size = 0;
-      osi_free(buffer);
     }
-
-    // Bail out of the loop if reading from the TAP fd would block.
-    ufd.fd = fd;
-    ufd.events = POLLIN;
-    ufd.revents = 0;
-
-    int ret;
-    OSI_NO_INTR(ret = poll(&ufd, 1, 0));
-    if (ret <= 0 || IS_EXCEPTION(ufd.revents)) break;
   }
+  osi_free(buffer);
 
   if (btpan_cb.flow) {
     // add fd back to monitor thread when the flow is on
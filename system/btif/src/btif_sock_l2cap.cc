@@ -620,6 +620,15 @@ static void on_l2cap_write_done(uint16_t len, uint32_t id) {
   uid_set_add_tx(uid_set, app_uid, len);
 }
 
+/* Send data to the app without blocking. Returns the number of bytes sent,
+ * 0 if the socket is full or on error, which the socket thread handles. */
+static uint32_t send_data_to_app_l(l2cap_socket* sock, const uint8_t* data,
+                                   uint32_t len) {
+  ssize_t sent;
+  OSI_NO_INTR(sent = send(sock->our_fd, data, len, MSG_DONTWAIT));
+  return sent > 0 ? (uint32_t)sent : 0;
+}
+
 static void on_l2cap_data_ind(tBTA_JV* evt, uint32_t id) {
   l2cap_socket* sock;
 
@@ -641,7 +650,15 @@ static void on_l2cap_data_ind(tBTA_JV* evt, uint32_t id) {
     std::vector<uint8_t> buffer(count);
     if (BTA_JvL2capRead(sock->handle, sock->id, buffer.data(), count) ==
         BTA_JV_SUCCESS) {
-      if (packet_put_tail_l(sock, buffer.data(), count)) {
+      /* As for RFCOMM, hand the data straight to the app when nothing is
+       * queued before it, instead of queueing it for the socket thread. */
+      uint32_t sent = 0;
+      if (!sock->first_packet) {
+        sent = send_data_to_app_l(sock, buffer.data(), count);
+      }
+      if (sent == count) {
+        bytes_read = count;
+      } else if (packet_put_tail_l(sock, buffer.data() + sent, count - sent)) {
         bytes_read = count;
         btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_WR,
                              sock->id);
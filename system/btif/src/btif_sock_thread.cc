@@ -33,22 +33,25 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <features.h>
-#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "bta_api.h"
 #include "btif_common.h"
@@ -65,11 +68,11 @@
   } while (0)
 
 #define MAX_THREAD 8
-#define MAX_POLL 64
-#define POLL_EXCEPTION_EVENTS (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)
-#define IS_EXCEPTION(e) ((e)&POLL_EXCEPTION_EVENTS)
-#define IS_READ(e) ((e)&POLLIN)
-#define IS_WRITE(e) ((e)&POLLOUT)
+#define MAX_EVENTS 64
+#define EPOLL_EXCEPTION_EVENTS (EPOLLHUP | EPOLLRDHUP | EPOLLERR)
+#define IS_EXCEPTION(e) ((e)&EPOLL_EXCEPTION_EVENTS)
+#define IS_READ(e) ((e)&EPOLLIN)
+#define IS_WRITE(e) ((e)&EPOLLOUT)
 /*cmd executes in socket poll thread */
 #define CMD_WAKEUP 1
 #define CMD_EXIT 2
@@ -78,16 +81,21 @@
 #define CMD_USER_PRIVATE 5
 
 struct poll_slot_t {
-  struct pollfd pfd;
+  int fd;
   uint32_t user_id;
   int type;
   int flags;
 };
 struct thread_slot_t {
   int cmd_fdr, cmd_fdw;
-  int poll_count;
-  poll_slot_t ps[MAX_POLL];
-  int psi[MAX_POLL];  // index of poll slot
+  int epoll_fd;
+  // Monitored fds, by fd. The epoll set keeps them across the wakeups, so
+  // nothing is rebuilt when an fd is added or removed.
+  std::unordered_map<int, poll_slot_t> ps;
+  // Monitored fds found closed. Closed fds are silently dropped from the epoll
+  // set, they are signaled as an exception on the next wakeup instead, as
+  // POLLNVAL did.
+  std::vector<int> invalid_fds;
   std::optional<pthread_t> thread_id;
   btsock_signaled_cb callback;
   btsock_cmd_cb cmd_callback;
@@ -145,6 +153,12 @@ static int alloc_thread_slot() {
 static void free_thread_slot(int h) {
   if (0 <= h && h < MAX_THREAD) {
     close_cmd_fd(h);
+    if (ts[h].epoll_fd != -1) {
+      close(ts[h].epoll_fd);
+      ts[h].epoll_fd = -1;
+    }
+    ts[h].ps.clear();
+    ts[h].invalid_fds.clear();
     ts[h].used = 0;
   } else
     APPL_TRACE_ERROR("invalid thread handle:%d", h);
@@ -156,9 +170,9 @@ void btsock_thread_init() {
     int h;
     for (h = 0; h < MAX_THREAD; h++) {
       ts[h].cmd_fdr = ts[h].cmd_fdw = -1;
+      ts[h].epoll_fd = -1;
       ts[h].used = 0;
       ts[h].thread_id = std::nullopt;
-      ts[h].poll_count = 0;
       ts[h].callback = NULL;
       ts[h].cmd_callback = NULL;
     }
@@ -332,73 +346,96 @@ int btsock_thread_exit(int h) {
   return false;
 }
 static void init_poll(int h) {
-  int i;
-  ts[h].poll_count = 0;
+  ts[h].ps.clear();
+  ts[h].invalid_fds.clear();
   ts[h].thread_id = std::nullopt;
   ts[h].callback = NULL;
   ts[h].cmd_callback = NULL;
-  for (i = 0; i < MAX_POLL; i++) {
-    ts[h].ps[i].pfd.fd = -1;
-    ts[h].psi[i] = -1;
+  asrt(ts[h].epoll_fd == -1);
+  ts[h].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (ts[h].epoll_fd == -1) {
+    APPL_TRACE_ERROR("epoll_create1 failed: %s", strerror(errno));
+    return;
   }
   init_cmd_fd(h);
 }
-static inline unsigned int flags2pevents(int flags) {
-  unsigned int pevents = 0;
-  if (flags & SOCK_THREAD_FD_WR) pevents |= POLLOUT;
-  if (flags & SOCK_THREAD_FD_RD) pevents |= POLLIN;
-  pevents |= POLL_EXCEPTION_EVENTS;
-  return pevents;
+static inline unsigned int flags2events(int flags) {
+  unsigned int events = 0;
+  if (flags & SOCK_THREAD_FD_WR) events |= EPOLLOUT;
+  if (flags & SOCK_THREAD_FD_RD) events |= EPOLLIN;
+  events |= EPOLL_EXCEPTION_EVENTS;
+  return events;
 }
-
-static inline void set_poll(poll_slot_t* ps, int fd, int type, int flags,
+static inline bool ctl_poll(int h, int op, const poll_slot_t* ps) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = flags2events(ps->flags);
+  event.data.fd = ps->fd;
+  return epoll_ctl(ts[h].epoll_fd, op, ps->fd, &event) == 0;
+}
+static inline void add_poll(int h, int fd, int type, int flags,
                             uint32_t user_id) {
-  ps->pfd.fd = fd;
-  ps->user_id = user_id;
+  asrt(fd != -1);
+  auto it = ts[h].ps.find(fd);
+  if (it == ts[h].ps.end()) {
+    poll_slot_t ps = {fd, user_id, type, flags};
+    if (!ctl_poll(h, EPOLL_CTL_ADD, &ps)) {
+      if (errno == EBADF) {
+        ts[h].ps[fd] = ps;
+        ts[h].invalid_fds.push_back(fd);
+        return;
+      }
+      APPL_TRACE_ERROR("unable to add fd:%d to epoll set: %s", fd,
+                       strerror(errno));
+      return;
+    }
+    ts[h].ps[fd] = ps;
+    return;
+  }
+
+  poll_slot_t* ps = &it->second;
   if (ps->type != 0 && ps->type != type)
     APPL_TRACE_ERROR(
         "poll socket type should not changed! type was:%d, type now:%d",
         ps->type, type);
   ps->type = type;
-  ps->flags = flags;
-  ps->pfd.events = flags2pevents(flags);
-  ps->pfd.revents = 0;
-}
-static inline void add_poll(int h, int fd, int type, int flags,
-                            uint32_t user_id) {
-  asrt(fd != -1);
-  int i;
-  int empty = -1;
-  poll_slot_t* ps = ts[h].ps;
-
-  for (i = 0; i < MAX_POLL; i++) {
-    if (ps[i].pfd.fd == fd) {
-      asrt(ts[h].poll_count < MAX_POLL);
+  ps->user_id = user_id;
+  ps->flags |= flags;
+  if (ctl_poll(h, EPOLL_CTL_MOD, ps)) return;
+  if (errno == EBADF) {
+    ts[h].invalid_fds.push_back(fd);
+    return;
+  }
 
-      set_poll(&ps[i], fd, type, flags | ps[i].flags, user_id);
+  // The fd was closed and reused without being removed, so the epoll set
+  // already dropped it: monitor the new file with the new flags only
+  if (errno == ENOENT) {
+    ps->flags = flags;
+    if (ctl_poll(h, EPOLL_CTL_ADD, ps)) {
+      auto& invalid_fds = ts[h].invalid_fds;
+      invalid_fds.erase(std::remove(invalid_fds.begin(), invalid_fds.end(), fd),
+                        invalid_fds.end());
       return;
-    } else if (empty < 0 && ps[i].pfd.fd == -1)
-      empty = i;
-  }
-  if (empty >= 0) {
-    asrt(ts[h].poll_count < MAX_POLL);
-    set_poll(&ps[empty], fd, type, flags, user_id);
-    ++ts[h].poll_count;
-    return;
+    }
   }
-  APPL_TRACE_ERROR("exceeded max poll slot:%d!", MAX_POLL);
+  APPL_TRACE_ERROR("unable to update fd:%d in epoll set: %s", fd,
+                   strerror(errno));
+  ts[h].ps.erase(it);
 }
 static inline void remove_poll(int h, poll_slot_t* ps, int flags) {
   if (flags == ps->flags) {
     // all monitored events signaled. To remove it, just clear the slot
-    --ts[h].poll_count;
-    memset(ps, 0, sizeof(*ps));
-    ps->pfd.fd = -1;
+    if (epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_DEL, ps->fd, NULL) != 0)
+      LOG_WARN("unable to remove fd:%d from epoll set: %s", ps->fd,
+               strerror(errno));
+    ts[h].ps.erase(ps->fd);
   } else {
     // one read or one write monitor event signaled, removed the accordding bit
     ps->flags &= ~flags;
     // update the poll events mask
-    ps->pfd.events = flags2pevents(ps->flags);
+    if (!ctl_poll(h, EPOLL_CTL_MOD, ps))
+      LOG_WARN("unable to update fd:%d in epoll set: %s", ps->fd,
+               strerror(errno));
   }
 }
 static int process_cmd_sock(int h) {
@@ -416,16 +453,14 @@ static int process_cmd_sock(int h) {
     case CMD_ADD_FD:
       add_poll(h, cmd.fd, cmd.type, cmd.flags, cmd.user_id);
       break;
-    case CMD_REMOVE_FD:
-      for (int i = 1; i < MAX_POLL; ++i) {
-        poll_slot_t* poll_slot = &ts[h].ps[i];
-        if (poll_slot->pfd.fd == cmd.fd) {
-          remove_poll(h, poll_slot, poll_slot->flags);
-          break;
-        }
+    case CMD_REMOVE_FD: {
+      auto it = ts[h].ps.find(cmd.fd);
+      if (it != ts[h].ps.end() && cmd.fd != fd) {
+        remove_poll(h, &it->second, it->second.flags);
       }
       close(cmd.fd);
       break;
+    }
     case CMD_WAKEUP:
       break;
     case CMD_USER_PRIVATE:
@@ -442,94 +477,104 @@ static int process_cmd_sock(int h) {
   return true;
 }
 
-static void process_data_sock(int h, struct pollfd* pfds, int pfds_count,
-                              int event_count) {
-  asrt(event_count <= pfds_count);
-  int i;
-  for (i = 1; i < pfds_count; i++) {
-    if (pfds[i].revents) {
-      int ps_i = ts[h].psi[i];
-      if (ts[h].ps[ps_i].pfd.fd == -1) {
-        LOG_INFO("Socket has been removed from poll set");
-        continue;
-      }
-      asrt(pfds[i].fd == ts[h].ps[ps_i].pfd.fd);
-      uint32_t user_id = ts[h].ps[ps_i].user_id;
-      int type = ts[h].ps[ps_i].type;
-      int flags = 0;
-      if (IS_READ(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_RD;
-      }
-      if (IS_WRITE(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_WR;
-      }
-      if (IS_EXCEPTION(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_EXCEPTION;
-        // remove the whole slot not flags
-        remove_poll(h, &ts[h].ps[ps_i], ts[h].ps[ps_i].flags);
-      } else if (flags)
-        remove_poll(h, &ts[h].ps[ps_i],
-                    flags);  // remove the monitor flags that already processed
-      if (flags) ts[h].callback(pfds[i].fd, type, flags, user_id);
+/* Finds the monitored fds closed without being removed, which the epoll set
+ * dropped without any event. Only checked with the commands, off the data
+ * path. */
+static void check_closed_fds(int h) {
+  for (auto& [fd, ps] : ts[h].ps) {
+    if (fd == ts[h].cmd_fdr) continue;
+    if (fcntl(fd, F_GETFD) == -1 && errno == EBADF)
+      ts[h].invalid_fds.push_back(fd);
+  }
+}
+
+/* Signals the closed fds as an exception, then removes their slot. The
+ * callbacks may add more closed fds, they are signaled too. */
+static void process_invalid_fds(int h) {
+  while (!ts[h].invalid_fds.empty()) {
+    std::vector<int> invalid_fds;
+    invalid_fds.swap(ts[h].invalid_fds);
+    for (int fd : invalid_fds) {
+      auto it = ts[h].ps.find(fd);
+      if (it == ts[h].ps.end()) continue;
+      poll_slot_t ps = it->second;
+      ts[h].ps.erase(it);
+      LOG_WARN("fd:%d was closed while monitored", fd);
+      ts[h].callback(fd, ps.type, SOCK_THREAD_FD_EXCEPTION, ps.user_id);
     }
   }
 }
 
-static void prepare_poll_fds(int h, struct pollfd* pfds) {
-  int count = 0;
-  int ps_i = 0;
-  int pfd_i = 0;
-  asrt(ts[h].poll_count <= MAX_POLL);
-  memset(pfds, 0, sizeof(pfds[0]) * ts[h].poll_count);
-  while (count < ts[h].poll_count) {
-    if (ps_i >= MAX_POLL) {
-      APPL_TRACE_ERROR(
-          "exceed max poll range, ps_i:%d, MAX_POLL:%d, count:%d, "
-          "ts[h].poll_count:%d",
-          ps_i, MAX_POLL, count, ts[h].poll_count);
-      return;
+static bool has_pending_cmd(int h) {
+  int size = 0;
+  return ioctl(ts[h].cmd_fdr, FIONREAD, &size) == 0 &&
+         size >= (int)sizeof(sock_cmd_t);
+}
+
+static void process_data_sock(int h, struct epoll_event* events,
+                              int event_count) {
+  int i;
+  for (i = 0; i < event_count; i++) {
+    int fd = events[i].data.fd;
+    if (fd == ts[h].cmd_fdr) continue;
+    auto it = ts[h].ps.find(fd);
+    if (it == ts[h].ps.end()) {
+      LOG_INFO("Socket has been removed from poll set");
+      continue;
     }
-    if (ts[h].ps[ps_i].pfd.fd >= 0) {
-      pfds[pfd_i] = ts[h].ps[ps_i].pfd;
-      ts[h].psi[pfd_i] = ps_i;
-      count++;
-      pfd_i++;
+    poll_slot_t* ps = &it->second;
+    uint32_t user_id = ps->user_id;
+    int type = ps->type;
+    int flags = 0;
+    if (IS_READ(events[i].events)) {
+      flags |= SOCK_THREAD_FD_RD;
     }
-    ps_i++;
+    if (IS_WRITE(events[i].events)) {
+      flags |= SOCK_THREAD_FD_WR;
+    }
+    if (IS_EXCEPTION(events[i].events)) {
+      flags |= SOCK_THREAD_FD_EXCEPTION;
+      // remove the whole slot not flags
+      remove_poll(h, ps, ps->flags);
+    } else if (flags)
+      remove_poll(h, ps, flags);  // remove the monitor flags that already
+                                  // processed
+    if (flags) ts[h].callback(fd, type, flags, user_id);
   }
 }
+
 static void* sock_poll_thread(void* arg) {
-  struct pollfd pfds[MAX_POLL];
-  memset(pfds, 0, sizeof(pfds));
+  struct epoll_event events[MAX_EVENTS];
   int h = (intptr_t)arg;
   for (;;) {
-    prepare_poll_fds(h, pfds);
+    // Signaled before waiting, as the closed fds never wake the thread up
+    process_invalid_fds(h);
     int ret;
-    OSI_NO_INTR(ret = poll(pfds, ts[h].poll_count, -1));
+    OSI_NO_INTR(ret = epoll_wait(ts[h].epoll_fd, events, MAX_EVENTS, -1));
     if (ret == -1) {
-      APPL_TRACE_ERROR("poll ret -1, exit the thread, errno:%d, err:%s", errno,
-                       strerror(errno));
+      APPL_TRACE_ERROR("epoll_wait ret -1, exit the thread, errno:%d, err:%s",
+                       errno, strerror(errno));
       break;
     }
-    if (ret != 0) {
-      int need_process_data_fd = true;
-      int pfds_count = ts[h].poll_count;
-      if (pfds[0].revents)  // cmd fd always is the first one
-      {
-        asrt(pfds[0].fd == ts[h].cmd_fdr);
-        if (!process_cmd_sock(h)) {
-          LOG_INFO("h:%d, process_cmd_sock return false, exit...", h);
-          break;
-        }
-        if (ret == 1)
-          need_process_data_fd = false;
-        else
-          ret--;  // exclude the cmd fd
+    bool cmd_signaled = false;
+    for (int i = 0; i < ret; i++) {
+      if (events[i].data.fd == ts[h].cmd_fdr) cmd_signaled = true;
+    }
+    if (cmd_signaled) {
+      // Handle all the queued commands in one wakeup, before the data fds
+      // they may add or remove
+      bool keep_running = true;
+      do {
+        keep_running = process_cmd_sock(h);
+      } while (keep_running && has_pending_cmd(h));
+      if (!keep_running) {
+        LOG_INFO("h:%d, process_cmd_sock return false, exit...", h);
+        break;
       }
-      if (need_process_data_fd) process_data_sock(h, pfds, pfds_count, ret);
-    } else {
-      LOG_INFO("no data, select ret: %d", ret);
-    };
+      check_closed_fds(h);
+    }
+    // All the fds signaled in this wakeup are processed in one batch
+    process_data_sock(h, events, ret);
   }
   LOG_INFO("socket poll thread exiting, h:%d", h);
   return 0;
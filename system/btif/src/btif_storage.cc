@@ -455,62 +455,86 @@ static bt_status_t btif_in_fetch_bonded_device(const std::string& bdstr) {
   return BT_STATUS_SUCCESS;
 }
 
+void btif_storage_visit_bonded_devices(
+    const std::vector<btif_storage_device_loader_t>& loaders) {
+  for (const auto& bd_addr : btif_config_get_paired_devices()) {
+    const std::string name = bd_addr.ToString();
+    for (const auto& loader : loaders) {
+      loader(bd_addr, name);
+    }
+  }
+}
+
 /*******************************************************************************
  *
- * Function         btif_in_fetch_bonded_devices
- *
- * Description      Internal helper function to fetch the bonded devices
- *                  from NVRAM
+ * Function         btif_in_fetch_bonded_device_keys
  *
- * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ * Description      Internal helper function to fetch the keys of one bonded
+ *                  device from NVRAM, and add it to |p_bonded_devices| if
+ *                  found
  *
  ******************************************************************************/
-static bt_status_t btif_in_fetch_bonded_devices(
+static void btif_in_fetch_bonded_device_keys(
+    const RawAddress& bd_addr, const std::string& name,
     btif_bonded_devices_t* p_bonded_devices, int add) {
-  memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
-
   bool bt_linkkey_file_found = false;
   int device_type;
 
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
-    LinkKey link_key;
-    size_t size = sizeof(link_key);
-    if (btif_config_get_bin(name, "LinkKey", link_key.data(), &size)) {
-      int linkkey_type;
-      if (btif_config_get_int(name, "LinkKeyType", &linkkey_type)) {
-        if (add) {
-          DEV_CLASS dev_class = {0, 0, 0};
-          int cod;
-          int pin_length = 0;
-          if (btif_config_get_int(name, "DevClass", &cod))
-            uint2devclass((uint32_t)cod, dev_class);
-          btif_config_get_int(name, "PinLength", &pin_length);
-          BTA_DmAddDevice(bd_addr, dev_class, link_key, (uint8_t)linkkey_type,
-                          pin_length);
-
-          if (btif_config_get_int(name, "DevType", &device_type) &&
-              (device_type == BT_DEVICE_TYPE_DUMO)) {
-            btif_gatts_add_bonded_dev_from_nv(bd_addr);
-          }
-        }
-        bt_linkkey_file_found = true;
-        if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
-          p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
-        } else {
-          BTIF_TRACE_WARNING("%s: exceed the max number of bonded devices",
-                             __func__);
+  BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
+  LinkKey link_key;
+  size_t size = sizeof(link_key);
+  if (btif_config_get_bin(name, "LinkKey", link_key.data(), &size)) {
+    int linkkey_type;
+    if (btif_config_get_int(name, "LinkKeyType", &linkkey_type)) {
+      if (add) {
+        DEV_CLASS dev_class = {0, 0, 0};
+        int cod;
+        int pin_length = 0;
+        if (btif_config_get_int(name, "DevClass", &cod))
+          uint2devclass((uint32_t)cod, dev_class);
+        btif_config_get_int(name, "PinLength", &pin_length);
+        BTA_DmAddDevice(bd_addr, dev_class, link_key, (uint8_t)linkkey_type,
+                        pin_length);
+
+        if (btif_config_get_int(name, "DevType", &device_type) &&
+            (device_type == BT_DEVICE_TYPE_DUMO)) {
+          btif_gatts_add_bonded_dev_from_nv(bd_addr);
         }
+      }
+      bt_linkkey_file_found = true;
+      if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
+        p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
       } else {
-        bt_linkkey_file_found = false;
+        BTIF_TRACE_WARNING("%s: exceed the max number of bonded devices",
+                           __func__);
       }
-    }
-    if (!btif_in_fetch_bonded_ble_device(name, add, p_bonded_devices) && !bt_linkkey_file_found) {
-      LOG_VERBOSE("No link key or ble key found for device:%s", name.c_str());
+    } else {
+      bt_linkkey_file_found = false;
     }
   }
+  if (!btif_in_fetch_bonded_ble_device(name, add, p_bonded_devices) && !bt_linkkey_file_found) {
+    LOG_VERBOSE("No link key or ble key found for device:%s", name.c_str());
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_in_fetch_bonded_devices
+ *
+ * Description      Internal helper function to fetch the bonded devices
+ *                  from NVRAM
+ *
+ * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ *
+ ******************************************************************************/
+static bt_status_t btif_in_fetch_bonded_devices(
+    btif_bonded_devices_t* p_bonded_devices, int add) {
+  memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
+  btif_storage_visit_bonded_devices(
+      {[p_bonded_devices, add](const RawAddress& bd_addr,
+                               const std::string& name) {
+        btif_in_fetch_bonded_device_keys(bd_addr, name, p_bonded_devices, add);
+      }});
   return BT_STATUS_SUCCESS;
 }
 
@@ -925,23 +949,19 @@ bt_status_t btif_storage_remove_bonded_device(
  * We still allow such devices to bond in order to give the user a chance to
  * update firmware.
  */
-static void remove_devices_with_sample_ltk() {
-  std::vector<RawAddress> bad_ltk;
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    tBTA_LE_KEY_VALUE key;
-    memset(&key, 0, sizeof(key));
+static bool has_sample_ltk(const RawAddress& bd_addr) {
+  tBTA_LE_KEY_VALUE key;
+  memset(&key, 0, sizeof(key));
 
-    if (btif_storage_get_ble_bonding_key(
-            bd_addr, BTM_LE_KEY_PENC, (uint8_t*)&key,
-            sizeof(tBTM_LE_PENC_KEYS)) == BT_STATUS_SUCCESS) {
-      if (is_sample_ltk(key.penc_key.ltk)) {
-        bad_ltk.push_back(bd_addr);
-      }
-    }
-  }
+  return btif_storage_get_ble_bonding_key(bd_addr, BTM_LE_KEY_PENC,
+                                          (uint8_t*)&key,
+                                          sizeof(tBTM_LE_PENC_KEYS)) ==
+             BT_STATUS_SUCCESS &&
+         is_sample_ltk(key.penc_key.ltk);
+}
 
+static void remove_devices_with_sample_ltk(
+    const std::vector<RawAddress>& bad_ltk) {
   for (RawAddress address : bad_ltk) {
     LOG(ERROR) << __func__
                << ": removing bond to device using test TLK: " << address;
@@ -950,21 +970,27 @@ static void remove_devices_with_sample_ltk() {
   }
 }
 
-/*******************************************************************************
- *
- * Function         btif_storage_load_le_devices
- *
- * Description      BTIF storage API - Loads all LE-only and Dual Mode devices
- *                  from NVRAM. This API invokes the adaper_properties_cb.
- *                  It also invokes invoke_address_consolidate_cb
- *                  to consolidate each Dual Mode device and
- *                  invoke_le_address_associate_cb to associate each LE-only
- *                  device between its RPA and identity address.
- *
- ******************************************************************************/
-void btif_storage_load_le_devices(void) {
-  btif_bonded_devices_t bonded_devices;
-  btif_in_fetch_bonded_devices(&bonded_devices, 1);
+/* Fetches the bonded devices from NVRAM and adds them to the BTA, in a single
+ * pass which also removes the bonds of the devices using the sample LTK */
+static void btif_in_fetch_bonded_devices_without_sample_ltk(
+    btif_bonded_devices_t* p_bonded_devices) {
+  std::vector<RawAddress> bad_ltk;
+  memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
+  btif_storage_visit_bonded_devices(
+      {[p_bonded_devices, &bad_ltk](const RawAddress& bd_addr,
+                                    const std::string& name) {
+        if (has_sample_ltk(bd_addr)) {
+          bad_ltk.push_back(bd_addr);
+          return;
+        }
+        btif_in_fetch_bonded_device_keys(bd_addr, name, p_bonded_devices, 1);
+      }});
+  remove_devices_with_sample_ltk(bad_ltk);
+}
+
+/* Consolidates the addresses of the bonded LE devices and reports them */
+static void btif_in_consolidate_le_devices(
+    const btif_bonded_devices_t& bonded_devices) {
   std::unordered_set<RawAddress> bonded_addresses;
   for (uint16_t i = 0; i < bonded_devices.num_devices; i++) {
     bonded_addresses.insert(bonded_devices.devices[i]);
@@ -1022,19 +1048,26 @@ void btif_storage_load_le_devices(void) {
 
 /*******************************************************************************
  *
- * Function         btif_storage_load_bonded_devices
- *
- * Description      BTIF storage API - Loads all the bonded devices from NVRAM
- *                  and adds to the BTA.
- *                  Additionally, this API also invokes the adaper_properties_cb
- *                  and remote_device_properties_cb for each of the bonded
- *                  devices.
+ * Function         btif_storage_load_le_devices
  *
- * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ * Description      BTIF storage API - Loads all LE-only and Dual Mode devices
+ *                  from NVRAM. This API invokes the adaper_properties_cb.
+ *                  It also invokes invoke_address_consolidate_cb
+ *                  to consolidate each Dual Mode device and
+ *                  invoke_le_address_associate_cb to associate each LE-only
+ *                  device between its RPA and identity address.
  *
  ******************************************************************************/
-bt_status_t btif_storage_load_bonded_devices(void) {
+void btif_storage_load_le_devices(void) {
   btif_bonded_devices_t bonded_devices;
+  btif_in_fetch_bonded_devices(&bonded_devices, 1);
+  btif_in_consolidate_le_devices(bonded_devices);
+}
+
+/* Invokes the adapter and remote device properties callbacks with the bonded
+ * devices */
+static void btif_in_report_bonded_devices(
+    btif_bonded_devices_t& bonded_devices) {
   uint32_t i = 0;
   bt_property_t adapter_props[6];
   uint32_t num_props = 0;
@@ -1047,10 +1080,6 @@ bt_status_t btif_storage_load_bonded_devices(void) {
   Uuid remote_uuids[BT_MAX_NUM_UUIDS];
   bt_status_t status;
 
-  remove_devices_with_sample_ltk();
-
-  btif_in_fetch_bonded_devices(&bonded_devices, 1);
-
   /* Now send the adapter_properties_cb with all adapter_properties */
   {
     memset(adapter_props, 0, sizeof(adapter_props));
@@ -1153,6 +1182,44 @@ bt_status_t btif_storage_load_bonded_devices(void) {
                                  remote_properties);
     }
   }
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_storage_load_bonded_devices
+ *
+ * Description      BTIF storage API - Loads all the bonded devices from NVRAM
+ *                  and adds to the BTA.
+ *                  Additionally, this API also invokes the adaper_properties_cb
+ *                  and remote_device_properties_cb for each of the bonded
+ *                  devices.
+ *
+ * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ *
+ ******************************************************************************/
+bt_status_t btif_storage_load_bonded_devices(void) {
+  btif_bonded_devices_t bonded_devices;
+  btif_in_fetch_bonded_devices_without_sample_ltk(&bonded_devices);
+  btif_in_report_bonded_devices(bonded_devices);
+  return BT_STATUS_SUCCESS;
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_storage_load_bonded_and_le_devices
+ *
+ * Description      BTIF storage API - Does what btif_storage_load_le_devices
+ *                  and then btif_storage_load_bonded_devices do, fetching the
+ *                  bonded devices from NVRAM and adding them to the BTA once.
+ *
+ * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ *
+ ******************************************************************************/
+bt_status_t btif_storage_load_bonded_and_le_devices(void) {
+  btif_bonded_devices_t bonded_devices;
+  btif_in_fetch_bonded_devices_without_sample_ltk(&bonded_devices);
+  btif_in_consolidate_le_devices(bonded_devices);
+  btif_in_report_bonded_devices(bonded_devices);
   return BT_STATUS_SUCCESS;
 }
 
@@ -1515,73 +1582,75 @@ bt_status_t btif_storage_add_hid_device_info(
   return BT_STATUS_SUCCESS;
 }
 
-/*******************************************************************************
- *
- * Function         btif_storage_load_bonded_hid_info
- *
- * Description      BTIF storage API - Loads hid info for all the bonded devices
- *                  from NVRAM and adds those devices  to the BTA_HH.
- *
- * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
- *
- ******************************************************************************/
-bt_status_t btif_storage_load_bonded_hid_info(void) {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
+/* Adds the hid info of a bonded device to the BTA_HH */
+static void btif_in_load_hid_info(const RawAddress& bd_addr,
+                                  const std::string& name) {
+  BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
 
-    int value;
-    if (!btif_config_get_int(name, "HidAttrMask", &value)) continue;
-    uint16_t attr_mask = (uint16_t)value;
+  int value;
+  if (!btif_config_get_int(name, "HidAttrMask", &value)) return;
+  uint16_t attr_mask = (uint16_t)value;
 
-    if (btif_in_fetch_bonded_device(name) != BT_STATUS_SUCCESS) {
-      btif_storage_remove_hid_info(bd_addr);
-      continue;
-    }
+  if (btif_in_fetch_bonded_device(name) != BT_STATUS_SUCCESS) {
+    btif_storage_remove_hid_info(bd_addr);
+    return;
+  }
 
-    tBTA_HH_DEV_DSCP_INFO dscp_info;
-    memset(&dscp_info, 0, sizeof(dscp_info));
+  tBTA_HH_DEV_DSCP_INFO dscp_info;
+  memset(&dscp_info, 0, sizeof(dscp_info));
 
-    btif_config_get_int(name, "HidSubClass", &value);
-    uint8_t sub_class = (uint8_t)value;
+  btif_config_get_int(name, "HidSubClass", &value);
+  uint8_t sub_class = (uint8_t)value;
 
-    btif_config_get_int(name, "HidAppId", &value);
-    uint8_t app_id = (uint8_t)value;
+  btif_config_get_int(name, "HidAppId", &value);
+  uint8_t app_id = (uint8_t)value;
 
-    btif_config_get_int(name, "HidVendorId", &value);
-    dscp_info.vendor_id = (uint16_t)value;
+  btif_config_get_int(name, "HidVendorId", &value);
+  dscp_info.vendor_id = (uint16_t)value;
 
-    btif_config_get_int(name, "HidProductId", &value);
-    dscp_info.product_id = (uint16_t)value;
+  btif_config_get_int(name, "HidProductId", &value);
+  dscp_info.product_id = (uint16_t)value;
 
-    btif_config_get_int(name, "HidVersion", &value);
-    dscp_info.version = (uint8_t)value;
+  btif_config_get_int(name, "HidVersion", &value);
+  dscp_info.version = (uint8_t)value;
 
-    btif_config_get_int(name, "HidCountryCode", &value);
-    dscp_info.ctry_code = (uint8_t)value;
+  btif_config_get_int(name, "HidCountryCode", &value);
+  dscp_info.ctry_code = (uint8_t)value;
 
-    value = 0;
-    btif_config_get_int(name, "HidSSRMaxLatency", &value);
-    dscp_info.ssr_max_latency = (uint16_t)value;
+  value = 0;
+  btif_config_get_int(name, "HidSSRMaxLatency", &value);
+  dscp_info.ssr_max_latency = (uint16_t)value;
 
-    value = 0;
-    btif_config_get_int(name, "HidSSRMinTimeout", &value);
-    dscp_info.ssr_min_tout = (uint16_t)value;
+  value = 0;
+  btif_config_get_int(name, "HidSSRMinTimeout", &value);
+  dscp_info.ssr_min_tout = (uint16_t)value;
 
-    size_t len = btif_config_get_bin_length(name, "HidDescriptor");
-    if (len > 0) {
-      dscp_info.descriptor.dl_len = (uint16_t)len;
-      dscp_info.descriptor.dsc_list = (uint8_t*)alloca(len);
-      btif_config_get_bin(name, "HidDescriptor",
-                          (uint8_t*)dscp_info.descriptor.dsc_list, &len);
-    }
+  size_t len = btif_config_get_bin_length(name, "HidDescriptor");
+  if (len > 0) {
+    dscp_info.descriptor.dl_len = (uint16_t)len;
+    dscp_info.descriptor.dsc_list = (uint8_t*)alloca(len);
+    btif_config_get_bin(name, "HidDescriptor",
+                        (uint8_t*)dscp_info.descriptor.dsc_list, &len);
+  }
 
-    // add extracted information to BTA HH
-    if (btif_hh_add_added_dev(bd_addr, attr_mask)) {
-      BTA_HhAddDev(bd_addr, attr_mask, sub_class, app_id, dscp_info);
-    }
+  // add extracted information to BTA HH
+  if (btif_hh_add_added_dev(bd_addr, attr_mask)) {
+    BTA_HhAddDev(bd_addr, attr_mask, sub_class, app_id, dscp_info);
   }
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_storage_load_bonded_hid_info
+ *
+ * Description      BTIF storage API - Loads hid info for all the bonded devices
+ *                  from NVRAM and adds those devices  to the BTA_HH.
+ *
+ * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ *
+ ******************************************************************************/
+bt_status_t btif_storage_load_bonded_hid_info(void) {
+  btif_storage_visit_bonded_devices({btif_in_load_hid_info});
 
   return BT_STATUS_SUCCESS;
 }
@@ -1665,98 +1734,100 @@ void btif_storage_add_hearing_aid(const HearingDevice& dev_info) {
           dev_info));
 }
 
-/** Loads information about bonded hearing aid devices */
-void btif_storage_load_bonded_hearing_aids() {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    const std::string& name = bd_addr.ToString();
-
-    int size = STORAGE_UUID_STRING_SIZE * HEARINGAID_MAX_NUM_UUIDS;
-    char uuid_str[size];
-    bool isHearingaidDevice = false;
-    if (btif_config_get_str(name, BTIF_STORAGE_PATH_REMOTE_SERVICE, uuid_str,
-                            &size)) {
-      Uuid p_uuid[HEARINGAID_MAX_NUM_UUIDS];
-      size_t num_uuids =
-          btif_split_uuids_string(uuid_str, p_uuid, HEARINGAID_MAX_NUM_UUIDS);
-      for (size_t i = 0; i < num_uuids; i++) {
-        if (p_uuid[i] == Uuid::FromString("FDF0")) {
-          isHearingaidDevice = true;
-          break;
-        }
+/* Adds a bonded hearing aid device to the BTA Hearing Aid */
+static void btif_in_load_hearing_aid(const RawAddress& bd_addr,
+                                     const std::string& name) {
+  int size = STORAGE_UUID_STRING_SIZE * HEARINGAID_MAX_NUM_UUIDS;
+  char uuid_str[size];
+  bool isHearingaidDevice = false;
+  if (btif_config_get_str(name, BTIF_STORAGE_PATH_REMOTE_SERVICE, uuid_str,
+                          &size)) {
+    Uuid p_uuid[HEARINGAID_MAX_NUM_UUIDS];
+    size_t num_uuids =
+        btif_split_uuids_string(uuid_str, p_uuid, HEARINGAID_MAX_NUM_UUIDS);
+    for (size_t i = 0; i < num_uuids; i++) {
+      if (p_uuid[i] == Uuid::FromString("FDF0")) {
+        isHearingaidDevice = true;
+        break;
       }
     }
-    if (!isHearingaidDevice) {
-      continue;
-    }
+  }
+  if (!isHearingaidDevice) {
+    return;
+  }
 
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
+  BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
 
-    if (btif_in_fetch_bonded_device(name) != BT_STATUS_SUCCESS) {
-      btif_storage_remove_hearing_aid(bd_addr);
-      continue;
-    }
+  if (btif_in_fetch_bonded_device(name) != BT_STATUS_SUCCESS) {
+    btif_storage_remove_hearing_aid(bd_addr);
+    return;
+  }
 
-    int value;
-    uint8_t capabilities = 0;
-    if (btif_config_get_int(name, HEARING_AID_CAPABILITIES, &value))
-      capabilities = value;
+  int value;
+  uint8_t capabilities = 0;
+  if (btif_config_get_int(name, HEARING_AID_CAPABILITIES, &value))
+    capabilities = value;
 
-    uint16_t codecs = 0;
-    if (btif_config_get_int(name, HEARING_AID_CODECS, &value)) codecs = value;
+  uint16_t codecs = 0;
+  if (btif_config_get_int(name, HEARING_AID_CODECS, &value)) codecs = value;
 
-    uint16_t audio_control_point_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_AUDIO_CONTROL_POINT, &value))
-      audio_control_point_handle = value;
+  uint16_t audio_control_point_handle = 0;
+  if (btif_config_get_int(name, HEARING_AID_AUDIO_CONTROL_POINT, &value))
+    audio_control_point_handle = value;
 
-    uint16_t audio_status_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_AUDIO_STATUS_HANDLE, &value))
-      audio_status_handle = value;
+  uint16_t audio_status_handle = 0;
+  if (btif_config_get_int(name, HEARING_AID_AUDIO_STATUS_HANDLE, &value))
+    audio_status_handle = value;
 
-    uint16_t audio_status_ccc_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_AUDIO_STATUS_CCC_HANDLE, &value))
-      audio_status_ccc_handle = value;
+  uint16_t audio_status_ccc_handle = 0;
+  if (btif_config_get_int(name, HEARING_AID_AUDIO_STATUS_CCC_HANDLE, &value))
+    audio_status_ccc_handle = value;
 
-    uint16_t service_changed_ccc_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_SERVICE_CHANGED_CCC_HANDLE,
-                            &value))
-      service_changed_ccc_handle = value;
+  uint16_t service_changed_ccc_handle = 0;
+  if (btif_config_get_int(name, HEARING_AID_SERVICE_CHANGED_CCC_HANDLE,
+                          &value))
+    service_changed_ccc_handle = value;
 
-    uint16_t volume_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_VOLUME_HANDLE, &value))
-      volume_handle = value;
+  uint16_t volume_handle = 0;
+  if (btif_config_get_int(name, HEARING_AID_VOLUME_HANDLE, &value))
+    volume_handle = value;
 
-    uint16_t read_psm_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_READ_PSM_HANDLE, &value))
-      read_psm_handle = value;
+  uint16_t read_psm_handle = 0;
+  if (btif_config_get_int(name, HEARING_AID_READ_PSM_HANDLE, &value))
+    read_psm_handle = value;
 
-    uint64_t lvalue;
-    uint64_t hi_sync_id = 0;
-    if (btif_config_get_uint64(name, HEARING_AID_SYNC_ID, &lvalue))
-      hi_sync_id = lvalue;
+  uint64_t lvalue;
+  uint64_t hi_sync_id = 0;
+  if (btif_config_get_uint64(name, HEARING_AID_SYNC_ID, &lvalue))
+    hi_sync_id = lvalue;
 
-    uint16_t render_delay = 0;
-    if (btif_config_get_int(name, HEARING_AID_RENDER_DELAY, &value))
-      render_delay = value;
+  uint16_t render_delay = 0;
+  if (btif_config_get_int(name, HEARING_AID_RENDER_DELAY, &value))
+    render_delay = value;
 
-    uint16_t preparation_delay = 0;
-    if (btif_config_get_int(name, HEARING_AID_PREPARATION_DELAY, &value))
-      preparation_delay = value;
+  uint16_t preparation_delay = 0;
+  if (btif_config_get_int(name, HEARING_AID_PREPARATION_DELAY, &value))
+    preparation_delay = value;
 
-    uint16_t is_acceptlisted = 0;
-    if (btif_config_get_int(name, HEARING_AID_IS_ACCEPTLISTED, &value))
-      is_acceptlisted = value;
+  uint16_t is_acceptlisted = 0;
+  if (btif_config_get_int(name, HEARING_AID_IS_ACCEPTLISTED, &value))
+    is_acceptlisted = value;
 
-    // add extracted information to BTA Hearing Aid
-    do_in_main_thread(
-        FROM_HERE,
-        Bind(&HearingAid::AddFromStorage,
-             HearingDevice(bd_addr, capabilities, codecs,
-                           audio_control_point_handle, audio_status_handle,
-                           audio_status_ccc_handle, service_changed_ccc_handle,
-                           volume_handle, read_psm_handle, hi_sync_id,
-                           render_delay, preparation_delay),
-             is_acceptlisted));
-  }
+  // add extracted information to BTA Hearing Aid
+  do_in_main_thread(
+      FROM_HERE,
+      Bind(&HearingAid::AddFromStorage,
+           HearingDevice(bd_addr, capabilities, codecs,
+                         audio_control_point_handle, audio_status_handle,
+                         audio_status_ccc_handle, service_changed_ccc_handle,
+                         volume_handle, read_psm_handle, hi_sync_id,
+                         render_delay, preparation_delay),
+           is_acceptlisted));
+}
+
+/** Loads information about bonded hearing aid devices */
+void btif_storage_load_bonded_hearing_aids() {
+  btif_storage_visit_bonded_devices({btif_in_load_hearing_aid});
 }
 
 /** Deletes the bonded hearing aid device info from NVRAM */
@@ -1981,97 +2052,99 @@ void btif_storage_set_leaudio_supported_context_types(
           addr, sink_supported_context_type, source_supported_context_type));
 }
 
-/** Loads information about bonded Le Audio devices */
-void btif_storage_load_bonded_leaudio() {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    int size = STORAGE_UUID_STRING_SIZE * BT_MAX_NUM_UUIDS;
-    char uuid_str[size];
-    bool isLeAudioDevice = false;
-    if (btif_config_get_str(name, BTIF_STORAGE_PATH_REMOTE_SERVICE, uuid_str,
-                            &size)) {
-      Uuid p_uuid[BT_MAX_NUM_UUIDS];
-      size_t num_uuids =
-          btif_split_uuids_string(uuid_str, p_uuid, BT_MAX_NUM_UUIDS);
-      for (size_t i = 0; i < num_uuids; i++) {
-        if (p_uuid[i] == Uuid::FromString("184E")) {
-          isLeAudioDevice = true;
-          break;
-        }
+/* Adds a bonded Le Audio device to the Le Audio client */
+static void btif_in_load_leaudio(const RawAddress& bd_addr,
+                                 const std::string& name) {
+  int size = STORAGE_UUID_STRING_SIZE * BT_MAX_NUM_UUIDS;
+  char uuid_str[size];
+  bool isLeAudioDevice = false;
+  if (btif_config_get_str(name, BTIF_STORAGE_PATH_REMOTE_SERVICE, uuid_str,
+                          &size)) {
+    Uuid p_uuid[BT_MAX_NUM_UUIDS];
+    size_t num_uuids =
+        btif_split_uuids_string(uuid_str, p_uuid, BT_MAX_NUM_UUIDS);
+    for (size_t i = 0; i < num_uuids; i++) {
+      if (p_uuid[i] == Uuid::FromString("184E")) {
+        isLeAudioDevice = true;
+        break;
       }
     }
-    if (!isLeAudioDevice) {
-      continue;
-    }
+  }
+  if (!isLeAudioDevice) {
+    return;
+  }
 
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
+  BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
 
-    int value;
-    bool autoconnect = false;
-    if (btif_config_get_int(name, BTIF_STORAGE_LEAUDIO_AUTOCONNECT, &value))
-      autoconnect = !!value;
-
-    int sink_audio_location = 0;
-    if (btif_config_get_int(name, BTIF_STORAGE_LEAUDIO_SINK_AUDIOLOCATION,
-                            &value))
-      sink_audio_location = value;
-
-    int source_audio_location = 0;
-    if (btif_config_get_int(name, BTIF_STORAGE_LEAUDIO_SOURCE_AUDIOLOCATION,
-                            &value))
-      source_audio_location = value;
-
-    int sink_supported_context_type = 0;
-    if (btif_config_get_int(
-            name, BTIF_STORAGE_LEAUDIO_SINK_SUPPORTED_CONTEXT_TYPE, &value))
-      sink_supported_context_type = value;
-
-    int source_supported_context_type = 0;
-    if (btif_config_get_int(
-            name, BTIF_STORAGE_LEAUDIO_SOURCE_SUPPORTED_CONTEXT_TYPE, &value))
-      source_supported_context_type = value;
-
-    size_t buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_HANDLES_BIN);
-    std::vector<uint8_t> handles(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_HANDLES_BIN,
-                          handles.data(), &buffer_size);
-    }
-
-    buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN);
-    std::vector<uint8_t> sink_pacs(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN,
-                          sink_pacs.data(), &buffer_size);
-    }
+  int value;
+  bool autoconnect = false;
+  if (btif_config_get_int(name, BTIF_STORAGE_LEAUDIO_AUTOCONNECT, &value))
+    autoconnect = !!value;
+
+  int sink_audio_location = 0;
+  if (btif_config_get_int(name, BTIF_STORAGE_LEAUDIO_SINK_AUDIOLOCATION,
+                          &value))
+    sink_audio_location = value;
+
+  int source_audio_location = 0;
+  if (btif_config_get_int(name, BTIF_STORAGE_LEAUDIO_SOURCE_AUDIOLOCATION,
+                          &value))
+    source_audio_location = value;
+
+  int sink_supported_context_type = 0;
+  if (btif_config_get_int(
+          name, BTIF_STORAGE_LEAUDIO_SINK_SUPPORTED_CONTEXT_TYPE, &value))
+    sink_supported_context_type = value;
+
+  int source_supported_context_type = 0;
+  if (btif_config_get_int(
+          name, BTIF_STORAGE_LEAUDIO_SOURCE_SUPPORTED_CONTEXT_TYPE, &value))
+    source_supported_context_type = value;
+
+  size_t buffer_size =
+      btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_HANDLES_BIN);
+  std::vector<uint8_t> handles(buffer_size);
+  if (buffer_size > 0) {
+    btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_HANDLES_BIN,
+                        handles.data(), &buffer_size);
+  }
 
-    buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN);
-    std::vector<uint8_t> source_pacs(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN,
-                          source_pacs.data(), &buffer_size);
-    }
+  buffer_size =
+      btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN);
+  std::vector<uint8_t> sink_pacs(buffer_size);
+  if (buffer_size > 0) {
+    btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_SINK_PACS_BIN,
+                        sink_pacs.data(), &buffer_size);
+  }
 
-    buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_ASES_BIN);
-    std::vector<uint8_t> ases(buffer_size);
-    if (buffer_size > 0) {
-      btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_ASES_BIN, ases.data(),
-                          &buffer_size);
-    }
+  buffer_size =
+      btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN);
+  std::vector<uint8_t> source_pacs(buffer_size);
+  if (buffer_size > 0) {
+    btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_SOURCE_PACS_BIN,
+                        source_pacs.data(), &buffer_size);
+  }
 
-    do_in_main_thread(
-        FROM_HERE,
-        Bind(&LeAudioClient::AddFromStorage, bd_addr, autoconnect,
-             sink_audio_location, source_audio_location,
-             sink_supported_context_type, source_supported_context_type,
-             std::move(handles), std::move(sink_pacs), std::move(source_pacs),
-             std::move(ases)));
+  buffer_size =
+      btif_config_get_bin_length(name, BTIF_STORAGE_LEAUDIO_ASES_BIN);
+  std::vector<uint8_t> ases(buffer_size);
+  if (buffer_size > 0) {
+    btif_config_get_bin(name, BTIF_STORAGE_LEAUDIO_ASES_BIN, ases.data(),
+                        &buffer_size);
   }
+
+  do_in_main_thread(
+      FROM_HERE,
+      Bind(&LeAudioClient::AddFromStorage, bd_addr, autoconnect,
+           sink_audio_location, source_audio_location,
+           sink_supported_context_type, source_supported_context_type,
+           std::move(handles), std::move(sink_pacs), std::move(source_pacs),
+           std::move(ases)));
+}
+
+/** Loads information about bonded Le Audio devices */
+void btif_storage_load_bonded_leaudio() {
+  btif_storage_visit_bonded_devices({btif_in_load_leaudio});
 }
 
 /** Remove the Le Audio device from storage */
@@ -2145,29 +2218,31 @@ void btif_storage_set_leaudio_has_features(const RawAddress& address,
                        address, features));
 }
 
-void btif_storage_load_bonded_leaudio_has_devices() {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    const std::string& name = bd_addr.ToString();
+/* Adds a bonded hearing access device to the HAS client */
+static void btif_in_load_leaudio_has_device(const RawAddress& bd_addr,
+                                            const std::string& name) {
+  if (!btif_config_exist(name, HAS_IS_ACCEPTLISTED) &&
+      !btif_config_exist(name, HAS_FEATURES))
+    return;
 
-    if (!btif_config_exist(name, HAS_IS_ACCEPTLISTED) &&
-        !btif_config_exist(name, HAS_FEATURES))
-      continue;
-
-    int value;
-    uint16_t is_acceptlisted = 0;
-    if (btif_config_get_int(name, HAS_IS_ACCEPTLISTED, &value))
-      is_acceptlisted = value;
+  int value;
+  uint16_t is_acceptlisted = 0;
+  if (btif_config_get_int(name, HAS_IS_ACCEPTLISTED, &value))
+    is_acceptlisted = value;
 
-    uint8_t features = 0;
-    if (btif_config_get_int(name, HAS_FEATURES, &value)) features = value;
+  uint8_t features = 0;
+  if (btif_config_get_int(name, HAS_FEATURES, &value)) features = value;
 
 #ifndef TARGET_FLOSS
-    do_in_main_thread(FROM_HERE, Bind(&le_audio::has::HasClient::AddFromStorage,
-                                      bd_addr, features, is_acceptlisted));
+  do_in_main_thread(FROM_HERE, Bind(&le_audio::has::HasClient::AddFromStorage,
+                                    bd_addr, features, is_acceptlisted));
 #else
-    ASSERT_LOG(false, "TODO - Fix LE audio build.");
+  ASSERT_LOG(false, "TODO - Fix LE audio build.");
 #endif
-  }
+}
+
+void btif_storage_load_bonded_leaudio_has_devices() {
+  btif_storage_visit_bonded_devices({btif_in_load_leaudio_has_device});
 }
 
 void btif_storage_remove_leaudio_has(const RawAddress& address) {
@@ -2245,25 +2320,28 @@ void btif_storage_remove_groups(const RawAddress& address) {
   btif_config_save();
 }
 
-/** Loads information about bonded group devices */
-void btif_storage_load_bonded_groups(void) {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-    size_t buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_DEVICE_GROUP_BIN);
-    if (buffer_size == 0) continue;
+/* Adds the groups of a bonded device to the device groups */
+static void btif_in_load_groups(const RawAddress& bd_addr,
+                                const std::string& name) {
+  size_t buffer_size =
+      btif_config_get_bin_length(name, BTIF_STORAGE_DEVICE_GROUP_BIN);
+  if (buffer_size == 0) return;
 
-    BTIF_TRACE_DEBUG("Grouped device:%s", name.c_str());
+  BTIF_TRACE_DEBUG("Grouped device:%s", name.c_str());
 
-    std::vector<uint8_t> in(buffer_size);
-    if (btif_config_get_bin(name, BTIF_STORAGE_DEVICE_GROUP_BIN, in.data(),
-                            &buffer_size)) {
-      do_in_main_thread(FROM_HERE, Bind(&DeviceGroups::AddFromStorage, bd_addr,
-                                        std::move(in)));
-    }
+  std::vector<uint8_t> in(buffer_size);
+  if (btif_config_get_bin(name, BTIF_STORAGE_DEVICE_GROUP_BIN, in.data(),
+                          &buffer_size)) {
+    do_in_main_thread(FROM_HERE, Bind(&DeviceGroups::AddFromStorage, bd_addr,
+                                      std::move(in)));
   }
 }
 
+/** Loads information about bonded group devices */
+void btif_storage_load_bonded_groups(void) {
+  btif_storage_visit_bonded_devices({btif_in_load_groups});
+}
+
 void btif_storage_set_csis_autoconnect(const RawAddress& addr,
                                        bool autoconnect) {
   do_in_jni_thread(FROM_HERE, Bind(
@@ -2296,29 +2374,31 @@ void btif_storage_update_csis_info(const RawAddress& addr) {
             addr, std::move(set_info)));
 }
 
-/** Loads information about the bonded CSIS device */
-void btif_storage_load_bonded_csis_devices(void) {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
+/* Adds a bonded CSIS device to the CSIS client */
+static void btif_in_load_csis_device(const RawAddress& bd_addr,
+                                     const std::string& name) {
+  BTIF_TRACE_DEBUG("Loading CSIS device:%s", name.c_str());
 
-    BTIF_TRACE_DEBUG("Loading CSIS device:%s", name.c_str());
+  int value;
+  bool autoconnect = false;
+  if (btif_config_get_int(name, BTIF_STORAGE_CSIS_AUTOCONNECT, &value))
+    autoconnect = !!value;
 
-    int value;
-    bool autoconnect = false;
-    if (btif_config_get_int(name, BTIF_STORAGE_CSIS_AUTOCONNECT, &value))
-      autoconnect = !!value;
-
-    size_t buffer_size =
-        btif_config_get_bin_length(name, BTIF_STORAGE_CSIS_SET_INFO_BIN);
-    std::vector<uint8_t> in(buffer_size);
-    if (buffer_size != 0)
-      btif_config_get_bin(name, BTIF_STORAGE_CSIS_SET_INFO_BIN, in.data(),
-                          &buffer_size);
-
-    if (buffer_size != 0 || autoconnect)
-      do_in_main_thread(FROM_HERE, Bind(&CsisClient::AddFromStorage, bd_addr,
-                                        std::move(in), autoconnect));
-  }
+  size_t buffer_size =
+      btif_config_get_bin_length(name, BTIF_STORAGE_CSIS_SET_INFO_BIN);
+  std::vector<uint8_t> in(buffer_size);
+  if (buffer_size != 0)
+    btif_config_get_bin(name, BTIF_STORAGE_CSIS_SET_INFO_BIN, in.data(),
+                        &buffer_size);
+
+  if (buffer_size != 0 || autoconnect)
+    do_in_main_thread(FROM_HERE, Bind(&CsisClient::AddFromStorage, bd_addr,
+                                      std::move(in), autoconnect));
+}
+
+/** Loads information about the bonded CSIS device */
+void btif_storage_load_bonded_csis_devices(void) {
+  btif_storage_visit_bonded_devices({btif_in_load_csis_device});
 }
 
 /** Removes information about the bonded CSIS device */
@@ -21,9 +21,15 @@
 #include "btif/include/stack_manager.h"
 
 #include <hardware/bluetooth.h>
+
+#include <array>
 #include <cstdlib>
 #include <cstring>
 
+#ifdef OS_ANDROID
+#include <android/sysprop/BluetoothProperties.sysprop.h>
+#endif
+
 #include "btcore/include/module.h"
 #include "btcore/include/osi_module.h"
 #include "btif_api.h"
@@ -189,6 +195,60 @@ static void clean_up_stack() {
 
 static bool get_stack_is_running() { return stack_is_running; }
 
+// Whether the stack layer of each profile was initialized since the stack
+// started. Accessed on the management thread until the main thread starts, and
+// on the main thread after.
+static std::array<bool, STACK_PROFILE_MAX> profile_initialized;
+
+static bool is_profile_enabled_by_product(stack_profile_t profile) {
+#ifdef OS_ANDROID
+  using android::sysprop::BluetoothProperties;
+  switch (profile) {
+    case STACK_PROFILE_PAN:
+      return BluetoothProperties::isProfilePanNapEnabled().value_or(true) ||
+             BluetoothProperties::isProfilePanPanuEnabled().value_or(true);
+    case STACK_PROFILE_HID_HOST:
+      return BluetoothProperties::isProfileHidHostEnabled().value_or(true);
+    case STACK_PROFILE_A2DP:
+      return BluetoothProperties::isProfileA2dpSourceEnabled().value_or(true) ||
+             BluetoothProperties::isProfileA2dpSinkEnabled().value_or(true);
+    default:
+      break;
+  }
+#endif
+  return true;
+}
+
+static void init_profile(stack_profile_t profile) {
+  if (profile_initialized[profile]) return;
+  profile_initialized[profile] = true;
+
+  switch (profile) {
+    case STACK_PROFILE_PAN:
+#if (BNEP_INCLUDED == TRUE)
+      BNEP_Init();
+#if (PAN_INCLUDED == TRUE)
+      PAN_Init();
+#endif /* PAN */
+#endif /* BNEP Included */
+      break;
+    case STACK_PROFILE_HID_HOST:
+#if (HID_HOST_INCLUDED == TRUE)
+      HID_HostInit();
+#endif
+      break;
+    case STACK_PROFILE_A2DP:
+      A2DP_Init();
+      break;
+    default:
+      break;
+  }
+}
+
+void stack_manager_init_profile(stack_profile_t profile) {
+  do_in_main_thread(FROM_HERE, base::Bind(&init_profile, profile));
+}
+
 // Internal functions
 extern const module_t bt_utils_module;
 extern const module_t bte_logmsg_module;
@@ -297,18 +357,15 @@ static void event_start_up_stack(UNUSED_ATTR void* context) {
   get_btm_client_interface().lifecycle.btm_ble_init();
 
   RFCOMM_Init();
-#if (BNEP_INCLUDED == TRUE)
-  BNEP_Init();
-#if (PAN_INCLUDED == TRUE)
-  PAN_Init();
-#endif /* PAN */
-#endif /* BNEP Included */
-  A2DP_Init();
+  // The profiles the product does not enable are initialized on first use
+  profile_initialized.fill(false);
+  for (int profile = 0; profile < STACK_PROFILE_MAX; profile++) {
+    if (is_profile_enabled_by_product((stack_profile_t)profile)) {
+      init_profile((stack_profile_t)profile);
+    }
+  }
   AVRC_Init();
   GAP_Init();
-#if (HID_HOST_INCLUDED == TRUE)
-  HID_HostInit();
-#endif
 
   bta_sys_init();
   bta_ar_init();
@@ -0,0 +1,316 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "btif/include/btif_a2dp_sink_jitter_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMaxQueueLength = 28;
+constexpr uint64_t kDecodeTickUs = 20000;
+constexpr uint32_t kSampleRate = 44100;
+// 20 ms of audio in each packet
+constexpr size_t kPacketFrames = 882;
+constexpr uint64_t kPacketDurationUs = 20000;
+
+// Interleaved stereo 16 bit audio of |frames| frames: a 1 kHz tone, or
+// silence
+std::vector<int16_t> MakeAudio(size_t frames, bool silent) {
+  std::vector<int16_t> pcm(2 * frames);
+  for (size_t i = 0; i < frames; i++) {
+    double v = silent ? 0 : 0.5 * std::sin(2 * M_PI * 1000.0 * i / kSampleRate);
+    pcm[2 * i] = (int16_t)std::lrint(v * 32767);
+    pcm[2 * i + 1] = (int16_t)std::lrint(-v * 32767);
+  }
+  return pcm;
+}
+
+// Plays the stream of the packets received at the times of |arrival_us| with
+// the A2DP Sink decode loop, and a receive queue of encoded packets.
+class JitterBufferSimulation {
+ public:
+  explicit JitterBufferSimulation(std::vector<uint64_t> arrival_us)
+      : jitter_buffer_(kMaxQueueLength, kDecodeTickUs),
+        arrival_us_(std::move(arrival_us)),
+        packet_(MakeAudio(kPacketFrames, false)) {
+    jitter_buffer_.Configure(kSampleRate, 16, 2);
+  }
+
+  // Runs the simulation until |end_us|
+  void Run(uint64_t end_us) {
+    for (; now_us_ < end_us; now_us_ += 1000) {
+      for (; next_ < arrival_us_.size() && arrival_us_[next_] <= now_us_;
+           next_++) {
+        jitter_buffer_.OnPacketReceived(now_us_);
+        if (queue_length_ == kMaxQueueLength) {
+          jitter_buffer_.OnPacketDropped();
+          queue_length_--;
+        }
+        queue_length_++;
+        // The decoding starts with the fifth packet
+        if (!decoding_ && queue_length_ == 5) {
+          decoding_ = true;
+          jitter_buffer_.Restart(now_us_);
+          next_tick_us_ = now_us_ + kDecodeTickUs;
+        }
+      }
+      if (decoding_ && now_us_ >= next_tick_us_) {
+        next_tick_us_ += kDecodeTickUs;
+        Tick();
+        max_queue_length_ = std::max(max_queue_length_, queue_length_);
+      }
+    }
+  }
+
+  BtifA2dpSinkJitterBuffer jitter_buffer_;
+  size_t queue_length_ = 0;
+  size_t max_queue_length_ = 0;
+
+ private:
+  void Tick() {
+    jitter_buffer_.OnDecodeTick(now_us_);
+    while (jitter_buffer_.ShouldDecodePacket(queue_length_)) {
+      queue_length_--;
+      const uint8_t* output;
+      jitter_buffer_.ProcessAudio((const uint8_t*)packet_.data(),
+                                  packet_.size() * sizeof(int16_t), &output);
+      jitter_buffer_.OnPacketDecoded();
+    }
+  }
+
+  const std::vector<uint64_t> arrival_us_;
+  const std::vector<int16_t> packet_;
+  size_t next_ = 0;
+  uint64_t now_us_ = 0;
+  uint64_t next_tick_us_ = 0;
+  bool decoding_ = false;
+};
+
+// Arrival times of the packets sent every |interval_us| from |first_us|, in
+// bursts of |burst| packets
+std::vector<uint64_t> MakeArrivals(uint64_t first_us, double interval_us,
+                                   size_t burst, uint64_t end_us) {
+  std::vector<uint64_t> arrival_us;
+  for (size_t i = 0;; i++) {
+    uint64_t sent_us = first_us + std::llrint((i / burst) * burst * interval_us);
+    if (sent_us >= end_us) break;
+    arrival_us.push_back(sent_us);
+  }
+  return arrival_us;
+}
+
+}  // namespace
+
+TEST(BtifA2dpSinkJitterBufferTest, steady_stream_keeps_minimum_depth) {
+  JitterBufferSimulation simulation(
+      MakeArrivals(7000, kPacketDurationUs, 1, 10000000));
+  simulation.Run(10000000);
+
+  BtifA2dpSinkJitterBuffer& jitter_buffer = simulation.jitter_buffer_;
+  EXPECT_EQ(jitter_buffer.GetMeanArrivalIntervalUs(), kPacketDurationUs);
+  EXPECT_EQ(jitter_buffer.GetArrivalJitterUs(), 0u);
+  EXPECT_EQ(jitter_buffer.GetPacketDurationUs(), kPacketDurationUs);
+  EXPECT_EQ(jitter_buffer.GetTargetDepthUs(),
+            BtifA2dpSinkJitterBuffer::kMinTargetDepthUs);
+
+  const BtifA2dpSinkJitterBuffer::Stats& stats = jitter_buffer.GetStats();
+  EXPECT_EQ(stats.packets_received, 500u);
+  EXPECT_EQ(stats.packets_dropped, 0u);
+  EXPECT_EQ(stats.underruns, 0u);
+  EXPECT_EQ(stats.overruns, 0u);
+  // The initial excess of the five packets is played faster
+  EXPECT_GT(stats.compressed_frames, 0u);
+  EXPECT_EQ(stats.stretched_frames, 0u);
+  EXPECT_LE(simulation.queue_length_ * kPacketDurationUs,
+            jitter_buffer.GetTargetDepthUs() + kPacketDurationUs);
+}
+
+TEST(BtifA2dpSinkJitterBufferTest, bursts_raise_target_depth) {
+  // Five packets every 100 ms, e.g. with Wi-Fi coexistence
+  JitterBufferSimulation simulation(
+      MakeArrivals(7000, kPacketDurationUs, 5, 20000000));
+  simulation.Run(2000000);
+  BtifA2dpSinkJitterBuffer& jitter_buffer = simulation.jitter_buffer_;
+  EXPECT_NEAR(jitter_buffer.GetPeakArrivalIntervalUs(), 100000u, 2000u);
+  EXPECT_GE(jitter_buffer.GetTargetDepthUs(), 110000u);
+  EXPECT_LE(jitter_buffer.GetTargetDepthUs(), 150000u);
+  EXPECT_GT(jitter_buffer.GetArrivalJitterUs(), 30000u);
+
+  size_t underruns = jitter_buffer.GetStats().underruns;
+  simulation.Run(20000000);
+  const BtifA2dpSinkJitterBuffer::Stats& stats = jitter_buffer.GetStats();
+  EXPECT_EQ(stats.underruns, underruns);
+  EXPECT_EQ(stats.packets_dropped, 0u);
+}
+
+TEST(BtifA2dpSinkJitterBufferTest, follows_clock_drift) {
+  // The sender clock is 1% faster: the audio is played faster
+  JitterBufferSimulation fast(
+      MakeArrivals(7000, kPacketDurationUs * 0.99, 1, 60000000));
+  fast.Run(60000000);
+  EXPECT_EQ(fast.jitter_buffer_.GetStats().packets_dropped, 0u);
+  EXPECT_EQ(fast.jitter_buffer_.GetStats().overruns, 0u);
+  EXPECT_GT(fast.jitter_buffer_.GetStats().compressed_frames,
+            kSampleRate * 60 / 100);
+  EXPECT_LE(fast.max_queue_length_, 6u);
+
+  // The sender clock is 1% slower: the audio is played slower
+  JitterBufferSimulation slow(
+      MakeArrivals(7000, kPacketDurationUs * 1.01, 1, 60000000));
+  slow.Run(60000000);
+  EXPECT_EQ(slow.jitter_buffer_.GetStats().underruns, 0u);
+  EXPECT_GT(slow.jitter_buffer_.GetStats().stretched_frames,
+            kSampleRate * 60 / 100 / 2);
+}
+
+TEST(BtifA2dpSinkJitterBufferTest, rebuffers_after_underrun) {
+  // The stream stops for 500 ms
+  std::vector<uint64_t> arrival_us =
+      MakeArrivals(7000, kPacketDurationUs, 1, 2000000);
+  std::vector<uint64_t> resumed_us =
+      MakeArrivals(2500000, kPacketDurationUs, 1, 4000000);
+  arrival_us.insert(arrival_us.end(), resumed_us.begin(), resumed_us.end());
+
+  JitterBufferSimulation simulation(arrival_us);
+  simulation.Run(2400000);
+  BtifA2dpSinkJitterBuffer& jitter_buffer = simulation.jitter_buffer_;
+  EXPECT_EQ(jitter_buffer.GetStats().underruns, 1u);
+  EXPECT_EQ(simulation.queue_length_, 0u);
+
+  // The decoding waits for the target depth
+  size_t decoded = jitter_buffer.GetStats().packets_decoded;
+  simulation.Run(2500000 + 10000);
+  EXPECT_EQ(jitter_buffer.GetStats().packets_decoded, decoded);
+  EXPECT_EQ(jitter_buffer.GetTargetDepthUs(),
+            BtifA2dpSinkJitterBuffer::kMinTargetDepthUs);
+}
+
+TEST(BtifA2dpSinkJitterBufferTest, decodes_ahead_of_time_when_almost_full) {
+  BtifA2dpSinkJitterBuffer jitter_buffer(kMaxQueueLength, kDecodeTickUs);
+  jitter_buffer.Configure(kSampleRate, 16, 2);
+  EXPECT_FALSE(jitter_buffer.IsOverrun(20));
+  EXPECT_TRUE(jitter_buffer.IsOverrun(21));
+
+  std::vector<int16_t> tone = MakeAudio(kPacketFrames, false);
+  std::vector<int16_t> silence = MakeAudio(kPacketFrames, true);
+  const uint8_t* output;
+  jitter_buffer.Restart(0);
+  jitter_buffer.OnDecodeTick(kDecodeTickUs);
+  ASSERT_TRUE(jitter_buffer.ShouldDecodePacket(21));
+  jitter_buffer.ProcessAudio((const uint8_t*)tone.data(), 4 * kPacketFrames,
+                             &output);
+  jitter_buffer.OnPacketDecoded();
+
+  // The credit of the tick is spent, but the queue is almost full: the
+  // silence is dropped
+  ASSERT_TRUE(jitter_buffer.ShouldDecodePacket(21));
+  EXPECT_EQ(jitter_buffer.ProcessAudio((const uint8_t*)silence.data(),
+                                       4 * kPacketFrames, &output),
+            0u);
+  jitter_buffer.OnPacketDecoded();
+  EXPECT_FALSE(jitter_buffer.ShouldDecodePacket(20));
+  EXPECT_EQ(jitter_buffer.GetStats().overruns, 1u);
+  EXPECT_EQ(jitter_buffer.GetStats().silence_dropped_frames, kPacketFrames);
+}
+
+TEST(BtifA2dpSinkJitterBufferTest, time_stretching_is_continuous) {
+  BtifA2dpSinkJitterBuffer jitter_buffer(kMaxQueueLength, kDecodeTickUs);
+  jitter_buffer.Configure(kSampleRate, 16, 2);
+  std::vector<int16_t> tone = MakeAudio(kPacketFrames, false);
+  std::vector<int16_t> silence = MakeAudio(kPacketFrames, true);
+  const size_t overlap =
+      kPacketFrames / BtifA2dpSinkJitterBuffer::kOverlapDivisor;
+  // One period of the 1 kHz tone
+  const size_t shift = 44;
+  const uint8_t* output;
+
+  // A gap of 100 ms between two packets sets the target depth
+  jitter_buffer.OnPacketReceived(1000);
+  jitter_buffer.OnPacketReceived(101000);
+  ASSERT_EQ(jitter_buffer.GetTargetDepthUs(), 120000u);
+
+  // Learns the packet duration
+  jitter_buffer.Restart(0);
+  jitter_buffer.OnDecodeTick(kDecodeTickUs);
+  ASSERT_TRUE(jitter_buffer.ShouldDecodePacket(2));
+  ASSERT_EQ(jitter_buffer.ProcessAudio((const uint8_t*)tone.data(),
+                                       4 * kPacketFrames, &output),
+            4 * kPacketFrames);
+  EXPECT_EQ(output, (const uint8_t*)tone.data());
+  jitter_buffer.OnPacketDecoded();
+
+  // A deep queue is compressed
+  jitter_buffer.OnDecodeTick(2 * kDecodeTickUs);
+  ASSERT_TRUE(jitter_buffer.ShouldDecodePacket(10));
+  size_t len = jitter_buffer.ProcessAudio((const uint8_t*)tone.data(),
+                                          4 * kPacketFrames, &output);
+  ASSERT_EQ(len, 4 * (kPacketFrames - shift));
+  const int16_t* out = (const int16_t*)output;
+  EXPECT_EQ(out[0], tone[0]);
+  EXPECT_EQ(out[1], tone[1]);
+  for (size_t i = 2 * overlap; i < len / 2; i++) {
+    ASSERT_EQ(out[i], tone[i + 2 * shift]);
+  }
+  // No sample jumps by more than the 1 kHz tone can
+  for (size_t i = 2; i < len / 2; i++) {
+    EXPECT_LE(std::abs(out[i] - out[i - 2]), 2400) << i;
+  }
+  jitter_buffer.OnPacketDecoded();
+  EXPECT_EQ(jitter_buffer.GetStats().compressed_frames, shift);
+
+  jitter_buffer.OnDecodeTick(3 * kDecodeTickUs);
+  ASSERT_TRUE(jitter_buffer.ShouldDecodePacket(10));
+  EXPECT_EQ(jitter_buffer.ProcessAudio((const uint8_t*)silence.data(),
+                                       4 * kPacketFrames, &output),
+            0u);
+  jitter_buffer.OnPacketDecoded();
+
+  // A shallow queue is stretched
+  jitter_buffer.OnDecodeTick(4 * kDecodeTickUs);
+  ASSERT_TRUE(jitter_buffer.ShouldDecodePacket(1));
+  len = jitter_buffer.ProcessAudio((const uint8_t*)tone.data(),
+                                   4 * kPacketFrames, &output);
+  ASSERT_EQ(len, 4 * (kPacketFrames + shift));
+  out = (const int16_t*)output;
+  for (size_t i = 0; i < 2 * shift; i++) ASSERT_EQ(out[i], tone[i]);
+  for (size_t i = 2 * (shift + overlap); i < len / 2; i++) {
+    ASSERT_EQ(out[i], tone[i - 2 * shift]);
+  }
+  for (size_t i = 2; i < len / 2; i++) {
+    EXPECT_LE(std::abs(out[i] - out[i - 2]), 2400) << i;
+  }
+  jitter_buffer.OnPacketDecoded();
+
+  jitter_buffer.OnDecodeTick(5 * kDecodeTickUs);
+  ASSERT_TRUE(jitter_buffer.ShouldDecodePacket(1));
+  EXPECT_EQ(jitter_buffer.ProcessAudio((const uint8_t*)silence.data(),
+                                       4 * kPacketFrames, &output),
+            8 * kPacketFrames);
+  jitter_buffer.OnPacketDecoded();
+
+  const BtifA2dpSinkJitterBuffer::Stats& stats = jitter_buffer.GetStats();
+  EXPECT_EQ(stats.stretched_frames, shift);
+  EXPECT_EQ(stats.silence_dropped_frames, kPacketFrames);
+  EXPECT_EQ(stats.silence_inserted_frames, kPacketFrames);
+  EXPECT_EQ(stats.packets_decoded, 5u);
+}
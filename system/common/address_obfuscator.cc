@@ -19,7 +19,6 @@
 #include "address_obfuscator.h"
 
 #include <base/logging.h>
-#include <openssl/hmac.h>
 
 #include <algorithm>
 
@@ -37,6 +36,15 @@ bool AddressObfuscator::IsSaltValid(const Octet32& salt_256bit) {
 void AddressObfuscator::Initialize(const Octet32& salt_256bit) {
   std::lock_guard<std::recursive_mutex> lock(instance_mutex_);
   salt_256bit_ = salt_256bit;
+  cache_.Clear();
+  hmac_ctx_.reset();
+  if (!IsSaltValid(salt_256bit_)) {
+    return;
+  }
+  hmac_ctx_.reset(HMAC_CTX_new());
+  CHECK(hmac_ctx_ != nullptr);
+  CHECK(HMAC_Init_ex(hmac_ctx_.get(), salt_256bit_.data(), salt_256bit_.size(),
+                     EVP_sha256(), nullptr));
 }
 
 bool AddressObfuscator::IsInitialized() {
@@ -47,13 +55,20 @@ bool AddressObfuscator::IsInitialized() {
 std::string AddressObfuscator::Obfuscate(const RawAddress& address) {
   std::lock_guard<std::recursive_mutex> lock(instance_mutex_);
   CHECK(IsInitialized());
+  const std::string* cached = cache_.Find(address);
+  if (cached != nullptr) {
+    return *cached;
+  }
   std::array<uint8_t, EVP_MAX_MD_SIZE> result = {};
   unsigned int out_len = 0;
-  CHECK(::HMAC(EVP_sha256(), salt_256bit_.data(), salt_256bit_.size(),
-               address.address, address.kLength, result.data(),
-               &out_len) != nullptr);
+  // Without a key or digest, HMAC_Init_ex() restarts from the keyed pads
+  CHECK(HMAC_Init_ex(hmac_ctx_.get(), nullptr, 0, nullptr, nullptr));
+  CHECK(HMAC_Update(hmac_ctx_.get(), address.address, address.kLength));
+  CHECK(HMAC_Final(hmac_ctx_.get(), result.data(), &out_len));
   CHECK_EQ(out_len, static_cast<unsigned int>(kOctet32Length));
-  return std::string(reinterpret_cast<const char*>(result.data()), out_len);
+  std::string obfuscated(reinterpret_cast<const char*>(result.data()), out_len);
+  cache_.Put(address, obfuscated);
+  return obfuscated;
 }
 
 }  // namespace common
@@ -18,10 +18,14 @@
 
 #pragma once
 
+#include <openssl/hmac.h>
+
 #include <array>
+#include <memory>
 #include <mutex>
 #include <string>
 
+#include "lru.h"
 #include "raw_address.h"
 
 namespace bluetooth {
@@ -30,6 +34,9 @@ namespace common {
 class AddressObfuscator {
  public:
   static constexpr unsigned int kOctet32Length = 32;
+  // Number of addresses whose obfuscated IDs are kept, above the number of
+  // devices a user connects to in a session
+  static constexpr size_t kCacheCapacity = 64;
   using Octet32 = std::array<uint8_t, kOctet32Length>;
   static AddressObfuscator* GetInstance() {
     static auto instance = new AddressObfuscator();
@@ -47,7 +54,8 @@ class AddressObfuscator {
   static bool IsSaltValid(const Octet32& salt_256bit);
 
   /**
-   * Initialize this obfuscator with necessary parameters
+   * Initialize this obfuscator with necessary parameters, dropping the IDs
+   * obfuscated with a previous salt
    *
    * @param salt_256bit a 256 bit salt used to hash the fixed length address
    */
@@ -59,7 +67,9 @@ class AddressObfuscator {
   bool IsInitialized();
 
   /**
-   * Obfuscate Bluetooth MAC address into an anonymous ID string
+   * Obfuscate Bluetooth MAC address into an anonymous ID string. The IDs of
+   * the last kCacheCapacity addresses are kept, so that the metrics logged for
+   * every connection and profile event do not compute the HMAC each time.
    *
    * @param address Bluetooth MAC address to be obfuscated
    * @return the obfuscated MAC address in 256 bit
@@ -67,8 +77,17 @@ class AddressObfuscator {
   std::string Obfuscate(const RawAddress& address);
 
  private:
-  AddressObfuscator() : salt_256bit_({0}) {}
+  struct HmacCtxDeleter {
+    void operator()(HMAC_CTX* ctx) const { HMAC_CTX_free(ctx); }
+  };
+
+  AddressObfuscator()
+      : salt_256bit_({0}), cache_(kCacheCapacity, "AddressObfuscator") {}
   Octet32 salt_256bit_;
+  // Keyed with salt_256bit_ once, so that each new address only hashes itself
+  // and not the inner and outer pads of the salt again
+  std::unique_ptr<HMAC_CTX, HmacCtxDeleter> hmac_ctx_;
+  LegacyLruCache<RawAddress, std::string> cache_;
   std::recursive_mutex instance_mutex_;
 };
 
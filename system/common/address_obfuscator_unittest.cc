@@ -120,3 +120,17 @@ TEST(AddressObfuscatorTest, test_obfuscate_address_key2_max_address) {
   EXPECT_EQ(result.size(), AddressObfuscator::kOctet32Length);
   EXPECT_EQ(result, kTestResult2_3);
 }
+
+TEST(AddressObfuscatorTest, test_obfuscate_address_cached_until_new_salt) {
+  AddressObfuscator::GetInstance()->Initialize(kTestKey1);
+  EXPECT_EQ(AddressObfuscator::GetInstance()->Obfuscate(kTestData1),
+            kTestResult1);
+  EXPECT_EQ(AddressObfuscator::GetInstance()->Obfuscate(kTestData1),
+            kTestResult1);
+  EXPECT_EQ(AddressObfuscator::GetInstance()->Obfuscate(kTestData2_1),
+            AddressObfuscator::GetInstance()->Obfuscate(kTestData2_1));
+
+  AddressObfuscator::GetInstance()->Initialize(kTestKey2);
+  EXPECT_EQ(AddressObfuscator::GetInstance()->Obfuscate(kTestData2_1),
+            kTestResult2_1);
+}
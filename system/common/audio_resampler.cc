@@ -0,0 +1,322 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "common/audio_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_RESAMPLER_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_RESAMPLER_SSE2
+#endif
+
+namespace bluetooth {
+
+namespace common {
+
+namespace {
+
+constexpr uint32_t kMaxSampleRate = 192000;
+
+// Stop band attenuation of the filter, in dB, and the matching beta parameter
+// of the Kaiser window.
+constexpr double kStopBandAttenuation = 80.0;
+constexpr double kKaiserBeta = 0.1102 * (kStopBandAttenuation - 8.7);
+
+// Zeroth order modified Bessel function of the first kind
+double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 50; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12) break;
+  }
+  return sum;
+}
+
+bool IsSupportedBitsPerSample(uint8_t bits_per_sample) {
+  return bits_per_sample == 16 || bits_per_sample == 24 ||
+         bits_per_sample == 32;
+}
+
+float LoadSample(const uint8_t* p, uint8_t bytes_per_sample) {
+  switch (bytes_per_sample) {
+    case 2: {
+      int16_t sample;
+      memcpy(&sample, p, sizeof(sample));
+      return sample * (1.0f / 32768.0f);
+    }
+    case 3: {
+      int32_t sample = p[0] | (p[1] << 8) | ((int8_t)p[2] * 65536);
+      return sample * (1.0f / 8388608.0f);
+    }
+    default: {
+      int32_t sample;
+      memcpy(&sample, p, sizeof(sample));
+      return sample * (1.0f / 2147483648.0f);
+    }
+  }
+}
+
+void StoreSample(float value, uint8_t* p, uint8_t bytes_per_sample) {
+  switch (bytes_per_sample) {
+    case 2: {
+      float scaled =
+          std::fmin(std::fmax(value * 32768.0f, -32768.0f), 32767.0f);
+      int16_t sample = (int16_t)std::lrint(scaled);
+      memcpy(p, &sample, sizeof(sample));
+      break;
+    }
+    case 3: {
+      float scaled =
+          std::fmin(std::fmax(value * 8388608.0f, -8388608.0f), 8388607.0f);
+      int32_t sample = (int32_t)std::lrint(scaled);
+      p[0] = sample;
+      p[1] = sample >> 8;
+      p[2] = sample >> 16;
+      break;
+    }
+    default: {
+      // 2^31 - 128 is the largest float below 2^31
+      float scaled = std::fmin(std::fmax(value * 2147483648.0f, -2147483648.0f),
+                               2147483520.0f);
+      int32_t sample = (int32_t)std::lrint(scaled);
+      memcpy(p, &sample, sizeof(sample));
+      break;
+    }
+  }
+}
+
+// Returns the dot product of the |n| floats of |a| and |b|. |n| is a multiple
+// of 4.
+float DotProduct(const float* a, const float* b, size_t n) {
+#if defined(AUDIO_RESAMPLER_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  if (i < n) acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+  float32x4_t acc = vaddq_f32(acc0, acc1);
+  float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+  return vget_lane_f32(vpadd_f32(sum, sum), 0);
+#elif defined(AUDIO_RESAMPLER_SSE2)
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm_add_ps(acc0,
+                      _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    acc1 = _mm_add_ps(
+        acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+  }
+  if (i < n) {
+    acc0 = _mm_add_ps(acc0,
+                      _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  __m128 acc = _mm_add_ps(acc0, acc1);
+  acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+  acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+  return _mm_cvtss_f32(acc);
+#else
+  float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (size_t i = 0; i < n; i += 4) {
+    acc[0] += a[i] * b[i];
+    acc[1] += a[i + 1] * b[i + 1];
+    acc[2] += a[i + 2] * b[i + 2];
+    acc[3] += a[i + 3] * b[i + 3];
+  }
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+}
+
+}  // namespace
+
+bool AudioResampler::Init(uint32_t in_sample_rate, uint32_t out_sample_rate,
+                          uint8_t channel_count, uint8_t in_bits_per_sample,
+                          uint8_t out_bits_per_sample,
+                          size_t max_input_frames) {
+  channel_count_ = 0;
+  if (in_sample_rate == 0 || in_sample_rate > kMaxSampleRate ||
+      out_sample_rate == 0 || out_sample_rate > kMaxSampleRate ||
+      channel_count == 0 || !IsSupportedBitsPerSample(in_bits_per_sample) ||
+      !IsSupportedBitsPerSample(out_bits_per_sample) ||
+      max_input_frames == 0) {
+    return false;
+  }
+
+  uint32_t gcd = std::gcd(in_sample_rate, out_sample_rate);
+  uint32_t phase_count = out_sample_rate / gcd;
+  uint32_t step = in_sample_rate / gcd;
+  if (phase_count > kMaxPhases) return false;
+
+  in_sample_rate_ = in_sample_rate;
+  out_sample_rate_ = out_sample_rate;
+  in_bytes_per_sample_ = in_bits_per_sample / 8;
+  out_bytes_per_sample_ = out_bits_per_sample / 8;
+  max_input_frames_ = max_input_frames;
+  phase_count_ = phase_count;
+  step_ = step;
+
+  if (in_sample_rate == out_sample_rate) {
+    // The samples are only converted
+    taps_ = 0;
+    coefficients_.clear();
+    history_.clear();
+    history_stride_ = 0;
+    channel_count_ = channel_count;
+    Reset();
+    return true;
+  }
+
+  // Cut off below the Nyquist frequency of the lower rate, so that the stop
+  // band starts there. The frequencies are in cycles per input sample.
+  size_t taps = kTapsPerPhase;
+  double nyquist = 0.5;
+  if (step > phase_count) {
+    taps = (kTapsPerPhase * step + phase_count - 1) / phase_count;
+    taps = (taps + 3) & ~(size_t)3;
+    nyquist = 0.5 * phase_count / step;
+  }
+  double transition =
+      (kStopBandAttenuation - 7.95) / (2.285 * 2.0 * M_PI * taps);
+  double cutoff = nyquist - transition / 2.0;
+
+  // The phase p computes the output at p / phase_count_ input frames after
+  // the tap taps_ / 2 - 1.
+  taps_ = taps;
+  coefficients_.assign(phase_count * taps, 0.0f);
+  double half_length = taps / 2.0;
+  double i0_beta = BesselI0(kKaiserBeta);
+  std::vector<double> phase_coefficients(taps);
+  for (uint32_t p = 0; p < phase_count; p++) {
+    double sum = 0.0;
+    for (size_t j = 0; j < taps; j++) {
+      double d = (double)j - (half_length - 1.0) - (double)p / phase_count;
+      double x = 2.0 * cutoff * d;
+      double sinc = (x == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+      double r = d / half_length;
+      double window = (r * r < 1.0)
+                          ? BesselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) /
+                                i0_beta
+                          : 0.0;
+      phase_coefficients[j] = 2.0 * cutoff * sinc * window;
+      sum += phase_coefficients[j];
+    }
+    // Unity gain at DC for every phase
+    for (size_t j = 0; j < taps; j++) {
+      coefficients_[p * taps + j] = phase_coefficients[j] / sum;
+    }
+  }
+
+  history_stride_ = taps + max_input_frames;
+  history_.assign(channel_count * history_stride_, 0.0f);
+  channel_count_ = channel_count;
+  Reset();
+  return true;
+}
+
+void AudioResampler::Reset() {
+  if (taps_ == 0) return;
+  // Start with the zeros before the first input frame, so that the first
+  // output frame is at the first input frame.
+  std::fill(history_.begin(), history_.end(), 0.0f);
+  history_frames_ = taps_ / 2 - 1;
+  position_ = 0;
+  phase_ = 0;
+}
+
+size_t AudioResampler::GetMaxOutputFrames(size_t input_frames) const {
+  if (taps_ == 0) return input_frames;
+  return (input_frames + taps_) * phase_count_ / step_ + 1;
+}
+
+void AudioResampler::LoadInput(const void* input, size_t input_frames) {
+  const uint8_t* p = static_cast<const uint8_t*>(input);
+  for (size_t i = 0; i < input_frames; i++) {
+    for (uint8_t ch = 0; ch < channel_count_; ch++) {
+      history_[ch * history_stride_ + history_frames_ + i] =
+          LoadSample(p, in_bytes_per_sample_);
+      p += in_bytes_per_sample_;
+    }
+  }
+  history_frames_ += input_frames;
+}
+
+size_t AudioResampler::Resample(const void* input, size_t input_frames,
+                                void* output) {
+  if (!IsConfigured() || input_frames > max_input_frames_) return 0;
+
+  uint8_t* out = static_cast<uint8_t*>(output);
+  if (taps_ == 0) {
+    size_t samples = input_frames * channel_count_;
+    if (in_bytes_per_sample_ == out_bytes_per_sample_) {
+      memcpy(out, input, samples * in_bytes_per_sample_);
+      return input_frames;
+    }
+    const uint8_t* in = static_cast<const uint8_t*>(input);
+    for (size_t i = 0; i < samples; i++) {
+      StoreSample(LoadSample(in, in_bytes_per_sample_), out,
+                  out_bytes_per_sample_);
+      in += in_bytes_per_sample_;
+      out += out_bytes_per_sample_;
+    }
+    return input_frames;
+  }
+
+  LoadInput(input, input_frames);
+
+  size_t output_frames = 0;
+  while (position_ + taps_ <= history_frames_) {
+    const float* coefficients = &coefficients_[phase_ * taps_];
+    for (uint8_t ch = 0; ch < channel_count_; ch++) {
+      const float* samples = &history_[ch * history_stride_ + position_];
+      StoreSample(DotProduct(samples, coefficients, taps_), out,
+                  out_bytes_per_sample_);
+      out += out_bytes_per_sample_;
+    }
+    output_frames++;
+
+    phase_ += step_;
+    position_ += phase_ / phase_count_;
+    phase_ %= phase_count_;
+  }
+
+  // Keep the frames still needed by the next output frames
+  size_t kept_frames = history_frames_ - position_;
+  for (uint8_t ch = 0; ch < channel_count_; ch++) {
+    float* samples = &history_[ch * history_stride_];
+    memmove(samples, samples + position_, kept_frames * sizeof(float));
+  }
+  history_frames_ = kept_frames;
+  position_ = 0;
+  return output_frames;
+}
+
+}  // namespace common
+
+}  // namespace bluetooth
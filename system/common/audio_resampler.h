@@ -0,0 +1,107 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bluetooth {
+
+namespace common {
+
+// Converts a stream of interleaved PCM samples from one sampling rate to
+// another, e.g. 44.1 kHz <-> 48 kHz, with a polyphase windowed sinc filter.
+//
+// The input and output samples are signed 16 bit, packed 24 bit or 32 bit
+// little endian integers, and may have different sizes. The filter runs on
+// floats, with NEON or SSE2 when available. All the memory is allocated by
+// Init(), so that Resample() can be called from the audio threads.
+class AudioResampler {
+ public:
+  // Number of filter taps of each output phase when up-sampling. The filter
+  // is longer when down-sampling, to keep the same transition band at the
+  // output rate.
+  static constexpr size_t kTapsPerPhase = 64;
+  // Largest number of output phases, i.e. of the output rate divided by the
+  // greatest common divisor of the two rates.
+  static constexpr uint32_t kMaxPhases = 1280;
+
+  AudioResampler() = default;
+  AudioResampler(const AudioResampler&) = delete;
+  AudioResampler& operator=(const AudioResampler&) = delete;
+
+  // Configures the conversion of |channel_count| channels of
+  // |in_bits_per_sample| samples at |in_sample_rate| into
+  // |out_bits_per_sample| samples at |out_sample_rate|, for calls of
+  // Resample() with at most |max_input_frames| frames.
+  // Returns false if the parameters are not supported.
+  bool Init(uint32_t in_sample_rate, uint32_t out_sample_rate,
+            uint8_t channel_count, uint8_t in_bits_per_sample,
+            uint8_t out_bits_per_sample, size_t max_input_frames);
+
+  // Drops the samples kept from the previous calls of Resample(), e.g. when
+  // the stream is flushed.
+  void Reset();
+
+  // Returns the largest number of frames produced by Resample() from
+  // |input_frames| frames.
+  size_t GetMaxOutputFrames(size_t input_frames) const;
+
+  // Converts the |input_frames| frames of |input| into |output|, which must
+  // hold GetMaxOutputFrames(|input_frames|) frames. The output is delayed by
+  // half the filter length: the last input frames are kept for the next call.
+  // Returns the number of frames written to |output|.
+  size_t Resample(const void* input, size_t input_frames, void* output);
+
+  bool IsConfigured() const { return channel_count_ != 0; }
+  uint32_t GetInputSampleRate() const { return in_sample_rate_; }
+  uint32_t GetOutputSampleRate() const { return out_sample_rate_; }
+
+ private:
+  void LoadInput(const void* input, size_t input_frames);
+
+  uint32_t in_sample_rate_ = 0;
+  uint32_t out_sample_rate_ = 0;
+  uint8_t channel_count_ = 0;
+  uint8_t in_bytes_per_sample_ = 0;
+  uint8_t out_bytes_per_sample_ = 0;
+  size_t max_input_frames_ = 0;
+
+  // The output frame k is computed at the input position k * step_ /
+  // phase_count_, from the taps_ input frames around it.
+  uint32_t phase_count_ = 0;
+  uint32_t step_ = 0;
+  size_t taps_ = 0;
+  // taps_ coefficients for each of the phase_count_ phases
+  std::vector<float> coefficients_;
+
+  // Input of each channel, converted to floats. The first history_frames_
+  // frames are kept from the previous calls.
+  std::vector<float> history_;
+  size_t history_stride_ = 0;
+  size_t history_frames_ = 0;
+  // First input frame and phase of the next output frame
+  size_t position_ = 0;
+  uint32_t phase_ = 0;
+};
+
+}  // namespace common
+
+}  // namespace bluetooth
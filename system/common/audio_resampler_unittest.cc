@@ -0,0 +1,223 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "common/audio_resampler.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using bluetooth::common::AudioResampler;
+
+namespace {
+
+// Interleaved stereo 16 bit sine, with the right channel in phase opposition
+std::vector<int16_t> MakeStereoSine(uint32_t sample_rate, double frequency,
+                                    double amplitude, size_t frames) {
+  std::vector<int16_t> pcm(2 * frames);
+  for (size_t i = 0; i < frames; i++) {
+    double v = amplitude * std::sin(2.0 * M_PI * frequency * i / sample_rate);
+    pcm[2 * i] = (int16_t)std::lrint(v * 32767.0);
+    pcm[2 * i + 1] = (int16_t)std::lrint(-v * 32767.0);
+  }
+  return pcm;
+}
+
+// Resamples |input| in chunks of |chunk_frames| stereo frames
+std::vector<int16_t> ResampleStereo(AudioResampler& resampler,
+                                    const std::vector<int16_t>& input,
+                                    size_t chunk_frames) {
+  std::vector<int16_t> output;
+  std::vector<int16_t> buffer(2 * resampler.GetMaxOutputFrames(chunk_frames));
+  size_t frames = input.size() / 2;
+  for (size_t i = 0; i < frames; i += chunk_frames) {
+    size_t n = std::min(chunk_frames, frames - i);
+    size_t out_frames = resampler.Resample(&input[2 * i], n, buffer.data());
+    EXPECT_LE(out_frames, resampler.GetMaxOutputFrames(n));
+    output.insert(output.end(), buffer.begin(),
+                  buffer.begin() + 2 * out_frames);
+  }
+  return output;
+}
+
+// Returns the ratio in dB of the power of the |channel| of the |pcm| stereo
+// frames, to the power of their difference with the expected sine. The
+// frames at both ends are skipped.
+double SignalToNoiseRatio(const std::vector<int16_t>& pcm, int channel,
+                          uint32_t sample_rate, double frequency,
+                          double amplitude) {
+  double signal = 0.0;
+  double noise = 0.0;
+  size_t frames = pcm.size() / 2;
+  for (size_t i = 256; i + 256 < frames; i++) {
+    double v = amplitude * std::sin(2.0 * M_PI * frequency * i / sample_rate);
+    if (channel == 1) v = -v;
+    double e = pcm[2 * i + channel] / 32767.0 - v;
+    signal += v * v;
+    noise += e * e;
+  }
+  return 10.0 * std::log10(signal / noise);
+}
+
+double Rms(const std::vector<int16_t>& pcm) {
+  double sum = 0.0;
+  for (size_t i = 512; i + 512 < pcm.size(); i++) {
+    sum += (pcm[i] / 32768.0) * (pcm[i] / 32768.0);
+  }
+  return std::sqrt(sum / (pcm.size() - 1024));
+}
+
+}  // namespace
+
+TEST(AudioResamplerTest, init_rejects_unsupported_parameters) {
+  AudioResampler resampler;
+  EXPECT_FALSE(resampler.IsConfigured());
+  EXPECT_FALSE(resampler.Init(0, 48000, 2, 16, 16, 512));
+  EXPECT_FALSE(resampler.Init(44100, 384000, 2, 16, 16, 512));
+  EXPECT_FALSE(resampler.Init(44100, 48000, 0, 16, 16, 512));
+  EXPECT_FALSE(resampler.Init(44100, 48000, 2, 8, 16, 512));
+  EXPECT_FALSE(resampler.Init(44100, 48000, 2, 16, 20, 512));
+  EXPECT_FALSE(resampler.Init(44100, 48000, 2, 16, 16, 0));
+  // 48000 / gcd(44099, 48000) phases
+  EXPECT_FALSE(resampler.Init(44099, 48000, 2, 16, 16, 512));
+  EXPECT_FALSE(resampler.IsConfigured());
+
+  int16_t pcm[4] = {};
+  EXPECT_EQ(resampler.Resample(pcm, 2, pcm), 0u);
+
+  EXPECT_TRUE(resampler.Init(44100, 48000, 2, 16, 16, 512));
+  EXPECT_TRUE(resampler.IsConfigured());
+  EXPECT_EQ(resampler.GetInputSampleRate(), 44100u);
+  EXPECT_EQ(resampler.GetOutputSampleRate(), 48000u);
+  EXPECT_EQ(resampler.Resample(pcm, 513, pcm), 0u);
+}
+
+TEST(AudioResamplerTest, same_rate_converts_samples) {
+  AudioResampler resampler;
+  ASSERT_TRUE(resampler.Init(48000, 48000, 2, 16, 16, 4));
+  int16_t in16[4] = {0, -32768, 32767, 1234};
+  int16_t out16[4] = {};
+  ASSERT_EQ(resampler.GetMaxOutputFrames(2), 2u);
+  ASSERT_EQ(resampler.Resample(in16, 2, out16), 2u);
+  for (int i = 0; i < 4; i++) EXPECT_EQ(out16[i], in16[i]);
+
+  ASSERT_TRUE(resampler.Init(48000, 48000, 2, 16, 32, 4));
+  int32_t out32[4] = {};
+  ASSERT_EQ(resampler.Resample(in16, 2, out32), 2u);
+  for (int i = 0; i < 4; i++) EXPECT_EQ(out32[i], in16[i] * 65536);
+
+  // Packed 24 bit samples, rounded and saturated to 16 bit
+  ASSERT_TRUE(resampler.Init(48000, 48000, 1, 24, 16, 4));
+  uint8_t in24[9] = {0xc0, 0x00, 0x00, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x80};
+  ASSERT_EQ(resampler.Resample(in24, 3, out16), 3u);
+  EXPECT_EQ(out16[0], 1);
+  EXPECT_EQ(out16[1], 32767);
+  EXPECT_EQ(out16[2], -32768);
+}
+
+TEST(AudioResamplerTest, up_sample_44100_to_48000) {
+  AudioResampler resampler;
+  ASSERT_TRUE(resampler.Init(44100, 48000, 2, 16, 16, 441));
+  std::vector<int16_t> input = MakeStereoSine(44100, 1000.0, 0.5, 44100);
+  std::vector<int16_t> output = ResampleStereo(resampler, input, 441);
+
+  // All the input but the last half filter length is converted
+  size_t frames = output.size() / 2;
+  EXPECT_LE(frames, 48000u);
+  EXPECT_GE(frames, 48000u - AudioResampler::kTapsPerPhase);
+  EXPECT_GT(SignalToNoiseRatio(output, 0, 48000, 1000.0, 0.5), 70.0);
+  EXPECT_GT(SignalToNoiseRatio(output, 1, 48000, 1000.0, 0.5), 70.0);
+}
+
+TEST(AudioResamplerTest, down_sample_48000_to_44100) {
+  AudioResampler resampler;
+  ASSERT_TRUE(resampler.Init(48000, 44100, 2, 16, 16, 480));
+  std::vector<int16_t> input = MakeStereoSine(48000, 10000.0, 0.5, 48000);
+  std::vector<int16_t> output = ResampleStereo(resampler, input, 480);
+
+  size_t frames = output.size() / 2;
+  EXPECT_LE(frames, 44100u);
+  EXPECT_GE(frames, 44100u - AudioResampler::kTapsPerPhase);
+  EXPECT_GT(SignalToNoiseRatio(output, 0, 44100, 10000.0, 0.5), 70.0);
+  EXPECT_GT(SignalToNoiseRatio(output, 1, 44100, 10000.0, 0.5), 70.0);
+}
+
+TEST(AudioResamplerTest, down_sample_rejects_aliases) {
+  AudioResampler resampler;
+  ASSERT_TRUE(resampler.Init(48000, 44100, 2, 16, 16, 480));
+  // Above the output Nyquist frequency: an alias at 21.1 kHz without filter
+  std::vector<int16_t> input = MakeStereoSine(48000, 23000.0, 0.5, 48000);
+  std::vector<int16_t> output = ResampleStereo(resampler, input, 480);
+  EXPECT_LT(20.0 * std::log10(Rms(output) / Rms(input)), -70.0);
+
+  // 48 kHz to 16 kHz, e.g. for hearing aids
+  ASSERT_TRUE(resampler.Init(48000, 16000, 2, 16, 16, 480));
+  input = MakeStereoSine(48000, 12000.0, 0.5, 48000);
+  output = ResampleStereo(resampler, input, 480);
+  EXPECT_LT(20.0 * std::log10(Rms(output) / Rms(input)), -70.0);
+}
+
+TEST(AudioResamplerTest, output_does_not_depend_on_chunks) {
+  AudioResampler resampler;
+  std::vector<int16_t> input = MakeStereoSine(44100, 3000.0, 0.8, 4410);
+
+  ASSERT_TRUE(resampler.Init(44100, 48000, 2, 16, 16, 4410));
+  std::vector<int16_t> single = ResampleStereo(resampler, input, 4410);
+
+  ASSERT_TRUE(resampler.Init(44100, 48000, 2, 16, 16, 4410));
+  std::vector<int16_t> chunked = ResampleStereo(resampler, input, 7);
+  EXPECT_EQ(single, chunked);
+
+  // Reset() restarts the stream
+  resampler.Reset();
+  std::vector<int16_t> restarted = ResampleStereo(resampler, input, 128);
+  EXPECT_EQ(single, restarted);
+}
+
+TEST(AudioResamplerTest, resample_24_bit_packed) {
+  AudioResampler resampler;
+  ASSERT_TRUE(resampler.Init(48000, 44100, 1, 24, 24, 480));
+
+  std::vector<uint8_t> input(3 * 48000);
+  for (size_t i = 0; i < 48000; i++) {
+    double v = 0.5 * std::sin(2.0 * M_PI * 1000.0 * i / 48000);
+    int32_t sample = (int32_t)std::lrint(v * 8388607.0);
+    input[3 * i] = sample;
+    input[3 * i + 1] = sample >> 8;
+    input[3 * i + 2] = sample >> 16;
+  }
+
+  std::vector<uint8_t> output(3 * resampler.GetMaxOutputFrames(480));
+  double signal = 0.0;
+  double noise = 0.0;
+  size_t n = 0;
+  for (size_t i = 0; i < 48000; i += 480) {
+    size_t frames = resampler.Resample(&input[3 * i], 480, output.data());
+    for (size_t k = 0; k < frames; k++, n++) {
+      const uint8_t* p = &output[3 * k];
+      int32_t sample = p[0] | (p[1] << 8) | ((int8_t)p[2] * 65536);
+      if (n < 256) continue;
+      double v = 0.5 * std::sin(2.0 * M_PI * 1000.0 * n / 44100);
+      double e = sample / 8388607.0 - v;
+      signal += v * v;
+      noise += e * e;
+    }
+  }
+  EXPECT_GT(10.0 * std::log10(signal / noise), 70.0);
+}
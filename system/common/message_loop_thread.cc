@@ -18,19 +18,27 @@
 
 #include <sys/syscall.h>
 #include <unistd.h>
+#include <algorithm>
 #include <thread>
 
 #include <base/logging.h>
 #include <base/strings/stringprintf.h>
 
 #include "gd/common/init_flags.h"
+#include "gd/common/inline_closure.h"
+#include "gd/os/alarm.h"
+#include "gd/os/handler.h"
+#include "gd/os/handler_stats.h"
+#include "gd/os/thread.h"
 #include "osi/include/log.h"
 
 namespace bluetooth {
 
 namespace common {
 
-static constexpr int kRealTimeFifoSchedulingPriority = 1;
+// How long ShutDown() waits for the task running on the Gd thread, if any
+static constexpr std::chrono::milliseconds kSharedShutDownTimeout =
+    std::chrono::milliseconds(2000);
 
 MessageLoopThread::MessageLoopThread(const std::string& thread_name)
     : MessageLoopThread(thread_name, false) {}
@@ -46,6 +54,9 @@ MessageLoopThread::MessageLoopThread(const std::string& thread_name,
       weak_ptr_factory_(this),
       shutting_down_(false),
       is_main_(is_main),
+      shared_handler_(nullptr),
+      shared_alarm_(nullptr),
+      shared_tasks_pending_(0),
       rust_thread_(nullptr) {}
 
 MessageLoopThread::~MessageLoopThread() { ShutDown(); }
@@ -65,7 +76,7 @@ void MessageLoopThread::StartUp() {
   std::future<void> start_up_future = start_up_promise.get_future();
   {
     std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
-    if (thread_ != nullptr) {
+    if (thread_ != nullptr || shared_handler_ != nullptr) {
       LOG(WARNING) << __func__ << ": thread " << *this << " is already started";
 
       return;
@@ -76,16 +87,98 @@ void MessageLoopThread::StartUp() {
   start_up_future.wait();
 }
 
+void MessageLoopThread::StartUpOn(os::Thread* thread) {
+  std::promise<void> start_up_promise;
+  std::future<void> start_up_future = start_up_promise.get_future();
+  {
+    std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+    if (thread_ != nullptr || shared_handler_ != nullptr) {
+      LOG(WARNING) << __func__ << ": thread " << *this << " is already started";
+      return;
+    }
+    shared_handler_ = new os::Handler(thread, thread_name_);
+    shared_alarm_ = new os::Alarm(shared_handler_);
+    shared_tasks_pending_ = 0;
+    shared_handler_->Post(base::BindOnce(&MessageLoopThread::RunOnSharedThread,
+                                         base::Unretained(this),
+                                         std::move(start_up_promise)));
+  }
+  start_up_future.wait();
+}
+
+void MessageLoopThread::RunOnSharedThread(std::promise<void> start_up_promise) {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  thread_id_ = base::PlatformThread::CurrentId();
+  linux_tid_ = static_cast<pid_t>(syscall(SYS_gettid));
+  LOG(INFO) << __func__ << ": thread " << thread_name_ << " runs on "
+            << base::PlatformThread::GetName();
+  start_up_promise.set_value();
+}
+
 bool MessageLoopThread::DoInThread(const base::Location& from_here,
                                    base::OnceClosure task) {
   return DoInThreadDelayed(from_here, std::move(task), base::TimeDelta());
 }
 
+bool MessageLoopThread::DoInThreadOrRun(const base::Location& from_here,
+                                        base::OnceClosure task) {
+  {
+    std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+    if (shared_handler_ == nullptr ||
+        thread_id_ != base::PlatformThread::CurrentId() ||
+        shared_tasks_pending_ != 0) {
+      return DoInThread(from_here, std::move(task));
+    }
+    // Tasks posted from |task| queue up behind it
+    shared_tasks_pending_++;
+  }
+  std::move(task).Run();
+  shared_tasks_pending_--;
+  return true;
+}
+
+void MessageLoopThread::PostShared(base::OnceClosure task) {
+  shared_tasks_pending_++;
+  shared_handler_->Post(
+      common::InlineClosure([this, task = std::move(task)]() mutable {
+        std::move(task).Run();
+        shared_tasks_pending_--;
+      }));
+}
+
+void MessageLoopThread::ScheduleSharedAlarm() {
+  auto delay = std::chrono::ceil<std::chrono::milliseconds>(
+      shared_delayed_tasks_.begin()->first - std::chrono::steady_clock::now());
+  // A zero delay would leave the alarm disarmed
+  shared_alarm_->Schedule(
+      base::BindOnce(&MessageLoopThread::PostDueSharedTasks,
+                     base::Unretained(this)),
+      std::max(delay, std::chrono::milliseconds(1)));
+}
+
+void MessageLoopThread::PostDueSharedTasks() {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  if (shared_alarm_ == nullptr) {
+    return;
+  }
+  // Tasks due at the same time keep the order they were posted in
+  auto due_end =
+      shared_delayed_tasks_.upper_bound(std::chrono::steady_clock::now());
+  for (auto it = shared_delayed_tasks_.begin(); it != due_end; ++it) {
+    PostShared(std::move(it->second));
+  }
+  shared_delayed_tasks_.erase(shared_delayed_tasks_.begin(), due_end);
+  if (!shared_delayed_tasks_.empty()) {
+    ScheduleSharedAlarm();
+  }
+}
+
 bool MessageLoopThread::DoInThreadDelayed(const base::Location& from_here,
                                           base::OnceClosure task,
                                           const base::TimeDelta& delay) {
   std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
-  if (is_main_ && init_flags::gd_rust_is_enabled()) {
+  if (is_main_ &&
+      InitFlags::IsEnabledCached<init_flags::gd_rust_is_enabled>()) {
     if (rust_thread_ == nullptr) {
       LOG(ERROR) << __func__ << ": rust thread is null for thread " << *this
                  << ", from " << from_here.ToString();
@@ -99,11 +192,31 @@ bool MessageLoopThread::DoInThreadDelayed(const base::Location& from_here,
     return true;
   }
 
-  if (message_loop_ == nullptr) {
+  if (message_loop_ == nullptr && shared_handler_ == nullptr) {
     LOG(ERROR) << __func__ << ": message loop is null for thread " << *this
                << ", from " << from_here.ToString();
     return false;
   }
+  if (os::HandlerStats::IsEnabled()) {
+    task = os::HandlerStats::Instrument(
+        thread_name_ + ":" + from_here.ToString(), std::move(task),
+        std::chrono::microseconds(delay.InMicroseconds()));
+  }
+  if (shared_handler_ != nullptr) {
+    if (delay <= base::TimeDelta()) {
+      PostShared(std::move(task));
+      return true;
+    }
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(delay.InMicroseconds());
+    bool earliest = shared_delayed_tasks_.empty() ||
+                    deadline < shared_delayed_tasks_.begin()->first;
+    shared_delayed_tasks_.emplace(deadline, std::move(task));
+    if (earliest) {
+      ScheduleSharedAlarm();
+    }
+    return true;
+  }
   if (!message_loop_->task_runner()->PostDelayedTask(from_here, std::move(task),
                                                      delay)) {
     LOG(ERROR) << __func__
@@ -124,6 +237,10 @@ void MessageLoopThread::ShutDown() {
       return;
     }
 
+    if (ShutDownShared()) {
+      return;
+    }
+
     std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
     if (thread_ == nullptr) {
       LOG(INFO) << __func__ << ": thread " << *this << " is already stopped";
@@ -157,6 +274,35 @@ void MessageLoopThread::ShutDown() {
   }
 }
 
+bool MessageLoopThread::ShutDownShared() {
+  os::Handler* handler;
+  os::Alarm* alarm;
+  {
+    std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+    if (shared_handler_ == nullptr) {
+      return false;
+    }
+    CHECK_NE(thread_id_, base::PlatformThread::CurrentId())
+        << __func__ << " should not be called on the thread itself. "
+        << "Otherwise, deadlock may happen.";
+    handler = shared_handler_;
+    alarm = shared_alarm_;
+    shared_handler_ = nullptr;
+    shared_alarm_ = nullptr;
+    shared_delayed_tasks_.clear();
+    thread_id_ = -1;
+    linux_tid_ = -1;
+  }
+  // The task running on the Gd thread, if any, may still post to this thread,
+  // so wait without holding the API lock
+  delete alarm;
+  handler->Clear();
+  handler->WaitUntilStopped(kSharedShutDownTimeout);
+  delete handler;
+  LOG(INFO) << __func__ << ": thread " << thread_name_ << " stopped";
+  return true;
+}
+
 base::PlatformThreadId MessageLoopThread::GetThreadId() const {
   std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
   return thread_id_;
@@ -191,6 +337,11 @@ btbase::AbstractMessageLoop* MessageLoopThread::message_loop() const {
 }
 
 bool MessageLoopThread::EnableRealTimeScheduling() {
+  return ApplyThreadPolicy(os::RealTimeThreadPolicy());
+}
+
+bool MessageLoopThread::ApplyThreadPolicy(
+    const os::ThreadPolicy& default_policy) {
   std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
 
   if (!IsRunning()) {
@@ -198,14 +349,11 @@ bool MessageLoopThread::EnableRealTimeScheduling() {
     return false;
   }
 
-  struct sched_param rt_params = {.sched_priority =
-                                      kRealTimeFifoSchedulingPriority};
-  int rc = sched_setscheduler(linux_tid_, SCHED_FIFO, &rt_params);
-  if (rc != 0) {
-    LOG(ERROR) << __func__ << ": unable to set SCHED_FIFO priority "
-               << kRealTimeFifoSchedulingPriority << " for linux_tid "
-               << std::to_string(linux_tid_) << ", thread " << *this
-               << ", error: " << strerror(errno);
+  auto policy = os::GetThreadPolicy(thread_name_, default_policy);
+  if (!os::ApplyThreadPolicy(linux_tid_, policy)) {
+    LOG(ERROR) << __func__ << ": unable to apply policy '"
+               << policy.ToString() << "' for linux_tid "
+               << std::to_string(linux_tid_) << ", thread " << *this;
     return false;
   }
   return true;
@@ -230,6 +378,8 @@ void MessageLoopThread::Run(std::promise<void> start_up_promise) {
     run_loop_ = new base::RunLoop();
     thread_id_ = base::PlatformThread::CurrentId();
     linux_tid_ = static_cast<pid_t>(syscall(SYS_gettid));
+    os::ApplyThreadPolicy(
+        linux_tid_, os::GetThreadPolicy(thread_name_, os::ThreadPolicy()));
     start_up_promise.set_value();
   }
 
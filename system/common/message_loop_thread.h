@@ -17,7 +17,10 @@
 #pragma once
 
 #include <unistd.h>
+#include <atomic>
+#include <chrono>
 #include <future>
+#include <map>
 #include <memory>
 #include <string>
 #include <thread>
@@ -29,9 +32,16 @@
 #include "src/message_loop_thread.rs.h"
 
 #include "abstract_message_loop.h"
+#include "gd/os/thread_policy.h"
 
 namespace bluetooth {
 
+namespace os {
+class Alarm;
+class Handler;
+class Thread;
+}  // namespace os
+
 namespace common {
 
 /**
@@ -65,6 +75,20 @@ class MessageLoopThread final {
    */
   void StartUp();
 
+  /**
+   * Start this thread as a sequence of tasks on a Gd reactor thread, instead
+   * of on a message loop thread of its own. Tasks posted from the Gd thread
+   * then run without a context switch, and DoInThreadOrRun() may even run
+   * them right away. The tasks of this thread still run in order, one at a
+   * time. message_loop() is not available in this mode.
+   *
+   * Repeated call to this method or StartUp() will only start this thread
+   * once
+   *
+   * @param thread Gd thread to run on, which must outlive ShutDown()
+   */
+  void StartUpOn(os::Thread* thread);
+
   /**
    * Post a task to run on this thread
    *
@@ -75,6 +99,20 @@ class MessageLoopThread final {
    */
   bool DoInThread(const base::Location& from_here, base::OnceClosure task);
 
+  /**
+   * Run a task right away when it would otherwise be the next task of this
+   * thread: the caller is this thread, it was started with StartUpOn(), and
+   * no task of this thread is queued or running. Otherwise, post it like
+   * DoInThread().
+   *
+   * @param from_here location where this task is originated
+   * @param task task created through base::Bind()
+   * @return true if task is run or successfully scheduled, false if task
+   * cannot be scheduled
+   */
+  bool DoInThreadOrRun(const base::Location& from_here,
+                       base::OnceClosure task);
+
   /**
    * Shutdown the current thread as if it is never started. IsRunning() and
    * DoInThread() will return false after this call. Blocks until the thread is
@@ -126,6 +164,17 @@ class MessageLoopThread final {
    */
   bool EnableRealTimeScheduling();
 
+  /**
+   * Apply a scheduling policy and CPU affinity to this thread. The policy
+   * configured for this thread by the system property
+   * bluetooth.os.thread_policy.<thread name>, if any, takes precedence over
+   * |default_policy|
+   *
+   * @param default_policy policy to apply when none is configured
+   * @return true on success, false otherwise
+   */
+  bool ApplyThreadPolicy(const os::ThreadPolicy& default_policy);
+
   /**
    * Return the weak pointer to this object. This can be useful when posting
    * delayed tasks to this MessageLoopThread using Timer.
@@ -190,6 +239,33 @@ class MessageLoopThread final {
    */
   void Run(std::promise<void> start_up_promise);
 
+  /**
+   * Record the Gd thread this thread was started on, in StartUpOn()
+   */
+  void RunOnSharedThread(std::promise<void> start_up_promise);
+
+  /**
+   * Stop a thread started with StartUpOn(). Returns false if it was not
+   */
+  bool ShutDownShared();
+
+  /**
+   * Queue a task on |shared_handler_|, counting it in |shared_tasks_pending_|
+   * until it has run
+   */
+  void PostShared(base::OnceClosure task);
+
+  /**
+   * Arm |shared_alarm_| for the earliest of |shared_delayed_tasks_|. Must be
+   * called with |api_mutex_| held
+   */
+  void ScheduleSharedAlarm();
+
+  /**
+   * Post the delayed tasks which are due, when |shared_alarm_| fires
+   */
+  void PostDueSharedTasks();
+
   mutable std::recursive_mutex api_mutex_;
   const std::string thread_name_;
   btbase::AbstractMessageLoop* message_loop_;
@@ -201,6 +277,14 @@ class MessageLoopThread final {
   base::WeakPtrFactory<MessageLoopThread> weak_ptr_factory_;
   bool shutting_down_;
   bool is_main_;
+  // Set when started with StartUpOn()
+  os::Handler* shared_handler_;
+  os::Alarm* shared_alarm_;
+  std::multimap<std::chrono::steady_clock::time_point, base::OnceClosure>
+      shared_delayed_tasks_;
+  // Tasks posted to |shared_handler_| or run by DoInThreadOrRun() which have
+  // not finished yet
+  std::atomic<size_t> shared_tasks_pending_;
   ::rust::Box<shim::rust::MessageLoopThread>* rust_thread_ = nullptr;
 };
 
@@ -18,6 +18,7 @@
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -26,6 +27,9 @@
 #include <sys/capability.h>
 #include <syscall.h>
 
+#include "gd/os/handler.h"
+#include "gd/os/thread.h"
+
 using bluetooth::common::MessageLoopThread;
 
 /**
@@ -328,3 +332,106 @@ TEST_F(MessageLoopThreadTest, shut_down_start_up_multi_thread) {
   auto thread = std::thread(&MessageLoopThread::StartUp, &message_loop_thread);
   thread.join();
 }
+
+// Verify a thread started on a Gd thread runs its tasks there, in order
+TEST_F(MessageLoopThreadTest, start_up_on_gd_thread) {
+  bluetooth::os::Thread gd_thread("gd_thread",
+                                  bluetooth::os::Thread::Priority::NORMAL);
+  MessageLoopThread message_loop_thread("test_thread");
+  message_loop_thread.StartUpOn(&gd_thread);
+  ASSERT_TRUE(message_loop_thread.IsRunning());
+
+  std::promise<std::string> name_promise;
+  std::future<std::string> name_future = name_promise.get_future();
+  message_loop_thread.DoInThread(
+      FROM_HERE,
+      base::BindOnce(&MessageLoopThreadTest::GetName, base::Unretained(this),
+                     std::move(name_promise)));
+  ASSERT_EQ(name_future.get(), "gd_thread");
+
+  // Delayed tasks run after the immediate ones, by deadline
+  std::vector<int> order;
+  std::promise<void> done_promise;
+  std::future<void> done_future = done_promise.get_future();
+  message_loop_thread.DoInThreadDelayed(
+      FROM_HERE,
+      base::BindOnce(
+          [](std::vector<int>* order, std::promise<void> promise) {
+            order->push_back(3);
+            promise.set_value();
+          },
+          &order, std::move(done_promise)),
+      base::TimeDelta::FromMilliseconds(20));
+  message_loop_thread.DoInThreadDelayed(
+      FROM_HERE,
+      base::BindOnce([](std::vector<int>* order) { order->push_back(2); },
+                     &order),
+      base::TimeDelta::FromMilliseconds(10));
+  message_loop_thread.DoInThread(
+      FROM_HERE,
+      base::BindOnce([](std::vector<int>* order) { order->push_back(1); },
+                     &order));
+  done_future.wait();
+  ASSERT_EQ(order, std::vector<int>({1, 2, 3}));
+
+  message_loop_thread.ShutDown();
+  ASSERT_FALSE(message_loop_thread.IsRunning());
+  ASSERT_FALSE(message_loop_thread.DoInThread(FROM_HERE, base::DoNothing()));
+}
+
+// Verify DoInThreadOrRun() only runs a task right away from the Gd thread,
+// when no other task of the thread is queued or running
+TEST_F(MessageLoopThreadTest, do_in_thread_or_run_on_gd_thread) {
+  bluetooth::os::Thread gd_thread("gd_thread",
+                                  bluetooth::os::Thread::Priority::NORMAL);
+  MessageLoopThread message_loop_thread("test_thread");
+  message_loop_thread.StartUpOn(&gd_thread);
+
+  std::vector<int> order;
+  std::promise<void> done_promise;
+  std::future<void> done_future = done_promise.get_future();
+  // From another thread, the task is posted
+  message_loop_thread.DoInThreadOrRun(
+      FROM_HERE,
+      base::BindOnce(
+          [](MessageLoopThread* thread, std::vector<int>* order,
+             std::promise<void> promise) {
+            order->push_back(1);
+            // From a task of the thread itself, the nested task queues up
+            thread->DoInThreadOrRun(
+                FROM_HERE,
+                base::BindOnce(
+                    [](std::vector<int>* order, std::promise<void> promise) {
+                      order->push_back(3);
+                      promise.set_value();
+                    },
+                    order, std::move(promise)));
+            order->push_back(2);
+          },
+          &message_loop_thread, &order, std::move(done_promise)));
+  done_future.wait();
+  ASSERT_EQ(order, std::vector<int>({1, 2, 3}));
+
+  // From a Gd task, while the thread is idle, the task runs right away
+  order.clear();
+  std::promise<void> gd_done_promise;
+  std::future<void> gd_done_future = gd_done_promise.get_future();
+  bluetooth::os::Handler gd_handler(&gd_thread);
+  gd_handler.Post(base::BindOnce(
+      [](MessageLoopThread* thread, std::vector<int>* order,
+         std::promise<void> promise) {
+        thread->DoInThreadOrRun(
+            FROM_HERE,
+            base::BindOnce([](std::vector<int>* order) { order->push_back(1); },
+                           order));
+        order->push_back(2);
+        promise.set_value();
+      },
+      &message_loop_thread, &order, std::move(gd_done_promise)));
+  gd_done_future.wait();
+  ASSERT_EQ(order, std::vector<int>({1, 2}));
+  gd_handler.Clear();
+  gd_handler.WaitUntilStopped(std::chrono::milliseconds(2000));
+
+  message_loop_thread.ShutDown();
+}
@@ -136,6 +136,14 @@ extern "C" {
 g722_encode_state_t *g722_encode_init(g722_encode_state_t *s, unsigned int rate, int options);
 int g722_encode_release(g722_encode_state_t *s);
 int g722_encode(g722_encode_state_t *s, uint8_t g722_data[], const int16_t amp[], int len);
+/*! Encode len interleaved stereo frames of amp, after shifting each sample right
+    by shift bits, with the left and right encoders. When one of the encoders is
+    NULL, the other one encodes the mono mix of the two channels. len must be even,
+    and the encoders must not be in ITU test mode.
+    \return The number of bytes written to each of left_data and right_data, or -1. */
+int g722_encode_stereo(g722_encode_state_t *left, g722_encode_state_t *right,
+                       uint8_t left_data[], uint8_t right_data[],
+                       const int16_t amp[], int len, int shift);
 
 g722_decode_state_t *g722_decode_init(g722_decode_state_t *s, unsigned int rate, int options);
 int g722_decode_release(g722_decode_state_t *s);
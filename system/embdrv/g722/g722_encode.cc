@@ -32,6 +32,14 @@
 #include "g722_typedefs.h"
 #include "g722_enc_dec.h"
 
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define G722_QMF_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define G722_QMF_SSE2
+#endif
+
 #if !defined(FALSE)
 #define FALSE 0
 #endif
@@ -268,8 +276,85 @@ static int16_t ihp[3] = {0, 3, 2};
 static int16_t wh[3] = {0, -214, 798};
 static int16_t rh2[4] = {2, 1, 2, 1};
 
-int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
-                       const int16_t amp[], int len)
+/* The QMF coefficients for the 24 samples of the history of the transmit QMF,
+   summing (low band) or subtracting (high band) the odd taps from the even
+   taps. */
+static const int16_t qmf_low_coeffs[24] =
+{
+       3,  -11,  -11,   53,   12, -156,   32,  362, -210, -805,  951, 3876,
+    3876,  951, -805, -210,  362,   32, -156,   12,   53,  -11,  -11,    3,
+};
+static const int16_t qmf_high_coeffs[24] =
+{
+      -3,  -11,   11,   53,  -12, -156,  -32,  362,  210, -805, -951, 3876,
+   -3876,  951,  805, -210, -362,   32,  156,   12,  -53,  -11,   11,    3,
+};
+
+/* Apply the transmit QMF to the 24 samples of history x, and keep one output
+   out of two. This is the same computation as in g722_encode(). */
+static __inline void qmf_tx(const int16_t x[24], int *xlow, int *xhigh)
+{
+#if defined(G722_QMF_NEON)
+    int32x4_t low;
+    int32x4_t high;
+    int32x2_t sum;
+    int i;
+
+    low = vmull_s16(vld1_s16(x), vld1_s16(qmf_low_coeffs));
+    high = vmull_s16(vld1_s16(x), vld1_s16(qmf_high_coeffs));
+    for (i = 4;  i < 24;  i += 4)
+    {
+        low = vmlal_s16(low, vld1_s16(x + i), vld1_s16(qmf_low_coeffs + i));
+        high = vmlal_s16(high, vld1_s16(x + i), vld1_s16(qmf_high_coeffs + i));
+    }
+    sum = vpadd_s32(vadd_s32(vget_low_s32(low), vget_high_s32(low)),
+                    vadd_s32(vget_low_s32(high), vget_high_s32(high)));
+    *xlow = vget_lane_s32(sum, 0) >> 14;
+    *xhigh = vget_lane_s32(sum, 1) >> 14;
+#elif defined(G722_QMF_SSE2)
+    __m128i x0 = _mm_loadu_si128((const __m128i *) x);
+    __m128i x1 = _mm_loadu_si128((const __m128i *) (x + 8));
+    __m128i x2 = _mm_loadu_si128((const __m128i *) (x + 16));
+    __m128i low;
+    __m128i high;
+
+    low = _mm_madd_epi16(x0, _mm_loadu_si128((const __m128i *) qmf_low_coeffs));
+    low = _mm_add_epi32(low, _mm_madd_epi16(x1,
+            _mm_loadu_si128((const __m128i *) (qmf_low_coeffs + 8))));
+    low = _mm_add_epi32(low, _mm_madd_epi16(x2,
+            _mm_loadu_si128((const __m128i *) (qmf_low_coeffs + 16))));
+    high = _mm_madd_epi16(x0, _mm_loadu_si128((const __m128i *) qmf_high_coeffs));
+    high = _mm_add_epi32(high, _mm_madd_epi16(x1,
+            _mm_loadu_si128((const __m128i *) (qmf_high_coeffs + 8))));
+    high = _mm_add_epi32(high, _mm_madd_epi16(x2,
+            _mm_loadu_si128((const __m128i *) (qmf_high_coeffs + 16))));
+    /* Sum the 4 lanes of each accumulator */
+    low = _mm_add_epi32(low, _mm_shuffle_epi32(low, 0x4E));
+    low = _mm_add_epi32(low, _mm_shuffle_epi32(low, 0xB1));
+    high = _mm_add_epi32(high, _mm_shuffle_epi32(high, 0x4E));
+    high = _mm_add_epi32(high, _mm_shuffle_epi32(high, 0xB1));
+    *xlow = _mm_cvtsi128_si32(low) >> 14;
+    *xhigh = _mm_cvtsi128_si32(high) >> 14;
+#else
+    int sumlow;
+    int sumhigh;
+    int i;
+
+    sumlow = 0;
+    sumhigh = 0;
+    for (i = 0;  i < 24;  i++)
+    {
+        sumlow += x[i]*qmf_low_coeffs[i];
+        sumhigh += x[i]*qmf_high_coeffs[i];
+    }
+    *xlow = sumlow >> 14;
+    *xhigh = sumhigh >> 14;
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Encode the low and high band samples from the QMF into a G.722 code */
+static __inline int encode_bands(g722_encode_state_t *s, int xlow, int xhigh)
 {
     int dlow;
     int dhigh;
@@ -283,6 +368,95 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     int wd3;
     int eh;
     int mih;
+    int i;
+    int ihigh;
+    int ilow;
+    int code;
+
+    /* Block 1L, SUBTRA */
+    el = saturate(xlow - s->band[0].s);
+
+    /* Block 1L, QUANTL */
+    wd = (el >= 0)  ?  el  :  -(el + 1);
+
+    for (i = 1;  i < 30;  i++)
+    {
+        wd1 = (q6[i]*s->band[0].det) >> 12;
+        if (wd < wd1)
+            break;
+    }
+    ilow = (el < 0)  ?  iln[i]  :  ilp[i];
+
+    /* Block 2L, INVQAL */
+    ril = ilow >> 2;
+    wd2 = qm4[ril];
+    dlow = (s->band[0].det*wd2) >> 15;
+
+    /* Block 3L, LOGSCL */
+    il4 = rl42[ril];
+    wd = (s->band[0].nb*127) >> 7;
+    s->band[0].nb = wd + wl[il4];
+    if (s->band[0].nb < 0)
+        s->band[0].nb = 0;
+    else if (s->band[0].nb > 18432)
+        s->band[0].nb = 18432;
+
+    /* Block 3L, SCALEL */
+    wd1 = (s->band[0].nb >> 6) & 31;
+    wd2 = 8 - (s->band[0].nb >> 11);
+    wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
+    s->band[0].det = wd3 << 2;
+
+    block4(&s->band[0], dlow);
+    {
+        int nb;
+
+        /* Block 1H, SUBTRA */
+        eh = saturate(xhigh - s->band[1].s);
+
+        /* Block 1H, QUANTH */
+        wd = (eh >= 0)  ?  eh  :  -(eh + 1);
+        wd1 = (564*s->band[1].det) >> 12;
+        mih = (wd >= wd1)  ?  2  :  1;
+        ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
+
+        /* Block 2H, INVQAH */
+        wd2 = qm2[ihigh];
+        dhigh = (s->band[1].det*wd2) >> 15;
+
+        /* Block 3H, LOGSCH */
+        ih2 = rh2[ihigh];
+        wd = (s->band[1].nb*127) >> 7;
+
+        nb = wd + wh[ih2];
+        if (nb < 0)
+            nb = 0;
+        else if (nb > 22528)
+            nb = 22528;
+        s->band[1].nb = nb;
+
+        /* Block 3H, SCALEH */
+        wd1 = (s->band[1].nb >> 6) & 31;
+        wd2 = 10 - (s->band[1].nb >> 11);
+        wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
+        s->band[1].det = wd3 << 2;
+
+        block4(&s->band[1], dhigh);
+#if   BITS_PER_SAMPLE == 8
+        code = ((ihigh << 6) | ilow);
+#elif BITS_PER_SAMPLE == 7
+        code = ((ihigh << 6) | ilow) >> 1;
+#elif BITS_PER_SAMPLE == 6
+        code = ((ihigh << 6) | ilow) >> 2;
+#endif
+    }
+    return code;
+}
+/*- End of function --------------------------------------------------------*/
+
+int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
+                       const int16_t amp[], int len)
+{
     int i;
     int j;
     /* Low and high band PCM from the QMF */
@@ -292,8 +466,6 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     /* Even and odd tap accumulators */
     int sumeven;
     int sumodd;
-    int ihigh;
-    int ilow;
     int code;
 
     g722_bytes = 0;
@@ -340,83 +512,7 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
 #endif
             }
         }
-        /* Block 1L, SUBTRA */
-        el = saturate(xlow - s->band[0].s);
-
-        /* Block 1L, QUANTL */
-        wd = (el >= 0)  ?  el  :  -(el + 1);
-
-        for (i = 1;  i < 30;  i++)
-        {
-            wd1 = (q6[i]*s->band[0].det) >> 12;
-            if (wd < wd1)
-                break;
-        }
-        ilow = (el < 0)  ?  iln[i]  :  ilp[i];
-
-        /* Block 2L, INVQAL */
-        ril = ilow >> 2;
-        wd2 = qm4[ril];
-        dlow = (s->band[0].det*wd2) >> 15;
-
-        /* Block 3L, LOGSCL */
-        il4 = rl42[ril];
-        wd = (s->band[0].nb*127) >> 7;
-        s->band[0].nb = wd + wl[il4];
-        if (s->band[0].nb < 0)
-            s->band[0].nb = 0;
-        else if (s->band[0].nb > 18432)
-            s->band[0].nb = 18432;
-
-        /* Block 3L, SCALEL */
-        wd1 = (s->band[0].nb >> 6) & 31;
-        wd2 = 8 - (s->band[0].nb >> 11);
-        wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-        s->band[0].det = wd3 << 2;
-
-        block4(&s->band[0], dlow);
-        {
-	    int nb;
-
-            /* Block 1H, SUBTRA */
-            eh = saturate(xhigh - s->band[1].s);
-
-            /* Block 1H, QUANTH */
-            wd = (eh >= 0)  ?  eh  :  -(eh + 1);
-            wd1 = (564*s->band[1].det) >> 12;
-            mih = (wd >= wd1)  ?  2  :  1;
-            ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
-
-            /* Block 2H, INVQAH */
-            wd2 = qm2[ihigh];
-            dhigh = (s->band[1].det*wd2) >> 15;
-
-            /* Block 3H, LOGSCH */
-            ih2 = rh2[ihigh];
-            wd = (s->band[1].nb*127) >> 7;
-
-            nb = wd + wh[ih2];
-            if (nb < 0)
-                nb = 0;
-            else if (nb > 22528)
-                nb = 22528;
-	    s->band[1].nb = nb;
-
-            /* Block 3H, SCALEH */
-            wd1 = (s->band[1].nb >> 6) & 31;
-            wd2 = 10 - (s->band[1].nb >> 11);
-            wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-            s->band[1].det = wd3 << 2;
-
-            block4(&s->band[1], dhigh);
-#if   BITS_PER_SAMPLE == 8
-            code = ((ihigh << 6) | ilow);
-#elif BITS_PER_SAMPLE == 7
-            code = ((ihigh << 6) | ilow) >> 1;
-#elif BITS_PER_SAMPLE == 6
-            code = ((ihigh << 6) | ilow) >> 2;
-#endif
-        }
+        code = encode_bands(s, xlow, xhigh);
 
 #if PACKED_OUTPUT == 1
             /* Pack the code bits */
@@ -435,4 +531,102 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     return g722_bytes;
 }
 /*- End of function --------------------------------------------------------*/
+
+/* Number of input frames deinterleaved at once by g722_encode_stereo() */
+#define STEREO_BLOCK_FRAMES 128
+
+int g722_encode_stereo(g722_encode_state_t *left, g722_encode_state_t *right,
+                       uint8_t left_data[], uint8_t right_data[],
+                       const int16_t amp[], int len, int shift)
+{
+    /* The QMF history of each channel, followed by a block of input */
+    int16_t x[2][24 + STEREO_BLOCK_FRAMES];
+    g722_encode_state_t *s[2];
+    uint8_t *g722_data[2];
+    int channels;
+    int xlow;
+    int xhigh;
+    int code;
+    int g722_bytes;
+    int i;
+    int j;
+    int k;
+    int n;
+    int c;
+
+    channels = 0;
+    if (left)
+    {
+        s[channels] = left;
+        g722_data[channels++] = left_data;
+    }
+    if (right)
+    {
+        s[channels] = right;
+        g722_data[channels++] = right_data;
+    }
+    if (channels == 0  ||  (len & 1))
+        return -1;
+    for (c = 0;  c < channels;  c++)
+    {
+        if (s[c]->itu_test_mode)
+            return -1;
+        for (i = 0;  i < 24;  i++)
+            x[c][i] = (int16_t) s[c]->x[i];
+    }
+
+    g722_bytes = 0;
+    for (j = 0;  j < len;  j += n)
+    {
+        n = len - j;
+        if (n > STEREO_BLOCK_FRAMES)
+            n = STEREO_BLOCK_FRAMES;
+
+        /* Deinterleave the block after the history, or mix it to mono for a
+           single encoder */
+        for (i = 0;  i < n;  i++)
+        {
+            int l = amp[2*(j + i)] >> shift;
+            int r = amp[2*(j + i) + 1] >> shift;
+
+            if (channels == 2)
+            {
+                x[0][24 + i] = (int16_t) l;
+                x[1][24 + i] = (int16_t) r;
+            }
+            else
+            {
+                x[0][24 + i] = (int16_t) ((l + r) >> 1);
+            }
+        }
+
+        /* Each code is computed from the 24 samples ending with the next two
+           input samples */
+        for (k = 0;  k < n;  k += 2)
+        {
+            for (c = 0;  c < channels;  c++)
+            {
+                qmf_tx(&x[c][k + 2], &xlow, &xhigh);
+#ifdef RUN_LIKE_REFERENCE_G722
+                xlow = limitValues(xlow);
+                xhigh = limitValues(xhigh);
+#endif
+                code = encode_bands(s[c], xlow, xhigh);
+                g722_data[c][g722_bytes] = (uint8_t) code;
+            }
+            g722_bytes++;
+        }
+
+        for (c = 0;  c < channels;  c++)
+            memmove(x[c], x[c] + n, 24*sizeof(x[c][0]));
+    }
+
+    for (c = 0;  c < channels;  c++)
+    {
+        for (i = 0;  i < 24;  i++)
+            s[c]->x[i] = x[c][i];
+    }
+    return g722_bytes;
+}
+/*- End of function --------------------------------------------------------*/
 /*- End of file ------------------------------------------------------------*/
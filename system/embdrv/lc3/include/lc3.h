@@ -297,6 +297,25 @@ lc3_decoder_t lc3_setup_decoder(
 int lc3_decode(lc3_decoder_t decoder, const void *in, int nbytes,
     enum lc3_pcm_format fmt, void *pcm, int stride);
 
+/**
+ * Decode a frame of several channels
+ * decoders        Handles of the decoders, one by channel
+ * nchannels       Number of channels
+ * in, nbytes      Input bitstreams and sizes in bytes, one by channel,
+ *                 a NULL bitstream performs PLC of the channel
+ * fmt             PCM output format
+ * pcm             Output PCM samples, the channels being interleaved
+ * return          0: On success  >0: Number of channels PLC operated
+ *                 -1: Wrong parameters
+ *
+ * The decoders are setup with the same frame duration and output
+ * samplerate. The channels are decoded in turn, the successive decodings
+ * sharing the same tables. On wrong parameters, no channel is decoded.
+ */
+int lc3_decode_channels(lc3_decoder_t *decoders, int nchannels,
+    const void * const *in, const int *nbytes,
+    enum lc3_pcm_format fmt, void *pcm);
+
 
 #ifdef __cplusplus
 }
@@ -31,6 +31,8 @@
 #include "spec.h"
 #include "plc.h"
 
+#include "lc3_neon.h"
+
 
 /**
  * Frame side data
@@ -144,6 +146,23 @@ int lc3_delay_samples(int dt_us, int sr_hz)
  *  Encoder
  * -------------------------------------------------------------------------- */
 
+/**
+ * Deinterleave signed 16 bits PCM samples
+ * pcm, stride     Input PCM samples, and count between two consecutives
+ * n               Number of samples
+ * xt, xs          Return the samples, as integers and as floats
+ */
+#ifndef load_s16_pcm
+LC3_HOT static void load_s16_pcm(
+    const int16_t *pcm, int stride, int n, int16_t *xt, float *xs)
+{
+    for (int i = 0; i < n; i++) {
+        int16_t in = pcm[i*stride];
+        xt[i] = in, xs[i] = in;
+    }
+}
+#endif /* load_s16_pcm */
+
 /**
  * Input PCM Samples from signed 16 bits
  * encoder         Encoder state
@@ -152,19 +171,10 @@ int lc3_delay_samples(int dt_us, int sr_hz)
 static void load_s16(
     struct lc3_encoder *encoder, const void *_pcm, int stride)
 {
-    const int16_t *pcm = _pcm;
-
     enum lc3_dt dt = encoder->dt;
     enum lc3_srate sr = encoder->sr_pcm;
 
-    int16_t *xt = encoder->xt;
-    float *xs = encoder->xs;
-    int ns = LC3_NS(dt, sr);
-
-    for (int i = 0; i < ns; i++) {
-        int16_t in = pcm[i*stride];
-        xt[i] = in, xs[i] = in;
-    }
+    load_s16_pcm(_pcm, stride, LC3_NS(dt, sr), encoder->xt, encoder->xs);
 }
 
 /**
@@ -601,3 +611,43 @@ int lc3_decode(struct lc3_decoder *decoder, const void *in, int nbytes,
 
     return ret;
 }
+
+/**
+ * Decode a frame of several channels
+ */
+int lc3_decode_channels(struct lc3_decoder **decoders, int nchannels,
+    const void * const *in, const int *nbytes,
+    enum lc3_pcm_format fmt, void *pcm)
+{
+    static const int pcm_bytes[] = {
+        [LC3_PCM_FORMAT_S16] = sizeof(int16_t),
+        [LC3_PCM_FORMAT_S24] = sizeof(int32_t),
+    };
+
+    /* --- Check parameters --- */
+
+    if (!decoders || nchannels <= 0 || !in || !nbytes)
+        return -1;
+
+    for (int ch = 0; ch < nchannels; ch++) {
+        struct lc3_decoder *decoder = decoders[ch];
+
+        if (!decoder || decoder->dt != decoders[0]->dt ||
+                decoder->sr_pcm != decoders[0]->sr_pcm)
+            return -1;
+
+        if (in[ch] && (nbytes[ch] < LC3_MIN_FRAME_BYTES ||
+                       nbytes[ch] > LC3_MAX_FRAME_BYTES   ))
+            return -1;
+    }
+
+    /* --- Processing --- */
+
+    int nplc = 0;
+
+    for (int ch = 0; ch < nchannels; ch++)
+        nplc += lc3_decode(decoders[ch], in[ch], nbytes[ch],
+            fmt, (uint8_t *)pcm + ch * pcm_bytes[fmt], nchannels);
+
+    return nplc;
+}
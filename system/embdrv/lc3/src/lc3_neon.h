@@ -0,0 +1,65 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 Google LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+
+#ifndef TEST_NEON
+#include <arm_neon.h>
+#endif /* TEST_NEON */
+
+
+/**
+ * Store 8 samples as integers and as floats
+ */
+static inline void neon_store_s16(int16x8_t x, int16_t *xt, float *xs)
+{
+    vst1q_s16(xt, x);
+    vst1q_f32(xs + 0, vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))));
+    vst1q_f32(xs + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))));
+}
+
+/**
+ * Deinterleave signed 16 bits PCM samples
+ * The strides of mono and stereo PCM are vectorized
+ */
+#ifndef load_s16_pcm
+#define load_s16_pcm neon_load_s16_pcm
+LC3_HOT static void neon_load_s16_pcm(
+    const int16_t *pcm, int stride, int n, int16_t *xt, float *xs)
+{
+    int i = 0;
+
+    if (stride == 1) {
+        for ( ; i + 8 <= n; i += 8)
+            neon_store_s16(vld1q_s16(pcm + i), xt + i, xs + i);
+
+    } else if (stride == 2) {
+        /* Each load reads the sample of the other channel that follows,
+         * so the last one is not loaded past the end of the PCM buffer */
+        for ( ; i + 8 < n; i += 8)
+            neon_store_s16(vld2q_s16(pcm + 2*i).val[0], xt + i, xs + i);
+    }
+
+    for ( ; i < n; i++) {
+        int16_t in = pcm[i*stride];
+        xt[i] = in, xs[i] = in;
+    }
+}
+#endif /* load_s16_pcm */
+
+#endif /* __ARM_NEON && __ARM_ARCH_ISA_A64 */
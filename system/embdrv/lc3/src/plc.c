@@ -18,6 +18,8 @@
 
 #include "plc.h"
 
+#include "plc_neon.h"
+
 
 /**
  * Reset Packet Loss Concealment state
@@ -37,25 +39,39 @@ void lc3_plc_suspend(struct lc3_plc_state *plc)
     plc->alpha = 1.0f;
 }
 
+/**
+ * Attenuate the coefficients, with a sign given by the noise generator
+ * seed            Current state of the noise generator
+ * alpha           Attenuation factor
+ * x, y, n         Input and output coefficients, n % 4 = 0
+ * return          The updated state of the noise generator
+ */
+#ifndef plc_noise
+LC3_HOT static uint16_t plc_noise(
+    uint16_t seed, float alpha, const float *x, float *y, int n)
+{
+    for (int i = 0; i < n; i++) {
+        seed = (16831 + seed * 12821) & 0xffff;
+        y[i] = alpha * (seed & 0x8000 ? -x[i] : x[i]);
+    }
+
+    return seed;
+}
+#endif /* plc_noise */
+
 /**
  * Synthesis of a PLC frame
  */
 void lc3_plc_synthesize(enum lc3_dt dt, enum lc3_srate sr,
     struct lc3_plc_state *plc, const float *x, float *y)
 {
-    uint16_t seed = plc->seed;
     float alpha = plc->alpha;
     int ne = LC3_NE(dt, sr);
 
     alpha *= (plc->count < 4 ? 1.0f :
               plc->count < 8 ? 0.9f : 0.85f);
 
-    for (int i = 0; i < ne; i++) {
-        seed = (16831 + seed * 12821) & 0xffff;
-        y[i] = alpha * (seed & 0x8000 ? -x[i] : x[i]);
-    }
-
-    plc->seed = seed;
+    plc->seed = plc_noise(plc->seed, alpha, x, y, ne);
     plc->alpha = alpha;
     plc->count++;
 }
@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 Google LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#if __ARM_NEON && __ARM_ARCH_ISA_A64
+
+#ifndef TEST_NEON
+#include <arm_neon.h>
+#endif /* TEST_NEON */
+
+
+/**
+ * Attenuate the coefficients, with a sign given by the noise generator
+ * The four lanes run the generator 4 steps ahead of each others
+ */
+#ifndef plc_noise
+#define plc_noise neon_plc_noise
+LC3_HOT static uint16_t neon_plc_noise(
+    uint16_t seed, float alpha, const float *x, float *y, int n)
+{
+    /* The steps 4 ahead, s(k+4) = a4 * s(k) + c4, are :
+     * a4 = 12821^4 and c4 = 16831 * (1 + 12821 + 12821^2 + 12821^3),
+     * the values being taken modulo 2^16 */
+
+    const uint16x4_t a4 = vdup_n_u16(8113);
+    const uint16x4_t c4 = vdup_n_u16(34564);
+
+    uint16_t s0[4];
+    for (int k = 0; k < 4; k++)
+        s0[k] = seed = 16831 + seed * 12821;
+
+    uint16x4_t s = vld1_u16(s0);
+
+    for (int i = 0; i < n; i += 4) {
+        uint32x4_t sign = vshll_n_u16(vand_u16(s, vdup_n_u16(0x8000)), 16);
+        uint32x4_t xi = vreinterpretq_u32_f32(vld1q_f32(x + i));
+
+        vst1q_f32(y + i, vmulq_n_f32(
+            vreinterpretq_f32_u32(veorq_u32(xi, sign)), alpha));
+
+        seed = vget_lane_u16(s, 3);
+        s = vmla_u16(c4, s, a4);
+    }
+
+    return seed;
+}
+#endif /* plc_noise */
+
+#endif /* __ARM_NEON && __ARM_ARCH_ISA_A64 */
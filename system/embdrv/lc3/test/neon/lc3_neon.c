@@ -0,0 +1,67 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 Google LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "neon.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------------- */
+
+#define TEST_NEON
+#include <common.h>
+#include <lc3_neon.h>
+
+/* -------------------------------------------------------------------------- */
+
+static int check_load_s16(void)
+{
+    int16_t pcm[2*480];
+    int16_t xt_neon[480];
+    float xs_neon[480];
+
+    for (int i = 0; i < 2*480; i++)
+        pcm[i] = rand() - RAND_MAX/2;
+
+    static const int ns[] = { 60, 80, 120, 160, 180, 240, 320, 360, 480 };
+    for (int k = 0; k < (int)(sizeof(ns) / sizeof(*ns)); k++)
+        for (int stride = 1; stride <= 2; stride++)
+            for (int ch = 0; ch < stride; ch++) {
+                const int16_t *x = pcm + ch;
+                int n = ns[k];
+
+                neon_load_s16_pcm(x, stride, n, xt_neon, xs_neon);
+                for (int i = 0; i < n; i++)
+                    if (xt_neon[i] != x[i*stride] ||
+                        xs_neon[i] != x[i*stride]   )
+                        return -1;
+            }
+
+    return 0;
+}
+
+int check_load(void)
+{
+    int ret;
+
+    if ((ret = check_load_s16()) < 0)
+        return ret;
+
+    return 0;
+}
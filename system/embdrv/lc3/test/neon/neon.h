@@ -24,6 +24,7 @@
 #define __ARM_NEON 1
 
 #include <stdint.h>
+#include <string.h>
 
 
 /* ----------------------------------------------------------------------------
@@ -36,6 +37,11 @@ typedef struct { int16_t e[8]; } int16x8_t;
 typedef struct { int32_t e[4]; } int32x4_t;
 typedef struct { int64_t e[2]; } int64x2_t;
 
+typedef struct { int16x8_t val[2]; } int16x8x2_t;
+
+typedef struct { uint16_t e[4]; } uint16x4_t;
+typedef struct { uint32_t e[4]; } uint32x4_t;
+
 
 /**
  * Load / Store
@@ -47,6 +53,36 @@ static int16x4_t vld1_s16(const int16_t *p)
     return (int16x4_t){ { p[0], p[1], p[2], p[3] } };
 }
 
+__attribute__((unused))
+static int16x8_t vld1q_s16(const int16_t *p)
+{
+    return (int16x8_t){ { p[0], p[1], p[2], p[3],
+                          p[4], p[5], p[6], p[7] } };
+}
+
+__attribute__((unused))
+static int16x8x2_t vld2q_s16(const int16_t *p)
+{
+    return (int16x8x2_t){
+        .val[0] = { { p[ 0], p[ 2], p[ 4], p[ 6],
+                      p[ 8], p[10], p[12], p[14] } },
+        .val[1] = { { p[ 1], p[ 3], p[ 5], p[ 7],
+                      p[ 9], p[11], p[13], p[15] } } };
+}
+
+__attribute__((unused))
+static void vst1q_s16(int16_t *p, int16x8_t v)
+{
+    for (int i = 0; i < 8; i++)
+        p[i] = v.e[i];
+}
+
+__attribute__((unused))
+static uint16x4_t vld1_u16(const uint16_t *p)
+{
+    return (uint16x4_t){ { p[0], p[1], p[2], p[3] } };
+}
+
 
 /**
  * Arithmetic
@@ -78,6 +114,41 @@ static int64x2_t vpadalq_s32(int64x2_t a, int32x4_t b)
     return r;
 }
 
+__attribute__((unused))
+static uint16x4_t vmla_u16(uint16x4_t r, uint16x4_t a, uint16x4_t b)
+{
+    for (int i = 0; i < 4; i++)
+        r.e[i] += (uint32_t)a.e[i] * b.e[i];
+
+    return r;
+}
+
+
+/**
+ * Logical
+ */
+
+__attribute__((unused))
+static uint16x4_t vand_u16(uint16x4_t a, uint16x4_t b)
+{
+    return (uint16x4_t){ { a.e[0] & b.e[0], a.e[1] & b.e[1],
+                           a.e[2] & b.e[2], a.e[3] & b.e[3]  } };
+}
+
+__attribute__((unused))
+static uint32x4_t veorq_u32(uint32x4_t a, uint32x4_t b)
+{
+    return (uint32x4_t){ { a.e[0] ^ b.e[0], a.e[1] ^ b.e[1],
+                           a.e[2] ^ b.e[2], a.e[3] ^ b.e[3]  } };
+}
+
+__attribute__((unused))
+static uint32x4_t vshll_n_u16(uint16x4_t a, const int n)
+{
+    return (uint32x4_t){ { (uint32_t)a.e[0] << n, (uint32_t)a.e[1] << n,
+                           (uint32_t)a.e[2] << n, (uint32_t)a.e[3] << n  } };
+}
+
 
 /**
  * Reduce
@@ -115,12 +186,42 @@ static int32x4_t vmovq_n_s32(uint32_t v)
     return (int32x4_t){ { v, v, v, v } };
 }
 
+__attribute__((unused))
+static int16x4_t vget_low_s16(int16x8_t a)
+{
+    return (int16x4_t){ { a.e[0], a.e[1], a.e[2], a.e[3] } };
+}
+
+__attribute__((unused))
+static int16x4_t vget_high_s16(int16x8_t a)
+{
+    return (int16x4_t){ { a.e[4], a.e[5], a.e[6], a.e[7] } };
+}
+
+__attribute__((unused))
+static int32x4_t vmovl_s16(int16x4_t a)
+{
+    return (int32x4_t){ { a.e[0], a.e[1], a.e[2], a.e[3] } };
+}
+
 __attribute__((unused))
 static int64x2_t vmovq_n_s64(int64_t v)
 {
     return (int64x2_t){ { v, v, } };
 }
 
+__attribute__((unused))
+static uint16x4_t vdup_n_u16(uint16_t v)
+{
+    return (uint16x4_t){ { v, v, v, v } };
+}
+
+__attribute__((unused))
+static uint16_t vget_lane_u16(uint16x4_t a, const int n)
+{
+    return a.e[n];
+}
+
 
 
 /* ----------------------------------------------------------------------------
@@ -182,6 +283,32 @@ static void vst1q_f32(float *p, float32x4_t v)
     p[0] = v.e[0], p[1] = v.e[1], p[2] = v.e[2], p[3] = v.e[3];
 }
 
+/**
+ * Conversion
+ */
+
+__attribute__((unused))
+static float32x4_t vcvtq_f32_s32(int32x4_t a)
+{
+    return (float32x4_t){ { a.e[0], a.e[1], a.e[2], a.e[3] } };
+}
+
+__attribute__((unused))
+static uint32x4_t vreinterpretq_u32_f32(float32x4_t a)
+{
+    uint32x4_t r;
+    memcpy(r.e, a.e, sizeof(r.e));
+    return r;
+}
+
+__attribute__((unused))
+static float32x4_t vreinterpretq_f32_u32(uint32x4_t a)
+{
+    float32x4_t r;
+    memcpy(r.e, a.e, sizeof(r.e));
+    return r;
+}
+
 /**
  * Arithmetic
  */
@@ -205,6 +332,12 @@ static float32x4_t vaddq_f32(float32x4_t a, float32x4_t b)
                             a.e[2] + b.e[2], a.e[3] + b.e[3] } };
 }
 
+__attribute__((unused))
+static float32x4_t vmulq_n_f32(float32x4_t a, float b)
+{
+    return (float32x4_t){ { a.e[0] * b, a.e[1] * b, a.e[2] * b, a.e[3] * b } };
+}
+
 __attribute__((unused))
 static float32x4_t vsubq_f32(float32x4_t a, float32x4_t b)
 {
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 Google LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "neon.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------------- */
+
+#define TEST_NEON
+#include <plc.c>
+
+/* -------------------------------------------------------------------------- */
+
+static uint16_t plc_noise_c(
+    uint16_t seed, float alpha, const float *x, float *y, int n)
+{
+    for (int i = 0; i < n; i++) {
+        seed = (16831 + seed * 12821) & 0xffff;
+        y[i] = alpha * (seed & 0x8000 ? -x[i] : x[i]);
+    }
+
+    return seed;
+}
+
+static int check_plc_noise(void)
+{
+    float x[400], y[400], y_neon[400];
+
+    for (int i = 0; i < 400; i++)
+        x[i] = (float)rand() / RAND_MAX - 0.5f;
+
+    static const int ne[] = { 60, 80, 120, 160, 180, 240, 320, 360, 400 };
+    static const float alpha[] = { 1.0f, 0.9f, 0.9f * 0.85f };
+
+    uint16_t seed = 24607;
+    for (int k = 0; k < (int)(sizeof(ne) / sizeof(*ne)); k++)
+        for (int j = 0; j < (int)(sizeof(alpha) / sizeof(*alpha)); j++) {
+            uint16_t seed_c = plc_noise_c(seed, alpha[j], x, y, ne[k]);
+            seed = neon_plc_noise(seed, alpha[j], x, y_neon, ne[k]);
+
+            if (seed != seed_c)
+                return -1;
+
+            for (int i = 0; i < ne[k]; i++)
+                if (y_neon[i] != y[i])
+                    return -1;
+        }
+
+    /* In place processing */
+    plc_noise_c(seed, alpha[2], x, y, 400);
+    neon_plc_noise(seed, alpha[2], x, x, 400);
+    for (int i = 0; i < 400; i++)
+        if (x[i] != y[i])
+            return -1;
+
+    return 0;
+}
+
+int check_plc(void)
+{
+    int ret;
+
+    if ((ret = check_plc_noise()) < 0)
+        return ret;
+
+    return 0;
+}
@@ -20,6 +20,8 @@
 
 int check_ltpf(void);
 int check_mdct(void);
+int check_load(void);
+int check_plc(void);
 
 int main()
 {
@@ -33,5 +35,13 @@ int main()
     printf("%s\n", (r = check_mdct()) == 0 ? "OK" : "Failed");
     ret = ret || r;
 
+    printf("Checking PCM load Neon... "); fflush(stdout);
+    printf("%s\n", (r = check_load()) == 0 ? "OK" : "Failed");
+    ret = ret || r;
+
+    printf("Checking PLC Neon... "); fflush(stdout);
+    printf("%s\n", (r = check_plc()) == 0 ? "OK" : "Failed");
+    ret = ret || r;
+
     return ret;
 }
@@ -238,6 +238,8 @@ typedef struct {
   uint8_t restrictSubbands;
   uint8_t enhancedEnabled;
   uint8_t bufferedBlocks;
+  /* Boolean, set by OI_CODEC_SBC_DecoderEnableSimd() */
+  uint8_t simdEnabled;
 } OI_CODEC_SBC_DECODER_CONTEXT;
 
 typedef struct {
@@ -297,6 +299,21 @@ OI_STATUS OI_CODEC_SBC_DecoderReset(OI_CODEC_SBC_DECODER_CONTEXT* context,
 OI_STATUS OI_CODEC_SBC_DecoderLimit(OI_CODEC_SBC_DECODER_CONTEXT* context,
                                     OI_BOOL enhanced, uint8_t subbands);
 
+/**
+ * This function selects the NEON or AVX2 versions of the dequantizer and of
+ * the synthesis filterbank, when the CPU supports them, or the portable C
+ * versions. Both decode to the same PCM samples. OI_CODEC_SBC_DecoderReset()
+ * selects the SIMD versions whenever they are supported.
+ *
+ * @param context   Pointer to the decoder context structure.
+ *
+ * @param enable    If true, use the SIMD versions if supported.
+ *
+ * @return          TRUE if the SIMD versions are in use.
+ */
+OI_BOOL OI_CODEC_SBC_DecoderEnableSimd(OI_CODEC_SBC_DECODER_CONTEXT* context,
+                                       OI_BOOL enable);
+
 /**
  * This function sets the decoder parameters for a raw decode where the decoder
  * parameters are not available in the sbc data stream.
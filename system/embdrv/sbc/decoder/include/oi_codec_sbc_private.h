@@ -183,6 +183,18 @@ PRIVATE void cosineModulateSynth4(SBC_BUFFER_T* RESTRICT out,
                                   int32_t const* RESTRICT in);
 PRIVATE void SynthWindow40_int32_int32_symmetry_with_sum(
     int16_t* pcm, SBC_BUFFER_T buffer[80], OI_UINT strideShift);
+PRIVATE void SynthWindow80_generated(int16_t* pcm,
+                                     SBC_BUFFER_T const* RESTRICT buffer,
+                                     OI_UINT strideShift);
+
+/* SIMD versions of the synthesis windows, see decoder-simd.c */
+PRIVATE OI_BOOL OI_SBC_SimdSupported(void);
+PRIVATE void SynthWindow80_simd(int16_t* pcm,
+                                SBC_BUFFER_T const* RESTRICT buffer,
+                                OI_UINT strideShift);
+PRIVATE void SynthWindow40_simd(int16_t* pcm,
+                                SBC_BUFFER_T const* RESTRICT buffer,
+                                OI_UINT strideShift);
 
 INLINE void dct3_4(int32_t* RESTRICT out, int32_t const* RESTRICT in);
 PRIVATE void analyze4_generated(SBC_BUFFER_T analysisBuffer[RESTRICT 40],
@@ -215,6 +227,24 @@ PRIVATE void OI_SBC_SynthFrame(OI_CODEC_SBC_DECODER_CONTEXT* context,
                                int16_t* pcm, OI_UINT start_block,
                                OI_UINT nrof_blocks);
 INLINE int32_t OI_SBC_Dequant(uint32_t raw, OI_UINT scale_factor, OI_UINT bits);
+
+/** OI_SBC_Dequant() of every subband of a frame, as
+ * (int32_t)((raw * 2 + 1) * mult - offset) >> shift */
+typedef struct {
+  uint32_t mult[SBC_MAX_CHANNELS * SBC_MAX_BANDS];
+  uint32_t offset[SBC_MAX_CHANNELS * SBC_MAX_BANDS];
+  int32_t shift[SBC_MAX_CHANNELS * SBC_MAX_BANDS];
+} OI_SBC_DEQUANT_PARAMS;
+
+PRIVATE void OI_SBC_DequantPrepare(OI_SBC_DEQUANT_PARAMS* params,
+                                   const OI_CODEC_SBC_COMMON_CONTEXT* common);
+/* Dequantize in place the raw samples of |nrof_blocks| blocks of |count|
+ * samples, |count| being a multiple of 4 */
+PRIVATE void OI_SBC_DequantFrame_simd(int32_t* s,
+                                      const OI_SBC_DEQUANT_PARAMS* params,
+                                      OI_UINT count, OI_UINT nrof_blocks);
+PRIVATE void OI_SBC_ReadSamplesSimd(OI_CODEC_SBC_DECODER_CONTEXT* context,
+                                    OI_BITSTREAM* global_bs);
 PRIVATE OI_BOOL OI_SBC_ExamineCommandPacket(
     OI_CODEC_SBC_DECODER_CONTEXT* context, const OI_BYTE* data, uint32_t len);
 PRIVATE void OI_SBC_GenerateTestSignal(int16_t pcmData[][2],
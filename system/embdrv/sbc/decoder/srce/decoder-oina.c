@@ -114,6 +114,12 @@ OI_STATUS OI_CODEC_SBC_DecoderLimit(OI_CODEC_SBC_DECODER_CONTEXT* context,
   return OI_OK;
 }
 
+OI_BOOL OI_CODEC_SBC_DecoderEnableSimd(OI_CODEC_SBC_DECODER_CONTEXT* context,
+                                       OI_BOOL enable) {
+  context->simdEnabled = (enable && OI_SBC_SimdSupported()) ? TRUE : FALSE;
+  return context->simdEnabled;
+}
+
 /**
 @}
 */
@@ -73,6 +73,7 @@ INLINE OI_STATUS internal_DecoderReset(OI_CODEC_SBC_DECODER_CONTEXT* context,
   context->common.codecInfo = OI_Codec_Copyright;
   context->common.maxBitneed = 0;
   context->limitFrameFormat = FALSE;
+  context->simdEnabled = OI_SBC_SimdSupported();
   OI_SBC_ExpandFrameFields(&context->common.frameInfo);
 
   /*PLATFORM_DECODER_RESET(context);*/
@@ -203,6 +204,55 @@ PRIVATE void OI_SBC_ReadSamples(OI_CODEC_SBC_DECODER_CONTEXT* context,
   } while (--nrof_blocks);
 }
 
+/** Same as OI_SBC_ReadSamples() and OI_SBC_ReadSamplesJoint(), reading the raw
+ * samples of the frame before dequantizing them all at once. */
+PRIVATE void OI_SBC_ReadSamplesSimd(OI_CODEC_SBC_DECODER_CONTEXT* context,
+                                    OI_BITSTREAM* global_bs) {
+  OI_CODEC_SBC_COMMON_CONTEXT* common = &context->common;
+  OI_UINT nrof_blocks = common->frameInfo.nrof_blocks;
+  OI_UINT nrof_subbands = common->frameInfo.nrof_subbands;
+  int32_t* RESTRICT s = common->subdata;
+  const uint8_t* ptr = global_bs->ptr.r;
+  uint32_t value = global_bs->value;
+  OI_UINT bitPtr = global_bs->bitPtr;
+  const OI_UINT iter_count = common->frameInfo.nrof_channels * nrof_subbands;
+  OI_SBC_DEQUANT_PARAMS params;
+  OI_UINT blk;
+
+  for (blk = 0; blk < nrof_blocks; ++blk) {
+    OI_UINT n;
+    for (n = 0; n < iter_count; ++n) {
+      OI_UINT bits = common->bits.uint8[n];
+      uint32_t raw = 0;
+      if (bits) {
+        OI_BITSTREAM_READUINT(raw, bits, ptr, value, bitPtr);
+      }
+      *s++ = (int32_t)raw;
+    }
+  }
+
+  s = common->subdata;
+  OI_SBC_DequantPrepare(&params, common);
+  OI_SBC_DequantFrame_simd(s, &params, iter_count, nrof_blocks);
+
+  if (common->frameInfo.mode == SBC_JOINT_STEREO && common->frameInfo.join) {
+    /* Mid/side of the subbands flagged in the join mask, first subband in its
+     * most significant bit */
+    for (blk = 0; blk < nrof_blocks; ++blk) {
+      OI_UINT sb;
+      for (sb = 0; sb < nrof_subbands; ++sb) {
+        if (common->frameInfo.join & (1 << (nrof_subbands - 1 - sb))) {
+          int32_t mid = s[sb];
+          int32_t side = s[sb + nrof_subbands];
+          s[sb] = mid + side;
+          s[sb + nrof_subbands] = mid - side;
+        }
+      }
+      s += iter_count;
+    }
+  }
+}
+
 /**
 @}
 */
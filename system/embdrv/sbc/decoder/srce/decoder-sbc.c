@@ -136,7 +136,9 @@ static OI_STATUS DecodeBody(OI_CODEC_SBC_DECODER_CONTEXT* context,
     OI_SBC_ComputeBitAllocation(&context->common);
 
     TRACE(("Reading samples"));
-    if (context->common.frameInfo.mode == SBC_JOINT_STEREO) {
+    if (context->simdEnabled) {
+      OI_SBC_ReadSamplesSimd(context, &bs);
+    } else if (context->common.frameInfo.mode == SBC_JOINT_STEREO) {
       OI_SBC_ReadSamplesJoint(context, &bs);
     } else {
       OI_SBC_ReadSamples(context, &bs);
@@ -0,0 +1,383 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/**
+@file
+
+NEON and AVX2 versions of the dequantizer and of the synthesis windows, used
+when OI_SBC_SimdSupported() returns TRUE.
+
+Every output is computed with the same 32-bit products, shifts and wrapping
+sums as SynthWindow80_generated(),
+SynthWindow40_int32_int32_symmetry_with_sum() and OI_SBC_Dequant(), so the
+decoded PCM is identical. Only the order of the additions changes.
+
+The 8-subband window computes the 8 output samples in parallel. Each lane needs
+one term out of every 8 consecutive buffer entries, so the window is walked in
+10 steps, two for each group of 16 entries. With A = buffer[16n + 4 .. 16n + 11]
+the lanes read, in output order:
+
+@code
+    even step:  buffer[16n + 12]  A[1]  A[2]  A[3]  A[4]  A[3]  A[2]  A[1]
+    odd step:   A[0]  A[7]  A[6]  A[5]  A[4]  A[5]  A[6]  A[7]
+@endcode
+
+The 4-subband window computes each output sample as two half sums, in the two
+halves of the vector, from buffer[16n .. 16n + 15] in 5 steps.
+
+@ingroup codec_internal
+*/
+
+/**
+@addtogroup codec_internal
+@{
+*/
+
+#include "oi_codec_sbc_private.h"
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define SBC_DECODER_NEON
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define SBC_DECODER_AVX2
+#define SIMD_TARGET __attribute__((target("avx2")))
+#endif
+
+#if defined(SBC_DECODER_NEON) || defined(SBC_DECODER_AVX2)
+
+/* Coefficients and shifts of SynthWindow80_generated(), per step and then per
+ * output sample. A negative shift is a right shift. */
+static const int16_t window80_coeff[10][8] = {
+    {8235, -3263, -10385, -16457, 10445, 16913, 11167, 9293},
+    {0, 29293, 24995, 19083, 0, -8443, -10337, -6087},
+    {26479, -5229, -309, -23641, -5297, 3687, 1917, 1247},
+    {-23167, 30835, 9161, -29015, 0, -301, -30605, -2893},
+    {9399, -27021, -23063, -12889, 22299, 15447, 8317, 23671},
+    {-17397, 31633, 27561, 6145, 0, 10255, 9553, 18055},
+    {26479, 17319, 2309, 24211, 10603, -18233, 22117, 11537},
+    {17397, 26663, 12705, 23469, 0, 9405, 16383, 1747},
+    {8235, 4555, 6239, 21223, 9539, 1499, 7543, 685},
+    {23167, 12419, 9251, 26913, 0, 26189, 8603, 8721},
+};
+
+static const int32_t window80_shift[10][8] = {
+    {-3, -5, -6, -6, -4, -5, -4, -3}, {0, -5, -5, -5, 0, -7, -4, -2},
+    {-2, 0, 4, -2, 1, 1, 2, 3},       {-3, -3, -3, -4, 0, 5, -1, 3},
+    {3, 1, 1, 2, 2, 2, 3, 2},         {1, 1, 1, 3, 0, 2, 2, 1},
+    {-2, 1, 3, -1, 0, -3, -4, -1},    {1, -2, -1, -2, 0, -1, -2, 1},
+    {-3, -1, -3, -8, -4, -1, -3, 1},  {-3, -4, -4, -6, 0, -7, -6, -7},
+};
+
+/* dec_window_4 coefficients of SynthWindow40_int32_int32_symmetry_with_sum(),
+ * signs included, for output samples 0 to 3 reading buffer[16n + 12],
+ * buffer[16n + 1], buffer[16n + 14] and buffer[16n + 3], then for the same
+ * output samples reading buffer[16n], buffer[16n + 13], nothing and
+ * buffer[16n + 15]. */
+static const int32_t window40_coeff[5][8] = {
+    {694, 97, 338, 495, 0, 704, 0, -554},
+    {4681, 3697, -5214, 5824, 1974, 1109, 0, -14047},
+    {53243, 35274, 44618, 50984, 24529, 50984, 0, 35274},
+    {4681, -14047, 5224, 1109, -24529, 5824, 0, 3697},
+    {694, -554, 270, 704, -1974, 495, 0, 97},
+};
+
+/* Byte indexes of the buffer[16n + x] read by each lane of window40_coeff,
+ * relative to buffer[16n] */
+#define WINDOW40_BYTES(x) (2 * (x)), (2 * (x) + 1)
+static const uint8_t window40_gather[16] = {
+    WINDOW40_BYTES(12), WINDOW40_BYTES(1),  WINDOW40_BYTES(14),
+    WINDOW40_BYTES(3),  WINDOW40_BYTES(0),  WINDOW40_BYTES(13),
+    WINDOW40_BYTES(14), WINDOW40_BYTES(15),
+};
+
+#endif
+
+#if defined(SBC_DECODER_NEON)
+
+PRIVATE OI_BOOL OI_SBC_SimdSupported(void) { return TRUE; }
+
+static void store_pcm8(int16_t* pcm, int16x8_t out, OI_UINT strideShift) {
+  if (strideShift == 0) {
+    vst1q_s16(pcm, out);
+  } else {
+    int16_t samples[8];
+    OI_UINT i;
+    vst1q_s16(samples, out);
+    for (i = 0; i < 8; i++) {
+      pcm[i << 1] = samples[i];
+    }
+  }
+}
+
+PRIVATE void SynthWindow80_simd(int16_t* pcm,
+                                SBC_BUFFER_T const* RESTRICT buffer,
+                                OI_UINT strideShift) {
+  int32x4_t lo = vdupq_n_s32(0);
+  int32x4_t hi = vdupq_n_s32(0);
+  OI_UINT n;
+
+  for (n = 0; n < 5; n++) {
+    int16x8_t a = vld1q_s16(buffer + 16 * n + 4);
+    int16x4_t a_lo = vget_low_s16(a);
+    int16x4_t a_hi = vget_high_s16(a);
+    int16x4_t even_lo = vset_lane_s16(buffer[16 * n + 12], a_lo, 0);
+    int16x4_t even_hi = vrev64_s16(vext_s16(a_lo, a_hi, 1));
+    int16x4_t odd_lo = vrev64_s16(vext_s16(a_hi, a_lo, 1));
+    int16_t const* coeff = window80_coeff[2 * n];
+    int32_t const* shift = window80_shift[2 * n];
+
+    lo = vaddq_s32(lo, vshlq_s32(vmull_s16(even_lo, vld1_s16(coeff)),
+                                 vld1q_s32(shift)));
+    hi = vaddq_s32(hi, vshlq_s32(vmull_s16(even_hi, vld1_s16(coeff + 4)),
+                                 vld1q_s32(shift + 4)));
+    lo = vaddq_s32(lo, vshlq_s32(vmull_s16(odd_lo, vld1_s16(coeff + 8)),
+                                 vld1q_s32(shift + 8)));
+    hi = vaddq_s32(hi, vshlq_s32(vmull_s16(a_hi, vld1_s16(coeff + 12)),
+                                 vld1q_s32(shift + 12)));
+  }
+
+  /* pcm /= 32768, rounding towards zero, then CLIP_INT16 */
+  lo = vshrq_n_s32(
+      vaddq_s32(lo, vandq_s32(vshrq_n_s32(lo, 31), vdupq_n_s32(32767))), 15);
+  hi = vshrq_n_s32(
+      vaddq_s32(hi, vandq_s32(vshrq_n_s32(hi, 31), vdupq_n_s32(32767))), 15);
+  store_pcm8(pcm, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)), strideShift);
+}
+
+PRIVATE void SynthWindow40_simd(int16_t* pcm,
+                                SBC_BUFFER_T const* RESTRICT buffer,
+                                OI_UINT strideShift) {
+  uint8x8_t gather_lo = vld1_u8(window40_gather);
+  uint8x8_t gather_hi = vld1_u8(window40_gather + 8);
+  int32x4_t lo = vdupq_n_s32(0);
+  int32x4_t hi = vdupq_n_s32(0);
+  int32x4_t sum;
+  int16x4_t out;
+  int16_t samples[4];
+  OI_UINT n;
+
+  for (n = 0; n < 5; n++) {
+    uint8x16_t b0 = vreinterpretq_u8_s16(vld1q_s16(buffer + 16 * n));
+    uint8x16_t b1 = vreinterpretq_u8_s16(vld1q_s16(buffer + 16 * n + 8));
+    uint8x8x4_t table = {{vget_low_u8(b0), vget_high_u8(b0), vget_low_u8(b1),
+                          vget_high_u8(b1)}};
+    int16x4_t x_lo = vreinterpret_s16_u8(vtbl4_u8(table, gather_lo));
+    int16x4_t x_hi = vreinterpret_s16_u8(vtbl4_u8(table, gather_hi));
+
+    lo = vmlaq_s32(lo, vmovl_s16(x_lo), vld1q_s32(window40_coeff[n]));
+    hi = vmlaq_s32(hi, vmovl_s16(x_hi), vld1q_s32(window40_coeff[n] + 4));
+  }
+
+  /* SCALE(-pa, 15), then CLIP_INT16 */
+  sum = vsubq_s32(vdupq_n_s32(1 << 14), vaddq_s32(lo, hi));
+  out = vqmovn_s32(vshrq_n_s32(sum, 15));
+  vst1_s16(samples, out);
+  for (n = 0; n < 4; n++) {
+    pcm[n << strideShift] = samples[n];
+  }
+}
+
+PRIVATE void OI_SBC_DequantFrame_simd(int32_t* s,
+                                      const OI_SBC_DEQUANT_PARAMS* params,
+                                      OI_UINT count, OI_UINT nrof_blocks) {
+  do {
+    OI_UINT n;
+    for (n = 0; n < count; n += 4) {
+      uint32x4_t d = vld1q_u32((uint32_t*)s + n);
+      d = vaddq_u32(vshlq_n_u32(d, 1), vdupq_n_u32(1));
+      d = vsubq_u32(vmulq_u32(d, vld1q_u32(params->mult + n)),
+                    vld1q_u32(params->offset + n));
+      vst1q_s32(s + n, vshlq_s32(vreinterpretq_s32_u32(d),
+                                 vnegq_s32(vld1q_s32(params->shift + n))));
+    }
+    s += count;
+  } while (--nrof_blocks);
+}
+
+#elif defined(SBC_DECODER_AVX2)
+
+PRIVATE OI_BOOL OI_SBC_SimdSupported(void) {
+  return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+}
+
+SIMD_TARGET static void store_pcm8(int16_t* pcm, __m128i out,
+                                   OI_UINT strideShift) {
+  if (strideShift == 0) {
+    _mm_storeu_si128((__m128i*)pcm, out);
+  } else {
+    pcm[0] = (int16_t)_mm_extract_epi16(out, 0);
+    pcm[2] = (int16_t)_mm_extract_epi16(out, 1);
+    pcm[4] = (int16_t)_mm_extract_epi16(out, 2);
+    pcm[6] = (int16_t)_mm_extract_epi16(out, 3);
+    pcm[8] = (int16_t)_mm_extract_epi16(out, 4);
+    pcm[10] = (int16_t)_mm_extract_epi16(out, 5);
+    pcm[12] = (int16_t)_mm_extract_epi16(out, 6);
+    pcm[14] = (int16_t)_mm_extract_epi16(out, 7);
+  }
+}
+
+/* Add the terms of one step of the 8-subband window */
+SIMD_TARGET static __m256i window80_step(__m256i acc, __m128i x, OI_UINT step) {
+  __m256i coeff = _mm256_cvtepi16_epi32(
+      _mm_loadu_si128((const __m128i*)window80_coeff[step]));
+  __m256i shift = _mm256_loadu_si256((const __m256i*)window80_shift[step]);
+  __m256i zero = _mm256_setzero_si256();
+  __m256i term = _mm256_mullo_epi32(_mm256_cvtepi16_epi32(x), coeff);
+
+  term = _mm256_sllv_epi32(term, _mm256_max_epi32(shift, zero));
+  term = _mm256_srav_epi32(term,
+                           _mm256_sub_epi32(zero, _mm256_min_epi32(shift, zero)));
+  return _mm256_add_epi32(acc, term);
+}
+
+SIMD_TARGET PRIVATE void SynthWindow80_simd(int16_t* pcm,
+                                            SBC_BUFFER_T const* RESTRICT buffer,
+                                            OI_UINT strideShift) {
+  const __m128i even = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 6, 7, 4, 5,
+                                     2, 3);
+  const __m128i odd = _mm_setr_epi8(0, 1, 14, 15, 12, 13, 10, 11, 8, 9, 10, 11,
+                                    12, 13, 14, 15);
+  __m256i acc = _mm256_setzero_si256();
+  __m128i lo, hi;
+  OI_UINT n;
+
+  for (n = 0; n < 5; n++) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(buffer + 16 * n + 4));
+    acc = window80_step(
+        acc, _mm_insert_epi16(_mm_shuffle_epi8(a, even), buffer[16 * n + 12], 0),
+        2 * n);
+    acc = window80_step(acc, _mm_shuffle_epi8(a, odd), 2 * n + 1);
+  }
+
+  /* pcm /= 32768, rounding towards zero, then CLIP_INT16 */
+  acc = _mm256_srai_epi32(
+      _mm256_add_epi32(acc, _mm256_and_si256(_mm256_srai_epi32(acc, 31),
+                                             _mm256_set1_epi32(32767))),
+      15);
+  lo = _mm256_castsi256_si128(acc);
+  hi = _mm256_extracti128_si256(acc, 1);
+  store_pcm8(pcm, _mm_packs_epi32(lo, hi), strideShift);
+}
+
+/* Products of the dec_window_4 coefficients of window40_coeff[n] with the
+ * buffer[16n .. 16n + 15] they apply to */
+SIMD_TARGET static __m256i window40_step(SBC_BUFFER_T const* RESTRICT buffer,
+                                         __m128i gather, __m128i gather_hi,
+                                         OI_UINT n) {
+  __m128i b0 = _mm_loadu_si128((const __m128i*)(buffer + 16 * n));
+  __m128i b1 = _mm_loadu_si128((const __m128i*)(buffer + 16 * n + 8));
+  /* pshufb yields zero for the indexes with their top bit set */
+  __m128i x = _mm_or_si128(_mm_shuffle_epi8(b0, gather),
+                           _mm_shuffle_epi8(b1, gather_hi));
+  return _mm256_mullo_epi32(
+      _mm256_cvtepi16_epi32(x),
+      _mm256_loadu_si256((const __m256i*)window40_coeff[n]));
+}
+
+SIMD_TARGET PRIVATE void SynthWindow40_simd(int16_t* pcm,
+                                            SBC_BUFFER_T const* RESTRICT buffer,
+                                            OI_UINT strideShift) {
+  const __m128i bytes = _mm_loadu_si128((const __m128i*)window40_gather);
+  /* Bytes of buffer[16n .. 16n + 7], then of buffer[16n + 8 .. 16n + 15] */
+  const __m128i gather =
+      _mm_or_si128(bytes, _mm_cmpgt_epi8(bytes, _mm_set1_epi8(15)));
+  const __m128i gather_hi = _mm_sub_epi8(bytes, _mm_set1_epi8(16));
+  __m256i acc;
+  __m128i sum;
+
+  /* Summed as a tree, the multiplications being the longest latency */
+  acc = _mm256_add_epi32(
+      _mm256_add_epi32(window40_step(buffer, gather, gather_hi, 0),
+                       window40_step(buffer, gather, gather_hi, 1)),
+      _mm256_add_epi32(window40_step(buffer, gather, gather_hi, 2),
+                       window40_step(buffer, gather, gather_hi, 3)));
+  acc = _mm256_add_epi32(acc, window40_step(buffer, gather, gather_hi, 4));
+
+  /* SCALE(-pa, 15), then CLIP_INT16 */
+  sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                      _mm256_extracti128_si256(acc, 1));
+  sum = _mm_srai_epi32(_mm_sub_epi32(_mm_set1_epi32(1 << 14), sum), 15);
+  sum = _mm_packs_epi32(sum, sum);
+  if (strideShift == 0) {
+    _mm_storel_epi64((__m128i*)pcm, sum);
+  } else {
+    pcm[0] = (int16_t)_mm_extract_epi16(sum, 0);
+    pcm[2] = (int16_t)_mm_extract_epi16(sum, 1);
+    pcm[4] = (int16_t)_mm_extract_epi16(sum, 2);
+    pcm[6] = (int16_t)_mm_extract_epi16(sum, 3);
+  }
+}
+
+SIMD_TARGET PRIVATE void OI_SBC_DequantFrame_simd(
+    int32_t* s, const OI_SBC_DEQUANT_PARAMS* params, OI_UINT count,
+    OI_UINT nrof_blocks) {
+  do {
+    OI_UINT n;
+    for (n = 0; n < count; n += 4) {
+      __m128i d = _mm_loadu_si128((const __m128i*)(s + n));
+      d = _mm_add_epi32(_mm_slli_epi32(d, 1), _mm_set1_epi32(1));
+      d = _mm_sub_epi32(
+          _mm_mullo_epi32(d,
+                          _mm_loadu_si128((const __m128i*)(params->mult + n))),
+          _mm_loadu_si128((const __m128i*)(params->offset + n)));
+      _mm_storeu_si128(
+          (__m128i*)(s + n),
+          _mm_srav_epi32(
+              d, _mm_loadu_si128((const __m128i*)(params->shift + n))));
+    }
+    s += count;
+  } while (--nrof_blocks);
+}
+
+#else
+
+PRIVATE OI_BOOL OI_SBC_SimdSupported(void) { return FALSE; }
+
+PRIVATE void SynthWindow80_simd(int16_t* pcm,
+                                SBC_BUFFER_T const* RESTRICT buffer,
+                                OI_UINT strideShift) {
+  SynthWindow80_generated(pcm, buffer, strideShift);
+}
+
+PRIVATE void SynthWindow40_simd(int16_t* pcm,
+                                SBC_BUFFER_T const* RESTRICT buffer,
+                                OI_UINT strideShift) {
+  SynthWindow40_int32_int32_symmetry_with_sum(pcm, (SBC_BUFFER_T*)buffer,
+                                              strideShift);
+}
+
+PRIVATE void OI_SBC_DequantFrame_simd(int32_t* s,
+                                      const OI_SBC_DEQUANT_PARAMS* params,
+                                      OI_UINT count, OI_UINT nrof_blocks) {
+  do {
+    OI_UINT n;
+    for (n = 0; n < count; n++) {
+      uint32_t d =
+          ((uint32_t)s[n] * 2 + 1) * params->mult[n] - params->offset[n];
+      s[n] = (int32_t)d >> params->shift[n];
+    }
+    s += count;
+  } while (--nrof_blocks);
+}
+
+#endif
+
+/**
+@}
+*/
@@ -180,6 +180,26 @@ INLINE int32_t OI_SBC_Dequant(uint32_t raw, OI_UINT scale_factor,
   return result >> (15 - scale_factor);
 }
 
+PRIVATE void OI_SBC_DequantPrepare(OI_SBC_DEQUANT_PARAMS* params,
+                                   const OI_CODEC_SBC_COMMON_CONTEXT* common) {
+  OI_UINT count =
+      common->frameInfo.nrof_channels * common->frameInfo.nrof_subbands;
+  OI_UINT n;
+
+  for (n = 0; n < count; n++) {
+    OI_UINT bits = common->bits.uint8[n];
+    OI_UINT scale_factor = common->scale_factor[n];
+
+    OI_ASSERT(scale_factor <= 15);
+    OI_ASSERT(bits <= 16);
+
+    /* Samples of one bit or less dequantize to 0 */
+    params->mult[n] = bits <= 1 ? 0 : dequant_long_scaled[bits];
+    params->offset[n] = bits <= 1 ? 0 : SBC_DEQUANT_LONG_SCALED_OFFSET;
+    params->shift[n] = 15 - scale_factor;
+  }
+}
+
 /* This version of Dequant does not incorporate the scaling factor of 1.38. It
  * is intended for use with implementations of the filterbank which are
  * hard-coded into a DSP. Output is Q16.4 format, so that after joint stereo
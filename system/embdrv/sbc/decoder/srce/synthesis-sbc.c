@@ -254,6 +254,9 @@ PRIVATE void dct2_8(SBC_BUFFER_T* RESTRICT out, int32_t const* RESTRICT x);
 typedef void (*SYNTH_FRAME)(OI_CODEC_SBC_DECODER_CONTEXT* context, int16_t* pcm,
                             OI_UINT blkstart, OI_UINT blkcount);
 
+typedef void (*SYNTH_WINDOW)(int16_t* pcm, SBC_BUFFER_T const* RESTRICT buffer,
+                             OI_UINT strideShift);
+
 #ifndef COPY_BACKWARD_32BIT_ALIGNED_72_HALFWORDS
 #define COPY_BACKWARD_32BIT_ALIGNED_72_HALFWORDS(dest, src) \
   do {                                                      \
@@ -283,6 +286,7 @@ PRIVATE void OI_SBC_SynthFrame_80(OI_CODEC_SBC_DECODER_CONTEXT* context,
   OI_UINT offset = context->common.filterBufferOffset;
   int32_t* s = context->common.subdata + 8 * nrof_channels * blkstart;
   OI_UINT blkstop = blkstart + blkcount;
+  SYNTH_WINDOW synth = context->simdEnabled ? SynthWindow80_simd : SYNTH80;
 
   for (blk = blkstart; blk < blkstop; blk++) {
     if (offset == 0) {
@@ -303,8 +307,8 @@ PRIVATE void OI_SBC_SynthFrame_80(OI_CODEC_SBC_DECODER_CONTEXT* context,
 
     for (ch = 0; ch < nrof_channels; ch++) {
       DCT2_8(context->common.filterBuffer[ch] + offset, s);
-      SYNTH80(pcm + ch, context->common.filterBuffer[ch] + offset,
-              pcmStrideShift);
+      synth(pcm + ch, context->common.filterBuffer[ch] + offset,
+            pcmStrideShift);
       s += 8;
     }
     pcm += (8 << pcmStrideShift);
@@ -341,8 +345,14 @@ PRIVATE void OI_SBC_SynthFrame_4SB(OI_CODEC_SBC_DECODER_CONTEXT* context,
     }
     for (ch = 0; ch < nrof_channels; ch++) {
       cosineModulateSynth4(context->common.filterBuffer[ch] + offset, s);
-      SynthWindow40_int32_int32_symmetry_with_sum(
-          pcm + ch, context->common.filterBuffer[ch] + offset, pcmStrideShift);
+      if (context->simdEnabled) {
+        SynthWindow40_simd(pcm + ch, context->common.filterBuffer[ch] + offset,
+                           pcmStrideShift);
+      } else {
+        SynthWindow40_int32_int32_symmetry_with_sum(
+            pcm + ch, context->common.filterBuffer[ch] + offset,
+            pcmStrideShift);
+      }
       s += 4;
     }
     pcm += (4 << pcmStrideShift);
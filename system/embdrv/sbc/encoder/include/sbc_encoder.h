@@ -200,6 +200,11 @@ extern uint32_t SBC_Encode(SBC_ENC_PARAMS* strEncParams, int16_t* input,
                            uint8_t* output);
 extern void SBC_Encoder_Init(SBC_ENC_PARAMS* strEncParams);
 
+/* Select the NEON or SSE2 analysis filter when |enable| is true and the
+ * encoder was built for either, and the C one otherwise. Both produce the same
+ * frames. Return true if the SIMD analysis filter is in use. */
+extern bool SBC_Encoder_SetSimd(bool enable);
+
 #ifdef __cplusplus
 }
 #endif
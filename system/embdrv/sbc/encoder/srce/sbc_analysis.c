@@ -1185,6 +1185,142 @@ static int16_t* s16X =
 #endif
 #endif
 
+/* SIMD kernels of WINDOW_PARTIAL_4 and WINDOW_PARTIAL_8. They compute the same
+ * 32 bit wrapping sums of 16x16 bit products, in another order, so that the
+ * encoded frames are bit exact with the C macros above. */
+#if (SBC_ARM_ASM_OPT == FALSE) && (SBC_IPAQ_OPT == TRUE) && \
+    (SBC_IS_64_MULT_IN_WINDOW_ACCU == FALSE)
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define SBC_ANALYSIS_NEON TRUE
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SBC_ANALYSIS_SSE2 TRUE
+#endif
+#endif
+
+#if defined(SBC_ANALYSIS_NEON) || defined(SBC_ANALYSIS_SSE2)
+#define SBC_ANALYSIS_SIMD TRUE
+
+/* Window coefficients laid out so that
+ * s32DCTY[i] = sum of as16Window8[j][i] * s16X[ChOffset + 16 * j + i]
+ * for j in 0..4, which is what WINDOW_PARTIAL_8 computes */
+static const int16_t as16Window8[5][16] = {
+    {0, WIND_8_SUBBANDS_1_0, WIND_8_SUBBANDS_2_0, WIND_8_SUBBANDS_3_0,
+     WIND_8_SUBBANDS_4_0, WIND_8_SUBBANDS_5_0, WIND_8_SUBBANDS_6_0,
+     WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_8_0, WIND_8_SUBBANDS_7_4,
+     WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_5_4, WIND_8_SUBBANDS_4_4,
+     WIND_8_SUBBANDS_3_4, WIND_8_SUBBANDS_2_4, WIND_8_SUBBANDS_1_4},
+    {WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_1, WIND_8_SUBBANDS_2_1,
+     WIND_8_SUBBANDS_3_1, WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_5_1,
+     WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_7_1, WIND_8_SUBBANDS_8_1,
+     WIND_8_SUBBANDS_7_3, WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_5_3,
+     WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_3_3, WIND_8_SUBBANDS_2_3,
+     WIND_8_SUBBANDS_1_3},
+    {WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_2, WIND_8_SUBBANDS_2_2,
+     WIND_8_SUBBANDS_3_2, WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_5_2,
+     WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_7_2, WIND_8_SUBBANDS_8_2,
+     WIND_8_SUBBANDS_7_2, WIND_8_SUBBANDS_6_2, WIND_8_SUBBANDS_5_2,
+     WIND_8_SUBBANDS_4_2, WIND_8_SUBBANDS_3_2, WIND_8_SUBBANDS_2_2,
+     WIND_8_SUBBANDS_1_2},
+    {(int16_t)-WIND_8_SUBBANDS_0_2, WIND_8_SUBBANDS_1_3, WIND_8_SUBBANDS_2_3,
+     WIND_8_SUBBANDS_3_3, WIND_8_SUBBANDS_4_3, WIND_8_SUBBANDS_5_3,
+     WIND_8_SUBBANDS_6_3, WIND_8_SUBBANDS_7_3, WIND_8_SUBBANDS_8_1,
+     WIND_8_SUBBANDS_7_1, WIND_8_SUBBANDS_6_1, WIND_8_SUBBANDS_5_1,
+     WIND_8_SUBBANDS_4_1, WIND_8_SUBBANDS_3_1, WIND_8_SUBBANDS_2_1,
+     WIND_8_SUBBANDS_1_1},
+    {(int16_t)-WIND_8_SUBBANDS_0_1, WIND_8_SUBBANDS_1_4, WIND_8_SUBBANDS_2_4,
+     WIND_8_SUBBANDS_3_4, WIND_8_SUBBANDS_4_4, WIND_8_SUBBANDS_5_4,
+     WIND_8_SUBBANDS_6_4, WIND_8_SUBBANDS_7_4, WIND_8_SUBBANDS_8_0,
+     WIND_8_SUBBANDS_7_0, WIND_8_SUBBANDS_6_0, WIND_8_SUBBANDS_5_0,
+     WIND_8_SUBBANDS_4_0, WIND_8_SUBBANDS_3_0, WIND_8_SUBBANDS_2_0,
+     WIND_8_SUBBANDS_1_0},
+};
+
+/* Same for WINDOW_PARTIAL_4, with
+ * s32DCTY[i] = sum of as16Window4[j][i] * s16X[ChOffset + 8 * j + i] */
+static const int16_t as16Window4[5][8] = {
+    {0, WIND_4_SUBBANDS_1_0, WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_3_0,
+     WIND_4_SUBBANDS_4_0, WIND_4_SUBBANDS_3_4, WIND_4_SUBBANDS_2_4,
+     WIND_4_SUBBANDS_1_4},
+    {WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_1, WIND_4_SUBBANDS_2_1,
+     WIND_4_SUBBANDS_3_1, WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_3,
+     WIND_4_SUBBANDS_2_3, WIND_4_SUBBANDS_1_3},
+    {WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_2, WIND_4_SUBBANDS_2_2,
+     WIND_4_SUBBANDS_3_2, WIND_4_SUBBANDS_4_2, WIND_4_SUBBANDS_3_2,
+     WIND_4_SUBBANDS_2_2, WIND_4_SUBBANDS_1_2},
+    {(int16_t)-WIND_4_SUBBANDS_0_2, WIND_4_SUBBANDS_1_3, WIND_4_SUBBANDS_2_3,
+     WIND_4_SUBBANDS_3_3, WIND_4_SUBBANDS_4_1, WIND_4_SUBBANDS_3_1,
+     WIND_4_SUBBANDS_2_1, WIND_4_SUBBANDS_1_1},
+    {(int16_t)-WIND_4_SUBBANDS_0_1, WIND_4_SUBBANDS_1_4, WIND_4_SUBBANDS_2_4,
+     WIND_4_SUBBANDS_3_4, WIND_4_SUBBANDS_4_0, WIND_4_SUBBANDS_3_0,
+     WIND_4_SUBBANDS_2_0, WIND_4_SUBBANDS_1_0},
+};
+
+/* Accumulate the windowed samples of 8 consecutive s32DCTY entries, reading
+ * the 8 samples of each of the 5 taps |s32Stride| samples apart */
+#if (SBC_ANALYSIS_NEON == TRUE)
+static inline void SbcWindow8Lanes(const int16_t* ps16X,
+                                   const int16_t* ps16Coeff,
+                                   int32_t s32Stride, int32_t* ps32Out) {
+  int16x8_t x = vld1q_s16(ps16X);
+  int16x8_t c = vld1q_s16(ps16Coeff);
+  int32x4_t lo = vmull_s16(vget_low_s16(x), vget_low_s16(c));
+  int32x4_t hi = vmull_s16(vget_high_s16(x), vget_high_s16(c));
+  int32_t j;
+
+  for (j = 1; j < 5; j++) {
+    x = vld1q_s16(ps16X + j * s32Stride);
+    c = vld1q_s16(ps16Coeff + j * s32Stride);
+    lo = vmlal_s16(lo, vget_low_s16(x), vget_low_s16(c));
+    hi = vmlal_s16(hi, vget_high_s16(x), vget_high_s16(c));
+  }
+  vst1q_s32(ps32Out, lo);
+  vst1q_s32(ps32Out + 4, hi);
+}
+#else
+static inline void SbcWindow8Lanes(const int16_t* ps16X,
+                                   const int16_t* ps16Coeff,
+                                   int32_t s32Stride, int32_t* ps32Out) {
+  __m128i lo = _mm_setzero_si128();
+  __m128i hi = _mm_setzero_si128();
+  int32_t j;
+
+  for (j = 0; j < 5; j++) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(ps16X + j * s32Stride));
+    __m128i c = _mm_loadu_si128((const __m128i*)(ps16Coeff + j * s32Stride));
+    /* Full 32 bit products, from their low and high halves */
+    __m128i prod_lo = _mm_mullo_epi16(x, c);
+    __m128i prod_hi = _mm_mulhi_epi16(x, c);
+    lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(prod_lo, prod_hi));
+    hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(prod_lo, prod_hi));
+  }
+  _mm_storeu_si128((__m128i*)ps32Out, lo);
+  _mm_storeu_si128((__m128i*)(ps32Out + 4), hi);
+}
+#endif
+
+static void SbcWindowPartial4Simd(const int16_t* ps16X) {
+  SbcWindow8Lanes(ps16X, as16Window4[0], 8, s32DCTY);
+}
+
+static void SbcWindowPartial8Simd(const int16_t* ps16X) {
+  SbcWindow8Lanes(ps16X, as16Window8[0], 16, s32DCTY);
+  SbcWindow8Lanes(ps16X + 8, as16Window8[0] + 8, 16, s32DCTY + 8);
+}
+
+static bool SbcUseSimd = true;
+#endif /* SBC_ANALYSIS_NEON || SBC_ANALYSIS_SSE2 */
+
+bool SBC_Encoder_SetSimd(bool enable) {
+#if (SBC_ANALYSIS_SIMD == TRUE)
+  SbcUseSimd = enable;
+  return enable;
+#else
+  return false;
+#endif
+}
+
 static int16_t ShiftCounter = 0;
 extern int16_t EncMaxShiftCounter;
 /****************************************************************************
@@ -1257,7 +1393,14 @@ void SbcAnalysisFilter4(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
     for (s32Ch = 0; s32Ch < s32NumOfChannels; s32Ch++) {
       ChOffset = s32Ch * Offset2 + Offset;
 
-      WINDOW_PARTIAL_4
+#if (SBC_ANALYSIS_SIMD == TRUE)
+      if (SbcUseSimd) {
+        SbcWindowPartial4Simd(&s16X[ChOffset]);
+      } else
+#endif
+      {
+        WINDOW_PARTIAL_4
+      }
 
       SBC_FastIDCT4(s32DCTY, ps32SbBuf);
 
@@ -1370,7 +1513,14 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
     for (s32Ch = 0; s32Ch < s32NumOfChannels; s32Ch++) {
       ChOffset = s32Ch * Offset2 + Offset;
 
-      WINDOW_PARTIAL_8
+#if (SBC_ANALYSIS_SIMD == TRUE)
+      if (SbcUseSimd) {
+        SbcWindowPartial8Simd(&s16X[ChOffset]);
+      } else
+#endif
+      {
+        WINDOW_PARTIAL_8
+      }
 
       SBC_FastIDCT8(s32DCTY, ps32SbBuf);
 
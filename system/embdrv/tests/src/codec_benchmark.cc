@@ -0,0 +1,421 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Cost of the embedded codecs per frame, over every configuration the
+// profiles use. Run with --benchmark_format=json (or --benchmark_out=<file>
+// --benchmark_out_format=json) for machine readable results: each entry has
+// the "frame_time" counter, in seconds per frame, and "allocs_per_frame".
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include "aptXHDbtenc.h"
+#include "aptXbtenc.h"
+#include "benchmark/benchmark.h"
+#include "embdrv/g722/g722_enc_dec.h"
+#include "lc3.h"
+#include "oi_codec_sbc.h"
+#include "oi_status.h"
+#include "sbc_encoder.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+// Heap allocations made by the process, to check that the codecs do not
+// allocate once set up. The C codecs get their memory from the caller, so
+// counting the C++ allocations covers them and the helpers in between.
+static size_t allocation_count = 0;
+
+void* operator new(size_t size) {
+  allocation_count++;
+  void* ptr = malloc(std::max<size_t>(size, 1));
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+namespace {
+
+constexpr int kNumFrames = 64;
+constexpr int kMaxFrameSize = 1024;
+
+// Pseudo random input, low pass filtered so that it looks like audio to the
+// psychoacoustic models rather than white noise
+std::vector<int16_t> reference_pcm(size_t num_samples) {
+  std::vector<int16_t> pcm(num_samples);
+  uint32_t seed = 0x12345678;
+  int32_t previous = 0;
+  for (auto& sample : pcm) {
+    seed = seed * 1664525 + 1013904223;
+    previous = (previous + (int16_t)(seed >> 16)) / 2;
+    sample = (int16_t)previous;
+  }
+  return pcm;
+}
+
+// Runs |process_frames|, that handles |kNumFrames| frames, for the duration of
+// the benchmark and reports the cost per frame
+template <typename F>
+void run(State& state, F process_frames) {
+  size_t allocations = allocation_count;
+  for (auto _ : state) {
+    if (!process_frames()) {
+      state.SkipWithError("Codec failure");
+      return;
+    }
+  }
+  allocations = allocation_count - allocations;
+
+  int64_t frames = state.iterations() * kNumFrames;
+  state.SetItemsProcessed(frames);
+  state.counters["frame_time"] = Counter(
+      kNumFrames, Counter::kIsIterationInvariantRate | Counter::kInvert);
+  state.counters["allocs_per_frame"] = Counter((double)allocations / frames);
+}
+
+//
+// SBC, as used by A2DP and HFP wide band speech: the arguments are the
+// sampling frequency, the channel mode, the number of subbands and the bit
+// rate in kbit/s.
+//
+
+void sbc_init(State& state, SBC_ENC_PARAMS* params) {
+  memset(params, 0, sizeof(*params));
+  params->s16SamplingFreq = state.range(0);
+  params->s16ChannelMode = state.range(1);
+  params->s16NumOfSubBands = state.range(2);
+  params->s16NumOfBlocks = SBC_BLOCK_3;
+  params->s16AllocationMethod = SBC_LOUDNESS;
+  params->u16BitRate = state.range(3);
+  SBC_Encoder_Init(params);
+}
+
+size_t sbc_samples_per_frame(const SBC_ENC_PARAMS& params) {
+  return params.s16NumOfSubBands * params.s16NumOfBlocks *
+         params.s16NumOfChannels;
+}
+
+void BM_SbcEncode(State& state) {
+  SBC_ENC_PARAMS params;
+  sbc_init(state, &params);
+  size_t samples_per_frame = sbc_samples_per_frame(params);
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * samples_per_frame);
+  uint8_t frame[kMaxFrameSize];
+
+  run(state, [&]() {
+    for (int i = 0; i < kNumFrames; i++) {
+      if (SBC_Encode(&params, &pcm[i * samples_per_frame], frame) == 0)
+        return false;
+    }
+    ::benchmark::DoNotOptimize(frame);
+    return true;
+  });
+}
+
+void BM_SbcDecode(State& state) {
+  SBC_ENC_PARAMS params;
+  sbc_init(state, &params);
+  size_t samples_per_frame = sbc_samples_per_frame(params);
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * samples_per_frame);
+  std::vector<uint8_t> encoded;
+  uint8_t frame[kMaxFrameSize];
+  for (int i = 0; i < kNumFrames; i++) {
+    uint32_t size = SBC_Encode(&params, &pcm[i * samples_per_frame], frame);
+    encoded.insert(encoded.end(), frame, frame + size);
+  }
+
+  // The decoder expects zeroed memory, as in the static A2DP decoder state
+  OI_CODEC_SBC_DECODER_CONTEXT context = {};
+  OI_CODEC_SBC_CODEC_DATA_STEREO data = {};
+  OI_CODEC_SBC_DecoderReset(&context, data.data, sizeof(data.data), 2, 2,
+                            FALSE);
+  int16_t decoded[SBC_MAX_SAMPLES_PER_FRAME * SBC_MAX_CHANNELS];
+
+  run(state, [&]() {
+    const OI_BYTE* frame_data = encoded.data();
+    uint32_t frame_bytes = encoded.size();
+    while (frame_bytes > 0) {
+      uint32_t pcm_bytes = sizeof(decoded);
+      if (!OI_SUCCESS(OI_CODEC_SBC_DecodeFrame(&context, &frame_data,
+                                               &frame_bytes, decoded,
+                                               &pcm_bytes)))
+        return false;
+    }
+    ::benchmark::DoNotOptimize(decoded);
+    return true;
+  });
+}
+
+void sbc_args(::benchmark::internal::Benchmark* b) {
+  b->ArgNames({"sampling_freq", "channel_mode", "subbands", "kbps"});
+  b->ArgsProduct({{SBC_sf16000, SBC_sf32000, SBC_sf44100, SBC_sf48000},
+                  {SBC_MONO, SBC_DUAL, SBC_STEREO, SBC_JOINT_STEREO},
+                  {4, 8},
+                  {127, 229, 328}});
+}
+
+BENCHMARK(BM_SbcEncode)->Apply(sbc_args);
+BENCHMARK(BM_SbcDecode)->Apply(sbc_args);
+
+//
+// aptX and aptX HD: a frame is one stereo codeword, made of 4 samples per
+// channel. The encoders do not depend on the sampling frequency.
+//
+
+void BM_AptxEncode(State& state) {
+  std::vector<uint8_t> encoder(SizeofAptxbtenc());
+  aptxbtenc_init(encoder.data(), 0);
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * 8);
+
+  run(state, [&]() {
+    uint32_t codeword;
+    for (int i = 0; i < kNumFrames; i++) {
+      uint32_t pcm_l[4];
+      uint32_t pcm_r[4];
+      for (int j = 0; j < 4; j++) {
+        pcm_l[j] = (uint16_t)pcm[8 * i + 2 * j];
+        pcm_r[j] = (uint16_t)pcm[8 * i + 2 * j + 1];
+      }
+      aptxbtenc_encodestereo(encoder.data(), pcm_l, pcm_r, &codeword);
+    }
+    ::benchmark::DoNotOptimize(codeword);
+    return true;
+  });
+}
+BENCHMARK(BM_AptxEncode);
+
+void BM_AptxHdEncode(State& state) {
+  std::vector<uint8_t> encoder(SizeofAptxhdbtenc());
+  aptxhdbtenc_init(encoder.data(), 0);
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * 8);
+
+  run(state, [&]() {
+    uint32_t codewords[2];
+    for (int i = 0; i < kNumFrames; i++) {
+      uint32_t pcm_l[4];
+      uint32_t pcm_r[4];
+      for (int j = 0; j < 4; j++) {
+        // 24 bit samples, sign extended
+        pcm_l[j] = (uint32_t)(int32_t)pcm[8 * i + 2 * j] << 8;
+        pcm_r[j] = (uint32_t)(int32_t)pcm[8 * i + 2 * j + 1] << 8;
+      }
+      aptxhdbtenc_encodestereo(encoder.data(), pcm_l, pcm_r, codewords);
+    }
+    ::benchmark::DoNotOptimize(codewords);
+    return true;
+  });
+}
+BENCHMARK(BM_AptxHdEncode);
+
+//
+// G.722, as used by ASHA on each hearing aid: 16 kHz mono in 10 ms or 20 ms
+// frames. The arguments are the bit rate and the frame duration in ms.
+//
+
+void BM_G722Encode(State& state) {
+  int samples_per_frame = 16 * state.range(1);
+  g722_encode_state_t encoder;
+  g722_encode_init(&encoder, state.range(0), G722_PACKED);
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * samples_per_frame);
+  std::vector<uint8_t> frame(samples_per_frame);
+
+  run(state, [&]() {
+    for (int i = 0; i < kNumFrames; i++) {
+      if (g722_encode(&encoder, frame.data(), &pcm[i * samples_per_frame],
+                      samples_per_frame) <= 0)
+        return false;
+    }
+    ::benchmark::DoNotOptimize(frame.data());
+    return true;
+  });
+}
+
+void BM_G722Decode(State& state) {
+  int samples_per_frame = 16 * state.range(1);
+  g722_encode_state_t encoder;
+  g722_encode_init(&encoder, state.range(0), G722_PACKED);
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * samples_per_frame);
+  std::vector<uint8_t> encoded(pcm.size());
+  int encoded_size =
+      g722_encode(&encoder, encoded.data(), pcm.data(), pcm.size());
+  int frame_size = encoded_size / kNumFrames;
+
+  g722_decode_state_t decoder;
+  g722_decode_init(&decoder, state.range(0), G722_PACKED);
+  std::vector<int16_t> decoded(2 * samples_per_frame);
+
+  run(state, [&]() {
+    for (int i = 0; i < kNumFrames; i++) {
+      if (g722_decode(&decoder, decoded.data(), &encoded[i * frame_size],
+                      frame_size, 0xffff) == 0)
+        return false;
+    }
+    ::benchmark::DoNotOptimize(decoded.data());
+    return true;
+  });
+}
+
+void g722_args(::benchmark::internal::Benchmark* b) {
+  b->ArgNames({"bps", "frame_ms"});
+  b->ArgsProduct({{48000, 56000, 64000}, {10, 20}});
+}
+
+BENCHMARK(BM_G722Encode)->Apply(g722_args);
+BENCHMARK(BM_G722Decode)->Apply(g722_args);
+
+//
+// G.722 for a binaural pair of hearing aids, from interleaved stereo PCM:
+// deinterleaved into two buffers and encoded per side, or encoded in one pass.
+//
+
+void BM_G722EncodeBinaural(State& state) {
+  int samples_per_frame = 16 * state.range(1);
+  g722_encode_state_t left, right;
+  g722_encode_init(&left, state.range(0), G722_PACKED);
+  g722_encode_init(&right, state.range(0), G722_PACKED);
+  std::vector<int16_t> pcm = reference_pcm(2 * kNumFrames * samples_per_frame);
+  std::vector<int16_t> chan_left(samples_per_frame);
+  std::vector<int16_t> chan_right(samples_per_frame);
+  std::vector<uint8_t> frame_left(samples_per_frame);
+  std::vector<uint8_t> frame_right(samples_per_frame);
+
+  run(state, [&]() {
+    for (int i = 0; i < kNumFrames; i++) {
+      const int16_t* p = &pcm[2 * i * samples_per_frame];
+      for (int j = 0; j < samples_per_frame; j++) {
+        chan_left[j] = p[2 * j] >> 1;
+        chan_right[j] = p[2 * j + 1] >> 1;
+      }
+      if (g722_encode(&left, frame_left.data(), chan_left.data(),
+                      samples_per_frame) <= 0 ||
+          g722_encode(&right, frame_right.data(), chan_right.data(),
+                      samples_per_frame) <= 0)
+        return false;
+    }
+    ::benchmark::DoNotOptimize(frame_left.data());
+    ::benchmark::DoNotOptimize(frame_right.data());
+    return true;
+  });
+}
+
+void BM_G722EncodeStereo(State& state) {
+  int samples_per_frame = 16 * state.range(1);
+  g722_encode_state_t left, right;
+  g722_encode_init(&left, state.range(0), G722_PACKED);
+  g722_encode_init(&right, state.range(0), G722_PACKED);
+  std::vector<int16_t> pcm = reference_pcm(2 * kNumFrames * samples_per_frame);
+  std::vector<uint8_t> frame_left(samples_per_frame);
+  std::vector<uint8_t> frame_right(samples_per_frame);
+
+  run(state, [&]() {
+    for (int i = 0; i < kNumFrames; i++) {
+      if (g722_encode_stereo(&left, &right, frame_left.data(),
+                             frame_right.data(),
+                             &pcm[2 * i * samples_per_frame],
+                             samples_per_frame, 1) <= 0)
+        return false;
+    }
+    ::benchmark::DoNotOptimize(frame_left.data());
+    ::benchmark::DoNotOptimize(frame_right.data());
+    return true;
+  });
+}
+
+BENCHMARK(BM_G722EncodeBinaural)->Apply(g722_args);
+BENCHMARK(BM_G722EncodeStereo)->Apply(g722_args);
+
+//
+// LC3, as used by LE Audio on each channel: the arguments are the frame
+// duration in us, the sampling frequency and the bit rate.
+//
+
+int lc3_frame_bytes_for(State& state) {
+  return std::clamp(lc3_frame_bytes(state.range(0), state.range(2)), 20, 400);
+}
+
+void BM_Lc3Encode(State& state) {
+  int dt_us = state.range(0);
+  int sr_hz = state.range(1);
+  int samples_per_frame = lc3_frame_samples(dt_us, sr_hz);
+  int frame_bytes = lc3_frame_bytes_for(state);
+
+  std::vector<uint8_t> mem(lc3_encoder_size(dt_us, sr_hz));
+  lc3_encoder_t encoder = lc3_setup_encoder(dt_us, sr_hz, 0, mem.data());
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * samples_per_frame);
+  std::vector<uint8_t> frame(frame_bytes);
+
+  run(state, [&]() {
+    for (int i = 0; i < kNumFrames; i++) {
+      if (lc3_encode(encoder, LC3_PCM_FORMAT_S16, &pcm[i * samples_per_frame],
+                     1, frame_bytes, frame.data()) != 0)
+        return false;
+    }
+    ::benchmark::DoNotOptimize(frame.data());
+    return true;
+  });
+}
+
+void BM_Lc3Decode(State& state) {
+  int dt_us = state.range(0);
+  int sr_hz = state.range(1);
+  int samples_per_frame = lc3_frame_samples(dt_us, sr_hz);
+  int frame_bytes = lc3_frame_bytes_for(state);
+
+  std::vector<uint8_t> encoder_mem(lc3_encoder_size(dt_us, sr_hz));
+  lc3_encoder_t encoder =
+      lc3_setup_encoder(dt_us, sr_hz, 0, encoder_mem.data());
+  std::vector<int16_t> pcm = reference_pcm(kNumFrames * samples_per_frame);
+  std::vector<uint8_t> encoded(kNumFrames * frame_bytes);
+  for (int i = 0; i < kNumFrames; i++) {
+    lc3_encode(encoder, LC3_PCM_FORMAT_S16, &pcm[i * samples_per_frame], 1,
+               frame_bytes, &encoded[i * frame_bytes]);
+  }
+
+  std::vector<uint8_t> decoder_mem(lc3_decoder_size(dt_us, sr_hz));
+  lc3_decoder_t decoder =
+      lc3_setup_decoder(dt_us, sr_hz, 0, decoder_mem.data());
+
+  run(state, [&]() {
+    for (int i = 0; i < kNumFrames; i++) {
+      if (lc3_decode(decoder, &encoded[i * frame_bytes], frame_bytes,
+                     LC3_PCM_FORMAT_S16, &pcm[i * samples_per_frame],
+                     1) != 0)
+        return false;
+    }
+    ::benchmark::DoNotOptimize(pcm.data());
+    return true;
+  });
+}
+
+void lc3_args(::benchmark::internal::Benchmark* b) {
+  b->ArgNames({"dt_us", "sr_hz", "bps"});
+  b->ArgsProduct({{7500, 10000},
+                  {8000, 16000, 24000, 32000, 48000},
+                  {16000, 32000, 64000, 96000, 124000}});
+}
+
+BENCHMARK(BM_Lc3Encode)->Apply(lc3_args);
+BENCHMARK(BM_Lc3Decode)->Apply(lc3_args);
+
+}  // namespace
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <cmath>
+#include <vector>
+
+#include "embdrv/g722/g722_enc_dec.h"
+
+namespace {
+
+// Interleaved stereo PCM: a full scale chirp on the left channel, and a
+// different signal with some noise on the right channel
+std::vector<int16_t> make_stereo_pcm(size_t frames) {
+  std::vector<int16_t> pcm(2 * frames);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < frames; i++) {
+    double t = i / 16000.0;
+    seed = seed * 1103515245 + 12345;
+    pcm[2 * i] = (int16_t)(32767 * std::sin(2 * M_PI * (200 + 3000 * t) * t));
+    pcm[2 * i + 1] = (int16_t)(12000 * std::sin(2 * M_PI * 1000 * t) +
+                               (int16_t)(seed >> 16) / 8);
+  }
+  return pcm;
+}
+
+class G722StereoEncodeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    g722_encode_init(&left_, 64000, G722_PACKED);
+    g722_encode_init(&right_, 64000, G722_PACKED);
+    g722_encode_init(&ref_left_, 64000, G722_PACKED);
+    g722_encode_init(&ref_right_, 64000, G722_PACKED);
+  }
+
+  // Encodes the |frames| frames of |pcm| from |first| with the reference
+  // encoders, on the deinterleaved channels shifted right by |shift| bits, or
+  // on their mono mix when |mono| is set
+  void reference_encode(const std::vector<int16_t>& pcm, size_t first,
+                        size_t frames, int shift, bool mono,
+                        std::vector<uint8_t>* ref_left,
+                        std::vector<uint8_t>* ref_right) {
+    std::vector<int16_t> l(frames);
+    std::vector<int16_t> r(frames);
+    for (size_t i = 0; i < frames; i++) {
+      int16_t sl = pcm[2 * (first + i)] >> shift;
+      int16_t sr = pcm[2 * (first + i) + 1] >> shift;
+      l[i] = mono ? (sl + sr) >> 1 : sl;
+      r[i] = sr;
+    }
+    std::vector<uint8_t> out(frames / 2);
+    ASSERT_EQ(g722_encode(&ref_left_, out.data(), l.data(), frames),
+              (int)frames / 2);
+    ref_left->insert(ref_left->end(), out.begin(), out.end());
+    if (mono) return;
+    ASSERT_EQ(g722_encode(&ref_right_, out.data(), r.data(), frames),
+              (int)frames / 2);
+    ref_right->insert(ref_right->end(), out.begin(), out.end());
+  }
+
+  g722_encode_state_t left_;
+  g722_encode_state_t right_;
+  g722_encode_state_t ref_left_;
+  g722_encode_state_t ref_right_;
+};
+
+}  // namespace
+
+TEST_F(G722StereoEncodeTest, matches_separate_encodes) {
+  std::vector<int16_t> pcm = make_stereo_pcm(16000);
+  std::vector<uint8_t> out_left;
+  std::vector<uint8_t> out_right;
+  std::vector<uint8_t> ref_left;
+  std::vector<uint8_t> ref_right;
+
+  // Chunks of various sizes, some smaller than the QMF history and some
+  // larger than the deinterleaved block
+  const size_t chunks[] = {2, 160, 320, 22, 480, 4, 1000};
+  size_t first = 0;
+  for (size_t c = 0; first < 16000; c = (c + 1) % 7) {
+    size_t frames = std::min(chunks[c], 16000 - first);
+    std::vector<uint8_t> l(frames / 2);
+    std::vector<uint8_t> r(frames / 2);
+    ASSERT_EQ(g722_encode_stereo(&left_, &right_, l.data(), r.data(),
+                                 &pcm[2 * first], frames, 1),
+              (int)frames / 2);
+    out_left.insert(out_left.end(), l.begin(), l.end());
+    out_right.insert(out_right.end(), r.begin(), r.end());
+    reference_encode(pcm, first, frames, 1, false, &ref_left, &ref_right);
+    first += frames;
+  }
+  EXPECT_EQ(out_left, ref_left);
+  EXPECT_EQ(out_right, ref_right);
+}
+
+TEST_F(G722StereoEncodeTest, single_encoder_encodes_mono_mix) {
+  std::vector<int16_t> pcm = make_stereo_pcm(3200);
+  std::vector<uint8_t> out(1600);
+  std::vector<uint8_t> ref_left;
+  std::vector<uint8_t> ref_right;
+
+  // The right encoder alone, without shift
+  ASSERT_EQ(g722_encode_stereo(nullptr, &right_, nullptr, out.data(),
+                               pcm.data(), 3200, 0),
+            1600);
+  reference_encode(pcm, 0, 3200, 0, true, &ref_left, &ref_right);
+  EXPECT_EQ(out, ref_left);
+}
+
+TEST_F(G722StereoEncodeTest, mixes_with_single_channel_encode) {
+  // The QMF history is shared with g722_encode() on the same state
+  std::vector<int16_t> pcm = make_stereo_pcm(960);
+  std::vector<uint8_t> out_left(480);
+  std::vector<uint8_t> out_right(480);
+  std::vector<uint8_t> ref_left;
+  std::vector<uint8_t> ref_right;
+
+  std::vector<int16_t> mono(160);
+  std::vector<uint8_t> scratch(80);
+  for (size_t i = 0; i < 160; i++) mono[i] = pcm[2 * i];
+  ASSERT_EQ(g722_encode(&left_, scratch.data(), mono.data(), 160), 80);
+  ASSERT_EQ(g722_encode(&ref_left_, scratch.data(), mono.data(), 160), 80);
+  ASSERT_EQ(g722_encode(&right_, scratch.data(), mono.data(), 160), 80);
+  ASSERT_EQ(g722_encode(&ref_right_, scratch.data(), mono.data(), 160), 80);
+
+  ASSERT_EQ(g722_encode_stereo(&left_, &right_, out_left.data(),
+                               out_right.data(), &pcm[320], 800, 0),
+            400);
+  out_left.resize(400);
+  out_right.resize(400);
+  reference_encode(pcm, 160, 800, 0, false, &ref_left, &ref_right);
+  EXPECT_EQ(out_left, ref_left);
+  EXPECT_EQ(out_right, ref_right);
+
+  for (size_t i = 0; i < 160; i++) mono[i] = pcm[2 * (800 + i) + 1];
+  std::vector<uint8_t> a(80);
+  std::vector<uint8_t> b(80);
+  ASSERT_EQ(g722_encode(&right_, a.data(), mono.data(), 160), 80);
+  ASSERT_EQ(g722_encode(&ref_right_, b.data(), mono.data(), 160), 80);
+  EXPECT_EQ(a, b);
+}
+
+TEST_F(G722StereoEncodeTest, rejects_invalid_arguments) {
+  int16_t pcm[8] = {};
+  uint8_t out[4];
+  EXPECT_EQ(g722_encode_stereo(nullptr, nullptr, out, out, pcm, 4, 0), -1);
+  EXPECT_EQ(g722_encode_stereo(&left_, &right_, out, out, pcm, 3, 0), -1);
+  left_.itu_test_mode = 1;
+  EXPECT_EQ(g722_encode_stereo(&left_, &right_, out, out, pcm, 4, 0), -1);
+}
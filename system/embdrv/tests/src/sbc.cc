@@ -0,0 +1,97 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "sbc_encoder.h"
+
+#define NUM_FRAMES 64
+#define MAX_FRAME_SIZE 1024
+
+struct SbcConfig {
+  int16_t num_of_sub_bands;
+  int16_t num_of_blocks;
+  int16_t channel_mode;
+  int16_t allocation_method;
+  uint16_t bit_rate;
+};
+
+class LibSbcEncTest : public ::testing::TestWithParam<SbcConfig> {
+ protected:
+  void TearDown() override { SBC_Encoder_SetSimd(true); }
+
+  // Encode the same pseudo random input, using the SIMD analysis filter or not
+  std::vector<uint8_t> encode(bool use_simd) {
+    const SbcConfig& config = GetParam();
+    SBC_ENC_PARAMS params;
+    memset(&params, 0, sizeof(params));
+    params.s16SamplingFreq = SBC_sf44100;
+    params.s16ChannelMode = config.channel_mode;
+    params.s16NumOfSubBands = config.num_of_sub_bands;
+    params.s16NumOfBlocks = config.num_of_blocks;
+    params.s16AllocationMethod = config.allocation_method;
+    params.u16BitRate = config.bit_rate;
+    SBC_Encoder_SetSimd(use_simd);
+    SBC_Encoder_Init(&params);
+
+    size_t samples_per_frame =
+        params.s16NumOfSubBands * params.s16NumOfBlocks * params.s16NumOfChannels;
+    std::vector<int16_t> pcm(samples_per_frame);
+    std::vector<uint8_t> encoded;
+    uint8_t frame[MAX_FRAME_SIZE];
+    uint32_t seed = 0x12345678;
+
+    for (int i = 0; i < NUM_FRAMES; i++) {
+      for (size_t j = 0; j < samples_per_frame; j++) {
+        seed = seed * 1664525 + 1013904223;
+        pcm[j] = (int16_t)(seed >> 16);
+      }
+      uint32_t size = SBC_Encode(&params, pcm.data(), frame);
+      EXPECT_GT(size, 0u);
+      EXPECT_LE(size, sizeof(frame));
+      encoded.insert(encoded.end(), frame, frame + size);
+    }
+    return encoded;
+  }
+};
+
+TEST_P(LibSbcEncTest, simd_analysis_is_bit_exact) {
+  std::vector<uint8_t> simd = encode(true);
+  std::vector<uint8_t> scalar = encode(false);
+  ASSERT_FALSE(scalar.empty());
+  EXPECT_EQ(simd, scalar);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SbcConfigs, LibSbcEncTest,
+    ::testing::Values(SbcConfig{8, SBC_BLOCK_3, SBC_JOINT_STEREO,
+                                SBC_LOUDNESS, 328},
+                      SbcConfig{8, SBC_BLOCK_3, SBC_STEREO,
+                                SBC_SNR, 229},
+                      SbcConfig{8, SBC_BLOCK_1, SBC_MONO,
+                                SBC_LOUDNESS, 127},
+                      SbcConfig{8, SBC_BLOCK_0, SBC_DUAL,
+                                SBC_SNR, 200},
+                      SbcConfig{4, SBC_BLOCK_3, SBC_JOINT_STEREO,
+                                SBC_LOUDNESS, 328},
+                      SbcConfig{4, SBC_BLOCK_2, SBC_STEREO,
+                                SBC_SNR, 229},
+                      SbcConfig{4, SBC_BLOCK_0, SBC_MONO,
+                                SBC_LOUDNESS, 127}));
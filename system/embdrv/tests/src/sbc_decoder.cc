@@ -0,0 +1,134 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "oi_codec_sbc.h"
+#include "oi_status.h"
+#include "sbc_encoder.h"
+
+#define NUM_FRAMES 64
+#define MAX_FRAME_SIZE 1024
+
+struct SbcDecoderConfig {
+  int16_t num_of_sub_bands;
+  int16_t num_of_blocks;
+  int16_t channel_mode;
+  int16_t allocation_method;
+  uint16_t bit_rate;
+  uint8_t pcm_stride;
+};
+
+class LibSbcDecTest : public ::testing::TestWithParam<SbcDecoderConfig> {
+ protected:
+  void SetUp() override {
+    const SbcDecoderConfig& config = GetParam();
+    SBC_ENC_PARAMS params;
+    memset(&params, 0, sizeof(params));
+    params.s16SamplingFreq = SBC_sf44100;
+    params.s16ChannelMode = config.channel_mode;
+    params.s16NumOfSubBands = config.num_of_sub_bands;
+    params.s16NumOfBlocks = config.num_of_blocks;
+    params.s16AllocationMethod = config.allocation_method;
+    params.u16BitRate = config.bit_rate;
+    SBC_Encoder_Init(&params);
+
+    // Pseudo random input, shaped so that the high subbands get fewer bits
+    size_t samples_per_frame =
+        params.s16NumOfSubBands * params.s16NumOfBlocks * params.s16NumOfChannels;
+    std::vector<int16_t> pcm(samples_per_frame);
+    uint8_t frame[MAX_FRAME_SIZE];
+    uint32_t seed = 0x12345678;
+    int32_t previous = 0;
+
+    for (int i = 0; i < NUM_FRAMES; i++) {
+      for (size_t j = 0; j < samples_per_frame; j++) {
+        seed = seed * 1664525 + 1013904223;
+        previous = (previous + (int16_t)(seed >> 16)) / 2;
+        pcm[j] = (int16_t)previous;
+      }
+      uint32_t size = SBC_Encode(&params, pcm.data(), frame);
+      ASSERT_GT(size, 0u);
+      encoded_.insert(encoded_.end(), frame, frame + size);
+    }
+  }
+
+  // Decode all the frames, using the SIMD dequantizer and synthesis or not
+  std::vector<int16_t> decode(bool use_simd) {
+    const SbcDecoderConfig& config = GetParam();
+    // The decoder expects zeroed memory, as in the static A2DP decoder state
+    OI_CODEC_SBC_DECODER_CONTEXT context = {};
+    OI_CODEC_SBC_CODEC_DATA_STEREO data = {};
+    EXPECT_EQ(OI_CODEC_SBC_DecoderReset(&context, data.data, sizeof(data.data),
+                                        config.pcm_stride, config.pcm_stride,
+                                        FALSE),
+              OI_OK);
+    if (!use_simd) {
+      EXPECT_FALSE(OI_CODEC_SBC_DecoderEnableSimd(&context, FALSE));
+    } else if (!OI_CODEC_SBC_DecoderEnableSimd(&context, TRUE)) {
+      GTEST_LOG_(INFO) << "No SIMD decoder on this CPU";
+    }
+
+    std::vector<int16_t> decoded;
+    int16_t pcm[SBC_MAX_SAMPLES_PER_FRAME * SBC_MAX_CHANNELS];
+    const OI_BYTE* frame_data = encoded_.data();
+    uint32_t frame_bytes = encoded_.size();
+
+    while (frame_bytes > 0) {
+      uint32_t pcm_bytes = sizeof(pcm);
+      OI_STATUS status = OI_CODEC_SBC_DecodeFrame(
+          &context, &frame_data, &frame_bytes, pcm, &pcm_bytes);
+      EXPECT_EQ(status, OI_OK);
+      if (!OI_SUCCESS(status)) break;
+      EXPECT_EQ(pcm_bytes, sizeof(int16_t) * config.num_of_sub_bands *
+                               config.num_of_blocks * config.pcm_stride);
+      decoded.insert(decoded.end(), pcm, pcm + pcm_bytes / sizeof(int16_t));
+    }
+    return decoded;
+  }
+
+  std::vector<uint8_t> encoded_;
+};
+
+TEST_P(LibSbcDecTest, simd_decoding_is_bit_exact) {
+  std::vector<int16_t> simd = decode(true);
+  std::vector<int16_t> scalar = decode(false);
+  ASSERT_EQ(scalar.size(), (size_t)NUM_FRAMES * GetParam().num_of_sub_bands *
+                               GetParam().num_of_blocks *
+                               GetParam().pcm_stride);
+  EXPECT_EQ(simd, scalar);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SbcDecoderConfigs, LibSbcDecTest,
+    ::testing::Values(SbcDecoderConfig{8, SBC_BLOCK_3, SBC_JOINT_STEREO,
+                                       SBC_LOUDNESS, 328, 2},
+                      SbcDecoderConfig{8, SBC_BLOCK_3, SBC_STEREO, SBC_SNR,
+                                       229, 2},
+                      SbcDecoderConfig{8, SBC_BLOCK_0, SBC_DUAL, SBC_SNR, 200,
+                                       2},
+                      SbcDecoderConfig{8, SBC_BLOCK_1, SBC_MONO, SBC_LOUDNESS,
+                                       127, 1},
+                      SbcDecoderConfig{4, SBC_BLOCK_3, SBC_JOINT_STEREO,
+                                       SBC_LOUDNESS, 328, 2},
+                      SbcDecoderConfig{4, SBC_BLOCK_2, SBC_STEREO, SBC_SNR,
+                                       229, 2},
+                      SbcDecoderConfig{4, SBC_BLOCK_1, SBC_MONO, SBC_LOUDNESS,
+                                       127, 1}));
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "oi_codec_sbc.h"
+#include "oi_status.h"
+#include "sbc_encoder.h"
+
+using ::benchmark::State;
+
+namespace {
+
+constexpr int kNumFrames = 128;
+constexpr int kMaxFrameSize = 1024;
+
+// A high quality A2DP stream with the given channel mode
+std::vector<uint8_t> encode(int16_t channel_mode, int16_t num_of_sub_bands) {
+  SBC_ENC_PARAMS params;
+  memset(&params, 0, sizeof(params));
+  params.s16SamplingFreq = SBC_sf44100;
+  params.s16ChannelMode = channel_mode;
+  params.s16NumOfSubBands = num_of_sub_bands;
+  params.s16NumOfBlocks = SBC_BLOCK_3;
+  params.s16AllocationMethod = SBC_LOUDNESS;
+  params.u16BitRate = channel_mode == SBC_MONO ? 127 : 328;
+  SBC_Encoder_Init(&params);
+
+  size_t samples_per_frame =
+      params.s16NumOfSubBands * params.s16NumOfBlocks * params.s16NumOfChannels;
+  std::vector<int16_t> pcm(samples_per_frame);
+  std::vector<uint8_t> encoded;
+  uint8_t frame[kMaxFrameSize];
+  uint32_t seed = 0x12345678;
+  int32_t previous = 0;
+
+  for (int i = 0; i < kNumFrames; i++) {
+    for (size_t j = 0; j < samples_per_frame; j++) {
+      seed = seed * 1664525 + 1013904223;
+      previous = (previous + (int16_t)(seed >> 16)) / 2;
+      pcm[j] = (int16_t)previous;
+    }
+    uint32_t size = SBC_Encode(&params, pcm.data(), frame);
+    encoded.insert(encoded.end(), frame, frame + size);
+  }
+  return encoded;
+}
+
+// Decode the stream as the A2DP sink does, with the SIMD kernels if the first
+// argument is set and the subband count given as second argument
+void decode(State& state, int16_t channel_mode) {
+  std::vector<uint8_t> encoded = encode(channel_mode, state.range(1));
+  OI_CODEC_SBC_DECODER_CONTEXT context = {};
+  OI_CODEC_SBC_CODEC_DATA_STEREO data = {};
+  int16_t pcm[SBC_MAX_SAMPLES_PER_FRAME * SBC_MAX_CHANNELS];
+
+  OI_CODEC_SBC_DecoderReset(&context, data.data, sizeof(data.data), 2, 2,
+                            FALSE);
+  bool use_simd = state.range(0) != 0;
+  if ((OI_CODEC_SBC_DecoderEnableSimd(&context, use_simd) != FALSE) !=
+      use_simd) {
+    state.SkipWithError("No SIMD decoder on this CPU");
+    return;
+  }
+
+  for (auto _ : state) {
+    const OI_BYTE* frame_data = encoded.data();
+    uint32_t frame_bytes = encoded.size();
+    while (frame_bytes > 0) {
+      uint32_t pcm_bytes = sizeof(pcm);
+      if (!OI_SUCCESS(OI_CODEC_SBC_DecodeFrame(&context, &frame_data,
+                                               &frame_bytes, pcm, &pcm_bytes))) {
+        state.SkipWithError("Decoding failure");
+        return;
+      }
+      ::benchmark::DoNotOptimize(pcm);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFrames);
+}
+
+void BM_SbcDecodeMono(State& state) { decode(state, SBC_MONO); }
+BENCHMARK(BM_SbcDecodeMono)->ArgsProduct({{0, 1}, {4, 8}});
+
+void BM_SbcDecodeStereo(State& state) { decode(state, SBC_STEREO); }
+BENCHMARK(BM_SbcDecodeStereo)->ArgsProduct({{0, 1}, {4, 8}});
+
+void BM_SbcDecodeJointStereo(State& state) { decode(state, SBC_JOINT_STEREO); }
+BENCHMARK(BM_SbcDecodeJointStereo)->ArgsProduct({{0, 1}, {4, 8}});
+
+}  // namespace
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark_counters.h"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+
+}  // namespace
+
+// Count the allocations of the whole benchmark binary. The array and nothrow forms call this one.
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    abort();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+namespace bluetooth {
+
+ProcessCounters GetProcessCounters() {
+  ProcessCounters counters;
+  counters.allocations = allocation_count.load(std::memory_order_relaxed);
+  struct rusage usage = {};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    counters.context_switches = usage.ru_nvcsw + usage.ru_nivcsw;
+  }
+  return counters;
+}
+
+void ReportCountersPerItem(
+    ::benchmark::State& state, const ProcessCounters& before, const ProcessCounters& after, uint64_t items) {
+  if (items == 0) {
+    return;
+  }
+  state.counters["allocs_per_item"] =
+      static_cast<double>(after.allocations - before.allocations) / static_cast<double>(items);
+  state.counters["context_switches_per_item"] =
+      static_cast<double>(after.context_switches - before.context_switches) / static_cast<double>(items);
+}
+
+}  // namespace bluetooth
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+
+namespace bluetooth {
+
+// Process wide costs, sampled before and after the measured loop of a benchmark
+struct ProcessCounters {
+  // Calls to operator new, by any thread
+  uint64_t allocations = 0;
+  // Voluntary and involuntary context switches of all the threads of the process
+  uint64_t context_switches = 0;
+};
+
+ProcessCounters GetProcessCounters();
+
+// Report the costs between |before| and |after| divided by |items|, as the allocs_per_item and
+// context_switches_per_item counters of the benchmark
+void ReportCountersPerItem(
+    ::benchmark::State& state, const ProcessCounters& before, const ProcessCounters& after, uint64_t items);
+
+}  // namespace bluetooth
@@ -137,7 +137,9 @@ struct ActivityAttribution::impl {
   }
 
   void on_hci_packet(hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length) {
-    attribution_processor_.OnBtaaPackets(std::move(hci_processor_.OnHciPacket(std::move(packet), type, length)));
+    btaa_packets_.clear();
+    hci_processor_.OnHciPacket(std::move(packet), type, length, btaa_packets_);
+    attribution_processor_.OnBtaaPackets(btaa_packets_);
   }
 
   void on_wakelock_acquired() {
@@ -174,6 +176,8 @@ struct ActivityAttribution::impl {
   AttributionProcessor attribution_processor_;
   HciProcessor hci_processor_;
   WakelockProcessor wakelock_processor_;
+  // Reused for every packet, to not allocate on the HCI path
+  std::vector<BtaaHciPacket> btaa_packets_;
 };
 
 void ActivityAttribution::Capture(const hal::HciPacket& packet, hal::SnoopLogger::PacketType type) {
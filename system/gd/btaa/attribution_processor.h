@@ -16,9 +16,11 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <unordered_map>
 
+#include "common/circular_buffer.h"
 #include "hci_processor.h"
 
 namespace bluetooth {
@@ -38,7 +40,7 @@ struct AddressActivityKey {
 struct AddressActivityKeyHasher {
   std::size_t operator()(const AddressActivityKey& key) const {
     return (
-        (std::hash<std::string>()(key.address.ToString()) ^
+        (std::hash<hci::Address>()(key.address) ^
          (std::hash<unsigned char>()(static_cast<unsigned char>(key.activity)))));
   }
 };
@@ -73,9 +75,56 @@ struct AppWakeupDescriptor {
   virtual ~AppWakeupDescriptor() {}
 };
 
+// Aggregation of the packets of one wakelock window. The table is allocated once and cleared at the end of every
+// window, so that attributing a packet is a probe in a fixed array rather than a map update. The devices seen once the
+// table is full are aggregated per activity under the empty address.
+class WindowAggregationTable {
+ public:
+  static constexpr size_t kMaxEntries = 256;
+
+  void Add(const AddressActivityKey& key, uint16_t byte_count, bool wakeup);
+  void Clear();
+
+  size_t Size() const {
+    return num_entries_ + num_overflow_entries_;
+  }
+
+  // Call func(const AddressActivityKey&, const BtaaAggregationEntry&) for every entry
+  template <typename Func>
+  void ForEach(Func func) const {
+    for (size_t i = 0; i < num_entries_; i++) {
+      const Slot& slot = slots_[used_slots_[i]];
+      func(slot.key, slot.entry);
+    }
+    for (size_t activity = 0; activity < kNumActivities; activity++) {
+      if (overflow_used_[activity]) {
+        func(AddressActivityKey{hci::Address::kEmpty, static_cast<Activity>(activity)}, overflow_[activity]);
+      }
+    }
+  }
+
+ private:
+  // Twice as many slots as entries, to keep the probe sequences short
+  static constexpr size_t kNumSlots = 2 * kMaxEntries;
+  static constexpr size_t kNumActivities = static_cast<size_t>(Activity::VENDOR) + 1;
+
+  struct Slot {
+    AddressActivityKey key;
+    BtaaAggregationEntry entry;
+    bool used;
+  };
+
+  std::array<Slot, kNumSlots> slots_{};
+  std::array<uint16_t, kMaxEntries> used_slots_{};
+  size_t num_entries_ = 0;
+  std::array<BtaaAggregationEntry, kNumActivities> overflow_{};
+  std::array<bool, kNumActivities> overflow_used_{};
+  size_t num_overflow_entries_ = 0;
+};
+
 class AttributionProcessor {
  public:
-  void OnBtaaPackets(std::vector<BtaaHciPacket> btaa_packets);
+  void OnBtaaPackets(const std::vector<BtaaHciPacket>& btaa_packets);
   void OnWakelockReleased(uint32_t duration_ms);
   void OnWakeup();
   void NotifyActivityAttributionInfo(int uid, const std::string& package_name, const std::string& device_address);
@@ -98,7 +147,7 @@ class AttributionProcessor {
   NowFunc now_func_ = std::chrono::system_clock::now;
   bool wakeup_ = false;
   std::unordered_map<AddressActivityKey, BtaaAggregationEntry, AddressActivityKeyHasher> btaa_aggregator_;
-  std::unordered_map<AddressActivityKey, BtaaAggregationEntry, AddressActivityKeyHasher> wakelock_duration_aggregator_;
+  WindowAggregationTable wakelock_duration_aggregator_;
   std::unordered_map<std::string, std::string> address_app_map_;
   std::unordered_map<AppActivityKey, BtaaAggregationEntry, AppActivityKeyHasher> app_activity_aggregator_;
   common::TimestampedCircularBuffer<DeviceWakeupDescriptor> device_wakeup_aggregator_ =
@@ -28,6 +28,7 @@ struct CmdEvtActivityClassification {
   uint16_t address_pos;
 };
 
+// Classify a packet by its code, in constant time
 CmdEvtActivityClassification lookup_cmd(hci::OpCode opcode);
 CmdEvtActivityClassification lookup_event(hci::EventCode event_code);
 CmdEvtActivityClassification lookup_le_event(hci::SubeventCode subevent_code);
@@ -49,7 +49,12 @@ struct PendingCommand {
 
 class HciProcessor {
  public:
-  std::vector<BtaaHciPacket> OnHciPacket(hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length);
+  // Append the attributed packets to btaa_hci_packets, which the caller reuses across packets
+  void OnHciPacket(
+      hal::HciPacket packet,
+      hal::SnoopLogger::PacketType type,
+      uint16_t length,
+      std::vector<BtaaHciPacket>& btaa_hci_packets);
 
  private:
   void process_le_event(std::vector<BtaaHciPacket>& btaa_hci_packets, int16_t byte_count, hci::EventView& event);
@@ -32,20 +32,57 @@ static const int kByteCountTransientDeviceActivityEntry = 200;
 static const int kDurationTransientDeviceActivityEntrySecs = 900;
 static const int kMapSizeTrimDownAggregationEntry = 200;
 
-void AttributionProcessor::OnBtaaPackets(std::vector<BtaaHciPacket> btaa_packets) {
+void WindowAggregationTable::Add(const AddressActivityKey& key, uint16_t byte_count, bool wakeup) {
+  // Fibonacci hashing spreads the low entropy bits of the address over the table
+  size_t index = (AddressActivityKeyHasher()(key) * 0x9E3779B97F4A7C15ull) % kNumSlots;
+  while (slots_[index].used && !(slots_[index].key == key)) {
+    index = (index + 1) % kNumSlots;
+  }
+
+  BtaaAggregationEntry* entry;
+  if (slots_[index].used) {
+    entry = &slots_[index].entry;
+  } else if (num_entries_ < kMaxEntries) {
+    slots_[index].used = true;
+    slots_[index].key = key;
+    slots_[index].entry = {};
+    used_slots_[num_entries_++] = index;
+    entry = &slots_[index].entry;
+  } else {
+    size_t activity = static_cast<size_t>(key.activity);
+    if (!overflow_used_[activity]) {
+      overflow_used_[activity] = true;
+      overflow_[activity] = {};
+      num_overflow_entries_++;
+    }
+    entry = &overflow_[activity];
+  }
+
+  entry->byte_count += byte_count;
+  if (wakeup) {
+    entry->wakeup_count += 1;
+  }
+}
+
+void WindowAggregationTable::Clear() {
+  for (size_t i = 0; i < num_entries_; i++) {
+    slots_[used_slots_[i]].used = false;
+  }
+  num_entries_ = 0;
+  overflow_used_.fill(false);
+  num_overflow_entries_ = 0;
+}
+
+void AttributionProcessor::OnBtaaPackets(const std::vector<BtaaHciPacket>& btaa_packets) {
   AddressActivityKey key;
 
   for (auto& btaa_packet : btaa_packets) {
     key.address = btaa_packet.address;
     key.activity = btaa_packet.activity;
 
-    if (wakelock_duration_aggregator_.find(key) == wakelock_duration_aggregator_.end()) {
-      wakelock_duration_aggregator_[key] = {};
-    }
-    wakelock_duration_aggregator_[key].byte_count += btaa_packet.byte_count;
+    wakelock_duration_aggregator_.Add(key, btaa_packet.byte_count, wakeup_);
 
     if (wakeup_) {
-      wakelock_duration_aggregator_[key].wakeup_count += 1;
       device_wakeup_aggregator_.Push(std::move(DeviceWakeupDescriptor(btaa_packet.activity, btaa_packet.address)));
       std::string package_info = kUnknownPackageInfo;
       std::string address = btaa_packet.address.ToString();
@@ -61,43 +98,46 @@ void AttributionProcessor::OnBtaaPackets(std::vector<BtaaHciPacket> btaa_packets
 void AttributionProcessor::OnWakelockReleased(uint32_t duration_ms) {
   uint32_t total_byte_count = 0;
 
-  for (auto& it : wakelock_duration_aggregator_) {
-    total_byte_count += it.second.byte_count;
-  }
+  wakelock_duration_aggregator_.ForEach(
+      [&total_byte_count](const AddressActivityKey& /* address_activity */, const BtaaAggregationEntry& entry) {
+        total_byte_count += entry.byte_count;
+      });
 
   if (total_byte_count == 0) {
     return;
   }
 
   auto cur_time = now_func_();
-  for (auto& it : wakelock_duration_aggregator_) {
-    it.second.wakelock_duration_ms = (uint64_t)duration_ms * it.second.byte_count / total_byte_count;
-    if (btaa_aggregator_.find(it.first) == btaa_aggregator_.end()) {
-      btaa_aggregator_[it.first] = {};
-      btaa_aggregator_[it.first].creation_time = cur_time;
+  wakelock_duration_aggregator_.ForEach([&](const AddressActivityKey& address_activity,
+                                            const BtaaAggregationEntry& entry) {
+    uint32_t wakelock_duration_ms = (uint64_t)duration_ms * entry.byte_count / total_byte_count;
+    if (btaa_aggregator_.find(address_activity) == btaa_aggregator_.end()) {
+      btaa_aggregator_[address_activity] = {};
+      btaa_aggregator_[address_activity].creation_time = cur_time;
     }
 
     auto elapsed_time_sec =
-        std::chrono::duration_cast<std::chrono::seconds>(cur_time - btaa_aggregator_[it.first].creation_time).count();
+        std::chrono::duration_cast<std::chrono::seconds>(cur_time - btaa_aggregator_[address_activity].creation_time)
+            .count();
     if (elapsed_time_sec > kDurationToKeepDeviceActivityEntrySecs) {
-      btaa_aggregator_[it.first].wakeup_count = 0;
-      btaa_aggregator_[it.first].byte_count = 0;
-      btaa_aggregator_[it.first].wakelock_duration_ms = 0;
-      btaa_aggregator_[it.first].creation_time = cur_time;
+      btaa_aggregator_[address_activity].wakeup_count = 0;
+      btaa_aggregator_[address_activity].byte_count = 0;
+      btaa_aggregator_[address_activity].wakelock_duration_ms = 0;
+      btaa_aggregator_[address_activity].creation_time = cur_time;
     }
 
-    btaa_aggregator_[it.first].wakeup_count += it.second.wakeup_count;
-    btaa_aggregator_[it.first].byte_count += it.second.byte_count;
-    btaa_aggregator_[it.first].wakelock_duration_ms += it.second.wakelock_duration_ms;
+    btaa_aggregator_[address_activity].wakeup_count += entry.wakeup_count;
+    btaa_aggregator_[address_activity].byte_count += entry.byte_count;
+    btaa_aggregator_[address_activity].wakelock_duration_ms += wakelock_duration_ms;
 
-    std::string address = it.first.address.ToString();
+    std::string address = address_activity.address.ToString();
     std::string package_info = kUnknownPackageInfo;
     if (address_app_map_.find(address) != address_app_map_.end()) {
       package_info = address_app_map_[address];
     }
     AppActivityKey key;
     key.app = package_info;
-    key.activity = it.first.activity;
+    key.activity = address_activity.activity;
 
     if (app_activity_aggregator_.find(key) == app_activity_aggregator_.end()) {
       app_activity_aggregator_[key] = {};
@@ -114,11 +154,11 @@ void AttributionProcessor::OnWakelockReleased(uint32_t duration_ms) {
       app_activity_aggregator_[key].creation_time = cur_time;
     }
 
-    app_activity_aggregator_[key].wakeup_count += it.second.wakeup_count;
-    app_activity_aggregator_[key].byte_count += it.second.byte_count;
-    app_activity_aggregator_[key].wakelock_duration_ms += it.second.wakelock_duration_ms;
-  }
-  wakelock_duration_aggregator_.clear();
+    app_activity_aggregator_[key].wakeup_count += entry.wakeup_count;
+    app_activity_aggregator_[key].byte_count += entry.byte_count;
+    app_activity_aggregator_[key].wakelock_duration_ms += wakelock_duration_ms;
+  });
+  wakelock_duration_aggregator_.Clear();
 
   if (btaa_aggregator_.size() <= kMapSizeTrimDownAggregationEntry &&
       app_activity_aggregator_.size() <= kMapSizeTrimDownAggregationEntry) {
@@ -83,3 +83,53 @@ TEST_F(AttributionProcessorTest, UAFInOnWakelockReleasedRegressionTest) {
   pAttProc->OnBtaaPackets(btaaPackets);
   pAttProc->OnWakelockReleased(100);
 }
+
+TEST(WindowAggregationTableTest, AggregatesPerAddressAndActivity) {
+  WindowAggregationTable table;
+  Address addr;
+  ASSERT_TRUE(Address::FromString("21:43:65:87:a9:10", addr));
+
+  table.Add(AddressActivityKey{addr, Activity::ACL}, 10, false);
+  table.Add(AddressActivityKey{addr, Activity::ACL}, 20, true);
+  table.Add(AddressActivityKey{addr, Activity::SCAN}, 5, false);
+  ASSERT_EQ(table.Size(), 2u);
+
+  table.ForEach([](const AddressActivityKey& key, const BtaaAggregationEntry& entry) {
+    if (key.activity == Activity::ACL) {
+      ASSERT_EQ(entry.byte_count, 30u);
+      ASSERT_EQ(entry.wakeup_count, 1u);
+    } else {
+      ASSERT_EQ(key.activity, Activity::SCAN);
+      ASSERT_EQ(entry.byte_count, 5u);
+      ASSERT_EQ(entry.wakeup_count, 0u);
+    }
+  });
+
+  table.Clear();
+  ASSERT_EQ(table.Size(), 0u);
+  table.Add(AddressActivityKey{addr, Activity::ACL}, 1, false);
+  table.ForEach([](const AddressActivityKey& /* key */, const BtaaAggregationEntry& entry) {
+    ASSERT_EQ(entry.byte_count, 1u);
+  });
+}
+
+TEST(WindowAggregationTableTest, OverflowIsAggregatedPerActivity) {
+  WindowAggregationTable table;
+  Address addr;
+  for (size_t i = 0; i < WindowAggregationTable::kMaxEntries + 10; i++) {
+    ASSERT_TRUE(Address::FromString(base::StringPrintf("21:43:65:87:%02zx:%02zx", i / 256, i % 256), addr));
+    table.Add(AddressActivityKey{addr, Activity::ACL}, 1, false);
+  }
+  ASSERT_EQ(table.Size(), WindowAggregationTable::kMaxEntries + 1);
+
+  uint32_t total_byte_count = 0;
+  uint32_t overflow_byte_count = 0;
+  table.ForEach([&](const AddressActivityKey& key, const BtaaAggregationEntry& entry) {
+    total_byte_count += entry.byte_count;
+    if (key.address.IsEmpty()) {
+      overflow_byte_count += entry.byte_count;
+    }
+  });
+  ASSERT_EQ(total_byte_count, WindowAggregationTable::kMaxEntries + 10);
+  ASSERT_EQ(overflow_byte_count, 10u);
+}
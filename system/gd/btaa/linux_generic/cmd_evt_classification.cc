@@ -16,10 +16,14 @@
 
 #include "btaa/cmd_evt_classification.h"
 
+#include <array>
+
 namespace bluetooth {
 namespace activity_attribution {
 
-CmdEvtActivityClassification lookup_cmd(hci::OpCode opcode) {
+namespace {
+
+CmdEvtActivityClassification classify_cmd(hci::OpCode opcode) {
   CmdEvtActivityClassification classification = {};
   switch (opcode) {
     case hci::OpCode::INQUIRY:
@@ -327,7 +331,7 @@ CmdEvtActivityClassification lookup_cmd(hci::OpCode opcode) {
   return classification;
 }
 
-CmdEvtActivityClassification lookup_event(hci::EventCode event_code) {
+CmdEvtActivityClassification classify_event(hci::EventCode event_code) {
   CmdEvtActivityClassification classification = {};
   switch (event_code) {
     case hci::EventCode::INQUIRY_COMPLETE:
@@ -397,7 +401,7 @@ CmdEvtActivityClassification lookup_event(hci::EventCode event_code) {
   return classification;
 }
 
-CmdEvtActivityClassification lookup_le_event(hci::SubeventCode subevent_code) {
+CmdEvtActivityClassification classify_le_event(hci::SubeventCode subevent_code) {
   CmdEvtActivityClassification classification = {};
   switch (subevent_code) {
     case hci::SubeventCode::CONNECTION_COMPLETE:
@@ -461,5 +465,56 @@ CmdEvtActivityClassification lookup_le_event(hci::SubeventCode subevent_code) {
   return classification;
 }
 
+// Commands are looked up by OGF and OCF, the tables cover the OCFs of every OGF up to the LE controller commands
+constexpr uint16_t kNumTableOgfs = 0x09;
+constexpr uint16_t kNumTableOcfs = 0x100;
+constexpr uint16_t kOcfMask = 0x3ff;
+constexpr uint16_t kOgfShift = 10;
+
+// The classification of every command, event and LE event code, computed once from the switches above so that
+// classifying a packet is a single array access
+struct ClassificationTables {
+  std::array<CmdEvtActivityClassification, kNumTableOgfs * kNumTableOcfs> commands;
+  std::array<CmdEvtActivityClassification, 0x100> events;
+  std::array<CmdEvtActivityClassification, 0x100> le_events;
+
+  ClassificationTables() {
+    for (uint16_t ogf = 0; ogf < kNumTableOgfs; ogf++) {
+      for (uint16_t ocf = 0; ocf < kNumTableOcfs; ocf++) {
+        commands[ogf * kNumTableOcfs + ocf] = classify_cmd(static_cast<hci::OpCode>((ogf << kOgfShift) | ocf));
+      }
+    }
+    for (uint16_t code = 0; code < events.size(); code++) {
+      events[code] = classify_event(static_cast<hci::EventCode>(code));
+      le_events[code] = classify_le_event(static_cast<hci::SubeventCode>(code));
+    }
+  }
+};
+
+const ClassificationTables& get_tables() {
+  static const ClassificationTables* tables = new ClassificationTables();
+  return *tables;
+}
+
+}  // namespace
+
+CmdEvtActivityClassification lookup_cmd(hci::OpCode opcode) {
+  uint16_t value = static_cast<uint16_t>(opcode);
+  uint16_t ogf = value >> kOgfShift;
+  uint16_t ocf = value & kOcfMask;
+  if (ogf < kNumTableOgfs && ocf < kNumTableOcfs) {
+    return get_tables().commands[ogf * kNumTableOcfs + ocf];
+  }
+  return classify_cmd(opcode);
+}
+
+CmdEvtActivityClassification lookup_event(hci::EventCode event_code) {
+  return get_tables().events[static_cast<uint8_t>(event_code)];
+}
+
+CmdEvtActivityClassification lookup_le_event(hci::SubeventCode subevent_code) {
+  return get_tables().le_events[static_cast<uint8_t>(subevent_code)];
+}
+
 }  // namespace activity_attribution
 }  // namespace bluetooth
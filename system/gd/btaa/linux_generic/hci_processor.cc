@@ -240,9 +240,11 @@ void HciProcessor::process_iso(
   btaa_hci_packets.push_back(BtaaHciPacket(Activity::ISO, address_value, byte_count));
 }
 
-std::vector<BtaaHciPacket> HciProcessor::OnHciPacket(
-    hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length) {
-  std::vector<BtaaHciPacket> btaa_hci_packets;
+void HciProcessor::OnHciPacket(
+    hal::HciPacket packet,
+    hal::SnoopLogger::PacketType type,
+    uint16_t length,
+    std::vector<BtaaHciPacket>& btaa_hci_packets) {
   auto packet_view = packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(packet));
   switch (type) {
     case hal::SnoopLogger::PacketType::CMD:
@@ -261,7 +263,6 @@ std::vector<BtaaHciPacket> HciProcessor::OnHciPacket(
       process_iso(btaa_hci_packets, packet_view, length);
       break;
   }
-  return btaa_hci_packets;
 }
 
 }  // namespace activity_attribution
@@ -16,10 +16,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace bluetooth {
 namespace common {
@@ -45,6 +47,18 @@ class BlockingQueue {
     return data;
   };
 
+  // Take up to max_count items without blocking, in the order they were pushed
+  std::vector<T> take_up_to(size_t max_count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<T> items;
+    items.reserve(std::min(max_count, queue_.size()));
+    while (!queue_.empty() && items.size() < max_count) {
+      items.push_back(std::move(queue_.front()));
+      queue_.pop();
+    }
+    return items;
+  }
+
   // Returns true if take() will not block within a time period
   bool wait_to_take(std::chrono::milliseconds time) {
     std::unique_lock<std::mutex> lock(mutex_);
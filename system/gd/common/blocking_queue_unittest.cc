@@ -69,6 +69,17 @@ TEST_F(BlockingQueueTest, same_thread_push_and_pop_batch) {
   EXPECT_TRUE(queue_.empty());
 }
 
+TEST_F(BlockingQueueTest, take_up_to) {
+  EXPECT_TRUE(queue_.take_up_to(4).empty());
+  for (int data = 0; data < 10; data++) {
+    queue_.push(data);
+  }
+  EXPECT_EQ(queue_.take_up_to(4), std::vector<int>({0, 1, 2, 3}));
+  EXPECT_EQ(queue_.take_up_to(4), std::vector<int>({4, 5, 6, 7}));
+  EXPECT_EQ(queue_.take_up_to(4), std::vector<int>({8, 9}));
+  EXPECT_TRUE(queue_.empty());
+}
+
 TEST_F(BlockingQueueTest, clear_queue) {
   for (int data = 0; data < 10; data++) {
     queue_.push(data);
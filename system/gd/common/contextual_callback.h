@@ -18,6 +18,7 @@
 
 #include "common/bind.h"
 #include "common/callback.h"
+#include "common/inline_closure.h"
 
 namespace bluetooth {
 namespace common {
@@ -26,8 +27,21 @@ class IPostableContext {
  public:
   virtual ~IPostableContext(){};
   virtual void Post(OnceClosure closure) = 0;
+  // Contexts which can queue an InlineClosure as is override this, so that posting it does not allocate
+  virtual void Post(InlineClosure closure) {
+    Post(std::move(closure).IntoOnceClosure());
+  }
 };
 
+// Bind the arguments of an invocation to callback, without allocating when they fit in an InlineClosure
+template <typename Callback, typename... Args>
+InlineClosure BindArguments(Callback&& callback, Args&&... args) {
+  return InlineClosure([callback = std::forward<Callback>(callback),
+                        args = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable {
+    std::apply([&callback](auto&&... unpacked) { std::move(callback).Run(std::move(unpacked)...); }, std::move(args));
+  });
+}
+
 template <typename R, typename... Args>
 class ContextualOnceCallback;
 
@@ -46,12 +60,12 @@ class ContextualOnceCallback<R(Args...)> {
   ContextualOnceCallback& operator=(ContextualOnceCallback&&) noexcept = default;
 
   void Invoke(Args... args) {
-    context_->Post(common::BindOnce(std::move(callback_), std::forward<Args>(args)...));
+    context_->Post(BindArguments(std::move(callback_), std::forward<Args>(args)...));
   }
 
   void InvokeIfNotEmpty(Args... args) {
     if (context_ != nullptr) {
-      context_->Post(common::BindOnce(std::move(callback_), std::forward<Args>(args)...));
+      context_->Post(BindArguments(std::move(callback_), std::forward<Args>(args)...));
     }
   }
 
@@ -61,7 +75,7 @@ class ContextualOnceCallback<R(Args...)> {
 
  private:
   common::OnceCallback<R(Args...)> callback_;
-  IPostableContext* context_;
+  IPostableContext* context_ = nullptr;
 };
 
 template <typename R, typename... Args>
@@ -82,12 +96,12 @@ class ContextualCallback<R(Args...)> {
   ContextualCallback& operator=(ContextualCallback&&) noexcept = default;
 
   void Invoke(Args... args) {
-    context_->Post(common::BindOnce(callback_, std::forward<Args>(args)...));
+    context_->Post(BindArguments(callback_, std::forward<Args>(args)...));
   }
 
   void InvokeIfNotEmpty(Args... args) {
     if (context_ != nullptr) {
-      context_->Post(common::BindOnce(callback_, std::forward<Args>(args)...));
+      context_->Post(BindArguments(callback_, std::forward<Args>(args)...));
     }
   }
 
@@ -97,7 +111,7 @@ class ContextualCallback<R(Args...)> {
 
  private:
   common::Callback<R(Args...)> callback_;
-  IPostableContext* context_;
+  IPostableContext* context_ = nullptr;
 };
 
 }  // namespace common
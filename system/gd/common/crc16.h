@@ -0,0 +1,77 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace bluetooth {
+namespace common {
+
+// CRC-16 with the polynomial x^16 + x^15 + x^2 + 1 (0x8005), reflected, as used by the Frame Check Sequence of L2CAP.
+// Bytes are processed eight at a time with one table per byte position (slice-by-8).
+namespace crc16_internal {
+
+using Table = std::array<uint16_t, 256>;
+
+constexpr uint16_t kReflectedPolynomial = 0xa001;
+
+constexpr std::array<Table, 8> GenerateTables() {
+  std::array<Table, 8> tables{};
+  for (uint16_t i = 0; i < 256; i++) {
+    uint16_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ kReflectedPolynomial : crc >> 1;
+    }
+    tables[0][i] = crc;
+  }
+  for (size_t slice = 1; slice < tables.size(); slice++) {
+    for (size_t i = 0; i < 256; i++) {
+      uint16_t previous = tables[slice - 1][i];
+      tables[slice][i] = (previous >> 8) ^ tables[0][previous & 0xff];
+    }
+  }
+  return tables;
+}
+
+inline constexpr std::array<Table, 8> kTables = GenerateTables();
+
+}  // namespace crc16_internal
+
+// Return the CRC of crc updated with one byte
+constexpr uint16_t Crc16Update(uint16_t crc, uint8_t byte) {
+  return (crc >> 8) ^ crc16_internal::kTables[0][(crc ^ byte) & 0xff];
+}
+
+// Return the CRC of crc updated with the length bytes at data
+inline uint16_t Crc16Update(uint16_t crc, const uint8_t* data, size_t length) {
+  const auto& t = crc16_internal::kTables;
+  while (length >= 8) {
+    crc = t[7][(crc ^ data[0]) & 0xff] ^ t[6][((crc >> 8) ^ data[1]) & 0xff] ^ t[5][data[2]] ^ t[4][data[3]] ^
+          t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+    data += 8;
+    length -= 8;
+  }
+  while (length--) {
+    crc = Crc16Update(crc, *data++);
+  }
+  return crc;
+}
+
+}  // namespace common
+}  // namespace bluetooth
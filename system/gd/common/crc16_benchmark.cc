@@ -0,0 +1,57 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/crc16.h"
+
+using ::benchmark::State;
+using ::bluetooth::common::Crc16Update;
+
+namespace {
+
+// FCS of an ERTM frame, from a minimal frame to the largest one fitting in the default L2CAP MTU
+void BM_Crc16(State& state) {
+  std::vector<uint8_t> frame(state.range(0));
+  for (size_t i = 0; i < frame.size(); i++) {
+    frame[i] = static_cast<uint8_t>(i);
+  }
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(Crc16Update(0, frame.data(), frame.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_Crc16)->Arg(64)->Arg(256)->Arg(672)->Arg(1021);
+
+// Same frames one byte at a time, as the table lookup used before
+void BM_Crc16ByteByByte(State& state) {
+  std::vector<uint8_t> frame(state.range(0));
+  for (size_t i = 0; i < frame.size(); i++) {
+    frame[i] = static_cast<uint8_t>(i);
+  }
+  for (auto _ : state) {
+    uint16_t crc = 0;
+    for (uint8_t byte : frame) {
+      crc = Crc16Update(crc, byte);
+    }
+    ::benchmark::DoNotOptimize(crc);
+  }
+  state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_Crc16ByteByByte)->Arg(64)->Arg(256)->Arg(672)->Arg(1021);
+
+}  // namespace
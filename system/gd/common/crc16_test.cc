@@ -0,0 +1,65 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/crc16.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace testing {
+
+using bluetooth::common::Crc16Update;
+
+// Bit by bit reference implementation
+uint16_t reference_crc16(uint16_t crc, const std::vector<uint8_t>& data) {
+  for (uint8_t byte : data) {
+    crc ^= byte;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+    }
+  }
+  return crc;
+}
+
+TEST(Crc16Test, check_value) {
+  std::vector<uint8_t> data = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  ASSERT_EQ(0xbb3d, Crc16Update(0, data.data(), data.size()));
+}
+
+TEST(Crc16Test, same_as_reference_for_all_lengths) {
+  std::vector<uint8_t> data;
+  for (size_t length = 0; length < 64; length++) {
+    ASSERT_EQ(reference_crc16(0x1234, data), Crc16Update(0x1234, data.data(), data.size())) << "length " << length;
+    data.push_back(static_cast<uint8_t>(length * 37 + 11));
+  }
+}
+
+TEST(Crc16Test, bytes_and_blocks_can_be_mixed) {
+  std::vector<uint8_t> data(1021);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i ^ (i >> 3));
+  }
+  uint16_t crc = Crc16Update(0, data[0]);
+  crc = Crc16Update(crc, data.data() + 1, 500);
+  for (size_t i = 501; i < data.size(); i++) {
+    crc = Crc16Update(crc, data[i]);
+  }
+  ASSERT_EQ(Crc16Update(0, data.data(), data.size()), crc);
+  ASSERT_EQ(reference_crc16(0, data), crc);
+}
+
+}  // namespace testing
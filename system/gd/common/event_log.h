@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+
+// Timestamped record in an EventLog
+template <typename T>
+struct EventLogEntry {
+  // Milliseconds since the epoch
+  long long timestamp;
+  T record;
+};
+
+// History of the last kCapacity records of type T, for dumpsys. The records are fixed size binary structures copied
+// into a preallocated ring: recording never allocates nor formats, the records are only turned into text when they
+// are dumped.
+//
+// Record() is lock-free and may be called from any thread. Pull() may run concurrently with Record(): every slot
+// carries a sequence number, and the slots which are being written while they are read are left out of the result.
+// A record may be lost if its writer is preempted while the ring wraps all the way around.
+template <typename T, size_t kCapacity>
+class EventLog {
+  static_assert(std::is_trivially_copyable_v<T>, "records are copied as raw bytes");
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+ public:
+  using Entry = EventLogEntry<T>;
+
+  EventLog() = default;
+  EventLog(const EventLog&) = delete;
+  EventLog& operator=(const EventLog&) = delete;
+
+  void Record(const T& record) {
+    Entry entry{
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count(),
+        record};
+    std::array<uint64_t, kWords> words{};
+    std::memcpy(words.data(), &entry, sizeof(entry));
+
+    uint64_t index = next_index_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[index % kCapacity];
+    // An odd sequence number marks the slot as being written
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+      slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+  }
+
+  // Return the records in the log, oldest first
+  std::vector<Entry> Pull() const {
+    uint64_t end = next_index_.load(std::memory_order_acquire);
+    uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+    std::vector<Entry> entries;
+    entries.reserve(end - begin);
+    for (uint64_t index = begin; index < end; index++) {
+      const Slot& slot = slots_[index % kCapacity];
+      uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence != 2 * index + 2) {
+        continue;
+      }
+      std::array<uint64_t, kWords> words;
+      for (size_t i = 0; i < kWords; i++) {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+        continue;
+      }
+      Entry entry;
+      std::memcpy(&entry, words.data(), sizeof(entry));
+      entries.push_back(entry);
+    }
+    return entries;
+  }
+
+ private:
+  static constexpr size_t kWords = (sizeof(Entry) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::array<std::atomic<uint64_t>, kWords> words{};
+  };
+
+  std::atomic<uint64_t> next_index_{0};
+  std::array<Slot, kCapacity> slots_{};
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/event_log.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+struct TestRecord {
+  uint32_t thread;
+  uint32_t sequence;
+  char name[13];
+};
+
+TEST(EventLogTest, empty) {
+  EventLog<TestRecord, 4> log;
+  ASSERT_TRUE(log.Pull().empty());
+}
+
+TEST(EventLogTest, keeps_last_records_in_order) {
+  EventLog<TestRecord, 4> log;
+  for (uint32_t i = 0; i < 6; i++) {
+    log.Record(TestRecord{0, i, "record"});
+  }
+  auto entries = log.Pull();
+  ASSERT_EQ(entries.size(), 4u);
+  for (uint32_t i = 0; i < 4; i++) {
+    ASSERT_EQ(entries[i].record.sequence, i + 2);
+    ASSERT_STREQ(entries[i].record.name, "record");
+    ASSERT_GT(entries[i].timestamp, 0);
+  }
+  ASSERT_LE(entries.front().timestamp, entries.back().timestamp);
+}
+
+TEST(EventLogTest, concurrent_record_and_pull) {
+  EventLog<TestRecord, 64> log;
+  constexpr uint32_t kThreads = 4;
+  constexpr uint32_t kRecords = 10000;
+  std::atomic<bool> done{false};
+  std::thread reader([&log, &done]() {
+    while (!done.load()) {
+      for (const auto& entry : log.Pull()) {
+        // A torn record would mix the fields of two records
+        ASSERT_EQ(entry.record.name[0], static_cast<char>('a' + entry.record.thread));
+      }
+    }
+  });
+  std::vector<std::thread> writers;
+  for (uint32_t thread = 0; thread < kThreads; thread++) {
+    writers.emplace_back([&log, thread]() {
+      for (uint32_t i = 0; i < kRecords; i++) {
+        TestRecord record{thread, i, {}};
+        record.name[0] = 'a' + thread;
+        log.Record(record);
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done = true;
+  reader.join();
+  ASSERT_EQ(log.Pull().size(), 64u);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace bluetooth
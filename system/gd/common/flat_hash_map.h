@@ -0,0 +1,283 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+
+// Hash map keeping its entries in one array, with open addressing and linear probing, for the small tables keyed by
+// handle, CID or address which are looked up for every packet. A lookup reads adjacent slots instead of following
+// the nodes of std::map or the buckets of std::unordered_map.
+//
+// Unlike the standard maps, any insertion or erasure invalidates all the iterators, pointers and references into the
+// map, and the iteration order is unspecified. Keys must not be modified through an iterator.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+  using Slot = std::optional<std::pair<Key, Value>>;
+
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+
+  template <bool kConst>
+  class Iterator {
+    using SlotPointer = std::conditional_t<kConst, const Slot*, Slot*>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FlatHashMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<kConst, const value_type*, value_type*>;
+    using reference = std::conditional_t<kConst, const value_type&, value_type&>;
+
+    Iterator() = default;
+    Iterator(SlotPointer slot, SlotPointer end) : slot_(slot), end_(end) {
+      SkipEmpty();
+    }
+    // Conversion from iterator to const_iterator
+    template <bool kOtherConst, typename = std::enable_if_t<kConst && !kOtherConst>>
+    Iterator(const Iterator<kOtherConst>& other) : slot_(other.slot_), end_(other.end_) {}
+
+    reference operator*() const {
+      return **slot_;
+    }
+    pointer operator->() const {
+      return &**slot_;
+    }
+    Iterator& operator++() {
+      slot_++;
+      SkipEmpty();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+    bool operator==(const Iterator& other) const {
+      return slot_ == other.slot_;
+    }
+    bool operator!=(const Iterator& other) const {
+      return slot_ != other.slot_;
+    }
+
+   private:
+    friend class FlatHashMap;
+    template <bool>
+    friend class Iterator;
+
+    void SkipEmpty() {
+      while (slot_ != end_ && !slot_->has_value()) {
+        slot_++;
+      }
+    }
+
+    SlotPointer slot_ = nullptr;
+    SlotPointer end_ = nullptr;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  FlatHashMap() = default;
+
+  iterator begin() {
+    return iterator(slots_.data(), slots_.data() + slots_.size());
+  }
+  iterator end() {
+    return iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size());
+  }
+  const_iterator begin() const {
+    return const_iterator(slots_.data(), slots_.data() + slots_.size());
+  }
+  const_iterator end() const {
+    return const_iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size());
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  void clear() {
+    slots_.clear();
+    size_ = 0;
+  }
+
+  // Make room for count entries without growing again
+  void reserve(size_t count) {
+    size_t capacity = kMinCapacity;
+    while (count * kMaxLoadDenominator > capacity * kMaxLoadNumerator) {
+      capacity *= 2;
+    }
+    if (capacity > slots_.size()) {
+      Rehash(capacity);
+    }
+  }
+
+  iterator find(const Key& key) {
+    size_t index = FindIndex(key);
+    return index == kNotFound ? end() : IteratorAt(index);
+  }
+
+  const_iterator find(const Key& key) const {
+    size_t index = FindIndex(key);
+    return index == kNotFound ? end() : const_iterator(slots_.data() + index, slots_.data() + slots_.size());
+  }
+
+  size_t count(const Key& key) const {
+    return FindIndex(key) == kNotFound ? 0 : 1;
+  }
+
+  bool contains(const Key& key) const {
+    return FindIndex(key) != kNotFound;
+  }
+
+  // Construct the value from args if key is not in the map yet
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    size_t index = FindIndex(key);
+    if (index != kNotFound) {
+      return {IteratorAt(index), false};
+    }
+    reserve(size_ + 1);
+    index = ProbeStart(key);
+    while (slots_[index].has_value()) {
+      index = (index + 1) & (slots_.size() - 1);
+    }
+    slots_[index].emplace(
+        std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+    size_++;
+    return {IteratorAt(index), true};
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(const Key& key, Args&&... args) {
+    return try_emplace(key, std::forward<Args>(args)...);
+  }
+
+  std::pair<iterator, bool> insert(value_type value) {
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  Value& operator[](const Key& key) {
+    return try_emplace(key).first->second;
+  }
+
+  Value& at(const Key& key) {
+    return find(key)->second;
+  }
+
+  const Value& at(const Key& key) const {
+    return find(key)->second;
+  }
+
+  size_t erase(const Key& key) {
+    size_t index = FindIndex(key);
+    if (index == kNotFound) {
+      return 0;
+    }
+    EraseIndex(index);
+    return 1;
+  }
+
+  // Invalidates all the iterators, including it
+  void erase(const_iterator it) {
+    EraseIndex(it.slot_ - slots_.data());
+  }
+
+ private:
+  static constexpr size_t kNotFound = SIZE_MAX;
+  static constexpr size_t kMinCapacity = 8;
+  // Grow when more than 3/4 of the slots are used
+  static constexpr size_t kMaxLoadNumerator = 3;
+  static constexpr size_t kMaxLoadDenominator = 4;
+
+  iterator IteratorAt(size_t index) {
+    return iterator(slots_.data() + index, slots_.data() + slots_.size());
+  }
+
+  // Fibonacci hashing spreads the consecutive handles and CIDs, whose std::hash is the identity
+  size_t ProbeStart(const Key& key) const {
+    uint64_t hash = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(hash >> 32) & (slots_.size() - 1);
+  }
+
+  size_t FindIndex(const Key& key) const {
+    if (size_ == 0) {
+      return kNotFound;
+    }
+    for (size_t index = ProbeStart(key);; index = (index + 1) & (slots_.size() - 1)) {
+      if (!slots_[index].has_value()) {
+        return kNotFound;
+      }
+      if (KeyEqual{}(slots_[index]->first, key)) {
+        return index;
+      }
+    }
+  }
+
+  // Backward shift deletion: move the following entries of the probe sequence up, so that no tombstone is needed
+  void EraseIndex(size_t hole) {
+    size_t mask = slots_.size() - 1;
+    slots_[hole].reset();
+    size_--;
+    for (size_t index = (hole + 1) & mask; slots_[index].has_value(); index = (index + 1) & mask) {
+      size_t start = ProbeStart(slots_[index]->first);
+      // The entry may move to the hole only if the hole lies between its probe start and its current slot
+      if (((index - start) & mask) >= ((index - hole) & mask)) {
+        slots_[hole].emplace(std::move(*slots_[index]));
+        slots_[index].reset();
+        hole = index;
+      }
+    }
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<Slot> old_slots(capacity);
+    std::swap(old_slots, slots_);
+    for (auto& slot : old_slots) {
+      if (slot.has_value()) {
+        size_t index = ProbeStart(slot->first);
+        while (slots_[index].has_value()) {
+          index = (index + 1) & (slots_.size() - 1);
+        }
+        slots_[index].emplace(std::move(*slot));
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t size_ = 0;
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/flat_hash_map.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+TEST(FlatHashMapTest, empty) {
+  FlatHashMap<uint16_t, int> map;
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.find(1), map.end());
+  ASSERT_EQ(map.begin(), map.end());
+  ASSERT_EQ(map.erase(1), 0u);
+}
+
+TEST(FlatHashMapTest, insert_find_erase) {
+  FlatHashMap<uint16_t, std::string> map;
+  ASSERT_TRUE(map.try_emplace(0x40, "a").second);
+  ASSERT_FALSE(map.try_emplace(0x40, "b").second);
+  map[0x41] = "c";
+  ASSERT_EQ(map.size(), 2u);
+  ASSERT_EQ(map.find(0x40)->second, "a");
+  ASSERT_EQ(map.at(0x41), "c");
+  ASSERT_TRUE(map.contains(0x41));
+  ASSERT_EQ(map.count(0x42), 0u);
+  ASSERT_EQ(map.erase(0x40), 1u);
+  ASSERT_EQ(map.find(0x40), map.end());
+  ASSERT_EQ(map.find(0x41)->second, "c");
+  map.erase(map.find(0x41));
+  ASSERT_TRUE(map.empty());
+}
+
+TEST(FlatHashMapTest, move_only_values) {
+  FlatHashMap<uint16_t, std::unique_ptr<int>> map;
+  for (int i = 0; i < 100; i++) {
+    map.emplace(i, std::make_unique<int>(i));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    map.erase(i);
+  }
+  ASSERT_EQ(map.size(), 50u);
+  for (int i = 1; i < 100; i += 2) {
+    ASSERT_EQ(*map.find(i)->second, i);
+  }
+}
+
+TEST(FlatHashMapTest, iterate) {
+  FlatHashMap<uint16_t, int> map;
+  for (int i = 0; i < 20; i++) {
+    map[i] = i * 2;
+  }
+  std::map<uint16_t, int> seen;
+  for (const auto& [key, value] : map) {
+    seen[key] = value;
+  }
+  ASSERT_EQ(seen.size(), 20u);
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ(seen[i], i * 2);
+  }
+}
+
+// Random operations against std::map, to cover the probe sequences wrapping around and the backward shifts
+TEST(FlatHashMapTest, matches_std_map) {
+  FlatHashMap<uint16_t, int> map;
+  std::map<uint16_t, int> reference;
+  std::mt19937 random(42);
+  for (int i = 0; i < 100000; i++) {
+    uint16_t key = random() % 64;
+    switch (random() % 3) {
+      case 0:
+        map[key] = i;
+        reference[key] = i;
+        break;
+      case 1:
+        ASSERT_EQ(map.erase(key), reference.erase(key));
+        break;
+      default: {
+        auto it = map.find(key);
+        auto expected = reference.find(key);
+        ASSERT_EQ(it == map.end(), expected == reference.end());
+        if (it != map.end()) {
+          ASSERT_EQ(it->second, expected->second);
+        }
+      }
+    }
+    ASSERT_EQ(map.size(), reference.size());
+  }
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/flat_hash_map.h"
+#include "common/sorted_vector_map.h"
+
+using ::benchmark::State;
+using ::bluetooth::common::FlatHashMap;
+using ::bluetooth::common::SortedVectorMap;
+
+namespace {
+
+// Connection handles as a controller allocates them
+std::vector<uint16_t> Handles(size_t count) {
+  std::vector<uint16_t> handles;
+  for (size_t i = 0; i < count; i++) {
+    handles.push_back(static_cast<uint16_t>(0x40 + i));
+  }
+  return handles;
+}
+
+// Per packet lookup of the connection of a handle, with the handles of |range(0)| connections in turn
+template <typename Map>
+void BM_HandleLookup(State& state) {
+  auto handles = Handles(state.range(0));
+  Map map;
+  for (auto handle : handles) {
+    map[handle] = handle;
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    auto it = map.find(handles[i]);
+    ::benchmark::DoNotOptimize(it->second);
+    i = i + 1 == handles.size() ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_HandleLookup, std::map<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(BM_HandleLookup, std::unordered_map<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(BM_HandleLookup, FlatHashMap<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(BM_HandleLookup, SortedVectorMap<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+
+// Connection and disconnection of a link while |range(0)| others stay connected
+template <typename Map>
+void BM_HandleInsertErase(State& state) {
+  auto handles = Handles(state.range(0) + 1);
+  Map map;
+  for (size_t i = 0; i + 1 < handles.size(); i++) {
+    map[handles[i]] = handles[i];
+  }
+  for (auto _ : state) {
+    map[handles.back()] = 0;
+    map.erase(handles.back());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_HandleInsertErase, std::map<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(BM_HandleInsertErase, std::unordered_map<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(BM_HandleInsertErase, FlatHashMap<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(BM_HandleInsertErase, SortedVectorMap<uint16_t, uint64_t>)->Arg(2)->Arg(8)->Arg(32);
+
+}  // namespace
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -34,6 +36,7 @@ class InitFlags final {
       flags++;
     }
     init_flags::load(std::move(rusted_flags));
+    generation_.fetch_add(1, std::memory_order_release);
   }
 
   inline static bool IsDebugLoggingEnabledForTag(const std::string& tag) {
@@ -58,7 +61,46 @@ class InitFlags final {
 
   inline static void SetAllForTesting() {
     init_flags::set_all_for_testing();
+    generation_.fetch_add(1, std::memory_order_release);
   }
+
+  // Value of an init flag getter such as init_flags::gd_rust_is_enabled, kept until the flags are loaded again. The
+  // getters lock the flags, which is too costly for the checks made for every packet or log line.
+  template <auto kGetter>
+  static bool IsEnabledCached() {
+    static std::atomic<uint32_t> cached{0};
+    return CheckCached(&cached, kGetter);
+  }
+
+  // Return the value which |check| returned since the flags were last loaded, or call it again. |cached| holds the
+  // generation of the flags and the value, and starts at 0.
+  template <typename Check>
+  static bool CheckCached(std::atomic<uint32_t>* cached, Check check) {
+    uint32_t generation = generation_.load(std::memory_order_acquire);
+    uint32_t value = cached->load(std::memory_order_relaxed);
+    if ((value >> 1) == generation) {
+      return value & 1;
+    }
+    bool enabled = check();
+    cached->store((generation << 1) | enabled, std::memory_order_relaxed);
+    return enabled;
+  }
+
+ private:
+  // Incremented whenever the flags change, starts at 1 so that no cached value matches before the first check
+  inline static std::atomic<uint32_t> generation_{1};
+};
+
+// Debug logging check of one LOG_DEBUG or LOG_VERBOSE call site, which compares the tag only once per flag load
+class DebugLoggingCheck final {
+ public:
+  template <typename Tag>
+  bool IsEnabled(const Tag& tag) {
+    return InitFlags::CheckCached(&cached_, [&tag] { return InitFlags::IsDebugLoggingEnabledForTag(tag); });
+  }
+
+ private:
+  std::atomic<uint32_t> cached_{0};
 };
 
 }  // namespace common
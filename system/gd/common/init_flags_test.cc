@@ -74,3 +74,25 @@ TEST(InitFlagsTest, test_debug_logging_multiple_flags) {
   ASSERT_FALSE(InitFlags::IsDebugLoggingEnabledForTag("Foo"));
   ASSERT_FALSE(InitFlags::IsDebugLoggingEnabledForAll());
 }
+
+TEST(InitFlagsTest, test_cached_checks_follow_load) {
+  const char* enabled[] = {"INIT_logging_debug_enabled_for_tags=foo", nullptr};
+  InitFlags::Load(enabled);
+  bluetooth::common::DebugLoggingCheck check;
+  ASSERT_TRUE(check.IsEnabled("foo"));
+  ASSERT_TRUE(check.IsEnabled("foo"));
+
+  const char* disabled[] = {"INIT_logging_debug_disabled_for_tags=foo", nullptr};
+  InitFlags::Load(disabled);
+  ASSERT_FALSE(check.IsEnabled("foo"));
+}
+
+TEST(InitFlagsTest, test_cached_flag_follows_load) {
+  const char* enabled[] = {"INIT_logging_debug_enabled_for_all=true", nullptr};
+  InitFlags::Load(enabled);
+  ASSERT_TRUE(InitFlags::IsEnabledCached<bluetooth::common::init_flags::logging_debug_enabled_for_all_is_enabled>());
+
+  const char* disabled[] = {"INIT_logging_debug_enabled_for_all=false", nullptr};
+  InitFlags::Load(disabled);
+  ASSERT_FALSE(InitFlags::IsEnabledCached<bluetooth::common::init_flags::logging_debug_enabled_for_all_is_enabled>());
+}
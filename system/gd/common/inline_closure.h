@@ -0,0 +1,185 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "common/bind.h"
+#include "common/callback.h"
+
+namespace bluetooth {
+namespace common {
+
+// Move-only closure which runs at most once, like OnceClosure, but which stores its functor and bound arguments in
+// kInlineSize bytes inside the object instead of a heap allocated BindState. Functors which do not fit, or which may
+// throw when moved, are moved to the heap instead.
+class InlineClosure {
+ public:
+  static constexpr size_t kInlineSize = 48;
+
+  InlineClosure() = default;
+
+  template <
+      typename Functor,
+      typename = std::enable_if_t<
+          !std::is_same_v<std::decay_t<Functor>, InlineClosure> && !std::is_same_v<std::decay_t<Functor>, OnceClosure> &&
+          std::is_invocable_v<std::decay_t<Functor>&&>>>
+  InlineClosure(Functor&& functor) {
+    using F = std::decay_t<Functor>;
+    if constexpr (FitsInline<F>()) {
+      new (storage_) F(std::forward<Functor>(functor));
+      ops_ = &InlineOps<F>::kOps;
+    } else {
+      *reinterpret_cast<F**>(storage_) = new F(std::forward<Functor>(functor));
+      ops_ = &HeapOps<F>::kOps;
+    }
+  }
+
+  // Wrap a bound callback, which keeps its own BindState
+  InlineClosure(OnceClosure closure) {
+    if (!closure.is_null()) {
+      *this = InlineClosure([closure = std::move(closure)]() mutable { std::move(closure).Run(); });
+    }
+  }
+
+  InlineClosure(const InlineClosure&) = delete;
+  InlineClosure& operator=(const InlineClosure&) = delete;
+
+  InlineClosure(InlineClosure&& other) noexcept {
+    MoveFrom(&other);
+  }
+
+  InlineClosure& operator=(InlineClosure&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  ~InlineClosure() {
+    Reset();
+  }
+
+  bool is_null() const {
+    return ops_ == nullptr;
+  }
+
+  // True if the functor is stored inside this object
+  bool is_inline() const {
+    return ops_ != nullptr && ops_->is_inline;
+  }
+
+  // Run the functor and release it. Must not be null.
+  void Run() && {
+    const Ops* ops = ops_;
+    ops_ = nullptr;
+    ops->run(storage_);
+    ops->destroy(storage_);
+  }
+
+  void Reset() {
+    if (ops_ != nullptr) {
+      const Ops* ops = ops_;
+      ops_ = nullptr;
+      ops->destroy(storage_);
+    }
+  }
+
+  // Convert into a OnceClosure, for the contexts which only queue those. This allocates.
+  OnceClosure IntoOnceClosure() && {
+    if (is_null()) {
+      return OnceClosure();
+    }
+    return common::BindOnce([](InlineClosure closure) { std::move(closure).Run(); }, std::move(*this));
+  }
+
+ private:
+  struct Ops {
+    void (*run)(void* storage);
+    // Move construct the functor of |from| into |to| and destroy the one of |from|
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+    bool is_inline;
+  };
+
+  template <typename F>
+  static constexpr bool FitsInline() {
+    return sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<F>;
+  }
+
+  template <typename F>
+  struct InlineOps {
+    static void Run(void* storage) {
+      std::invoke(std::move(*static_cast<F*>(storage)));
+    }
+    static void Relocate(void* from, void* to) {
+      new (to) F(std::move(*static_cast<F*>(from)));
+      static_cast<F*>(from)->~F();
+    }
+    static void Destroy(void* storage) {
+      static_cast<F*>(storage)->~F();
+    }
+    static constexpr Ops kOps{&Run, &Relocate, &Destroy, true};
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static void Run(void* storage) {
+      std::invoke(std::move(**static_cast<F**>(storage)));
+    }
+    static void Relocate(void* from, void* to) {
+      *static_cast<F**>(to) = *static_cast<F**>(from);
+    }
+    static void Destroy(void* storage) {
+      delete *static_cast<F**>(storage);
+    }
+    static constexpr Ops kOps{&Run, &Relocate, &Destroy, false};
+  };
+
+  void MoveFrom(InlineClosure* other) {
+    if (other->ops_ != nullptr) {
+      other->ops_->relocate(other->storage_, storage_);
+      ops_ = other->ops_;
+      other->ops_ = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+  const Ops* ops_ = nullptr;
+};
+
+// Bind a method of obj and its arguments into an InlineClosure. The arguments are stored decayed and moved into the
+// call, as with BindOnce and Unretained(obj), but the wrappers of base/bind.h are not understood.
+template <typename T, typename Functor, typename... Args>
+InlineClosure BindInlineOn(T* obj, Functor&& functor, Args&&... args) {
+  return InlineClosure([obj,
+                        functor = std::forward<Functor>(functor),
+                        args = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable {
+    std::apply(
+        [obj, &functor](auto&&... unpacked) { std::invoke(functor, obj, std::move(unpacked)...); }, std::move(args));
+  });
+}
+
+}  // namespace common
+}  // namespace bluetooth
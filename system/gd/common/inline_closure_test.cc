@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/inline_closure.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+class Counter {
+ public:
+  void Add(int value, std::unique_ptr<int> extra) {
+    total_ += value + *extra;
+  }
+  int total_ = 0;
+};
+
+TEST(InlineClosureTest, empty) {
+  InlineClosure closure;
+  ASSERT_TRUE(closure.is_null());
+  ASSERT_TRUE(InlineClosure(OnceClosure()).is_null());
+}
+
+TEST(InlineClosureTest, small_functor_is_inline) {
+  int value = 0;
+  auto owned = std::make_unique<int>(2);
+  InlineClosure closure([&value, owned = std::move(owned)]() { value += *owned; });
+  ASSERT_TRUE(closure.is_inline());
+  InlineClosure moved = std::move(closure);
+  ASSERT_TRUE(closure.is_null());
+  ASSERT_TRUE(moved.is_inline());
+  std::move(moved).Run();
+  ASSERT_EQ(value, 2);
+  ASSERT_TRUE(moved.is_null());
+}
+
+TEST(InlineClosureTest, large_functor_is_on_heap) {
+  int value = 0;
+  std::array<int, 32> values{};
+  values[31] = 3;
+  InlineClosure closure([&value, values]() { value = values[31]; });
+  ASSERT_FALSE(closure.is_inline());
+  InlineClosure moved = std::move(closure);
+  std::move(moved).Run();
+  ASSERT_EQ(value, 3);
+}
+
+TEST(InlineClosureTest, reset_releases_functor) {
+  auto shared = std::make_shared<int>(0);
+  InlineClosure closure([shared]() {});
+  ASSERT_EQ(shared.use_count(), 2);
+  closure.Reset();
+  ASSERT_EQ(shared.use_count(), 1);
+}
+
+TEST(InlineClosureTest, wraps_once_closure) {
+  int value = 0;
+  InlineClosure closure(BindOnce([](int* value) { *value = 4; }, Unretained(&value)));
+  ASSERT_TRUE(closure.is_inline());
+  std::move(closure).Run();
+  ASSERT_EQ(value, 4);
+}
+
+TEST(InlineClosureTest, into_once_closure) {
+  int value = 0;
+  OnceClosure closure = InlineClosure([&value]() { value = 5; }).IntoOnceClosure();
+  std::move(closure).Run();
+  ASSERT_EQ(value, 5);
+}
+
+TEST(InlineClosureTest, bind_inline_on) {
+  Counter counter;
+  InlineClosure closure = BindInlineOn(&counter, &Counter::Add, 1, std::make_unique<int>(2));
+  ASSERT_TRUE(closure.is_inline());
+  std::move(closure).Run();
+  ASSERT_EQ(counter.total_, 3);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace bluetooth
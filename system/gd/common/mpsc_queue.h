@@ -0,0 +1,103 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace bluetooth {
+namespace common {
+
+// Unbounded multi-producer/single-consumer queue. Push() is lock-free and may be called from any thread; TryPop(),
+// Pop() and MarkConsumed() must only be called from one consumer at a time.
+//
+// Besides the linked nodes, the queue keeps a count of pushed but not yet consumed elements. Push() reports the
+// transition of that count from zero, so a producer only needs to wake the consumer for the first element of a burst.
+// The consumer retires elements with MarkConsumed() once it is done with them, and learns whether more arrived in the
+// meantime.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  ~MpscQueue() {
+    T value;
+    while (TryPop(&value)) {
+    }
+    delete tail_;
+  }
+
+  // Enqueue an element. Returns true if the queue had no unconsumed elements, i.e. the consumer needs to be notified.
+  bool Push(T value) {
+    auto* node = new Node(std::move(value));
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next_.store(node, std::memory_order_release);
+    return pending_.fetch_add(1, std::memory_order_acq_rel) == 0;
+  }
+
+  // Consumer only. Dequeue the oldest element if one is fully linked. Returns false if there is none.
+  bool TryPop(T* value) {
+    Node* next = tail_->next_.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    *value = std::move(next->value_);
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+
+  // Consumer only. Dequeue the oldest element. Must only be called when PendingCount() guarantees that the element
+  // exists; it may briefly spin while a concurrent Push() finishes linking an earlier node.
+  T Pop() {
+    T value;
+    while (!TryPop(&value)) {
+      std::this_thread::yield();
+    }
+    return value;
+  }
+
+  // Number of elements pushed but not yet retired by MarkConsumed()
+  size_t PendingCount() const {
+    return pending_.load(std::memory_order_acquire);
+  }
+
+  // Consumer only. Retire count elements. Returns the number of elements still pending.
+  size_t MarkConsumed(size_t count) {
+    return pending_.fetch_sub(count, std::memory_order_acq_rel) - count;
+  }
+
+ private:
+  struct Node {
+    Node() = default;
+    explicit Node(T value) : value_(std::move(value)) {}
+    std::atomic<Node*> next_{nullptr};
+    T value_;
+  };
+
+  // Producers append at head_, the consumer removes from tail_, which is always a dummy node
+  std::atomic<Node*> head_;
+  Node* tail_;
+  std::atomic<size_t> pending_{0};
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace testing {
+
+using bluetooth::common::MpscQueue;
+
+TEST(MpscQueueTest, empty) {
+  MpscQueue<int> queue;
+  int value = 0;
+  ASSERT_FALSE(queue.TryPop(&value));
+  ASSERT_EQ(0ul, queue.PendingCount());
+}
+
+TEST(MpscQueueTest, fifo_order) {
+  MpscQueue<int> queue;
+  ASSERT_TRUE(queue.Push(1));
+  ASSERT_FALSE(queue.Push(2));
+  ASSERT_FALSE(queue.Push(3));
+  ASSERT_EQ(3ul, queue.PendingCount());
+
+  ASSERT_EQ(1, queue.Pop());
+  ASSERT_EQ(2, queue.Pop());
+  ASSERT_EQ(3, queue.Pop());
+  int value = 0;
+  ASSERT_FALSE(queue.TryPop(&value));
+  ASSERT_EQ(0ul, queue.MarkConsumed(3));
+}
+
+TEST(MpscQueueTest, notify_again_after_consumed) {
+  MpscQueue<int> queue;
+  ASSERT_TRUE(queue.Push(1));
+  ASSERT_EQ(1, queue.Pop());
+  ASSERT_FALSE(queue.Push(2));
+  ASSERT_EQ(1ul, queue.MarkConsumed(1));
+  ASSERT_EQ(2, queue.Pop());
+  ASSERT_EQ(0ul, queue.MarkConsumed(1));
+  ASSERT_TRUE(queue.Push(3));
+}
+
+TEST(MpscQueueTest, move_only_elements_released_on_destruction) {
+  auto value = std::make_shared<int>(1);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(value);
+    queue.Push(value);
+    ASSERT_EQ(3, value.use_count());
+  }
+  ASSERT_EQ(1, value.use_count());
+}
+
+TEST(MpscQueueTest, multiple_producers) {
+  constexpr int kProducers = 4;
+  constexpr int kElementsPerProducer = 10000;
+  MpscQueue<int> queue;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kElementsPerProducer; i++) {
+        queue.Push(p * kElementsPerProducer + i);
+      }
+    });
+  }
+
+  std::vector<int> last_seen(kProducers, -1);
+  for (int received = 0; received < kProducers * kElementsPerProducer; received++) {
+    while (queue.PendingCount() == 0) {
+      std::this_thread::yield();
+    }
+    int value = queue.Pop();
+    queue.MarkConsumed(1);
+    // Elements from one producer are dequeued in the order they were pushed
+    int producer = value / kElementsPerProducer;
+    ASSERT_LT(last_seen[producer], value);
+    last_seen[producer] = value;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  ASSERT_EQ(0ul, queue.PendingCount());
+}
+
+}  // namespace testing
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+
+// Ordered map keeping its entries sorted in one vector, for the tables of a few entries which are iterated in key
+// order or searched with lower_bound() on every packet. Lookups are a binary search over contiguous entries.
+//
+// Unlike std::map, any insertion or erasure invalidates the iterators, pointers and references after the position
+// of the change. Keys must not be modified through an iterator.
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class SortedVectorMap {
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  SortedVectorMap() = default;
+
+  iterator begin() {
+    return entries_.begin();
+  }
+  iterator end() {
+    return entries_.end();
+  }
+  const_iterator begin() const {
+    return entries_.begin();
+  }
+  const_iterator end() const {
+    return entries_.end();
+  }
+  const_iterator cbegin() const {
+    return entries_.cbegin();
+  }
+  const_iterator cend() const {
+    return entries_.cend();
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  bool empty() const {
+    return entries_.empty();
+  }
+
+  void clear() {
+    entries_.clear();
+  }
+
+  void reserve(size_t count) {
+    entries_.reserve(count);
+  }
+
+  iterator lower_bound(const Key& key) {
+    return std::lower_bound(entries_.begin(), entries_.end(), key, KeyLess());
+  }
+
+  const_iterator lower_bound(const Key& key) const {
+    return std::lower_bound(entries_.begin(), entries_.end(), key, KeyLess());
+  }
+
+  iterator upper_bound(const Key& key) {
+    return std::upper_bound(entries_.begin(), entries_.end(), key, KeyGreater());
+  }
+
+  const_iterator upper_bound(const Key& key) const {
+    return std::upper_bound(entries_.begin(), entries_.end(), key, KeyGreater());
+  }
+
+  iterator find(const Key& key) {
+    auto it = lower_bound(key);
+    return it != entries_.end() && !Compare{}(key, it->first) ? it : entries_.end();
+  }
+
+  const_iterator find(const Key& key) const {
+    auto it = lower_bound(key);
+    return it != entries_.end() && !Compare{}(key, it->first) ? it : entries_.end();
+  }
+
+  size_t count(const Key& key) const {
+    return find(key) == entries_.end() ? 0 : 1;
+  }
+
+  bool contains(const Key& key) const {
+    return find(key) != entries_.end();
+  }
+
+  // Construct the value from args if key is not in the map yet
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    auto it = lower_bound(key);
+    if (it != entries_.end() && !Compare{}(key, it->first)) {
+      return {it, false};
+    }
+    it = entries_.emplace(
+        it, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+    return {it, true};
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(const Key& key, Args&&... args) {
+    return try_emplace(key, std::forward<Args>(args)...);
+  }
+
+  std::pair<iterator, bool> insert(value_type value) {
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  Value& operator[](const Key& key) {
+    return try_emplace(key).first->second;
+  }
+
+  size_t erase(const Key& key) {
+    auto it = find(key);
+    if (it == entries_.end()) {
+      return 0;
+    }
+    entries_.erase(it);
+    return 1;
+  }
+
+  // Return the iterator following the erased entry
+  iterator erase(const_iterator it) {
+    return entries_.erase(it);
+  }
+
+ private:
+  struct KeyLess {
+    bool operator()(const value_type& entry, const Key& key) const {
+      return Compare{}(entry.first, key);
+    }
+  };
+
+  struct KeyGreater {
+    bool operator()(const Key& key, const value_type& entry) const {
+      return Compare{}(key, entry.first);
+    }
+  };
+
+  std::vector<value_type> entries_;
+};
+
+}  // namespace common
+}  // namespace bluetooth
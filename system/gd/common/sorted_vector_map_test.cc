@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/sorted_vector_map.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+TEST(SortedVectorMapTest, empty) {
+  SortedVectorMap<uint16_t, int> map;
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.find(1), map.end());
+  ASSERT_EQ(map.lower_bound(1), map.end());
+  ASSERT_EQ(map.erase(1), 0u);
+}
+
+TEST(SortedVectorMapTest, keeps_key_order) {
+  SortedVectorMap<uint16_t, std::string> map;
+  ASSERT_TRUE(map.try_emplace(3, "c").second);
+  ASSERT_TRUE(map.try_emplace(1, "a").second);
+  ASSERT_FALSE(map.try_emplace(1, "x").second);
+  map[2] = "b";
+  std::vector<uint16_t> keys;
+  std::string values;
+  for (const auto& [key, value] : map) {
+    keys.push_back(key);
+    values += value;
+  }
+  ASSERT_EQ(keys, std::vector<uint16_t>({1, 2, 3}));
+  ASSERT_EQ(values, "abc");
+}
+
+TEST(SortedVectorMapTest, bounds) {
+  SortedVectorMap<uint16_t, int> map;
+  map[10] = 1;
+  map[20] = 2;
+  ASSERT_EQ(map.lower_bound(10)->first, 10);
+  ASSERT_EQ(map.lower_bound(11)->first, 20);
+  ASSERT_EQ(map.upper_bound(10)->first, 20);
+  ASSERT_EQ(map.lower_bound(21), map.end());
+  ASSERT_EQ(map.find(15), map.end());
+  ASSERT_EQ(map.count(20), 1u);
+}
+
+TEST(SortedVectorMapTest, erase) {
+  SortedVectorMap<uint16_t, std::unique_ptr<int>> map;
+  for (int i = 0; i < 5; i++) {
+    map.emplace(i, std::make_unique<int>(i));
+  }
+  ASSERT_EQ(map.erase(2), 1u);
+  auto next = map.erase(map.find(0));
+  ASSERT_EQ(next->first, 1);
+  ASSERT_EQ(map.size(), 3u);
+  ASSERT_FALSE(map.contains(2));
+  ASSERT_EQ(*map.find(4)->second, 4);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace bluetooth
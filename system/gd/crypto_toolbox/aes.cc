@@ -51,6 +51,16 @@
 #define HAVE_UINT_32T
 #endif
 
+/* the AES instructions of the CPU encrypt with the precomputed key schedule
+   when the compiler targets them: ARMv8 Crypto Extensions or AES-NI */
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+#define USE_ARMV8_AES
+#include <arm_neon.h>
+#elif defined(__AES__)
+#define USE_AES_NI
+#include <wmmintrin.h>
+#endif
+
 /* define if you don't want any tables */
 #if 1
 #define USE_TABLES
@@ -545,6 +555,26 @@ return_type aes_set_key(const unsigned char key[], length_type keylen, aes_conte
 
 return_type aes_encrypt(const unsigned char in[N_BLOCK], unsigned char out[N_BLOCK], const aes_context ctx[1]) {
   if (ctx->rnd) {
+#if defined(USE_ARMV8_AES)
+    uint8x16_t s = vld1q_u8(in);
+    uint_8t r;
+
+    for (r = 0; r < ctx->rnd - 1; ++r)
+      s = vaesmcq_u8(vaeseq_u8(s, vld1q_u8(ctx->ksch + r * N_BLOCK)));
+    s = vaeseq_u8(s, vld1q_u8(ctx->ksch + r * N_BLOCK));
+    s = veorq_u8(s, vld1q_u8(ctx->ksch + (r + 1) * N_BLOCK));
+    vst1q_u8(out, s);
+#elif defined(USE_AES_NI)
+    const __m128i* k = (const __m128i*)ctx->ksch;
+    __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in),
+                              _mm_loadu_si128(k));
+    uint_8t r;
+
+    for (r = 1; r < ctx->rnd; ++r)
+      s = _mm_aesenc_si128(s, _mm_loadu_si128(k + r));
+    s = _mm_aesenclast_si128(s, _mm_loadu_si128(k + r));
+    _mm_storeu_si128((__m128i*)out, s);
+#else
     uint_8t s1[N_BLOCK], r;
     copy_and_key(s1, in, ctx->ksch);
 
@@ -563,6 +593,7 @@ return_type aes_encrypt(const unsigned char in[N_BLOCK], unsigned char out[N_BLO
 #endif
     shift_sub_rows(s1);
     copy_and_key(out, s1, ctx->ksch + r * N_BLOCK);
+#endif
   } else
     return (return_type)-1;
   return 0;
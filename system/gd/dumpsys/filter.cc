@@ -25,183 +25,155 @@
 using namespace bluetooth;
 using namespace dumpsys;
 
-class Filter {
- public:
-  Filter(const dumpsys::ReflectionSchema& reflection_schema) : reflection_schema_(reflection_schema) {}
-
-  virtual ~Filter() = default;
-
-  virtual void FilterInPlace(char* dumpsys_data) = 0;
-
-  static std::unique_ptr<Filter> Factory(
-      dumpsys::FilterType filter_type, const dumpsys::ReflectionSchema& reflection_schema);
-
- protected:
-  /**
-   * Given both reflection field data and the populated flatbuffer table data, if any,
-   * filter the contents of the field based upon the filtering privacy level.
-   *
-   * Primitives and composite strings may be successfully processed at this point.
-   * Other composite types (e.g. structs or tables) must be expanded into the
-   * respective grouping of subfields.
-   *
-   * @param field The reflection field information from the bundled schema
-   * @param table The populated field data, if any
-   *
-   * @return true if field was filtered successfully, false otherwise.
-   */
-  virtual bool FilterField(const reflection::Field* field, flatbuffers::Table* table) {
-    return false;
-  }
-
-  /**
-   * Given both reflection object data and the populated flatbuffer table data, if any,
-   * filter the object fields based upon the filtering privacy level.
-   *
-   * @param object The reflection object information from the bundled schema
-   * @param table The populated field data, if any
-   *
-   */
-  virtual void FilterObject(const reflection::Object* object, flatbuffers::Table* table){};
-
-  /**
-   * Given both reflection field data and the populated table data, if any,
-   * filter the contents of the table based upon the filtering privacy level.
-   *
-   * @param schema The reflection schema information from the bundled schema
-   * @param table The populated field data, if any
-   *
-   */
-  virtual void FilterTable(const reflection::Schema* schema, flatbuffers::Table* table){};
-
-  const dumpsys::ReflectionSchema& reflection_schema_;
+namespace {
+
+enum class FieldKind {
+  kBool,
+  kInteger,
+  kLong,
+  kFloat,
+  kString,
+  kTable,
+  kTableVector,
+  // Any other type, only kept with the privacy level kAny
+  kOther,
 };
 
-class DeveloperPrivacyFilter : public Filter {
- public:
-  DeveloperPrivacyFilter(const dumpsys::ReflectionSchema& reflection_schema) : Filter(reflection_schema) {}
-  void FilterInPlace(char* dumpsys_data) override { /* Nothing to do in this mode */
+FieldKind GetFieldKind(const reflection::Schema& schema, const reflection::Field& field) {
+  switch (field.type()->base_type()) {
+    case reflection::Bool:
+      return FieldKind::kBool;
+    case reflection::Int:
+    case reflection::UInt:
+      return FieldKind::kInteger;
+    case reflection::Long:
+    case reflection::ULong:
+      return FieldKind::kLong;
+    case reflection::Float:
+      return FieldKind::kFloat;
+    case reflection::String:
+      return FieldKind::kString;
+    case reflection::Obj:
+      return schema.objects()->Get(field.type()->index())->is_struct() ? FieldKind::kOther : FieldKind::kTable;
+    case reflection::Vector:
+      if (field.type()->element() == reflection::Obj &&
+          !schema.objects()->Get(field.type()->index())->is_struct()) {
+        return FieldKind::kTableVector;
+      }
+      return FieldKind::kOther;
+    default:
+      return FieldKind::kOther;
   }
-};
+}
 
-class UserPrivacyFilter : public Filter {
- public:
-  UserPrivacyFilter(const dumpsys::ReflectionSchema& reflection_schema) : Filter(reflection_schema) {}
-  void FilterInPlace(char* dumpsys_data) override;
+}  // namespace
 
- protected:
-  bool FilterField(const reflection::Field* field, flatbuffers::Table* table) override;
-  void FilterObject(const reflection::Object* object, flatbuffers::Table* table) override;
-  void FilterTable(const reflection::Schema* schema, flatbuffers::Table* table) override;
+struct PrivacyFilter::FieldPlan {
+  const reflection::Field* field;
+  FieldKind kind;
+  internal::PrivacyLevel privacy_level;
+  // Object index of the table, or of the vector elements
+  size_t object_index;
 };
 
-bool UserPrivacyFilter::FilterField(const reflection::Field* field, flatbuffers::Table* table) {
-  ASSERT(field != nullptr);
-  ASSERT(table != nullptr);
-  internal::PrivacyLevel privacy_level = internal::FindFieldPrivacyLevel(*field);
-
-  const auto type = static_cast<flatbuffers::BaseType>(field->type()->base_type());
-  switch (type) {
-    case flatbuffers::BASE_TYPE_INT:
-      return internal::FilterTypeInteger(*field, table, privacy_level);
-      break;
-    case flatbuffers::BASE_TYPE_FLOAT:
-      return internal::FilterTypeFloat(*field, table, privacy_level);
-      break;
-    case flatbuffers::BASE_TYPE_STRING:
-      return internal::FilterTypeString(*field, table, privacy_level);
-      break;
-    case flatbuffers::BASE_TYPE_STRUCT:
-      return internal::FilterTypeStruct(*field, table, privacy_level);
-      break;
-    case flatbuffers::BASE_TYPE_BOOL:
-      return internal::FilterTypeBool(*field, table, privacy_level);
-      break;
-    case flatbuffers::BASE_TYPE_LONG:
-      return internal::FilterTypeLong(*field, table, privacy_level);
-      break;
-    default:
-      LOG_WARN("Unsupported base type:%s", internal::FlatbufferTypeText(type).c_str());
-      break;
-  }
-  return false;
-}
-
-void UserPrivacyFilter::FilterObject(const reflection::Object* object, flatbuffers::Table* table) {
-  ASSERT(object != nullptr);
-  if (table == nullptr) {
-    return;  // table data is not populated
-  }
-  for (auto it = object->fields()->cbegin(); it != object->fields()->cend(); ++it) {
-    if (!FilterField(*it, table)) {
-      LOG_ERROR("%s Unable to filter field from an object when it's expected it will work", __func__);
-    };
-  }
-}
+struct PrivacyFilter::TablePlan {
+  std::vector<FieldPlan> fields;
+};
 
-void UserPrivacyFilter::FilterTable(const reflection::Schema* schema, flatbuffers::Table* table) {
-  if (schema == nullptr) {
-    LOG_WARN("%s schema is nullptr...probably ok", __func__);
-    return;
+PrivacyFilter::PrivacyFilter(FilterType filter_type, const ReflectionSchema& reflection_schema)
+    : filter_type_(filter_type) {
+  if (filter_type_ == FilterType::AS_DEVELOPER) {
+    return;  // Nothing to do in this mode
   }
 
-  const reflection::Object* object = schema->root_table();
-  if (object == nullptr) {
-    LOG_WARN("%s reflection object is nullptr...is ok ?", __func__);
+  const reflection::Schema* schema = reflection_schema.GetRootReflectionSchema();
+  if (schema == nullptr || schema->root_table() == nullptr) {
+    LOG_WARN("Unable to find the root reflection schema, filtering everything out");
     return;
   }
 
-  if (table == nullptr) {
-    return;  // table not populated
-  }
-
-  for (auto it = object->fields()->cbegin(); it != object->fields()->cend(); ++it) {
-    if (FilterField(*it, table)) {
-      continue;  // Field successfully filtered
+  const auto* objects = schema->objects();
+  table_plans_.resize(objects->size());
+  for (size_t index = 0; index < objects->size(); index++) {
+    const reflection::Object* object = objects->Get(index);
+    if (object == schema->root_table()) {
+      root_object_index_ = index;
     }
-    // Get the index of this complex non-string object from the schema which is
-    // also the same index into the data table.
-    int32_t index = it->type()->index();
-    ASSERT(index != -1);
-
-    flatbuffers::Table* sub_table = table->GetPointer<flatbuffers::Table*>(it->offset());
-    const reflection::Schema* sub_schema =
-        reflection_schema_.FindInReflectionSchema(schema->objects()->Get(index)->name()->str());
-
-    if (sub_schema != nullptr) {
-      FilterTable(sub_schema, sub_table);  // Top level schema
-    } else {
-      // Leaf node schema
-      const flatbuffers::String* name = schema->objects()->Get(index)->name();
-      const reflection::Object* sub_object = internal::FindReflectionObject(schema->objects(), name);
-      if (sub_object != nullptr) {
-        FilterObject(sub_object, sub_table);
-      } else {
-        LOG_ERROR("Unable to find reflection sub object:%s\n", name->c_str());
-      }
+    for (const reflection::Field* field : *object->fields()) {
+      FieldKind kind = GetFieldKind(*schema, *field);
+      size_t object_index = (kind == FieldKind::kTable || kind == FieldKind::kTableVector) ? field->type()->index() : 0;
+      table_plans_[index].fields.push_back({field, kind, internal::FindFieldPrivacyLevel(*field), object_index});
     }
   }
 }
 
-void UserPrivacyFilter::FilterInPlace(char* dumpsys_data) {
-  ASSERT(dumpsys_data != nullptr);
-  const reflection::Schema* root_schema = reflection_schema_.FindInReflectionSchema(reflection_schema_.GetRootName());
-  flatbuffers::Table* table = const_cast<flatbuffers::Table*>(flatbuffers::GetRoot<flatbuffers::Table>(dumpsys_data));
-  FilterTable(root_schema, table);
+PrivacyFilter::~PrivacyFilter() = default;
+
+void PrivacyFilter::FilterTable(size_t object_index, flatbuffers::Table* table) const {
+  for (const FieldPlan& plan : table_plans_[object_index].fields) {
+    const reflection::Field& field = *plan.field;
+    switch (plan.kind) {
+      case FieldKind::kBool:
+        internal::FilterTypeBool(field, table, plan.privacy_level);
+        break;
+      case FieldKind::kInteger:
+        internal::FilterTypeInteger(field, table, plan.privacy_level);
+        break;
+      case FieldKind::kLong:
+        internal::FilterTypeLong(field, table, plan.privacy_level);
+        break;
+      case FieldKind::kFloat:
+        internal::FilterTypeFloat(field, table, plan.privacy_level);
+        break;
+      case FieldKind::kString:
+        internal::FilterTypeString(field, table, plan.privacy_level);
+        break;
+      case FieldKind::kTable: {
+        // Removed from the table unless any privacy level may see it
+        internal::FilterTypeStruct(field, table, plan.privacy_level);
+        auto* sub_table = table->GetPointer<flatbuffers::Table*>(field.offset());
+        if (sub_table != nullptr) {
+          FilterTable(plan.object_index, sub_table);
+        }
+      } break;
+      case FieldKind::kTableVector: {
+        if (plan.privacy_level != internal::kAny) {
+          internal::ScrubFromTable(table, field.offset());
+          break;
+        }
+        auto* sub_tables = table->GetPointer<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::Table>>*>(
+            field.offset());
+        if (sub_tables == nullptr) {
+          break;
+        }
+        for (flatbuffers::uoffset_t i = 0; i < sub_tables->size(); i++) {
+          FilterTable(plan.object_index, const_cast<flatbuffers::Table*>(sub_tables->Get(i)));
+        }
+      } break;
+      case FieldKind::kOther:
+        if (plan.privacy_level != internal::kAny) {
+          internal::ScrubFromTable(table, field.offset());
+        }
+        break;
+    }
+  }
 }
 
-std::unique_ptr<Filter> Filter::Factory(
-    dumpsys::FilterType filter_type, const dumpsys::ReflectionSchema& reflection_schema) {
-  switch (filter_type) {
-    case dumpsys::FilterType::AS_DEVELOPER:
-      return std::make_unique<DeveloperPrivacyFilter>(reflection_schema);
-    default:
-      return std::make_unique<UserPrivacyFilter>(reflection_schema);
+void PrivacyFilter::FilterInPlace(std::string* dumpsys_data) const {
+  ASSERT(dumpsys_data != nullptr);
+  if (filter_type_ == FilterType::AS_DEVELOPER) {
+    return;  // Nothing to do in this mode
+  }
+  if (table_plans_.empty()) {
+    dumpsys_data->clear();
+    return;
   }
+  flatbuffers::Table* table =
+      const_cast<flatbuffers::Table*>(flatbuffers::GetRoot<flatbuffers::Table>(dumpsys_data->data()));
+  FilterTable(root_object_index_, table);
 }
 
 void bluetooth::dumpsys::FilterInPlace(
     FilterType filter_type, const ReflectionSchema& reflection_schema, std::string* dumpsys_data) {
-  auto filter = Filter::Factory(filter_type, reflection_schema);
-  filter->FilterInPlace(dumpsys_data->data());
+  PrivacyFilter(filter_type, reflection_schema).FilterInPlace(dumpsys_data);
 }
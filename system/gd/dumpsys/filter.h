@@ -15,6 +15,8 @@
  */
 
 #include <string>
+#include <vector>
+
 #include "dumpsys/reflection_schema.h"
 
 namespace bluetooth {
@@ -22,6 +24,31 @@ namespace dumpsys {
 
 enum FilterType { AS_USER = 0, AS_DEVELOPER };
 
+// Filters dumpsys data of the root type of the reflection schema, according to the privacy level of its fields.
+// The privacy level and the type of every field are looked up once, when the filter is created, so filtering only
+// walks the populated data.
+class PrivacyFilter {
+ public:
+  PrivacyFilter(FilterType filter_type, const ReflectionSchema& reflection_schema);
+  ~PrivacyFilter();
+
+  PrivacyFilter(const PrivacyFilter&) = delete;
+  PrivacyFilter& operator=(const PrivacyFilter&) = delete;
+
+  void FilterInPlace(std::string* dumpsys_data) const;
+
+ private:
+  struct FieldPlan;
+  struct TablePlan;
+
+  void FilterTable(size_t object_index, flatbuffers::Table* table) const;
+
+  const FilterType filter_type_;
+  // Indexed by the object index in the root reflection schema
+  std::vector<TablePlan> table_plans_;
+  size_t root_object_index_{0};
+};
+
 void FilterInPlace(FilterType filter_type, const ReflectionSchema& reflection_schema, std::string* dumpsys_data);
 
 }  // namespace dumpsys
@@ -20,6 +20,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <utility>
 
 #include "blueberry/facade/common.pb.h"
@@ -62,6 +63,45 @@ class GrpcEventQueue {
     return ::grpc::Status::OK;
   }
 
+  /**
+   * Same as RunLoop(), but the pending events are written together, up to max_batch_size of them per message, so
+   * that a stream of packets at radio rates does not cost one gRPC message each.
+   *
+   * @param context client context
+   * @param writer output writer
+   * @param max_batch_size maximum number of events per message, kDefaultMaxBatchSize if 0
+   * @param add_to_batch callable appending one event to a batch message, as in add_to_batch(Batch*, T)
+   * @return gRPC status
+   */
+  template <typename Batch, typename AddToBatch>
+  ::grpc::Status RunBatchLoop(
+      ::grpc::ServerContext* context,
+      ::grpc::ServerWriter<Batch>* writer,
+      size_t max_batch_size,
+      AddToBatch add_to_batch) {
+    using namespace std::chrono_literals;
+    if (max_batch_size == 0) {
+      max_batch_size = kDefaultMaxBatchSize;
+    }
+    LOG_INFO("%s: Entering batch loop, up to %zu events per batch", log_name_.c_str(), max_batch_size);
+    batching_ = true;
+    while (!context->IsCancelled()) {
+      // Wait for 100 ms so that cancellation can be caught in amortized 50 ms latency
+      if (pending_events_.wait_to_take(100ms)) {
+        Batch batch;
+        for (auto& event : pending_events_.take_up_to(max_batch_size)) {
+          add_to_batch(&batch, std::move(event));
+        }
+        writer->Write(batch);
+      }
+    }
+    running_ = false;
+    LOG_INFO("%s: Exited batch loop", log_name_.c_str());
+    return ::grpc::Status::OK;
+  }
+
+  static constexpr size_t kDefaultMaxBatchSize = 64;
+
   /**
    * Called when there is an incoming event
    * @param event incoming event
@@ -71,13 +111,17 @@ class GrpcEventQueue {
       LOG_INFO("%s: Discarding an event while not running the loop", log_name_.c_str());
       return;
     }
-    LOG_INFO("%s: Got event, enqueuing", log_name_.c_str());
+    if (!batching_) {
+      LOG_INFO("%s: Got event, enqueuing", log_name_.c_str());
+    }
     pending_events_.push(std::move(event));
   }
 
  private:
   std::string log_name_;
   std::atomic<bool> running_{true};
+  // Events are not logged one by one when they are streamed in batches
+  std::atomic<bool> batching_{false};
   common::BlockingQueue<T> pending_events_;
 };
 
@@ -95,7 +95,7 @@ class InternalHciCallbacks : public IBluetoothHciCallbacks {
     common::StopWatch stop_watch(GetTimerText(__func__, event));
     std::vector<uint8_t> received_hci_packet(event.begin(), event.end());
     btsnoop_logger_->Capture(received_hci_packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::EVT);
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       btaa_logger_->Capture(received_hci_packet, SnoopLogger::PacketType::EVT);
     }
     if (callback_ != nullptr) {
@@ -108,7 +108,7 @@ class InternalHciCallbacks : public IBluetoothHciCallbacks {
     common::StopWatch stop_watch(GetTimerText(__func__, data));
     std::vector<uint8_t> received_hci_packet(data.begin(), data.end());
     btsnoop_logger_->Capture(received_hci_packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       btaa_logger_->Capture(received_hci_packet, SnoopLogger::PacketType::ACL);
     }
     if (callback_ != nullptr) {
@@ -121,7 +121,7 @@ class InternalHciCallbacks : public IBluetoothHciCallbacks {
     common::StopWatch stop_watch(GetTimerText(__func__, data));
     std::vector<uint8_t> received_hci_packet(data.begin(), data.end());
     btsnoop_logger_->Capture(received_hci_packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::SCO);
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       btaa_logger_->Capture(received_hci_packet, SnoopLogger::PacketType::SCO);
     }
     if (callback_ != nullptr) {
@@ -161,7 +161,7 @@ class HciHalHidl : public HciHal {
 
   void sendHciCommand(HciPacket command) override {
     btsnoop_logger_->Capture(command, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       btaa_logger_->Capture(command, SnoopLogger::PacketType::CMD);
     }
     bt_hci_->sendHciCommand(command);
@@ -169,7 +169,7 @@ class HciHalHidl : public HciHal {
 
   void sendAclData(HciPacket packet) override {
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       btaa_logger_->Capture(packet, SnoopLogger::PacketType::ACL);
     }
     bt_hci_->sendAclData(packet);
@@ -177,7 +177,7 @@ class HciHalHidl : public HciHal {
 
   void sendScoData(HciPacket packet) override {
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::SCO);
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       btaa_logger_->Capture(packet, SnoopLogger::PacketType::SCO);
     }
     bt_hci_->sendScoData(packet);
@@ -196,13 +196,13 @@ class HciHalHidl : public HciHal {
  protected:
   void ListDependencies(ModuleList* list) const {
     list->add<SnoopLogger>();
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       list->add<activity_attribution::ActivityAttribution>();
     }
   }
 
   void Start() override {
-    if (common::init_flags::btaa_hci_is_enabled()) {
+    if (common::InitFlags::IsEnabledCached<common::init_flags::btaa_hci_is_enabled>()) {
       btaa_logger_ = GetDependency<activity_attribution::ActivityAttribution>();
     }
     btsnoop_logger_ = GetDependency<SnoopLogger>();
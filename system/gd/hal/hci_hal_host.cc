@@ -23,10 +23,12 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <csignal>
+#include <deque>
 #include <mutex>
-#include <queue>
 
 #include "hal/hci_hal.h"
 #include "hal/snoop_logger.h"
@@ -50,6 +52,10 @@ constexpr uint8_t kHciScoHeaderSize = 3;
 constexpr uint8_t kHciEvtHeaderSize = 2;
 constexpr uint8_t kHciIsoHeaderSize = 4;
 constexpr int kBufSize = 1024 + 4 + 1;  // DeviceProperties::acl_data_packet_size_ + ACL header + H4 header
+// Largest number of packets received with a single syscall
+constexpr size_t kMaxPacketsPerRead = 16;
+// Largest number of packets sent with a single syscall
+constexpr size_t kMaxPacketsPerWrite = 16;
 
 constexpr uint8_t BTPROTO_HCI = 1;
 constexpr uint16_t HCI_CHANNEL_USER = 1;
@@ -230,8 +236,7 @@ class HciHalHost : public HciHal {
     ASSERT(sock_fd_ != INVALID_FD);
     std::vector<uint8_t> packet = std::move(command);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
-    packet.insert(packet.cbegin(), kH4Command);
-    write_to_fd(packet);
+    write_to_fd(kH4Command, std::move(packet));
   }
 
   void sendAclData(HciPacket data) override {
@@ -239,8 +244,7 @@ class HciHalHost : public HciHal {
     ASSERT(sock_fd_ != INVALID_FD);
     std::vector<uint8_t> packet = std::move(data);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
-    packet.insert(packet.cbegin(), kH4Acl);
-    write_to_fd(packet);
+    write_to_fd(kH4Acl, std::move(packet));
   }
 
   void sendScoData(HciPacket data) override {
@@ -248,8 +252,7 @@ class HciHalHost : public HciHal {
     ASSERT(sock_fd_ != INVALID_FD);
     std::vector<uint8_t> packet = std::move(data);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::SCO);
-    packet.insert(packet.cbegin(), kH4Sco);
-    write_to_fd(packet);
+    write_to_fd(kH4Sco, std::move(packet));
   }
 
   void sendIsoData(HciPacket data) override {
@@ -257,8 +260,7 @@ class HciHalHost : public HciHal {
     ASSERT(sock_fd_ != INVALID_FD);
     std::vector<uint8_t> packet = std::move(data);
     btsnoop_logger_->Capture(packet, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ISO);
-    packet.insert(packet.cbegin(), kH4Iso);
-    write_to_fd(packet);
+    write_to_fd(kH4Iso, std::move(packet));
   }
 
  protected:
@@ -312,12 +314,16 @@ class HciHalHost : public HciHal {
   bluetooth::os::Thread hci_incoming_thread_ =
       bluetooth::os::Thread("hci_incoming_thread", bluetooth::os::Thread::Priority::NORMAL);
   bluetooth::os::Reactor::Reactable* reactable_ = nullptr;
-  std::queue<std::vector<uint8_t>> hci_outgoing_queue_;
+  // Packets waiting for the socket to be writable, with their H4 type
+  std::deque<std::pair<uint8_t, HciPacket>> hci_outgoing_queue_;
   SnoopLogger* btsnoop_logger_ = nullptr;
+  // Only accessed from hci_incoming_thread_
+  std::array<uint8_t, kMaxPacketsPerRead> incoming_packet_types_;
+  std::array<HciPacket, kMaxPacketsPerRead> incoming_packets_;
 
-  void write_to_fd(HciPacket packet) {
+  void write_to_fd(uint8_t type, HciPacket packet) {
     // TODO: replace this with new queue when it's ready
-    hci_outgoing_queue_.emplace(packet);
+    hci_outgoing_queue_.emplace_back(type, std::move(packet));
     if (hci_outgoing_queue_.size() == 1) {
       hci_incoming_thread_.GetReactor()->ModifyRegistration(
           reactable_,
@@ -328,12 +334,25 @@ class HciHalHost : public HciHal {
 
   void send_packet_ready() {
     std::lock_guard<std::mutex> lock(this->api_mutex_);
-    auto packet_to_send = this->hci_outgoing_queue_.front();
-    auto bytes_written = write(this->sock_fd_, (void*)packet_to_send.data(), packet_to_send.size());
-    this->hci_outgoing_queue_.pop();
-    if (bytes_written == -1) {
+    // Send everything queued since the socket was last writable with a single syscall. Each datagram of the user
+    // channel must hold a single H4 packet, hence one message per packet, gathering its type and payload. Packets
+    // are never held back to fill a batch: they wait at most for the next iteration of the reactor.
+    struct mmsghdr messages[kMaxPacketsPerWrite] = {};
+    struct iovec iovecs[kMaxPacketsPerWrite][2];
+    size_t count = std::min(hci_outgoing_queue_.size(), kMaxPacketsPerWrite);
+    for (size_t i = 0; i < count; i++) {
+      auto& [type, packet] = hci_outgoing_queue_[i];
+      iovecs[i][0] = {.iov_base = &type, .iov_len = kH4HeaderSize};
+      iovecs[i][1] = {.iov_base = packet.data(), .iov_len = packet.size()};
+      messages[i].msg_hdr.msg_iov = iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 2;
+    }
+    int sent_count;
+    RUN_NO_INTR(sent_count = sendmmsg(this->sock_fd_, messages, count, 0));
+    if (sent_count == -1) {
       abort();
     }
+    hci_outgoing_queue_.erase(hci_outgoing_queue_.begin(), hci_outgoing_queue_.begin() + sent_count);
     if (hci_outgoing_queue_.empty()) {
       this->hci_incoming_thread_.GetReactor()->ModifyRegistration(
           this->reactable_,
@@ -350,114 +369,130 @@ class HciHalHost : public HciHal {
         return;
       }
     }
-    uint8_t buf[kBufSize] = {};
-
-    ssize_t received_size;
-    RUN_NO_INTR(received_size = read(sock_fd_, buf, kBufSize));
-    ASSERT_LOG(received_size != -1, "Can't receive from socket: %s", strerror(errno));
-    if (received_size == 0) {
-      LOG_WARN("Can't read H4 header. EOF received");
-      raise(SIGINT);
+
+    // Each datagram of the user channel holds a single H4 packet. Receive all the pending ones with a single syscall,
+    // scattering the H4 header away so that each packet lands in the storage handed over to the stack.
+    struct mmsghdr messages[kMaxPacketsPerRead] = {};
+    struct iovec iovecs[kMaxPacketsPerRead][2];
+    for (size_t i = 0; i < kMaxPacketsPerRead; i++) {
+      incoming_packets_[i].resize(kBufSize - kH4HeaderSize);
+      iovecs[i][0] = {.iov_base = &incoming_packet_types_[i], .iov_len = kH4HeaderSize};
+      iovecs[i][1] = {.iov_base = incoming_packets_[i].data(), .iov_len = incoming_packets_[i].size()};
+      messages[i].msg_hdr.msg_iov = iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    int received_count;
+    RUN_NO_INTR(received_count = recvmmsg(sock_fd_, messages, kMaxPacketsPerRead, MSG_DONTWAIT, nullptr));
+    if (received_count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
       return;
     }
+    ASSERT_LOG(received_count != -1, "Can't receive from socket: %s", strerror(errno));
+
+    for (int i = 0; i < received_count; i++) {
+      size_t received_size = messages[i].msg_len;
+      if (received_size == 0) {
+        LOG_WARN("Can't read H4 header. EOF received");
+        raise(SIGINT);
+        return;
+      }
+      ASSERT_LOG(!(messages[i].msg_hdr.msg_flags & MSG_TRUNC), "packet too long");
+      HciPacket packet = std::move(incoming_packets_[i]);
+      packet.resize(received_size - kH4HeaderSize);
+      handle_incoming_packet(incoming_packet_types_[i], std::move(packet));
+    }
+  }
+
+  void handle_incoming_packet(uint8_t type, HciPacket packet) {
+    size_t received_size = packet.size() + kH4HeaderSize;
 
-    if (buf[0] == kH4Event) {
+    if (type == kH4Event) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciEvtHeaderSize, "Received bad HCI_EVT packet size: %zu", received_size);
-      uint8_t hci_evt_parameter_total_length = buf[2];
-      ssize_t payload_size = received_size - (kH4HeaderSize + kHciEvtHeaderSize);
+      uint8_t hci_evt_parameter_total_length = packet[1];
+      size_t payload_size = received_size - (kH4HeaderSize + kHciEvtHeaderSize);
       ASSERT_LOG(
           payload_size == hci_evt_parameter_total_length,
           "malformed HCI event total parameter size received: %zu != %d",
           payload_size,
           hci_evt_parameter_total_length);
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciEvtHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::EVT);
+      btsnoop_logger_->Capture(packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::EVT);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an event after processing");
           return;
         }
-        incoming_packet_callback_->hciEventReceived(receivedHciPacket);
+        incoming_packet_callback_->hciEventReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Acl) {
+    if (type == kH4Acl) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciAclHeaderSize, "Received bad HCI_ACL packet size: %zu", received_size);
       int payload_size = received_size - (kH4HeaderSize + kHciAclHeaderSize);
-      uint16_t hci_acl_data_total_length = (buf[4] << 8) + buf[3];
+      uint16_t hci_acl_data_total_length = (packet[3] << 8) + packet[2];
       ASSERT_LOG(
           payload_size == hci_acl_data_total_length,
           "malformed ACL length received: %d != %d",
           payload_size,
           hci_acl_data_total_length);
-      ASSERT_LOG(hci_acl_data_total_length <= kBufSize - kH4HeaderSize - kHciAclHeaderSize, "packet too long");
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciAclHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
+      btsnoop_logger_->Capture(packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping an ACL packet after processing");
           return;
         }
-        incoming_packet_callback_->aclDataReceived(receivedHciPacket);
+        incoming_packet_callback_->aclDataReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Sco) {
+    if (type == kH4Sco) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciScoHeaderSize, "Received bad HCI_SCO packet size: %zu", received_size);
       int payload_size = received_size - (kH4HeaderSize + kHciScoHeaderSize);
-      uint8_t hci_sco_data_total_length = buf[3];
+      uint8_t hci_sco_data_total_length = packet[2];
       ASSERT_LOG(
           payload_size == hci_sco_data_total_length,
           "malformed SCO length received: %d != %d",
           payload_size,
           hci_sco_data_total_length);
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciScoHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::SCO);
+      btsnoop_logger_->Capture(packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::SCO);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a SCO packet after processing");
           return;
         }
-        incoming_packet_callback_->scoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->scoDataReceived(std::move(packet));
       }
     }
 
-    if (buf[0] == kH4Iso) {
+    if (type == kH4Iso) {
       ASSERT_LOG(
           received_size >= kH4HeaderSize + kHciIsoHeaderSize, "Received bad HCI_ISO packet size: %zu", received_size);
       int payload_size = received_size - (kH4HeaderSize + kHciIsoHeaderSize);
-      uint16_t hci_iso_data_total_length = ((buf[4] & 0x3f) << 8) + buf[3];
+      uint16_t hci_iso_data_total_length = ((packet[3] & 0x3f) << 8) + packet[2];
       ASSERT_LOG(
           payload_size == hci_iso_data_total_length,
           "malformed ISO length received: %d != %d",
           payload_size,
           hci_iso_data_total_length);
 
-      HciPacket receivedHciPacket;
-      receivedHciPacket.assign(buf + kH4HeaderSize, buf + kH4HeaderSize + kHciIsoHeaderSize + payload_size);
-      btsnoop_logger_->Capture(receivedHciPacket, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ISO);
+      btsnoop_logger_->Capture(packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ISO);
       {
         std::lock_guard<std::mutex> incoming_packet_callback_lock(incoming_packet_callback_mutex_);
         if (incoming_packet_callback_ == nullptr) {
           LOG_INFO("Dropping a ISO packet after processing");
           return;
         }
-        incoming_packet_callback_->isoDataReceived(receivedHciPacket);
+        incoming_packet_callback_->isoDataReceived(std::move(packet));
       }
     }
-    memset(buf, 0, kBufSize);
   }
 };
 
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_capture_filter.h"
+
+#include <algorithm>
+
+#include "common/strings.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace hal {
+
+namespace {
+
+constexpr size_t kCommandHeaderSize = 3;
+constexpr size_t kEventHeaderSize = 2;
+constexpr size_t kAclHeaderSize = 4;
+constexpr size_t kScoHeaderSize = 3;
+constexpr size_t kIsoHeaderSize = 4;
+constexpr size_t kL2capHeaderSize = 4;
+constexpr size_t kL2capCidOffset = kAclHeaderSize + 2;
+constexpr size_t kSignallingCommandOffset = kAclHeaderSize + kL2capHeaderSize;
+// Code, identifier and length of a signalling command
+constexpr size_t kSignallingCommandHeaderSize = 4;
+constexpr size_t kSignallingDataOffset = kSignallingCommandOffset + kSignallingCommandHeaderSize;
+
+constexpr uint8_t kAclContinuingFragment = 0x1;
+constexpr uint16_t kClassicSignallingCid = 0x0001;
+constexpr uint16_t kLeSignallingCid = 0x0005;
+
+constexpr uint8_t kConnectionRequest = 0x02;
+constexpr uint8_t kConnectionResponse = 0x03;
+constexpr uint8_t kDisconnectionRequest = 0x06;
+constexpr uint8_t kLeCreditBasedConnectionRequest = 0x14;
+constexpr uint8_t kLeCreditBasedConnectionResponse = 0x15;
+constexpr uint16_t kConnectionSuccessful = 0x0000;
+constexpr uint16_t kConnectionPending = 0x0001;
+
+constexpr uint8_t kDisconnectionCompleteEvent = 0x05;
+
+uint16_t read_uint16(const HciPacket& packet, size_t offset) {
+  return static_cast<uint16_t>(packet[offset]) | static_cast<uint16_t>(packet[offset + 1] << 8);
+}
+
+SnoopLogger::Direction opposite(SnoopLogger::Direction direction) {
+  return direction == SnoopLogger::Direction::INCOMING ? SnoopLogger::Direction::OUTGOING
+                                                       : SnoopLogger::Direction::INCOMING;
+}
+
+// Handles take 12 bits, leaving room for the direction and a 16 bit CID or identifier
+uint32_t key_of(uint16_t handle, SnoopLogger::Direction direction, uint16_t id) {
+  return static_cast<uint32_t>(handle) << 17 | static_cast<uint32_t>(direction) << 16 | id;
+}
+
+uint16_t handle_of_key(uint32_t key) {
+  return static_cast<uint16_t>(key >> 17);
+}
+
+std::optional<SnoopLogger::PacketType> packet_type_from_string(const std::string& name) {
+  if (name == "cmd") {
+    return SnoopLogger::PacketType::CMD;
+  }
+  if (name == "acl") {
+    return SnoopLogger::PacketType::ACL;
+  }
+  if (name == "sco") {
+    return SnoopLogger::PacketType::SCO;
+  }
+  if (name == "evt") {
+    return SnoopLogger::PacketType::EVT;
+  }
+  if (name == "iso") {
+    return SnoopLogger::PacketType::ISO;
+  }
+  return std::nullopt;
+}
+
+std::optional<SnoopCaptureFilter::Action> action_from_string(const std::string& name) {
+  if (name == "full") {
+    return SnoopCaptureFilter::Action::FULL;
+  }
+  if (name == "header") {
+    return SnoopCaptureFilter::Action::HEADER;
+  }
+  if (name == "drop") {
+    return SnoopCaptureFilter::Action::DROP;
+  }
+  return std::nullopt;
+}
+
+std::optional<uint16_t> uint16_from_string(const std::string& str) {
+  auto value = common::Uint64FromString(str);
+  if (!value || *value > UINT16_MAX) {
+    return std::nullopt;
+  }
+  return static_cast<uint16_t>(*value);
+}
+
+template <typename T>
+bool matches(const std::optional<T>& expected, const std::optional<T>& actual) {
+  return !expected || expected == actual;
+}
+
+}  // namespace
+
+std::optional<std::vector<SnoopCaptureFilter::Rule>> SnoopCaptureFilter::ParseRules(const std::string& rules) {
+  std::vector<Rule> result;
+  for (const auto& text : common::StringSplit(rules, ";")) {
+    if (common::StringTrim(text).empty()) {
+      continue;
+    }
+    auto fields_action = common::StringSplit(text, ":");
+    if (fields_action.size() != 2) {
+      LOG_WARN("Capture rule '%s' needs a single action", text.c_str());
+      return std::nullopt;
+    }
+    Rule rule;
+    auto action = action_from_string(common::StringTrim(fields_action[1]));
+    if (!action) {
+      LOG_WARN("Unknown action in capture rule '%s'", text.c_str());
+      return std::nullopt;
+    }
+    rule.action = *action;
+    for (const auto& field : common::StringSplit(fields_action[0], ",")) {
+      if (common::StringTrim(field).empty()) {
+        continue;
+      }
+      auto key_value = common::StringSplit(field, "=", 2);
+      if (key_value.size() != 2) {
+        LOG_WARN("Malformed field '%s' in capture rule '%s'", field.c_str(), text.c_str());
+        return std::nullopt;
+      }
+      auto key = common::StringTrim(key_value[0]);
+      auto value = common::StringTrim(key_value[1]);
+      if (key == "type") {
+        rule.type = packet_type_from_string(value);
+        if (!rule.type) {
+          LOG_WARN("Unknown packet type '%s' in capture rule '%s'", value.c_str(), text.c_str());
+          return std::nullopt;
+        }
+        continue;
+      }
+      auto number = uint16_from_string(value);
+      if (!number) {
+        LOG_WARN("Invalid %s '%s' in capture rule '%s'", key.c_str(), value.c_str(), text.c_str());
+        return std::nullopt;
+      }
+      if (key == "handle") {
+        rule.handle = number;
+      } else if (key == "cid") {
+        rule.cid = number;
+      } else if (key == "psm") {
+        rule.psm = number;
+      } else {
+        LOG_WARN("Unknown field '%s' in capture rule '%s'", key.c_str(), text.c_str());
+        return std::nullopt;
+      }
+    }
+    result.push_back(rule);
+  }
+  return result;
+}
+
+size_t SnoopCaptureFilter::HeaderLength(const HciPacket& packet, SnoopLogger::PacketType type) {
+  size_t length = 0;
+  switch (type) {
+    case SnoopLogger::PacketType::CMD:
+      length = kCommandHeaderSize;
+      break;
+    case SnoopLogger::PacketType::EVT:
+      length = kEventHeaderSize;
+      break;
+    case SnoopLogger::PacketType::ACL:
+      length = kAclHeaderSize;
+      if (packet.size() > 1 && ((packet[1] >> 4) & 0x3) != kAclContinuingFragment) {
+        length += kL2capHeaderSize;
+      }
+      break;
+    case SnoopLogger::PacketType::SCO:
+      length = kScoHeaderSize;
+      break;
+    case SnoopLogger::PacketType::ISO:
+      length = kIsoHeaderSize;
+      break;
+  }
+  return std::min(length, packet.size());
+}
+
+void SnoopCaptureFilter::SetRules(std::vector<Rule> rules) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  track_psms_ = std::any_of(rules.begin(), rules.end(), [](const Rule& rule) { return rule.psm.has_value(); });
+  rules_ = std::move(rules);
+  empty_.store(rules_.empty(), std::memory_order_relaxed);
+  last_cids_.clear();
+  channel_psms_.clear();
+  pending_psms_.clear();
+}
+
+SnoopCaptureFilter::Action SnoopCaptureFilter::Evaluate(
+    const HciPacket& packet, SnoopLogger::Direction direction, SnoopLogger::PacketType type) {
+  if (empty_.load(std::memory_order_relaxed)) {
+    return Action::FULL;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::optional<uint16_t> handle;
+  std::optional<uint16_t> cid;
+  std::optional<uint16_t> psm;
+  switch (type) {
+    case SnoopLogger::PacketType::ACL:
+    case SnoopLogger::PacketType::SCO:
+    case SnoopLogger::PacketType::ISO:
+      if (packet.size() >= 2) {
+        handle = read_uint16(packet, 0) & 0x0fff;
+      }
+      break;
+    case SnoopLogger::PacketType::EVT:
+      if (packet.size() >= 5 && packet[0] == kDisconnectionCompleteEvent) {
+        forget_handle(read_uint16(packet, 3) & 0x0fff);
+      }
+      break;
+    case SnoopLogger::PacketType::CMD:
+      break;
+  }
+
+  if (type == SnoopLogger::PacketType::ACL && handle) {
+    auto fragment_key = key_of(*handle, direction, 0);
+    if (((packet[1] >> 4) & 0x3) != kAclContinuingFragment) {
+      if (packet.size() >= kAclHeaderSize + kL2capHeaderSize) {
+        cid = read_uint16(packet, kL2capCidOffset);
+        last_cids_[fragment_key] = *cid;
+        if (track_psms_ && (*cid == kClassicSignallingCid || *cid == kLeSignallingCid)) {
+          learn_l2cap_signalling(packet, *handle, direction);
+        }
+      }
+    } else if (auto last_cid = last_cids_.find(fragment_key); last_cid != last_cids_.end()) {
+      cid = last_cid->second;
+    }
+    if (cid && track_psms_) {
+      auto channel = channel_psms_.find(key_of(*handle, direction, *cid));
+      if (channel != channel_psms_.end()) {
+        psm = channel->second;
+      }
+    }
+  }
+
+  for (const auto& rule : rules_) {
+    if (matches(rule.type, std::optional(type)) && matches(rule.handle, handle) && matches(rule.cid, cid) &&
+        matches(rule.psm, psm)) {
+      return rule.action;
+    }
+  }
+  return Action::FULL;
+}
+
+void SnoopCaptureFilter::learn_l2cap_signalling(
+    const HciPacket& packet, uint16_t handle, SnoopLogger::Direction direction) {
+  if (packet.size() < kSignallingDataOffset + 4) {
+    return;
+  }
+  uint8_t code = packet[kSignallingCommandOffset];
+  uint8_t identifier = packet[kSignallingCommandOffset + 1];
+  // Data sent to the requester is written with the source CID of the request, data sent to the responder with the
+  // destination CID of the response
+  switch (code) {
+    case kConnectionRequest:
+    case kLeCreditBasedConnectionRequest: {
+      uint16_t psm = read_uint16(packet, kSignallingDataOffset);
+      uint16_t source_cid = read_uint16(packet, kSignallingDataOffset + 2);
+      channel_psms_[key_of(handle, opposite(direction), source_cid)] = psm;
+      pending_psms_[key_of(handle, direction, identifier)] = psm;
+      break;
+    }
+    case kConnectionResponse:
+    case kLeCreditBasedConnectionResponse: {
+      size_t result_offset = kSignallingDataOffset + (code == kConnectionResponse ? 4 : 8);
+      if (packet.size() < result_offset + 2) {
+        return;
+      }
+      uint16_t result = read_uint16(packet, result_offset);
+      auto request_key = key_of(handle, opposite(direction), identifier);
+      auto pending = pending_psms_.find(request_key);
+      if (pending == pending_psms_.end() || (code == kConnectionResponse && result == kConnectionPending)) {
+        return;
+      }
+      if (result == kConnectionSuccessful) {
+        uint16_t destination_cid = read_uint16(packet, kSignallingDataOffset);
+        channel_psms_[key_of(handle, opposite(direction), destination_cid)] = pending->second;
+      }
+      pending_psms_.erase(pending);
+      break;
+    }
+    case kDisconnectionRequest: {
+      uint16_t destination_cid = read_uint16(packet, kSignallingDataOffset);
+      uint16_t source_cid = read_uint16(packet, kSignallingDataOffset + 2);
+      channel_psms_.erase(key_of(handle, direction, destination_cid));
+      channel_psms_.erase(key_of(handle, opposite(direction), source_cid));
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void SnoopCaptureFilter::forget_handle(uint16_t handle) {
+  for (auto* map : {&last_cids_, &channel_psms_, &pending_psms_}) {
+    for (auto it = map->begin(); it != map->end();) {
+      if (handle_of_key(it->first) == handle) {
+        it = map->erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+}
+
+}  // namespace hal
+}  // namespace bluetooth
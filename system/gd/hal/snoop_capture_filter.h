@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hal/snoop_logger.h"
+
+namespace bluetooth {
+namespace hal {
+
+// Decides how much of each packet the snoop logger captures, from a list of rules evaluated in order. Rules only look at
+// the HCI and L2CAP headers of a packet. The PSM of an L2CAP channel is learned from the connection requests and
+// responses seen on the signalling channels.
+class SnoopCaptureFilter {
+ public:
+  enum class Action {
+    // Capture the whole packet
+    FULL,
+    // Capture the HCI header, and the L2CAP basic header of ACL packets starting an L2CAP frame
+    HEADER,
+    // Don't capture the packet at all
+    DROP,
+  };
+
+  // A rule matches the packets which match all of its fields
+  struct Rule {
+    std::optional<SnoopLogger::PacketType> type;
+    // Connection handle of ACL, SCO and ISO packets
+    std::optional<uint16_t> handle;
+    // L2CAP channel of ACL packets, as written in the packet
+    std::optional<uint16_t> cid;
+    std::optional<uint16_t> psm;
+    Action action = Action::FULL;
+  };
+
+  // Parse rules such as "type=acl,psm=25:header;type=iso:header;type=sco:drop", or return std::nullopt when malformed
+  static std::optional<std::vector<Rule>> ParseRules(const std::string& rules);
+
+  // Return the number of bytes of packet captured by Action::HEADER
+  static size_t HeaderLength(const HciPacket& packet, SnoopLogger::PacketType type);
+
+  void SetRules(std::vector<Rule> rules);
+
+  // Return the action of the first rule matching packet, FULL when none does
+  Action Evaluate(const HciPacket& packet, SnoopLogger::Direction direction, SnoopLogger::PacketType type);
+
+ private:
+  void learn_l2cap_signalling(const HciPacket& packet, uint16_t handle, SnoopLogger::Direction direction);
+  void forget_handle(uint16_t handle);
+
+  std::atomic<bool> empty_ = true;
+  std::mutex mutex_;
+  std::vector<Rule> rules_;
+  bool track_psms_ = false;
+  // CID of the last L2CAP frame started on each handle and direction, for the continuation fragments
+  std::unordered_map<uint32_t, uint16_t> last_cids_;
+  // PSM of the channels, keyed by handle, direction of the data and CID written in the data
+  std::unordered_map<uint32_t, uint16_t> channel_psms_;
+  // PSM of the connection requests waiting for their response, keyed by handle, direction and identifier
+  std::unordered_map<uint32_t, uint16_t> pending_psms_;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
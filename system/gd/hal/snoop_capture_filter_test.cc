@@ -0,0 +1,112 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_capture_filter.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+using Action = SnoopCaptureFilter::Action;
+using Direction = SnoopLogger::Direction;
+using PacketType = SnoopLogger::PacketType;
+
+// AVDTP connection request from the local device on handle 0x002: PSM 0x0019, source CID 0x0040
+const HciPacket kAvdtpConnectionRequest = {
+    0x02, 0x20, 0x0c, 0x00, 0x08, 0x00, 0x01, 0x00, 0x02, 0x07, 0x04, 0x00, 0x19, 0x00, 0x40, 0x00};
+// Successful response of the peer: destination CID 0x0051, source CID 0x0040
+const HciPacket kAvdtpConnectionResponse = {0x02, 0x20, 0x10, 0x00, 0x0c, 0x00, 0x01, 0x00, 0x03, 0x07,
+                                            0x08, 0x00, 0x51, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00};
+// Media packets sent to the peer, and received from it
+const HciPacket kOutgoingMedia = {0x02, 0x20, 0x08, 0x00, 0x04, 0x00, 0x51, 0x00, 0x80, 0x60, 0x00, 0x01};
+const HciPacket kIncomingMedia = {0x02, 0x20, 0x08, 0x00, 0x04, 0x00, 0x40, 0x00, 0x80, 0x60, 0x00, 0x01};
+// Continuation of the outgoing media packet
+const HciPacket kOutgoingMediaContinuation = {0x02, 0x10, 0x02, 0x00, 0x12, 0x34};
+// Packet of another channel with the same CID as the local AVDTP channel, sent to the peer
+const HciPacket kOutgoingOtherChannel = {0x02, 0x20, 0x08, 0x00, 0x04, 0x00, 0x40, 0x00, 0x01, 0x02, 0x03, 0x04};
+const HciPacket kDisconnectionComplete = {0x05, 0x04, 0x00, 0x02, 0x00, 0x13};
+
+TEST(SnoopCaptureFilterTest, parse_rules) {
+  auto rules = SnoopCaptureFilter::ParseRules("type=acl, psm=25 : header; handle=3,cid=64:drop;type=iso:full;");
+  ASSERT_TRUE(rules);
+  ASSERT_EQ(3ul, rules->size());
+  ASSERT_EQ(PacketType::ACL, rules->at(0).type);
+  ASSERT_EQ(25, rules->at(0).psm);
+  ASSERT_FALSE(rules->at(0).handle);
+  ASSERT_EQ(Action::HEADER, rules->at(0).action);
+  ASSERT_EQ(3, rules->at(1).handle);
+  ASSERT_EQ(64, rules->at(1).cid);
+  ASSERT_EQ(Action::DROP, rules->at(1).action);
+  ASSERT_EQ(PacketType::ISO, rules->at(2).type);
+  ASSERT_EQ(Action::FULL, rules->at(2).action);
+  ASSERT_TRUE(SnoopCaptureFilter::ParseRules("")->empty());
+}
+
+TEST(SnoopCaptureFilterTest, parse_malformed_rules) {
+  ASSERT_FALSE(SnoopCaptureFilter::ParseRules("type=acl"));
+  ASSERT_FALSE(SnoopCaptureFilter::ParseRules("type=acl:truncate"));
+  ASSERT_FALSE(SnoopCaptureFilter::ParseRules("type=le:drop"));
+  ASSERT_FALSE(SnoopCaptureFilter::ParseRules("psm=65536:drop"));
+  ASSERT_FALSE(SnoopCaptureFilter::ParseRules("color=blue:drop"));
+  ASSERT_FALSE(SnoopCaptureFilter::ParseRules("handle:drop"));
+}
+
+TEST(SnoopCaptureFilterTest, no_rules_capture_everything) {
+  SnoopCaptureFilter filter;
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kOutgoingMedia, Direction::OUTGOING, PacketType::ACL));
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kDisconnectionComplete, Direction::INCOMING, PacketType::EVT));
+}
+
+TEST(SnoopCaptureFilterTest, first_matching_rule_wins) {
+  SnoopCaptureFilter filter;
+  filter.SetRules(*SnoopCaptureFilter::ParseRules("type=sco:drop;handle=2,cid=81:header;handle=2:drop"));
+  ASSERT_EQ(Action::DROP, filter.Evaluate({0x03, 0x00, 0x00}, Direction::OUTGOING, PacketType::SCO));
+  ASSERT_EQ(Action::HEADER, filter.Evaluate(kOutgoingMedia, Direction::OUTGOING, PacketType::ACL));
+  ASSERT_EQ(Action::HEADER, filter.Evaluate(kOutgoingMediaContinuation, Direction::OUTGOING, PacketType::ACL));
+  ASSERT_EQ(Action::DROP, filter.Evaluate(kIncomingMedia, Direction::INCOMING, PacketType::ACL));
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kAvdtpConnectionRequest, Direction::OUTGOING, PacketType::CMD));
+}
+
+TEST(SnoopCaptureFilterTest, learn_psm_from_signalling) {
+  SnoopCaptureFilter filter;
+  filter.SetRules(*SnoopCaptureFilter::ParseRules("psm=25:header"));
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kOutgoingMedia, Direction::OUTGOING, PacketType::ACL));
+
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kAvdtpConnectionRequest, Direction::OUTGOING, PacketType::ACL));
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kAvdtpConnectionResponse, Direction::INCOMING, PacketType::ACL));
+  ASSERT_EQ(Action::HEADER, filter.Evaluate(kOutgoingMedia, Direction::OUTGOING, PacketType::ACL));
+  ASSERT_EQ(Action::HEADER, filter.Evaluate(kOutgoingMediaContinuation, Direction::OUTGOING, PacketType::ACL));
+  ASSERT_EQ(Action::HEADER, filter.Evaluate(kIncomingMedia, Direction::INCOMING, PacketType::ACL));
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kOutgoingOtherChannel, Direction::OUTGOING, PacketType::ACL));
+
+  // The channels are forgotten with their connection
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kDisconnectionComplete, Direction::INCOMING, PacketType::EVT));
+  ASSERT_EQ(Action::FULL, filter.Evaluate(kOutgoingMedia, Direction::OUTGOING, PacketType::ACL));
+}
+
+TEST(SnoopCaptureFilterTest, header_length) {
+  ASSERT_EQ(8ul, SnoopCaptureFilter::HeaderLength(kOutgoingMedia, PacketType::ACL));
+  ASSERT_EQ(4ul, SnoopCaptureFilter::HeaderLength(kOutgoingMediaContinuation, PacketType::ACL));
+  ASSERT_EQ(2ul, SnoopCaptureFilter::HeaderLength(kDisconnectionComplete, PacketType::EVT));
+  ASSERT_EQ(4ul, SnoopCaptureFilter::HeaderLength(kOutgoingMedia, PacketType::ISO));
+  ASSERT_EQ(1ul, SnoopCaptureFilter::HeaderLength({0x01}, PacketType::CMD));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
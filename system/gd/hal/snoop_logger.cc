@@ -17,21 +17,26 @@
 #include "hal/snoop_logger.h"
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <bitset>
 #include <chrono>
-#include <sstream>
+#include <climits>
+#include <cstring>
 
-#include "common/circular_buffer.h"
 #include "common/init_flags.h"
 #include "common/strings.h"
+#include "hal/snoop_capture_filter.h"
 #include "os/fake_timer/fake_timerfd.h"
 #include "os/files.h"
 #include "os/log.h"
 #include "os/parameter_provider.h"
 #include "os/system_properties.h"
+#include "os/utils.h"
 
 namespace bluetooth {
 #ifdef USE_FAKE_TIMERS
@@ -73,6 +78,7 @@ constexpr size_t kDefaultBtSnoopMaxPacketsPerFile = 0xffff;
 
 // We restrict the maximum packet size to 150 bytes
 constexpr size_t kDefaultBtSnoozMaxBytesPerPacket = 150;
+static_assert(kDefaultBtSnoozMaxBytesPerPacket <= UINT8_MAX, "btsnooz record sizes are stored on a byte");
 constexpr size_t kDefaultBtSnoozMaxPayloadBytesPerPacket =
     kDefaultBtSnoozMaxBytesPerPacket - sizeof(SnoopLogger::PacketHeaderType);
 
@@ -80,6 +86,29 @@ using namespace std::chrono_literals;
 constexpr std::chrono::hours kBtSnoozLogLifeTime = 12h;
 constexpr std::chrono::hours kBtSnoozLogDeleteRepeatingAlarmInterval = 1h;
 
+static_assert((SnoopLogger::kAsyncRingSize & (SnoopLogger::kAsyncRingSize - 1)) == 0);
+
+// Write all the buffers of iov to fd, resuming after partial writes
+bool write_all(int fd, struct iovec* iov, int iov_count) {
+  while (iov_count > 0) {
+    ssize_t written;
+    RUN_NO_INTR(written = writev(fd, iov, iov_count));
+    if (written < 0) {
+      return false;
+    }
+    while (iov_count > 0 && static_cast<size_t>(written) >= iov->iov_len) {
+      written -= iov->iov_len;
+      iov++;
+      iov_count--;
+    }
+    if (iov_count > 0) {
+      iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + written;
+      iov->iov_len -= written;
+    }
+  }
+  return true;
+}
+
 std::string get_btsnoop_log_path(std::string log_dir, bool filtered) {
   if (filtered) {
     log_dir.append(".filtered");
@@ -169,9 +198,9 @@ size_t get_btsnooz_packet_length_to_write(
           // For the signaling CID, take the full packet.
           // That way, the PSM setup is captured, allowing decoding of PSMs down
           // the road.
-          return packet.size();
+          len_hci_acl = packet.size();
         } else if (qualcomm_debug_log_enabled && hci_acl_packet_handle == kQualcommDebugLogHandle) {
-          return packet.size();
+          len_hci_acl = packet.size();
         } else {
           // Otherwise, return as much as we reasonably can
           len_hci_acl = kMaxBtsnoozAclSize;
@@ -203,6 +232,9 @@ const std::string SnoopLogger::kIsDebuggableProperty = "ro.debuggable";
 const std::string SnoopLogger::kBtSnoopLogModeProperty = "persist.bluetooth.btsnooplogmode";
 const std::string SnoopLogger::kBtSnoopDefaultLogModeProperty = "persist.bluetooth.btsnoopdefaultmode";
 const std::string SnoopLogger::kSoCManufacturerProperty = "ro.soc.manufacturer";
+const std::string SnoopLogger::kBtSnoopAsyncWriterProperty = "persist.bluetooth.btsnoop.async_writer";
+const std::string SnoopLogger::kBtSnoopFlushIntervalProperty = "persist.bluetooth.btsnoop.flush_interval_ms";
+const std::string SnoopLogger::kBtSnoopCaptureFilterProperty = "persist.bluetooth.btsnoop.capture_filter";
 
 // The max ACL packet size (in bytes) in truncated logging mode. All information
 // past this point is truncated from a packet.
@@ -216,14 +248,20 @@ SnoopLogger::SnoopLogger(
     const std::string& btsnoop_mode,
     bool qualcomm_debug_log_enabled,
     const std::chrono::milliseconds snooz_log_life_time,
-    const std::chrono::milliseconds snooz_log_delete_alarm_interval)
+    const std::chrono::milliseconds snooz_log_delete_alarm_interval,
+    bool async_writer_enabled,
+    const std::chrono::milliseconds async_flush_interval,
+    const std::string& capture_filter)
     : snoop_log_path_(std::move(snoop_log_path)),
       snooz_log_path_(std::move(snooz_log_path)),
       max_packets_per_file_(max_packets_per_file),
-      btsnooz_buffer_(max_packets_per_buffer),
+      btsnooz_capacity_(max_packets_per_buffer),
       qualcomm_debug_log_enabled_(qualcomm_debug_log_enabled),
+      capture_filter_(std::make_unique<SnoopCaptureFilter>()),
       snooz_log_life_time_(snooz_log_life_time),
-      snooz_log_delete_alarm_interval_(snooz_log_delete_alarm_interval) {
+      snooz_log_delete_alarm_interval_(snooz_log_delete_alarm_interval),
+      async_writer_enabled_(async_writer_enabled),
+      async_flush_interval_(async_flush_interval) {
   if (false && btsnoop_mode == kBtSnoopLogModeFiltered) {
     // TODO(b/163733538): implement filtered snoop log in GD, currently filtered == disabled
     LOG_INFO("Filtered Snoop Logs enabled");
@@ -260,6 +298,26 @@ SnoopLogger::SnoopLogger(
   }
   // Add ".filtered" extension if necessary
   snoop_log_path_ = get_btsnoop_log_path(snoop_log_path_, is_filtered_);
+  if (!capture_filter.empty()) {
+    SetCaptureFilter(capture_filter);
+  }
+  if (!is_enabled_) {
+    btsnooz_records_.resize(btsnooz_capacity_ * kDefaultBtSnoozMaxBytesPerPacket);
+    btsnooz_record_sizes_.resize(btsnooz_capacity_);
+  }
+}
+
+SnoopLogger::~SnoopLogger() = default;
+
+bool SnoopLogger::SetCaptureFilter(const std::string& rules) {
+  auto parsed_rules = SnoopCaptureFilter::ParseRules(rules);
+  if (!parsed_rules) {
+    LOG_ERROR("Ignoring malformed capture filter '%s'", rules.c_str());
+    return false;
+  }
+  LOG_INFO("Capture filter set to '%s'", rules.c_str());
+  capture_filter_->SetRules(std::move(*parsed_rules));
+  return true;
 }
 
 void SnoopLogger::CloseCurrentSnoopLogFile() {
@@ -268,6 +326,10 @@ void SnoopLogger::CloseCurrentSnoopLogFile() {
     btsnoop_ostream_.flush();
     btsnoop_ostream_.close();
   }
+  if (btsnoop_fd_ >= 0) {
+    close(btsnoop_fd_);
+    btsnoop_fd_ = -1;
+  }
   packet_counter_ = 0;
 }
 
@@ -289,6 +351,24 @@ void SnoopLogger::OpenNextSnoopLogFile() {
   }
 
   mode_t prevmask = umask(0);
+  if (async_writer_enabled_) {
+    // The asynchronous writer needs a file descriptor for writev()
+    RUN_NO_INTR(btsnoop_fd_ = open(snoop_log_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666));
+#ifdef USE_FAKE_TIMERS
+    file_creation_time = fake_timerfd_get_clock();
+#endif
+    if (btsnoop_fd_ < 0) {
+      LOG_ALWAYS_FATAL("Unable to open snoop log at \"%s\", error: \"%s\"", snoop_log_path_.c_str(), strerror(errno));
+    }
+    umask(prevmask);
+    struct iovec iov = {
+        .iov_base = const_cast<FileHeaderType*>(&kBtSnoopFileHeader), .iov_len = sizeof(FileHeaderType)};
+    if (!write_all(btsnoop_fd_, &iov, 1)) {
+      LOG_ALWAYS_FATAL(
+          "Unable to write file header to \"%s\", error: \"%s\"", snoop_log_path_.c_str(), strerror(errno));
+    }
+    return;
+  }
   // do not use std::ios::app as we want override the existing file
   btsnoop_ostream_.open(snoop_log_path_, std::ios::binary | std::ios::out);
 #ifdef USE_FAKE_TIMERS
@@ -307,6 +387,10 @@ void SnoopLogger::OpenNextSnoopLogFile() {
 }
 
 void SnoopLogger::Capture(const HciPacket& packet, Direction direction, PacketType type) {
+  auto action = capture_filter_->Evaluate(packet, direction, type);
+  if (action == SnoopCaptureFilter::Action::DROP) {
+    return;
+  }
   uint64_t timestamp_us =
       std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
           .count();
@@ -337,20 +421,24 @@ void SnoopLogger::Capture(const HciPacket& packet, Direction direction, PacketTy
   if (is_truncated_ && type == PacketType::ACL) {
     header.length_captured = htonl(std::min(length, kMaxTruncatedAclPacketSize));
   }
+  if (action == SnoopCaptureFilter::Action::HEADER) {
+    uint32_t header_length = SnoopCaptureFilter::HeaderLength(packet, type) + /* type byte */ 1;
+    header.length_captured = htonl(std::min(ntohl(header.length_captured), header_length));
+  }
+  // Number of bytes of the packet following the record header
+  size_t captured_length = ntohl(header.length_captured) - /* type byte */ 1;
+  if (is_enabled_ && async_writer_enabled_) {
+    CaptureAsync(header, packet);
+    return;
+  }
   {
     std::lock_guard<std::recursive_mutex> lock(file_mutex_);
     if (!is_enabled_) {
       // btsnoop disabled, log in-memory btsnooz log only
-      std::stringstream ss;
-      size_t included_length = get_btsnooz_packet_length_to_write(packet, type, qualcomm_debug_log_enabled_);
+      size_t included_length =
+          std::min(get_btsnooz_packet_length_to_write(packet, type, qualcomm_debug_log_enabled_), captured_length);
       header.length_captured = htonl(included_length + /* type byte */ 1);
-      if (!ss.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
-        LOG_ERROR("Failed to write packet header for btsnooz, error: \"%s\"", strerror(errno));
-      }
-      if (!ss.write(reinterpret_cast<const char*>(packet.data()), included_length)) {
-        LOG_ERROR("Failed to write packet payload for btsnooz, error: \"%s\"", strerror(errno));
-      }
-      btsnooz_buffer_.Push(ss.str());
+      PushSnoozRecord(header, packet.data(), included_length);
       return;
     }
     packet_counter_++;
@@ -360,7 +448,7 @@ void SnoopLogger::Capture(const HciPacket& packet, Direction direction, PacketTy
     if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
       LOG_ERROR("Failed to write packet header for btsnoop, error: \"%s\"", strerror(errno));
     }
-    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(packet.data()), packet.size())) {
+    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(packet.data()), captured_length)) {
       LOG_ERROR("Failed to write packet payload for btsnoop, error: \"%s\"", strerror(errno));
     }
     // std::ofstream::flush() pushes user data into kernel memory. The data will be written even if this process
@@ -373,6 +461,122 @@ void SnoopLogger::Capture(const HciPacket& packet, Direction direction, PacketTy
   }
 }
 
+void SnoopLogger::PushSnoozRecord(const PacketHeaderType& header, const uint8_t* payload, size_t payload_size) {
+  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  if (btsnooz_capacity_ == 0) {
+    return;
+  }
+  size_t index = (btsnooz_first_ + btsnooz_count_) % btsnooz_capacity_;
+  if (btsnooz_count_ == btsnooz_capacity_) {
+    // Overwrite the oldest record
+    btsnooz_first_ = (btsnooz_first_ + 1) % btsnooz_capacity_;
+  } else {
+    btsnooz_count_++;
+  }
+  uint8_t* record = &btsnooz_records_[index * kDefaultBtSnoozMaxBytesPerPacket];
+  std::memcpy(record, &header, sizeof(PacketHeaderType));
+  std::memcpy(record + sizeof(PacketHeaderType), payload, payload_size);
+  btsnooz_record_sizes_[index] = static_cast<uint8_t>(sizeof(PacketHeaderType) + payload_size);
+}
+
+std::vector<std::string> SnoopLogger::PullSnoozRecords() const {
+  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  std::vector<std::string> records;
+  records.reserve(btsnooz_count_);
+  for (size_t i = 0; i < btsnooz_count_; i++) {
+    size_t index = (btsnooz_first_ + i) % btsnooz_capacity_;
+    auto record = reinterpret_cast<const char*>(&btsnooz_records_[index * kDefaultBtSnoozMaxBytesPerPacket]);
+    records.emplace_back(record, btsnooz_record_sizes_[index]);
+  }
+  return records;
+}
+
+void SnoopLogger::CaptureAsync(const PacketHeaderType& header, const HciPacket& packet) {
+  // Claim the next free chunk; the ring is shared by every thread capturing packets
+  size_t pos = async_enqueue_pos_.load(std::memory_order_relaxed);
+  AsyncChunk* chunk;
+  while (true) {
+    chunk = &async_ring_[pos & (kAsyncRingSize - 1)];
+    size_t sequence = chunk->sequence.load(std::memory_order_acquire);
+    if (sequence == pos) {
+      if (async_enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < pos) {
+      // The writer hasn't caught up yet, leave its records alone
+      async_dropped_packets_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      pos = async_enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  // length_captured counts the type byte, which is the last field of the header
+  size_t payload_size = std::min(
+      static_cast<size_t>(ntohl(header.length_captured)) - 1, kAsyncChunkSize - sizeof(PacketHeaderType));
+  PacketHeaderType chunk_header = header;
+  chunk_header.length_captured = htonl(payload_size + 1);
+  chunk_header.dropped_packets = htonl(async_dropped_packets_.load(std::memory_order_relaxed));
+  std::memcpy(chunk->data, &chunk_header, sizeof(PacketHeaderType));
+  std::memcpy(chunk->data + sizeof(PacketHeaderType), packet.data(), payload_size);
+  chunk->size = sizeof(PacketHeaderType) + payload_size;
+  chunk->sequence.store(pos + 1, std::memory_order_release);
+
+  // Don't wait for the flush interval once half of the ring is used
+  if (pos - async_dequeue_pos_.load(std::memory_order_relaxed) >= kAsyncRingSize / 2 &&
+      !async_flush_requested_.exchange(true, std::memory_order_relaxed)) {
+    async_handler_->Post(common::BindOnce(&SnoopLogger::FlushAsyncRecords, common::Unretained(this)));
+  }
+}
+
+void SnoopLogger::FlushAsyncRecords() {
+  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  async_flush_requested_.store(false, std::memory_order_relaxed);
+  size_t first = async_dequeue_pos_.load(std::memory_order_relaxed);
+  size_t count = 0;
+  while (true) {
+    auto& chunk = async_ring_[(first + count) & (kAsyncRingSize - 1)];
+    if (chunk.sequence.load(std::memory_order_acquire) != first + count + 1) {
+      break;
+    }
+    packet_counter_++;
+    if (packet_counter_ > max_packets_per_file_) {
+      WriteAsyncChunks(first, count);
+      first += count;
+      count = 0;
+      OpenNextSnoopLogFile();
+    }
+    count++;
+    if (count == static_cast<size_t>(IOV_MAX)) {
+      WriteAsyncChunks(first, count);
+      first += count;
+      count = 0;
+    }
+  }
+  WriteAsyncChunks(first, count);
+}
+
+void SnoopLogger::WriteAsyncChunks(size_t first, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  struct iovec iov[IOV_MAX];
+  for (size_t i = 0; i < count; i++) {
+    auto& chunk = async_ring_[(first + i) & (kAsyncRingSize - 1)];
+    iov[i] = {.iov_base = chunk.data, .iov_len = chunk.size};
+  }
+  // writev() pushes the records into kernel memory, like std::ofstream::flush() in the synchronous mode
+  if (!write_all(btsnoop_fd_, iov, static_cast<int>(count))) {
+    LOG_ERROR("Failed to write %zu packets for btsnoop, error: \"%s\"", count, strerror(errno));
+  }
+  // Hand the chunks back to Capture()
+  for (size_t i = 0; i < count; i++) {
+    auto& chunk = async_ring_[(first + i) & (kAsyncRingSize - 1)];
+    chunk.sequence.store(first + i + kAsyncRingSize, std::memory_order_release);
+  }
+  async_dequeue_pos_.store(first + count, std::memory_order_relaxed);
+}
+
 void SnoopLogger::DumpSnoozLogToFile(const std::vector<std::string>& data) const {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   if (is_enabled_) {
@@ -422,14 +626,48 @@ void SnoopLogger::Start() {
   if (is_enabled_) {
     OpenNextSnoopLogFile();
   }
+  if (is_enabled_ && async_writer_enabled_) {
+    LOG_INFO("Writing btsnoop log every %lld ms", static_cast<long long>(async_flush_interval_.count()));
+    async_ring_ = std::make_unique<AsyncChunk[]>(kAsyncRingSize);
+    for (size_t i = 0; i < kAsyncRingSize; i++) {
+      async_ring_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    async_enqueue_pos_ = 0;
+    async_dequeue_pos_ = 0;
+    async_dropped_packets_ = 0;
+    async_thread_ = std::make_unique<os::Thread>("bt_snoop_writer", os::Thread::Priority::NORMAL);
+    async_handler_ = std::make_unique<os::Handler>(async_thread_.get());
+    async_flush_alarm_ = std::make_unique<os::RepeatingAlarm>(async_handler_.get());
+    async_flush_alarm_->Schedule(
+        common::Bind(&SnoopLogger::FlushAsyncRecords, common::Unretained(this)), async_flush_interval_);
+  }
   alarm_ = std::make_unique<os::RepeatingAlarm>(GetHandler());
   alarm_->Schedule(
       common::Bind(&delete_old_btsnooz_files, snooz_log_path_, snooz_log_life_time_), snooz_log_delete_alarm_interval_);
 }
 
 void SnoopLogger::Stop() {
+  // Stop the writer thread before taking file_mutex_, which a flush in progress on that thread may be waiting for
+  bool async_writer_stopped = false;
+  if (async_thread_ != nullptr) {
+    async_flush_alarm_->Cancel();
+    async_flush_alarm_.reset();
+    async_handler_->Clear();
+    async_handler_->WaitUntilStopped(std::chrono::milliseconds(2000));
+    async_handler_.reset();
+    async_thread_->Stop();
+    async_thread_.reset();
+    async_writer_stopped = true;
+  }
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   LOG_DEBUG("Closing btsnoop log data at %s", snoop_log_path_.c_str());
+  if (async_writer_stopped) {
+    // Write what was captured since the last flush
+    FlushAsyncRecords();
+    if (async_dropped_packets_ > 0) {
+      LOG_WARN("Dropped %u btsnoop packets", async_dropped_packets_.load());
+    }
+  }
   CloseCurrentSnoopLogFile();
   // Cancel the alarm
   alarm_->Cancel();
@@ -440,7 +678,7 @@ void SnoopLogger::Stop() {
 
 DumpsysDataFinisher SnoopLogger::GetDumpsysData(flatbuffers::FlatBufferBuilder* builder) const {
   LOG_DEBUG("Dumping btsnooz log data to %s", snooz_log_path_.c_str());
-  DumpSnoozLogToFile(btsnooz_buffer_.Pull());
+  DumpSnoozLogToFile(PullSnoozRecords());
   return Module::GetDumpsysData(builder);
 }
 
@@ -504,6 +742,21 @@ bool SnoopLogger::IsQualcommDebugLogEnabled() {
   return qualcomm_debug_log_enabled;
 }
 
+bool SnoopLogger::IsAsyncWriterEnabled() {
+  return os::GetSystemPropertyBool(kBtSnoopAsyncWriterProperty, false);
+}
+
+std::chrono::milliseconds SnoopLogger::GetAsyncFlushInterval() {
+  auto flush_interval_ms = os::GetSystemPropertyUint32(
+      kBtSnoopFlushIntervalProperty, static_cast<uint32_t>(kDefaultAsyncFlushInterval.count()));
+  // A zero interval would keep the writer thread busy
+  return std::chrono::milliseconds(std::max(flush_interval_ms, 1u));
+}
+
+std::string SnoopLogger::GetCaptureFilter() {
+  return os::GetSystemProperty(kBtSnoopCaptureFilterProperty).value_or("");
+}
+
 const ModuleFactory SnoopLogger::Factory = ModuleFactory([]() {
   return new SnoopLogger(
       os::ParameterProvider::SnoopLogFilePath(),
@@ -513,7 +766,10 @@ const ModuleFactory SnoopLogger::Factory = ModuleFactory([]() {
       GetBtSnoopMode(),
       IsQualcommDebugLogEnabled(),
       kBtSnoozLogLifeTime,
-      kBtSnoozLogDeleteRepeatingAlarmInterval);
+      kBtSnoozLogDeleteRepeatingAlarmInterval,
+      IsAsyncWriterEnabled(),
+      GetAsyncFlushInterval(),
+      GetCaptureFilter());
 });
 
 }  // namespace hal
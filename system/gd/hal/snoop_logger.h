@@ -16,19 +16,26 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
-#include "common/circular_buffer.h"
 #include "hal/hci_hal.h"
 #include "module.h"
+#include "os/handler.h"
 #include "os/repeating_alarm.h"
+#include "os/thread.h"
 
 namespace bluetooth {
 namespace hal {
 
+class SnoopCaptureFilter;
+
 #ifdef USE_FAKE_TIMERS
 static uint64_t file_creation_time;
 #endif
@@ -48,6 +55,16 @@ class SnoopLogger : public ::bluetooth::Module {
   static const std::string kBtSnoopLogModeProperty;
   static const std::string kBtSnoopDefaultLogModeProperty;
   static const std::string kSoCManufacturerProperty;
+  static const std::string kBtSnoopAsyncWriterProperty;
+  static const std::string kBtSnoopFlushIntervalProperty;
+  static const std::string kBtSnoopCaptureFilterProperty;
+
+  // Size of the preallocated chunks holding a packet for the asynchronous writer, header included. Longer packets are
+  // truncated to fit, and logged with their original length.
+  static constexpr size_t kAsyncChunkSize = 1088;
+  // Number of chunks in the ring of the asynchronous writer, a power of two
+  static constexpr size_t kAsyncRingSize = 512;
+  static constexpr std::chrono::milliseconds kDefaultAsyncFlushInterval = std::chrono::milliseconds(100);
 
   // Put in header for test
   struct PacketHeaderType {
@@ -80,6 +97,17 @@ class SnoopLogger : public ::bluetooth::Module {
   // Changes to this value is only effective after restarting Bluetooth
   static bool IsQualcommDebugLogEnabled();
 
+  // Returns whether btsnoop records are written from a background thread instead of in Capture()
+  // Changes to this value is only effective after restarting Bluetooth
+  static bool IsAsyncWriterEnabled();
+
+  // Returns how often the background thread writes the records captured so far
+  // Changes to this value is only effective after restarting Bluetooth
+  static std::chrono::milliseconds GetAsyncFlushInterval();
+
+  // Returns the capture rules applied to every packet, see SnoopCaptureFilter::ParseRules()
+  static std::string GetCaptureFilter();
+
   // Has to be defined from 1 to 4 per btsnoop format
   enum PacketType {
     CMD = 1,
@@ -94,8 +122,13 @@ class SnoopLogger : public ::bluetooth::Module {
     OUTGOING,
   };
 
+  ~SnoopLogger() override;
+
   void Capture(const HciPacket& packet, Direction direction, PacketType type);
 
+  // Replace the capture rules, see SnoopCaptureFilter::ParseRules(). Malformed rules are ignored and return false.
+  bool SetCaptureFilter(const std::string& rules);
+
  protected:
   void ListDependencies(ModuleList* list) const override;
   void Start() override;
@@ -114,12 +147,29 @@ class SnoopLogger : public ::bluetooth::Module {
       const std::string& btsnoop_mode,
       bool qualcomm_debug_log_enabled,
       const std::chrono::milliseconds snooz_log_life_time,
-      const std::chrono::milliseconds snooz_log_delete_alarm_interval);
+      const std::chrono::milliseconds snooz_log_delete_alarm_interval,
+      bool async_writer_enabled = false,
+      const std::chrono::milliseconds async_flush_interval = kDefaultAsyncFlushInterval,
+      const std::string& capture_filter = "");
   void CloseCurrentSnoopLogFile();
   void OpenNextSnoopLogFile();
   void DumpSnoozLogToFile(const std::vector<std::string>& data) const;
+  // Write every record queued for the asynchronous writer so far
+  void FlushAsyncRecords();
 
  private:
+  struct AsyncChunk {
+    // Vyukov bounded queue sequence: index of the chunk when free, index + 1 once it holds a record
+    std::atomic<size_t> sequence;
+    size_t size;
+    uint8_t data[kAsyncChunkSize];
+  };
+
+  void PushSnoozRecord(const PacketHeaderType& header, const uint8_t* payload, size_t payload_size);
+  std::vector<std::string> PullSnoozRecords() const;
+  void CaptureAsync(const PacketHeaderType& header, const HciPacket& packet);
+  void WriteAsyncChunks(size_t first, size_t count);
+
   std::string snoop_log_path_;
   std::string snooz_log_path_;
   std::ofstream btsnoop_ostream_;
@@ -127,13 +177,34 @@ class SnoopLogger : public ::bluetooth::Module {
   bool is_filtered_ = false;
   bool is_truncated_ = false;
   size_t max_packets_per_file_;
-  common::CircularBuffer<std::string> btsnooz_buffer_;
+  // In-memory btsnooz log: a ring of fixed size records, preallocated so that capturing a packet doesn't allocate
+  size_t btsnooz_capacity_;
+  std::vector<uint8_t> btsnooz_records_;
+  std::vector<uint8_t> btsnooz_record_sizes_;
+  size_t btsnooz_first_ = 0;
+  size_t btsnooz_count_ = 0;
   bool qualcomm_debug_log_enabled_ = false;
   size_t packet_counter_ = 0;
+  std::unique_ptr<SnoopCaptureFilter> capture_filter_;
   mutable std::recursive_mutex file_mutex_;
   std::unique_ptr<os::RepeatingAlarm> alarm_;
   std::chrono::milliseconds snooz_log_life_time_;
   std::chrono::milliseconds snooz_log_delete_alarm_interval_;
+
+  // Asynchronous writer state. Capture() only claims and fills chunks of the ring; the records are written with
+  // writev() from async_thread_, every async_flush_interval_ or as soon as half of the ring is used.
+  bool async_writer_enabled_ = false;
+  std::chrono::milliseconds async_flush_interval_;
+  int btsnoop_fd_ = -1;
+  std::unique_ptr<AsyncChunk[]> async_ring_;
+  std::atomic<size_t> async_enqueue_pos_ = 0;
+  std::atomic<size_t> async_dequeue_pos_ = 0;
+  std::atomic<bool> async_flush_requested_ = false;
+  // Cumulative number of records dropped because the ring was full, as reported in the btsnoop record headers
+  std::atomic<uint32_t> async_dropped_packets_ = 0;
+  std::unique_ptr<os::Thread> async_thread_;
+  std::unique_ptr<os::Handler> async_handler_;
+  std::unique_ptr<os::RepeatingAlarm> async_flush_alarm_;
 };
 
 }  // namespace hal
@@ -16,6 +16,7 @@
 
 #include "hal/snoop_logger.h"
 
+#include <arpa/inet.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -69,7 +70,8 @@ class TestSnoopLoggerModule : public SnoopLogger {
       std::string snooz_log_path,
       size_t max_packets_per_file,
       const std::string& btsnoop_mode,
-      bool qualcomm_debug_log_enabled)
+      bool qualcomm_debug_log_enabled,
+      bool async_writer_enabled = false)
       : SnoopLogger(
             std::move(snoop_log_path),
             std::move(snooz_log_path),
@@ -78,7 +80,8 @@ class TestSnoopLoggerModule : public SnoopLogger {
             btsnoop_mode,
             qualcomm_debug_log_enabled,
             20ms,
-            5ms) {}
+            5ms,
+            async_writer_enabled) {}
 
   std::string ToString() const override {
     return std::string("TestSnoopLoggerModule");
@@ -207,6 +210,30 @@ TEST_F(SnoopLoggerModuleTest, capture_hci_cmd_btsnooz_test) {
   ASSERT_FALSE(std::filesystem::exists(temp_snooz_log_));
 }
 
+TEST_F(SnoopLoggerModuleTest, btsnooz_buffer_overwrites_oldest_packet_test) {
+  // Actual test
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(), temp_snooz_log_.string(), 10, SnoopLogger::kBtSnoopLogModeDisabled, false);
+  TestModuleRegistry test_registry;
+  test_registry.InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  size_t max_packets = SnoopLogger::GetMaxPacketsPerBuffer();
+  snoop_logger->Capture(kInformationRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+  for (size_t i = 0; i < max_packets; i++) {
+    snoop_logger->Capture(kSdpConnectionRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+  }
+  snoop_logger->CallGetDumpsysData(builder_);
+
+  // The first packet was overwritten
+  ASSERT_TRUE(std::filesystem::exists(temp_snooz_log_));
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snooz_log_),
+      sizeof(SnoopLogger::FileHeaderType) +
+          (sizeof(SnoopLogger::PacketHeaderType) + kSdpConnectionRequest.size()) * max_packets);
+
+  test_registry.StopAll();
+}
+
 TEST_F(SnoopLoggerModuleTest, capture_l2cap_signal_packet_btsnooz_test) {
   // Actual test
   auto* snoop_logger = new TestSnoopLoggerModule(
@@ -230,6 +257,35 @@ TEST_F(SnoopLoggerModuleTest, capture_l2cap_signal_packet_btsnooz_test) {
   ASSERT_FALSE(std::filesystem::exists(temp_snooz_log_));
 }
 
+TEST_F(SnoopLoggerModuleTest, capture_oversized_l2cap_signal_packet_btsnooz_test) {
+  // A 1000 byte signalling packet on handle 0x0008, larger than a btsnooz record
+  constexpr uint16_t kL2capLength = 1000;
+  std::vector<uint8_t> oversized_signal_packet = {
+      0x08, 0x20, (kL2capLength + 4) & 0xff, (kL2capLength + 4) >> 8, kL2capLength & 0xff, kL2capLength >> 8,
+      0x01, 0x00};
+  oversized_signal_packet.resize(oversized_signal_packet.size() + kL2capLength, 0xa5);
+  // Size of a btsnooz record, header included
+  constexpr size_t kMaxBtsnoozRecordSize = 150;
+
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(), temp_snooz_log_.string(), 10, SnoopLogger::kBtSnoopLogModeDisabled, false);
+  TestModuleRegistry test_registry;
+  test_registry.InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  snoop_logger->Capture(oversized_signal_packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
+  snoop_logger->Capture(kSdpConnectionRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
+  snoop_logger->CallGetDumpsysData(builder_);
+
+  // The oversized packet is truncated to one record and the next record is intact
+  ASSERT_TRUE(std::filesystem::exists(temp_snooz_log_));
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snooz_log_),
+      sizeof(SnoopLogger::FileHeaderType) + kMaxBtsnoozRecordSize + sizeof(SnoopLogger::PacketHeaderType) +
+          kSdpConnectionRequest.size());
+
+  test_registry.StopAll();
+}
+
 TEST_F(SnoopLoggerModuleTest, capture_l2cap_short_data_packet_btsnooz_test) {
   // Actual test
   auto* snoop_logger = new TestSnoopLoggerModule(
@@ -359,6 +415,74 @@ TEST_F(SnoopLoggerModuleTest, rotate_file_after_full_test) {
       sizeof(SnoopLogger::FileHeaderType) + (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 10);
 }
 
+TEST_F(SnoopLoggerModuleTest, async_writer_rotate_file_after_full_test) {
+  // Actual test
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(), temp_snooz_log_.string(), 10, SnoopLogger::kBtSnoopLogModeFull, false, true);
+  TestModuleRegistry test_registry;
+  test_registry.InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  for (int i = 0; i < 11; i++) {
+    snoop_logger->Capture(kInformationRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+  }
+
+  test_registry.StopAll();
+
+  // Verify states after test
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_));
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_last_));
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_),
+      sizeof(SnoopLogger::FileHeaderType) + (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 1);
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_last_),
+      sizeof(SnoopLogger::FileHeaderType) + (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()) * 10);
+}
+
+TEST_F(SnoopLoggerModuleTest, async_writer_truncate_long_packet_test) {
+  // Actual test
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(), temp_snooz_log_.string(), 10, SnoopLogger::kBtSnoopLogModeFull, false, true);
+  TestModuleRegistry test_registry;
+  test_registry.InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  std::vector<uint8_t> long_packet(SnoopLogger::kAsyncChunkSize * 2, 0x42);
+  snoop_logger->Capture(long_packet, SnoopLogger::Direction::INCOMING, SnoopLogger::PacketType::ACL);
+
+  test_registry.StopAll();
+
+  // Verify states after test
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_), sizeof(SnoopLogger::FileHeaderType) + SnoopLogger::kAsyncChunkSize);
+  std::ifstream log(temp_snoop_log_, std::ios::binary);
+  log.seekg(sizeof(SnoopLogger::FileHeaderType));
+  SnoopLogger::PacketHeaderType header;
+  ASSERT_TRUE(log.read(reinterpret_cast<char*>(&header), sizeof(header)));
+  ASSERT_EQ(long_packet.size() + 1, ntohl(header.length_original));
+  ASSERT_EQ(SnoopLogger::kAsyncChunkSize - sizeof(SnoopLogger::PacketHeaderType) + 1, ntohl(header.length_captured));
+  ASSERT_EQ(0u, header.dropped_packets);
+}
+
+TEST_F(SnoopLoggerModuleTest, capture_filter_test) {
+  // Actual test
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(), temp_snooz_log_.string(), 10, SnoopLogger::kBtSnoopLogModeFull, false);
+  TestModuleRegistry test_registry;
+  test_registry.InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  ASSERT_FALSE(snoop_logger->SetCaptureFilter("type=acl:truncate"));
+  ASSERT_TRUE(snoop_logger->SetCaptureFilter("type=acl:header;type=cmd:drop"));
+  snoop_logger->Capture(kAvdtpSuspend, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::ACL);
+  snoop_logger->Capture(kInformationRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+
+  test_registry.StopAll();
+
+  // Verify states after test: only the HCI and L2CAP headers of the ACL packet are captured
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_),
+      sizeof(SnoopLogger::FileHeaderType) + sizeof(SnoopLogger::PacketHeaderType) + 8);
+}
+
 TEST_F(SnoopLoggerModuleTest, qualcomm_debug_log_test) {
   auto* snoop_logger = new TestSnoopLoggerModule(
       temp_snoop_log_.string(), temp_snooz_log_.string(), 10, SnoopLogger::kBtSnoopLogModeDisabled, true);
@@ -83,7 +83,11 @@ struct AclManager::impl {
     }
 
     hci_queue_end_->UnregisterDequeue();
-    delete round_robin_scheduler_;
+    {
+      const std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+      delete round_robin_scheduler_;
+      round_robin_scheduler_ = nullptr;
+    }
     if (enqueue_registered_.exchange(false)) {
       hci_queue_end_->UnregisterEnqueue();
     }
@@ -139,25 +143,17 @@ void AclManager::RegisterCallbacks(ConnectionCallbacks* callbacks, os::Handler*
 
 void AclManager::UnregisterCallbacks(ConnectionCallbacks* callbacks, std::promise<void> promise) {
   ASSERT(callbacks != nullptr);
-  CallOn(
-      pimpl_->classic_impl_,
-      &classic_impl::handle_unregister_callbacks,
-      common::Unretained(callbacks),
-      std::move(promise));
+  CallOn(pimpl_->classic_impl_, &classic_impl::handle_unregister_callbacks, callbacks, std::move(promise));
 }
 
 void AclManager::RegisterLeCallbacks(LeConnectionCallbacks* callbacks, os::Handler* handler) {
   ASSERT(callbacks != nullptr && handler != nullptr);
-  CallOn(
-      pimpl_->le_impl_,
-      &le_impl::handle_register_le_callbacks,
-      common::Unretained(callbacks),
-      common::Unretained(handler));
+  CallOn(pimpl_->le_impl_, &le_impl::handle_register_le_callbacks, callbacks, handler);
 }
 
 void AclManager::UnregisterLeCallbacks(LeConnectionCallbacks* callbacks, std::promise<void> promise) {
   ASSERT(callbacks != nullptr);
-  CallOn(pimpl_->le_impl_, &le_impl::handle_unregister_le_callbacks, common::Unretained(callbacks), std::move(promise));
+  CallOn(pimpl_->le_impl_, &le_impl::handle_unregister_le_callbacks, callbacks, std::move(promise));
 }
 
 void AclManager::CreateConnection(Address address) {
@@ -281,6 +277,10 @@ void AclManager::WriteDefaultLinkPolicySettings(uint16_t default_link_policy_set
   CallOn(pimpl_->classic_impl_, &classic_impl::write_default_link_policy_settings, default_link_policy_settings);
 }
 
+void AclManager::SetAclLinkQos(uint16_t handle, uint8_t weight, std::chrono::milliseconds max_latency) {
+  CallOn(pimpl_->round_robin_scheduler_, &RoundRobinScheduler::SetLinkQos, handle, weight, max_latency);
+}
+
 void AclManager::OnAdvertisingSetTerminated(ErrorCode status, uint16_t conn_handle, hci::AddressWithType adv_address) {
   if (status == ErrorCode::SUCCESS) {
     CallOn(pimpl_->le_impl_, &le_impl::UpdateLocalAddress, conn_handle, adv_address);
@@ -341,6 +341,8 @@ void AclManager::impl::Dump(
       (le_impl_ != nullptr) ? connectability_state_machine_text(le_impl_->connectability_state_) : "INDETERMINATE";
   const auto le_create_connection_timeout_alarms_count =
       (le_impl_ != nullptr) ? (int)le_impl_->create_connection_timeout_alarms_.size() : 0;
+  const auto pause_window_stats = (le_impl_ != nullptr) ? le_impl_->le_address_manager_->GetPauseWindowStats()
+                                                         : LeAddressManager::PauseWindowStats();
 
   auto title = fb_builder->CreateString("----- Acl Manager Dumpsys -----");
   auto le_connectability_state = fb_builder->CreateString(le_connectability_state_text);
@@ -353,12 +355,36 @@ void AclManager::impl::Dump(
   }
   auto vecofstrings = fb_builder->CreateVector(strings, connect_list.size());
 
+  // The modules are dumped on their handler, where the scheduler runs
+  std::vector<flatbuffers::Offset<AclLinkStatsData>> link_stats;
+  if (round_robin_scheduler_ != nullptr) {
+    for (uint16_t handle : round_robin_scheduler_->GetLinkHandles()) {
+      auto stats = round_robin_scheduler_->GetLinkStats(handle);
+      ASSERT(stats.has_value());
+      AclLinkStatsDataBuilder link_builder(*fb_builder);
+      link_builder.add_handle(handle);
+      link_builder.add_weight(stats->weight);
+      link_builder.add_max_latency_ms(stats->max_latency.count());
+      link_builder.add_queue_depth(stats->queue_depth);
+      link_builder.add_sent_packets(stats->sent_packets);
+      link_builder.add_total_wait_us(stats->total_wait.count());
+      link_builder.add_max_wait_us(stats->max_wait.count());
+      link_stats.push_back(link_builder.Finish());
+    }
+  }
+  auto link_stats_offset = fb_builder->CreateVector(link_stats);
+
   AclManagerDataBuilder builder(*fb_builder);
   builder.add_title(title);
   builder.add_le_filter_accept_list_count(connect_list.size());
   builder.add_le_filter_accept_list(vecofstrings);
   builder.add_le_connectability_state(le_connectability_state);
   builder.add_le_create_connection_timeout_alarms_count(le_create_connection_timeout_alarms_count);
+  builder.add_le_pause_window_count(pause_window_stats.count);
+  builder.add_le_pause_window_total_us(pause_window_stats.total.count());
+  builder.add_le_pause_window_max_us(pause_window_stats.max.count());
+  builder.add_le_pause_window_last_us(pause_window_stats.last.count());
+  builder.add_link_stats(link_stats_offset);
 
   flatbuffers::Offset<AclManagerData> dumpsys_data = builder.Finish();
   promise.set_value(dumpsys_data);
@@ -125,6 +125,10 @@ public:
  virtual uint16_t ReadDefaultLinkPolicySettings();
  virtual void WriteDefaultLinkPolicySettings(uint16_t default_link_policy_settings);
 
+ // Gives the link |weight| times the share of the controller buffers of a default link, and sends its packets ahead of
+ // the other links once they waited |max_latency|. A zero |max_latency| removes the latency budget.
+ virtual void SetAclLinkQos(uint16_t handle, uint8_t weight, std::chrono::milliseconds max_latency);
+
  // Callback from Advertising Manager to notify the advitiser (local) address
  virtual void OnAdvertisingSetTerminated(ErrorCode status, uint16_t conn_handle, hci::AddressWithType adv_address);
 
@@ -17,7 +17,7 @@
 #include "hci/acl_manager/acl_fragmenter.h"
 
 #include "os/log.h"
-#include "packet/fragmenting_inserter.h"
+#include "packet/slice_builder.h"
 
 namespace bluetooth {
 namespace hci {
@@ -26,11 +26,14 @@ namespace acl_manager {
 AclFragmenter::AclFragmenter(size_t mtu, std::unique_ptr<packet::BasePacketBuilder> packet)
     : mtu_(mtu), packet_(std::move(packet)) {}
 
-std::vector<std::unique_ptr<packet::RawBuilder>> AclFragmenter::GetFragments() {
-  std::vector<std::unique_ptr<packet::RawBuilder>> to_return;
-  packet::FragmentingInserter fragmenting_inserter(mtu_, std::back_insert_iterator(to_return));
-  packet_->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
+std::vector<std::unique_ptr<packet::BasePacketBuilder>> AclFragmenter::GetFragments() {
+  ASSERT(mtu_ > 0);
+  auto slices = packet::SliceBuilder::Split(*packet_, mtu_);
+  std::vector<std::unique_ptr<packet::BasePacketBuilder>> to_return;
+  to_return.reserve(slices.size());
+  for (auto& slice : slices) {
+    to_return.push_back(std::move(slice));
+  }
   return to_return;
 }
 
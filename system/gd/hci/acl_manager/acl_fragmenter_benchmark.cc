@@ -0,0 +1,112 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/acl_manager/acl_fragmenter.h"
+#include "hci/acl_manager/assembler.h"
+#include "packet/bit_inserter.h"
+#include "packet/fragmenting_inserter.h"
+#include "packet/packet_view.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::acl_manager::AclFragmenter;
+using ::bluetooth::packet::BasePacketBuilder;
+using ::bluetooth::packet::BitInserter;
+using ::bluetooth::packet::FragmentingInserter;
+using ::bluetooth::packet::RawBuilder;
+
+namespace {
+
+// Size of the L2CAP PDU fragmented and recombined by every iteration
+constexpr size_t kPduSize = 4096;
+
+std::unique_ptr<RawBuilder> make_pdu() {
+  std::vector<uint8_t> bytes(kPduSize);
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+  return std::make_unique<RawBuilder>(std::move(bytes));
+}
+
+// Serialize every fragment, as the HCI layer does before handing it to the HAL
+size_t serialize_fragments(const std::vector<std::unique_ptr<BasePacketBuilder>>& fragments) {
+  size_t total = 0;
+  for (const auto& fragment : fragments) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(fragment->size());
+    BitInserter it(bytes);
+    fragment->Serialize(it);
+    total += bytes.size();
+  }
+  return total;
+}
+
+// Fragmentation copying every byte into the fragments, as done before slicing the serialized PDU
+void BM_AclFragmenter_copying(State& state) {
+  size_t mtu = state.range(0);
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<RawBuilder>> raw_fragments;
+    FragmentingInserter fragmenting_inserter(mtu, std::back_insert_iterator(raw_fragments));
+    make_pdu()->Serialize(fragmenting_inserter);
+    fragmenting_inserter.finalize();
+    std::vector<std::unique_ptr<BasePacketBuilder>> fragments(
+        std::make_move_iterator(raw_fragments.begin()), std::make_move_iterator(raw_fragments.end()));
+    benchmark::DoNotOptimize(serialize_fragments(fragments));
+  }
+  state.SetBytesProcessed(state.iterations() * kPduSize);
+}
+BENCHMARK(BM_AclFragmenter_copying)->Arg(27)->Arg(251)->Arg(1021);
+
+void BM_AclFragmenter_slicing(State& state) {
+  size_t mtu = state.range(0);
+  for (auto _ : state) {
+    auto fragments = AclFragmenter(mtu, make_pdu()).GetFragments();
+    benchmark::DoNotOptimize(serialize_fragments(fragments));
+  }
+  state.SetBytesProcessed(state.iterations() * kPduSize);
+}
+BENCHMARK(BM_AclFragmenter_slicing)->Arg(27)->Arg(251)->Arg(1021);
+
+// Recombine the payloads of received ACL packets into a chain of views, then read the PDU back
+void BM_AclRecombination(State& state) {
+  size_t mtu = state.range(0);
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> received;
+  for (size_t begin = 0; begin < kPduSize; begin += mtu) {
+    auto end = std::min(begin + mtu, kPduSize);
+    received.push_back(std::make_shared<std::vector<uint8_t>>(end - begin, static_cast<uint8_t>(begin)));
+  }
+  for (auto _ : state) {
+    bluetooth::hci::acl_manager::PacketViewForRecombination pdu(
+        bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(received.front()));
+    for (size_t i = 1; i < received.size(); i++) {
+      pdu.AppendPacketView(bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(received[i]));
+    }
+    uint32_t sum = 0;
+    for (auto byte : pdu) {
+      sum += byte;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * kPduSize);
+}
+BENCHMARK(BM_AclRecombination)->Arg(27)->Arg(251)->Arg(1021);
+
+}  // namespace
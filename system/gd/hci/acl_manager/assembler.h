@@ -19,6 +19,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 
 #include "hci/acl_manager/acl_connection.h"
 #include "hci/address_with_type.h"
@@ -61,8 +62,8 @@ struct assembler {
   AddressWithType address_with_type_;
   AclConnection::QueueDownEnd* down_end_;
   os::Handler* handler_;
-  PacketViewForRecombination recombination_stage_{
-      PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>())};
+  // Fragments of the PDU being recombined, chained as views of the received packets without copying them
+  std::optional<PacketViewForRecombination> recombination_stage_;
   size_t remaining_sdu_continuation_packet_size_ = 0;
   std::shared_ptr<std::atomic_bool> enqueue_registered_ = std::make_shared<std::atomic_bool>(false);
   std::queue<packet::PacketView<packet::kLittleEndian>> incoming_queue_;
@@ -97,30 +98,29 @@ struct assembler {
       return;
     }
     if (packet_boundary_flag == PacketBoundaryFlag::CONTINUING_FRAGMENT) {
-      if (remaining_sdu_continuation_packet_size_ < payload_size) {
+      if (!recombination_stage_.has_value() || remaining_sdu_continuation_packet_size_ < payload_size) {
         LOG_WARN("Remote sent unexpected L2CAP PDU. Drop the entire L2CAP PDU");
-        recombination_stage_ =
-            PacketViewForRecombination(PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>()));
+        recombination_stage_.reset();
         remaining_sdu_continuation_packet_size_ = 0;
         return;
       }
       remaining_sdu_continuation_packet_size_ -= payload_size;
-      recombination_stage_.AppendPacketView(payload);
+      recombination_stage_->AppendPacketView(payload);
       if (remaining_sdu_continuation_packet_size_ != 0) {
         return;
       } else {
-        payload = recombination_stage_;
-        recombination_stage_ =
-            PacketViewForRecombination(PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>()));
+        payload = *recombination_stage_;
+        recombination_stage_.reset();
       }
     } else if (packet_boundary_flag == PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE) {
-      if (recombination_stage_.size() > 0) {
+      if (recombination_stage_.has_value()) {
         LOG_ERROR("Controller sent a starting packet without finishing previous packet. Drop previous one.");
+        recombination_stage_.reset();
       }
       auto l2cap_pdu_size = GetL2capPduSize(packet);
       remaining_sdu_continuation_packet_size_ = l2cap_pdu_size - (payload_size - kL2capBasicFrameHeaderSize);
       if (remaining_sdu_continuation_packet_size_ > 0) {
-        recombination_stage_ = payload;
+        recombination_stage_.emplace(payload);
         return;
       }
     }
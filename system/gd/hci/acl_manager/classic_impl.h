@@ -21,6 +21,7 @@
 #include <unordered_set>
 
 #include "common/bind.h"
+#include "common/flat_hash_map.h"
 #include "hci/acl_manager/assembler.h"
 #include "hci/acl_manager/event_checkers.h"
 #include "hci/acl_manager/round_robin_scheduler.h"
@@ -36,12 +37,9 @@ namespace acl_manager {
 struct acl_connection {
   acl_connection(AddressWithType address_with_type, AclConnection::QueueDownEnd* queue_down_end, os::Handler* handler)
       : address_with_type_(address_with_type),
-        assembler_(new acl_manager::assembler(address_with_type, queue_down_end, handler)) {}
-  ~acl_connection() {
-    delete assembler_;
-  }
+        assembler_(std::make_unique<acl_manager::assembler>(address_with_type, queue_down_end, handler)) {}
   AddressWithType address_with_type_;
-  struct acl_manager::assembler* assembler_;
+  std::unique_ptr<acl_manager::assembler> assembler_;
   ConnectionManagementCallbacks* connection_management_callbacks_ = nullptr;
 };
 
@@ -127,7 +125,8 @@ struct classic_impl : public security::ISecurityManagerListener {
   static constexpr uint16_t kIllegalConnectionHandle = 0xffff;
   struct {
    private:
-    std::map<uint16_t, acl_connection> acl_connections_;
+    // Looked up for every incoming ACL packet
+    common::FlatHashMap<uint16_t, acl_connection> acl_connections_;
     mutable std::mutex acl_connections_guard_;
     ConnectionManagementCallbacks* find_callbacks(uint16_t handle) {
       auto connection = acl_connections_.find(handle);
@@ -184,7 +183,7 @@ struct classic_impl : public security::ISecurityManagerListener {
     bool send_packet_upward(uint16_t handle, std::function<void(struct acl_manager::assembler* assembler)> cb) {
       std::unique_lock<std::mutex> lock(acl_connections_guard_);
       auto connection = acl_connections_.find(handle);
-      if (connection != acl_connections_.end()) cb(connection->second.assembler_);
+      if (connection != acl_connections_.end()) cb(connection->second.assembler_.get());
       return connection != acl_connections_.end();
     }
     void add(
@@ -194,10 +193,7 @@ struct classic_impl : public security::ISecurityManagerListener {
         os::Handler* handler,
         ConnectionManagementCallbacks* connection_management_callbacks) {
       std::unique_lock<std::mutex> lock(acl_connections_guard_);
-      auto emplace_pair = acl_connections_.emplace(
-          std::piecewise_construct,
-          std::forward_as_tuple(handle),
-          std::forward_as_tuple(remote_address, queue_end, handler));
+      auto emplace_pair = acl_connections_.try_emplace(handle, remote_address, queue_end, handler);
       ASSERT(emplace_pair.second);  // Make sure the connection is unique
       emplace_pair.first->second.connection_management_callbacks_ = connection_management_callbacks;
     }
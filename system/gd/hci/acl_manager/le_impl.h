@@ -26,6 +26,7 @@
 #include <unordered_set>
 
 #include "common/bind.h"
+#include "common/flat_hash_map.h"
 #include "common/init_flags.h"
 #include "crypto_toolbox/crypto_toolbox.h"
 #include "hci/acl_manager/assembler.h"
@@ -89,12 +90,9 @@ inline std::string connectability_state_machine_text(const ConnectabilityState&
 struct le_acl_connection {
   le_acl_connection(AddressWithType remote_address, AclConnection::QueueDownEnd* queue_down_end, os::Handler* handler)
       : remote_address_(remote_address),
-        assembler_(new acl_manager::assembler(remote_address, queue_down_end, handler)) {}
-  ~le_acl_connection() {
-    delete assembler_;
-  }
+        assembler_(std::make_unique<acl_manager::assembler>(remote_address, queue_down_end, handler)) {}
   AddressWithType remote_address_;
-  acl_manager::assembler* assembler_;
+  std::unique_ptr<acl_manager::assembler> assembler_;
   LeConnectionManagementCallbacks* le_connection_management_callbacks_ = nullptr;
 };
 
@@ -161,7 +159,8 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
   static constexpr uint16_t kIllegalConnectionHandle = 0xffff;
   struct {
    private:
-    std::map<uint16_t, le_acl_connection> le_acl_connections_;
+    // Looked up for every incoming ACL packet
+    common::FlatHashMap<uint16_t, le_acl_connection> le_acl_connections_;
     mutable std::mutex le_acl_connections_guard_;
     LeConnectionManagementCallbacks* find_callbacks(uint16_t handle) {
       auto connection = le_acl_connections_.find(handle);
@@ -205,7 +204,7 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
     bool send_packet_upward(uint16_t handle, std::function<void(struct acl_manager::assembler* assembler)> cb) {
       std::unique_lock<std::mutex> lock(le_acl_connections_guard_);
       auto connection = le_acl_connections_.find(handle);
-      if (connection != le_acl_connections_.end()) cb(connection->second.assembler_);
+      if (connection != le_acl_connections_.end()) cb(connection->second.assembler_.get());
       return connection != le_acl_connections_.end();
     }
     void add(
@@ -215,10 +214,7 @@ struct le_impl : public bluetooth::hci::LeAddressManagerCallback {
         os::Handler* handler,
         LeConnectionManagementCallbacks* le_connection_management_callbacks) {
       std::unique_lock<std::mutex> lock(le_acl_connections_guard_);
-      auto emplace_pair = le_acl_connections_.emplace(
-          std::piecewise_construct,
-          std::forward_as_tuple(handle),
-          std::forward_as_tuple(remote_address, queue_end, handler));
+      auto emplace_pair = le_acl_connections_.try_emplace(handle, remote_address, queue_end, handler);
       ASSERT(emplace_pair.second);  // Make sure the connection is unique
       emplace_pair.first->second.le_connection_management_callbacks_ = le_connection_management_callbacks;
     }
@@ -15,12 +15,18 @@
  */
 
 #include "hci/acl_manager/round_robin_scheduler.h"
+
+#include <algorithm>
+
 #include "hci/acl_manager/acl_fragmenter.h"
+#include "os/trace.h"
 
 namespace bluetooth {
 namespace hci {
 namespace acl_manager {
 
+using Clock = std::chrono::steady_clock;
+
 RoundRobinScheduler::RoundRobinScheduler(
     os::Handler* handler, Controller* controller, common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end)
     : handler_(handler), controller_(controller), hci_queue_end_(hci_queue_end) {
@@ -41,16 +47,18 @@ RoundRobinScheduler::~RoundRobinScheduler() {
 
 void RoundRobinScheduler::Register(ConnectionType connection_type, uint16_t handle,
                                    std::shared_ptr<acl_manager::AclConnection::Queue> queue) {
-  acl_queue_handler acl_queue_handler = {connection_type, std::move(queue), false, 0};
-  acl_queue_handlers_.insert(std::pair<uint16_t, RoundRobinScheduler::acl_queue_handler>(handle, acl_queue_handler));
-  if (fragments_to_send_.size() == 0) {
-    start_round_robin();
+  acl_queue_handler acl_queue_handler;
+  acl_queue_handler.connection_type_ = connection_type;
+  acl_queue_handler.queue_ = std::move(queue);
+  auto result = acl_queue_handlers_.emplace(handle, std::move(acl_queue_handler));
+  if (result.second) {
+    register_dequeue(result.first);
   }
 }
 
 void RoundRobinScheduler::Unregister(uint16_t handle) {
   ASSERT(acl_queue_handlers_.count(handle) == 1);
-  auto acl_queue_handler = acl_queue_handlers_.find(handle)->second;
+  auto& acl_queue_handler = acl_queue_handlers_.find(handle)->second;
   // Reclaim outstanding packets
   if (acl_queue_handler.connection_type_ == ConnectionType::CLASSIC) {
     acl_packet_credits_ += acl_queue_handler.number_of_sent_packets_;
@@ -64,7 +72,6 @@ void RoundRobinScheduler::Unregister(uint16_t handle) {
     acl_queue_handler.queue_->GetDownEnd()->UnregisterDequeue();
   }
   acl_queue_handlers_.erase(handle);
-  starting_point_ = acl_queue_handlers_.begin();
 }
 
 void RoundRobinScheduler::SetLinkPriority(uint16_t handle, bool high_priority) {
@@ -76,6 +83,42 @@ void RoundRobinScheduler::SetLinkPriority(uint16_t handle, bool high_priority) {
   acl_queue_handler->second.high_priority_ = high_priority;
 }
 
+void RoundRobinScheduler::SetLinkQos(uint16_t handle, uint8_t weight, std::chrono::milliseconds max_latency) {
+  auto acl_queue_handler = acl_queue_handlers_.find(handle);
+  if (acl_queue_handler == acl_queue_handlers_.end()) {
+    LOG_WARN("handle %d is invalid", handle);
+    return;
+  }
+  if (weight == 0) {
+    LOG_WARN("Invalid weight 0 for handle %d, using %d", handle, kDefaultWeight);
+    weight = kDefaultWeight;
+  }
+  acl_queue_handler->second.weight_ = weight;
+  acl_queue_handler->second.max_latency_ = std::max(max_latency, std::chrono::milliseconds(0));
+}
+
+std::optional<RoundRobinScheduler::LinkStats> RoundRobinScheduler::GetLinkStats(uint16_t handle) const {
+  auto acl_queue_handler = acl_queue_handlers_.find(handle);
+  if (acl_queue_handler == acl_queue_handlers_.end()) {
+    return std::nullopt;
+  }
+  const auto& link = acl_queue_handler->second;
+  LinkStats stats = link.stats_;
+  stats.weight = link.weight_;
+  stats.max_latency = link.max_latency_;
+  stats.queue_depth = (link.pending_packet_ != nullptr ? 1 : 0) + link.number_of_sent_packets_;
+  return stats;
+}
+
+std::vector<uint16_t> RoundRobinScheduler::GetLinkHandles() const {
+  std::vector<uint16_t> handles;
+  handles.reserve(acl_queue_handlers_.size());
+  for (const auto& [handle, link] : acl_queue_handlers_) {
+    handles.push_back(handle);
+  }
+  return handles;
+}
+
 uint16_t RoundRobinScheduler::GetCredits() {
   return acl_packet_credits_;
 }
@@ -85,6 +128,7 @@ uint16_t RoundRobinScheduler::GetLeCredits() {
 }
 
 void RoundRobinScheduler::start_round_robin() {
+  os::ScopedTrace trace("ACL round robin");
   if (acl_packet_credits_ == 0 && le_acl_packet_credits_ == 0) {
     return;
   }
@@ -99,50 +143,158 @@ void RoundRobinScheduler::start_round_robin() {
     send_next_fragment();
     return;
   }
-  if (acl_queue_handlers_.empty()) {
-    LOG_INFO("No any acl connection");
+  auto acl_queue_handler = select_next_link();
+  if (acl_queue_handler == acl_queue_handlers_.end()) {
     return;
   }
+  buffer_packet(acl_queue_handler);
+}
 
-  if (acl_queue_handlers_.size() == 1 || starting_point_ == acl_queue_handlers_.end()) {
-    starting_point_ = acl_queue_handlers_.begin();
+void RoundRobinScheduler::register_dequeue(LinkIterator acl_queue_handler) {
+  if (acl_queue_handler->second.dequeue_is_registered_) {
+    return;
   }
-  size_t count = acl_queue_handlers_.size();
+  acl_queue_handler->second.dequeue_is_registered_ = true;
+  acl_queue_handler->second.queue_->GetDownEnd()->RegisterDequeue(
+      handler_, common::Bind(&RoundRobinScheduler::stage_packet, common::Unretained(this), acl_queue_handler->first));
+}
 
-  for (auto acl_queue_handler = starting_point_; count > 0; count--) {
-    // Prevent registration when credits is zero
-    bool classic_buffer_full =
-        acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::CLASSIC;
-    bool le_buffer_full =
-        le_acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::LE;
-    if (!acl_queue_handler->second.dequeue_is_registered_ && !classic_buffer_full && !le_buffer_full) {
-      acl_queue_handler->second.dequeue_is_registered_ = true;
-      acl_queue_handler->second.queue_->GetDownEnd()->RegisterDequeue(
-          handler_, common::Bind(&RoundRobinScheduler::buffer_packet, common::Unretained(this), acl_queue_handler));
+// Take the next packet of the link out of its queue; the rest stay there until this one is sent
+void RoundRobinScheduler::stage_packet(uint16_t handle) {
+  auto acl_queue_handler = acl_queue_handlers_.find(handle);
+  ASSERT(acl_queue_handler != acl_queue_handlers_.end());
+  auto& link = acl_queue_handler->second;
+  link.pending_packet_ = link.queue_->GetDownEnd()->TryDequeue();
+  ASSERT(link.pending_packet_ != nullptr);
+  link.pending_since_ = Clock::now();
+  link.dequeue_is_registered_ = false;
+  link.queue_->GetDownEnd()->UnregisterDequeue();
+  if (fragments_to_send_.empty()) {
+    start_round_robin();
+  }
+}
+
+bool RoundRobinScheduler::has_credits(const acl_queue_handler& acl_queue_handler) const {
+  if (acl_queue_handler.connection_type_ == ConnectionType::CLASSIC) {
+    return acl_packet_credits_ > 0;
+  }
+  return le_acl_packet_credits_ > 0;
+}
+
+uint16_t RoundRobinScheduler::fragment_count(const acl_queue_handler& acl_queue_handler) const {
+  size_t mtu = acl_queue_handler.connection_type_ == ConnectionType::CLASSIC ? hci_mtu_ : le_hci_mtu_;
+  size_t size = acl_queue_handler.pending_packet_->size();
+  if (mtu == 0 || size <= mtu) {
+    return 1;
+  }
+  return (size + mtu - 1) / mtu;
+}
+
+RoundRobinScheduler::LinkIterator RoundRobinScheduler::select_next_link() {
+  auto now = Clock::now();
+  auto selected = acl_queue_handlers_.end();
+  int selected_rank = 0;
+  // High priority links go first, then links whose packet is over its latency budget, oldest packet first
+  for (auto it = acl_queue_handlers_.begin(); it != acl_queue_handlers_.end(); it++) {
+    const auto& link = it->second;
+    if (link.pending_packet_ == nullptr || !has_credits(link)) {
+      continue;
     }
-    acl_queue_handler = std::next(acl_queue_handler);
-    if (acl_queue_handler == acl_queue_handlers_.end()) {
-      acl_queue_handler = acl_queue_handlers_.begin();
+    int rank = 0;
+    if (link.high_priority_) {
+      rank = 2;
+    } else if (link.max_latency_.count() > 0 && now - link.pending_since_ >= link.max_latency_) {
+      rank = 1;
     }
+    bool older = rank == selected_rank && rank > 0 && link.pending_since_ < selected->second.pending_since_;
+    if (rank > selected_rank || older) {
+      selected = it;
+      selected_rank = rank;
+    }
+  }
+  if (selected == acl_queue_handlers_.end()) {
+    return select_by_deficit();
   }
+  // Packets sent ahead of their turn still count against the share of their link
+  if (!selected->second.high_priority_) {
+    selected->second.deficit_ -= fragment_count(selected->second);
+  }
+  return selected;
+}
 
-  starting_point_ = std::next(starting_point_);
+// Deficit round-robin in units of ACL fragments. Every round, each link with a packet waiting earns its weight, and
+// keeps its turn as long as its deficit is positive. A packet is sent as soon as the deficit is positive and charged
+// in full, so that large packets don't need to wait for several rounds while the controller buffers are idle.
+RoundRobinScheduler::LinkIterator RoundRobinScheduler::select_by_deficit() {
+  auto eligible = [this](const acl_queue_handler& link) {
+    return link.pending_packet_ != nullptr && has_credits(link);
+  };
+  auto find_positive = [this, &eligible]() {
+    auto start = acl_queue_handlers_.lower_bound(current_handle_);
+    for (size_t count = acl_queue_handlers_.size(); count > 0; count--) {
+      if (start == acl_queue_handlers_.end()) {
+        start = acl_queue_handlers_.begin();
+      }
+      if (eligible(start->second) && start->second.deficit_ > 0) {
+        return start;
+      }
+      start++;
+    }
+    return acl_queue_handlers_.end();
+  };
+
+  auto selected = find_positive();
+  if (selected == acl_queue_handlers_.end()) {
+    // Play the rounds in which no link can send at once
+    int32_t rounds = 0;
+    for (const auto& [handle, link] : acl_queue_handlers_) {
+      if (eligible(link)) {
+        int32_t link_rounds = (1 - link.deficit_ + link.weight_ - 1) / link.weight_;
+        rounds = rounds == 0 ? link_rounds : std::min(rounds, link_rounds);
+      }
+    }
+    if (rounds == 0) {
+      return acl_queue_handlers_.end();
+    }
+    for (auto& [handle, link] : acl_queue_handlers_) {
+      if (eligible(link)) {
+        link.deficit_ += rounds * link.weight_;
+      }
+    }
+    selected = find_positive();
+    ASSERT(selected != acl_queue_handlers_.end());
+  }
+
+  selected->second.deficit_ -= fragment_count(selected->second);
+  if (selected->second.deficit_ > 0) {
+    current_handle_ = selected->first;
+  } else {
+    auto next = std::next(selected);
+    current_handle_ = next == acl_queue_handlers_.end() ? acl_queue_handlers_.begin()->first : next->first;
+  }
+  return selected;
 }
 
-void RoundRobinScheduler::buffer_packet(std::map<uint16_t, acl_queue_handler>::iterator acl_queue_handler) {
+void RoundRobinScheduler::buffer_packet(LinkIterator acl_queue_handler) {
   BroadcastFlag broadcast_flag = BroadcastFlag::POINT_TO_POINT;
   // Wrap packet and enqueue it
   uint16_t handle = acl_queue_handler->first;
-  auto packet = acl_queue_handler->second.queue_->GetDownEnd()->TryDequeue();
+  auto& link = acl_queue_handler->second;
+  auto packet = std::move(link.pending_packet_);
   ASSERT(packet != nullptr);
 
-  ConnectionType connection_type = acl_queue_handler->second.connection_type_;
+  auto wait = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - link.pending_since_);
+  link.stats_.sent_packets++;
+  link.stats_.total_wait += wait;
+  link.stats_.max_wait = std::max(link.stats_.max_wait, wait);
+
+  ConnectionType connection_type = link.connection_type_;
   size_t mtu = connection_type == ConnectionType::CLASSIC ? hci_mtu_ : le_hci_mtu_;
   PacketBoundaryFlag packet_boundary_flag = (packet->IsFlushable())
                                                 ? PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE
                                                 : PacketBoundaryFlag::FIRST_NON_AUTOMATICALLY_FLUSHABLE;
 
-  int acl_priority = acl_queue_handler->second.high_priority_ ? 1 : 0;
+  int acl_priority = link.high_priority_ ? 1 : 0;
   if (packet->size() <= mtu) {
     fragments_to_send_.push(
         std::make_pair(
@@ -160,9 +312,9 @@ void RoundRobinScheduler::buffer_packet(std::map<uint16_t, acl_queue_handler>::i
     }
   }
   ASSERT(fragments_to_send_.size() > 0);
-  unregister_all_connections();
 
-  acl_queue_handler->second.number_of_sent_packets_ += fragments_to_send_.size();
+  link.number_of_sent_packets_ += fragments_to_send_.size();
+  register_dequeue(acl_queue_handler);
   send_next_fragment();
 }
 
@@ -193,6 +345,7 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
     ASSERT(le_acl_packet_credits_ > 0);
     le_acl_packet_credits_ -= 1;
   }
+  trace_credits();
 
   auto raw_pointer = fragments_to_send_.front().second.release();
   fragments_to_send_.pop();
@@ -245,11 +398,19 @@ void RoundRobinScheduler::incoming_acl_credits(uint16_t handle, uint16_t credits
       LOG_WARN("le acl packet credits overflow due to receive %hx credits", credits);
     }
   }
+  trace_credits();
   if (credit_was_zero) {
     start_round_robin();
   }
 }
 
+void RoundRobinScheduler::trace_credits() const {
+  if (os::IsTracing()) {
+    os::TraceCounter("ACL credits", acl_packet_credits_);
+    os::TraceCounter("LE ACL credits", le_acl_packet_credits_);
+  }
+}
+
 }  // namespace acl_manager
 }  // namespace hci
 }  // namespace bluetooth
@@ -18,8 +18,13 @@
 
 #include <stdint.h>
 
+#include <chrono>
+#include <optional>
+#include <vector>
+
 #include "common/bidi_queue.h"
 #include "common/multi_priority_queue.h"
+#include "common/sorted_vector_map.h"
 #include "hci/acl_manager.h"
 #include "hci/controller.h"
 #include "hci/hci_packets.h"
@@ -29,6 +34,9 @@ namespace bluetooth {
 namespace hci {
 namespace acl_manager {
 
+// Schedules the ACL packets of all the connections on the controller buffers. High priority links are served first,
+// then links whose packet waited longer than their latency budget, then every other link in deficit round-robin,
+// weighted by link.
 class RoundRobinScheduler {
  public:
   RoundRobinScheduler(
@@ -37,32 +45,68 @@ class RoundRobinScheduler {
 
   enum ConnectionType { CLASSIC, LE };
 
+  static constexpr uint8_t kDefaultWeight = 1;
+
+  struct LinkStats {
+    uint8_t weight = kDefaultWeight;
+    std::chrono::milliseconds max_latency{0};
+    // Packet waiting for its turn in the scheduler, plus fragments not completed by the controller yet
+    size_t queue_depth = 0;
+    uint64_t sent_packets = 0;
+    // Time packets waited in the scheduler before being fragmented and sent
+    std::chrono::microseconds total_wait{0};
+    std::chrono::microseconds max_wait{0};
+  };
+
   struct acl_queue_handler {
     ConnectionType connection_type_;
     std::shared_ptr<acl_manager::AclConnection::Queue> queue_;
     bool dequeue_is_registered_ = false;
     uint16_t number_of_sent_packets_ = 0;  // Track credits
     bool high_priority_ = false;           // For A2dp use
+    uint8_t weight_ = kDefaultWeight;      // Fragments the link may send per round
+    std::chrono::milliseconds max_latency_{0};  // Latency budget of the packets of the link, 0 for none
+    // Packet dequeued from queue_, waiting for its turn
+    std::unique_ptr<packet::BasePacketBuilder> pending_packet_;
+    std::chrono::steady_clock::time_point pending_since_;
+    int32_t deficit_ = 0;  // In fragments; negative after sending a packet larger than the remaining deficit
+    LinkStats stats_;
   };
 
   void Register(ConnectionType connection_type, uint16_t handle,
                 std::shared_ptr<acl_manager::AclConnection::Queue> queue);
   void Unregister(uint16_t handle);
   void SetLinkPriority(uint16_t handle, bool high_priority);
+  // Give the link |weight| times the share of a default link, and serve its packets ahead of the round-robin once
+  // they waited |max_latency|. A zero |max_latency| removes the latency budget.
+  void SetLinkQos(uint16_t handle, uint8_t weight, std::chrono::milliseconds max_latency);
+  std::optional<LinkStats> GetLinkStats(uint16_t handle) const;
+  std::vector<uint16_t> GetLinkHandles() const;
   uint16_t GetCredits();
   uint16_t GetLeCredits();
 
  private:
+  using LinkIterator = common::SortedVectorMap<uint16_t, acl_queue_handler>::iterator;
+
   void start_round_robin();
-  void buffer_packet(std::map<uint16_t, acl_queue_handler>::iterator acl_queue_handler);
+  void register_dequeue(LinkIterator acl_queue_handler);
+  void stage_packet(uint16_t handle);
+  LinkIterator select_next_link();
+  LinkIterator select_by_deficit();
+  bool has_credits(const acl_queue_handler& acl_queue_handler) const;
+  uint16_t fragment_count(const acl_queue_handler& acl_queue_handler) const;
+  void buffer_packet(LinkIterator acl_queue_handler);
   void unregister_all_connections();
   void send_next_fragment();
   std::unique_ptr<AclBuilder> handle_enqueue_next_fragment();
   void incoming_acl_credits(uint16_t handle, uint16_t credits);
+  void trace_credits() const;
 
   os::Handler* handler_ = nullptr;
   Controller* controller_ = nullptr;
-  std::map<uint16_t, acl_queue_handler> acl_queue_handlers_;
+  // Looked up for every packet and credit, and walked in handle order by the round-robin. Registering and
+  // unregistering a link invalidates the iterators, so the dequeue callbacks look the link up by handle.
+  common::SortedVectorMap<uint16_t, acl_queue_handler> acl_queue_handlers_;
   common::MultiPriorityQueue<std::pair<ConnectionType, std::unique_ptr<AclBuilder>>, 2> fragments_to_send_;
   uint16_t max_acl_packet_credits_ = 0;
   uint16_t acl_packet_credits_ = 0;
@@ -72,10 +116,10 @@ class RoundRobinScheduler {
   size_t le_hci_mtu_{0};
   std::atomic_bool enqueue_registered_ = false;
   common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end_ = nullptr;
-  // first register queue end for the Round-robin schedule
-  std::map<uint16_t, acl_queue_handler>::iterator starting_point_;
+  // Handle of the link whose turn it is in the deficit round-robin
+  uint16_t current_handle_ = 0;
 };
 
 }  // namespace acl_manager
 }  // namespace hci
-}  // namespace bluetooth
\ No newline at end of file
+}  // namespace bluetooth
@@ -153,6 +153,33 @@ class RoundRobinSchedulerTest : public ::testing::Test {
     sent_acl_packets_.pop();
   }
 
+  RoundRobinScheduler::LinkStats GetLinkStats(uint16_t handle) {
+    std::promise<std::optional<RoundRobinScheduler::LinkStats>> promise;
+    auto future = promise.get_future();
+    handler_->Post(common::BindOnce(
+        [](RoundRobinScheduler* scheduler,
+           uint16_t handle,
+           std::promise<std::optional<RoundRobinScheduler::LinkStats>> promise) {
+          promise.set_value(scheduler->GetLinkStats(handle));
+        },
+        common::Unretained(round_robin_scheduler_),
+        handle,
+        std::move(promise)));
+    auto stats = future.get();
+    EXPECT_TRUE(stats.has_value());
+    return stats.value_or(RoundRobinScheduler::LinkStats{});
+  }
+
+  // The scheduler takes the next packet of a link out of its queue from the reactable of the queue, so wait on the
+  // handler until it holds one. None of the packets sent on the link are completed in the tests, so the queue depth is
+  // the sent packets, plus one for the packet held by the scheduler.
+  void WaitForPendingPacket(uint16_t handle) {
+    auto stats = GetLinkStats(handle);
+    while (stats.queue_depth == stats.sent_packets) {
+      stats = GetLinkStats(handle);
+    }
+  }
+
   void SetPacketFuture(uint16_t count) {
     ASSERT_EQ(packet_promise_, nullptr) << "Promises, Promises, ... Only one at a time.";
     packet_count_ = count;
@@ -413,6 +440,72 @@ TEST_F(RoundRobinSchedulerTest, receive_le_credit_when_next_fragment_is_classic)
   round_robin_scheduler_->Unregister(le_handle);
 }
 
+TEST_F(RoundRobinSchedulerTest, share_credits_by_link_weight) {
+  uint16_t handle1 = 0x01;
+  uint16_t handle2 = 0x02;
+  uint16_t bulk_handle = 0x03;
+  auto connection_queue1 = std::make_shared<AclConnection::Queue>(10);
+  auto connection_queue2 = std::make_shared<AclConnection::Queue>(10);
+  auto bulk_connection_queue = std::make_shared<AclConnection::Queue>(10);
+  round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::CLASSIC, handle1, connection_queue1);
+  round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::CLASSIC, handle2, connection_queue2);
+  round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::CLASSIC, bulk_handle, bulk_connection_queue);
+  round_robin_scheduler_->SetLinkQos(handle1, 2, std::chrono::milliseconds(0));
+
+  // Use up all the credits
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(controller_->max_acl_packet_credits_));
+  for (uint16_t i = 0; i < controller_->max_acl_packet_credits_; i++) {
+    EnqueueAclUpEnd(bulk_connection_queue->GetUpEnd(), {0x03, 0x02, 0x01});
+  }
+  packet_future_->wait();
+  for (uint16_t i = 0; i < controller_->max_acl_packet_credits_; i++) {
+    VerifyPacket(bulk_handle, {0x03, 0x02, 0x01});
+  }
+  ASSERT_EQ(round_robin_scheduler_->GetCredits(), 0);
+
+  for (uint8_t i = 0; i < 4; i++) {
+    EnqueueAclUpEnd(connection_queue1->GetUpEnd(), {0x01, i});
+    EnqueueAclUpEnd(connection_queue2->GetUpEnd(), {0x02, i});
+  }
+  enqueue_future_->wait();
+
+  // Return the credits one at a time, each one once the links with packets left have one waiting in the scheduler
+  for (uint8_t i = 0; i < 6; i++) {
+    if (GetLinkStats(handle1).sent_packets < 4) {
+      WaitForPendingPacket(handle1);
+    }
+    if (GetLinkStats(handle2).sent_packets < 4) {
+      WaitForPendingPacket(handle2);
+    }
+    ASSERT_NO_FATAL_FAILURE(SetPacketFuture(1));
+    controller_->SendCompletedAclPacketsCallback(bulk_handle, 1);
+    packet_future_->wait();
+  }
+  VerifyPacket(handle1, {0x01, 0x00});
+  VerifyPacket(handle1, {0x01, 0x01});
+  VerifyPacket(handle2, {0x02, 0x00});
+  VerifyPacket(handle1, {0x01, 0x02});
+  VerifyPacket(handle1, {0x01, 0x03});
+  VerifyPacket(handle2, {0x02, 0x01});
+
+  auto stats1 = GetLinkStats(handle1);
+  ASSERT_EQ(stats1.weight, 2);
+  ASSERT_EQ(stats1.sent_packets, 4u);
+  ASSERT_EQ(stats1.queue_depth, 4u);
+  // One packet waiting in the scheduler, and two sent packets not completed yet
+  WaitForPendingPacket(handle2);
+  auto stats2 = GetLinkStats(handle2);
+  ASSERT_EQ(stats2.weight, RoundRobinScheduler::kDefaultWeight);
+  ASSERT_EQ(stats2.sent_packets, 2u);
+  ASSERT_EQ(stats2.queue_depth, 3u);
+  ASSERT_FALSE(round_robin_scheduler_->GetLinkStats(0x04).has_value());
+  ASSERT_EQ(round_robin_scheduler_->GetLinkHandles(), std::vector<uint16_t>({handle1, handle2, bulk_handle}));
+
+  round_robin_scheduler_->Unregister(handle1);
+  round_robin_scheduler_->Unregister(handle2);
+  round_robin_scheduler_->Unregister(bulk_handle);
+}
+
 }  // namespace
 }  // namespace acl_manager
 }  // namespace hci
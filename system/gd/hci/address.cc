@@ -83,39 +83,29 @@ std::optional<Address> Address::FromLegacyConfigString(const std::string& str) {
 }
 
 std::optional<Address> Address::FromString(const std::string& from) {
+  // "xx:xx:xx:xx:xx:xx" with the most significant byte first, parsed in place as it is checked for each config section
   if (from.length() != 17) {
     return std::nullopt;
   }
 
+  auto hex_digit = [](char c) -> int {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  };
   Address addr{};
-  std::istringstream stream(from);
-  std::string token;
-  int index = 0;
-  while (getline(stream, token, ':')) {
-    if (index >= 6) {
+  for (size_t index = 0; index < kLength; index++) {
+    size_t position = index * 3;
+    if (index > 0 && from[position - 1] != ':') {
       return std::nullopt;
     }
-
-    if (token.length() != 2) {
-      return std::nullopt;
-    }
-
-    char* temp = nullptr;
-    addr.address.at(5 - index) = std::strtol(token.c_str(), &temp, 16);
-    if (temp == token.c_str()) {
-      // string token is empty or has wrong format
-      return std::nullopt;
-    }
-    if (temp != (token.c_str() + token.size())) {
-      // cannot parse whole string
+    int high = hex_digit(from[position]);
+    int low = hex_digit(from[position + 1]);
+    if (high < 0 || low < 0) {
       return std::nullopt;
     }
-
-    index++;
-  }
-
-  if (index != 6) {
-    return std::nullopt;
+    addr.address[5 - index] = static_cast<uint8_t>((high << 4) | low);
   }
 
   return addr;
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/lru_cache.h"
+#include "hci/address_with_type.h"
+
+namespace bluetooth {
+namespace hci {
+
+// Advertising data of the devices whose reports are split over several events, such as chained extended advertising
+// reports or legacy advertising followed by a scan response. Look-ups are O(1), and the least recently used device
+// is evicted when the cache is full. The buffers of cleared and evicted devices are reused for new ones.
+// NOT THREAD SAFE
+class AdvertisingCache {
+ public:
+  static constexpr size_t kCacheMax = 1000;
+  // Buffers kept around for reuse, enough for the devices whose reports are in flight at a given time
+  static constexpr size_t kMaxSpareBuffers = 16;
+
+  AdvertisingCache() : items_(kCacheMax) {}
+
+  // Replace the data of |address_with_type| with |data|
+  const std::vector<uint8_t>& Set(const AddressWithType& address_with_type, const std::vector<uint8_t>& data) {
+    auto& buffer = get_or_insert(address_with_type);
+    buffer.assign(data.begin(), data.end());
+    return buffer;
+  }
+
+  bool Exist(const AddressWithType& address_with_type) const {
+    return items_.contains(address_with_type);
+  }
+
+  // Append |data| to the data of |address_with_type|
+  const std::vector<uint8_t>& Append(const AddressWithType& address_with_type, const std::vector<uint8_t>& data) {
+    auto& buffer = get_or_insert(address_with_type);
+    buffer.insert(buffer.end(), data.begin(), data.end());
+    return buffer;
+  }
+
+  /* Clear data for device |addr_type, addr| */
+  void Clear(const AddressWithType& address_with_type) {
+    auto node = items_.extract(address_with_type);
+    if (node) {
+      recycle(std::move(node->second));
+    }
+  }
+
+  void ClearAll() {
+    items_.clear();
+    spare_buffers_.clear();
+  }
+
+  size_t Size() const {
+    return items_.size();
+  }
+
+ private:
+  std::vector<uint8_t>& get_or_insert(const AddressWithType& address_with_type) {
+    auto it = items_.find(address_with_type);
+    if (it != items_.end()) {
+      return it->second;
+    }
+    std::vector<uint8_t> buffer;
+    if (!spare_buffers_.empty()) {
+      buffer = std::move(spare_buffers_.back());
+      spare_buffers_.pop_back();
+    }
+    auto [inserted, success, evicted] = items_.try_emplace(address_with_type, std::move(buffer));
+    if (evicted) {
+      recycle(std::move(evicted->second));
+    }
+    return inserted->second;
+  }
+
+  void recycle(std::vector<uint8_t> buffer) {
+    if (spare_buffers_.size() < kMaxSpareBuffers) {
+      buffer.clear();
+      spare_buffers_.push_back(std::move(buffer));
+    }
+  }
+
+  common::LruCache<AddressWithType, std::vector<uint8_t>> items_;
+  std::vector<std::vector<uint8_t>> spare_buffers_;
+};
+
+}  // namespace hci
+}  // namespace bluetooth
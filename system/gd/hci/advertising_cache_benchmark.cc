@@ -0,0 +1,180 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <list>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/advertising_cache.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::Address;
+using ::bluetooth::hci::AddressType;
+using ::bluetooth::hci::AddressWithType;
+using ::bluetooth::hci::AdvertisingCache;
+
+namespace {
+
+constexpr uint32_t kDevices = 10000;
+constexpr size_t kReports = 200000;
+
+// The cache before it was indexed, kept for comparison
+class ListAdvertisingCache {
+ public:
+  const std::vector<uint8_t>& Set(const AddressWithType& address_with_type, std::vector<uint8_t> data) {
+    auto it = Find(address_with_type);
+    if (it != items.end()) {
+      it->data = std::move(data);
+      return it->data;
+    }
+    if (items.size() > AdvertisingCache::kCacheMax) {
+      items.pop_back();
+    }
+    items.emplace_front(address_with_type, std::move(data));
+    return items.front().data;
+  }
+
+  bool Exist(const AddressWithType& address_with_type) {
+    return Find(address_with_type) != items.end();
+  }
+
+  const std::vector<uint8_t>& Append(const AddressWithType& address_with_type, std::vector<uint8_t> data) {
+    auto it = Find(address_with_type);
+    if (it != items.end()) {
+      it->data.insert(it->data.end(), data.begin(), data.end());
+      return it->data;
+    }
+    if (items.size() > AdvertisingCache::kCacheMax) {
+      items.pop_back();
+    }
+    items.emplace_front(address_with_type, std::move(data));
+    return items.front().data;
+  }
+
+  void Clear(const AddressWithType& address_with_type) {
+    auto it = Find(address_with_type);
+    if (it != items.end()) {
+      items.erase(it);
+    }
+  }
+
+ private:
+  struct Item {
+    AddressWithType address_with_type;
+    std::vector<uint8_t> data;
+
+    Item(const AddressWithType& address_with_type, std::vector<uint8_t> data)
+        : address_with_type(address_with_type), data(data) {}
+  };
+
+  std::list<Item>::iterator Find(const AddressWithType& address_with_type) {
+    for (auto it = items.begin(); it != items.end(); it++) {
+      if (it->address_with_type == address_with_type) {
+        return it;
+      }
+    }
+    return items.end();
+  }
+
+  std::list<Item> items;
+};
+
+// One advertising report, reduced to what LeScanningManager does with the cache
+struct Report {
+  AddressWithType address_with_type;
+  bool is_start;          // legacy scannable advertising, which starts over the data of the device
+  bool is_scan_response;  // legacy scan response, dropped if the advertising wasn't seen
+  bool is_complete;       // last report of the advertising data, which is then delivered and cleared
+  std::vector<uint8_t> data;
+};
+
+// Reports of beacons around a scanner in a dense environment: mostly non-connectable legacy beacons, scannable
+// devices whose scan response is missed a third of the time, and extended advertising chained over three reports.
+// The reports of different devices interleave, and the missed scan responses keep the cache full.
+const std::vector<Report>& beacon_capture() {
+  static const std::vector<Report> capture = [] {
+    std::mt19937 random(42);
+    std::vector<AddressWithType> devices;
+    for (uint32_t i = 0; i < kDevices; i++) {
+      devices.emplace_back(
+          Address({static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(random()),
+                   static_cast<uint8_t>(random()), static_cast<uint8_t>(random()), 0xc0}),
+          AddressType::RANDOM_DEVICE_ADDRESS);
+    }
+    std::vector<Report> reports;
+    std::vector<std::pair<size_t, int>> chained;  // device and remaining reports of chained advertising in flight
+    while (reports.size() < kReports) {
+      auto device = devices[random() % kDevices];
+      auto kind = random() % 10;
+      std::vector<uint8_t> data(31, static_cast<uint8_t>(kind));
+      if (!chained.empty() && kind < 3) {
+        auto& [index, remaining] = chained.front();
+        remaining--;
+        reports.push_back({devices[index], false, false, remaining == 0, std::vector<uint8_t>(229, 0xee)});
+        if (remaining == 0) {
+          chained.erase(chained.begin());
+        }
+      } else if (kind < 6) {
+        reports.push_back({device, false, false, true, data});
+      } else if (kind < 9) {
+        reports.push_back({device, true, false, false, data});
+        if (random() % 3 != 0) {
+          reports.push_back({device, false, true, true, data});
+        }
+      } else {
+        chained.emplace_back(random() % kDevices, 2);
+        reports.push_back({devices[chained.back().first], false, false, false, std::vector<uint8_t>(229, 0xee)});
+      }
+    }
+    return reports;
+  }();
+  return capture;
+}
+
+template <typename Cache>
+void replay(State& state) {
+  const auto& capture = beacon_capture();
+  for (auto _ : state) {
+    Cache cache;
+    size_t delivered = 0;
+    for (const auto& report : capture) {
+      if (report.is_scan_response && !cache.Exist(report.address_with_type)) {
+        continue;
+      }
+      const auto& data = report.is_start ? cache.Set(report.address_with_type, report.data)
+                                         : cache.Append(report.address_with_type, report.data);
+      if (report.is_complete) {
+        delivered += data.size();
+        cache.Clear(report.address_with_type);
+      }
+    }
+    benchmark::DoNotOptimize(delivered);
+  }
+  state.SetItemsProcessed(state.iterations() * capture.size());
+}
+
+void BM_AdvertisingCache_list(State& state) {
+  replay<ListAdvertisingCache>(state);
+}
+BENCHMARK(BM_AdvertisingCache_list);
+
+void BM_AdvertisingCache_indexed(State& state) {
+  replay<AdvertisingCache>(state);
+}
+BENCHMARK(BM_AdvertisingCache_indexed);
+
+}  // namespace
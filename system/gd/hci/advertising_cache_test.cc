@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/advertising_cache.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+AddressWithType device(uint32_t index) {
+  return AddressWithType(
+      Address({static_cast<uint8_t>(index), static_cast<uint8_t>(index >> 8), static_cast<uint8_t>(index >> 16), 0, 0,
+               0xc0}),
+      AddressType::RANDOM_DEVICE_ADDRESS);
+}
+
+TEST(AdvertisingCacheTest, set_append_and_clear) {
+  AdvertisingCache cache;
+  ASSERT_FALSE(cache.Exist(device(1)));
+  ASSERT_EQ(std::vector<uint8_t>({1, 2}), cache.Set(device(1), {1, 2}));
+  ASSERT_EQ(std::vector<uint8_t>({1, 2, 3}), cache.Append(device(1), {3}));
+  ASSERT_EQ(std::vector<uint8_t>({4}), cache.Append(device(2), {4}));
+  ASSERT_TRUE(cache.Exist(device(1)));
+  ASSERT_EQ(2u, cache.Size());
+
+  // Set replaces the data
+  ASSERT_EQ(std::vector<uint8_t>({5}), cache.Set(device(1), {5}));
+
+  cache.Clear(device(1));
+  ASSERT_FALSE(cache.Exist(device(1)));
+  ASSERT_TRUE(cache.Exist(device(2)));
+  // A device cleared and seen again starts over, even though its buffer may be reused
+  ASSERT_EQ(std::vector<uint8_t>({6}), cache.Append(device(3), {6}));
+  ASSERT_EQ(std::vector<uint8_t>({7}), cache.Append(device(1), {7}));
+
+  cache.ClearAll();
+  ASSERT_EQ(0u, cache.Size());
+  ASSERT_FALSE(cache.Exist(device(2)));
+}
+
+TEST(AdvertisingCacheTest, evict_least_recently_used) {
+  AdvertisingCache cache;
+  for (uint32_t i = 0; i < AdvertisingCache::kCacheMax; i++) {
+    cache.Set(device(i), {static_cast<uint8_t>(i)});
+  }
+  ASSERT_EQ(AdvertisingCache::kCacheMax, cache.Size());
+  // Appending to the oldest device makes it the most recent one
+  cache.Append(device(0), {0});
+
+  cache.Set(device(AdvertisingCache::kCacheMax), {0});
+  ASSERT_EQ(AdvertisingCache::kCacheMax, cache.Size());
+  ASSERT_TRUE(cache.Exist(device(0)));
+  ASSERT_FALSE(cache.Exist(device(1)));
+  ASSERT_TRUE(cache.Exist(device(AdvertisingCache::kCacheMax)));
+  // The buffer of the evicted device doesn't leak into the new one
+  ASSERT_EQ(std::vector<uint8_t>({1, 2}), cache.Append(device(AdvertisingCache::kCacheMax + 1), {1, 2}));
+}
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
@@ -17,14 +17,18 @@
 #include "hci/controller.h"
 
 #include <future>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include "common/init_flags.h"
+#include "common/strings.h"
 #include "hci/hci_layer.h"
 #include "hci_controller_generated.h"
+#include "os/files.h"
 #include "os/metrics.h"
+#include "os/parameter_provider.h"
 #include "os/system_properties.h"
 
 namespace bluetooth {
@@ -39,6 +43,11 @@ using os::Handler;
 static constexpr uint64_t kCsrLeEventMask = 0x000000000000001f;
 const std::string kBtCsrProperty = "persist.bluetooth.hci.csr";
 
+constexpr bool kDefaultCapabilitySnapshotEnabled = false;
+static const std::string kPropertyCapabilitySnapshotEnabled = "bluetooth.core.controller.capability_snapshot.enabled";
+// Change when the format of the snapshot, or the interpretation of its command completes, changes
+constexpr char kCapabilitySnapshotHeader[] = "controller_capabilities_v1";
+
 struct Controller::impl {
   impl(Controller& module) : module_(module) {}
 
@@ -55,58 +64,90 @@ struct Controller::impl {
     }
     set_event_mask(kDefaultEventMask);
     write_le_host_support(Enable::ENABLED, Enable::DISABLED);
-    hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_name_complete_handler));
-    hci_->EnqueueCommand(ReadLocalVersionInformationBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_version_information_complete_handler));
-    hci_->EnqueueCommand(ReadLocalSupportedCommandsBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_supported_commands_complete_handler));
 
-    hci_->EnqueueCommand(
+    if (os::GetSystemPropertyBool(kPropertyCapabilitySnapshotEnabled, kDefaultCapabilitySnapshotEnabled)) {
+      capability_snapshot_enabled_ = true;
+      load_capability_snapshot();
+    }
+
+    // The version and the address identify the controller, they are always read to validate the capability snapshot
+    std::promise<void> probe_promise;
+    auto probe_future = probe_promise.get_future();
+    send_capability_read(
+        ReadLocalVersionInformationBuilder::Create(),
+        common::BindOnce(&Controller::impl::read_local_version_information_complete_handler, common::Unretained(this)));
+    send_capability_read(
+        ReadBdAddrBuilder::Create(),
+        common::BindOnce(
+            &Controller::impl::read_controller_mac_address_handler,
+            common::Unretained(this),
+            std::move(probe_promise)));
+    probe_future.wait();
+    if (!cached_capabilities_.empty()) {
+      for (const auto& [command, complete] : recorded_capabilities_) {
+        auto cached = cached_capabilities_.find(command);
+        if (cached == cached_capabilities_.end() || cached->second != complete) {
+          LOG_INFO("Controller version or address changed, reading all the capabilities");
+          cached_capabilities_.clear();
+          break;
+        }
+      }
+    }
+
+    read_capability(
+        ReadLocalSupportedCommandsBuilder::Create(),
+        common::BindOnce(&Controller::impl::read_local_supported_commands_complete_handler, common::Unretained(this)));
+
+    read_capability(
         LeReadLocalSupportedFeaturesBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_local_supported_features_handler));
+        common::BindOnce(&Controller::impl::le_read_local_supported_features_handler, common::Unretained(this)));
 
-    hci_->EnqueueCommand(
+    read_capability(
         LeReadSupportedStatesBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_supported_states_handler));
+        common::BindOnce(&Controller::impl::le_read_supported_states_handler, common::Unretained(this)));
 
     // Wait for all extended features read
     std::promise<void> features_promise;
     auto features_future = features_promise.get_future();
-    hci_->EnqueueCommand(ReadLocalExtendedFeaturesBuilder::Create(0x00),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_extended_features_complete_handler,
-                                             std::move(features_promise)));
+    read_capability(
+        ReadLocalExtendedFeaturesBuilder::Create(0x00),
+        common::BindOnce(
+            &Controller::impl::read_local_extended_features_complete_handler,
+            common::Unretained(this),
+            std::move(features_promise)));
     features_future.wait();
 
-    hci_->EnqueueCommand(ReadBufferSizeBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_buffer_size_complete_handler));
+    read_capability(
+        ReadBufferSizeBuilder::Create(),
+        common::BindOnce(&Controller::impl::read_buffer_size_complete_handler, common::Unretained(this)));
 
     if (is_supported(OpCode::LE_READ_BUFFER_SIZE_V2)) {
-      hci_->EnqueueCommand(
+      read_capability(
           LeReadBufferSizeV2Builder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_v2_handler));
+          common::BindOnce(&Controller::impl::le_read_buffer_size_v2_handler, common::Unretained(this)));
     } else {
-      hci_->EnqueueCommand(
+      read_capability(
           LeReadBufferSizeV1Builder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_handler));
+          common::BindOnce(&Controller::impl::le_read_buffer_size_handler, common::Unretained(this)));
     }
 
-    hci_->EnqueueCommand(
+    read_capability(
         LeReadFilterAcceptListSizeBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_connect_list_size_handler));
+        common::BindOnce(&Controller::impl::le_read_connect_list_size_handler, common::Unretained(this)));
 
     if (is_supported(OpCode::LE_READ_RESOLVING_LIST_SIZE) && module_.SupportsBlePrivacy()) {
-      hci_->EnqueueCommand(
+      read_capability(
           LeReadResolvingListSizeBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_resolving_list_size_handler));
+          common::BindOnce(&Controller::impl::le_read_resolving_list_size_handler, common::Unretained(this)));
     } else {
       LOG_INFO("LE_READ_RESOLVING_LIST_SIZE not supported, defaulting to 0");
       le_resolving_list_size_ = 0;
     }
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_DATA_LENGTH) && module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(LeReadMaximumDataLengthBuilder::Create(),
-                           handler->BindOnceOn(this, &Controller::impl::le_read_maximum_data_length_handler));
+      read_capability(
+          LeReadMaximumDataLengthBuilder::Create(),
+          common::BindOnce(&Controller::impl::le_read_maximum_data_length_handler, common::Unretained(this)));
     } else {
       LOG_INFO("LE_READ_MAXIMUM_DATA_LENGTH not supported, defaulting to 0");
       le_maximum_data_length_.supported_max_rx_octets_ = 0;
@@ -125,18 +166,19 @@ struct Controller::impl {
       }
     }
     if (is_supported(OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH) && module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(
+      read_capability(
           LeReadSuggestedDefaultDataLengthBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_suggested_default_data_length_handler));
+          common::BindOnce(&Controller::impl::le_read_suggested_default_data_length_handler, common::Unretained(this)));
     } else {
       LOG_INFO("LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH not supported, defaulting to 27 (0x1B)");
       le_suggested_default_data_length_ = 27;
     }
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH) && module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
           LeReadMaximumAdvertisingDataLengthBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_maximum_advertising_data_length_handler));
+          common::BindOnce(
+              &Controller::impl::le_read_maximum_advertising_data_length_handler, common::Unretained(this)));
     } else {
       LOG_INFO("LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH not supported, defaulting to 31 (0x1F)");
       le_maximum_advertising_data_length_ = 31;
@@ -144,18 +186,19 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS) &&
         module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
           LeReadNumberOfSupportedAdvertisingSetsBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_number_of_supported_advertising_sets_handler));
+          common::BindOnce(
+              &Controller::impl::le_read_number_of_supported_advertising_sets_handler, common::Unretained(this)));
     } else {
       LOG_INFO("LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS not supported, defaulting to 1");
       le_number_supported_advertising_sets_ = 1;
     }
 
     if (is_supported(OpCode::LE_READ_PERIODIC_ADVERTISING_LIST_SIZE) && module_.SupportsBlePeriodicAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
           LeReadPeriodicAdvertiserListSizeBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_periodic_advertiser_list_size_handler));
+          common::BindOnce(&Controller::impl::le_read_periodic_advertiser_list_size_handler, common::Unretained(this)));
     } else {
       LOG_INFO("LE_READ_PERIODIC_ADVERTISING_LIST_SIZE not supported, defaulting to 0");
       le_periodic_advertiser_list_size_ = 0;
@@ -169,20 +212,117 @@ struct Controller::impl {
     // Skip vendor capabilities check if configured.
     if (os::GetSystemPropertyBool(
             kPropertyVendorCapabilitiesEnabled, kDefaultVendorCapabilitiesEnabled)) {
-      hci_->EnqueueCommand(
+      read_capability(
           LeGetVendorCapabilitiesBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_get_vendor_capabilities_handler));
+          common::BindOnce(&Controller::impl::le_get_vendor_capabilities_handler, common::Unretained(this)));
     } else {
       vendor_capabilities_.is_supported_ = 0x00;
     }
 
-    // We only need to synchronize the last read. Make BD_ADDR to be the last one.
+    // We only need to synchronize the last read. Make the local name, which isn't in the snapshot, the last one.
     std::promise<void> promise;
     auto future = promise.get_future();
     hci_->EnqueueCommand(
-        ReadBdAddrBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::read_controller_mac_address_handler, std::move(promise)));
+        ReadLocalNameBuilder::Create(),
+        handler->BindOnceOn(this, &Controller::impl::read_local_name_complete_handler, std::move(promise)));
     future.wait();
+
+    if (capability_snapshot_enabled_ && recorded_capabilities_ != cached_capabilities_) {
+      save_capability_snapshot();
+    }
+    cached_capabilities_.clear();
+    recorded_capabilities_.clear();
+  }
+
+  // Send a command which reads a capability of the controller, and record its result for the snapshot
+  void send_capability_read(
+      std::unique_ptr<CommandBuilder> command, common::OnceCallback<void(CommandCompleteView)> handler) {
+    auto command_bytes = serialize_command(*command);
+    hci_->EnqueueCommand(
+        std::move(command),
+        module_.GetHandler()->BindOnceOn(
+            this, &Controller::impl::on_capability_read, std::move(command_bytes), std::move(handler)));
+  }
+
+  // Replay the result of command from the capability snapshot when it has it, or send command otherwise
+  void read_capability(
+      std::unique_ptr<CommandBuilder> command, common::OnceCallback<void(CommandCompleteView)> handler) {
+    auto command_bytes = serialize_command(*command);
+    auto cached = cached_capabilities_.find(command_bytes);
+    if (cached == cached_capabilities_.end()) {
+      send_capability_read(std::move(command), std::move(handler));
+      return;
+    }
+    // Run on the handler after the results already received, like the command complete would
+    module_.GetHandler()->Post(common::BindOnce(
+        &Controller::impl::on_capability_read,
+        common::Unretained(this),
+        std::move(command_bytes),
+        std::move(handler),
+        command_complete_view_of(cached->second)));
+  }
+
+  void on_capability_read(
+      std::vector<uint8_t> command_bytes,
+      common::OnceCallback<void(CommandCompleteView)> handler,
+      CommandCompleteView view) {
+    ASSERT(view.IsValid());
+    if (capability_snapshot_enabled_) {
+      recorded_capabilities_[std::move(command_bytes)] = std::vector<uint8_t>(view.begin(), view.end());
+    }
+    std::move(handler).Run(view);
+  }
+
+  static CommandCompleteView command_complete_view_of(const std::vector<uint8_t>& bytes) {
+    return CommandCompleteView::Create(
+        EventView::Create(packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(bytes))));
+  }
+
+  static std::vector<uint8_t> serialize_command(const CommandBuilder& command) {
+    std::vector<uint8_t> bytes;
+    packet::BitInserter it(bytes);
+    command.Serialize(it);
+    return bytes;
+  }
+
+  void load_capability_snapshot() {
+    auto path = os::ParameterProvider::ControllerCapabilitiesFilePath();
+    auto content = os::ReadSmallFile(path);
+    if (!content) {
+      LOG_INFO("No controller capability snapshot in %s", path.c_str());
+      return;
+    }
+    auto lines = common::StringSplit(*content, "\n");
+    if (lines.empty() || lines[0] != kCapabilitySnapshotHeader) {
+      LOG_WARN("Ignoring controller capability snapshot of another version");
+      return;
+    }
+    for (size_t i = 1; i < lines.size(); i++) {
+      if (lines[i].empty()) {
+        continue;
+      }
+      auto fields = common::StringSplit(lines[i], " ");
+      auto command = fields.size() == 2 ? common::FromHexString(fields[0]) : std::nullopt;
+      auto complete = fields.size() == 2 ? common::FromHexString(fields[1]) : std::nullopt;
+      if (!command || !complete || !command_complete_view_of(*complete).IsValid()) {
+        LOG_WARN("Ignoring malformed controller capability snapshot");
+        cached_capabilities_.clear();
+        return;
+      }
+      cached_capabilities_[*command] = *complete;
+    }
+    LOG_INFO("Loaded %zu controller capabilities from %s", cached_capabilities_.size(), path.c_str());
+  }
+
+  void save_capability_snapshot() {
+    std::string content = std::string(kCapabilitySnapshotHeader) + "\n";
+    for (const auto& [command, complete] : recorded_capabilities_) {
+      content += common::ToHexString(command) + " " + common::ToHexString(complete) + "\n";
+    }
+    auto path = os::ParameterProvider::ControllerCapabilitiesFilePath();
+    if (!os::WriteToFile(path, content)) {
+      LOG_WARN("Unable to save the controller capability snapshot to %s", path.c_str());
+    }
   }
 
   void Stop() {
@@ -199,7 +339,7 @@ struct Controller::impl {
     }
     auto complete_view = NumberOfCompletedPacketsView::Create(event);
     ASSERT(complete_view.IsValid());
-    for (auto completed_packets : complete_view.GetCompletedPackets()) {
+    for (const auto& completed_packets : complete_view.GetCompletedPacketsLazy()) {
       uint16_t handle = completed_packets.connection_handle_;
       uint16_t credits = completed_packets.host_num_of_completed_packets_;
       acl_credits_callback_.Invoke(handle, credits);
@@ -246,7 +386,7 @@ struct Controller::impl {
     ASSERT_LOG(status == ErrorCode::SUCCESS, "Status 0x%02hhx, %s", status, ErrorCodeText(status).c_str());
   }
 
-  void read_local_name_complete_handler(CommandCompleteView view) {
+  void read_local_name_complete_handler(std::promise<void> promise, CommandCompleteView view) {
     auto complete_view = ReadLocalNameCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
     ErrorCode status = complete_view.GetStatus();
@@ -256,6 +396,7 @@ struct Controller::impl {
     local_name_ = std::string(local_name_array.begin(), local_name_array.end());
     // erase \0
     local_name_.erase(std::find(local_name_.begin(), local_name_.end(), '\0'), local_name_.end());
+    promise.set_value();
   }
 
   void read_local_version_information_complete_handler(CommandCompleteView view) {
@@ -292,10 +433,12 @@ struct Controller::impl {
     // Query all extended features
     if (page_number < complete_view.GetMaximumPageNumber()) {
       page_number++;
-      hci_->EnqueueCommand(
+      read_capability(
           ReadLocalExtendedFeaturesBuilder::Create(page_number),
-          module_.GetHandler()->BindOnceOn(this, &Controller::impl::read_local_extended_features_complete_handler,
-                                           std::move(promise)));
+          common::BindOnce(
+              &Controller::impl::read_local_extended_features_complete_handler,
+              common::Unretained(this),
+              std::move(promise)));
     } else {
       promise.set_value();
     }
@@ -897,6 +1040,12 @@ struct Controller::impl {
 
   HciLayer* hci_;
 
+  // Command completes of the capability reads by the serialized command, loaded from the snapshot of the last start
+  // and recorded during this one
+  bool capability_snapshot_enabled_ = false;
+  std::map<std::vector<uint8_t>, std::vector<uint8_t>> cached_capabilities_;
+  std::map<std::vector<uint8_t>, std::vector<uint8_t>> recorded_capabilities_;
+
   CompletedAclPacketsCallback acl_credits_callback_{};
   CompletedAclPacketsCallback acl_monitor_credits_callback_{};
   LocalVersionInformation local_version_information_{};
@@ -29,6 +29,9 @@
 #include "common/init_flags.h"
 #include "hci/address.h"
 #include "hci/hci_layer.h"
+#include "os/files.h"
+#include "os/parameter_provider.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
@@ -87,6 +90,10 @@ class TestHciLayer : public HciLayer {
     auto packet_view = GetPacketView(std::move(command_builder));
     CommandView command = CommandView::Create(packet_view);
     ASSERT_TRUE(command.IsValid());
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      command_counts_[command.GetOpCode()]++;
+    }
 
     uint8_t num_packets = 1;
     std::unique_ptr<packet::BasePacketBuilder> event_builder;
@@ -264,6 +271,11 @@ class TestHciLayer : public HciLayer {
     return command;
   }
 
+  size_t GetCommandCount(OpCode op_code) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return command_counts_[op_code];
+  }
+
   void ListDependencies(ModuleList* list) const {}
   void Start() override {}
   void Stop() override {}
@@ -278,6 +290,7 @@ class TestHciLayer : public HciLayer {
  private:
   common::ContextualCallback<void(EventView)> number_of_completed_packets_callback_;
   std::queue<CommandView> command_queue_;
+  std::map<OpCode, size_t> command_counts_;
   mutable std::mutex mutex_;
   std::condition_variable not_empty_;
 };
@@ -356,6 +369,43 @@ TEST_F(ControllerTest, read_controller_info) {
   ASSERT_EQ(controller_->GetLeNumberOfSupportedAdverisingSets(), 0xF0);
 }
 
+#ifndef OS_ANDROID
+TEST(ControllerCapabilitySnapshotTest, restart_from_snapshot) {
+  auto path = ::testing::TempDir() + "/controller_capabilities_test.conf";
+  os::ParameterProvider::OverrideControllerCapabilitiesFilePath(path);
+  ASSERT_TRUE(os::SetSystemProperty("bluetooth.core.controller.capability_snapshot.enabled", "true"));
+  feature_spec_version = 98;
+
+  for (int start = 0; start < 2; start++) {
+    TestModuleRegistry registry;
+    auto test_hci_layer = new TestHciLayer;
+    registry.InjectTestModule(&HciLayer::Factory, test_hci_layer);
+    registry.Start<Controller>(&registry.GetTestThread());
+    auto controller = static_cast<Controller*>(registry.GetModuleUnderTest(&Controller::Factory));
+
+    // The second start only probes the version and the address of the controller
+    ASSERT_EQ(1u, test_hci_layer->GetCommandCount(OpCode::READ_LOCAL_VERSION_INFORMATION));
+    ASSERT_EQ(1u, test_hci_layer->GetCommandCount(OpCode::READ_BD_ADDR));
+    size_t expected_reads = start == 0 ? 1 : 0;
+    ASSERT_EQ(expected_reads, test_hci_layer->GetCommandCount(OpCode::READ_LOCAL_SUPPORTED_COMMANDS));
+    ASSERT_EQ(expected_reads, test_hci_layer->GetCommandCount(OpCode::READ_BUFFER_SIZE));
+    ASSERT_EQ(expected_reads * 3, test_hci_layer->GetCommandCount(OpCode::READ_LOCAL_EXTENDED_FEATURES));
+
+    ASSERT_EQ(controller->GetAclPacketLength(), test_hci_layer->acl_data_packet_length);
+    ASSERT_EQ(controller->GetLeBufferSize().total_num_le_packets_, 0x08);
+    ASSERT_EQ(controller->GetLeNumberOfSupportedAdverisingSets(), 0xF0);
+    ASSERT_EQ(controller->GetMacAddress(), Address::kAny);
+    ASSERT_EQ(controller->GetLocalName(), "DUT");
+    ASSERT_EQ(controller->GetVendorCapabilities().version_supported_, 98);
+    registry.StopAll();
+  }
+
+  os::RemoveFile(path);
+  os::ParameterProvider::OverrideControllerCapabilitiesFilePath("");
+  os::ClearSystemPropertiesForHost();
+}
+#endif
+
 TEST_F(ControllerTest, read_write_local_name) {
   ASSERT_EQ(controller_->GetLocalName(), "DUT");
   controller_->WriteLocalName("New name");
@@ -0,0 +1,343 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// End to end cost of the data packets through the HCI layer, its queues and handlers, against a controller which
+// runs on its own thread and loops the ACL packets back. Besides time, every benchmark reports the allocations and
+// context switches per packet, and the percentiles of the per packet latency.
+//
+// To follow regressions, record a baseline on the reference device and compare later runs against it:
+//   bluetooth_benchmark_gd --benchmark_filter=BM_DataPlane --benchmark_out=baseline.json --benchmark_out_format=json
+//   compare.py benchmarks baseline.json new.json  (from the google benchmark tools)
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "benchmark_counters.h"
+#include "common/bind.h"
+#include "hal/hci_hal.h"
+#include "hci/hci_layer.h"
+#include "hci/hci_packets.h"
+#include "metrics/latency_histogram.h"
+#include "module.h"
+#include "os/handler.h"
+#include "os/queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+using ::bluetooth::ModuleList;
+using ::bluetooth::TestModuleRegistry;
+using ::bluetooth::hci::AclBuilder;
+using ::bluetooth::hci::AclView;
+using ::bluetooth::hci::CommandCompleteBuilder;
+using ::bluetooth::hci::CommandView;
+using ::bluetooth::hci::CompletedPackets;
+using ::bluetooth::hci::EventCode;
+using ::bluetooth::hci::EventView;
+using ::bluetooth::hci::HciLayer;
+using ::bluetooth::hci::IsoBuilder;
+using ::bluetooth::hci::IsoView;
+using ::bluetooth::metrics::LatencyHistogram;
+using ::bluetooth::os::Handler;
+using ::bluetooth::os::Thread;
+
+namespace {
+
+constexpr uint16_t kHandle = 0x0040;
+constexpr uint8_t kControllerCredits = 1;
+// Packets in flight in each iteration, like an audio or file transfer burst
+constexpr int kPacketsPerIteration = 32;
+
+std::vector<uint8_t> Serialize(std::unique_ptr<bluetooth::packet::BasePacketBuilder> builder) {
+  std::vector<uint8_t> bytes;
+  bluetooth::packet::BitInserter bi(bytes);
+  builder->Serialize(bi);
+  return bytes;
+}
+
+// Controller which answers every command with a successful Command Complete, completes every data packet, and
+// sends the ACL packets back to the host. It runs on its own thread, like the transport of a real controller.
+class LoopbackControllerHal : public bluetooth::hal::HciHal {
+ public:
+  void registerIncomingPacketCallback(bluetooth::hal::HciHalCallbacks* callbacks) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_ = callbacks;
+  }
+
+  void unregisterIncomingPacketCallback() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_ = nullptr;
+  }
+
+  void sendHciCommand(bluetooth::hal::HciPacket command) override {
+    auto view = CommandView::Create(bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(
+        std::make_shared<std::vector<uint8_t>>(std::move(command))));
+    auto op_code = view.GetOpCode();
+    Post([this, op_code]() {
+      auto payload = std::make_unique<bluetooth::packet::RawBuilder>();
+      payload->AddOctets1(static_cast<uint8_t>(bluetooth::hci::ErrorCode::SUCCESS));
+      callbacks_->hciEventReceived(
+          Serialize(CommandCompleteBuilder::Create(kControllerCredits, op_code, std::move(payload))));
+    });
+  }
+
+  void sendAclData(bluetooth::hal::HciPacket data) override {
+    Post([this, data = std::move(data)]() {
+      callbacks_->hciEventReceived(CompletedPacketsEvent(data));
+      callbacks_->aclDataReceived(data);
+    });
+  }
+
+  void sendScoData(bluetooth::hal::HciPacket) override {}
+
+  void sendIsoData(bluetooth::hal::HciPacket data) override {
+    Post([this, data = std::move(data)]() { callbacks_->hciEventReceived(CompletedPacketsEvent(data)); });
+  }
+
+  std::string ToString() const override {
+    return "LoopbackControllerHal";
+  }
+
+ protected:
+  void ListDependencies(ModuleList*) const override {}
+
+  void Start() override {
+    running_ = true;
+    controller_ = std::thread(&LoopbackControllerHal::run, this);
+  }
+
+  void Stop() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+      pending_changed_.notify_one();
+    }
+    controller_.join();
+  }
+
+ private:
+  // Number Of Completed Packets event for the data packet
+  static std::vector<uint8_t> CompletedPacketsEvent(const bluetooth::hal::HciPacket& data) {
+    CompletedPackets completed;
+    completed.connection_handle_ = (data[0] | (data[1] << 8)) & 0x0fff;
+    completed.host_num_of_completed_packets_ = 1;
+    return Serialize(bluetooth::hci::NumberOfCompletedPacketsBuilder::Create({completed}));
+  }
+
+  void Post(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(std::move(task));
+    pending_changed_.notify_one();
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+      if (pending_.empty()) {
+        pending_changed_.wait(lock);
+        continue;
+      }
+      auto task = std::move(pending_.front());
+      pending_.pop_front();
+      if (callbacks_ != nullptr) {
+        task();
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable pending_changed_;
+  std::deque<std::function<void()>> pending_;
+  bluetooth::hal::HciHalCallbacks* callbacks_ = nullptr;
+  bool running_ = false;
+  std::thread controller_;
+};
+
+class BM_DataPlane : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    registry_ = std::make_unique<TestModuleRegistry>();
+    registry_->InjectTestModule(&bluetooth::hal::HciHal::Factory, new LoopbackControllerHal());
+    registry_->Start<HciLayer>(&registry_->GetTestThread());
+    hci_ = registry_->GetModuleUnderTest<HciLayer>();
+    thread_ = std::make_unique<Thread>("BM_DataPlane thread", Thread::Priority::NORMAL);
+    handler_ = std::make_unique<Handler>(thread_.get());
+    acl_buffer_ = std::make_unique<bluetooth::os::EnqueueBuffer<AclBuilder>>(hci_->GetAclQueueEnd());
+    iso_buffer_ = std::make_unique<bluetooth::os::EnqueueBuffer<IsoBuilder>>(hci_->GetIsoQueueEnd());
+    hci_->GetAclQueueEnd()->RegisterDequeue(
+        handler_.get(), bluetooth::common::Bind(&BM_DataPlane::on_incoming_acl, bluetooth::common::Unretained(this)));
+    hci_->RegisterEventHandler(
+        EventCode::NUMBER_OF_COMPLETED_PACKETS, handler_->BindOn(this, &BM_DataPlane::on_completed_packets));
+  }
+
+  void TearDown(State& st) override {
+    hci_->UnregisterEventHandler(EventCode::NUMBER_OF_COMPLETED_PACKETS);
+    hci_->GetAclQueueEnd()->UnregisterDequeue();
+    acl_buffer_ = nullptr;
+    iso_buffer_ = nullptr;
+    handler_->Clear();
+    handler_->WaitUntilStopped(std::chrono::milliseconds(2000));
+    handler_ = nullptr;
+    thread_->Stop();
+    thread_ = nullptr;
+    registry_->StopAll();
+    registry_ = nullptr;
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  // Send a burst of packets from the handler thread, and wait until each of them came back, or was completed
+  template <typename Builder>
+  void SendBurst(std::function<std::unique_ptr<Builder>()> make_packet, bluetooth::os::EnqueueBuffer<Builder>* buffer) {
+    std::promise<void> done;
+    auto done_future = done.get_future();
+    handler_->Post(bluetooth::common::BindOnce(
+        [](BM_DataPlane* self,
+           std::function<std::unique_ptr<Builder>()> make_packet,
+           bluetooth::os::EnqueueBuffer<Builder>* buffer,
+           std::promise<void> done) {
+          self->remaining_ = kPacketsPerIteration;
+          self->done_ = std::move(done);
+          for (int i = 0; i < kPacketsPerIteration; i++) {
+            self->sent_times_.push_back(std::chrono::steady_clock::now());
+            buffer->Enqueue(make_packet(), self->handler_.get());
+          }
+        },
+        this,
+        std::move(make_packet),
+        buffer,
+        std::move(done)));
+    done_future.wait();
+  }
+
+  // Handler thread only
+  void on_packet_done() {
+    latency_.Record(std::chrono::steady_clock::now() - sent_times_.front());
+    sent_times_.pop_front();
+    if (--remaining_ == 0) {
+      done_.set_value();
+    }
+  }
+
+  void on_incoming_acl() {
+    auto packet = hci_->GetAclQueueEnd()->TryDequeue();
+    if (packet != nullptr && loopback_) {
+      on_packet_done();
+    }
+  }
+
+  void on_completed_packets(EventView event) {
+    if (loopback_) {
+      return;
+    }
+    auto view = bluetooth::hci::NumberOfCompletedPacketsView::Create(event);
+    if (!view.IsValid()) {
+      return;
+    }
+    for (const auto& completed : view.GetCompletedPackets()) {
+      for (int i = 0; i < completed.host_num_of_completed_packets_; i++) {
+        on_packet_done();
+      }
+    }
+  }
+
+  template <typename Builder>
+  void Run(
+      State& state,
+      bool loopback,
+      std::function<std::unique_ptr<Builder>()> make_packet,
+      bluetooth::os::EnqueueBuffer<Builder>* buffer) {
+    loopback_ = loopback;
+    latency_.Reset();
+    auto before = bluetooth::GetProcessCounters();
+    for (auto _ : state) {
+      SendBurst(make_packet, buffer);
+    }
+    auto after = bluetooth::GetProcessCounters();
+    uint64_t packets = state.iterations() * kPacketsPerIteration;
+    state.SetItemsProcessed(packets);
+    state.SetBytesProcessed(packets * state.range(0));
+    bluetooth::ReportCountersPerItem(state, before, after, packets);
+    auto snapshot = latency_.GetSnapshot();
+    state.counters["p50_us"] = snapshot.GetPercentile(50);
+    state.counters["p99_us"] = snapshot.GetPercentile(99);
+    state.counters["max_us"] = snapshot.max_us;
+  }
+
+  std::unique_ptr<TestModuleRegistry> registry_;
+  HciLayer* hci_ = nullptr;
+  std::unique_ptr<Thread> thread_;
+  std::unique_ptr<Handler> handler_;
+  std::unique_ptr<bluetooth::os::EnqueueBuffer<AclBuilder>> acl_buffer_;
+  std::unique_ptr<bluetooth::os::EnqueueBuffer<IsoBuilder>> iso_buffer_;
+
+  // Handler thread only
+  bool loopback_ = false;
+  int remaining_ = 0;
+  std::promise<void> done_;
+  std::deque<std::chrono::steady_clock::time_point> sent_times_;
+  LatencyHistogram latency_;
+};
+
+// ACL packets from the upper queue of the HCI layer to the controller and back, with payloads from the LE default
+// size to the BR/EDR 3-DH5 size
+BENCHMARK_DEFINE_F(BM_DataPlane, acl_round_trip)(State& state) {
+  size_t payload_size = state.range(0);
+  Run<AclBuilder>(
+      state,
+      true,
+      [payload_size]() {
+        return AclBuilder::Create(
+            kHandle,
+            bluetooth::hci::PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE,
+            bluetooth::hci::BroadcastFlag::POINT_TO_POINT,
+            std::make_unique<bluetooth::packet::RawBuilder>(std::vector<uint8_t>(payload_size)));
+      },
+      acl_buffer_.get());
+}
+
+BENCHMARK_REGISTER_F(BM_DataPlane, acl_round_trip)->Arg(27)->Arg(251)->Arg(1021)->UseRealTime();
+
+// ISO SDUs from the upper queue of the HCI layer until the controller reports them completed, with the SDU sizes of
+// LC3 frames at 16, 48 and 96 kHz
+BENCHMARK_DEFINE_F(BM_DataPlane, iso_send)(State& state) {
+  size_t sdu_size = state.range(0);
+  uint16_t sequence_number = 0;
+  Run<IsoBuilder>(
+      state,
+      false,
+      [sdu_size, &sequence_number]() -> std::unique_ptr<IsoBuilder> {
+        return bluetooth::hci::IsoWithoutTimestampBuilder::Create(
+            kHandle,
+            bluetooth::hci::IsoPacketBoundaryFlag::COMPLETE_SDU,
+            sequence_number++,
+            bluetooth::hci::IsoPacketStatusFlag::VALID,
+            std::make_unique<bluetooth::packet::RawBuilder>(std::vector<uint8_t>(sdu_size)));
+      },
+      iso_buffer_.get());
+}
+
+BENCHMARK_REGISTER_F(BM_DataPlane, iso_send)->Arg(40)->Arg(100)->Arg(155)->UseRealTime();
+
+}  // namespace
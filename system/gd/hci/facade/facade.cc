@@ -16,6 +16,7 @@
 
 #include "hci/facade/facade.h"
 
+#include <atomic>
 #include <memory>
 
 #include "blueberry/facade/hci/hci_facade.grpc.pb.h"
@@ -165,6 +166,23 @@ class HciFacadeService : public HciFacade::Service {
     return pending_acl_events_.RunLoop(context, writer);
   };
 
+  ::grpc::Status StreamAclBatches(
+      ::grpc::ServerContext* context,
+      const ::blueberry::facade::StreamBatchesRequest* request,
+      ::grpc::ServerWriter<::blueberry::facade::DataBatch>* writer) override {
+    hci_layer_->GetAclQueueEnd()->RegisterDequeue(
+        facade_handler_, common::Bind(&HciFacadeService::on_acl_ready, common::Unretained(this)));
+    unregister_acl_dequeue_ = true;
+    log_acl_packets_ = false;
+    return pending_acl_events_.RunBatchLoop(
+        context,
+        writer,
+        request->max_batch_size(),
+        [](::blueberry::facade::DataBatch* batch, ::blueberry::facade::Data acl) {
+          batch->add_payloads(std::move(*acl.mutable_payload()));
+        });
+  };
+
  private:
   std::unique_ptr<AclBuilder> handle_enqueue_acl(std::promise<void>* promise) {
     promise->set_value();
@@ -176,7 +194,9 @@ class HciFacadeService : public HciFacade::Service {
     auto acl_ptr = hci_layer_->GetAclQueueEnd()->TryDequeue();
     ASSERT(acl_ptr != nullptr);
     ASSERT(acl_ptr->IsValid());
-    LOG_INFO("Got an Acl message for handle 0x%hx", acl_ptr->GetHandle());
+    if (log_acl_packets_) {
+      LOG_INFO("Got an Acl message for handle 0x%hx", acl_ptr->GetHandle());
+    }
     ::blueberry::facade::Data incoming;
     incoming.set_payload(std::string(acl_ptr->begin(), acl_ptr->end()));
     pending_acl_events_.OnIncomingEvent(std::move(incoming));
@@ -221,6 +241,8 @@ class HciFacadeService : public HciFacade::Service {
   ::bluetooth::grpc::GrpcEventQueue<::blueberry::facade::Data> pending_le_events_{"StreamLeSubevents"};
   ::bluetooth::grpc::GrpcEventQueue<::blueberry::facade::Data> pending_acl_events_{"StreamAcl"};
   bool unregister_acl_dequeue_{false};
+  // Cleared when the ACL packets are streamed in batches, whose rate is too high to log each of them
+  std::atomic<bool> log_acl_packets_{true};
   std::unique_ptr<TestAclBuilder> waiting_acl_packet_;
   bool completed_packets_callback_registered_{false};
 };
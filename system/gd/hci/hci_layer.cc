@@ -16,13 +16,23 @@
 
 #include "hci/hci_layer.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
 #include "common/bind.h"
 #include "common/init_flags.h"
 #include "common/stop_watch.h"
+#include "hal/serialize_packet.h"
 #include "hci/hci_metrics_logging.h"
+#include "hci_layer_generated.h"
+#include "metrics/latency_histogram.h"
 #include "os/alarm.h"
 #include "os/metrics.h"
 #include "os/queue.h"
+#include "os/system_properties.h"
+#include "os/trace.h"
 #include "packet/packet_builder.h"
 #include "storage/storage_module.h"
 
@@ -47,6 +57,14 @@ using os::Handler;
 using std::move;
 using std::unique_ptr;
 
+// Upper bound on the commands in flight, on top of the credits granted by the controller. 1 sends the commands one at
+// a time, waiting for the response to each of them.
+static constexpr char kMaxOutstandingCommandsProperty[] = "bluetooth.hci.max_outstanding_commands";
+static constexpr uint32_t kDefaultMaxOutstandingCommands = 4;
+
+// Trace span of a command waiting in the queue; once sent, the span "HCI <opcode>" lasts until its response
+static constexpr char kCommandQueuedTrace[] = "HCI command queued";
+
 static void fail_if_reset_complete_not_success(CommandCompleteView complete) {
   auto reset_complete = ResetCompleteView::Create(complete);
   ASSERT(reset_complete.IsValid());
@@ -58,6 +76,60 @@ static void abort_after_time_out(OpCode op_code) {
   ASSERT_LOG(false, "Done waiting for debug information after HCI timeout (%s)", OpCodeText(op_code).c_str());
 }
 
+// Events counted by event code or LE subevent code. The counters are only written on the HCI layer handler, and read
+// from the dumpsys thread.
+class EventCounters {
+ public:
+  static constexpr size_t kNumCodes = 256;
+
+  void Received(uint8_t code) {
+    increment(counters_[code].received);
+  }
+
+  void Handled(uint8_t code) {
+    increment(counters_[code].handled);
+  }
+
+  void Dropped(uint8_t code) {
+    increment(counters_[code].dropped);
+  }
+
+  template <typename TCodeText>
+  flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<HciEventCountersData>>> Dump(
+      flatbuffers::FlatBufferBuilder* fb_builder, TCodeText code_text) const {
+    std::vector<flatbuffers::Offset<HciEventCountersData>> counters;
+    for (size_t code = 0; code < kNumCodes; code++) {
+      uint64_t received = counters_[code].received.load(std::memory_order_relaxed);
+      if (received == 0) {
+        continue;
+      }
+      auto name = fb_builder->CreateString(code_text(static_cast<uint8_t>(code)));
+      HciEventCountersDataBuilder builder(*fb_builder);
+      builder.add_code(static_cast<uint8_t>(code));
+      builder.add_name(name);
+      builder.add_received(received);
+      builder.add_handled(counters_[code].handled.load(std::memory_order_relaxed));
+      builder.add_dropped(counters_[code].dropped.load(std::memory_order_relaxed));
+      counters.push_back(builder.Finish());
+    }
+    return fb_builder->CreateVector(counters);
+  }
+
+ private:
+  struct Counters {
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> handled{0};
+    std::atomic<uint64_t> dropped{0};
+  };
+
+  // There is a single writer, so this doesn't need an atomic read-modify-write
+  static void increment(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  std::array<Counters, kNumCodes> counters_;
+};
+
 class CommandQueueEntry {
  public:
   CommandQueueEntry(
@@ -69,7 +141,16 @@ class CommandQueueEntry {
       : command(move(command_packet)), waiting_for_status_(true), on_status(move(on_status_function)) {}
 
   unique_ptr<CommandBuilder> command;
+  // Set once the command is serialized, before it is sent to the controller
+  std::shared_ptr<std::vector<uint8_t>> command_bytes;
   unique_ptr<CommandView> command_view;
+  OpCode op_code{OpCode::NONE};
+  // Set once the command is sent to the controller
+  std::chrono::steady_clock::time_point sent_time;
+  std::chrono::steady_clock::time_point deadline;
+  // Set if the command was enqueued while tracing, to close its trace spans
+  bool traced{false};
+  int32_t trace_id{0};
 
   bool waiting_for_status_;
   ContextualOnceCallback<void(CommandStatusView)> on_status;
@@ -94,6 +175,8 @@ class CommandQueueEntry {
 struct HciLayer::impl {
   impl(hal::HciHal* hal, HciLayer& module) : hal_(hal), module_(module) {
     hci_timeout_alarm_ = new Alarm(module.GetHandler());
+    max_outstanding_commands_ = std::max<uint32_t>(
+        1, os::GetSystemPropertyUint32(kMaxOutstandingCommandsProperty, kDefaultMaxOutstandingCommands));
   }
 
   ~impl() {
@@ -107,6 +190,7 @@ struct HciLayer::impl {
       delete hci_abort_alarm_;
     }
     command_queue_.clear();
+    in_flight_commands_.clear();
   }
 
   void drop(EventView event) {
@@ -115,31 +199,28 @@ struct HciLayer::impl {
 
   void on_outbound_acl_ready() {
     auto packet = acl_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendAclData(bytes);
+    hal_->sendAclData(hal::SerializePacket(std::move(packet)));
   }
 
   void on_outbound_sco_ready() {
     auto packet = sco_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendScoData(bytes);
+    hal_->sendScoData(hal::SerializePacket(std::move(packet)));
   }
 
   void on_outbound_iso_ready() {
     auto packet = iso_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
-    hal_->sendIsoData(bytes);
+    hal_->sendIsoData(hal::SerializePacket(std::move(packet)));
   }
 
   template <typename TResponse>
   void enqueue_command(unique_ptr<CommandBuilder> command, ContextualOnceCallback<void(TResponse)> on_response) {
     command_queue_.emplace_back(move(command), move(on_response));
+    if (os::IsTracing()) {
+      auto& entry = command_queue_.back();
+      entry.traced = true;
+      entry.trace_id = static_cast<int32_t>(next_command_trace_id_++);
+      os::TraceAsyncBegin(kCommandQueuedTrace, entry.trace_id);
+    }
     send_next_command();
   }
 
@@ -174,18 +255,26 @@ struct HciLayer::impl {
     }
     bool is_status = logging_id == "status";
 
-    ASSERT_LOG(!command_queue_.empty(), "Unexpected %s event with OpCode 0x%02hx (%s)", logging_id.c_str(), op_code,
-               OpCodeText(op_code).c_str());
-    if (waiting_command_ == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
-      LOG_ERROR("Discarding event that came after timeout 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
-      return;
+    ASSERT_LOG(!in_flight_commands_.empty(), "Unexpected %s event with OpCode 0x%02hx (%s)", logging_id.c_str(),
+               op_code, OpCodeText(op_code).c_str());
+    auto entry = find_in_flight_command(op_code);
+    if (entry == in_flight_commands_.end()) {
+      OpCode oldest_op_code = in_flight_commands_.front().op_code;
+      if (oldest_op_code == OpCode::CONTROLLER_DEBUG_INFO) {
+        LOG_ERROR("Discarding event that came after timeout 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
+        return;
+      }
+      ASSERT_LOG(false, "Waiting for 0x%02hx (%s), got 0x%02hx (%s)", oldest_op_code,
+                 OpCodeText(oldest_op_code).c_str(), op_code, OpCodeText(op_code).c_str());
+    }
+    command_latency(op_code).Record(std::chrono::steady_clock::now() - entry->sent_time);
+    if (entry->traced) {
+      os::TraceAsyncEnd("HCI " + OpCodeText(op_code), entry->trace_id);
     }
-    ASSERT_LOG(waiting_command_ == op_code, "Waiting for 0x%02hx (%s), got 0x%02hx (%s)", waiting_command_,
-               OpCodeText(waiting_command_).c_str(), op_code, OpCodeText(op_code).c_str());
 
     bool is_vendor_specific = static_cast<int>(op_code) & (0x3f << 10);
     CommandStatusView status_view = CommandStatusView::Create(event);
-    if (is_vendor_specific && (is_status && !command_queue_.front().waiting_for_status_) &&
+    if (is_vendor_specific && (is_status && !entry->waiting_for_status_) &&
         (status_view.IsValid() && status_view.GetStatus() == ErrorCode::UNKNOWN_HCI_COMMAND)) {
       // If this is a command status of a vendor specific command, and command complete is expected, we can't treat
       // this as hard failure since we have no way of probing this lack of support at earlier time. Instead we let
@@ -193,36 +282,77 @@ struct HciLayer::impl {
       // response.
       CommandCompleteView command_complete_view = CommandCompleteView::Create(
           EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-      command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(move(command_complete_view));
+      entry->GetCallback<CommandCompleteView>()->Invoke(move(command_complete_view));
     } else {
       ASSERT_LOG(
-          command_queue_.front().waiting_for_status_ == is_status,
+          entry->waiting_for_status_ == is_status,
           "0x%02hx (%s) was not expecting %s event",
           op_code,
           OpCodeText(op_code).c_str(),
           logging_id.c_str());
 
-      command_queue_.front().GetCallback<TResponse>()->Invoke(move(response_view));
+      entry->GetCallback<TResponse>()->Invoke(move(response_view));
     }
 
-    command_queue_.pop_front();
-    waiting_command_ = OpCode::NONE;
+    bool was_oldest = entry == in_flight_commands_.begin();
+    in_flight_commands_.erase(entry);
     if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Cancel();
+      if (was_oldest) {
+        schedule_hci_timeout();
+      }
       send_next_command();
     }
   }
 
+  // Round trip time from sending a command to receiving its status or complete event, by opcode
+  metrics::LatencyHistogram& command_latency(OpCode op_code) {
+    auto histogram = command_latencies_.find(op_code);
+    if (histogram == command_latencies_.end()) {
+      histogram =
+          command_latencies_.emplace(op_code, &metrics::LatencyHistogram::Get("hci_command." + OpCodeText(op_code)))
+              .first;
+    }
+    return *histogram->second;
+  }
+
+  // Responses to commands with the same opcode come back in the order the commands were sent
+  std::list<CommandQueueEntry>::iterator find_in_flight_command(OpCode op_code) {
+    return std::find_if(in_flight_commands_.begin(), in_flight_commands_.end(),
+                        [op_code](const CommandQueueEntry& entry) { return entry.op_code == op_code; });
+  }
+
+  // Arm the timeout for the oldest command in flight. The deadlines of the commands behind it are checked in turn
+  // once it completes.
+  void schedule_hci_timeout() {
+    hci_timeout_alarm_->Cancel();
+    if (in_flight_commands_.empty()) {
+      return;
+    }
+    const CommandQueueEntry& oldest = in_flight_commands_.front();
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        oldest.deadline - std::chrono::steady_clock::now());
+    // A zero delay would leave the alarm disarmed
+    remaining = std::max(remaining, std::chrono::milliseconds(1));
+    hci_timeout_alarm_->Schedule(
+        BindOnce(&impl::on_hci_timeout, common::Unretained(this), oldest.op_code), remaining);
+  }
+
+  // Reset drops the commands the controller is processing, and the debug info is requested after a timeout, so these
+  // are never sent along with other commands
+  static bool must_be_sent_alone(OpCode op_code) {
+    return op_code == OpCode::RESET || op_code == OpCode::CONTROLLER_DEBUG_INFO;
+  }
+
   void on_hci_timeout(OpCode op_code) {
     common::StopWatch::DumpStopWatchLog();
     LOG_ERROR("Timed out waiting for 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
     // TODO: LogMetricHciTimeoutEvent(static_cast<uint32_t>(op_code));
 
-    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size());
+    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size() + in_flight_commands_.size());
     // Clear any waiting commands (there is an abort coming anyway)
     command_queue_.clear();
+    in_flight_commands_.clear();
     command_credits_ = 1;
-    waiting_command_ = OpCode::NONE;
     enqueue_command(
         ControllerDebugInfoBuilder::Create(), module_.GetHandler()->BindOnce(&fail_if_reset_complete_not_success));
     // Don't time out for this one;
@@ -240,32 +370,39 @@ struct HciLayer::impl {
   }
 
   void send_next_command() {
-    if (command_credits_ == 0) {
-      return;
-    }
-    if (waiting_command_ != OpCode::NONE) {
-      return;
-    }
-    if (command_queue_.size() == 0) {
-      return;
-    }
-    std::shared_ptr<std::vector<uint8_t>> bytes = std::make_shared<std::vector<uint8_t>>();
-    BitInserter bi(*bytes);
-    command_queue_.front().command->Serialize(bi);
-    hal_->sendHciCommand(*bytes);
-
-    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(bytes));
-    ASSERT(cmd_view.IsValid());
-    OpCode op_code = cmd_view.GetOpCode();
-    command_queue_.front().command_view = std::make_unique<CommandView>(std::move(cmd_view));
-    log_link_layer_connection_command(command_queue_.front().command_view);
-    log_classic_pairing_command_status(command_queue_.front().command_view, ErrorCode::STATUS_UNKNOWN);
-    waiting_command_ = op_code;
-    command_credits_ = 0;  // Only allow one outstanding command
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Schedule(BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code), kHciTimeoutMs);
-    } else {
-      LOG_WARN("%s sent without an hci-timeout timer", OpCodeText(op_code).c_str());
+    while (command_credits_ > 0 && in_flight_commands_.size() < max_outstanding_commands_ && !command_queue_.empty()) {
+      auto& entry = command_queue_.front();
+      if (entry.command_bytes == nullptr) {
+        entry.command_bytes = std::make_shared<std::vector<uint8_t>>();
+        BitInserter bi(*entry.command_bytes);
+        entry.command->Serialize(bi);
+        auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(entry.command_bytes));
+        ASSERT(cmd_view.IsValid());
+        entry.op_code = cmd_view.GetOpCode();
+        entry.command_view = std::make_unique<CommandView>(std::move(cmd_view));
+      }
+      OpCode op_code = entry.op_code;
+      if (!in_flight_commands_.empty() &&
+          (must_be_sent_alone(op_code) || must_be_sent_alone(in_flight_commands_.front().op_code))) {
+        return;
+      }
+      hal_->sendHciCommand(*entry.command_bytes);
+
+      entry.sent_time = std::chrono::steady_clock::now();
+      entry.deadline = entry.sent_time + kHciTimeoutMs;
+      if (entry.traced) {
+        os::TraceAsyncEnd(kCommandQueuedTrace, entry.trace_id);
+        os::TraceAsyncBegin("HCI " + OpCodeText(op_code), entry.trace_id);
+      }
+      log_link_layer_connection_command(entry.command_view);
+      log_classic_pairing_command_status(entry.command_view, ErrorCode::STATUS_UNKNOWN);
+      in_flight_commands_.splice(in_flight_commands_.end(), command_queue_, command_queue_.begin());
+      command_credits_--;
+      if (hci_timeout_alarm_ == nullptr) {
+        LOG_WARN("%s sent without an hci-timeout timer", OpCodeText(op_code).c_str());
+      } else if (in_flight_commands_.size() == 1) {
+        schedule_hci_timeout();
+      }
     }
   }
 
@@ -275,22 +412,22 @@ struct HciLayer::impl {
         "Can not register handler for %02hhx (%s)",
         EventCode::LE_META_EVENT,
         EventCodeText(EventCode::LE_META_EVENT).c_str());
-    ASSERT_LOG(event_handlers_.count(event) == 0, "Can not register a second handler for %02hhx (%s)", event,
-               EventCodeText(event).c_str());
-    event_handlers_[event] = handler;
+    ASSERT_LOG(event_handlers_[static_cast<uint8_t>(event)].IsEmpty(),
+               "Can not register a second handler for %02hhx (%s)", event, EventCodeText(event).c_str());
+    event_handlers_[static_cast<uint8_t>(event)] = handler;
   }
 
   void unregister_event(EventCode event) {
-    event_handlers_.erase(event);
+    event_handlers_[static_cast<uint8_t>(event)] = ContextualCallback<void(EventView)>();
   }
 
   void register_le_meta_event(ContextualCallback<void(EventView)> handler) {
     ASSERT_LOG(
-        event_handlers_.count(EventCode::LE_META_EVENT) == 0,
+        event_handlers_[static_cast<uint8_t>(EventCode::LE_META_EVENT)].IsEmpty(),
         "Can not register a second handler for %02hhx (%s)",
         EventCode::LE_META_EVENT,
         EventCodeText(EventCode::LE_META_EVENT).c_str());
-    event_handlers_[EventCode::LE_META_EVENT] = handler;
+    event_handlers_[static_cast<uint8_t>(EventCode::LE_META_EVENT)] = handler;
   }
 
   void unregister_le_meta_event() {
@@ -298,13 +435,13 @@ struct HciLayer::impl {
   }
 
   void register_le_event(SubeventCode event, ContextualCallback<void(LeMetaEventView)> handler) {
-    ASSERT_LOG(subevent_handlers_.count(event) == 0, "Can not register a second handler for %02hhx (%s)", event,
-               SubeventCodeText(event).c_str());
-    subevent_handlers_[event] = handler;
+    ASSERT_LOG(subevent_handlers_[static_cast<uint8_t>(event)].IsEmpty(),
+               "Can not register a second handler for %02hhx (%s)", event, SubeventCodeText(event).c_str());
+    subevent_handlers_[static_cast<uint8_t>(event)] = handler;
   }
 
   void unregister_le_event(SubeventCode event) {
-    subevent_handlers_.erase(subevent_handlers_.find(event));
+    subevent_handlers_[static_cast<uint8_t>(event)] = ContextualCallback<void(LeMetaEventView)>();
   }
 
   static void abort_after_root_inflammation(uint8_t vse_error) {
@@ -331,7 +468,8 @@ struct HciLayer::impl {
 
   void on_hci_event(EventView event) {
     ASSERT(event.IsValid());
-    if (command_queue_.empty()) {
+    event_counters_.Received(static_cast<uint8_t>(event.GetEventCode()));
+    if (in_flight_commands_.empty()) {
       auto event_code = event.GetEventCode();
       // BT Core spec 5.2 (Volume 4, Part E section 4.4) allows anytime
       // COMMAND_COMPLETE and COMMAND_STATUS with opcode 0x0 for flow control
@@ -356,7 +494,8 @@ struct HciLayer::impl {
       std::unique_ptr<CommandView> no_waiting_command{nullptr};
       log_hci_event(no_waiting_command, event, module_.GetDependency<storage::StorageModule>());
     } else {
-      log_hci_event(command_queue_.front().command_view, event, module_.GetDependency<storage::StorageModule>());
+      log_hci_event(
+          in_flight_command_for(event).command_view, event, module_.GetDependency<storage::StorageModule>());
     }
     EventCode event_code = event.GetEventCode();
     // Root Inflamation is a special case, since it aborts here
@@ -367,39 +506,82 @@ struct HciLayer::impl {
         auto bqr_event = BqrEventView::Create(view);
         auto inflammation = BqrRootInflammationEventView::Create(bqr_event);
         if (bqr_event.IsValid() && inflammation.IsValid()) {
+          event_counters_.Handled(static_cast<uint8_t>(event_code));
           handle_root_inflammation(inflammation.GetVendorSpecificErrorCode());
           return;
         }
       }
     }
-    if (event_handlers_.find(event_code) == event_handlers_.end()) {
+    auto& handler = event_handlers_[static_cast<uint8_t>(event_code)];
+    if (handler.IsEmpty()) {
+      event_counters_.Dropped(static_cast<uint8_t>(event_code));
       LOG_WARN("Unhandled event of type 0x%02hhx (%s)", event_code, EventCodeText(event_code).c_str());
       return;
     }
-    event_handlers_[event_code].Invoke(event);
+    event_counters_.Handled(static_cast<uint8_t>(event_code));
+    handler.Invoke(event);
+  }
+
+  // The command an event answers, or the oldest command in flight for any other event
+  CommandQueueEntry& in_flight_command_for(EventView event) {
+    OpCode op_code = OpCode::NONE;
+    if (event.GetEventCode() == EventCode::COMMAND_COMPLETE) {
+      auto view = CommandCompleteView::Create(event);
+      op_code = view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+    } else if (event.GetEventCode() == EventCode::COMMAND_STATUS) {
+      auto view = CommandStatusView::Create(event);
+      op_code = view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+    }
+    auto entry = find_in_flight_command(op_code);
+    return entry == in_flight_commands_.end() ? in_flight_commands_.front() : *entry;
   }
 
   void on_le_meta_event(EventView event) {
     LeMetaEventView meta_event_view = LeMetaEventView::Create(event);
     ASSERT(meta_event_view.IsValid());
     SubeventCode subevent_code = meta_event_view.GetSubeventCode();
-    if (subevent_handlers_.find(subevent_code) == subevent_handlers_.end()) {
+    subevent_counters_.Received(static_cast<uint8_t>(subevent_code));
+    auto& handler = subevent_handlers_[static_cast<uint8_t>(subevent_code)];
+    if (handler.IsEmpty()) {
+      subevent_counters_.Dropped(static_cast<uint8_t>(subevent_code));
       LOG_WARN("Unhandled le subevent of type 0x%02hhx (%s)", subevent_code, SubeventCodeText(subevent_code).c_str());
       return;
     }
-    subevent_handlers_[subevent_code].Invoke(meta_event_view);
+    subevent_counters_.Handled(static_cast<uint8_t>(subevent_code));
+    handler.Invoke(meta_event_view);
+  }
+
+  flatbuffers::Offset<HciLayerData> Dump(flatbuffers::FlatBufferBuilder* fb_builder) const {
+    auto title = fb_builder->CreateString("----- Hci Layer Dumpsys -----");
+    auto event_counters =
+        event_counters_.Dump(fb_builder, [](uint8_t code) { return EventCodeText(static_cast<EventCode>(code)); });
+    auto le_subevent_counters = subevent_counters_.Dump(
+        fb_builder, [](uint8_t code) { return SubeventCodeText(static_cast<SubeventCode>(code)); });
+
+    HciLayerDataBuilder builder(*fb_builder);
+    builder.add_title(title);
+    builder.add_event_counters(event_counters);
+    builder.add_le_subevent_counters(le_subevent_counters);
+    return builder.Finish();
   }
 
   hal::HciHal* hal_;
   HciLayer& module_;
 
   // Command Handling
+  // Commands waiting to be sent, and commands sent to the controller waiting for their response, in sending order
   std::list<CommandQueueEntry> command_queue_;
-
-  std::map<EventCode, ContextualCallback<void(EventView)>> event_handlers_;
-  std::map<SubeventCode, ContextualCallback<void(LeMetaEventView)>> subevent_handlers_;
-  OpCode waiting_command_{OpCode::NONE};
+  std::list<CommandQueueEntry> in_flight_commands_;
+  std::unordered_map<OpCode, metrics::LatencyHistogram*> command_latencies_;
+
+  // Indexed by event code and LE subevent code; an empty callback means no handler is registered
+  std::array<ContextualCallback<void(EventView)>, EventCounters::kNumCodes> event_handlers_{};
+  std::array<ContextualCallback<void(LeMetaEventView)>, EventCounters::kNumCodes> subevent_handlers_{};
+  EventCounters event_counters_;
+  EventCounters subevent_counters_;
   uint8_t command_credits_{1};  // Send reset first
+  size_t max_outstanding_commands_{1};
+  uint32_t next_command_trace_id_{0};
   Alarm* hci_timeout_alarm_{nullptr};
   Alarm* hci_abort_alarm_{nullptr};
 
@@ -625,6 +807,18 @@ LeIsoInterface* HciLayer::GetLeIsoInterface(ContextualCallback<void(LeMetaEventV
 
 const ModuleFactory HciLayer::Factory = ModuleFactory([]() { return new HciLayer(); });
 
+DumpsysDataFinisher HciLayer::GetDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) const {
+  ASSERT(fb_builder != nullptr);
+  if (impl_ == nullptr) {
+    return Module::GetDumpsysData(fb_builder);
+  }
+
+  auto dumpsys_data = impl_->Dump(fb_builder);
+  return [dumpsys_data](DumpsysDataBuilder* dumpsys_builder) {
+    dumpsys_builder->add_hci_layer_dumpsys_data(dumpsys_data);
+  };
+}
+
 void HciLayer::ListDependencies(ModuleList* list) const {
   list->add<hal::HciHal>();
   list->add<storage::StorageModule>();
@@ -113,6 +113,8 @@ class HciLayer : public Module, public CommandInterface<CommandBuilder> {
 
   void Stop() override;
 
+  DumpsysDataFinisher GetDumpsysData(flatbuffers::FlatBufferBuilder* builder) const override;  // Module
+
   virtual void Disconnect(uint16_t handle, ErrorCode reason);
   virtual void ReadRemoteVersion(
       hci::ErrorCode hci_status, uint16_t handle, uint8_t version, uint16_t manufacturer_name, uint16_t sub_version);
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "common/bind.h"
+#include "hal/hci_hal.h"
+#include "hci/hci_layer.h"
+#include "hci/hci_packets.h"
+#include "module.h"
+#include "os/handler.h"
+#include "os/system_properties.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+using ::bluetooth::ModuleList;
+using ::bluetooth::TestModuleRegistry;
+using ::bluetooth::hci::CommandBuilder;
+using ::bluetooth::hci::CommandCompleteBuilder;
+using ::bluetooth::hci::CommandCompleteView;
+using ::bluetooth::hci::CommandView;
+using ::bluetooth::hci::HciLayer;
+using ::bluetooth::hci::OpCode;
+using ::bluetooth::os::Handler;
+using ::bluetooth::os::Thread;
+
+namespace {
+
+constexpr char kMaxOutstandingCommandsProperty[] = "bluetooth.hci.max_outstanding_commands";
+// Round trip of a command through the transport and the controller
+constexpr std::chrono::microseconds kControllerLatency = std::chrono::microseconds(500);
+constexpr uint8_t kControllerCredits = 8;
+
+// Controller which answers every command with a Command Complete, kControllerLatency after receiving it
+class FakeControllerHal : public bluetooth::hal::HciHal {
+ public:
+  void registerIncomingPacketCallback(bluetooth::hal::HciHalCallbacks* callbacks) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_ = callbacks;
+  }
+
+  void unregisterIncomingPacketCallback() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_ = nullptr;
+  }
+
+  void sendHciCommand(bluetooth::hal::HciPacket command) override {
+    auto view = CommandView::Create(
+        bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(
+            std::make_shared<std::vector<uint8_t>>(std::move(command))));
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back({std::chrono::steady_clock::now() + kControllerLatency, view.GetOpCode()});
+    pending_changed_.notify_one();
+  }
+
+  void sendAclData(bluetooth::hal::HciPacket) override {}
+  void sendScoData(bluetooth::hal::HciPacket) override {}
+  void sendIsoData(bluetooth::hal::HciPacket) override {}
+
+  std::string ToString() const override {
+    return "FakeControllerHal";
+  }
+
+ protected:
+  void ListDependencies(ModuleList*) const override {}
+
+  void Start() override {
+    running_ = true;
+    controller_ = std::thread(&FakeControllerHal::run, this);
+  }
+
+  void Stop() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+      pending_changed_.notify_one();
+    }
+    controller_.join();
+  }
+
+ private:
+  struct PendingResponse {
+    std::chrono::steady_clock::time_point time;
+    OpCode op_code;
+  };
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+      if (pending_.empty()) {
+        pending_changed_.wait(lock);
+        continue;
+      }
+      auto response = pending_.front();
+      if (std::chrono::steady_clock::now() < response.time) {
+        pending_changed_.wait_until(lock, response.time);
+        continue;
+      }
+      pending_.pop_front();
+      // Every command of the benchmark answers with a single status byte
+      auto payload = std::make_unique<bluetooth::packet::RawBuilder>();
+      payload->AddOctets1(static_cast<uint8_t>(bluetooth::hci::ErrorCode::SUCCESS));
+      auto event = CommandCompleteBuilder::Create(kControllerCredits, response.op_code, std::move(payload));
+      std::vector<uint8_t> bytes;
+      bluetooth::packet::BitInserter bi(bytes);
+      event->Serialize(bi);
+      if (callbacks_ != nullptr) {
+        callbacks_->hciEventReceived(bytes);
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable pending_changed_;
+  std::deque<PendingResponse> pending_;
+  bluetooth::hal::HciHalCallbacks* callbacks_ = nullptr;
+  bool running_ = false;
+  std::thread controller_;
+};
+
+std::unique_ptr<CommandBuilder> startup_command(int index) {
+  switch (index % 8) {
+    case 0:
+      return bluetooth::hci::ReadLocalVersionInformationBuilder::Create();
+    case 1:
+      return bluetooth::hci::ReadLocalSupportedCommandsBuilder::Create();
+    case 2:
+      return bluetooth::hci::ReadLocalSupportedFeaturesBuilder::Create();
+    case 3:
+      return bluetooth::hci::ReadBufferSizeBuilder::Create();
+    case 4:
+      return bluetooth::hci::ReadBdAddrBuilder::Create();
+    case 5:
+      return bluetooth::hci::LeReadBufferSizeV1Builder::Create();
+    case 6:
+      return bluetooth::hci::LeReadLocalSupportedFeaturesBuilder::Create();
+    default:
+      return bluetooth::hci::LeReadSupportedStatesBuilder::Create();
+  }
+}
+
+// Send the burst of independent commands the stack issues while starting up, at different pipelining depths. Compare
+// the time per iteration of depth 1, which waits for each response before sending the next command, with the others.
+class BM_HciLayerCommands : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    bluetooth::os::SetSystemProperty(kMaxOutstandingCommandsProperty, std::to_string(st.range(0)));
+    registry_ = std::make_unique<TestModuleRegistry>();
+    registry_->InjectTestModule(&bluetooth::hal::HciHal::Factory, new FakeControllerHal());
+    registry_->Start<HciLayer>(&registry_->GetTestThread());
+    hci_ = registry_->GetModuleUnderTest<HciLayer>();
+    thread_ = std::make_unique<Thread>("BM_HciLayerCommands thread", Thread::Priority::NORMAL);
+    handler_ = std::make_unique<Handler>(thread_.get());
+    // Wait for the reset sent by HciLayer::Start()
+    SendCommands(1);
+  }
+
+  void TearDown(State& st) override {
+    handler_->Clear();
+    handler_->WaitUntilStopped(std::chrono::milliseconds(2000));
+    handler_ = nullptr;
+    thread_->Stop();
+    thread_ = nullptr;
+    registry_->StopAll();
+    registry_ = nullptr;
+    bluetooth::os::ClearSystemPropertiesForHost();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void on_complete(CommandCompleteView) {
+    if (++completed_ == expected_) {
+      done_promise_.set_value();
+    }
+  }
+
+  void SendCommands(int num_commands) {
+    completed_ = 0;
+    expected_ = num_commands;
+    done_promise_ = std::promise<void>();
+    auto done = done_promise_.get_future();
+    for (int i = 0; i < num_commands; i++) {
+      hci_->EnqueueCommand(startup_command(i), handler_->BindOnceOn(this, &BM_HciLayerCommands::on_complete));
+    }
+    done.wait();
+  }
+
+  std::unique_ptr<TestModuleRegistry> registry_;
+  HciLayer* hci_ = nullptr;
+  std::unique_ptr<Thread> thread_;
+  std::unique_ptr<Handler> handler_;
+  int completed_ = 0;
+  int expected_ = 0;
+  std::promise<void> done_promise_;
+};
+
+BENCHMARK_DEFINE_F(BM_HciLayerCommands, send_startup_commands)(State& state) {
+  for (auto _ : state) {
+    SendCommands(state.range(1));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+BENCHMARK_REGISTER_F(BM_HciLayerCommands, send_startup_commands)
+    ->Args({1, 40})
+    ->Args({2, 40})
+    ->Args({4, 40})
+    ->Args({8, 40})
+    ->UseRealTime();
+
+}  // namespace
@@ -622,6 +622,64 @@ TEST_F(HciTest, creditsTest) {
       ReadLocalSupportedFeaturesCompleteView::Create(CommandCompleteView::Create(EventView::Create(event))).IsValid());
 }
 
+TEST_F(HciTest, pipelinedCommandsTest) {
+  ASSERT_EQ(0u, hal->GetNumSentCommands());
+
+  // Let the controller accept three commands at once
+  uint8_t num_packets = 3;
+  hal->callbacks->hciEventReceived(GetPacketBytes(NoCommandCompleteBuilder::Create(num_packets)));
+
+  upper->SendHciCommandExpectingComplete(ReadLocalVersionInformationBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalSupportedCommandsBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalSupportedFeaturesBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadBufferSizeBuilder::Create());
+  ASSERT_TRUE(fake_registry_.SynchronizeModuleHandler(&HciLayer::Factory, kTimeout));
+
+  // Verify that the first three are sent without waiting for their responses
+  ASSERT_EQ(3u, hal->GetNumSentCommands());
+  ASSERT_TRUE(ReadLocalVersionInformationView::Create(hal->GetSentCommand()).IsValid());
+  ASSERT_TRUE(ReadLocalSupportedCommandsView::Create(hal->GetSentCommand()).IsValid());
+  ASSERT_TRUE(ReadLocalSupportedFeaturesView::Create(hal->GetSentCommand()).IsValid());
+
+  // Answer the last one first, and return a single credit
+  auto event_future = upper->GetReceivedEventFuture();
+  auto command_future = hal->GetSentCommandFuture();
+  num_packets = 1;
+  ErrorCode error_code = ErrorCode::SUCCESS;
+  uint64_t lmp_features = 0x012345678abcdef;
+  hal->callbacks->hciEventReceived(
+      GetPacketBytes(ReadLocalSupportedFeaturesCompleteBuilder::Create(num_packets, error_code, lmp_features)));
+
+  // The response is matched by opcode to the third command
+  auto event_status = event_future.wait_for(kTimeout);
+  ASSERT_EQ(event_status, std::future_status::ready);
+  auto event = upper->GetReceivedEvent();
+  ASSERT_TRUE(
+      ReadLocalSupportedFeaturesCompleteView::Create(CommandCompleteView::Create(EventView::Create(event))).IsValid());
+
+  // Verify that the credit is used for the fourth one
+  auto command_sent_status = command_future.wait_for(kTimeout);
+  ASSERT_EQ(command_sent_status, std::future_status::ready);
+  ASSERT_EQ(1u, hal->GetNumSentCommands());
+  ASSERT_TRUE(ReadBufferSizeView::Create(hal->GetSentCommand()).IsValid());
+
+  // Answer the first one
+  event_future = upper->GetReceivedEventFuture();
+  LocalVersionInformation local_version_information;
+  local_version_information.hci_version_ = HciVersion::V_5_0;
+  local_version_information.hci_revision_ = 0x1234;
+  local_version_information.lmp_version_ = LmpVersion::V_4_2;
+  local_version_information.manufacturer_name_ = 0xBAD;
+  local_version_information.lmp_subversion_ = 0x5678;
+  hal->callbacks->hciEventReceived(GetPacketBytes(
+      ReadLocalVersionInformationCompleteBuilder::Create(num_packets, error_code, local_version_information)));
+  event_status = event_future.wait_for(kTimeout);
+  ASSERT_EQ(event_status, std::future_status::ready);
+  event = upper->GetReceivedEvent();
+  ASSERT_TRUE(
+      ReadLocalVersionInformationCompleteView::Create(CommandCompleteView::Create(EventView::Create(event))).IsValid());
+}
+
 TEST_F(HciTest, leSecurityInterfaceTest) {
   // Send LeRand to the controller
   auto command_future = hal->GetSentCommandFuture();
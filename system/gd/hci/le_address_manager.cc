@@ -16,6 +16,8 @@
 
 #include "hci/le_address_manager.h"
 
+#include <algorithm>
+
 #include "common/init_flags.h"
 #include "os/log.h"
 #include "os/rand.h"
@@ -233,6 +235,9 @@ void LeAddressManager::pause_registered_clients() {
         break;
       case WAITING_FOR_RESUME:
       case RESUMED:
+        if (!pause_window_start_) {
+          pause_window_start_ = std::chrono::steady_clock::now();
+        }
         client.second = ClientState::WAITING_FOR_PAUSE;
         client.first->OnPause();
         break;
@@ -284,12 +289,33 @@ void LeAddressManager::resume_registered_clients() {
   }
 
   LOG_INFO("Resuming registered clients");
+  close_pause_window();
   for (auto& client : registered_clients_) {
     client.second = ClientState::WAITING_FOR_RESUME;
     client.first->OnResume();
   }
 }
 
+void LeAddressManager::close_pause_window() {
+  if (!pause_window_start_) {
+    return;
+  }
+  auto duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - *pause_window_start_);
+  pause_window_start_.reset();
+  LOG_DEBUG("Clients were paused for %lld us", static_cast<long long>(duration.count()));
+  std::lock_guard<std::mutex> lock(pause_window_stats_mutex_);
+  pause_window_stats_.count++;
+  pause_window_stats_.total += duration;
+  pause_window_stats_.max = std::max(pause_window_stats_.max, duration);
+  pause_window_stats_.last = duration;
+}
+
+LeAddressManager::PauseWindowStats LeAddressManager::GetPauseWindowStats() const {
+  std::lock_guard<std::mutex> lock(pause_window_stats_mutex_);
+  return pause_window_stats_;
+}
+
 void LeAddressManager::ack_resume(LeAddressManagerCallback* callback) {
   if (registered_clients_.find(callback) != registered_clients_.end()) {
     registered_clients_.find(callback)->second = ClientState::RESUMED;
@@ -549,6 +575,92 @@ void LeAddressManager::ClearResolvingList() {
   handler_->BindOnceOn(this, &LeAddressManager::pause_registered_clients).Invoke();
 }
 
+void LeAddressManager::ApplyListUpdate(ListUpdate update) {
+  handler_->BindOnceOn(this, &LeAddressManager::apply_list_update, std::move(update)).Invoke();
+}
+
+void LeAddressManager::apply_list_update(ListUpdate update) {
+  if (update.IsEmpty()) {
+    return;
+  }
+  // Address resolution is disabled once around all the resolving list changes, instead of around each of them
+  if (update.changes_resolving_list_) {
+    auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
+    cached_commands_.push({CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(disable_builder)}});
+  }
+  for (auto& command : update.commands_) {
+    cached_commands_.push(std::move(command));
+  }
+  if (supports_ble_privacy_) {
+    for (const auto& [peer_identity_address_type, peer_identity_address] : update.privacy_mode_devices_) {
+      auto packet_builder =
+          hci::LeSetPrivacyModeBuilder::Create(peer_identity_address_type, peer_identity_address, PrivacyMode::DEVICE);
+      cached_commands_.push({CommandType::LE_SET_PRIVACY_MODE, HCICommand{std::move(packet_builder)}});
+    }
+  }
+  if (update.changes_resolving_list_) {
+    auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
+    cached_commands_.push({CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(enable_builder)}});
+  }
+  LOG_INFO("Applying a list update of %zu commands", update.commands_.size());
+
+  if (registered_clients_.empty()) {
+    handle_next_command();
+  } else {
+    pause_registered_clients();
+  }
+}
+
+void LeAddressManager::ListUpdate::AddDeviceToFilterAcceptList(
+    FilterAcceptListAddressType connect_list_address_type, Address address) {
+  auto packet_builder = hci::LeAddDeviceToFilterAcceptListBuilder::Create(connect_list_address_type, address);
+  commands_.push_back({CommandType::ADD_DEVICE_TO_CONNECT_LIST, HCICommand{std::move(packet_builder)}});
+}
+
+void LeAddressManager::ListUpdate::RemoveDeviceFromFilterAcceptList(
+    FilterAcceptListAddressType connect_list_address_type, Address address) {
+  auto packet_builder = hci::LeRemoveDeviceFromFilterAcceptListBuilder::Create(connect_list_address_type, address);
+  commands_.push_back({CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST, HCICommand{std::move(packet_builder)}});
+}
+
+void LeAddressManager::ListUpdate::ClearFilterAcceptList() {
+  auto packet_builder = hci::LeClearFilterAcceptListBuilder::Create();
+  commands_.push_back({CommandType::CLEAR_CONNECT_LIST, HCICommand{std::move(packet_builder)}});
+}
+
+void LeAddressManager::ListUpdate::AddDeviceToResolvingList(
+    PeerAddressType peer_identity_address_type,
+    Address peer_identity_address,
+    const std::array<uint8_t, 16>& peer_irk,
+    const std::array<uint8_t, 16>& local_irk) {
+  auto packet_builder = hci::LeAddDeviceToResolvingListBuilder::Create(
+      peer_identity_address_type, peer_identity_address, peer_irk, local_irk);
+  commands_.push_back({CommandType::ADD_DEVICE_TO_RESOLVING_LIST, HCICommand{std::move(packet_builder)}});
+  privacy_mode_devices_.emplace_back(peer_identity_address_type, peer_identity_address);
+  changes_resolving_list_ = true;
+}
+
+void LeAddressManager::ListUpdate::RemoveDeviceFromResolvingList(
+    PeerAddressType peer_identity_address_type, Address peer_identity_address) {
+  auto packet_builder =
+      hci::LeRemoveDeviceFromResolvingListBuilder::Create(peer_identity_address_type, peer_identity_address);
+  commands_.push_back({CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST, HCICommand{std::move(packet_builder)}});
+  privacy_mode_devices_.erase(
+      std::remove(
+          privacy_mode_devices_.begin(),
+          privacy_mode_devices_.end(),
+          std::make_pair(peer_identity_address_type, peer_identity_address)),
+      privacy_mode_devices_.end());
+  changes_resolving_list_ = true;
+}
+
+void LeAddressManager::ListUpdate::ClearResolvingList() {
+  auto packet_builder = hci::LeClearResolvingListBuilder::Create();
+  commands_.push_back({CommandType::CLEAR_RESOLVING_LIST, HCICommand{std::move(packet_builder)}});
+  privacy_mode_devices_.clear();
+  changes_resolving_list_ = true;
+}
+
 template <class View>
 void LeAddressManager::on_command_complete(CommandCompleteView view) {
   auto op_code = view.GetCommandOpCode();
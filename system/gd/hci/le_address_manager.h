@@ -15,10 +15,13 @@
  */
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <variant>
+#include <vector>
 
 #include "common/callback.h"
 #include "hci/address_with_type.h"
@@ -93,6 +96,20 @@ class LeAddressManager {
   void RemoveDeviceFromResolvingList(PeerAddressType peer_identity_address_type, Address peer_identity_address);
   void ClearFilterAcceptList();
   void ClearResolvingList();
+
+  // Apply a batch of filter accept list and resolving list changes in a single pause window
+  class ListUpdate;
+  void ApplyListUpdate(ListUpdate update);
+
+  struct PauseWindowStats {
+    uint64_t count = 0;
+    std::chrono::microseconds total{0};
+    std::chrono::microseconds max{0};
+    std::chrono::microseconds last{0};
+  };
+  // How long the registered clients stayed paused, over every window since construction
+  PauseWindowStats GetPauseWindowStats() const;
+
   void OnCommandComplete(CommandCompleteView view);
   std::chrono::milliseconds GetNextPrivateAddressIntervalMs();
 
@@ -155,6 +172,8 @@ class LeAddressManager {
   hci::Address generate_rpa();
   hci::Address generate_nrpa();
   void handle_next_command();
+  void apply_list_update(ListUpdate update);
+  void close_pause_window();
   void check_cached_commands();
   template <class View>
   void on_command_complete(CommandCompleteView view);
@@ -175,6 +194,35 @@ class LeAddressManager {
   uint8_t resolving_list_size_;
   std::queue<Command> cached_commands_;
   bool supports_ble_privacy_{false};
+
+  std::optional<std::chrono::steady_clock::time_point> pause_window_start_;
+  mutable std::mutex pause_window_stats_mutex_;
+  PauseWindowStats pause_window_stats_;
+};
+
+class LeAddressManager::ListUpdate {
+ public:
+  void AddDeviceToFilterAcceptList(FilterAcceptListAddressType connect_list_address_type, Address address);
+  void RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType connect_list_address_type, Address address);
+  void ClearFilterAcceptList();
+  void AddDeviceToResolvingList(
+      PeerAddressType peer_identity_address_type,
+      Address peer_identity_address,
+      const std::array<uint8_t, 16>& peer_irk,
+      const std::array<uint8_t, 16>& local_irk);
+  void RemoveDeviceFromResolvingList(PeerAddressType peer_identity_address_type, Address peer_identity_address);
+  void ClearResolvingList();
+
+  bool IsEmpty() const {
+    return commands_.empty();
+  }
+
+ private:
+  friend class LeAddressManager;
+  std::vector<Command> commands_;
+  // Devices added to the resolving list, which need the device privacy mode when the controller supports it
+  std::vector<std::pair<PeerAddressType, Address>> privacy_mode_devices_;
+  bool changes_resolving_list_ = false;
 };
 
 }  // namespace hci
@@ -390,6 +390,45 @@ TEST_F(LeAddressManagerWithSingleClientTest, clear_connect_list) {
   clients[0].get()->WaitForResume();
 }
 
+TEST_F(LeAddressManagerWithSingleClientTest, apply_list_update_in_one_pause_window) {
+  Address first_address;
+  Address::FromString("01:02:03:04:05:06", first_address);
+  Address second_address;
+  Address::FromString("01:02:03:04:05:07", second_address);
+  clients[0].get()->WaitForResume();
+  sync_handler(handler_);
+  auto pause_windows_before = le_address_manager_->GetPauseWindowStats().count;
+
+  LeAddressManager::ListUpdate update;
+  ASSERT_TRUE(update.IsEmpty());
+  update.AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, first_address);
+  update.AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, second_address);
+  update.RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::RANDOM, first_address);
+  ASSERT_FALSE(update.IsEmpty());
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  le_address_manager_->ApplyListUpdate(std::move(update));
+
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  auto packet = test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  auto packet_view = LeAddDeviceToFilterAcceptListView::Create(
+      LeConnectionManagementCommandView::Create(AclCommandView::Create(packet)));
+  ASSERT_TRUE(packet_view.IsValid());
+  ASSERT_EQ(second_address, packet_view.GetAddress());
+  // The client stays paused between the commands of the update
+  ASSERT_TRUE(clients[0]->paused);
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  test_hci_layer_->GetCommand(OpCode::LE_REMOVE_DEVICE_FROM_FILTER_ACCEPT_LIST);
+  ASSERT_TRUE(clients[0]->paused);
+  test_hci_layer_->IncomingEvent(LeRemoveDeviceFromFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+  sync_handler(handler_);
+
+  ASSERT_EQ(pause_windows_before + 1, le_address_manager_->GetPauseWindowStats().count);
+}
+
 // b/260916288
 TEST_F(LeAddressManagerWithSingleClientTest, DISABLED_add_device_to_resolving_list) {
   Address address;
@@ -15,8 +15,11 @@
  */
 #include "hci/le_advertising_manager.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <tuple>
 
 #include "common/init_flags.h"
 #include "hci/acl_manager.h"
@@ -37,6 +40,15 @@ const ModuleFactory LeAdvertisingManager::Factory = ModuleFactory([]() { return
 constexpr int kIdLocal = 0xff;  // Id for advertiser not register from Java layer
 constexpr uint16_t kLenOfFlags = 0x03;
 
+// Time slicing of more extended advertisers than the controller has advertising sets
+constexpr char kMultiplexerEnabledProperty[] = "bluetooth.le.adv_multiplexer.enabled";
+constexpr char kMultiplexerSliceProperty[] = "bluetooth.le.adv_multiplexer.slice_ms";
+constexpr uint32_t kDefaultMultiplexerSliceMs = 1000;
+// The SID of a set is derived from its id, keep them distinct
+constexpr size_t kMaxMultiplexedAdvertisers = LeAdvertisingManager::kAdvertisingSetIdMask;
+// A slice lasts at least this many advertising events of the resident advertisers
+constexpr uint32_t kMinAdvertisingEventsPerSlice = 4;
+
 enum class AdvertisingApiType {
   LEGACY = 1,
   ANDROID_HCI = 2,
@@ -66,8 +78,77 @@ struct Advertiser {
   bool directed = false;
   bool in_use = false;
   std::unique_ptr<os::Alarm> address_rotation_alarm;
+  // State last programmed into the controller, to skip updates which change nothing
+  std::optional<ExtendedAdvertisingConfig> programmed_parameters;
+  std::optional<std::vector<uint8_t>> programmed_advertisement;
+  std::optional<std::vector<uint8_t>> programmed_scan_response;
+  std::optional<PeriodicAdvertisingParameters> programmed_periodic_parameters;
+  std::optional<std::vector<uint8_t>> programmed_periodic_data;
+  // Time slicing state, when the multiplexer is enabled. An advertiser which is not resident has no advertising set in
+  // the controller, and is programmed again from the multiplexed_* fields at its next slice.
+  bool resident = false;
+  bool wants_enable = false;
+  bool periodic_enabled = false;
+  bool reprogramming = false;
+  std::optional<ExtendedAdvertisingConfig> multiplexed_parameters;
+  std::optional<std::vector<GapData>> multiplexed_advertisement;
+  std::optional<std::vector<GapData>> multiplexed_scan_response;
+  std::optional<PeriodicAdvertisingParameters> multiplexed_periodic_parameters;
+  std::optional<std::vector<GapData>> multiplexed_periodic_data;
+  std::chrono::steady_clock::time_point resident_since;
+  std::chrono::milliseconds airtime{0};
+  uint32_t slices = 0;
+
+  void forget_programmed_state() {
+    programmed_parameters.reset();
+    programmed_advertisement.reset();
+    programmed_scan_response.reset();
+    programmed_periodic_parameters.reset();
+    programmed_periodic_data.reset();
+  }
 };
 
+// Compare the fields of two configs which end up in the advertising parameters command
+static bool same_advertising_parameters(const ExtendedAdvertisingConfig& a, const ExtendedAdvertisingConfig& b) {
+  auto fields = [](const ExtendedAdvertisingConfig& c) {
+    return std::tie(
+        c.interval_min,
+        c.interval_max,
+        c.advertising_type,
+        c.own_address_type,
+        c.peer_address_type,
+        c.peer_address,
+        c.channel_map,
+        c.filter_policy,
+        c.tx_power,
+        c.connectable,
+        c.scannable,
+        c.directed,
+        c.high_duty_directed_connectable,
+        c.legacy_pdus,
+        c.anonymous,
+        c.include_tx_power,
+        c.use_le_coded_phy,
+        c.secondary_max_skip,
+        c.secondary_advertising_phy,
+        c.enable_scan_request_notifications);
+  };
+  return fields(a) == fields(b);
+}
+
+static bool same_periodic_parameters(const PeriodicAdvertisingParameters& a, const PeriodicAdvertisingParameters& b) {
+  return a.min_interval == b.min_interval && a.max_interval == b.max_interval && a.properties == b.properties;
+}
+
+static std::vector<uint8_t> serialize_gap_data(const std::vector<GapData>& data) {
+  std::vector<uint8_t> bytes;
+  packet::BitInserter it(bytes);
+  for (const auto& gap_data : data) {
+    gap_data.Serialize(it);
+  }
+  return bytes;
+}
+
 ExtendedAdvertisingConfig::ExtendedAdvertisingConfig(const AdvertisingConfig& config) : AdvertisingConfig(config) {
   switch (config.advertising_type) {
     case AdvertisingType::ADV_IND:
@@ -143,7 +224,17 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             handler->BindOnceOn(this, &impl::on_read_advertising_physical_channel_tx_power));
       }
     }
-    enabled_sets_ = std::vector<EnabledSet>(num_instances_);
+
+    max_advertisers_ = num_instances_;
+    multiplexer_enabled_ = advertising_api_type_ == AdvertisingApiType::EXTENDED &&
+                           os::GetSystemPropertyBool(kMultiplexerEnabledProperty, false);
+    if (multiplexer_enabled_) {
+      max_advertisers_ = std::max(num_instances_, kMaxMultiplexedAdvertisers);
+      multiplexer_slice_ = std::chrono::milliseconds(
+          os::GetSystemPropertyUint32(kMultiplexerSliceProperty, kDefaultMultiplexerSliceMs));
+      multiplexer_alarm_ = std::make_unique<os::Alarm>(module_handler_);
+    }
+    enabled_sets_ = std::vector<EnabledSet>(max_advertisers_);
     for (size_t i = 0; i < enabled_sets_.size(); i++) {
       enabled_sets_[i].advertising_handle_ = kInvalidHandle;
     }
@@ -265,11 +356,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     AdvertiserId id = advertising_api_type_ == AdvertisingApiType::ANDROID_HCI ? 1 : 0;
     {
       std::unique_lock lock(id_mutex_);
-      while (id < num_instances_ && advertising_sets_.count(id) != 0) {
+      while (id < max_advertisers_ && advertising_sets_.count(id) != 0) {
         id++;
       }
-      if (id == num_instances_) {
-        LOG_WARN("Number of max instances %d reached", (uint16_t)num_instances_);
+      if (id == max_advertisers_) {
+        LOG_WARN("Number of max instances %d reached", (uint16_t)max_advertisers_);
         return kInvalidId;
       }
       advertising_sets_[id].in_use = true;
@@ -283,7 +374,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (advertising_sets_.count(advertiser_id) == 0) {
       return;
     }
-    if (advertising_api_type_ == AdvertisingApiType::EXTENDED) {
+    if (advertising_api_type_ == AdvertisingApiType::EXTENDED && is_resident(advertiser_id)) {
       le_advertising_interface_->EnqueueCommand(
           hci::LeRemoveAdvertisingSetBuilder::Create(advertiser_id),
           module_handler_->BindOnce(impl::check_status<LeRemoveAdvertisingSetCompleteView>));
@@ -299,6 +390,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       address_manager_registered = false;
       paused = false;
     }
+    lock.unlock();
+    if (multiplexer_enabled_) {
+      // Give the set of the controller to a waiting advertiser right away
+      rotate_multiplexed_advertisers();
+    }
   }
 
   void create_advertiser(
@@ -430,8 +526,40 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     advertising_sets_[id].max_extended_advertising_events = max_ext_adv_events;
     advertising_sets_[id].handler = handler;
 
+    if (multiplexer_enabled_ && count_resident_advertisers() < num_instances_) {
+      make_resident(id);
+    }
+    // The state of an advertiser which waits for its slice is only recorded
     set_parameters(id, config);
+    if (is_resident(id)) {
+      set_own_address(id, config);
+    }
+
+    if (config.advertising_type == AdvertisingType::ADV_IND ||
+        config.advertising_type == AdvertisingType::ADV_NONCONN_IND) {
+      set_data(id, true, config.scan_response);
+    }
+    set_data(id, false, config.advertisement);
 
+    if (!config.periodic_data.empty()) {
+      set_periodic_parameter(id, config.periodic_advertising_parameters);
+      set_periodic_data(id, config.periodic_data);
+      enable_periodic_advertising(id, true);
+    }
+
+    if (!paused || !is_resident(id)) {
+      enable_advertiser(id, true, duration, max_ext_adv_events);
+    } else {
+      EnabledSet curr_set;
+      curr_set.advertising_handle_ = id;
+      curr_set.duration_ = duration;
+      curr_set.max_extended_advertising_events_ = max_ext_adv_events;
+      std::vector<EnabledSet> enabled_sets = {curr_set};
+      enabled_sets_[id] = curr_set;
+    }
+  }
+
+  void set_own_address(AdvertiserId id, const ExtendedAdvertisingConfig& config) {
     auto address_policy = le_address_manager_->GetAddressPolicy();
     switch (config.own_address_type) {
       case OwnAddressType::RANDOM_DEVICE_ADDRESS:
@@ -467,28 +595,6 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         // For resolvable address types, set the Peer address and type, and the controller generates the address.
         LOG_ALWAYS_FATAL("Unsupported Advertising Type %s", OwnAddressTypeText(config.own_address_type).c_str());
     }
-    if (config.advertising_type == AdvertisingType::ADV_IND ||
-        config.advertising_type == AdvertisingType::ADV_NONCONN_IND) {
-      set_data(id, true, config.scan_response);
-    }
-    set_data(id, false, config.advertisement);
-
-    if (!config.periodic_data.empty()) {
-      set_periodic_parameter(id, config.periodic_advertising_parameters);
-      set_periodic_data(id, config.periodic_data);
-      enable_periodic_advertising(id, true);
-    }
-
-    if (!paused) {
-      enable_advertiser(id, true, duration, max_ext_adv_events);
-    } else {
-      EnabledSet curr_set;
-      curr_set.advertising_handle_ = id;
-      curr_set.duration_ = duration;
-      curr_set.max_extended_advertising_events_ = max_ext_adv_events;
-      std::vector<EnabledSet> enabled_sets = {curr_set};
-      enabled_sets_[id] = curr_set;
-    }
   }
 
   void stop_advertising(AdvertiserId advertiser_id) {
@@ -496,6 +602,10 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       LOG_INFO("Unknown advertising set %u", advertiser_id);
       return;
     }
+    advertising_sets_[advertiser_id].wants_enable = false;
+    if (!is_resident(advertiser_id)) {
+      return;
+    }
     EnabledSet curr_set;
     curr_set.advertising_handle_ = advertiser_id;
     std::vector<EnabledSet> enabled_vector{curr_set};
@@ -598,6 +708,17 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     advertising_sets_[advertiser_id].tx_power = config.tx_power;
     advertising_sets_[advertiser_id].directed = config.directed;
 
+    if (multiplexer_enabled_) {
+      advertising_sets_[advertiser_id].multiplexed_parameters = config;
+      if (!is_resident(advertiser_id)) {
+        if (notify_multiplexed(advertiser_id)) {
+          advertising_callbacks_->OnAdvertisingParametersUpdated(
+              advertiser_id, config.tx_power, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        }
+        return;
+      }
+    }
+
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
         le_advertising_interface_->EnqueueCommand(
@@ -706,6 +827,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         }
       } break;
     }
+    advertising_sets_[advertiser_id].programmed_parameters = config;
   }
 
   bool data_has_flags(std::vector<GapData> data) {
@@ -767,7 +889,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     return true;
   };
 
-  void set_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data) {
+  // Add the Flags and fill the TX Power of data as they will be sent to the controller
+  std::vector<GapData> complete_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data) {
     // The Flags data type shall be included when any of the Flag bits are non-zero and the advertising packet
     // is connectable.
     if (!set_scan_rsp && advertising_sets_[advertiser_id].connectable && !data_has_flags(data)) {
@@ -788,6 +911,29 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         break;
       }
     }
+    return data;
+  }
+
+  void set_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data) {
+    if (multiplexer_enabled_) {
+      auto& multiplexed = set_scan_rsp ? advertising_sets_[advertiser_id].multiplexed_scan_response
+                                       : advertising_sets_[advertiser_id].multiplexed_advertisement;
+      multiplexed = data;
+      if (!is_resident(advertiser_id)) {
+        if (notify_multiplexed(advertiser_id)) {
+          if (set_scan_rsp) {
+            advertising_callbacks_->OnScanResponseDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+          } else {
+            advertising_callbacks_->OnAdvertisingDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+          }
+        }
+        return;
+      }
+    }
+
+    data = complete_data(advertiser_id, set_scan_rsp, std::move(data));
 
     if (advertising_api_type_ != AdvertisingApiType::EXTENDED && !check_advertising_data(data, false)) {
       if (set_scan_rsp) {
@@ -882,6 +1028,10 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         }
       } break;
     }
+
+    auto& programmed = set_scan_rsp ? advertising_sets_[advertiser_id].programmed_scan_response
+                                    : advertising_sets_[advertiser_id].programmed_advertisement;
+    programmed = serialize_gap_data(data);
   }
 
   void send_data_fragment(
@@ -914,6 +1064,24 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void enable_advertiser(
       AdvertiserId advertiser_id, bool enable, uint16_t duration, uint8_t max_extended_advertising_events) {
+    if (multiplexer_enabled_) {
+      advertising_sets_[advertiser_id].wants_enable = enable;
+      if (!is_resident(advertiser_id)) {
+        advertising_sets_[advertiser_id].duration = duration;
+        advertising_sets_[advertiser_id].max_extended_advertising_events = max_extended_advertising_events;
+        if (enable && !paused && count_resident_advertisers() < num_instances_) {
+          rotate_multiplexed_advertisers();
+        } else if (enable) {
+          schedule_multiplexer();
+        }
+        if (notify_multiplexed(advertiser_id)) {
+          advertising_callbacks_->OnAdvertisingEnabled(
+              advertiser_id, enable, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        }
+        return;
+      }
+    }
+
     EnabledSet curr_set;
     curr_set.advertising_handle_ = advertiser_id;
     curr_set.duration_ = duration;
@@ -970,6 +1138,17 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void set_periodic_parameter(
       AdvertiserId advertiser_id, PeriodicAdvertisingParameters periodic_advertising_parameters) {
+    if (multiplexer_enabled_) {
+      advertising_sets_[advertiser_id].multiplexed_periodic_parameters = periodic_advertising_parameters;
+      if (!is_resident(advertiser_id)) {
+        if (notify_multiplexed(advertiser_id)) {
+          advertising_callbacks_->OnPeriodicAdvertisingParametersUpdated(
+              advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        }
+        return;
+      }
+    }
+
     uint8_t include_tx_power = periodic_advertising_parameters.properties >>
                                PeriodicAdvertisingParameters::AdvertisingProperty::INCLUDE_TX_POWER;
 
@@ -981,9 +1160,21 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             include_tx_power),
         module_handler_->BindOnceOn(
             this, &impl::check_status_with_id<LeSetPeriodicAdvertisingParamCompleteView>, advertiser_id));
+    advertising_sets_[advertiser_id].programmed_periodic_parameters = periodic_advertising_parameters;
   }
 
   void set_periodic_data(AdvertiserId advertiser_id, std::vector<GapData> data) {
+    if (multiplexer_enabled_) {
+      advertising_sets_[advertiser_id].multiplexed_periodic_data = data;
+      if (!is_resident(advertiser_id)) {
+        if (notify_multiplexed(advertiser_id)) {
+          advertising_callbacks_->OnPeriodicAdvertisingDataSet(
+              advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        }
+        return;
+      }
+    }
+
     uint16_t data_len = 0;
     // check data size
     for (size_t i = 0; i < data.size(); i++) {
@@ -1027,6 +1218,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       }
       send_periodic_data_fragment(advertiser_id, sub_data, Operation::LAST_FRAGMENT);
     }
+    advertising_sets_[advertiser_id].programmed_periodic_data = serialize_gap_data(data);
   }
 
   void send_periodic_data_fragment(AdvertiserId advertiser_id, std::vector<GapData> data, Operation operation) {
@@ -1044,6 +1236,17 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void enable_periodic_advertising(AdvertiserId advertiser_id, bool enable) {
+    if (multiplexer_enabled_) {
+      advertising_sets_[advertiser_id].periodic_enabled = enable;
+      if (!is_resident(advertiser_id)) {
+        if (notify_multiplexed(advertiser_id)) {
+          advertising_callbacks_->OnPeriodicAdvertisingEnabled(
+              advertiser_id, enable, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        }
+        return;
+      }
+    }
+
     Enable enable_value = enable ? Enable::ENABLED : Enable::DISABLED;
 
     le_advertising_interface_->EnqueueCommand(
@@ -1055,6 +1258,288 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             advertiser_id));
   }
 
+  void update_advertising_sets(std::map<AdvertiserId, AdvertisingSetUpdate> updates) {
+    for (auto& [advertiser_id, update] : updates) {
+      if (advertising_sets_.count(advertiser_id) == 0) {
+        LOG_WARN("Ignoring update of unknown advertising set %d", advertiser_id);
+        continue;
+      }
+      auto& advertiser = advertising_sets_[advertiser_id];
+      // Skipped commands are reported like check_status_with_id() reports completed ones
+      bool notify = advertising_callbacks_ != nullptr && advertiser.started && id_map_[advertiser_id] != kIdLocal;
+
+      // The parameters go first, since they decide the Flags and the TX Power of the data
+      if (update.parameters) {
+        if (advertiser.programmed_parameters &&
+            same_advertising_parameters(*advertiser.programmed_parameters, *update.parameters)) {
+          if (notify) {
+            int8_t tx_power = advertising_api_type_ == AdvertisingApiType::EXTENDED ? advertiser.tx_power
+                                                                                    : le_physical_channel_tx_power_;
+            advertising_callbacks_->OnAdvertisingParametersUpdated(
+                advertiser_id, tx_power, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+          }
+        } else {
+          set_parameters(advertiser_id, *update.parameters);
+        }
+      }
+      if (update.advertisement) {
+        auto data = complete_data(advertiser_id, false, std::move(*update.advertisement));
+        if (advertiser.programmed_advertisement == serialize_gap_data(data)) {
+          if (notify) {
+            advertising_callbacks_->OnAdvertisingDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+          }
+        } else {
+          set_data(advertiser_id, false, std::move(data));
+        }
+      }
+      if (update.scan_response) {
+        auto data = complete_data(advertiser_id, true, std::move(*update.scan_response));
+        if (advertiser.programmed_scan_response == serialize_gap_data(data)) {
+          if (notify) {
+            advertising_callbacks_->OnScanResponseDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+          }
+        } else {
+          set_data(advertiser_id, true, std::move(data));
+        }
+      }
+      if (update.periodic_parameters) {
+        if (advertiser.programmed_periodic_parameters &&
+            same_periodic_parameters(*advertiser.programmed_periodic_parameters, *update.periodic_parameters)) {
+          if (notify) {
+            advertising_callbacks_->OnPeriodicAdvertisingParametersUpdated(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+          }
+        } else {
+          set_periodic_parameter(advertiser_id, *update.periodic_parameters);
+        }
+      }
+      if (update.periodic_data) {
+        if (advertiser.programmed_periodic_data == serialize_gap_data(*update.periodic_data)) {
+          if (notify) {
+            advertising_callbacks_->OnPeriodicAdvertisingDataSet(
+                advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+          }
+        } else {
+          set_periodic_data(advertiser_id, std::move(*update.periodic_data));
+        }
+      }
+    }
+  }
+
+  bool is_resident(AdvertiserId advertiser_id) {
+    return !multiplexer_enabled_ || advertising_sets_[advertiser_id].resident;
+  }
+
+  size_t count_resident_advertisers() const {
+    return std::count_if(advertising_sets_.begin(), advertising_sets_.end(), [](const auto& entry) {
+      return entry.second.resident;
+    });
+  }
+
+  // Report the state recorded for an advertiser which waits for its slice like check_status_with_id() reports
+  // completed commands
+  bool notify_multiplexed(AdvertiserId advertiser_id) {
+    return advertising_callbacks_ != nullptr && advertising_sets_[advertiser_id].started &&
+           id_map_[advertiser_id] != kIdLocal;
+  }
+
+  // Directed and limited advertising would miss their deadline, periodic advertising would lose its synchronized
+  // scanners, and the advertisers of the stack itself are not multiplexed.
+  bool is_pinned(AdvertiserId advertiser_id) {
+    const auto& advertiser = advertising_sets_[advertiser_id];
+    return advertiser.directed || advertiser.periodic_enabled || advertiser.duration != 0 ||
+           advertiser.max_extended_advertising_events != 0 || id_map_[advertiser_id] == kIdLocal;
+  }
+
+  void make_resident(AdvertiserId advertiser_id) {
+    auto& advertiser = advertising_sets_[advertiser_id];
+    advertiser.resident = true;
+    advertiser.resident_since = std::chrono::steady_clock::now();
+    advertiser.slices++;
+  }
+
+  void schedule_multiplexer() {
+    if (multiplexer_scheduled_) {
+      return;
+    }
+    // A slice covers a few advertising events of every resident advertiser, whose interval is in units of 0.625 ms
+    std::chrono::milliseconds slice = multiplexer_slice_;
+    for (const auto& [id, advertiser] : advertising_sets_) {
+      if (advertiser.resident && advertiser.multiplexed_parameters) {
+        slice = std::max(
+            slice,
+            std::chrono::milliseconds(
+                kMinAdvertisingEventsPerSlice * advertiser.multiplexed_parameters->interval_max * 5 / 8));
+      }
+    }
+    multiplexer_scheduled_ = true;
+    multiplexer_alarm_->Schedule(
+        common::BindOnce(&impl::rotate_multiplexed_advertisers, common::Unretained(this)), slice);
+  }
+
+  // Move the least served waiting advertisers into the sets of the most served resident ones. Advertisers only swap
+  // towards an even airtime, so that the sets stay put when there are as many enabled advertisers as sets.
+  void rotate_multiplexed_advertisers() {
+    multiplexer_scheduled_ = false;
+    auto now = std::chrono::steady_clock::now();
+    std::vector<AdvertiserId> waiting;
+    std::vector<AdvertiserId> evictable;
+    size_t resident_count = 0;
+    for (auto& [id, advertiser] : advertising_sets_) {
+      if (advertiser.resident) {
+        resident_count++;
+        if (advertiser.wants_enable) {
+          advertiser.airtime += std::chrono::duration_cast<std::chrono::milliseconds>(now - advertiser.resident_since);
+        }
+        advertiser.resident_since = now;
+        if (!is_pinned(id)) {
+          evictable.push_back(id);
+        }
+      } else if (advertiser.wants_enable && advertiser.multiplexed_parameters) {
+        waiting.push_back(id);
+      }
+    }
+    if (waiting.empty()) {
+      return;
+    }
+    if (paused) {
+      schedule_multiplexer();
+      return;
+    }
+
+    std::sort(waiting.begin(), waiting.end(), [this](AdvertiserId a, AdvertiserId b) {
+      return advertising_sets_[a].airtime < advertising_sets_[b].airtime;
+    });
+    // The disabled advertisers lose their set first
+    std::sort(evictable.begin(), evictable.end(), [this](AdvertiserId a, AdvertiserId b) {
+      const auto& first = advertising_sets_[a];
+      const auto& second = advertising_sets_[b];
+      if (first.wants_enable != second.wants_enable) {
+        return !first.wants_enable;
+      }
+      return first.airtime > second.airtime;
+    });
+
+    auto next_evictable = evictable.begin();
+    for (AdvertiserId id : waiting) {
+      if (resident_count >= num_instances_) {
+        if (next_evictable == evictable.end()) {
+          break;
+        }
+        const auto& outgoing = advertising_sets_[*next_evictable];
+        if (outgoing.wants_enable && outgoing.airtime < advertising_sets_[id].airtime) {
+          break;
+        }
+        evict_advertiser(*next_evictable++);
+        resident_count--;
+      }
+      restore_advertiser(id);
+      resident_count++;
+    }
+    log_multiplexer_fairness();
+    schedule_multiplexer();
+  }
+
+  // Release the set of the controller without telling the upper layers, for which the advertiser stays enabled
+  void evict_advertiser(AdvertiserId advertiser_id) {
+    auto& advertiser = advertising_sets_[advertiser_id];
+    LOG_INFO(
+        "Advertiser %d leaves its set after %lld ms of airtime",
+        advertiser_id,
+        static_cast<long long>(advertiser.airtime.count()));
+    if (enabled_sets_[advertiser_id].advertising_handle_ != kInvalidHandle) {
+      EnabledSet curr_set;
+      curr_set.advertising_handle_ = advertiser_id;
+      std::vector<EnabledSet> enabled_vector{curr_set};
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_vector),
+          module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
+      enabled_sets_[advertiser_id].advertising_handle_ = kInvalidHandle;
+    }
+    le_advertising_interface_->EnqueueCommand(
+        hci::LeRemoveAdvertisingSetBuilder::Create(advertiser_id),
+        module_handler_->BindOnce(impl::check_status<LeRemoveAdvertisingSetCompleteView>));
+    if (advertiser.address_rotation_alarm != nullptr) {
+      advertiser.address_rotation_alarm->Cancel();
+      advertiser.address_rotation_alarm.reset();
+    }
+    advertiser.forget_programmed_state();
+    advertiser.resident = false;
+  }
+
+  // Program the recorded state of an advertiser into a free set of the controller. The completions of these commands
+  // are not reported, except for the start of an advertiser which never had a set.
+  void restore_advertiser(AdvertiserId advertiser_id) {
+    auto& advertiser = advertising_sets_[advertiser_id];
+    make_resident(advertiser_id);
+    LOG_INFO(
+        "Advertiser %d takes a set for its slice %u, after %lld ms of airtime",
+        advertiser_id,
+        advertiser.slices,
+        static_cast<long long>(advertiser.airtime.count()));
+    advertiser.reprogramming = true;
+
+    ExtendedAdvertisingConfig config = *advertiser.multiplexed_parameters;
+    set_parameters(advertiser_id, config);
+    set_own_address(advertiser_id, config);
+    if (advertiser.multiplexed_scan_response) {
+      set_data(advertiser_id, true, *advertiser.multiplexed_scan_response);
+    }
+    if (advertiser.multiplexed_advertisement) {
+      set_data(advertiser_id, false, *advertiser.multiplexed_advertisement);
+    }
+    if (advertiser.multiplexed_periodic_parameters) {
+      set_periodic_parameter(advertiser_id, *advertiser.multiplexed_periodic_parameters);
+    }
+    if (advertiser.multiplexed_periodic_data) {
+      set_periodic_data(advertiser_id, *advertiser.multiplexed_periodic_data);
+    }
+    if (advertiser.periodic_enabled) {
+      enable_periodic_advertising(advertiser_id, true);
+    }
+
+    EnabledSet curr_set;
+    curr_set.advertising_handle_ = advertiser_id;
+    curr_set.duration_ = advertiser.duration;
+    curr_set.max_extended_advertising_events_ = advertiser.max_extended_advertising_events;
+    std::vector<EnabledSet> enabled_sets = {curr_set};
+    enabled_sets_[advertiser_id] = curr_set;
+    le_advertising_interface_->EnqueueCommand(
+        hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::ENABLED, enabled_sets),
+        module_handler_->BindOnceOn(
+            this,
+            &impl::on_set_extended_advertising_enable_complete<LeSetExtendedAdvertisingEnableCompleteView>,
+            true,
+            enabled_sets,
+            false /* trigger_callbacks */));
+  }
+
+  // Jain's index of the airtime of the enabled advertisers: 1 when they all had the same airtime, 1/n when a single
+  // one had it all
+  void log_multiplexer_fairness() {
+    double sum = 0;
+    double sum_of_squares = 0;
+    size_t count = 0;
+    for (const auto& [id, advertiser] : advertising_sets_) {
+      if (advertiser.wants_enable) {
+        double airtime = static_cast<double>(advertiser.airtime.count());
+        sum += airtime;
+        sum_of_squares += airtime * airtime;
+        count++;
+      }
+    }
+    if (count == 0 || sum_of_squares == 0) {
+      return;
+    }
+    LOG_INFO(
+        "Multiplexing %zu advertisers over %zu sets, airtime fairness %.2f",
+        count,
+        num_instances_,
+        sum * sum / (count * sum_of_squares));
+  }
+
   void OnPause() override {
     if (!address_manager_registered) {
       LOG_WARN("Unregistered!");
@@ -1204,6 +1689,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   std::mutex id_mutex_;
   size_t num_instances_;
+  // Number of advertisers, more than the sets of the controller when they are multiplexed
+  size_t max_advertisers_ = 0;
+  bool multiplexer_enabled_ = false;
+  bool multiplexer_scheduled_ = false;
+  std::chrono::milliseconds multiplexer_slice_{kDefaultMultiplexerSliceMs};
+  std::unique_ptr<os::Alarm> multiplexer_alarm_;
   std::vector<hci::EnabledSet> enabled_sets_;
   // map to mapping the id from java layer and advertier id
   std::map<uint8_t, int> id_map_;
@@ -1297,6 +1788,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       if (id == kInvalidHandle) {
         continue;
       }
+      // The enable is the last command sent to restore a multiplexed advertiser
+      advertising_sets_[id].reprogramming = false;
 
       int reg_id = id_map_[id];
       if (reg_id == kIdLocal) {
@@ -1327,10 +1820,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (complete_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(complete_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      advertising_sets_[id].forget_programmed_state();
     }
     advertising_sets_[id].tx_power = complete_view.GetSelectedTxPower();
 
-    if (advertising_sets_[id].started && id_map_[id] != kIdLocal) {
+    if (advertising_sets_[id].started && id_map_[id] != kIdLocal && !advertising_sets_[id].reprogramming) {
       advertising_callbacks_->OnAdvertisingParametersUpdated(id, advertising_sets_[id].tx_power, advertising_status);
     }
   }
@@ -1346,7 +1840,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
     }
 
-    if (advertising_callbacks_ == nullptr || !advertising_sets_[id].started || id_map_[id] == kIdLocal) {
+    if (advertising_callbacks_ == nullptr || !advertising_sets_[id].started || id_map_[id] == kIdLocal ||
+        advertising_sets_[id].reprogramming) {
       return;
     }
 
@@ -1385,11 +1880,16 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (status_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(status_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      // The controller state is unknown now, so the next update sends everything again
+      if (advertising_sets_.count(id) != 0) {
+        advertising_sets_[id].forget_programmed_state();
+      }
     }
 
     // Do not trigger callback if the advertiser not stated yet, or the advertiser is not register
-    // from Java layer
-    if (advertising_callbacks_ == nullptr || !advertising_sets_[id].started || id_map_[id] == kIdLocal) {
+    // from Java layer, or the commands only restore a multiplexed advertiser
+    if (advertising_callbacks_ == nullptr || !advertising_sets_[id].started || id_map_[id] == kIdLocal ||
+        advertising_sets_[id].reprogramming) {
       return;
     }
 
@@ -1663,6 +2163,10 @@ void LeAdvertisingManager::EnablePeriodicAdvertising(AdvertiserId advertiser_id,
   CallOn(pimpl_.get(), &impl::enable_periodic_advertising, advertiser_id, enable);
 }
 
+void LeAdvertisingManager::UpdateAdvertisingSets(std::map<AdvertiserId, AdvertisingSetUpdate> updates) {
+  CallOn(pimpl_.get(), &impl::update_advertising_sets, std::move(updates));
+}
+
 void LeAdvertisingManager::RemoveAdvertiser(AdvertiserId advertiser_id) {
   CallOn(pimpl_.get(), &impl::remove_advertiser, advertiser_id);
 }
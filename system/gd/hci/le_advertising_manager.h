@@ -15,7 +15,9 @@
  */
 #pragma once
 
+#include <map>
 #include <memory>
+#include <optional>
 
 #include "common/callback.h"
 #include "hci/address_with_type.h"
@@ -70,6 +72,16 @@ class ExtendedAdvertisingConfig : public AdvertisingConfig {
 
 using AdvertiserId = uint8_t;
 
+// Desired state of an advertising set. Fields left empty keep their current value.
+class AdvertisingSetUpdate {
+ public:
+  std::optional<ExtendedAdvertisingConfig> parameters;
+  std::optional<std::vector<GapData>> advertisement;
+  std::optional<std::vector<GapData>> scan_response;
+  std::optional<PeriodicAdvertisingParameters> periodic_parameters;
+  std::optional<std::vector<GapData>> periodic_data;
+};
+
 class AdvertisingCallback {
  public:
   enum AdvertisingStatus {
@@ -143,6 +155,10 @@ class LeAdvertisingManager : public bluetooth::Module {
 
   void EnablePeriodicAdvertising(AdvertiserId advertiser_id, bool enable);
 
+  // Bring each advertising set to its desired state, sending only the commands for what differs from the state last
+  // programmed into the controller. Unchanged fields are reported through the callbacks as set successfully.
+  void UpdateAdvertisingSets(std::map<AdvertiserId, AdvertisingSetUpdate> updates);
+
   void RemoveAdvertiser(AdvertiserId advertiser_id);
 
   void RegisterAdvertisingCallback(AdvertisingCallback* advertising_callback);
@@ -29,6 +29,7 @@
 #include "hci/address.h"
 #include "hci/controller.h"
 #include "hci/hci_layer_fake.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
@@ -459,6 +460,49 @@ class LeExtendedAdvertisingAPITest : public LeExtendedAdvertisingManagerTest {
   AdvertiserId advertiser_id_;
 };
 
+class LeExtendedAdvertisingMultiplexerTest : public LeExtendedAdvertisingManagerTest {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(os::SetSystemProperty("bluetooth.le.adv_multiplexer.enabled", "true"));
+    ASSERT_TRUE(os::SetSystemProperty("bluetooth.le.adv_multiplexer.slice_ms", "100"));
+    num_instances_ = 1;
+    LeExtendedAdvertisingManagerTest::SetUp();
+  }
+
+  void TearDown() override {
+    LeExtendedAdvertisingManagerTest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+
+  ExtendedAdvertisingConfig MakeConfig() {
+    ExtendedAdvertisingConfig advertising_config{};
+    advertising_config.advertising_type = AdvertisingType::ADV_IND;
+    advertising_config.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+    GapData data_item{};
+    data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+    data_item.data_ = {'r', 'a', 'n', 'd', 'o', 'm', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+    advertising_config.advertisement = {data_item};
+    advertising_config.scan_response = {data_item};
+    advertising_config.channel_map = 1;
+    return advertising_config;
+  }
+
+  void CompleteCommands(std::vector<OpCode> opcodes) {
+    std::vector<uint8_t> success_vector{static_cast<uint8_t>(ErrorCode::SUCCESS)};
+    for (auto opcode : opcodes) {
+      ASSERT_EQ(opcode, test_hci_layer_->GetCommand().GetOpCode());
+      if (opcode == OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS) {
+        test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+            uint8_t{1}, ErrorCode::SUCCESS, static_cast<uint8_t>(-23)));
+      } else {
+        test_hci_layer_->IncomingEvent(
+            CommandCompleteBuilder::Create(uint8_t{1}, opcode, std::make_unique<RawBuilder>(success_vector)));
+      }
+    }
+    sync_client_handler();
+  }
+};
+
 TEST_F(LeAdvertisingManagerTest, startup_teardown) {}
 
 TEST_F(LeAndroidHciAdvertisingManagerTest, startup_teardown) {}
@@ -791,6 +835,57 @@ TEST_F(LeExtendedAdvertisingAPITest, set_data_test) {
   test_hci_layer_->IncomingEvent(LeSetExtendedScanResponseDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
 }
 
+TEST_F(LeExtendedAdvertisingAPITest, update_advertising_sets_sends_only_changes) {
+  // The advertisement programmed when the set started doesn't change
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::FLAGS;
+  data_item.data_ = {0x34};
+  advertising_data.push_back(data_item);
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'r', 'a', 'n', 'd', 'o', 'm', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  advertising_data.push_back(data_item);
+  std::vector<GapData> response_data{};
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'t', 'e', 's', 't', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  response_data.push_back(data_item);
+
+  AdvertisingSetUpdate update;
+  update.advertisement = advertising_data;
+  update.scan_response = response_data;
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnScanResponseDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->UpdateAdvertisingSets({{advertiser_id_, update}});
+  // Only the scan response is sent
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedScanResponseDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+
+  // Nothing changes anymore, so the next command is the periodic data
+  std::vector<GapData> periodic_data{};
+  data_item.data_type_ = GapDataType::TX_POWER_LEVEL;
+  data_item.data_ = {0x00};
+  periodic_data.push_back(data_item);
+  update.periodic_data = periodic_data;
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnScanResponseDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnPeriodicAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->UpdateAdvertisingSets({{advertiser_id_, update}});
+  ASSERT_EQ(OpCode::LE_SET_PERIODIC_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetPeriodicAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
 TEST_F(LeAndroidHciAdvertisingAPITest, set_data_test) {
   // Set advertising data
   std::vector<GapData> advertising_data{};
@@ -1258,6 +1353,36 @@ TEST_F(LeExtendedAdvertisingAPITest, no_callbacks_on_resume) {
   sync_client_handler();
 }
 
+TEST_F(LeExtendedAdvertisingMultiplexerTest, advertisers_take_turns_on_one_set) {
+  std::vector<OpCode> start_opcodes = {
+      OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+      OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE,
+  };
+
+  auto first_id = le_advertising_manager_->ExtendedCreateAdvertiser(
+      0x00, MakeConfig(), scan_callback, set_terminated_callback, 0, 0, client_handler_);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, first_id);
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x00, first_id, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  CompleteCommands(start_opcodes);
+
+  // The second advertiser gets an id, and waits for the slice of the first one to end
+  auto second_id = le_advertising_manager_->ExtendedCreateAdvertiser(
+      0x01, MakeConfig(), scan_callback, set_terminated_callback, 0, 0, client_handler_);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, second_id);
+  ASSERT_NE(first_id, second_id);
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x01, second_id, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(mock_advertising_callback_, OnAdvertisingEnabled(_, _, _)).Times(0);
+  EXPECT_CALL(mock_advertising_callback_, OnAdvertisingParametersUpdated(_, _, _)).Times(0);
+  CompleteCommands({OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, OpCode::LE_REMOVE_ADVERTISING_SET});
+  CompleteCommands(start_opcodes);
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
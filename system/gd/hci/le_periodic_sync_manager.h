@@ -16,10 +16,13 @@
 #pragma once
 
 #include <chrono>
+#include <list>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "common/callback.h"
+#include "common/flat_hash_map.h"
 #include "common/init_flags.h"
 #include "hci/address_with_type.h"
 #include "hci/hci_packets.h"
@@ -56,6 +59,18 @@ struct PeriodicSyncStates {
   PeriodicSyncState sync_state;
 };
 
+// Host side state of an established sync, indexed by its sync handle
+struct EstablishedPeriodicSync {
+  std::list<PeriodicSyncStates>::iterator sync;
+  // Fragments of the report being received, reused from one train of reports to the next
+  std::vector<uint8_t> fragments;
+  // Set once the fragments overflowed, the rest of the train is dropped up to its last report
+  bool drop_fragments = false;
+  // Last data delivered as complete, to drop the unchanged periodic data
+  std::vector<uint8_t> last_complete_data;
+  bool has_last_complete_data = false;
+};
+
 struct PendingPeriodicSyncRequest {
   PendingPeriodicSyncRequest(
       uint8_t advertiser_sid,
@@ -120,7 +135,7 @@ class PeriodicSyncManager {
               this, &PeriodicSyncManager::check_status<LePeriodicAdvertisingTerminateSyncCompleteView>));
       return;
     };
-    periodic_syncs_.erase(periodic_sync);
+    RemoveSyncRequest(periodic_sync);
     le_scanning_interface_->EnqueueCommand(
         hci::LePeriodicAdvertisingTerminateSyncBuilder::Create(handle),
         handler_->BindOnceOn(this, &PeriodicSyncManager::check_status<LePeriodicAdvertisingTerminateSyncCompleteView>));
@@ -143,7 +158,7 @@ class PeriodicSyncManager {
       LOG_DEBUG("[PSync]: Removing Sync request from queue");
       CleanUpRequest(adv_sid, address);
     }
-    periodic_syncs_.erase(periodic_sync);
+    RemoveSyncRequest(periodic_sync);
   }
 
   void TransferSync(
@@ -301,6 +316,7 @@ class PeriodicSyncManager {
     }
     periodic_sync->sync_handle = event_view.GetSyncHandle();
     periodic_sync->sync_state = PERIODIC_SYNC_STATE_ESTABLISHED;
+    established_syncs_[periodic_sync->sync_handle] = EstablishedPeriodicSync{.sync = periodic_sync};
     callbacks_->OnPeriodicSyncStarted(
         periodic_sync->request_id,
         (uint8_t)event_view.GetStatus(),
@@ -325,18 +341,53 @@ class PeriodicSyncManager {
         (uint16_t)event_view.GetData().size());
 
     uint16_t sync_handle = event_view.GetSyncHandle();
-    auto periodic_sync = GetEstablishedSyncFromHandle(sync_handle);
-    if (periodic_sync == periodic_syncs_.end()) {
+    auto established_sync = established_syncs_.find(sync_handle);
+    if (established_sync == established_syncs_.end()) {
       LOG_ERROR("[PSync]: index not found for handle %u", sync_handle);
       return;
     }
+
+    // Reassemble the fragments here, so that the clients only get whole periodic advertising data
+    auto& state = established_sync->second;
+    auto data_status = event_view.GetDataStatus();
+    auto data = event_view.GetData();
+    if (state.drop_fragments) {
+      if (data_status != PeriodicAdvertisingDataStatus::DATA_INCOMPLETE_MORE_TO_COME) {
+        state.drop_fragments = false;
+      }
+      return;
+    }
+    if (state.fragments.size() + data.size() > kMaxPeriodicAdvertisingDataLength) {
+      LOG_WARN(
+          "[PSync]: periodic data of handle %u exceeds %zu bytes, dropped",
+          sync_handle,
+          kMaxPeriodicAdvertisingDataLength);
+      state.fragments.clear();
+      state.drop_fragments = data_status == PeriodicAdvertisingDataStatus::DATA_INCOMPLETE_MORE_TO_COME;
+      return;
+    }
+    if (data_status == PeriodicAdvertisingDataStatus::DATA_INCOMPLETE_MORE_TO_COME) {
+      state.fragments.insert(state.fragments.end(), data.begin(), data.end());
+      return;
+    }
+    if (!state.fragments.empty()) {
+      state.fragments.insert(state.fragments.end(), data.begin(), data.end());
+      data.swap(state.fragments);
+      state.fragments.clear();
+    }
+
+    // The periodic data seldom changes from one interval to the next, do not report it again
+    if (data_status == PeriodicAdvertisingDataStatus::DATA_COMPLETE) {
+      if (state.has_last_complete_data && state.last_complete_data == data) {
+        return;
+      }
+      state.last_complete_data.assign(data.begin(), data.end());
+      state.has_last_complete_data = true;
+    }
+
     LOG_DEBUG("%s", "[PSync]: invoking callback");
     callbacks_->OnPeriodicSyncReport(
-        sync_handle,
-        event_view.GetTxPower(),
-        event_view.GetRssi(),
-        (uint16_t)event_view.GetDataStatus(),
-        event_view.GetData());
+        sync_handle, event_view.GetTxPower(), event_view.GetRssi(), (uint16_t)data_status, std::move(data));
   }
 
   void HandleLePeriodicAdvertisingSyncLost(LePeriodicAdvertisingSyncLostView event_view) {
@@ -345,7 +396,11 @@ class PeriodicSyncManager {
     LOG_DEBUG("[PSync]: sync_handle = %d", sync_handle);
     callbacks_->OnPeriodicSyncLost(sync_handle);
     auto periodic_sync = GetEstablishedSyncFromHandle(sync_handle);
-    periodic_syncs_.erase(periodic_sync);
+    if (periodic_sync == periodic_syncs_.end()) {
+      LOG_ERROR("[PSync]: index not found for handle %u", sync_handle);
+      return;
+    }
+    RemoveSyncRequest(periodic_sync);
   }
 
   void HandleLePeriodicAdvertisingSyncTransferReceived(LePeriodicAdvertisingSyncTransferReceivedView event_view) {
@@ -398,13 +453,15 @@ class PeriodicSyncManager {
   }
 
  private:
+  // Maximum length of the periodic advertising data, Core Vol 6 Part B 2.3.4.9
+  static constexpr size_t kMaxPeriodicAdvertisingDataLength = 1650;
+
   std::list<PeriodicSyncStates>::iterator GetEstablishedSyncFromHandle(uint16_t handle) {
-    for (auto it = periodic_syncs_.begin(); it != periodic_syncs_.end(); it++) {
-      if (it->sync_handle == handle && it->sync_state == PeriodicSyncState::PERIODIC_SYNC_STATE_ESTABLISHED) {
-        return it;
-      }
+    auto established_sync = established_syncs_.find(handle);
+    if (established_sync == established_syncs_.end()) {
+      return periodic_syncs_.end();
     }
-    return periodic_syncs_.end();
+    return established_sync->second.sync;
   }
 
   std::list<PeriodicSyncStates>::iterator GetSyncFromAddressWithTypeAndSid(
@@ -437,6 +494,12 @@ class PeriodicSyncManager {
   }
 
   void RemoveSyncRequest(std::list<PeriodicSyncStates>::iterator it) {
+    if (it->sync_state == PERIODIC_SYNC_STATE_ESTABLISHED) {
+      auto established_sync = established_syncs_.find(it->sync_handle);
+      if (established_sync != established_syncs_.end() && established_sync->second.sync == it) {
+        established_syncs_.erase(established_sync);
+      }
+    }
     periodic_syncs_.erase(it);
   }
 
@@ -519,6 +582,8 @@ class PeriodicSyncManager {
   ScanningCallback* callbacks_;
   std::list<PendingPeriodicSyncRequest> pending_sync_requests_;
   std::list<PeriodicSyncStates> periodic_syncs_;
+  // Established entries of periodic_syncs_, looked up for every periodic advertising report
+  common::FlatHashMap<uint16_t, EstablishedPeriodicSync> established_syncs_;
   std::list<PeriodicSyncTransferStates> periodic_sync_transfers_;
   bool sync_received_callback_registered_ = false;
   int sync_received_callback_id{};
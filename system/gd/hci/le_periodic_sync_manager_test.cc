@@ -589,6 +589,106 @@ TEST_F(PeriodicSyncManagerTest, handle_periodic_advertising_report_test) {
   sync_handler();
 }
 
+TEST_F(PeriodicSyncManagerTest, handle_fragmented_periodic_advertising_report_test) {
+  uint16_t sync_handle = 0x12;
+  uint8_t advertiser_sid = 0x02;
+  // start scan
+  Address address;
+  Address::FromString("00:11:22:33:44:55", address);
+  AddressWithType address_with_type = AddressWithType(address, AddressType::PUBLIC_DEVICE_ADDRESS);
+  PeriodicSyncStates request{
+      .request_id = 0x01,
+      .advertiser_sid = advertiser_sid,
+      .address_with_type = address_with_type,
+      .sync_handle = sync_handle,
+      .sync_state = PeriodicSyncState::PERIODIC_SYNC_STATE_IDLE,
+  };
+  ASSERT_NO_FATAL_FAILURE(test_le_scanning_interface_->SetCommandFuture());
+  periodic_sync_manager_->StartSync(request, 0x04, 0x0A);
+  auto packet = test_le_scanning_interface_->GetCommand(OpCode::LE_PERIODIC_ADVERTISING_CREATE_SYNC);
+  auto temp_veiw = LePeriodicAdvertisingCreateSyncView::Create(LeScanningCommandView::Create(packet));
+  ASSERT_TRUE(temp_veiw.IsValid());
+
+  // Get command status
+  test_le_scanning_interface_->CommandStatusCallback(
+      LePeriodicAdvertisingCreateSyncStatusBuilder::Create(ErrorCode::SUCCESS, 0x00));
+
+  EXPECT_CALL(mock_callbacks_, OnPeriodicSyncStarted);
+
+  // Get LePeriodicAdvertisingSyncEstablished
+  auto builder = LePeriodicAdvertisingSyncEstablishedBuilder::Create(
+      ErrorCode::SUCCESS,
+      sync_handle,
+      advertiser_sid,
+      address_with_type.GetAddressType(),
+      address_with_type.GetAddress(),
+      SecondaryPhyType::LE_1M,
+      0xFF,
+      ClockAccuracy::PPM_250);
+  auto event_view = LePeriodicAdvertisingSyncEstablishedView::Create(
+      LeMetaEventView::Create(EventView::Create(GetPacketView(std::move(builder)))));
+  periodic_sync_manager_->HandleLePeriodicAdvertisingSyncEstablished(event_view);
+
+  auto send_report = [&](PeriodicAdvertisingDataStatus data_status, std::vector<uint8_t> data) {
+    auto report_builder = LePeriodicAdvertisingReportBuilder::Create(
+        sync_handle, 0x1a, 0x1a, CteType::AOA_CONSTANT_TONE_EXTENSION, data_status, data);
+    auto report_view = LePeriodicAdvertisingReportView::Create(
+        LeMetaEventView::Create(EventView::Create(GetPacketView(std::move(report_builder)))));
+    periodic_sync_manager_->HandleLePeriodicAdvertisingReport(report_view);
+  };
+
+  // The fragments are reported once, as one complete data
+  std::vector<uint8_t> expected_data = {0x01, 0x02, 0x03, 0x04};
+  EXPECT_CALL(
+      mock_callbacks_,
+      OnPeriodicSyncReport(
+          sync_handle,
+          0x1a,
+          0x1a,
+          static_cast<uint8_t>(PeriodicAdvertisingDataStatus::DATA_COMPLETE),
+          expected_data))
+      .Times(1);
+  send_report(PeriodicAdvertisingDataStatus::DATA_INCOMPLETE_MORE_TO_COME, {0x01, 0x02});
+  send_report(PeriodicAdvertisingDataStatus::DATA_COMPLETE, {0x03, 0x04});
+
+  // The same data in the next interval is not reported again
+  send_report(PeriodicAdvertisingDataStatus::DATA_INCOMPLETE_MORE_TO_COME, {0x01, 0x02});
+  send_report(PeriodicAdvertisingDataStatus::DATA_COMPLETE, {0x03, 0x04});
+
+  std::vector<uint8_t> changed_data = {0x05};
+  EXPECT_CALL(
+      mock_callbacks_,
+      OnPeriodicSyncReport(
+          sync_handle,
+          0x1a,
+          0x1a,
+          static_cast<uint8_t>(PeriodicAdvertisingDataStatus::DATA_COMPLETE),
+          changed_data))
+      .Times(1);
+  send_report(PeriodicAdvertisingDataStatus::DATA_COMPLETE, {0x05});
+
+  // A train longer than the maximum periodic advertising data is dropped, up to its last report
+  std::vector<uint8_t> fragment(247, 0x06);
+  for (int i = 0; i < 7; i++) {
+    send_report(PeriodicAdvertisingDataStatus::DATA_INCOMPLETE_MORE_TO_COME, fragment);
+  }
+  send_report(PeriodicAdvertisingDataStatus::DATA_COMPLETE, {0x07});
+
+  std::vector<uint8_t> next_data = {0x08};
+  EXPECT_CALL(
+      mock_callbacks_,
+      OnPeriodicSyncReport(
+          sync_handle,
+          0x1a,
+          0x1a,
+          static_cast<uint8_t>(PeriodicAdvertisingDataStatus::DATA_COMPLETE),
+          next_data))
+      .Times(1);
+  send_report(PeriodicAdvertisingDataStatus::DATA_COMPLETE, {0x08});
+
+  sync_handler();
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
@@ -19,15 +19,20 @@
 #include <unordered_map>
 
 #include "hci/acl_manager.h"
+#include "hci/advertising_cache.h"
 #include "hci/controller.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "hci/le_periodic_sync_manager.h"
 #include "hci/le_scanning_interface.h"
+#include "hci/scan_result_filter.h"
+#include "hci/software_scan_filter.h"
 #include "hci/vendor_specific_event_manager.h"
 #include "module.h"
+#include "os/alarm.h"
 #include "os/handler.h"
 #include "os/log.h"
+#include "os/system_properties.h"
 #include "storage/storage_module.h"
 
 namespace bluetooth {
@@ -42,6 +47,14 @@ constexpr uint16_t kLeScanIntervalMax = 0x4000;
 constexpr uint16_t kDefaultLeExtendedScanInterval = 4800;
 constexpr uint16_t kLeExtendedScanIntervalMax = 0xFFFF;
 
+// Host side filtering and batching of scan results, disabled when zero
+constexpr char kHostScanFilterWindowProperty[] = "bluetooth.le.scan.host_filter_window_ms";
+constexpr char kHostScanBatchIntervalProperty[] = "bluetooth.le.scan.host_batch_interval_ms";
+// Size of the batch scan results read out before they are reported, the other results stay in the controller storage
+// until the next read out. Unbounded when zero.
+constexpr char kBatchScanMaxReportBytesProperty[] = "bluetooth.le.batch_scan.max_report_bytes";
+constexpr uint32_t kDefaultBatchScanMaxReportBytes = 64 * 1024;
+
 constexpr uint8_t kScannableBit = 1;
 constexpr uint8_t kDirectedBit = 2;
 constexpr uint8_t kScanResponseBit = 3;
@@ -61,80 +74,6 @@ struct Scanner {
   bool in_use;
 };
 
-class AdvertisingCache {
- public:
-  const std::vector<uint8_t>& Set(const AddressWithType& address_with_type, std::vector<uint8_t> data) {
-    auto it = Find(address_with_type);
-    if (it != items.end()) {
-      it->data = std::move(data);
-      return it->data;
-    }
-
-    if (items.size() > cache_max) {
-      items.pop_back();
-    }
-
-    items.emplace_front(address_with_type, std::move(data));
-    return items.front().data;
-  }
-
-  bool Exist(const AddressWithType& address_with_type) {
-    auto it = Find(address_with_type);
-    if (it == items.end()) {
-      return false;
-    }
-    return true;
-  }
-
-  const std::vector<uint8_t>& Append(const AddressWithType& address_with_type, std::vector<uint8_t> data) {
-    auto it = Find(address_with_type);
-    if (it != items.end()) {
-      it->data.insert(it->data.end(), data.begin(), data.end());
-      return it->data;
-    }
-
-    if (items.size() > cache_max) {
-      items.pop_back();
-    }
-
-    items.emplace_front(address_with_type, std::move(data));
-    return items.front().data;
-  }
-
-  /* Clear data for device |addr_type, addr| */
-  void Clear(AddressWithType address_with_type) {
-    auto it = Find(address_with_type);
-    if (it != items.end()) {
-      items.erase(it);
-    }
-  }
-
-  void ClearAll() {
-    items.clear();
-  }
-
-  struct Item {
-    AddressWithType address_with_type;
-    std::vector<uint8_t> data;
-
-    Item(const AddressWithType& address_with_type, std::vector<uint8_t> data)
-        : address_with_type(address_with_type), data(data) {}
-  };
-
-  std::list<Item>::iterator Find(const AddressWithType& address_with_type) {
-    for (auto it = items.begin(); it != items.end(); it++) {
-      if (it->address_with_type == address_with_type) {
-        return it;
-      }
-    }
-    return items.end();
-  }
-
-  /* we keep maximum 7 devices in the cache */
-  const size_t cache_max = 1000;
-  std::list<Item> items;
-};
-
 class NullScanningCallback : public ScanningCallback {
   void OnScannerRegistered(const Uuid app_uuid, ScannerId scanner_id, ScanningStatus status) override {
     LOG_INFO("OnScannerRegistered in NullScanningCallback");
@@ -282,6 +221,16 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     }
     batch_scan_config_.current_state = BatchScanState::DISABLED_STATE;
     batch_scan_config_.ref_value = kInvalidScannerId;
+    auto filter_window_ms = os::GetSystemPropertyUint32(kHostScanFilterWindowProperty, 0);
+    auto batch_interval_ms = os::GetSystemPropertyUint32(kHostScanBatchIntervalProperty, 0);
+    if (filter_window_ms != 0 || batch_interval_ms != 0) {
+      LOG_INFO("Host scan result filter window %u ms, batch interval %u ms", filter_window_ms, batch_interval_ms);
+    }
+    scan_result_filter_ = ScanResultFilter(std::chrono::milliseconds(filter_window_ms));
+    scan_result_batch_interval_ = std::chrono::milliseconds(batch_interval_ms);
+    scan_result_batch_alarm_ = std::make_unique<os::Alarm>(module_handler_);
+    batch_scan_max_report_bytes_ =
+        os::GetSystemPropertyUint32(kBatchScanMaxReportBytesProperty, kDefaultBatchScanMaxReportBytes);
     configure_scan();
   }
 
@@ -296,6 +245,9 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     }
     batch_scan_config_.current_state = BatchScanState::DISABLED_STATE;
     batch_scan_config_.ref_value = kInvalidScannerId;
+    scan_result_batch_alarm_->Cancel();
+    scan_result_batch_alarm_.reset();
+    pending_scan_results_.clear();
     scanning_callbacks_ = &null_scanning_callback_;
     periodic_sync_manager_.SetScanningCallback(scanning_callbacks_);
   }
@@ -423,13 +375,13 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       LOG_INFO("Dropping invalid advertising event");
       return;
     }
-    std::vector<LeExtendedAdvertisingResponse> reports = event_view.GetResponses();
+    auto reports = event_view.GetResponsesLazy();
     if (reports.empty()) {
       LOG_INFO("Zero results in advertising event");
       return;
     }
 
-    for (LeExtendedAdvertisingResponse report : reports) {
+    for (const LeExtendedAdvertisingResponse& report : reports) {
       uint16_t event_type = report.connectable_ | (report.scannable_ << kScannableBit) |
                             (report.directed_ << kDirectedBit) | (report.scan_response_ << kScanResponseBit) |
                             (report.legacy_ << kLegacyBit) | ((uint16_t)report.data_status_ << kDataStatusBits);
@@ -461,8 +413,33 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     bool is_scannable = event_type & (1 << kScannableBit);
     bool is_scan_response = event_type & (1 << kScanResponseBit);
     bool is_legacy = event_type & (1 << kLegacyBit);
+    uint8_t data_status = event_type >> kDataStatusBits;
+    bool is_anonymous = address_type == (uint8_t)DirectAdvertisingAddressType::NO_ADDRESS_PROVIDED;
+
+    // Drop the reports carrying all their data which don't match the software filter before copying them. The
+    // others are matched once their data is complete.
+    bool software_filter_matched = !software_scan_filter_active();
+    if (!software_filter_matched) {
+      AddressWithType address_with_type(address, (AddressType)address_type);
+      bool is_self_contained = data_status != (uint8_t)DataStatus::CONTINUING && !(is_legacy && is_scannable) &&
+                               !is_scan_response && !advertising_cache_.Exist(address_with_type);
+      if (is_anonymous || is_self_contained) {
+        SoftwareScanFilter::Match match(software_scan_filter_, address_with_type);
+        for (const auto& datum : advertising_data) {
+          if (!datum.data_.empty()) {
+            match.AddStructure(datum.data_[0], datum.data_.data() + 1, datum.data_.size() - 1);
+          }
+        }
+        if (!match.Matches()) {
+          return;
+        }
+        software_filter_matched = true;
+      }
+    }
 
-    auto significant_data = std::vector<uint8_t>{};
+    // Reuse the buffer of the previous report, its capacity fits most reports
+    auto& significant_data = significant_data_;
+    significant_data.clear();
     for (const auto& datum : advertising_data) {
       if (!datum.data_.empty()) {
         significant_data.push_back(static_cast<uint8_t>(datum.data_.size()));
@@ -470,18 +447,19 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       }
     }
 
-    if (address_type == (uint8_t)DirectAdvertisingAddressType::NO_ADDRESS_PROVIDED) {
-      scanning_callbacks_->OnScanResult(
-          event_type,
-          address_type,
-          address,
-          primary_phy,
-          secondary_phy,
-          advertising_sid,
-          tx_power,
-          rssi,
-          periodic_advertising_interval,
-          significant_data);
+    if (is_anonymous) {
+      deliver_scan_result({
+          .event_type = event_type,
+          .address_type = address_type,
+          .address = address,
+          .primary_phy = primary_phy,
+          .secondary_phy = secondary_phy,
+          .advertising_sid = advertising_sid,
+          .tx_power = tx_power,
+          .rssi = rssi,
+          .periodic_advertising_interval = periodic_advertising_interval,
+          .advertising_data = significant_data,
+      });
       return;
     } else if (address == Address::kEmpty) {
       LOG_WARN("Receive non-anonymous advertising report with empty address, skip!");
@@ -499,7 +477,6 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     std::vector<uint8_t> const& adv_data = is_start ? advertising_cache_.Set(address_with_type, significant_data)
                                                     : advertising_cache_.Append(address_with_type, significant_data);
 
-    uint8_t data_status = event_type >> kDataStatusBits;
     if (data_status == (uint8_t)DataStatus::CONTINUING) {
       // Waiting for whole data
       return;
@@ -510,6 +487,17 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
 
+    if (!software_filter_matched && !software_scan_filter_.Matches(address_with_type, adv_data)) {
+      advertising_cache_.Clear(address_with_type);
+      return;
+    }
+
+    if (!scan_result_filter_.ShouldDeliver(address_with_type, event_type, adv_data)) {
+      // Same data as the last result of the device, delivered recently
+      advertising_cache_.Clear(address_with_type);
+      return;
+    }
+
     switch (address_type) {
       case (uint8_t)AddressType::PUBLIC_DEVICE_ADDRESS:
       case (uint8_t)AddressType::PUBLIC_IDENTITY_ADDRESS:
@@ -520,21 +508,72 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
         address_type = (uint8_t)AddressType::RANDOM_DEVICE_ADDRESS;
         break;
     }
-    scanning_callbacks_->OnScanResult(
-        event_type,
-        address_type,
-        address,
-        primary_phy,
-        secondary_phy,
-        advertising_sid,
-        tx_power,
-        rssi,
-        periodic_advertising_interval,
-        adv_data);
+    deliver_scan_result({
+        .event_type = event_type,
+        .address_type = address_type,
+        .address = address,
+        .primary_phy = primary_phy,
+        .secondary_phy = secondary_phy,
+        .advertising_sid = advertising_sid,
+        .tx_power = tx_power,
+        .rssi = rssi,
+        .periodic_advertising_interval = periodic_advertising_interval,
+        .advertising_data = adv_data,
+    });
 
     advertising_cache_.Clear(address_with_type);
   }
 
+  struct ScanResult {
+    uint16_t event_type;
+    uint8_t address_type;
+    Address address;
+    uint8_t primary_phy;
+    uint8_t secondary_phy;
+    uint8_t advertising_sid;
+    int8_t tx_power;
+    int8_t rssi;
+    uint16_t periodic_advertising_interval;
+    std::vector<uint8_t> advertising_data;
+  };
+
+  // Deliver the result right away, or with the others received in the same batch interval. Batching wakes up the
+  // threads of the scanning callbacks once per interval instead of once per result.
+  void deliver_scan_result(ScanResult result) {
+    if (scan_result_batch_interval_.count() == 0) {
+      on_scan_result(std::move(result));
+      return;
+    }
+    pending_scan_results_.push_back(std::move(result));
+    if (pending_scan_results_.size() == 1) {
+      scan_result_batch_alarm_->Schedule(
+          common::BindOnce(&impl::flush_scan_results, common::Unretained(this)), scan_result_batch_interval_);
+    }
+  }
+
+  void flush_scan_results() {
+    scan_result_batch_alarm_->Cancel();
+    auto results = std::move(pending_scan_results_);
+    pending_scan_results_.clear();
+    for (auto& result : results) {
+      on_scan_result(std::move(result));
+    }
+  }
+
+  void on_scan_result(ScanResult result) {
+    scanning_callbacks_->OnScanResult(
+        result.event_type,
+        result.address_type,
+        result.address,
+        result.primary_phy,
+        result.secondary_phy,
+        result.advertising_sid,
+        result.tx_power,
+        result.rssi,
+        result.periodic_advertising_interval,
+        std::move(result.advertising_data));
+  }
+
   void configure_scan() {
     std::vector<PhyScanParameters> parameter_vector;
     PhyScanParameters phy_scan_parameters;
@@ -660,6 +699,9 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
     is_scanning_ = false;
+    // Deliver the results received before the scan stopped, and report every device again on the next scan
+    flush_scan_results();
+    scan_result_filter_.Clear();
 
     switch (api_type_) {
       case ScanApiType::EXTENDED:
@@ -710,12 +752,14 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   }
 
   void scan_filter_enable(bool enable) {
+    Enable apcf_enable = enable ? Enable::ENABLED : Enable::DISABLED;
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      LOG_INFO("Advertising filter is not supported, %s the software filter", enable ? "enable" : "disable");
+      software_scan_filter_enabled_ = enable;
+      scanning_callbacks_->OnFilterEnable(apcf_enable, (uint8_t)ErrorCode::SUCCESS);
       return;
     }
 
-    Enable apcf_enable = enable ? Enable::ENABLED : Enable::DISABLED;
     le_scanning_interface_->EnqueueCommand(
         LeAdvFilterEnableBuilder::Create(apcf_enable),
         module_handler_->BindOnceOn(this, &impl::on_advertising_filter_complete));
@@ -735,7 +779,14 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   void scan_filter_parameter_setup(
       ApcfAction action, uint8_t filter_index, AdvertisingFilterParameter advertising_filter_parameter) {
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      // The software filter accepts the reports matching the content filters of any filter index
+      if (action == ApcfAction::DELETE) {
+        software_scan_filter_.RemoveFilter(filter_index);
+      } else if (action == ApcfAction::CLEAR) {
+        software_scan_filter_.Clear();
+      }
+      scanning_callbacks_->OnFilterParamSetup(
+          software_scan_filter_.AvailableFilters(), action, (uint8_t)ErrorCode::SUCCESS);
       return;
     }
 
@@ -798,7 +849,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
 
   void scan_filter_add(uint8_t filter_index, std::vector<AdvertisingPacketContentFilterCommand> filters) {
     if (!is_filter_supported_) {
-      LOG_WARN("Advertising filter is not supported");
+      software_scan_filter_add(filter_index, filters);
       return;
     }
 
@@ -844,6 +895,56 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     }
   }
 
+  bool software_scan_filter_active() const {
+    return !is_filter_supported_ && software_scan_filter_enabled_ && !software_scan_filter_.IsEmpty();
+  }
+
+  void software_scan_filter_add(
+      uint8_t filter_index, const std::vector<AdvertisingPacketContentFilterCommand>& filters) {
+    for (const auto& filter : filters) {
+      bool added = false;
+      switch (filter.filter_type) {
+        case ApcfFilterType::BROADCASTER_ADDRESS: {
+          std::optional<std::array<uint8_t, 16>> irk;
+          if (!is_empty_128bit(filter.irk)) {
+            irk = filter.irk;
+          }
+          added = software_scan_filter_.AddAddressFilter(filter_index, filter.address, irk);
+          break;
+        }
+        case ApcfFilterType::SERVICE_UUID:
+        case ApcfFilterType::SERVICE_SOLICITATION_UUID:
+          added = software_scan_filter_.AddUuidFilter(
+              filter_index,
+              filter.uuid,
+              filter.uuid_mask,
+              filter.filter_type == ApcfFilterType::SERVICE_SOLICITATION_UUID);
+          break;
+        case ApcfFilterType::LOCAL_NAME:
+          added = software_scan_filter_.AddLocalNameFilter(filter_index, filter.name);
+          break;
+        case ApcfFilterType::MANUFACTURER_DATA:
+          added = software_scan_filter_.AddManufacturerDataFilter(
+              filter_index, filter.company, filter.company_mask, filter.data, filter.data_mask);
+          break;
+        case ApcfFilterType::SERVICE_DATA:
+          added = software_scan_filter_.AddServiceDataFilter(filter_index, filter.data, filter.data_mask);
+          break;
+        case ApcfFilterType::AD_TYPE:
+          added = software_scan_filter_.AddAdTypeFilter(filter_index, filter.ad_type, filter.data, filter.data_mask);
+          break;
+        default:
+          LOG_ERROR("Unknown filter type: %d", (uint16_t)filter.filter_type);
+          break;
+      }
+      scanning_callbacks_->OnFilterConfigCallback(
+          filter.filter_type,
+          software_scan_filter_.AvailableFilters(),
+          ApcfAction::ADD,
+          (uint8_t)(added ? ErrorCode::SUCCESS : ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+    }
+  }
+
   std::unordered_map<uint8_t, AddressWithType> remove_me_later_map_;
 
   void update_address_filter(
@@ -1186,10 +1287,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
 
-    if (batch_scan_result_cache_.find(scanner_id) == batch_scan_result_cache_.end()) {
-      std::vector<uint8_t> empty_data = {};
-      batch_scan_result_cache_.emplace(scanner_id, empty_data);
-    }
+    batch_scan_result_cache_.try_emplace(scanner_id);
 
     le_scanning_interface_->EnqueueCommand(
         LeBatchScanReadResultParametersBuilder::Create(static_cast<BatchScanDataRead>(scan_mode)),
@@ -1497,17 +1595,26 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
     }
     uint8_t num_of_records = complete_view.GetNumOfRecords();
     auto report_format = complete_view.GetBatchScanDataRead();
-    if (num_of_records == 0) {
-      scanning_callbacks_->OnBatchScanReports(
-          scanner_id, 0x00, (int)report_format, total_num_of_records, batch_scan_result_cache_[scanner_id]);
-      batch_scan_result_cache_.erase(scanner_id);
-    } else {
+    auto cache = batch_scan_result_cache_.try_emplace(scanner_id).first;
+    if (num_of_records != 0) {
+      // Append each chunk as it comes, the records are reported as soon as the last one or the size bound is reached
       auto raw_data = complete_view.GetRawData();
-      batch_scan_result_cache_[scanner_id].insert(
-          batch_scan_result_cache_[scanner_id].end(), raw_data.begin(), raw_data.end());
+      if (cache->second.empty()) {
+        cache->second = std::move(raw_data);
+      } else {
+        cache->second.insert(cache->second.end(), raw_data.begin(), raw_data.end());
+      }
       total_num_of_records += num_of_records;
-      batch_scan_read_results(scanner_id, total_num_of_records, static_cast<BatchScanMode>(report_format));
+      if (batch_scan_max_report_bytes_ == 0 || cache->second.size() < batch_scan_max_report_bytes_) {
+        batch_scan_read_results(scanner_id, total_num_of_records, static_cast<BatchScanMode>(report_format));
+        return;
+      }
+      LOG_INFO("Reporting %u batch scan records, the others stay in the controller", total_num_of_records);
     }
+    auto data = std::move(cache->second);
+    batch_scan_result_cache_.erase(cache);
+    scanning_callbacks_->OnBatchScanReports(
+        scanner_id, 0x00, (int)report_format, total_num_of_records, std::move(data));
   }
 
   void on_storage_threshold_breach(VendorSpecificEventView event) {
@@ -1598,7 +1705,15 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   bool scan_on_resume_ = false;
   bool paused_ = false;
   AdvertisingCache advertising_cache_;
+  std::vector<uint8_t> significant_data_;
+  ScanResultFilter scan_result_filter_;
+  std::chrono::milliseconds scan_result_batch_interval_{0};
+  std::unique_ptr<os::Alarm> scan_result_batch_alarm_;
+  std::vector<ScanResult> pending_scan_results_;
   bool is_filter_supported_ = false;
+  // Evaluates the scan filters on the host when the controller doesn't support APCF
+  SoftwareScanFilter software_scan_filter_;
+  bool software_scan_filter_enabled_ = false;
   bool is_ad_type_filter_supported_ = false;
   bool is_batch_scan_supported_ = false;
   bool is_periodic_advertising_sync_transfer_sender_supported_ = false;
@@ -1610,6 +1725,7 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
   LeScanningFilterPolicy filter_policy_{LeScanningFilterPolicy::ACCEPT_ALL};
   BatchScanConfig batch_scan_config_;
   std::map<ScannerId, std::vector<uint8_t>> batch_scan_result_cache_;
+  uint32_t batch_scan_max_report_bytes_ = kDefaultBatchScanMaxReportBytes;
   std::unordered_map<uint8_t, ScannerId> tracker_id_map_;
   uint16_t total_num_of_advt_tracked_ = 0x00;
 
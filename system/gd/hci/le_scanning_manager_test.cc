@@ -367,6 +367,43 @@ TEST_F(LeScanningManagerTest, start_scan_test) {
   test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({report}));
 }
 
+TEST_F(LeScanningManagerTest, software_scan_filter_test) {
+  start_le_scanning_manager();
+  EXPECT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  le_scanning_manager->Scan(true);
+  EXPECT_EQ(OpCode::LE_SET_SCAN_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  EXPECT_EQ(OpCode::LE_SET_SCAN_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetScanEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // Without APCF, the filters are evaluated on the host
+  auto filter = make_filter(hci::ApcfFilterType::AD_TYPE);
+  filter.ad_type = static_cast<uint8_t>(GapDataType::FLAGS);
+  filter.data = {0x35};
+  filter.data_mask = {0xff};
+  EXPECT_CALL(
+      mock_callbacks_,
+      OnFilterConfigCallback(ApcfFilterType::AD_TYPE, _, ApcfAction::ADD, (uint8_t)ErrorCode::SUCCESS));
+  le_scanning_manager->ScanFilterAdd(0x01, {filter});
+  EXPECT_CALL(mock_callbacks_, OnFilterEnable(Enable::ENABLED, (uint8_t)ErrorCode::SUCCESS));
+  le_scanning_manager->ScanFilterEnable(true);
+  sync_client_handler();
+
+  // The flags of the report don't match
+  EXPECT_CALL(mock_callbacks_, OnScanResult).Times(0);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({make_advertising_report()}));
+  sync_client_handler();
+  testing::Mock::VerifyAndClearExpectations(&mock_callbacks_);
+
+  filter.data = {0x34};
+  EXPECT_CALL(mock_callbacks_, OnFilterConfigCallback);
+  le_scanning_manager->ScanFilterAdd(0x02, {filter});
+  EXPECT_CALL(mock_callbacks_, OnScanResult);
+  test_hci_layer_->IncomingLeMetaEvent(LeAdvertisingReportBuilder::Create({make_advertising_report()}));
+  sync_client_handler();
+}
+
 TEST_F(LeScanningManagerTest, is_ad_type_filter_supported_false_test) {
   start_le_scanning_manager();
   ASSERT_TRUE(fake_registry_.IsStarted(&HciLayer::Factory));
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/scan_result_filter.h"
+
+namespace bluetooth {
+namespace hci {
+
+namespace {
+
+// FNV-1a, good enough to tell advertising data apart and cheap for a few dozen bytes
+uint64_t hash_of(uint16_t event_type, const std::vector<uint8_t>& advertising_data) {
+  constexpr uint64_t kPrime = 0x100000001b3;
+  uint64_t hash = 0xcbf29ce484222325;
+  hash = (hash ^ (event_type & 0xff)) * kPrime;
+  hash = (hash ^ (event_type >> 8)) * kPrime;
+  for (auto byte : advertising_data) {
+    hash = (hash ^ byte) * kPrime;
+  }
+  return hash;
+}
+
+}  // namespace
+
+ScanResultFilter::ScanResultFilter(std::chrono::milliseconds window)
+    : window_(window), delivered_(kMaxTrackedDevices) {}
+
+bool ScanResultFilter::ShouldDeliver(
+    const AddressWithType& address_with_type,
+    uint16_t event_type,
+    const std::vector<uint8_t>& advertising_data,
+    Clock::time_point now) {
+  if (!IsEnabled()) {
+    return true;
+  }
+  auto hash = hash_of(event_type, advertising_data);
+  auto it = delivered_.find(address_with_type);
+  if (it != delivered_.end() && it->second.hash == hash && now - it->second.time < window_) {
+    return false;
+  }
+  delivered_.insert_or_assign(address_with_type, Delivered{.hash = hash, .time = now});
+  return true;
+}
+
+void ScanResultFilter::Clear() {
+  delivered_.clear();
+}
+
+}  // namespace hci
+}  // namespace bluetooth
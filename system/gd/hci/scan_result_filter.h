@@ -0,0 +1,65 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "common/lru_cache.h"
+#include "hci/address_with_type.h"
+
+namespace bluetooth {
+namespace hci {
+
+// Host side duplicate filtering of scan results, for controllers which can't filter them while scanning with
+// duplicates allowed. A result is suppressed if its device delivered the same event type and advertising data less
+// than a window ago, so an unchanged device is still reported once per window. NOT THREAD SAFE
+class ScanResultFilter {
+ public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t kMaxTrackedDevices = 1000;
+
+  // A zero window disables the filtering
+  explicit ScanResultFilter(std::chrono::milliseconds window = std::chrono::milliseconds(0));
+
+  bool IsEnabled() const {
+    return window_.count() > 0;
+  }
+
+  // Return true if the result should be delivered, and remember it as the last result of the device in that case
+  bool ShouldDeliver(
+      const AddressWithType& address_with_type,
+      uint16_t event_type,
+      const std::vector<uint8_t>& advertising_data,
+      Clock::time_point now = Clock::now());
+
+  // Forget every device, such as when scanning stops
+  void Clear();
+
+ private:
+  struct Delivered {
+    uint64_t hash;
+    Clock::time_point time;
+  };
+
+  std::chrono::milliseconds window_;
+  common::LruCache<AddressWithType, Delivered> delivered_;
+};
+
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/scan_result_filter.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+using std::chrono::milliseconds;
+
+const AddressWithType kDevice(Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), AddressType::PUBLIC_DEVICE_ADDRESS);
+const AddressWithType kOtherDevice(Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x07}), AddressType::PUBLIC_DEVICE_ADDRESS);
+constexpr uint16_t kEventType = 0x13;
+
+TEST(ScanResultFilterTest, disabled_delivers_everything) {
+  ScanResultFilter filter;
+  ASSERT_FALSE(filter.IsEnabled());
+  auto now = ScanResultFilter::Clock::now();
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType, {1, 2}, now));
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType, {1, 2}, now));
+}
+
+TEST(ScanResultFilterTest, suppress_unchanged_repeats_in_window) {
+  ScanResultFilter filter(milliseconds(100));
+  auto now = ScanResultFilter::Clock::now();
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType, {1, 2}, now));
+  ASSERT_FALSE(filter.ShouldDeliver(kDevice, kEventType, {1, 2}, now + milliseconds(50)));
+  // Other devices, event types, and data aren't duplicates
+  ASSERT_TRUE(filter.ShouldDeliver(kOtherDevice, kEventType, {1, 2}, now + milliseconds(50)));
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType + 1, {1, 2}, now + milliseconds(60)));
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType + 1, {1, 3}, now + milliseconds(70)));
+  ASSERT_FALSE(filter.ShouldDeliver(kDevice, kEventType + 1, {1, 3}, now + milliseconds(80)));
+}
+
+TEST(ScanResultFilterTest, deliver_unchanged_device_once_per_window) {
+  ScanResultFilter filter(milliseconds(100));
+  auto now = ScanResultFilter::Clock::now();
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType, {1}, now));
+  ASSERT_FALSE(filter.ShouldDeliver(kDevice, kEventType, {1}, now + milliseconds(99)));
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType, {1}, now + milliseconds(100)));
+  ASSERT_FALSE(filter.ShouldDeliver(kDevice, kEventType, {1}, now + milliseconds(150)));
+
+  filter.Clear();
+  ASSERT_TRUE(filter.ShouldDeliver(kDevice, kEventType, {1}, now + milliseconds(150)));
+}
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
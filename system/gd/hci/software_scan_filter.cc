@@ -0,0 +1,366 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/software_scan_filter.h"
+
+#include <algorithm>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace hci {
+
+namespace {
+
+// AD types, from the Assigned Numbers
+constexpr uint8_t kIncomplete16BitServiceUuids = 0x02;
+constexpr uint8_t kComplete16BitServiceUuids = 0x03;
+constexpr uint8_t kIncomplete32BitServiceUuids = 0x04;
+constexpr uint8_t kComplete32BitServiceUuids = 0x05;
+constexpr uint8_t kIncomplete128BitServiceUuids = 0x06;
+constexpr uint8_t kComplete128BitServiceUuids = 0x07;
+constexpr uint8_t kShortenedLocalName = 0x08;
+constexpr uint8_t kCompleteLocalName = 0x09;
+constexpr uint8_t k16BitSolicitationUuids = 0x14;
+constexpr uint8_t k128BitSolicitationUuids = 0x15;
+constexpr uint8_t k16BitServiceData = 0x16;
+constexpr uint8_t k32BitSolicitationUuids = 0x1f;
+constexpr uint8_t k32BitServiceData = 0x20;
+constexpr uint8_t k128BitServiceData = 0x21;
+constexpr uint8_t kManufacturerSpecificData = 0xff;
+
+bool masked_equal(const uint8_t* data, const uint8_t* value, const uint8_t* mask, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if ((data[i] & mask[i]) != (value[i] & mask[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Uuid::UUID128Bit uuid_from_le(const uint8_t* data, size_t width) {
+  switch (width) {
+    case Uuid::kNumBytes16:
+      return Uuid::From16Bit(data[0] | (data[1] << 8)).To128BitLE();
+    case Uuid::kNumBytes32:
+      return Uuid::From32Bit(data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24))
+          .To128BitLE();
+    default:
+      return Uuid::From128BitLE(data).To128BitLE();
+  }
+}
+
+// An empty mask compares all the bytes of the data
+std::optional<std::vector<uint8_t>> mask_for(const std::vector<uint8_t>& data, const std::vector<uint8_t>& data_mask) {
+  if (data_mask.empty()) {
+    return std::vector<uint8_t>(data.size(), 0xff);
+  }
+  if (data_mask.size() != data.size()) {
+    LOG_ERROR("data and data_mask are of different size");
+    return std::nullopt;
+  }
+  return data_mask;
+}
+
+}  // namespace
+
+bool SoftwareScanFilter::Condition::Test(const uint8_t* data, size_t size) const {
+  if (uuid_width == 0) {
+    return size >= value.size() && masked_equal(data, value.data(), mask.data(), value.size());
+  }
+  for (size_t offset = 0; offset + uuid_width <= size; offset += uuid_width) {
+    auto uuid = uuid_from_le(data + offset, uuid_width);
+    if (masked_equal(uuid.data(), value.data(), mask.data(), uuid.size())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+SoftwareScanFilter::Match::Match(const SoftwareScanFilter& filter, const AddressWithType& address_with_type)
+    : filter_(filter) {
+  for (const auto& condition : filter_.address_conditions_) {
+    if (address_with_type.GetAddress() == condition.address ||
+        (condition.irk && address_with_type.IsRpaThatMatchesIrk(*condition.irk))) {
+      matched_kinds_[condition.slot] |= ADDRESS;
+    }
+  }
+}
+
+void SoftwareScanFilter::Match::AddStructure(uint8_t ad_type, const uint8_t* data, size_t size) {
+  for (size_t i = filter_.first_condition_[ad_type]; i < filter_.first_condition_[ad_type + 1]; i++) {
+    const auto& condition = filter_.conditions_[i];
+    if ((matched_kinds_[condition.slot] & condition.kind) == 0 && condition.Test(data, size)) {
+      matched_kinds_[condition.slot] |= condition.kind;
+    }
+  }
+}
+
+bool SoftwareScanFilter::Match::Matches() const {
+  for (size_t slot = 0; slot < kMaxFilters; slot++) {
+    auto required = filter_.required_kinds_[slot];
+    if (required != 0 && (matched_kinds_[slot] & required) == required) {
+      return true;
+    }
+  }
+  return false;
+}
+
+SoftwareScanFilter::SoftwareScanFilter() {
+  slot_of_index_.fill(kNoSlot);
+}
+
+std::optional<uint8_t> SoftwareScanFilter::slot_for(uint8_t filter_index) {
+  if (slot_of_index_[filter_index] != kNoSlot) {
+    return slot_of_index_[filter_index];
+  }
+  for (uint8_t slot = 0; slot < kMaxFilters; slot++) {
+    if (!used_slots_[slot]) {
+      used_slots_[slot] = true;
+      slot_of_index_[filter_index] = slot;
+      return slot;
+    }
+  }
+  LOG_WARN("No space left for filter index %d", filter_index);
+  return std::nullopt;
+}
+
+void SoftwareScanFilter::add_condition(uint8_t slot, Condition condition) {
+  condition.slot = slot;
+  required_kinds_[slot] |= condition.kind;
+  conditions_.push_back(std::move(condition));
+}
+
+void SoftwareScanFilter::compile() {
+  std::stable_sort(conditions_.begin(), conditions_.end(), [](const Condition& a, const Condition& b) {
+    return a.ad_type < b.ad_type;
+  });
+  first_condition_.fill(0);
+  for (const auto& condition : conditions_) {
+    first_condition_[condition.ad_type + 1]++;
+  }
+  for (size_t ad_type = 1; ad_type < first_condition_.size(); ad_type++) {
+    first_condition_[ad_type] += first_condition_[ad_type - 1];
+  }
+}
+
+bool SoftwareScanFilter::AddAddressFilter(
+    uint8_t filter_index, const Address& address, std::optional<std::array<uint8_t, 16>> irk) {
+  auto slot = slot_for(filter_index);
+  if (!slot) {
+    return false;
+  }
+  address_conditions_.push_back({.slot = *slot, .address = address, .irk = irk});
+  required_kinds_[*slot] |= ADDRESS;
+  return true;
+}
+
+bool SoftwareScanFilter::AddUuidFilter(
+    uint8_t filter_index, const Uuid& uuid, const Uuid& uuid_mask, bool solicitation) {
+  auto slot = slot_for(filter_index);
+  if (!slot) {
+    return false;
+  }
+  // Compare every UUID of the report as a 128 bit UUID, with the mask applied to the bytes of the shortest
+  // representation of the filter, as APCF does
+  auto value = uuid.To128BitLE();
+  Uuid::UUID128Bit mask;
+  mask.fill(0xff);
+  if (!uuid_mask.IsEmpty()) {
+    switch (uuid.GetShortestRepresentationSize()) {
+      case Uuid::kNumBytes16: {
+        auto mask16 = uuid_mask.As16Bit();
+        mask[12] = static_cast<uint8_t>(mask16);
+        mask[13] = static_cast<uint8_t>(mask16 >> 8);
+      } break;
+      case Uuid::kNumBytes32: {
+        auto mask32 = uuid_mask.As32Bit();
+        for (size_t i = 0; i < Uuid::kNumBytes32; i++) {
+          mask[12 + i] = static_cast<uint8_t>(mask32 >> (8 * i));
+        }
+      } break;
+      default:
+        mask = uuid_mask.To128BitLE();
+        break;
+    }
+  }
+  std::vector<std::pair<uint8_t, uint8_t>> ad_types;  // AD type and width of its UUIDs
+  if (solicitation) {
+    ad_types = {{k16BitSolicitationUuids, Uuid::kNumBytes16},
+                {k32BitSolicitationUuids, Uuid::kNumBytes32},
+                {k128BitSolicitationUuids, Uuid::kNumBytes128}};
+  } else {
+    ad_types = {{kIncomplete16BitServiceUuids, Uuid::kNumBytes16},
+                {kComplete16BitServiceUuids, Uuid::kNumBytes16},
+                {kIncomplete32BitServiceUuids, Uuid::kNumBytes32},
+                {kComplete32BitServiceUuids, Uuid::kNumBytes32},
+                {kIncomplete128BitServiceUuids, Uuid::kNumBytes128},
+                {kComplete128BitServiceUuids, Uuid::kNumBytes128}};
+  }
+  for (auto [ad_type, width] : ad_types) {
+    add_condition(
+        *slot,
+        Condition{
+            .ad_type = ad_type,
+            .kind = solicitation ? SOLICITATION_UUID : SERVICE_UUID,
+            .uuid_width = width,
+            .value = std::vector<uint8_t>(value.begin(), value.end()),
+            .mask = std::vector<uint8_t>(mask.begin(), mask.end()),
+        });
+  }
+  compile();
+  return true;
+}
+
+bool SoftwareScanFilter::AddLocalNameFilter(uint8_t filter_index, const std::vector<uint8_t>& name) {
+  auto slot = slot_for(filter_index);
+  if (!slot) {
+    return false;
+  }
+  // The name of the report starts with the name of the filter
+  for (auto ad_type : {kShortenedLocalName, kCompleteLocalName}) {
+    add_condition(
+        *slot,
+        Condition{
+            .ad_type = ad_type,
+            .kind = LOCAL_NAME,
+            .uuid_width = 0,
+            .value = name,
+            .mask = std::vector<uint8_t>(name.size(), 0xff),
+        });
+  }
+  compile();
+  return true;
+}
+
+bool SoftwareScanFilter::AddManufacturerDataFilter(
+    uint8_t filter_index,
+    uint16_t company,
+    uint16_t company_mask,
+    const std::vector<uint8_t>& data,
+    const std::vector<uint8_t>& data_mask) {
+  auto mask = mask_for(data, data_mask);
+  if (!mask) {
+    return false;
+  }
+  auto slot = slot_for(filter_index);
+  if (!slot) {
+    return false;
+  }
+  if (company_mask == 0) {
+    company_mask = 0xffff;
+  }
+  std::vector<uint8_t> value = {static_cast<uint8_t>(company), static_cast<uint8_t>(company >> 8)};
+  value.insert(value.end(), data.begin(), data.end());
+  mask->insert(mask->begin(), {static_cast<uint8_t>(company_mask), static_cast<uint8_t>(company_mask >> 8)});
+  add_condition(
+      *slot,
+      Condition{
+          .ad_type = kManufacturerSpecificData,
+          .kind = MANUFACTURER_DATA,
+          .uuid_width = 0,
+          .value = std::move(value),
+          .mask = std::move(*mask),
+      });
+  compile();
+  return true;
+}
+
+bool SoftwareScanFilter::AddServiceDataFilter(
+    uint8_t filter_index, const std::vector<uint8_t>& data, const std::vector<uint8_t>& data_mask) {
+  auto mask = mask_for(data, data_mask);
+  if (!mask) {
+    return false;
+  }
+  auto slot = slot_for(filter_index);
+  if (!slot) {
+    return false;
+  }
+  for (auto ad_type : {k16BitServiceData, k32BitServiceData, k128BitServiceData}) {
+    add_condition(
+        *slot,
+        Condition{.ad_type = ad_type, .kind = SERVICE_DATA, .uuid_width = 0, .value = data, .mask = *mask});
+  }
+  compile();
+  return true;
+}
+
+bool SoftwareScanFilter::AddAdTypeFilter(
+    uint8_t filter_index, uint8_t ad_type, const std::vector<uint8_t>& data, const std::vector<uint8_t>& data_mask) {
+  auto mask = mask_for(data, data_mask);
+  if (!mask) {
+    return false;
+  }
+  auto slot = slot_for(filter_index);
+  if (!slot) {
+    return false;
+  }
+  add_condition(
+      *slot,
+      Condition{.ad_type = ad_type, .kind = AD_TYPE, .uuid_width = 0, .value = data, .mask = std::move(*mask)});
+  compile();
+  return true;
+}
+
+void SoftwareScanFilter::RemoveFilter(uint8_t filter_index) {
+  auto slot = slot_of_index_[filter_index];
+  if (slot == kNoSlot) {
+    return;
+  }
+  conditions_.erase(
+      std::remove_if(
+          conditions_.begin(),
+          conditions_.end(),
+          [slot](const Condition& condition) { return condition.slot == slot; }),
+      conditions_.end());
+  address_conditions_.erase(
+      std::remove_if(
+          address_conditions_.begin(),
+          address_conditions_.end(),
+          [slot](const AddressCondition& condition) { return condition.slot == slot; }),
+      address_conditions_.end());
+  required_kinds_[slot] = 0;
+  used_slots_[slot] = false;
+  slot_of_index_[filter_index] = kNoSlot;
+  compile();
+}
+
+void SoftwareScanFilter::Clear() {
+  conditions_.clear();
+  address_conditions_.clear();
+  required_kinds_.fill(0);
+  used_slots_.reset();
+  slot_of_index_.fill(kNoSlot);
+  compile();
+}
+
+bool SoftwareScanFilter::Matches(
+    const AddressWithType& address_with_type, const std::vector<uint8_t>& advertising_data) const {
+  Match match(*this, address_with_type);
+  size_t offset = 0;
+  while (offset < advertising_data.size()) {
+    size_t length = advertising_data[offset];
+    if (length == 0 || offset + 1 + length > advertising_data.size()) {
+      break;
+    }
+    match.AddStructure(advertising_data[offset + 1], advertising_data.data() + offset + 2, length - 1);
+    offset += 1 + length;
+  }
+  return match.Matches();
+}
+
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "hci/address_with_type.h"
+#include "hci/uuid.h"
+
+namespace bluetooth {
+namespace hci {
+
+// Host side evaluation of advertising packet content filters, for controllers without APCF. The filters are compiled
+// into conditions indexed by AD type, so a report costs one pass over its AD structures and each structure is only
+// compared with the conditions on its AD type. A report is accepted when all the kinds of content filters of one
+// filter index match, any filter of a given kind being enough. NOT THREAD SAFE
+class SoftwareScanFilter {
+ public:
+  static constexpr size_t kMaxFilters = 32;
+
+  // Evaluation of one report, fed with its AD structures one at a time without copying them
+  class Match {
+   public:
+    Match(const SoftwareScanFilter& filter, const AddressWithType& address_with_type);
+
+    // Evaluate the AD structure of type |ad_type| whose data, not including the type, is |data|
+    void AddStructure(uint8_t ad_type, const uint8_t* data, size_t size);
+
+    bool Matches() const;
+
+   private:
+    const SoftwareScanFilter& filter_;
+    std::array<uint8_t, kMaxFilters> matched_kinds_{};
+  };
+
+  SoftwareScanFilter();
+
+  // Each Add method returns false if all the filter indexes are in use, or if the filter is malformed
+  bool AddAddressFilter(uint8_t filter_index, const Address& address, std::optional<std::array<uint8_t, 16>> irk);
+  bool AddUuidFilter(uint8_t filter_index, const Uuid& uuid, const Uuid& uuid_mask, bool solicitation);
+  bool AddLocalNameFilter(uint8_t filter_index, const std::vector<uint8_t>& name);
+  bool AddManufacturerDataFilter(
+      uint8_t filter_index,
+      uint16_t company,
+      uint16_t company_mask,
+      const std::vector<uint8_t>& data,
+      const std::vector<uint8_t>& data_mask);
+  // |data| starts with the service UUID, as with APCF
+  bool AddServiceDataFilter(
+      uint8_t filter_index, const std::vector<uint8_t>& data, const std::vector<uint8_t>& data_mask);
+  bool AddAdTypeFilter(
+      uint8_t filter_index, uint8_t ad_type, const std::vector<uint8_t>& data, const std::vector<uint8_t>& data_mask);
+
+  void RemoveFilter(uint8_t filter_index);
+  void Clear();
+
+  bool IsEmpty() const {
+    return used_slots_.none();
+  }
+
+  size_t AvailableFilters() const {
+    return kMaxFilters - used_slots_.count();
+  }
+
+  // Evaluate a report whose advertising data is a sequence of length, AD type, data structures
+  bool Matches(const AddressWithType& address_with_type, const std::vector<uint8_t>& advertising_data) const;
+
+ private:
+  // Kinds of content filters, as bits of the kinds required and matched by a filter index
+  enum Kind : uint8_t {
+    ADDRESS = 1 << 0,
+    SERVICE_UUID = 1 << 1,
+    SOLICITATION_UUID = 1 << 2,
+    LOCAL_NAME = 1 << 3,
+    MANUFACTURER_DATA = 1 << 4,
+    SERVICE_DATA = 1 << 5,
+    AD_TYPE = 1 << 6,
+  };
+
+  struct Condition {
+    uint8_t ad_type;
+    uint8_t slot;
+    Kind kind;
+    // Width of each UUID of a list of UUIDs, or 0 to compare the data with value under mask
+    uint8_t uuid_width;
+    std::vector<uint8_t> value;
+    std::vector<uint8_t> mask;
+
+    bool Test(const uint8_t* data, size_t size) const;
+  };
+
+  struct AddressCondition {
+    uint8_t slot;
+    Address address;
+    std::optional<std::array<uint8_t, 16>> irk;
+  };
+
+  std::optional<uint8_t> slot_for(uint8_t filter_index);
+  void add_condition(uint8_t slot, Condition condition);
+  void compile();
+
+  // Slot of each filter index in use, kNoSlot otherwise
+  static constexpr uint8_t kNoSlot = 0xff;
+  std::array<uint8_t, 256> slot_of_index_;
+  std::bitset<kMaxFilters> used_slots_;
+  std::array<uint8_t, kMaxFilters> required_kinds_{};
+  std::vector<AddressCondition> address_conditions_;
+  std::vector<Condition> conditions_;
+  // The conditions on AD type t are conditions_[first_condition_[t]] to conditions_[first_condition_[t + 1]], excluded
+  std::array<uint16_t, 257> first_condition_{};
+};
+
+}  // namespace hci
+}  // namespace bluetooth
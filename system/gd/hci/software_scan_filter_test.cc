@@ -0,0 +1,143 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/software_scan_filter.h"
+
+#include <gtest/gtest.h>
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+const AddressWithType kDevice(Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), AddressType::PUBLIC_DEVICE_ADDRESS);
+const AddressWithType kOtherDevice(Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x07}), AddressType::RANDOM_DEVICE_ADDRESS);
+
+// Flags, complete 16 bit service UUIDs 0x180d and 0xfeaa, complete local name "Beacon", manufacturer data of company
+// 0x004c, and service data of 0xfeaa
+const std::vector<uint8_t> kAdvertisingData = {
+    0x02, 0x01, 0x06,                                // flags
+    0x05, 0x03, 0x0d, 0x18, 0xaa, 0xfe,              // service UUIDs
+    0x07, 0x09, 'B',  'e',  'a',  'c',  'o',  'n',   // name
+    0x05, 0xff, 0x4c, 0x00, 0x02, 0x15,              // manufacturer data
+    0x05, 0x16, 0xaa, 0xfe, 0x10, 0x20,              // service data
+};
+
+TEST(SoftwareScanFilterTest, empty_filter) {
+  SoftwareScanFilter filter;
+  ASSERT_TRUE(filter.IsEmpty());
+  ASSERT_EQ(SoftwareScanFilter::kMaxFilters, filter.AvailableFilters());
+  ASSERT_FALSE(filter.Matches(kDevice, kAdvertisingData));
+}
+
+TEST(SoftwareScanFilterTest, address_filter) {
+  SoftwareScanFilter filter;
+  ASSERT_TRUE(filter.AddAddressFilter(1, kDevice.GetAddress(), std::nullopt));
+  ASSERT_FALSE(filter.IsEmpty());
+  ASSERT_TRUE(filter.Matches(kDevice, {}));
+  ASSERT_FALSE(filter.Matches(kOtherDevice, kAdvertisingData));
+}
+
+TEST(SoftwareScanFilterTest, uuid_filter) {
+  SoftwareScanFilter filter;
+  ASSERT_TRUE(filter.AddUuidFilter(1, Uuid::From16Bit(0xfeaa), Uuid::kEmpty, false));
+  ASSERT_TRUE(filter.Matches(kDevice, kAdvertisingData));
+  ASSERT_FALSE(filter.Matches(kDevice, {0x03, 0x03, 0x0f, 0x18}));
+  // The same UUID advertised in its 128 bit form also matches
+  auto uuid128 = Uuid::From16Bit(0xfeaa).To128BitLE();
+  std::vector<uint8_t> data = {0x11, 0x07};
+  data.insert(data.end(), uuid128.begin(), uuid128.end());
+  ASSERT_TRUE(filter.Matches(kDevice, data));
+
+  // A solicitation filter doesn't look at service UUIDs
+  SoftwareScanFilter solicitation;
+  ASSERT_TRUE(solicitation.AddUuidFilter(1, Uuid::From16Bit(0xfeaa), Uuid::kEmpty, true));
+  ASSERT_FALSE(solicitation.Matches(kDevice, kAdvertisingData));
+  ASSERT_TRUE(solicitation.Matches(kDevice, {0x03, 0x14, 0xaa, 0xfe}));
+
+  // Masked UUIDs only compare the bits of the mask
+  SoftwareScanFilter masked;
+  ASSERT_TRUE(masked.AddUuidFilter(1, Uuid::From16Bit(0x1800), Uuid::From16Bit(0xff00), false));
+  ASSERT_TRUE(masked.Matches(kDevice, kAdvertisingData));
+  ASSERT_FALSE(masked.Matches(kDevice, {0x03, 0x03, 0x0d, 0x19}));
+}
+
+TEST(SoftwareScanFilterTest, content_filters) {
+  SoftwareScanFilter name;
+  ASSERT_TRUE(name.AddLocalNameFilter(1, {'B', 'e', 'a'}));
+  ASSERT_TRUE(name.Matches(kDevice, kAdvertisingData));
+  ASSERT_FALSE(name.Matches(kDevice, {0x03, 0x09, 'B', 'e'}));
+
+  SoftwareScanFilter manufacturer;
+  ASSERT_TRUE(manufacturer.AddManufacturerDataFilter(1, 0x004c, 0, {0x02, 0x00}, {0xff, 0x00}));
+  ASSERT_TRUE(manufacturer.Matches(kDevice, kAdvertisingData));
+  ASSERT_FALSE(manufacturer.Matches(kDevice, {0x05, 0xff, 0x4d, 0x00, 0x02, 0x15}));
+  ASSERT_FALSE(manufacturer.AddManufacturerDataFilter(2, 0x004c, 0, {0x02, 0x00}, {0xff}));
+
+  SoftwareScanFilter service_data;
+  ASSERT_TRUE(service_data.AddServiceDataFilter(1, {0xaa, 0xfe, 0x10}, {}));
+  ASSERT_TRUE(service_data.Matches(kDevice, kAdvertisingData));
+  ASSERT_FALSE(service_data.Matches(kDevice, {0x04, 0x16, 0xaa, 0xfe, 0x11}));
+
+  SoftwareScanFilter ad_type;
+  ASSERT_TRUE(ad_type.AddAdTypeFilter(1, 0x01, {}, {}));
+  ASSERT_TRUE(ad_type.Matches(kDevice, kAdvertisingData));
+  ASSERT_FALSE(ad_type.Matches(kDevice, {0x03, 0x09, 'B', 'e'}));
+}
+
+TEST(SoftwareScanFilterTest, all_kinds_of_a_filter_index_match) {
+  SoftwareScanFilter filter;
+  // Filter index 1 is a name and either of two UUIDs, filter index 2 is an address
+  ASSERT_TRUE(filter.AddLocalNameFilter(1, {'B', 'e', 'a', 'c', 'o', 'n'}));
+  ASSERT_TRUE(filter.AddUuidFilter(1, Uuid::From16Bit(0x1234), Uuid::kEmpty, false));
+  ASSERT_TRUE(filter.AddUuidFilter(1, Uuid::From16Bit(0x180d), Uuid::kEmpty, false));
+  ASSERT_TRUE(filter.AddAddressFilter(2, kOtherDevice.GetAddress(), std::nullopt));
+  ASSERT_EQ(SoftwareScanFilter::kMaxFilters - 2, filter.AvailableFilters());
+
+  ASSERT_TRUE(filter.Matches(kDevice, kAdvertisingData));
+  ASSERT_FALSE(filter.Matches(kDevice, {0x07, 0x09, 'B', 'e', 'a', 'c', 'o', 'n'}));
+  ASSERT_TRUE(filter.Matches(kOtherDevice, {}));
+
+  filter.RemoveFilter(1);
+  ASSERT_FALSE(filter.Matches(kDevice, kAdvertisingData));
+  ASSERT_TRUE(filter.Matches(kOtherDevice, {}));
+  filter.Clear();
+  ASSERT_TRUE(filter.IsEmpty());
+  ASSERT_FALSE(filter.Matches(kOtherDevice, {}));
+}
+
+TEST(SoftwareScanFilterTest, filter_indexes_are_limited) {
+  SoftwareScanFilter filter;
+  for (uint8_t i = 0; i < SoftwareScanFilter::kMaxFilters; i++) {
+    ASSERT_TRUE(filter.AddAdTypeFilter(i, 0x01, {}, {}));
+  }
+  ASSERT_EQ(0u, filter.AvailableFilters());
+  ASSERT_FALSE(filter.AddAdTypeFilter(SoftwareScanFilter::kMaxFilters, 0x01, {}, {}));
+  // More content filters can be added to the filter indexes in use
+  ASSERT_TRUE(filter.AddAdTypeFilter(0, 0x02, {}, {}));
+  filter.RemoveFilter(3);
+  ASSERT_TRUE(filter.AddAdTypeFilter(SoftwareScanFilter::kMaxFilters, 0x01, {}, {}));
+}
+
+TEST(SoftwareScanFilterTest, truncated_structures_are_ignored) {
+  SoftwareScanFilter filter;
+  ASSERT_TRUE(filter.AddAdTypeFilter(1, 0x01, {}, {}));
+  ASSERT_FALSE(filter.Matches(kDevice, {0x05, 0x01, 0x06}));
+  ASSERT_FALSE(filter.Matches(kDevice, {0x00, 0x01, 0x06}));
+}
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
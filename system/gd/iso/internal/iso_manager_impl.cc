@@ -103,12 +103,14 @@ void IsoManagerImpl::SetCigParameters(
           &IsoManagerImpl::SetCigParametersComplete,
           common::Unretained(this),
           cig_id,
+          sdu_interval_m_to_s,
           cis_configs,
           std::move(command_complete_callback)));
 }
 
 void IsoManagerImpl::SetCigParametersComplete(
     uint8_t cig_id,
+    uint32_t sdu_interval_m_to_s,
     const std::vector<hci::CisParametersConfig>& cis_configs,
     SetCigParametersCallback command_complete_callback,
     hci::CommandCompleteView command_complete) {
@@ -136,6 +138,7 @@ void IsoManagerImpl::SetCigParametersComplete(
           .connection_handle = *handle_it,
       });
 
+      iso_tx_states_[*handle_it] = IsoTxState{.sdu_interval_us = sdu_interval_m_to_s};
       handles.push_back(*handle_it);
 
       cis_it++;
@@ -176,12 +179,14 @@ void IsoManagerImpl::SetCigParametersTest(
           &IsoManagerImpl::SetCigParametersTestComplete,
           common::Unretained(this),
           cig_id,
+          sdu_interval_m_to_s,
           cis_test_configs,
           std::move(command_complete_callback)));
 }
 
 void IsoManagerImpl::SetCigParametersTestComplete(
     uint8_t cig_id,
+    uint32_t sdu_interval_m_to_s,
     const std::vector<hci::LeCisParametersTestConfig>& cis_configs,
     SetCigParametersCallback command_complete_callback,
     hci::CommandCompleteView command_complete) {
@@ -209,6 +214,7 @@ void IsoManagerImpl::SetCigParametersTestComplete(
           .connection_handle = *handle_it,
       });
 
+      iso_tx_states_[*handle_it] = IsoTxState{.sdu_interval_us = sdu_interval_m_to_s};
       handles.push_back(*handle_it);
 
       cis_it++;
@@ -238,6 +244,20 @@ void IsoManagerImpl::LeCreateCis(std::vector<std::pair<uint16_t, uint16_t>> cis_
 void IsoManagerImpl::RemoveCig(uint8_t cig_id) {
   ASSERT(IsKnownCig(cig_id));
 
+  for (const auto& connection : iso_connections_) {
+    auto state = iso_tx_states_.find(connection.connection_handle);
+    if (connection.cig_id != cig_id || state == iso_tx_states_.end()) {
+      continue;
+    }
+    LOG_INFO(
+        "cis_handle=0x%04hx sent=%llu late=%llu dropped=%llu",
+        connection.connection_handle,
+        static_cast<unsigned long long>(state->second.sent_sdu_count),
+        static_cast<unsigned long long>(state->second.late_sdu_count),
+        static_cast<unsigned long long>(state->second.dropped_sdu_count));
+    iso_tx_states_.erase(state);
+  }
+
   hci_le_iso_interface_->EnqueueCommand(
       hci::LeRemoveCigBuilder::Create(cig_id),
       iso_handler_->BindOnce(&IsoManagerImpl::RemoveCigComplete, common::Unretained(this)));
@@ -251,14 +271,95 @@ void IsoManagerImpl::RemoveCigComplete(hci::CommandCompleteView command_complete
 }
 
 void IsoManagerImpl::SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet) {
-  auto builder = hci::IsoWithoutTimestampBuilder::Create(
+  auto& state = iso_tx_states_[cis_handle];
+  iso_enqueue_buffer_->Enqueue(
+      BuildIsoPacket(cis_handle, &state, std::chrono::steady_clock::now(), std::move(packet)), iso_handler_);
+}
+
+void IsoManagerImpl::SendIsoPackets(std::vector<std::pair<uint16_t, std::vector<uint8_t>>> packets) {
+  // The SDUs of one interval share the same time, so that they get the same sequence number on every CIS
+  auto now = std::chrono::steady_clock::now();
+  for (auto& [cis_handle, packet] : packets) {
+    auto& state = iso_tx_states_[cis_handle];
+    iso_enqueue_buffer_->Enqueue(BuildIsoPacket(cis_handle, &state, now, std::move(packet)), iso_handler_);
+  }
+}
+
+std::unique_ptr<hci::IsoBuilder> IsoManagerImpl::BuildIsoPacket(
+    uint16_t cis_handle, IsoTxState* state, std::chrono::steady_clock::time_point now, std::vector<uint8_t> packet) {
+  uint64_t interval = state->next_interval;
+  if (state->sdu_interval_us != 0) {
+    if (!state->started) {
+      state->started = true;
+      state->reference = now;
+    } else {
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - state->reference);
+      uint64_t current_interval = elapsed.count() / state->sdu_interval_us;
+      // Skip the sequence numbers of the intervals which already went by, as the controller would drop their SDUs
+      if (current_interval > interval) {
+        state->late_sdu_count++;
+        state->dropped_sdu_count += current_interval - interval;
+        interval = current_interval;
+      }
+    }
+  }
+  state->next_interval = interval + 1;
+  state->sent_sdu_count++;
+
+  // The first SDU has been sent by the time the second one comes, ask the controller when
+  if (state->sdu_interval_us != 0 && !state->tx_sync_requested && state->sent_sdu_count > 1) {
+    state->tx_sync_requested = true;
+    hci_le_iso_interface_->EnqueueCommand(
+        hci::LeReadIsoTxSyncBuilder::Create(cis_handle),
+        iso_handler_->BindOnce(&IsoManagerImpl::ReadIsoTxSyncComplete, common::Unretained(this), cis_handle));
+  }
+
+  auto sequence_number = static_cast<uint16_t>(interval);
+  auto payload = std::make_unique<bluetooth::packet::RawBuilder>(std::move(packet));
+  if (state->has_tx_sync && interval >= state->tx_sync_interval) {
+    uint64_t since_tx_sync_us = (interval - state->tx_sync_interval) * state->sdu_interval_us;
+    auto time_stamp = static_cast<uint32_t>(state->tx_sync_timestamp_us + since_tx_sync_us);
+    return hci::IsoWithTimestampBuilder::Create(
+        cis_handle,
+        hci::IsoPacketBoundaryFlag::COMPLETE_SDU,
+        time_stamp,
+        sequence_number,
+        hci::IsoPacketStatusFlag::VALID,
+        std::move(payload));
+  }
+  return hci::IsoWithoutTimestampBuilder::Create(
       cis_handle,
       hci::IsoPacketBoundaryFlag::COMPLETE_SDU,
-      0 /* sequence_number*/,
+      sequence_number,
       hci::IsoPacketStatusFlag::VALID,
-      std::make_unique<bluetooth::packet::RawBuilder>(packet));
-  LOG_INFO("%c%c", packet[0], packet[1]);
-  iso_enqueue_buffer_->Enqueue(std::move(builder), iso_handler_);
+      std::move(payload));
+}
+
+void IsoManagerImpl::ReadIsoTxSyncComplete(uint16_t cis_handle, hci::CommandCompleteView command_complete) {
+  ASSERT(command_complete.IsValid());
+
+  auto tx_sync = hci::LeReadIsoTxSyncCompleteView::Create(command_complete);
+  ASSERT(tx_sync.IsValid());
+
+  auto state = iso_tx_states_.find(cis_handle);
+  if (state == iso_tx_states_.end()) {
+    return;
+  }
+  if (tx_sync.GetStatus() != hci::ErrorCode::SUCCESS) {
+    LOG_WARN("cis_handle=0x%04hx status=%s", cis_handle, hci::ErrorCodeText(tx_sync.GetStatus()).c_str());
+    state->second.tx_sync_requested = false;
+    return;
+  }
+
+  // Find the sent interval whose sequence number the controller reports, the sequence numbers wrap around
+  uint64_t last_interval = state->second.next_interval - 1;
+  uint16_t behind = static_cast<uint16_t>(last_interval) - tx_sync.GetPacketSequenceNumber();
+  if (behind > last_interval) {
+    return;
+  }
+  state->second.tx_sync_interval = last_interval - behind;
+  state->second.tx_sync_timestamp_us = tx_sync.GetTimestamp();
+  state->second.has_tx_sync = true;
 }
 
 void IsoManagerImpl::OnIncomingPacket() {
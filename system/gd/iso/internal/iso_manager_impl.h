@@ -16,11 +16,13 @@
 
 #pragma once
 
+#include "common/flat_hash_map.h"
 #include "hci/controller.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "os/handler.h"
 
+#include <chrono>
 #include <list>
 
 namespace bluetooth {
@@ -37,6 +39,28 @@ struct IsochronousConnection {
   uint8_t cis_id;
 };
 
+// Transmit side of a CIS. The SDUs are numbered by the SDU interval they are sent in, counted from the first one.
+struct IsoTxState {
+  // Zero when the SDU interval is unknown, then the SDUs are numbered one after the other
+  uint32_t sdu_interval_us = 0;
+  bool started = false;
+  // Host time at which the interval of the first SDU started
+  std::chrono::steady_clock::time_point reference;
+  uint64_t next_interval = 0;
+
+  // Controller time of one sent SDU, from LE Read ISO TX Sync. Once known, the SDUs carry their timestamp.
+  bool tx_sync_requested = false;
+  bool has_tx_sync = false;
+  uint64_t tx_sync_interval = 0;
+  uint32_t tx_sync_timestamp_us = 0;
+
+  uint64_t sent_sdu_count = 0;
+  // SDUs submitted after their interval had started
+  uint64_t late_sdu_count = 0;
+  // Intervals which went without SDU, the controller had nothing to send in them
+  uint64_t dropped_sdu_count = 0;
+};
+
 class IsoManagerImpl {
  public:
   explicit IsoManagerImpl(os::Handler* iso_handler, hci::HciLayer* hci_layer, hci::Controller* controller);
@@ -65,6 +89,7 @@ class IsoManagerImpl {
       SetCigParametersCallback command_complete_callback);
   void SetCigParametersComplete(
       uint8_t cig_id,
+      uint32_t sdu_interval_m_to_s,
       const std::vector<hci::CisParametersConfig>& cis_configs,
       SetCigParametersCallback command_complete_callback,
       hci::CommandCompleteView command_complete);
@@ -85,6 +110,7 @@ class IsoManagerImpl {
       SetCigParametersCallback command_complete_callback);
   void SetCigParametersTestComplete(
       uint8_t cig_id,
+      uint32_t sdu_interval_m_to_s,
       const std::vector<hci::LeCisParametersTestConfig>& cis_configs,
       SetCigParametersCallback command_complete_callback,
       hci::CommandCompleteView command_complete);
@@ -95,6 +121,9 @@ class IsoManagerImpl {
   void RemoveCigComplete(hci::CommandCompleteView command_complete);
 
   void SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet);
+  // Send the SDUs of one SDU interval, for all the CISes of a CIG, at once
+  void SendIsoPackets(std::vector<std::pair<uint16_t, std::vector<uint8_t>>> packets);
+  void ReadIsoTxSyncComplete(uint16_t cis_handle, hci::CommandCompleteView command_complete);
   void OnIncomingPacket();
 
   bool IsKnownCig(uint8_t cig_id) {
@@ -104,12 +133,16 @@ class IsoManagerImpl {
   }
 
  private:
+  std::unique_ptr<hci::IsoBuilder> BuildIsoPacket(
+      uint16_t cis_handle, IsoTxState* state, std::chrono::steady_clock::time_point now, std::vector<uint8_t> packet);
+
   os::Handler* iso_handler_;
   hci::HciLayer* hci_layer_;
   hci::LeIsoInterface* hci_le_iso_interface_;
   std::unique_ptr<os::EnqueueBuffer<bluetooth::hci::IsoBuilder>> iso_enqueue_buffer_;
   hci::Controller* controller_ __attribute__((unused));
   std::list<IsochronousConnection> iso_connections_;
+  common::FlatHashMap<uint16_t, IsoTxState> iso_tx_states_;
   CisEstablishedCallback cis_established_callback;
   IsoDataCallback iso_data_callback;
 };
@@ -97,7 +97,11 @@ void IsoManager::RemoveCig(uint8_t cig_id) {
 }
 
 void IsoManager::SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet) {
-  iso_handler_->CallOn(iso_manager_impl_, &internal::IsoManagerImpl::SendIsoPacket, cis_handle, packet);
+  iso_handler_->CallOn(iso_manager_impl_, &internal::IsoManagerImpl::SendIsoPacket, cis_handle, std::move(packet));
+}
+
+void IsoManager::SendIsoPackets(std::vector<std::pair<uint16_t, std::vector<uint8_t>>> packets) {
+  iso_handler_->CallOn(iso_manager_impl_, &internal::IsoManagerImpl::SendIsoPackets, std::move(packets));
 }
 
 }  // namespace iso
@@ -75,6 +75,8 @@ class IsoManager {
   void RemoveCig(uint8_t cig_id);
 
   void SendIsoPacket(uint16_t cis_handle, std::vector<uint8_t> packet);
+  // Send the SDUs of the CISes of one CIG for the same SDU interval
+  void SendIsoPackets(std::vector<std::pair<uint16_t, std::vector<uint8_t>>> packets);
 
  protected:
   IsoManager(os::Handler* iso_handler, internal::IsoManagerImpl* iso_manager_impl)
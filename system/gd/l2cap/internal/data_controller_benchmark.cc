@@ -0,0 +1,285 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/bidi_queue.h"
+#include "common/bind.h"
+#include "l2cap/internal/basic_mode_channel_data_controller.h"
+#include "l2cap/internal/enhanced_retransmission_mode_channel_data_controller.h"
+#include "l2cap/internal/ilink.h"
+#include "l2cap/internal/le_credit_based_channel_data_controller.h"
+#include "l2cap/internal/scheduler.h"
+#include "l2cap/l2cap_packets.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+using ::bluetooth::common::BidiQueue;
+using ::bluetooth::l2cap::Cid;
+using ::bluetooth::l2cap::internal::BasicModeDataController;
+using ::bluetooth::l2cap::internal::DataController;
+using ::bluetooth::l2cap::internal::ErtmController;
+using ::bluetooth::l2cap::internal::ILink;
+using ::bluetooth::l2cap::internal::LeCreditBasedDataController;
+using ::bluetooth::l2cap::internal::Scheduler;
+using ::bluetooth::os::Handler;
+using ::bluetooth::os::Thread;
+
+namespace {
+
+// Allocations of the whole process, to count the ones made for each SDU
+std::atomic<size_t> allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using ChannelQueue = BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue>;
+using Clock = std::chrono::steady_clock;
+
+enum Mode : int64_t { BASIC, ERTM, LE_CREDIT_BASED };
+
+constexpr Cid kCid = 0x40;
+constexpr size_t kSdusPerIteration = 64;
+constexpr uint16_t kErtmMps = 1010;
+// Largest MPS whose PDUs fit in one LE data packet of 251 bytes
+constexpr uint16_t kLeMps = 247;
+constexpr uint16_t kLeCredits = 10;
+
+// Gives the credits returned by one LE credit based channel to the other
+class LoopbackLink : public ILink {
+ public:
+  explicit LoopbackLink(Handler* handler) : handler_(handler) {}
+
+  void SendDisconnectionRequest(Cid, Cid) override {}
+  bluetooth::hci::AddressWithType GetDevice() const override {
+    return bluetooth::hci::AddressWithType();
+  }
+  void SendLeCredit(Cid, uint16_t credit) override {
+    if (peer_ != nullptr) {
+      handler_->Post(bluetooth::common::BindOnce(&LeCreditBasedDataController::OnCredit,
+                                                 bluetooth::common::Unretained(peer_), credit));
+    }
+  }
+
+  LeCreditBasedDataController* peer_ = nullptr;
+
+ private:
+  Handler* handler_;
+};
+
+// Carries the PDUs of one controller to the other, as a controller looping back the ACL data would, dropping each PDU
+// with the given probability
+class LoopbackScheduler : public Scheduler {
+ public:
+  LoopbackScheduler(Handler* handler, double loss_rate) : handler_(handler), loss_(loss_rate) {}
+
+  void Connect(DataController* from, DataController* to) {
+    from_ = from;
+    to_ = to;
+  }
+
+  void OnPacketsReady(Cid, int number_packets) override {
+    for (int i = 0; i < number_packets; i++) {
+      handler_->Post(bluetooth::common::BindOnce(&LoopbackScheduler::deliver, bluetooth::common::Unretained(this)));
+    }
+  }
+
+ private:
+  void deliver() {
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    bluetooth::packet::BitInserter bi(*bytes);
+    from_->GetNextPacket()->Serialize(bi);
+    if (!loss_(random_)) {
+      to_->OnPdu(bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(bytes));
+    }
+  }
+
+  Handler* handler_;
+  std::bernoulli_distribution loss_;
+  std::mt19937 random_{42};
+  DataController* from_ = nullptr;
+  DataController* to_ = nullptr;
+};
+
+// The SDUs of an iteration, and the latency of each received one
+struct Transfer {
+  size_t sdu_size;
+  std::vector<Clock::time_point> send_times = std::vector<Clock::time_point>(kSdusPerIteration);
+  std::vector<double> latencies_us;
+  size_t received = 0;
+  std::promise<void>* all_received = nullptr;
+};
+
+// Each SDU starts with its index in the iteration, to find when it was sent
+void send_sdus(DataController* sender, Transfer* transfer) {
+  for (size_t i = 0; i < kSdusPerIteration; i++) {
+    auto sdu = std::make_unique<bluetooth::packet::RawBuilder>();
+    sdu->AddOctets4(static_cast<uint32_t>(i));
+    sdu->AddOctets(std::vector<uint8_t>(transfer->sdu_size - sizeof(uint32_t), static_cast<uint8_t>(i)));
+    transfer->send_times[i] = Clock::now();
+    sender->OnSdu(std::move(sdu));
+  }
+}
+
+void receive_sdu(ChannelQueue* queue, Transfer* transfer) {
+  auto sdu = queue->GetUpEnd()->TryDequeue();
+  auto now = Clock::now();
+  auto index = sdu->begin().extract<uint32_t>();
+  transfer->latencies_us.push_back(
+      std::chrono::duration<double, std::micro>(now - transfer->send_times[index % kSdusPerIteration]).count());
+  if (++transfer->received % kSdusPerIteration == 0) {
+    transfer->all_received->set_value();
+  }
+}
+
+void stop_receiving(ChannelQueue* queue, std::promise<void>* stopped) {
+  queue->GetUpEnd()->UnregisterDequeue();
+  stopped->set_value();
+}
+
+double percentile(std::vector<double>* values, double fraction) {
+  if (values->empty()) {
+    return 0;
+  }
+  auto nth = values->begin() + static_cast<size_t>(fraction * (values->size() - 1));
+  std::nth_element(values->begin(), nth, values->end());
+  return *nth;
+}
+
+std::unique_ptr<DataController> create_controller(Mode mode, ILink* link, ChannelQueue* queue, Handler* handler,
+                                                  Scheduler* scheduler, size_t sdu_size) {
+  switch (mode) {
+    case BASIC:
+      return std::make_unique<BasicModeDataController>(kCid, kCid, queue->GetDownEnd(), handler, scheduler);
+    case ERTM: {
+      auto controller = std::make_unique<ErtmController>(link, kCid, kCid, queue->GetDownEnd(), handler, scheduler);
+      // Short timers, so that a lost frame at the end of the window is recovered quickly
+      bluetooth::l2cap::RetransmissionAndFlowControlConfigurationOption option;
+      option.tx_window_size_ = 10;
+      option.max_transmit_ = 20;
+      option.retransmission_time_out_ = 5;
+      option.monitor_time_out_ = 10;
+      option.maximum_pdu_size_ = kErtmMps;
+      controller->SetRetransmissionAndFlowControlOptions(option);
+      return controller;
+    }
+    case LE_CREDIT_BASED: {
+      auto controller =
+          std::make_unique<LeCreditBasedDataController>(link, kCid, kCid, queue->GetDownEnd(), handler, scheduler);
+      controller->SetMtu(sdu_size);
+      controller->SetMps(kLeMps);
+      controller->SetInitialLocalCredits(kLeCredits);
+      controller->OnCredit(kLeCredits);
+      return controller;
+    }
+  }
+  return nullptr;
+}
+
+// Send SDUs of the size given as second argument from one channel to another, in the mode given as first argument,
+// over a link losing the percentage of the PDUs of the sender given as third argument. Reports the rate of SDUs and
+// bytes, the latency from OnSdu() of the sender to the dequeue of the receiver user, and the allocations per SDU.
+void BM_L2capDataPath(State& state) {
+  auto mode = static_cast<Mode>(state.range(0));
+  auto sdu_size = static_cast<size_t>(state.range(1));
+  Thread thread("l2cap_benchmark", Thread::Priority::NORMAL);
+  Handler handler(&thread);
+  // The SDUs are received on another thread, as done by the users of the channels
+  Thread user_thread("l2cap_benchmark_user", Thread::Priority::NORMAL);
+  Handler user_handler(&user_thread);
+  LoopbackLink sender_link(&handler);
+  LoopbackLink receiver_link(&handler);
+  ChannelQueue sender_queue{10};
+  ChannelQueue receiver_queue{10};
+  LoopbackScheduler to_receiver(&handler, state.range(2) / 100.0);
+  LoopbackScheduler to_sender(&handler, 0);
+  auto sender = create_controller(mode, &sender_link, &sender_queue, &handler, &to_receiver, sdu_size);
+  auto receiver = create_controller(mode, &receiver_link, &receiver_queue, &handler, &to_sender, sdu_size);
+  to_receiver.Connect(sender.get(), receiver.get());
+  to_sender.Connect(receiver.get(), sender.get());
+  if (mode == LE_CREDIT_BASED) {
+    receiver_link.peer_ = static_cast<LeCreditBasedDataController*>(sender.get());
+  }
+
+  Transfer transfer;
+  transfer.sdu_size = sdu_size;
+  transfer.latencies_us.reserve(kSdusPerIteration * 1024);
+  receiver_queue.GetUpEnd()->RegisterDequeue(&user_handler,
+                                             bluetooth::common::Bind(&receive_sdu, &receiver_queue, &transfer));
+
+  size_t allocations_before = allocations.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    transfer.all_received = &promise;
+    handler.Post(bluetooth::common::BindOnce(&send_sdus, sender.get(), &transfer));
+    future.wait();
+  }
+  size_t sdus = state.iterations() * kSdusPerIteration;
+  state.counters["allocations_per_sdu"] = ::benchmark::Counter(
+      static_cast<double>(allocations.load(std::memory_order_relaxed) - allocations_before) / sdus);
+
+  std::promise<void> stopped;
+  user_handler.Post(bluetooth::common::BindOnce(&stop_receiving, &receiver_queue, &stopped));
+  stopped.get_future().wait();
+  state.counters["p50_latency_us"] = ::benchmark::Counter(percentile(&transfer.latencies_us, 0.5));
+  state.counters["p99_latency_us"] = ::benchmark::Counter(percentile(&transfer.latencies_us, 0.99));
+  state.SetItemsProcessed(sdus);
+  state.SetBytesProcessed(sdus * sdu_size);
+  state.SetLabel(mode == BASIC ? "basic" : mode == ERTM ? "ertm" : "le_credit_based");
+  user_handler.Clear();
+  handler.Clear();
+}
+
+void data_path_matrix(::benchmark::internal::Benchmark* benchmark) {
+  for (int64_t sdu_size : {64, 672, 4096}) {
+    benchmark->Args({BASIC, sdu_size, 0});
+    benchmark->Args({LE_CREDIT_BASED, sdu_size, 0});
+    for (int64_t loss : {0, 1, 5}) {
+      benchmark->Args({ERTM, sdu_size, loss});
+    }
+  }
+}
+BENCHMARK(BM_L2capDataPath)->Apply(data_path_matrix)->UseRealTime();
+
+}  // namespace
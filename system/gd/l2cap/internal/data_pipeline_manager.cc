@@ -62,6 +62,22 @@ void DataPipelineManager::SetChannelTxPriority(Cid cid, bool high_priority) {
   scheduler_->SetChannelTxPriority(cid, high_priority);
 }
 
+void DataPipelineManager::SetChannelWeight(Cid cid, int weight) {
+  ASSERT(sender_map_.find(cid) != sender_map_.end());
+  scheduler_->SetChannelWeight(cid, weight);
+}
+
+std::unique_ptr<Scheduler> DataPipelineManager::create_scheduler(SchedulerPolicy scheduler_policy,
+                                                                 LowerQueueUpEnd* link_queue_up_end) {
+  switch (scheduler_policy) {
+    case SchedulerPolicy::FIFO:
+      return std::make_unique<Fifo>(this, link_queue_up_end, handler_);
+    case SchedulerPolicy::PRIORITY:
+      return std::make_unique<PriorityScheduler>(this, link_queue_up_end, handler_);
+  }
+  return nullptr;
+}
+
 }  // namespace internal
 }  // namespace l2cap
 }  // namespace bluetooth
@@ -28,6 +28,7 @@
 #include "l2cap/internal/receiver.h"
 #include "l2cap/internal/scheduler.h"
 #include "l2cap/internal/scheduler_fifo.h"
+#include "l2cap/internal/scheduler_priority.h"
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/mtu.h"
 #include "os/handler.h"
@@ -55,8 +56,17 @@ class DataPipelineManager {
   using LowerDequeue = UpperEnqueue;
   using LowerQueueUpEnd = common::BidiQueueEnd<LowerEnqueue, LowerDequeue>;
 
-  DataPipelineManager(os::Handler* handler, ILink* link, LowerQueueUpEnd* link_queue_up_end)
-      : handler_(handler), link_(link), scheduler_(std::make_unique<Fifo>(this, link_queue_up_end, handler)),
+  // How the channels of the link share it
+  enum class SchedulerPolicy {
+    // In the order their packets became ready (Fifo)
+    FIFO,
+    // Fixed channels first, then weighted round-robin among dynamic channels (PriorityScheduler)
+    PRIORITY,
+  };
+
+  DataPipelineManager(os::Handler* handler, ILink* link, LowerQueueUpEnd* link_queue_up_end,
+                      SchedulerPolicy scheduler_policy = SchedulerPolicy::FIFO)
+      : handler_(handler), link_(link), scheduler_(create_scheduler(scheduler_policy, link_queue_up_end)),
         receiver_(link_queue_up_end, handler, this) {}
 
   using ChannelMode = Sender::ChannelMode;
@@ -67,6 +77,7 @@ class DataPipelineManager {
   virtual void OnPacketSent(Cid cid);
   virtual void UpdateClassicConfiguration(Cid cid, classic::internal::ChannelConfigurationState config);
   virtual void SetChannelTxPriority(Cid cid, bool high_priority);
+  virtual void SetChannelWeight(Cid cid, int weight);
   virtual ~DataPipelineManager() = default;
 
  private:
@@ -75,6 +86,8 @@ class DataPipelineManager {
   std::unordered_map<Cid, Sender> sender_map_;
   std::unique_ptr<Scheduler> scheduler_;
   Receiver receiver_;
+
+  std::unique_ptr<Scheduler> create_scheduler(SchedulerPolicy scheduler_policy, LowerQueueUpEnd* link_queue_up_end);
 };
 }  // namespace internal
 }  // namespace l2cap
@@ -16,15 +16,17 @@
 
 #include "l2cap/internal/enhanced_retransmission_mode_channel_data_controller.h"
 
+#include <algorithm>
+#include <deque>
 #include <map>
 #include <queue>
+#include <tuple>
 #include <vector>
 
 #include "common/bind.h"
 #include "l2cap/internal/ilink.h"
 #include "os/alarm.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
+#include "packet/slice_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -48,9 +50,6 @@ struct ErtmController::impl {
   // We don't support extended window
   static constexpr uint8_t kMaxTxWin = 64;
 
-  // We don't support sending SREJ
-  static constexpr bool kSendSrej = false;
-
   // States (@see 8.6.5.2): Transmitter state and receiver state
 
   enum class TxState {
@@ -80,9 +79,11 @@ struct ErtmController::impl {
   int unacked_frames_ = 0;
   // TODO: Instead of having a map, we may consider about a better data structure
   // Map from TxSeq to (SAR, SDU size for START packet, information payload)
-  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, std::shared_ptr<packet::RawBuilder>>> unacked_list_;
+  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, std::shared_ptr<packet::BasePacketBuilder>>>
+      unacked_list_;
   // Stores (SAR, SDU size for START packet, information payload)
-  std::queue<std::tuple<SegmentationAndReassembly, uint16_t, std::unique_ptr<packet::RawBuilder>>> pending_frames_;
+  std::queue<std::tuple<SegmentationAndReassembly, uint16_t, std::unique_ptr<packet::BasePacketBuilder>>>
+      pending_frames_;
   int retry_count_ = 0;
   std::map<uint8_t /* tx_seq, */, int /* count */> retry_i_frames_;
   bool rnr_sent_ = false;
@@ -90,14 +91,19 @@ struct ErtmController::impl {
   bool srej_actioned_ = false;
   uint16_t srej_save_req_seq_ = 0;
   bool send_rej_ = false;
-  int buffer_seq_srej_ = 0;
+  // TxSeq of the missing I-frames we sent a SREJ for, in the order we expect them
+  std::deque<uint8_t> srej_list_;
+  // I-frames received out of sequence in SREJ_SENT, waiting for the missing ones. Map from TxSeq to (SAR, SDU size for
+  // START packet, information payload)
+  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, packet::PacketView<true>>> srej_saved_frames_;
   int frames_sent_ = 0;
   os::Alarm retrans_timer_;
   os::Alarm monitor_timer_;
 
   // Events (@see 8.6.5.4)
 
-  void data_request(SegmentationAndReassembly sar, std::unique_ptr<packet::RawBuilder> pdu, uint16_t sdu_size = 0) {
+  void data_request(
+      SegmentationAndReassembly sar, std::unique_ptr<packet::BasePacketBuilder> pdu, uint16_t sdu_size = 0) {
     // Note: sdu_size only applies to START packet
     if (tx_state_ == TxState::XMIT && !remote_busy() && rem_window_not_full()) {
       send_data(sar, sdu_size, std::move(pdu));
@@ -197,13 +203,12 @@ struct ErtmController::impl {
         pass_to_tx(req_seq, f);
       } else if (with_unexpected_tx_seq(tx_seq) && with_valid_req_seq(req_seq) && with_valid_f_bit(f) &&
                  !local_busy()) {
-        if constexpr (kSendSrej) {
-          // We don't support sending SREJ
-        } else {
-          pass_to_tx(req_seq, f);
-          send_rej();
-          rx_state_ = RxState::REJ_SENT;
-        }
+        // Only ask for the missing frames, and keep the ones received after them
+        pass_to_tx(req_seq, f);
+        init_srej();
+        save_i_frame_srej(tx_seq, sar, sdu_size, payload);
+        send_srej(tx_seq);
+        rx_state_ = RxState::SREJ_SENT;
       } else if (with_expected_tx_seq(tx_seq) && with_valid_req_seq(req_seq) && with_valid_f_bit(f) && local_busy()) {
         pass_to_tx(req_seq, f);
         store_or_ignore();
@@ -240,12 +245,46 @@ struct ErtmController::impl {
         pass_to_tx(req_seq, f);
       }
     } else if (rx_state_ == RxState::SREJ_SENT) {
-      // SREJ NOT SUPPORTED
+      if (with_expected_tx_seq_srej(tx_seq) && with_valid_req_seq(req_seq) && with_valid_f_bit(f) && !local_busy()) {
+        pass_to_tx(req_seq, f);
+        save_i_frame_srej(tx_seq, sar, sdu_size, payload);
+        bool last_missing_frame = srej_list_is_one();
+        pop_srej_list();
+        data_indication_srej();
+        if (last_missing_frame) {
+          send_ack(Final::NOT_SET);
+          rx_state_ = RxState::RECV;
+        }
+      } else if (with_unexpected_tx_seq_srej(tx_seq) && with_valid_req_seq(req_seq) && with_valid_f_bit(f) &&
+                 !local_busy()) {
+        // The frames requested before this one were lost again
+        pass_to_tx(req_seq, f);
+        save_i_frame_srej(tx_seq, sar, sdu_size, payload);
+        resend_srej(tx_seq);
+      } else if (with_expected_tx_seq(tx_seq) && with_valid_req_seq(req_seq) && with_valid_f_bit(f) &&
+                 !local_busy()) {
+        pass_to_tx(req_seq, f);
+        save_i_frame_srej(tx_seq, sar, sdu_size, payload);
+        increment_expected_tx_seq();
+      } else if (with_unexpected_tx_seq(tx_seq) && with_valid_req_seq(req_seq) && with_valid_f_bit(f) &&
+                 !local_busy()) {
+        pass_to_tx(req_seq, f);
+        save_i_frame_srej(tx_seq, sar, sdu_size, payload);
+        send_srej(tx_seq);
+      } else if (with_duplicate_tx_seq_srej(tx_seq) && with_valid_req_seq(req_seq) && with_valid_f_bit(f)) {
+        pass_to_tx(req_seq, f);
+      } else if (with_valid_req_seq(req_seq) && with_valid_f_bit(f) && local_busy()) {
+        pass_to_tx(req_seq, f);
+      } else if ((with_invalid_tx_seq(tx_seq) && controller_->local_tx_window_ > kMaxTxWin / 2) ||
+                 with_invalid_req_seq(req_seq)) {
+        CloseChannel();
+      }
     }
   }
 
   void recv_rr(uint8_t req_seq, Poll p = Poll::NOT_SET, Final f = Final::NOT_SET) {
-    if (rx_state_ == RxState::RECV) {
+    // Out of sequence frames are saved in SREJ_SENT, which doesn't change how S-frames are handled
+    if (rx_state_ == RxState::RECV || rx_state_ == RxState::SREJ_SENT) {
       if (p == Poll::NOT_SET && f == Final::NOT_SET && with_valid_req_seq(req_seq) && with_valid_f_bit(f)) {
         pass_to_tx(req_seq, f);
         if (remote_busy() && unacked_frames_ > 0) {
@@ -295,13 +334,12 @@ struct ErtmController::impl {
       } else if (with_invalid_req_seq(req_seq)) {
         CloseChannel();
       }
-    } else if (rx_state_ == RxState::SREJ_SENT) {
-      // SREJ NOT SUPPORTED
     }
   }
 
   void recv_rej(uint8_t req_seq, Poll p = Poll::NOT_SET, Final f = Final::NOT_SET) {
-    if (rx_state_ == RxState::RECV) {
+    // Out of sequence frames are saved in SREJ_SENT, which doesn't change how S-frames are handled
+    if (rx_state_ == RxState::RECV || rx_state_ == RxState::SREJ_SENT) {
       if (f == Final::NOT_SET && with_valid_req_seq_retrans(req_seq) &&
           retry_i_frames_less_than_max_transmit(req_seq) && with_valid_f_bit(f)) {
         remote_busy_ = false;
@@ -351,13 +389,12 @@ struct ErtmController::impl {
       } else if (with_invalid_req_seq_retrans(req_seq)) {
         CloseChannel();
       }
-    } else if (rx_state_ == RxState::SREJ_SENT) {
-      // SREJ NOT SUPPORTED
     }
   }
 
   void recv_rnr(uint8_t req_seq, Poll p = Poll::NOT_SET, Final f = Final::NOT_SET) {
-    if (rx_state_ == RxState::RECV) {
+    // Out of sequence frames are saved in SREJ_SENT, which doesn't change how S-frames are handled
+    if (rx_state_ == RxState::RECV || rx_state_ == RxState::SREJ_SENT) {
       if (p == Poll::NOT_SET && with_valid_req_seq(req_seq) && with_valid_f_bit(f)) {
         remote_busy_ = true;
         pass_to_tx(req_seq, f);
@@ -382,13 +419,12 @@ struct ErtmController::impl {
       } else if (with_invalid_req_seq_retrans(req_seq)) {
         CloseChannel();
       }
-    } else if (rx_state_ == RxState::SREJ_SENT) {
-      // SREJ NOT SUPPORTED
     }
   }
 
   void recv_srej(uint8_t req_seq, Poll p = Poll::NOT_SET, Final f = Final::NOT_SET) {
-    if (rx_state_ == RxState::RECV) {
+    // Out of sequence frames are saved in SREJ_SENT, which doesn't change how S-frames are handled
+    if (rx_state_ == RxState::RECV || rx_state_ == RxState::SREJ_SENT) {
       if (p == Poll::NOT_SET && f == Final::NOT_SET && with_valid_req_seq_retrans(req_seq) &&
           retry_i_frames_less_than_max_transmit(req_seq) && with_valid_f_bit(f)) {
         remote_busy_ = false;
@@ -456,8 +492,6 @@ struct ErtmController::impl {
       } else if (with_invalid_req_seq_retrans(req_seq)) {
         CloseChannel();
       }
-    } else if (rx_state_ == RxState::SREJ_SENT) {
-      // SREJ NOT SUPPORTED
     }
   }
 
@@ -547,29 +581,22 @@ struct ErtmController::impl {
     return !with_invalid_tx_seq(tx_seq) && !with_expected_tx_seq(tx_seq);
   }
 
-  bool with_expected_tx_seq_srej() {
-    // We don't support sending SREJ
-    return false;
-  }
-
-  bool send_req_is_true() {
-    // We don't support sending SREJ
-    return false;
+  bool with_expected_tx_seq_srej(uint8_t tx_seq) {
+    return !srej_list_.empty() && srej_list_.front() == tx_seq;
   }
 
   bool srej_list_is_one() {
-    // We don't support sending SREJ
-    return false;
+    return srej_list_.size() == 1;
   }
 
-  bool with_unexpected_tx_seq_srej() {
-    // We don't support sending SREJ
-    return false;
+  bool with_unexpected_tx_seq_srej(uint8_t tx_seq) {
+    return !with_expected_tx_seq_srej(tx_seq) &&
+           std::find(srej_list_.begin(), srej_list_.end(), tx_seq) != srej_list_.end();
   }
 
-  bool with_duplicate_tx_seq_srej() {
-    // We don't support sending SREJ
-    return false;
+  bool with_duplicate_tx_seq_srej(uint8_t tx_seq) {
+    bool requested = std::find(srej_list_.begin(), srej_list_.end(), tx_seq) != srej_list_.end();
+    return srej_saved_frames_.find(tx_seq) != srej_saved_frames_.end() || (with_duplicate_tx_seq(tx_seq) && !requested);
   }
 
   // Actions (@see 8.6.5.6)
@@ -597,9 +624,12 @@ struct ErtmController::impl {
     controller_->send_pdu(std::move(builder));
   }
 
-  void send_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> segment,
-                 Final f = Final::NOT_SET) {
-    std::shared_ptr<packet::RawBuilder> shared_segment(segment.release());
+  void send_data(
+      SegmentationAndReassembly sar,
+      uint16_t sdu_size,
+      std::unique_ptr<packet::BasePacketBuilder> segment,
+      Final f = Final::NOT_SET) {
+    std::shared_ptr<packet::BasePacketBuilder> shared_segment(segment.release());
     unacked_list_.emplace(std::piecewise_construct, std::forward_as_tuple(next_tx_seq_),
                           std::forward_as_tuple(sar, sdu_size, shared_segment));
 
@@ -613,12 +643,13 @@ struct ErtmController::impl {
     start_retrans_timer();
   }
 
-  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> data) {
+  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::BasePacketBuilder> data) {
     pending_frames_.emplace(std::make_tuple(sar, sdu_size, std::move(data)));
   }
 
   void process_req_seq(uint8_t req_seq) {
-    for (int i = expected_ack_seq_; i < req_seq; i++) {
+    // Sequence numbers wrap around, so the acked frames may run past kMaxTxWin - 1
+    for (uint8_t i = expected_ack_seq_; i != req_seq; i = (i + 1) % kMaxTxWin) {
       unacked_list_.erase(i);
       retry_i_frames_[i] = 0;
     }
@@ -639,20 +670,22 @@ struct ErtmController::impl {
     controller_->send_pdu(std::move(builder));
   }
 
+  // Acknowledge the frames passed to the upper layer. This is ExpectedTxSeq except in SREJ_SENT, where the frames
+  // received after a missing one are not acknowledged yet.
   void send_rr(Poll p) {
-    _send_s_frame(SupervisoryFunction::RECEIVER_READY, expected_tx_seq_, p, Final::NOT_SET);
+    _send_s_frame(SupervisoryFunction::RECEIVER_READY, buffer_seq_, p, Final::NOT_SET);
   }
 
   void send_rr(Final f) {
-    _send_s_frame(SupervisoryFunction::RECEIVER_READY, expected_tx_seq_, Poll::NOT_SET, f);
+    _send_s_frame(SupervisoryFunction::RECEIVER_READY, buffer_seq_, Poll::NOT_SET, f);
   }
 
   void send_rnr(Poll p) {
-    _send_s_frame(SupervisoryFunction::RECEIVER_NOT_READY, expected_tx_seq_, p, Final::NOT_SET);
+    _send_s_frame(SupervisoryFunction::RECEIVER_NOT_READY, buffer_seq_, p, Final::NOT_SET);
   }
 
   void send_rnr(Final f) {
-    _send_s_frame(SupervisoryFunction::RECEIVER_NOT_READY, expected_tx_seq_, Poll::NOT_SET, f);
+    _send_s_frame(SupervisoryFunction::RECEIVER_NOT_READY, buffer_seq_, Poll::NOT_SET, f);
     rnr_sent_ = true;
   }
 
@@ -683,8 +716,25 @@ struct ErtmController::impl {
     }
   }
 
-  void send_srej() {
-    // Sending SREJ is not supported
+  // Send a SREJ for each frame from ExpectedTxSeq up to, but not including, tx_seq, which was received
+  void send_srej(uint8_t tx_seq) {
+    while (!with_expected_tx_seq(tx_seq)) {
+      _send_s_frame(SupervisoryFunction::SELECT_REJECT, expected_tx_seq_, Poll::NOT_SET, Final::NOT_SET);
+      srej_list_.push_back(expected_tx_seq_);
+      increment_expected_tx_seq();
+    }
+    increment_expected_tx_seq();
+  }
+
+  // Send a SREJ again for each frame requested before tx_seq, which was received
+  void resend_srej(uint8_t tx_seq) {
+    while (srej_list_.front() != tx_seq) {
+      uint8_t missing_tx_seq = srej_list_.front();
+      srej_list_.pop_front();
+      _send_s_frame(SupervisoryFunction::SELECT_REJECT, missing_tx_seq, Poll::NOT_SET, Final::NOT_SET);
+      srej_list_.push_back(missing_tx_seq);
+    }
+    srej_list_.pop_front();
   }
 
   void start_retrans_timer() {
@@ -733,11 +783,13 @@ struct ErtmController::impl {
   }
 
   void init_srej() {
-    // We don't support sending SREJ
+    srej_list_.clear();
+    srej_saved_frames_.clear();
   }
 
-  void save_i_frame_srej() {
-    // We don't support sending SREJ
+  void save_i_frame_srej(uint8_t tx_seq, SegmentationAndReassembly sar, uint16_t sdu_size,
+                         const packet::PacketView<true>& payload) {
+    srej_saved_frames_.insert_or_assign(tx_seq, std::make_tuple(sar, sdu_size, payload));
   }
 
   void store_or_ignore() {
@@ -763,7 +815,7 @@ struct ErtmController::impl {
       retry_i_frames_[i]++;
       frames_sent_++;
       f = Final::NOT_SET;
-      i++;
+      i = (i + 1) % kMaxTxWin;
     }
     if (i != req_seq) {
       start_retrans_timer();
@@ -801,23 +853,27 @@ struct ErtmController::impl {
   }
 
   void pop_srej_list() {
-    // We don't support sending SREJ
+    srej_list_.pop_front();
   }
 
+  // Pass the saved frames to the upper layer, up to the next missing one
   void data_indication_srej() {
-    // We don't support sending SREJ
+    auto frame = srej_saved_frames_.find(buffer_seq_);
+    while (frame != srej_saved_frames_.end()) {
+      auto [sar, sdu_size, payload] = std::move(frame->second);
+      srej_saved_frames_.erase(frame);
+      data_indication(sar, sdu_size, payload);
+      frame = srej_saved_frames_.find(buffer_seq_);
+    }
   }
 };
 
 // Segmentation is handled here
 void ErtmController::OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) {
   auto sdu_size = sdu->size();
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
   auto size_each_packet = (remote_mps_ - 4 /* basic L2CAP header */ - 2 /* SDU length */ - 2 /* Enhanced control */ -
                            (fcs_enabled_ ? 2 : 0));
-  packet::FragmentingInserter fragmenting_inserter(size_each_packet, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
+  auto segments = packet::SliceBuilder::Split(*sdu, size_each_packet);
   if (segments.size() == 1) {
     pimpl_->data_request(SegmentationAndReassembly::UNSEGMENTED, std::move(segments[0]));
     return;
@@ -82,14 +82,14 @@ class ErtmController : public DataController {
 
   class CopyablePacketBuilder : public packet::BasePacketBuilder {
    public:
-    CopyablePacketBuilder(std::shared_ptr<packet::RawBuilder> builder) : builder_(std::move(builder)) {}
+    CopyablePacketBuilder(std::shared_ptr<packet::BasePacketBuilder> builder) : builder_(std::move(builder)) {}
 
     void Serialize(BitInserter& it) const override;
 
     size_t size() const override;
 
    private:
-    std::shared_ptr<packet::RawBuilder> builder_;
+    std::shared_ptr<packet::BasePacketBuilder> builder_;
   };
 
   PacketViewForReassembly reassembly_stage_{PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>())};
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <future>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/bidi_queue.h"
+#include "common/bind.h"
+#include "l2cap/internal/enhanced_retransmission_mode_channel_data_controller.h"
+#include "l2cap/internal/ilink.h"
+#include "l2cap/internal/scheduler.h"
+#include "l2cap/l2cap_packets.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+using ::bluetooth::common::BidiQueue;
+using ::bluetooth::l2cap::Cid;
+using ::bluetooth::l2cap::internal::ErtmController;
+using ::bluetooth::l2cap::internal::ILink;
+using ::bluetooth::l2cap::internal::Scheduler;
+using ::bluetooth::os::Handler;
+using ::bluetooth::os::Thread;
+
+namespace {
+
+using ChannelQueue = BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue>;
+
+constexpr Cid kCid = 0x40;
+constexpr size_t kSduSize = 600;
+constexpr size_t kSdusPerIteration = 64;
+
+class NullLink : public ILink {
+ public:
+  void SendDisconnectionRequest(Cid, Cid) override {}
+  bluetooth::hci::AddressWithType GetDevice() const override {
+    return bluetooth::hci::AddressWithType();
+  }
+};
+
+// Carries the PDUs of one controller to the other, dropping each PDU with the given probability. The PDUs are
+// delivered one per handler task, each task posting the next one, so that the handler runs the other tasks and
+// reactables of the thread, like the dequeue of the received SDUs, between two PDUs as a real link would.
+class LossyLinkScheduler : public Scheduler {
+ public:
+  LossyLinkScheduler(Handler* handler, double loss_rate) : handler_(handler), loss_(loss_rate) {}
+
+  void Connect(ErtmController* from, ErtmController* to) {
+    from_ = from;
+    to_ = to;
+  }
+
+  void OnPacketsReady(Cid, int number_packets) override {
+    bool delivering = pending_packets_ > 0;
+    pending_packets_ += number_packets;
+    if (!delivering) {
+      post_deliver();
+    }
+  }
+
+  size_t i_frames_sent_ = 0;
+
+ private:
+  void post_deliver() {
+    handler_->Post(bluetooth::common::BindOnce(&LossyLinkScheduler::deliver, bluetooth::common::Unretained(this)));
+  }
+
+  void deliver() {
+    pending_packets_--;
+    if (pending_packets_ > 0) {
+      post_deliver();
+    }
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    bluetooth::packet::BitInserter bi(*bytes);
+    from_->GetNextPacket()->Serialize(bi);
+    bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian> pdu(bytes);
+    auto frame = bluetooth::l2cap::StandardFrameView::Create(bluetooth::l2cap::BasicFrameView::Create(pdu));
+    if (frame.IsValid() && frame.GetFrameType() == bluetooth::l2cap::FrameType::I_FRAME) {
+      i_frames_sent_++;
+    }
+    if (!loss_(random_)) {
+      to_->OnPdu(pdu);
+    }
+  }
+
+  Handler* handler_;
+  std::bernoulli_distribution loss_;
+  std::mt19937 random_{42};
+  ErtmController* from_ = nullptr;
+  ErtmController* to_ = nullptr;
+  int pending_packets_ = 0;
+};
+
+void send_sdus(ErtmController* sender) {
+  for (size_t i = 0; i < kSdusPerIteration; i++) {
+    auto sdu = std::make_unique<bluetooth::packet::RawBuilder>();
+    sdu->AddOctets(std::vector<uint8_t>(kSduSize, static_cast<uint8_t>(i)));
+    sender->OnSdu(std::move(sdu));
+  }
+}
+
+void receive_sdu(ChannelQueue* queue, size_t* received, std::promise<void>** all_received) {
+  queue->GetUpEnd()->TryDequeue();
+  if (++*received % kSdusPerIteration == 0) {
+    (*all_received)->set_value();
+  }
+}
+
+void stop_receiving(ChannelQueue* queue, std::promise<void>* stopped) {
+  queue->GetUpEnd()->UnregisterDequeue();
+  stopped->set_value();
+}
+
+// Send SDUs over a link losing a percentage of the PDUs of the sender, given as argument, and count the I-frames
+// needed to deliver each SDU. Without loss, that is one I-frame per SDU: the receiver never claims local busy, which
+// drops the I-frames received meanwhile, and the retransmission timer never expires before the ack is received.
+void BM_ErtmLossyLink(State& state) {
+  Thread thread("ertm_benchmark", Thread::Priority::NORMAL);
+  Handler handler(&thread);
+  // The SDUs are received on another thread, as done by the users of the channels
+  Thread user_thread("ertm_benchmark_user", Thread::Priority::NORMAL);
+  Handler user_handler(&user_thread);
+  NullLink link;
+  ChannelQueue sender_queue{10};
+  // Room for all the SDUs of an iteration, so that the enqueue buffer of the receiver drains after each PDU and never
+  // backs up to its local busy threshold while the user thread dequeues
+  ChannelQueue receiver_queue{kSdusPerIteration};
+  LossyLinkScheduler to_receiver(&handler, state.range(0) / 100.0);
+  LossyLinkScheduler to_sender(&handler, 0);
+  ErtmController sender(&link, kCid, kCid, sender_queue.GetDownEnd(), &handler, &to_receiver);
+  ErtmController receiver(&link, kCid, kCid, receiver_queue.GetDownEnd(), &handler, &to_sender);
+  to_receiver.Connect(&sender, &receiver);
+  to_sender.Connect(&receiver, &sender);
+
+  // Timers short enough for a lost frame at the end of the window to be recovered quickly, but far above the round
+  // trip of the ack on this link, so that no frame is retransmitted without being lost
+  bluetooth::l2cap::RetransmissionAndFlowControlConfigurationOption option;
+  option.tx_window_size_ = 10;
+  option.max_transmit_ = 20;
+  option.retransmission_time_out_ = 50;
+  option.monitor_time_out_ = 100;
+  option.maximum_pdu_size_ = 1010;
+  sender.SetRetransmissionAndFlowControlOptions(option);
+  receiver.SetRetransmissionAndFlowControlOptions(option);
+
+  size_t received = 0;
+  std::promise<void>* all_received = nullptr;
+  receiver_queue.GetUpEnd()->RegisterDequeue(
+      &user_handler, bluetooth::common::Bind(&receive_sdu, &receiver_queue, &received, &all_received));
+
+  for (auto _ : state) {
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    all_received = &promise;
+    handler.Post(bluetooth::common::BindOnce(&send_sdus, &sender));
+    future.wait();
+  }
+  state.counters["i_frames_per_sdu"] =
+      ::benchmark::Counter(static_cast<double>(to_receiver.i_frames_sent_) / (state.iterations() * kSdusPerIteration));
+  state.SetItemsProcessed(state.iterations() * kSdusPerIteration);
+
+  std::promise<void> stopped;
+  user_handler.Post(bluetooth::common::BindOnce(&stop_receiving, &receiver_queue, &stopped));
+  stopped.get_future().wait();
+  user_handler.Clear();
+  handler.Clear();
+}
+BENCHMARK(BM_ErtmLossyLink)->Arg(0)->Arg(1)->Arg(5)->Arg(10)->UseRealTime();
+
+}  // namespace
@@ -42,6 +42,19 @@ PacketView<kLittleEndian> GetPacketView(std::unique_ptr<packet::BasePacketBuilde
   return packet::PacketView<packet::kLittleEndian>(bytes);
 }
 
+PacketView<kLittleEndian> CreateIFrame(uint8_t tx_seq, std::vector<uint8_t> payload) {
+  return GetPacketView(EnhancedInformationFrameBuilder::Create(
+      1, tx_seq, Final::NOT_SET, 0, SegmentationAndReassembly::UNSEGMENTED, CreateSdu(std::move(payload))));
+}
+
+// Return the supervisory function and ReqSeq of the next S-frame sent by controller
+std::pair<SupervisoryFunction, uint8_t> GetNextSFrame(ErtmController* controller) {
+  auto s_frame_view = EnhancedSupervisoryFrameView::Create(
+      StandardFrameView::Create(BasicFrameView::Create(GetPacketView(controller->GetNextPacket()))));
+  EXPECT_TRUE(s_frame_view.IsValid());
+  return {s_frame_view.GetS(), s_frame_view.GetReqSeq()};
+}
+
 void sync_handler(os::Handler* handler) {
   std::promise<void> promise;
   auto future = promise.get_future();
@@ -204,6 +217,36 @@ TEST_F(ErtmDataControllerTest, receive_packet_with_fcs) {
   EXPECT_EQ(data, "abcd");
 }
 
+TEST_F(ErtmDataControllerTest, receive_out_of_sequence_sends_srej) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  ErtmController controller{&link, 1, 1, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  EXPECT_CALL(scheduler, OnPacketsReady(1, 1)).Times(3);
+  controller.OnPdu(CreateIFrame(0, {'a'}));
+  EXPECT_EQ(GetNextSFrame(&controller), std::make_pair(SupervisoryFunction::RECEIVER_READY, uint8_t{1}));
+
+  // Frame 1 is lost: only it is requested again, and the frames after it are kept
+  controller.OnPdu(CreateIFrame(2, {'c'}));
+  EXPECT_EQ(GetNextSFrame(&controller), std::make_pair(SupervisoryFunction::SELECT_REJECT, uint8_t{1}));
+  controller.OnPdu(CreateIFrame(3, {'d'}));
+  sync_handler(queue_handler_);
+  auto payload = channel_queue.GetUpEnd()->TryDequeue();
+  EXPECT_NE(payload, nullptr);
+  EXPECT_EQ(std::string(payload->begin(), payload->end()), "a");
+  EXPECT_EQ(channel_queue.GetUpEnd()->TryDequeue(), nullptr);
+
+  // The retransmission of frame 1 releases the saved frames, in sequence
+  controller.OnPdu(CreateIFrame(1, {'b'}));
+  EXPECT_EQ(GetNextSFrame(&controller), std::make_pair(SupervisoryFunction::RECEIVER_READY, uint8_t{4}));
+  sync_handler(queue_handler_);
+  std::string data;
+  while ((payload = channel_queue.GetUpEnd()->TryDequeue()) != nullptr) {
+    data += std::string(payload->begin(), payload->end());
+  }
+  EXPECT_EQ(data, "bcd");
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace l2cap
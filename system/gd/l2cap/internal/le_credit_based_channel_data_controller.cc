@@ -16,10 +16,11 @@
 
 #include "l2cap/internal/le_credit_based_channel_data_controller.h"
 
+#include <algorithm>
+
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/le/internal/link.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
+#include "packet/slice_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -31,6 +32,13 @@ LeCreditBasedDataController::LeCreditBasedDataController(ILink* link, Cid cid, C
     : cid_(cid), remote_cid_(remote_cid), enqueue_buffer_(channel_queue_end), handler_(handler), scheduler_(scheduler),
       link_(link) {}
 
+LeCreditBasedDataController::~LeCreditBasedDataController() {
+  auto stall_time = GetCreditStallTime();
+  if (stall_time.count() > 0) {
+    LOG_INFO("Channel 0x%x waited %d ms for credits", cid_, static_cast<int>(stall_time.count()));
+  }
+}
+
 void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) {
   auto sdu_size = sdu->size();
   if (sdu_size == 0) {
@@ -40,11 +48,8 @@ void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilde
   if (sdu_size > mtu_) {
     LOG_WARN("Received sdu_size %d > mtu %d", static_cast<int>(sdu_size), mtu_);
   }
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
   // TODO: We don't need to waste 2 bytes for continuation segment.
-  packet::FragmentingInserter fragmenting_inserter(mps_ - 2, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
+  auto segments = packet::SliceBuilder::Split(*sdu, mps_ - 2);
   std::unique_ptr<BasicFrameBuilder> builder;
   builder = FirstLeInformationFrameBuilder::Create(remote_cid_, sdu_size, std::move(segments[0]));
   pdu_queue_.emplace(std::move(builder));
@@ -52,16 +57,8 @@ void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilde
     builder = BasicFrameBuilder::Create(remote_cid_, std::move(segments[i]));
     pdu_queue_.emplace(std::move(builder));
   }
-  if (credits_ >= segments.size()) {
-    scheduler_->OnPacketsReady(cid_, segments.size());
-    credits_ -= segments.size();
-  } else if (credits_ > 0) {
-    scheduler_->OnPacketsReady(cid_, credits_);
-    pending_frames_count_ += (segments.size() - credits_);
-    credits_ = 0;
-  } else {
-    pending_frames_count_ += segments.size();
-  }
+  pending_frames_count_ += segments.size();
+  send_pending_frames();
 }
 
 void LeCreditBasedDataController::OnPdu(packet::PacketView<true> pdu) {
@@ -70,8 +67,10 @@ void LeCreditBasedDataController::OnPdu(packet::PacketView<true> pdu) {
     LOG_WARN("Received invalid frame");
     return;
   }
-  if (basic_frame_view.size() > mps_) {
-    LOG_WARN("Received frame size %d > mps %d, dropping the packet", static_cast<int>(basic_frame_view.size()), mps_);
+  // The MPS bounds the information payload, the basic L2CAP header is not part of it
+  auto information_payload_size = basic_frame_view.GetPayload().size();
+  if (information_payload_size > mps_) {
+    LOG_WARN("Received frame size %d > mps %d, dropping the packet", static_cast<int>(information_payload_size), mps_);
     return;
   }
   if (remaining_sdu_continuation_packet_size_ == 0) {
@@ -97,8 +96,11 @@ void LeCreditBasedDataController::OnPdu(packet::PacketView<true> pdu) {
     remaining_sdu_continuation_packet_size_ = 0;
     link_->SendDisconnectionRequest(cid_, remote_cid_);
   }
-  // TODO: Improve the logic by sending credit only after user dequeued the SDU
-  link_->SendLeCredit(cid_, 1);
+  if (local_credits_ > 0) {
+    local_credits_--;
+  }
+  unreturned_credits_++;
+  return_credits();
 }
 
 std::unique_ptr<packet::BasePacketBuilder> LeCreditBasedDataController::GetNextPacket() {
@@ -122,15 +124,66 @@ void LeCreditBasedDataController::OnCredit(uint16_t credits) {
     link_->SendDisconnectionRequest(cid_, remote_cid_);
   }
   credits_ = total_credits;
-  if (pending_frames_count_ > 0 && credits_ >= pending_frames_count_) {
-    scheduler_->OnPacketsReady(cid_, pending_frames_count_);
-    pending_frames_count_ = 0;
-    credits_ -= pending_frames_count_;
-  } else if (pending_frames_count_ > 0) {
-    scheduler_->OnPacketsReady(cid_, credits_);
-    pending_frames_count_ -= credits_;
-    credits_ = 0;
+  send_pending_frames();
+}
+
+void LeCreditBasedDataController::SetInitialLocalCredits(uint16_t credits) {
+  local_credits_ = credits;
+}
+
+void LeCreditBasedDataController::SetCreditReturnPolicy(uint16_t threshold, bool adaptive) {
+  credit_return_threshold_ = std::max<uint16_t>(threshold, 1);
+  adaptive_credit_return_ = adaptive;
+}
+
+std::chrono::milliseconds LeCreditBasedDataController::GetCreditStallTime() const {
+  auto stall_ns = credit_stall_ns_.load();
+  auto stall_start_ns = credit_stall_start_ns_.load();
+  if (stall_start_ns != 0) {
+    stall_ns +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count() - stall_start_ns;
   }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(stall_ns));
+}
+
+void LeCreditBasedDataController::send_pending_frames() {
+  uint16_t count = std::min(credits_, pending_frames_count_);
+  if (count > 0) {
+    scheduler_->OnPacketsReady(cid_, count);
+    credits_ -= count;
+    pending_frames_count_ -= count;
+  }
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+  if (pending_frames_count_ > 0 && credit_stall_start_ns_ == 0) {
+    credit_stall_start_ns_ = now_ns;
+  } else if (pending_frames_count_ == 0 && credit_stall_start_ns_ != 0) {
+    credit_stall_ns_ += now_ns - credit_stall_start_ns_.exchange(0);
+  }
+}
+
+void LeCreditBasedDataController::return_credits() {
+  // Number of received SDUs waiting to be dequeued by the user after which it is considered slower than the peer
+  constexpr size_t kEnqueueBufferBusyThreshold = 3;
+  if (unreturned_credits_ == 0 || credit_return_deferred_) {
+    return;
+  }
+  if (adaptive_credit_return_ && enqueue_buffer_.Size() >= kEnqueueBufferBusyThreshold) {
+    credit_return_deferred_ = true;
+    enqueue_buffer_.NotifyOnEmpty(
+        common::BindOnce(&LeCreditBasedDataController::on_enqueue_buffer_empty, common::Unretained(this)));
+    return;
+  }
+  if (unreturned_credits_ < credit_return_threshold_ && local_credits_ > 0) {
+    return;
+  }
+  link_->SendLeCredit(cid_, unreturned_credits_);
+  local_credits_ += unreturned_credits_;
+  unreturned_credits_ = 0;
+}
+
+void LeCreditBasedDataController::on_enqueue_buffer_empty() {
+  credit_return_deferred_ = false;
+  return_credits();
 }
 
 }  // namespace internal
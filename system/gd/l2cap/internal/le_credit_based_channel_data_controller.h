@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <unordered_map>
 #include <utility>
@@ -44,6 +46,7 @@ class LeCreditBasedDataController : public DataController {
   using UpperQueueDownEnd = common::BidiQueueEnd<UpperEnqueue, UpperDequeue>;
   LeCreditBasedDataController(ILink* link, Cid cid, Cid remote_cid, UpperQueueDownEnd* channel_queue_end,
                               os::Handler* handler, Scheduler* scheduler);
+  ~LeCreditBasedDataController();
 
   void OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) override;
   void OnPdu(packet::PacketView<true> pdu) override;
@@ -58,6 +61,16 @@ class LeCreditBasedDataController : public DataController {
   // TODO: Handle credits
   void OnCredit(uint16_t credits);
 
+  // Credits given to the peer in the connection request or response
+  void SetInitialLocalCredits(uint16_t credits);
+  // Credits consumed by the peer are returned once threshold of them accumulated, or when the peer has none left. When
+  // adaptive, they are held back while the received SDUs are waiting for the user, and returned once the user dequeued
+  // them, so that the peer sends at the rate the user consumes.
+  void SetCreditReturnPolicy(uint16_t threshold, bool adaptive);
+
+  // Time spent with segments to send and no credit from the peer. Can be called from any thread.
+  std::chrono::milliseconds GetCreditStallTime() const;
+
  private:
   Cid cid_;
   Cid remote_cid_;
@@ -70,6 +83,19 @@ class LeCreditBasedDataController : public DataController {
   uint16_t mps_ = 251;
   uint16_t credits_ = 0;
   uint16_t pending_frames_count_ = 0;
+  uint16_t local_credits_ = 0;
+  uint16_t unreturned_credits_ = 0;
+  uint16_t credit_return_threshold_ = 1;
+  bool adaptive_credit_return_ = false;
+  bool credit_return_deferred_ = false;
+  using Clock = std::chrono::steady_clock;
+  // Start of the current stall in nanoseconds since the epoch of Clock, 0 when not stalled
+  std::atomic<int64_t> credit_stall_start_ns_ = 0;
+  std::atomic<int64_t> credit_stall_ns_ = 0;
+
+  void send_pending_frames();
+  void return_credits();
+  void on_enqueue_buffer_empty();
 
   class PacketViewForReassembly : public packet::PacketView<kLittleEndian> {
    public:
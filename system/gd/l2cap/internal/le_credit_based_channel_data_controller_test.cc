@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "l2cap/internal/ilink_mock.h"
 #include "l2cap/internal/scheduler_mock.h"
 #include "l2cap/l2cap_packets.h"
@@ -160,6 +162,27 @@ TEST_F(LeCreditBasedDataControllerTest, receive_segmented) {
   EXPECT_EQ(data, "abcdefg");
 }
 
+TEST_F(LeCreditBasedDataControllerTest, receive_segments_of_mps_size) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.OnCredit(10);
+  // The SDU length and the first 4 bytes fill the MPS of the first frame
+  controller.SetMps(6);
+  auto segment1 = CreateSdu({'a', 'b', 'c', 'd'});
+  auto builder1 = FirstLeInformationFrameBuilder::Create(0x41, 10, std::move(segment1));
+  controller.OnPdu(GetPacketView(std::move(builder1)));
+  auto segment2 = CreateSdu({'e', 'f', 'g', 'h', 'i', 'j'});
+  auto builder2 = BasicFrameBuilder::Create(0x41, std::move(segment2));
+  controller.OnPdu(GetPacketView(std::move(builder2)));
+  sync_handler(queue_handler_);
+  auto payload = channel_queue.GetUpEnd()->TryDequeue();
+  EXPECT_NE(payload, nullptr);
+  std::string data = std::string(payload->begin(), payload->end());
+  EXPECT_EQ(data, "abcdefghij");
+}
+
 TEST_F(LeCreditBasedDataControllerTest, receive_segmented_with_wrong_sdu_length) {
   common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
   testing::MockScheduler scheduler;
@@ -179,6 +202,80 @@ TEST_F(LeCreditBasedDataControllerTest, receive_segmented_with_wrong_sdu_length)
   EXPECT_EQ(payload, nullptr);
 }
 
+TEST_F(LeCreditBasedDataControllerTest, return_credits_in_batches) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.SetInitialLocalCredits(4);
+  controller.SetCreditReturnPolicy(3, false);
+  EXPECT_CALL(link, SendLeCredit(0x41, ::testing::_)).Times(0);
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'a'}))));
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'b'}))));
+  ::testing::Mock::VerifyAndClearExpectations(&link);
+  EXPECT_CALL(link, SendLeCredit(0x41, 3));
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'c'}))));
+  ::testing::Mock::VerifyAndClearExpectations(&link);
+  sync_handler(queue_handler_);
+}
+
+TEST_F(LeCreditBasedDataControllerTest, return_credits_when_peer_has_none_left) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.SetInitialLocalCredits(2);
+  controller.SetCreditReturnPolicy(10, false);
+  EXPECT_CALL(link, SendLeCredit(0x41, 2));
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'a'}))));
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'b'}))));
+  sync_handler(queue_handler_);
+}
+
+TEST_F(LeCreditBasedDataControllerTest, hold_back_credits_until_user_dequeues) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{1};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.SetInitialLocalCredits(4);
+  controller.SetCreditReturnPolicy(1, true);
+  // The first SDU fills the queue of the user, the next ones wait in the controller
+  EXPECT_CALL(link, SendLeCredit(0x41, 1));
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'a'}))));
+  sync_handler(queue_handler_);
+  EXPECT_CALL(link, SendLeCredit(0x41, 1)).Times(2);
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'b'}))));
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'c'}))));
+  ::testing::Mock::VerifyAndClearExpectations(&link);
+  EXPECT_CALL(link, SendLeCredit(0x41, ::testing::_)).Times(0);
+  controller.OnPdu(GetPacketView(FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'d'}))));
+  ::testing::Mock::VerifyAndClearExpectations(&link);
+
+  EXPECT_CALL(link, SendLeCredit(0x41, 1));
+  for (char expected : {'a', 'b', 'c', 'd'}) {
+    sync_handler(queue_handler_);
+    auto payload = channel_queue.GetUpEnd()->TryDequeue();
+    ASSERT_NE(payload, nullptr);
+    EXPECT_EQ(*payload->begin(), expected);
+  }
+  sync_handler(queue_handler_);
+}
+
+TEST_F(LeCreditBasedDataControllerTest, credit_stall_time) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.OnSdu(CreateSdu({'a', 'b', 'c', 'd'}));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_GE(controller.GetCreditStallTime(), std::chrono::milliseconds(20));
+  EXPECT_CALL(scheduler, OnPacketsReady(0x41, 1));
+  controller.OnCredit(1);
+  auto stall_time = controller.GetCreditStallTime();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(controller.GetCreditStallTime(), stall_time);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace l2cap
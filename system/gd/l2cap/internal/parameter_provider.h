@@ -36,12 +36,34 @@ class ParameterProvider {
   virtual std::chrono::milliseconds GetLeLinkIdleDisconnectTimeout() {
     return std::chrono::seconds(1);
   }
+  // Share each link among its channels with PriorityScheduler instead of Fifo
+  virtual bool IsPrioritySchedulerEnabled() {
+    return false;
+  }
   virtual uint16_t GetLeMps() {
     return 251;
   }
+  // Choose the MPS of new LE credit based channels so that each PDU fills whole LE data packets of the link, at most
+  // GetLeMps()
+  virtual bool IsLeMpsAutoTuned() {
+    return false;
+  }
   virtual uint16_t GetLeInitialCredit() {
     return 100;
   }
+  // Bytes of received PDUs buffered for each LE credit based channel. When not 0, the initial credits are the number
+  // of PDUs of the channel MPS fitting in it instead of GetLeInitialCredit().
+  virtual uint32_t GetLeReceiveBufferSize() {
+    return 0;
+  }
+  // Number of credits consumed by the peer returned together in an LE Flow Control Credit packet
+  virtual uint16_t GetLeCreditReturnThreshold() {
+    return 1;
+  }
+  // Hold back the credits while the received SDUs are waiting for the channel user
+  virtual bool IsLeCreditReturnAdaptive() {
+    return false;
+  }
 };
 
 }  // namespace internal
@@ -60,6 +60,11 @@ class Scheduler {
    */
   virtual void SetChannelTxPriority(Cid cid, bool high_priority) {}
 
+  /**
+   * Give the channel weight times the share of the link of a default channel, among the channels of the same priority.
+   */
+  virtual void SetChannelWeight(Cid cid, int weight) {}
+
   /**
    * Called by data controller to indicate that a channel is closed and packets should be dropped
    */
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "l2cap/internal/scheduler_priority.h"
+
+#include "l2cap/internal/data_pipeline_manager.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+
+PriorityScheduler::PriorityScheduler(DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end,
+                                     os::Handler* handler)
+    : data_pipeline_manager_(data_pipeline_manager), link_queue_up_end_(link_queue_up_end), handler_(handler) {
+  ASSERT(link_queue_up_end_ != nullptr && handler_ != nullptr);
+}
+
+// Invoked from some external Handler context
+PriorityScheduler::~PriorityScheduler() {
+  if (link_queue_enqueue_registered_.exchange(false)) {
+    link_queue_up_end_->UnregisterEnqueue();
+  }
+}
+
+// Invoked within L2CAP Handler context
+void PriorityScheduler::OnPacketsReady(Cid cid, int number_packets) {
+  if (number_packets == 0) {
+    return;
+  }
+  if (cid < kFirstDynamicChannel) {
+    fixed_channels_.push(std::make_pair(cid, number_packets));
+  } else {
+    dynamic_channels_[cid].pending_packets += number_packets;
+  }
+  pending_packets_ += number_packets;
+  try_register_link_queue_enqueue();
+}
+
+// Invoked within L2CAP Handler context
+void PriorityScheduler::SetChannelTxPriority(Cid cid, bool high_priority) {
+  auto channel = dynamic_channels_.find(cid);
+  if (channel == dynamic_channels_.end()) {
+    if (!high_priority) {
+      return;
+    }
+    channel = dynamic_channels_.emplace(cid, DynamicChannel{}).first;
+  }
+  channel->second.high_priority = high_priority;
+  channel->second.deficit = 0;
+}
+
+// Invoked within L2CAP Handler context
+void PriorityScheduler::SetChannelWeight(Cid cid, int weight) {
+  ASSERT(weight > 0);
+  dynamic_channels_[cid].weight = weight;
+}
+
+void PriorityScheduler::RemoveChannel(Cid cid) {
+  for (size_t i = 0; i < fixed_channels_.size(); i++) {
+    auto channel_id_and_number_packets = fixed_channels_.front();
+    fixed_channels_.pop();
+    if (channel_id_and_number_packets.first != cid) {
+      fixed_channels_.push(channel_id_and_number_packets);
+    } else {
+      pending_packets_ -= channel_id_and_number_packets.second;
+    }
+  }
+  auto channel = dynamic_channels_.find(cid);
+  if (channel != dynamic_channels_.end()) {
+    pending_packets_ -= channel->second.pending_packets;
+    dynamic_channels_.erase(channel);
+  }
+  try_unregister_link_queue_enqueue();
+}
+
+Cid PriorityScheduler::next_fixed_channel() {
+  if (fixed_channels_.empty()) {
+    return kInvalidCid;
+  }
+  auto& channel_id_and_number_packets = fixed_channels_.front();
+  auto channel_id = channel_id_and_number_packets.first;
+  channel_id_and_number_packets.second--;
+  if (channel_id_and_number_packets.second == 0) {
+    fixed_channels_.pop();
+  }
+  return channel_id;
+}
+
+Cid PriorityScheduler::next_dynamic_channel(bool high_priority) {
+  auto eligible = [high_priority](const DynamicChannel& channel) {
+    return channel.high_priority == high_priority && channel.pending_packets > 0;
+  };
+  Cid& current_cid = current_cid_[high_priority];
+  auto channel = dynamic_channels_.find(current_cid);
+  // The channel keeps its turn until it used its deficit or has nothing left to send
+  if (channel == dynamic_channels_.end() || !eligible(channel->second) || channel->second.deficit == 0) {
+    if (channel != dynamic_channels_.end()) {
+      channel->second.deficit = 0;
+    }
+    channel = dynamic_channels_.upper_bound(current_cid);
+    size_t visited = 0;
+    for (; visited < dynamic_channels_.size(); visited++, channel++) {
+      if (channel == dynamic_channels_.end()) {
+        channel = dynamic_channels_.begin();
+      }
+      if (eligible(channel->second)) {
+        break;
+      }
+    }
+    if (visited == dynamic_channels_.size()) {
+      return kInvalidCid;
+    }
+    current_cid = channel->first;
+    channel->second.deficit = channel->second.weight;
+  }
+  channel->second.deficit--;
+  channel->second.pending_packets--;
+  return channel->first;
+}
+
+// Invoked from some external Queue Reactable context
+std::unique_ptr<PriorityScheduler::UpperDequeue> PriorityScheduler::link_queue_enqueue_callback() {
+  ASSERT(pending_packets_ > 0);
+  auto channel_id = next_fixed_channel();
+  if (channel_id == kInvalidCid) {
+    channel_id = next_dynamic_channel(true);
+  }
+  if (channel_id == kInvalidCid) {
+    channel_id = next_dynamic_channel(false);
+  }
+  ASSERT(channel_id != kInvalidCid);
+  pending_packets_--;
+  auto packet = data_pipeline_manager_->GetDataController(channel_id)->GetNextPacket();
+
+  data_pipeline_manager_->OnPacketSent(channel_id);
+  try_unregister_link_queue_enqueue();
+  return packet;
+}
+
+void PriorityScheduler::try_register_link_queue_enqueue() {
+  if (link_queue_enqueue_registered_.exchange(true)) {
+    return;
+  }
+  link_queue_up_end_->RegisterEnqueue(
+      handler_, common::Bind(&PriorityScheduler::link_queue_enqueue_callback, common::Unretained(this)));
+}
+
+void PriorityScheduler::try_unregister_link_queue_enqueue() {
+  if (pending_packets_ == 0 && link_queue_enqueue_registered_.exchange(false)) {
+    link_queue_up_end_->UnregisterEnqueue();
+  }
+}
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <queue>
+#include <utility>
+
+#include "common/bidi_queue.h"
+#include "common/bind.h"
+#include "l2cap/cid.h"
+#include "l2cap/internal/scheduler.h"
+#include "os/handler.h"
+#include "os/queue.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+class DataPipelineManager;
+
+// Sends the packets of fixed channels (signalling, ATT, SMP) first, in the order they became ready. Then the dynamic
+// channels prioritized with SetChannelTxPriority(), then the other dynamic channels. Dynamic channels of the same
+// priority share the link in deficit round-robin, where each channel sends up to its weight in packets per round.
+class PriorityScheduler : public Scheduler {
+ public:
+  static constexpr int kDefaultWeight = 1;
+
+  PriorityScheduler(DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end,
+                    os::Handler* handler);
+  ~PriorityScheduler();
+  void OnPacketsReady(Cid cid, int number_packets) override;
+  void SetChannelTxPriority(Cid cid, bool high_priority) override;
+  void SetChannelWeight(Cid cid, int weight) override;
+  void RemoveChannel(Cid cid) override;
+
+ private:
+  struct DynamicChannel {
+    int pending_packets = 0;
+    int weight = kDefaultWeight;
+    // Packets the channel may still send in the current round
+    int deficit = 0;
+    bool high_priority = false;
+  };
+
+  DataPipelineManager* data_pipeline_manager_;
+  LowerQueueUpEnd* link_queue_up_end_;
+  os::Handler* handler_;
+  using ChannelAndNumPackets = std::pair<Cid, int>;
+  std::queue<ChannelAndNumPackets> fixed_channels_;
+  std::map<Cid, DynamicChannel> dynamic_channels_;
+  // Channel whose turn it is in the round-robin of the high priority channels, and of the others
+  Cid current_cid_[2] = {kInvalidCid, kInvalidCid};
+  int pending_packets_ = 0;
+  std::atomic_bool link_queue_enqueue_registered_ = false;
+
+  Cid next_fixed_channel();
+  Cid next_dynamic_channel(bool high_priority);
+  void try_register_link_queue_enqueue();
+  void try_unregister_link_queue_enqueue();
+  std::unique_ptr<LowerEnqueue> link_queue_enqueue_callback();
+};
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "l2cap/internal/scheduler_priority.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "l2cap/internal/data_controller_mock.h"
+#include "l2cap/internal/data_pipeline_manager_mock.h"
+#include "os/handler.h"
+#include "os/mock_queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+constexpr Cid kAttCid = 4;
+constexpr Cid kBulkCid = 0x40;
+constexpr Cid kOtherCid = 0x41;
+
+PacketView<kLittleEndian> GetPacketView(std::unique_ptr<packet::BasePacketBuilder> packet) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  BitInserter i(*bytes);
+  bytes->reserve(packet->size());
+  packet->Serialize(i);
+  return packet::PacketView<packet::kLittleEndian>(bytes);
+}
+
+class MyDataController : public testing::MockDataController {
+ public:
+  MyDataController(Cid cid) : cid_(cid) {}
+
+  std::unique_ptr<BasePacketBuilder> GetNextPacket() override {
+    return BasicFrameBuilder::Create(cid_, std::make_unique<packet::RawBuilder>());
+  }
+
+ private:
+  Cid cid_;
+};
+
+class L2capSchedulerPriorityTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_ = new os::Thread("test_thread", os::Thread::Priority::NORMAL);
+    queue_handler_ = new os::Handler(thread_);
+    mock_data_pipeline_manager_ = new testing::MockDataPipelineManager(queue_handler_, &queue_end_);
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(kAttCid)).WillRepeatedly(Return(&att_controller_));
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(kBulkCid)).WillRepeatedly(Return(&bulk_controller_));
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(kOtherCid)).WillRepeatedly(Return(&other_controller_));
+    EXPECT_CALL(*mock_data_pipeline_manager_, OnPacketSent(_)).Times(::testing::AnyNumber());
+    scheduler_ = new PriorityScheduler(mock_data_pipeline_manager_, &queue_end_, queue_handler_);
+  }
+
+  void TearDown() override {
+    delete scheduler_;
+    delete mock_data_pipeline_manager_;
+    queue_handler_->Clear();
+    delete queue_handler_;
+    delete thread_;
+  }
+
+  // Channel of each packet sent to the link, in order
+  std::vector<Cid> SentChannels(int number_packets) {
+    enqueue_.run_enqueue(number_packets);
+    std::vector<Cid> cids;
+    while (!enqueue_.enqueued.empty()) {
+      auto basic_frame_view = BasicFrameView::Create(GetPacketView(std::move(enqueue_.enqueued.front())));
+      enqueue_.enqueued.pop();
+      EXPECT_TRUE(basic_frame_view.IsValid());
+      cids.push_back(basic_frame_view.GetChannelId());
+    }
+    return cids;
+  }
+
+  os::Thread* thread_ = nullptr;
+  os::Handler* queue_handler_ = nullptr;
+  os::MockIQueueDequeue<Scheduler::LowerDequeue> dequeue_;
+  os::MockIQueueEnqueue<Scheduler::LowerEnqueue> enqueue_;
+  common::BidiQueueEnd<Scheduler::LowerEnqueue, Scheduler::LowerDequeue> queue_end_{&enqueue_, &dequeue_};
+  testing::MockDataPipelineManager* mock_data_pipeline_manager_ = nullptr;
+  MyDataController att_controller_{kAttCid};
+  MyDataController bulk_controller_{kBulkCid};
+  MyDataController other_controller_{kOtherCid};
+  PriorityScheduler* scheduler_ = nullptr;
+};
+
+TEST_F(L2capSchedulerPriorityTest, fixed_channels_first) {
+  scheduler_->OnPacketsReady(kBulkCid, 2);
+  scheduler_->OnPacketsReady(kAttCid, 2);
+  ASSERT_EQ(SentChannels(4), std::vector<Cid>({kAttCid, kAttCid, kBulkCid, kBulkCid}));
+}
+
+TEST_F(L2capSchedulerPriorityTest, weighted_round_robin) {
+  scheduler_->SetChannelWeight(kBulkCid, 2);
+  scheduler_->OnPacketsReady(kBulkCid, 4);
+  scheduler_->OnPacketsReady(kOtherCid, 3);
+  ASSERT_EQ(SentChannels(7),
+            std::vector<Cid>({kBulkCid, kBulkCid, kOtherCid, kBulkCid, kBulkCid, kOtherCid, kOtherCid}));
+}
+
+TEST_F(L2capSchedulerPriorityTest, high_priority_dynamic_channel) {
+  scheduler_->SetChannelTxPriority(kOtherCid, true);
+  scheduler_->OnPacketsReady(kBulkCid, 1);
+  scheduler_->OnPacketsReady(kOtherCid, 2);
+  scheduler_->OnPacketsReady(kAttCid, 1);
+  ASSERT_EQ(SentChannels(4), std::vector<Cid>({kAttCid, kOtherCid, kOtherCid, kBulkCid}));
+}
+
+TEST_F(L2capSchedulerPriorityTest, remove_channel) {
+  scheduler_->OnPacketsReady(kAttCid, 1);
+  scheduler_->OnPacketsReady(kBulkCid, 2);
+  scheduler_->OnPacketsReady(kOtherCid, 1);
+  scheduler_->RemoveChannel(kAttCid);
+  scheduler_->RemoveChannel(kBulkCid);
+  ASSERT_EQ(SentChannels(1), std::vector<Cid>({kOtherCid}));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
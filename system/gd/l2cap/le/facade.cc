@@ -16,6 +16,9 @@
 
 #include "l2cap/le/facade.h"
 
+#include <atomic>
+#include <future>
+
 #include "blueberry/facade/l2cap/le/facade.grpc.pb.h"
 #include "grpc/grpc_event_queue.h"
 #include "l2cap/le/dynamic_channel.h"
@@ -50,6 +53,7 @@ SecurityPolicy SecurityLevelToPolicy(SecurityLevel level) {
 }
 
 static constexpr auto kChannelOpenTimeout = std::chrono::seconds(4);
+static constexpr auto kGeneratedPacketsTimeout = std::chrono::seconds(30);
 
 class L2capLeModuleFacadeService : public L2capLeModuleFacade::Service {
  public:
@@ -64,6 +68,16 @@ class L2capLeModuleFacadeService : public L2capLeModuleFacade::Service {
     return pending_l2cap_data_.RunLoop(context, writer);
   }
 
+  ::grpc::Status FetchL2capDataBatches(
+      ::grpc::ServerContext* context,
+      const ::blueberry::facade::StreamBatchesRequest* request,
+      ::grpc::ServerWriter<L2capPacketBatch>* writer) override {
+    return pending_l2cap_data_.RunBatchLoop(
+        context, writer, request->max_batch_size(), [](L2capPacketBatch* batch, L2capPacket packet) {
+          *batch->add_packets() = std::move(packet);
+        });
+  }
+
   ::grpc::Status OpenDynamicChannel(::grpc::ServerContext* context, const OpenDynamicChannelRequest* request,
                                     OpenDynamicChannelResponse* response) override {
     auto service_helper = dynamic_channel_helper_map_.find(request->psm());
@@ -131,6 +145,26 @@ class L2capLeModuleFacadeService : public L2capLeModuleFacade::Service {
     return ::grpc::Status::OK;
   }
 
+  ::grpc::Status GenerateDynamicChannelPackets(
+      ::grpc::ServerContext* context,
+      const GenerateDynamicChannelPacketsRequest* request,
+      GeneratePacketsResponse* response) override {
+    std::unique_lock<std::mutex> lock(channel_map_mutex_);
+    auto service_helper = dynamic_channel_helper_map_.find(request->psm());
+    if (service_helper == dynamic_channel_helper_map_.end()) {
+      return ::grpc::Status(::grpc::StatusCode::FAILED_PRECONDITION, "Psm not registered");
+    }
+    if (request->payload_size() == 0) {
+      return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "Payload size must not be 0");
+    }
+    uint32_t packets_sent = 0;
+    if (!service_helper->second->SendGeneratedPackets(request->count(), request->payload_size(), &packets_sent)) {
+      return ::grpc::Status(::grpc::StatusCode::FAILED_PRECONDITION, "Channel not open");
+    }
+    response->set_packets_sent(packets_sent);
+    return ::grpc::Status::OK;
+  }
+
   class L2capDynamicChannelHelper {
    public:
     L2capDynamicChannelHelper(L2capLeModuleFacadeService* service, L2capLeModule* l2cap_layer, os::Handler* handler,
@@ -240,6 +274,63 @@ class L2capLeModuleFacadeService : public L2capLeModuleFacade::Service {
       return packet_one;
     }
 
+    // Enqueue count generated packets, without a round trip to the test harness for each of them. Returns false if
+    // the channel is not open, and the number of packets enqueued before kGeneratedPacketsTimeout in packets_sent.
+    bool SendGeneratedPackets(uint32_t count, uint32_t payload_size, uint32_t* packets_sent) {
+      if (channel_ == nullptr) {
+        std::unique_lock<std::mutex> lock(channel_open_cv_mutex_);
+        if (!channel_open_cv_.wait_for(lock, kChannelOpenTimeout, [this] { return channel_ != nullptr; })) {
+          LOG_WARN("Channel is not open for psm %d", psm_);
+          return false;
+        }
+      }
+      *packets_sent = 0;
+      if (count == 0) {
+        return true;
+      }
+      generated_packets_sent_ = 0;
+      generated_packets_left_ = count;
+      generated_payload_size_ = payload_size;
+      generated_packets_promise_ = std::promise<void>();
+      auto future = generated_packets_promise_.get_future();
+      channel_->GetQueueUpEnd()->RegisterEnqueue(
+          handler_, common::Bind(&L2capDynamicChannelHelper::generate_packet, common::Unretained(this)));
+      if (future.wait_for(kGeneratedPacketsTimeout) != std::future_status::ready) {
+        LOG_ERROR("Only %u of %u generated packets were sent", generated_packets_sent_.load(), count);
+        std::promise<void> stopped;
+        auto stopped_future = stopped.get_future();
+        handler_->Post(common::BindOnce(
+            &L2capDynamicChannelHelper::stop_generated_packets, common::Unretained(this), std::move(stopped)));
+        stopped_future.wait();
+      }
+      *packets_sent = generated_packets_sent_;
+      return true;
+    }
+
+    std::unique_ptr<packet::BasePacketBuilder> generate_packet() {
+      uint32_t sequence = generated_packets_sent_;
+      std::vector<uint8_t> payload(generated_payload_size_, static_cast<uint8_t>(sequence));
+      for (size_t i = 0; i < sizeof(sequence) && i < payload.size(); i++) {
+        payload[i] = static_cast<uint8_t>(sequence >> (8 * i));
+      }
+      auto packet = std::make_unique<packet::RawBuilder>(payload.size());
+      packet->AddOctets(payload);
+      generated_packets_sent_++;
+      if (--generated_packets_left_ == 0) {
+        channel_->GetQueueUpEnd()->UnregisterEnqueue();
+        generated_packets_promise_.set_value();
+      }
+      return packet;
+    }
+
+    void stop_generated_packets(std::promise<void> stopped) {
+      if (generated_packets_left_ != 0 && channel_ != nullptr) {
+        channel_->GetQueueUpEnd()->UnregisterEnqueue();
+      }
+      generated_packets_left_ = 0;
+      stopped.set_value();
+    }
+
     L2capLeModuleFacadeService* facade_service_;
     L2capLeModule* l2cap_layer_;
     os::Handler* handler_;
@@ -250,6 +341,10 @@ class L2capLeModuleFacadeService : public L2capLeModuleFacade::Service {
     DynamicChannelManager::ConnectionResult channel_open_fail_reason_;
     std::condition_variable channel_open_cv_;
     std::mutex channel_open_cv_mutex_;
+    std::atomic<uint32_t> generated_packets_sent_{0};
+    uint32_t generated_packets_left_{0};
+    uint32_t generated_payload_size_{0};
+    std::promise<void> generated_packets_promise_;
   };
 
   ::grpc::Status SetFixedChannel(::grpc::ServerContext* context, const SetEnableFixedChannelRequest* request,
@@ -16,6 +16,7 @@
 
 #include "l2cap/le/internal/link.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 
@@ -34,13 +35,20 @@ namespace internal {
 
 static constexpr uint16_t kDefaultMinimumCeLength = 0x0002;
 static constexpr uint16_t kDefaultMaximumCeLength = 0x0C00;
+// Smallest MPS of an LE credit based channel
+static constexpr uint16_t kMinimumLeMps = 23;
+// Bytes of the basic L2CAP header sent with each PDU
+static constexpr uint16_t kBasicL2capHeaderLength = 4;
 
 Link::Link(os::Handler* l2cap_handler, std::unique_ptr<hci::acl_manager::LeAclConnection> acl_connection,
            l2cap::internal::ParameterProvider* parameter_provider,
            DynamicChannelServiceManagerImpl* dynamic_service_manager,
            FixedChannelServiceManagerImpl* fixed_service_manager, LinkManager* link_manager)
     : l2cap_handler_(l2cap_handler), acl_connection_(std::move(acl_connection)),
-      data_pipeline_manager_(l2cap_handler, this, acl_connection_->GetAclQueueEnd()),
+      data_pipeline_manager_(l2cap_handler, this, acl_connection_->GetAclQueueEnd(),
+                             parameter_provider->IsPrioritySchedulerEnabled()
+                                 ? l2cap::internal::DataPipelineManager::SchedulerPolicy::PRIORITY
+                                 : l2cap::internal::DataPipelineManager::SchedulerPolicy::FIFO),
       parameter_provider_(parameter_provider), dynamic_service_manager_(dynamic_service_manager),
       signalling_manager_(l2cap_handler_, this, &data_pipeline_manager_, dynamic_service_manager_,
                           &dynamic_channel_allocator_),
@@ -89,6 +97,8 @@ void Link::OnConnectionUpdate(
 
 void Link::OnDataLengthChange(uint16_t tx_octets, uint16_t tx_time, uint16_t rx_octets, uint16_t rx_time) {
   LOG_INFO("tx_octets %hx tx_time %hx rx_octets %hx rx_time %hx", tx_octets, tx_time, rx_octets, rx_time);
+  // The MPS is used in both directions
+  data_length_ = std::min(tx_octets, rx_octets);
 }
 
 void Link::OnReadRemoteVersionInformationComplete(
@@ -270,11 +280,33 @@ void Link::NotifyChannelFail(Cid cid, DynamicChannelManager::ConnectionResult re
 }
 
 uint16_t Link::GetMps() const {
-  return parameter_provider_->GetLeMps();
+  auto max_mps = parameter_provider_->GetLeMps();
+  if (!parameter_provider_->IsLeMpsAutoTuned() || data_length_ == 0) {
+    return max_mps;
+  }
+  // Largest PDU whose basic frame is a whole number of data packets, so that no data packet is sent partially filled
+  uint32_t packets = (static_cast<uint32_t>(max_mps) + kBasicL2capHeaderLength) / data_length_;
+  uint32_t mps = packets * data_length_;
+  if (mps < kMinimumLeMps + kBasicL2capHeaderLength) {
+    return max_mps;
+  }
+  return static_cast<uint16_t>(mps - kBasicL2capHeaderLength);
+}
+
+uint16_t Link::GetInitialCredit(uint16_t mps) const {
+  auto receive_buffer_size = parameter_provider_->GetLeReceiveBufferSize();
+  if (receive_buffer_size == 0 || mps == 0) {
+    return parameter_provider_->GetLeInitialCredit();
+  }
+  return static_cast<uint16_t>(std::clamp<uint32_t>(receive_buffer_size / mps, 1, 0xffff));
+}
+
+uint16_t Link::GetCreditReturnThreshold() const {
+  return parameter_provider_->GetLeCreditReturnThreshold();
 }
 
-uint16_t Link::GetInitialCredit() const {
-  return parameter_provider_->GetLeInitialCredit();
+bool Link::IsCreditReturnAdaptive() const {
+  return parameter_provider_->IsLeCreditReturnAdaptive();
 }
 
 void Link::SendLeCredit(Cid local_cid, uint16_t credit) {
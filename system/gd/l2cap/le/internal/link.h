@@ -145,7 +145,12 @@ class Link : public l2cap::internal::ILink, public hci::acl_manager::LeConnectio
 
   virtual uint16_t GetMps() const;
 
-  virtual uint16_t GetInitialCredit() const;
+  // Initial credits of a channel receiving PDUs of up to mps bytes
+  virtual uint16_t GetInitialCredit(uint16_t mps) const;
+
+  virtual uint16_t GetCreditReturnThreshold() const;
+
+  virtual bool IsCreditReturnAdaptive() const;
 
   void SendLeCredit(Cid local_cid, uint16_t credit) override;
 
@@ -176,6 +181,8 @@ class Link : public l2cap::internal::ILink, public hci::acl_manager::LeConnectio
   uint16_t update_request_latency_;
   uint16_t update_request_supervision_timeout_;
   std::atomic_int remaining_packets_to_be_sent_ = 0;
+  // Payload of the LE data packets in both directions, 27 bytes until a Data Length Change event
+  uint16_t data_length_ = 27;
 
   // Received connection update complete from ACL manager. SignalId is bound to a valid number when we need to send a
   // response to remote. If SignalId is bound to an invalid number, we don't send a response to remote, because the
@@ -70,7 +70,7 @@ void LeSignallingManager::on_security_result_for_outgoing(Psm psm, Cid local_cid
   }
 
   PendingCommand pending_command = PendingCommand::CreditBasedConnectionRequest(
-      next_signal_id_, psm, local_cid, mtu, link_->GetMps(), link_->GetInitialCredit());
+      next_signal_id_, psm, local_cid, mtu, link_->GetMps(), link_->GetInitialCredit(link_->GetMps()));
   next_signal_id_++;
   pending_commands_.push(pending_command);
   if (pending_commands_.size() == 1) {
@@ -252,13 +252,18 @@ void LeSignallingManager::on_security_result_for_incoming(Psm psm, PendingConnec
     return;
   }
 
-  send_connection_response(signal_id, new_channel->GetCid(), local_mtu, local_mps, link_->GetInitialCredit(),
+  // The peer sends PDUs of up to our MPS, whatever its own MPS is
+  auto initial_credits = link_->GetInitialCredit(local_mps);
+  auto actual_mps = std::min(request.max_pdu_size, local_mps);
+  send_connection_response(signal_id, new_channel->GetCid(), local_mtu, local_mps, initial_credits,
                            LeCreditBasedConnectionResponseResult::SUCCESS);
   auto* data_controller = reinterpret_cast<l2cap::internal::LeCreditBasedDataController*>(
       data_pipeline_manager_->GetDataController(new_channel->GetCid()));
   auto actual_mtu = std::min(request.mtu, local_mtu);
   data_controller->SetMtu(actual_mtu);
-  data_controller->SetMps(std::min(request.max_pdu_size, local_mps));
+  data_controller->SetMps(actual_mps);
+  data_controller->SetInitialLocalCredits(initial_credits);
+  data_controller->SetCreditReturnPolicy(link_->GetCreditReturnThreshold(), link_->IsCreditReturnAdaptive());
   data_controller->OnCredit(request.initial_credits);
   auto user_channel = std::make_unique<DynamicChannel>(new_channel, handler_, link_, actual_mtu);
   dynamic_service_manager_->GetService(psm)->NotifyChannelCreation(std::move(user_channel));
@@ -296,6 +301,8 @@ void LeSignallingManager::OnConnectionResponse(SignalId signal_id, Cid remote_ci
   auto actual_mtu = std::min(mtu, command_just_sent_.mtu_);
   data_controller->SetMtu(actual_mtu);
   data_controller->SetMps(std::min(mps, command_just_sent_.mps_));
+  data_controller->SetInitialLocalCredits(command_just_sent_.credits_);
+  data_controller->SetCreditReturnPolicy(link_->GetCreditReturnThreshold(), link_->IsCreditReturnAdaptive());
   data_controller->OnCredit(initial_credits);
   std::unique_ptr<DynamicChannel> user_channel =
       std::make_unique<DynamicChannel>(new_channel, handler_, link_, actual_mtu);
@@ -17,6 +17,9 @@
 
 #include "metrics/counter_metrics.h"
 
+#include <functional>
+#include <thread>
+
 #include "common/bind.h"
 #include "os/log.h"
 #include "os/metrics.h"
@@ -58,6 +61,45 @@ bool CounterMetrics::CacheCount(int32_t key, int64_t count) {
     LOG_WARN("count is not larger than 0. count: %s, key: %d", std::to_string(count).c_str(), key);
     return false;
   }
+  Slot* slot = FindSlot(key);
+  if (slot == nullptr) {
+    return CacheCountLocked(key, count);
+  }
+  int64_t total = slot->count.fetch_add(count, std::memory_order_relaxed);
+  if (LLONG_MAX - total < count) {
+    LOG_WARN("Counter metric overflows. count %s current total: %s key: %d",
+             std::to_string(count).c_str(), std::to_string(total).c_str(), key);
+    slot->count.store(LLONG_MAX, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+CounterMetrics::Slot* CounterMetrics::FindSlot(int32_t key) {
+  if (key == kEmptyKey) {
+    return nullptr;
+  }
+  static thread_local size_t shard_index =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % kNumShards;
+  Shard& shard = shards_[shard_index];
+  size_t start = static_cast<uint32_t>(key) % kSlotsPerShard;
+  for (size_t i = 0; i < kSlotsPerShard; i++) {
+    Slot& slot = shard.slots[(start + i) % kSlotsPerShard];
+    int32_t slot_key = slot.key.load(std::memory_order_acquire);
+    if (slot_key == kEmptyKey) {
+      // Claim the slot, unless another thread sharing the shard did first.
+      if (slot.key.compare_exchange_strong(slot_key, key, std::memory_order_acq_rel)) {
+        return &slot;
+      }
+    }
+    if (slot_key == key) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+bool CounterMetrics::CacheCountLocked(int32_t key, int64_t count) {
   int64_t total = 0;
   std::lock_guard<std::mutex> lock(mutex_);
   if (counters_.find(key) != counters_.end()) {
@@ -93,6 +135,22 @@ void CounterMetrics::DrainBufferedCounters() {
   }
   std::lock_guard<std::mutex> lock(mutex_);
   LOG_INFO("Draining buffered counters");
+  // Sum the shards into the map of the keys cached under the lock, then
+  // report every key once.
+  for (auto& shard : shards_) {
+    for (auto& slot : shard.slots) {
+      int32_t key = slot.key.load(std::memory_order_acquire);
+      if (key == kEmptyKey) {
+        continue;
+      }
+      int64_t count = slot.count.exchange(0, std::memory_order_relaxed);
+      if (count == 0) {
+        continue;
+      }
+      int64_t& total = counters_[key];
+      total = (LLONG_MAX - total < count) ? LLONG_MAX : total + count;
+    }
+  }
   for (auto const& pair : counters_) {
     Count(pair.first, pair.second);
   }
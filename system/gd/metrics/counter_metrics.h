@@ -15,6 +15,10 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <limits>
+#include <mutex>
 #include <unordered_map>
 
 #include "module.h"
@@ -42,6 +46,26 @@ class CounterMetrics : public bluetooth::Module {
   }
 
  private:
+  // Counters are cached in per-thread shards of fixed size, so that caching
+  // a count is a relaxed atomic add. Keys are assigned a slot of the shard
+  // on first use and keep it; keys that do not fit are cached in counters_.
+  static constexpr size_t kNumShards = 8;
+  static constexpr size_t kSlotsPerShard = 128;
+  static constexpr int32_t kEmptyKey = std::numeric_limits<int32_t>::min();
+
+  struct Slot {
+    std::atomic<int32_t> key{kEmptyKey};
+    std::atomic<int64_t> count{0};
+  };
+
+  struct alignas(64) Shard {
+    std::array<Slot, kSlotsPerShard> slots;
+  };
+
+  Slot* FindSlot(int32_t key);
+  bool CacheCountLocked(int32_t key, int64_t count);
+
+  std::array<Shard, kNumShards> shards_;
   std::unordered_map<int32_t, int64_t> counters_;
   mutable std::mutex mutex_;
   std::unique_ptr<os::RepeatingAlarm> alarm_;
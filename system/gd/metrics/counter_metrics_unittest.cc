@@ -16,7 +16,9 @@
 
 #include "metrics/counter_metrics.h"
 
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -87,6 +89,24 @@ TEST_F(CounterMetricsTest, non_positive) {
   ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 5);
 }
 
+TEST_F(CounterMetricsTest, multiple_threads) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([this]() {
+      for (int j = 0; j < 1000; j++) {
+        ASSERT_TRUE(testable_counter_metrics_.CacheCount(1, 1));
+        ASSERT_TRUE(testable_counter_metrics_.CacheCount(j % 300, 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  testable_counter_metrics_.DrainBuffer();
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[1], 4000 + 4 * 4);
+  ASSERT_EQ(testable_counter_metrics_.test_counters_[299], 4 * 3);
+}
+
 }  // namespace
 }  // namespace metrics
 }  // namespace bluetooth
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+namespace bluetooth {
+namespace metrics {
+
+namespace {
+
+std::mutex registry_mutex;
+// Never destroyed, histograms may be recorded while the process exits
+std::map<std::string, std::unique_ptr<LatencyHistogram>>* registry = nullptr;
+
+void atomic_min(std::atomic<uint64_t>& target, uint64_t value) {
+  uint64_t current = target.load(std::memory_order_relaxed);
+  while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void atomic_max(std::atomic<uint64_t>& target, uint64_t value) {
+  uint64_t current = target.load(std::memory_order_relaxed);
+  while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+LatencyHistogram& LatencyHistogram::Get(const std::string& name) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  if (registry == nullptr) {
+    registry = new std::map<std::string, std::unique_ptr<LatencyHistogram>>();
+  }
+  auto& histogram = (*registry)[name];
+  if (histogram == nullptr) {
+    histogram = std::make_unique<LatencyHistogram>();
+  }
+  return *histogram;
+}
+
+std::map<std::string, LatencyHistogram::Snapshot> LatencyHistogram::GetAllSnapshots() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  std::map<std::string, Snapshot> snapshots;
+  if (registry == nullptr) {
+    return snapshots;
+  }
+  for (const auto& [name, histogram] : *registry) {
+    auto snapshot = histogram->GetSnapshot();
+    if (snapshot.count > 0) {
+      snapshots.emplace(name, snapshot);
+    }
+  }
+  return snapshots;
+}
+
+size_t LatencyHistogram::BucketOf(uint64_t value_us) {
+  value_us = std::min(value_us, kMaxValueUs);
+  if (value_us < 2 * kSubBuckets) {
+    return value_us;
+  }
+  size_t msb = 63 - __builtin_clzll(value_us);
+  size_t shift = msb - kSubBucketBits;
+  return kSubBuckets * (shift + 1) + ((value_us >> shift) - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::BucketLowestValue(size_t bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  size_t shift = bucket / kSubBuckets - 1;
+  return (bucket % kSubBuckets + kSubBuckets) << shift;
+}
+
+uint64_t LatencyHistogram::BucketHighestValue(size_t bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  size_t shift = bucket / kSubBuckets - 1;
+  return ((bucket % kSubBuckets + kSubBuckets + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t latency_us) {
+  latency_us = std::min(latency_us, kMaxValueUs);
+  counts_[BucketOf(latency_us)].fetch_add(1, std::memory_order_relaxed);
+  sum_us_.fetch_add(latency_us, std::memory_order_relaxed);
+  atomic_min(min_us_, latency_us);
+  atomic_max(max_us_, latency_us);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  auto snapshot = other.GetSnapshot();
+  if (snapshot.count == 0) {
+    return;
+  }
+  for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+    if (snapshot.counts[bucket] > 0) {
+      counts_[bucket].fetch_add(snapshot.counts[bucket], std::memory_order_relaxed);
+    }
+  }
+  sum_us_.fetch_add(snapshot.sum_us, std::memory_order_relaxed);
+  atomic_min(min_us_, snapshot.min_us);
+  atomic_max(max_us_, snapshot.max_us);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+  // The fields are read one by one while other threads may record, the snapshot is only consistent with itself
+  Snapshot snapshot;
+  for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+    snapshot.counts[bucket] = counts_[bucket].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.counts[bucket];
+  }
+  if (snapshot.count == 0) {
+    return snapshot;
+  }
+  snapshot.sum_us = sum_us_.load(std::memory_order_relaxed);
+  snapshot.min_us = std::min(min_us_.load(std::memory_order_relaxed), kMaxValueUs);
+  snapshot.max_us = max_us_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  sum_us_.store(0, std::memory_order_relaxed);
+  min_us_.store(UINT64_MAX, std::memory_order_relaxed);
+  max_us_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Snapshot::Merge(const Snapshot& other) {
+  if (other.count == 0) {
+    return;
+  }
+  for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+    counts[bucket] += other.counts[bucket];
+  }
+  min_us = count == 0 ? other.min_us : std::min(min_us, other.min_us);
+  max_us = std::max(max_us, other.max_us);
+  count += other.count;
+  sum_us += other.sum_us;
+}
+
+uint64_t LatencyHistogram::Snapshot::GetPercentile(double percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+  percentile = std::clamp(percentile, 0.0, 100.0);
+  auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * count)));
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+    seen += counts[bucket];
+    if (seen >= rank) {
+      return std::min(std::max(BucketHighestValue(bucket), min_us), max_us);
+    }
+  }
+  return max_us;
+}
+
+uint64_t LatencyHistogram::Snapshot::GetMean() const {
+  return count == 0 ? 0 : sum_us / count;
+}
+
+}  // namespace metrics
+}  // namespace bluetooth
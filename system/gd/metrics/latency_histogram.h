@@ -0,0 +1,114 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace bluetooth {
+namespace metrics {
+
+// Distribution of latencies in microseconds, in log-linear buckets: every power of two range is split in
+// kSubBuckets linear buckets, so that any recorded value is known within 1 / kSubBuckets of its magnitude, from one
+// microsecond up to hours, in a fixed amount of memory.
+//
+// Recording is a few relaxed atomic operations, so a histogram can be shared by any number of threads. Histograms are
+// registered by name with Get(), and are dumped with the dumpsys data.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 4;
+  static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+  // Larger values are recorded as the largest value
+  static constexpr size_t kMaxValueBits = 36;
+  static constexpr uint64_t kMaxValueUs = (uint64_t{1} << kMaxValueBits) - 1;
+  static constexpr size_t kNumBuckets = kSubBuckets * (kMaxValueBits - kSubBucketBits + 1);
+
+  // Plain copy of the histogram counts, for reading and merging
+  struct Snapshot {
+    std::array<uint64_t, kNumBuckets> counts{};
+    uint64_t count = 0;
+    uint64_t sum_us = 0;
+    uint64_t min_us = 0;
+    uint64_t max_us = 0;
+
+    void Merge(const Snapshot& other);
+    // Return the highest value of the bucket which holds the percentile, with percentile in [0, 100]
+    uint64_t GetPercentile(double percentile) const;
+    uint64_t GetMean() const;
+  };
+
+  LatencyHistogram() = default;
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  // Return the histogram registered under name, creating it on first use. The histogram lives until the process
+  // exits, so callers may keep the reference.
+  static LatencyHistogram& Get(const std::string& name);
+
+  // Return a snapshot of every registered histogram which recorded at least one value
+  static std::map<std::string, Snapshot> GetAllSnapshots();
+
+  void Record(uint64_t latency_us);
+
+  template <typename Rep, typename Period>
+  void Record(std::chrono::duration<Rep, Period> latency) {
+    auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    Record(latency_us > 0 ? static_cast<uint64_t>(latency_us) : 0);
+  }
+
+  // Add the values recorded by other, e.g. a histogram filled by a single thread
+  void Merge(const LatencyHistogram& other);
+
+  Snapshot GetSnapshot() const;
+
+  void Reset();
+
+  // Bucket of value, and range of the values counted in a bucket
+  static size_t BucketOf(uint64_t value_us);
+  static uint64_t BucketLowestValue(size_t bucket);
+  static uint64_t BucketHighestValue(size_t bucket);
+
+ private:
+  std::array<std::atomic<uint64_t>, kNumBuckets> counts_{};
+  std::atomic<uint64_t> sum_us_{0};
+  std::atomic<uint64_t> min_us_{UINT64_MAX};
+  std::atomic<uint64_t> max_us_{0};
+};
+
+// Record the time elapsed between construction and destruction in a histogram
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(LatencyHistogram& histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedLatency() {
+    histogram_.Record(std::chrono::steady_clock::now() - start_);
+  }
+
+  ScopedLatency(const ScopedLatency&) = delete;
+  ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+ private:
+  LatencyHistogram& histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace metrics
+}  // namespace bluetooth
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics/latency_histogram_dumpsys.h"
+
+#include <vector>
+
+#include "metrics/latency_histogram.h"
+
+namespace bluetooth {
+namespace metrics {
+
+flatbuffers::Offset<LatencyHistogramsData> GetLatencyHistogramsDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) {
+  std::vector<flatbuffers::Offset<LatencyHistogramData>> histograms;
+  for (const auto& [name, snapshot] : LatencyHistogram::GetAllSnapshots()) {
+    std::vector<int64_t> lowest_values;
+    std::vector<int64_t> counts;
+    for (size_t bucket = 0; bucket < LatencyHistogram::kNumBuckets; bucket++) {
+      if (snapshot.counts[bucket] == 0) {
+        continue;
+      }
+      lowest_values.push_back(LatencyHistogram::BucketLowestValue(bucket));
+      counts.push_back(snapshot.counts[bucket]);
+    }
+    auto name_offset = fb_builder->CreateString(name);
+    auto lowest_values_offset = fb_builder->CreateVector(lowest_values);
+    auto counts_offset = fb_builder->CreateVector(counts);
+
+    LatencyHistogramDataBuilder builder(*fb_builder);
+    builder.add_name(name_offset);
+    builder.add_count(snapshot.count);
+    builder.add_min_micros(snapshot.min_us);
+    builder.add_mean_micros(snapshot.GetMean());
+    builder.add_p50_micros(snapshot.GetPercentile(50));
+    builder.add_p90_micros(snapshot.GetPercentile(90));
+    builder.add_p99_micros(snapshot.GetPercentile(99));
+    builder.add_p999_micros(snapshot.GetPercentile(99.9));
+    builder.add_max_micros(snapshot.max_us);
+    builder.add_bucket_lowest_values_micros(lowest_values_offset);
+    builder.add_bucket_counts(counts_offset);
+    histograms.push_back(builder.Finish());
+  }
+
+  auto title_offset = fb_builder->CreateString("Bluetooth Latency Histograms");
+  auto histograms_offset = fb_builder->CreateVector(histograms);
+
+  LatencyHistogramsDataBuilder builder(*fb_builder);
+  builder.add_title(title_offset);
+  builder.add_histograms(histograms_offset);
+  return builder.Finish();
+}
+
+}  // namespace metrics
+}  // namespace bluetooth
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <flatbuffers/flatbuffers.h>
+
+#include "latency_histogram_generated.h"
+
+namespace bluetooth {
+namespace metrics {
+
+// Dump every registered LatencyHistogram to a flat buffer defined in latency_histogram.fbs
+flatbuffers::Offset<LatencyHistogramsData> GetLatencyHistogramsDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder);
+
+}  // namespace metrics
+}  // namespace bluetooth
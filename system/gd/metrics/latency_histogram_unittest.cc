@@ -0,0 +1,135 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics/latency_histogram.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bluetooth {
+namespace metrics {
+namespace {
+
+TEST(LatencyHistogramTest, buckets_cover_every_value) {
+  for (size_t bucket = 0; bucket + 1 < LatencyHistogram::kNumBuckets; bucket++) {
+    ASSERT_LE(LatencyHistogram::BucketLowestValue(bucket), LatencyHistogram::BucketHighestValue(bucket));
+    ASSERT_EQ(LatencyHistogram::BucketHighestValue(bucket) + 1, LatencyHistogram::BucketLowestValue(bucket + 1));
+    ASSERT_EQ(LatencyHistogram::BucketOf(LatencyHistogram::BucketLowestValue(bucket)), bucket);
+    ASSERT_EQ(LatencyHistogram::BucketOf(LatencyHistogram::BucketHighestValue(bucket)), bucket);
+  }
+  ASSERT_EQ(
+      LatencyHistogram::BucketHighestValue(LatencyHistogram::kNumBuckets - 1), LatencyHistogram::kMaxValueUs);
+  ASSERT_EQ(LatencyHistogram::BucketOf(UINT64_MAX), LatencyHistogram::kNumBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, bucket_precision) {
+  for (uint64_t value : {100u, 1000u, 12345u, 1000000u}) {
+    auto bucket = LatencyHistogram::BucketOf(value);
+    auto width = LatencyHistogram::BucketHighestValue(bucket) - LatencyHistogram::BucketLowestValue(bucket) + 1;
+    ASSERT_LE(width * LatencyHistogram::kSubBuckets, value);
+  }
+}
+
+TEST(LatencyHistogramTest, percentiles) {
+  LatencyHistogram histogram;
+  for (uint64_t value = 1; value <= 1000; value++) {
+    histogram.Record(value);
+  }
+  auto snapshot = histogram.GetSnapshot();
+  ASSERT_EQ(snapshot.count, 1000u);
+  ASSERT_EQ(snapshot.min_us, 1u);
+  ASSERT_EQ(snapshot.max_us, 1000u);
+  ASSERT_EQ(snapshot.GetMean(), 500u);
+  ASSERT_NEAR(snapshot.GetPercentile(50), 500, 500 / LatencyHistogram::kSubBuckets);
+  ASSERT_NEAR(snapshot.GetPercentile(99), 990, 990 / LatencyHistogram::kSubBuckets);
+  ASSERT_EQ(snapshot.GetPercentile(0), 1u);
+  ASSERT_EQ(snapshot.GetPercentile(100), 1000u);
+}
+
+TEST(LatencyHistogramTest, record_duration) {
+  LatencyHistogram histogram;
+  histogram.Record(std::chrono::milliseconds(3));
+  histogram.Record(std::chrono::nanoseconds(-1));
+  auto snapshot = histogram.GetSnapshot();
+  ASSERT_EQ(snapshot.count, 2u);
+  ASSERT_EQ(snapshot.min_us, 0u);
+  ASSERT_EQ(snapshot.max_us, 3000u);
+}
+
+TEST(LatencyHistogramTest, merge) {
+  LatencyHistogram first;
+  LatencyHistogram second;
+  first.Record(10);
+  second.Record(20);
+  second.Record(5000);
+  first.Merge(second);
+
+  auto snapshot = first.GetSnapshot();
+  ASSERT_EQ(snapshot.count, 3u);
+  ASSERT_EQ(snapshot.min_us, 10u);
+  ASSERT_EQ(snapshot.max_us, 5000u);
+
+  LatencyHistogram::Snapshot merged;
+  merged.Merge(second.GetSnapshot());
+  merged.Merge(LatencyHistogram().GetSnapshot());
+  ASSERT_EQ(merged.count, 2u);
+  ASSERT_EQ(merged.min_us, 20u);
+}
+
+TEST(LatencyHistogramTest, reset) {
+  LatencyHistogram histogram;
+  histogram.Record(10);
+  histogram.Reset();
+  ASSERT_EQ(histogram.GetSnapshot().count, 0u);
+  histogram.Record(20);
+  ASSERT_EQ(histogram.GetSnapshot().min_us, 20u);
+}
+
+TEST(LatencyHistogramTest, registry) {
+  auto& histogram = LatencyHistogram::Get("latency_histogram_test.registry");
+  ASSERT_EQ(&histogram, &LatencyHistogram::Get("latency_histogram_test.registry"));
+  ASSERT_EQ(LatencyHistogram::GetAllSnapshots().count("latency_histogram_test.registry"), 0u);
+
+  histogram.Record(42);
+  auto snapshots = LatencyHistogram::GetAllSnapshots();
+  ASSERT_EQ(snapshots.count("latency_histogram_test.registry"), 1u);
+  ASSERT_EQ(snapshots["latency_histogram_test.registry"].max_us, 42u);
+}
+
+TEST(LatencyHistogramTest, multiple_threads) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&histogram, i]() {
+      for (uint64_t value = 0; value < 10000; value++) {
+        histogram.Record(value + i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto snapshot = histogram.GetSnapshot();
+  ASSERT_EQ(snapshot.count, 40000u);
+  ASSERT_EQ(snapshot.min_us, 0u);
+  ASSERT_EQ(snapshot.max_us, 10002u);
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace bluetooth
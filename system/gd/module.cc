@@ -16,10 +16,21 @@
 #define LOG_TAG "BtGdModule"
 
 #include "module.h"
+
+#include <algorithm>
+#include <queue>
+#include <thread>
+
 #include "common/init_flags.h"
 #include "dumpsys/init_flags.h"
+#include "metrics/latency_histogram.h"
+#include "metrics/latency_histogram_dumpsys.h"
+#include "os/handler_stats_dumpsys.h"
 #include "os/wakelock_manager.h"
 
+using ::bluetooth::metrics::GetLatencyHistogramsDumpsysData;
+using ::bluetooth::metrics::LatencyHistogram;
+using ::bluetooth::os::GetHandlerStatsDumpsysData;
 using ::bluetooth::os::Handler;
 using ::bluetooth::os::Thread;
 using ::bluetooth::os::WakelockManager;
@@ -56,12 +67,14 @@ Module* Module::GetDependency(const ModuleFactory* module) const {
 }
 
 Module* ModuleRegistry::Get(const ModuleFactory* module) const {
+  std::lock_guard<std::mutex> lock(started_modules_mutex_);
   auto instance = started_modules_.find(module);
   ASSERT_LOG(instance != started_modules_.end(), "Request for module not started up, maybe not in Start(ModuleList)?");
   return instance->second;
 }
 
 bool ModuleRegistry::IsStarted(const ModuleFactory* module) const {
+  std::lock_guard<std::mutex> lock(started_modules_mutex_);
   return started_modules_.find(module) != started_modules_.end();
 }
 
@@ -73,7 +86,8 @@ void ModuleRegistry::Start(ModuleList* modules, Thread* thread) {
 
 void ModuleRegistry::set_registry_and_handler(Module* instance, Thread* thread) const {
   instance->registry_ = this;
-  instance->handler_ = new Handler(thread);
+  // Closures are accounted per module, as all the modules share the stack thread
+  instance->handler_ = new Handler(thread, thread->GetThreadName() + ":" + instance->ToString());
 }
 
 Module* ModuleRegistry::Start(const ModuleFactory* module, Thread* thread) {
@@ -93,13 +107,105 @@ Module* ModuleRegistry::Start(const ModuleFactory* module, Thread* thread) {
 
   LOG_DEBUG("Finished starting dependencies and calling Start() of %s", instance->ToString().c_str());
 
+  auto start = std::chrono::steady_clock::now();
   instance->Start();
-  start_order_.push_back(module);
-  started_modules_[module] = instance;
+  set_started(module, instance, std::chrono::steady_clock::now() - start);
   LOG_DEBUG("Started %s", instance->ToString().c_str());
   return instance;
 }
 
+void ModuleRegistry::set_started(
+    const ModuleFactory* module, Module* instance, std::chrono::steady_clock::duration start_time) {
+  // Shown with the other latency histograms in dumpsys
+  LatencyHistogram::Get("Module start " + instance->ToString()).Record(start_time);
+  std::lock_guard<std::mutex> lock(started_modules_mutex_);
+  start_order_.push_back(module);
+  started_modules_[module] = instance;
+}
+
+void ModuleRegistry::StartParallel(ModuleList* modules, Thread* thread, size_t num_workers) {
+  struct Node {
+    Module* instance;
+    size_t pending_dependencies = 0;
+    std::vector<const ModuleFactory*> dependents;
+  };
+  std::map<const ModuleFactory*, Node> graph;
+
+  // Construct the modules which are not started yet and build their dependency graph, on this thread
+  std::function<void(const ModuleFactory*)> add = [&](const ModuleFactory* module) {
+    if (IsStarted(module) || graph.count(module) != 0) {
+      return;
+    }
+    Module* instance = module->ctor_();
+    set_registry_and_handler(instance, thread);
+    instance->ListDependencies(&instance->dependencies_);
+    graph[module].instance = instance;
+    for (const ModuleFactory* dependency : instance->dependencies_.list_) {
+      add(dependency);
+      if (!IsStarted(dependency)) {
+        graph[module].pending_dependencies++;
+        graph[dependency].dependents.push_back(module);
+      }
+    }
+  };
+  for (const ModuleFactory* module : modules->list_) {
+    add(module);
+  }
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::queue<const ModuleFactory*> ready;
+  size_t remaining = graph.size();
+  // Only set on this thread once the workers are joined, last_instance_ is not synchronized
+  Module* last_started = nullptr;
+  for (auto& [module, node] : graph) {
+    if (node.pending_dependencies == 0) {
+      ready.push(module);
+    }
+  }
+
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      changed.wait(lock, [&]() { return !ready.empty() || remaining == 0; });
+      if (remaining == 0) {
+        return;
+      }
+      const ModuleFactory* module = ready.front();
+      ready.pop();
+      Module* instance = graph[module].instance;
+      lock.unlock();
+
+      LOG_DEBUG("Calling Start() of %s", instance->ToString().c_str());
+      auto start = std::chrono::steady_clock::now();
+      instance->Start();
+      set_started(module, instance, std::chrono::steady_clock::now() - start);
+      LOG_DEBUG("Started %s", instance->ToString().c_str());
+
+      lock.lock();
+      last_started = instance;
+      remaining--;
+      for (const ModuleFactory* dependent : graph[module].dependents) {
+        if (--graph[dependent].pending_dependencies == 0) {
+          ready.push(dependent);
+        }
+      }
+      changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::max<size_t>(num_workers, 1); i++) {
+    workers.emplace_back(worker);
+  }
+  for (auto& worker_thread : workers) {
+    worker_thread.join();
+  }
+  if (last_started != nullptr) {
+    last_instance_ = "starting " + last_started->ToString();
+  }
+}
+
 void ModuleRegistry::StopAll() {
   // Since modules were brought up in dependency order, it is safe to tear down by going in reverse order.
   for (auto it = start_order_.rbegin(); it != start_order_.rend(); it++) {
@@ -114,6 +220,7 @@ void ModuleRegistry::StopAll() {
     LOG_INFO("Stopping Module %s", instance->second->ToString().c_str());
     instance->second->Stop();
   }
+  std::lock_guard<std::mutex> lock(started_modules_mutex_);
   for (auto it = start_order_.rbegin(); it != start_order_.rend(); it++) {
     auto instance = started_modules_.find(*it);
     ASSERT(instance != started_modules_.end());
@@ -142,6 +249,8 @@ void ModuleDumper::DumpState(std::string* output) const {
 
   auto init_flags_offset = dumpsys::InitFlags::Dump(&builder);
   auto wakelock_offset = WakelockManager::Get().GetDumpsysData(&builder);
+  auto handler_stats_offset = GetHandlerStatsDumpsysData(&builder);
+  auto latency_histograms_offset = GetLatencyHistogramsDumpsysData(&builder);
 
   std::queue<DumpsysDataFinisher> queue;
   for (auto it = module_registry_.start_order_.rbegin(); it != module_registry_.start_order_.rend(); it++) {
@@ -154,6 +263,8 @@ void ModuleDumper::DumpState(std::string* output) const {
   data_builder.add_title(title);
   data_builder.add_init_flags(init_flags_offset);
   data_builder.add_wakelock_manager_data(wakelock_offset);
+  data_builder.add_handler_stats_data(handler_stats_offset);
+  data_builder.add_latency_histograms_data(latency_histograms_offset);
 
   while (!queue.empty()) {
     queue.front()(&data_builder);
@@ -164,4 +275,60 @@ void ModuleDumper::DumpState(std::string* output) const {
   *output = std::string(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
 }
 
+void ModuleDumper::DumpCommonState(std::string* output) const {
+  ASSERT(output != nullptr);
+
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto title = builder.CreateString(title_);
+
+  auto init_flags_offset = dumpsys::InitFlags::Dump(&builder);
+  auto wakelock_offset = WakelockManager::Get().GetDumpsysData(&builder);
+  auto handler_stats_offset = GetHandlerStatsDumpsysData(&builder);
+  auto latency_histograms_offset = GetLatencyHistogramsDumpsysData(&builder);
+
+  DumpsysDataBuilder data_builder(builder);
+  data_builder.add_title(title);
+  data_builder.add_init_flags(init_flags_offset);
+  data_builder.add_wakelock_manager_data(wakelock_offset);
+  data_builder.add_handler_stats_data(handler_stats_offset);
+  data_builder.add_latency_histograms_data(latency_histograms_offset);
+
+  builder.Finish(data_builder.Finish());
+  *output = std::string(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+}
+
+std::vector<std::shared_ptr<ModuleDumper::ModuleData>> ModuleDumper::DumpModulesAsync() const {
+  std::vector<std::shared_ptr<ModuleData>> modules_data;
+  for (auto it = module_registry_.start_order_.rbegin(); it != module_registry_.start_order_.rend(); it++) {
+    auto instance = module_registry_.started_modules_.find(*it);
+    ASSERT(instance != module_registry_.started_modules_.end());
+    const Module* module = instance->second;
+    auto module_data = std::make_shared<ModuleData>(module->ToString());
+    module->GetHandler()->Post(common::BindOnce(&ModuleDumper::CollectModuleData, module, module_data));
+    modules_data.push_back(std::move(module_data));
+  }
+  return modules_data;
+}
+
+void ModuleDumper::CollectModuleData(const Module* module, std::shared_ptr<ModuleData> module_data) {
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto title = builder.CreateString(module_data->GetName());
+  auto finisher = module->GetDumpsysData(&builder);
+
+  DumpsysDataBuilder data_builder(builder);
+  data_builder.add_title(title);
+  finisher(&data_builder);
+  builder.Finish(data_builder.Finish());
+
+  std::lock_guard<std::mutex> lock(module_data->mutex_);
+  module_data->data_ = std::string(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+  module_data->collected_ = true;
+  module_data->collected_cv_.notify_all();
+}
+
+bool ModuleDumper::ModuleData::WaitUntil(std::chrono::steady_clock::time_point deadline) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return collected_cv_.wait_until(lock, deadline, [this]() { return collected_; });
+}
+
 }  // namespace bluetooth
@@ -17,9 +17,13 @@
 #pragma once
 
 #include <flatbuffers/flatbuffers.h>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -144,6 +148,11 @@ class ModuleRegistry {
 
   Module* Start(const ModuleFactory* id, ::bluetooth::os::Thread* thread);
 
+  // Start all the modules on this list and their dependencies like Start(), but call the Start() of the modules which
+  // do not depend on each other concurrently, on up to num_workers threads. A module still only starts once all its
+  // dependencies are started.
+  void StartParallel(ModuleList* modules, ::bluetooth::os::Thread* thread, size_t num_workers);
+
   // Stop all running modules in reverse order of start
   void StopAll();
 
@@ -154,6 +163,11 @@ class ModuleRegistry {
 
   os::Handler* GetModuleHandler(const ModuleFactory* module) const;
 
+  // Mark the module as started, once its Start() returned
+  void set_started(const ModuleFactory* module, Module* instance, std::chrono::steady_clock::duration start_time);
+
+  // Guards started_modules_ and start_order_ while the modules start in parallel
+  mutable std::mutex started_modules_mutex_;
   std::map<const ModuleFactory*, Module*> started_modules_;
   std::vector<const ModuleFactory*> start_order_;
   std::string last_instance_;
@@ -161,11 +175,47 @@ class ModuleRegistry {
 
 class ModuleDumper {
  public:
+  // The dumpsys data of a single module, collected on the handler of that module
+  class ModuleData {
+   public:
+    explicit ModuleData(std::string name) : name_(std::move(name)) {}
+
+    const std::string& GetName() const {
+      return name_;
+    }
+
+    // Wait for the data to be collected, return false if the deadline passed first
+    bool WaitUntil(std::chrono::steady_clock::time_point deadline);
+
+    // DumpsysData buffer holding the title and the data of the module only, once collected
+    std::string* GetData() {
+      return &data_;
+    }
+
+   private:
+    friend ModuleDumper;
+
+    const std::string name_;
+    std::mutex mutex_;
+    std::condition_variable collected_cv_;
+    bool collected_{false};
+    std::string data_;
+  };
+
   ModuleDumper(const ModuleRegistry& module_registry, const char* title)
       : module_registry_(module_registry), title_(title) {}
   void DumpState(std::string* output) const;
 
+  // Dump the state which is not owned by any module, in a DumpsysData buffer holding the title
+  void DumpCommonState(std::string* output) const;
+
+  // Post the collection of the data of every started module to the handler of that module, so that each module is
+  // dumped in between its other tasks rather than all of them at once. The data is returned in dump order.
+  std::vector<std::shared_ptr<ModuleData>> DumpModulesAsync() const;
+
  private:
+  static void CollectModuleData(const Module* module, std::shared_ptr<ModuleData> module_data);
+
   const ModuleRegistry& module_registry_;
   const std::string title_;
 };
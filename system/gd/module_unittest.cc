@@ -271,6 +271,39 @@ TEST_F(ModuleTest, two_dependencies) {
   EXPECT_FALSE(registry_->IsStarted<TestModuleTwoDependencies>());
 }
 
+TEST_F(ModuleTest, two_dependencies_parallel) {
+  ModuleList list;
+  list.add<TestModuleTwoDependencies>();
+  registry_->StartParallel(&list, thread_, 4);
+
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleOneDependency>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependencyTwo>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleTwoDependencies>());
+
+  registry_->StopAll();
+
+  EXPECT_FALSE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleOneDependency>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleNoDependencyTwo>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleTwoDependencies>());
+}
+
+TEST_F(ModuleTest, parallel_start_skips_started_modules) {
+  ModuleList first;
+  first.add<TestModuleOneDependency>();
+  registry_->Start(&first, thread_);
+
+  ModuleList second;
+  second.add<TestModuleTwoDependencies>();
+  registry_->StartParallel(&second, thread_, 2);
+
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependencyTwo>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleTwoDependencies>());
+
+  registry_->StopAll();
+}
+
 void post_to_module_one_handler() {
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
   test_module_one_dependency_handler->Post(common::BindOnce([] { FAIL(); }));
@@ -36,6 +36,8 @@ struct InquiryModule::impl {
   void RegisterCallbacks(InquiryCallbacks inquiry_callbacks);
   void UnregisterCallbacks();
 
+  void RegisterActivityCallback(InquiryActivityCallback callback);
+
   void StartOneShotInquiry(bool limited, InquiryLength inquiry_length, NumResponses num_responses);
   void StopOneShotInquiry();
 
@@ -62,6 +64,7 @@ struct InquiryModule::impl {
 
  private:
   InquiryCallbacks inquiry_callbacks_;
+  InquiryActivityCallback activity_callback_;
 
   InquiryModule& module_;
 
@@ -76,6 +79,7 @@ struct InquiryModule::impl {
   int8_t inquiry_response_tx_power_;
 
   bool IsInquiryActive() const;
+  void NotifyActivityChange(bool was_active);
 
   void EnqueueCommandComplete(std::unique_ptr<hci::CommandBuilder> command);
   void EnqueueCommandStatus(std::unique_ptr<hci::CommandBuilder> command);
@@ -200,8 +204,10 @@ void neighbor::InquiryModule::impl::OnEvent(hci::EventView view) {
       auto packet = hci::InquiryCompleteView::Create(view);
       ASSERT(packet.IsValid());
       LOG_INFO("inquiry complete");
+      bool was_active = IsInquiryActive();
       active_limited_one_shot_ = false;
       active_general_one_shot_ = false;
+      NotifyActivityChange(was_active);
       inquiry_callbacks_.complete(packet.GetStatus());
     } break;
 
@@ -263,6 +269,16 @@ void neighbor::InquiryModule::impl::UnregisterCallbacks() {
   inquiry_callbacks_ = {nullptr, nullptr, nullptr, nullptr};
 }
 
+void neighbor::InquiryModule::impl::RegisterActivityCallback(InquiryActivityCallback callback) {
+  activity_callback_ = callback;
+}
+
+void neighbor::InquiryModule::impl::NotifyActivityChange(bool was_active) {
+  if (was_active != IsInquiryActive()) {
+    activity_callback_.InvokeIfNotEmpty(IsInquiryActive());
+  }
+}
+
 void neighbor::InquiryModule::impl::EnqueueCommandComplete(std::unique_ptr<hci::CommandBuilder> command) {
   hci_layer_->EnqueueCommand(std::move(command), handler_->BindOnceOn(this, &impl::OnCommandComplete));
 }
@@ -293,6 +309,7 @@ void neighbor::InquiryModule::impl::StartOneShotInquiry(
     active_general_one_shot_ = true;
     lap.lap_ = kGeneralInquiryAccessCode;
   }
+  NotifyActivityChange(false);
   EnqueueCommandStatus(hci::InquiryBuilder::Create(lap, inquiry_length, num_responses));
 }
 
@@ -300,6 +317,7 @@ void neighbor::InquiryModule::impl::StopOneShotInquiry() {
   ASSERT(active_general_one_shot_ || active_limited_one_shot_);
   active_general_one_shot_ = false;
   active_limited_one_shot_ = false;
+  NotifyActivityChange(true);
   EnqueueCommandComplete(hci::InquiryCancelBuilder::Create());
 }
 
@@ -319,6 +337,7 @@ void neighbor::InquiryModule::impl::StartPeriodicInquiry(
     active_general_periodic_ = true;
     lap.lap_ = kGeneralInquiryAccessCode;
   }
+  NotifyActivityChange(false);
   EnqueueCommandComplete(
       hci::PeriodicInquiryModeBuilder::Create(max_delay, min_delay, lap, inquiry_length, num_responses));
 }
@@ -327,6 +346,7 @@ void neighbor::InquiryModule::impl::StopPeriodicInquiry() {
   ASSERT(active_general_periodic_ || active_limited_periodic_);
   active_general_periodic_ = false;
   active_limited_periodic_ = false;
+  NotifyActivityChange(true);
   EnqueueCommandComplete(hci::ExitPeriodicInquiryModeBuilder::Create());
 }
 
@@ -400,6 +420,11 @@ void neighbor::InquiryModule::UnregisterCallbacks() {
   pimpl_->UnregisterCallbacks();
 }
 
+void neighbor::InquiryModule::RegisterActivityCallback(InquiryActivityCallback callback) {
+  GetHandler()->Post(common::BindOnce(
+      &neighbor::InquiryModule::impl::RegisterActivityCallback, common::Unretained(pimpl_.get()), callback));
+}
+
 void neighbor::InquiryModule::StartGeneralInquiry(InquiryLength inquiry_length, NumResponses num_responses) {
   GetHandler()->Post(common::BindOnce(
       &neighbor::InquiryModule::impl::StartOneShotInquiry,
@@ -17,6 +17,7 @@
 
 #include <memory>
 
+#include "common/contextual_callback.h"
 #include "hci/hci_packets.h"
 #include "module.h"
 #include "neighbor/scan_parameters.h"
@@ -32,6 +33,8 @@ using InquiryResultCallback = std::function<void(hci::InquiryResultView view)>;
 using InquiryResultWithRssiCallback = std::function<void(hci::InquiryResultWithRssiView view)>;
 using ExtendedInquiryResultCallback = std::function<void(hci::ExtendedInquiryResultView view)>;
 using InquiryCompleteCallback = std::function<void(hci::ErrorCode status)>;
+// Invoked with true when a one shot or periodic inquiry starts, and with false when no inquiry is active any more
+using InquiryActivityCallback = common::ContextualCallback<void(bool active)>;
 
 using InquiryCallbacks = struct {
   InquiryResultCallback result;
@@ -45,6 +48,8 @@ class InquiryModule : public bluetooth::Module {
   void RegisterCallbacks(InquiryCallbacks inquiry_callbacks);
   void UnregisterCallbacks();
 
+  void RegisterActivityCallback(InquiryActivityCallback callback);
+
   void StartGeneralInquiry(InquiryLength inquiry_length, NumResponses num_responses);
   void StartLimitedInquiry(InquiryLength inquiry_length, NumResponses num_responses);
   void StopInquiry();
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "bt_gd_neigh"
+
+#include "neighbor/radio_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include "common/bind.h"
+#include "module.h"
+#include "neighbor/inquiry.h"
+#include "neighbor/page.h"
+#include "neighbor/scan_parameters.h"
+#include "os/handler.h"
+#include "os/log.h"
+#include "os/system_properties.h"
+
+namespace bluetooth {
+namespace neighbor {
+
+namespace {
+constexpr char kPropertyRadioPriority[] = "bluetooth.neighbor.radio_priority";
+constexpr ScanWindow kMinPageScanWindow = 0x0011;
+}  // namespace
+
+std::string RadioPriorityText(RadioPriority priority) {
+  switch (priority) {
+    case RadioPriority::CONNECTABILITY:
+      return "connectability";
+    case RadioPriority::BALANCED:
+      return "balanced";
+    case RadioPriority::DISCOVERY:
+      return "discovery";
+  }
+  return "unknown";
+}
+
+struct RadioSchedulerModule::impl {
+  void SetPriority(RadioPriority priority);
+  RadioPriority GetPriority() const;
+
+  InquiryStatistics GetInquiryStatistics() const;
+
+  void Start();
+  void Stop();
+
+  impl(RadioSchedulerModule& module);
+
+ private:
+  RadioSchedulerModule& module_;
+
+  RadioPriority priority_{RadioPriority::CONNECTABILITY};
+  InquiryStatistics statistics_{};
+
+  bool inquiry_active_{false};
+  std::chrono::steady_clock::time_point inquiry_start_;
+  // Page scan activity to restore when the inquiry is over, set while it is reduced
+  std::optional<ScanParameters> saved_page_scan_;
+
+  void OnInquiryActivity(bool active);
+  void ReducePageScan();
+  void RestorePageScan();
+
+  InquiryModule* inquiry_module_;
+  PageModule* page_module_;
+  os::Handler* handler_;
+};
+
+const ModuleFactory neighbor::RadioSchedulerModule::Factory =
+    ModuleFactory([]() { return new neighbor::RadioSchedulerModule(); });
+
+neighbor::RadioSchedulerModule::impl::impl(neighbor::RadioSchedulerModule& module) : module_(module) {}
+
+void neighbor::RadioSchedulerModule::impl::Start() {
+  inquiry_module_ = module_.GetDependency<InquiryModule>();
+  page_module_ = module_.GetDependency<PageModule>();
+  handler_ = module_.GetHandler();
+
+  auto priority = os::GetSystemProperty(kPropertyRadioPriority);
+  if (priority == RadioPriorityText(RadioPriority::BALANCED)) {
+    priority_ = RadioPriority::BALANCED;
+  } else if (priority == RadioPriorityText(RadioPriority::DISCOVERY)) {
+    priority_ = RadioPriority::DISCOVERY;
+  }
+  LOG_INFO("Radio priority:%s", RadioPriorityText(priority_).c_str());
+
+  inquiry_module_->RegisterActivityCallback(handler_->BindOn(this, &impl::OnInquiryActivity));
+}
+
+void neighbor::RadioSchedulerModule::impl::Stop() {
+  inquiry_module_->RegisterActivityCallback({});
+  RestorePageScan();
+  LOG_INFO(
+      "Inquiries count:%u last:%llums total:%llums longest:%llums",
+      statistics_.count,
+      static_cast<unsigned long long>(statistics_.last_duration_ms),
+      static_cast<unsigned long long>(statistics_.total_duration_ms),
+      static_cast<unsigned long long>(statistics_.longest_duration_ms));
+}
+
+void neighbor::RadioSchedulerModule::impl::OnInquiryActivity(bool active) {
+  if (active == inquiry_active_) {
+    return;
+  }
+  inquiry_active_ = active;
+  if (active) {
+    inquiry_start_ = std::chrono::steady_clock::now();
+    ReducePageScan();
+    return;
+  }
+
+  uint64_t duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - inquiry_start_)
+                             .count();
+  statistics_.count++;
+  statistics_.last_duration_ms = duration_ms;
+  statistics_.total_duration_ms += duration_ms;
+  statistics_.longest_duration_ms = std::max(statistics_.longest_duration_ms, duration_ms);
+  RestorePageScan();
+}
+
+// Only the window is reduced: the interval is the one advertised by the page scan repetition mode
+void neighbor::RadioSchedulerModule::impl::ReducePageScan() {
+  if (priority_ == RadioPriority::CONNECTABILITY) {
+    return;
+  }
+  ScanParameters params = saved_page_scan_.value_or(page_module_->GetScanActivity());
+  ScanWindow window = kMinPageScanWindow;
+  if (priority_ == RadioPriority::BALANCED) {
+    window = std::max<ScanWindow>(kMinPageScanWindow, params.window / 2);
+  }
+  if (window >= params.window) {
+    return;
+  }
+  if (!saved_page_scan_.has_value()) {
+    saved_page_scan_ = params;
+  }
+  page_module_->SetScanActivity({params.interval, window});
+}
+
+void neighbor::RadioSchedulerModule::impl::RestorePageScan() {
+  if (!saved_page_scan_.has_value()) {
+    return;
+  }
+  page_module_->SetScanActivity(*saved_page_scan_);
+  saved_page_scan_.reset();
+}
+
+void neighbor::RadioSchedulerModule::impl::SetPriority(RadioPriority priority) {
+  if (priority == priority_) {
+    return;
+  }
+  LOG_INFO("Set radio priority:%s", RadioPriorityText(priority).c_str());
+  priority_ = priority;
+  if (!inquiry_active_) {
+    return;
+  }
+  if (priority_ == RadioPriority::CONNECTABILITY) {
+    RestorePageScan();
+  } else {
+    ReducePageScan();
+  }
+}
+
+RadioPriority neighbor::RadioSchedulerModule::impl::GetPriority() const {
+  return priority_;
+}
+
+InquiryStatistics neighbor::RadioSchedulerModule::impl::GetInquiryStatistics() const {
+  return statistics_;
+}
+
+/**
+ * General API here
+ */
+neighbor::RadioSchedulerModule::RadioSchedulerModule() : pimpl_(std::make_unique<impl>(*this)) {}
+
+neighbor::RadioSchedulerModule::~RadioSchedulerModule() {
+  pimpl_.reset();
+}
+
+void neighbor::RadioSchedulerModule::SetPriority(RadioPriority priority) {
+  GetHandler()->Post(common::BindOnce(
+      &neighbor::RadioSchedulerModule::impl::SetPriority, common::Unretained(pimpl_.get()), priority));
+}
+
+RadioPriority neighbor::RadioSchedulerModule::GetPriority() const {
+  return pimpl_->GetPriority();
+}
+
+InquiryStatistics neighbor::RadioSchedulerModule::GetInquiryStatistics() const {
+  return pimpl_->GetInquiryStatistics();
+}
+
+/**
+ * Module methods here
+ */
+void neighbor::RadioSchedulerModule::ListDependencies(ModuleList* list) const {
+  list->add<InquiryModule>();
+  list->add<PageModule>();
+}
+
+void neighbor::RadioSchedulerModule::Start() {
+  pimpl_->Start();
+}
+
+void neighbor::RadioSchedulerModule::Stop() {
+  pimpl_->Stop();
+}
+
+}  // namespace neighbor
+}  // namespace bluetooth
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "module.h"
+
+namespace bluetooth {
+namespace neighbor {
+
+// Which activity gets the radio time when an inquiry runs while page scan is enabled
+enum class RadioPriority {
+  // Page scan keeps its windows, the inquiry finds devices more slowly
+  CONNECTABILITY,
+  // Page scan windows are halved during inquiries
+  BALANCED,
+  // Page scan windows are reduced to the minimum during inquiries
+  DISCOVERY,
+};
+
+std::string RadioPriorityText(RadioPriority priority);
+
+struct InquiryStatistics {
+  uint32_t count;
+  uint64_t last_duration_ms;
+  uint64_t total_duration_ms;
+  uint64_t longest_duration_ms;
+};
+
+// Shares the BR/EDR radio time between the inquiries of InquiryModule and the page scan of PageModule. The page scan
+// interval is kept, so that the page scan repetition mode given in the inquiry responses stays true, and only the page
+// scan window shrinks while an inquiry is active. The duration of the inquiries is measured to tune the priority.
+class RadioSchedulerModule : public bluetooth::Module {
+ public:
+  void SetPriority(RadioPriority priority);
+  RadioPriority GetPriority() const;
+
+  InquiryStatistics GetInquiryStatistics() const;
+
+  static const ModuleFactory Factory;
+
+  RadioSchedulerModule();
+  RadioSchedulerModule(const RadioSchedulerModule&) = delete;
+  RadioSchedulerModule& operator=(const RadioSchedulerModule&) = delete;
+
+  ~RadioSchedulerModule();
+
+ protected:
+  void ListDependencies(ModuleList* list) const override;
+  void Start() override;
+  void Stop() override;
+  std::string ToString() const override {
+    return std::string("RadioScheduler");
+  }
+
+ private:
+  struct impl;
+  std::unique_ptr<impl> pimpl_;
+};
+
+}  // namespace neighbor
+}  // namespace bluetooth
@@ -22,15 +22,15 @@
 
 #include "common/callback.h"
 #include "os/handler.h"
+#include "os/internal/timer_multiplexer.h"
 #include "os/thread.h"
 #include "os/utils.h"
 
 namespace bluetooth {
 namespace os {
 
-// A single-shot alarm for reactor-based thread, implemented by Linux timerfd.
-// When it's constructed, it will register a reactable on the specified thread; when it's destroyed, it will unregister
-// itself from the thread.
+// A single-shot alarm for reactor-based thread. All the alarms of a thread share a timer wheel backed by a single Linux
+// timerfd registered on that thread; when an alarm is destroyed, it is removed from the wheel.
 class Alarm {
  public:
   // Create and register a single-shot alarm on a given handler
@@ -42,7 +42,7 @@ class Alarm {
   // Unregister this alarm from the thread and release resource
   ~Alarm();
 
-  // Schedule the alarm with given delay
+  // Schedule the alarm with given delay. A zero delay leaves the alarm disarmed.
   void Schedule(common::OnceClosure task, std::chrono::milliseconds delay);
 
   // Cancel the alarm. No-op if it's not armed.
@@ -51,10 +51,12 @@ class Alarm {
  private:
   common::OnceClosure task_;
   Handler* handler_;
-  int fd_ = 0;
-  Reactor::Reactable* token_;
+  internal::TimerMultiplexer* timer_multiplexer_;
+  internal::TimerMultiplexer::Timer timer_;
+  // Generation of the pending schedule, or 0 if the alarm is not armed
+  uint64_t generation_ = 0;
   mutable std::mutex mutex_;
-  void on_fire();
+  void on_fire(uint64_t generation);
 };
 
 }  // namespace os
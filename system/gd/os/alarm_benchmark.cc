@@ -17,6 +17,7 @@
 #include <chrono>
 #include <future>
 #include <unordered_map>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "common/bind.h"
@@ -50,6 +51,7 @@ class BM_ReactableAlarm : public ::benchmark::Fixture {
   void TearDown(State& st) override {
     alarm_ = nullptr;
     repeating_alarm_ = nullptr;
+    handler_->Clear();
     handler_ = nullptr;
     thread_->Stop();
     thread_ = nullptr;
@@ -140,3 +142,25 @@ BENCHMARK_REGISTER_F(BM_ReactableAlarm, periodic_accuracy)
     ->Args({2000, 15, 20})
     ->Iterations(1)
     ->UseRealTime();
+
+// Alarms of a busy thread are constantly re-scheduled and cancelled long before they fire, e.g. supervision and
+// response timeouts. Measures schedule + cancel with state.range(0) alarms armed concurrently on the same thread.
+BENCHMARK_DEFINE_F(BM_ReactableAlarm, schedule_cancel_churn)(State& state) {
+  std::vector<std::unique_ptr<Alarm>> alarms;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    alarms.push_back(std::make_unique<Alarm>(handler_.get()));
+    alarms.back()->Schedule(bluetooth::common::BindOnce([] {}), std::chrono::milliseconds(60000 + i));
+  }
+  int64_t round = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < alarms.size(); i++) {
+      alarms[i]->Cancel();
+      alarms[i]->Schedule(bluetooth::common::BindOnce([] {}), std::chrono::milliseconds(60000 + (round + i) % 1000));
+    }
+    round++;
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  alarms.clear();
+};
+
+BENCHMARK_REGISTER_F(BM_ReactableAlarm, schedule_cancel_churn)->Arg(10)->Arg(100)->Arg(1000)->UseRealTime();
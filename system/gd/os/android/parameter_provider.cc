@@ -30,6 +30,7 @@ std::mutex parameter_mutex;
 std::string config_file_path;
 std::string snoop_log_file_path;
 std::string snooz_log_file_path;
+std::string controller_capabilities_file_path;
 bluetooth_keystore::BluetoothKeystoreInterface* bt_keystore_interface = nullptr;
 bool is_common_criteria_mode = false;
 int common_criteria_config_compare_result = 0b11;
@@ -82,6 +83,21 @@ void ParameterProvider::OverrideSnoozLogFilePath(const std::string& path) {
   snooz_log_file_path = path;
 }
 
+std::string ParameterProvider::ControllerCapabilitiesFilePath() {
+  {
+    std::lock_guard<std::mutex> lock(parameter_mutex);
+    if (!controller_capabilities_file_path.empty()) {
+      return controller_capabilities_file_path;
+    }
+  }
+  return "/data/misc/bluedroid/bt_controller_capabilities.conf";
+}
+
+void ParameterProvider::OverrideControllerCapabilitiesFilePath(const std::string& path) {
+  std::lock_guard<std::mutex> lock(parameter_mutex);
+  controller_capabilities_file_path = path;
+}
+
 bluetooth_keystore::BluetoothKeystoreInterface* ParameterProvider::GetBtKeystoreInterface() {
   std::lock_guard<std::mutex> lock(parameter_mutex);
   return bt_keystore_interface;
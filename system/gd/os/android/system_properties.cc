@@ -46,6 +46,7 @@ bool SetSystemProperty(const std::string& property, const std::string& value) {
     LOG_ERROR("Set property %s failed with error code %d", property.c_str(), ret);
     return false;
   }
+  ReloadCachedSystemProperties();
   return true;
 }
 
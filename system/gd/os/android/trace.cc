@@ -0,0 +1,62 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BtGdTrace"
+// Bluetooth has no atrace category of its own, the network category is the closest one
+#define ATRACE_TAG ATRACE_TAG_NETWORK
+
+#include "os/trace.h"
+
+#include <cutils/trace.h>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace os {
+
+bool IsTracing() {
+  return ATRACE_ENABLED();
+}
+
+bool StartTracing(const std::string& path) {
+  LOG_WARN("Trace events are written to atrace, start a Perfetto trace instead of writing to %s", path.c_str());
+  return false;
+}
+
+void StopTracing() {}
+
+void TraceBegin(const std::string& name) {
+  ATRACE_BEGIN(name.c_str());
+}
+
+void TraceEnd() {
+  ATRACE_END();
+}
+
+void TraceAsyncBegin(const std::string& name, int32_t cookie) {
+  ATRACE_ASYNC_BEGIN(name.c_str(), cookie);
+}
+
+void TraceAsyncEnd(const std::string& name, int32_t cookie) {
+  ATRACE_ASYNC_END(name.c_str(), cookie);
+}
+
+void TraceCounter(const std::string& name, int64_t value) {
+  ATRACE_INT64(name.c_str(), value);
+}
+
+}  // namespace os
+}  // namespace bluetooth
@@ -16,19 +16,33 @@
 
 #include "os/handler.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 
 #include "common/bind.h"
 #include "common/callback.h"
+#include "os/handler_stats.h"
 #include "os/log.h"
 #include "os/reactor.h"
 #include "os/utils.h"
 
+namespace {
+
+// Upper bound of closures run per wake-up, so that other reactables on the same thread are not starved by a burst
+constexpr size_t kMaxClosuresPerEvent = 64;
+
+}  // namespace
+
 namespace bluetooth {
 namespace os {
+using common::InlineClosure;
 using common::OnceClosure;
 
-Handler::Handler(Thread* thread) : tasks_(new std::queue<OnceClosure>()), thread_(thread) {
+Handler::Handler(Thread* thread) : Handler(thread, thread->GetThreadName()) {}
+
+Handler::Handler(Thread* thread, std::string stats_site)
+    : cleared_(std::make_shared<std::atomic<bool>>(false)), thread_(thread), stats_site_(std::move(stats_site)) {
   event_ = thread_->GetReactor()->NewEvent();
   reactable_ = thread_->GetReactor()->Register(
       event_->Id(), common::Bind(&Handler::handle_next_event, common::Unretained(this)), common::Closure());
@@ -43,25 +57,34 @@ Handler::~Handler() {
 }
 
 void Handler::Post(OnceClosure closure) {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (was_cleared()) {
-      LOG_WARN("Posting to a handler which has been cleared");
-      return;
-    }
-    tasks_->emplace(std::move(closure));
+  Post(InlineClosure(std::move(closure)));
+}
+
+void Handler::Post(InlineClosure closure) {
+  if (was_cleared()) {
+    LOG_WARN("Posting to a handler which has been cleared");
+    return;
+  }
+  if (HandlerStats::IsEnabled()) {
+    closure = HandlerStats::Instrument(stats_site_, std::move(closure).IntoOnceClosure());
+  }
+  // Only the first closure queued since the last drain needs to wake up the thread
+  if (tasks_.Push(std::move(closure))) {
+    event_->Notify();
   }
-  event_->Notify();
 }
 
 void Handler::Clear() {
-  std::queue<OnceClosure>* tmp = nullptr;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     ASSERT_LOG(!was_cleared(), "Handlers must only be cleared once");
-    std::swap(tasks_, tmp);
+    cleared_->store(true, std::memory_order_release);
+  }
+  // Once cleared, handle_next_event() no longer touches the queue, so it can be drained outside of the lock
+  InlineClosure closure;
+  while (tasks_.TryPop(&closure)) {
+    closure.Reset();
   }
-  delete tmp;
 
   event_->Clear();
 
@@ -75,7 +98,8 @@ void Handler::WaitUntilStopped(std::chrono::milliseconds timeout) {
 }
 
 void Handler::handle_next_event() {
-  common::OnceClosure closure;
+  std::array<InlineClosure, kMaxClosuresPerEvent> closures;
+  size_t count = 0;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     bool has_data = event_->Read();
@@ -85,10 +109,29 @@ void Handler::handle_next_event() {
     }
     ASSERT_LOG(has_data, "Notified for work but no work available");
 
-    closure = std::move(tasks_->front());
-    tasks_->pop();
+    size_t pending = tasks_.PendingCount();
+    if (HandlerStats::IsEnabled()) {
+      HandlerStats::Get().RecordQueueDepth(stats_site_, pending);
+    }
+    count = std::min(pending, kMaxClosuresPerEvent);
+    for (size_t i = 0; i < count; i++) {
+      closures[i] = tasks_.Pop();
+    }
+  }
+
+  // Closures posted from now on did not notify, so wake up again if any are left
+  if (tasks_.MarkConsumed(count) > 0) {
+    event_->Notify();
+  }
+
+  // The handler may be cleared and destroyed as soon as a closure returns, so only the shared flag is used from here
+  auto cleared = cleared_;
+  for (size_t i = 0; i < count; i++) {
+    if (cleared->load(std::memory_order_acquire)) {
+      return;
+    }
+    std::move(closures[i]).Run();
   }
-  std::move(closure).Run();
 }
 
 }  // namespace os
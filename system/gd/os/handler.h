@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -24,6 +25,8 @@
 #include "common/bind.h"
 #include "common/callback.h"
 #include "common/contextual_callback.h"
+#include "common/inline_closure.h"
+#include "common/mpsc_queue.h"
 #include "os/thread.h"
 #include "os/utils.h"
 
@@ -32,12 +35,17 @@ namespace os {
 
 // A message-queue style handler for reactor-based thread to handle incoming events from different threads. When it's
 // constructed, it will register a reactable on the specified thread; when it's destroyed, it will unregister itself
-// from the thread.
+// from the thread. Posting is lock-free, and only the first closure of a burst notifies the thread; the handler then
+// runs the pending closures in batches. When HandlerStats is enabled, closures are recorded under the stats site of the
+// handler, the thread name unless given.
 class Handler : public common::IPostableContext {
  public:
   // Create and register a handler on given thread
   explicit Handler(Thread* thread);
 
+  // Create and register a handler on given thread, recording its closures under stats_site, e.g. the owning module
+  Handler(Thread* thread, std::string stats_site);
+
   Handler(const Handler&) = delete;
   Handler& operator=(const Handler&) = delete;
 
@@ -47,20 +55,29 @@ class Handler : public common::IPostableContext {
   // Enqueue a closure to the queue of this handler
   virtual void Post(common::OnceClosure closure) override;
 
+  // Enqueue a closure to the queue of this handler. Unlike a OnceClosure, it needs no BindState when its functor fits.
+  virtual void Post(common::InlineClosure closure) override;
+
   // Remove all pending events from the queue of this handler
   void Clear();
 
   // Die if the current reactable doesn't stop before the timeout.  Must be called after Clear()
   void WaitUntilStopped(std::chrono::milliseconds timeout);
 
+  // Return true if invoked from the thread running this handler, where waiting for a posted closure would deadlock
+  bool IsOnThread() const {
+    return thread_->IsSameThread();
+  }
+
   template <typename Functor, typename... Args>
   void Call(Functor&& functor, Args&&... args) {
     Post(common::BindOnce(std::forward<Functor>(functor), std::forward<Args>(args)...));
   }
 
+  // Call a method of obj on this handler. The arguments are bound without base/bind.h, so they are passed as is.
   template <typename T, typename Functor, typename... Args>
   void CallOn(T* obj, Functor&& functor, Args&&... args) {
-    Post(common::BindOnce(std::forward<Functor>(functor), common::Unretained(obj), std::forward<Args>(args)...));
+    Post(common::BindInlineOn(obj, std::forward<Functor>(functor), std::forward<Args>(args)...));
   }
 
   template <typename Functor, typename... Args>
@@ -99,12 +116,16 @@ class Handler : public common::IPostableContext {
 
  private:
   inline bool was_cleared() const {
-    return tasks_ == nullptr;
+    return cleared_->load(std::memory_order_acquire);
   };
-  std::queue<common::OnceClosure>* tasks_;
+  common::MpscQueue<common::InlineClosure> tasks_;
+  // Shared with the batch being executed, which must not touch the handler after running a closure
+  std::shared_ptr<std::atomic<bool>> cleared_;
   Thread* thread_;
+  const std::string stats_site_;
   std::unique_ptr<Reactor::Event> event_;
   Reactor::Reactable* reactable_;
+  // Serializes the consumer side of tasks_ between the reactor thread and Clear()
   mutable std::mutex mutex_;
   void handle_next_event();
 };
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/bind.h"
+#include "os/handler.h"
+#include "os/thread.h"
+
+using ::benchmark::State;
+using ::bluetooth::common::BindOnce;
+using ::bluetooth::os::Handler;
+using ::bluetooth::os::Thread;
+
+class BM_HandlerPost : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    benchmark::Fixture::SetUp(st);
+    thread_ = std::make_unique<Thread>("BM_HandlerPost thread", Thread::Priority::NORMAL);
+    handler_ = std::make_unique<Handler>(thread_.get());
+  }
+  void TearDown(State& st) override {
+    handler_->Clear();
+    handler_->WaitUntilStopped(std::chrono::milliseconds(2000));
+    handler_ = nullptr;
+    thread_->Stop();
+    thread_ = nullptr;
+    benchmark::Fixture::TearDown(st);
+  }
+
+  void callback() {
+    if (++counter_ == expected_) {
+      done_promise_.set_value();
+    }
+  }
+
+  void Reset(int64_t expected) {
+    counter_ = 0;
+    expected_ = expected;
+    done_promise_ = std::promise<void>();
+  }
+
+  // Post messages_per_producer closures from each of num_producers threads, and wait until all of them ran
+  void PostFromProducers(int num_producers, int64_t messages_per_producer) {
+    Reset(num_producers * messages_per_producer);
+    auto done = done_promise_.get_future();
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; p++) {
+      producers.emplace_back([this, messages_per_producer]() {
+        for (int64_t i = 0; i < messages_per_producer; i++) {
+          handler_->Post(BindOnce(&BM_HandlerPost::callback, bluetooth::common::Unretained(this)));
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+    done.wait();
+  }
+
+  std::unique_ptr<Thread> thread_;
+  std::unique_ptr<Handler> handler_;
+  std::atomic<int64_t> counter_;
+  int64_t expected_;
+  std::promise<void> done_promise_;
+};
+
+// A burst of posts from one thread, e.g. a flood of LE advertising reports from the HAL thread
+BENCHMARK_DEFINE_F(BM_HandlerPost, single_producer_burst)(State& state) {
+  for (auto _ : state) {
+    PostFromProducers(1, state.range(0));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+};
+
+BENCHMARK_REGISTER_F(BM_HandlerPost, single_producer_burst)
+    ->Arg(10)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->UseRealTime();
+
+// Several threads posting into the same handler, where producers used to contend on the handler mutex
+BENCHMARK_DEFINE_F(BM_HandlerPost, multiple_producers)(State& state) {
+  for (auto _ : state) {
+    PostFromProducers(state.range(0), state.range(1));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+};
+
+BENCHMARK_REGISTER_F(BM_HandlerPost, multiple_producers)
+    ->Args({2, 10000})
+    ->Args({4, 10000})
+    ->Args({8, 10000})
+    ->UseRealTime();
+
+// One closure in flight at a time, which measures the wake-up latency rather than the queue throughput
+BENCHMARK_DEFINE_F(BM_HandlerPost, ping_pong)(State& state) {
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); i++) {
+      Reset(1);
+      auto done = done_promise_.get_future();
+      handler_->Post(BindOnce(&BM_HandlerPost_ping_pong_Benchmark::callback, bluetooth::common::Unretained(this)));
+      done.wait();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+};
+
+BENCHMARK_REGISTER_F(BM_HandlerPost, ping_pong)->Arg(1000)->UseRealTime();
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/handler_stats.h"
+
+#include <time.h>
+
+#include <algorithm>
+
+#include "common/bind.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace os {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::chrono::microseconds thread_cpu_time() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) +
+         std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(ts.tv_nsec));
+}
+
+void run_instrumented(const std::string& site, Clock::time_point runnable, common::OnceClosure closure) {
+  auto start = Clock::now();
+  auto start_cpu_time = thread_cpu_time();
+  std::move(closure).Run();
+  auto cpu_time = thread_cpu_time() - start_cpu_time;
+  auto end = Clock::now();
+  // A delayed closure may run slightly before its nominal time, which is no latency at all
+  auto queue_latency = std::max(
+      std::chrono::duration_cast<std::chrono::microseconds>(start - runnable), std::chrono::microseconds(0));
+  HandlerStats::Get().Record(
+      site, queue_latency, std::chrono::duration_cast<std::chrono::microseconds>(end - start), cpu_time);
+}
+
+}  // namespace
+
+std::atomic<bool> HandlerStats::enabled_(false);
+
+void HandlerStats::SetEnabled(bool enabled) {
+  LOG_INFO("Handler statistics %s", enabled ? "enabled" : "disabled");
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+size_t HandlerStats::BucketOf(std::chrono::microseconds duration) {
+  return std::upper_bound(kBucketUpperBoundsUs.begin(), kBucketUpperBoundsUs.end(), duration.count() - 1) -
+         kBucketUpperBoundsUs.begin();
+}
+
+common::OnceClosure HandlerStats::Instrument(
+    std::string site, common::OnceClosure closure, std::chrono::microseconds delay) {
+  return common::BindOnce(&run_instrumented, std::move(site), Clock::now() + delay, std::move(closure));
+}
+
+void HandlerStats::Record(
+    const std::string& site,
+    std::chrono::microseconds queue_latency,
+    std::chrono::microseconds run_duration,
+    std::chrono::microseconds cpu_time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& stats = sites_[site];
+  stats.run_count++;
+  stats.queue_latency_histogram[BucketOf(queue_latency)]++;
+  stats.run_duration_histogram[BucketOf(run_duration)]++;
+  stats.total_queue_latency += queue_latency;
+  stats.max_queue_latency = std::max(stats.max_queue_latency, queue_latency);
+  stats.total_run_duration += run_duration;
+  stats.max_run_duration = std::max(stats.max_run_duration, run_duration);
+  stats.total_cpu_time += cpu_time;
+  stats.max_cpu_time = std::max(stats.max_cpu_time, cpu_time);
+}
+
+void HandlerStats::RecordQueueDepth(const std::string& site, size_t queue_depth) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& stats = sites_[site];
+  stats.max_queue_depth = std::max(stats.max_queue_depth, queue_depth);
+}
+
+std::map<std::string, HandlerStats::SiteStats> HandlerStats::GetSnapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sites_;
+}
+
+void HandlerStats::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sites_.clear();
+}
+
+}  // namespace os
+}  // namespace bluetooth
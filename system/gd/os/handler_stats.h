@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/callback.h"
+
+namespace bluetooth {
+namespace os {
+
+// Optional instrumentation of the closures posted to os::Handler and common::MessageLoopThread. When enabled, every
+// closure records how long it waited in its queue, how long it ran and the CPU time of its thread while it ran, keyed
+// by its posting site: the module for the handlers of the gd modules, the posting location for the legacy threads.
+// When disabled, posting only pays for a relaxed atomic load.
+class HandlerStats {
+ public:
+  // Upper bounds of the histogram buckets; the last bucket counts everything above the last bound
+  static constexpr std::array<int64_t, 13> kBucketUpperBoundsUs = {
+      10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000};
+  static constexpr size_t kBuckets = kBucketUpperBoundsUs.size() + 1;
+  using Histogram = std::array<uint64_t, kBuckets>;
+
+  struct SiteStats {
+    uint64_t run_count = 0;
+    Histogram queue_latency_histogram{};
+    Histogram run_duration_histogram{};
+    std::chrono::microseconds total_queue_latency{0};
+    std::chrono::microseconds max_queue_latency{0};
+    std::chrono::microseconds total_run_duration{0};
+    std::chrono::microseconds max_run_duration{0};
+    // CPU time consumed by the thread while running the closures, excluding the time it was preempted or blocked
+    std::chrono::microseconds total_cpu_time{0};
+    std::chrono::microseconds max_cpu_time{0};
+    // Largest number of closures seen pending at once, for sites which report it
+    size_t max_queue_depth = 0;
+  };
+
+  static HandlerStats& Get() {
+    static HandlerStats instance;
+    return instance;
+  }
+
+  static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  static void SetEnabled(bool enabled);
+
+  // Return the index of the histogram bucket counting duration
+  static size_t BucketOf(std::chrono::microseconds duration);
+
+  // Wrap closure so that it records its queue latency and run duration under site once it runs. The queue latency is
+  // measured from now plus delay, the time the closure is expected to become runnable.
+  static common::OnceClosure Instrument(
+      std::string site, common::OnceClosure closure, std::chrono::microseconds delay = std::chrono::microseconds(0));
+
+  void Record(
+      const std::string& site,
+      std::chrono::microseconds queue_latency,
+      std::chrono::microseconds run_duration,
+      std::chrono::microseconds cpu_time = std::chrono::microseconds(0));
+
+  void RecordQueueDepth(const std::string& site, size_t queue_depth);
+
+  // Return a copy of the statistics of every site recorded so far
+  std::map<std::string, SiteStats> GetSnapshot() const;
+
+  // Discard all the statistics recorded so far
+  void Reset();
+
+ private:
+  HandlerStats() = default;
+
+  static std::atomic<bool> enabled_;
+  mutable std::mutex mutex_;
+  std::map<std::string, SiteStats> sites_;
+};
+
+}  // namespace os
+}  // namespace bluetooth
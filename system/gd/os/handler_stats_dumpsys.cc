@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/handler_stats_dumpsys.h"
+
+#include <vector>
+
+#include "os/handler_stats.h"
+
+namespace bluetooth {
+namespace os {
+
+namespace {
+
+flatbuffers::Offset<flatbuffers::Vector<int64_t>> create_histogram(
+    flatbuffers::FlatBufferBuilder* fb_builder, const HandlerStats::Histogram& histogram) {
+  std::vector<int64_t> counts(histogram.begin(), histogram.end());
+  return fb_builder->CreateVector(counts);
+}
+
+}  // namespace
+
+flatbuffers::Offset<HandlerStatsData> GetHandlerStatsDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) {
+  std::vector<flatbuffers::Offset<HandlerSiteStatsData>> sites;
+  for (const auto& [site, stats] : HandlerStats::Get().GetSnapshot()) {
+    auto site_offset = fb_builder->CreateString(site);
+    auto queue_latency_offset = create_histogram(fb_builder, stats.queue_latency_histogram);
+    auto run_duration_offset = create_histogram(fb_builder, stats.run_duration_histogram);
+
+    HandlerSiteStatsDataBuilder builder(*fb_builder);
+    builder.add_site(site_offset);
+    builder.add_run_count(stats.run_count);
+    builder.add_queue_latency_histogram(queue_latency_offset);
+    builder.add_run_duration_histogram(run_duration_offset);
+    builder.add_total_queue_latency_micros(stats.total_queue_latency.count());
+    builder.add_max_queue_latency_micros(stats.max_queue_latency.count());
+    builder.add_total_run_duration_micros(stats.total_run_duration.count());
+    builder.add_max_run_duration_micros(stats.max_run_duration.count());
+    builder.add_max_queue_depth(stats.max_queue_depth);
+    builder.add_total_cpu_time_micros(stats.total_cpu_time.count());
+    builder.add_max_cpu_time_micros(stats.max_cpu_time.count());
+    sites.push_back(builder.Finish());
+  }
+
+  auto title_offset = fb_builder->CreateString("Bluetooth Handler Statistics");
+  std::vector<int64_t> bounds(HandlerStats::kBucketUpperBoundsUs.begin(), HandlerStats::kBucketUpperBoundsUs.end());
+  auto bounds_offset = fb_builder->CreateVector(bounds);
+  auto sites_offset = fb_builder->CreateVector(sites);
+
+  HandlerStatsDataBuilder builder(*fb_builder);
+  builder.add_title(title_offset);
+  builder.add_enabled(HandlerStats::IsEnabled());
+  builder.add_histogram_bucket_upper_bounds_micros(bounds_offset);
+  builder.add_sites(sites_offset);
+  return builder.Finish();
+}
+
+}  // namespace os
+}  // namespace bluetooth
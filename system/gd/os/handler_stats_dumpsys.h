@@ -0,0 +1,30 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <flatbuffers/flatbuffers.h>
+
+#include "handler_stats_generated.h"
+
+namespace bluetooth {
+namespace os {
+
+// Dump the statistics recorded by HandlerStats to a flat buffer defined in handler_stats.fbs
+flatbuffers::Offset<HandlerStatsData> GetHandlerStatsDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder);
+
+}  // namespace os
+}  // namespace bluetooth
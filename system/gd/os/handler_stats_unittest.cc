@@ -0,0 +1,172 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/handler_stats.h"
+
+#include <future>
+#include <thread>
+
+#include "common/bind.h"
+#include "common/callback.h"
+#include "gtest/gtest.h"
+#include "os/handler.h"
+#include "os/thread.h"
+
+namespace bluetooth {
+namespace os {
+namespace {
+
+constexpr char kThreadName[] = "handler_stats_test_thread";
+
+uint64_t sum(const HandlerStats::Histogram& histogram) {
+  uint64_t total = 0;
+  for (auto count : histogram) {
+    total += count;
+  }
+  return total;
+}
+
+class HandlerStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    HandlerStats::Get().Reset();
+    thread_ = new Thread(kThreadName, Thread::Priority::NORMAL);
+    handler_ = new Handler(thread_);
+  }
+  void TearDown() override {
+    HandlerStats::SetEnabled(false);
+    handler_->Clear();
+    delete handler_;
+    delete thread_;
+    HandlerStats::Get().Reset();
+  }
+
+  // Closures posted while enabled record their statistics after they return, so wait for the handler to run a closure
+  // posted after them
+  void sync_handler() {
+    bool enabled = HandlerStats::IsEnabled();
+    HandlerStats::SetEnabled(false);
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    handler_->Post(common::BindOnce(&std::promise<void>::set_value, common::Unretained(&promise)));
+    future.wait();
+    HandlerStats::SetEnabled(enabled);
+  }
+
+  Handler* handler_;
+  Thread* thread_;
+};
+
+TEST_F(HandlerStatsTest, bucket_of) {
+  ASSERT_EQ(0ul, HandlerStats::BucketOf(std::chrono::microseconds(0)));
+  ASSERT_EQ(0ul, HandlerStats::BucketOf(std::chrono::microseconds(10)));
+  ASSERT_EQ(1ul, HandlerStats::BucketOf(std::chrono::microseconds(11)));
+  ASSERT_EQ(6ul, HandlerStats::BucketOf(std::chrono::milliseconds(1)));
+  ASSERT_EQ(HandlerStats::kBuckets - 2, HandlerStats::BucketOf(std::chrono::milliseconds(100)));
+  ASSERT_EQ(HandlerStats::kBuckets - 1, HandlerStats::BucketOf(std::chrono::seconds(10)));
+}
+
+TEST_F(HandlerStatsTest, disabled_by_default) {
+  ASSERT_FALSE(HandlerStats::IsEnabled());
+  handler_->Post(common::BindOnce([] {}));
+  sync_handler();
+  ASSERT_TRUE(HandlerStats::Get().GetSnapshot().empty());
+}
+
+TEST_F(HandlerStatsTest, record_posted_closures) {
+  constexpr int kClosures = 10;
+  HandlerStats::SetEnabled(true);
+
+  // Block the thread so that the other closures pile up behind the first one
+  std::promise<void> can_continue;
+  auto can_continue_future = can_continue.get_future().share();
+  handler_->Post(common::BindOnce(
+      [](std::shared_future<void> future) {
+        future.wait();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      },
+      can_continue_future));
+  for (int i = 1; i < kClosures; i++) {
+    handler_->Post(common::BindOnce([] {}));
+  }
+  can_continue.set_value();
+  sync_handler();
+
+  auto snapshot = HandlerStats::Get().GetSnapshot();
+  ASSERT_EQ(1ul, snapshot.size());
+  const auto& stats = snapshot[kThreadName];
+  ASSERT_EQ(static_cast<uint64_t>(kClosures), stats.run_count);
+  ASSERT_EQ(stats.run_count, sum(stats.queue_latency_histogram));
+  ASSERT_EQ(stats.run_count, sum(stats.run_duration_histogram));
+  ASSERT_GE(stats.max_run_duration, std::chrono::milliseconds(2));
+  // The closures behind the blocked one waited at least as long as it ran
+  ASSERT_GE(stats.max_queue_latency, std::chrono::milliseconds(2));
+  ASSERT_GE(stats.total_run_duration, stats.max_run_duration);
+  ASSERT_GE(stats.max_queue_depth, 1ul);
+}
+
+TEST_F(HandlerStatsTest, record_cpu_time) {
+  HandlerStats::SetEnabled(true);
+  handler_->Clear();
+  delete handler_;
+  handler_ = new Handler(thread_, "module");
+
+  // A sleeping closure consumes no CPU time, a spinning one consumes about as much as it runs
+  handler_->Post(common::BindOnce([] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }));
+  handler_->Post(common::BindOnce([] {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+  }));
+  sync_handler();
+
+  auto snapshot = HandlerStats::Get().GetSnapshot();
+  ASSERT_EQ(1ul, snapshot.count("module"));
+  const auto& stats = snapshot["module"];
+  ASSERT_EQ(2ul, stats.run_count);
+  ASSERT_GE(stats.total_run_duration, std::chrono::milliseconds(25));
+  ASSERT_GT(stats.max_cpu_time, std::chrono::milliseconds(1));
+  ASSERT_LT(stats.total_cpu_time, std::chrono::milliseconds(20));
+}
+
+TEST_F(HandlerStatsTest, instrument_excludes_delay) {
+  HandlerStats::SetEnabled(true);
+  bool ran = false;
+  auto closure = HandlerStats::Instrument(
+      "delayed", common::BindOnce([](bool* ran) { *ran = true; }, common::Unretained(&ran)), std::chrono::seconds(1));
+  std::move(closure).Run();
+  ASSERT_TRUE(ran);
+
+  auto snapshot = HandlerStats::Get().GetSnapshot();
+  ASSERT_EQ(1ul, snapshot["delayed"].run_count);
+  ASSERT_EQ(std::chrono::microseconds(0), snapshot["delayed"].max_queue_latency);
+}
+
+TEST_F(HandlerStatsTest, reset) {
+  HandlerStats::Get().Record("site", std::chrono::microseconds(5), std::chrono::microseconds(500));
+  HandlerStats::Get().RecordQueueDepth("site", 3);
+  auto snapshot = HandlerStats::Get().GetSnapshot();
+  ASSERT_EQ(1ul, snapshot["site"].queue_latency_histogram[0]);
+  ASSERT_EQ(1ul, snapshot["site"].run_duration_histogram[HandlerStats::BucketOf(std::chrono::microseconds(500))]);
+  ASSERT_EQ(3ul, snapshot["site"].max_queue_depth);
+
+  HandlerStats::Get().Reset();
+  ASSERT_TRUE(HandlerStats::Get().GetSnapshot().empty());
+}
+
+}  // namespace
+}  // namespace os
+}  // namespace bluetooth
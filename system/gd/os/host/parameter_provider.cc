@@ -32,6 +32,7 @@ std::mutex parameter_mutex;
 std::string config_file_path;
 std::string snoop_log_file_path;
 std::string snooz_log_file_path;
+std::string controller_capabilities_file_path;
 }  // namespace
 
 // Write to $PWD/bt_stack.conf if $PWD can be found, otherwise, write to $HOME/bt_stack.conf
@@ -96,6 +97,26 @@ void ParameterProvider::OverrideSnoozLogFilePath(const std::string& path) {
   snooz_log_file_path = path;
 }
 
+std::string ParameterProvider::ControllerCapabilitiesFilePath() {
+  {
+    std::lock_guard<std::mutex> lock(parameter_mutex);
+    if (!controller_capabilities_file_path.empty()) {
+      return controller_capabilities_file_path;
+    }
+  }
+  char cwd[PATH_MAX] = {};
+  if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+    LOG_ERROR("Failed to get current working directory due to \"%s\", returning default", strerror(errno));
+    return "bt_controller_capabilities.conf";
+  }
+  return std::string(cwd) + "/bt_controller_capabilities.conf";
+}
+
+void ParameterProvider::OverrideControllerCapabilitiesFilePath(const std::string& path) {
+  std::lock_guard<std::mutex> lock(parameter_mutex);
+  controller_capabilities_file_path = path;
+}
+
 bluetooth_keystore::BluetoothKeystoreInterface* ParameterProvider::GetBtKeystoreInterface() {
   return nullptr;
 }
@@ -14,7 +14,10 @@
  * limitations under the License.
  */
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -23,8 +26,14 @@
 namespace testing {
 
 using bluetooth::os::ClearSystemPropertiesForHost;
+using bluetooth::os::GetCachedSystemProperty;
 using bluetooth::os::GetSystemProperty;
+using bluetooth::os::ObserveCachedSystemProperty;
 using bluetooth::os::SetSystemProperty;
+using bluetooth::os::SystemPropertyKey;
+
+constexpr SystemPropertyKey<bool> kCachedBool{"bluetooth.test.cached_bool", true};
+constexpr SystemPropertyKey<uint32_t> kCachedUint32{"bluetooth.test.cached_uint32", 7};
 
 TEST(SystemPropertiesTest, set_and_get_test) {
   ASSERT_TRUE(SetSystemProperty("persist.bluetooth.factoryreset", "true"));
@@ -41,4 +50,32 @@ TEST(SystemPropertiesTest, set_and_get_test) {
   ASSERT_FALSE(GetSystemProperty("persist.bluetooth.factoryreset"));
 }
 
-}  // namespace testing
\ No newline at end of file
+TEST(SystemPropertiesTest, cached_property_follows_set_and_clear) {
+  ClearSystemPropertiesForHost();
+  ASSERT_TRUE(GetCachedSystemProperty<kCachedBool>());
+  ASSERT_EQ(GetCachedSystemProperty<kCachedUint32>(), 7u);
+
+  ASSERT_TRUE(SetSystemProperty("bluetooth.test.cached_bool", "false"));
+  ASSERT_TRUE(SetSystemProperty("bluetooth.test.cached_uint32", "42"));
+  ASSERT_FALSE(GetCachedSystemProperty<kCachedBool>());
+  ASSERT_EQ(GetCachedSystemProperty<kCachedUint32>(), 42u);
+
+  ClearSystemPropertiesForHost();
+  ASSERT_TRUE(GetCachedSystemProperty<kCachedBool>());
+  ASSERT_EQ(GetCachedSystemProperty<kCachedUint32>(), 7u);
+}
+
+TEST(SystemPropertiesTest, cached_property_observer_sees_changes_only) {
+  ClearSystemPropertiesForHost();
+  // Observers stay registered for the process, so the values outlive the test
+  auto seen = std::make_shared<std::vector<uint32_t>>();
+  ObserveCachedSystemProperty<kCachedUint32>([seen](uint32_t value) { seen->push_back(value); });
+
+  ASSERT_TRUE(SetSystemProperty("bluetooth.test.cached_uint32", "9"));
+  ASSERT_TRUE(SetSystemProperty("bluetooth.test.unrelated", "1"));
+  ASSERT_TRUE(SetSystemProperty("bluetooth.test.cached_uint32", "9"));
+  ClearSystemPropertiesForHost();
+  ASSERT_EQ(*seen, (std::vector<uint32_t>{9, 7}));
+}
+
+}  // namespace testing
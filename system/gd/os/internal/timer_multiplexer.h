@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "common/callback.h"
+#include "os/internal/timer_wheel.h"
+#include "os/reactor.h"
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+
+// DO NOT USE OUTSIDE os/
+// Multiplexes all the alarms of a thread onto a single timerfd registered on its reactor. Timers are kept in a
+// TimerWheel, and the timerfd is only re-armed when a timer needs to expire before it's due, so scheduling and
+// cancelling an alarm is usually a couple of list operations instead of timerfd syscalls. Cancelling the earliest timer
+// leaves the timerfd armed; the wake-up then finds nothing to do, and re-arms it for the next deadline.
+class TimerMultiplexer {
+ public:
+  class Timer : public TimerWheel::Entry {
+   public:
+    // on_expired is invoked on the reactor thread, with the generation returned by the Schedule() call that armed it
+    explicit Timer(common::Callback<void(uint64_t)> on_expired) : on_expired_(std::move(on_expired)) {}
+
+   private:
+    friend class TimerMultiplexer;
+    const common::Callback<void(uint64_t)> on_expired_;
+    uint64_t period_ticks_ = 0;
+    uint64_t generation_ = 0;
+  };
+
+  explicit TimerMultiplexer(Reactor* reactor);
+
+  TimerMultiplexer(const TimerMultiplexer&) = delete;
+  TimerMultiplexer& operator=(const TimerMultiplexer&) = delete;
+
+  ~TimerMultiplexer();
+
+  // Arm timer to expire after delay, then every period if period is not zero. Replaces any previous schedule of the
+  // timer, and returns a generation, which is never zero, identifying this schedule.
+  uint64_t Schedule(Timer* timer, std::chrono::milliseconds delay, std::chrono::milliseconds period);
+
+  // Disarm timer. An expiry which is already being dispatched can still be delivered with the previous generation.
+  void Cancel(Timer* timer);
+
+  // Disarm timer and wait until its callback is not running anymore, unless invoked from that callback
+  void Remove(Timer* timer);
+
+ private:
+  void on_fire();
+  void arm_locked(uint64_t deadline);
+
+  Reactor* reactor_;
+  int fd_;
+  Reactor::Reactable* reactable_;
+  std::mutex mutex_;
+  std::condition_variable dispatch_done_;
+  TimerWheel wheel_;
+  // Deadline the timerfd is currently armed for, or TimerWheel::kNever
+  uint64_t armed_deadline_ = TimerWheel::kNever;
+  uint64_t next_generation_ = 1;
+  // Timer whose callback is running, and the thread running it
+  Timer* dispatching_ = nullptr;
+  std::thread::id dispatching_thread_;
+};
+
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+
+// DO NOT USE OUTSIDE os/
+// Hierarchical timer wheel. Each of the kLevels levels has 64 slots, a slot of level L covering 64^L ticks, so inserting,
+// removing and expiring an entry are O(1) regardless of how many entries are queued. Entries of a higher level are
+// cascaded to lower levels as time moves past their slot.
+// The wheel is not thread safe and does not read any clock: the unit of a tick is up to the user, and time only moves
+// forward through Advance().
+class TimerWheel {
+ public:
+  static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+  // An intrusive wheel entry. The wheel does not own entries; they must be removed before they are destroyed.
+  class Entry {
+   public:
+    Entry() = default;
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+
+    uint64_t deadline() const {
+      return deadline_;
+    }
+
+   private:
+    friend class TimerWheel;
+    uint64_t deadline_ = 0;
+    Entry* prev_ = nullptr;
+    Entry* next_ = nullptr;
+    int8_t level_ = kNotQueued;
+    uint8_t slot_ = 0;
+  };
+
+  explicit TimerWheel(uint64_t now);
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Queue entry to expire at deadline, replacing any previous deadline. An entry whose deadline is not after Now() is
+  // expired immediately.
+  void Insert(Entry* entry, uint64_t deadline);
+
+  // Remove entry from the wheel, including from the list of expired entries. No-op if it's not queued.
+  void Remove(Entry* entry);
+
+  bool IsQueued(const Entry* entry) const {
+    return entry->level_ != kNotQueued;
+  }
+
+  // Move time forward to now, collecting every entry with a deadline up to now as expired
+  void Advance(uint64_t now);
+
+  // Return the oldest expired entry, which is no longer queued, or nullptr if there is none
+  Entry* PopExpired();
+
+  // Earliest deadline of the queued entries: Now() if there are expired entries, kNever if the wheel is empty.
+  // This walks the next occupied slot of each level, and the whole top level.
+  uint64_t NextExpiry() const;
+
+  uint64_t Now() const {
+    return now_;
+  }
+
+ private:
+  static constexpr int kLevelBits = 6;
+  static constexpr int kSlotsPerLevel = 1 << kLevelBits;
+  static constexpr int kLevels = 6;
+  // Deltas beyond the range of the top level are parked there and re-inserted when their slot comes due
+  static constexpr uint64_t kMaxDelta = (uint64_t{1} << (kLevelBits * kLevels)) - 1;
+  static constexpr int8_t kNotQueued = -1;
+  static constexpr int8_t kExpired = kLevels;
+
+  void place(Entry* entry);
+  void link_slot(Entry* entry, int level, int slot);
+  void link_expired(Entry* entry);
+  uint64_t next_slot_time() const;
+  void process_slots();
+
+  uint64_t now_;
+  Entry* slots_[kLevels][kSlotsPerLevel] = {};
+  uint64_t occupied_[kLevels] = {};
+  Entry* expired_head_ = nullptr;
+  Entry* expired_tail_ = nullptr;
+};
+
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
@@ -38,14 +38,20 @@ std::optional<std::string> GetSystemProperty(const std::string& property) {
 }
 
 bool SetSystemProperty(const std::string& property, const std::string& value) {
-  std::lock_guard<std::mutex> lock(properties_mutex);
-  properties.insert_or_assign(property, value);
+  {
+    std::lock_guard<std::mutex> lock(properties_mutex);
+    properties.insert_or_assign(property, value);
+  }
+  ReloadCachedSystemProperties();
   return true;
 }
 
 void ClearSystemPropertiesForHost() {
-  std::lock_guard<std::mutex> lock(properties_mutex);
-  properties.clear();
+  {
+    std::lock_guard<std::mutex> lock(properties_mutex);
+    properties.clear();
+  }
+  ReloadCachedSystemProperties();
 }
 
 bool IsRootCanalEnabled() {
@@ -17,6 +17,7 @@
 #include "os/alarm.h"
 
 #include <future>
+#include <vector>
 
 #include "common/bind.h"
 #include "gtest/gtest.h"
@@ -50,9 +51,9 @@ class AlarmTest : public ::testing::Test {
     handler_->Post(common::BindOnce(fake_timerfd_advance, ms));
   }
   Alarm* alarm_;
+  Handler* handler_;
 
  private:
-  Handler* handler_;
   Thread* thread_;
 };
 
@@ -99,6 +100,44 @@ TEST_F(AlarmTest, delete_while_alarm_armed) {
   std::this_thread::sleep_for(std::chrono::milliseconds(10));
 }
 
+TEST_F(AlarmTest, alarms_on_same_thread_fire_in_deadline_order) {
+  std::vector<int> fired;
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  Alarm second(handler_);
+  Alarm third(handler_);
+  alarm_->Schedule(
+      BindOnce(
+          [](std::vector<int>* fired, std::promise<void>* promise) {
+            fired->push_back(3);
+            promise->set_value();
+          },
+          common::Unretained(&fired),
+          common::Unretained(&promise)),
+      std::chrono::milliseconds(300));
+  second.Schedule(
+      BindOnce([](std::vector<int>* fired) { fired->push_back(1); }, common::Unretained(&fired)),
+      std::chrono::milliseconds(5));
+  third.Schedule(
+      BindOnce([](std::vector<int>* fired) { fired->push_back(2); }, common::Unretained(&fired)),
+      std::chrono::milliseconds(70));
+  fake_timer_advance(300);
+  future.get();
+  ASSERT_EQ(std::vector<int>({1, 2, 3}), fired);
+}
+
+TEST_F(AlarmTest, cancel_one_of_several_alarms) {
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  Alarm cancelled(handler_);
+  cancelled.Schedule(BindOnce([]() { ASSERT_TRUE(false) << "Should not happen"; }), std::chrono::milliseconds(5));
+  alarm_->Schedule(
+      BindOnce(&std::promise<void>::set_value, common::Unretained(&promise)), std::chrono::milliseconds(10));
+  cancelled.Cancel();
+  fake_timer_advance(10);
+  future.get();
+}
+
 }  // namespace
 }  // namespace os
 }  // namespace bluetooth
@@ -133,7 +133,8 @@ bool WriteToFile(const std::string& path, const std::string& data) {
     return false;
   }
 
-  if (std::fprintf(fp, "%s", data.c_str()) < 0) {
+  // Write the data as is, as it may hold null bytes
+  if (std::fwrite(data.data(), 1, data.size(), fp) != data.size()) {
     LOG_ERROR("unable to write to file '%s', error: %s", temp_path.c_str(), strerror(errno));
     HandleError(temp_path, &dir_fd, &fp);
     return false;
@@ -187,6 +188,37 @@ bool WriteToFile(const std::string& path, const std::string& data) {
   return true;
 }
 
+bool AppendToFile(const std::string& path, const std::string& data) {
+  ASSERT(!path.empty());
+  int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fd < 0) {
+    LOG_ERROR("unable to open file '%s', error: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t result = write(fd, data.data() + written, data.size() - written);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_ERROR("unable to append to file '%s', error: %s", path.c_str(), strerror(errno));
+      close(fd);
+      return false;
+    }
+    written += result;
+  }
+  if (fsync(fd) != 0) {
+    LOG_WARN("unable to fsync file '%s', error: %s", path.c_str(), strerror(errno));
+    // Allow fsync to fail and continue
+  }
+  if (close(fd) != 0) {
+    LOG_ERROR("unable to close file '%s', error: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+  return true;
+}
+
 bool RemoveFile(const std::string& path) {
   if (remove(path.c_str()) != 0) {
     LOG_ERROR("unable to remove file '%s', error: %s", path.c_str(), strerror(errno));
@@ -23,6 +23,7 @@
 
 namespace testing {
 
+using bluetooth::os::AppendToFile;
 using bluetooth::os::FileExists;
 using bluetooth::os::ReadSmallFile;
 using bluetooth::os::RenameFile;
@@ -73,6 +74,17 @@ TEST(FilesTest, overwrite_test) {
   EXPECT_TRUE(std::filesystem::remove(temp_file));
 }
 
+TEST(FilesTest, append_test) {
+  auto temp_dir = std::filesystem::temp_directory_path();
+  auto temp_file = temp_dir / "file_1.txt";
+  std::filesystem::remove(temp_file);
+  ASSERT_TRUE(AppendToFile(temp_file.string(), "Hello "));
+  EXPECT_THAT(ReadSmallFile(temp_file.string()), Optional(StrEq("Hello ")));
+  ASSERT_TRUE(AppendToFile(temp_file.string(), "world!\n"));
+  EXPECT_THAT(ReadSmallFile(temp_file.string()), Optional(StrEq("Hello world!\n")));
+  EXPECT_TRUE(std::filesystem::remove(temp_file));
+}
+
 TEST(FilesTest, write_read_empty_string_test) {
   auto temp_dir = std::filesystem::temp_directory_path();
   auto temp_file = temp_dir / "file_1.txt";
@@ -15,7 +15,11 @@
  */
 
 template <typename T>
-Queue<T>::Queue(size_t capacity) : enqueue_(capacity), dequeue_(0){};
+Queue<T>::Queue(size_t capacity, QueueMode mode) : mode_(mode), enqueue_(capacity), dequeue_(0) {
+  if (mode_ == QueueMode::RING_BUFFER) {
+    ring_.resize(capacity);
+  }
+};
 
 template <typename T>
 Queue<T>::~Queue() {
@@ -87,6 +91,19 @@ void Queue<T>::UnregisterDequeue() {
 
 template <typename T>
 std::unique_ptr<T> Queue<T>::TryDequeue() {
+  if (mode_ == QueueMode::RING_BUFFER) {
+    // The dequeue semaphore is only increased once an item is published, so it decides whether one is available
+    if (!dequeue_.reactive_semaphore_.TryDecrease()) {
+      return nullptr;
+    }
+    size_t head = ring_head_.load(std::memory_order_relaxed);
+    ASSERT(head != ring_tail_.load(std::memory_order_acquire));
+    std::unique_ptr<T> data = std::move(ring_[head % ring_.size()]);
+    ring_head_.store(head + 1, std::memory_order_release);
+    enqueue_.reactive_semaphore_.Increase();
+    return data;
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
 
   if (queue_.empty()) {
@@ -103,10 +120,57 @@ std::unique_ptr<T> Queue<T>::TryDequeue() {
   return data;
 }
 
+template <typename T>
+std::vector<std::unique_ptr<T>> Queue<T>::TryDequeueBatch(size_t max) {
+  std::vector<std::unique_ptr<T>> batch;
+  if (mode_ == QueueMode::RING_BUFFER) {
+    size_t count = 0;
+    while (count < max && dequeue_.reactive_semaphore_.TryDecrease()) {
+      count++;
+    }
+    if (count == 0) {
+      return batch;
+    }
+    batch.reserve(count);
+    size_t head = ring_head_.load(std::memory_order_relaxed);
+    ASSERT(ring_tail_.load(std::memory_order_acquire) - head >= count);
+    for (size_t i = 0; i < count; i++) {
+      batch.push_back(std::move(ring_[(head + i) % ring_.size()]));
+    }
+    ring_head_.store(head + count, std::memory_order_release);
+    enqueue_.reactive_semaphore_.Increase(count);
+    return batch;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t count = std::min(max, queue_.size());
+  if (count == 0) {
+    return batch;
+  }
+  batch.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    dequeue_.reactive_semaphore_.Decrease();
+    batch.push_back(std::move(queue_.front()));
+    queue_.pop();
+  }
+  enqueue_.reactive_semaphore_.Increase(count);
+  return batch;
+}
+
 template <typename T>
 void Queue<T>::EnqueueCallbackInternal(EnqueueCallback callback) {
   std::unique_ptr<T> data = callback.Run();
   ASSERT(data != nullptr);
+  if (mode_ == QueueMode::RING_BUFFER) {
+    // Only this reactable decreases the enqueue semaphore, so a free slot is guaranteed once it's readable
+    enqueue_.reactive_semaphore_.Decrease();
+    size_t tail = ring_tail_.load(std::memory_order_relaxed);
+    ASSERT(tail - ring_head_.load(std::memory_order_acquire) < ring_.size());
+    ring_[tail % ring_.size()] = std::move(data);
+    ring_tail_.store(tail + 1, std::memory_order_release);
+    dequeue_.reactive_semaphore_.Increase();
+    return;
+  }
   std::lock_guard<std::mutex> lock(mutex_);
   enqueue_.reactive_semaphore_.Decrease();
   queue_.push(std::move(data));
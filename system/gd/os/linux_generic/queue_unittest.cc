@@ -810,6 +810,73 @@ TEST_F(QueueTest, unregister_dequeue_and_wait) {
   delete indicator;
 }
 
+// Fill |queue| with kQueueSize items "0" to "kQueueSize - 1" from the enqueue end
+void fill_queue(TestEnqueueEnd* test_enqueue_end) {
+  for (int i = 0; i < kQueueSize; i++) {
+    test_enqueue_end->buffer_.push(std::make_unique<std::string>(std::to_string(i)));
+  }
+  std::unordered_map<int, std::promise<int>> enqueue_promise_map;
+  enqueue_promise_map.emplace(std::piecewise_construct, std::forward_as_tuple(0), std::forward_as_tuple());
+  auto enqueue_future = enqueue_promise_map[0].get_future();
+  test_enqueue_end->RegisterEnqueue(&enqueue_promise_map);
+  enqueue_future.wait();
+}
+
+class QueueModeTest : public QueueTest, public ::testing::WithParamInterface<QueueMode> {};
+
+TEST_P(QueueModeTest, try_dequeue_batch) {
+  Queue<std::string> queue(kQueueSize, GetParam());
+  TestEnqueueEnd test_enqueue_end(&queue, enqueue_handler_);
+  fill_queue(&test_enqueue_end);
+  sync_enqueue_handler();
+
+  auto batch = queue.TryDequeueBatch(3);
+  ASSERT_EQ(batch.size(), 3ul);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(*batch[i], std::to_string(i));
+  }
+  EXPECT_EQ(*queue.TryDequeue(), "3");
+  batch = queue.TryDequeueBatch(kDoubleOfQueueSize);
+  ASSERT_EQ(batch.size(), (size_t)kQueueSize - 4);
+  for (int i = 4; i < kQueueSize; i++) {
+    EXPECT_EQ(*batch[i - 4], std::to_string(i));
+  }
+  EXPECT_TRUE(queue.TryDequeueBatch(kQueueSize).empty());
+  EXPECT_EQ(queue.TryDequeue(), nullptr);
+
+  // The whole capacity is available again for the enqueue end
+  fill_queue(&test_enqueue_end);
+  sync_enqueue_handler();
+  EXPECT_EQ(test_enqueue_end.count, kDoubleOfQueueSize);
+  EXPECT_EQ(queue.TryDequeueBatch(kDoubleOfQueueSize).size(), (size_t)kQueueSize);
+}
+
+TEST_P(QueueModeTest, enqueue_and_dequeue_in_order) {
+  constexpr int kItems = kQueueSize * 50;
+  Queue<std::string> queue(kQueueSize, GetParam());
+  TestEnqueueEnd test_enqueue_end(&queue, enqueue_handler_);
+  TestDequeueEnd test_dequeue_end(&queue, dequeue_handler_, kItems);
+  for (int i = 0; i < kItems; i++) {
+    test_enqueue_end.buffer_.push(std::make_unique<std::string>(std::to_string(i)));
+  }
+
+  std::unordered_map<int, std::promise<int>> dequeue_promise_map;
+  dequeue_promise_map.emplace(std::piecewise_construct, std::forward_as_tuple(kItems), std::forward_as_tuple());
+  auto dequeue_future = dequeue_promise_map[kItems].get_future();
+  test_dequeue_end.RegisterDequeue(&dequeue_promise_map);
+  std::unordered_map<int, std::promise<int>> enqueue_promise_map;
+  test_enqueue_end.RegisterEnqueue(&enqueue_promise_map);
+  dequeue_future.wait();
+
+  for (int i = 0; i < kItems; i++) {
+    ASSERT_EQ(*test_dequeue_end.buffer_.front(), std::to_string(i));
+    test_dequeue_end.buffer_.pop();
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    QueueTest, QueueModeTest, ::testing::Values(QueueMode::LOCKED, QueueMode::RING_BUFFER));
+
 // Create all threads for death tests in the function that dies
 class QueueDeathTest : public ::testing::Test {
  public:
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "os/utils.h"
 
 namespace bluetooth {
@@ -33,8 +35,10 @@ class ReactiveSemaphore {
   ~ReactiveSemaphore();
   // Decrements the value of |fd_|, this will cause a crash if |fd_| unreadable.
   void Decrease();
-  // Increase the value of |fd_|, this will cause a crash if |fd_| unwritable.
-  void Increase();
+  // Decrements the value of |fd_| if it isn't zero. Return false if |fd_| is unreadable.
+  bool TryDecrease();
+  // Increase the value of |fd_| by |count|, this will cause a crash if |fd_| unwritable.
+  void Increase(uint64_t count = 1);
   int GetFd();
 
  private:
@@ -21,7 +21,6 @@
 #include <sys/eventfd.h>
 #include <unistd.h>
 
-#include <algorithm>
 #include <cerrno>
 #include <cinttypes>
 #include <cstring>
@@ -99,7 +98,7 @@ class Reactor::Reactable {
   std::unique_ptr<std::promise<void>> finished_promise_;
 };
 
-Reactor::Reactor() : epoll_fd_(0), control_fd_(0), is_running_(false) {
+Reactor::Reactor() : epoll_fd_(0), control_fd_(0), is_running_(false), dispatching_(false) {
   RUN_NO_INTR(epoll_fd_ = epoll_create1(EPOLL_CLOEXEC));
   ASSERT_LOG(epoll_fd_ != -1, "could not create epoll fd: %s", strerror(errno));
 
@@ -131,9 +130,12 @@ void Reactor::Run() {
   int timeout_ms = -1;
   bool waiting_for_idle = false;
   for (;;) {
+    // Reactables unregistered from now on may still be returned by epoll_wait(). Until the batch is dispatched, they
+    // are only flagged as removed and their deletion is deferred, so no per-event lookup under mutex_ is needed.
     {
-      std::unique_lock<std::mutex> lock(mutex_);
-      invalidation_list_.clear();
+      std::lock_guard<std::mutex> lock(mutex_);
+      dispatching_ = true;
+      executing_reactable_finished_ = nullptr;
     }
     epoll_event events[kEpollMaxEvents];
     int count;
@@ -146,6 +148,7 @@ void Reactor::Run() {
       idle_promise_ = nullptr;
     }
 
+    bool stop_requested = false;
     for (int i = 0; i < count; ++i) {
       auto event = events[i];
       ASSERT(event.events != 0u);
@@ -155,8 +158,8 @@ void Reactor::Run() {
         uint64_t value;
         eventfd_read(control_fd_, &value);
         if ((value & kStopReactor) != 0) {
-          is_running_ = false;
-          return;
+          stop_requested = true;
+          break;
         } else if ((value & kWaitForIdle) != 0) {
           timeout_ms = 30;
           waiting_for_idle = true;
@@ -167,16 +170,12 @@ void Reactor::Run() {
         }
       }
       auto* reactable = static_cast<Reactor::Reactable*>(event.data.ptr);
-      std::unique_lock<std::mutex> lock(mutex_);
-      executing_reactable_finished_ = nullptr;
-      // See if this reactable has been removed in the meantime.
-      if (std::find(invalidation_list_.begin(), invalidation_list_.end(), reactable) != invalidation_list_.end()) {
-        continue;
-      }
-
       {
         std::lock_guard<std::mutex> reactable_lock(reactable->mutex_);
-        lock.unlock();
+        // See if this reactable has been removed in the meantime. It is freed in finish_dispatch_batch().
+        if (reactable->removed_) {
+          continue;
+        }
         reactable->is_executing_ = true;
       }
       if (event.events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR) && !reactable->on_read_ready_.is_null()) {
@@ -195,6 +194,24 @@ void Reactor::Run() {
         }
       }
     }
+    finish_dispatch_batch();
+
+    if (stop_requested) {
+      is_running_ = false;
+      return;
+    }
+  }
+}
+
+void Reactor::finish_dispatch_batch() {
+  std::vector<Reactable*> deferred;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dispatching_ = false;
+    std::swap(deferred, deferred_delete_list_);
+  }
+  for (auto* reactable : deferred) {
+    delete reactable;
   }
 }
 
@@ -231,13 +248,12 @@ Reactor::Reactable* Reactor::Register(int fd, Closure on_read_ready, Closure on_
 
 void Reactor::Unregister(Reactor::Reactable* reactable) {
   ASSERT(reactable != nullptr);
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    invalidation_list_.push_back(reactable);
-  }
   bool delaying_delete_until_callback_finished = false;
+  Closure released_read_ready;
+  Closure released_write_ready;
   {
     int result;
+    std::lock_guard<std::mutex> lock(mutex_);
     std::lock_guard<std::mutex> reactable_lock(reactable->mutex_);
     RUN_NO_INTR(result = epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, reactable->fd_, nullptr));
     if (result == -1 && errno == ENOENT) {
@@ -253,6 +269,15 @@ void Reactor::Unregister(Reactor::Reactable* reactable) {
       reactable->finished_promise_ = std::make_unique<std::promise<void>>();
       executing_reactable_finished_ = std::make_shared<std::future<void>>(reactable->finished_promise_->get_future());
       delaying_delete_until_callback_finished = true;
+    } else if (dispatching_) {
+      // The reactor may hold a pending event for this reactable, from the epoll_wait() in progress or from the batch
+      // being dispatched. It will be skipped, and the reactable deleted once the batch has been dispatched. The
+      // callbacks are released now, outside of the locks, so that they do not outlive the registration.
+      reactable->removed_ = true;
+      released_read_ready = std::move(reactable->on_read_ready_);
+      released_write_ready = std::move(reactable->on_write_ready_);
+      deferred_delete_list_.push_back(reactable);
+      delaying_delete_until_callback_finished = true;
     }
   }
   // If we are unregistering outside of the callback event from this reactable, we delete it now
@@ -18,6 +18,7 @@
 
 #include <sys/eventfd.h>
 
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <thread>
@@ -165,6 +166,36 @@ class FakeRunningReactable {
   std::promise<void> finished;
 };
 
+class UnregisterPeerReactable {
+ public:
+  UnregisterPeerReactable(Reactor* reactor, std::atomic<int>* run_count)
+      : fd_(eventfd(0, 0)), reactor_(reactor), run_count_(run_count) {
+    EXPECT_NE(fd_, -1);
+  }
+
+  ~UnregisterPeerReactable() {
+    close(fd_);
+  }
+
+  void OnReadReady() {
+    uint64_t value = 0;
+    auto read_result = eventfd_read(fd_, &value);
+    EXPECT_EQ(read_result, 0);
+    (*run_count_)++;
+    reactor_->Unregister(peer_->reactable_);
+    peer_->reactable_ = nullptr;
+    g_promise->set_value(kReadReadyValue);
+  }
+
+  Reactor::Reactable* reactable_ = nullptr;
+  UnregisterPeerReactable* peer_ = nullptr;
+  int fd_;
+
+ private:
+  Reactor* reactor_;
+  std::atomic<int>* run_count_;
+};
+
 TEST_F(ReactorTest, start_and_stop) {
   auto reactor_thread = std::thread(&Reactor::Run, reactor_);
   reactor_->Stop();
@@ -387,6 +418,41 @@ TEST_F(ReactorTest, hot_unregister_during_unregister_from_callback) {
   reactor_thread.join();
 }
 
+TEST_F(ReactorTest, unregister_pending_reactable_in_same_batch) {
+  std::atomic<int> run_count = 0;
+  UnregisterPeerReactable fake_reactable1(reactor_, &run_count);
+  UnregisterPeerReactable fake_reactable2(reactor_, &run_count);
+  fake_reactable1.peer_ = &fake_reactable2;
+  fake_reactable2.peer_ = &fake_reactable1;
+  fake_reactable1.reactable_ = reactor_->Register(
+      fake_reactable1.fd_,
+      Bind(&UnregisterPeerReactable::OnReadReady, common::Unretained(&fake_reactable1)),
+      common::Closure());
+  fake_reactable2.reactable_ = reactor_->Register(
+      fake_reactable2.fd_,
+      Bind(&UnregisterPeerReactable::OnReadReady, common::Unretained(&fake_reactable2)),
+      common::Closure());
+
+  // Both reactables are ready before the reactor starts, so they are reaped in the same batch. Whichever runs first
+  // unregisters the other, whose pending event must then be dropped.
+  EXPECT_EQ(eventfd_write(fake_reactable1.fd_, 1), 0);
+  EXPECT_EQ(eventfd_write(fake_reactable2.fd_, 1), 0);
+  auto future = g_promise->get_future();
+  auto reactor_thread = std::thread(&Reactor::Run, reactor_);
+  EXPECT_EQ(future.get(), kReadReadyValue);
+  EXPECT_TRUE(reactor_->WaitForIdle(std::chrono::milliseconds(100)));
+  EXPECT_EQ(run_count, 1);
+  reactor_->Stop();
+  reactor_thread.join();
+
+  if (fake_reactable1.reactable_ != nullptr) {
+    reactor_->Unregister(fake_reactable1.reactable_);
+  }
+  if (fake_reactable2.reactable_ != nullptr) {
+    reactor_->Unregister(fake_reactable2.reactable_);
+  }
+}
+
 TEST_F(ReactorTest, start_and_stop_multi_times) {
   auto reactor_thread = std::thread(&Reactor::Run, reactor_);
   reactor_->Stop();
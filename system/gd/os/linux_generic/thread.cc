@@ -23,28 +23,21 @@
 #include <cerrno>
 #include <cstring>
 
+#include "os/internal/timer_multiplexer.h"
 #include "os/log.h"
 
 namespace bluetooth {
 namespace os {
 
-namespace {
-constexpr int kRealTimeFifoSchedulingPriority = 1;
-}
-
 Thread::Thread(const std::string& name, const Priority priority)
-    : name_(name), reactor_(), running_thread_(&Thread::run, this, priority) {}
-
-void Thread::run(Priority priority) {
-  if (priority == Priority::REAL_TIME) {
-    struct sched_param rt_params = {.sched_priority = kRealTimeFifoSchedulingPriority};
-    auto linux_tid = static_cast<pid_t>(syscall(SYS_gettid));
-    int rc;
-    RUN_NO_INTR(rc = sched_setscheduler(linux_tid, SCHED_FIFO, &rt_params));
-    if (rc != 0) {
-      LOG_ERROR("unable to set SCHED_FIFO priority: %s", strerror(errno));
-    }
-  }
+    : Thread(name, priority == Priority::REAL_TIME ? RealTimeThreadPolicy() : ThreadPolicy()) {}
+
+Thread::Thread(const std::string& name, const ThreadPolicy& policy)
+    : name_(name), reactor_(), running_thread_(&Thread::run, this, policy) {}
+
+void Thread::run(ThreadPolicy policy) {
+  auto linux_tid = static_cast<pid_t>(syscall(SYS_gettid));
+  ApplyThreadPolicy(linux_tid, GetThreadPolicy(name_, policy));
   reactor_.Run();
 }
 
@@ -72,6 +65,13 @@ Reactor* Thread::GetReactor() const {
   return &reactor_;
 }
 
+internal::TimerMultiplexer* Thread::GetTimerMultiplexer() const {
+  std::call_once(timer_multiplexer_once_, [this] {
+    timer_multiplexer_ = std::make_unique<internal::TimerMultiplexer>(&reactor_);
+  });
+  return timer_multiplexer_.get();
+}
+
 std::string Thread::GetThreadName() const {
   return name_;
 }
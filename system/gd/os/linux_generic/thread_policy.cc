@@ -0,0 +1,237 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/thread_policy.h"
+
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "common/strings.h"
+#include "os/log.h"
+#include "os/system_properties.h"
+#include "os/utils.h"
+
+namespace bluetooth {
+namespace os {
+
+namespace {
+
+constexpr char kThreadPolicyPropertyPrefix[] = "bluetooth.os.thread_policy.";
+constexpr int kRealTimeFifoSchedulingPriority = 1;
+constexpr int kMaxCpus = 64;
+
+std::optional<ThreadPolicy::Scheduler> scheduler_from_string(const std::string& name) {
+  if (name == "other") {
+    return ThreadPolicy::Scheduler::OTHER;
+  }
+  if (name == "fifo") {
+    return ThreadPolicy::Scheduler::FIFO;
+  }
+  if (name == "rr") {
+    return ThreadPolicy::Scheduler::RR;
+  }
+  return std::nullopt;
+}
+
+std::string scheduler_text(ThreadPolicy::Scheduler scheduler) {
+  switch (scheduler) {
+    case ThreadPolicy::Scheduler::OTHER:
+      return "other";
+    case ThreadPolicy::Scheduler::FIFO:
+      return "fifo";
+    case ThreadPolicy::Scheduler::RR:
+      return "rr";
+  }
+  return "unknown";
+}
+
+std::optional<int> cpu_from_string(const std::string& str) {
+  auto cpu = common::Uint64FromString(str);
+  if (!cpu || *cpu >= kMaxCpus) {
+    return std::nullopt;
+  }
+  return static_cast<int>(*cpu);
+}
+
+// Parse a list of CPU indexes and ranges such as "0,2,4-7" into a mask
+std::optional<uint64_t> cpu_mask_from_string(const std::string& cpus) {
+  uint64_t mask = 0;
+  for (const auto& token : common::StringSplit(cpus, ",")) {
+    auto range = common::StringSplit(common::StringTrim(token), "-");
+    if (range.size() > 2) {
+      return std::nullopt;
+    }
+    auto first = cpu_from_string(range.front());
+    auto last = cpu_from_string(range.back());
+    if (!first || !last || *first > *last) {
+      return std::nullopt;
+    }
+    for (int cpu = *first; cpu <= *last; cpu++) {
+      mask |= uint64_t{1} << cpu;
+    }
+  }
+  return mask;
+}
+
+std::string cpu_mask_text(uint64_t mask) {
+  std::vector<std::string> cpus;
+  for (int cpu = 0; cpu < kMaxCpus; cpu++) {
+    if (mask & (uint64_t{1} << cpu)) {
+      cpus.push_back(std::to_string(cpu));
+    }
+  }
+  return common::StringJoin(cpus, ",");
+}
+
+}  // namespace
+
+std::string ThreadPolicy::ToString() const {
+  std::vector<std::string> fields;
+  if (scheduler) {
+    fields.push_back("sched=" + scheduler_text(*scheduler));
+  }
+  if (scheduler || priority != 0) {
+    fields.push_back("priority=" + std::to_string(priority));
+  }
+  if (cpu_affinity_mask != 0) {
+    fields.push_back("cpus=" + cpu_mask_text(cpu_affinity_mask));
+  }
+  return common::StringJoin(fields, ";");
+}
+
+ThreadPolicy RealTimeThreadPolicy() {
+  return ThreadPolicy{
+      .scheduler = ThreadPolicy::Scheduler::FIFO,
+      .priority = kRealTimeFifoSchedulingPriority,
+  };
+}
+
+std::optional<ThreadPolicy> ParseThreadPolicy(const std::string& policy) {
+  ThreadPolicy result;
+  for (const auto& field : common::StringSplit(policy, ";")) {
+    if (common::StringTrim(field).empty()) {
+      continue;
+    }
+    auto key_value = common::StringSplit(field, "=", 2);
+    if (key_value.size() != 2) {
+      LOG_WARN("Malformed field '%s' in thread policy '%s'", field.c_str(), policy.c_str());
+      return std::nullopt;
+    }
+    auto key = common::StringTrim(key_value[0]);
+    auto value = common::StringTrim(key_value[1]);
+    if (key == "sched") {
+      result.scheduler = scheduler_from_string(value);
+      if (!result.scheduler) {
+        LOG_WARN("Unknown scheduler '%s' in thread policy '%s'", value.c_str(), policy.c_str());
+        return std::nullopt;
+      }
+    } else if (key == "priority") {
+      auto priority = common::Int64FromString(value);
+      if (!priority || *priority < -20 || *priority > 99) {
+        LOG_WARN("Invalid priority '%s' in thread policy '%s'", value.c_str(), policy.c_str());
+        return std::nullopt;
+      }
+      result.priority = static_cast<int>(*priority);
+    } else if (key == "cpus") {
+      auto mask = cpu_mask_from_string(value);
+      if (!mask) {
+        LOG_WARN("Invalid cpus '%s' in thread policy '%s'", value.c_str(), policy.c_str());
+        return std::nullopt;
+      }
+      result.cpu_affinity_mask = *mask;
+    } else {
+      LOG_WARN("Unknown field '%s' in thread policy '%s'", key.c_str(), policy.c_str());
+      return std::nullopt;
+    }
+  }
+  bool real_time = result.scheduler == ThreadPolicy::Scheduler::FIFO || result.scheduler == ThreadPolicy::Scheduler::RR;
+  if (real_time && result.priority < 1) {
+    LOG_WARN("Real-time thread policy '%s' needs a priority from 1 to 99", policy.c_str());
+    return std::nullopt;
+  }
+  if (!real_time && result.priority > 19) {
+    LOG_WARN("Thread policy '%s' needs a nice value from -20 to 19", policy.c_str());
+    return std::nullopt;
+  }
+  return result;
+}
+
+ThreadPolicy GetThreadPolicy(const std::string& thread_name, const ThreadPolicy& default_policy) {
+  auto value = GetSystemProperty(kThreadPolicyPropertyPrefix + thread_name);
+  if (!value || value->empty()) {
+    return default_policy;
+  }
+  auto policy = ParseThreadPolicy(*value);
+  if (!policy) {
+    LOG_ERROR("Ignoring malformed policy '%s' of thread %s", value->c_str(), thread_name.c_str());
+    return default_policy;
+  }
+  return *policy;
+}
+
+bool ApplyThreadPolicy(pid_t tid, const ThreadPolicy& policy) {
+  bool success = true;
+  int rc;
+  if (policy.scheduler == ThreadPolicy::Scheduler::FIFO || policy.scheduler == ThreadPolicy::Scheduler::RR) {
+    struct sched_param rt_params = {.sched_priority = policy.priority};
+    int sched_policy = policy.scheduler == ThreadPolicy::Scheduler::FIFO ? SCHED_FIFO : SCHED_RR;
+    RUN_NO_INTR(rc = sched_setscheduler(tid, sched_policy, &rt_params));
+    if (rc != 0) {
+      LOG_ERROR("unable to set real-time policy %s: %s", policy.ToString().c_str(), strerror(errno));
+      success = false;
+    }
+  } else {
+    if (policy.scheduler == ThreadPolicy::Scheduler::OTHER) {
+      struct sched_param params = {.sched_priority = 0};
+      RUN_NO_INTR(rc = sched_setscheduler(tid, SCHED_OTHER, &params));
+      if (rc != 0) {
+        LOG_ERROR("unable to set SCHED_OTHER: %s", strerror(errno));
+        success = false;
+      }
+    }
+    // On Linux, setpriority() on a thread id changes the nice value of that thread only
+    if (policy.scheduler || policy.priority != 0) {
+      RUN_NO_INTR(rc = setpriority(PRIO_PROCESS, tid, policy.priority));
+      if (rc != 0) {
+        LOG_ERROR("unable to set nice value %d: %s", policy.priority, strerror(errno));
+        success = false;
+      }
+    }
+  }
+
+  if (policy.cpu_affinity_mask != 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu = 0; cpu < kMaxCpus; cpu++) {
+      if (policy.cpu_affinity_mask & (uint64_t{1} << cpu)) {
+        CPU_SET(cpu, &cpu_set);
+      }
+    }
+    RUN_NO_INTR(rc = sched_setaffinity(tid, sizeof(cpu_set), &cpu_set));
+    if (rc != 0) {
+      LOG_ERROR("unable to set CPU affinity %s: %s", cpu_mask_text(policy.cpu_affinity_mask).c_str(), strerror(errno));
+      success = false;
+    }
+  }
+  return success;
+}
+
+}  // namespace os
+}  // namespace bluetooth
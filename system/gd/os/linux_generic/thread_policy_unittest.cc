@@ -0,0 +1,139 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/thread_policy.h"
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <future>
+
+#include "common/bind.h"
+#include "gtest/gtest.h"
+#include "os/handler.h"
+#include "os/system_properties.h"
+#include "os/thread.h"
+
+namespace bluetooth {
+namespace os {
+namespace {
+
+uint64_t current_affinity_mask() {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  EXPECT_EQ(0, sched_getaffinity(0, sizeof(cpu_set), &cpu_set));
+  uint64_t mask = 0;
+  for (int cpu = 0; cpu < 64; cpu++) {
+    if (CPU_ISSET(cpu, &cpu_set)) {
+      mask |= uint64_t{1} << cpu;
+    }
+  }
+  return mask;
+}
+
+TEST(ThreadPolicyTest, parse_full_policy) {
+  auto policy = ParseThreadPolicy("sched=fifo;priority=2;cpus=0,2,4-7");
+  ASSERT_TRUE(policy);
+  ASSERT_EQ(ThreadPolicy::Scheduler::FIFO, policy->scheduler);
+  ASSERT_EQ(2, policy->priority);
+  ASSERT_EQ(0xf5ul, policy->cpu_affinity_mask);
+}
+
+TEST(ThreadPolicyTest, parse_partial_policy) {
+  ASSERT_EQ(ThreadPolicy(), ParseThreadPolicy(""));
+  auto policy = ParseThreadPolicy(" cpus = 3 ;");
+  ASSERT_TRUE(policy);
+  ASSERT_FALSE(policy->scheduler);
+  ASSERT_EQ(0, policy->priority);
+  ASSERT_EQ(0x8ul, policy->cpu_affinity_mask);
+  policy = ParseThreadPolicy("sched=other;priority=-5");
+  ASSERT_TRUE(policy);
+  ASSERT_EQ(ThreadPolicy::Scheduler::OTHER, policy->scheduler);
+  ASSERT_EQ(-5, policy->priority);
+}
+
+TEST(ThreadPolicyTest, parse_malformed_policy) {
+  ASSERT_FALSE(ParseThreadPolicy("sched"));
+  ASSERT_FALSE(ParseThreadPolicy("sched=deadline"));
+  ASSERT_FALSE(ParseThreadPolicy("priority=high"));
+  ASSERT_FALSE(ParseThreadPolicy("cpus=3-1"));
+  ASSERT_FALSE(ParseThreadPolicy("cpus=64"));
+  ASSERT_FALSE(ParseThreadPolicy("cpus=1-2-3"));
+  ASSERT_FALSE(ParseThreadPolicy("cpus="));
+  ASSERT_FALSE(ParseThreadPolicy("color=blue"));
+  // Real-time schedulers need a real-time priority, and nice values are limited to 19
+  ASSERT_FALSE(ParseThreadPolicy("sched=rr"));
+  ASSERT_FALSE(ParseThreadPolicy("sched=fifo;priority=100"));
+  ASSERT_FALSE(ParseThreadPolicy("priority=20"));
+}
+
+TEST(ThreadPolicyTest, to_string_round_trip) {
+  ThreadPolicy policy{.scheduler = ThreadPolicy::Scheduler::RR, .priority = 3, .cpu_affinity_mask = 0x31};
+  ASSERT_EQ("sched=rr;priority=3;cpus=0,4,5", policy.ToString());
+  ASSERT_EQ(policy, ParseThreadPolicy(policy.ToString()));
+  ASSERT_EQ(RealTimeThreadPolicy(), ParseThreadPolicy(RealTimeThreadPolicy().ToString()));
+}
+
+#ifndef OS_ANDROID
+TEST(ThreadPolicyTest, get_thread_policy_from_system_property) {
+  ThreadPolicy default_policy{.cpu_affinity_mask = 0x1};
+  ASSERT_EQ(default_policy, GetThreadPolicy("thread_policy_test", default_policy));
+  ASSERT_TRUE(SetSystemProperty("bluetooth.os.thread_policy.thread_policy_test", "sched=rr;priority=4"));
+  ASSERT_EQ(ParseThreadPolicy("sched=rr;priority=4"), GetThreadPolicy("thread_policy_test", default_policy));
+  // A malformed property is ignored
+  ASSERT_TRUE(SetSystemProperty("bluetooth.os.thread_policy.thread_policy_test", "sched=rr"));
+  ASSERT_EQ(default_policy, GetThreadPolicy("thread_policy_test", default_policy));
+  ClearSystemPropertiesForHost();
+}
+#endif
+
+TEST(ThreadPolicyTest, apply_cpu_affinity) {
+  uint64_t original_mask = current_affinity_mask();
+  ASSERT_NE(0ul, original_mask);
+  uint64_t first_cpu = original_mask & -original_mask;
+  auto tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+  ASSERT_TRUE(ApplyThreadPolicy(tid, ThreadPolicy{.cpu_affinity_mask = first_cpu}));
+  ASSERT_EQ(first_cpu, current_affinity_mask());
+  // An empty policy leaves the thread alone
+  ASSERT_TRUE(ApplyThreadPolicy(tid, ThreadPolicy()));
+  ASSERT_EQ(first_cpu, current_affinity_mask());
+
+  ASSERT_TRUE(ApplyThreadPolicy(tid, ThreadPolicy{.cpu_affinity_mask = original_mask}));
+  ASSERT_EQ(original_mask, current_affinity_mask());
+}
+
+TEST(ThreadPolicyTest, thread_starts_with_policy) {
+  uint64_t original_mask = current_affinity_mask();
+  uint64_t first_cpu = original_mask & -original_mask;
+  Thread thread("thread_policy_test", ThreadPolicy{.cpu_affinity_mask = first_cpu});
+  Handler handler(&thread);
+
+  std::promise<uint64_t> mask_promise;
+  auto mask_future = mask_promise.get_future();
+  handler.Post(common::BindOnce(
+      [](std::promise<uint64_t> promise) { promise.set_value(current_affinity_mask()); }, std::move(mask_promise)));
+  ASSERT_EQ(first_cpu, mask_future.get());
+  handler.Clear();
+
+  // The policy of the new thread doesn't leak to the thread which created it
+  ASSERT_EQ(original_mask, current_affinity_mask());
+}
+
+}  // namespace
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/internal/timer_multiplexer.h"
+
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/bind.h"
+#include "os/linux_generic/linux.h"
+#include "os/log.h"
+#include "os/utils.h"
+
+#ifdef OS_ANDROID
+#define ALARM_CLOCK CLOCK_BOOTTIME_ALARM
+#else
+#define ALARM_CLOCK CLOCK_BOOTTIME
+#endif
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+
+namespace {
+
+// The wheel counts in microseconds, so that rounding deadlines up to a tick doesn't noticeably delay short alarms
+constexpr int64_t kNanosecondsPerTick = 1000;
+constexpr int64_t kTicksPerMillisecond = 1000;
+constexpr int64_t kNanosecondsPerSecond = 1000000000;
+#ifdef USE_FAKE_TIMERS
+// The fake timerfd only has millisecond resolution, and treats a zero delay as disarming the timer
+constexpr int64_t kMinimumArmDelayNs = 1000000;
+#else
+constexpr int64_t kMinimumArmDelayNs = 1;
+#endif
+
+int64_t now_ns() {
+#ifdef USE_FAKE_TIMERS
+  return fake_timer::fake_timerfd_get_clock() * kTicksPerMillisecond * kNanosecondsPerTick;
+#else
+  timespec now;
+  clock_gettime(CLOCK_BOOTTIME, &now);
+  return now.tv_sec * kNanosecondsPerSecond + now.tv_nsec;
+#endif
+}
+
+}  // namespace
+
+TimerMultiplexer::TimerMultiplexer(Reactor* reactor)
+    : reactor_(reactor), fd_(TIMERFD_CREATE(ALARM_CLOCK, TFD_NONBLOCK)), wheel_(now_ns() / kNanosecondsPerTick) {
+  ASSERT_LOG(fd_ != -1, "cannot create timerfd: %s", strerror(errno));
+
+  reactable_ = reactor_->Register(
+      fd_, common::Bind(&TimerMultiplexer::on_fire, common::Unretained(this)), common::Closure());
+}
+
+TimerMultiplexer::~TimerMultiplexer() {
+  reactor_->Unregister(reactable_);
+
+  int close_status;
+  RUN_NO_INTR(close_status = TIMERFD_CLOSE(fd_));
+  ASSERT(close_status != -1);
+}
+
+uint64_t TimerMultiplexer::Schedule(Timer* timer, std::chrono::milliseconds delay, std::chrono::milliseconds period) {
+  // Round the current time up, so that the timer never expires before delay is elapsed
+  uint64_t now = (now_ns() + kNanosecondsPerTick - 1) / kNanosecondsPerTick;
+  std::lock_guard<std::mutex> lock(mutex_);
+  timer->period_ticks_ = period.count() * kTicksPerMillisecond;
+  timer->generation_ = next_generation_++;
+  wheel_.Insert(timer, std::max(now, wheel_.Now()) + delay.count() * kTicksPerMillisecond);
+  if (timer->deadline() < armed_deadline_) {
+    arm_locked(timer->deadline());
+  }
+  return timer->generation_;
+}
+
+void TimerMultiplexer::Cancel(Timer* timer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  wheel_.Remove(timer);
+  timer->generation_ = next_generation_++;
+}
+
+void TimerMultiplexer::Remove(Timer* timer) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  wheel_.Remove(timer);
+  timer->generation_ = next_generation_++;
+  if (dispatching_thread_ == std::this_thread::get_id()) {
+    return;
+  }
+  dispatch_done_.wait(lock, [this, timer] { return dispatching_ != timer; });
+}
+
+void TimerMultiplexer::on_fire() {
+  uint64_t times_invoked;
+  // The timerfd is non-blocking: re-arming it after the reactor polled it resets the expiration count
+  auto bytes_read = read(fd_, &times_invoked, sizeof(uint64_t));
+  ASSERT(bytes_read == static_cast<ssize_t>(sizeof(uint64_t)) || errno == EAGAIN);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  armed_deadline_ = TimerWheel::kNever;
+  wheel_.Advance(std::max<uint64_t>(now_ns() / kNanosecondsPerTick, wheel_.Now()));
+  dispatching_thread_ = std::this_thread::get_id();
+  for (auto* entry = wheel_.PopExpired(); entry != nullptr; entry = wheel_.PopExpired()) {
+    auto* timer = static_cast<Timer*>(entry);
+    uint64_t generation = timer->generation_;
+    // Periods missed while the thread was busy are skipped rather than fired back to back: the next deadline is the
+    // first one of the period grid after now
+    if (timer->period_ticks_ != 0) {
+      uint64_t next_deadline = timer->deadline() + timer->period_ticks_;
+      if (next_deadline <= wheel_.Now()) {
+        uint64_t missed_periods = (wheel_.Now() - timer->deadline()) / timer->period_ticks_;
+        next_deadline = timer->deadline() + (missed_periods + 1) * timer->period_ticks_;
+      }
+      wheel_.Insert(timer, next_deadline);
+    }
+    dispatching_ = timer;
+    lock.unlock();
+    timer->on_expired_.Run(generation);
+    lock.lock();
+    // timer may have been destroyed by its own callback, don't touch it
+    dispatching_ = nullptr;
+    dispatch_done_.notify_all();
+  }
+  dispatching_thread_ = std::thread::id();
+  uint64_t next_expiry = wheel_.NextExpiry();
+  if (next_expiry < armed_deadline_) {
+    arm_locked(next_expiry);
+  }
+}
+
+void TimerMultiplexer::arm_locked(uint64_t deadline) {
+  int64_t delay_ns = std::max(static_cast<int64_t>(deadline) * kNanosecondsPerTick - now_ns(), kMinimumArmDelayNs);
+  itimerspec timer_itimerspec{
+      {/* interval for periodic timer */}, {delay_ns / kNanosecondsPerSecond, delay_ns % kNanosecondsPerSecond}};
+  int result = TIMERFD_SETTIME(fd_, 0, &timer_itimerspec, nullptr);
+  ASSERT(result == 0);
+  armed_deadline_ = deadline;
+}
+
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
@@ -20,9 +20,12 @@
 
 #include "os/wakelock_manager.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <mutex>
 
+#include "common/bind.h"
+#include "os/alarm.h"
 #include "os/internal/wakelock_native.h"
 #include "os/log.h"
 
@@ -50,6 +53,7 @@ struct WakelockManager::Stats {
   size_t released_count = 0;
   size_t acquired_errors = 0;
   size_t released_errors = 0;
+  size_t avoided_acquisitions = 0;
   uint64_t min_acquired_interval_ms = 0;
   uint64_t max_acquired_interval_ms = 0;
   uint64_t last_acquired_interval_ms = 0;
@@ -66,6 +70,7 @@ struct WakelockManager::Stats {
     released_count = 0;
     acquired_errors = 0;
     released_errors = 0;
+    avoided_acquisitions = 0;
     min_acquired_interval_ms = 0;
     max_acquired_interval_ms = 0;
     last_acquired_interval_ms = 0;
@@ -174,6 +179,7 @@ struct WakelockManager::Stats {
     builder.add_avg_interval_millis(avg_interval_ms);
     builder.add_total_interval_millis(total_interval_ms);
     builder.add_total_time_since_reset_millis(just_now_ms - last_reset_timestamp_ms);
+    builder.add_avoided_acquisition_count(avoided_acquisitions);
     return builder.Finish();
   }
 };
@@ -192,6 +198,22 @@ void WakelockManager::SetOsCallouts(OsCallouts* callouts, Handler* handler) {
   LOG_INFO("set to %s", is_native_ ? "native" : "non-native");
 }
 
+void WakelockManager::SetHysteresis(
+    std::chrono::milliseconds min_hold, std::chrono::milliseconds release_grace, Handler* handler) {
+  std::lock_guard<std::recursive_mutex> lock_guard(mutex_);
+  if (release_pending_) {
+    release_pending_ = false;
+    ReleaseNow();
+  }
+  min_hold_ = min_hold;
+  release_grace_ = release_grace;
+  if (handler == nullptr || (min_hold.count() <= 0 && release_grace.count() <= 0)) {
+    release_alarm_.reset();
+  } else {
+    release_alarm_ = std::make_unique<Alarm>(handler);
+  }
+}
+
 bool WakelockManager::Acquire() {
   std::lock_guard<std::recursive_mutex> lock_guard(mutex_);
   if (!initialized_) {
@@ -201,6 +223,14 @@ bool WakelockManager::Acquire() {
     initialized_ = true;
   }
 
+  if (release_pending_) {
+    // The wakelock is still held: drop the pending release rather than releasing and acquiring it again
+    release_alarm_->Cancel();
+    release_pending_ = false;
+    pstats_->avoided_acquisitions++;
+    return true;
+  }
+
   StatusCode status;
   if (is_native_) {
     status = WakelockNative::Get().Acquire(kBtWakelockId);
@@ -227,6 +257,45 @@ bool WakelockManager::Release() {
     initialized_ = true;
   }
 
+  if (release_pending_) {
+    return true;
+  }
+
+  if (release_alarm_ != nullptr && pstats_->is_acquired) {
+    // Defer by the grace period, or by the remainder of the minimum hold time if longer
+    uint64_t held_ms = now_ms() - pstats_->last_acquired_timestamp_ms;
+    uint64_t delay_ms = std::max<int64_t>(release_grace_.count(), min_hold_.count() - (int64_t)held_ms);
+    if (delay_ms > 0) {
+      release_pending_ = true;
+      release_deadline_ms_ = now_ms() + delay_ms;
+      release_alarm_->Schedule(
+          common::BindOnce(&WakelockManager::OnReleaseDeferred, common::Unretained(this)),
+          std::chrono::milliseconds(delay_ms));
+      return true;
+    }
+  }
+
+  return ReleaseNow();
+}
+
+void WakelockManager::OnReleaseDeferred() {
+  std::lock_guard<std::recursive_mutex> lock_guard(mutex_);
+  if (!release_pending_) {
+    return;
+  }
+  // The alarm may have fired just before the release was dropped and deferred again, wait for the new deadline
+  uint64_t just_now_ms = now_ms();
+  if (just_now_ms < release_deadline_ms_) {
+    release_alarm_->Schedule(
+        common::BindOnce(&WakelockManager::OnReleaseDeferred, common::Unretained(this)),
+        std::chrono::milliseconds(release_deadline_ms_ - just_now_ms));
+    return;
+  }
+  release_pending_ = false;
+  ReleaseNow();
+}
+
+bool WakelockManager::ReleaseNow() {
   StatusCode status;
   if (is_native_) {
     status = WakelockNative::Get().Release(kBtWakelockId);
@@ -250,9 +319,13 @@ void WakelockManager::CleanUp() {
     LOG_ERROR("Already uninitialized");
     return;
   }
+  if (release_pending_) {
+    release_alarm_->Cancel();
+    release_pending_ = false;
+  }
   if (pstats_->is_acquired) {
     LOG_ERROR("Releasing wake lock as part of cleanup");
-    Release();
+    ReleaseNow();
   }
   if (is_native_) {
     WakelockNative::Get().CleanUp();
@@ -16,6 +16,7 @@
  *
  ******************************************************************************/
 #include <optional>
+#include <thread>
 #include <unordered_map>
 
 #include <gmock/gmock.h>
@@ -189,4 +190,56 @@ TEST_F(WakelockManagerTest, test_with_os_callouts_in_a_loop_and_dump) {
   }
 }
 
+TEST_F(WakelockManagerTest, test_release_grace_period_coalesces_acquisitions) {
+  TestOsCallouts os_callouts;
+  WakelockManager::Get().SetOsCallouts(&os_callouts, handler_);
+  WakelockManager::Get().SetHysteresis(std::chrono::milliseconds(0), std::chrono::milliseconds(100), handler_);
+
+  for (size_t i = 0; i < 100; i++) {
+    WakelockManager::Get().Acquire();
+    WakelockManager::Get().Release();
+  }
+  SyncHandler();
+  // The wakelock is acquired once, and held until the grace period elapses
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(1)));
+
+  {
+    flatbuffers::FlatBufferBuilder builder(1024);
+    auto offset = WakelockManager::Get().GetDumpsysData(&builder);
+    FinishWakelockManagerDataBuffer(builder, offset);
+    auto data = GetWakelockManagerData(builder.GetBufferPointer());
+
+    ASSERT_TRUE(data->is_acquired());
+    ASSERT_EQ(data->acquired_count(), 1);
+    ASSERT_EQ(data->avoided_acquisition_count(), 99);
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  SyncHandler();
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(0)));
+
+  WakelockManager::Get().SetHysteresis(std::chrono::milliseconds(0), std::chrono::milliseconds(0), nullptr);
+  WakelockManager::Get().CleanUp();
+  SyncHandler();
+}
+
+TEST_F(WakelockManagerTest, test_min_hold) {
+  TestOsCallouts os_callouts;
+  WakelockManager::Get().SetOsCallouts(&os_callouts, handler_);
+  WakelockManager::Get().SetHysteresis(std::chrono::milliseconds(100), std::chrono::milliseconds(0), handler_);
+
+  WakelockManager::Get().Acquire();
+  WakelockManager::Get().Release();
+  SyncHandler();
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(1)));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  SyncHandler();
+  ASSERT_THAT(os_callouts.GetNetAcquiredCount(WakelockManager::kBtWakelockId), Optional(Eq(0)));
+
+  WakelockManager::Get().SetHysteresis(std::chrono::milliseconds(0), std::chrono::milliseconds(0), nullptr);
+  WakelockManager::Get().CleanUp();
+  SyncHandler();
+}
+
 }  // namespace testing
@@ -44,14 +44,16 @@ static_assert(LOG_TAG != nullptr, "LOG_TAG is null after header inclusion");
 
 #define LOG_VERBOSE(fmt, args...)                                             \
   do {                                                                        \
-    if (bluetooth::common::InitFlags::IsDebugLoggingEnabledForTag(LOG_TAG)) { \
+    static bluetooth::common::DebugLoggingCheck _debug_logging_check;         \
+    if (_debug_logging_check.IsEnabled(LOG_TAG)) {                            \
       ALOGV("%s:%d %s: " fmt, __FILE__, __LINE__, __func__, ##args);          \
     }                                                                         \
   } while (false)
 
 #define LOG_DEBUG(fmt, args...)                                               \
   do {                                                                        \
-    if (bluetooth::common::InitFlags::IsDebugLoggingEnabledForTag(LOG_TAG)) { \
+    static bluetooth::common::DebugLoggingCheck _debug_logging_check;         \
+    if (_debug_logging_check.IsEnabled(LOG_TAG)) {                            \
       ALOGD("%s:%d %s: " fmt, __FILE__, __LINE__, __func__, ##args);          \
     }                                                                         \
   } while (false)
@@ -93,13 +95,15 @@ static_assert(LOG_TAG != nullptr, "LOG_TAG is null after header inclusion");
 #else
 #define LOG_VERBOSE(...)                                                      \
   do {                                                                        \
-    if (bluetooth::common::InitFlags::IsDebugLoggingEnabledForTag(LOG_TAG)) { \
+    static bluetooth::common::DebugLoggingCheck _debug_logging_check;         \
+    if (_debug_logging_check.IsEnabled(LOG_TAG)) {                            \
       LOGWRAPPER(LOG_TAG_VERBOSE, __VA_ARGS__);                               \
     }                                                                         \
   } while (false)
 #define LOG_DEBUG(...)                                                        \
   do {                                                                        \
-    if (bluetooth::common::InitFlags::IsDebugLoggingEnabledForTag(LOG_TAG)) { \
+    static bluetooth::common::DebugLoggingCheck _debug_logging_check;         \
+    if (_debug_logging_check.IsEnabled(LOG_TAG)) {                            \
       LOGWRAPPER(LOG_TAG_DEBUG, __VA_ARGS__);                                 \
     }                                                                         \
   } while (false)
@@ -160,13 +164,15 @@ static_assert(LOG_TAG != nullptr, "LOG_TAG is null after header inclusion");
 #else
 #define LOG_VERBOSE(fmt, args...)                                             \
   do {                                                                        \
-    if (bluetooth::common::InitFlags::IsDebugLoggingEnabledForTag(LOG_TAG)) { \
+    static bluetooth::common::DebugLoggingCheck _debug_logging_check;         \
+    if (_debug_logging_check.IsEnabled(LOG_TAG)) {                            \
       LOGWRAPPER(fmt, ##args);                                                \
     }                                                                         \
   } while (false)
 #define LOG_DEBUG(fmt, args...)                                               \
   do {                                                                        \
-    if (bluetooth::common::InitFlags::IsDebugLoggingEnabledForTag(LOG_TAG)) { \
+    static bluetooth::common::DebugLoggingCheck _debug_logging_check;         \
+    if (_debug_logging_check.IsEnabled(LOG_TAG)) {                            \
       LOGWRAPPER(fmt, ##args);                                                \
     }                                                                         \
   } while (false)
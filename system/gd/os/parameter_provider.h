@@ -40,6 +40,11 @@ class ParameterProvider {
 
   static void OverrideSnoozLogFilePath(const std::string& path);
 
+  // Return the path to the snapshot of the controller capabilities
+  static std::string ControllerCapabilitiesFilePath();
+
+  static void OverrideControllerCapabilitiesFilePath(const std::string& path);
+
   static bluetooth_keystore::BluetoothKeystoreInterface* GetBtKeystoreInterface();
 
   static void SetBtKeystoreInterface(bluetooth_keystore::BluetoothKeystoreInterface* bt_keystore);
@@ -18,9 +18,12 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include "common/bind.h"
 #include "common/callback.h"
@@ -52,6 +55,24 @@ class IQueueDequeue {
   virtual void RegisterDequeue(Handler* handler, DequeueCallback callback) = 0;
   virtual void UnregisterDequeue() = 0;
   virtual std::unique_ptr<T> TryDequeue() = 0;
+  // Dequeue up to |max| items at once, in order. Return an empty vector when there is nothing in the queue.
+  virtual std::vector<std::unique_ptr<T>> TryDequeueBatch(size_t max) {
+    std::vector<std::unique_ptr<T>> batch;
+    for (std::unique_ptr<T> data; batch.size() < max && (data = TryDequeue()) != nullptr;) {
+      batch.push_back(std::move(data));
+    }
+    return batch;
+  }
+};
+
+// Storage of a |Queue|.
+// LOCKED keeps items in a std::queue guarded by a mutex, and is safe to dequeue from any thread.
+// RING_BUFFER preallocates |capacity| slots which are accessed without locking. Items are only enqueued from the
+// reactor thread of the enqueue end, so there is a single producer; TryDequeue() and TryDequeueBatch() must not be
+// invoked concurrently with each other, which is always the case when they are only used from the DequeueCallback.
+enum class QueueMode {
+  LOCKED,
+  RING_BUFFER,
 };
 
 template <typename T>
@@ -64,7 +85,7 @@ class Queue : public IQueueEnqueue<T>, public IQueueDequeue<T> {
   // is empty. TryDequeue should be use in this function to get data from queue.
   using DequeueCallback = common::Callback<void()>;
   // Create a queue with |capacity| is the maximum number of messages a queue can contain
-  explicit Queue(size_t capacity);
+  explicit Queue(size_t capacity, QueueMode mode = QueueMode::LOCKED);
   ~Queue();
   // Register |callback| that will be called on |handler| when the queue is able to enqueue one piece of data.
   // This will cause a crash if handler or callback has already been registered before.
@@ -80,13 +101,23 @@ class Queue : public IQueueEnqueue<T>, public IQueueDequeue<T> {
   // Try to dequeue an item from this queue. Return nullptr when there is nothing in the queue.
   std::unique_ptr<T> TryDequeue() override;
 
+  // Try to dequeue up to |max| items from this queue, with a single lock or ring buffer access.
+  std::vector<std::unique_ptr<T>> TryDequeueBatch(size_t max) override;
+
  private:
   void EnqueueCallbackInternal(EnqueueCallback callback);
-  // An internal queue that holds at most |capacity| pieces of data
+  const QueueMode mode_;
+  // An internal queue that holds at most |capacity| pieces of data, in QueueMode::LOCKED
   std::queue<std::unique_ptr<T>> queue_;
-  // A mutex that guards data in this queue
+  // A mutex that guards data in this queue in QueueMode::LOCKED, and endpoint registration in both modes
   std::mutex mutex_;
 
+  // |capacity| slots in QueueMode::RING_BUFFER. Slots [ring_head_, ring_tail_) hold data; both indexes only grow,
+  // and are kept on separate cache lines since they are written by different threads.
+  std::vector<std::unique_ptr<T>> ring_;
+  alignas(64) std::atomic<size_t> ring_head_ = 0;
+  alignas(64) std::atomic<size_t> ring_tail_ = 0;
+
   class QueueEndpoint {
    public:
 #ifdef OS_LINUX_GENERIC
@@ -37,8 +37,10 @@ class BM_QueuePerformance : public ::benchmark::Fixture {
   }
 
   void TearDown(State& st) override {
+    enqueue_handler_->Clear();
     delete enqueue_handler_;
     delete enqueue_thread_;
+    dequeue_handler_->Clear();
     delete dequeue_handler_;
     delete dequeue_thread_;
     enqueue_handler_ = nullptr;
@@ -106,18 +108,26 @@ class TestEnqueueEnd {
 
 class TestDequeueEnd {
  public:
-  explicit TestDequeueEnd(int64_t count, Queue<std::string>* queue, Handler* handler, std::promise<void>* promise)
-      : count_(count), handler_(handler), queue_(queue), promise_(promise) {}
+  explicit TestDequeueEnd(
+      int64_t count, Queue<std::string>* queue, Handler* handler, std::promise<void>* promise, size_t batch_size = 1)
+      : count_(count), handler_(handler), queue_(queue), promise_(promise), batch_size_(batch_size) {}
 
   void RegisterDequeue() {
     handler_->Post(common::BindOnce(&TestDequeueEnd::handle_register_dequeue, common::Unretained(this)));
   }
 
   void DequeueCallbackForTest() {
-    std::string data = *(queue_->TryDequeue());
-    buffer_.push(data);
+    if (batch_size_ > 1) {
+      for (auto& data : queue_->TryDequeueBatch(batch_size_)) {
+        buffer_.push(*data);
+        count_--;
+      }
+    } else {
+      std::string data = *(queue_->TryDequeue());
+      buffer_.push(data);
+      count_--;
+    }
 
-    count_--;
     if (count_ == 0) {
       queue_->UnregisterDequeue();
       promise_->set_value();
@@ -131,6 +141,7 @@ class TestDequeueEnd {
   Handler* handler_;
   Queue<std::string>* queue_;
   std::promise<void>* promise_;
+  size_t batch_size_;
 
   void handle_register_dequeue() {
     queue_->RegisterDequeue(handler_, common::Bind(&TestDequeueEnd::DequeueCallbackForTest, common::Unretained(this)));
@@ -202,5 +213,41 @@ BENCHMARK_REGISTER_F(BM_QueuePerformance, send_10000_packet_vary_by_packet_size)
     ->Iterations(100)
     ->UseRealTime();
 
+// Args: number of packets, QueueMode, and how many packets the dequeue end takes per callback
+BENCHMARK_DEFINE_F(BM_QueuePerformance, send_packet_vary_by_mode)(State& state) {
+  for (auto _ : state) {
+    int64_t num_data_to_send_ = state.range(0);
+    Queue<std::string> queue(num_data_to_send_, static_cast<QueueMode>(state.range(1)));
+
+    // register dequeue
+    std::promise<void> dequeue_promise;
+    auto dequeue_future = dequeue_promise.get_future();
+    TestDequeueEnd test_dequeue_end(num_data_to_send_, &queue, dequeue_handler_, &dequeue_promise, state.range(2));
+    test_dequeue_end.RegisterDequeue();
+
+    // Push data to enqueue end buffer and register enqueue
+    std::promise<void> enqueue_promise;
+    TestEnqueueEnd test_enqueue_end(num_data_to_send_, &queue, enqueue_handler_, &enqueue_promise);
+    for (int i = 0; i < num_data_to_send_; i++) {
+      test_enqueue_end.push(std::to_string(1));
+    }
+    dequeue_future.wait();
+  }
+
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * state.range(0));
+};
+
+BENCHMARK_REGISTER_F(BM_QueuePerformance, send_packet_vary_by_mode)
+    ->Args({1000, static_cast<int>(QueueMode::LOCKED), 1})
+    ->Args({1000, static_cast<int>(QueueMode::LOCKED), 32})
+    ->Args({1000, static_cast<int>(QueueMode::RING_BUFFER), 1})
+    ->Args({1000, static_cast<int>(QueueMode::RING_BUFFER), 32})
+    ->Args({10000, static_cast<int>(QueueMode::LOCKED), 1})
+    ->Args({10000, static_cast<int>(QueueMode::LOCKED), 32})
+    ->Args({10000, static_cast<int>(QueueMode::RING_BUFFER), 1})
+    ->Args({10000, static_cast<int>(QueueMode::RING_BUFFER), 32})
+    ->Iterations(100)
+    ->UseRealTime();
+
 }  // namespace os
 }  // namespace bluetooth
@@ -21,10 +21,10 @@
 #include <atomic>
 #include <functional>
 #include <future>
-#include <list>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include "common/callback.h"
 #include "os/utils.h"
@@ -36,6 +36,9 @@ namespace os {
 // When a reactor is running, the main loop is polling and blocked until at least one registered reactable is ready to
 // read or write. It will invoke on_read_ready() or on_write_ready(), which is registered with the reactor. Then, it
 // blocks again until ready event.
+// Ready events are dispatched in batches: the reactor lock is only taken around each epoll_wait() and batch, and the
+// callbacks run without holding it. Reactables unregistered while an event of theirs may be pending in the current
+// batch are skipped, and only freed once the batch has been dispatched.
 class Reactor {
  public:
   // An object used for Unregister() and ModifyRegistration()
@@ -95,9 +98,14 @@ class Reactor {
   int epoll_fd_;
   int control_fd_;
   std::atomic<bool> is_running_;
-  std::list<Reactable*> invalidation_list_;
+  // Set from before epoll_wait() until the batch it returned has been dispatched
+  bool dispatching_;
+  // Reactables unregistered while dispatching_ is set, freed once the batch is dispatched
+  std::vector<Reactable*> deferred_delete_list_;
   std::shared_ptr<std::future<void>> executing_reactable_finished_;
   std::shared_ptr<std::promise<void>> idle_promise_;
+
+  void finish_dispatch_batch();
 };
 
 }  // namespace os
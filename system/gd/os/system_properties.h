@@ -16,8 +16,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
+#include <type_traits>
 
 namespace bluetooth {
 namespace os {
@@ -48,6 +52,70 @@ bool SetSystemProperty(const std::string& property, const std::string& value);
 // Clear system properties for host only
 void ClearSystemPropertiesForHost();
 
+// Compile-time key of a system property read once and then cached, for the checks on hot paths:
+//
+//   constexpr os::SystemPropertyKey<bool> kFooEnabled{"bluetooth.foo.enabled", false};
+//   if (os::GetCachedSystemProperty<kFooEnabled>()) { ... }
+//
+// A check is one load of the cached value. The cached values are read again by ReloadCachedSystemProperties(), which
+// SetSystemProperty() calls, and which the stack calls when it starts for the properties other processes change.
+template <typename T>
+struct SystemPropertyKey {
+  static_assert(std::is_same_v<T, bool> || std::is_same_v<T, uint32_t>, "Cached properties are bool or uint32_t");
+  using value_type = T;
+  const char* property;
+  T default_value;
+};
+
+namespace internal {
+
+constexpr int64_t kUnloadedSystemProperty = INT64_MIN;
+
+template <const auto& kKey>
+inline std::atomic<int64_t> cached_system_property{kUnloadedSystemProperty};
+
+// Read the property into |cell| and keep |cell| for the next ReloadCachedSystemProperties()
+int64_t LoadCachedSystemProperty(std::atomic<int64_t>* cell, std::function<int64_t()> read);
+
+void AddCachedSystemPropertyObserver(
+    std::atomic<int64_t>* cell, std::function<int64_t()> read, std::function<void(int64_t)> observer);
+
+template <typename T>
+int64_t ReadSystemProperty(const SystemPropertyKey<T>& key) {
+  if constexpr (std::is_same_v<T, bool>) {
+    return GetSystemPropertyBool(key.property, key.default_value);
+  } else {
+    return GetSystemPropertyUint32(key.property, key.default_value);
+  }
+}
+
+}  // namespace internal
+
+template <const auto& kKey>
+typename std::decay_t<decltype(kKey)>::value_type GetCachedSystemProperty() {
+  using T = typename std::decay_t<decltype(kKey)>::value_type;
+  int64_t value = internal::cached_system_property<kKey>.load(std::memory_order_relaxed);
+  if (value == internal::kUnloadedSystemProperty) {
+    value = internal::LoadCachedSystemProperty(
+        &internal::cached_system_property<kKey>, [] { return internal::ReadSystemProperty(kKey); });
+  }
+  return static_cast<T>(value);
+}
+
+// Run |observer| with the new value of the property each time ReloadCachedSystemProperties() finds it changed, on the
+// thread which reloads them
+template <const auto& kKey>
+void ObserveCachedSystemProperty(std::function<void(typename std::decay_t<decltype(kKey)>::value_type)> observer) {
+  using T = typename std::decay_t<decltype(kKey)>::value_type;
+  internal::AddCachedSystemPropertyObserver(
+      &internal::cached_system_property<kKey>,
+      [] { return internal::ReadSystemProperty(kKey); },
+      [observer = std::move(observer)](int64_t value) { observer(static_cast<T>(value)); });
+}
+
+// Read again the cached properties, and notify the observers of the ones which changed
+void ReloadCachedSystemProperties();
+
 // Check if the vendor image is using root canal simulated Bluetooth stack
 bool IsRootCanalEnabled();
 
@@ -14,7 +14,11 @@
  * limitations under the License.
  */
 
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "common/strings.h"
 #include "os/system_properties.h"
@@ -22,6 +26,61 @@
 namespace bluetooth {
 namespace os {
 
+namespace {
+
+struct CachedSystemProperty {
+  std::function<int64_t()> read;
+  std::vector<std::function<void(int64_t)>> observers;
+};
+
+std::mutex cached_properties_mutex;
+std::unordered_map<std::atomic<int64_t>*, CachedSystemProperty> cached_properties;
+
+}  // namespace
+
+namespace internal {
+
+int64_t LoadCachedSystemProperty(std::atomic<int64_t>* cell, std::function<int64_t()> read) {
+  int64_t value = read();
+  std::lock_guard<std::mutex> lock(cached_properties_mutex);
+  cached_properties.try_emplace(cell, CachedSystemProperty{std::move(read), {}});
+  cell->store(value, std::memory_order_relaxed);
+  return value;
+}
+
+void AddCachedSystemPropertyObserver(
+    std::atomic<int64_t>* cell, std::function<int64_t()> read, std::function<void(int64_t)> observer) {
+  std::lock_guard<std::mutex> lock(cached_properties_mutex);
+  auto& entry = cached_properties.try_emplace(cell, CachedSystemProperty{std::move(read), {}}).first->second;
+  entry.observers.push_back(std::move(observer));
+  // The observers compare with the value which was seen last, load one if no check did yet
+  if (cell->load(std::memory_order_relaxed) == kUnloadedSystemProperty) {
+    cell->store(entry.read(), std::memory_order_relaxed);
+  }
+}
+
+}  // namespace internal
+
+void ReloadCachedSystemProperties() {
+  std::vector<std::pair<std::function<void(int64_t)>, int64_t>> notifications;
+  {
+    std::lock_guard<std::mutex> lock(cached_properties_mutex);
+    for (auto& [cell, entry] : cached_properties) {
+      int64_t value = entry.read();
+      int64_t previous = cell->exchange(value, std::memory_order_relaxed);
+      if (previous != value && previous != internal::kUnloadedSystemProperty) {
+        for (const auto& observer : entry.observers) {
+          notifications.emplace_back(observer, value);
+        }
+      }
+    }
+  }
+  // Outside of the lock, so that the observers may check other cached properties
+  for (auto& [observer, value] : notifications) {
+    observer(value);
+  }
+}
+
 uint32_t GetSystemPropertyUint32(const std::string& property, uint32_t default_value) {
   return GetSystemPropertyUint32Base(property, default_value, 10);
 }
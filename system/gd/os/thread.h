@@ -16,16 +16,22 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 
 #include "os/reactor.h"
+#include "os/thread_policy.h"
 #include "os/utils.h"
 
 namespace bluetooth {
 namespace os {
 
+namespace internal {
+class TimerMultiplexer;
+}  // namespace internal
+
 // Reactor-based looper thread implementation. The thread runs immediately after it is constructed, and stops after
 // Stop() is invoked. To assign task to this thread, user needs to register a reactable object to the underlying
 // reactor.
@@ -43,6 +49,11 @@ class Thread {
   // priority: priority for kernel scheduler
   Thread(const std::string& name, Priority priority);
 
+  // name: thread name for POSIX systems
+  // policy: scheduling policy and CPU affinity applied when the thread starts, unless the system property
+  // bluetooth.os.thread_policy.<name> overrides it
+  Thread(const std::string& name, const ThreadPolicy& policy);
+
   Thread(const Thread&) = delete;
   Thread& operator=(const Thread&) = delete;
 
@@ -65,10 +76,19 @@ class Thread {
   Reactor* GetReactor() const;
 
  private:
-  void run(Priority priority);
+  friend class Alarm;
+  friend class RepeatingAlarm;
+
+  void run(ThreadPolicy policy);
+  // Return the timer multiplexer shared by all the alarms of this thread, creating it on first use
+  internal::TimerMultiplexer* GetTimerMultiplexer() const;
+
   mutable std::mutex mutex_;
   const std::string name_;
   mutable Reactor reactor_;
+  // Declared after reactor_, so that it is unregistered before the reactor is destroyed
+  mutable std::once_flag timer_multiplexer_once_;
+  mutable std::unique_ptr<internal::TimerMultiplexer> timer_multiplexer_;
   std::thread running_thread_;
 };
 
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace bluetooth {
+namespace os {
+
+// Scheduling policy of a stack thread. Unset parts leave the corresponding attribute of the thread unchanged.
+struct ThreadPolicy {
+  enum class Scheduler {
+    OTHER,
+    FIFO,
+    RR,
+  };
+
+  std::optional<Scheduler> scheduler;
+  // SCHED_FIFO / SCHED_RR priority from 1 to 99, or nice value from -20 to 19 for SCHED_OTHER
+  int priority = 0;
+  // Bit N allows the thread to run on CPU N; 0 leaves the affinity unchanged
+  uint64_t cpu_affinity_mask = 0;
+
+  bool operator==(const ThreadPolicy& other) const {
+    return scheduler == other.scheduler && priority == other.priority &&
+           cpu_affinity_mask == other.cpu_affinity_mask;
+  }
+
+  std::string ToString() const;
+};
+
+// Policy used for Thread::Priority::REAL_TIME and MessageLoopThread::EnableRealTimeScheduling()
+ThreadPolicy RealTimeThreadPolicy();
+
+// Parse a policy of the form "sched=fifo;priority=2;cpus=4-7". Every field is optional; sched is one of other, fifo
+// and rr, and cpus is a list of CPU indexes and ranges such as "0,2,4-7". Return std::nullopt if |policy| is malformed.
+std::optional<ThreadPolicy> ParseThreadPolicy(const std::string& policy);
+
+// Return the policy configured for the thread named |thread_name| through the system property
+// bluetooth.os.thread_policy.<thread_name>, or |default_policy| if it is not set or malformed
+ThreadPolicy GetThreadPolicy(const std::string& thread_name, const ThreadPolicy& default_policy);
+
+// Apply |policy| to the Linux thread |tid|. Return false if any part of it could not be applied.
+bool ApplyThreadPolicy(pid_t tid, const ThreadPolicy& policy);
+
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/internal/timer_wheel.h"
+
+#include <algorithm>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+
+namespace {
+
+// Distance in slots from current_slot to the next occupied slot of a level, in [1, 64]. The current slot itself
+// counts as 64 slots away, since entries are never placed in the slot that is currently due.
+int distance_to_next_slot(uint64_t occupied, int current_slot) {
+  int shift = (current_slot + 1) % 64;
+  uint64_t rotated = shift == 0 ? occupied : (occupied >> shift) | (occupied << (64 - shift));
+  return __builtin_ctzll(rotated) + 1;
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now) {}
+
+void TimerWheel::Insert(Entry* entry, uint64_t deadline) {
+  Remove(entry);
+  entry->deadline_ = deadline;
+  place(entry);
+}
+
+void TimerWheel::Remove(Entry* entry) {
+  if (entry->level_ == kNotQueued) {
+    return;
+  }
+  if (entry->level_ == kExpired) {
+    (entry->prev_ == nullptr ? expired_head_ : entry->prev_->next_) = entry->next_;
+    (entry->next_ == nullptr ? expired_tail_ : entry->next_->prev_) = entry->prev_;
+  } else {
+    Entry*& head = slots_[entry->level_][entry->slot_];
+    (entry->prev_ == nullptr ? head : entry->prev_->next_) = entry->next_;
+    if (entry->next_ != nullptr) {
+      entry->next_->prev_ = entry->prev_;
+    }
+    if (head == nullptr) {
+      occupied_[entry->level_] &= ~(uint64_t{1} << entry->slot_);
+    }
+  }
+  entry->prev_ = nullptr;
+  entry->next_ = nullptr;
+  entry->level_ = kNotQueued;
+}
+
+void TimerWheel::Advance(uint64_t now) {
+  ASSERT(now >= now_);
+  for (uint64_t slot_time = next_slot_time(); slot_time <= now; slot_time = next_slot_time()) {
+    now_ = slot_time;
+    process_slots();
+  }
+  now_ = now;
+}
+
+TimerWheel::Entry* TimerWheel::PopExpired() {
+  Entry* entry = expired_head_;
+  if (entry != nullptr) {
+    Remove(entry);
+  }
+  return entry;
+}
+
+uint64_t TimerWheel::NextExpiry() const {
+  if (expired_head_ != nullptr) {
+    return now_;
+  }
+  uint64_t next = kNever;
+  // Below the top level, the slots of a level never wrap around, so its earliest deadline is in its next occupied slot
+  for (int level = 0; level < kLevels - 1; level++) {
+    if (occupied_[level] == 0) {
+      continue;
+    }
+    int current_slot = (now_ >> (level * kLevelBits)) % kSlotsPerLevel;
+    int slot = (current_slot + distance_to_next_slot(occupied_[level], current_slot)) % kSlotsPerLevel;
+    for (const Entry* entry = slots_[level][slot]; entry != nullptr; entry = entry->next_) {
+      next = std::min(next, entry->deadline_);
+    }
+  }
+  // Entries too far away for the wheel are parked in the top level, regardless of their slot order
+  for (const auto* entry : slots_[kLevels - 1]) {
+    for (; entry != nullptr; entry = entry->next_) {
+      next = std::min(next, entry->deadline_);
+    }
+  }
+  return next;
+}
+
+void TimerWheel::place(Entry* entry) {
+  if (entry->deadline_ <= now_) {
+    link_expired(entry);
+    return;
+  }
+  // Use the finest level at which the deadline is less than a full turn of slots away
+  for (int level = 0; level < kLevels; level++) {
+    int shift = level * kLevelBits;
+    if ((entry->deadline_ >> shift) - (now_ >> shift) < kSlotsPerLevel) {
+      link_slot(entry, level, (entry->deadline_ >> shift) % kSlotsPerLevel);
+      return;
+    }
+  }
+  // Too far away for the wheel; park it in the last slot of the top level, it is placed again when time moves past that slot
+  int shift = (kLevels - 1) * kLevelBits;
+  link_slot(entry, kLevels - 1, ((now_ >> shift) + kSlotsPerLevel - 1) % kSlotsPerLevel);
+}
+
+void TimerWheel::link_slot(Entry* entry, int level, int slot) {
+  Entry*& head = slots_[level][slot];
+  entry->prev_ = nullptr;
+  entry->next_ = head;
+  if (head != nullptr) {
+    head->prev_ = entry;
+  }
+  head = entry;
+  occupied_[level] |= uint64_t{1} << slot;
+  entry->level_ = level;
+  entry->slot_ = slot;
+}
+
+void TimerWheel::link_expired(Entry* entry) {
+  entry->prev_ = expired_tail_;
+  entry->next_ = nullptr;
+  (expired_tail_ == nullptr ? expired_head_ : expired_tail_->next_) = entry;
+  expired_tail_ = entry;
+  entry->level_ = kExpired;
+}
+
+uint64_t TimerWheel::next_slot_time() const {
+  uint64_t next = kNever;
+  for (int level = 0; level < kLevels; level++) {
+    if (occupied_[level] == 0) {
+      continue;
+    }
+    int shift = level * kLevelBits;
+    uint64_t current = now_ >> shift;
+    uint64_t slot_time = (current + distance_to_next_slot(occupied_[level], current % kSlotsPerLevel)) << shift;
+    next = std::min(next, slot_time);
+  }
+  return next;
+}
+
+void TimerWheel::process_slots() {
+  // Cascade from the coarsest level, so that entries moving down are never placed behind the current time
+  for (int level = kLevels - 1; level >= 0; level--) {
+    int shift = level * kLevelBits;
+    if (now_ & ((uint64_t{1} << shift) - 1)) {
+      continue;
+    }
+    int slot = (now_ >> shift) % kSlotsPerLevel;
+    Entry* entry = slots_[level][slot];
+    if (entry == nullptr) {
+      continue;
+    }
+    slots_[level][slot] = nullptr;
+    occupied_[level] &= ~(uint64_t{1} << slot);
+    // Slots are filled at the head; walk from the tail so that entries with the same deadline expire in insertion order
+    while (entry->next_ != nullptr) {
+      entry = entry->next_;
+    }
+    while (entry != nullptr) {
+      Entry* prev = entry->prev_;
+      place(entry);
+      entry = prev;
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
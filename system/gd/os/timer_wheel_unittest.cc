@@ -0,0 +1,177 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "os/internal/timer_wheel.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace bluetooth {
+namespace os {
+namespace internal {
+namespace {
+
+using Entry = TimerWheel::Entry;
+
+TEST(TimerWheelTest, empty) {
+  TimerWheel wheel(100);
+  ASSERT_EQ(TimerWheel::kNever, wheel.NextExpiry());
+  wheel.Advance(1000);
+  ASSERT_EQ(1000ul, wheel.Now());
+  ASSERT_EQ(nullptr, wheel.PopExpired());
+}
+
+TEST(TimerWheelTest, expire_at_deadline) {
+  TimerWheel wheel(0);
+  Entry entry;
+  wheel.Insert(&entry, 10);
+  ASSERT_TRUE(wheel.IsQueued(&entry));
+  ASSERT_EQ(10ul, wheel.NextExpiry());
+  wheel.Advance(9);
+  ASSERT_EQ(nullptr, wheel.PopExpired());
+  wheel.Advance(10);
+  ASSERT_EQ(&entry, wheel.PopExpired());
+  ASSERT_FALSE(wheel.IsQueued(&entry));
+  ASSERT_EQ(TimerWheel::kNever, wheel.NextExpiry());
+}
+
+TEST(TimerWheelTest, deadline_in_the_past_expires_immediately) {
+  TimerWheel wheel(50);
+  Entry entry;
+  wheel.Insert(&entry, 20);
+  ASSERT_EQ(50ul, wheel.NextExpiry());
+  ASSERT_EQ(&entry, wheel.PopExpired());
+}
+
+TEST(TimerWheelTest, remove) {
+  TimerWheel wheel(0);
+  Entry first, second;
+  wheel.Insert(&first, 5);
+  wheel.Insert(&second, 5);
+  wheel.Remove(&first);
+  ASSERT_FALSE(wheel.IsQueued(&first));
+  wheel.Advance(5);
+  ASSERT_EQ(&second, wheel.PopExpired());
+  ASSERT_EQ(nullptr, wheel.PopExpired());
+  // Removing an entry that is not queued is a no-op
+  wheel.Remove(&first);
+}
+
+TEST(TimerWheelTest, remove_expired) {
+  TimerWheel wheel(0);
+  Entry first, second;
+  wheel.Insert(&first, 1);
+  wheel.Insert(&second, 1);
+  wheel.Advance(1);
+  wheel.Remove(&first);
+  ASSERT_EQ(&second, wheel.PopExpired());
+  ASSERT_EQ(nullptr, wheel.PopExpired());
+}
+
+TEST(TimerWheelTest, insert_replaces_deadline) {
+  TimerWheel wheel(0);
+  Entry entry;
+  wheel.Insert(&entry, 5000);
+  wheel.Insert(&entry, 3);
+  wheel.Advance(3);
+  ASSERT_EQ(&entry, wheel.PopExpired());
+  wheel.Advance(6000);
+  ASSERT_EQ(nullptr, wheel.PopExpired());
+}
+
+TEST(TimerWheelTest, same_deadline_expires_in_insertion_order) {
+  TimerWheel wheel(0);
+  Entry entries[4];
+  for (auto& entry : entries) {
+    // Far enough away to be cascaded through several levels
+    wheel.Insert(&entry, 300000);
+  }
+  wheel.Advance(300000);
+  for (auto& entry : entries) {
+    ASSERT_EQ(&entry, wheel.PopExpired());
+  }
+}
+
+TEST(TimerWheelTest, next_expiry_is_earliest_deadline) {
+  TimerWheel wheel(12345);
+  // Deadlines which end up in different levels, and one parked beyond the range of the wheel
+  uint64_t deadlines[] = {12345 + 100000, 12345 + 70, 12345 + 5000000, 12345 + 3, uint64_t{1} << 40};
+  Entry entries[5];
+  for (int i = 0; i < 5; i++) {
+    wheel.Insert(&entries[i], deadlines[i]);
+  }
+  std::sort(std::begin(deadlines), std::end(deadlines));
+  for (auto deadline : deadlines) {
+    ASSERT_EQ(deadline, wheel.NextExpiry());
+    wheel.Advance(deadline);
+    ASSERT_NE(nullptr, wheel.PopExpired());
+    ASSERT_EQ(nullptr, wheel.PopExpired());
+  }
+  ASSERT_EQ(TimerWheel::kNever, wheel.NextExpiry());
+}
+
+TEST(TimerWheelTest, deadline_beyond_wheel_range) {
+  TimerWheel wheel(0);
+  Entry entry;
+  uint64_t deadline = uint64_t{1} << 40;
+  wheel.Insert(&entry, deadline);
+  wheel.Advance(deadline - 1);
+  ASSERT_EQ(nullptr, wheel.PopExpired());
+  wheel.Advance(deadline);
+  ASSERT_EQ(&entry, wheel.PopExpired());
+}
+
+TEST(TimerWheelTest, random_deadlines_expire_in_order) {
+  constexpr int kEntries = 1000;
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<uint64_t> delay(1, 1000000);
+  TimerWheel wheel(777);
+  std::vector<Entry> entries(kEntries);
+  for (auto& entry : entries) {
+    wheel.Insert(&entry, wheel.Now() + delay(generator));
+  }
+
+  int expired = 0;
+  uint64_t last_deadline = 0;
+  while (expired < kEntries) {
+    // Advance in uneven steps, sometimes skipping over many slots at once
+    wheel.Advance(wheel.Now() + delay(generator) / 100);
+    for (Entry* entry = wheel.PopExpired(); entry != nullptr; entry = wheel.PopExpired()) {
+      ASSERT_LE(entry->deadline(), wheel.Now());
+      ASSERT_LE(last_deadline, entry->deadline());
+      last_deadline = entry->deadline();
+      expired++;
+    }
+    // Nothing which is still queued is overdue, and the earliest of them is reported
+    uint64_t next_expiry = TimerWheel::kNever;
+    for (auto& entry : entries) {
+      if (wheel.IsQueued(&entry)) {
+        ASSERT_GT(entry.deadline(), wheel.Now());
+        next_expiry = std::min(next_expiry, entry.deadline());
+      }
+    }
+    ASSERT_EQ(next_expiry, wheel.NextExpiry());
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace os
+}  // namespace bluetooth
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace bluetooth {
+namespace os {
+
+// Trace events of the stack, for looking at the timing of individual operations.
+//
+// On Android the events are written to atrace, and are captured with Perfetto or systrace. On Linux and host they are
+// written in the Chrome JSON trace format to the file given to StartTracing(), which is opened in Perfetto UI or
+// chrome://tracing.
+//
+// Every event is dropped when tracing is off. Callers which build event names should check IsTracing() first, so
+// that nothing is allocated when tracing is off.
+
+// Return true if trace events are recorded
+bool IsTracing();
+
+// Start writing trace events to the file at |path|, return false if the platform records trace events by itself or if
+// the file can't be opened
+bool StartTracing(const std::string& path);
+
+// Stop writing trace events, and complete the trace file
+void StopTracing();
+
+// Begin and end a span on the calling thread, spans of a thread must be nested
+void TraceBegin(const std::string& name);
+void TraceEnd();
+
+// Begin and end a span which may end on another thread. Spans with the same name are told apart by |cookie|, which
+// must be unique among the spans of that name in progress.
+void TraceAsyncBegin(const std::string& name, int32_t cookie);
+void TraceAsyncEnd(const std::string& name, int32_t cookie);
+
+// Record the current value of counter |name|
+void TraceCounter(const std::string& name, int64_t value);
+
+// Trace a span on the calling thread from construction to destruction. The span is ended even if tracing stopped
+// in between.
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(const char* name) : tracing_(IsTracing()) {
+    if (tracing_) {
+      TraceBegin(name);
+    }
+  }
+  ~ScopedTrace() {
+    if (tracing_) {
+      TraceEnd();
+    }
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+ private:
+  const bool tracing_;
+};
+
+}  // namespace os
+}  // namespace bluetooth
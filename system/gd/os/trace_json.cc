@@ -0,0 +1,154 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Trace events in the Chrome JSON array format, for the platforms without atrace
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+
+#include "os/log.h"
+#include "os/trace.h"
+
+namespace bluetooth {
+namespace os {
+
+namespace {
+
+std::atomic<bool> tracing{false};
+std::mutex trace_mutex;
+FILE* trace_file = nullptr;
+bool first_event = true;
+
+int64_t CurrentThreadId() {
+  thread_local int64_t thread_id = syscall(SYS_gettid);
+  return thread_id;
+}
+
+std::string EscapeJson(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char code[7];
+      snprintf(code, sizeof(code), "\\u%04x", c);
+      escaped.append(code);
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+// Write one event, |fields| holds the event specific fields and starts with a comma
+void WriteEvent(char phase, const std::string& fields) {
+  auto timestamp_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch());
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  if (trace_file == nullptr) {
+    return;
+  }
+  fprintf(
+      trace_file,
+      "%s{\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%" PRId64 "%s}",
+      first_event ? "\n" : ",\n",
+      phase,
+      timestamp_us.count(),
+      getpid(),
+      CurrentThreadId(),
+      fields.c_str());
+  first_event = false;
+}
+
+}  // namespace
+
+bool IsTracing() {
+  return tracing.load(std::memory_order_relaxed);
+}
+
+bool StartTracing(const std::string& path) {
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  if (trace_file != nullptr) {
+    LOG_WARN("Already tracing, ignoring %s", path.c_str());
+    return false;
+  }
+  trace_file = fopen(path.c_str(), "w");
+  if (trace_file == nullptr) {
+    LOG_ERROR("Unable to open trace file %s", path.c_str());
+    return false;
+  }
+  fputc('[', trace_file);
+  first_event = true;
+  tracing.store(true, std::memory_order_relaxed);
+  LOG_INFO("Writing trace events to %s", path.c_str());
+  return true;
+}
+
+void StopTracing() {
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  tracing.store(false, std::memory_order_relaxed);
+  if (trace_file == nullptr) {
+    return;
+  }
+  fputs("\n]\n", trace_file);
+  fclose(trace_file);
+  trace_file = nullptr;
+}
+
+void TraceBegin(const std::string& name) {
+  if (!IsTracing()) {
+    return;
+  }
+  WriteEvent('B', ",\"name\":\"" + EscapeJson(name) + "\"");
+}
+
+void TraceEnd() {
+  if (!IsTracing()) {
+    return;
+  }
+  WriteEvent('E', "");
+}
+
+void TraceAsyncBegin(const std::string& name, int32_t cookie) {
+  if (!IsTracing()) {
+    return;
+  }
+  WriteEvent('b', ",\"cat\":\"bluetooth\",\"name\":\"" + EscapeJson(name) + "\",\"id\":" + std::to_string(cookie));
+}
+
+void TraceAsyncEnd(const std::string& name, int32_t cookie) {
+  if (!IsTracing()) {
+    return;
+  }
+  WriteEvent('e', ",\"cat\":\"bluetooth\",\"name\":\"" + EscapeJson(name) + "\",\"id\":" + std::to_string(cookie));
+}
+
+void TraceCounter(const std::string& name, int64_t value) {
+  if (!IsTracing()) {
+    return;
+  }
+  WriteEvent('C', ",\"name\":\"" + EscapeJson(name) + "\",\"args\":{\"value\":" + std::to_string(value) + "}");
+}
+
+}  // namespace os
+}  // namespace bluetooth
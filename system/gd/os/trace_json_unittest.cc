@@ -0,0 +1,91 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "os/trace.h"
+
+namespace bluetooth {
+namespace os {
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+size_t CountOf(const std::string& content, const std::string& pattern) {
+  size_t count = 0;
+  for (auto pos = content.find(pattern); pos != std::string::npos; pos = content.find(pattern, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+class TraceJsonTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "/trace_json_test_" + std::to_string(getpid()) + ".json";
+  }
+  void TearDown() override {
+    StopTracing();
+    unlink(path_.c_str());
+  }
+  std::string path_;
+};
+
+TEST_F(TraceJsonTest, nothing_recorded_when_off) {
+  ASSERT_FALSE(IsTracing());
+  { ScopedTrace trace("not recorded"); }
+  TraceCounter("not recorded", 1);
+  ASSERT_TRUE(ReadFile(path_).empty());
+}
+
+TEST_F(TraceJsonTest, record_events) {
+  ASSERT_TRUE(StartTracing(path_));
+  ASSERT_TRUE(IsTracing());
+  ASSERT_FALSE(StartTracing(path_));
+  {
+    ScopedTrace trace("scoped \"span\"");
+    TraceAsyncBegin("async span", 7);
+    TraceAsyncEnd("async span", 7);
+    TraceCounter("counter", 42);
+  }
+  StopTracing();
+  ASSERT_FALSE(IsTracing());
+  { ScopedTrace trace("not recorded"); }
+
+  auto content = ReadFile(path_);
+  ASSERT_EQ(content.front(), '[');
+  ASSERT_EQ(content.substr(content.size() - 3), "\n]\n");
+  ASSERT_EQ(CountOf(content, "{\"ph\""), 5u);
+  ASSERT_EQ(CountOf(content, "\"name\":\"scoped \\\"span\\\"\""), 1u);
+  ASSERT_EQ(CountOf(content, "\"ph\":\"E\""), 1u);
+  ASSERT_EQ(CountOf(content, "\"name\":\"async span\",\"id\":7"), 2u);
+  ASSERT_EQ(CountOf(content, "\"args\":{\"value\":42}"), 1u);
+  ASSERT_EQ(CountOf(content, "not recorded"), 0u);
+}
+
+}  // namespace
+}  // namespace os
+}  // namespace bluetooth
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -30,6 +31,8 @@
 namespace bluetooth {
 namespace os {
 
+class Alarm;
+
 class WakelockManager {
  public:
   static const std::string kBtWakelockId;
@@ -58,6 +61,12 @@ class WakelockManager {
   // This method must be called before calling Acquire() or Release()
   void SetOsCallouts(OsCallouts* callouts, Handler* handler);
 
+  // Set the release hysteresis: once acquired, the wakelock is held for at least |min_hold|, and each release is
+  // deferred by |release_grace|. Acquiring while a release is deferred drops the release, so that bursts of short
+  // activity share one acquisition. The deferred releases run on |handler|.
+  // Zero durations, or a null |handler|, disable the hysteresis, which is the default.
+  void SetHysteresis(std::chrono::milliseconds min_hold, std::chrono::milliseconds release_grace, Handler* handler);
+
   // Acquire the Bluetooth wakelock.
   // Return true on success, otherwise false.
   // The function is thread safe.
@@ -80,12 +89,21 @@ class WakelockManager {
  private:
   WakelockManager();
 
+  bool ReleaseNow();
+  void OnReleaseDeferred();
+
   std::recursive_mutex mutex_;
   bool initialized_ = false;
   OsCallouts* os_callouts_ = nullptr;
   Handler* os_callouts_handler_ = nullptr;
   bool is_native_ = true;
 
+  std::chrono::milliseconds min_hold_{0};
+  std::chrono::milliseconds release_grace_{0};
+  std::unique_ptr<Alarm> release_alarm_;
+  bool release_pending_ = false;
+  uint64_t release_deadline_ms_ = 0;
+
   struct Stats;
   std::unique_ptr<Stats> pstats_;
 };
@@ -22,7 +22,9 @@
 #include <memory>
 #include <vector>
 
+#include "os/log.h"
 #include "packet/bit_inserter.h"
+#include "packet/buffer_inserter.h"
 
 namespace bluetooth {
 namespace packet {
@@ -38,6 +40,14 @@ class BasePacketBuilder {
   // Write to the vector with the given iterator.
   virtual void Serialize(BitInserter& it) const = 0;
 
+  // Write into the length bytes at buffer, which must hold size() bytes. Returns the number of bytes written.
+  size_t SerializeInto(uint8_t* buffer, size_t length) const {
+    ASSERT_LOG(size() <= length, "Packet of %zu bytes doesn't fit in %zu bytes", size(), length);
+    BufferInserter it(buffer, length);
+    Serialize(it);
+    return it.size();
+  }
+
   void SetFlushable(bool is_flushable) {
     is_flushable_ = is_flushable;
   }
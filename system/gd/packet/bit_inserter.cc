@@ -44,5 +44,16 @@ void BitInserter::insert_byte(uint8_t byte) {
   insert_bits(byte, 8);
 }
 
+void BitInserter::insert_bytes(const uint8_t* bytes, size_t size) {
+  // Bytes which don't start on a byte boundary have to be shifted one by one
+  if (num_saved_bits_ != 0) {
+    for (size_t i = 0; i < size; i++) {
+      insert_bits(bytes[i], 8);
+    }
+    return;
+  }
+  ByteInserter::insert_bytes(bytes, size);
+}
+
 }  // namespace packet
 }  // namespace bluetooth
@@ -78,5 +78,26 @@ TEST(BitInserterTest, observerTest) {
   ASSERT_EQ(result.size(), copy.size());
 }
 
+TEST(BitInserterTest, insertBytes) {
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  std::vector<uint8_t> copy;
+  it.RegisterObserver(ByteObserver([&copy](uint8_t byte) { copy.push_back(byte); }, []() { return 0; }));
+
+  std::vector<uint8_t> payload = {0x01, 0x02, 0x03};
+  it.insert_bytes(payload.data(), payload.size());
+  ASSERT_EQ(payload, bytes);
+  ASSERT_EQ(payload, copy);
+
+  // Bytes inserted after a partial byte are shifted by the saved bits
+  it.insert_bits(0b1, 4);
+  it.insert_bytes(payload.data(), payload.size());
+  it.insert_bits(0b0, 4);
+  std::vector<uint8_t> result = {0x01, 0x02, 0x03, 0x11, 0x20, 0x30, 0x00};
+  ASSERT_EQ(result, bytes);
+  ASSERT_EQ(result, copy);
+  it.UnregisterObserver();
+}
+
 }  // namespace packet
 }  // namespace bluetooth
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/buffer_inserter.h"
+
+#include <cstring>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace packet {
+
+BufferInserter::BufferInserter(uint8_t* buffer, size_t length)
+    : BitInserter(to_construct_bit_inserter_), buffer_(buffer), length_(length) {}
+
+void BufferInserter::insert_bits(uint8_t byte, size_t num_bits) {
+  size_t total_bits = num_bits + num_saved_bits_;
+  uint16_t new_value = static_cast<uint8_t>(saved_bits_) | (static_cast<uint16_t>(byte) << num_saved_bits_);
+  if (total_bits >= 8) {
+    uint8_t new_byte = static_cast<uint8_t>(new_value);
+    ASSERT_LOG(size_ < length_, "Buffer of %zu bytes is full", length_);
+    on_byte(new_byte);
+    buffer_[size_++] = new_byte;
+    total_bits -= 8;
+    new_value = new_value >> 8;
+  }
+  num_saved_bits_ = total_bits;
+  uint8_t mask = static_cast<uint8_t>(0xff) >> (8 - num_saved_bits_);
+  saved_bits_ = static_cast<uint8_t>(new_value) & mask;
+}
+
+void BufferInserter::insert_bytes(const uint8_t* bytes, size_t size) {
+  // Bytes which don't start on a byte boundary have to be shifted one by one
+  if (num_saved_bits_ != 0) {
+    for (size_t i = 0; i < size; i++) {
+      insert_bits(bytes[i], 8);
+    }
+    return;
+  }
+  ASSERT_LOG(size <= length_ - size_, "Can't insert %zu bytes, %zu bytes left in the buffer", size, length_ - size_);
+  if (HasObservers()) {
+    for (size_t i = 0; i < size; i++) {
+      on_byte(bytes[i]);
+    }
+  }
+  std::memcpy(buffer_ + size_, bytes, size);
+  size_ += size;
+}
+
+size_t BufferInserter::size() const {
+  return size_;
+}
+
+}  // namespace packet
+}  // namespace bluetooth
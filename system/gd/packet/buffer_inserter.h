@@ -0,0 +1,47 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "packet/bit_inserter.h"
+
+namespace bluetooth {
+namespace packet {
+
+// Inserter writing into memory owned by the caller instead of a growing vector
+class BufferInserter : public BitInserter {
+ public:
+  BufferInserter(uint8_t* buffer, size_t length);
+
+  void insert_bits(uint8_t byte, size_t num_bits) override;
+
+  void insert_bytes(const uint8_t* bytes, size_t size) override;
+
+  // Number of bytes written into the buffer
+  size_t size() const;
+
+ protected:
+  std::vector<uint8_t> to_construct_bit_inserter_;
+  uint8_t* buffer_;
+  size_t length_;
+  size_t size_{0};
+};
+
+}  // namespace packet
+}  // namespace bluetooth
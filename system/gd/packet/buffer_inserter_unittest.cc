@@ -0,0 +1,83 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/buffer_inserter.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace packet {
+
+TEST(BufferInserterTest, addMoreBits) {
+  std::array<uint8_t, 5> buffer{};
+  BufferInserter it(buffer.data(), buffer.size());
+
+  for (size_t i = 0; i < 9; i++) {
+    it.insert_bits(static_cast<uint8_t>(i), i);
+  }
+  it.insert_bits(static_cast<uint8_t>(0b1010), 4);
+  std::array<uint8_t, 5> result = {0b00011101 /* 3 2 1 */, 0b00010101 /* 5 4 */, 0b11100011 /* 7 6 */,
+                                   0b10000000 /* 8 */, 0b10100000 /* filled with 1010 */};
+
+  ASSERT_EQ(result.size(), it.size());
+  ASSERT_EQ(result, buffer);
+}
+
+TEST(BufferInserterTest, observerTest) {
+  std::array<uint8_t, 4> buffer{};
+  BufferInserter it(buffer.data(), buffer.size());
+  std::vector<uint8_t> copy;
+
+  uint64_t checksum = 0x0123456789abcdef;
+  it.RegisterObserver(ByteObserver([&copy](uint8_t byte) { copy.push_back(byte); }, [checksum]() { return checksum; }));
+  it.insert_byte(0x01);
+  std::array<uint8_t, 3> bytes = {0x02, 0x03, 0x04};
+  it.insert_bytes(bytes.data(), bytes.size());
+
+  ASSERT_EQ(buffer.size(), it.size());
+  ASSERT_EQ(std::vector<uint8_t>(buffer.begin(), buffer.end()), copy);
+  ASSERT_EQ(checksum, it.UnregisterObserver().GetValue());
+}
+
+TEST(BufferInserterTest, serializeIntoTest) {
+  std::vector<uint8_t> payload = {0x01, 0x02, 0x03, 0x04, 0x05};
+  RawBuilder builder(payload);
+  builder.AddOctets2(0x0706);
+
+  std::array<uint8_t, 8> buffer{};
+  ASSERT_EQ(builder.size(), builder.SerializeInto(buffer.data(), buffer.size()));
+  std::array<uint8_t, 8> result = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x00};
+  ASSERT_EQ(result, buffer);
+
+  ASSERT_DEATH(builder.SerializeInto(buffer.data(), builder.size() - 1), "");
+}
+
+TEST(BufferInserterTest, insertPastTheEndTest) {
+  std::array<uint8_t, 2> buffer{};
+  BufferInserter it(buffer.data(), buffer.size());
+  std::array<uint8_t, 3> bytes = {0x01, 0x02, 0x03};
+  ASSERT_DEATH(it.insert_bytes(bytes.data(), bytes.size()), "");
+  it.insert_bytes(bytes.data(), 2);
+  ASSERT_DEATH(it.insert_byte(0x03), "");
+}
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -43,10 +43,23 @@ void ByteInserter::on_byte(uint8_t byte) {
   }
 }
 
+bool ByteInserter::HasObservers() const {
+  return !registered_observers_.empty();
+}
+
 void ByteInserter::insert_byte(uint8_t byte) {
   on_byte(byte);
   std::back_insert_iterator<std::vector<uint8_t>>::operator=(byte);
 }
 
+void ByteInserter::insert_bytes(const uint8_t* bytes, size_t size) {
+  if (HasObservers()) {
+    for (size_t i = 0; i < size; i++) {
+      on_byte(bytes[i]);
+    }
+  }
+  container->insert(container->end(), bytes, bytes + size);
+}
+
 }  // namespace packet
 }  // namespace bluetooth
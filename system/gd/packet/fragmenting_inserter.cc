@@ -46,6 +46,12 @@ void FragmentingInserter::insert_bits(uint8_t byte, size_t num_bits) {
   saved_bits_ = static_cast<uint8_t>(new_value) & mask;
 }
 
+void FragmentingInserter::insert_bytes(const uint8_t* bytes, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    insert_bits(bytes[i], 8);
+  }
+}
+
 void FragmentingInserter::finalize() {
   if (curr_packet_->size() != 0) {
     iterator_ = std::move(curr_packet_);
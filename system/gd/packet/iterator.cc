@@ -23,7 +23,12 @@ namespace packet {
 
 template <bool little_endian>
 Iterator<little_endian>::Iterator(const std::forward_list<View>& data, size_t offset) {
-  data_ = data;
+  if (!data.empty() && std::next(data.begin()) == data.end()) {
+    contiguous_view_ = data.front();
+    contiguous_data_ = contiguous_view_->data();
+  } else {
+    data_ = data;
+  }
   index_ = offset;
   begin_ = 0;
   end_ = 0;
@@ -81,6 +86,8 @@ template <bool little_endian>
 Iterator<little_endian>& Iterator<little_endian>::operator=(const Iterator<little_endian>& itr) {
   if (this == &itr) return *this;
   this->data_ = itr.data_;
+  this->contiguous_view_ = itr.contiguous_view_;
+  this->contiguous_data_ = itr.contiguous_data_;
   this->begin_ = itr.begin_;
   this->end_ = itr.end_;
   this->index_ = itr.index_;
@@ -120,9 +127,12 @@ bool Iterator<little_endian>::operator>=(const Iterator<little_endian>& itr) con
 template <bool little_endian>
 uint8_t Iterator<little_endian>::operator*() const {
   ASSERT_LOG(index_ < end_ && !(begin_ > index_), "Index %zu out of bounds: [%zu,%zu)", index_, begin_, end_);
+  if (contiguous_data_ != nullptr) {
+    return contiguous_data_[index_];
+  }
   size_t index = index_;
 
-  for (auto view : data_) {
+  for (const auto& view : data_) {
     if (index < view.size()) {
       return view[index];
     }
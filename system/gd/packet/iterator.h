@@ -17,8 +17,10 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <forward_list>
 #include <memory>
+#include <optional>
 #include <type_traits>
 
 #include "packet/custom_field_fixed_size_interface.h"
@@ -27,6 +29,21 @@
 namespace bluetooth {
 namespace packet {
 
+// Load the sizeof(FixedWidthPODType) bytes at data, stored with the given endianness
+template <bool little_endian, typename FixedWidthPODType>
+FixedWidthPODType LoadFixedWidth(const uint8_t* data) {
+  FixedWidthPODType value{};
+  uint8_t* value_ptr = reinterpret_cast<uint8_t*>(&value);
+  if constexpr (little_endian) {
+    std::memcpy(value_ptr, data, sizeof(FixedWidthPODType));
+  } else {
+    for (size_t i = 0; i < sizeof(FixedWidthPODType); i++) {
+      value_ptr[sizeof(FixedWidthPODType) - i - 1] = data[i];
+    }
+  }
+  return value;
+}
+
 // Templated Iterator for endianness
 template <bool little_endian>
 class Iterator : public std::iterator<std::random_access_iterator_tag, uint8_t> {
@@ -62,10 +79,21 @@ class Iterator : public std::iterator<std::random_access_iterator_tag, uint8_t>
 
   Iterator Subrange(size_t index, size_t length) const;
 
+  // Returns whether all the bytes of the iterated data are in a single buffer
+  bool IsContiguous() const {
+    return contiguous_data_ != nullptr;
+  }
+
   // Get the next sizeof(FixedWidthPODType) bytes and return the filled type
   template <typename FixedWidthPODType, typename std::enable_if<std::is_pod<FixedWidthPODType>::value, int>::type = 0>
   FixedWidthPODType extract() {
     static_assert(std::is_pod<FixedWidthPODType>::value, "Iterator::extract requires a fixed-width type.");
+    if (contiguous_data_ != nullptr && index_ >= begin_ && index_ + sizeof(FixedWidthPODType) <= end_) {
+      auto value = LoadFixedWidth<little_endian, FixedWidthPODType>(contiguous_data_ + index_);
+      index_ += sizeof(FixedWidthPODType);
+      return value;
+    }
+    // Byte by byte, which also reports out of bounds reads
     FixedWidthPODType extracted_value{};
     uint8_t* value_ptr = (uint8_t*)&extracted_value;
 
@@ -80,6 +108,14 @@ class Iterator : public std::iterator<std::random_access_iterator_tag, uint8_t>
   template <typename T, typename std::enable_if<std::is_base_of_v<CustomFieldFixedSizeInterface<T>, T>, int>::type = 0>
   T extract() {
     T extracted_value{};
+    size_t length = CustomFieldFixedSizeInterface<T>::length();
+    if (contiguous_data_ != nullptr && index_ >= begin_ && index_ + length <= end_) {
+      for (size_t i = 0; i < length; i++) {
+        extracted_value.data()[little_endian ? i : length - i - 1] = contiguous_data_[index_ + i];
+      }
+      index_ += length;
+      return extracted_value;
+    }
     for (size_t i = 0; i < CustomFieldFixedSizeInterface<T>::length(); i++) {
       size_t index = (little_endian ? i : CustomFieldFixedSizeInterface<T>::length() - i - 1);
       extracted_value.data()[index] = this->operator*();
@@ -89,7 +125,11 @@ class Iterator : public std::iterator<std::random_access_iterator_tag, uint8_t>
   }
 
  private:
+  // Data made of several fragments. Data in a single fragment is kept in contiguous_view_ instead, which is cheaper
+  // to copy and read.
   std::forward_list<View> data_;
+  std::optional<View> contiguous_view_;
+  const uint8_t* contiguous_data_ = nullptr;
   size_t index_;
   size_t begin_;
   size_t end_;
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+
+#include "packet/iterator.h"
+
+namespace bluetooth {
+namespace packet {
+
+// Elements of an array field of a packet, parsed one at a time while iterating instead of all at once into a vector.
+// Iterating visits the same elements as the vector returned by the getter of the field, in the same order.
+template <typename T, bool little_endian>
+class LazyArray {
+ public:
+  // Parse the element at *it into element and move *it past it. Returns false when the element is malformed, in which
+  // case it is skipped.
+  using Extractor = bool (*)(T* element, Iterator<little_endian>* it);
+
+  // Iterate over the elements starting at begin, at most count of them when set, while there is at least
+  // min_element_size bytes remaining (at least one byte when min_element_size is 0)
+  LazyArray(Iterator<little_endian> begin, std::optional<size_t> count, size_t min_element_size, Extractor extractor)
+      : begin_(begin), count_(count), min_element_size_(min_element_size == 0 ? 1 : min_element_size),
+        extractor_(extractor) {}
+
+  class const_iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const T& operator*() const {
+      return element_;
+    }
+
+    const T* operator->() const {
+      return &element_;
+    }
+
+    const_iterator& operator++() {
+      parse_next();
+      return *this;
+    }
+
+    // All the iterators which reached the end of the array compare equal, regardless of their position
+    bool operator==(const const_iterator& other) const {
+      return done_ == other.done_ && (done_ || it_.NumBytesRemaining() == other.it_.NumBytesRemaining());
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class LazyArray;
+
+    const_iterator(const LazyArray* array, Iterator<little_endian> it, bool done)
+        : array_(array), it_(it), remaining_(array->count_), done_(done) {
+      if (!done_) {
+        parse_next();
+      }
+    }
+
+    void parse_next() {
+      while (true) {
+        if ((remaining_ && *remaining_ == 0) || it_.NumBytesRemaining() < array_->min_element_size_) {
+          done_ = true;
+          return;
+        }
+        if (remaining_) {
+          (*remaining_)--;
+        }
+        element_ = T{};
+        if (array_->extractor_(&element_, &it_)) {
+          return;
+        }
+      }
+    }
+
+    const LazyArray* array_;
+    Iterator<little_endian> it_;
+    std::optional<size_t> remaining_;
+    bool done_;
+    T element_{};
+  };
+
+  const_iterator begin() const {
+    return const_iterator(this, begin_, false);
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, begin_, true);
+  }
+
+  // Returns whether the array has no element. Parses the first element.
+  bool empty() const {
+    return begin() == end();
+  }
+
+ private:
+  Iterator<little_endian> begin_;
+  std::optional<size_t> count_;
+  size_t min_element_size_;
+  Extractor extractor_;
+};
+
+}  // namespace packet
+}  // namespace bluetooth
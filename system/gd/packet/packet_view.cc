@@ -17,6 +17,7 @@
 #include "packet/packet_view.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "os/log.h"
 
@@ -68,6 +69,30 @@ size_t PacketView<little_endian>::size() const {
   return length_;
 }
 
+template <bool little_endian>
+void PacketView<little_endian>::CopyTo(uint8_t* destination) const {
+  for (const auto& fragment : fragments_) {
+    if (fragment.size() != 0) {
+      std::memcpy(destination, fragment.data(), fragment.size());
+      destination += fragment.size();
+    }
+  }
+}
+
+template <bool little_endian>
+bool PacketView<little_endian>::IsContiguous() const {
+  return !fragments_.empty() && std::next(fragments_.begin()) == fragments_.end();
+}
+
+template <bool little_endian>
+const uint8_t* PacketView<little_endian>::GetContiguousData(size_t offset, size_t length) const {
+  if (!IsContiguous()) {
+    return nullptr;
+  }
+  ASSERT_LOG(offset + length <= length_, "Index %zu out of bounds", offset + length - 1);
+  return fragments_.front().data() + offset;
+}
+
 template <bool little_endian>
 std::forward_list<View> PacketView<little_endian>::GetSubviewList(size_t begin, size_t end) const {
   ASSERT(begin <= end);
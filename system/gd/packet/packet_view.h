@@ -18,6 +18,7 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <type_traits>
 
 #include "packet/iterator.h"
 #include "packet/view.h"
@@ -49,6 +50,24 @@ class PacketView {
 
   size_t size() const;
 
+  // Copy the bytes of this packet to |destination|, which must hold size() bytes. Much cheaper than copying through
+  // iterators, since each fragment is copied at once.
+  void CopyTo(uint8_t* destination) const;
+
+  // Returns whether the bytes of this packet are in a single buffer
+  bool IsContiguous() const;
+
+  // Same as (begin() + offset).extract<FixedWidthPODType>(), but loads the value directly when the packet is
+  // contiguous. Used by the generated accessors of fields at a fixed offset.
+  template <typename FixedWidthPODType, typename std::enable_if<std::is_pod<FixedWidthPODType>::value, int>::type = 0>
+  FixedWidthPODType ExtractAt(size_t offset) const {
+    const uint8_t* data = GetContiguousData(offset, sizeof(FixedWidthPODType));
+    if (data == nullptr) {
+      return (begin() + offset).template extract<FixedWidthPODType>();
+    }
+    return LoadFixedWidth<little_endian, FixedWidthPODType>(data);
+  }
+
   PacketView<true> GetLittleEndianSubview(size_t begin, size_t end) const;
 
   PacketView<false> GetBigEndianSubview(size_t begin, size_t end) const;
@@ -60,6 +79,8 @@ class PacketView {
   std::forward_list<View> fragments_;
   size_t length_;
   std::forward_list<View> GetSubviewList(size_t begin, size_t end) const;
+  // Return a pointer to the length bytes at offset when the packet is contiguous, nullptr otherwise
+  const uint8_t* GetContiguousData(size_t offset, size_t length) const;
 };
 
 }  // namespace packet
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <forward_list>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/address.h"
+#include "hci/hci_packets.h"
+#include "packet/bit_inserter.h"
+#include "packet/packet_view.h"
+#include "packet/view.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::Address;
+using ::bluetooth::hci::EventView;
+using ::bluetooth::hci::LeExtendedAdvertisingReportBuilder;
+using ::bluetooth::hci::LeExtendedAdvertisingReportView;
+using ::bluetooth::hci::LeExtendedAdvertisingResponse;
+using ::bluetooth::hci::LeMetaEventView;
+using ::bluetooth::packet::kLittleEndian;
+using ::bluetooth::packet::PacketView;
+using ::bluetooth::packet::View;
+
+namespace {
+
+constexpr size_t kReportsPerEvent = 4;
+
+std::shared_ptr<std::vector<uint8_t>> extended_advertising_report_bytes() {
+  std::vector<LeExtendedAdvertisingResponse> reports;
+  for (size_t i = 0; i < kReportsPerEvent; i++) {
+    LeExtendedAdvertisingResponse report{};
+    report.connectable_ = 1;
+    report.address_type_ = bluetooth::hci::DirectAdvertisingAddressType::RANDOM_DEVICE_ADDRESS;
+    report.address_ = Address({0x12, 0x34, 0x56, 0x78, 0x9a, static_cast<uint8_t>(i)});
+    report.rssi_ = 0xc0;
+    bluetooth::hci::LengthAndData flags{};
+    flags.data_ = {static_cast<uint8_t>(bluetooth::hci::GapDataType::FLAGS), 0x06};
+    bluetooth::hci::LengthAndData name{};
+    name.data_ = {static_cast<uint8_t>(bluetooth::hci::GapDataType::COMPLETE_LOCAL_NAME), 'b', 'e', 'n', 'c', 'h'};
+    report.advertising_data_ = {flags, name};
+    reports.push_back(report);
+  }
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  bluetooth::packet::BitInserter bi(*bytes);
+  LeExtendedAdvertisingReportBuilder::Create(reports)->Serialize(bi);
+  return bytes;
+}
+
+size_t parse_extended_advertising_report(PacketView<kLittleEndian> packet) {
+  auto report = LeExtendedAdvertisingReportView::Create(LeMetaEventView::Create(EventView::Create(packet)));
+  if (!report.IsValid()) {
+    return 0;
+  }
+  size_t parsed = 0;
+  for (const auto& response : report.GetResponses()) {
+    parsed += response.rssi_ != 0;
+  }
+  return parsed;
+}
+
+// Parse the received event, held in a single buffer like every event received from the HAL
+void BM_ParseContiguousExtendedAdvertisingReport(State& state) {
+  auto bytes = extended_advertising_report_bytes();
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(parse_extended_advertising_report(PacketView<kLittleEndian>(bytes)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseContiguousExtendedAdvertisingReport);
+
+// Parse the same event split in two fragments, which goes through the iterator over fragments
+void BM_ParseFragmentedExtendedAdvertisingReport(State& state) {
+  auto bytes = extended_advertising_report_bytes();
+  size_t half = bytes->size() / 2;
+  PacketView<kLittleEndian> packet(std::forward_list<View>{View(bytes, 0, half), View(bytes, half, bytes->size())});
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(parse_extended_advertising_report(packet));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseFragmentedExtendedAdvertisingReport);
+
+}  // namespace
@@ -552,6 +552,39 @@ TEST_F(PacketViewMultiViewTest, arrayOperatorTest) {
   ASSERT_DEATH(multi_view[single_view.size()], "");
 }
 
+TEST_F(PacketViewMultiViewTest, copyToTest) {
+  std::vector<uint8_t> single_bytes(single_view.size());
+  single_view.CopyTo(single_bytes.data());
+  std::vector<uint8_t> multi_bytes(multi_view.size());
+  multi_view.CopyTo(multi_bytes.data());
+  ASSERT_EQ(std::vector<uint8_t>(single_view.begin(), single_view.end()), multi_bytes);
+  ASSERT_EQ(single_bytes, multi_bytes);
+
+  // Subviews start and end in the middle of fragments
+  auto subview = multi_view.GetLittleEndianSubview(1, multi_view.size() - 1);
+  std::vector<uint8_t> sub_bytes(subview.size());
+  subview.CopyTo(sub_bytes.data());
+  ASSERT_EQ(std::vector<uint8_t>(subview.begin(), subview.end()), sub_bytes);
+}
+
+TEST_F(PacketViewMultiViewTest, extractAtTest) {
+  ASSERT_TRUE(single_view.IsContiguous());
+  ASSERT_FALSE(multi_view.IsContiguous());
+  ASSERT_TRUE(single_view.begin().IsContiguous());
+  ASSERT_FALSE(multi_view.begin().IsContiguous());
+  // Both paths agree, including across fragment boundaries
+  for (size_t i = 0; i + sizeof(uint32_t) <= single_view.size(); i++) {
+    ASSERT_EQ(single_view.ExtractAt<uint32_t>(i), multi_view.ExtractAt<uint32_t>(i));
+    ASSERT_EQ(single_view.ExtractAt<uint32_t>(i), (single_view.begin() + i).extract<uint32_t>());
+  }
+  ASSERT_EQ(0x03020100u, single_view.ExtractAt<uint32_t>(0));
+  auto big_endian_view = single_view.GetBigEndianSubview(0, single_view.size());
+  ASSERT_EQ(0x00010203u, big_endian_view.ExtractAt<uint32_t>(0));
+  ASSERT_EQ(0x00010203u, big_endian_view.begin().extract<uint32_t>());
+  ASSERT_DEATH(single_view.ExtractAt<uint16_t>(single_view.size() - 1), "");
+  ASSERT_DEATH(multi_view.ExtractAt<uint16_t>(multi_view.size() - 1), "");
+}
+
 TEST_F(PacketViewMultiViewAppendTest, sizeTestAppend) {
   ASSERT_EQ(single_view.size(), multi_view.size());
 }
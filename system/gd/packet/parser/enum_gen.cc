@@ -42,20 +42,71 @@ void EnumGen::GenDefinitionPybind11(std::ostream& stream) {
 }
 
 void EnumGen::GenLogging(std::ostream& stream) {
-  // Print out the switch statement that converts all the constants to strings.
-  stream << "inline std::string " << e_.name_ << "Text(const " << e_.name_ << "& param) {";
-  stream << "switch (param) {";
-  for (const auto& pair : e_.constants_) {
-    stream << "case " << e_.name_ << "::" << pair.second << ":";
-    stream << "  return \"" << pair.second << "\";";
+  std::string underlying_type = util::GetTypeForSize(e_.size_);
+  std::string table = "k" + e_.name_ + "Names";
+
+  // Print out the table of the constants and their names, sorted by value.
+  if (!e_.constants_.empty()) {
+    stream << "inline constexpr std::pair<" << e_.name_ << ", const char*> " << table << "[] = {";
+    for (const auto& pair : e_.constants_) {
+      stream << "{" << e_.name_ << "::" << pair.second << ", \"" << pair.second << "\"},";
+    }
+    stream << "};\n\n";
   }
-  stream << "default:";
-  stream << "  return std::string(\"Unknown " << e_.name_ << ": \") + std::to_string(static_cast<int>(param));";
+
+  // Print out the lookup of the name of a constant, nullptr for the values which aren't one.
+  stream << "constexpr const char* " << e_.name_ << "Name(const " << e_.name_ << "&";
+  if (e_.constants_.empty()) {
+    stream << ") {";
+    stream << "return nullptr;";
+  } else {
+    stream << " param) {";
+    uint64_t first = e_.constants_.begin()->first;
+    uint64_t last = e_.constants_.rbegin()->first;
+    if (last - first + 1 == e_.constants_.size()) {
+      // Consecutive values are looked up by index.
+      stream << "auto value = static_cast<" << underlying_type << ">(param);";
+      stream << "if (";
+      if (first != 0) {
+        stream << "value < 0x" << std::hex << first << std::dec << " || ";
+      }
+      stream << "value > 0x" << std::hex << last << std::dec << ") {";
+      stream << "return nullptr;";
+      stream << "}";
+      stream << "return " << table << "[value - 0x" << std::hex << first << std::dec << "].second;";
+    } else {
+      stream << "size_t begin = 0;";
+      stream << "size_t end = " << e_.constants_.size() << ";";
+      stream << "while (begin < end) {";
+      stream << "size_t middle = begin + (end - begin) / 2;";
+      stream << "if (" << table << "[middle].first < param) { begin = middle + 1; } else { end = middle; }";
+      stream << "}";
+      stream << "if (begin < " << e_.constants_.size() << " && " << table << "[begin].first == param) {";
+      stream << "return " << table << "[begin].second;";
+      stream << "}";
+      stream << "return nullptr;";
+    }
+  }
+  stream << "}\n\n";
+
+  stream << "constexpr bool Is" << e_.name_ << "Valid(const " << e_.name_ << "& param) {";
+  stream << "return " << e_.name_ << "Name(param) != nullptr;";
+  stream << "}\n\n";
+
+  stream << "inline std::string " << e_.name_ << "Text(const " << e_.name_ << "& param) {";
+  stream << "const char* name = " << e_.name_ << "Name(param);";
+  stream << "if (name != nullptr) {";
+  stream << "  return name;";
   stream << "}";
+  stream << "return std::string(\"Unknown " << e_.name_ << ": \") + std::to_string(static_cast<int>(param));";
   stream << "}\n\n";
 
   // Print out the stream operator so that the constant can be written to streams.
   stream << "inline std::ostream& operator<<(std::ostream& os, const " << e_.name_ << "& param) {";
+  stream << "const char* name = " << e_.name_ << "Name(param);";
+  stream << "if (name != nullptr) {";
+  stream << "  return os << name;";
+  stream << "}";
   stream << "  return os << " << e_.name_ << "Text(param);";
   stream << "}\n";
 }
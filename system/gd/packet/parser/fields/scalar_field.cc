@@ -16,6 +16,7 @@
 
 #include "fields/scalar_field.h"
 
+#include "fields/enum_field.h"
 #include "fields/fixed_scalar_field.h"
 #include "fields/size_field.h"
 #include "util.h"
@@ -67,12 +68,17 @@ int ScalarField::GenBounds(std::ostream& s, Size start_offset, Size end_offset,
 }
 
 void ScalarField::GenExtractor(std::ostream& s, int num_leading_bits, bool) const {
+  GenExtractedValue(s, GetName() + "_it.extract", "", num_leading_bits);
+}
+
+void ScalarField::GenExtractedValue(
+    std::ostream& s, const std::string& extract_function, const std::string& arguments, int num_leading_bits) const {
   Size size = GetSize();
   // Extract the correct number of bytes. The return type could be different
   // from the extract type if an earlier field causes the beginning of the
   // current field to start in the middle of a byte.
   std::string extract_type = util::GetTypeForSize(size.bits() + num_leading_bits);
-  s << "auto extracted_value = " << GetName() << "_it.extract<" << extract_type << ">();";
+  s << "auto extracted_value = " << extract_function << "<" << extract_type << ">(" << arguments << ");";
 
   // Right shift the result to remove leading bits.
   if (num_leading_bits != 0) {
@@ -99,11 +105,26 @@ std::string ScalarField::GetGetterFunctionName() const {
 void ScalarField::GenGetter(std::ostream& s, Size start_offset, Size end_offset) const {
   s << GetDataType() << " " << GetGetterFunctionName() << "() const {";
   s << "ASSERT(was_validated_);";
-  s << "auto to_bound = begin();";
-  int num_leading_bits = GenBounds(s, start_offset, end_offset, GetSize());
+  // Fields at a fixed offset from the beginning are loaded straight from the view, without an iterator when the view
+  // is contiguous. Fields with their own extractor keep using it.
+  bool load_at_offset =
+      !start_offset.empty() && (GetFieldType() == ScalarField::kFieldType || GetFieldType() == EnumField::kFieldType);
+  int num_leading_bits;
+  if (load_at_offset) {
+    num_leading_bits = start_offset.bits() % 8;
+  } else {
+    s << "auto to_bound = begin();";
+    num_leading_bits = GenBounds(s, start_offset, end_offset, GetSize());
+  }
   s << GetDataType() << " " << GetName() << "_value{};";
   s << GetDataType() << "* " << GetName() << "_ptr = &" << GetName() << "_value;";
-  GenExtractor(s, num_leading_bits, false);
+  if (load_at_offset) {
+    std::stringstream offset;
+    offset << "(" << start_offset << ") / 8";
+    GenExtractedValue(s, "ExtractAt", offset.str(), num_leading_bits);
+  } else {
+    GenExtractor(s, num_leading_bits, false);
+  }
   s << "return " << GetName() << "_value;";
   s << "}";
 }
@@ -66,6 +66,12 @@ class ScalarField : public PacketField {
     return false;
   }
 
+ protected:
+  // Generate the extraction of the value from extract_function<type>(arguments), with its leading bits shifted out
+  // and masked to the size of the field
+  void GenExtractedValue(
+      std::ostream& s, const std::string& extract_function, const std::string& arguments, int num_leading_bits) const;
+
  private:
   const int size_;
 };
@@ -165,6 +165,37 @@ void VectorField::GenGetter(std::ostream& s, Size start_offset, Size end_offset)
   s << "}\n";
 }
 
+bool VectorField::HasLazyGetter() const {
+  // Elements held in a std::unique_ptr are not copyable
+  return !element_field_->BuilderParameterMustBeMoved();
+}
+
+void VectorField::GenLazyGetter(std::ostream& s, Size start_offset, Size end_offset, bool little_endian) const {
+  std::string element_type = element_field_->GetDataType();
+  std::string iterator = little_endian ? "Iterator<kLittleEndian>" : "Iterator<!kLittleEndian>";
+  std::string lazy_array =
+      "LazyArray<" + element_type + ", " + (little_endian ? "kLittleEndian" : "!kLittleEndian") + ">";
+
+  s << lazy_array << " " << GetGetterFunctionName() << "Lazy() const {";
+  s << "ASSERT(was_validated_);";
+  s << "size_t end_index = size();";
+  s << "auto to_bound = begin();";
+  int num_leading_bits = GenBounds(s, start_offset, end_offset, GetSize());
+  s << "std::optional<size_t> count;";
+  if (size_field_ != nullptr && size_field_->GetFieldType() == CountField::kFieldType) {
+    s << "count = Get" << util::UnderscoreToCamelCase(size_field_->GetName()) << "();";
+  }
+  s << "return " << lazy_array << "(" << GetName() << "_it, count, ";
+  s << (element_size_.empty() ? 0 : element_size_.bytes()) << ", ";
+  s << "[](" << element_type << "* " << element_field_->GetName() << "_ptr, " << iterator << "* it) {";
+  s << "auto " << element_field_->GetName() << "_it = *it;";
+  element_field_->GenExtractor(s, num_leading_bits, false);
+  s << "*it = " << element_field_->GetName() << "_it;";
+  s << "return " << element_field_->GetName() << "_ptr != nullptr;";
+  s << "});";
+  s << "}\n";
+}
+
 std::string VectorField::GetBuilderParameterType() const {
   std::stringstream ss;
   if (element_field_->BuilderParameterMustBeMoved()) {
@@ -45,6 +45,12 @@ class VectorField : public PacketField {
 
   virtual void GenGetter(std::ostream& s, Size start_offset, Size end_offset) const override;
 
+  // Whether GenLazyGetter supports the type of the elements
+  bool HasLazyGetter() const;
+
+  // Generate a getter returning a LazyArray which parses the elements while iterating over them
+  void GenLazyGetter(std::ostream& s, Size start_offset, Size end_offset, bool little_endian) const;
+
   virtual std::string GetBuilderParameterType() const override;
 
   virtual bool BuilderParameterMustBeMoved() const override;
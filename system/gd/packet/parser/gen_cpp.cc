@@ -55,7 +55,8 @@ bool generate_cpp_headers_one_file(
     const std::filesystem::path& input_file,
     const std::filesystem::path& include_dir,
     const std::filesystem::path& out_dir,
-    const std::string& root_namespace) {
+    const std::string& root_namespace,
+    bool generate_lazy_arrays) {
   auto gen_relative_path = input_file.lexically_relative(include_dir).parent_path();
 
   auto input_filename = input_file.filename().string().substr(0, input_file.filename().string().find(".pdl"));
@@ -83,6 +84,7 @@ bool generate_cpp_headers_one_file(
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>
 
 #include "os/log.h"
 #include "packet/base_packet_builder.h"
@@ -101,6 +103,10 @@ bool generate_cpp_headers_one_file(
 
 )";
 
+  if (generate_lazy_arrays) {
+    out_file << "#include \"packet/lazy_array.h\"\n";
+  }
+
   for (const auto& c : decls.type_defs_queue_) {
     if (c.second->GetDefinitionType() == TypeDef::Type::CUSTOM ||
         c.second->GetDefinitionType() == TypeDef::Type::CHECKSUM) {
@@ -141,6 +147,10 @@ using ::bluetooth::packet::parser::ChecksumTypeChecker;
 
 )";
 
+  if (generate_lazy_arrays) {
+    out_file << "using ::bluetooth::packet::LazyArray;\n\n";
+  }
+
   for (const auto& e : decls.type_defs_queue_) {
     if (e.second->GetDefinitionType() == TypeDef::Type::ENUM) {
       const auto* enum_def = static_cast<const EnumDef*>(e.second);
@@ -193,7 +203,7 @@ using ::bluetooth::packet::parser::ChecksumTypeChecker;
   }
 
   for (const auto& packet_def : decls.packet_defs_queue_) {
-    packet_def.second->GenParserDefinition(out_file);
+    packet_def.second->GenParserDefinition(out_file, generate_lazy_arrays);
     out_file << "\n\n";
   }
 
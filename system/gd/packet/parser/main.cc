@@ -42,7 +42,8 @@ bool generate_cpp_headers_one_file(
     const std::filesystem::path& input_file,
     const std::filesystem::path& include_dir,
     const std::filesystem::path& out_dir,
-    const std::string& root_namespace);
+    const std::string& root_namespace,
+    bool generate_lazy_arrays);
 
 bool generate_pybind11_sources_one_file(
     const Declarations& decls,
@@ -123,6 +124,9 @@ void usage(const char* prog) {
 
   ofs << std::setw(24) << "--num_shards= ";
   ofs << "Number of shards per output pybind11 cc file." << std::endl;
+
+  ofs << std::setw(24) << "--lazy_arrays ";
+  ofs << "Also generate getters parsing array fields lazily while iterating." << std::endl;
 }
 
 int main(int argc, const char** argv) {
@@ -134,6 +138,7 @@ int main(int argc, const char** argv) {
   // Number of shards per output pybind11 cc file
   size_t num_shards = 1;
   bool generate_rust = false;
+  bool generate_lazy_arrays = false;
   std::queue<std::filesystem::path> input_files;
 
   const std::string arg_out = "--out=";
@@ -142,6 +147,7 @@ int main(int argc, const char** argv) {
   const std::string arg_num_shards = "--num_shards=";
   const std::string arg_rust = "--rust";
   const std::string arg_source_root = "--source_root=";
+  const std::string arg_lazy_arrays = "--lazy_arrays";
 
   // Parse the source root first (if it exists) since it will be used for other
   // paths.
@@ -164,6 +170,8 @@ int main(int argc, const char** argv) {
       num_shards = std::stoul(arg.substr(arg_num_shards.size()));
     } else if (arg.find(arg_rust) == 0) {
       generate_rust = true;
+    } else if (arg.find(arg_lazy_arrays) == 0) {
+      generate_lazy_arrays = true;
     } else if (arg.find(arg_source_root) == 0) {
       // Do nothing (just don't treat it as input_files)
     } else {
@@ -192,7 +200,8 @@ int main(int argc, const char** argv) {
       }
     } else {
       std::cout << "generating c++ and pybind11" << std::endl;
-      if (!generate_cpp_headers_one_file(declarations, input_files.front(), include_dir, out_dir, root_namespace)) {
+      if (!generate_cpp_headers_one_file(
+              declarations, input_files.front(), include_dir, out_dir, root_namespace, generate_lazy_arrays)) {
         std::cerr << "Didn't generate cpp headers for " << input_files.front() << std::endl;
         return 3;
       }
@@ -31,7 +31,7 @@ PacketField* PacketDef::GetNewField(const std::string&, ParseLocation) const {
   return nullptr;  // Packets can't be fields
 }
 
-void PacketDef::GenParserDefinition(std::ostream& s) const {
+void PacketDef::GenParserDefinition(std::ostream& s, bool generate_lazy_arrays) const {
   s << "class " << name_ << "View";
   if (parent_ != nullptr) {
     s << " : public " << parent_->name_ << "View {";
@@ -62,6 +62,10 @@ void PacketDef::GenParserDefinition(std::ostream& s) const {
   for (const auto& field : public_fields) {
     GenParserFieldGetter(s, field);
     s << "\n";
+    if (generate_lazy_arrays && field->GetFieldType() == VectorField::kFieldType) {
+      GenParserLazyArrayGetter(s, static_cast<const VectorField*>(field));
+      s << "\n";
+    }
   }
   GenValidator(s);
   s << "\n";
@@ -164,6 +168,15 @@ void PacketDef::GenParserFieldGetter(std::ostream& s, const PacketField* field)
   field->GenGetter(s, start_field_offset, end_field_offset);
 }
 
+void PacketDef::GenParserLazyArrayGetter(std::ostream& s, const VectorField* field) const {
+  if (!field->HasLazyGetter()) {
+    return;
+  }
+  auto start_field_offset = GetOffsetForField(field->GetName(), false);
+  auto end_field_offset = GetOffsetForField(field->GetName(), true);
+  field->GenLazyGetter(s, start_field_offset, end_field_offset, is_little_endian_);
+}
+
 TypeDef::Type PacketDef::GetDefinitionType() const {
   return TypeDef::Type::PACKET;
 }
@@ -31,7 +31,8 @@ class PacketDef : public ParentDef {
 
   PacketField* GetNewField(const std::string& name, ParseLocation loc) const;
 
-  void GenParserDefinition(std::ostream& s) const;
+  // generate_lazy_arrays adds a getter returning a LazyArray for each array field
+  void GenParserDefinition(std::ostream& s, bool generate_lazy_arrays = false) const;
 
   void GenTestingParserFromBytes(std::ostream& s) const;
 
@@ -39,6 +40,8 @@ class PacketDef : public ParentDef {
 
   void GenParserFieldGetter(std::ostream& s, const PacketField* field) const;
 
+  void GenParserLazyArrayGetter(std::ostream& s, const VectorField* field) const;
+
   void GenValidator(std::ostream& s) const;
 
   void GenParserToString(std::ostream& s) const;
@@ -534,6 +534,18 @@ vector<uint8_t> count_array_enum{
 };
 }
 
+TEST(GeneratedPacketTest, testEnumNames) {
+  static_assert(IsForArraysValid(ForArrays::TWO_THREE));
+  static_assert(!IsForArraysValid(static_cast<ForArrays>(0x0003)));
+  static_assert(IsTwoBitsValid(TwoBits::ZERO));
+  ASSERT_STREQ("FFFF", ForArraysName(ForArrays::FFFF));
+  ASSERT_EQ(nullptr, ForArraysName(static_cast<ForArrays>(0x0000)));
+  ASSERT_STREQ("LAZY_ME", FourBitsName(FourBits::LAZY_ME));
+  ASSERT_EQ(nullptr, FourBitsName(static_cast<FourBits>(4)));
+  ASSERT_EQ("ONE_TWO", ForArraysText(ForArrays::ONE_TWO));
+  ASSERT_EQ("Unknown FourBits: 4", FourBitsText(static_cast<FourBits>(4)));
+}
+
 TEST(GeneratedPacketTest, testCountArrayEnum) {
   std::vector<ForArrays> count_array{{ForArrays::ONE, ForArrays::TWO_THREE, ForArrays::FFFF}};
   auto packet = CountArrayEnumBuilder::Create(count_array);
@@ -870,6 +882,20 @@ TEST(GeneratedPacketTest, testCountArrayVariableLengthMissingData) {
   }
 }
 
+TEST(GeneratedPacketTest, testCountArrayVariableLengthLazy) {
+  for (const auto& bytes : {count_array_variable, count_array_variable_extra, count_array_variable_too_few}) {
+    PacketView<kLittleEndian> packet_bytes_view(std::make_shared<std::vector<uint8_t>>(bytes));
+    auto view = CountArrayVariableView::Create(packet_bytes_view);
+    ASSERT_TRUE(view.IsValid());
+    auto array = view.GetVariableArray();
+    std::vector<Variable> lazy_array(view.GetVariableArrayLazy().begin(), view.GetVariableArrayLazy().end());
+    ASSERT_EQ(array.size(), lazy_array.size());
+    for (size_t i = 0; i < array.size(); i++) {
+      ASSERT_EQ(array[i].data, lazy_array[i].data);
+    }
+  }
+}
+
 vector<uint8_t> one_struct{
     0x01, 0x02, 0x03,  // id = 0x01, count = 0x0302
 };
@@ -983,6 +1009,15 @@ TEST(GeneratedPacketTest, testVectorOfStruct) {
     ASSERT_EQ(array[i].id_, copy_array[i].id_);
     ASSERT_EQ(array[i].count_, copy_array[i].count_);
   }
+
+  size_t index = 0;
+  for (const auto& element : view.GetArrayLazy()) {
+    ASSERT_LT(index, copy_array.size());
+    ASSERT_EQ(element.id_, copy_array[index].id_);
+    ASSERT_EQ(element.count_, copy_array[index].count_);
+    index++;
+  }
+  ASSERT_EQ(copy_array.size(), index);
 }
 
 TEST(GeneratedPacketTest, testArrayOfStruct) {
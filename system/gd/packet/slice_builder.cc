@@ -0,0 +1,55 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/slice_builder.h"
+
+#include <algorithm>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace packet {
+
+SliceBuilder::SliceBuilder(std::shared_ptr<const std::vector<uint8_t>> buffer, size_t begin, size_t end)
+    : buffer_(std::move(buffer)), begin_(begin), end_(end) {
+  ASSERT(buffer_ != nullptr);
+  ASSERT_LOG(begin_ <= end_ && end_ <= buffer_->size(), "invalid slice [%zu, %zu) of %zu bytes", begin_, end_,
+             buffer_->size());
+}
+
+std::vector<std::unique_ptr<SliceBuilder>> SliceBuilder::Split(const BasePacketBuilder& packet, size_t max_size) {
+  ASSERT(max_size > 0);
+  auto buffer = std::make_shared<std::vector<uint8_t>>(packet.size());
+  buffer->resize(packet.SerializeInto(buffer->data(), buffer->size()));
+
+  std::vector<std::unique_ptr<SliceBuilder>> slices;
+  slices.reserve((buffer->size() + max_size - 1) / max_size);
+  for (size_t begin = 0; begin < buffer->size(); begin += max_size) {
+    slices.push_back(std::make_unique<SliceBuilder>(buffer, begin, std::min(begin + max_size, buffer->size())));
+  }
+  return slices;
+}
+
+size_t SliceBuilder::size() const {
+  return end_ - begin_;
+}
+
+void SliceBuilder::Serialize(BitInserter& it) const {
+  it.insert_bytes(buffer_->data() + begin_, size());
+}
+
+}  // namespace packet
+}  // namespace bluetooth
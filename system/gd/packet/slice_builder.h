@@ -0,0 +1,50 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "packet/bit_inserter.h"
+#include "packet/packet_builder.h"
+
+namespace bluetooth {
+namespace packet {
+
+// Builder serializing the bytes [begin, end) of a buffer shared with other builders. Fragments of a serialized packet
+// reference its buffer instead of each holding a copy of their bytes.
+class SliceBuilder : public PacketBuilder<true> {
+ public:
+  SliceBuilder(std::shared_ptr<const std::vector<uint8_t>> buffer, size_t begin, size_t end);
+  virtual ~SliceBuilder() = default;
+
+  // Serialize packet once and return consecutive slices of at most max_size bytes of the result
+  static std::vector<std::unique_ptr<SliceBuilder>> Split(const BasePacketBuilder& packet, size_t max_size);
+
+  virtual size_t size() const override;
+
+  virtual void Serialize(BitInserter& it) const override;
+
+ private:
+  std::shared_ptr<const std::vector<uint8_t>> buffer_;
+  size_t begin_;
+  size_t end_;
+};
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/slice_builder.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace packet {
+
+TEST(SliceBuilderTest, serializeSlices) {
+  auto buffer = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{0x00, 0x01, 0x02, 0x03, 0x04});
+  SliceBuilder first(buffer, 0, 2);
+  SliceBuilder second(buffer, 2, 5);
+  SliceBuilder empty(buffer, 5, 5);
+  ASSERT_EQ(2u, first.size());
+  ASSERT_EQ(3u, second.size());
+  ASSERT_EQ(0u, empty.size());
+
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  second.Serialize(it);
+  empty.Serialize(it);
+  first.Serialize(it);
+  ASSERT_EQ(std::vector<uint8_t>({0x02, 0x03, 0x04, 0x00, 0x01}), bytes);
+}
+
+TEST(SliceBuilderTest, slicesShareTheBuffer) {
+  auto buffer = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{0x00, 0x01, 0x02, 0x03});
+  auto slice = std::make_unique<SliceBuilder>(buffer, 1, 3);
+  ASSERT_EQ(2, buffer.use_count());
+  std::weak_ptr<const std::vector<uint8_t>> weak_buffer = buffer;
+  buffer.reset();
+
+  // The slice keeps the buffer alive until it is serialized
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  slice->Serialize(it);
+  ASSERT_EQ(std::vector<uint8_t>({0x01, 0x02}), bytes);
+  slice.reset();
+  ASSERT_TRUE(weak_buffer.expired());
+}
+
+TEST(SliceBuilderTest, splitPacket) {
+  RawBuilder packet(std::vector<uint8_t>{0x00, 0x01, 0x02, 0x03, 0x04});
+  auto slices = SliceBuilder::Split(packet, 2);
+  ASSERT_EQ(3u, slices.size());
+
+  std::vector<std::vector<uint8_t>> fragments;
+  for (const auto& slice : slices) {
+    std::vector<uint8_t> bytes;
+    BitInserter it(bytes);
+    slice->Serialize(it);
+    fragments.push_back(bytes);
+  }
+  ASSERT_EQ(std::vector<uint8_t>({0x00, 0x01}), fragments[0]);
+  ASSERT_EQ(std::vector<uint8_t>({0x02, 0x03}), fragments[1]);
+  ASSERT_EQ(std::vector<uint8_t>({0x04}), fragments[2]);
+
+  ASSERT_TRUE(SliceBuilder::Split(RawBuilder(), 2).empty());
+}
+
+}  // namespace packet
+}  // namespace bluetooth
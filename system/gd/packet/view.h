@@ -35,6 +35,9 @@ class View {
 
   size_t size() const;
 
+  // Return a pointer to the first byte of this view; the size() bytes of a view are contiguous
+  const uint8_t* data() const;
+
  private:
   std::shared_ptr<const std::vector<uint8_t>> data_;
   size_t begin_;
@@ -10,7 +10,9 @@ use bt_topshim::profiles::gatt::GattStatus;
 use btstack::bluetooth::{
     BluetoothDevice, IBluetooth, IBluetoothCallback, IBluetoothConnectionCallback,
 };
-use btstack::bluetooth_gatt::{BluetoothGattService, IBluetoothGattCallback, LePhy};
+use btstack::bluetooth_gatt::{
+    BluetoothGattService, GattNotification, IBluetoothGattCallback, LePhy,
+};
 use btstack::suspend::ISuspendCallback;
 use btstack::RPCProxy;
 use dbus::nonblock::SyncConnection;
@@ -410,6 +412,12 @@ impl IBluetoothGattCallback for BtGattCallback {
         print_info!("GATT Notification: addr = {}, handle = {}, value = {:?}", addr, handle, value);
     }
 
+    fn on_notify_batch(&self, addr: String, notifications: Vec<GattNotification>) {
+        for notification in notifications {
+            self.on_notify(addr.clone(), notification.handle, notification.value);
+        }
+    }
+
     fn on_read_remote_rssi(&self, addr: String, rssi: i32, status: i32) {
         print_info!("Remote RSSI read: addr = {}, rssi = {}, status = {}", addr, rssi, status);
     }
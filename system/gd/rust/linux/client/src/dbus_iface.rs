@@ -7,7 +7,7 @@ use btstack::bluetooth::{
     BluetoothDevice, IBluetooth, IBluetoothCallback, IBluetoothConnectionCallback,
 };
 use btstack::bluetooth_gatt::{
-    BluetoothGattCharacteristic, BluetoothGattDescriptor, BluetoothGattService,
+    BluetoothGattCharacteristic, BluetoothGattDescriptor, BluetoothGattService, GattNotification,
     GattWriteRequestStatus, GattWriteType, IBluetoothGatt, IBluetoothGattCallback,
     IScannerCallback, LePhy, ScanFilter, ScanSettings,
 };
@@ -94,6 +94,12 @@ pub struct BluetoothGattServiceDBus {
     pub included_services: Vec<BluetoothGattService>,
 }
 
+#[dbus_propmap(GattNotification)]
+pub struct GattNotificationDBus {
+    handle: i32,
+    value: Vec<u8>,
+}
+
 #[dbus_propmap(BluetoothDevice)]
 pub struct BluetoothDeviceDBus {
     address: String,
@@ -703,6 +709,11 @@ impl IBluetoothGatt for BluetoothGattDBus {
         dbus_generated!()
     }
 
+    #[dbus_method("SetNotificationBatching")]
+    fn set_notification_batching(&mut self, client_id: i32, enable: bool) {
+        dbus_generated!()
+    }
+
     #[dbus_method("BeginReliableWrite")]
     fn begin_reliable_write(&mut self, client_id: i32, addr: String) {
         dbus_generated!()
@@ -801,6 +812,9 @@ impl IBluetoothGattCallback for IBluetoothGattCallbackDBus {
     #[dbus_method("OnNotify")]
     fn on_notify(&self, addr: String, handle: i32, value: Vec<u8>) {}
 
+    #[dbus_method("OnNotifyBatch")]
+    fn on_notify_batch(&self, addr: String, notifications: Vec<GattNotification>) {}
+
     #[dbus_method("OnReadRemoteRssi")]
     fn on_read_remote_rssi(&self, addr: String, rssi: i32, status: i32) {}
 
@@ -1,7 +1,7 @@
 use bt_topshim::{btif::Uuid128Bit, profiles::gatt::GattStatus};
 
 use btstack::bluetooth_gatt::{
-    BluetoothGattCharacteristic, BluetoothGattDescriptor, BluetoothGattService,
+    BluetoothGattCharacteristic, BluetoothGattDescriptor, BluetoothGattService, GattNotification,
     GattWriteRequestStatus, GattWriteType, IBluetoothGatt, IBluetoothGattCallback,
     IScannerCallback, LePhy, RSSISettings, ScanFilter, ScanSettings, ScanType,
 };
@@ -90,6 +90,11 @@ impl IBluetoothGattCallback for BluetoothGattCallbackDBus {
         dbus_generated!()
     }
 
+    #[dbus_method("OnNotifyBatch")]
+    fn on_notify_batch(&self, addr: String, notifications: Vec<GattNotification>) {
+        dbus_generated!()
+    }
+
     #[dbus_method("OnReadRemoteRssi")]
     fn on_read_remote_rssi(&self, addr: String, rssi: i32, status: i32) {
         dbus_generated!()
@@ -174,6 +179,12 @@ pub struct BluetoothGattServiceDBus {
     included_services: Vec<BluetoothGattService>,
 }
 
+#[dbus_propmap(GattNotification)]
+pub struct GattNotificationDBus {
+    handle: i32,
+    value: Vec<u8>,
+}
+
 #[dbus_propmap(RSSISettings)]
 pub struct RSSISettingsDBus {
     low_threshold: i32,
@@ -340,6 +351,11 @@ impl IBluetoothGatt for IBluetoothGattDBus {
         dbus_generated!()
     }
 
+    #[dbus_method("SetNotificationBatching")]
+    fn set_notification_batching(&mut self, client_id: i32, enable: bool) {
+        dbus_generated!()
+    }
+
     #[dbus_method("BeginReliableWrite")]
     fn begin_reliable_write(&mut self, client_id: i32, addr: String) {
         dbus_generated!()
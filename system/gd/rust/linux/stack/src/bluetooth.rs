@@ -643,6 +643,18 @@ impl BtifBluetoothCallbacks for Bluetooth {
 
         // Update local property cache
         for prop in properties {
+            // Properties reported again with the same value are not sent to the clients.
+            let unchanged = match (&prop, self.properties.get(&prop.get_type())) {
+                (BluetoothProperty::BdName(new), Some(BluetoothProperty::BdName(old))) => {
+                    new == old
+                }
+                (
+                    BluetoothProperty::AdapterScanMode(new),
+                    Some(BluetoothProperty::AdapterScanMode(old)),
+                ) => new == old,
+                _ => false,
+            };
+
             match &prop {
                 BluetoothProperty::BdAddr(bdaddr) => {
                     self.update_local_address(&bdaddr);
@@ -665,12 +677,12 @@ impl BtifBluetoothCallbacks for Bluetooth {
                             ));
                     }
                 }
-                BluetoothProperty::BdName(bdname) => {
+                BluetoothProperty::BdName(bdname) if !unchanged => {
                     self.for_all_callbacks(|callback| {
                         callback.on_name_changed(bdname.clone());
                     });
                 }
-                BluetoothProperty::AdapterScanMode(mode) => {
+                BluetoothProperty::AdapterScanMode(mode) if !unchanged => {
                     self.for_all_callbacks(|callback| {
                         callback
                             .on_discoverable_changed(*mode == BtScanMode::ConnectableDiscoverable);
@@ -687,9 +699,14 @@ impl BtifBluetoothCallbacks for Bluetooth {
         let device = BluetoothDevice::from_properties(&properties);
         let address = device.address.clone();
 
+        // A device found again is only sent to the clients if its name or address changed.
+        let mut changed = true;
         if let Some(existing) = self.found_devices.get_mut(&address) {
+            let previous = existing.info.clone();
             existing.update_properties(properties);
             existing.seen();
+            changed =
+                existing.info.name != previous.name || existing.info.address != previous.address;
         } else {
             let device_with_props = BluetoothDeviceContext::new(
                 BtBondState::NotBonded,
@@ -701,6 +718,10 @@ impl BtifBluetoothCallbacks for Bluetooth {
             self.found_devices.insert(address.clone(), device_with_props);
         }
 
+        if !changed {
+            return;
+        }
+
         let device = self.found_devices.get(&address).unwrap();
 
         self.for_all_callbacks(|callback| {
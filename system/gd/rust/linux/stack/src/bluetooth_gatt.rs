@@ -13,9 +13,10 @@ use bt_topshim::topstack;
 
 use log::{debug, warn};
 use num_traits::cast::{FromPrimitive, ToPrimitive};
-use std::collections::HashSet;
+use std::collections::{HashMap, HashSet};
 use std::sync::{Arc, Mutex};
 use tokio::sync::mpsc::Sender;
+use tokio::time::{self, Duration};
 
 use crate::{Message, RPCProxy};
 
@@ -27,6 +28,9 @@ struct Client {
 
     // Queued on_characteristic_write callback.
     congestion_queue: Vec<(String, i32, i32)>,
+
+    // Whether notifications are delivered with on_notify_batch.
+    batch_notifications: bool,
 }
 
 struct Connection {
@@ -95,6 +99,7 @@ impl ContextMap {
             callback,
             is_congested: false,
             congestion_queue: vec![],
+            batch_notifications: false,
         });
     }
 
@@ -232,6 +237,10 @@ pub trait IBluetoothGatt {
     /// Registers to receive notifications or indications for a given characteristic.
     fn register_for_notification(&self, client_id: i32, addr: String, handle: i32, enable: bool);
 
+    /// Delivers the notifications and indications of a client with on_notify_batch, at most
+    /// once per connection every `NOTIFY_BATCH_PERIOD`, instead of one on_notify each.
+    fn set_notification_batching(&mut self, client_id: i32, enable: bool);
+
     /// Begins reliable write.
     fn begin_reliable_write(&mut self, client_id: i32, addr: String);
 
@@ -317,6 +326,13 @@ impl BluetoothGattCharacteristic {
     }
 }
 
+#[derive(Debug, Default)]
+/// Represents a notification or indication of a GATT characteristic.
+pub struct GattNotification {
+    pub handle: i32,
+    pub value: Vec<u8>,
+}
+
 #[derive(Debug, Default)]
 /// Represents a GATT Service.
 pub struct BluetoothGattService {
@@ -380,6 +396,10 @@ pub trait IBluetoothGattCallback: RPCProxy {
     /// When notification or indication is received.
     fn on_notify(&self, addr: String, handle: i32, value: Vec<u8>);
 
+    /// When notifications or indications are received, in the order they were received, if
+    /// enabled with IBluetoothGatt::set_notification_batching.
+    fn on_notify_batch(&self, addr: String, notifications: Vec<GattNotification>);
+
     /// The completion of IBluetoothGatt::read_remote_rssi.
     fn on_read_remote_rssi(&self, addr: String, rssi: i32, status: i32);
 
@@ -479,12 +499,22 @@ pub struct ScanSettings {
 pub struct ScanFilter {}
 
 /// Implementation of the GATT API (IBluetoothGatt).
+/// Time during which the notifications of a connection are gathered into one batch.
+const NOTIFY_BATCH_PERIOD: Duration = Duration::from_millis(20);
+
+/// Number of notifications after which a batch is delivered without waiting.
+const NOTIFY_BATCH_MAX_SIZE: usize = 64;
+
 pub struct BluetoothGatt {
     intf: Arc<Mutex<BluetoothInterface>>,
     gatt: Option<Gatt>,
+    tx: Option<Sender<Message>>,
 
     context_map: ContextMap,
     reliable_queue: HashSet<String>,
+
+    // Notifications waiting for their batch to be delivered, by connection id.
+    pending_notifications: HashMap<i32, Vec<GattNotification>>,
 }
 
 impl BluetoothGatt {
@@ -493,12 +523,15 @@ impl BluetoothGatt {
         BluetoothGatt {
             intf: intf,
             gatt: None,
+            tx: None,
             context_map: ContextMap::new(),
             reliable_queue: HashSet::new(),
+            pending_notifications: HashMap::new(),
         }
     }
 
     pub fn init_profiles(&mut self, tx: Sender<Message>) {
+        self.tx = Some(tx.clone());
         self.gatt = Gatt::new(&self.intf.lock().unwrap());
         self.gatt.as_mut().unwrap().initialize(
             GattClientCallbacksDispatcher {
@@ -522,6 +555,20 @@ impl BluetoothGatt {
             },
         );
     }
+
+    /// Delivers the pending notifications of a connection in one on_notify_batch.
+    pub fn flush_notifications(&mut self, conn_id: i32) {
+        let notifications = match self.pending_notifications.remove(&conn_id) {
+            Some(notifications) if !notifications.is_empty() => notifications,
+            _ => return,
+        };
+
+        let address = self.context_map.get_address_by_conn_id(conn_id);
+        let client = self.context_map.get_client_by_conn_id(conn_id);
+        if let (Some(address), Some(client)) = (address, client) {
+            client.callback.on_notify_batch(address, notifications);
+        }
+    }
 }
 
 // Temporary util that covers only basic string conversion.
@@ -802,6 +849,12 @@ impl IBluetoothGatt for BluetoothGatt {
         );
     }
 
+    fn set_notification_batching(&mut self, client_id: i32, enable: bool) {
+        if let Some(client) = self.context_map.get_by_client_id_mut(client_id) {
+            client.batch_notifications = enable;
+        }
+    }
+
     fn register_for_notification(&self, client_id: i32, addr: String, handle: i32, enable: bool) {
         let conn_id = self.context_map.get_conn_id_from_address(client_id, &addr);
         if conn_id.is_none() {
@@ -1007,6 +1060,7 @@ impl BtifGattClientCallbacks for BluetoothGatt {
     }
 
     fn disconnect_cb(&mut self, conn_id: i32, status: i32, client_id: i32, addr: RawAddress) {
+        self.flush_notifications(conn_id);
         self.context_map.remove_connection(client_id, conn_id);
         let client = self.context_map.get_by_client_id(client_id);
         if client.is_none() {
@@ -1045,11 +1099,34 @@ impl BtifGattClientCallbacks for BluetoothGatt {
             return;
         }
 
-        client.unwrap().callback.on_notify(
-            RawAddress { val: data.bda.address }.to_string(),
-            data.handle as i32,
-            data.value[0..data.len as usize].to_vec(),
-        );
+        let client = client.unwrap();
+        if !client.batch_notifications {
+            client.callback.on_notify(
+                RawAddress { val: data.bda.address }.to_string(),
+                data.handle as i32,
+                data.value[0..data.len as usize].to_vec(),
+            );
+            return;
+        }
+
+        let pending = self.pending_notifications.entry(conn_id).or_insert_with(Vec::new);
+        if pending.is_empty() {
+            // First notification of the batch, deliver it at the end of the period.
+            if let Some(tx) = self.tx.clone() {
+                topstack::get_runtime().spawn(async move {
+                    time::sleep(NOTIFY_BATCH_PERIOD).await;
+                    let _ = tx.send(Message::GattNotifyBatch(conn_id)).await;
+                });
+            }
+        }
+        pending.push(GattNotification {
+            handle: data.handle as i32,
+            value: data.value[0..data.len as usize].to_vec(),
+        });
+
+        if pending.len() >= NOTIFY_BATCH_MAX_SIZE {
+            self.flush_notifications(conn_id);
+        }
     }
 
     fn read_characteristic_cb(&mut self, conn_id: i32, status: i32, data: BtGattReadParams) {
@@ -1429,6 +1506,8 @@ mod tests {
 
         fn on_notify(&self, _addr: String, _handle: i32, _value: Vec<u8>) {}
 
+        fn on_notify_batch(&self, _addr: String, _notifications: Vec<GattNotification>) {}
+
         fn on_read_remote_rssi(&self, _addr: String, _rssi: i32, _status: i32) {}
 
         fn on_configure_mtu(&self, _addr: String, _mtu: i32, _status: i32) {}
@@ -56,6 +56,9 @@ pub enum Message {
     // Update list of found devices and remove old instances.
     DeviceFreshnessCheck,
 
+    // Deliver the batch of GATT notifications of a connection.
+    GattNotifyBatch(i32),
+
     // Suspend related
     SuspendCallbackRegistered(u32),
     SuspendCallbackDisconnected(u32),
@@ -133,6 +136,10 @@ impl Stack {
                     bluetooth.lock().unwrap().trigger_freshness_check();
                 }
 
+                Message::GattNotifyBatch(conn_id) => {
+                    bluetooth_gatt.lock().unwrap().flush_notifications(conn_id);
+                }
+
                 Message::SuspendCallbackRegistered(id) => {
                     suspend.lock().unwrap().callback_registered(id);
                 }
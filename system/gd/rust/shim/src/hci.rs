@@ -37,7 +37,7 @@ pub fn hci_send_command(
     data: &[u8],
     callback: cxx::UniquePtr<ffi::u8SliceOnceCallback>,
 ) {
-    log::error!("sending command: {:02x?}", data);
+    log::debug!("sending command: {:02x?}", data);
     match CommandPacket::parse(data) {
         Ok(packet) => {
             let mut commands = hci.internal.commands.clone();
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "bind_helpers.h"
@@ -119,13 +120,12 @@ void BleAdvertiserIntf::SetParameters(uint8_t adv_id, RustAdvertiseParameters pa
 }
 
 void BleAdvertiserIntf::SetData(uint8_t adv_id, bool set_scan_rsp, ::rust::Vec<uint8_t> data) {
-  std::vector<uint8_t> converted;
-  std::copy(data.begin(), data.end(), std::back_inserter(converted));
+  std::vector<uint8_t> converted(data.begin(), data.end());
 
   adv_intf_->SetData(
       adv_id,
       set_scan_rsp,
-      converted,
+      std::move(converted),
       base::Bind(&BleAdvertiserIntf::OnIdStatusCallback, base::Unretained(this), adv_id));
 }
 
@@ -146,16 +146,15 @@ void BleAdvertiserIntf::StartAdvertising(
     ::rust::Vec<uint8_t> scan_response_data,
     int32_t timeout_in_sec) {
   AdvertiseParameters converted_params = internal::ConvertRustAdvParams(params);
-  std::vector<uint8_t> converted_adv_data, converted_scan_rsp_data;
-  std::copy(advertise_data.begin(), advertise_data.end(), std::back_inserter(converted_adv_data));
-  std::copy(scan_response_data.begin(), scan_response_data.end(), std::back_inserter(converted_scan_rsp_data));
+  std::vector<uint8_t> converted_adv_data(advertise_data.begin(), advertise_data.end());
+  std::vector<uint8_t> converted_scan_rsp_data(scan_response_data.begin(), scan_response_data.end());
 
   adv_intf_->StartAdvertising(
       adv_id,
       base::Bind(&BleAdvertiserIntf::OnIdStatusCallback, base::Unretained(this), adv_id),
       converted_params,
-      converted_adv_data,
-      converted_scan_rsp_data,
+      std::move(converted_adv_data),
+      std::move(converted_scan_rsp_data),
       timeout_in_sec,
       base::Bind(&BleAdvertiserIntf::OnIdStatusCallback, base::Unretained(this), adv_id));
 }
@@ -171,19 +170,18 @@ void BleAdvertiserIntf::StartAdvertisingSet(
     uint8_t max_ext_adv_events) {
   AdvertiseParameters converted_params = internal::ConvertRustAdvParams(params);
   PeriodicAdvertisingParameters converted_periodic_params = internal::ConvertRustPeriodicAdvParams(periodic_params);
-  std::vector<uint8_t> converted_adv_data, converted_scan_rsp_data, converted_periodic_data;
-  std::copy(advertise_data.begin(), advertise_data.end(), std::back_inserter(converted_adv_data));
-  std::copy(scan_response_data.begin(), scan_response_data.end(), std::back_inserter(converted_scan_rsp_data));
-  std::copy(periodic_data.begin(), periodic_data.end(), std::back_inserter(converted_periodic_data));
+  std::vector<uint8_t> converted_adv_data(advertise_data.begin(), advertise_data.end());
+  std::vector<uint8_t> converted_scan_rsp_data(scan_response_data.begin(), scan_response_data.end());
+  std::vector<uint8_t> converted_periodic_data(periodic_data.begin(), periodic_data.end());
 
   adv_intf_->StartAdvertisingSet(
       reg_id,
       base::Bind(&BleAdvertiserIntf::OnIdTxPowerStatusCallback, base::Unretained(this)),
       converted_params,
-      converted_adv_data,
-      converted_scan_rsp_data,
+      std::move(converted_adv_data),
+      std::move(converted_scan_rsp_data),
       converted_periodic_params,
-      converted_periodic_data,
+      std::move(converted_periodic_data),
       duration,
       max_ext_adv_events,
       base::Bind(&BleAdvertiserIntf::OnIdStatusCallback, base::Unretained(this)));
@@ -197,11 +195,10 @@ void BleAdvertiserIntf::SetPeriodicAdvertisingParameters(uint8_t adv_id, RustPer
 }
 
 void BleAdvertiserIntf::SetPeriodicAdvertisingData(uint8_t adv_id, ::rust::Vec<uint8_t> data) {
-  std::vector<uint8_t> converted;
-  std::copy(data.begin(), data.end(), std::back_inserter(converted));
+  std::vector<uint8_t> converted(data.begin(), data.end());
 
   adv_intf_->SetPeriodicAdvertisingData(
-      adv_id, converted, base::Bind(&BleAdvertiserIntf::OnIdStatusCallback, base::Unretained(this), adv_id));
+      adv_id, std::move(converted), base::Bind(&BleAdvertiserIntf::OnIdStatusCallback, base::Unretained(this), adv_id));
 }
 
 void BleAdvertiserIntf::SetPeriodicAdvertisingEnable(uint8_t adv_id, bool enable) {
@@ -1059,9 +1059,13 @@ pub fn get_btinterface() -> Option<BluetoothInterface> {
     ret
 }
 
-// Turns C-array T[] to Vec<U>.
+// Turns C-array T[] to Vec<U>. Going through a slice lets the byte arrays of
+// the packets and values be copied at once instead of element by element.
 pub(crate) fn ptr_to_vec<T: Copy, U: From<T>>(start: *const T, length: usize) -> Vec<U> {
-    unsafe { (0..length).map(|i| U::from(*start.offset(i as isize))).collect::<Vec<U>>() }
+    if start.is_null() || length == 0 {
+        return Vec::new();
+    }
+    unsafe { std::slice::from_raw_parts(start, length) }.iter().map(|v| U::from(*v)).collect()
 }
 
 #[cfg(test)]
@@ -1125,6 +1129,12 @@ mod tests {
         assert_eq!(expected, vec);
     }
 
+    #[test]
+    fn test_ptr_to_vec_null() {
+        let vec: Vec<u8> = ptr_to_vec(std::ptr::null::<u8>(), 3);
+        assert!(vec.is_empty());
+    }
+
     #[test]
     fn test_property_with_string_conversions() {
         {
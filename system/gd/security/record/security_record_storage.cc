@@ -17,6 +17,9 @@
  */
 #include "security/record/security_record_storage.h"
 
+#include <vector>
+
+#include "common/bind.h"
 #include "storage/mutation.h"
 
 namespace bluetooth {
@@ -91,10 +94,62 @@ void SetLeData(storage::Mutation& mutation, std::shared_ptr<record::SecurityReco
   }
 }
 
-void SetAuthenticationData(storage::Mutation& mutation, std::shared_ptr<record::SecurityRecord> record, storage::Device& device) {
-  device.SetIsAuthenticated((record->IsAuthenticated() ? 1 : 0));
-  device.SetIsEncryptionRequired((record->IsEncryptionRequired() ? 1 : 0));
-  device.SetRequiresMitmProtection(record->RequiresMitmProtection() ? 1 : 0);
+void SetAuthenticationData(
+    storage::Mutation& mutation, std::shared_ptr<record::SecurityRecord> record, storage::Device& device) {
+  mutation.Add(device.SetIsAuthenticated((record->IsAuthenticated() ? 1 : 0)));
+  mutation.Add(device.SetIsEncryptionRequired((record->IsEncryptionRequired() ? 1 : 0)));
+  mutation.Add(device.SetRequiresMitmProtection(record->RequiresMitmProtection() ? 1 : 0));
+}
+
+hci::DeviceType GetDeviceType(std::shared_ptr<record::SecurityRecord> record) {
+  if (record->IsClassicLinkKeyValid() && !record->identity_address_) {
+    return hci::DeviceType::BR_EDR;
+  } else if (record->IsClassicLinkKeyValid() && record->remote_ltk) {
+    return hci::DeviceType::DUAL;
+  } else if (!record->IsClassicLinkKeyValid() && record->remote_ltk) {
+    return hci::DeviceType::LE;
+  }
+  LOG_WARN(
+      "Cannot determine device type from security record for '%s'; defaulting to LE",
+      record->GetPseudoAddress()->ToString().c_str());
+  return hci::DeviceType::LE;
+}
+
+// Runs on the storage module handler. The keys of all the records are committed in one mutation. Only the device
+// types which are not stored yet are committed before, as the Classic() and Le() views of a device require its type.
+void WriteSecurityRecords(
+    storage::StorageModule* storage_module, std::vector<std::shared_ptr<record::SecurityRecord>> records) {
+  std::vector<storage::Device> devices;
+  devices.reserve(records.size());
+  auto type_mutation = storage_module->Modify();
+  bool has_new_types = false;
+  for (auto& record : records) {
+    devices.push_back(storage_module->GetDeviceByClassicMacAddress(record->GetPseudoAddress()->GetAddress()));
+    auto stored_type = devices.back().GetDeviceType();
+    auto type = GetDeviceType(record);
+    if (!stored_type || (*stored_type != type && *stored_type != hci::DeviceType::DUAL)) {
+      type_mutation.Add(devices.back().SetDeviceType(type));
+      has_new_types = true;
+    }
+  }
+  if (has_new_types) {
+    type_mutation.Commit();
+  }
+
+  auto mutation = storage_module->Modify();
+  for (size_t i = 0; i < records.size(); i++) {
+    SetClassicData(mutation, records[i], devices[i]);
+    SetLeData(mutation, records[i], devices[i]);
+    SetAuthenticationData(mutation, records[i], devices[i]);
+  }
+  mutation.Commit();
+}
+
+void RemoveStoredDevice(storage::StorageModule* storage_module, hci::AddressWithType address) {
+  storage::Device device = storage_module->GetDeviceByClassicMacAddress(address.GetAddress());
+  auto mutation = storage_module->Modify();
+  mutation.Add(device.RemoveFromConfig());
+  mutation.Commit();
 }
 }  // namespace
 
@@ -102,29 +157,15 @@ SecurityRecordStorage::SecurityRecordStorage(storage::StorageModule* storage_mod
     : storage_module_(storage_module), handler_(handler) {}
 
 void SecurityRecordStorage::SaveSecurityRecords(std::set<std::shared_ptr<record::SecurityRecord>>* records) {
+  std::vector<std::shared_ptr<record::SecurityRecord>> snapshot;
   for (auto record : *records) {
     if (record->IsTemporary()) continue;
-    storage::Device device = storage_module_->GetDeviceByClassicMacAddress(record->GetPseudoAddress()->GetAddress());
-    auto mutation = storage_module_->Modify();
-
-    if (record->IsClassicLinkKeyValid() && !record->identity_address_) {
-      mutation.Add(device.SetDeviceType(hci::DeviceType::BR_EDR));
-    } else if (record->IsClassicLinkKeyValid() && record->remote_ltk) {
-      mutation.Add(device.SetDeviceType(hci::DeviceType::DUAL));
-    } else if (!record->IsClassicLinkKeyValid() && record->remote_ltk) {
-      mutation.Add(device.SetDeviceType(hci::DeviceType::LE));
-    } else {
-      mutation.Add(device.SetDeviceType(hci::DeviceType::LE));
-      LOG_WARN(
-          "Cannot determine device type from security record for '%s'; defaulting to LE",
-          record->GetPseudoAddress()->ToString().c_str());
-    }
-    mutation.Commit();
-    SetClassicData(mutation, record, device);
-    SetLeData(mutation, record, device);
-    SetAuthenticationData(mutation, record, device);
-    mutation.Commit();
+    snapshot.push_back(std::make_shared<record::SecurityRecord>(*record));
+  }
+  if (snapshot.empty()) {
+    return;
   }
+  storage_module_->Post(common::BindOnce(&WriteSecurityRecords, storage_module_, std::move(snapshot)));
 }
 
 void SecurityRecordStorage::LoadSecurityRecords(std::set<std::shared_ptr<record::SecurityRecord>>* records) {
@@ -184,10 +225,7 @@ void SecurityRecordStorage::LoadSecurityRecords(std::set<std::shared_ptr<record:
 }
 
 void SecurityRecordStorage::RemoveDevice(hci::AddressWithType address) {
-  storage::Device device = storage_module_->GetDeviceByClassicMacAddress(address.GetAddress());
-  auto mutation = storage_module_->Modify();
-  mutation.Add(device.RemoveFromConfig());
-  mutation.Commit();
+  storage_module_->Post(common::BindOnce(&RemoveStoredDevice, storage_module_, address));
 }
 
 }  // namespace record
@@ -44,7 +44,8 @@ class SecurityRecordStorage {
   /**
    * Iterates through given vector and stores each record's metadata to disk.
    *
-   * <p>Job gets posted to the Handler.
+   * <p>The records are copied and the job gets posted to the storage module handler, where all their keys are
+   * committed in one mutation.
    *
    * @param records set of shared pointers to records.
    */
@@ -62,12 +63,14 @@ class SecurityRecordStorage {
   /**
    * Removes a device from the storage
    *
+   * <p>Job gets posted to the storage module handler, after the pending saves.
+   *
    * @param address of device to remove
    */
   void RemoveDevice(hci::AddressWithType address);
 
  private:
-  storage::StorageModule* storage_module_ __attribute__((unused));
+  storage::StorageModule* storage_module_;
   os::Handler* handler_ __attribute__((unused));
 };
 
@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <filesystem>
+
 #include "security/test/fake_storage_module.h"
 
 namespace bluetooth {
@@ -25,9 +27,12 @@ namespace security {
 namespace record {
 namespace {
 
-class DISABLED_SecurityRecordStorageTest : public ::testing::Test {
+class SecurityRecordStorageTest : public ::testing::Test {
  protected:
   void SetUp() override {
+    // Every test starts from an empty config, the devices saved by the previous ones are on disk
+    RemoveConfigFiles();
+
     // Make Fake storage module
     storage_module_ = new FakeStorageModule();
 
@@ -42,12 +47,20 @@ class DISABLED_SecurityRecordStorageTest : public ::testing::Test {
     synchronize();
     fake_registry_.StopAll();
     delete record_storage_;
+    RemoveConfigFiles();
   }
 
+  // The records are written on the storage module handler
   void synchronize() {
     fake_registry_.SynchronizeModuleHandler(&FakeStorageModule::Factory, std::chrono::milliseconds(20));
   }
 
+  void RemoveConfigFiles() {
+    for (auto path : {"/tmp/temp_config.txt", "/tmp/temp_config.bak", "/tmp/temp_config.journal"}) {
+      std::filesystem::remove(path);
+    }
+  }
+
   TestModuleRegistry fake_registry_;
   os::Thread& thread_ = fake_registry_.GetTestThread();
   os::Handler* handler_ = nullptr;
@@ -55,9 +68,9 @@ class DISABLED_SecurityRecordStorageTest : public ::testing::Test {
   record::SecurityRecordStorage* record_storage_;
 };
 
-TEST_F(DISABLED_SecurityRecordStorageTest, setup_teardown) {}
+TEST_F(SecurityRecordStorageTest, setup_teardown) {}
 
-TEST_F(DISABLED_SecurityRecordStorageTest, store_security_record) {
+TEST_F(SecurityRecordStorageTest, store_security_record) {
   hci::AddressWithType remote(
       hci::Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), hci::AddressType::PUBLIC_DEVICE_ADDRESS);
   std::array<uint8_t, 16> link_key = {
@@ -68,6 +81,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, store_security_record) {
   std::set<std::shared_ptr<record::SecurityRecord>> record_set;
   record_set.insert(record);
   record_storage_->SaveSecurityRecords(&record_set);
+  synchronize();
 
   auto device = storage_module_->GetDeviceByClassicMacAddress(remote.GetAddress());
   ASSERT_TRUE(device.GetDeviceType());
@@ -78,7 +92,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, store_security_record) {
   }
 }
 
-TEST_F(DISABLED_SecurityRecordStorageTest, store_le_security_record) {
+TEST_F(SecurityRecordStorageTest, store_le_security_record) {
   hci::AddressWithType identity_address(
       hci::Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), hci::AddressType::RANDOM_DEVICE_ADDRESS);
   std::array<uint8_t, 16> remote_ltk{
@@ -103,6 +117,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, store_le_security_record) {
   std::set<std::shared_ptr<record::SecurityRecord>> record_set;
   record_set.insert(record);
   record_storage_->SaveSecurityRecords(&record_set);
+  synchronize();
 
   auto device = storage_module_->GetDeviceByClassicMacAddress(identity_address.GetAddress());
   ASSERT_EQ(hci::DeviceType::LE, device.GetDeviceType());
@@ -118,7 +133,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, store_le_security_record) {
   ASSERT_EQ(device.Le().GetPeerSignatureResolvingKeys(), "000000000883ae44d6779e901d25cdd7b6f4578502");
 }
 
-TEST_F(DISABLED_SecurityRecordStorageTest, load_security_record) {
+TEST_F(SecurityRecordStorageTest, load_security_record) {
   hci::AddressWithType remote(
       hci::Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), hci::AddressType::PUBLIC_DEVICE_ADDRESS);
   std::array<uint8_t, 16> link_key = {
@@ -129,6 +144,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, load_security_record) {
   std::set<std::shared_ptr<record::SecurityRecord>> record_set;
   record_set.insert(record);
   record_storage_->SaveSecurityRecords(&record_set);
+  synchronize();
 
   auto device = storage_module_->GetDeviceByClassicMacAddress(remote.GetAddress());
   ASSERT_TRUE(device.GetDeviceType());
@@ -151,7 +167,29 @@ TEST_F(DISABLED_SecurityRecordStorageTest, load_security_record) {
   }
 }
 
-TEST_F(DISABLED_SecurityRecordStorageTest, dont_save_temporary_records) {
+TEST_F(SecurityRecordStorageTest, store_snapshot_of_records) {
+  hci::AddressWithType remote(
+      hci::Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), hci::AddressType::PUBLIC_DEVICE_ADDRESS);
+  std::array<uint8_t, 16> link_key = {
+      0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0};
+  std::shared_ptr<record::SecurityRecord> record = std::make_shared<record::SecurityRecord>(remote);
+
+  record->SetLinkKey(link_key, hci::KeyType::DEBUG_COMBINATION);
+  record->SetAuthenticated(true);
+  std::set<std::shared_ptr<record::SecurityRecord>> record_set;
+  record_set.insert(record);
+  record_storage_->SaveSecurityRecords(&record_set);
+  // Changes made after the save must not race with the write on the storage module handler
+  record->SetLinkKey(link_key, hci::KeyType::AUTHENTICATED_P256);
+  synchronize();
+
+  auto device = storage_module_->GetDeviceByClassicMacAddress(remote.GetAddress());
+  ASSERT_EQ(hci::DeviceType::BR_EDR, device.GetDeviceType());
+  ASSERT_EQ(hci::KeyType::DEBUG_COMBINATION, device.Classic().GetLinkKeyType());
+  ASSERT_EQ(1, device.GetIsAuthenticated());
+}
+
+TEST_F(SecurityRecordStorageTest, dont_save_temporary_records) {
   hci::AddressWithType remote(
       hci::Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), hci::AddressType::PUBLIC_DEVICE_ADDRESS);
   std::array<uint8_t, 16> link_key = {
@@ -163,6 +201,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, dont_save_temporary_records) {
   std::set<std::shared_ptr<record::SecurityRecord>> record_set;
   record_set.insert(record);
   record_storage_->SaveSecurityRecords(&record_set);
+  synchronize();
 
   auto device = storage_module_->GetDeviceByClassicMacAddress(remote.GetAddress());
   ASSERT_FALSE(device.GetDeviceType());
@@ -172,7 +211,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, dont_save_temporary_records) {
   ASSERT_EQ(record_set.size(), 0);
 }
 
-TEST_F(DISABLED_SecurityRecordStorageTest, test_remove) {
+TEST_F(SecurityRecordStorageTest, test_remove) {
   hci::AddressWithType remote(
       hci::Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), hci::AddressType::PUBLIC_DEVICE_ADDRESS);
   std::array<uint8_t, 16> link_key = {
@@ -183,6 +222,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, test_remove) {
   std::set<std::shared_ptr<record::SecurityRecord>> record_set;
   record_set.insert(record);
   record_storage_->SaveSecurityRecords(&record_set);
+  synchronize();
 
   auto device = storage_module_->GetDeviceByClassicMacAddress(remote.GetAddress());
   ASSERT_TRUE(device.GetDeviceType());
@@ -194,6 +234,7 @@ TEST_F(DISABLED_SecurityRecordStorageTest, test_remove) {
   }
 
   record_storage_->RemoveDevice(remote);
+  synchronize();
 
   record_set.clear();
   record_storage_->LoadSecurityRecords(&record_set);
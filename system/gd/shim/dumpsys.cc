@@ -17,8 +17,13 @@
 
 #include "dumpsys/dumpsys.h"
 
+#include <chrono>
+#include <condition_variable>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "dumpsys/filter.h"
 #include "module.h"
@@ -35,15 +40,18 @@ static const std::string kReadOnlyDebuggableProperty = "ro.debuggable";
 namespace {
 constexpr char kModuleName[] = "shim::Dumpsys";
 constexpr char kDumpsysTitle[] = "----- Gd Dumpsys ------";
+// Time given to the modules to provide their data; the modules which did not by then are skipped
+constexpr std::chrono::milliseconds kDumpsysTimeBudget = std::chrono::milliseconds(1000);
 }  // namespace
 
 struct Dumpsys::impl {
  public:
-  void DumpWithArgsSync(int fd, const char** args, std::promise<void> promise);
+  void DumpWithArgs(int fd, const char** args);
+  void DumpWithArgsAsync(int fd, const char** args, std::promise<void> promise);
   int GetNumberOfBundledSchemas() const;
 
   impl(const Dumpsys& dumpsys_module, const dumpsys::ReflectionSchema& reflection_schema);
-  ~impl() = default;
+  ~impl();
 
  protected:
   void FilterAsUser(std::string* dumpsys_data);
@@ -53,17 +61,37 @@ struct Dumpsys::impl {
   bool IsDebuggable() const;
 
  private:
-  void DumpWithArgsAsync(int fd, const char** args);
+  void WriteSection(int fd, std::string* dumpsys_data);
 
   const Dumpsys& dumpsys_module_;
   const dumpsys::ReflectionSchema reflection_schema_;
+  const dumpsys::PrivacyFilter developer_filter_;
+  const dumpsys::PrivacyFilter user_filter_;
+
+  // Deserialized from the reflection schema by the first dump, for printing every following dump
+  mutable std::once_flag json_parser_once_;
+  mutable std::unique_ptr<flatbuffers::Parser> json_parser_;
+  mutable std::string json_parser_error_;
+
+  // Asynchronous dumps run on their own thread, and must be done before the module stops
+  std::mutex dumps_mutex_;
+  std::condition_variable dumps_cv_;
+  int pending_dumps_{0};
 };
 
 const ModuleFactory Dumpsys::Factory =
     ModuleFactory([]() { return new Dumpsys(bluetooth::dumpsys::GetBundledSchemaData()); });
 
 Dumpsys::impl::impl(const Dumpsys& dumpsys_module, const dumpsys::ReflectionSchema& reflection_schema)
-    : dumpsys_module_(dumpsys_module), reflection_schema_(std::move(reflection_schema)) {}
+    : dumpsys_module_(dumpsys_module),
+      reflection_schema_(std::move(reflection_schema)),
+      developer_filter_(dumpsys::FilterType::AS_DEVELOPER, reflection_schema_),
+      user_filter_(dumpsys::FilterType::AS_USER, reflection_schema_) {}
+
+Dumpsys::impl::~impl() {
+  std::unique_lock<std::mutex> lock(dumps_mutex_);
+  dumps_cv_.wait(lock, [this]() { return pending_dumps_ == 0; });
+}
 
 int Dumpsys::impl::GetNumberOfBundledSchemas() const {
   return reflection_schema_.GetNumberOfBundledSchemas();
@@ -75,65 +103,105 @@ bool Dumpsys::impl::IsDebuggable() const {
 
 void Dumpsys::impl::FilterAsDeveloper(std::string* dumpsys_data) {
   ASSERT(dumpsys_data != nullptr);
-  dumpsys::FilterInPlace(dumpsys::FilterType::AS_DEVELOPER, reflection_schema_, dumpsys_data);
+  developer_filter_.FilterInPlace(dumpsys_data);
 }
 
 void Dumpsys::impl::FilterAsUser(std::string* dumpsys_data) {
   ASSERT(dumpsys_data != nullptr);
-  dumpsys::FilterInPlace(dumpsys::FilterType::AS_USER, reflection_schema_, dumpsys_data);
+  user_filter_.FilterInPlace(dumpsys_data);
 }
 
 std::string Dumpsys::impl::PrintAsJson(std::string* dumpsys_data) const {
   ASSERT(dumpsys_data != nullptr);
 
-  const std::string root_name = reflection_schema_.GetRootName();
-  if (root_name.empty()) {
+  std::call_once(json_parser_once_, [this]() {
     char buf[255];
-    snprintf(buf, sizeof(buf), "ERROR: Unable to find root name in prebundled reflection schema\n");
-    LOG_WARN("%s", buf);
-    return std::string(buf);
-  }
-
-  const reflection::Schema* schema = reflection_schema_.FindInReflectionSchema(root_name);
-  if (schema == nullptr) {
-    char buf[255];
-    snprintf(buf, sizeof(buf), "ERROR: Unable to find schema root name:%s\n", root_name.c_str());
-    LOG_WARN("%s", buf);
-    return std::string(buf);
-  }
-
-  flatbuffers::IDLOptions options{};
-  options.output_default_scalars_in_json = true;
-  flatbuffers::Parser parser{options};
-  if (!parser.Deserialize(schema)) {
-    char buf[255];
-    snprintf(buf, sizeof(buf), "ERROR: Unable to deserialize bundle root name:%s\n", root_name.c_str());
-    LOG_WARN("%s", buf);
-    return std::string(buf);
+    const std::string root_name = reflection_schema_.GetRootName();
+    if (root_name.empty()) {
+      snprintf(buf, sizeof(buf), "ERROR: Unable to find root name in prebundled reflection schema\n");
+      LOG_WARN("%s", buf);
+      json_parser_error_ = buf;
+      return;
+    }
+
+    const reflection::Schema* schema = reflection_schema_.FindInReflectionSchema(root_name);
+    if (schema == nullptr) {
+      snprintf(buf, sizeof(buf), "ERROR: Unable to find schema root name:%s\n", root_name.c_str());
+      LOG_WARN("%s", buf);
+      json_parser_error_ = buf;
+      return;
+    }
+
+    flatbuffers::IDLOptions options{};
+    options.output_default_scalars_in_json = true;
+    auto parser = std::make_unique<flatbuffers::Parser>(options);
+    if (!parser->Deserialize(schema)) {
+      snprintf(buf, sizeof(buf), "ERROR: Unable to deserialize bundle root name:%s\n", root_name.c_str());
+      LOG_WARN("%s", buf);
+      json_parser_error_ = buf;
+      return;
+    }
+    json_parser_ = std::move(parser);
+  });
+
+  if (json_parser_ == nullptr) {
+    return json_parser_error_;
   }
 
   std::string jsongen;
-  flatbuffers::GenerateText(parser, dumpsys_data->data(), &jsongen);
+  flatbuffers::GenerateText(*json_parser_, dumpsys_data->data(), &jsongen);
   return jsongen;
 }
 
-void Dumpsys::impl::DumpWithArgsAsync(int fd, const char** args) {
+void Dumpsys::impl::WriteSection(int fd, std::string* dumpsys_data) {
+  FilterAsDeveloper(dumpsys_data);
+  if (dumpsys_data->empty()) {
+    return;
+  }
+  dprintf(fd, "%s", PrintAsJson(dumpsys_data).c_str());
+}
+
+void Dumpsys::impl::DumpWithArgs(int fd, const char** args) {
   ParsedDumpsysArgs parsed_dumpsys_args(args);
   const auto registry = dumpsys_module_.GetModuleRegistry();
 
   ModuleDumper dumper(*registry, kDumpsysTitle);
-  std::string dumpsys_data;
-  dumper.DumpState(&dumpsys_data);
+  // The modules are dumped on their own handlers while the common state is written out, and each module is written
+  // out as soon as it is dumped
+  auto modules_data = dumper.DumpModulesAsync();
+  const auto deadline = std::chrono::steady_clock::now() + kDumpsysTimeBudget;
 
   dprintf(fd, " ----- Filtering as Developer -----\n");
-  FilterAsDeveloper(&dumpsys_data);
-
-  dprintf(fd, "%s", PrintAsJson(&dumpsys_data).c_str());
+  std::string dumpsys_data;
+  dumper.DumpCommonState(&dumpsys_data);
+  WriteSection(fd, &dumpsys_data);
+
+  for (auto& module_data : modules_data) {
+    if (!module_data->WaitUntil(deadline)) {
+      dprintf(
+          fd,
+          "%s: skipped, not dumped within %lld ms\n",
+          module_data->GetName().c_str(),
+          static_cast<long long>(kDumpsysTimeBudget.count()));
+      continue;
+    }
+    WriteSection(fd, module_data->GetData());
+  }
 }
 
-void Dumpsys::impl::DumpWithArgsSync(int fd, const char** args, std::promise<void> promise) {
-  DumpWithArgsAsync(fd, args);
-  promise.set_value();
+void Dumpsys::impl::DumpWithArgsAsync(int fd, const char** args, std::promise<void> promise) {
+  {
+    std::lock_guard<std::mutex> lock(dumps_mutex_);
+    pending_dumps_++;
+  }
+  // The dump waits for the module handlers, so it must not run on one of them
+  std::thread([this, fd, args, promise = std::move(promise)]() mutable {
+    DumpWithArgs(fd, args);
+    promise.set_value();
+    std::lock_guard<std::mutex> lock(dumps_mutex_);
+    pending_dumps_--;
+    dumps_cv_.notify_all();
+  }).detach();
 }
 
 Dumpsys::Dumpsys(const std::string& pre_bundled_schema)
@@ -143,10 +211,7 @@ void Dumpsys::Dump(int fd, const char** args) {
   if (fd <= 0) {
     return;
   }
-  std::promise<void> promise;
-  auto future = promise.get_future();
-  CallOn(pimpl_.get(), &Dumpsys::impl::DumpWithArgsSync, fd, args, std::move(promise));
-  future.get();
+  pimpl_->DumpWithArgs(fd, args);
 }
 
 void Dumpsys::Dump(int fd, const char** args, std::promise<void> promise) {
@@ -154,7 +219,7 @@ void Dumpsys::Dump(int fd, const char** args, std::promise<void> promise) {
     promise.set_value();
     return;
   }
-  CallOn(pimpl_.get(), &Dumpsys::impl::DumpWithArgsSync, fd, args, std::move(promise));
+  pimpl_->DumpWithArgsAsync(fd, args, std::move(promise));
 }
 
 os::Handler* Dumpsys::GetGdShimHandler() {
@@ -25,6 +25,7 @@
 #include "module.h"
 #include "os/handler.h"
 #include "os/log.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "os/wakelock_manager.h"
 
@@ -58,7 +59,13 @@ void StackManager::StartUp(ModuleList* modules, Thread* stack_thread) {
 }
 
 void StackManager::handle_start_up(ModuleList* modules, Thread* stack_thread, std::promise<void> promise) {
-  registry_.Start(modules, stack_thread);
+  // Modules which do not depend on each other may start concurrently on this many threads
+  auto start_workers = os::GetSystemPropertyUint32("bluetooth.gd.module_start_workers", 1);
+  if (start_workers > 1) {
+    registry_.StartParallel(modules, stack_thread, start_workers);
+  } else {
+    registry_.Start(modules, stack_thread);
+  }
   promise.set_value();
 }
 
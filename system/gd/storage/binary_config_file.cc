@@ -0,0 +1,456 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/binary_config_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "os/files.h"
+#include "os/log.h"
+#include "storage/device.h"
+#include "storage/legacy_config_file.h"
+
+namespace bluetooth {
+namespace storage {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x46435442;  // "BTCF"
+constexpr uint32_t kVersion = 1;
+
+// Word offsets of the header fields
+enum HeaderWord : size_t {
+  MAGIC,
+  VERSION,
+  FILE_SIZE,
+  SECTION_COUNT,
+  PROPERTY_COUNT,
+  SECTIONS_OFFSET,
+  SORTED_SECTIONS_OFFSET,
+  PROPERTIES_OFFSET,
+  SORTED_PROPERTIES_OFFSET,
+  STRINGS_OFFSET,
+  STRINGS_SIZE,
+  HEADER_WORD_COUNT,
+};
+
+constexpr size_t kWordSize = 4;
+constexpr size_t kHeaderSize = HEADER_WORD_COUNT * kWordSize;
+constexpr size_t kSectionSize = 4 * kWordSize;
+constexpr size_t kPropertySize = 4 * kWordSize;
+
+struct Section {
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> properties;
+};
+
+void PutWord(std::string* out, size_t offset, uint32_t word) {
+  for (size_t i = 0; i < kWordSize; i++) {
+    (*out)[offset + i] = static_cast<char>((word >> (8 * i)) & 0xff);
+  }
+}
+
+// Strings are stored once, as many properties share the same names and values
+class StringTable {
+ public:
+  uint32_t Add(const std::string& string) {
+    auto it = offsets_.find(string);
+    if (it != offsets_.end()) {
+      return it->second;
+    }
+    uint32_t offset = table_.size();
+    table_.append(string);
+    offsets_.emplace(string, offset);
+    return offset;
+  }
+  const std::string& Table() const {
+    return table_;
+  }
+
+ private:
+  std::string table_;
+  std::unordered_map<std::string, uint32_t> offsets_;
+};
+
+std::string Build(const std::vector<Section>& sections) {
+  size_t property_count = 0;
+  for (const auto& section : sections) {
+    property_count += section.properties.size();
+  }
+  size_t sections_offset = kHeaderSize;
+  size_t sorted_sections_offset = sections_offset + sections.size() * kSectionSize;
+  size_t properties_offset = sorted_sections_offset + sections.size() * kWordSize;
+  size_t sorted_properties_offset = properties_offset + property_count * kPropertySize;
+  size_t strings_offset = sorted_properties_offset + property_count * kWordSize;
+
+  std::string out(strings_offset, '\0');
+  StringTable strings;
+  std::vector<uint32_t> sorted_sections(sections.size());
+  size_t property = 0;
+  for (size_t i = 0; i < sections.size(); i++) {
+    const auto& section = sections[i];
+    size_t entry = sections_offset + i * kSectionSize;
+    PutWord(&out, entry, strings.Add(section.name));
+    PutWord(&out, entry + kWordSize, section.name.size());
+    PutWord(&out, entry + 2 * kWordSize, property);
+    PutWord(&out, entry + 3 * kWordSize, section.properties.size());
+    std::vector<uint32_t> sorted_properties(section.properties.size());
+    for (size_t j = 0; j < section.properties.size(); j++) {
+      const auto& [name, value] = section.properties[j];
+      size_t property_entry = properties_offset + (property + j) * kPropertySize;
+      PutWord(&out, property_entry, strings.Add(name));
+      PutWord(&out, property_entry + kWordSize, name.size());
+      PutWord(&out, property_entry + 2 * kWordSize, strings.Add(value));
+      PutWord(&out, property_entry + 3 * kWordSize, value.size());
+      sorted_properties[j] = property + j;
+    }
+    std::sort(sorted_properties.begin(), sorted_properties.end(), [&](uint32_t a, uint32_t b) {
+      return section.properties[a - property].first < section.properties[b - property].first;
+    });
+    for (size_t j = 0; j < sorted_properties.size(); j++) {
+      PutWord(&out, sorted_properties_offset + (property + j) * kWordSize, sorted_properties[j]);
+    }
+    property += section.properties.size();
+    sorted_sections[i] = i;
+  }
+  std::sort(sorted_sections.begin(), sorted_sections.end(), [&](uint32_t a, uint32_t b) {
+    return sections[a].name < sections[b].name;
+  });
+  for (size_t i = 0; i < sorted_sections.size(); i++) {
+    PutWord(&out, sorted_sections_offset + i * kWordSize, sorted_sections[i]);
+  }
+
+  out.append(strings.Table());
+  PutWord(&out, MAGIC * kWordSize, kMagic);
+  PutWord(&out, VERSION * kWordSize, kVersion);
+  PutWord(&out, FILE_SIZE * kWordSize, out.size());
+  PutWord(&out, SECTION_COUNT * kWordSize, sections.size());
+  PutWord(&out, PROPERTY_COUNT * kWordSize, property_count);
+  PutWord(&out, SECTIONS_OFFSET * kWordSize, sections_offset);
+  PutWord(&out, SORTED_SECTIONS_OFFSET * kWordSize, sorted_sections_offset);
+  PutWord(&out, PROPERTIES_OFFSET * kWordSize, properties_offset);
+  PutWord(&out, SORTED_PROPERTIES_OFFSET * kWordSize, sorted_properties_offset);
+  PutWord(&out, STRINGS_OFFSET * kWordSize, strings_offset);
+  PutWord(&out, STRINGS_SIZE * kWordSize, strings.Table().size());
+  return out;
+}
+
+}  // namespace
+
+std::optional<BinaryConfigView> BinaryConfigView::Parse(std::string_view data) {
+  BinaryConfigView view(data);
+  if (data.size() < kHeaderSize || view.Word(MAGIC * kWordSize) != kMagic) {
+    LOG_WARN("not a binary config");
+    return std::nullopt;
+  }
+  if (view.Word(VERSION * kWordSize) != kVersion) {
+    LOG_WARN("unsupported binary config version %u", view.Word(VERSION * kWordSize));
+    return std::nullopt;
+  }
+  if (view.Word(FILE_SIZE * kWordSize) != data.size()) {
+    LOG_WARN("binary config of %zu bytes instead of %u", data.size(), view.Word(FILE_SIZE * kWordSize));
+    return std::nullopt;
+  }
+  // The tables must follow each other, which also bounds them by the size of the file
+  uint64_t section_count = view.Word(SECTION_COUNT * kWordSize);
+  uint64_t property_count = view.Word(PROPERTY_COUNT * kWordSize);
+  uint64_t sections_offset = kHeaderSize;
+  uint64_t sorted_sections_offset = sections_offset + section_count * kSectionSize;
+  uint64_t properties_offset = sorted_sections_offset + section_count * kWordSize;
+  uint64_t sorted_properties_offset = properties_offset + property_count * kPropertySize;
+  uint64_t strings_offset = sorted_properties_offset + property_count * kWordSize;
+  if (view.Word(SECTIONS_OFFSET * kWordSize) != sections_offset ||
+      view.Word(SORTED_SECTIONS_OFFSET * kWordSize) != sorted_sections_offset ||
+      view.Word(PROPERTIES_OFFSET * kWordSize) != properties_offset ||
+      view.Word(SORTED_PROPERTIES_OFFSET * kWordSize) != sorted_properties_offset ||
+      view.Word(STRINGS_OFFSET * kWordSize) != strings_offset ||
+      strings_offset + view.Word(STRINGS_SIZE * kWordSize) != data.size()) {
+    LOG_WARN("malformed binary config header");
+    return std::nullopt;
+  }
+  view.section_count_ = section_count;
+  view.sections_offset_ = sections_offset;
+  view.sorted_sections_offset_ = sorted_sections_offset;
+  view.properties_offset_ = properties_offset;
+  view.sorted_properties_offset_ = sorted_properties_offset;
+  view.strings_offset_ = strings_offset;
+
+  uint64_t strings_size = data.size() - strings_offset;
+  auto is_string_valid = [&](size_t word_offset) {
+    return static_cast<uint64_t>(view.Word(word_offset)) + view.Word(word_offset + kWordSize) <= strings_size;
+  };
+  uint64_t next_property = 0;
+  for (size_t i = 0; i < section_count; i++) {
+    size_t entry = sections_offset + i * kSectionSize;
+    if (!is_string_valid(entry) || view.Word(entry + 2 * kWordSize) != next_property) {
+      LOG_WARN("malformed binary config section %zu", i);
+      return std::nullopt;
+    }
+    uint64_t first = next_property;
+    next_property += view.Word(entry + 3 * kWordSize);
+    if (next_property > property_count) {
+      LOG_WARN("malformed binary config section %zu", i);
+      return std::nullopt;
+    }
+    for (uint64_t p = first; p < next_property; p++) {
+      size_t property_entry = properties_offset + p * kPropertySize;
+      uint32_t sorted = view.Word(sorted_properties_offset + p * kWordSize);
+      if (!is_string_valid(property_entry) || !is_string_valid(property_entry + 2 * kWordSize) || sorted < first ||
+          sorted >= next_property) {
+        LOG_WARN("malformed binary config property %" PRIu64, p);
+        return std::nullopt;
+      }
+    }
+    // Strictly increasing names make the binary search exact
+    for (uint64_t p = first + 1; p < next_property; p++) {
+      uint32_t previous = view.Word(sorted_properties_offset + (p - 1) * kWordSize);
+      uint32_t current = view.Word(sorted_properties_offset + p * kWordSize);
+      if (!(view.PropertyName(previous) < view.PropertyName(current))) {
+        LOG_WARN("unsorted binary config properties in section %zu", i);
+        return std::nullopt;
+      }
+    }
+  }
+  if (next_property != property_count) {
+    LOG_WARN("malformed binary config property count");
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < section_count; i++) {
+    uint32_t current = view.Word(sorted_sections_offset + i * kWordSize);
+    if (current >= section_count) {
+      LOG_WARN("malformed binary config sorted section %zu", i);
+      return std::nullopt;
+    }
+    if (i > 0 && !(view.GetSectionName(view.Word(sorted_sections_offset + (i - 1) * kWordSize)) <
+                   view.GetSectionName(current))) {
+      LOG_WARN("unsorted binary config sections");
+      return std::nullopt;
+    }
+  }
+  return view;
+}
+
+uint32_t BinaryConfigView::Word(size_t offset) const {
+  uint32_t word = 0;
+  for (size_t i = 0; i < kWordSize; i++) {
+    word |= static_cast<uint32_t>(static_cast<uint8_t>(data_[offset + i])) << (8 * i);
+  }
+  return word;
+}
+
+std::string_view BinaryConfigView::String(size_t word_offset) const {
+  return data_.substr(strings_offset_ + Word(word_offset), Word(word_offset + kWordSize));
+}
+
+std::string_view BinaryConfigView::GetSectionName(size_t section_index) const {
+  ASSERT(section_index < section_count_);
+  return String(sections_offset_ + section_index * kSectionSize);
+}
+
+size_t BinaryConfigView::GetPropertyCount(size_t section_index) const {
+  ASSERT(section_index < section_count_);
+  return Word(sections_offset_ + section_index * kSectionSize + 3 * kWordSize);
+}
+
+std::pair<std::string_view, std::string_view> BinaryConfigView::GetProperty(
+    size_t section_index, size_t property_index) const {
+  ASSERT(property_index < GetPropertyCount(section_index));
+  size_t property = Word(sections_offset_ + section_index * kSectionSize + 2 * kWordSize) + property_index;
+  return {PropertyName(property), String(properties_offset_ + property * kPropertySize + 2 * kWordSize)};
+}
+
+std::optional<size_t> BinaryConfigView::FindSection(std::string_view section) const {
+  size_t low = 0;
+  size_t high = section_count_;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    uint32_t index = Word(sorted_sections_offset_ + middle * kWordSize);
+    auto name = GetSectionName(index);
+    if (name == section) {
+      return index;
+    }
+    if (name < section) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> BinaryConfigView::GetProperty(
+    std::string_view section, std::string_view property) const {
+  auto section_index = FindSection(section);
+  if (!section_index) {
+    return std::nullopt;
+  }
+  size_t low = Word(sections_offset_ + *section_index * kSectionSize + 2 * kWordSize);
+  size_t high = low + GetPropertyCount(*section_index);
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    uint32_t index = Word(sorted_properties_offset_ + middle * kWordSize);
+    auto name = PropertyName(index);
+    if (name == property) {
+      return String(properties_offset_ + index * kPropertySize + 2 * kWordSize);
+    }
+    if (name < property) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return std::nullopt;
+}
+
+std::unique_ptr<MappedBinaryConfig> MappedBinaryConfig::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    LOG_ERROR("unable to open file '%s', error: %s", path.c_str(), strerror(errno));
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0) {
+    LOG_ERROR("unable to get size of file '%s', error: %s", path.c_str(), strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+  size_t size = file_stat.st_size;
+  void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid once the file is closed
+  close(fd);
+  if (address == MAP_FAILED) {
+    LOG_ERROR("unable to map file '%s', error: %s", path.c_str(), strerror(errno));
+    return nullptr;
+  }
+  auto view = BinaryConfigView::Parse(std::string_view(static_cast<const char*>(address), size));
+  if (!view) {
+    LOG_ERROR("malformed binary config file '%s'", path.c_str());
+    munmap(address, size);
+    return nullptr;
+  }
+  return std::unique_ptr<MappedBinaryConfig>(new MappedBinaryConfig(address, size, *view));
+}
+
+MappedBinaryConfig::~MappedBinaryConfig() {
+  munmap(address_, size_);
+}
+
+BinaryConfigFile::BinaryConfigFile(std::string path) : path_(std::move(path)) {
+  ASSERT(!path_.empty());
+}
+
+std::optional<ConfigCache> BinaryConfigFile::Read(size_t temp_devices_capacity) {
+  auto mapped = MappedBinaryConfig::Open(path_);
+  if (!mapped) {
+    return std::nullopt;
+  }
+  const auto& view = mapped->View();
+  ConfigCache cache(temp_devices_capacity, Device::kLinkKeyProperties);
+  for (size_t i = 0; i < view.GetSectionCount(); i++) {
+    std::string section(view.GetSectionName(i));
+    for (size_t j = 0; j < view.GetPropertyCount(i); j++) {
+      auto [property, value] = view.GetProperty(i, j);
+      cache.SetProperty(section, std::string(property), std::string(value));
+    }
+  }
+  return cache;
+}
+
+bool BinaryConfigFile::Write(const ConfigCache& cache) {
+  return os::WriteToFile(path_, Serialize(cache));
+}
+
+bool BinaryConfigFile::Delete() {
+  if (!os::FileExists(path_)) {
+    LOG_WARN("Config file at \"%s\" does not exist", path_.c_str());
+    return false;
+  }
+  return os::RemoveFile(path_);
+}
+
+std::string BinaryConfigFile::Serialize(const ConfigCache& cache) {
+  std::vector<Section> sections;
+  cache.ForEachPersistentSection(
+      [&sections](const std::string& name, const common::ListMap<std::string, std::string>& properties) {
+        Section section{.name = name};
+        section.properties.reserve(properties.size());
+        for (const auto& property : properties) {
+          section.properties.emplace_back(property.first, property.second);
+        }
+        sections.push_back(std::move(section));
+      });
+  return Build(sections);
+}
+
+std::optional<std::string> BinaryConfigFile::FromLegacyFormat(const std::string& legacy) {
+  // Sections and properties read again replace the previous value in place, as when loading a ConfigCache
+  std::vector<Section> sections;
+  std::unordered_map<std::string, size_t> section_indexes;
+  std::vector<std::unordered_map<std::string, size_t>> property_indexes;
+  std::istringstream input(legacy);
+  bool parsed =
+      LegacyConfigFile::Parse(input, [&](const std::string& section, std::string property, std::string value) {
+        auto [section_it, section_added] = section_indexes.try_emplace(section, sections.size());
+        if (section_added) {
+          sections.push_back(Section{.name = section});
+          property_indexes.emplace_back();
+        }
+        auto& properties = sections[section_it->second].properties;
+        auto [property_it, property_added] =
+            property_indexes[section_it->second].try_emplace(property, properties.size());
+        if (property_added) {
+          properties.emplace_back(std::move(property), std::move(value));
+        } else {
+          properties[property_it->second].second = std::move(value);
+        }
+      });
+  if (!parsed) {
+    return std::nullopt;
+  }
+  return Build(sections);
+}
+
+std::optional<std::string> BinaryConfigFile::ToLegacyFormat(std::string_view binary) {
+  auto view = BinaryConfigView::Parse(binary);
+  if (!view) {
+    return std::nullopt;
+  }
+  // Same layout as ConfigCache::SerializeToLegacyFormat()
+  std::string legacy;
+  for (size_t i = 0; i < view->GetSectionCount(); i++) {
+    legacy.append("[").append(view->GetSectionName(i)).append("]\n");
+    for (size_t j = 0; j < view->GetPropertyCount(i); j++) {
+      auto [property, value] = view->GetProperty(i, j);
+      legacy.append(property).append(" = ").append(value).append("\n");
+    }
+    legacy.append("\n");
+  }
+  return legacy;
+}
+
+}  // namespace storage
+}  // namespace bluetooth
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "storage/config_cache.h"
+
+namespace bluetooth {
+namespace storage {
+
+// Read only access to a config in the binary format, queried in place without copying nor parsing its strings
+//
+// The format is made of little endian 32 bit words and of a table of strings:
+//   header: magic, version, file size, section count, property count and the offsets of the four tables below and of
+//           the string table, followed by its size
+//   sections: name offset, name length, first property and property count of each section, in file order
+//   sorted sections: indexes of the sections sorted by name
+//   properties: name offset, name length, value offset and value length of each property, sections after sections
+//   sorted properties: indexes of the properties of each section sorted by name, at the position of its properties
+class BinaryConfigView {
+ public:
+  // Return std::nullopt if |data| is not a well formed binary config. |data| must outlive the view.
+  static std::optional<BinaryConfigView> Parse(std::string_view data);
+
+  size_t GetSectionCount() const {
+    return section_count_;
+  }
+  // Sections and properties are indexed in file order
+  std::string_view GetSectionName(size_t section_index) const;
+  size_t GetPropertyCount(size_t section_index) const;
+  std::pair<std::string_view, std::string_view> GetProperty(size_t section_index, size_t property_index) const;
+
+  // Binary search a section or a property by name
+  std::optional<size_t> FindSection(std::string_view section) const;
+  bool HasSection(std::string_view section) const {
+    return FindSection(section).has_value();
+  }
+  std::optional<std::string_view> GetProperty(std::string_view section, std::string_view property) const;
+
+ private:
+  explicit BinaryConfigView(std::string_view data) : data_(data) {}
+  uint32_t Word(size_t offset) const;
+  std::string_view String(size_t word_offset) const;
+  std::string_view PropertyName(size_t property) const {
+    return String(properties_offset_ + property * 16);
+  }
+  std::string_view data_;
+  size_t section_count_ = 0;
+  size_t sections_offset_ = 0;
+  size_t sorted_sections_offset_ = 0;
+  size_t properties_offset_ = 0;
+  size_t sorted_properties_offset_ = 0;
+  size_t strings_offset_ = 0;
+};
+
+// A binary config file mapped in memory, for the lifetime of this object
+class MappedBinaryConfig {
+ public:
+  // Return nullptr if the file cannot be mapped or is not a well formed binary config
+  static std::unique_ptr<MappedBinaryConfig> Open(const std::string& path);
+  ~MappedBinaryConfig();
+  MappedBinaryConfig(const MappedBinaryConfig&) = delete;
+  MappedBinaryConfig& operator=(const MappedBinaryConfig&) = delete;
+
+  const BinaryConfigView& View() const {
+    return view_;
+  }
+
+ private:
+  MappedBinaryConfig(void* address, size_t size, BinaryConfigView view)
+      : address_(address), size_(size), view_(view) {}
+  void* address_;
+  size_t size_;
+  BinaryConfigView view_;
+};
+
+// Binary counterpart of LegacyConfigFile, loaded without parsing any text
+class BinaryConfigFile {
+ public:
+  static BinaryConfigFile FromPath(std::string path) {
+    return BinaryConfigFile(std::move(path));
+  }
+  explicit BinaryConfigFile(std::string path);
+  std::optional<ConfigCache> Read(size_t temp_devices_capacity);
+  bool Write(const ConfigCache& cache);
+  bool Delete();
+
+  static std::string Serialize(const ConfigCache& cache);
+  // Convert from and to the legacy format, keeping every section and property the legacy parser reads, in order,
+  // unpaired devices included. Return std::nullopt if the input is malformed.
+  static std::optional<std::string> FromLegacyFormat(const std::string& legacy);
+  static std::optional<std::string> ToLegacyFormat(std::string_view binary);
+
+ private:
+  std::string path_;
+};
+
+}  // namespace storage
+}  // namespace bluetooth
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/binary_config_file.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "os/files.h"
+#include "storage/device.h"
+
+namespace testing {
+
+using bluetooth::os::WriteToFile;
+using bluetooth::storage::BinaryConfigFile;
+using bluetooth::storage::BinaryConfigView;
+using bluetooth::storage::ConfigCache;
+using bluetooth::storage::Device;
+using bluetooth::storage::MappedBinaryConfig;
+
+static const std::string kLegacyConfig =
+    "[Info]\n"
+    "FileSource = Empty\n"
+    "TimeCreated = 2020-05-20 01:20:56\n"
+    "\n"
+    "# comments are not kept\n"
+    "[Adapter]\n"
+    "Address = 01:02:03:ab:cd:ef\n"
+    "ScanMode = 2\n"
+    "\n"
+    "[01:02:03:ab:cd:ea]\n"
+    "name = hello = world\n"
+    "LinkKey = fedcba0987654321fedcba0987654328\n"
+    "\n"
+    "[01:02:03:ab:cd:eb]\n"
+    "name = not paired\n"
+    "\n";
+
+TEST(BinaryConfigFileTest, legacy_format_loop_back_test) {
+  auto binary = BinaryConfigFile::FromLegacyFormat(kLegacyConfig);
+  ASSERT_TRUE(binary);
+  auto legacy = BinaryConfigFile::ToLegacyFormat(*binary);
+  ASSERT_TRUE(legacy);
+  EXPECT_EQ(
+      *legacy,
+      "[Info]\n"
+      "FileSource = Empty\n"
+      "TimeCreated = 2020-05-20 01:20:56\n"
+      "\n"
+      "[Adapter]\n"
+      "Address = 01:02:03:ab:cd:ef\n"
+      "ScanMode = 2\n"
+      "\n"
+      "[01:02:03:ab:cd:ea]\n"
+      "name = hello = world\n"
+      "LinkKey = fedcba0987654321fedcba0987654328\n"
+      "\n"
+      "[01:02:03:ab:cd:eb]\n"
+      "name = not paired\n"
+      "\n");
+  EXPECT_THAT(BinaryConfigFile::FromLegacyFormat(*legacy), Optional(StrEq(*binary)));
+}
+
+TEST(BinaryConfigFileTest, repeated_properties_replace_previous_ones_test) {
+  auto binary = BinaryConfigFile::FromLegacyFormat(
+      "[A]\n"
+      "B = 1\n"
+      "C = 2\n"
+      "[D]\n"
+      "E = 3\n"
+      "[A]\n"
+      "B = 4\n");
+  ASSERT_TRUE(binary);
+  EXPECT_THAT(
+      BinaryConfigFile::ToLegacyFormat(*binary),
+      Optional(StrEq("[A]\n"
+                     "B = 4\n"
+                     "C = 2\n"
+                     "\n"
+                     "[D]\n"
+                     "E = 3\n"
+                     "\n")));
+}
+
+TEST(BinaryConfigFileTest, malformed_input_test) {
+  EXPECT_FALSE(BinaryConfigFile::FromLegacyFormat("[A\nB = 1\n"));
+  EXPECT_FALSE(BinaryConfigFile::FromLegacyFormat("[A]\nB\n"));
+
+  auto binary = BinaryConfigFile::FromLegacyFormat(kLegacyConfig);
+  ASSERT_TRUE(binary);
+  EXPECT_FALSE(BinaryConfigView::Parse(""));
+  EXPECT_FALSE(BinaryConfigView::Parse(std::string_view(*binary).substr(0, binary->size() - 1)));
+  std::string unsupported_version = *binary;
+  unsupported_version[4] = 2;
+  EXPECT_FALSE(BinaryConfigView::Parse(unsupported_version));
+  // A string going past the end of the string table
+  std::string bad_string = *binary;
+  bad_string[44 + 4] = 0xff;
+  bad_string[44 + 5] = 0xff;
+  EXPECT_FALSE(BinaryConfigView::Parse(bad_string));
+}
+
+TEST(BinaryConfigFileTest, lookup_test) {
+  auto binary = BinaryConfigFile::FromLegacyFormat(kLegacyConfig);
+  ASSERT_TRUE(binary);
+  auto view = BinaryConfigView::Parse(*binary);
+  ASSERT_TRUE(view);
+  EXPECT_EQ(view->GetSectionCount(), 4u);
+  EXPECT_EQ(view->GetSectionName(2), "01:02:03:ab:cd:ea");
+  EXPECT_EQ(view->GetPropertyCount(2), 2u);
+  EXPECT_EQ(
+      view->GetProperty(2, 1),
+      std::make_pair(std::string_view("LinkKey"), std::string_view("fedcba0987654321fedcba0987654328")));
+  EXPECT_THAT(view->FindSection("Adapter"), Optional(1u));
+  EXPECT_FALSE(view->HasSection("Metrics"));
+  EXPECT_THAT(view->GetProperty("Adapter", "ScanMode"), Optional(Eq("2")));
+  EXPECT_THAT(view->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(Eq("hello = world")));
+  EXPECT_FALSE(view->GetProperty("Adapter", "Name"));
+  EXPECT_FALSE(view->GetProperty("Metrics", "ScanMode"));
+}
+
+TEST(BinaryConfigFileTest, write_and_read_loop_back_test) {
+  auto temp_config = std::filesystem::temp_directory_path() / "temp_config.bin";
+
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  config.SetProperty("A", "B", "C");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "B", "C");
+  config.SetProperty("CC:DD:EE:FF:00:11", "LinkKey", "AABBAABBCCDDEE");
+  config.SetProperty("CC:DD:EE:FF:00:11", "Name", "");
+  EXPECT_TRUE(BinaryConfigFile::FromPath(temp_config.string()).Write(config));
+
+  auto mapped = MappedBinaryConfig::Open(temp_config.string());
+  ASSERT_NE(mapped, nullptr);
+  EXPECT_THAT(mapped->View().GetProperty("CC:DD:EE:FF:00:11", "LinkKey"), Optional(Eq("AABBAABBCCDDEE")));
+  EXPECT_THAT(mapped->View().GetProperty("CC:DD:EE:FF:00:11", "Name"), Optional(Eq("")));
+  // Unpaired devices do not exist in persistent config file
+  EXPECT_FALSE(mapped->View().HasSection("AA:BB:CC:DD:EE:FF"));
+  mapped.reset();
+
+  auto config_read = BinaryConfigFile::FromPath(temp_config.string()).Read(100);
+  ASSERT_TRUE(config_read);
+  config.RemoveSection("AA:BB:CC:DD:EE:FF");
+  EXPECT_EQ(config, *config_read);
+  EXPECT_EQ(config.SerializeToLegacyFormat(), config_read->SerializeToLegacyFormat());
+
+  EXPECT_TRUE(BinaryConfigFile::FromPath(temp_config.string()).Delete());
+  EXPECT_EQ(MappedBinaryConfig::Open(temp_config.string()), nullptr);
+  EXPECT_FALSE(BinaryConfigFile::FromPath(temp_config.string()).Read(100));
+}
+
+TEST(BinaryConfigFileTest, read_malformed_file_test) {
+  auto temp_config = std::filesystem::temp_directory_path() / "temp_config.bin";
+  EXPECT_TRUE(WriteToFile(temp_config.string(), kLegacyConfig));
+  EXPECT_EQ(MappedBinaryConfig::Open(temp_config.string()), nullptr);
+  EXPECT_FALSE(BinaryConfigFile::FromPath(temp_config.string()).Read(100));
+  EXPECT_TRUE(std::filesystem::remove(temp_config));
+}
+
+}  // namespace testing
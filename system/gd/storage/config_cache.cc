@@ -16,8 +16,8 @@
 
 #include "storage/config_cache.h"
 
+#include <algorithm>
 #include <ios>
-#include <sstream>
 #include <utility>
 
 #include "hci/enum_helper.h"
@@ -56,7 +56,12 @@ const std::unordered_set<std::string_view> kClassicPropertyNames = {
 
 const std::string ConfigCache::kDefaultSectionName = "Global";
 
+const std::unordered_set<std::string_view> ConfigCache::kIndexedPropertyNames = {
+    "LeIdentityAddr", "LeLegacyPseudoAddr", "DevType"};
+
 std::string kEncryptedStr = "encrypted";
+// Common criteria config compare result when both the config file and its backup match their checksum
+constexpr int kConfigCompareAllPass = 0b11;
 
 ConfigCache::ConfigCache(size_t temp_device_capacity, std::unordered_set<std::string_view> persistent_property_names)
     : persistent_property_names_(std::move(persistent_property_names)),
@@ -69,14 +74,24 @@ void ConfigCache::SetPersistentConfigChangedCallback(std::function<void()> persi
   persistent_config_changed_callback_ = std::move(persistent_config_changed_callback);
 }
 
+void ConfigCache::SetPersistentChangeCallback(std::function<void(PersistentChange)> persistent_change_callback) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  persistent_change_callback_ = std::move(persistent_change_callback);
+}
+
 ConfigCache::ConfigCache(ConfigCache&& other) noexcept
     : persistent_config_changed_callback_(std::move(other.persistent_config_changed_callback_)),
+      persistent_change_callback_(std::move(other.persistent_change_callback_)),
       persistent_property_names_(std::move(other.persistent_property_names_)),
       information_sections_(std::move(other.information_sections_)),
       persistent_devices_(std::move(other.persistent_devices_)),
-      temporary_devices_(std::move(other.temporary_devices_)) {
+      temporary_devices_(std::move(other.temporary_devices_)),
+      property_index_(std::move(other.property_index_)),
+      parsed_values_(std::move(other.parsed_values_)),
+      serialized_sections_(std::move(other.serialized_sections_)) {
   // std::function will be in a valid but unspecified state after std::move(), hence resetting it
   other.persistent_config_changed_callback_ = {};
+  other.persistent_change_callback_ = {};
 }
 
 ConfigCache& ConfigCache::operator=(ConfigCache&& other) noexcept {
@@ -87,10 +102,15 @@ ConfigCache& ConfigCache::operator=(ConfigCache&& other) noexcept {
   std::lock_guard<std::recursive_mutex> others_lock(other.mutex_);
   persistent_config_changed_callback_.swap(other.persistent_config_changed_callback_);
   other.persistent_config_changed_callback_ = {};
+  persistent_change_callback_.swap(other.persistent_change_callback_);
+  other.persistent_change_callback_ = {};
   persistent_property_names_ = std::move(other.persistent_property_names_);
   information_sections_ = std::move(other.information_sections_);
   persistent_devices_ = std::move(other.persistent_devices_);
   temporary_devices_ = std::move(other.temporary_devices_);
+  property_index_ = std::move(other.property_index_);
+  parsed_values_ = std::move(other.parsed_values_);
+  serialized_sections_ = std::move(other.serialized_sections_);
   return *this;
 }
 
@@ -109,16 +129,25 @@ bool ConfigCache::operator!=(const ConfigCache& rhs) const {
 void ConfigCache::Clear() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (information_sections_.size() > 0) {
+    for (const auto& section : information_sections_) {
+      PersistentChangeCallback(MutationEntry::EntryType::REMOVE_SECTION, section.first);
+    }
     information_sections_.clear();
     PersistentConfigChangedCallback();
   }
   if (persistent_devices_.size() > 0) {
+    for (const auto& section : persistent_devices_) {
+      PersistentChangeCallback(MutationEntry::EntryType::REMOVE_SECTION, section.first);
+    }
     persistent_devices_.clear();
     PersistentConfigChangedCallback();
   }
   if (temporary_devices_.size() > 0) {
     temporary_devices_.clear();
   }
+  property_index_.clear();
+  parsed_values_.clear();
+  serialized_sections_.clear();
 }
 
 bool ConfigCache::HasSection(const std::string& section) const {
@@ -159,7 +188,13 @@ std::optional<std::string> ConfigCache::GetProperty(const std::string& section,
     if (property_iter != section_iter->second.end()) {
       std::string value = property_iter->second;
       if (os::ParameterProvider::GetBtKeystoreInterface() != nullptr && value == kEncryptedStr) {
-        return os::ParameterProvider::GetBtKeystoreInterface()->get_key(section + "-" + property);
+        // Keys are only fetched from the keystore when a device uses them
+        auto decrypted = os::ParameterProvider::GetBtKeystoreInterface()->get_key(section + "-" + property);
+        if (decrypted.empty()) {
+          LOG_WARN("%s of %s is not in the keystore", property.c_str(), section.c_str());
+          return std::nullopt;
+        }
+        return decrypted;
       }
       return value;
     }
@@ -186,6 +221,8 @@ void ConfigCache::SetProperty(std::string section, std::string property, std::st
     if (section_iter == information_sections_.end()) {
       section_iter = information_sections_.try_emplace_back(section, common::ListMap<std::string, std::string>{}).first;
     }
+    PersistentChangeCallback(MutationEntry::EntryType::SET, section, property, value);
+    OnPropertySet(section, section_iter->second, property, value);
     section_iter->second.insert_or_assign(property, std::move(value));
     PersistentConfigChangedCallback();
     return;
@@ -195,6 +232,11 @@ void ConfigCache::SetProperty(std::string section, std::string property, std::st
     // move paired devices or create new paired device when a link key is set
     auto section_properties = temporary_devices_.extract(section);
     if (section_properties) {
+      // the properties of the device become persistent with it
+      for (const auto& temporary_property : section_properties->second) {
+        PersistentChangeCallback(
+            MutationEntry::EntryType::SET, section, temporary_property.first, temporary_property.second);
+      }
       section_iter = persistent_devices_.try_emplace_back(section, std::move(section_properties->second)).first;
     } else {
       section_iter = persistent_devices_.try_emplace_back(section, common::ListMap<std::string, std::string>{}).first;
@@ -209,6 +251,8 @@ void ConfigCache::SetProperty(std::string section, std::string property, std::st
         value = kEncryptedStr;
       }
     }
+    PersistentChangeCallback(MutationEntry::EntryType::SET, section, property, value);
+    OnPropertySet(section, section_iter->second, property, value);
     section_iter->second.insert_or_assign(property, std::move(value));
     PersistentConfigChangedCallback();
     return;
@@ -217,19 +261,34 @@ void ConfigCache::SetProperty(std::string section, std::string property, std::st
   if (section_iter == temporary_devices_.end()) {
     auto triple = temporary_devices_.try_emplace(section, common::ListMap<std::string, std::string>{});
     section_iter = std::get<0>(triple);
+    auto& evicted = std::get<2>(triple);
+    if (evicted) {
+      OnSectionRemoved(evicted->first, evicted->second);
+    }
   }
+  OnPropertySet(section, section_iter->second, property, value);
   section_iter->second.insert_or_assign(property, std::move(value));
 }
 
 bool ConfigCache::RemoveSection(const std::string& section) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   // sections are unique among all three maps, hence removing from one of them is enough
-  if (information_sections_.extract(section) || persistent_devices_.extract(section)) {
+  auto properties = information_sections_.extract(section);
+  if (!properties) {
+    properties = persistent_devices_.extract(section);
+  }
+  if (properties) {
+    OnSectionRemoved(section, properties->second);
+    PersistentChangeCallback(MutationEntry::EntryType::REMOVE_SECTION, section);
     PersistentConfigChangedCallback();
     return true;
-  } else {
-    return temporary_devices_.extract(section).has_value();
   }
+  properties = temporary_devices_.extract(section);
+  if (properties) {
+    OnSectionRemoved(section, properties->second);
+    return true;
+  }
+  return false;
 }
 
 bool ConfigCache::RemoveProperty(const std::string& section, const std::string& property) {
@@ -237,11 +296,15 @@ bool ConfigCache::RemoveProperty(const std::string& section, const std::string&
   auto section_iter = information_sections_.find(section);
   if (section_iter != information_sections_.end()) {
     auto value = section_iter->second.extract(property);
+    if (value) {
+      OnPropertyRemoved(section, property, value->second);
+    }
     // if section is empty after removal, remove the whole section as empty section is not allowed
     if (section_iter->second.size() == 0) {
       information_sections_.erase(section_iter);
     }
     if (value.has_value()) {
+      PersistentChangeCallback(MutationEntry::EntryType::REMOVE_PROPERTY, section, property);
       PersistentConfigChangedCallback();
       return true;
     } else {
@@ -251,15 +314,28 @@ bool ConfigCache::RemoveProperty(const std::string& section, const std::string&
   section_iter = persistent_devices_.find(section);
   if (section_iter != persistent_devices_.end()) {
     auto value = section_iter->second.extract(property);
+    if (value) {
+      OnPropertyRemoved(section, property, value->second);
+    }
+    bool section_removed_from_disk = section_iter->second.size() == 0;
     // if section is empty after removal, remove the whole section as empty section is not allowed
     if (section_iter->second.size() == 0) {
       persistent_devices_.erase(section_iter);
     } else if (value && IsPersistentProperty(property)) {
       // move unpaired device
       auto section_properties = persistent_devices_.extract(section);
-      temporary_devices_.insert_or_assign(section, std::move(section_properties->second));
+      auto evicted = temporary_devices_.insert_or_assign(section, std::move(section_properties->second));
+      if (evicted) {
+        OnSectionRemoved(evicted->first, evicted->second);
+      }
+      section_removed_from_disk = true;
     }
     if (value.has_value()) {
+      if (section_removed_from_disk) {
+        PersistentChangeCallback(MutationEntry::EntryType::REMOVE_SECTION, section);
+      } else {
+        PersistentChangeCallback(MutationEntry::EntryType::REMOVE_PROPERTY, section, property);
+      }
       PersistentConfigChangedCallback();
       if (os::ParameterProvider::GetBtKeystoreInterface() != nullptr && os::ParameterProvider::IsCommonCriteriaMode() &&
           InEncryptKeyNameList(property)) {
@@ -273,6 +349,9 @@ bool ConfigCache::RemoveProperty(const std::string& section, const std::string&
   section_iter = temporary_devices_.find(section);
   if (section_iter != temporary_devices_.end()) {
     auto value = section_iter->second.extract(property);
+    if (value) {
+      OnPropertyRemoved(section, property, value->second);
+    }
     if (section_iter->second.size() == 0) {
       temporary_devices_.erase(section_iter);
     }
@@ -284,6 +363,7 @@ bool ConfigCache::RemoveProperty(const std::string& section, const std::string&
 void ConfigCache::ConvertEncryptOrDecryptKeyIfNeeded() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   LOG_INFO("%s", __func__);
+  bool is_config_trusted = os::ParameterProvider::GetCommonCriteriaConfigCompareResult() == kConfigCompareAllPass;
   auto persistent_sections = GetPersistentSections();
   for (const auto& section : persistent_sections) {
     auto section_iter = persistent_devices_.find(section);
@@ -298,9 +378,15 @@ void ConfigCache::ConvertEncryptOrDecryptKeyIfNeeded() {
             SetProperty(section, std::string(property), kEncryptedStr);
           }
         }
-        if (os::ParameterProvider::GetBtKeystoreInterface() != nullptr && is_encrypted) {
+        // Encrypted keys stay in the keystore in common criteria mode, GetProperty fetches each of them when its
+        // device authenticates. They are all fetched now only if the config files failed their checksum.
+        if (os::ParameterProvider::GetBtKeystoreInterface() != nullptr && is_encrypted &&
+            (!os::ParameterProvider::IsCommonCriteriaMode() || !is_config_trusted)) {
           std::string value_str =
               os::ParameterProvider::GetBtKeystoreInterface()->get_key(section + "-" + std::string(property));
+          if (value_str.empty()) {
+            LOG_WARN("%s of %s is not in the keystore", std::string(property).c_str(), section.c_str());
+          }
           if (!os::ParameterProvider::IsCommonCriteriaMode()) {
             SetProperty(section, std::string(property), value_str);
           }
@@ -318,6 +404,14 @@ bool ConfigCache::IsPersistentProperty(const std::string& property) const {
   return persistent_property_names_.find(property) != persistent_property_names_.end();
 }
 
+void ConfigCache::RemoveTemporaryDevices() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  for (const auto& section : temporary_devices_) {
+    OnSectionRemoved(section.first, section.second);
+  }
+  temporary_devices_.clear();
+}
+
 void ConfigCache::RemoveSectionWithProperty(const std::string& property) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   size_t num_persistent_removed = 0;
@@ -325,6 +419,8 @@ void ConfigCache::RemoveSectionWithProperty(const std::string& property) {
     for (auto it = config_section->begin(); it != config_section->end();) {
       if (it->second.contains(property)) {
         LOG_INFO("Removing persistent section %s with property %s", it->first.c_str(), property.c_str());
+        PersistentChangeCallback(MutationEntry::EntryType::REMOVE_SECTION, it->first);
+        OnSectionRemoved(it->first, it->second);
         it = config_section->erase(it);
         num_persistent_removed++;
         continue;
@@ -335,6 +431,7 @@ void ConfigCache::RemoveSectionWithProperty(const std::string& property) {
   for (auto it = temporary_devices_.begin(); it != temporary_devices_.end();) {
     if (it->second.contains(property)) {
       LOG_INFO("Removing temporary section %s with property %s", it->first.c_str(), property.c_str());
+      OnSectionRemoved(it->first, it->second);
       it = temporary_devices_.erase(it);
       continue;
     }
@@ -376,18 +473,52 @@ void ConfigCache::Commit(std::queue<MutationEntry>& mutation_entries) {
 }
 
 std::string ConfigCache::SerializeToLegacyFormat() const {
+  return GetPersistentSnapshot().SerializeToLegacyFormat();
+}
+
+std::string ConfigCache::PersistentSnapshot::SerializeToLegacyFormat() const {
+  size_t size = 0;
+  for (const auto& section : serialized_sections_) {
+    size += section->size();
+  }
+  std::string serialized;
+  serialized.reserve(size);
+  for (const auto& section : serialized_sections_) {
+    serialized.append(*section);
+  }
+  return serialized;
+}
+
+ConfigCache::PersistentSnapshot ConfigCache::GetPersistentSnapshot() const {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
-  std::stringstream serialized;
+  PersistentSnapshot snapshot;
+  snapshot.serialized_sections_.reserve(information_sections_.size() + persistent_devices_.size());
   for (const auto* config_section : {&information_sections_, &persistent_devices_}) {
     for (const auto& section : *config_section) {
-      serialized << "[" << section.first << "]" << std::endl;
-      for (const auto& property : section.second) {
-        serialized << property.first << " = " << property.second << std::endl;
+      auto& serialized = serialized_sections_[section.first];
+      if (serialized == nullptr) {
+        std::string text = "[" + section.first + "]\n";
+        for (const auto& property : section.second) {
+          text.append(property.first).append(" = ").append(property.second).append("\n");
+        }
+        text.append("\n");
+        serialized = std::make_shared<const std::string>(std::move(text));
       }
-      serialized << std::endl;
+      snapshot.serialized_sections_.push_back(serialized);
+    }
+  }
+  return snapshot;
+}
+
+void ConfigCache::ForEachPersistentSection(
+    const std::function<void(const std::string& section, const common::ListMap<std::string, std::string>& properties)>&
+        visitor) const {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  for (const auto* config_section : {&information_sections_, &persistent_devices_}) {
+    for (const auto& section : *config_section) {
+      visitor(section.first, section.second);
     }
   }
-  return serialized.str();
 }
 
 std::vector<ConfigCache::SectionAndPropertyValue> ConfigCache::GetSectionNamesWithProperty(
@@ -413,6 +544,120 @@ std::vector<ConfigCache::SectionAndPropertyValue> ConfigCache::GetSectionNamesWi
   return result;
 }
 
+std::vector<std::string> ConfigCache::GetSectionNamesWithPropertyValue(
+    const std::string& property, const std::string& value) const {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::vector<std::string> result;
+  if (kIndexedPropertyNames.find(property) == kIndexedPropertyNames.end()) {
+    for (auto& section_and_property : GetSectionNamesWithProperty(property)) {
+      if (section_and_property.property == value) {
+        result.push_back(std::move(section_and_property.section));
+      }
+    }
+    return result;
+  }
+  auto property_iter = property_index_.find(property);
+  if (property_iter == property_index_.end()) {
+    return result;
+  }
+  auto value_iter = property_iter->second.find(value);
+  if (value_iter == property_iter->second.end()) {
+    return result;
+  }
+  result.assign(value_iter->second.begin(), value_iter->second.end());
+  std::stable_partition(result.begin(), result.end(), [this](const std::string& section) {
+    return information_sections_.contains(section) || persistent_devices_.contains(section);
+  });
+  return result;
+}
+
+void ConfigCache::OnPropertySet(
+    const std::string& section,
+    const common::ListMap<std::string, std::string>& properties,
+    const std::string& property,
+    const std::string& value) {
+  InvalidateParsedProperty(section, property);
+  serialized_sections_.erase(section);
+  if (kIndexedPropertyNames.find(property) == kIndexedPropertyNames.end()) {
+    return;
+  }
+  auto old_value = properties.find(property);
+  if (old_value != properties.end()) {
+    UnindexProperty(section, property, old_value->second);
+  }
+  property_index_[property][value].insert(section);
+}
+
+void ConfigCache::OnPropertyRemoved(const std::string& section, const std::string& property, const std::string& value) {
+  InvalidateParsedProperty(section, property);
+  serialized_sections_.erase(section);
+  UnindexProperty(section, property, value);
+}
+
+void ConfigCache::OnSectionRemoved(
+    const std::string& section, const common::ListMap<std::string, std::string>& properties) {
+  parsed_values_.erase(section);
+  serialized_sections_.erase(section);
+  for (const auto& property : properties) {
+    UnindexProperty(section, property.first, property.second);
+  }
+}
+
+void ConfigCache::UnindexProperty(const std::string& section, const std::string& property, const std::string& value) {
+  auto property_iter = property_index_.find(property);
+  if (property_iter == property_index_.end()) {
+    return;
+  }
+  auto value_iter = property_iter->second.find(value);
+  if (value_iter == property_iter->second.end()) {
+    return;
+  }
+  value_iter->second.erase(section);
+  if (value_iter->second.empty()) {
+    property_iter->second.erase(value_iter);
+  }
+}
+
+void ConfigCache::InvalidateParsedProperty(const std::string& section, const std::string& property) {
+  auto section_iter = parsed_values_.find(section);
+  if (section_iter == parsed_values_.end()) {
+    return;
+  }
+  section_iter->second.erase(property);
+  if (section_iter->second.empty()) {
+    parsed_values_.erase(section_iter);
+  }
+}
+
+const std::string* ConfigCache::FindProperty(
+    const std::string& section, const std::string& property, bool* in_keystore) const {
+  *in_keystore = false;
+  for (const auto* config_section : {&information_sections_, &persistent_devices_}) {
+    auto section_iter = config_section->find(section);
+    if (section_iter == config_section->end()) {
+      continue;
+    }
+    auto property_iter = section_iter->second.find(property);
+    if (property_iter == section_iter->second.end()) {
+      return nullptr;
+    }
+    *in_keystore = config_section == &persistent_devices_ && property_iter->second == kEncryptedStr &&
+                   os::ParameterProvider::GetBtKeystoreInterface() != nullptr;
+    return &property_iter->second;
+  }
+  auto section_iter = temporary_devices_.find(section);
+  if (section_iter == temporary_devices_.end()) {
+    return nullptr;
+  }
+  auto property_iter = section_iter->second.find(property);
+  return property_iter != section_iter->second.end() ? &property_iter->second : nullptr;
+}
+
+void ConfigCache::ReadAtomically(const std::function<void()>& reader) const {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  reader();
+}
+
 namespace {
 
 bool FixDeviceTypeInconsistencyInSection(
@@ -466,17 +711,36 @@ bool FixDeviceTypeInconsistencyInSection(
 
 bool ConfigCache::FixDeviceTypeInconsistencies() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  // The device type is indexed and cached, hence fixed sections are indexed again and dropped from the caches
+  const std::string device_type_property = "DevType";
+  auto fix_section = [&](const std::string& section, common::ListMap<std::string, std::string>& properties) {
+    std::optional<std::string> device_type;
+    auto device_type_iter = properties.find(device_type_property);
+    if (device_type_iter != properties.end()) {
+      device_type = device_type_iter->second;
+    }
+    if (!FixDeviceTypeInconsistencyInSection(section, properties)) {
+      return false;
+    }
+    if (device_type) {
+      OnPropertyRemoved(section, device_type_property, *device_type);
+    } else {
+      serialized_sections_.erase(section);
+    }
+    property_index_[device_type_property][properties.find(device_type_property)->second].insert(section);
+    return true;
+  };
   bool persistent_device_changed = false;
   for (auto* config_section : {&information_sections_, &persistent_devices_}) {
     for (auto& elem : *config_section) {
-      if (FixDeviceTypeInconsistencyInSection(elem.first, elem.second)) {
+      if (fix_section(elem.first, elem.second)) {
         persistent_device_changed = true;
       }
     }
   }
   bool temp_device_changed = false;
   for (auto& elem : temporary_devices_) {
-    if (FixDeviceTypeInconsistencyInSection(elem.first, elem.second)) {
+    if (fix_section(elem.first, elem.second)) {
       temp_device_changed = true;
     }
   }
@@ -15,13 +15,18 @@
  */
 #pragma once
 
+#include <any>
 #include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
 #include <string>
 #include <string_view>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -71,8 +76,30 @@ class ConfigCache {
   // observers
   virtual bool HasSection(const std::string& section) const;
   virtual bool HasProperty(const std::string& section, const std::string& property) const;
-  // Get property, return std::nullopt if section or property does not exist
+  // Get property, return std::nullopt if section or property does not exist, or if its value is kept in the keystore
+  // and cannot be fetched from it
   virtual std::optional<std::string> GetProperty(const std::string& section, const std::string& property) const;
+  // Get property parsed by |parse|, which is only called again once the property changed. There must be a single
+  // parser per type T. Values kept in the keystore are parsed on each call.
+  template <typename T>
+  std::optional<T> GetParsedProperty(
+      const std::string& section, const std::string& property, std::optional<T> (*parse)(const std::string&)) const {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    bool in_keystore = false;
+    const std::string* value = FindProperty(section, property, &in_keystore);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    if (in_keystore) {
+      auto decrypted = GetProperty(section, property);
+      return decrypted ? parse(*decrypted) : std::nullopt;
+    }
+    std::any& parsed = parsed_values_[section][property][std::type_index(typeid(T))];
+    if (!parsed.has_value()) {
+      parsed = parse(*value);
+    }
+    return std::any_cast<const std::optional<T>&>(parsed);
+  }
   // Returns a copy of persistent device MAC addresses
   virtual std::vector<std::string> GetPersistentSections() const;
   // Return true if a section is persistent
@@ -84,6 +111,22 @@ class ConfigCache {
   virtual bool IsPersistentProperty(const std::string& property) const;
   // Serialize to legacy config format
   virtual std::string SerializeToLegacyFormat() const;
+  // An immutable copy of the sections written to disk, in their serialized form, which outlives later changes
+  class PersistentSnapshot {
+   public:
+    std::string SerializeToLegacyFormat() const;
+
+   private:
+    friend class ConfigCache;
+    std::vector<std::shared_ptr<const std::string>> serialized_sections_;
+  };
+  // Only sections changed since the last snapshot are serialized while holding the config mutex, the others are
+  // shared with it, so that serializing a snapshot to save it does not block readers
+  virtual PersistentSnapshot GetPersistentSnapshot() const;
+  // Call |visitor| with each section written to disk and its properties, in the order they are serialized
+  virtual void ForEachPersistentSection(
+      const std::function<void(const std::string& section, const common::ListMap<std::string, std::string>& properties)>&
+          visitor) const;
   // Return a copy of pair<section_name, property_value> with property
   struct SectionAndPropertyValue {
     std::string section;
@@ -96,6 +139,13 @@ class ConfigCache {
     }
   };
   virtual std::vector<SectionAndPropertyValue> GetSectionNamesWithProperty(const std::string& property) const;
+  // Return the sections where |property| is |value|, persistent ones first. Properties of kIndexedPropertyNames are
+  // looked up in an index, others by going through every section.
+  virtual std::vector<std::string> GetSectionNamesWithPropertyValue(
+      const std::string& property, const std::string& value) const;
+
+  // Call |reader| while holding the config mutex, so that the properties it reads are consistent with each other
+  virtual void ReadAtomically(const std::function<void()>& reader) const;
 
   // modifiers
   // Commit all mutation entries in sequence while holding the config mutex
@@ -103,14 +153,29 @@ class ConfigCache {
   virtual void SetProperty(std::string section, std::string property, std::string value);
   virtual bool RemoveSection(const std::string& section);
   virtual bool RemoveProperty(const std::string& section, const std::string& property);
+  // Move keys to the keystore in common criteria mode, and back into the config otherwise. Keys already in the keystore
+  // are left there until used, unless the config files failed their checksum.
   virtual void ConvertEncryptOrDecryptKeyIfNeeded();
   // TODO: have a systematic way of doing this instead of specialized methods
   // Remove sections with |property| set
   virtual void RemoveSectionWithProperty(const std::string& property);
   // remove all content in this config cache, restore it to the state after the explicit constructor
   virtual void Clear();
+  // Remove the temporary device sections, leaving what SerializeToLegacyFormat() returns
+  virtual void RemoveTemporaryDevices();
   // Set a callback to notify interested party that a persistent config change has just happened
   virtual void SetPersistentConfigChangedCallback(std::function<void()> persistent_config_changed_callback);
+  // A change of what is written to disk, which gives the same config when replayed in order: SET |value| of
+  // |property|, REMOVE_PROPERTY |property|, or REMOVE_SECTION
+  struct PersistentChange {
+    MutationEntry::EntryType type;
+    std::string section;
+    std::string property;
+    std::string value;
+  };
+  // Set a callback receiving each persistent change before the persistent config changed callback is called. It is
+  // called while holding the config mutex.
+  virtual void SetPersistentChangeCallback(std::function<void(PersistentChange)> persistent_change_callback);
 
   // Device config specific methods
   // TODO: methods here should be moved to a device specific config cache if this config cache is supposed to be generic
@@ -123,11 +188,15 @@ class ConfigCache {
 
   // constants
   static const std::string kDefaultSectionName;
+  // Properties whose sections are indexed by value, as devices are looked up by them
+  static const std::unordered_set<std::string_view> kIndexedPropertyNames;
 
  private:
   mutable std::recursive_mutex mutex_;
   // A callback to notify interested party that a persistent config change has just happened, empty by default
   std::function<void()> persistent_config_changed_callback_;
+  // A callback receiving each persistent change, empty by default
+  std::function<void(PersistentChange)> persistent_change_callback_;
   // A set of property names that if set would make a section persistent and if non of these properties are set, a
   // section would become temporary again
   std::unordered_set<std::string_view> persistent_property_names_;
@@ -138,6 +207,28 @@ class ConfigCache {
   // Information about temporary devices, normally unpaired, will not be written to disk, will be evicted automatically
   // if capacity exceeds given value during initialization
   common::LruCache<std::string, common::ListMap<std::string, std::string>> temporary_devices_;
+  // Sections of each value of the properties in kIndexedPropertyNames, among all three maps above
+  std::unordered_map<std::string, std::unordered_map<std::string, std::unordered_set<std::string>>> property_index_;
+  // Values parsed by GetParsedProperty(), holding a std::optional<T> for each type T a property was parsed into
+  mutable std::unordered_map<std::string, std::unordered_map<std::string, std::unordered_map<std::type_index, std::any>>>
+      parsed_values_;
+  // Serialized form of the persistent sections unchanged since they were last put in a PersistentSnapshot
+  mutable std::unordered_map<std::string, std::shared_ptr<const std::string>> serialized_sections_;
+
+  // Keep property_index_, parsed_values_ and serialized_sections_ up to date when |property| of |section| is set to |value| in |properties|,
+  // called before setting it
+  void OnPropertySet(
+      const std::string& section,
+      const common::ListMap<std::string, std::string>& properties,
+      const std::string& property,
+      const std::string& value);
+  void OnPropertyRemoved(const std::string& section, const std::string& property, const std::string& value);
+  void OnSectionRemoved(const std::string& section, const common::ListMap<std::string, std::string>& properties);
+  void UnindexProperty(const std::string& section, const std::string& property, const std::string& value);
+  void InvalidateParsedProperty(const std::string& section, const std::string& property);
+  // Return the stored value of |property| of |section|, without copying it, or nullptr if it does not exist.
+  // |in_keystore| tells whether the actual value is kept in the keystore instead.
+  const std::string* FindProperty(const std::string& section, const std::string& property, bool* in_keystore) const;
 
   // Convenience method to check if the callback is valid before calling it
   inline void PersistentConfigChangedCallback() const {
@@ -145,6 +236,16 @@ class ConfigCache {
       persistent_config_changed_callback_();
     }
   }
+  // The change is only built when there is a callback, as SetProperty() is called for each property when loading
+  inline void PersistentChangeCallback(
+      MutationEntry::EntryType type,
+      const std::string& section,
+      const std::string& property = {},
+      const std::string& value = {}) const {
+    if (persistent_change_callback_) {
+      persistent_change_callback_(PersistentChange{type, section, property, value});
+    }
+  }
 };
 
 }  // namespace storage
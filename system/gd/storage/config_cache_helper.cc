@@ -22,22 +22,24 @@
 namespace bluetooth {
 namespace storage {
 
+namespace {
+
+std::optional<std::vector<uint8_t>> ParseBin(const std::string& value_str) {
+  auto value = common::FromHexString(value_str);
+  if (!value) {
+    LOG_WARN("value_str cannot be parsed to std::vector<uint8_t>");
+  }
+  return value;
+}
+
+}  // namespace
+
 void ConfigCacheHelper::SetBool(const std::string& section, const std::string& property, bool value) {
   config_cache_.SetProperty(section, property, value ? "true" : "false");
 }
 
 std::optional<bool> ConfigCacheHelper::GetBool(const std::string& section, const std::string& property) const {
-  auto value_str = config_cache_.GetProperty(section, property);
-  if (!value_str) {
-    return std::nullopt;
-  }
-  if (*value_str == "true") {
-    return true;
-  } else if (*value_str == "false") {
-    return false;
-  } else {
-    return std::nullopt;
-  }
+  return config_cache_.GetParsedProperty<bool>(section, property, &common::BoolFromString);
 }
 
 void ConfigCacheHelper::SetUint64(const std::string& section, const std::string& property, uint64_t value) {
@@ -45,11 +47,7 @@ void ConfigCacheHelper::SetUint64(const std::string& section, const std::string&
 }
 
 std::optional<uint64_t> ConfigCacheHelper::GetUint64(const std::string& section, const std::string& property) const {
-  auto value_str = config_cache_.GetProperty(section, property);
-  if (!value_str) {
-    return std::nullopt;
-  }
-  return common::Uint64FromString(*value_str);
+  return config_cache_.GetParsedProperty<uint64_t>(section, property, &common::Uint64FromString);
 }
 
 void ConfigCacheHelper::SetUint32(const std::string& section, const std::string& property, uint32_t value) {
@@ -57,10 +55,6 @@ void ConfigCacheHelper::SetUint32(const std::string& section, const std::string&
 }
 
 std::optional<uint32_t> ConfigCacheHelper::GetUint32(const std::string& section, const std::string& property) const {
-  auto value_str = config_cache_.GetProperty(section, property);
-  if (!value_str) {
-    return std::nullopt;
-  }
   auto large_value = GetUint64(section, property);
   if (!large_value) {
     return std::nullopt;
@@ -76,11 +70,7 @@ void ConfigCacheHelper::SetInt64(const std::string& section, const std::string&
 }
 
 std::optional<int64_t> ConfigCacheHelper::GetInt64(const std::string& section, const std::string& property) const {
-  auto value_str = config_cache_.GetProperty(section, property);
-  if (!value_str) {
-    return std::nullopt;
-  }
-  return common::Int64FromString(*value_str);
+  return config_cache_.GetParsedProperty<int64_t>(section, property, &common::Int64FromString);
 }
 
 void ConfigCacheHelper::SetInt(const std::string& section, const std::string& property, int value) {
@@ -88,10 +78,6 @@ void ConfigCacheHelper::SetInt(const std::string& section, const std::string& pr
 }
 
 std::optional<int> ConfigCacheHelper::GetInt(const std::string& section, const std::string& property) const {
-  auto value_str = config_cache_.GetProperty(section, property);
-  if (!value_str) {
-    return std::nullopt;
-  }
   auto large_value = GetInt64(section, property);
   if (!large_value) {
     return std::nullopt;
@@ -99,7 +85,7 @@ std::optional<int> ConfigCacheHelper::GetInt(const std::string& section, const s
   if (!common::IsNumberInNumericLimits<int>(*large_value)) {
     return std::nullopt;
   }
-  return static_cast<uint32_t>(*large_value);
+  return static_cast<int>(*large_value);
 }
 
 void ConfigCacheHelper::SetBin(
@@ -109,15 +95,7 @@ void ConfigCacheHelper::SetBin(
 
 std::optional<std::vector<uint8_t>> ConfigCacheHelper::GetBin(
     const std::string& section, const std::string& property) const {
-  auto value_str = config_cache_.GetProperty(section, property);
-  if (!value_str) {
-    return std::nullopt;
-  }
-  auto value = common::FromHexString(*value_str);
-  if (!value) {
-    LOG_WARN("value_str cannot be parsed to std::vector<uint8_t>");
-  }
-  return value;
+  return config_cache_.GetParsedProperty<std::vector<uint8_t>>(section, property, &ParseBin);
 }
 
 }  // namespace storage
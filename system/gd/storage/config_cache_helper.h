@@ -15,10 +15,16 @@
  */
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <optional>
+#include <string>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "common/numbers.h"
 #include "common/strings.h"
@@ -35,6 +41,7 @@ namespace storage {
 //
 // - all SetX methods accept value as copy and std::move() in encouraged
 // - all GetX methods return std::optional<X> and std::nullopt if not exist. std::optional<> can be treated as bool
+// - values are parsed once and cached in ConfigCache until they change
 class ConfigCacheHelper {
  public:
   static ConfigCacheHelper FromConfigCache(ConfigCache& config_cache) {
@@ -96,20 +103,12 @@ class ConfigCacheHelper {
 
   template <typename T, typename std::enable_if<std::is_base_of_v<Serializable<T>, T>, int>::type = 0>
   std::optional<T> Get(const std::string& section, const std::string& property) {
-    auto value = config_cache_.GetProperty(section, property);
-    if (!value) {
-      return std::nullopt;
-    }
-    return T::FromLegacyConfigString(*value);
+    return config_cache_.GetParsedProperty<T>(section, property, &T::FromLegacyConfigString);
   }
 
   template <typename T, typename std::enable_if<std::is_enum_v<T>, int>::type = 0>
   std::optional<T> Get(const std::string& section, const std::string& property) {
-    auto value = config_cache_.GetProperty(section, property);
-    if (!value) {
-      return std::nullopt;
-    }
-    return bluetooth::FromLegacyConfigString<T>(*value);
+    return config_cache_.GetParsedProperty<T>(section, property, &bluetooth::FromLegacyConfigString<T>);
   }
 
   template <
@@ -119,11 +118,24 @@ class ConfigCacheHelper {
               std::is_base_of_v<Serializable<typename T::value_type>, typename T::value_type>,
           int>::type = 0>
   std::optional<T> Get(const std::string& section, const std::string& property) {
-    auto value = config_cache_.GetProperty(section, property);
-    if (!value) {
-      return std::nullopt;
-    }
-    auto values = common::StringSplit(*value, " ");
+    return config_cache_.GetParsedProperty<T>(section, property, &ParseList<T>);
+  }
+
+  // Get several properties of |section| at once, all read while holding the config mutex, e.g. a whole device:
+  //   auto [name, device_type] = helper.GetProperties<std::string, hci::DeviceType>(address, {"Name", "DevType"});
+  template <typename... T>
+  std::tuple<std::optional<T>...> GetProperties(
+      const std::string& section, const std::array<std::string, sizeof...(T)>& properties) {
+    std::tuple<std::optional<T>...> values;
+    config_cache_.ReadAtomically(
+        [&]() { GetPropertiesInto(section, properties, values, std::index_sequence_for<T...>{}); });
+    return values;
+  }
+
+ private:
+  template <typename T>
+  static std::optional<T> ParseList(const std::string& value) {
+    auto values = common::StringSplit(value, " ");
     T result;
     result.reserve(values.size());
     for (const auto& str : values) {
@@ -136,7 +148,15 @@ class ConfigCacheHelper {
     return result;
   }
 
- private:
+  template <typename... T, size_t... I>
+  void GetPropertiesInto(
+      const std::string& section,
+      const std::array<std::string, sizeof...(T)>& properties,
+      std::tuple<std::optional<T>...>& values,
+      std::index_sequence<I...>) {
+    ((std::get<I>(values) = Get<T>(section, properties[I])), ...);
+  }
+
   ConfigCache& config_cache_;
 };
 
@@ -22,12 +22,14 @@
 #include <limits>
 #include <vector>
 
+#include "hci/enum_helper.h"
 #include "storage/device.h"
 
 namespace testing {
 
 using bluetooth::storage::ConfigCache;
 using bluetooth::storage::ConfigCacheHelper;
+using bluetooth::hci::DeviceType;
 using bluetooth::storage::Device;
 
 TEST(ConfigCacheHelperTest, set_get_bool_test) {
@@ -133,4 +135,54 @@ TEST(ConfigCacheHelperTest, set_get_bin_test) {
   ASSERT_THAT(ConfigCacheHelper(config).GetBin("A", "B"), Optional(ContainerEq(data2)));
 }
 
-}  // namespace testing
\ No newline at end of file
+TEST(ConfigCacheHelperTest, parsed_value_follows_changes_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  ConfigCacheHelper helper(config);
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "B", "12");
+  ASSERT_THAT(helper.GetUint64("AA:BB:CC:DD:EE:FF", "B"), Optional(Eq(uint64_t(12))));
+  ASSERT_THAT(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"), Optional(Eq(12)));
+  ASSERT_THAT(helper.GetBin("AA:BB:CC:DD:EE:FF", "B"), Optional(ElementsAre(0x12)));
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "B", "-1");
+  ASSERT_FALSE(helper.GetUint64("AA:BB:CC:DD:EE:FF", "B"));
+  ASSERT_THAT(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"), Optional(Eq(-1)));
+  // the device becomes paired, hence persistent, and keeps its properties
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "AABBAABBCCDDEE");
+  ASSERT_THAT(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"), Optional(Eq(-1)));
+  ASSERT_TRUE(config.RemoveProperty("AA:BB:CC:DD:EE:FF", "B"));
+  ASSERT_FALSE(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"));
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "B", "2");
+  ASSERT_THAT(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"), Optional(Eq(2)));
+  ASSERT_TRUE(config.RemoveSection("AA:BB:CC:DD:EE:FF"));
+  ASSERT_FALSE(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"));
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "B", "3");
+  ASSERT_THAT(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"), Optional(Eq(3)));
+  config.Clear();
+  ASSERT_FALSE(helper.GetInt("AA:BB:CC:DD:EE:FF", "B"));
+}
+
+TEST(ConfigCacheHelperTest, parsed_device_type_follows_fix_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  ConfigCacheHelper helper(config);
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "AABBAABBCCDDEE");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "DevType", std::to_string(DeviceType::LE));
+  ASSERT_THAT(helper.Get<DeviceType>("AA:BB:CC:DD:EE:FF", "DevType"), Optional(Eq(DeviceType::LE)));
+  ASSERT_TRUE(config.FixDeviceTypeInconsistencies());
+  ASSERT_THAT(helper.Get<DeviceType>("AA:BB:CC:DD:EE:FF", "DevType"), Optional(Eq(DeviceType::BR_EDR)));
+}
+
+TEST(ConfigCacheHelperTest, get_properties_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  ConfigCacheHelper helper(config);
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "Name", "HEADSET");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "DevType", std::to_string(DeviceType::DUAL));
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "AABBAABBCCDDEE");
+  auto [name, device_type, link_key, pin_length] =
+      helper.GetProperties<std::string, DeviceType, std::vector<uint8_t>, int>(
+          "AA:BB:CC:DD:EE:FF", {"Name", "DevType", "LinkKey", "PinLength"});
+  ASSERT_THAT(name, Optional(StrEq("HEADSET")));
+  ASSERT_THAT(device_type, Optional(Eq(DeviceType::DUAL)));
+  ASSERT_THAT(link_key, Optional(ElementsAre(0xAA, 0xBB, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE)));
+  ASSERT_FALSE(pin_length);
+}
+
+}  // namespace testing
@@ -391,6 +391,58 @@ TEST(ConfigCacheTest, test_get_section_with_property) {
           SectionAndPropertyValue{.section = "AA:BB:CC:DD:EE:FF", .property = "C"}));
 }
 
+TEST(ConfigCacheTest, test_get_section_with_indexed_property_value) {
+  ConfigCache config(2, Device::kLinkKeyProperties);
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LeIdentityAddr", "11:22:33:44:55:66");
+  config.SetProperty("AA:BB:CC:DD:EE:EF", "LeIdentityAddr", "11:22:33:44:55:66");
+  config.SetProperty("AA:BB:CC:DD:EE:EF", "LinkKey", "AABBAABBCCDDEE");
+  // persistent sections come first
+  ASSERT_THAT(
+      config.GetSectionNamesWithPropertyValue("LeIdentityAddr", "11:22:33:44:55:66"),
+      ElementsAre("AA:BB:CC:DD:EE:EF", "AA:BB:CC:DD:EE:FF"));
+
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LeIdentityAddr", "11:22:33:44:55:77");
+  ASSERT_THAT(
+      config.GetSectionNamesWithPropertyValue("LeIdentityAddr", "11:22:33:44:55:66"), ElementsAre("AA:BB:CC:DD:EE:EF"));
+  ASSERT_THAT(
+      config.GetSectionNamesWithPropertyValue("LeIdentityAddr", "11:22:33:44:55:77"), ElementsAre("AA:BB:CC:DD:EE:FF"));
+
+  // unpairing keeps the section and its index
+  ASSERT_TRUE(config.RemoveProperty("AA:BB:CC:DD:EE:EF", "LinkKey"));
+  ASSERT_THAT(
+      config.GetSectionNamesWithPropertyValue("LeIdentityAddr", "11:22:33:44:55:66"), ElementsAre("AA:BB:CC:DD:EE:EF"));
+  ASSERT_TRUE(config.RemoveProperty("AA:BB:CC:DD:EE:EF", "LeIdentityAddr"));
+  ASSERT_THAT(config.GetSectionNamesWithPropertyValue("LeIdentityAddr", "11:22:33:44:55:66"), ElementsAre());
+
+  ASSERT_TRUE(config.RemoveSection("AA:BB:CC:DD:EE:FF"));
+  ASSERT_THAT(config.GetSectionNamesWithPropertyValue("LeIdentityAddr", "11:22:33:44:55:77"), ElementsAre());
+
+  // evicted temporary sections leave the index
+  config.SetProperty("AA:BB:CC:DD:EE:01", "DevType", "2");
+  config.SetProperty("AA:BB:CC:DD:EE:02", "DevType", "2");
+  config.SetProperty("AA:BB:CC:DD:EE:03", "DevType", "2");
+  ASSERT_THAT(
+      config.GetSectionNamesWithPropertyValue("DevType", "2"),
+      UnorderedElementsAre("AA:BB:CC:DD:EE:02", "AA:BB:CC:DD:EE:03"));
+
+  // fixed device types are indexed again
+  config.SetProperty("AA:BB:CC:DD:EE:03", "LinkKey", "AABBAABBCCDDEE");
+  ASSERT_TRUE(config.FixDeviceTypeInconsistencies());
+  ASSERT_THAT(config.GetSectionNamesWithPropertyValue("DevType", "2"), ElementsAre());
+  ASSERT_THAT(
+      config.GetSectionNamesWithPropertyValue("DevType", std::to_string(bluetooth::hci::DeviceType::BR_EDR)),
+      UnorderedElementsAre("AA:BB:CC:DD:EE:02", "AA:BB:CC:DD:EE:03"));
+
+  // properties that are not indexed are looked up too
+  config.SetProperty("AA:BB:CC:DD:EE:03", "Name", "Headset");
+  ASSERT_THAT(config.GetSectionNamesWithPropertyValue("Name", "Headset"), ElementsAre("AA:BB:CC:DD:EE:03"));
+
+  config.Clear();
+  ASSERT_THAT(
+      config.GetSectionNamesWithPropertyValue("DevType", std::to_string(bluetooth::hci::DeviceType::BR_EDR)),
+      ElementsAre());
+}
+
 TEST(ConfigCacheTest, test_get_sections_matching_at_least_one_property) {
   ConfigCache config(100, Device::kLinkKeyProperties);
   config.SetProperty("A", "B", "C");
@@ -413,4 +465,52 @@ TEST(ConfigCacheTest, test_empty_persistent_properties) {
   ASSERT_THAT(config.GetPersistentSections(), ElementsAre());
 }
 
-}  // namespace testing
\ No newline at end of file
+TEST(ConfigCacheTest, test_persistent_snapshot) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  config.SetProperty("A", "B", "C");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "B", "C");
+  config.SetProperty("CC:DD:EE:FF:00:11", "LinkKey", "AABBAABBCCDDEE");
+  auto snapshot = config.GetPersistentSnapshot();
+  ASSERT_EQ(
+      snapshot.SerializeToLegacyFormat(),
+      "[A]\n"
+      "B = C\n"
+      "\n"
+      "[CC:DD:EE:FF:00:11]\n"
+      "LinkKey = AABBAABBCCDDEE\n"
+      "\n");
+
+  // changes made after a snapshot do not show in it, but in the next ones
+  config.SetProperty("CC:DD:EE:FF:00:11", "Name", "HEADSET");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "CCDDCCDDEEFF");
+  config.RemoveSection("A");
+  ASSERT_EQ(
+      snapshot.SerializeToLegacyFormat(),
+      "[A]\n"
+      "B = C\n"
+      "\n"
+      "[CC:DD:EE:FF:00:11]\n"
+      "LinkKey = AABBAABBCCDDEE\n"
+      "\n");
+  ASSERT_EQ(
+      config.SerializeToLegacyFormat(),
+      "[CC:DD:EE:FF:00:11]\n"
+      "LinkKey = AABBAABBCCDDEE\n"
+      "Name = HEADSET\n"
+      "\n"
+      "[AA:BB:CC:DD:EE:FF]\n"
+      "B = C\n"
+      "LinkKey = CCDDCCDDEEFF\n"
+      "\n");
+  ASSERT_TRUE(config.FixDeviceTypeInconsistencies());
+  config.RemoveProperty("AA:BB:CC:DD:EE:FF", "LinkKey");
+  ASSERT_EQ(
+      config.SerializeToLegacyFormat(),
+      "[CC:DD:EE:FF:00:11]\n"
+      "LinkKey = AABBAABBCCDDEE\n"
+      "Name = HEADSET\n"
+      "DevType = 1\n"
+      "\n");
+}
+
+}  // namespace testing
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "os/files.h"
+#include "storage/binary_config_file.h"
+#include "storage/legacy_config_file.h"
+
+using ::benchmark::State;
+using ::bluetooth::storage::BinaryConfigFile;
+using ::bluetooth::storage::LegacyConfigFile;
+using ::bluetooth::storage::MappedBinaryConfig;
+
+namespace {
+
+constexpr size_t kTempDevicesCapacity = 10000;
+
+// A config with the given number of bonded devices, each with the properties usually saved by the stack
+std::string make_legacy_config(size_t device_count) {
+  std::string config =
+      "[Info]\nFileSource = Empty\nTimeCreated = 2020-05-20 01:20:56\n\n"
+      "[Adapter]\nAddress = 01:02:03:ab:cd:ef\nLE_LOCAL_KEY_IRK = fedcba0987654321fedcba0987654321\n"
+      "ScanMode = 2\nDiscoveryTimeout = 120\n\n";
+  char address[18];
+  for (size_t i = 0; i < device_count; i++) {
+    std::snprintf(address, sizeof(address), "aa:bb:cc:dd:%02zx:%02zx", i >> 8, i & 0xff);
+    config.append("[").append(address).append("]\n");
+    config.append("Name = Headset ").append(std::to_string(i)).append("\n");
+    config.append(
+        "DevClass = 2360344\nDevType = 3\nAddrType = 0\nManufacturer = 15\nLmpVer = 9\nLmpSubVer = 8716\n"
+        "Service = 0000110b-0000-1000-8000-00805f9b34fb 0000110e-0000-1000-8000-00805f9b34fb\n"
+        "LinkKeyType = 8\nPinLength = 0\nLinkKey = fedcba0987654321fedcba0987654328\n"
+        "LE_KEY_PENC = 0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef01234567\n"
+        "LE_KEY_PID = 0123456789abcdef0123456789abcdef0123456789abcdef00\n"
+        "LE_KEY_PCSRK = 0123456789abcdef0123456789abcdef0000000000\n\n");
+  }
+  return config;
+}
+
+// Write both formats of a config of the number of devices given as argument
+class ConfigFiles {
+ public:
+  explicit ConfigFiles(size_t device_count) {
+    auto temp_dir = std::filesystem::temp_directory_path();
+    legacy_path_ = (temp_dir / "bt_config_benchmark.conf").string();
+    binary_path_ = (temp_dir / "bt_config_benchmark.bin").string();
+    auto legacy = make_legacy_config(device_count);
+    bluetooth::os::WriteToFile(legacy_path_, legacy);
+    bluetooth::os::WriteToFile(binary_path_, *BinaryConfigFile::FromLegacyFormat(legacy));
+  }
+  ~ConfigFiles() {
+    std::filesystem::remove(legacy_path_);
+    std::filesystem::remove(binary_path_);
+  }
+  std::string legacy_path_;
+  std::string binary_path_;
+};
+
+// Load the config as done when the stack starts
+void BM_LegacyConfigFileRead(State& state) {
+  ConfigFiles files(state.range(0));
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(LegacyConfigFile::FromPath(files.legacy_path_).Read(kTempDevicesCapacity));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LegacyConfigFileRead)->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_BinaryConfigFileRead(State& state) {
+  ConfigFiles files(state.range(0));
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(BinaryConfigFile::FromPath(files.binary_path_).Read(kTempDevicesCapacity));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BinaryConfigFileRead)->Arg(10)->Arg(100)->Arg(1000);
+
+// Map the config and look up one property, without loading it
+void BM_MappedBinaryConfigLookup(State& state) {
+  ConfigFiles files(state.range(0));
+  for (auto _ : state) {
+    auto mapped = MappedBinaryConfig::Open(files.binary_path_);
+    ::benchmark::DoNotOptimize(mapped->View().GetProperty("aa:bb:cc:dd:00:05", "LinkKey"));
+  }
+}
+BENCHMARK(BM_MappedBinaryConfigLookup)->Arg(10)->Arg(100)->Arg(1000);
+
+}  // namespace
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/config_journal.h"
+
+#include <optional>
+#include <string_view>
+
+#include "os/files.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace storage {
+
+namespace {
+
+constexpr char kSet = 'S';
+constexpr char kRemoveProperty = 'P';
+constexpr char kRemoveSection = 'R';
+
+void AppendField(std::string* line, const std::string& field) {
+  line->append(std::to_string(field.size()));
+  line->push_back(':');
+  line->append(field);
+}
+
+// Extract the length prefixed string at the start of |input|
+std::optional<std::string> ExtractField(std::string_view* input) {
+  size_t colon = input->find(':');
+  if (colon == std::string_view::npos || colon == 0 || colon > 10) {
+    return std::nullopt;
+  }
+  size_t length = 0;
+  for (size_t i = 0; i < colon; i++) {
+    char digit = (*input)[i];
+    if (digit < '0' || digit > '9') {
+      return std::nullopt;
+    }
+    length = length * 10 + (digit - '0');
+  }
+  if (input->size() - colon - 1 < length) {
+    return std::nullopt;
+  }
+  std::string field(input->substr(colon + 1, length));
+  input->remove_prefix(colon + 1 + length);
+  return field;
+}
+
+}  // namespace
+
+ConfigJournal::ConfigJournal(std::string path) : path_(std::move(path)) {
+  ASSERT(!path_.empty());
+}
+
+std::string ConfigJournal::Serialize(const ConfigCache::PersistentChange& change) {
+  std::string line;
+  switch (change.type) {
+    case MutationEntry::EntryType::SET:
+      line.push_back(kSet);
+      AppendField(&line, change.section);
+      AppendField(&line, change.property);
+      AppendField(&line, change.value);
+      break;
+    case MutationEntry::EntryType::REMOVE_PROPERTY:
+      line.push_back(kRemoveProperty);
+      AppendField(&line, change.section);
+      AppendField(&line, change.property);
+      break;
+    case MutationEntry::EntryType::REMOVE_SECTION:
+      line.push_back(kRemoveSection);
+      AppendField(&line, change.section);
+      break;
+      // do not write a default case so that when a new enum is defined, compilation would fail automatically
+  }
+  line.push_back('\n');
+  return line;
+}
+
+bool ConfigJournal::Append(const std::string& serialized_changes) {
+  return os::AppendToFile(path_, serialized_changes);
+}
+
+size_t ConfigJournal::Replay(ConfigCache* cache) {
+  ASSERT(cache != nullptr);
+  if (!os::FileExists(path_)) {
+    return 0;
+  }
+  auto content = os::ReadSmallFile(path_);
+  if (!content) {
+    return 0;
+  }
+  std::string_view input(*content);
+  size_t applied = 0;
+  while (!input.empty()) {
+    char type = input.front();
+    input.remove_prefix(1);
+    auto section = ExtractField(&input);
+    if (!section || section->empty()) {
+      break;
+    }
+    std::optional<std::string> property;
+    std::optional<std::string> value;
+    if (type == kSet || type == kRemoveProperty) {
+      property = ExtractField(&input);
+      if (!property || property->empty()) {
+        break;
+      }
+    }
+    if (type == kSet) {
+      value = ExtractField(&input);
+      if (!value) {
+        break;
+      }
+    } else if (type != kRemoveProperty && type != kRemoveSection) {
+      break;
+    }
+    // The end of line tells that the change was completely written
+    if (input.empty() || input.front() != '\n') {
+      break;
+    }
+    input.remove_prefix(1);
+    if (type == kSet) {
+      cache->SetProperty(std::move(*section), std::move(*property), std::move(*value));
+    } else if (type == kRemoveProperty) {
+      cache->RemoveProperty(*section, *property);
+    } else {
+      cache->RemoveSection(*section);
+    }
+    applied++;
+  }
+  if (!input.empty()) {
+    LOG_WARN("Ignoring %zu bytes of malformed changes at the end of %s", input.size(), path_.c_str());
+  }
+  return applied;
+}
+
+bool ConfigJournal::Exists() const {
+  return os::FileExists(path_);
+}
+
+bool ConfigJournal::Delete() {
+  if (!os::FileExists(path_)) {
+    return true;
+  }
+  return os::RemoveFile(path_);
+}
+
+}  // namespace storage
+}  // namespace bluetooth
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "storage/config_cache.h"
+
+namespace bluetooth {
+namespace storage {
+
+// Append-only log of the persistent changes made to a config since it was last written to its file, so that a change
+// costs a small append instead of a rewrite of the whole file
+//
+// Each change takes one line made of its type and of its length prefixed strings, so that a change torn by a crash is
+// detected and ignored when replaying. The value of a property only depends on the last change touching it, so replaying a
+// journal over a file already holding its changes, as left by a crash right after the file was rewritten, is harmless.
+class ConfigJournal {
+ public:
+  static ConfigJournal FromPath(std::string path) {
+    return ConfigJournal(std::move(path));
+  }
+  explicit ConfigJournal(std::string path);
+  // Append changes made by Serialize() and sync them to disk
+  bool Append(const std::string& serialized_changes);
+  // Apply the changes of the journal to |cache| in the order they were appended, up to the first malformed one, and
+  // return the number of changes applied
+  size_t Replay(ConfigCache* cache);
+  bool Exists() const;
+  bool Delete();
+
+  static std::string Serialize(const ConfigCache::PersistentChange& change);
+
+ private:
+  std::string path_;
+};
+
+}  // namespace storage
+}  // namespace bluetooth
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/config_journal.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+
+#include "os/files.h"
+#include "storage/device.h"
+
+namespace testing {
+
+using bluetooth::os::ReadSmallFile;
+using bluetooth::os::WriteToFile;
+using bluetooth::storage::ConfigCache;
+using bluetooth::storage::ConfigJournal;
+using bluetooth::storage::Device;
+
+class ConfigJournalTest : public Test {
+ protected:
+  void SetUp() override {
+    temp_journal_ = std::filesystem::temp_directory_path() / "temp_config.journal";
+    std::filesystem::remove(temp_journal_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(temp_journal_);
+  }
+
+  // Record the persistent changes made to |config| in the order they are made
+  void Record(ConfigCache* config) {
+    config->SetPersistentChangeCallback(
+        [this](ConfigCache::PersistentChange change) { changes_.append(ConfigJournal::Serialize(change)); });
+  }
+
+  std::filesystem::path temp_journal_;
+  std::string changes_;
+};
+
+TEST_F(ConfigJournalTest, replay_loop_back_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  config.SetProperty("Adapter", "Name", "PHONE");
+  ConfigCache replayed(100, Device::kLinkKeyProperties);
+  replayed.SetProperty("Adapter", "Name", "PHONE");
+
+  Record(&config);
+  config.SetProperty("Info", "FileSource", "");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "Name", "colon: and = sign");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "AABBAABBCCDDEE");
+  config.SetProperty("CC:DD:EE:FF:00:11", "LinkKey", "CCDDCCDDEEFF");
+  config.SetProperty("CC:DD:EE:FF:00:11", "Name", "HEADSET");
+  config.RemoveProperty("CC:DD:EE:FF:00:11", "Name");
+  config.SetProperty("11:22:33:44:55:66", "LinkKey", "11221122");
+  config.RemoveSection("11:22:33:44:55:66");
+  config.RemoveSection("Adapter");
+  EXPECT_TRUE(ConfigJournal::FromPath(temp_journal_.string()).Append(changes_));
+
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(&replayed), 9u);
+  EXPECT_EQ(config, replayed);
+  EXPECT_THAT(
+      replayed.GetPersistentSections(), UnorderedElementsAre("AA:BB:CC:DD:EE:FF", "CC:DD:EE:FF:00:11"));
+  EXPECT_THAT(replayed.GetProperty("AA:BB:CC:DD:EE:FF", "Name"), Optional(StrEq("colon: and = sign")));
+  EXPECT_THAT(replayed.GetProperty("Info", "FileSource"), Optional(StrEq("")));
+
+  // Replaying over a config already holding the changes, as left by a crash right after a save, changes nothing
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(&replayed), 9u);
+  EXPECT_EQ(config, replayed);
+}
+
+TEST_F(ConfigJournalTest, torn_change_is_ignored_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  Record(&config);
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "AABBAABBCCDDEE");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "Name", "HEADSET");
+  // Drop the end of line of the last change, as a crash while appending it would
+  EXPECT_TRUE(WriteToFile(temp_journal_.string(), changes_.substr(0, changes_.size() - 1)));
+
+  ConfigCache replayed(100, Device::kLinkKeyProperties);
+  EXPECT_EQ(ConfigJournal::FromPath(temp_journal_.string()).Replay(&replayed), 1u);
+  EXPECT_THAT(replayed.GetProperty("AA:BB:CC:DD:EE:FF", "LinkKey"), Optional(StrEq("AABBAABBCCDDEE")));
+  EXPECT_FALSE(replayed.HasProperty("AA:BB:CC:DD:EE:FF", "Name"));
+}
+
+TEST_F(ConfigJournalTest, append_and_delete_test) {
+  ConfigJournal journal = ConfigJournal::FromPath(temp_journal_.string());
+  EXPECT_FALSE(journal.Exists());
+  ConfigCache replayed(100, Device::kLinkKeyProperties);
+  EXPECT_EQ(journal.Replay(&replayed), 0u);
+
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  Record(&config);
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "LinkKey", "AABBAABBCCDDEE");
+  EXPECT_TRUE(journal.Append(changes_));
+  std::string first = changes_;
+  changes_.clear();
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "Name", "HEADSET");
+  EXPECT_TRUE(journal.Append(changes_));
+  EXPECT_THAT(ReadSmallFile(temp_journal_.string()), Optional(StrEq(first + changes_)));
+
+  EXPECT_TRUE(journal.Delete());
+  EXPECT_FALSE(journal.Exists());
+  EXPECT_TRUE(journal.Delete());
+}
+
+}  // namespace testing
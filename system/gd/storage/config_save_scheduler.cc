@@ -0,0 +1,114 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/config_save_scheduler.h"
+
+#include <algorithm>
+
+namespace bluetooth {
+namespace storage {
+
+namespace {
+
+constexpr std::chrono::hours kOneDay = std::chrono::hours(24);
+constexpr std::chrono::hours kOneHour = std::chrono::hours(1);
+
+}  // namespace
+
+ConfigSaveScheduler::ConfigSaveScheduler(
+    std::chrono::milliseconds min_delay, std::chrono::milliseconds max_delay, int64_t daily_write_budget_bytes)
+    : min_delay_(min_delay),
+      max_delay_(std::max(min_delay, max_delay)),
+      daily_write_budget_bytes_(daily_write_budget_bytes),
+      save_delay_(min_delay) {
+  stats_.daily_write_budget_bytes = daily_write_budget_bytes_;
+}
+
+std::chrono::milliseconds ConfigSaveScheduler::GetSaveDelay() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return save_delay_;
+}
+
+void ConfigSaveScheduler::OnSectionChanged(const std::string& section, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  dirty_sections_.insert(section);
+  if (!oldest_dirty_change_) {
+    oldest_dirty_change_ = now;
+  }
+}
+
+void ConfigSaveScheduler::OnSaved(size_t bytes, bool full_save, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  StartNewDayIfNeeded(now);
+  ForgetSavesOlderThanAnHour(now);
+  if (full_save) {
+    stats_.full_save_count++;
+  } else {
+    stats_.journal_append_count++;
+  }
+  stats_.bytes_written += bytes;
+  stats_.bytes_written_today += bytes;
+  saves_in_last_hour_.push_back(now);
+  if (oldest_dirty_change_) {
+    stats_.max_dirty_age = std::max(
+        stats_.max_dirty_age, std::chrono::duration_cast<std::chrono::milliseconds>(now - *oldest_dirty_change_));
+  }
+  dirty_sections_.clear();
+  oldest_dirty_change_.reset();
+
+  if (stats_.bytes_written_today >= daily_write_budget_bytes_) {
+    save_delay_ = max_delay_;
+  } else if (last_save_ && now - *last_save_ < max_delay_) {
+    save_delay_ = std::min(save_delay_ * 2, max_delay_);
+  } else {
+    save_delay_ = min_delay_;
+  }
+  last_save_ = now;
+}
+
+ConfigSaveScheduler::Stats ConfigSaveScheduler::GetStats(Clock::time_point now) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  if (day_start_ && now - *day_start_ >= kOneDay) {
+    stats.bytes_written_today = 0;
+  }
+  stats.saves_in_last_hour =
+      std::count_if(saves_in_last_hour_.begin(), saves_in_last_hour_.end(), [now](Clock::time_point save) {
+        return now - save < kOneHour;
+      });
+  stats.save_delay = save_delay_;
+  stats.dirty_section_count = dirty_sections_.size();
+  if (oldest_dirty_change_) {
+    stats.dirty_age = std::chrono::duration_cast<std::chrono::milliseconds>(now - *oldest_dirty_change_);
+  }
+  return stats;
+}
+
+void ConfigSaveScheduler::StartNewDayIfNeeded(Clock::time_point now) {
+  if (!day_start_ || now - *day_start_ >= kOneDay) {
+    day_start_ = now;
+    stats_.bytes_written_today = 0;
+  }
+}
+
+void ConfigSaveScheduler::ForgetSavesOlderThanAnHour(Clock::time_point now) {
+  while (!saves_in_last_hour_.empty() && now - saves_in_last_hour_.front() >= kOneHour) {
+    saves_in_last_hour_.pop_front();
+  }
+}
+
+}  // namespace storage
+}  // namespace bluetooth
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+namespace bluetooth {
+namespace storage {
+
+// Decide how long to wait before saving config changes, so that bursts of changes cost few writes
+//
+// The delay starts at |min_delay| and doubles after each save made less than |max_delay| after the previous one, up to
+// |max_delay|, and goes back to |min_delay| once saves are spaced out again. Once |daily_write_budget_bytes| were
+// written within a day, saves are delayed by |max_delay| until the day is over. Sections changed since the last save
+// are tracked to report how long changes stay in memory only. All methods are thread safe.
+class ConfigSaveScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  ConfigSaveScheduler(
+      std::chrono::milliseconds min_delay, std::chrono::milliseconds max_delay, int64_t daily_write_budget_bytes);
+
+  // Delay to wait before the next save
+  std::chrono::milliseconds GetSaveDelay() const;
+  // Record a change of |section|, to be saved by the next save
+  void OnSectionChanged(const std::string& section, Clock::time_point now);
+  // Record a save of all the changes so far, which wrote |bytes| by rewriting the config files or by appending to the
+  // journal
+  void OnSaved(size_t bytes, bool full_save, Clock::time_point now);
+
+  struct Stats {
+    int64_t full_save_count = 0;
+    int64_t journal_append_count = 0;
+    int64_t bytes_written = 0;
+    int64_t bytes_written_today = 0;
+    int64_t daily_write_budget_bytes = 0;
+    int64_t saves_in_last_hour = 0;
+    std::chrono::milliseconds save_delay{0};
+    size_t dirty_section_count = 0;
+    // Age of the oldest change not saved yet, and the largest one seen when saving
+    std::chrono::milliseconds dirty_age{0};
+    std::chrono::milliseconds max_dirty_age{0};
+  };
+  Stats GetStats(Clock::time_point now) const;
+
+ private:
+  void StartNewDayIfNeeded(Clock::time_point now);
+  void ForgetSavesOlderThanAnHour(Clock::time_point now);
+
+  const std::chrono::milliseconds min_delay_;
+  const std::chrono::milliseconds max_delay_;
+  const int64_t daily_write_budget_bytes_;
+  mutable std::mutex mutex_;
+  std::chrono::milliseconds save_delay_;
+  std::unordered_set<std::string> dirty_sections_;
+  std::optional<Clock::time_point> oldest_dirty_change_;
+  std::optional<Clock::time_point> last_save_;
+  std::deque<Clock::time_point> saves_in_last_hour_;
+  std::optional<Clock::time_point> day_start_;
+  Stats stats_;
+};
+
+}  // namespace storage
+}  // namespace bluetooth
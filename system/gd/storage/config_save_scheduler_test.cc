@@ -0,0 +1,111 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/config_save_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace testing {
+
+using bluetooth::storage::ConfigSaveScheduler;
+using std::chrono::hours;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+// Time points are synthetic, so that no test depends on the speed of the machine
+static const ConfigSaveScheduler::Clock::time_point kStart = ConfigSaveScheduler::Clock::time_point() + hours(1000);
+
+TEST(ConfigSaveSchedulerTest, delay_grows_under_load_and_resets_test) {
+  ConfigSaveScheduler scheduler(milliseconds(100), milliseconds(1000), 1024 * 1024);
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(100));
+  scheduler.OnSaved(10, false, kStart);
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(100));
+  scheduler.OnSaved(10, false, kStart + milliseconds(100));
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(200));
+  scheduler.OnSaved(10, false, kStart + milliseconds(300));
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(400));
+  scheduler.OnSaved(10, false, kStart + milliseconds(700));
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(800));
+  scheduler.OnSaved(10, false, kStart + milliseconds(1500));
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(1000));
+  // Saves spaced out by more than the maximum delay bring it back to the minimum
+  scheduler.OnSaved(10, false, kStart + seconds(10));
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(100));
+}
+
+TEST(ConfigSaveSchedulerTest, daily_write_budget_test) {
+  ConfigSaveScheduler scheduler(milliseconds(100), milliseconds(1000), 100);
+  scheduler.OnSaved(60, true, kStart);
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(100));
+  scheduler.OnSaved(60, true, kStart + hours(1));
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(1000));
+  auto stats = scheduler.GetStats(kStart + hours(1));
+  EXPECT_EQ(stats.bytes_written_today, 120);
+  EXPECT_EQ(stats.daily_write_budget_bytes, 100);
+
+  // The budget is available again the next day
+  EXPECT_EQ(scheduler.GetStats(kStart + hours(24)).bytes_written_today, 0);
+  scheduler.OnSaved(60, true, kStart + hours(25));
+  EXPECT_EQ(scheduler.GetSaveDelay(), milliseconds(100));
+  stats = scheduler.GetStats(kStart + hours(25));
+  EXPECT_EQ(stats.bytes_written_today, 60);
+  EXPECT_EQ(stats.bytes_written, 180);
+  EXPECT_EQ(stats.full_save_count, 3);
+  EXPECT_EQ(stats.journal_append_count, 0);
+}
+
+TEST(ConfigSaveSchedulerTest, saves_in_last_hour_test) {
+  ConfigSaveScheduler scheduler(milliseconds(100), milliseconds(1000), 1024 * 1024);
+  scheduler.OnSaved(10, true, kStart);
+  scheduler.OnSaved(10, false, kStart + std::chrono::minutes(30));
+  scheduler.OnSaved(10, false, kStart + std::chrono::minutes(50));
+  EXPECT_EQ(scheduler.GetStats(kStart + std::chrono::minutes(50)).saves_in_last_hour, 3);
+  EXPECT_EQ(scheduler.GetStats(kStart + std::chrono::minutes(70)).saves_in_last_hour, 2);
+  scheduler.OnSaved(10, false, kStart + std::chrono::minutes(100));
+  auto stats = scheduler.GetStats(kStart + std::chrono::minutes(100));
+  EXPECT_EQ(stats.saves_in_last_hour, 2);
+  EXPECT_EQ(stats.full_save_count, 1);
+  EXPECT_EQ(stats.journal_append_count, 3);
+}
+
+TEST(ConfigSaveSchedulerTest, dirty_sections_test) {
+  ConfigSaveScheduler scheduler(milliseconds(100), milliseconds(1000), 1024 * 1024);
+  auto stats = scheduler.GetStats(kStart);
+  EXPECT_EQ(stats.dirty_section_count, 0u);
+  EXPECT_EQ(stats.dirty_age, milliseconds(0));
+
+  scheduler.OnSectionChanged("Adapter", kStart);
+  scheduler.OnSectionChanged("AA:BB:CC:DD:EE:FF", kStart + milliseconds(50));
+  scheduler.OnSectionChanged("Adapter", kStart + milliseconds(80));
+  stats = scheduler.GetStats(kStart + milliseconds(100));
+  EXPECT_EQ(stats.dirty_section_count, 2u);
+  EXPECT_EQ(stats.dirty_age, milliseconds(100));
+
+  scheduler.OnSaved(10, false, kStart + milliseconds(300));
+  stats = scheduler.GetStats(kStart + milliseconds(300));
+  EXPECT_EQ(stats.dirty_section_count, 0u);
+  EXPECT_EQ(stats.dirty_age, milliseconds(0));
+  EXPECT_EQ(stats.max_dirty_age, milliseconds(300));
+
+  // A change saved sooner does not lower the maximum
+  scheduler.OnSectionChanged("Adapter", kStart + seconds(10));
+  scheduler.OnSaved(10, false, kStart + seconds(10) + milliseconds(100));
+  EXPECT_EQ(scheduler.GetStats(kStart + seconds(11)).max_dirty_age, milliseconds(300));
+}
+
+}  // namespace testing
@@ -44,21 +44,21 @@ std::string GetConfigSection(
     case Device::ConfigKeyAddressType::LEGACY_KEY_ADDRESS:
     case Device::ConfigKeyAddressType::CLASSIC_ADDRESS:
       return key_address_string;
-    case Device::ConfigKeyAddressType::LE_IDENTITY_ADDRESS:
-      for (const auto& section_and_property : config->GetSectionNamesWithProperty(kLeIdentityAddressKey)) {
-        if (section_and_property.property == key_address_string) {
-          return section_and_property.section;
-        }
+    case Device::ConfigKeyAddressType::LE_IDENTITY_ADDRESS: {
+      auto sections = config->GetSectionNamesWithPropertyValue(kLeIdentityAddressKey, key_address_string);
+      if (!sections.empty()) {
+        return sections.front();
       }
       return key_address_string;
-    case Device::ConfigKeyAddressType::LE_LEGACY_PSEUDO_ADDRESS:
-      for (const auto& section_and_property : config->GetSectionNamesWithProperty(kLeLegacyPseudoAddr)) {
-        if (section_and_property.property == key_address_string) {
-          return section_and_property.section;
-        }
+    }
+    case Device::ConfigKeyAddressType::LE_LEGACY_PSEUDO_ADDRESS: {
+      auto sections = config->GetSectionNamesWithPropertyValue(kLeLegacyPseudoAddr, key_address_string);
+      if (!sections.empty()) {
+        return sections.front();
       }
       // One cannot create a new device just using LE legacy pseudo address
       [[fallthrough]];
+    }
     default:
       LOG_ALWAYS_FATAL("Unknown key_address_type %d", static_cast<int>(key_address_type));
       return "";
@@ -39,11 +39,23 @@ std::optional<ConfigCache> LegacyConfigFile::Read(size_t temp_devices_capacity)
     LOG_ERROR("unable to open file '%s', error: %s", path_.c_str(), strerror(errno));
     return std::nullopt;
   }
-  int line_num = 0;
   ConfigCache cache(temp_devices_capacity, Device::kLinkKeyProperties);
+  bool parsed = Parse(config_file, [&cache](const std::string& section, std::string property, std::string value) {
+    cache.SetProperty(section, std::move(property), std::move(value));
+  });
+  if (!parsed) {
+    return std::nullopt;
+  }
+  return cache;
+}
+
+bool LegacyConfigFile::Parse(
+    std::istream& input,
+    const std::function<void(const std::string& section, std::string property, std::string value)>& on_property) {
+  int line_num = 0;
   std::string line;
   std::string section(ConfigCache::kDefaultSectionName);
-  while (std::getline(config_file, line)) {
+  while (std::getline(input, line)) {
     ++line_num;
     line = common::StringTrim(std::move(line));
     if (line.front() == '\0' || line.front() == '#') {
@@ -52,7 +64,7 @@ std::optional<ConfigCache> LegacyConfigFile::Read(size_t temp_devices_capacity)
     if (line.front() == '[') {
       if (line.back() != ']') {
         LOG_WARN("unterminated section name on line %d", line_num);
-        return std::nullopt;
+        return false;
       }
       // Read 'test' from '[text]', hence -2
       section = line.substr(1, line.size() - 2);
@@ -60,14 +72,14 @@ std::optional<ConfigCache> LegacyConfigFile::Read(size_t temp_devices_capacity)
       auto tokens = common::StringSplit(line, "=", 2);
       if (tokens.size() != 2) {
         LOG_WARN("no key/value separator found on line %d", line_num);
-        return std::nullopt;
+        return false;
       }
       tokens[0] = common::StringTrim(std::move(tokens[0]));
       tokens[1] = common::StringTrim(std::move(tokens[1]));
-      cache.SetProperty(section, tokens[0], std::move(tokens[1]));
+      on_property(section, std::move(tokens[0]), std::move(tokens[1]));
     }
   }
-  return cache;
+  return true;
 }
 
 bool LegacyConfigFile::Write(const ConfigCache& cache) {
@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <functional>
+#include <istream>
 #include <string>
 #include <utility>
 
@@ -34,6 +36,11 @@ class LegacyConfigFile {
   bool Write(const ConfigCache& cache);
   bool Delete();
 
+  // Call |on_property| with each property of |input| in order, return false if |input| is malformed
+  static bool Parse(
+      std::istream& input,
+      const std::function<void(const std::string& section, std::string property, std::string value)>& on_property);
+
  private:
   std::string path_;
 };
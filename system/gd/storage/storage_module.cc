@@ -16,10 +16,14 @@
 
 #include "storage/storage_module.h"
 
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <utility>
 
 #include "common/bind.h"
@@ -30,8 +34,11 @@
 #include "os/parameter_provider.h"
 #include "os/system_properties.h"
 #include "storage/config_cache.h"
+#include "storage/config_journal.h"
+#include "storage/config_save_scheduler.h"
 #include "storage/legacy_config_file.h"
 #include "storage/mutation.h"
+#include "storage_module_generated.h"
 
 namespace bluetooth {
 namespace storage {
@@ -49,6 +56,12 @@ static const std::chrono::milliseconds kDefaultConfigSaveDelay = std::chrono::mi
 // Writing a config to disk takes a minimum 10 ms on a decent x86_64 machine, and 20 ms if including backup file
 // The config saving delay must be bigger than this value to avoid overwhelming the disk
 static const std::chrono::milliseconds kMinConfigSaveDelay = std::chrono::milliseconds(20);
+// Rewrite the config file once the journal holds this many bytes, so that replaying it at start up stays cheap
+static const size_t kMaxJournalSize = 32 * 1024;
+// Saves coming in quick succession are spaced out up to this delay, which is also used once the daily budget is spent
+static const std::chrono::milliseconds kMaxConfigSaveDelay = std::chrono::milliseconds(30000);
+// Bytes that can be written to flash by config saves each day before saves are spaced out by the maximum delay
+static const int64_t kDailyWriteBudgetBytes = 4 * 1024 * 1024;
 
 const int kConfigFileComparePass = 1;
 const int kConfigBackupComparePass = 2;
@@ -62,19 +75,56 @@ const std::string StorageModule::kTimeCreatedFormat = "%Y-%m-%d %H:%M:%S";
 
 const std::string StorageModule::kAdapterSection = "Adapter";
 
+namespace {
+
+// The config parsed by the last StorageModule, kept from its Stop() to the next Start() so that a disable/enable
+// cycle does not parse the config file again. It is only used while the file still holds exactly what was saved.
+struct ConfigSnapshot {
+  std::string config_file_path;
+  size_t temp_devices_capacity;
+  size_t file_size;
+  size_t file_hash;
+  ConfigCache cache;
+};
+
+std::mutex config_snapshot_mutex;
+std::optional<ConfigSnapshot> config_snapshot;
+
+std::optional<ConfigCache> TakeConfigSnapshot(const std::string& config_file_path, size_t temp_devices_capacity) {
+  std::lock_guard<std::mutex> lock(config_snapshot_mutex);
+  std::optional<ConfigSnapshot> snapshot;
+  std::swap(snapshot, config_snapshot);
+  if (!snapshot || snapshot->config_file_path != config_file_path ||
+      snapshot->temp_devices_capacity != temp_devices_capacity) {
+    return std::nullopt;
+  }
+  auto file = os::ReadSmallFile(config_file_path);
+  if (!file || file->size() != snapshot->file_size || std::hash<std::string>{}(*file) != snapshot->file_hash) {
+    LOG_INFO("%s changed since the last stop", config_file_path.c_str());
+    return std::nullopt;
+  }
+  return std::move(snapshot->cache);
+}
+
+}  // namespace
+
 StorageModule::StorageModule(
     std::string config_file_path,
     std::chrono::milliseconds config_save_delay,
     size_t temp_devices_capacity,
     bool is_restricted_mode,
-    bool is_single_user_mode)
+    bool is_single_user_mode,
+    bool use_journal)
     : config_file_path_(std::move(config_file_path)),
       config_save_delay_(config_save_delay),
       temp_devices_capacity_(temp_devices_capacity),
       is_restricted_mode_(is_restricted_mode),
-      is_single_user_mode_(is_single_user_mode) {
+      is_single_user_mode_(is_single_user_mode),
+      use_journal_(use_journal) {
   // e.g. "/data/misc/bluedroid/bt_config.conf" to "/data/misc/bluedroid/bt_config.bak"
   config_backup_path_ = config_file_path_.substr(0, config_file_path_.find_last_of('.')) + ".bak";
+  // e.g. "/data/misc/bluedroid/bt_config.conf" to "/data/misc/bluedroid/bt_config.journal"
+  journal_path_ = config_file_path_.substr(0, config_file_path_.find_last_of('.')) + ".journal";
   ASSERT_LOG(
       config_save_delay > kMinConfigSaveDelay,
       "Config save delay of %lld ms is not enough, must be at least %lld ms to avoid overwhelming the disk",
@@ -89,16 +139,34 @@ StorageModule::~StorageModule() {
 
 const ModuleFactory StorageModule::Factory = ModuleFactory([]() {
   return new StorageModule(
-      os::ParameterProvider::ConfigFilePath(), kDefaultConfigSaveDelay, kDefaultTempDeviceCapacity, false, false);
+      os::ParameterProvider::ConfigFilePath(), kDefaultConfigSaveDelay, kDefaultTempDeviceCapacity, false, false, true);
 });
 
 struct StorageModule::impl {
-  explicit impl(Handler* handler, ConfigCache cache, size_t in_memory_cache_size_limit)
-      : config_save_alarm_(handler), cache_(std::move(cache)), memory_only_cache_(in_memory_cache_size_limit, {}) {}
+  explicit impl(
+      Handler* handler,
+      ConfigCache cache,
+      size_t in_memory_cache_size_limit,
+      std::chrono::milliseconds config_save_delay)
+      : config_save_alarm_(handler),
+        cache_(std::move(cache)),
+        memory_only_cache_(in_memory_cache_size_limit, {}),
+        save_scheduler_(
+            config_save_delay, std::max(config_save_delay, kMaxConfigSaveDelay), kDailyWriteBudgetBytes) {}
   Alarm config_save_alarm_;
   ConfigCache cache_;
   ConfigCache memory_only_cache_;
   bool has_pending_config_save_ = false;
+  // Size and hash of the config file as last written by SaveImmediately()
+  size_t saved_file_size_ = 0;
+  size_t saved_file_hash_ = 0;
+  // Changes not yet in the journal nor in the config file, serialized as they are made on the thread of the caller
+  std::mutex journal_mutex_;
+  std::string pending_journal_changes_;
+  size_t journal_size_ = 0;
+  // The config file must be rewritten before appending to the journal, as changes made while loading are not journaled
+  bool needs_full_save_ = true;
+  ConfigSaveScheduler save_scheduler_;
 };
 
 Mutation StorageModule::Modify() {
@@ -106,6 +174,10 @@ Mutation StorageModule::Modify() {
   return Mutation(&pimpl_->cache_, &pimpl_->memory_only_cache_);
 }
 
+void StorageModule::Post(common::OnceClosure task) {
+  GetHandler()->Post(std::move(task));
+}
+
 ConfigCache* StorageModule::GetConfigCache() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   return &pimpl_->cache_;
@@ -122,30 +194,78 @@ void StorageModule::SaveDelayed() {
     return;
   }
   pimpl_->config_save_alarm_.Schedule(
-      common::BindOnce(&StorageModule::SaveImmediately, common::Unretained(this)), config_save_delay_);
+      common::BindOnce(&StorageModule::SaveToJournal, common::Unretained(this)),
+      pimpl_->save_scheduler_.GetSaveDelay());
   pimpl_->has_pending_config_save_ = true;
 }
 
+void StorageModule::SaveToJournal() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  pimpl_->has_pending_config_save_ = false;
+  if (!use_journal_ || pimpl_->needs_full_save_ || pimpl_->journal_size_ >= kMaxJournalSize) {
+    SaveImmediately();
+    return;
+  }
+  std::string changes;
+  {
+    std::lock_guard<std::mutex> journal_lock(pimpl_->journal_mutex_);
+    changes.swap(pimpl_->pending_journal_changes_);
+  }
+  if (changes.empty()) {
+    return;
+  }
+  if (!ConfigJournal::FromPath(journal_path_).Append(changes)) {
+    LOG_WARN("cannot append to journal at %s, saving whole config", journal_path_.c_str());
+    SaveImmediately();
+    return;
+  }
+  pimpl_->journal_size_ += changes.size();
+  pimpl_->save_scheduler_.OnSaved(changes.size(), false, ConfigSaveScheduler::Clock::now());
+}
+
+void StorageModule::SaveDurably() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (pimpl_->has_pending_config_save_) {
+    pimpl_->config_save_alarm_.Cancel();
+  }
+  SaveToJournal();
+}
+
 void StorageModule::SaveImmediately() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (pimpl_->has_pending_config_save_) {
     pimpl_->config_save_alarm_.Cancel();
     pimpl_->has_pending_config_save_ = false;
   }
+  // Changes made from now on are both in the file and in the next journal, which is harmless as replaying is idempotent
+  {
+    std::lock_guard<std::mutex> journal_lock(pimpl_->journal_mutex_);
+    pimpl_->pending_journal_changes_.clear();
+  }
   // 1. rename old config to backup name
   if (os::FileExists(config_file_path_)) {
     ASSERT(os::RenameFile(config_file_path_, config_backup_path_));
   }
   // 2. write in-memory config to disk, if failed, backup can still be used
-  ASSERT(LegacyConfigFile::FromPath(config_file_path_).Write(pimpl_->cache_));
+  auto serialized = pimpl_->cache_.SerializeToLegacyFormat();
+  ASSERT(os::WriteToFile(config_file_path_, serialized));
   // 3. now write back up to disk as well
-  ASSERT(LegacyConfigFile::FromPath(config_backup_path_).Write(pimpl_->cache_));
+  ASSERT(os::WriteToFile(config_backup_path_, serialized));
   // 4. save checksum if it is running in common criteria mode
   if (bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr &&
       bluetooth::os::ParameterProvider::IsCommonCriteriaMode()) {
     bluetooth::os::ParameterProvider::GetBtKeystoreInterface()->set_encrypt_key_or_remove_key(
         kConfigFilePrefix, kConfigFileHash);
   }
+  // 5. the journal is now part of the config files
+  if (!ConfigJournal::FromPath(journal_path_).Delete()) {
+    LOG_WARN("cannot delete journal at %s", journal_path_.c_str());
+  }
+  pimpl_->journal_size_ = 0;
+  pimpl_->needs_full_save_ = false;
+  pimpl_->saved_file_size_ = serialized.size();
+  pimpl_->saved_file_hash_ = std::hash<std::string>{}(serialized);
+  pimpl_->save_scheduler_.OnSaved(2 * serialized.size(), true, ConfigSaveScheduler::Clock::now());
 }
 
 void StorageModule::ListDependencies(ModuleList* list) const {
@@ -159,24 +279,46 @@ void StorageModule::Start() {
     LOG_INFO("%s is true, delete config files", kFactoryResetProperty.c_str());
     LegacyConfigFile::FromPath(config_file_path_).Delete();
     LegacyConfigFile::FromPath(config_backup_path_).Delete();
+    ConfigJournal::FromPath(journal_path_).Delete();
     os::SetSystemProperty(kFactoryResetProperty, "false");
   }
+  // The checksum of common criteria mode only covers the config files, changes are not journaled to keep it meaningful
+  bool is_common_criteria_mode = bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr &&
+                                 bluetooth::os::ParameterProvider::IsCommonCriteriaMode();
+  if (use_journal_ && is_common_criteria_mode) {
+    LOG_INFO("not journaling config changes in common criteria mode");
+    use_journal_ = false;
+  }
   if (!is_config_checksum_pass(kConfigFileComparePass)) {
     LegacyConfigFile::FromPath(config_file_path_).Delete();
   }
   if (!is_config_checksum_pass(kConfigBackupComparePass)) {
     LegacyConfigFile::FromPath(config_backup_path_).Delete();
   }
-  auto config = LegacyConfigFile::FromPath(config_file_path_).Read(temp_devices_capacity_);
-  if (!config || !config->HasSection(kAdapterSection)) {
-    LOG_WARN("cannot load config at %s, using backup at %s.", config_file_path_.c_str(), config_backup_path_.c_str());
-    config = LegacyConfigFile::FromPath(config_backup_path_).Read(temp_devices_capacity_);
-    file_source = "Backup";
+  auto config = TakeConfigSnapshot(config_file_path_, temp_devices_capacity_);
+  if (config) {
+    LOG_INFO("reusing the config parsed before the last stop");
+  } else {
+    config = LegacyConfigFile::FromPath(config_file_path_).Read(temp_devices_capacity_);
+    if (!config || !config->HasSection(kAdapterSection)) {
+      LOG_WARN(
+          "cannot load config at %s, using backup at %s.", config_file_path_.c_str(), config_backup_path_.c_str());
+      config = LegacyConfigFile::FromPath(config_backup_path_).Read(temp_devices_capacity_);
+      file_source = "Backup";
+    }
+    if (!config || !config->HasSection(kAdapterSection)) {
+      LOG_WARN("cannot load backup config at %s; creating new empty ones", config_backup_path_.c_str());
+      config.emplace(temp_devices_capacity_, Device::kLinkKeyProperties);
+      file_source = "Empty";
+    }
   }
-  if (!config || !config->HasSection(kAdapterSection)) {
-    LOG_WARN("cannot load backup config at %s; creating new empty ones", config_backup_path_.c_str());
-    config.emplace(temp_devices_capacity_, Device::kLinkKeyProperties);
-    file_source = "Empty";
+  if (use_journal_) {
+    auto replayed = ConfigJournal::FromPath(journal_path_).Replay(&config.value());
+    if (replayed > 0) {
+      LOG_INFO("replayed %zu config changes from %s", replayed, journal_path_.c_str());
+    }
+  } else {
+    ConfigJournal::FromPath(journal_path_).Delete();
   }
   if (!file_source.empty()) {
     config->SetProperty(kInfoSection, kFileSourceProperty, std::move(file_source));
@@ -197,7 +339,15 @@ void StorageModule::Start() {
   config->FixDeviceTypeInconsistencies();
   config->SetPersistentConfigChangedCallback([this] { this->CallOn(this, &StorageModule::SaveDelayed); });
   // TODO (b/158035889) Migrate metrics module to GD
-  pimpl_ = std::make_unique<impl>(GetHandler(), std::move(config.value()), temp_devices_capacity_);
+  pimpl_ = std::make_unique<impl>(GetHandler(), std::move(config.value()), temp_devices_capacity_, config_save_delay_);
+  pimpl_->cache_.SetPersistentChangeCallback(
+      [impl = pimpl_.get(), use_journal = use_journal_](ConfigCache::PersistentChange change) {
+        impl->save_scheduler_.OnSectionChanged(change.section, ConfigSaveScheduler::Clock::now());
+        if (use_journal) {
+          std::lock_guard<std::mutex> journal_lock(impl->journal_mutex_);
+          impl->pending_journal_changes_.append(ConfigJournal::Serialize(change));
+        }
+      });
   SaveDelayed();
   if (bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr) {
     bluetooth::os::ParameterProvider::GetBtKeystoreInterface()->ConvertEncryptOrDecryptKeyIfNeeded();
@@ -210,6 +360,20 @@ void StorageModule::Stop() {
   if (bluetooth::os::ParameterProvider::GetBtKeystoreInterface() != nullptr) {
     bluetooth::os::ParameterProvider::GetBtKeystoreInterface()->clear_map();
   }
+  // Keep what was just saved for the next start, unpaired devices are not kept across a restart
+  ConfigCache& cache = pimpl_->cache_;
+  cache.SetPersistentConfigChangedCallback([] {});
+  cache.SetPersistentChangeCallback([](ConfigCache::PersistentChange) {});
+  cache.RemoveTemporaryDevices();
+  {
+    std::lock_guard<std::mutex> snapshot_lock(config_snapshot_mutex);
+    config_snapshot.emplace(ConfigSnapshot{
+        config_file_path_,
+        temp_devices_capacity_,
+        pimpl_->saved_file_size_,
+        pimpl_->saved_file_hash_,
+        std::move(cache)});
+  }
   pimpl_.reset();
 }
 
@@ -217,6 +381,34 @@ std::string StorageModule::ToString() const {
   return "Storage Module";
 }
 
+DumpsysDataFinisher StorageModule::GetDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) const {
+  ASSERT(fb_builder != nullptr);
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (pimpl_ == nullptr) {
+    return [](DumpsysDataBuilder* dumpsys_builder) {};
+  }
+  auto stats = pimpl_->save_scheduler_.GetStats(ConfigSaveScheduler::Clock::now());
+  auto title = fb_builder->CreateString("----- Storage Module Dumpsys -----");
+
+  StorageModuleDataBuilder builder(*fb_builder);
+  builder.add_title(title);
+  builder.add_full_save_count(stats.full_save_count);
+  builder.add_journal_append_count(stats.journal_append_count);
+  builder.add_bytes_written(stats.bytes_written);
+  builder.add_bytes_written_today(stats.bytes_written_today);
+  builder.add_daily_write_budget_bytes(stats.daily_write_budget_bytes);
+  builder.add_saves_in_last_hour(stats.saves_in_last_hour);
+  builder.add_current_save_delay_millis(stats.save_delay.count());
+  builder.add_dirty_section_count(stats.dirty_section_count);
+  builder.add_dirty_age_millis(stats.dirty_age.count());
+  builder.add_max_dirty_age_millis(stats.max_dirty_age.count());
+  auto dumpsys_data = builder.Finish();
+
+  return [dumpsys_data](DumpsysDataBuilder* dumpsys_builder) {
+    dumpsys_builder->add_storage_module_dumpsys_data(dumpsys_data);
+  };
+}
+
 Device StorageModule::GetDeviceByLegacyKey(hci::Address legacy_key_address) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   return Device(
@@ -23,6 +23,7 @@
 #include <mutex>
 #include <string>
 
+#include "common/callback.h"
 #include "hci/address.h"
 #include "module.h"
 #include "storage/adapter_config.h"
@@ -108,11 +109,16 @@ class StorageModule : public bluetooth::Module {
   // Commit() is called. User should never touch ConfigCache() directly.
   Mutation Modify();
 
+  // Run |task| on the storage module handler, after the tasks already posted there. Users committing many entries at
+  // once use it to keep the commits off their own handler
+  void Post(common::OnceClosure task);
+
  protected:
   void ListDependencies(ModuleList* list) const override;
   void Start() override;
   void Stop() override;
   std::string ToString() const override;
+  DumpsysDataFinisher GetDumpsysData(flatbuffers::FlatBufferBuilder* builder) const override;  // Module
 
   friend shim::BtifConfigInterface;
   // For shim layer only
@@ -125,29 +131,39 @@ class StorageModule : public bluetooth::Module {
   // In some cases, one may want to save the config immediately to disk. Call this method with caution as it runs
   // immediately on the calling thread
   void SaveImmediately();
+  // Make the changes durable before returning, like SaveImmediately(), but by appending them to the journal when it
+  // is enabled instead of rewriting the config file and its backup
+  void SaveDurably();
 
   // Create the storage module where:
   // - config_file_path is the path to the config file on disk, a .bak file will be created with the original
   // - config_save_delay is the duration after which to dump config to disk after SaveDelayed() is called
   // - temp_devices_capacity is the number of temporary, typically unpaired devices to hold in a memory based LRU
   // - is_restricted_mode and is_single_user_mode are flags from upper layer
+  // - use_journal is whether to append changes to a .journal file next to the config file instead of rewriting the
+  //   config file after each series of changes, the config file is only rewritten once the journal grows too large
   StorageModule(
       std::string config_file_path,
       std::chrono::milliseconds config_save_delay,
       size_t temp_devices_capacity,
       bool is_restricted_mode,
-      bool is_single_user_mode);
+      bool is_single_user_mode,
+      bool use_journal = false);
 
  private:
   struct impl;
+  // Append the changes since the last save to the journal, or rewrite the config file when the journal is too large
+  void SaveToJournal();
   mutable std::recursive_mutex mutex_;
   std::unique_ptr<impl> pimpl_;
   std::string config_file_path_;
   std::string config_backup_path_;
+  std::string journal_path_;
   std::chrono::milliseconds config_save_delay_;
   size_t temp_devices_capacity_;
   bool is_restricted_mode_;
   bool is_single_user_mode_;
+  bool use_journal_;
   static bool is_config_checksum_pass(int check_bit);
 };
 
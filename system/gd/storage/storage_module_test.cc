@@ -24,6 +24,7 @@
 #include <ctime>
 #include <filesystem>
 #include <iomanip>
+#include <memory>
 #include <optional>
 #include <thread>
 
@@ -81,13 +82,15 @@ class TestStorageModule : public StorageModule {
       std::chrono::milliseconds config_save_delay,
       size_t temp_devices_capacity,
       bool is_restricted_mode,
-      bool is_single_user_mode)
+      bool is_single_user_mode,
+      bool use_journal = false)
       : StorageModule(
             std::move(config_file_path),
             config_save_delay,
             temp_devices_capacity,
             is_restricted_mode,
-            is_single_user_mode) {}
+            is_single_user_mode,
+            use_journal) {}
 
   ConfigCache* GetConfigCachePublic() {
     return StorageModule::GetConfigCache();
@@ -100,6 +103,10 @@ class TestStorageModule : public StorageModule {
   void SaveImmediatelyPublic() {
     StorageModule::SaveImmediately();
   }
+
+  void SaveDurablyPublic() {
+    StorageModule::SaveDurably();
+  }
 };
 
 class StorageModuleTest : public Test {
@@ -283,6 +290,63 @@ TEST_F(StorageModuleTest, save_config_test) {
   ASSERT_TRUE(std::filesystem::exists(temp_config_));
 }
 
+TEST_F(StorageModuleTest, save_durably_appends_to_journal_test) {
+  ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
+  auto temp_journal = temp_dir_ / "temp_config.journal";
+
+  auto* storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, 10, false, false, true);
+  auto test_registry = std::make_unique<TestModuleRegistry>();
+  test_registry->InjectTestModule(&StorageModule::Factory, storage);
+
+  // The first save after start up rewrites the config file
+  storage->SaveDurablyPublic();
+  ASSERT_FALSE(std::filesystem::exists(temp_journal));
+
+  // Then the changes are appended to the journal, the config file is left as it is
+  storage->GetConfigCachePublic()->SetProperty("01:02:03:ab:cd:ea", "LinkKey", "123456");
+  storage->SaveDurablyPublic();
+  ASSERT_TRUE(std::filesystem::exists(temp_journal));
+  auto config = LegacyConfigFile::FromPath(temp_config_.string()).Read(10);
+  ASSERT_TRUE(config);
+  ASSERT_FALSE(config->HasProperty("01:02:03:ab:cd:ea", "LinkKey"));
+
+  // Stopping folds the journal into the config file
+  test_registry->StopAll();
+  ASSERT_FALSE(std::filesystem::exists(temp_journal));
+  config = LegacyConfigFile::FromPath(temp_config_.string()).Read(10);
+  ASSERT_TRUE(config);
+  ASSERT_THAT(config->GetProperty("01:02:03:ab:cd:ea", "LinkKey"), Optional(StrEq("123456")));
+}
+
+TEST_F(StorageModuleTest, restart_reuses_saved_config_test) {
+  ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
+
+  // First start parses the file
+  auto* storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, 10, false, false);
+  auto test_registry = std::make_unique<TestModuleRegistry>();
+  test_registry->InjectTestModule(&StorageModule::Factory, storage);
+  storage->GetConfigCachePublic()->SetProperty("01:02:03:ab:cd:ea", "name", "foo");
+  storage->GetConfigCachePublic()->SetProperty("01:02:03:ab:cd:ec", "name", "unpaired");
+  test_registry->StopAll();
+
+  // Restart with the file untouched: paired devices are kept, unpaired ones are not
+  storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, 10, false, false);
+  test_registry = std::make_unique<TestModuleRegistry>();
+  test_registry->InjectTestModule(&StorageModule::Factory, storage);
+  ASSERT_THAT(storage->GetConfigCachePublic()->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(StrEq("foo")));
+  ASSERT_FALSE(storage->GetConfigCachePublic()->HasSection("01:02:03:ab:cd:ec"));
+  test_registry->StopAll();
+
+  // Restart after the file changed: the file is read again
+  ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
+  storage = new TestStorageModule(temp_config_.string(), kTestConfigSaveDelay, 10, false, false);
+  test_registry = std::make_unique<TestModuleRegistry>();
+  test_registry->InjectTestModule(&StorageModule::Factory, storage);
+  ASSERT_THAT(
+      storage->GetConfigCachePublic()->GetProperty("01:02:03:ab:cd:ea", "name"), Optional(StrEq("hello world")));
+  test_registry->StopAll();
+}
+
 TEST_F(StorageModuleTest, get_bonded_devices_test) {
   // Prepare config file
   ASSERT_TRUE(bluetooth::os::WriteToFile(temp_config_.string(), kReadTestConfig));
@@ -60,16 +60,19 @@ extern void btu_hci_msg_process(BT_HDR* p_msg);
  *
  * Function         post_to_hci_message_loop
  *
- * Description      Post an HCI event to the main thread
+ * Description      Post an HCI event to the main thread, or process it
+ *                  right away if the main thread shares the calling Gd thread
+ *                  and has nothing queued
  *
  * Returns          None
  *
  *****************************************************************************/
 static void post_to_main_message_loop(const base::Location& from_here,
                                       BT_HDR* p_msg) {
-  if (do_in_main_thread(from_here, base::Bind(&btu_hci_msg_process, p_msg)) !=
+  if (do_in_main_thread_or_run(from_here,
+                               base::Bind(&btu_hci_msg_process, p_msg)) !=
       BT_STATUS_SUCCESS) {
-    LOG(ERROR) << __func__ << ": do_in_main_thread failed from "
+    LOG(ERROR) << __func__ << ": do_in_main_thread_or_run failed from "
                << from_here.ToString();
   }
 }
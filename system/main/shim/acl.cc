@@ -24,15 +24,17 @@
 #include <cstdint>
 #include <functional>
 #include <future>
-#include <map>
 #include <memory>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "btif/include/btif_hh.h"
 #include "device/include/controller.h"
 #include "gd/common/bidi_queue.h"
 #include "gd/common/bind.h"
+#include "gd/common/flat_hash_map.h"
 #include "gd/common/init_flags.h"
 #include "gd/common/strings.h"
 #include "gd/common/sync_map_count.h"
@@ -73,6 +75,8 @@ extern tBTM_CB btm_cb;
 
 bt_status_t do_in_main_thread(const base::Location& from_here,
                               base::OnceClosure task);
+bt_status_t do_in_main_thread_or_run(const base::Location& from_here,
+                                     base::OnceClosure task);
 
 using namespace bluetooth;
 
@@ -340,15 +344,30 @@ void ValidateAclInterface(const shim::legacy::acl_interface_t& acl_interface) {
              "Must provide to respond when active le connection disconnects");
 }
 
+// Call the method of obj on handler, or run it right away when the caller
+// already runs on the handler thread. bt_main_thread may share the Gd stack
+// thread, and it would wait forever for a task only it can run.
+template <typename T, typename Functor, typename... Args>
+void CallOnOrRun(os::Handler* handler, T* obj, Functor&& functor,
+                 Args&&... args) {
+  if (handler->IsOnThread()) {
+    std::invoke(std::forward<Functor>(functor), obj,
+                std::forward<Args>(args)...);
+    return;
+  }
+  handler->CallOn(obj, std::forward<Functor>(functor),
+                  std::forward<Args>(args)...);
+}
+
 }  // namespace
 
-#define TRY_POSTING_ON_MAIN(cb, ...)                               \
-  do {                                                             \
-    if (cb == nullptr) {                                           \
-      LOG_WARN("Dropping ACL event with no callback");             \
-    } else {                                                       \
-      do_in_main_thread(FROM_HERE, base::Bind(cb, ##__VA_ARGS__)); \
-    }                                                              \
+#define TRY_POSTING_ON_MAIN(cb, ...)                                      \
+  do {                                                                    \
+    if (cb == nullptr) {                                                  \
+      LOG_WARN("Dropping ACL event with no callback");                    \
+    } else {                                                              \
+      do_in_main_thread_or_run(FROM_HERE, base::Bind(cb, ##__VA_ARGS__)); \
+    }                                                                     \
   } while (0)
 
 constexpr HciHandle kInvalidHciHandle = 0xffff;
@@ -407,8 +426,8 @@ class ShimAclConnection {
     if (send_data_upwards_ == nullptr) {
       LOG_WARN("Dropping ACL data with no callback");
       osi_free(p_buf);
-    } else if (do_in_main_thread(FROM_HERE,
-                                 base::Bind(send_data_upwards_, p_buf)) !=
+    } else if (do_in_main_thread_or_run(
+                   FROM_HERE, base::Bind(send_data_upwards_, p_buf)) !=
                BT_STATUS_SUCCESS) {
       osi_free(p_buf);
     }
@@ -416,6 +435,7 @@ class ShimAclConnection {
 
   virtual void InitiateDisconnect(hci::DisconnectReason reason) = 0;
   virtual bool IsLocallyInitiated() const = 0;
+  virtual bool IsLe() const = 0;
 
   CreationTime GetCreationTime() const { return creation_time_; }
   uint16_t Handle() const { return handle_; }
@@ -687,6 +707,8 @@ class ClassicShimAclConnection
     ASSERT(connection_->SetConnectionEncryption(is_encryption_enabled));
   }
 
+  bool IsLe() const override { return false; }
+
   bool IsLocallyInitiated() const override {
     return connection_->locally_initiated_;
   }
@@ -785,6 +807,8 @@ class LeShimAclConnection
     connection_->Disconnect(reason);
   }
 
+  bool IsLe() const override { return true; }
+
   bool IsLocallyInitiated() const override {
     return connection_->locally_initiated_;
   }
@@ -805,10 +829,11 @@ struct shim::legacy::Acl::impl {
         shadow_address_resolution_list_(
             ShadowAddressResolutionList(max_address_resolution_size)) {}
 
-  std::map<HciHandle, std::unique_ptr<ClassicShimAclConnection>>
-      handle_to_classic_connection_map_;
-  std::map<HciHandle, std::unique_ptr<LeShimAclConnection>>
-      handle_to_le_connection_map_;
+  // Connections of both transports, so that the data path and the connection
+  // events find a handle with one lookup. FindClassic() and FindLe() give the
+  // transport specific connection.
+  common::FlatHashMap<HciHandle, std::unique_ptr<ShimAclConnection>>
+      handle_to_connection_map_;
 
   SyncMapCount<std::string> classic_acl_disconnect_reason_;
   SyncMapCount<std::string> le_acl_disconnect_reason_;
@@ -819,111 +844,119 @@ struct shim::legacy::Acl::impl {
   ShadowAcceptlist shadow_acceptlist_;
   ShadowAddressResolutionList shadow_address_resolution_list_;
 
-  bool IsClassicAcl(HciHandle handle) {
-    return handle_to_classic_connection_map_.find(handle) !=
-           handle_to_classic_connection_map_.end();
+  ClassicShimAclConnection* FindClassic(HciHandle handle) const {
+    auto connection = handle_to_connection_map_.find(handle);
+    if (connection == handle_to_connection_map_.end() ||
+        connection->second->IsLe()) {
+      return nullptr;
+    }
+    return static_cast<ClassicShimAclConnection*>(connection->second.get());
+  }
+
+  LeShimAclConnection* FindLe(HciHandle handle) const {
+    auto connection = handle_to_connection_map_.find(handle);
+    if (connection == handle_to_connection_map_.end() ||
+        !connection->second->IsLe()) {
+      return nullptr;
+    }
+    return static_cast<LeShimAclConnection*>(connection->second.get());
   }
 
-  void EnqueueClassicPacket(HciHandle handle,
-                            std::unique_ptr<packet::RawBuilder> packet) {
-    ASSERT_LOG(IsClassicAcl(handle), "handle %d is not a classic connection",
+  ClassicShimAclConnection* GetClassic(HciHandle handle) const {
+    auto connection = FindClassic(handle);
+    ASSERT_LOG(connection != nullptr, "handle %d is not a classic connection",
                handle);
-    handle_to_classic_connection_map_[handle]->EnqueuePacket(std::move(packet));
+    return connection;
   }
 
-  bool IsLeAcl(HciHandle handle) {
-    return handle_to_le_connection_map_.find(handle) !=
-           handle_to_le_connection_map_.end();
+  bool EnqueuePacket(HciHandle handle,
+                     std::unique_ptr<packet::RawBuilder> packet) {
+    auto connection = handle_to_connection_map_.find(handle);
+    if (connection == handle_to_connection_map_.end()) {
+      return false;
+    }
+    connection->second->EnqueuePacket(std::move(packet));
+    return true;
   }
 
-  void EnqueueLePacket(HciHandle handle,
-                       std::unique_ptr<packet::RawBuilder> packet) {
-    ASSERT_LOG(IsLeAcl(handle), "handle %d is not a LE connection", handle);
-    handle_to_le_connection_map_[handle]->EnqueuePacket(std::move(packet));
+  size_t CountConnections(bool is_le) const {
+    size_t count = 0;
+    for (const auto& connection : handle_to_connection_map_) {
+      if (connection.second->IsLe() == is_le) count++;
+    }
+    return count;
   }
 
-  void ShutdownClassicConnections(std::promise<void> promise) {
-    LOG_INFO("Shutdown gd acl shim classic connections");
-    for (auto& connection : handle_to_classic_connection_map_) {
+  // Shut down and remove the connections of one transport
+  void ShutdownConnections(bool is_le) {
+    std::vector<HciHandle> handles;
+    for (auto& connection : handle_to_connection_map_) {
+      if (connection.second->IsLe() != is_le) continue;
       connection.second->Shutdown();
+      handles.push_back(connection.first);
+    }
+    for (auto handle : handles) {
+      handle_to_connection_map_.erase(handle);
     }
-    handle_to_classic_connection_map_.clear();
+  }
+
+  void ShutdownClassicConnections(std::promise<void> promise) {
+    LOG_INFO("Shutdown gd acl shim classic connections");
+    ShutdownConnections(false);
     promise.set_value();
   }
 
   void ShutdownLeConnections(std::promise<void> promise) {
     LOG_INFO("Shutdown gd acl shim le connections");
-    for (auto& connection : handle_to_le_connection_map_) {
-      connection.second->Shutdown();
-    }
-    handle_to_le_connection_map_.clear();
+    ShutdownConnections(true);
     promise.set_value();
   }
 
   void FinalShutdown(std::promise<void> promise) {
-    if (!handle_to_classic_connection_map_.empty()) {
-      for (auto& connection : handle_to_classic_connection_map_) {
-        connection.second->Shutdown();
-      }
-      handle_to_classic_connection_map_.clear();
-      LOG_INFO("Cleared all classic connections count:%zu",
-               handle_to_classic_connection_map_.size());
-    }
-
-    if (!handle_to_le_connection_map_.empty()) {
-      for (auto& connection : handle_to_le_connection_map_) {
+    if (!handle_to_connection_map_.empty()) {
+      size_t classic_count = CountConnections(false);
+      size_t le_count = CountConnections(true);
+      for (auto& connection : handle_to_connection_map_) {
         connection.second->Shutdown();
       }
-      handle_to_le_connection_map_.clear();
-      LOG_INFO("Cleared all le connections count:%zu",
-               handle_to_le_connection_map_.size());
+      handle_to_connection_map_.clear();
+      LOG_INFO("Cleared all connections classic count:%zu le count:%zu",
+               classic_count, le_count);
     }
     promise.set_value();
   }
 
   void HoldMode(HciHandle handle, uint16_t max_interval,
                 uint16_t min_interval) {
-    ASSERT_LOG(IsClassicAcl(handle), "handle %d is not a classic connection",
-               handle);
-    handle_to_classic_connection_map_[handle]->HoldMode(max_interval,
-                                                        min_interval);
+    GetClassic(handle)->HoldMode(max_interval, min_interval);
   }
 
   void ExitSniffMode(HciHandle handle) {
-    ASSERT_LOG(IsClassicAcl(handle), "handle %d is not a classic connection",
-               handle);
-    handle_to_classic_connection_map_[handle]->ExitSniffMode();
+    GetClassic(handle)->ExitSniffMode();
   }
 
   void SniffMode(HciHandle handle, uint16_t max_interval, uint16_t min_interval,
                  uint16_t attempt, uint16_t timeout) {
-    ASSERT_LOG(IsClassicAcl(handle), "handle %d is not a classic connection",
-               handle);
-    handle_to_classic_connection_map_[handle]->SniffMode(
-        max_interval, min_interval, attempt, timeout);
+    GetClassic(handle)->SniffMode(max_interval, min_interval, attempt, timeout);
   }
 
   void SniffSubrating(HciHandle handle, uint16_t maximum_latency,
                       uint16_t minimum_remote_timeout,
                       uint16_t minimum_local_timeout) {
-    ASSERT_LOG(IsClassicAcl(handle), "handle %d is not a classic connection",
-               handle);
-    handle_to_classic_connection_map_[handle]->SniffSubrating(
+    GetClassic(handle)->SniffSubrating(
         maximum_latency, minimum_remote_timeout, minimum_local_timeout);
   }
 
   void SetConnectionEncryption(HciHandle handle, hci::Enable enable) {
-    ASSERT_LOG(IsClassicAcl(handle), "handle %d is not a classic connection",
-               handle);
-    handle_to_classic_connection_map_[handle]->SetConnectionEncryption(enable);
+    GetClassic(handle)->SetConnectionEncryption(enable);
   }
 
   void disconnect_classic(uint16_t handle, tHCI_STATUS reason,
                           std::string comment) {
-    auto connection = handle_to_classic_connection_map_.find(handle);
-    if (connection != handle_to_classic_connection_map_.end()) {
-      auto remote_address = connection->second->GetRemoteAddress();
-      connection->second->InitiateDisconnect(
+    auto connection = FindClassic(handle);
+    if (connection != nullptr) {
+      auto remote_address = connection->GetRemoteAddress();
+      connection->InitiateDisconnect(
           ToDisconnectReasonFromLegacy(reason));
       LOG_DEBUG("Disconnection initiated classic remote:%s handle:%hu",
                 PRIVATE_ADDRESS(remote_address), handle);
@@ -940,12 +973,11 @@ struct shim::legacy::Acl::impl {
   }
 
   void disconnect_le(uint16_t handle, tHCI_STATUS reason, std::string comment) {
-    auto connection = handle_to_le_connection_map_.find(handle);
-    if (connection != handle_to_le_connection_map_.end()) {
-      auto remote_address_with_type =
-          connection->second->GetRemoteAddressWithType();
+    auto connection = FindLe(handle);
+    if (connection != nullptr) {
+      auto remote_address_with_type = connection->GetRemoteAddressWithType();
       GetAclManager()->RemoveFromBackgroundList(remote_address_with_type);
-      connection->second->InitiateDisconnect(
+      connection->InitiateDisconnect(
           ToDisconnectReasonFromLegacy(reason));
       LOG_DEBUG("Disconnection initiated le remote:%s handle:%hu",
                 PRIVATE_ADDRESS(remote_address_with_type), handle);
@@ -1091,6 +1123,9 @@ struct shim::legacy::Acl::impl {
 extern tL2C_CB l2cb;
 void DumpsysL2cap(int fd) {
   LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+  LOG_DUMPSYS(fd, "ccb pool in_use:%u peak:%u allocated:%u max:%u",
+              l2cb.num_used_ccbs, l2cb.peak_used_ccbs, l2cb.num_ccbs,
+              l2cb.max_ccbs);
   for (int i = 0; i < MAX_L2CAP_LINKS; i++) {
     const tL2C_LCB& lcb = l2cb.lcb_pool[i];
     if (!lcb.in_use) continue;
@@ -1161,12 +1196,15 @@ void DumpsysAcl(int fd) {
       LOG_DUMPSYS(fd, "    [le] conn_addr:%s[%s]",
                   link.conn_addr.ToString().c_str(),
                   AddressTypeText(link.conn_addr_type).c_str());
+      LOG_DUMPSYS(fd,
+                  "    [le] tx_octets:%hu tx_phy:%hhu goodput:x%.1f of 27 "
+                  "octets on 1M",
+                  link.le_tx_octets, link.le_tx_phy, link.LeGoodputGain());
     }
   }
 }
 #undef DUMPSYS_TAG
 
-using Record = common::TimestampedEntry<std::string>;
 const std::string kTimeFormat("%Y-%m-%d %H:%M:%S");
 
 #define DUMPSYS_TAG "shim::legacy::hid"
@@ -1201,15 +1239,24 @@ void DumpsysHid(int fd) {
 void DumpsysBtm(int fd) {
   LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
   if (btm_cb.history_ != nullptr) {
-    std::vector<Record> history = btm_cb.history_->Pull();
-    for (auto& record : history) {
-      time_t then = record.timestamp / 1000;
+    for (const auto& entry : btm_cb.history_->Pull()) {
+      time_t then = entry.timestamp / 1000;
       struct tm tm;
       localtime_r(&then, &tm);
       auto s2 = common::StringFormatTime(kTimeFormat, tm);
-      LOG_DUMPSYS(fd, " %s.%03u %s", s2.c_str(),
-                  static_cast<unsigned int>(record.timestamp % 1000),
-                  record.entry.c_str());
+      const tBTM_LOG_HISTORY_RECORD& record = entry.record;
+      if (!record.has_addr) {
+        LOG_DUMPSYS(fd, " %s.%03u %s", s2.c_str(),
+                    static_cast<unsigned int>(entry.timestamp % 1000),
+                    record.msg);
+        continue;
+      }
+      std::string addr = record.has_addr_type
+                             ? std::string(PRIVATE_ADDRESS(record.addr))
+                             : std::string(PRIVATE_ADDRESS(record.addr.bda));
+      LOG_DUMPSYS(fd, " %s.%03u %-6s %-25s: %s %s", s2.c_str(),
+                  static_cast<unsigned int>(entry.timestamp % 1000),
+                  record.tag, record.msg, addr.c_str(), record.extra);
     }
   }
 }
@@ -1284,30 +1331,30 @@ shim::legacy::Acl::~Acl() {
 bool shim::legacy::Acl::CheckForOrphanedAclConnections() const {
   bool orphaned_acl_connections = false;
 
-  if (!pimpl_->handle_to_classic_connection_map_.empty()) {
+  if (pimpl_->CountConnections(false) != 0) {
     LOG_ERROR("About to destroy classic active ACL");
-    for (const auto& connection : pimpl_->handle_to_classic_connection_map_) {
-      LOG_ERROR("  Orphaned classic ACL handle:0x%04x bd_addr:%s created:%s",
-                connection.second->Handle(),
-                PRIVATE_ADDRESS(connection.second->GetRemoteAddress()),
-                common::StringFormatTimeWithMilliseconds(
-                    kConnectionDescriptorTimeFormat,
-                    connection.second->GetCreationTime())
-                    .c_str());
+    for (const auto& [handle, connection] : pimpl_->handle_to_connection_map_) {
+      if (connection->IsLe()) continue;
+      LOG_ERROR(
+          "  Orphaned classic ACL handle:0x%04x bd_addr:%s created:%s", handle,
+          PRIVATE_ADDRESS(pimpl_->FindClassic(handle)->GetRemoteAddress()),
+          common::StringFormatTimeWithMilliseconds(
+              kConnectionDescriptorTimeFormat, connection->GetCreationTime())
+              .c_str());
     }
     orphaned_acl_connections = true;
   }
 
-  if (!pimpl_->handle_to_le_connection_map_.empty()) {
+  if (pimpl_->CountConnections(true) != 0) {
     LOG_ERROR("About to destroy le active ACL");
-    for (const auto& connection : pimpl_->handle_to_le_connection_map_) {
-      LOG_ERROR("  Orphaned le ACL handle:0x%04x bd_addr:%s created:%s",
-                connection.second->Handle(),
-                PRIVATE_ADDRESS(connection.second->GetRemoteAddressWithType()),
-                common::StringFormatTimeWithMilliseconds(
-                    kConnectionDescriptorTimeFormat,
-                    connection.second->GetCreationTime())
-                    .c_str());
+    for (const auto& [handle, connection] : pimpl_->handle_to_connection_map_) {
+      if (!connection->IsLe()) continue;
+      LOG_ERROR(
+          "  Orphaned le ACL handle:0x%04x bd_addr:%s created:%s", handle,
+          PRIVATE_ADDRESS(pimpl_->FindLe(handle)->GetRemoteAddressWithType()),
+          common::StringFormatTimeWithMilliseconds(
+              kConnectionDescriptorTimeFormat, connection->GetCreationTime())
+              .c_str());
     }
     orphaned_acl_connections = true;
   }
@@ -1321,11 +1368,7 @@ void shim::legacy::Acl::on_incoming_acl_credits(uint16_t handle,
 
 void shim::legacy::Acl::write_data_sync(
     HciHandle handle, std::unique_ptr<packet::RawBuilder> packet) {
-  if (pimpl_->IsClassicAcl(handle)) {
-    pimpl_->EnqueueClassicPacket(handle, std::move(packet));
-  } else if (pimpl_->IsLeAcl(handle)) {
-    pimpl_->EnqueueLePacket(handle, std::move(packet));
-  } else {
+  if (!pimpl_->EnqueuePacket(handle, std::move(packet))) {
     LOG_ERROR("Unable to find destination to write data\n");
   }
 }
@@ -1358,8 +1401,8 @@ void shim::legacy::Acl::AcceptLeConnectionFrom(
     std::promise<bool> promise) {
   LOG_DEBUG("AcceptLeConnectionFrom %s",
             PRIVATE_ADDRESS(address_with_type.GetAddress()));
-  handler_->CallOn(pimpl_.get(), &Acl::impl::accept_le_connection_from,
-                   address_with_type, is_direct, std::move(promise));
+  CallOnOrRun(handler_, pimpl_.get(), &Acl::impl::accept_le_connection_from,
+              address_with_type, is_direct, std::move(promise));
 }
 
 void shim::legacy::Acl::IgnoreLeConnectionFrom(
@@ -1372,16 +1415,14 @@ void shim::legacy::Acl::IgnoreLeConnectionFrom(
 
 void shim::legacy::Acl::OnClassicLinkDisconnected(HciHandle handle,
                                                   hci::ErrorCode reason) {
-  hci::Address remote_address =
-      pimpl_->handle_to_classic_connection_map_[handle]->GetRemoteAddress();
-  CreationTime creation_time =
-      pimpl_->handle_to_classic_connection_map_[handle]->GetCreationTime();
-  bool is_locally_initiated =
-      pimpl_->handle_to_classic_connection_map_[handle]->IsLocallyInitiated();
+  const ClassicShimAclConnection* connection = pimpl_->FindClassic(handle);
+  hci::Address remote_address = connection->GetRemoteAddress();
+  CreationTime creation_time = connection->GetCreationTime();
+  bool is_locally_initiated = connection->IsLocallyInitiated();
 
   TeardownTime teardown_time = std::chrono::system_clock::now();
 
-  pimpl_->handle_to_classic_connection_map_.erase(handle);
+  pimpl_->handle_to_connection_map_.erase(handle);
   TRY_POSTING_ON_MAIN(acl_interface_.connection.classic.on_disconnected,
                       ToLegacyHciErrorCode(hci::ErrorCode::SUCCESS), handle,
                       ToLegacyHciErrorCode(reason));
@@ -1401,7 +1442,9 @@ bluetooth::hci::AddressWithType shim::legacy::Acl::GetConnectionLocalAddress(
     const RawAddress& remote_bda) {
   bluetooth::hci::AddressWithType address_with_type;
   auto remote_address = ToGdAddress(remote_bda);
-  for (auto& [handle, connection] : pimpl_->handle_to_le_connection_map_) {
+  for (auto& [handle, shim_connection] : pimpl_->handle_to_connection_map_) {
+    if (!shim_connection->IsLe()) continue;
+    auto connection = static_cast<LeShimAclConnection*>(shim_connection.get());
     if (connection->GetRemoteAddressWithType().GetAddress() == remote_address) {
       return connection->GetLocalAddressWithType();
     }
@@ -1412,16 +1455,15 @@ bluetooth::hci::AddressWithType shim::legacy::Acl::GetConnectionLocalAddress(
 
 void shim::legacy::Acl::OnLeLinkDisconnected(HciHandle handle,
                                              hci::ErrorCode reason) {
+  const LeShimAclConnection* connection = pimpl_->FindLe(handle);
   hci::AddressWithType remote_address_with_type =
-      pimpl_->handle_to_le_connection_map_[handle]->GetRemoteAddressWithType();
-  CreationTime creation_time =
-      pimpl_->handle_to_le_connection_map_[handle]->GetCreationTime();
-  bool is_locally_initiated =
-      pimpl_->handle_to_le_connection_map_[handle]->IsLocallyInitiated();
+      connection->GetRemoteAddressWithType();
+  CreationTime creation_time = connection->GetCreationTime();
+  bool is_locally_initiated = connection->IsLocallyInitiated();
 
   TeardownTime teardown_time = std::chrono::system_clock::now();
 
-  pimpl_->handle_to_le_connection_map_.erase(handle);
+  pimpl_->handle_to_connection_map_.erase(handle);
   TRY_POSTING_ON_MAIN(acl_interface_.connection.le.on_disconnected,
                       ToLegacyHciErrorCode(hci::ErrorCode::SUCCESS), handle,
                       ToLegacyHciErrorCode(reason));
@@ -1446,16 +1488,16 @@ void shim::legacy::Acl::OnConnectSuccess(
   const hci::Address remote_address = connection->GetAddress();
   const RawAddress bd_addr = ToRawAddress(remote_address);
 
-  pimpl_->handle_to_classic_connection_map_.emplace(
-      handle, std::make_unique<ClassicShimAclConnection>(
-                  acl_interface_.on_send_data_upwards,
-                  std::bind(&shim::legacy::Acl::OnClassicLinkDisconnected, this,
-                            std::placeholders::_1, std::placeholders::_2),
-                  acl_interface_.link.classic, handler_, std::move(connection),
-                  std::chrono::system_clock::now()));
-  pimpl_->handle_to_classic_connection_map_[handle]->RegisterCallbacks();
-  pimpl_->handle_to_classic_connection_map_[handle]
-      ->ReadRemoteControllerInformation();
+  auto shim_connection = std::make_unique<ClassicShimAclConnection>(
+      acl_interface_.on_send_data_upwards,
+      std::bind(&shim::legacy::Acl::OnClassicLinkDisconnected, this,
+                std::placeholders::_1, std::placeholders::_2),
+      acl_interface_.link.classic, handler_, std::move(connection),
+      std::chrono::system_clock::now());
+  ClassicShimAclConnection* classic_connection = shim_connection.get();
+  pimpl_->handle_to_connection_map_.emplace(handle, std::move(shim_connection));
+  classic_connection->RegisterCallbacks();
+  classic_connection->ReadRemoteControllerInformation();
 
   TRY_POSTING_ON_MAIN(acl_interface_.connection.classic.on_connected, bd_addr,
                       handle, false);
@@ -1529,14 +1571,15 @@ void shim::legacy::Acl::OnLeConnectSuccess(
   tBLE_ADDR_TYPE peer_addr_type =
       (tBLE_ADDR_TYPE)connection->peer_address_with_type_.GetAddressType();
 
-  pimpl_->handle_to_le_connection_map_.emplace(
-      handle, std::make_unique<LeShimAclConnection>(
-                  acl_interface_.on_send_data_upwards,
-                  std::bind(&shim::legacy::Acl::OnLeLinkDisconnected, this,
-                            std::placeholders::_1, std::placeholders::_2),
-                  acl_interface_.link.le, handler_, std::move(connection),
-                  std::chrono::system_clock::now()));
-  pimpl_->handle_to_le_connection_map_[handle]->RegisterCallbacks();
+  auto shim_connection = std::make_unique<LeShimAclConnection>(
+      acl_interface_.on_send_data_upwards,
+      std::bind(&shim::legacy::Acl::OnLeLinkDisconnected, this,
+                std::placeholders::_1, std::placeholders::_2),
+      acl_interface_.link.le, handler_, std::move(connection),
+      std::chrono::system_clock::now());
+  LeShimAclConnection* le_connection = shim_connection.get();
+  pimpl_->handle_to_connection_map_.emplace(handle, std::move(shim_connection));
+  le_connection->RegisterCallbacks();
 
   // Once an le connection has successfully been established
   // the device address is removed from the controller accept list.
@@ -1552,9 +1595,9 @@ void shim::legacy::Acl::OnLeConnectSuccess(
     pimpl_->shadow_acceptlist_.Remove(address_with_type);
   }
 
-  if (!pimpl_->handle_to_le_connection_map_[handle]->IsInFilterAcceptList() &&
+  if (!le_connection->IsInFilterAcceptList() &&
       connection_role == hci::Role::CENTRAL) {
-    pimpl_->handle_to_le_connection_map_[handle]->InitiateDisconnect(
+    le_connection->InitiateDisconnect(
         hci::DisconnectReason::REMOTE_USER_TERMINATED_CONNECTION);
     LOG_INFO("Disconnected ACL after connection canceled");
     BTM_LogHistory(kBtmLogTag, ToLegacyAddressWithType(address_with_type),
@@ -1562,8 +1605,7 @@ void shim::legacy::Acl::OnLeConnectSuccess(
     return;
   }
 
-  pimpl_->handle_to_le_connection_map_[handle]
-      ->ReadRemoteControllerInformation();
+  le_connection->ReadRemoteControllerInformation();
 
   tBLE_BD_ADDR legacy_address_with_type =
       ToLegacyAddressWithType(address_with_type);
@@ -1651,15 +1693,16 @@ void shim::legacy::Acl::Shutdown() {
   if (CheckForOrphanedAclConnections()) {
     std::promise<void> shutdown_promise;
     auto shutdown_future = shutdown_promise.get_future();
-    handler_->CallOn(pimpl_.get(), &Acl::impl::ShutdownClassicConnections,
-                     std::move(shutdown_promise));
+    CallOnOrRun(handler_, pimpl_.get(),
+                &Acl::impl::ShutdownClassicConnections,
+                std::move(shutdown_promise));
     shutdown_future.wait();
 
     shutdown_promise = std::promise<void>();
 
     shutdown_future = shutdown_promise.get_future();
-    handler_->CallOn(pimpl_.get(), &Acl::impl::ShutdownLeConnections,
-                     std::move(shutdown_promise));
+    CallOnOrRun(handler_, pimpl_.get(), &Acl::impl::ShutdownLeConnections,
+                std::move(shutdown_promise));
     shutdown_future.wait();
     LOG_WARN("Flushed open ACL connections");
   } else {
@@ -1668,6 +1711,10 @@ void shim::legacy::Acl::Shutdown() {
 }
 
 void shim::legacy::Acl::FinalShutdown() {
+  // The acl manager and the shim handler run on the Gd stack thread, which may
+  // also be bt_main_thread: waiting for them there would never return.
+  ASSERT_LOG(!handler_->IsOnThread(),
+             "Final shutdown must not run on the Gd stack thread");
   std::promise<void> promise;
   auto future = promise.get_future();
   GetAclManager()->UnregisterCallbacks(this, std::move(promise));
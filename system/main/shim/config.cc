@@ -162,7 +162,7 @@ void BtifConfigInterface::ConvertEncryptOrDecryptKeyIfNeeded() {
 
 void BtifConfigInterface::Save() { GetStorage()->SaveDelayed(); }
 
-void BtifConfigInterface::Flush() { GetStorage()->SaveImmediately(); }
+void BtifConfigInterface::Flush() { GetStorage()->SaveDurably(); }
 
 void BtifConfigInterface::Clear() { GetStorage()->GetConfigCache()->Clear(); }
 
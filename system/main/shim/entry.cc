@@ -40,6 +40,7 @@ namespace bluetooth {
 namespace shim {
 
 os::Handler* GetGdShimHandler() { return Stack::GetInstance()->GetHandler(); }
+os::Thread* GetGdShimThread() { return Stack::GetInstance()->GetThread(); }
 
 hci::LeAdvertisingManager* GetAdvertising() {
   return Stack::GetInstance()
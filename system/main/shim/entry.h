@@ -34,6 +34,7 @@
 namespace bluetooth {
 namespace os {
 class Handler;
+class Thread;
 }
 namespace activity_attribution {
 class ActivityAttribution;
@@ -80,6 +81,9 @@ class Dumpsys;
 /* This returns a handler that might be used in shim to receive callbacks from
  * within the stack. */
 os::Handler* GetGdShimHandler();
+/* This returns the thread the Gd modules run on, or nullptr if there is none
+ * the legacy stack may share. */
+os::Thread* GetGdShimThread();
 hci::LeAdvertisingManager* GetAdvertising();
 bluetooth::hci::Controller* GetController();
 neighbor::DiscoverabilityModule* GetDiscoverability();
@@ -56,6 +56,13 @@ static base::Callback<void(const base::Location&, BT_HDR*)> send_data_upwards;
 static const packet_fragmenter_t* packet_fragmenter;
 
 namespace {
+
+// Checked for every command and packet sent down
+bool gd_rust_is_enabled() {
+  return bluetooth::common::InitFlags::IsEnabledCached<
+      bluetooth::common::init_flags::gd_rust_is_enabled>();
+}
+
 bool is_valid_event_code(bluetooth::hci::EventCode event_code) {
   switch (event_code) {
     case bluetooth::hci::EventCode::INQUIRY_COMPLETE:
@@ -281,13 +288,8 @@ static bluetooth::os::EnqueueBuffer<bluetooth::hci::ScoBuilder>*
 
 static std::unique_ptr<bluetooth::packet::RawBuilder> MakeUniquePacket(
     const uint8_t* data, size_t len) {
-  bluetooth::packet::RawBuilder builder;
-  std::vector<uint8_t> bytes(data, data + len);
-
-  auto payload = std::make_unique<bluetooth::packet::RawBuilder>();
-  payload->AddOctets(bytes);
-
-  return payload;
+  return std::make_unique<bluetooth::packet::RawBuilder>(
+      std::vector<uint8_t>(data, data + len));
 }
 
 static BT_HDR* WrapPacketAndCopy(
@@ -299,7 +301,7 @@ static BT_HDR* WrapPacketAndCopy(
   packet->len = data->size();
   packet->layer_specific = 0;
   packet->event = event;
-  std::copy(data->begin(), data->end(), packet->data);
+  data->CopyTo(packet->data);
   return packet;
 }
 
@@ -335,7 +337,6 @@ void OnTransmitPacketCommandComplete(command_complete_cb complete_callback,
                                      bluetooth::hci::CommandCompleteView view) {
   LOG_DEBUG("Received cmd complete for %s",
             bluetooth::hci::OpCodeText(view.GetCommandOpCode()).c_str());
-  std::vector<uint8_t> data(view.begin(), view.end());
   BT_HDR* response = WrapPacketAndCopy(MSG_HC_TO_STACK_HCI_EVT, &view);
   complete_callback(response, context);
 }
@@ -716,7 +717,7 @@ static void set_data_cb(
 static void transmit_command(const BT_HDR* command,
                              command_complete_cb complete_callback,
                              command_status_cb status_callback, void* context) {
-  if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+  if (gd_rust_is_enabled()) {
     rust::transmit_command(command, complete_callback, status_callback,
                            context);
   } else {
@@ -753,7 +754,7 @@ static void transmit_fragment(BT_HDR* packet, bool send_transmit_finished) {
   if (event == MSG_STACK_TO_HC_HCI_ACL) {
     const uint8_t* stream = packet->data + packet->offset;
     size_t length = packet->len;
-    if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+    if (gd_rust_is_enabled()) {
       rust::transmit_fragment(stream, length);
     } else {
       cpp::transmit_fragment(stream, length);
@@ -761,7 +762,7 @@ static void transmit_fragment(BT_HDR* packet, bool send_transmit_finished) {
   } else if (event == MSG_STACK_TO_HC_HCI_SCO) {
     const uint8_t* stream = packet->data + packet->offset;
     size_t length = packet->len;
-    if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+    if (gd_rust_is_enabled()) {
       rust::transmit_sco_fragment(stream, length);
     } else {
       cpp::transmit_sco_fragment(stream, length);
@@ -769,7 +770,7 @@ static void transmit_fragment(BT_HDR* packet, bool send_transmit_finished) {
   } else if (event == MSG_STACK_TO_HC_HCI_ISO) {
     const uint8_t* stream = packet->data + packet->offset;
     size_t length = packet->len;
-    if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+    if (gd_rust_is_enabled()) {
       rust::transmit_iso_fragment(stream, length);
     } else {
       cpp::transmit_iso_fragment(stream, length);
@@ -802,7 +803,7 @@ static const packet_fragmenter_callbacks_t packet_fragmenter_callbacks = {
     transmit_fragment, dispatch_reassembled, fragmenter_transmit_finished};
 
 static void transmit_downward(uint16_t type, void* raw_data) {
-  if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+  if (gd_rust_is_enabled()) {
     packet_fragmenter->fragment_and_dispatch(static_cast<BT_HDR*>(raw_data));
   } else {
     bluetooth::shim::GetGdShimHandler()->Call(
@@ -824,7 +825,7 @@ const hci_t* bluetooth::shim::hci_layer_get_interface() {
 
 void bluetooth::shim::hci_on_reset_complete() {
   ASSERT(send_data_upwards);
-  if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+  if (gd_rust_is_enabled()) {
     ::rust::hci_on_reset_complete();
   }
 
@@ -845,7 +846,7 @@ void bluetooth::shim::hci_on_reset_complete() {
       continue;
     }
 
-    if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+    if (gd_rust_is_enabled()) {
       ::rust::register_event(event_code);
     } else {
       cpp::register_event(event_code);
@@ -863,7 +864,7 @@ void bluetooth::shim::hci_on_reset_complete() {
       continue;
     }
 
-    if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+    if (gd_rust_is_enabled()) {
       ::rust::register_le_event(subevent_code);
     } else {
       cpp::register_le_event(subevent_code);
@@ -871,20 +872,20 @@ void bluetooth::shim::hci_on_reset_complete() {
   }
 
   // TODO handle BQR event in GD
-  if (!bluetooth::common::init_flags::gd_rust_is_enabled()) {
+  if (!gd_rust_is_enabled()) {
     auto handler = bluetooth::shim::GetGdShimHandler();
     bluetooth::shim::GetVendorSpecificEventManager()->RegisterEventHandler(
         bluetooth::hci::VseSubeventCode::BQR_EVENT,
         handler->Bind(cpp::vendor_specific_event_callback));
   }
 
-  if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+  if (gd_rust_is_enabled()) {
     ::rust::register_for_sco();
   } else {
     cpp::register_for_sco();
   }
 
-  if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+  if (gd_rust_is_enabled()) {
     ::rust::register_for_iso();
   } else {
     cpp::register_for_iso();
@@ -892,7 +893,7 @@ void bluetooth::shim::hci_on_reset_complete() {
 }
 
 void bluetooth::shim::hci_on_shutting_down() {
-  if (bluetooth::common::init_flags::gd_rust_is_enabled()) {
+  if (gd_rust_is_enabled()) {
     ::rust::on_shutting_down();
   } else {
     cpp::on_shutting_down();
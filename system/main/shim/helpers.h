@@ -107,10 +107,8 @@ inline tBLE_BD_ADDR ToLegacyAddressWithType(
 
 inline std::unique_ptr<bluetooth::packet::RawBuilder> MakeUniquePacket(
     const uint8_t* data, size_t len, bool is_flushable) {
-  bluetooth::packet::RawBuilder builder;
-  std::vector<uint8_t> bytes(data, data + len);
-  auto payload = std::make_unique<bluetooth::packet::RawBuilder>();
-  payload->AddOctets(bytes);
+  auto payload = std::make_unique<bluetooth::packet::RawBuilder>(
+      std::vector<uint8_t>(data, data + len));
   payload->SetFlushable(is_flushable);
   return payload;
 }
@@ -119,13 +117,11 @@ inline BT_HDR* MakeLegacyBtHdrPacket(
     std::unique_ptr<bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>>
         packet,
     const std::vector<uint8_t>& preamble) {
-  std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
   BT_HDR* buffer = static_cast<BT_HDR*>(
-      osi_calloc(packet_vector.size() + preamble.size() + sizeof(BT_HDR)));
+      osi_calloc(packet->size() + preamble.size() + sizeof(BT_HDR)));
   std::copy(preamble.begin(), preamble.end(), buffer->data);
-  std::copy(packet_vector.begin(), packet_vector.end(),
-            buffer->data + preamble.size());
-  buffer->len = preamble.size() + packet_vector.size();
+  packet->CopyTo(buffer->data + preamble.size());
+  buffer->len = preamble.size() + packet->size();
   return buffer;
 }
 
@@ -229,11 +229,7 @@ struct ClassicDynamicChannelHelper {
       return;
     }
     auto packet = channel->second->GetQueueUpEnd()->TryDequeue();
-    std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
-    BT_HDR* buffer =
-        static_cast<BT_HDR*>(osi_calloc(packet_vector.size() + sizeof(BT_HDR)));
-    std::copy(packet_vector.begin(), packet_vector.end(), buffer->data);
-    buffer->len = packet_vector.size();
+    BT_HDR* buffer = MakeLegacyBtHdrPacket(std::move(packet), {});
     if (do_in_main_thread(FROM_HERE,
                           base::Bind(appl_info_.pL2CA_DataInd_Cb, cid_token,
                                      base::Unretained(buffer))) !=
@@ -922,11 +918,7 @@ struct LeFixedChannelHelper {
       return;
     }
     auto packet = channel->second->GetQueueUpEnd()->TryDequeue();
-    std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
-    BT_HDR* buffer =
-        static_cast<BT_HDR*>(osi_calloc(packet_vector.size() + sizeof(BT_HDR)));
-    std::copy(packet_vector.begin(), packet_vector.end(), buffer->data);
-    buffer->len = packet_vector.size();
+    BT_HDR* buffer = MakeLegacyBtHdrPacket(std::move(packet), {});
     auto address = bluetooth::ToRawAddress(device);
     freg_.pL2CA_FixedData_Cb(cid_, address, buffer);
   }
@@ -1419,11 +1411,7 @@ struct LeDynamicChannelHelper {
       return;
     }
     auto packet = channel->second->GetQueueUpEnd()->TryDequeue();
-    std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
-    BT_HDR* buffer =
-        static_cast<BT_HDR*>(osi_calloc(packet_vector.size() + sizeof(BT_HDR)));
-    std::copy(packet_vector.begin(), packet_vector.end(), buffer->data);
-    buffer->len = packet_vector.size();
+    BT_HDR* buffer = MakeLegacyBtHdrPacket(std::move(packet), {});
     if (do_in_main_thread(FROM_HERE,
                           base::Bind(appl_info_.pL2CA_DataInd_Cb, cid_token,
                                      base::Unretained(buffer))) !=
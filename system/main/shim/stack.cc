@@ -43,8 +43,12 @@
 #include "gd/neighbor/name.h"
 #include "gd/neighbor/name_db.h"
 #include "gd/neighbor/page.h"
+#include "gd/neighbor/radio_scheduler.h"
 #include "gd/neighbor/scan.h"
+#include "gd/os/handler_stats.h"
 #include "gd/os/log.h"
+#include "gd/os/system_properties.h"
+#include "gd/os/trace.h"
 #include "gd/security/security_module.h"
 #include "gd/shim/dumpsys.h"
 #include "gd/storage/storage_module.h"
@@ -68,6 +72,11 @@ using ::bluetooth::common::StringFormat;
 namespace {
 // PID file format
 constexpr char pid_file_format[] = "/var/run/bluetooth/bluetooth%d.pid";
+// Records closure latencies of the stack threads, reported in dumpsys
+constexpr char kPropertyHandlerStatsEnabled[] =
+    "bluetooth.os.handler_stats.enabled";
+// Writes trace events to this file, on the platforms without atrace
+constexpr char kPropertyTracePath[] = "bluetooth.os.trace.path";
 
 void CreatePidFile() {
   std::string pid_file =
@@ -166,6 +175,7 @@ void Stack::StartEverything() {
     modules.add<neighbor::NameModule>();
     modules.add<neighbor::NameDbModule>();
     modules.add<neighbor::PageModule>();
+    modules.add<neighbor::RadioSchedulerModule>();
     modules.add<neighbor::ScanModule>();
     modules.add<storage::StorageModule>();
   }
@@ -213,6 +223,16 @@ void Stack::Start(ModuleList* modules) {
   ASSERT_LOG(!is_running_, "%s Gd stack already running", __func__);
   LOG_INFO("%s Starting Gd stack", __func__);
 
+  // Properties may have been changed by other processes since the stack last
+  // ran
+  os::ReloadCachedSystemProperties();
+  os::HandlerStats::SetEnabled(
+      os::GetSystemPropertyBool(kPropertyHandlerStatsEnabled, false));
+  auto trace_path = os::GetSystemProperty(kPropertyTracePath);
+  if (trace_path && !trace_path->empty()) {
+    os::StartTracing(*trace_path);
+  }
+
   stack_thread_ =
       new os::Thread("gd_stack_thread", os::Thread::Priority::REAL_TIME);
   stack_manager_.StartUp(modules, stack_thread_);
@@ -262,6 +282,8 @@ void Stack::Stop() {
   delete stack_thread_;
   stack_thread_ = nullptr;
 
+  os::StopTracing();
+
   LOG_INFO("%s Successfully shut down Gd stack", __func__);
 }
 
@@ -308,6 +330,11 @@ os::Handler* Stack::GetHandler() {
   return stack_handler_;
 }
 
+os::Thread* Stack::GetThread() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return is_running_ ? stack_thread_ : nullptr;
+}
+
 bool Stack::IsDumpsysModuleStarted() const {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   return GetStackManager()->IsStarted<Dumpsys>();
@@ -61,6 +61,9 @@ class Stack {
 
   Btm* GetBtm();
   os::Handler* GetHandler();
+  // The thread the Gd modules run on, or nullptr if the Gd stack is not
+  // running or runs in Rust
+  os::Thread* GetThread();
 
   ::rust::Box<rust::Hci>* GetRustHci() { return rust_hci_; }
   ::rust::Box<rust::Controller>* GetRustController() {
@@ -57,3 +57,27 @@ void* allocation_tracker_notify_free(allocator_id_t allocator_id, void* ptr);
 // Get the full size for an allocation, taking into account the size of
 // canaries.
 size_t allocation_tracker_resize_for_canary(size_t size);
+
+// Maximum number of buffer pool size classes the tracker keeps statistics for.
+#define ALLOCATION_TRACKER_MAX_POOL_CLASSES 8
+
+// Buffer pool statistics. Unlike the rest of the tracker, they are kept
+// whether or not the tracker is enabled, and are reported by
+// |osi_allocator_debug_dump|. |size_class| must be below
+// |ALLOCATION_TRACKER_MAX_POOL_CLASSES|.
+
+// Declare that the blocks of |size_class| are |block_size| bytes.
+void allocation_tracker_notify_pool_class(size_t size_class,
+                                          size_t block_size);
+
+// Notify the tracker of a block of |size_class| handed out by the pool.
+// |new_block| is true if the block was carved out of fresh pool memory
+// rather than reused.
+void allocation_tracker_notify_pool_alloc(size_t size_class, bool new_block);
+
+// Notify the tracker of a block of |size_class| given back to the pool.
+void allocation_tracker_notify_pool_free(size_t size_class);
+
+// Notify the tracker of a pool allocation served by the regular allocator,
+// because it was too large for any size class or the pool was exhausted.
+void allocation_tracker_notify_pool_overflow(void);
@@ -41,6 +41,20 @@ void* osi_malloc(size_t size);
 void* osi_calloc(size_t size);
 void osi_free(void* ptr);
 
+// Enable the buffer pool backing |osi_buffer_alloc| if |enabled| is true.
+// Until this is called with |enabled| true, |osi_buffer_alloc| behaves like
+// |osi_malloc|. The pool, once enabled, stays enabled for the lifetime of
+// the process.
+void osi_buffer_pool_init(bool enabled);
+
+// Allocate a buffer of |size| bytes for a short-lived packet such as a
+// BT_HDR. Buffers that fit one of the pool size classes come from
+// per-thread caches of fixed-size blocks, so that the hot packet paths
+// neither contend on nor fragment the heap; larger ones come from
+// |osi_malloc|. Like any other allocation, the buffer is released with
+// |osi_free|, from any thread.
+void* osi_buffer_alloc(size_t size);
+
 // Free a buffer that was previously allocated with function |osi_malloc|
 // or |osi_calloc| and reset the pointer to that buffer to NULL.
 // |p_ptr| is a pointer to the buffer pointer to be reset.
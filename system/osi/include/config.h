@@ -20,11 +20,103 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 // The default section name to use if a key/value pair is not defined within
 // a section.
 #define CONFIG_DEFAULT_SECTION "Global"
 
+// A list of |T| in insertion order, which can be found in constant time by
+// their |Key| member. It offers the subset of std::list used by the config
+// users. Keys are unique, and must not change while in the list, except for
+// an element moved from right before being erased.
+template <typename T, std::string T::*Key>
+class indexed_list {
+ public:
+  using iterator = typename std::list<T>::iterator;
+  using const_iterator = typename std::list<T>::const_iterator;
+
+  indexed_list() = default;
+  indexed_list(const indexed_list& other) : list_(other.list_) { Reindex(); }
+  indexed_list(indexed_list&& other) noexcept
+      : list_(std::move(other.list_)), index_(std::move(other.index_)) {
+    other.index_.clear();
+  }
+  indexed_list& operator=(const indexed_list& other) {
+    if (this != &other) {
+      list_ = other.list_;
+      Reindex();
+    }
+    return *this;
+  }
+  indexed_list& operator=(indexed_list&& other) noexcept {
+    if (this != &other) {
+      list_ = std::move(other.list_);
+      index_ = std::move(other.index_);
+      other.list_.clear();
+      other.index_.clear();
+    }
+    return *this;
+  }
+
+  iterator begin() { return list_.begin(); }
+  iterator end() { return list_.end(); }
+  const_iterator begin() const { return list_.begin(); }
+  const_iterator end() const { return list_.end(); }
+  size_t size() const { return list_.size(); }
+  bool empty() const { return list_.empty(); }
+
+  // Return the first element with |key|, or end()
+  iterator find(const std::string& key) {
+    auto it = index_.find(key);
+    return it == index_.end() ? list_.end() : it->second;
+  }
+  const_iterator find(const std::string& key) const {
+    auto it = index_.find(key);
+    return it == index_.end() ? list_.end() : const_iterator(it->second);
+  }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    T& element = list_.emplace_back(std::forward<Args>(args)...);
+    index_.try_emplace(element.*Key, std::prev(list_.end()));
+    return element;
+  }
+
+  iterator erase(iterator position) {
+    auto it = index_.find((*position).*Key);
+    if (it != index_.end() && it->second == position) {
+      index_.erase(it);
+    } else {
+      // The element was moved from, look for it by position
+      for (it = index_.begin(); it != index_.end(); ++it) {
+        if (it->second == position) {
+          index_.erase(it);
+          break;
+        }
+      }
+    }
+    return list_.erase(position);
+  }
+
+  void clear() {
+    list_.clear();
+    index_.clear();
+  }
+
+ private:
+  void Reindex() {
+    index_.clear();
+    for (auto it = list_.begin(); it != list_.end(); ++it) {
+      index_.try_emplace((*it).*Key, it);
+    }
+  }
+
+  std::list<T> list_;
+  std::unordered_map<std::string, iterator> index_;
+};
+
 struct entry_t {
   std::string key;
   std::string value;
@@ -32,14 +124,14 @@ struct entry_t {
 
 struct section_t {
   std::string name;
-  std::list<entry_t> entries;
+  indexed_list<entry_t, &entry_t::key> entries;
   void Set(std::string key, std::string value);
   std::list<entry_t>::iterator Find(const std::string& key);
   bool Has(const std::string& key);
 };
 
 struct config_t {
-  std::list<section_t> sections;
+  indexed_list<section_t, &section_t::name> sections;
   std::list<section_t>::iterator Find(const std::string& section);
   bool Has(const std::string& section);
 };
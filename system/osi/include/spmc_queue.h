@@ -0,0 +1,86 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+// A bounded, lock-free, single producer multiple consumer flavour of
+// |fixed_queue_t| for the audio data paths.
+//
+// NOTE:
+// Only one thread at a time may enqueue into a queue. Elements may be
+// dequeued, dropped or flushed from any number of threads. None of the
+// functions below ever block the caller. Unlike |fixed_queue_t|, this queue
+// has no file descriptors and cannot be registered with a reactor.
+struct spmc_queue_t;
+typedef struct spmc_queue_t spmc_queue_t;
+
+typedef void (*spmc_queue_free_cb)(void* data);
+
+// Creates a new queue holding up to |capacity| elements. |capacity| must be
+// greater than 0. The caller must free the returned queue with
+// |spmc_queue_free|.
+spmc_queue_t* spmc_queue_new(size_t capacity);
+
+// Frees a queue and (optionally) the enqueued elements.
+// |queue| is the queue to free. If the |free_cb| callback is not null,
+// it is called on each queue element to free it. Freeing a queue that is
+// currently in use by another thread results in undefined behaviour.
+void spmc_queue_free(spmc_queue_t* queue, spmc_queue_free_cb free_cb);
+
+// Flushes a queue and (optionally) frees the enqueued elements.
+// If the |free_cb| callback is not null, it is called on each queue element
+// to free it. Returns the number of flushed elements. If |queue| is NULL,
+// the return value is 0.
+size_t spmc_queue_flush(spmc_queue_t* queue, spmc_queue_free_cb free_cb);
+
+// Returns a value indicating whether the given |queue| is empty. If |queue|
+// is NULL, the return value is true.
+bool spmc_queue_is_empty(const spmc_queue_t* queue);
+
+// Returns the length of the |queue|. If |queue| is NULL, the return value
+// is 0.
+size_t spmc_queue_length(const spmc_queue_t* queue);
+
+// Returns the maximum number of elements this queue may hold. |queue| may
+// not be NULL.
+size_t spmc_queue_capacity(const spmc_queue_t* queue);
+
+// Tries to enqueue |data| into the |queue|. If the queue is full, this
+// function returns false immediately. Otherwise, this function returns
+// true. Neither |queue| nor |data| may be NULL.
+bool spmc_queue_try_enqueue(spmc_queue_t* queue, void* data);
+
+// Tries to dequeue an element from |queue|. If the queue is empty or NULL,
+// this function returns NULL immediately. Otherwise, the oldest element in
+// the queue is returned.
+void* spmc_queue_try_dequeue(spmc_queue_t* queue);
+
+// Dequeues up to |max_count| of the oldest elements from |queue| into
+// |elements|, oldest first. Returns the number of elements dequeued. If
+// |queue| is NULL, the return value is 0. |elements| may not be NULL.
+size_t spmc_queue_try_dequeue_batch(spmc_queue_t* queue, void** elements,
+                                    size_t max_count);
+
+// Removes up to |count| of the oldest elements from |queue| and
+// (optionally) frees them with |free_cb|. Returns the number of elements
+// removed. If |queue| is NULL, the return value is 0.
+size_t spmc_queue_drop_oldest(spmc_queue_t* queue, size_t count,
+                              spmc_queue_free_cb free_cb);
@@ -0,0 +1,92 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// A lock-free flavour of |ringbuffer_t| for the byte streams between two
+// threads, e.g. the stack and an audio or socket thread.
+//
+// NOTE:
+// Only one thread at a time may write into a ring, and only one thread at a
+// time may read from it; the writer and the reader may run concurrently.
+// None of the functions below ever block the caller.
+//
+// Instead of copying, the writer may reserve the free space of the ring,
+// fill it in place and commit the bytes it wrote; the reader may reserve
+// the data, consume it in place and commit the bytes it consumed. Where the
+// platform allows it, the data memory is mapped twice back to back, so that
+// a reservation always covers all the free space or all the data, even
+// across the end of the ring. Otherwise, a reservation stops at the end of
+// the ring and the rest is reserved by the next call.
+struct spsc_ringbuffer_t;
+typedef struct spsc_ringbuffer_t spsc_ringbuffer_t;
+
+// Creates a ring holding at least |size| bytes. |size| is rounded up to a
+// power of two, and to a multiple of the page size when the memory is mapped
+// twice. Returns NULL if the memory could not be allocated. The caller must
+// free the returned ring with |spsc_ringbuffer_free|.
+spsc_ringbuffer_t* spsc_ringbuffer_init(size_t size);
+
+// Frees the ring. Safe to call with NULL.
+void spsc_ringbuffer_free(spsc_ringbuffer_t* rb);
+
+// Returns the number of bytes the ring holds when full. |rb| may not be NULL.
+size_t spsc_ringbuffer_capacity(const spsc_ringbuffer_t* rb);
+
+// Returns true if reservations are never split at the end of the ring.
+// |rb| may not be NULL.
+bool spsc_ringbuffer_is_mirrored(const spsc_ringbuffer_t* rb);
+
+// Returns the number of bytes of data in the ring. |rb| may not be NULL.
+size_t spsc_ringbuffer_size(const spsc_ringbuffer_t* rb);
+
+// Returns the number of free bytes in the ring. |rb| may not be NULL.
+size_t spsc_ringbuffer_available(const spsc_ringbuffer_t* rb);
+
+// Writer only. Returns where the next bytes are to be written, and sets
+// |length| to the number of bytes which may be written there contiguously,
+// possibly 0. The bytes are not readable until committed. Neither |rb| nor
+// |length| may be NULL.
+uint8_t* spsc_ringbuffer_write_reserve(spsc_ringbuffer_t* rb, size_t* length);
+
+// Writer only. Makes the first |length| bytes of the last write reservation
+// readable. |length| may not exceed the reserved length.
+void spsc_ringbuffer_write_commit(spsc_ringbuffer_t* rb, size_t length);
+
+// Reader only. Returns the oldest data of the ring, and sets |length| to the
+// number of bytes which may be read there contiguously, possibly 0. Neither
+// |rb| nor |length| may be NULL.
+const uint8_t* spsc_ringbuffer_read_reserve(spsc_ringbuffer_t* rb,
+                                            size_t* length);
+
+// Reader only. Releases the first |length| bytes of the last read
+// reservation to the writer. |length| may not exceed the reserved length.
+void spsc_ringbuffer_read_commit(spsc_ringbuffer_t* rb, size_t length);
+
+// Writer only. Copies up to |length| bytes from |p| into the ring. Returns
+// the number of bytes written, less than |length| if the ring is full.
+size_t spsc_ringbuffer_insert(spsc_ringbuffer_t* rb, const uint8_t* p,
+                              size_t length);
+
+// Reader only. Copies up to |length| bytes out of the ring into |p|. Returns
+// the number of bytes read, less than |length| if the ring runs empty.
+size_t spsc_ringbuffer_pop(spsc_ringbuffer_t* rb, uint8_t* p, size_t length);
@@ -20,6 +20,7 @@
 
 #include <hardware/bluetooth.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // Set the Bluetooth OS callouts to |callouts|.
 // This function should be called when native kernel wakelocks are not used
@@ -27,6 +28,16 @@
 // kernel wakelocks will be used.
 void wakelock_set_os_callouts(bt_os_callouts_t* callouts);
 
+// Set the release hysteresis of the Bluetooth wakelock: once acquired, the
+// wakelock is held for at least |min_hold_ms|, and each release is deferred by
+// |release_grace_ms|. An acquisition while a release is deferred drops the
+// release, so that bursts of short activity share one wakelock acquisition.
+// Zero values disable the hysteresis. If this function is not called, the
+// values are read from the bluetooth.wakelock.min_hold_ms and
+// bluetooth.wakelock.release_grace_ms properties, which default to zero.
+// The function is thread safe.
+void wakelock_set_hysteresis(uint64_t min_hold_ms, uint64_t release_grace_ms);
+
 // Acquire the Bluetooth wakelock.
 // The function is thread safe.
 // Return true on success, otherwise false.
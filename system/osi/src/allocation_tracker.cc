@@ -23,6 +23,7 @@
 #include <base/logging.h>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
@@ -50,6 +51,18 @@ static size_t free_counter = 0;
 static size_t alloc_total_size = 0;
 static size_t free_total_size = 0;
 
+// Buffer pool statistics, updated with relaxed atomics from the allocating
+// and freeing threads so that the pool fast path doesn't take tracker_lock
+typedef struct {
+  std::atomic<size_t> block_size;
+  std::atomic<size_t> alloc_count;
+  std::atomic<size_t> free_count;
+  std::atomic<size_t> new_block_count;
+} pool_class_stats_t;
+
+static pool_class_stats_t pool_stats[ALLOCATION_TRACKER_MAX_POOL_CLASSES];
+static std::atomic<size_t> pool_overflow_count;
+
 void allocation_tracker_init(void) {
   std::unique_lock<std::mutex> lock(tracker_lock);
   if (enabled) return;
@@ -174,6 +187,27 @@ size_t allocation_tracker_resize_for_canary(size_t size) {
   return (!enabled) ? size : size + (2 * canary_size);
 }
 
+void allocation_tracker_notify_pool_class(size_t size_class,
+                                          size_t block_size) {
+  CHECK(size_class < ALLOCATION_TRACKER_MAX_POOL_CLASSES);
+  pool_stats[size_class].block_size.store(block_size,
+                                          std::memory_order_relaxed);
+}
+
+void allocation_tracker_notify_pool_alloc(size_t size_class, bool new_block) {
+  pool_class_stats_t& stats = pool_stats[size_class];
+  stats.alloc_count.fetch_add(1, std::memory_order_relaxed);
+  if (new_block) stats.new_block_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void allocation_tracker_notify_pool_free(size_t size_class) {
+  pool_stats[size_class].free_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void allocation_tracker_notify_pool_overflow(void) {
+  pool_overflow_count.fetch_add(1, std::memory_order_relaxed);
+}
+
 void osi_allocator_debug_dump(int fd) {
   dprintf(fd, "\nBluetooth Memory Allocation Statistics:\n");
 
@@ -184,4 +218,20 @@ void osi_allocator_debug_dump(int fd) {
   dprintf(fd, "  Total allocated/free/used octets : %zu / %zu / %zu\n",
           alloc_total_size, free_total_size,
           alloc_total_size - free_total_size);
+
+  dprintf(fd, "  Buffer pool allocations served by malloc : %zu\n",
+          pool_overflow_count.load(std::memory_order_relaxed));
+  for (const auto& stats : pool_stats) {
+    size_t block_size = stats.block_size.load(std::memory_order_relaxed);
+    if (block_size == 0) continue;
+    size_t alloc_count = stats.alloc_count.load(std::memory_order_relaxed);
+    size_t free_count = stats.free_count.load(std::memory_order_relaxed);
+    size_t new_block_count =
+        stats.new_block_count.load(std::memory_order_relaxed);
+    dprintf(fd,
+            "  Buffer pool %zu octet blocks allocated/free/used/reserved : "
+            "%zu / %zu / %zu / %zu\n",
+            block_size, alloc_count, free_count, alloc_count - free_count,
+            new_block_count);
+  }
 }
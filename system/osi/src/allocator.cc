@@ -16,14 +16,165 @@
  *
  ******************************************************************************/
 #include <base/logging.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <mutex>
 
 #include "check.h"
 #include "osi/include/allocation_tracker.h"
 #include "osi/include/allocator.h"
+#include "osi/include/log.h"
 
 static const allocator_id_t alloc_allocator_id = 42;
+static const allocator_id_t buffer_pool_allocator_id = 43;
+
+namespace {
+
+// Block sizes of the buffer pool, with room for the allocation tracker
+// canaries:
+// - HCI, L2CAP and RFCOMM command buffers of BT_SMALL_BUFFER_SIZE (660)
+// - ACL and L2CAP segments up to the L2CAP MTU (1691) plus headers
+// - A2DP media packets and the other BT_DEFAULT_BUFFER_SIZE (4112) buffers
+constexpr size_t kPoolBlockSizes[] = {704, 1792, 4160};
+constexpr size_t kPoolClasses =
+    sizeof(kPoolBlockSizes) / sizeof(kPoolBlockSizes[0]);
+static_assert(kPoolClasses <= ALLOCATION_TRACKER_MAX_POOL_CLASSES,
+              "too many buffer pool size classes");
+
+// Address space reserved for the blocks of each size class. Pages are only
+// backed by memory once blocks are carved out of them, and blocks are never
+// returned to the system, so the footprint is the high-water mark of each
+// class.
+constexpr size_t kPoolClassRegionSize = 4 * 1024 * 1024;
+
+// A thread keeps up to kMaxCachedBlocks free blocks of each class, and
+// exchanges kTransferBlocks at a time with the shared free list of the class
+constexpr size_t kMaxCachedBlocks = 64;
+constexpr size_t kTransferBlocks = 32;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct PoolClass {
+  std::mutex mutex;
+  FreeBlock* free_blocks = nullptr;
+  // Bytes of the class region carved into blocks so far
+  std::atomic<size_t> carved{0};
+};
+
+std::mutex pool_init_mutex;
+std::atomic<uintptr_t> pool_base{0};
+PoolClass pool_classes[kPoolClasses];
+
+// Move up to |count| blocks from the list at |from| to the list at |to|.
+// Return the number of blocks moved.
+size_t move_blocks(FreeBlock** from, FreeBlock** to, size_t count) {
+  size_t moved = 0;
+  while (*from != nullptr && moved < count) {
+    FreeBlock* block = *from;
+    *from = block->next;
+    block->next = *to;
+    *to = block;
+    moved++;
+  }
+  return moved;
+}
+
+struct ThreadCache {
+  FreeBlock* blocks[kPoolClasses] = {};
+  size_t counts[kPoolClasses] = {};
+  // Set once the thread is exiting; blocks freed past that point go
+  // straight to the shared lists
+  bool destroyed = false;
+
+  ~ThreadCache() {
+    for (size_t size_class = 0; size_class < kPoolClasses; size_class++) {
+      PoolClass& pool_class = pool_classes[size_class];
+      std::lock_guard<std::mutex> lock(pool_class.mutex);
+      move_blocks(&blocks[size_class], &pool_class.free_blocks,
+                  counts[size_class]);
+      counts[size_class] = 0;
+    }
+    destroyed = true;
+  }
+};
+
+thread_local ThreadCache thread_cache;
+
+bool buffer_pool_owns(const void* ptr) {
+  uintptr_t base = pool_base.load(std::memory_order_relaxed);
+  return base != 0 && reinterpret_cast<uintptr_t>(ptr) - base <
+                          kPoolClasses * kPoolClassRegionSize;
+}
+
+void* buffer_pool_alloc(size_t size) {
+  uintptr_t base = pool_base.load(std::memory_order_acquire);
+  if (base == 0) return nullptr;
+
+  size_t size_class = 0;
+  while (size_class < kPoolClasses && kPoolBlockSizes[size_class] < size) {
+    size_class++;
+  }
+  if (size_class == kPoolClasses) return nullptr;
+
+  ThreadCache& cache = thread_cache;
+  if (cache.blocks[size_class] == nullptr && !cache.destroyed) {
+    PoolClass& pool_class = pool_classes[size_class];
+    std::lock_guard<std::mutex> lock(pool_class.mutex);
+    cache.counts[size_class] +=
+        move_blocks(&pool_class.free_blocks, &cache.blocks[size_class],
+                    kTransferBlocks);
+  }
+  FreeBlock* block = cache.blocks[size_class];
+  if (block != nullptr) {
+    cache.blocks[size_class] = block->next;
+    cache.counts[size_class]--;
+    allocation_tracker_notify_pool_alloc(size_class, false);
+    return block;
+  }
+
+  // No free block left, carve a new one out of the class region
+  size_t block_size = kPoolBlockSizes[size_class];
+  size_t offset = pool_classes[size_class].carved.fetch_add(
+      block_size, std::memory_order_relaxed);
+  if (offset + block_size > kPoolClassRegionSize) return nullptr;
+  allocation_tracker_notify_pool_alloc(size_class, true);
+  return reinterpret_cast<void*>(base + size_class * kPoolClassRegionSize +
+                                 offset);
+}
+
+void buffer_pool_free(void* ptr) {
+  uintptr_t offset = reinterpret_cast<uintptr_t>(ptr) -
+                     pool_base.load(std::memory_order_relaxed);
+  size_t size_class = offset / kPoolClassRegionSize;
+  allocation_tracker_notify_pool_free(size_class);
+
+  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+  PoolClass& pool_class = pool_classes[size_class];
+  ThreadCache& cache = thread_cache;
+  if (cache.destroyed) {
+    std::lock_guard<std::mutex> lock(pool_class.mutex);
+    block->next = pool_class.free_blocks;
+    pool_class.free_blocks = block;
+    return;
+  }
+
+  block->next = cache.blocks[size_class];
+  cache.blocks[size_class] = block;
+  if (++cache.counts[size_class] > kMaxCachedBlocks) {
+    std::lock_guard<std::mutex> lock(pool_class.mutex);
+    cache.counts[size_class] -=
+        move_blocks(&cache.blocks[size_class], &pool_class.free_blocks,
+                    kTransferBlocks);
+  }
+}
+
+}  // namespace
 
 char* osi_strdup(const char* str) {
   size_t size = strlen(str) + 1;  // + 1 for the null terminator
@@ -72,7 +223,45 @@ void* osi_calloc(size_t size) {
   return allocation_tracker_notify_alloc(alloc_allocator_id, ptr, size);
 }
 
+void osi_buffer_pool_init(bool enabled) {
+  if (!enabled) return;
+  std::lock_guard<std::mutex> lock(pool_init_mutex);
+  if (pool_base.load(std::memory_order_relaxed) != 0) return;
+
+  void* base = mmap(nullptr, kPoolClasses * kPoolClassRegionSize,
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    LOG_ERROR("%s unable to reserve buffer pool: %s", __func__,
+              strerror(errno));
+    return;
+  }
+  for (size_t size_class = 0; size_class < kPoolClasses; size_class++) {
+    allocation_tracker_notify_pool_class(size_class,
+                                         kPoolBlockSizes[size_class]);
+  }
+  pool_base.store(reinterpret_cast<uintptr_t>(base), std::memory_order_release);
+}
+
+void* osi_buffer_alloc(size_t size) {
+  CHECK(static_cast<ssize_t>(size) >= 0);
+  size_t real_size = allocation_tracker_resize_for_canary(size);
+  void* ptr = buffer_pool_alloc(real_size);
+  if (ptr == nullptr) {
+    if (pool_base.load(std::memory_order_relaxed) != 0) {
+      allocation_tracker_notify_pool_overflow();
+    }
+    return osi_malloc(size);
+  }
+  return allocation_tracker_notify_alloc(buffer_pool_allocator_id, ptr, size);
+}
+
 void osi_free(void* ptr) {
+  if (buffer_pool_owns(ptr)) {
+    buffer_pool_free(
+        allocation_tracker_notify_free(buffer_pool_allocator_id, ptr));
+    return;
+  }
   free(allocation_tracker_notify_free(alloc_allocator_id, ptr));
 }
 
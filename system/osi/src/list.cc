@@ -10,14 +10,23 @@ struct list_node_t {
   void* data;
 };
 
+// Nodes of removed elements are kept for the next insertions, up to this
+// many per list, so that a queue which is filled and drained again and again
+// does not allocate once it reached its usual depth.
+#define LIST_NODE_CACHE_SIZE 32
+
 typedef struct list_t {
   list_node_t* head;
   list_node_t* tail;
   size_t length;
   list_free_cb free_cb;
   const allocator_t* allocator;
+  // Unused nodes, linked through |next|
+  list_node_t* free_nodes;
+  size_t free_node_count;
 } list_t;
 
+static list_node_t* list_alloc_node_(list_t* list);
 static list_node_t* list_free_node_(list_t* list, list_node_t* node);
 
 // Hidden constructor, only to be used by the hash map for the allocation
@@ -41,6 +50,11 @@ void list_free(list_t* list) {
   if (!list) return;
 
   list_clear(list);
+  while (list->free_nodes) {
+    list_node_t* node = list->free_nodes;
+    list->free_nodes = node->next;
+    list->allocator->free(node);
+  }
   list->allocator->free(list);
 }
 
@@ -92,7 +106,7 @@ bool list_insert_after(list_t* list, list_node_t* prev_node, void* data) {
   CHECK(prev_node != NULL);
   CHECK(data != NULL);
 
-  list_node_t* node = (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+  list_node_t* node = list_alloc_node_(list);
   if (!node) return false;
 
   node->next = prev_node->next;
@@ -107,7 +121,7 @@ bool list_prepend(list_t* list, void* data) {
   CHECK(list != NULL);
   CHECK(data != NULL);
 
-  list_node_t* node = (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+  list_node_t* node = list_alloc_node_(list);
   if (!node) return false;
   node->next = list->head;
   node->data = data;
@@ -121,7 +135,7 @@ bool list_append(list_t* list, void* data) {
   CHECK(list != NULL);
   CHECK(data != NULL);
 
-  list_node_t* node = (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+  list_node_t* node = list_alloc_node_(list);
   if (!node) return false;
   node->next = NULL;
   node->data = data;
@@ -202,6 +216,16 @@ void* list_node(const list_node_t* node) {
   return node->data;
 }
 
+static list_node_t* list_alloc_node_(list_t* list) {
+  list_node_t* node = list->free_nodes;
+  if (node) {
+    list->free_nodes = node->next;
+    --list->free_node_count;
+    return node;
+  }
+  return (list_node_t*)list->allocator->alloc(sizeof(list_node_t));
+}
+
 static list_node_t* list_free_node_(list_t* list, list_node_t* node) {
   CHECK(list != NULL);
   CHECK(node != NULL);
@@ -209,7 +233,14 @@ static list_node_t* list_free_node_(list_t* list, list_node_t* node) {
   list_node_t* next = node->next;
 
   if (list->free_cb) list->free_cb(node->data);
-  list->allocator->free(node);
+  if (list->free_node_count < LIST_NODE_CACHE_SIZE) {
+    node->data = NULL;
+    node->next = list->free_nodes;
+    list->free_nodes = node;
+    ++list->free_node_count;
+  } else {
+    list->allocator->free(node);
+  }
   --list->length;
 
   return next;
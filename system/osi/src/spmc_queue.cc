@@ -0,0 +1,148 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "osi/include/spmc_queue.h"
+
+#include <base/logging.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "check.h"
+
+// Number of elements |spmc_queue_flush| and |spmc_queue_drop_oldest| take
+// out of the queue at a time
+#define SPMC_QUEUE_DROP_BATCH 16
+
+// |head| and |tail| count the elements ever dequeued and enqueued; the
+// element at position N lives in slots[N & mask]. The consumers claim
+// elements by advancing |head| with a compare-and-swap, so that a slot is
+// never reused by the producer before it has been read.
+struct spmc_queue_t {
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+  alignas(64) size_t capacity;
+  size_t mask;
+  std::atomic<void*>* slots;
+};
+
+spmc_queue_t* spmc_queue_new(size_t capacity) {
+  CHECK(capacity > 0);
+
+  size_t slot_count = 1;
+  while (slot_count < capacity) slot_count <<= 1;
+
+  spmc_queue_t* queue = new spmc_queue_t;
+  queue->capacity = capacity;
+  queue->mask = slot_count - 1;
+  queue->slots = new std::atomic<void*>[slot_count];
+  return queue;
+}
+
+void spmc_queue_free(spmc_queue_t* queue, spmc_queue_free_cb free_cb) {
+  if (queue == NULL) return;
+
+  spmc_queue_flush(queue, free_cb);
+  delete[] queue->slots;
+  delete queue;
+}
+
+size_t spmc_queue_flush(spmc_queue_t* queue, spmc_queue_free_cb free_cb) {
+  return spmc_queue_drop_oldest(queue, SIZE_MAX, free_cb);
+}
+
+bool spmc_queue_is_empty(const spmc_queue_t* queue) {
+  return spmc_queue_length(queue) == 0;
+}
+
+size_t spmc_queue_length(const spmc_queue_t* queue) {
+  if (queue == NULL) return 0;
+
+  // Read |head| first: |tail| can only have grown since
+  size_t head = queue->head.load(std::memory_order_acquire);
+  size_t tail = queue->tail.load(std::memory_order_acquire);
+  return tail - head;
+}
+
+size_t spmc_queue_capacity(const spmc_queue_t* queue) {
+  CHECK(queue != NULL);
+
+  return queue->capacity;
+}
+
+bool spmc_queue_try_enqueue(spmc_queue_t* queue, void* data) {
+  CHECK(queue != NULL);
+  CHECK(data != NULL);
+
+  size_t tail = queue->tail.load(std::memory_order_relaxed);
+  size_t head = queue->head.load(std::memory_order_acquire);
+  if (tail - head >= queue->capacity) return false;
+
+  queue->slots[tail & queue->mask].store(data, std::memory_order_relaxed);
+  queue->tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+void* spmc_queue_try_dequeue(spmc_queue_t* queue) {
+  void* data = NULL;
+  if (spmc_queue_try_dequeue_batch(queue, &data, 1) == 0) return NULL;
+  return data;
+}
+
+size_t spmc_queue_try_dequeue_batch(spmc_queue_t* queue, void** elements,
+                                    size_t max_count) {
+  CHECK(elements != NULL);
+  if (queue == NULL) return 0;
+
+  size_t head = queue->head.load(std::memory_order_acquire);
+  while (true) {
+    size_t tail = queue->tail.load(std::memory_order_acquire);
+    size_t count = std::min(tail - head, max_count);
+    if (count == 0) return 0;
+
+    for (size_t i = 0; i < count; i++) {
+      size_t slot = (head + i) & queue->mask;
+      elements[i] = queue->slots[slot].load(std::memory_order_relaxed);
+    }
+    // On failure, another consumer took some of these elements: |head| is
+    // reloaded and the elements are read again.
+    if (queue->head.compare_exchange_weak(head, head + count,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_acquire)) {
+      return count;
+    }
+  }
+}
+
+size_t spmc_queue_drop_oldest(spmc_queue_t* queue, size_t count,
+                              spmc_queue_free_cb free_cb) {
+  void* elements[SPMC_QUEUE_DROP_BATCH];
+  size_t dropped = 0;
+  while (dropped < count) {
+    size_t batch_size =
+        std::min<size_t>(count - dropped, SPMC_QUEUE_DROP_BATCH);
+    size_t batch = spmc_queue_try_dequeue_batch(queue, elements, batch_size);
+    if (batch == 0) break;
+
+    if (free_cb != NULL) {
+      for (size_t i = 0; i < batch; i++) free_cb(elements[i]);
+    }
+    dropped += batch;
+  }
+  return dropped;
+}
@@ -0,0 +1,212 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "osi/include/spsc_ringbuffer.h"
+
+#include <base/logging.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "check.h"
+
+// |head| and |tail| count the bytes ever read and written; the byte at
+// position N lives in data[N & mask]. When |mirrored|, data[capacity + i]
+// is the same memory as data[i].
+struct spsc_ringbuffer_t {
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+  alignas(64) size_t capacity;
+  size_t mask;
+  bool mirrored;
+  uint8_t* data;
+};
+
+// Maps |size| bytes of memory twice, back to back. Returns NULL if the
+// platform does not support it.
+static uint8_t* map_mirrored(size_t size) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+  int fd = syscall(SYS_memfd_create, "spsc_ringbuffer", 0);
+  if (fd < 0) return NULL;
+  if (ftruncate(fd, size) < 0) {
+    close(fd);
+    return NULL;
+  }
+
+  // Reserve the address range of both copies, then map the memory over it
+  void* base = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                    -1, 0);
+  if (base == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+  uint8_t* data = static_cast<uint8_t*>(base);
+  bool mapped =
+      mmap(data, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+           0) != MAP_FAILED &&
+      mmap(data + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+           fd, 0) != MAP_FAILED;
+  close(fd);
+  if (!mapped) {
+    munmap(base, 2 * size);
+    return NULL;
+  }
+  return data;
+#else
+  return NULL;
+#endif
+}
+
+spsc_ringbuffer_t* spsc_ringbuffer_init(size_t size) {
+  CHECK(size > 0);
+
+  size_t capacity = 1;
+  while (capacity < size) capacity <<= 1;
+
+  spsc_ringbuffer_t* rb = new spsc_ringbuffer_t;
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  rb->capacity = std::max(capacity, page_size);
+  rb->data = map_mirrored(rb->capacity);
+  rb->mirrored = rb->data != NULL;
+  if (!rb->mirrored) {
+    rb->capacity = capacity;
+    rb->data = static_cast<uint8_t*>(malloc(capacity));
+    if (rb->data == NULL) {
+      delete rb;
+      return NULL;
+    }
+  }
+  rb->mask = rb->capacity - 1;
+  return rb;
+}
+
+void spsc_ringbuffer_free(spsc_ringbuffer_t* rb) {
+  if (rb == NULL) return;
+
+  if (rb->mirrored) {
+    munmap(rb->data, 2 * rb->capacity);
+  } else {
+    free(rb->data);
+  }
+  delete rb;
+}
+
+size_t spsc_ringbuffer_capacity(const spsc_ringbuffer_t* rb) {
+  CHECK(rb != NULL);
+  return rb->capacity;
+}
+
+bool spsc_ringbuffer_is_mirrored(const spsc_ringbuffer_t* rb) {
+  CHECK(rb != NULL);
+  return rb->mirrored;
+}
+
+size_t spsc_ringbuffer_size(const spsc_ringbuffer_t* rb) {
+  CHECK(rb != NULL);
+
+  // Read |head| first: |tail| can only have grown since
+  size_t head = rb->head.load(std::memory_order_acquire);
+  size_t tail = rb->tail.load(std::memory_order_acquire);
+  return tail - head;
+}
+
+size_t spsc_ringbuffer_available(const spsc_ringbuffer_t* rb) {
+  CHECK(rb != NULL);
+
+  // Read |tail| first: |head| can only have grown since
+  size_t tail = rb->tail.load(std::memory_order_acquire);
+  size_t head = rb->head.load(std::memory_order_acquire);
+  return rb->capacity - (tail - head);
+}
+
+uint8_t* spsc_ringbuffer_write_reserve(spsc_ringbuffer_t* rb, size_t* length) {
+  CHECK(rb != NULL);
+  CHECK(length != NULL);
+
+  size_t tail = rb->tail.load(std::memory_order_relaxed);
+  size_t head = rb->head.load(std::memory_order_acquire);
+  size_t offset = tail & rb->mask;
+  *length = rb->capacity - (tail - head);
+  if (!rb->mirrored) *length = std::min(*length, rb->capacity - offset);
+  return rb->data + offset;
+}
+
+void spsc_ringbuffer_write_commit(spsc_ringbuffer_t* rb, size_t length) {
+  CHECK(rb != NULL);
+
+  size_t tail = rb->tail.load(std::memory_order_relaxed);
+  CHECK(tail - rb->head.load(std::memory_order_acquire) + length <=
+        rb->capacity);
+  rb->tail.store(tail + length, std::memory_order_release);
+}
+
+const uint8_t* spsc_ringbuffer_read_reserve(spsc_ringbuffer_t* rb,
+                                            size_t* length) {
+  CHECK(rb != NULL);
+  CHECK(length != NULL);
+
+  size_t head = rb->head.load(std::memory_order_relaxed);
+  size_t tail = rb->tail.load(std::memory_order_acquire);
+  size_t offset = head & rb->mask;
+  *length = tail - head;
+  if (!rb->mirrored) *length = std::min(*length, rb->capacity - offset);
+  return rb->data + offset;
+}
+
+void spsc_ringbuffer_read_commit(spsc_ringbuffer_t* rb, size_t length) {
+  CHECK(rb != NULL);
+
+  size_t head = rb->head.load(std::memory_order_relaxed);
+  CHECK(rb->tail.load(std::memory_order_acquire) - head >= length);
+  rb->head.store(head + length, std::memory_order_release);
+}
+
+size_t spsc_ringbuffer_insert(spsc_ringbuffer_t* rb, const uint8_t* p,
+                              size_t length) {
+  size_t count = 0;
+  // Twice at most, when the free space wraps around an unmirrored ring
+  while (count < length) {
+    size_t reserved;
+    uint8_t* data = spsc_ringbuffer_write_reserve(rb, &reserved);
+    size_t n = std::min(reserved, length - count);
+    if (n == 0) break;
+    memcpy(data, p + count, n);
+    spsc_ringbuffer_write_commit(rb, n);
+    count += n;
+  }
+  return count;
+}
+
+size_t spsc_ringbuffer_pop(spsc_ringbuffer_t* rb, uint8_t* p, size_t length) {
+  size_t count = 0;
+  // Twice at most, when the data wraps around an unmirrored ring
+  while (count < length) {
+    size_t reserved;
+    const uint8_t* data = spsc_ringbuffer_read_reserve(rb, &reserved);
+    size_t n = std::min(reserved, length - count);
+    if (n == 0) break;
+    memcpy(p + count, data, n);
+    spsc_ringbuffer_read_commit(rb, n);
+    count += n;
+  }
+  return count;
+}
@@ -24,6 +24,7 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <pthread.h>
+#include <signal.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -40,6 +41,7 @@
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/properties.h"
 #include "osi/include/thread.h"
 #include "osi/include/wakelock.h"
 
@@ -59,6 +61,21 @@ static pthread_once_t initialized = PTHREAD_ONCE_INIT;
 static int wake_lock_fd = INVALID_FD;
 static int wake_unlock_fd = INVALID_FD;
 
+static const char* MIN_HOLD_MS_PROPERTY = "bluetooth.wakelock.min_hold_ms";
+static const char* RELEASE_GRACE_MS_PROPERTY =
+    "bluetooth.wakelock.release_grace_ms";
+
+// Release hysteresis, see wakelock_set_hysteresis().
+// The state is protected by |hysteresis_mutex|.
+static std::mutex hysteresis_mutex;
+static bool hysteresis_configured = false;
+static uint64_t min_hold_ms = 0;
+static uint64_t release_grace_ms = 0;
+static bool release_pending = false;
+static uint64_t release_deadline_ms = 0;
+static timer_t release_timer;
+static bool release_timer_created = false;
+
 // Wakelock statistics for the "bluetooth_timer"
 typedef struct {
   bool is_acquired;
@@ -75,6 +92,7 @@ typedef struct {
   uint64_t last_reset_timestamp_ms;
   int last_acquired_error;
   int last_released_error;
+  size_t avoided_acquisitions;
 } wakelock_stats_t;
 
 static wakelock_stats_t wakelock_stats;
@@ -87,11 +105,18 @@ static bt_status_t wakelock_acquire_callout(void);
 static bt_status_t wakelock_acquire_native(void);
 static bt_status_t wakelock_release_callout(void);
 static bt_status_t wakelock_release_native(void);
+static bool wakelock_release_now(void);
+static uint64_t now_ms(void);
+static uint64_t wakelock_release_delay_ms(void);
+static bool arm_release_timer(uint64_t delay_ms);
+static void disarm_release_timer(void);
+static void release_timer_expired(union sigval sv);
 static void wakelock_initialize(void);
 static void wakelock_initialize_native(void);
 static void reset_wakelock_stats(void);
 static void update_wakelock_acquired_stats(bt_status_t acquired_status);
 static void update_wakelock_released_stats(bt_status_t released_status);
+static void update_wakelock_avoided_stats(void);
 
 void wakelock_set_os_callouts(bt_os_callouts_t* callouts) {
   wakelock_os_callouts = callouts;
@@ -99,9 +124,26 @@ void wakelock_set_os_callouts(bt_os_callouts_t* callouts) {
   LOG_INFO("%s set to %s", __func__, (is_native) ? "native" : "non-native");
 }
 
+void wakelock_set_hysteresis(uint64_t min_hold, uint64_t release_grace) {
+  std::lock_guard<std::mutex> lock(hysteresis_mutex);
+  hysteresis_configured = true;
+  min_hold_ms = min_hold;
+  release_grace_ms = release_grace;
+}
+
 bool wakelock_acquire(void) {
   pthread_once(&initialized, wakelock_initialize);
 
+  std::lock_guard<std::mutex> lock(hysteresis_mutex);
+  if (release_pending) {
+    // The wakelock is still held: drop the pending release rather than
+    // releasing and acquiring it again.
+    disarm_release_timer();
+    release_pending = false;
+    update_wakelock_avoided_stats();
+    return true;
+  }
+
   bt_status_t status = BT_STATUS_FAIL;
 
   if (is_native)
@@ -148,6 +190,21 @@ static bt_status_t wakelock_acquire_native(void) {
 bool wakelock_release(void) {
   pthread_once(&initialized, wakelock_initialize);
 
+  std::lock_guard<std::mutex> lock(hysteresis_mutex);
+  if (release_pending) return true;
+
+  uint64_t delay_ms = wakelock_release_delay_ms();
+  if (delay_ms > 0 && arm_release_timer(delay_ms)) {
+    release_pending = true;
+    release_deadline_ms = now_ms() + delay_ms;
+    return true;
+  }
+
+  return wakelock_release_now();
+}
+
+// NOTE: must be called with |hysteresis_mutex| held
+static bool wakelock_release_now(void) {
   bt_status_t status = BT_STATUS_FAIL;
 
   if (is_native)
@@ -160,6 +217,73 @@ bool wakelock_release(void) {
   return (status == BT_STATUS_SUCCESS);
 }
 
+// Returns how long the release of the wakelock should be deferred for: the
+// grace period, or the remainder of the minimum hold time if longer.
+// NOTE: must be called with |hysteresis_mutex| held
+static uint64_t wakelock_release_delay_ms(void) {
+  if (min_hold_ms == 0 && release_grace_ms == 0) return 0;
+
+  std::lock_guard<std::mutex> lock(stats_mutex);
+  if (!wakelock_stats.is_acquired) return 0;
+
+  uint64_t delay_ms = release_grace_ms;
+  uint64_t held_ms = now_ms() - wakelock_stats.last_acquired_timestamp_ms;
+  if (held_ms < min_hold_ms && min_hold_ms - held_ms > delay_ms)
+    delay_ms = min_hold_ms - held_ms;
+  return delay_ms;
+}
+
+// NOTE: must be called with |hysteresis_mutex| held
+static bool arm_release_timer(uint64_t delay_ms) {
+  if (!release_timer_created) {
+    struct sigevent sigevent;
+    memset(&sigevent, 0, sizeof(sigevent));
+    sigevent.sigev_notify = SIGEV_THREAD;
+    sigevent.sigev_notify_function = release_timer_expired;
+    if (timer_create(CLOCK_ID, &sigevent, &release_timer) == -1) {
+      LOG_ERROR("%s unable to create release timer: %s", __func__,
+                strerror(errno));
+      return false;
+    }
+    release_timer_created = true;
+  }
+
+  struct itimerspec timer_time;
+  memset(&timer_time, 0, sizeof(timer_time));
+  timer_time.it_value.tv_sec = delay_ms / 1000;
+  timer_time.it_value.tv_nsec = (delay_ms % 1000) * 1000000LL;
+  if (timer_settime(release_timer, 0, &timer_time, NULL) == -1) {
+    LOG_ERROR("%s unable to set release timer: %s", __func__, strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+// NOTE: must be called with |hysteresis_mutex| held
+static void disarm_release_timer(void) {
+  if (!release_timer_created) return;
+
+  struct itimerspec timer_time;
+  memset(&timer_time, 0, sizeof(timer_time));
+  timer_settime(release_timer, 0, &timer_time, NULL);
+}
+
+static void release_timer_expired(UNUSED_ATTR union sigval sv) {
+  std::lock_guard<std::mutex> lock(hysteresis_mutex);
+  if (!release_pending) return;
+
+  // The timer may have expired just before the release was dropped and
+  // deferred again, in which case it waits for the new deadline.
+  uint64_t just_now_ms = now_ms();
+  if (just_now_ms < release_deadline_ms &&
+      arm_release_timer(release_deadline_ms - just_now_ms)) {
+    return;
+  }
+
+  release_pending = false;
+  wakelock_release_now();
+}
+
 static bt_status_t wakelock_release_callout(void) {
   return static_cast<bt_status_t>(
       wakelock_os_callouts->release_wake_lock(WAKE_LOCK_ID));
@@ -184,6 +308,14 @@ static bt_status_t wakelock_release_native(void) {
 static void wakelock_initialize(void) {
   reset_wakelock_stats();
 
+  {
+    std::lock_guard<std::mutex> lock(hysteresis_mutex);
+    if (!hysteresis_configured) {
+      min_hold_ms = osi_property_get_int32(MIN_HOLD_MS_PROPERTY, 0);
+      release_grace_ms = osi_property_get_int32(RELEASE_GRACE_MS_PROPERTY, 0);
+    }
+  }
+
   if (is_native) wakelock_initialize_native();
 }
 
@@ -208,9 +340,17 @@ static void wakelock_initialize_native(void) {
 }
 
 void wakelock_cleanup(void) {
-  if (wakelock_stats.is_acquired) {
-    LOG_ERROR("%s releasing wake lock as part of cleanup", __func__);
-    wakelock_release();
+  {
+    std::lock_guard<std::mutex> lock(hysteresis_mutex);
+    if (release_pending) {
+      disarm_release_timer();
+      release_pending = false;
+    }
+    if (wakelock_stats.is_acquired) {
+      LOG_ERROR("%s releasing wake lock as part of cleanup", __func__);
+      wakelock_release_now();
+    }
+    hysteresis_configured = false;
   }
   wake_lock_path.clear();
   wake_unlock_path.clear();
@@ -250,6 +390,7 @@ static void reset_wakelock_stats(void) {
   wakelock_stats.last_acquired_timestamp_ms = 0;
   wakelock_stats.last_released_timestamp_ms = 0;
   wakelock_stats.last_reset_timestamp_ms = now_ms();
+  wakelock_stats.avoided_acquisitions = 0;
 }
 
 //
@@ -324,6 +465,16 @@ static void update_wakelock_released_stats(bt_status_t released_status) {
       bluetooth::common::WAKE_EVENT_RELEASED, "", "", just_now_ms);
 }
 
+//
+// Update the Bluetooth wakelock statistics when an acquisition is avoided by
+// dropping a pending release.
+// This function is thread-safe.
+//
+static void update_wakelock_avoided_stats(void) {
+  std::lock_guard<std::mutex> lock(stats_mutex);
+  wakelock_stats.avoided_acquisitions++;
+}
+
 void wakelock_debug_dump(int fd) {
   const uint64_t just_now_ms = now_ms();
 
@@ -353,6 +504,8 @@ void wakelock_debug_dump(int fd) {
           wakelock_stats.is_acquired ? "true" : "false");
   dprintf(fd, "  Acquired/released count        : %zu / %zu\n",
           wakelock_stats.acquired_count, wakelock_stats.released_count);
+  dprintf(fd, "  Acquisitions avoided           : %zu\n",
+          wakelock_stats.avoided_acquisitions);
   dprintf(fd, "  Acquired/released error count  : %zu / %zu\n",
           wakelock_stats.acquired_errors, wakelock_stats.released_errors);
   dprintf(fd, "  Last acquire/release error code: %d / %d\n",
@@ -16,6 +16,8 @@
  *
  ******************************************************************************/
 #include <cstring>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -50,3 +52,53 @@ TEST_F(AllocatorTest, test_osi_strndup) {
   EXPECT_EQ(0, strcmp(str, copy_str));
   osi_free(copy_str);
 }
+
+TEST_F(AllocatorTest, test_osi_buffer_alloc_reuses_blocks) {
+  osi_buffer_pool_init(true);
+
+  uint8_t* buffer = static_cast<uint8_t*>(osi_buffer_alloc(660));
+  ASSERT_NE(nullptr, buffer);
+  memset(buffer, 0x5a, 660);
+  osi_free(buffer);
+
+  // The block freed last is the first one handed out again
+  uint8_t* again = static_cast<uint8_t*>(osi_buffer_alloc(600));
+  EXPECT_EQ(buffer, again);
+
+  // Buffers of another size class come from another block
+  uint8_t* large = static_cast<uint8_t*>(osi_buffer_alloc(4112));
+  ASSERT_NE(nullptr, large);
+  EXPECT_NE(again, large);
+  memset(large, 0xa5, 4112);
+
+  osi_free(again);
+  osi_free(large);
+}
+
+TEST_F(AllocatorTest, test_osi_buffer_alloc_falls_back_to_malloc) {
+  osi_buffer_pool_init(true);
+
+  uint8_t* buffer = static_cast<uint8_t*>(osi_buffer_alloc(16384));
+  ASSERT_NE(nullptr, buffer);
+  memset(buffer, 0x5a, 16384);
+  osi_free(buffer);
+}
+
+TEST_F(AllocatorTest, test_osi_buffer_alloc_free_on_other_thread) {
+  osi_buffer_pool_init(true);
+
+  std::vector<void*> buffers;
+  for (int i = 0; i < 200; i++) {
+    buffers.push_back(osi_buffer_alloc(1000));
+  }
+  std::thread([&buffers] {
+    for (void* buffer : buffers) osi_free(buffer);
+  }).join();
+
+  // The blocks released by the exited thread can be allocated again
+  buffers.clear();
+  for (int i = 0; i < 200; i++) {
+    buffers.push_back(osi_buffer_alloc(1000));
+  }
+  for (void* buffer : buffers) osi_free(buffer);
+}
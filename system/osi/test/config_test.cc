@@ -244,6 +244,32 @@ TEST_F(ConfigTest, config_remove_key_missing) {
   EXPECT_EQ(config_get_int(*config, "DID", "productId", 999), 999);
 }
 
+TEST_F(ConfigTest, config_keeps_insertion_order) {
+  std::unique_ptr<config_t> config = config_new_empty();
+  config_set_string(config.get(), "A", "a", "1");
+  config_set_string(config.get(), "B", "b", "2");
+  config_set_string(config.get(), "A", "c", "3");
+  config_set_string(config.get(), "A", "a", "4");
+  EXPECT_TRUE(config_remove_section(config.get(), "B"));
+  config_set_string(config.get(), "B", "b", "5");
+  EXPECT_TRUE(config_remove_key(config.get(), "A", "a"));
+  config_set_string(config.get(), "A", "a", "6");
+
+  std::string order;
+  for (const section_t& section : config->sections) {
+    for (const entry_t& entry : section.entries) {
+      order += section.name + "." + entry.key + "=" + entry.value + " ";
+    }
+  }
+  EXPECT_EQ(order, "A.c=3 A.a=6 B.b=5 ");
+
+  // A clone has its own index
+  std::unique_ptr<config_t> clone = config_new_clone(*config);
+  EXPECT_TRUE(config_remove_section(config.get(), "A"));
+  EXPECT_FALSE(config_has_section(*config, "A"));
+  EXPECT_EQ(*config_get_string(*clone, "A", "a", nullptr), "6");
+}
+
 TEST_F(ConfigTest, config_save_basic) {
   std::unique_ptr<config_t> config = config_new(CONFIG_FILE);
   EXPECT_TRUE(config_save(*config, CONFIG_FILE));
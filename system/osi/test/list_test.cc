@@ -209,3 +209,25 @@ TEST_F(ListTest, test_list_foreach_partial) {
 
   list_free(list);
 }
+
+TEST_F(ListTest, test_list_reuses_removed_nodes) {
+  list_t* list = list_new(NULL);
+
+  // More elements than the node cache keeps, filled and drained repeatedly
+  int x[100];
+  for (int round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < ARRAY_SIZE(x); ++i) {
+      x[i] = round * 1000 + i;
+      EXPECT_TRUE(list_append(list, &x[i]));
+    }
+    EXPECT_EQ(list_length(list), ARRAY_SIZE(x));
+    for (size_t i = 0; i < ARRAY_SIZE(x); ++i) {
+      int* front = (int*)list_front(list);
+      EXPECT_EQ(*front, round * 1000 + (int)i);
+      EXPECT_TRUE(list_remove(list, front));
+    }
+    EXPECT_TRUE(list_is_empty(list));
+  }
+
+  list_free(list);
+}
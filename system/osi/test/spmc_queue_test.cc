@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "AllocationTestHarness.h"
+
+#include "osi/include/allocator.h"
+#include "osi/include/spmc_queue.h"
+
+static const size_t TEST_QUEUE_SIZE = 10;
+
+static int test_queue_entry_free_counter = 0;
+
+static void test_queue_entry_free_cb(void* data) {
+  test_queue_entry_free_counter++;
+}
+
+// Queue elements are the non-NULL values 1, 2, 3...
+static void* element(uintptr_t value) { return reinterpret_cast<void*>(value); }
+
+class SpmcQueueTest : public AllocationTestHarness {};
+
+TEST_F(SpmcQueueTest, test_spmc_queue_null) {
+  EXPECT_TRUE(spmc_queue_is_empty(NULL));
+  EXPECT_EQ(0u, spmc_queue_length(NULL));
+  EXPECT_EQ(NULL, spmc_queue_try_dequeue(NULL));
+  EXPECT_EQ(0u, spmc_queue_flush(NULL, NULL));
+  EXPECT_EQ(0u, spmc_queue_drop_oldest(NULL, 1, NULL));
+  spmc_queue_free(NULL, NULL);
+}
+
+TEST_F(SpmcQueueTest, test_spmc_queue_enqueue_dequeue) {
+  spmc_queue_t* queue = spmc_queue_new(TEST_QUEUE_SIZE);
+  EXPECT_EQ(TEST_QUEUE_SIZE, spmc_queue_capacity(queue));
+  EXPECT_TRUE(spmc_queue_is_empty(queue));
+
+  // The queue holds exactly |TEST_QUEUE_SIZE| elements
+  for (uintptr_t i = 1; i <= TEST_QUEUE_SIZE; i++) {
+    EXPECT_TRUE(spmc_queue_try_enqueue(queue, element(i)));
+    EXPECT_EQ(i, spmc_queue_length(queue));
+  }
+  EXPECT_FALSE(spmc_queue_try_enqueue(queue, element(TEST_QUEUE_SIZE + 1)));
+
+  // Elements wrap around the slots in FIFO order
+  for (uintptr_t i = 1; i <= 3 * TEST_QUEUE_SIZE; i++) {
+    EXPECT_EQ(element(i), spmc_queue_try_dequeue(queue));
+    EXPECT_TRUE(spmc_queue_try_enqueue(queue, element(i + TEST_QUEUE_SIZE)));
+  }
+  EXPECT_EQ(TEST_QUEUE_SIZE, spmc_queue_length(queue));
+
+  test_queue_entry_free_counter = 0;
+  spmc_queue_free(queue, test_queue_entry_free_cb);
+  EXPECT_EQ((int)TEST_QUEUE_SIZE, test_queue_entry_free_counter);
+}
+
+TEST_F(SpmcQueueTest, test_spmc_queue_dequeue_batch) {
+  spmc_queue_t* queue = spmc_queue_new(TEST_QUEUE_SIZE);
+  for (uintptr_t i = 1; i <= 5; i++) {
+    EXPECT_TRUE(spmc_queue_try_enqueue(queue, element(i)));
+  }
+
+  void* elements[TEST_QUEUE_SIZE] = {};
+  EXPECT_EQ(3u, spmc_queue_try_dequeue_batch(queue, elements, 3));
+  EXPECT_EQ(element(1), elements[0]);
+  EXPECT_EQ(element(3), elements[2]);
+  EXPECT_EQ(2u, spmc_queue_try_dequeue_batch(queue, elements, 3));
+  EXPECT_EQ(element(4), elements[0]);
+  EXPECT_EQ(element(5), elements[1]);
+  EXPECT_EQ(0u, spmc_queue_try_dequeue_batch(queue, elements, 3));
+
+  spmc_queue_free(queue, NULL);
+}
+
+TEST_F(SpmcQueueTest, test_spmc_queue_drop_oldest_and_flush) {
+  spmc_queue_t* queue = spmc_queue_new(TEST_QUEUE_SIZE);
+  for (uintptr_t i = 1; i <= TEST_QUEUE_SIZE; i++) {
+    EXPECT_TRUE(spmc_queue_try_enqueue(queue, element(i)));
+  }
+
+  test_queue_entry_free_counter = 0;
+  EXPECT_EQ(4u, spmc_queue_drop_oldest(queue, 4, test_queue_entry_free_cb));
+  EXPECT_EQ(4, test_queue_entry_free_counter);
+  EXPECT_EQ(TEST_QUEUE_SIZE - 4, spmc_queue_length(queue));
+  EXPECT_EQ(element(5), spmc_queue_try_dequeue(queue));
+
+  EXPECT_EQ(TEST_QUEUE_SIZE - 5,
+            spmc_queue_flush(queue, test_queue_entry_free_cb));
+  EXPECT_EQ((int)TEST_QUEUE_SIZE - 1, test_queue_entry_free_counter);
+  EXPECT_TRUE(spmc_queue_is_empty(queue));
+  EXPECT_EQ(0u, spmc_queue_drop_oldest(queue, 4, test_queue_entry_free_cb));
+
+  spmc_queue_free(queue, NULL);
+}
+
+TEST_F(SpmcQueueTest, test_spmc_queue_concurrent_producer_consumers) {
+  static const uintptr_t kElements = 100000;
+  spmc_queue_t* queue = spmc_queue_new(TEST_QUEUE_SIZE);
+
+  // One consumer dequeues while the producer drops the oldest elements
+  // whenever the queue fills up: every element comes out exactly once.
+  uintptr_t dequeued_sum = 0;
+  uintptr_t dequeued_count = 0;
+  std::thread consumer([&] {
+    uintptr_t last = 0;
+    while (last < kElements) {
+      void* data = spmc_queue_try_dequeue(queue);
+      if (data == NULL) {
+        std::this_thread::yield();
+        continue;
+      }
+      uintptr_t value = reinterpret_cast<uintptr_t>(data);
+      EXPECT_LT(last, value);
+      last = value;
+      dequeued_sum += value;
+      dequeued_count++;
+    }
+  });
+
+  uintptr_t dropped_sum = 0;
+  for (uintptr_t i = 1; i <= kElements; i++) {
+    while (!spmc_queue_try_enqueue(queue, element(i))) {
+      void* dropped[2];
+      size_t count = spmc_queue_try_dequeue_batch(queue, dropped, 2);
+      for (size_t j = 0; j < count; j++) {
+        dropped_sum += reinterpret_cast<uintptr_t>(dropped[j]);
+      }
+    }
+  }
+  // The last element is never dropped, so the consumer eventually gets it
+  consumer.join();
+
+  EXPECT_EQ(kElements * (kElements + 1) / 2, dequeued_sum + dropped_sum);
+  EXPECT_TRUE(spmc_queue_is_empty(queue));
+  spmc_queue_free(queue, NULL);
+}
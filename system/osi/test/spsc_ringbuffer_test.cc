@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "AllocationTestHarness.h"
+
+#include "osi/include/spsc_ringbuffer.h"
+
+class SpscRingbufferTest : public AllocationTestHarness {};
+
+TEST_F(SpscRingbufferTest, test_new_simple) {
+  spsc_ringbuffer_t* rb = spsc_ringbuffer_init(4000);
+  ASSERT_TRUE(rb != NULL);
+  EXPECT_LE(4000u, spsc_ringbuffer_capacity(rb));
+  // The capacity is a power of two
+  EXPECT_EQ(0u, spsc_ringbuffer_capacity(rb) & (spsc_ringbuffer_capacity(rb) - 1));
+  EXPECT_EQ(0u, spsc_ringbuffer_size(rb));
+  EXPECT_EQ(spsc_ringbuffer_capacity(rb), spsc_ringbuffer_available(rb));
+  spsc_ringbuffer_free(rb);
+  spsc_ringbuffer_free(NULL);
+}
+
+TEST_F(SpscRingbufferTest, test_insert_pop) {
+  spsc_ringbuffer_t* rb = spsc_ringbuffer_init(16);
+  size_t capacity = spsc_ringbuffer_capacity(rb);
+
+  uint8_t buffer[10] = {0x01, 0x02, 0x03, 0x04, 0x05,
+                        0x06, 0x07, 0x08, 0x09, 0x0A};
+  EXPECT_EQ(10u, spsc_ringbuffer_insert(rb, buffer, sizeof(buffer)));
+  EXPECT_EQ(10u, spsc_ringbuffer_size(rb));
+  EXPECT_EQ(capacity - 10, spsc_ringbuffer_available(rb));
+
+  uint8_t peek[10] = {0};
+  EXPECT_EQ(4u, spsc_ringbuffer_pop(rb, peek, 4));
+  EXPECT_EQ(0, memcmp(buffer, peek, 4));
+  EXPECT_EQ(6u, spsc_ringbuffer_pop(rb, peek, sizeof(peek)));
+  EXPECT_EQ(0, memcmp(buffer + 4, peek, 6));
+  EXPECT_EQ(0u, spsc_ringbuffer_size(rb));
+  EXPECT_EQ(0u, spsc_ringbuffer_pop(rb, peek, sizeof(peek)));
+
+  spsc_ringbuffer_free(rb);
+}
+
+TEST_F(SpscRingbufferTest, test_insert_full) {
+  spsc_ringbuffer_t* rb = spsc_ringbuffer_init(16);
+  size_t capacity = spsc_ringbuffer_capacity(rb);
+
+  uint8_t* buffer = new uint8_t[capacity + 1];
+  memset(buffer, 0x55, capacity + 1);
+  EXPECT_EQ(capacity, spsc_ringbuffer_insert(rb, buffer, capacity + 1));
+  EXPECT_EQ(0u, spsc_ringbuffer_available(rb));
+  EXPECT_EQ(0u, spsc_ringbuffer_insert(rb, buffer, 1));
+
+  size_t length;
+  spsc_ringbuffer_write_reserve(rb, &length);
+  EXPECT_EQ(0u, length);
+
+  delete[] buffer;
+  spsc_ringbuffer_free(rb);
+}
+
+TEST_F(SpscRingbufferTest, test_reserve_commit_wraps_around) {
+  spsc_ringbuffer_t* rb = spsc_ringbuffer_init(16);
+  size_t capacity = spsc_ringbuffer_capacity(rb);
+
+  // Move the positions close to the end of the ring
+  uint8_t* filler = new uint8_t[capacity];
+  memset(filler, 0, capacity);
+  EXPECT_EQ(capacity - 3, spsc_ringbuffer_insert(rb, filler, capacity - 3));
+  EXPECT_EQ(capacity - 3, spsc_ringbuffer_pop(rb, filler, capacity - 3));
+
+  // Write 8 bytes in place across the end of the ring
+  uint8_t written = 0;
+  while (written < 8) {
+    size_t length;
+    uint8_t* data = spsc_ringbuffer_write_reserve(rb, &length);
+    ASSERT_LT(0u, length);
+    if (spsc_ringbuffer_is_mirrored(rb)) {
+      EXPECT_EQ(capacity, length);
+    }
+    size_t n = std::min<size_t>(length, 8 - written);
+    for (size_t i = 0; i < n; i++) data[i] = written + i;
+    spsc_ringbuffer_write_commit(rb, n);
+    written += n;
+  }
+  EXPECT_EQ(8u, spsc_ringbuffer_size(rb));
+
+  // Read them back in place
+  uint8_t read = 0;
+  while (read < 8) {
+    size_t length;
+    const uint8_t* data = spsc_ringbuffer_read_reserve(rb, &length);
+    ASSERT_LT(0u, length);
+    if (spsc_ringbuffer_is_mirrored(rb)) {
+      EXPECT_EQ(8u, length);
+    }
+    for (size_t i = 0; i < length; i++) EXPECT_EQ(read + i, data[i]);
+    spsc_ringbuffer_read_commit(rb, length);
+    read += length;
+  }
+  EXPECT_EQ(0u, spsc_ringbuffer_size(rb));
+
+  delete[] filler;
+  spsc_ringbuffer_free(rb);
+}
+
+TEST_F(SpscRingbufferTest, test_producer_consumer_threads) {
+  static const size_t kTotalBytes = 1 << 20;
+  spsc_ringbuffer_t* rb = spsc_ringbuffer_init(256);
+
+  std::thread producer([rb]() {
+    uint8_t chunk[97];
+    size_t sent = 0;
+    while (sent < kTotalBytes) {
+      size_t n = std::min(sizeof(chunk), kTotalBytes - sent);
+      for (size_t i = 0; i < n; i++) chunk[i] = (sent + i) & 0xff;
+      size_t written = 0;
+      while (written < n) {
+        written += spsc_ringbuffer_insert(rb, chunk + written, n - written);
+      }
+      sent += n;
+    }
+  });
+
+  // Every byte arrives once, in order
+  size_t received = 0;
+  bool in_order = true;
+  while (received < kTotalBytes) {
+    size_t length;
+    const uint8_t* data = spsc_ringbuffer_read_reserve(rb, &length);
+    for (size_t i = 0; i < length; i++) {
+      in_order &= data[i] == ((received + i) & 0xff);
+    }
+    spsc_ringbuffer_read_commit(rb, length);
+    received += length;
+  }
+  producer.join();
+
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(0u, spsc_ringbuffer_size(rb));
+  spsc_ringbuffer_free(rb);
+}
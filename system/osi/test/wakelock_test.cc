@@ -19,19 +19,23 @@
 #include <gtest/gtest.h>
 
 #include <base/logging.h>
+#include <atomic>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "osi/include/wakelock.h"
 
 #include "AllocationTestHarness.h"
 
-static bool is_wake_lock_acquired = false;
+static std::atomic_bool is_wake_lock_acquired = false;
+static std::atomic_int acquire_count = 0;
 
 static int acquire_wake_lock_cb(const char* lock_name) {
   is_wake_lock_acquired = true;
+  acquire_count++;
   return BT_STATUS_SUCCESS;
 }
 
@@ -74,6 +78,7 @@ class WakelockTest : public AllocationTestHarness {
 
   void TearDown() override {
     is_wake_lock_acquired = false;
+    acquire_count = 0;
     wakelock_cleanup();
     wakelock_set_os_callouts(NULL);
 
@@ -161,3 +166,39 @@ TEST_F(WakelockTest, test_set_paths) {
     ASSERT_FALSE(IsFileWakeLockAcquired());
   }
 }
+
+TEST_F(WakelockTest, test_release_grace_period) {
+  wakelock_set_os_callouts(&bt_wakelock_callouts);
+  wakelock_set_hysteresis(0, 100);
+
+  for (size_t i = 0; i < 100; i++) {
+    wakelock_acquire();
+    ASSERT_TRUE(is_wake_lock_acquired);
+    wakelock_release();
+    ASSERT_TRUE(is_wake_lock_acquired);
+  }
+  // The releases within the grace period are coalesced in one acquisition
+  ASSERT_EQ(acquire_count, 1);
+
+  usleep(300 * 1000);
+  ASSERT_FALSE(is_wake_lock_acquired);
+}
+
+TEST_F(WakelockTest, test_min_hold) {
+  wakelock_set_os_callouts(&bt_wakelock_callouts);
+  wakelock_set_hysteresis(100, 0);
+
+  wakelock_acquire();
+  wakelock_release();
+  ASSERT_TRUE(is_wake_lock_acquired);
+
+  usleep(300 * 1000);
+  ASSERT_FALSE(is_wake_lock_acquired);
+
+  // Once held for the minimum hold time, the wakelock is released right away
+  wakelock_acquire();
+  usleep(150 * 1000);
+  wakelock_release();
+  ASSERT_FALSE(is_wake_lock_acquired);
+  ASSERT_EQ(acquire_count, 2);
+}
@@ -59,6 +59,7 @@ void Device::RegisterInterfaces(MediaInterface* media_interface,
   a2dp_interface_ = a2dp_interface;
   media_interface_ = media_interface;
   volume_interface_ = volume_interface;
+  InvalidateMediaCache();
 }
 
 base::WeakPtr<Device> Device::Get() {
@@ -174,8 +175,8 @@ void Device::VendorPacketHandler(uint8_t label,
         send_message(label, false, std::move(response));
         return;
       }
-      media_interface_->GetSongInfo(base::Bind(&Device::GetElementAttributesResponse, weak_ptr_factory_.GetWeakPtr(),
-                                               label, get_element_attributes_request_pkt));
+      GetSongInfo(base::Bind(&Device::GetElementAttributesResponse, weak_ptr_factory_.GetWeakPtr(), label,
+                             get_element_attributes_request_pkt));
     } break;
 
     case CommandPdu::GET_PLAY_STATUS: {
@@ -276,7 +277,7 @@ void Device::HandleNotification(
 
   switch (pkt->GetEventRegistered()) {
     case Event::TRACK_CHANGED: {
-      media_interface_->GetNowPlayingList(
+      GetNowPlayingList(
           base::Bind(&Device::TrackChangedNotificationResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, true));
     } break;
@@ -295,7 +296,7 @@ void Device::HandleNotification(
     } break;
 
     case Event::NOW_PLAYING_CONTENT_CHANGED: {
-      media_interface_->GetNowPlayingList(
+      GetNowPlayingList(
           base::Bind(&Device::HandleNowPlayingNotificationResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, true));
     } break;
@@ -851,13 +852,13 @@ void Device::HandleGetFolderItems(uint8_t label,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetFolderItems(
+          CurrentFolder(), pkt->GetStartItem() == 0,
           base::Bind(&Device::GetVFSListResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     case Scope::NOW_PLAYING:
-      media_interface_->GetNowPlayingList(
+      GetNowPlayingList(
           base::Bind(&Device::GetNowPlayingListResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
@@ -888,13 +889,13 @@ void Device::HandleGetTotalNumberOfItems(
       break;
     }
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetFolderItems(
+          CurrentFolder(), true,
           base::Bind(&Device::GetTotalNumberOfItemsVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
     case Scope::NOW_PLAYING:
-      media_interface_->GetNowPlayingList(
+      GetNowPlayingList(
           base::Bind(&Device::GetTotalNumberOfItemsNowPlayingResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
@@ -972,8 +973,8 @@ void Device::HandleChangePath(uint8_t label,
                    << "\"";
   }
 
-  media_interface_->GetFolderItems(
-      curr_browsed_player_id_, CurrentFolder(),
+  GetFolderItems(
+      CurrentFolder(), true,
       base::Bind(&Device::ChangePathResponse, weak_ptr_factory_.GetWeakPtr(),
                  label, pkt));
 }
@@ -1010,7 +1011,7 @@ void Device::HandleGetItemAttributes(
 
   switch (pkt->GetScope()) {
     case Scope::NOW_PLAYING: {
-      media_interface_->GetNowPlayingList(
+      GetNowPlayingList(
           base::Bind(&Device::GetItemAttributesNowPlayingResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
     } break;
@@ -1019,8 +1020,8 @@ void Device::HandleGetItemAttributes(
       // then we can auto send the error without calling up. We do this check
       // later right now though in order to prevent race conditions with updates
       // on the media layer.
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetFolderItems(
+          CurrentFolder(), false,
           base::Bind(&Device::GetItemAttributesVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
@@ -1375,6 +1376,9 @@ void Device::SendFolderUpdate(bool available_players, bool addressed_player,
   CHECK(media_interface_);
   DEVICE_VLOG(4) << __func__;
 
+  // The players, their queues and their folders may all have changed
+  InvalidateMediaCache();
+
   if (available_players) {
     HandleAvailablePlayerUpdate();
   }
@@ -1386,12 +1390,14 @@ void Device::SendFolderUpdate(bool available_players, bool addressed_player,
 
 void Device::HandleTrackUpdate() {
   DEVICE_VLOG(2) << __func__;
+  InvalidateMediaCache();
+
   if (!track_changed_.first) {
     LOG(WARNING) << "Device is not registered for track changed updates";
     return;
   }
 
-  media_interface_->GetNowPlayingList(
+  GetNowPlayingList(
       base::Bind(&Device::TrackChangedNotificationResponse,
                  weak_ptr_factory_.GetWeakPtr(), track_changed_.second, false));
 }
@@ -1410,13 +1416,14 @@ void Device::HandlePlayStatusUpdate() {
 
 void Device::HandleNowPlayingUpdate() {
   DEVICE_VLOG(2) << __func__;
+  InvalidateMediaCache();
 
   if (!now_playing_changed_.first) {
     LOG(WARNING) << "Device is not registered for now playing updates";
     return;
   }
 
-  media_interface_->GetNowPlayingList(base::Bind(
+  GetNowPlayingList(base::Bind(
       &Device::HandleNowPlayingNotificationResponse,
       weak_ptr_factory_.GetWeakPtr(), now_playing_changed_.second, false));
 }
@@ -1489,6 +1496,79 @@ void Device::HandleAddressedPlayerUpdate() {
       weak_ptr_factory_.GetWeakPtr(), addr_player_changed_.second, false));
 }
 
+void Device::GetSongInfo(MediaInterface::SongInfoCallback info_cb) {
+  if (cached_song_info_) {
+    info_cb.Run(*cached_song_info_);
+    return;
+  }
+
+  media_interface_->GetSongInfo(
+      base::Bind(&Device::CacheSongInfo, weak_ptr_factory_.GetWeakPtr(),
+                 media_cache_generation_, info_cb));
+}
+
+void Device::GetNowPlayingList(
+    MediaInterface::NowPlayingCallback now_playing_cb) {
+  if (cached_now_playing_list_) {
+    now_playing_cb.Run(cached_now_playing_list_->curr_song_id,
+                       cached_now_playing_list_->song_list);
+    return;
+  }
+
+  media_interface_->GetNowPlayingList(
+      base::Bind(&Device::CacheNowPlayingList, weak_ptr_factory_.GetWeakPtr(),
+                 media_cache_generation_, now_playing_cb));
+}
+
+void Device::GetFolderItems(std::string media_id, bool refresh,
+                            MediaInterface::FolderItemsCallback folder_cb) {
+  uint16_t player_id = curr_browsed_player_id_;
+  if (!refresh && cached_folder_items_ &&
+      cached_folder_items_->player_id == player_id &&
+      cached_folder_items_->media_id == media_id) {
+    folder_cb.Run(cached_folder_items_->items);
+    return;
+  }
+
+  media_interface_->GetFolderItems(
+      player_id, media_id,
+      base::Bind(&Device::CacheFolderItems, weak_ptr_factory_.GetWeakPtr(),
+                 media_cache_generation_, player_id, media_id, folder_cb));
+}
+
+void Device::InvalidateMediaCache() {
+  media_cache_generation_++;
+  cached_song_info_.reset();
+  cached_now_playing_list_.reset();
+  cached_folder_items_.reset();
+}
+
+void Device::CacheSongInfo(uint32_t generation,
+                           MediaInterface::SongInfoCallback info_cb,
+                           SongInfo info) {
+  if (generation == media_cache_generation_) cached_song_info_ = info;
+  info_cb.Run(std::move(info));
+}
+
+void Device::CacheNowPlayingList(
+    uint32_t generation, MediaInterface::NowPlayingCallback now_playing_cb,
+    std::string curr_song_id, std::vector<SongInfo> song_list) {
+  if (generation == media_cache_generation_) {
+    cached_now_playing_list_ = NowPlayingList{curr_song_id, song_list};
+  }
+  now_playing_cb.Run(std::move(curr_song_id), std::move(song_list));
+}
+
+void Device::CacheFolderItems(uint32_t generation, uint16_t player_id,
+                              std::string media_id,
+                              MediaInterface::FolderItemsCallback folder_cb,
+                              std::vector<ListItem> items) {
+  if (generation == media_cache_generation_) {
+    cached_folder_items_ = FolderItems{player_id, std::move(media_id), items};
+  }
+  folder_cb.Run(std::move(items));
+}
+
 void Device::DeviceDisconnected() {
   DEVICE_LOG(INFO) << "Device was disconnected";
   play_pos_update_cb_.Cancel();
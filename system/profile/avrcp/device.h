@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <stack>
 
 #include <base/bind.h>
@@ -296,6 +297,28 @@ class Device {
     active_labels_.erase(label);
     send_message_cb_.Run(label, browse, std::move(message));
   }
+
+  // Remote devices, car kits in particular, poll the song info and the now
+  // playing list, and browse large folders a few items per request. These
+  // queries are answered from the media cache, which is dropped when the
+  // media or folder updates are received. The listing of a folder is always
+  // refreshed when |refresh| is set, which is the case for the requests
+  // starting a new pass over the folder.
+  void GetSongInfo(MediaInterface::SongInfoCallback info_cb);
+  void GetNowPlayingList(MediaInterface::NowPlayingCallback now_playing_cb);
+  void GetFolderItems(std::string media_id, bool refresh,
+                      MediaInterface::FolderItemsCallback folder_cb);
+  void InvalidateMediaCache();
+  void CacheSongInfo(uint32_t generation,
+                     MediaInterface::SongInfoCallback info_cb, SongInfo info);
+  void CacheNowPlayingList(uint32_t generation,
+                           MediaInterface::NowPlayingCallback now_playing_cb,
+                           std::string curr_song_id,
+                           std::vector<SongInfo> song_list);
+  void CacheFolderItems(uint32_t generation, uint16_t player_id,
+                        std::string media_id,
+                        MediaInterface::FolderItemsCallback folder_cb,
+                        std::vector<ListItem> items);
   base::WeakPtrFactory<Device> weak_ptr_factory_;
 
   // TODO (apanicke): Initialize all the variables in the constructor.
@@ -333,6 +356,22 @@ class Device {
   SongInfo last_song_info_;
   PlayStatus last_play_status_;
 
+  // Media cache. The generation is incremented each time the cache is
+  // dropped, so that the answers to the queries issued before are not cached.
+  struct NowPlayingList {
+    std::string curr_song_id;
+    std::vector<SongInfo> song_list;
+  };
+  struct FolderItems {
+    uint16_t player_id;
+    std::string media_id;
+    std::vector<ListItem> items;
+  };
+  uint32_t media_cache_generation_ = 0;
+  std::optional<SongInfo> cached_song_info_;
+  std::optional<NowPlayingList> cached_now_playing_list_;
+  std::optional<FolderItems> cached_folder_items_;
+
   base::CancelableClosure play_pos_update_cb_;
 
   MediaInterface* media_interface_ = nullptr;
@@ -656,6 +656,44 @@ TEST_F(AvrcpDeviceTest, getElementAttributesTest) {
   SendMessage(3, TestAvrcpPacket::Make(get_element_attributes_request_full));
 }
 
+TEST_F(AvrcpDeviceTest, getElementAttributesCachedTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr);
+
+  SongInfo info = {"test_id",
+                   {AttributeEntry(Attribute::TITLE, "Test Song")}};
+  SongInfo new_info = {"test_id2",
+                       {AttributeEntry(Attribute::TITLE, "New Song")}};
+
+  // The song info is only queried again after a track update
+  EXPECT_CALL(interface, GetSongInfo(_))
+      .Times(2)
+      .WillOnce(InvokeCb<0>(info))
+      .WillOnce(InvokeCb<0>(new_info));
+
+  auto response = GetElementAttributesResponseBuilder::MakeBuilder(0xFFFF);
+  response->AddAttributeEntry(Attribute::TITLE, "Test Song");
+  EXPECT_CALL(response_cb, Call(2, false, matchPacket(std::move(response))))
+      .Times(1);
+  SendMessage(2, TestAvrcpPacket::Make(get_element_attributes_request_partial));
+
+  response = GetElementAttributesResponseBuilder::MakeBuilder(0xFFFF);
+  response->AddAttributeEntry(Attribute::TITLE, "Test Song");
+  EXPECT_CALL(response_cb, Call(3, false, matchPacket(std::move(response))))
+      .Times(1);
+  SendMessage(3, TestAvrcpPacket::Make(get_element_attributes_request_partial));
+
+  test_device->HandleTrackUpdate();
+
+  response = GetElementAttributesResponseBuilder::MakeBuilder(0xFFFF);
+  response->AddAttributeEntry(Attribute::TITLE, "New Song");
+  EXPECT_CALL(response_cb, Call(4, false, matchPacket(std::move(response))))
+      .Times(1);
+  SendMessage(4, TestAvrcpPacket::Make(get_element_attributes_request_partial));
+}
+
 TEST_F(AvrcpDeviceTest, getElementAttributesWithCoverArtTest) {
   MockMediaInterface interface;
   NiceMock<MockA2dpInterface> a2dp_interface;
@@ -926,6 +964,64 @@ TEST_F(AvrcpDeviceTest, getVFSFolderTest) {
   SendBrowseMessage(1, request);
 }
 
+TEST_F(AvrcpDeviceTest, getVFSFolderInChunksTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr);
+
+  FolderInfo info0 = {"test_id0", true, "Test Folder0"};
+  FolderInfo info1 = {"test_id1", true, "Test Folder1"};
+  FolderInfo info2 = {"test_id2", true, "Test Folder2"};
+  ListItem item0 = {ListItem::FOLDER, info0, SongInfo()};
+  ListItem item1 = {ListItem::FOLDER, info1, SongInfo()};
+  ListItem item2 = {ListItem::FOLDER, info2, SongInfo()};
+  std::vector<ListItem> list = {item0, item1, item2};
+
+  // The folder is listed once for each pass starting at the first item
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(2)
+      .WillRepeatedly(InvokeCb<2>(list));
+
+  auto expected_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  expected_response->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  expected_response->AddFolder(FolderItem(2, 0, true, "Test Folder1"));
+  EXPECT_CALL(response_cb,
+              Call(1, true, matchPacket(std::move(expected_response))))
+      .Times(1);
+  auto request_builder =
+      GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 0, 1, {});
+  auto request = TestBrowsePacket::Make();
+  request_builder->Serialize(request);
+  SendBrowseMessage(1, request);
+
+  expected_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  expected_response->AddFolder(FolderItem(3, 0, true, "Test Folder2"));
+  EXPECT_CALL(response_cb,
+              Call(2, true, matchPacket(std::move(expected_response))))
+      .Times(1);
+  request_builder =
+      GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 2, 3, {});
+  request = TestBrowsePacket::Make();
+  request_builder->Serialize(request);
+  SendBrowseMessage(2, request);
+
+  expected_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  expected_response->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  expected_response->AddFolder(FolderItem(2, 0, true, "Test Folder1"));
+  EXPECT_CALL(response_cb,
+              Call(3, true, matchPacket(std::move(expected_response))))
+      .Times(1);
+  request_builder =
+      GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 0, 1, {});
+  request = TestBrowsePacket::Make();
+  request_builder->Serialize(request);
+  SendBrowseMessage(3, request);
+}
+
 TEST_F(AvrcpDeviceTest, getFolderItemsMtuTest) {
   auto truncated_packet = GetFolderItemsResponseBuilder::MakeVFSBuilder(
       Status::NO_ERROR, 0x0000, 0xFFFF);
@@ -586,7 +586,7 @@ static void a2dp_aac_encode_frames(uint8_t nb_frame) {
   int written = 0;
 
   while (nb_frame) {
-    BT_HDR* p_buf = (BT_HDR*)osi_malloc(BT_DEFAULT_BUFFER_SIZE);
+    BT_HDR* p_buf = (BT_HDR*)osi_buffer_alloc(BT_DEFAULT_BUFFER_SIZE);
     p_buf->offset = A2DP_AAC_OFFSET;
     p_buf->len = 0;
     p_buf->layer_specific = 0;
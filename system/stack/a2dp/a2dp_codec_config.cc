@@ -60,6 +60,55 @@ static void init_btav_a2dp_codec_config(
   codec_config->codec_priority = codec_priority;
 }
 
+// The registry of the codecs the stack can negotiate. Each entry gives how to
+// create the codec and the relative CPU cost of running it on the host.
+// Adding a codec only needs a new entry here and in the A2DP_* functions
+// dispatching on its codec type.
+struct A2dpCodecRegistryEntry {
+  btav_a2dp_codec_index_t codec_index;
+  A2dpCodecConfig* (*create)(btav_a2dp_codec_priority_t codec_priority);
+  uint8_t software_cpu_cost;
+};
+
+template <typename T>
+static A2dpCodecConfig* create_codec_config(
+    btav_a2dp_codec_priority_t codec_priority) {
+  return new T(codec_priority);
+}
+
+static const A2dpCodecRegistryEntry a2dp_codec_registry[] = {
+    {BTAV_A2DP_CODEC_INDEX_SOURCE_SBC,
+     create_codec_config<A2dpCodecConfigSbcSource>, 1},
+    {BTAV_A2DP_CODEC_INDEX_SINK_SBC,
+     create_codec_config<A2dpCodecConfigSbcSink>, 1},
+#if !defined(EXCLUDE_NONSTANDARD_CODECS)
+    {BTAV_A2DP_CODEC_INDEX_SOURCE_AAC,
+     create_codec_config<A2dpCodecConfigAacSource>, 4},
+    {BTAV_A2DP_CODEC_INDEX_SINK_AAC,
+     create_codec_config<A2dpCodecConfigAacSink>, 2},
+    {BTAV_A2DP_CODEC_INDEX_SOURCE_APTX,
+     create_codec_config<A2dpCodecConfigAptx>, 2},
+    {BTAV_A2DP_CODEC_INDEX_SOURCE_APTX_HD,
+     create_codec_config<A2dpCodecConfigAptxHd>, 3},
+    {BTAV_A2DP_CODEC_INDEX_SOURCE_LDAC,
+     create_codec_config<A2dpCodecConfigLdacSource>, 5},
+    {BTAV_A2DP_CODEC_INDEX_SINK_LDAC,
+     create_codec_config<A2dpCodecConfigLdacSink>, 3},
+    {BTAV_A2DP_CODEC_INDEX_SOURCE_OPUS,
+     create_codec_config<A2dpCodecConfigOpusSource>, 4},
+    {BTAV_A2DP_CODEC_INDEX_SINK_OPUS,
+     create_codec_config<A2dpCodecConfigOpusSink>, 3},
+#endif
+};
+
+static const A2dpCodecRegistryEntry* find_codec_registry_entry(
+    btav_a2dp_codec_index_t codec_index) {
+  for (const auto& entry : a2dp_codec_registry) {
+    if (entry.codec_index == codec_index) return &entry;
+  }
+  return nullptr;
+}
+
 A2dpCodecConfig::A2dpCodecConfig(btav_a2dp_codec_index_t codec_index,
                                  const std::string& name,
                                  btav_a2dp_codec_priority_t codec_priority)
@@ -102,62 +151,39 @@ void A2dpCodecConfig::setDefaultCodecPriority() {
   if (default_codec_priority_ != BTAV_A2DP_CODEC_PRIORITY_DEFAULT) {
     codec_priority_ = default_codec_priority_;
   } else {
-    // Compute the default codec priority
+    // Compute the default codec priority, offloaded codecs first
     uint32_t priority = 1000 * (codec_index_ + 1) + 1;
+    if (isOffloadSupported()) priority += 1000 * BTAV_A2DP_CODEC_INDEX_MAX;
     codec_priority_ = static_cast<btav_a2dp_codec_priority_t>(priority);
   }
   codec_config_.codec_priority = codec_priority_;
 }
 
+uint8_t A2dpCodecConfig::softwareCpuCost() const {
+  const A2dpCodecRegistryEntry* entry = find_codec_registry_entry(codec_index_);
+  return (entry != nullptr) ? entry->software_cpu_cost : UINT8_MAX;
+}
+
+bool A2dpCodecConfig::isOffloadSupported() const {
+#if !defined(UNIT_TESTS)
+  return bluetooth::audio::a2dp::is_codec_offloading_supported(codec_index_);
+#else
+  return false;
+#endif
+}
+
 A2dpCodecConfig* A2dpCodecConfig::createCodec(
     btav_a2dp_codec_index_t codec_index,
     btav_a2dp_codec_priority_t codec_priority) {
   LOG_INFO("%s", A2DP_CodecIndexStr(codec_index));
 
-  A2dpCodecConfig* codec_config = nullptr;
-  switch (codec_index) {
-    case BTAV_A2DP_CODEC_INDEX_SOURCE_SBC:
-      codec_config = new A2dpCodecConfigSbcSource(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SINK_SBC:
-      codec_config = new A2dpCodecConfigSbcSink(codec_priority);
-      break;
-#if !defined(EXCLUDE_NONSTANDARD_CODECS)
-    case BTAV_A2DP_CODEC_INDEX_SOURCE_AAC:
-      codec_config = new A2dpCodecConfigAacSource(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SINK_AAC:
-      codec_config = new A2dpCodecConfigAacSink(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SOURCE_APTX:
-      codec_config = new A2dpCodecConfigAptx(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SOURCE_APTX_HD:
-      codec_config = new A2dpCodecConfigAptxHd(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SOURCE_LDAC:
-      codec_config = new A2dpCodecConfigLdacSource(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SINK_LDAC:
-      codec_config = new A2dpCodecConfigLdacSink(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SOURCE_OPUS:
-      codec_config = new A2dpCodecConfigOpusSource(codec_priority);
-      break;
-    case BTAV_A2DP_CODEC_INDEX_SINK_OPUS:
-      codec_config = new A2dpCodecConfigOpusSink(codec_priority);
-      break;
-#endif
-    case BTAV_A2DP_CODEC_INDEX_MAX:
-    default:
-      break;
-  }
+  const A2dpCodecRegistryEntry* entry = find_codec_registry_entry(codec_index);
+  if (entry == nullptr) return nullptr;
 
-  if (codec_config != nullptr) {
-    if (!codec_config->init()) {
-      delete codec_config;
-      codec_config = nullptr;
-    }
+  A2dpCodecConfig* codec_config = entry->create(codec_priority);
+  if (!codec_config->init()) {
+    delete codec_config;
+    codec_config = nullptr;
   }
 
   return codec_config;
@@ -514,6 +540,9 @@ void A2dpCodecConfig::debug_codec_dump(int fd) {
   std::string result;
   dprintf(fd, "\nA2DP %s State:\n", name().c_str());
   dprintf(fd, "  Priority: %d\n", codecPriority());
+  dprintf(fd, "  Offload supported: %s\n",
+          isOffloadSupported() ? "true" : "false");
+  dprintf(fd, "  Software CPU cost: %d\n", softwareCpuCost());
 
   result = codecConfig2Str(getCodecConfig());
   dprintf(fd, "  Config: %s\n", result.c_str());
@@ -528,13 +557,16 @@ void A2dpCodecConfig::debug_codec_dump(int fd) {
 //
 // Compares two codecs |lhs| and |rhs| based on their priority.
 // Returns true if |lhs| has higher priority (larger priority value).
-// If |lhs| and |rhs| have same priority, the unique codec index is used
+// If |lhs| and |rhs| have same priority, the codec with the lower CPU cost
+// on the host has higher priority, and then the unique codec index is used
 // as a tie-breaker: larger codec index value means higher priority.
 //
 static bool compare_codec_priority(const A2dpCodecConfig* lhs,
                                    const A2dpCodecConfig* rhs) {
   if (lhs->codecPriority() > rhs->codecPriority()) return true;
   if (lhs->codecPriority() < rhs->codecPriority()) return false;
+  if (lhs->softwareCpuCost() != rhs->softwareCpuCost())
+    return (lhs->softwareCpuCost() < rhs->softwareCpuCost());
   return (lhs->codecIndex() > rhs->codecIndex());
 }
 
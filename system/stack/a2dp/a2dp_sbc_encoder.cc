@@ -26,7 +26,7 @@
 #include <string.h>
 
 #include "a2dp_sbc.h"
-#include "a2dp_sbc_up_sample.h"
+#include "common/audio_resampler.h"
 #include "common/time_util.h"
 #include "embdrv/sbc/encoder/include/sbc_encoder.h"
 #include "osi/include/allocator.h"
@@ -47,6 +47,10 @@
 
 #define A2DP_SBC_MAX_PCM_ITER_NUM_PER_TICK 3
 
+/* Largest number of PCM frames read at once when the feeding is resampled */
+#define A2DP_SBC_MAX_RESAMPLER_INPUT_FRAMES \
+  (SBC_MAX_NUM_FRAME * SBC_MAX_NUM_OF_BLOCKS * SBC_MAX_NUM_OF_SUBBANDS)
+
 #define A2DP_SBC_MAX_HQ_FRAME_SIZE_44_1 119
 #define A2DP_SBC_MAX_HQ_FRAME_SIZE_48 115
 
@@ -74,6 +78,7 @@ typedef struct {
   float counter;
   uint32_t bytes_per_tick; /* pcm bytes read each media task tick */
   uint64_t last_frame_us;
+  bool resampler_configured; /* a2dp_sbc_resampler matches the feeding */
 } tA2DP_SBC_FEEDING_STATE;
 
 typedef struct {
@@ -103,17 +108,31 @@ typedef struct {
   tA2DP_SBC_FEEDING_STATE feeding_state;
   int16_t pcmBuffer[SBC_MAX_PCM_BUFFER_SIZE];
 
+  /* PCM data of the frames read at once by a2dp_sbc_send_frames_batch() */
+  int16_t batchPcmBuffer[MAX_PCM_FRAME_NUM_PER_TICK * SBC_MAX_PCM_BUFFER_SIZE];
+  bool batch_active;
+  uint32_t batch_frames;     /* Frames in batchPcmBuffer */
+  uint32_t batch_next_frame; /* Next frame of batchPcmBuffer to encode */
+  uint32_t batch_first_frame_bytes; /* First frame bytes read by the batch */
+
   a2dp_sbc_encoder_stats_t stats;
 } tA2DP_SBC_ENCODER_CB;
 
 static tA2DP_SBC_ENCODER_CB a2dp_sbc_encoder_cb;
 
+/* Converts the feeding to the SBC sampling rate when they differ */
+static bluetooth::common::AudioResampler a2dp_sbc_resampler;
+
 static void a2dp_sbc_encoder_update(A2dpCodecConfig* a2dp_codec_config,
                                     bool* p_restart_input,
                                     bool* p_restart_output,
                                     bool* p_config_updated);
 static bool a2dp_sbc_read_feeding(uint32_t* bytes);
-static void a2dp_sbc_encode_frames(uint8_t nb_frame);
+static bool a2dp_sbc_read_feeding_batch(uint32_t nb_frame);
+static bool a2dp_sbc_next_frame(int16_t** input, uint32_t* bytes_read);
+static void a2dp_sbc_encode_frames(uint8_t nb_frame,
+                                   tA2DP_ENCODER_PACKET_POOL* pool);
+static uint32_t a2dp_sbc_sampling_rate(void);
 static void a2dp_sbc_get_num_frame_iteration(uint8_t* num_of_iterations,
                                              uint8_t* num_of_frames,
                                              uint64_t timestamp_us);
@@ -362,6 +381,7 @@ void a2dp_sbc_feeding_reset(void) {
 void a2dp_sbc_feeding_flush(void) {
   a2dp_sbc_encoder_cb.feeding_state.counter = 0.0f;
   a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue = 0;
+  a2dp_sbc_resampler.Reset();
 }
 
 uint64_t a2dp_sbc_get_encoder_interval_ms(void) {
@@ -383,8 +403,27 @@ void a2dp_sbc_send_frames(uint64_t timestamp_us) {
 
   for (uint8_t counter = 0; counter < nb_iterations; counter++) {
     // Transcode frame and enqueue
-    a2dp_sbc_encode_frames(nb_frame);
+    a2dp_sbc_encode_frames(nb_frame, nullptr);
+  }
+}
+
+void a2dp_sbc_send_frames_batch(uint64_t timestamp_us,
+                                tA2DP_ENCODER_PACKET_POOL* pool) {
+  uint8_t nb_frame = 0;
+  uint8_t nb_iterations = 0;
+
+  a2dp_sbc_get_num_frame_iteration(&nb_iterations, &nb_frame, timestamp_us);
+  LOG_VERBOSE("%s: Sending %d frames per iteration, %d iterations", __func__,
+              nb_frame, nb_iterations);
+  if (nb_frame == 0) return;
+
+  // Read the PCM data of all the iterations at once, unless it is up-sampled
+  a2dp_sbc_read_feeding_batch(nb_frame * nb_iterations);
+  for (uint8_t counter = 0; counter < nb_iterations; counter++) {
+    // Transcode frame and enqueue
+    a2dp_sbc_encode_frames(nb_frame, pool);
   }
+  a2dp_sbc_encoder_cb.batch_active = false;
 }
 
 // Obtains the number of frames to send and number of iterations
@@ -488,7 +527,28 @@ static void a2dp_sbc_get_num_frame_iteration(uint8_t* num_of_iterations,
   *num_of_iterations = noi;
 }
 
-static void a2dp_sbc_encode_frames(uint8_t nb_frame) {
+// Takes a packet buffer from |pool| if it has one, otherwise allocates it.
+static BT_HDR* a2dp_sbc_get_packet(tA2DP_ENCODER_PACKET_POOL* pool) {
+  if (pool != nullptr && pool->count > 0 &&
+      pool->buffer_size >= A2DP_SBC_BUFFER_SIZE) {
+    return pool->packets[--pool->count];
+  }
+  return (BT_HDR*)osi_buffer_alloc(A2DP_SBC_BUFFER_SIZE);
+}
+
+// Gives back to |pool| a packet buffer that wasn't used, or frees it.
+static void a2dp_sbc_put_packet(tA2DP_ENCODER_PACKET_POOL* pool,
+                                BT_HDR* p_buf) {
+  if (pool != nullptr && pool->count < A2DP_ENCODER_PACKET_POOL_SIZE &&
+      pool->buffer_size == A2DP_SBC_BUFFER_SIZE) {
+    pool->packets[pool->count++] = p_buf;
+    return;
+  }
+  osi_free(p_buf);
+}
+
+static void a2dp_sbc_encode_frames(uint8_t nb_frame,
+                                   tA2DP_ENCODER_PACKET_POOL* pool) {
   SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
   uint8_t remain_nb_frame = nb_frame;
   uint16_t blocm_x_subband =
@@ -497,7 +557,7 @@ static void a2dp_sbc_encode_frames(uint8_t nb_frame) {
   uint8_t last_frame_len = 0;
 
   while (nb_frame) {
-    BT_HDR* p_buf = (BT_HDR*)osi_malloc(A2DP_SBC_BUFFER_SIZE);
+    BT_HDR* p_buf = a2dp_sbc_get_packet(pool);
     uint32_t bytes_read = 0;
 
     p_buf->offset = A2DP_SBC_OFFSET;
@@ -506,16 +566,13 @@ static void a2dp_sbc_encode_frames(uint8_t nb_frame) {
     a2dp_sbc_encoder_cb.stats.media_read_total_expected_packets++;
 
     do {
-      /* Fill allocated buffer with 0 */
-      memset(a2dp_sbc_encoder_cb.pcmBuffer, 0,
-             blocm_x_subband * p_encoder_params->s16NumOfChannels);
       //
       // Read the PCM data and encode it. If necessary, upsample the data.
       //
       uint32_t num_bytes = 0;
-      if (a2dp_sbc_read_feeding(&num_bytes)) {
+      int16_t* input = nullptr;
+      if (a2dp_sbc_next_frame(&input, &num_bytes)) {
         uint8_t* output = (uint8_t*)(p_buf + 1) + p_buf->offset + p_buf->len;
-        int16_t* input = a2dp_sbc_encoder_cb.pcmBuffer;
         uint16_t output_len = SBC_Encode(p_encoder_params, input, output);
         last_frame_len = output_len;
 
@@ -556,17 +613,107 @@ static void a2dp_sbc_encode_frames(uint8_t nb_frame) {
         return;
     } else {
       a2dp_sbc_encoder_cb.stats.media_read_total_dropped_packets++;
-      osi_free(p_buf);
+      a2dp_sbc_put_packet(pool, p_buf);
     }
   }
 }
 
+// Gets the PCM data of the next frame in |input|: the next frame of the batch
+// read by a2dp_sbc_read_feeding_batch() if one is in progress, otherwise the
+// frame read by a2dp_sbc_read_feeding().
+static bool a2dp_sbc_next_frame(int16_t** input, uint32_t* bytes_read) {
+  SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
+  uint32_t frame_samples = p_encoder_params->s16NumOfSubBands *
+                           p_encoder_params->s16NumOfBlocks *
+                           p_encoder_params->s16NumOfChannels;
+
+  if (a2dp_sbc_encoder_cb.batch_active) {
+    uint32_t frame = a2dp_sbc_encoder_cb.batch_next_frame;
+    if (frame == a2dp_sbc_encoder_cb.batch_frames) return false;
+    *input = a2dp_sbc_encoder_cb.batchPcmBuffer + frame * frame_samples;
+    *bytes_read = frame == 0 ? a2dp_sbc_encoder_cb.batch_first_frame_bytes
+                             : frame_samples * sizeof(int16_t);
+    a2dp_sbc_encoder_cb.batch_next_frame++;
+    return true;
+  }
+
+  /* Fill allocated buffer with 0 */
+  memset(a2dp_sbc_encoder_cb.pcmBuffer, 0,
+         p_encoder_params->s16NumOfSubBands * p_encoder_params->s16NumOfBlocks *
+             p_encoder_params->s16NumOfChannels);
+  *input = a2dp_sbc_encoder_cb.pcmBuffer;
+  return a2dp_sbc_read_feeding(bytes_read);
+}
+
+// Reads the PCM data of |nb_frame| frames with a single call to the read
+// callback. The frames read are encoded before reading more, and the bytes of
+// an incomplete last frame are kept as the feeding residue, as
+// a2dp_sbc_read_feeding() does. Returns false without reading anything if the
+// PCM data must be up-sampled, as it is then read one frame at a time.
+static bool a2dp_sbc_read_feeding_batch(uint32_t nb_frame) {
+  SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
+  uint32_t bytes_needed = p_encoder_params->s16NumOfSubBands *
+                          p_encoder_params->s16NumOfBlocks *
+                          p_encoder_params->s16NumOfChannels * sizeof(int16_t);
+  uint32_t residue = a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue;
+  uint8_t* batch = (uint8_t*)a2dp_sbc_encoder_cb.batchPcmBuffer;
+
+  if (a2dp_sbc_sampling_rate() !=
+          a2dp_sbc_encoder_cb.feeding_params.sample_rate ||
+      a2dp_sbc_encoder_cb.feeding_params.bits_per_sample != 16) {
+    return false;
+  }
+  if (nb_frame > MAX_PCM_FRAME_NUM_PER_TICK) {
+    nb_frame = MAX_PCM_FRAME_NUM_PER_TICK;
+  }
+
+  /* The residue of the previous read starts the first frame */
+  memcpy(batch, a2dp_sbc_encoder_cb.pcmBuffer, residue);
+  uint32_t read_size = nb_frame * bytes_needed - residue;
+  a2dp_sbc_encoder_cb.stats.media_read_total_expected_reads_count++;
+  a2dp_sbc_encoder_cb.stats.media_read_total_expected_read_bytes += read_size;
+  uint32_t nb_byte_read =
+      a2dp_sbc_encoder_cb.read_callback(batch + residue, read_size);
+  a2dp_sbc_encoder_cb.stats.media_read_total_actual_read_bytes += nb_byte_read;
+  if (nb_byte_read == read_size) {
+    a2dp_sbc_encoder_cb.stats.media_read_total_actual_reads_count++;
+  }
+
+  uint32_t available = residue + nb_byte_read;
+  a2dp_sbc_encoder_cb.batch_frames = available / bytes_needed;
+  a2dp_sbc_encoder_cb.batch_next_frame = 0;
+  a2dp_sbc_encoder_cb.batch_first_frame_bytes = bytes_needed - residue;
+  a2dp_sbc_encoder_cb.batch_active = true;
+
+  /* Keep the bytes of an incomplete frame for the next read */
+  residue = available % bytes_needed;
+  memcpy(a2dp_sbc_encoder_cb.pcmBuffer,
+         batch + a2dp_sbc_encoder_cb.batch_frames * bytes_needed, residue);
+  a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue = residue;
+  return true;
+}
+
+// Gets the SBC sampling rate in Hz.
+static uint32_t a2dp_sbc_sampling_rate(void) {
+  switch (a2dp_sbc_encoder_cb.sbc_encoder_params.s16SamplingFreq) {
+    case SBC_sf48000:
+      return 48000;
+    case SBC_sf44100:
+      return 44100;
+    case SBC_sf32000:
+      return 32000;
+    case SBC_sf16000:
+      return 16000;
+  }
+  return 48000;
+}
+
 static bool a2dp_sbc_read_feeding(uint32_t* bytes_read) {
   SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
   uint16_t blocm_x_subband =
       p_encoder_params->s16NumOfSubBands * p_encoder_params->s16NumOfBlocks;
   uint32_t read_size;
-  uint32_t sbc_sampling = 48000;
+  uint32_t sbc_sampling = a2dp_sbc_sampling_rate();
   uint32_t src_samples;
   uint16_t bytes_needed = blocm_x_subband * p_encoder_params->s16NumOfChannels *
                           a2dp_sbc_encoder_cb.feeding_params.bits_per_sample /
@@ -577,29 +724,13 @@ static bool a2dp_sbc_read_feeding(uint32_t* bytes_read) {
   static uint16_t read_buffer[SBC_MAX_NUM_FRAME * SBC_MAX_NUM_OF_BLOCKS *
                               SBC_MAX_NUM_OF_CHANNELS *
                               SBC_MAX_NUM_OF_SUBBANDS];
-  uint32_t src_size_used;
+  uint32_t frame_size;
   uint32_t dst_size_used;
   bool fract_needed;
   int32_t fract_max;
   int32_t fract_threshold;
   uint32_t nb_byte_read;
 
-  /* Get the SBC sampling rate */
-  switch (p_encoder_params->s16SamplingFreq) {
-    case SBC_sf48000:
-      sbc_sampling = 48000;
-      break;
-    case SBC_sf44100:
-      sbc_sampling = 44100;
-      break;
-    case SBC_sf32000:
-      sbc_sampling = 32000;
-      break;
-    case SBC_sf16000:
-      sbc_sampling = 16000;
-      break;
-  }
-
   a2dp_sbc_encoder_cb.stats.media_read_total_expected_reads_count++;
   if (sbc_sampling == a2dp_sbc_encoder_cb.feeding_params.sample_rate) {
     read_size =
@@ -680,23 +811,31 @@ static bool a2dp_sbc_read_feeding(uint32_t* bytes_read) {
   }
   a2dp_sbc_encoder_cb.stats.media_read_total_actual_reads_count++;
 
-  /* Initialize PCM up-sampling engine */
-  a2dp_sbc_init_up_sample(a2dp_sbc_encoder_cb.feeding_params.sample_rate,
-                          sbc_sampling,
-                          a2dp_sbc_encoder_cb.feeding_params.bits_per_sample,
-                          a2dp_sbc_encoder_cb.feeding_params.channel_count);
+  /* Configure the resampler on the first read of the feeding */
+  if (!a2dp_sbc_encoder_cb.feeding_state.resampler_configured) {
+    a2dp_sbc_encoder_cb.feeding_state.resampler_configured = true;
+    if (!a2dp_sbc_resampler.Init(
+            a2dp_sbc_encoder_cb.feeding_params.sample_rate, sbc_sampling,
+            a2dp_sbc_encoder_cb.feeding_params.channel_count,
+            a2dp_sbc_encoder_cb.feeding_params.bits_per_sample, 16,
+            A2DP_SBC_MAX_RESAMPLER_INPUT_FRAMES)) {
+      LOG_ERROR("%s: cannot resample from %u to %u", __func__,
+                a2dp_sbc_encoder_cb.feeding_params.sample_rate, sbc_sampling);
+    }
+  }
 
   /*
    * Re-sample the read buffer.
-   * The output PCM buffer will be stereo, 16 bit per sample.
+   * The output PCM buffer will be 16 bit per sample.
    */
-  dst_size_used = a2dp_sbc_up_sample(
-      (uint8_t*)read_buffer,
-      (uint8_t*)up_sampled_buffer +
-          a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue,
-      nb_byte_read, sizeof(up_sampled_buffer) -
-                        a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue,
-      &src_size_used);
+  frame_size = a2dp_sbc_encoder_cb.feeding_params.channel_count *
+               (a2dp_sbc_encoder_cb.feeding_params.bits_per_sample / 8);
+  dst_size_used =
+      a2dp_sbc_resampler.Resample(
+          read_buffer, nb_byte_read / frame_size,
+          (uint8_t*)up_sampled_buffer +
+              a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue) *
+      a2dp_sbc_encoder_cb.feeding_params.channel_count * sizeof(int16_t);
 
   /* update the residue */
   a2dp_sbc_encoder_cb.feeding_state.aa_feed_residue += dst_size_used;
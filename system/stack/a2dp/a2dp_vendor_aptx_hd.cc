@@ -84,7 +84,8 @@ static const tA2DP_ENCODER_INTERFACE a2dp_encoder_interface_aptx_hd = {
     a2dp_vendor_aptx_hd_get_encoder_interval_ms,
     a2dp_vendor_aptx_hd_get_effective_frame_size,
     a2dp_vendor_aptx_hd_send_frames,
-    nullptr  // set_transmit_queue_length
+    nullptr,  // set_transmit_queue_length
+    nullptr   // send_frames_batch
 };
 
 UNUSED_ATTR static tA2DP_STATUS A2DP_CodecInfoMatchesCapabilityAptxHd(
@@ -110,7 +110,9 @@ static const tA2DP_ENCODER_INTERFACE a2dp_encoder_interface_opus = {
     a2dp_vendor_opus_get_encoder_interval_ms,
     a2dp_vendor_opus_get_effective_frame_size,
     a2dp_vendor_opus_send_frames,
-    a2dp_vendor_opus_set_transmit_queue_length};
+    a2dp_vendor_opus_set_transmit_queue_length,
+    nullptr  // send_frames_batch
+};
 
 static const tA2DP_DECODER_INTERFACE a2dp_decoder_interface_opus = {
     a2dp_vendor_opus_decoder_init,          a2dp_vendor_opus_decoder_cleanup,
@@ -21,9 +21,47 @@
 #include "stack/acl/acl.h"
 #include "types/raw_address.h"
 
+namespace {
+
+constexpr uint16_t kLeDefaultTxOctets = 27;
+constexpr uint8_t kLePhy1m = 1;
+constexpr uint8_t kLePhy2m = 2;
+constexpr uint8_t kLePhyCoded = 3;
+constexpr double kLeInterFrameSpaceUs = 150;
+
+/* Air time of a data channel PDU, with its preamble, access address, header
+ * and CRC */
+double le_pdu_air_time_us(uint8_t phy, uint16_t octets) {
+  switch (phy) {
+    case kLePhy2m:
+      return (2 + 4 + 2 + octets + 3) * 8 / 2.0;
+    case kLePhyCoded:
+      /* S=8 coding, 8 us per bit after the preamble */
+      return 80 + (32 + 2 + 3) * 8 + (2 + octets + 3) * 8 * 8 + 3 * 8;
+    default:
+      return (1 + 4 + 2 + octets + 3) * 8.0;
+  }
+}
+
+/* Payload octets per microsecond when the link is saturated: one full PDU
+ * answered by an empty one */
+double le_goodput(uint8_t phy, uint16_t octets) {
+  return octets / (le_pdu_air_time_us(phy, octets) + kLeInterFrameSpaceUs +
+                   le_pdu_air_time_us(phy, 0) + kLeInterFrameSpaceUs);
+}
+
+}  // namespace
+
+double tACL_CONN::LeGoodputGain() const {
+  return le_goodput(le_tx_phy, le_tx_octets) /
+         le_goodput(kLePhy1m, kLeDefaultTxOctets);
+}
+
 void tACL_CONN::Reset() {
   memset(peer_le_features, 0, sizeof(peer_le_features));
   peer_le_features_valid = false;
+  le_tx_octets = kLeDefaultTxOctets;
+  le_tx_phy = kLePhy1m;
   memset(peer_lmp_feature_pages, 0, sizeof(peer_lmp_feature_pages));
   memset(peer_lmp_feature_valid, 0, sizeof(peer_lmp_feature_valid));
   active_remote_addr = RawAddress::kEmpty;
@@ -177,6 +177,11 @@ struct tBTM_PM_MCB {
 struct tACL_CONN {
   BD_FEATURES peer_le_features;
   bool peer_le_features_valid;
+  /* LE transmit data length and PHY reported by the controller */
+  uint16_t le_tx_octets;
+  uint8_t le_tx_phy;
+  /* Estimated goodput of the LE link relative to 27 byte PDUs on 1M PHY */
+  double LeGoodputGain() const;
   BD_FEATURES peer_lmp_feature_pages[HCI_EXT_FEATURES_PAGE_MAX + 1];
   bool peer_lmp_feature_valid[HCI_EXT_FEATURES_PAGE_MAX + 1];
 
@@ -22,6 +22,7 @@
 #include "stack/btm/btm_sec.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/include/acl_api.h"
+#include "stack/include/ble_acl_interface.h"
 #include "stack/include/bt_types.h"
 #include "stack/include/l2cap_hci_link_interface.h"
 #include "types/raw_address.h"
@@ -187,5 +188,16 @@ void acl_ble_data_length_change_event(uint16_t handle, uint16_t max_tx_octets,
       "Data length change event received handle:0x%04x max_tx_octets:%hu "
       "max_tx_time:%hu max_rx_octets:%hu max_rx_time:%hu",
       handle, max_tx_octets, max_tx_time, max_rx_octets, max_rx_time);
+  acl_ble_set_tx_data_length(handle, max_tx_octets);
   l2cble_process_data_length_change_event(handle, max_tx_octets, max_rx_octets);
 }
+
+void gatt_notify_phy_updated(tGATT_STATUS status, uint16_t handle,
+                             uint8_t tx_phy, uint8_t rx_phy);
+void acl_ble_phy_update_event(tGATT_STATUS status, uint16_t handle,
+                              uint8_t tx_phy, uint8_t rx_phy) {
+  if (status == GATT_SUCCESS) {
+    acl_ble_set_tx_phy(handle, tx_phy);
+  }
+  gatt_notify_phy_updated(status, handle, tx_phy, rx_phy);
+}
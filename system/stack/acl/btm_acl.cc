@@ -56,6 +56,7 @@
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"  // UNUSED_ATTR
+#include "osi/include/properties.h"
 #include "stack/acl/acl.h"
 #include "stack/acl/peer_packet_types.h"
 #include "stack/btm/btm_dev.h"
@@ -67,6 +68,7 @@
 #include "stack/include/acl_hci_link_interface.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/btm_api.h"
+#include "stack/include/btm_ble_api.h"
 #include "stack/include/btm_iso_api.h"
 #include "stack/include/btu.h"
 #include "stack/include/hci_error_code.h"
@@ -124,6 +126,11 @@ typedef struct {
 
 constexpr uint8_t BTM_MAX_SW_ROLE_FAILED_ATTEMPTS = 3;
 
+/* Negotiate the data length and PHY of the LE links once their features are
+ * known */
+constexpr char kPropertyLeLinkOptimizerEnabled[] =
+    "bluetooth.core.le.link_optimizer.enabled";
+
 /* Define masks for supported and exception 2.0 ACL packet types
  */
 constexpr uint16_t BTM_ACL_SUPPORTED_PKTS_MASK =
@@ -2571,6 +2578,26 @@ uint16_t acl_get_supported_packet_types() {
   return btm_cb.acl_cb_.DefaultPacketTypes();
 }
 
+/* Ask for the longest PDUs and the 2M PHY as soon as the peer features show
+ * they are supported, instead of leaving the link on 27 byte PDUs on the 1M
+ * PHY until a profile asks for them */
+static void acl_ble_optimize_link(const tACL_CONN& link) {
+  if (!osi_property_get_bool(kPropertyLeLinkOptimizerEnabled, true)) return;
+
+  const controller_t* controller = controller_get_interface();
+  if (controller->supports_ble_packet_extension() &&
+      HCI_LE_DATA_LEN_EXT_SUPPORTED(link.peer_le_features) &&
+      link.le_tx_octets < BTM_BLE_DATA_SIZE_MAX) {
+    BTM_SetBleDataLength(link.remote_addr, BTM_BLE_DATA_SIZE_MAX);
+  }
+  /* the controller picks between the PHYs both sides prefer */
+  if (controller->supports_ble_2m_phy() &&
+      HCI_LE_2M_PHY_SUPPORTED(link.peer_le_features)) {
+    BTM_BleSetPhy(link.remote_addr, PHY_LE_1M | PHY_LE_2M,
+                  PHY_LE_1M | PHY_LE_2M, 0);
+  }
+}
+
 bool acl_set_peer_le_features_from_handle(uint16_t hci_handle,
                                           const uint8_t* p) {
   tACL_CONN* p_acl = internal_.acl_get_connection_from_handle(hci_handle);
@@ -2580,9 +2607,22 @@ bool acl_set_peer_le_features_from_handle(uint16_t hci_handle,
   STREAM_TO_ARRAY(p_acl->peer_le_features, p, BD_FEATURES_LEN);
   p_acl->peer_le_features_valid = true;
   LOG_DEBUG("Completed le feature read request");
+  acl_ble_optimize_link(*p_acl);
   return true;
 }
 
+void acl_ble_set_tx_data_length(uint16_t hci_handle, uint16_t tx_octets) {
+  tACL_CONN* p_acl = internal_.acl_get_connection_from_handle(hci_handle);
+  if (p_acl == nullptr) return;
+  p_acl->le_tx_octets = tx_octets;
+}
+
+void acl_ble_set_tx_phy(uint16_t hci_handle, uint8_t tx_phy) {
+  tACL_CONN* p_acl = internal_.acl_get_connection_from_handle(hci_handle);
+  if (p_acl == nullptr) return;
+  p_acl->le_tx_phy = tx_phy;
+}
+
 void on_acl_br_edr_connected(const RawAddress& bda, uint16_t handle,
                              uint8_t enc_mode) {
   if (delayed_role_change_ != nullptr && delayed_role_change_->bd_addr == bda) {
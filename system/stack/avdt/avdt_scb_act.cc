@@ -1016,6 +1016,9 @@ void avdt_scb_hdl_write_req(AvdtpScb* p_scb, tAVDT_SCB_EVT* p_data) {
   /* Build a media packet, and add an RTP header if required. */
   if (add_rtp_header) {
     if (p_data->apiwrite.p_buf->offset < AVDT_MEDIA_HDR_SIZE) {
+      /* The buffer is owned by AVDTP from now on */
+      AVDT_TRACE_WARNING("Dropped media packet; no room for the RTP header");
+      osi_free(p_data->apiwrite.p_buf);
       return;
     }
 
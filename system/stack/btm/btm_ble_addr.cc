@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "btm_ble_int.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "gap_api.h"
 #include "main/shim/shim.h"
@@ -107,12 +108,28 @@ bool btm_ble_init_pseudo_addr(tBTM_SEC_DEV_REC* p_dev_rec,
                               const RawAddress& new_pseudo_addr) {
   if (p_dev_rec->ble.pseudo_addr.IsEmpty()) {
     p_dev_rec->ble.pseudo_addr = new_pseudo_addr;
+    btm_sec_index_dev_rec(p_dev_rec);
     return true;
   }
 
   return false;
 }
 
+/* Return true if the hash of the Resolvable Private Address |rpa| is the one
+ * computed by the IRK |irk| from its prand */
+static bool rpa_matches_key(const RawAddress& rpa,
+                            const crypto_toolbox::AesCmacKey& irk) {
+  /* use the 3 MSB of bd address as prand */
+  Octet16 prand{};
+  prand[0] = rpa.address[2];
+  prand[1] = rpa.address[1];
+  prand[2] = rpa.address[0];
+
+  Octet16 x = irk.Encrypt(prand);
+  return x[0] == rpa.address[5] && x[1] == rpa.address[4] &&
+         x[2] == rpa.address[3];
+}
+
 /* Return true if given Resolvable Privae Address |rpa| matches Identity
  * Resolving Key |irk| */
 static bool rpa_matches_irk(const RawAddress& rpa, const Octet16& irk) {
@@ -177,16 +194,103 @@ static bool btm_ble_match_random_bda(void* data, void* context) {
   return true;
 }
 
+/** This function is called when an IRK is added to or removed from a device
+ * record, to rebuild the IRK index and forget the resolved RPAs. */
+void btm_ble_rpa_index_invalidate(void) {
+  btm_cb.rpa_irk_index.clear();
+  btm_cb.rpa_irk_index_dirty = true;
+  btm_cb.rpa_cache.clear();
+}
+
+static void rpa_irk_index_build(void) {
+  btm_cb.rpa_irk_index.clear();
+  for (list_node_t* node = list_begin(btm_cb.sec_dev_rec);
+       node != list_end(btm_cb.sec_dev_rec); node = list_next(node)) {
+    tBTM_SEC_DEV_REC* p_dev_rec =
+        static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
+    if (!(p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) ||
+        !(p_dev_rec->ble.key_type & BTM_LE_KEY_PID))
+      continue;
+    btm_cb.rpa_irk_index.push_back(tBTM_BLE_RPA_IRK{
+        .bd_addr = p_dev_rec->bd_addr,
+        .irk = crypto_toolbox::AesCmacKey(p_dev_rec->ble.keys.irk),
+    });
+  }
+  btm_cb.rpa_irk_index_dirty = false;
+}
+
+/* Return the device record of |bd_addr| if it still has the IRK |irk| */
+static tBTM_SEC_DEV_REC* rpa_irk_index_check(const RawAddress& bd_addr,
+                                             const Octet16& irk) {
+  tBTM_SEC_DEV_REC* p_dev_rec = btm_find_dev(bd_addr);
+  if (p_dev_rec == nullptr || !(p_dev_rec->ble.key_type & BTM_LE_KEY_PID) ||
+      p_dev_rec->ble.keys.irk != irk)
+    return nullptr;
+  return p_dev_rec;
+}
+
+/* Keep the resolution of |random_bda| to |p_dev_rec|, or to no record */
+static void rpa_cache_update(const RawAddress& random_bda,
+                             tBTM_SEC_DEV_REC* p_dev_rec, uint64_t now_ms) {
+  auto& cache = btm_cb.rpa_cache;
+  if (cache.size() >= BTM_BLE_RPA_CACHE_SIZE &&
+      cache.find(random_bda) == cache.end()) {
+    for (auto it = cache.begin(); it != cache.end();) {
+      it = (now_ms - it->second.time_ms >= BTM_BLE_RPA_CACHE_TIMEOUT_MS)
+               ? cache.erase(it)
+               : std::next(it);
+    }
+    if (cache.size() >= BTM_BLE_RPA_CACHE_SIZE) cache.clear();
+  }
+  cache[random_bda] = tBTM_BLE_RPA_CACHE_ENT{
+      .bd_addr = (p_dev_rec != nullptr) ? p_dev_rec->bd_addr : RawAddress{},
+      .time_ms = now_ms,
+  };
+}
+
 /** This function is called to resolve a random address.
  * Returns pointer to the security record of the device whom a random address is
  * matched to.
+ *
+ * The RPAs resolved recently are looked up first, then the RPA is matched
+ * against the expanded IRKs of the bonded devices.
  */
 tBTM_SEC_DEV_REC* btm_ble_resolve_random_addr(const RawAddress& random_bda) {
   if (btm_cb.sec_dev_rec == nullptr) return nullptr;
-  list_node_t* n = list_foreach(btm_cb.sec_dev_rec, btm_ble_match_random_bda,
-                                (void*)&random_bda);
-  return (n == nullptr) ? (nullptr)
-                        : (static_cast<tBTM_SEC_DEV_REC*>(list_node(n)));
+
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  auto cached = btm_cb.rpa_cache.find(random_bda);
+  if (cached != btm_cb.rpa_cache.end() &&
+      now_ms - cached->second.time_ms < BTM_BLE_RPA_CACHE_TIMEOUT_MS) {
+    if (cached->second.bd_addr.IsEmpty()) return nullptr;
+
+    tBTM_SEC_DEV_REC* p_dev_rec = btm_find_dev(cached->second.bd_addr);
+    if (p_dev_rec != nullptr && (p_dev_rec->ble.key_type & BTM_LE_KEY_PID) &&
+        rpa_matches_irk(random_bda, p_dev_rec->ble.keys.irk))
+      return p_dev_rec;
+  }
+
+  if (btm_cb.rpa_irk_index_dirty) rpa_irk_index_build();
+
+  bool index_is_stale = false;
+  tBTM_SEC_DEV_REC* p_match = nullptr;
+  for (const auto& entry : btm_cb.rpa_irk_index) {
+    if (!rpa_matches_key(random_bda, entry.irk)) continue;
+    p_match = rpa_irk_index_check(entry.bd_addr, entry.irk.key());
+    if (p_match != nullptr) break;
+    index_is_stale = true;
+  }
+
+  if (p_match == nullptr && index_is_stale) {
+    /* a record changed without invalidating the index */
+    btm_ble_rpa_index_invalidate();
+    list_node_t* n = list_foreach(btm_cb.sec_dev_rec, btm_ble_match_random_bda,
+                                  (void*)&random_bda);
+    if (n != nullptr) p_match = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  }
+
+  rpa_cache_update(random_bda, p_match, now_ms);
+  return p_match;
 }
 
 /*******************************************************************************
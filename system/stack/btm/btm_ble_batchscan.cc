@@ -19,6 +19,7 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <memory>
 #include <vector>
 #include "bt_target.h"
 
@@ -281,9 +282,11 @@ void btm_ble_read_batchscan_reports(tBTM_BLE_BATCH_SCAN_MODE scan_mode,
 }
 
 /* read reports. data is accumulated in |data_all|, number of records is
- * accumulated in |num_records_all| */
-void read_reports_cb(std::vector<uint8_t> data_all, uint8_t num_records_all,
-                     tBTM_BLE_SCAN_REP_CBACK cb, uint8_t* p, uint16_t len) {
+ * accumulated in |num_records_all|. |data_all| is shared by the callbacks of
+ * the successive reads, so that it is not copied for every chunk. */
+void read_reports_cb(std::shared_ptr<std::vector<uint8_t>> data_all,
+                     uint8_t num_records_all, tBTM_BLE_SCAN_REP_CBACK cb,
+                     uint8_t* p, uint16_t len) {
   if (len < 2) {
     BTM_TRACE_ERROR("%s: wrong length", __func__);
     return;
@@ -313,12 +316,12 @@ void read_reports_cb(std::vector<uint8_t> data_all, uint8_t num_records_all,
                   num_records);
 
   if (num_records == 0) {
-    cb.Run(BTM_SUCCESS, report_format, num_records_all, data_all);
+    cb.Run(BTM_SUCCESS, report_format, num_records_all, std::move(*data_all));
     return;
   }
 
   if (len > 4) {
-    data_all.insert(data_all.end(), p, p + len - 4);
+    data_all->insert(data_all->end(), p, p + len - 4);
     num_records_all += num_records;
 
     /* More records could be in the buffer and needs to be pulled out */
@@ -547,7 +550,9 @@ void BTM_BleReadScanReports(tBTM_BLE_BATCH_SCAN_MODE scan_mode,
   }
 
   btm_ble_read_batchscan_reports(
-      scan_mode, base::Bind(&read_reports_cb, std::vector<uint8_t>(), 0, cb));
+      scan_mode,
+      base::Bind(&read_reports_cb, std::make_shared<std::vector<uint8_t>>(),
+                 0, cb));
   return;
 }
 
@@ -17,15 +17,43 @@
  ******************************************************************************/
 
 #include <string.h>
+
+#include <vector>
+
 #include "bt_target.h"
 
 #include "btm_ble_api.h"
+#include "common/time_util.h"
+#include "osi/include/properties.h"
 #include "stack/btm/btm_int_types.h"
 #include "utils/include/bt_utils.h"
 
 extern tBTM_CB btm_cb;
 
-tBTM_BLE_ENERGY_INFO_CB ble_energy_info_cb;
+/* Minimum time between two reads of the controller energy info. The requests
+ * made sooner are answered without waking the controller up. */
+static const char kPropertyEnergyInfoMinIntervalMs[] =
+    "bluetooth.btm.energy_info.min_interval_ms";
+#define BTM_BLE_ENERGY_INFO_MIN_INTERVAL_MS 1000
+
+/* The controller reports its activity since its previous read, and the upper
+ * layers add the reported values up. A read is thus reported once: the
+ * requests sharing a read, or answered within the minimum interval, get an
+ * activity of 0. */
+typedef struct {
+  /* requests waiting for the read in progress */
+  std::vector<tBTM_BLE_ENERGY_INFO_CBACK*> waiting;
+  /* completion time of the last successful read, 0 if none */
+  uint64_t last_read_ms;
+} tBTM_BLE_ENERGY_INFO_CB;
+
+static tBTM_BLE_ENERGY_INFO_CB ble_energy_info_cb;
+
+static uint64_t btm_ble_energy_info_min_interval_ms() {
+  static const uint64_t min_interval_ms = osi_property_get_int32(
+      kPropertyEnergyInfoMinIntervalMs, BTM_BLE_ENERGY_INFO_MIN_INTERVAL_MS);
+  return min_interval_ms;
+}
 
 /*******************************************************************************
  *
@@ -43,37 +71,48 @@ static void btm_ble_cont_energy_cmpl_cback(tBTM_VSC_CMPL* p_params) {
   uint16_t len = p_params->param_len;
   uint32_t total_tx_time = 0, total_rx_time = 0, total_idle_time = 0,
            total_energy_used = 0;
+  tHCI_STATUS status = HCI_ERR_UNSPECIFIED;
 
   if (len < 17) {
     BTM_TRACE_ERROR("wrong length for btm_ble_cont_energy_cmpl_cback");
-    return;
+  } else {
+    uint8_t raw_status;
+    STREAM_TO_UINT8(raw_status, p);
+    status = to_hci_status_code(raw_status);
+    STREAM_TO_UINT32(total_tx_time, p);
+    STREAM_TO_UINT32(total_rx_time, p);
+    STREAM_TO_UINT32(total_idle_time, p);
+    STREAM_TO_UINT32(total_energy_used, p);
   }
 
-  uint8_t raw_status;
-  STREAM_TO_UINT8(raw_status, p);
-  tHCI_STATUS status = to_hci_status_code(raw_status);
-  STREAM_TO_UINT32(total_tx_time, p);
-  STREAM_TO_UINT32(total_rx_time, p);
-  STREAM_TO_UINT32(total_idle_time, p);
-  STREAM_TO_UINT32(total_energy_used, p);
-
   BTM_TRACE_DEBUG(
-      "energy_info status=%d,tx_t=%ld, rx_t=%ld, ener_used=%ld, idle_t=%ld",
-      status, total_tx_time, total_rx_time, total_energy_used, total_idle_time);
+      "energy_info status=%d,tx_t=%ld, rx_t=%ld, ener_used=%ld, idle_t=%ld "
+      "requests=%zu",
+      status, total_tx_time, total_rx_time, total_energy_used, total_idle_time,
+      ble_energy_info_cb.waiting.size());
 
-  if (NULL != ble_energy_info_cb.p_ener_cback)
-    ble_energy_info_cb.p_ener_cback(total_tx_time, total_rx_time,
-                                    total_idle_time, total_energy_used,
-                                    static_cast<tHCI_STATUS>(status));
+  if (status == HCI_SUCCESS) {
+    ble_energy_info_cb.last_read_ms =
+        bluetooth::common::time_get_os_boottime_ms();
+  }
 
-  return;
+  std::vector<tBTM_BLE_ENERGY_INFO_CBACK*> waiting;
+  waiting.swap(ble_energy_info_cb.waiting);
+  for (tBTM_BLE_ENERGY_INFO_CBACK* p_ener_cback : waiting) {
+    p_ener_cback(total_tx_time, total_rx_time, total_idle_time,
+                 total_energy_used, status);
+    /* the activity is reported to the first request only */
+    total_tx_time = total_rx_time = total_idle_time = total_energy_used = 0;
+  }
 }
 
 /*******************************************************************************
  *
  * Function         BTM_BleGetEnergyInfo
  *
- * Description      This function obtains the energy info
+ * Description      This function obtains the energy info. The controller is
+ *                  read at most once per minimum interval, and the requests
+ *                  made while a read is in progress share it.
  *
  * Parameters      p_ener_cback - Callback pointer
  *
@@ -92,7 +131,25 @@ tBTM_STATUS BTM_BleGetEnergyInfo(tBTM_BLE_ENERGY_INFO_CBACK* p_ener_cback) {
     return BTM_ERR_PROCESSING;
   }
 
-  ble_energy_info_cb.p_ener_cback = p_ener_cback;
+  if (p_ener_cback == NULL) return BTM_ILLEGAL_VALUE;
+
+  /* share the read in progress */
+  if (!ble_energy_info_cb.waiting.empty()) {
+    ble_energy_info_cb.waiting.push_back(p_ener_cback);
+    return BTM_CMD_STARTED;
+  }
+
+  if (ble_energy_info_cb.last_read_ms != 0 &&
+      bluetooth::common::time_get_os_boottime_ms() -
+              ble_energy_info_cb.last_read_ms <
+          btm_ble_energy_info_min_interval_ms()) {
+    BTM_TRACE_DEBUG("%s: read less than %llu ms ago", __func__,
+                    (unsigned long long)btm_ble_energy_info_min_interval_ms());
+    p_ener_cback(0, 0, 0, 0, HCI_SUCCESS);
+    return BTM_CMD_STARTED;
+  }
+
+  ble_energy_info_cb.waiting.push_back(p_ener_cback);
   BTM_VendorSpecificCommand(HCI_BLE_ENERGY_INFO, 0, NULL,
                             btm_ble_cont_energy_cmpl_cback);
   return BTM_CMD_STARTED;
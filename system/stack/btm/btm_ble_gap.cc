@@ -50,6 +50,7 @@
 #include "stack/include/acl_api.h"
 #include "stack/include/advertise_data_parser.h"
 #include "stack/include/ble_scanner.h"
+#include "stack/include/ble_acl_interface.h"
 #include "stack/include/bt_types.h"
 #include "stack/include/btm_api_types.h"
 #include "stack/include/gap_api.h"
@@ -2391,6 +2392,8 @@ void btm_ble_update_inq_result(tINQ_DB_ENT* p_i, uint8_t addr_type,
 
   bool has_advertising_flags = false;
   if (!data.empty()) {
+    btm_rmt_name_cache_update_from_eir(bda, data.data(), data.size());
+
     const uint8_t* p_flag =
         AdvertiseDataParser::GetFieldByType(data, BTM_BLE_AD_TYPE_FLAG, &len);
     if (p_flag != NULL && len != 0) {
@@ -2497,7 +2500,7 @@ void btm_clear_all_pending_le_entry(void) {
     if ((p_ent->in_use) &&
         (p_ent->inq_info.results.device_type == BT_DEVICE_TYPE_BLE) &&
         !p_ent->scan_rsp)
-      p_ent->in_use = false;
+      btm_inq_db_remove(p_ent);
   }
 }
 
@@ -2937,8 +2940,8 @@ void btm_ble_process_phy_update_pkt(uint8_t len, uint8_t* data) {
   STREAM_TO_UINT8(tx_phy, p);
   STREAM_TO_UINT8(rx_phy, p);
 
-  gatt_notify_phy_updated(static_cast<tGATT_STATUS>(status), handle, tx_phy,
-                          rx_phy);
+  acl_ble_phy_update_event(static_cast<tGATT_STATUS>(status), handle, tx_phy,
+                           rx_phy);
 }
 
 /*******************************************************************************
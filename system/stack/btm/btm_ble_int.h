@@ -105,6 +105,7 @@ extern void btm_gen_resolvable_private_addr(
 
 extern tBTM_SEC_DEV_REC* btm_ble_resolve_random_addr(
     const RawAddress& random_bda);
+extern void btm_ble_rpa_index_invalidate(void);
 extern void btm_gen_resolve_paddr_low(const RawAddress& address);
 extern uint64_t btm_get_next_private_addrress_interval_ms();
 
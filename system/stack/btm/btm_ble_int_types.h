@@ -21,6 +21,7 @@
 
 #include "osi/include/alarm.h"
 #include "stack/btm/neighbor_inquiry.h"
+#include "stack/crypto_toolbox/crypto_toolbox.h"
 #include "stack/include/btm_ble_api_types.h"
 #include "types/raw_address.h"
 
@@ -301,4 +302,20 @@ typedef struct {
                                                      and peripheral*/
 } tBTM_BLE_CB;
 
+/* RPAs resolved by the host are kept for the longest RPA rotation period */
+#define BTM_BLE_RPA_CACHE_SIZE 256
+#define BTM_BLE_RPA_CACHE_TIMEOUT_MS (15 * 60 * 1000)
+
+/* IRK of a bonded device, with its expanded key schedule */
+typedef struct {
+  RawAddress bd_addr; /* address of the device record */
+  crypto_toolbox::AesCmacKey irk;
+} tBTM_BLE_RPA_IRK;
+
+/* RPA resolved by the host */
+typedef struct {
+  RawAddress bd_addr; /* address of the device record, empty if none */
+  uint64_t time_ms;
+} tBTM_BLE_RPA_CACHE_ENT;
+
 #endif  // BTM_BLE_INT_TYPES_H
@@ -29,6 +29,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <iterator>
+
 #include "btm_api.h"
 #include "btm_ble_int.h"
 #include "device/include/controller.h"
@@ -76,6 +78,7 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
 
     p_dev_rec->bd_addr = bd_addr;
     p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+    btm_sec_index_dev_rec(p_dev_rec);
 
     /* use default value for background connection params */
     /* update conn params, use default value for background connection params */
@@ -131,9 +134,85 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
   return true;
 }
 
+/* Upper bound of the address index: lookups by resolvable private address
+ * add entries which are never updated, so the index is rebuilt from scratch
+ * when it grows past this size. */
+#define BTM_SEC_DEV_REC_INDEX_MAX_SIZE (4 * BTM_SEC_MAX_DEVICE_RECORDS)
+
+static bool dev_rec_has_handle(const tBTM_SEC_DEV_REC* p_dev_rec,
+                               uint16_t handle) {
+  return p_dev_rec->hci_handle == handle || p_dev_rec->ble_hci_handle == handle;
+}
+
+static bool dev_rec_has_address(tBTM_SEC_DEV_REC* p_dev_rec,
+                                const RawAddress& bd_addr) {
+  if (p_dev_rec->bd_addr == bd_addr) return true;
+  // If a LE random address is looking for device record
+  if (p_dev_rec->ble.pseudo_addr == bd_addr) return true;
+
+  return btm_ble_addr_resolvable(bd_addr, p_dev_rec);
+}
+
+static void index_dev_rec_address(const RawAddress& bd_addr,
+                                  tBTM_SEC_DEV_REC* p_dev_rec) {
+  auto& index = btm_cb.sec_dev_rec_by_addr;
+  auto it = index.find(bd_addr);
+  if (it != index.end()) {
+    // Keep a record which still matches: it is the older one
+    if (it->second != p_dev_rec && !dev_rec_has_address(it->second, bd_addr))
+      it->second = p_dev_rec;
+    return;
+  }
+  if (index.size() >= BTM_SEC_DEV_REC_INDEX_MAX_SIZE) index.clear();
+  index.emplace(bd_addr, p_dev_rec);
+}
+
+static void index_dev_rec_handle(uint16_t handle, tBTM_SEC_DEV_REC* p_dev_rec) {
+  // Most records share the invalid handle, it is never indexed
+  if (handle == HCI_INVALID_HANDLE) return;
+
+  auto& index = btm_cb.sec_dev_rec_by_handle;
+  auto it = index.find(handle);
+  if (it == index.end()) {
+    index.emplace(handle, p_dev_rec);
+  } else if (!dev_rec_has_handle(it->second, handle)) {
+    it->second = p_dev_rec;
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_sec_index_dev_rec
+ *
+ * Description      Add the current addresses and handles of |p_dev_rec| to
+ *                  the device record lookup indexes
+ *
+ ******************************************************************************/
+void btm_sec_index_dev_rec(tBTM_SEC_DEV_REC* p_dev_rec) {
+  if (!p_dev_rec->bd_addr.IsEmpty())
+    index_dev_rec_address(p_dev_rec->bd_addr, p_dev_rec);
+  if (!p_dev_rec->ble.pseudo_addr.IsEmpty())
+    index_dev_rec_address(p_dev_rec->ble.pseudo_addr, p_dev_rec);
+  index_dev_rec_handle(p_dev_rec->hci_handle, p_dev_rec);
+  index_dev_rec_handle(p_dev_rec->ble_hci_handle, p_dev_rec);
+}
+
+static void unindex_dev_rec(tBTM_SEC_DEV_REC* p_dev_rec) {
+  auto& by_addr = btm_cb.sec_dev_rec_by_addr;
+  for (auto it = by_addr.begin(); it != by_addr.end();) {
+    it = (it->second == p_dev_rec) ? by_addr.erase(it) : std::next(it);
+  }
+  auto& by_handle = btm_cb.sec_dev_rec_by_handle;
+  for (auto it = by_handle.begin(); it != by_handle.end();) {
+    it = (it->second == p_dev_rec) ? by_handle.erase(it) : std::next(it);
+  }
+}
+
 void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec) {
   p_dev_rec->link_key.fill(0);
   memset(&p_dev_rec->ble.keys, 0, sizeof(tBTM_SEC_BLE_KEYS));
+  unindex_dev_rec(p_dev_rec);
+  btm_ble_rpa_index_invalidate();
   list_remove(btm_cb.sec_dev_rec, p_dev_rec);
 }
 
@@ -263,6 +342,7 @@ tBTM_SEC_DEV_REC* btm_sec_alloc_dev(const RawAddress& bd_addr) {
 
   p_dev_rec->ble_hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE);
   p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+  btm_sec_index_dev_rec(p_dev_rec);
 
   return (p_dev_rec);
 }
@@ -335,8 +415,18 @@ bool is_handle_equal(void* data, void* context) {
  *
  ******************************************************************************/
 tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t handle) {
+  auto it = btm_cb.sec_dev_rec_by_handle.find(handle);
+  if (it != btm_cb.sec_dev_rec_by_handle.end()) {
+    if (dev_rec_has_handle(it->second, handle)) return it->second;
+    btm_cb.sec_dev_rec_by_handle.erase(it);
+  }
+
   list_node_t* n = list_foreach(btm_cb.sec_dev_rec, is_handle_equal, &handle);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    index_dev_rec_handle(handle, p_dev_rec);
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -345,12 +435,18 @@ bool is_address_equal(void* data, void* context) {
   tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(data);
   const RawAddress* bd_addr = ((RawAddress*)context);
 
-  if (p_dev_rec->bd_addr == *bd_addr) return false;
-  // If a LE random address is looking for device record
-  if (p_dev_rec->ble.pseudo_addr == *bd_addr) return false;
+  return !dev_rec_has_address(p_dev_rec, *bd_addr);
+}
 
-  if (btm_ble_addr_resolvable(*bd_addr, p_dev_rec)) return false;
-  return true;
+/* Look up |bd_addr| in the address index, dropping the entry if the record
+ * it points to no longer has that address */
+static tBTM_SEC_DEV_REC* find_indexed_dev(const RawAddress& bd_addr) {
+  auto it = btm_cb.sec_dev_rec_by_addr.find(bd_addr);
+  if (it == btm_cb.sec_dev_rec_by_addr.end()) return nullptr;
+  if (dev_rec_has_address(it->second, bd_addr)) return it->second;
+
+  btm_cb.sec_dev_rec_by_addr.erase(it);
+  return nullptr;
 }
 
 /*******************************************************************************
@@ -366,9 +462,16 @@ bool is_address_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev(const RawAddress& bd_addr) {
   if (btm_cb.sec_dev_rec == nullptr) return nullptr;
 
+  tBTM_SEC_DEV_REC* p_dev_rec = find_indexed_dev(bd_addr);
+  if (p_dev_rec != nullptr) return p_dev_rec;
+
   list_node_t* n =
       list_foreach(btm_cb.sec_dev_rec, is_address_equal, (void*)&bd_addr);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    index_dev_rec_address(bd_addr, p_dev_rec);
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -393,6 +496,10 @@ static bool has_lenc_and_address_is_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev_with_lenc(const RawAddress& bd_addr) {
   if (btm_cb.sec_dev_rec == nullptr) return nullptr;
 
+  tBTM_SEC_DEV_REC* p_dev_rec = find_indexed_dev(bd_addr);
+  if (p_dev_rec != nullptr && (p_dev_rec->ble.key_type & BTM_LE_KEY_LENC))
+    return p_dev_rec;
+
   list_node_t* n = list_foreach(btm_cb.sec_dev_rec, has_lenc_and_address_is_equal,
                                 (void*)&bd_addr);
   if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
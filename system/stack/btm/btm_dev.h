@@ -25,6 +25,17 @@
 
 void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec);
 
+/*******************************************************************************
+ *
+ * Function         btm_sec_index_dev_rec
+ *
+ * Description      Add the current addresses and handles of |p_dev_rec| to
+ *                  the device record lookup indexes. Called when they change,
+ *                  so that the next lookups skip the scan of all records.
+ *
+ ******************************************************************************/
+void btm_sec_index_dev_rec(tBTM_SEC_DEV_REC* p_dev_rec);
+
 /** Free resources associated with the device associated with |bd_addr| address.
  *
  * *** WARNING ***
@@ -33,6 +33,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "advertise_data_parser.h"
 #include "common/time_util.h"
 #include "device/include/controller.h"
@@ -48,6 +51,7 @@
 #include "stack/include/bt_hdr.h"
 #include "stack/include/btm_api.h"
 #include "stack/include/btm_ble_api.h"
+#include "stack/include/btu.h"  // do_in_main_thread
 #include "stack/include/inq_hci_link_interface.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
@@ -140,11 +144,14 @@ const uint16_t BTM_EIR_UUID_LKUP_TBL[BTM_EIR_MAX_SERVICES] = {
 /*            L O C A L    F U N C T I O N     P R O T O T Y P E S            */
 /******************************************************************************/
 static void btm_clr_inq_db(const RawAddress* p_bda);
+static void btm_inq_db_reindex(void);
 void btm_clr_inq_result_flt(void);
 static void btm_inq_rmt_name_failed_cancelled(void);
 static tBTM_STATUS btm_initiate_rem_name(const RawAddress& remote_bda,
                                          uint8_t origin, uint64_t timeout_ms,
                                          tBTM_CMPL_CB* p_cb);
+static void btm_rmt_name_cache_report(tBTM_CMPL_CB* p_cb,
+                                      tBTM_REMOTE_DEV_NAME rem_name);
 
 static uint8_t btm_convert_uuid_to_eir_service(uint16_t uuid16);
 void btm_set_eir_uuid(const uint8_t* p_eir, tBTM_INQ_RESULTS* p_results);
@@ -153,12 +160,43 @@ static const uint8_t* btm_eir_get_uuid_list(const uint8_t* p_eir,
                                             uint8_t* p_num_uuid,
                                             uint8_t* p_uuid_list_type);
 
+/* Sends a remote name request to the controller, keeping track of it until
+ * its completion */
+static void btm_send_rmt_name_req(const RawAddress& bda,
+                                  uint8_t page_scan_rep_mode,
+                                  uint8_t page_scan_mode,
+                                  uint16_t clock_offset) {
+  btm_cb.rmt_name_in_flight[bda] = bluetooth::common::time_get_os_boottime_ms();
+  btsnd_hcic_rmt_name_req(bda, page_scan_rep_mode, page_scan_mode,
+                          clock_offset);
+}
+
+/* Returns true if a remote name request for |bda| is already pending in the
+ * controller. The requests which did not complete within the remote name
+ * timeout are considered lost. */
+static bool btm_rmt_name_req_in_flight(const RawAddress& bda) {
+  auto it = btm_cb.rmt_name_in_flight.find(bda);
+  if (it == btm_cb.rmt_name_in_flight.end()) return false;
+  if (bluetooth::common::time_get_os_boottime_ms() - it->second <
+      BTM_EXT_RMT_NAME_TIMEOUT_MS) {
+    return true;
+  }
+  btm_cb.rmt_name_in_flight.erase(it);
+  return false;
+}
+
 void SendRemoteNameRequest(const RawAddress& raw_address) {
   if (bluetooth::shim::is_gd_shim_enabled()) {
     return bluetooth::shim::SendRemoteNameRequest(raw_address);
   } else {
-    btsnd_hcic_rmt_name_req(raw_address, HCI_PAGE_SCAN_REP_MODE_R1,
-                            HCI_MANDATARY_PAGE_SCAN_MODE, 0);
+    /* The completion of the pending request is reported to the security
+     * procedures as well */
+    if (btm_rmt_name_req_in_flight(raw_address)) {
+      VLOG(1) << __func__ << ": already pending for " << raw_address;
+      return;
+    }
+    btm_send_rmt_name_req(raw_address, HCI_PAGE_SCAN_REP_MODE_R1,
+                          HCI_MANDATARY_PAGE_SCAN_MODE, 0);
   }
 }
 /*******************************************************************************
@@ -580,6 +618,11 @@ tBTM_STATUS BTM_StartInquiry(tBTM_INQ_RESULTS_CB* p_results_cb,
  *                                    A pointer to tBTM_REMOTE_DEV_NAME is
  *                                    passed to the callback.
  *
+ *                  A name learned within BTM_RMT_NAME_CACHE_TIMEOUT_MS is
+ *                  passed to p_cb without a new request, and the requests
+ *                  for the device of the active request are completed with
+ *                  it.
+ *
  * Returns
  *                  BTM_CMD_STARTED is returned if the request was successfully
  *                                  sent to HCI.
@@ -599,6 +642,18 @@ tBTM_STATUS BTM_ReadRemoteDeviceName(const RawAddress& remote_bda,
   }
 
   VLOG(1) << __func__ << ": bd addr " << remote_bda;
+  /* The requests without callback are still sent: the security procedures
+   * rely on the events of the remote name request itself */
+  tBTM_REMOTE_DEV_NAME rem_name;
+  if (p_cb && BTM_IsDeviceUp() &&
+      btm_rmt_name_cache_read(remote_bda, &rem_name)) {
+    VLOG(1) << __func__ << ": name of " << remote_bda << " is cached";
+    do_in_main_thread(FROM_HERE,
+                      base::BindOnce(&btm_rmt_name_cache_report, p_cb,
+                                     rem_name));
+    return BTM_CMD_STARTED;
+  }
+
   /* Use LE transport when LE is the only available option */
   if (transport == BT_TRANSPORT_LE) {
     return btm_ble_read_remote_name(remote_bda, p_cb);
@@ -903,13 +958,13 @@ void btm_clr_inq_db(const RawAddress* p_bda) {
   BTM_TRACE_DEBUG("btm_clr_inq_db: inq_active:0x%x state:%d",
                   btm_cb.btm_inq_vars.inq_active, btm_cb.btm_inq_vars.state);
 #endif
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use) {
-      /* If this is the specified BD_ADDR or clearing all devices */
-      if (p_bda == NULL || (p_ent->inq_info.results.remote_bd_addr == *p_bda)) {
-        p_ent->in_use = false;
-      }
-    }
+  if (p_bda == NULL) {
+    for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) p_ent->in_use = false;
+    btm_cb.inq_db_by_addr.clear();
+    btm_cb.inq_db_by_age = {};
+  } else {
+    p_ent = btm_inq_db_find(*p_bda);
+    if (p_ent != NULL) btm_inq_db_remove(p_ent);
   }
 #if (BTM_INQ_DEBUG == TRUE)
   BTM_TRACE_DEBUG("inq_active:0x%x state:%d", btm_cb.btm_inq_vars.inq_active,
@@ -979,15 +1034,66 @@ bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
-  uint16_t xx;
+  auto it = btm_cb.inq_db_by_addr.find(p_bda);
+  if (it == btm_cb.inq_db_by_addr.end()) return (NULL);
+
+  /* Entries released behind the back of the index are not trusted */
+  tINQ_DB_ENT* p_ent = it->second;
+  if (!p_ent->in_use || p_ent->inq_info.results.remote_bd_addr != p_bda) {
+    btm_cb.inq_db_by_addr.erase(it);
+    return (NULL);
+  }
+  return (p_ent);
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_inq_db_remove
+ *
+ * Description      This function releases an entry of the inquiry database.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btm_inq_db_remove(tINQ_DB_ENT* p_ent) {
+  auto it = btm_cb.inq_db_by_addr.find(p_ent->inq_info.results.remote_bd_addr);
+  if (it != btm_cb.inq_db_by_addr.end() && it->second == p_ent)
+    btm_cb.inq_db_by_addr.erase(it);
+  p_ent->in_use = false;
+}
+
+/* Rebuilds the indexes of the inquiry database from its entries */
+static void btm_inq_db_reindex(void) {
   tINQ_DB_ENT* p_ent = btm_cb.btm_inq_vars.inq_db;
 
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use && p_ent->inq_info.results.remote_bd_addr == p_bda)
-      return (p_ent);
+  btm_cb.inq_db_by_addr.clear();
+  btm_cb.inq_db_by_age = {};
+  for (uint16_t xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+    if (!p_ent->in_use) continue;
+    btm_cb.inq_db_by_addr[p_ent->inq_info.results.remote_bd_addr] = p_ent;
+    btm_cb.inq_db_by_age.emplace(p_ent->time_of_resp, p_ent);
   }
+}
 
-  /* If here, not found */
+/* Returns the free entry, or releases the in use entry with the oldest
+ * response, found first in the age order. NULL if the age order is empty. */
+static tINQ_DB_ENT* btm_inq_db_evict_oldest(void) {
+  auto& by_age = btm_cb.inq_db_by_age;
+
+  while (!by_age.empty()) {
+    uint64_t time_of_resp = by_age.top().first;
+    tINQ_DB_ENT* p_ent = by_age.top().second;
+    by_age.pop();
+
+    if (!p_ent->in_use) return (p_ent);
+    /* Responses received since the entry was queued move it back */
+    if (p_ent->time_of_resp != time_of_resp) {
+      by_age.emplace(p_ent->time_of_resp, p_ent);
+      continue;
+    }
+    btm_inq_db_remove(p_ent);
+    return (p_ent);
+  }
   return (NULL);
 }
 
@@ -1004,32 +1110,32 @@ tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda) {
   uint16_t xx;
-  tINQ_DB_ENT* p_ent = btm_cb.btm_inq_vars.inq_db;
-  tINQ_DB_ENT* p_old = btm_cb.btm_inq_vars.inq_db;
-  uint64_t ot = UINT64_MAX;
+  tINQ_DB_ENT* p_ent = NULL;
 
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (!p_ent->in_use) {
-      memset(p_ent, 0, sizeof(tINQ_DB_ENT));
-      p_ent->inq_info.results.remote_bd_addr = p_bda;
-      p_ent->in_use = true;
-
-      return (p_ent);
-    }
+  /* The age order keeps stale items of the removed entries: drop them once
+   * they outnumber the entries */
+  if (btm_cb.inq_db_by_age.size() > 4 * BTM_INQ_DB_SIZE) btm_inq_db_reindex();
 
-    if (p_ent->time_of_resp < ot) {
-      p_old = p_ent;
-      ot = p_ent->time_of_resp;
-    }
+  if (btm_cb.inq_db_by_addr.size() < BTM_INQ_DB_SIZE) {
+    p_ent = btm_cb.btm_inq_vars.inq_db;
+    for (xx = 0; xx < BTM_INQ_DB_SIZE && p_ent->in_use; xx++) p_ent++;
+    if (xx == BTM_INQ_DB_SIZE) p_ent = NULL;
   }
 
-  /* If here, no free entry found. Return the oldest. */
+  /* If here with no free entry, reuse the oldest */
+  if (p_ent == NULL) p_ent = btm_inq_db_evict_oldest();
+  if (p_ent == NULL) {
+    btm_inq_db_reindex();
+    p_ent = btm_inq_db_evict_oldest();
+  }
 
-  memset(p_old, 0, sizeof(tINQ_DB_ENT));
-  p_old->inq_info.results.remote_bd_addr = p_bda;
-  p_old->in_use = true;
+  memset(p_ent, 0, sizeof(tINQ_DB_ENT));
+  p_ent->inq_info.results.remote_bd_addr = p_bda;
+  p_ent->in_use = true;
+  btm_cb.inq_db_by_addr[p_bda] = p_ent;
+  btm_cb.inq_db_by_age.emplace(p_ent->time_of_resp, p_ent);
 
-  return (p_old);
+  return (p_ent);
 }
 
 /*******************************************************************************
@@ -1205,6 +1311,7 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
                BTM_EIR_SERVICE_ARRAY_SIZE * (BTM_EIR_ARRAY_BITS / 8));
         /* set bit map of UUID list from received EIR */
         btm_set_eir_uuid(p, p_cur);
+        btm_rmt_name_cache_update_from_eir(bda, p, HCI_EXT_INQ_RESPONSE_LEN);
         p_eir_data = p;
       } else
         p_eir_data = NULL;
@@ -1253,6 +1360,7 @@ void btm_sort_inq_result(void) {
   }
 
   osi_free(p_tmp);
+  btm_inq_db_reindex();
 }
 
 /*******************************************************************************
@@ -1366,7 +1474,15 @@ tBTM_STATUS btm_initiate_rem_name(const RawAddress& remote_bda, uint8_t origin,
   if (!BTM_IsDeviceUp()) return (BTM_WRONG_MODE);
   if (origin == BTM_RMT_NAME_EXT) {
     if (p_inq->remname_active) {
-      return (BTM_BUSY);
+      if (p_inq->remname_bda != remote_bda) return (BTM_BUSY);
+      /* The active request completes for this caller as well */
+      if (p_cb && p_cb != p_inq->p_remname_cmpl_cb &&
+          std::find(btm_cb.remname_waiters.begin(),
+                    btm_cb.remname_waiters.end(),
+                    p_cb) == btm_cb.remname_waiters.end()) {
+        btm_cb.remname_waiters.push_back(p_cb);
+      }
+      return BTM_CMD_STARTED;
     } else {
       /* If there is no remote name request running,call the callback function
        * and start timer */
@@ -1376,18 +1492,24 @@ tBTM_STATUS btm_initiate_rem_name(const RawAddress& remote_bda, uint8_t origin,
       alarm_set_on_mloop(p_inq->remote_name_timer, timeout_ms,
                          btm_inq_remote_name_timer_timeout, NULL);
 
-      /* If the database entry exists for the device, use its clock offset */
+      /* If the security procedures already requested the name, wait for the
+       * completion of their request */
       tINQ_DB_ENT* p_i = btm_inq_db_find(remote_bda);
-      if (p_i && (p_i->inq_info.results.inq_result_type & BTM_INQ_RESULT_BR)) {
+      if (btm_rmt_name_req_in_flight(remote_bda)) {
+        VLOG(1) << __func__ << ": already pending for " << remote_bda;
+      } else if (p_i &&
+                 (p_i->inq_info.results.inq_result_type & BTM_INQ_RESULT_BR)) {
+        /* If the database entry exists for the device, use its clock offset
+         */
         tBTM_INQ_INFO* p_cur = &p_i->inq_info;
-        btsnd_hcic_rmt_name_req(
+        btm_send_rmt_name_req(
             remote_bda, p_cur->results.page_scan_rep_mode,
             p_cur->results.page_scan_mode,
             (uint16_t)(p_cur->results.clock_offset | BTM_CLOCK_OFFSET_VALID));
       } else {
         /* Otherwise use defaults and mark the clock offset as invalid */
-        btsnd_hcic_rmt_name_req(remote_bda, HCI_PAGE_SCAN_REP_MODE_R1,
-                                HCI_MANDATARY_PAGE_SCAN_MODE, 0);
+        btm_send_rmt_name_req(remote_bda, HCI_PAGE_SCAN_REP_MODE_R1,
+                              HCI_MANDATARY_PAGE_SCAN_MODE, 0);
       }
 
       p_inq->remname_active = true;
@@ -1421,8 +1543,14 @@ void btm_process_remote_name(const RawAddress* bda, const BD_NAME bdn,
   if (bda) {
     rem_name.bd_addr = *bda;
     VLOG(2) << "BDA " << *bda;
+    btm_cb.rmt_name_in_flight.erase(*bda);
+    if (hci_status == HCI_SUCCESS && bdn != nullptr) {
+      btm_rmt_name_cache_update(*bda, bdn, evt_len);
+    }
   } else {
     rem_name.bd_addr = RawAddress::kEmpty;
+    /* The failed request is not known */
+    btm_cb.rmt_name_in_flight.clear();
   }
 
   VLOG(2) << "Inquire BDA " << p_inq->remname_bda;
@@ -1468,8 +1596,107 @@ void btm_process_remote_name(const RawAddress* bda, const BD_NAME bdn,
     p_inq->remname_bda = RawAddress::kEmpty;
 
     p_inq->p_remname_cmpl_cb = NULL;
+    std::vector<tBTM_CMPL_CB*> waiters;
+    waiters.swap(btm_cb.remname_waiters);
     if (p_cb) (p_cb)(&rem_name);
+    for (tBTM_CMPL_CB* p_waiter : waiters) (p_waiter)(&rem_name);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_rmt_name_cache_update
+ *
+ * Description      This function stores the name of a remote device, received
+ *                  in |p_name| of |len| bytes, in the remote name cache. When
+ *                  the cache is full, the expired names are dropped, or else
+ *                  the oldest one.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btm_rmt_name_cache_update(const RawAddress& bda, const uint8_t* p_name,
+                               uint16_t len) {
+  len = std::min<uint16_t>(len, BD_NAME_LEN);
+  while (len > 0 && p_name[len - 1] == 0) len--;
+  if (len == 0) return;
+
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  auto& cache = btm_cb.rmt_name_cache;
+  if (cache.size() >= BTM_RMT_NAME_CACHE_SIZE && cache.count(bda) == 0) {
+    auto oldest = cache.end();
+    for (auto it = cache.begin(); it != cache.end();) {
+      if (now_ms - it->second.time_ms >= BTM_RMT_NAME_CACHE_TIMEOUT_MS) {
+        it = cache.erase(it);
+        continue;
+      }
+      if (oldest == cache.end() || it->second.time_ms < oldest->second.time_ms)
+        oldest = it;
+      ++it;
+    }
+    if (cache.size() >= BTM_RMT_NAME_CACHE_SIZE) cache.erase(oldest);
   }
+
+  tBTM_RMT_NAME_CACHE_ENT& ent = cache[bda];
+  memcpy(ent.name, p_name, len);
+  ent.name[len] = 0;
+  ent.length = len;
+  ent.time_ms = now_ms;
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_rmt_name_cache_update_from_eir
+ *
+ * Description      This function stores the complete local name found in the
+ *                  EIR or advertising data of a remote device in the remote
+ *                  name cache. The shortened names are not stored, since they
+ *                  differ from the names returned by remote name requests.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btm_rmt_name_cache_update_from_eir(const RawAddress& bda,
+                                        const uint8_t* p_eir, size_t eir_len) {
+  uint8_t len = 0;
+  const uint8_t* p_name = AdvertiseDataParser::GetFieldByType(
+      p_eir, eir_len, HCI_EIR_COMPLETE_LOCAL_NAME_TYPE, &len);
+  if (p_name != nullptr && len != 0) {
+    btm_rmt_name_cache_update(bda, p_name, len);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_rmt_name_cache_read
+ *
+ * Description      This function looks up the name of a remote device in the
+ *                  remote name cache, and drops it if it expired.
+ *
+ * Returns          true and fills |p_name| if a name was found
+ *
+ ******************************************************************************/
+bool btm_rmt_name_cache_read(const RawAddress& bda,
+                             tBTM_REMOTE_DEV_NAME* p_name) {
+  auto it = btm_cb.rmt_name_cache.find(bda);
+  if (it == btm_cb.rmt_name_cache.end()) return false;
+  if (bluetooth::common::time_get_os_boottime_ms() - it->second.time_ms >=
+      BTM_RMT_NAME_CACHE_TIMEOUT_MS) {
+    btm_cb.rmt_name_cache.erase(it);
+    return false;
+  }
+
+  p_name->status = BTM_SUCCESS;
+  p_name->bd_addr = bda;
+  p_name->length = it->second.length;
+  memcpy(p_name->remote_bd_name, it->second.name, it->second.length + 1);
+  p_name->hci_status = HCI_SUCCESS;
+  return true;
+}
+
+static void btm_rmt_name_cache_report(tBTM_CMPL_CB* p_cb,
+                                      tBTM_REMOTE_DEV_NAME rem_name) {
+  (p_cb)(&rem_name);
 }
 
 void btm_inq_remote_name_timer_timeout(UNUSED_ATTR void* data) {
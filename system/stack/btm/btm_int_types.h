@@ -19,10 +19,15 @@
 #define BTM_INT_TYPES_H
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <queue>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include "gd/common/circular_buffer.h"
+#include "gd/common/event_log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
 #include "osi/include/list.h"
@@ -34,33 +39,30 @@
 #include "stack/include/bt_octets.h"
 #include "stack/include/btm_ble_api_types.h"
 #include "stack/include/security_client_callbacks.h"
+#include "types/ble_address_with_type.h"
 #include "types/raw_address.h"
 
 #define BTM_MAX_SCN_ 31  // PORT_MAX_RFC_PORTS packages/modules/Bluetooth/system/stack/include/rfcdefs.h
 
-constexpr size_t kMaxLogSize = 255;
-constexpr size_t kBtmLogHistoryBufferSize = 100;
-
-class TimestampedStringCircularBuffer
-    : public bluetooth::common::TimestampedCircularBuffer<std::string> {
- public:
-  explicit TimestampedStringCircularBuffer(size_t size)
-      : bluetooth::common::TimestampedCircularBuffer<std::string>(size) {}
-
-  void Push(std::string s) {
-    bluetooth::common::TimestampedCircularBuffer<std::string>::Push(
-        s.substr(0, kMaxLogSize));
-  }
-
-  template <typename... Args>
-  void Push(Args... args) {
-    char buf[kMaxLogSize];
-    std::snprintf(buf, sizeof(buf), args...);
-    bluetooth::common::TimestampedCircularBuffer<std::string>::Push(
-        std::string(buf));
-  }
+constexpr size_t kBtmLogHistoryBufferSize = 128;
+constexpr size_t kMaxLogHistoryTagLength = 6;
+constexpr size_t kMaxLogHistoryMsgLength = 25;
+constexpr size_t kMaxLogHistoryExtraLength = 127;
+
+/* Entry of the btm history, copied as is and only formatted when dumped */
+struct tBTM_LOG_HISTORY_RECORD {
+  char tag[kMaxLogHistoryTagLength + 1];
+  char msg[kMaxLogHistoryMsgLength + 1];
+  char extra[kMaxLogHistoryExtraLength + 1];
+  tBLE_BD_ADDR addr;
+  bool has_addr;      /* false for the stack events without a peer */
+  bool has_addr_type; /* false for the BR/EDR addresses */
 };
 
+using tBTM_LOG_HISTORY =
+    bluetooth::common::EventLog<tBTM_LOG_HISTORY_RECORD,
+                                kBtmLogHistoryBufferSize>;
+
 /*
  * Local device configuration
  */
@@ -243,6 +245,23 @@ typedef struct tBTM_CB {
   **      Inquiry
   *****************************************************/
   tBTM_INQUIRY_VAR_ST btm_inq_vars;
+  /* Lookup indexes of btm_inq_vars.inq_db, maintained by btm_inq.cc: the in
+   * use entries by address, and by time of response, oldest first. The age
+   * order is updated lazily: an entry may be queued with an older time than
+   * its current time_of_resp. */
+  std::unordered_map<RawAddress, tINQ_DB_ENT*> inq_db_by_addr;
+  std::priority_queue<std::pair<uint64_t, tINQ_DB_ENT*>,
+                      std::vector<std::pair<uint64_t, tINQ_DB_ENT*>>,
+                      std::greater<std::pair<uint64_t, tINQ_DB_ENT*>>>
+      inq_db_by_age;
+  /* Remote names recently learned, by address, and the remote name requests
+   * sent to the controller and not completed yet, by address, with the time
+   * at which they were sent. */
+  std::unordered_map<RawAddress, tBTM_RMT_NAME_CACHE_ENT> rmt_name_cache;
+  std::unordered_map<RawAddress, uint64_t> rmt_name_in_flight;
+  /* Callbacks of the BTM_ReadRemoteDeviceName calls for
+   * btm_inq_vars.remname_bda coalesced into the active request */
+  std::vector<tBTM_CMPL_CB*> remname_waiters;
 
   /*****************************************************
   **      SCO Management
@@ -279,6 +298,16 @@ typedef struct tBTM_CB {
   uint8_t disc_reason{0};           /* for legacy devices */
   tBTM_SEC_SERV_REC sec_serv_rec[BTM_SEC_MAX_SERVICE_RECORDS];
   list_t* sec_dev_rec{nullptr}; /* list of tBTM_SEC_DEV_REC */
+  /* Lookup indexes of sec_dev_rec, maintained by btm_dev.cc. Entries are
+   * hints, checked against the record before use. */
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> sec_dev_rec_by_addr;
+  std::unordered_map<uint16_t, tBTM_SEC_DEV_REC*> sec_dev_rec_by_handle;
+  /* IRKs of sec_dev_rec for the host resolution of the RPAs, rebuilt when
+   * rpa_irk_index_dirty is set, and the RPAs resolved by the host. Entries
+   * are hints, checked against the record before use. */
+  std::vector<tBTM_BLE_RPA_IRK> rpa_irk_index;
+  bool rpa_irk_index_dirty{true};
+  std::unordered_map<RawAddress, tBTM_BLE_RPA_CACHE_ENT> rpa_cache;
   tBTM_SEC_SERV_REC* p_out_serv{nullptr};
   tBTM_MKEY_CALLBACK* mkey_cback{nullptr};
 
@@ -308,7 +337,7 @@ typedef struct tBTM_CB {
 
   tACL_CB acl_cb_;
 
-  std::shared_ptr<TimestampedStringCircularBuffer> history_{nullptr};
+  std::shared_ptr<tBTM_LOG_HISTORY> history_{nullptr};
 
   void Init(uint8_t initial_security_mode) {
     memset(&cfg, 0, sizeof(cfg));
@@ -342,17 +371,27 @@ typedef struct tBTM_CB {
     security_mode = initial_security_mode;
     pairing_bda = RawAddress::kAny;
     sec_dev_rec = list_new(osi_free);
+    sec_dev_rec_by_addr.clear();
+    sec_dev_rec_by_handle.clear();
+    rpa_irk_index.clear();
+    rpa_irk_index_dirty = true;
+    rpa_cache.clear();
 
     /* Initialize BTM component structures */
     btm_inq_vars.Init(); /* Inquiry Database and Structures */
+    inq_db_by_addr.clear();
+    inq_db_by_age = {};
+    rmt_name_cache.clear();
+    rmt_name_in_flight.clear();
+    remname_waiters.clear();
     acl_cb_ = {};
     sco_cb.Init();       /* SCO Database and Structures (If included) */
     devcb.Init();
 
-    history_ = std::make_shared<TimestampedStringCircularBuffer>(
-        kBtmLogHistoryBufferSize);
+    history_ = std::make_shared<tBTM_LOG_HISTORY>();
     CHECK(history_ != nullptr);
-    history_->Push(std::string("Initialized btm history"));
+    history_->Record(
+        tBTM_LOG_HISTORY_RECORD{.msg = "Initialized btm history"});
   }
 
   void Free() {
@@ -361,6 +400,11 @@ typedef struct tBTM_CB {
     devcb.Free();
     sco_cb.Free();
     btm_inq_vars.Free();
+    inq_db_by_addr.clear();
+    inq_db_by_age = {};
+    rmt_name_cache.clear();
+    rmt_name_in_flight.clear();
+    remname_waiters.clear();
 
     fixed_queue_free(page_queue, nullptr);
     page_queue = nullptr;
@@ -368,6 +412,11 @@ typedef struct tBTM_CB {
     fixed_queue_free(sec_pending_q, nullptr);
     sec_pending_q = nullptr;
 
+    sec_dev_rec_by_addr.clear();
+    sec_dev_rec_by_handle.clear();
+    rpa_irk_index.clear();
+    rpa_irk_index_dirty = true;
+    rpa_cache.clear();
     list_free(sec_dev_rec);
     sec_dev_rec = nullptr;
 
@@ -102,6 +102,11 @@ void IsoManager::SendIsoData(uint16_t iso_handle, const uint8_t* data,
   pimpl_->iso_impl_->send_iso_data(iso_handle, data, data_len);
 }
 
+void IsoManager::SendIsoDataBatch(const iso_manager::iso_sdu* sdus,
+                                  uint8_t num_sdus) {
+  pimpl_->iso_impl_->send_iso_data_batch(sdus, num_sdus);
+}
+
 void IsoManager::CreateBig(uint8_t big_id,
                            struct iso_manager::big_create_params big_params) {
   pimpl_->iso_impl_->create_big(big_id, std::move(big_params));
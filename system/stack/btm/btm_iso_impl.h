@@ -29,6 +29,7 @@
 #include "btm_iso_api.h"
 #include "common/time_util.h"
 #include "device/include/controller.h"
+#include "gd/common/sorted_vector_map.h"
 #include "hci/include/hci_layer.h"
 #include "internal_include/stack_config.h"
 #include "osi/include/allocator.h"
@@ -507,8 +508,8 @@ struct iso_impl {
     bte_main_hci_send(packet, MSG_STACK_TO_HC_HCI_ISO | 0x0001);
   }
 
-  void send_iso_data(uint16_t iso_handle, const uint8_t* data,
-                     uint16_t data_len) {
+  /* Returns the connection of iso_handle if it can send data, or nullptr */
+  iso_base* get_iso_for_tx(uint16_t iso_handle) {
     iso_base* iso = GetIsoIfKnown(iso_handle);
     LOG_ASSERT(iso != nullptr)
         << "No such iso connection handle: " << loghex(iso_handle);
@@ -517,34 +518,37 @@ struct iso_impl {
       if (!(iso->state_flags & kStateFlagIsConnected)) {
         LOG(WARNING) << __func__ << "Cis handle: " << loghex(iso_handle)
                      << " not established";
-        return;
+        return nullptr;
       }
     }
 
     if (!(iso->state_flags & kStateFlagHasDataPathSet)) {
       LOG_WARN("Data path not set for handle: 0x%04x", iso_handle);
-      return;
+      return nullptr;
     }
 
+    return iso;
+  }
+
+  void drop_iso_sdu(iso_base* iso, uint16_t iso_handle, uint16_t data_len) {
+    iso->cr_stats.credits_underflow_bytes += data_len;
+    iso->cr_stats.credits_underflow_count++;
+    iso->cr_stats.credits_last_underflow_us =
+        bluetooth::common::time_get_os_boottime_us();
+
+    LOG(WARNING) << __func__ << ", dropping ISO packet, len: "
+                 << static_cast<int>(data_len)
+                 << ", iso credits: " << static_cast<int>(iso_credits_)
+                 << ", iso handle: " << loghex(iso_handle);
+  }
+
+  void send_iso_sdu(iso_base* iso, uint16_t iso_handle, uint32_t ts,
+                    const uint8_t* data, uint16_t data_len) {
     /* Calculate sequence number for the ISO data packet.
      * It should be incremented by 1 every SDU Interval.
      */
-    uint32_t ts = bluetooth::common::time_get_os_boottime_us();
     iso->sync_info.seq_nb = (ts - iso->sync_info.first_sync_ts) / iso->sdu_itv;
 
-    if (iso_credits_ == 0 || data_len > iso_buffer_size_) {
-      iso->cr_stats.credits_underflow_bytes += data_len;
-      iso->cr_stats.credits_underflow_count++;
-      iso->cr_stats.credits_last_underflow_us =
-          bluetooth::common::time_get_os_boottime_us();
-
-      LOG(WARNING) << __func__ << ", dropping ISO packet, len: "
-                   << static_cast<int>(data_len)
-                   << ", iso credits: " << static_cast<int>(iso_credits_)
-                   << ", iso handle: " << loghex(iso_handle);
-      return;
-    }
-
     iso_credits_--;
     iso->used_credits++;
 
@@ -554,6 +558,54 @@ struct iso_impl {
     send_iso_data_hci_packet(packet);
   }
 
+  void send_iso_data(uint16_t iso_handle, const uint8_t* data,
+                     uint16_t data_len) {
+    iso_base* iso = get_iso_for_tx(iso_handle);
+    if (iso == nullptr) return;
+
+    uint32_t ts = bluetooth::common::time_get_os_boottime_us();
+    if (iso_credits_ == 0 || data_len > iso_buffer_size_) {
+      drop_iso_sdu(iso, iso_handle, data_len);
+      return;
+    }
+
+    send_iso_sdu(iso, iso_handle, ts, data, data_len);
+  }
+
+  void send_iso_data_batch(const iso_manager::iso_sdu* sdus,
+                           uint8_t num_sdus) {
+    LOG_ASSERT(num_sdus <= iso_manager::kIsoMaxSdusPerBatch)
+        << "Too many SDUs in the batch: " << +num_sdus;
+
+    /* Streams which cannot send, e.g. a disconnected CIS, are left out and do
+     * not prevent the others from sending.
+     */
+    iso_base* isos[iso_manager::kIsoMaxSdusPerBatch];
+    uint8_t num_ready = 0;
+    bool fits = true;
+    for (uint8_t i = 0; i < num_sdus; ++i) {
+      isos[i] = get_iso_for_tx(sdus[i].conn_handle);
+      if (isos[i] == nullptr) continue;
+      num_ready++;
+      if (sdus[i].data_len > iso_buffer_size_) fits = false;
+    }
+
+    /* The SDUs belong to the same SDU interval, so they share the time stamp
+     * and are either all sent or all dropped.
+     */
+    uint32_t ts = bluetooth::common::time_get_os_boottime_us();
+    bool can_send = fits && iso_credits_ >= num_ready;
+    for (uint8_t i = 0; i < num_sdus; ++i) {
+      if (isos[i] == nullptr) continue;
+      if (can_send) {
+        send_iso_sdu(isos[i], sdus[i].conn_handle, ts, sdus[i].data,
+                     sdus[i].data_len);
+      } else {
+        drop_iso_sdu(isos[i], sdus[i].conn_handle, sdus[i].data_len);
+      }
+    }
+  }
+
   void process_cis_est_pkt(uint8_t len, uint8_t* data) {
     cis_establish_cmpl_evt evt;
 
@@ -960,8 +1012,11 @@ struct iso_impl {
     dprintf(fd, "  ----------------\n ");
   }
 
-  std::map<uint16_t, std::unique_ptr<iso_cis>> conn_hdl_to_cis_map_;
-  std::map<uint16_t, std::unique_ptr<iso_bis>> conn_hdl_to_bis_map_;
+  /* Looked up for every ISO data packet and credit */
+  bluetooth::common::SortedVectorMap<uint16_t, std::unique_ptr<iso_cis>>
+      conn_hdl_to_cis_map_;
+  bluetooth::common::SortedVectorMap<uint16_t, std::unique_ptr<iso_bis>>
+      conn_hdl_to_bis_map_;
   std::map<uint16_t, RawAddress> cis_hdl_to_addr;
 
   std::atomic_uint16_t iso_credits_;
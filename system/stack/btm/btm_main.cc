@@ -22,11 +22,12 @@
  *
  ******************************************************************************/
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 
 #include "bt_target.h"
-#include "main/shim/dumpsys.h"
 #include "osi/include/log.h"
 #include "stack/btm/btm_int_types.h"
 #include "stack/include/btm_client_interface.h"
@@ -60,24 +61,35 @@ void btm_free(void) {
   btm_cb.Free();
 }
 
-constexpr size_t kMaxLogHistoryTagLength = 6;
-constexpr size_t kMaxLogHistoryMsgLength = 25;
+template <size_t N>
+static void btm_log_history_copy(char (&dst)[N], const std::string& src) {
+  size_t length = std::min(src.size(), N - 1);
+  memcpy(dst, src.data(), length);
+  dst[length] = '\0';
+}
 
-static void btm_log_history(const std::string& tag, const char* addr,
-                            const std::string& msg, const std::string& extra) {
+static void btm_log_history(const std::string& tag, const tBLE_BD_ADDR& addr,
+                            bool has_addr_type, const std::string& msg,
+                            const std::string& extra) {
   if (btm_cb.history_ == nullptr) {
     LOG_ERROR("BTM_LogHistory has not been constructed or already destroyed !");
     return;
   }
 
-  btm_cb.history_->Push(
-      "%-6s %-25s: %s %s", tag.substr(0, kMaxLogHistoryTagLength).c_str(),
-      msg.substr(0, kMaxLogHistoryMsgLength).c_str(), addr, extra.c_str());
+  tBTM_LOG_HISTORY_RECORD record;
+  btm_log_history_copy(record.tag, tag);
+  btm_log_history_copy(record.msg, msg);
+  btm_log_history_copy(record.extra, extra);
+  record.addr = addr;
+  record.has_addr = true;
+  record.has_addr_type = has_addr_type;
+  btm_cb.history_->Record(record);
 }
 
 void BTM_LogHistory(const std::string& tag, const RawAddress& bd_addr,
                     const std::string& msg, const std::string& extra) {
-  btm_log_history(tag, PRIVATE_ADDRESS(bd_addr), msg, extra);
+  btm_log_history(tag, tBLE_BD_ADDR{.type = BLE_ADDR_PUBLIC, .bda = bd_addr},
+                  false, msg, extra);
 }
 
 void BTM_LogHistory(const std::string& tag, const RawAddress& bd_addr,
@@ -87,7 +99,7 @@ void BTM_LogHistory(const std::string& tag, const RawAddress& bd_addr,
 
 void BTM_LogHistory(const std::string& tag, const tBLE_BD_ADDR& ble_bd_addr,
                     const std::string& msg, const std::string& extra) {
-  btm_log_history(tag, PRIVATE_ADDRESS(ble_bd_addr), msg, extra);
+  btm_log_history(tag, ble_bd_addr, true, msg, extra);
 }
 
 void BTM_LogHistory(const std::string& tag, const tBLE_BD_ADDR& ble_bd_addr,
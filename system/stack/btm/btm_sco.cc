@@ -26,9 +26,11 @@
 #include <base/logging.h>
 #include <base/strings/stringprintf.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
@@ -174,6 +176,50 @@ static tSCO_CONN* btm_get_active_sco() {
   return nullptr;
 }
 
+// Counts a packet received on the active link, with its Packet_Status_Flag
+static void btm_sco_count_rx_packet(tSCO_HCI_STATS* p_stats,
+                                    uint8_t packet_status) {
+  uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+  if (p_stats->rx_packets > 0) {
+    p_stats->max_rx_interval_us =
+        std::max(p_stats->max_rx_interval_us, now_us - p_stats->last_rx_us);
+  }
+  p_stats->last_rx_us = now_us;
+  p_stats->rx_packets++;
+
+  switch (packet_status) {
+    case 0x1:
+      p_stats->rx_erroneous++;
+      break;
+    case 0x2:
+      p_stats->rx_no_data++;
+      break;
+    case 0x3:
+      p_stats->rx_partially_lost++;
+      break;
+    default:
+      break;
+  }
+}
+
+// Reads at most |length| bytes of the audio server straight into a SCO
+// packet of |sco_handle|. Returns nullptr when there is no data to send.
+static BT_HDR* btm_sco_read_packet(uint16_t sco_handle, uint8_t length) {
+  BT_HDR* p_buf = (BT_HDR*)osi_calloc(BT_SMALL_BUFFER_SIZE);
+  // SCO header size is 3 per Core 5.2 Vol 4 Part E 5.4.3 figure 5.3
+  size_t size_read = bluetooth::audio::sco::read(p_buf->data + 3, length);
+  if (size_read == 0) {
+    osi_free(p_buf);
+    return nullptr;
+  }
+  p_buf->event = BT_EVT_TO_LM_HCI_SCO;
+  p_buf->len = size_read + 3;
+  uint8_t* payload = p_buf->data;
+  UINT16_TO_STREAM(payload, sco_handle);
+  UINT8_TO_STREAM(payload, size_read);
+  return p_buf;
+}
+
 /*******************************************************************************
  *
  * Function         btm_route_sco_data
@@ -184,8 +230,10 @@ static tSCO_CONN* btm_get_active_sco() {
  *
  ******************************************************************************/
 void btm_route_sco_data(BT_HDR* p_msg) {
+  tSCO_HCI_STATS& stats = btm_cb.sco_cb.hci_stats;
   if (p_msg->len < 3) {
     LOG_ERROR("Received incomplete SCO header");
+    stats.rx_dropped++;
     osi_free(p_msg);
     return;
   }
@@ -196,6 +244,7 @@ void btm_route_sco_data(BT_HDR* p_msg) {
   STREAM_TO_UINT8(length, payload);
   if (p_msg->len != length + 3) {
     LOG_ERROR("Received invalid SCO data of size: %hhu, dropping", length);
+    stats.rx_dropped++;
     osi_free(p_msg);
     return;
   }
@@ -203,16 +252,50 @@ void btm_route_sco_data(BT_HDR* p_msg) {
   ASSERT_LOG(handle <= 0xEFF, "Require handle <= 0xEFF, but is 0x%X", handle);
   auto* active_sco = btm_get_active_sco();
   if (active_sco != nullptr && active_sco->hci_handle == handle) {
+    btm_sco_count_rx_packet(&stats, (handle_with_flags >> 12) & 0x3);
     // TODO: For MSBC, we need to decode here
     bluetooth::audio::sco::write(payload, length);
+  } else {
+    stats.rx_dropped++;
   }
   osi_free(p_msg);
-  // For Chrome OS, we send the outgoing data after receiving an incoming one
-  uint8_t out_buf[BTM_SCO_DATA_SIZE_MAX];
-  auto size_read = bluetooth::audio::sco::read(out_buf, length);
-  auto data = std::vector<uint8_t>(out_buf, out_buf + size_read);
+  if (active_sco == nullptr) return;
+
+  // For Chrome OS, we send the outgoing data after receiving an incoming one.
+  // The data of the audio server is read into the packet to send.
   // TODO: For MSBC, we need to encode here
-  btm_send_sco_packet(std::move(data));
+  uint8_t tx_length = std::min<uint8_t>(length, BTM_SCO_DATA_SIZE_MAX);
+  BT_HDR* packet = btm_sco_read_packet(active_sco->hci_handle, tx_length);
+  if (packet == nullptr) {
+    stats.tx_underruns++;
+    return;
+  }
+  // Short of the requested length, not of the received one which may be larger
+  if (packet->len < tx_length + 3) stats.tx_underruns++;
+  stats.tx_packets++;
+  bte_main_hci_send(packet, BT_EVT_TO_LM_HCI_SCO);
+}
+
+/*******************************************************************************
+ *
+ * Function         BTM_DumpScoStatistics
+ *
+ * Description      Dump the statistics of the SCO data routed over HCI
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTM_DumpScoStatistics(int fd) {
+  const tSCO_HCI_STATS& stats = btm_cb.sco_cb.hci_stats;
+  dprintf(fd, "\nSCO over HCI:\n");
+  dprintf(fd,
+          "  rx packets:%u erroneous:%u no_data:%u partially_lost:%u "
+          "dropped:%u max_interval_us:%llu\n",
+          stats.rx_packets, stats.rx_erroneous, stats.rx_no_data,
+          stats.rx_partially_lost, stats.rx_dropped,
+          (unsigned long long)stats.max_rx_interval_us);
+  dprintf(fd, "  tx packets:%u underruns:%u\n", stats.tx_packets,
+          stats.tx_underruns);
 }
 
 void btm_send_sco_packet(std::vector<uint8_t> data) {
@@ -763,6 +846,7 @@ void btm_sco_connected(const RawAddress& bda, uint16_t hci_handle,
 
       (*p->p_conn_cb)(xx);
 
+      btm_cb.sco_cb.hci_stats = {};
       bluetooth::audio::sco::open();
 
       return;
@@ -118,11 +118,28 @@ typedef struct {
 
 } tSCO_CONN;
 
+/* Statistics of the SCO data routed over HCI, for the current link */
+typedef struct {
+  uint32_t rx_packets;
+  /* Packet_Status_Flag of the received packets, Core 5.3 Vol 4 Part E 5.4.3 */
+  uint32_t rx_erroneous;
+  uint32_t rx_no_data;
+  uint32_t rx_partially_lost;
+  /* Malformed packets, or packets of an inactive link */
+  uint32_t rx_dropped;
+  uint32_t tx_packets;
+  /* Transmit slots for which the audio server had less than a packet */
+  uint32_t tx_underruns;
+  uint64_t last_rx_us;
+  uint64_t max_rx_interval_us;
+} tSCO_HCI_STATS;
+
 /* SCO Management control block */
 typedef struct {
   tSCO_CONN sco_db[BTM_MAX_SCO_LINKS];
   enh_esco_params_t def_esco_parms;
   bool esco_supported;        /* true if 1.2 cntlr AND supports eSCO links */
+  tSCO_HCI_STATS hci_stats;
 
   tSCO_CONN* get_sco_connection_from_index(uint16_t index) {
     return (index < kMaxScoLinks) ? (&sco_db[index]) : nullptr;
@@ -140,6 +157,7 @@ typedef struct {
 
   void Init() {
     def_esco_parms = esco_parameters_for_codec(ESCO_CODEC_CVSD_S3);
+    hci_stats = {};
   }
 
   void Free() { bluetooth::audio::sco::cleanup(); }
@@ -3706,6 +3706,7 @@ void btm_sec_connected(const RawAddress& bda, uint16_t handle,
   }
 
   p_dev_rec->hci_handle = handle;
+  btm_sec_index_dev_rec(p_dev_rec);
   btm_acl_created(bda, handle, assigned_role, BT_TRANSPORT_BR_EDR);
 
   /* role may not be correct here, it will be updated by l2cap, but we need to
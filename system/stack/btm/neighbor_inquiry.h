@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include "osi/include/alarm.h"
@@ -261,3 +262,23 @@ typedef union /* contains the inquiry filter condition */
 
 extern bool btm_inq_find_bdaddr(const RawAddress& p_bda);
 extern tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda);
+extern void btm_inq_db_remove(tINQ_DB_ENT* p_ent);
+
+/* Cache of the remote names learned from EIR, advertising data or a remote
+ * name request, used to answer BTM_ReadRemoteDeviceName without paging */
+#define BTM_RMT_NAME_CACHE_SIZE 64
+#define BTM_RMT_NAME_CACHE_TIMEOUT_MS (60 * 1000) /* 60 seconds */
+
+typedef struct {
+  uint16_t length;
+  BD_NAME name;
+  uint64_t time_ms; /* Boot time at which the name was learned */
+} tBTM_RMT_NAME_CACHE_ENT;
+
+extern void btm_rmt_name_cache_update(const RawAddress& bda,
+                                      const uint8_t* p_name, uint16_t len);
+extern void btm_rmt_name_cache_update_from_eir(const RawAddress& bda,
+                                               const uint8_t* p_eir,
+                                               size_t eir_len);
+extern bool btm_rmt_name_cache_read(const RawAddress& bda,
+                                    tBTM_REMOTE_DEV_NAME* p_name);
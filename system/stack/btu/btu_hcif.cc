@@ -39,6 +39,7 @@
 #include "main/shim/hci_layer.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
+#include "stack/include/acl_api.h"
 #include "stack/include/acl_hci_link_interface.h"
 #include "stack/include/ble_acl_interface.h"
 #include "stack/include/ble_hci_link_interface.h"
@@ -1698,6 +1699,7 @@ static void btu_ble_data_length_change_evt(uint8_t* p, uint16_t evt_len) {
   p += 2; /* Skip the TxTimer */
   STREAM_TO_UINT16(rx_data_len, p);
 
+  acl_ble_set_tx_data_length(handle, tx_data_len);
   l2cble_process_data_length_change_event(handle, tx_data_len, rx_data_len);
 }
 
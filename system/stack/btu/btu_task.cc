@@ -32,9 +32,11 @@
 #include "btif/include/btif_common.h"
 #include "btm_iso_api.h"
 #include "common/message_loop_thread.h"
+#include "main/shim/entry.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "osi/include/properties.h"
 #include "stack/include/acl_hci_link_interface.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/btu.h"
@@ -49,6 +51,11 @@ uint8_t btu_trace_level = HCI_INITIAL_TRACE_LEVEL;
 
 static MessageLoopThread main_thread("bt_main_thread", true);
 
+// Runs the tasks of the main thread on the Gd stack thread, so that the events
+// and data the shim hands over to the legacy stack do not switch threads
+static const char kPropertySharedMainThread[] =
+    "bluetooth.core.shared_main_thread.enabled";
+
 void btu_hci_msg_process(BT_HDR* p_msg) {
   /* Determine the input message type. */
   switch (p_msg->event & BT_EVT_MASK) {
@@ -107,6 +114,15 @@ bt_status_t do_in_main_thread_delayed(const base::Location& from_here,
   return BT_STATUS_SUCCESS;
 }
 
+bt_status_t do_in_main_thread_or_run(const base::Location& from_here,
+                                     base::OnceClosure task) {
+  if (!main_thread.DoInThreadOrRun(from_here, std::move(task))) {
+    LOG(ERROR) << __func__ << ": failed from " << from_here.ToString();
+    return BT_STATUS_FAIL;
+  }
+  return BT_STATUS_SUCCESS;
+}
+
 static void do_post_on_bt_main(BtMainClosure closure) { closure(); }
 
 void post_on_bt_main(BtMainClosure closure) {
@@ -116,6 +132,17 @@ void post_on_bt_main(BtMainClosure closure) {
 }
 
 void main_thread_start_up() {
+  bluetooth::os::Thread* gd_thread = bluetooth::shim::GetGdShimThread();
+  if (gd_thread != nullptr &&
+      osi_property_get_bool(kPropertySharedMainThread, false)) {
+    // The Gd stack thread already runs with real time scheduling
+    main_thread.StartUpOn(gd_thread);
+    if (!main_thread.IsRunning()) {
+      LOG(FATAL) << __func__ << ": unable to start btu on the Gd thread.";
+    }
+    return;
+  }
+
   main_thread.StartUp();
   if (!main_thread.IsRunning()) {
     LOG(FATAL) << __func__ << ": unable to start btu message loop thread.";
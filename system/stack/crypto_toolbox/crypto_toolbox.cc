@@ -54,7 +54,7 @@ Octet16 f4(const uint8_t* u, const uint8_t* v, const Octet16& x, uint8_t z) {
 }
 
 /** helper for f5 */
-static Octet16 calculate_mac_key_or_ltk(const Octet16& t, uint8_t counter,
+static Octet16 calculate_mac_key_or_ltk(const AesCmacKey& t, uint8_t counter,
                                         uint8_t* key_id, const Octet16& n1,
                                         const Octet16& n2, uint8_t* a1,
                                         uint8_t* a2, uint8_t* length) {
@@ -72,7 +72,7 @@ static Octet16 calculate_mac_key_or_ltk(const Octet16& t, uint8_t counter,
   it = std::copy(key_id, key_id + 4, it);
   it = std::copy(&counter, &counter + 1, it);
 
-  return aes_cmac(t, msg.data(), msg.size());
+  return t.Cmac(msg.data(), msg.size());
 }
 
 void f5(const uint8_t* w, const Octet16& n1, const Octet16& n2, uint8_t* a1,
@@ -84,9 +84,10 @@ void f5(const uint8_t* w, const Octet16& n1, const Octet16& n2, uint8_t* a1,
 
   const Octet16 salt{0xBE, 0x83, 0x60, 0x5A, 0xDB, 0x0B, 0x37, 0x60,
                      0x38, 0xA5, 0xF5, 0xAA, 0x91, 0x83, 0x88, 0x6C};
-  Octet16 t = aes_cmac(salt, w, BT_OCTET32_LEN);
+  /* T keys the two CMACs below, and is not kept by aes_cmac() */
+  const AesCmacKey t(aes_cmac(salt, w, BT_OCTET32_LEN));
 
-  DVLOG(2) << "T=" << HexEncode(t.data(), t.size());
+  DVLOG(2) << "T=" << HexEncode(t.key().data(), t.key().size());
 
   uint8_t key_id[4] = {0x65, 0x6c, 0x74, 0x62}; /* 0x62746c65 */
   uint8_t length[2] = {0x00, 0x01};             /* 0x0100 */
@@ -18,11 +18,39 @@
 #include <base/logging.h>
 
 #include "check.h"
+#include "stack/crypto_toolbox/aes.h"
 #include "stack/include/bt_octets.h"
 #include "stack/include/bt_types.h"
 
 namespace crypto_toolbox {
 
+/* AES-128 key with its expanded key schedule and its CMAC subkeys, for the
+ * computations which use the same key several times, like the resolution of
+ * random addresses with an IRK. The keys and messages are in little endian
+ * order, like for the functions below, which expand their key on each call.
+ * All of it is wiped when the object is destroyed. */
+class AesCmacKey {
+ public:
+  explicit AesCmacKey(const Octet16& key);
+  AesCmacKey(const AesCmacKey&) = default;
+  AesCmacKey& operator=(const AesCmacKey&) = default;
+  ~AesCmacKey();
+
+  const Octet16& key() const { return key_; }
+
+  /* This function computes AES_128(key, message) */
+  Octet16 Encrypt(const Octet16& message) const;
+
+  /* This function computes the AES-CMAC of the |length| bytes of |input| */
+  Octet16 Cmac(const uint8_t* input, uint16_t length) const;
+
+ private:
+  Octet16 key_;
+  aes_context ctx_;
+  Octet16 k1_;
+  Octet16 k2_;
+};
+
 extern Octet16 aes_128(const Octet16& key, const Octet16& message);
 extern Octet16 aes_cmac(const Octet16& key, const uint8_t* message,
                         uint16_t length);
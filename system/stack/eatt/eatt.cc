@@ -185,6 +185,12 @@ EattChannel* EattExtension::GetChannelAvailableForClientRequest(
   return pimpl_->eatt_impl_->get_channel_available_for_client_request(bd_addr);
 }
 
+EattChannel* EattExtension::GetLeastLoadedChannelForClientRequest(
+    const RawAddress& bd_addr) {
+  return pimpl_->eatt_impl_->get_least_loaded_channel_for_client_request(
+      bd_addr);
+}
+
 /* Start stop GATT indication timer per CID */
 void EattExtension::StartIndicationConfirmationTimer(const RawAddress& bd_addr,
                                                      uint16_t cid) {
@@ -55,6 +55,9 @@ class EattChannel {
   alarm_t* ind_confirmation_timer_;
   /* GATT client command queue */
   std::deque<tGATT_CMD_Q> cl_cmd_q_;
+  /* Number of GATT client commands queued, and deepest queue seen */
+  uint32_t cl_cmd_count_;
+  size_t cl_cmd_q_max_depth_;
 
   EattChannel(RawAddress& bda, uint16_t cid, uint16_t tx_mtu, uint16_t rx_mtu)
       : bda_(bda),
@@ -64,7 +67,9 @@ class EattChannel {
         state_(EattChannelState::EATT_CHANNEL_PENDING),
         indicate_handle_(0),
         ind_ack_timer_(NULL),
-        ind_confirmation_timer_(NULL) {
+        ind_confirmation_timer_(NULL),
+        cl_cmd_count_(0),
+        cl_cmd_q_max_depth_(0) {
     cl_cmd_q_ = std::deque<tGATT_CMD_Q>();
   }
 
@@ -229,7 +234,8 @@ class EattExtension {
       const RawAddress& bd_addr);
 
   /**
-   * Get EATT channel available to send GATT request.
+   * Get EATT channel available to send GATT request. Of the opened channels
+   * with no client command queued, the one which served the fewest commands.
    *
    * @param bd_addr peer device address
    *
@@ -238,6 +244,17 @@ class EattExtension {
   virtual EattChannel* GetChannelAvailableForClientRequest(
       const RawAddress& bd_addr);
 
+  /**
+   * Get the opened EATT channel with the fewest client commands queued, to
+   * queue a GATT request on when no channel is available.
+   *
+   * @param bd_addr peer device address
+   *
+   * @return pointer to EATT channel.
+   */
+  virtual EattChannel* GetLeastLoadedChannelForClientRequest(
+      const RawAddress& bd_addr);
+
   /**
    * Start GATT indication timer per CID.
    *
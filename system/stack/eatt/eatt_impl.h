@@ -112,6 +112,11 @@ struct eatt_impl {
 
   void remove_channel_by_cid(eatt_device* eatt_dev, uint16_t lcid) {
     auto channel = eatt_dev->eatt_channels[lcid];
+    LOG_INFO(
+        "Channel 0x%04x for device %s queued %u client commands, at most %zu "
+        "at once",
+        lcid, channel->bda_.ToString().c_str(), channel->cl_cmd_count_,
+        channel->cl_cmd_q_max_depth_);
     if (!channel->cl_cmd_q_.empty()) {
       LOG_WARN("Channel %c, for device %s is not empty on disconnection.", lcid,
                channel->bda_.ToString().c_str());
@@ -687,14 +692,34 @@ struct eatt_impl {
     eatt_device* eatt_dev = find_device_by_address(bd_addr);
     if (!eatt_dev) return nullptr;
 
-    auto iter = find_if(
-        eatt_dev->eatt_channels.begin(), eatt_dev->eatt_channels.end(),
-        [](const std::pair<uint16_t, std::shared_ptr<EattChannel>>& el) {
-          return el.second->cl_cmd_q_.empty();
-        });
+    /* Spread the requests over the idle channels */
+    EattChannel* best = nullptr;
+    for (auto& el : eatt_dev->eatt_channels) {
+      EattChannel* channel = el.second.get();
+      if (channel->state_ != EattChannelState::EATT_CHANNEL_OPENED ||
+          !channel->cl_cmd_q_.empty())
+        continue;
+      if (!best || channel->cl_cmd_count_ < best->cl_cmd_count_)
+        best = channel;
+    }
 
-    return (iter == eatt_dev->eatt_channels.end()) ? nullptr
-                                                   : iter->second.get();
+    return best;
+  }
+
+  EattChannel* get_least_loaded_channel_for_client_request(
+      const RawAddress& bd_addr) {
+    eatt_device* eatt_dev = find_device_by_address(bd_addr);
+    if (!eatt_dev) return nullptr;
+
+    EattChannel* best = nullptr;
+    for (auto& el : eatt_dev->eatt_channels) {
+      EattChannel* channel = el.second.get();
+      if (channel->state_ != EattChannelState::EATT_CHANNEL_OPENED) continue;
+      if (!best || channel->cl_cmd_q_.size() < best->cl_cmd_q_.size())
+        best = channel;
+    }
+
+    return best;
   }
 
   void free_gatt_resources(const RawAddress& bd_addr) {
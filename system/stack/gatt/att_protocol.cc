@@ -606,5 +606,6 @@ tGATT_STATUS attp_send_cl_msg(tGATT_TCB& tcb, tGATT_CLCB* p_clcb,
     return GATT_NO_RESOURCES;
   }
 
+  gatt_record_first_operation(tcb, op_code);
   return attp_cl_send_cmd(tcb, p_clcb, op_code, p_cmd);
 }
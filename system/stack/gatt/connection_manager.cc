@@ -23,11 +23,16 @@
 #include <base/location.h>
 #include <base/logging.h>
 
+#include <algorithm>
+#include <cinttypes>
 #include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "bind_helpers.h"
+#include "common/time_util.h"
+#include "device/include/controller.h"
 #include "internal_include/bt_trace.h"
 #include "main/shim/dumpsys.h"
 #include "main/shim/le_scanning_manager.h"
@@ -42,6 +47,9 @@
 #include "types/raw_address.h"
 
 #define DIRECT_CONNECT_TIMEOUT (30 * 1000) /* 30 seconds */
+/* Devices waiting for room in the accept list replace the ones seen less
+ * recently, if they advertised within this time */
+#define ACCEPT_LIST_SIGHTING_TIMEOUT (10 * 1000) /* 10 seconds */
 
 constexpr char kBtmLogTag[] = "TA";
 
@@ -76,6 +84,9 @@ struct tAPPS_CONNECTING {
   std::set<tAPP_ID> doing_bg_conn;
   std::set<tAPP_ID> doing_targeted_announcements_conn;
   bool is_in_accept_list;
+  // Boot time of the last advertisement or connection seen from the device,
+  // or 0 if none was seen yet
+  uint64_t last_seen_ms;
 
   // Apps trying to do direct connection.
   std::map<tAPP_ID, unique_alarm_ptr> doing_direct_conn;
@@ -109,8 +120,163 @@ bool is_anyone_connecting(
           !it->second.doing_targeted_announcements_conn.empty());
 }
 
+/* The background connections share the accept list of the controller. When
+ * they do not all fit, the devices seen most recently are kept in the accept
+ * list, and the others wait in standby until they are seen advertising. */
+
+// Size of the controller accept list, or 0 if unknown
+size_t accept_list_budget() {
+  const controller_t* controller = controller_get_interface();
+  if (controller == nullptr || controller->get_ble_acceptlist_size == nullptr)
+    return 0;
+  return controller->get_ble_acceptlist_size();
+}
+
+size_t num_of_accept_list_entries() {
+  return std::count_if(
+      bgconn_dev.begin(), bgconn_dev.end(),
+      [](const auto& pair) { return pair.second.is_in_accept_list; });
+}
+
+bool is_accept_list_full() {
+  size_t budget = accept_list_budget();
+  return budget != 0 && num_of_accept_list_entries() >= budget;
+}
+
+// Background connection waiting for room in the accept list
+bool is_standby(const tAPPS_CONNECTING& apps) {
+  return !apps.is_in_accept_list && !apps.doing_bg_conn.empty() &&
+         apps.doing_targeted_announcements_conn.empty();
+}
+
+int num_of_standby_devices() {
+  return std::count_if(
+      bgconn_dev.begin(), bgconn_dev.end(),
+      [](const auto& pair) { return is_standby(pair.second); });
+}
+
+bool observing_standby_devices = false;
+bool accept_list_rotation_scheduled = false;
+
 }  // namespace
 
+static void target_announcement_observe_results_cb(tBTM_INQ_RESULTS* p_inq,
+                                                   const uint8_t* p_eir,
+                                                   uint16_t eir_len);
+
+/* Observes the advertisements while some devices are in standby. The
+ * observation is shared with the targeted announcements. */
+static void update_standby_observation() {
+  bool observe = num_of_standby_devices() > 0;
+  if (observe == observing_standby_devices) return;
+  observing_standby_devices = observe;
+  if (num_of_targeted_announcements_users() > 0) return;
+
+  LOG_DEBUG("observe %d", observe);
+  BTM_BleTargetAnnouncementObserve(observe,
+                                   target_announcement_observe_results_cb);
+}
+
+/* Moves the device of the accept list seen least recently, and not used by a
+ * direct connection, to standby. Returns false if there is none. */
+static bool accept_list_evict_least_recently_seen() {
+  auto victim = bgconn_dev.end();
+  for (auto it = bgconn_dev.begin(); it != bgconn_dev.end(); it++) {
+    if (!it->second.is_in_accept_list || !it->second.doing_direct_conn.empty())
+      continue;
+    if (victim == bgconn_dev.end() ||
+        it->second.last_seen_ms < victim->second.last_seen_ms) {
+      victim = it;
+    }
+  }
+  if (victim == bgconn_dev.end()) return false;
+
+  LOG_INFO("Moving device %s to standby", PRIVATE_ADDRESS(victim->first));
+  BTM_AcceptlistRemove(victim->first);
+  victim->second.is_in_accept_list = false;
+  update_standby_observation();
+  return true;
+}
+
+/* Fills the room left in the accept list with the standby devices seen most
+ * recently, and swaps the standby devices seen recently with the devices of
+ * the accept list seen less recently. All the changes are made at once, so
+ * that the controller is updated within a single pause of the connection
+ * attempts. */
+static void accept_list_rotate() {
+  accept_list_rotation_scheduled = false;
+
+  using iterator = std::map<RawAddress, tAPPS_CONNECTING>::iterator;
+  std::vector<iterator> standby;
+  std::vector<iterator> evictable;
+  for (auto it = bgconn_dev.begin(); it != bgconn_dev.end(); it++) {
+    if (is_standby(it->second)) {
+      standby.push_back(it);
+    } else if (it->second.is_in_accept_list &&
+               it->second.doing_direct_conn.empty()) {
+      evictable.push_back(it);
+    }
+  }
+  std::sort(standby.begin(), standby.end(), [](iterator a, iterator b) {
+    return a->second.last_seen_ms > b->second.last_seen_ms;
+  });
+  std::sort(evictable.begin(), evictable.end(), [](iterator a, iterator b) {
+    return a->second.last_seen_ms < b->second.last_seen_ms;
+  });
+
+  size_t budget = accept_list_budget();
+  size_t entries = num_of_accept_list_entries();
+  size_t room = (budget == 0) ? standby.size()
+                              : budget - std::min(budget, entries);
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
+  std::vector<iterator> to_remove;
+  std::vector<iterator> to_add;
+  for (iterator candidate : standby) {
+    if (room > 0) {
+      to_add.push_back(candidate);
+      room--;
+      continue;
+    }
+    if (to_remove.size() == evictable.size()) break;
+    iterator victim = evictable[to_remove.size()];
+    if (now_ms - candidate->second.last_seen_ms >
+            ACCEPT_LIST_SIGHTING_TIMEOUT ||
+        victim->second.last_seen_ms >= candidate->second.last_seen_ms) {
+      break;
+    }
+    to_remove.push_back(victim);
+    to_add.push_back(candidate);
+  }
+
+  for (iterator victim : to_remove) {
+    LOG_INFO("Moving device %s to standby", PRIVATE_ADDRESS(victim->first));
+    BTM_AcceptlistRemove(victim->first);
+    victim->second.is_in_accept_list = false;
+  }
+  for (iterator candidate : to_add) {
+    LOG_INFO("Moving device %s to accept list",
+             PRIVATE_ADDRESS(candidate->first));
+    if (!BTM_AcceptlistAdd(candidate->first)) {
+      LOG_WARN("Failed to add device %s to accept list",
+               PRIVATE_ADDRESS(candidate->first));
+      continue;
+    }
+    candidate->second.is_in_accept_list = true;
+  }
+  if (!to_add.empty()) {
+    BTM_LogHistory(kBtmLogTag, RawAddress::kEmpty, "Rotated accept list");
+  }
+  update_standby_observation();
+}
+
+/* Schedules the rotation of the accept list after the pending events, so that
+ * the changes caused by several events are batched */
+static void schedule_accept_list_rotation() {
+  if (accept_list_rotation_scheduled || num_of_standby_devices() == 0) return;
+  accept_list_rotation_scheduled = true;
+  do_in_main_thread(FROM_HERE, base::BindOnce(&accept_list_rotate));
+}
+
 /** background connection device from the list. Returns pointer to the device
  * record, or nullptr if not found */
 std::set<tAPP_ID> get_apps_connecting_to(const RawAddress& address) {
@@ -160,8 +326,15 @@ static void target_announcement_observe_results_cb(tBTM_INQ_RESULTS* p_inq,
                                                    uint16_t eir_len) {
   auto addr = p_inq->remote_bd_addr;
   auto it = bgconn_dev.find(addr);
-  if (it == bgconn_dev.end() ||
-      it->second.doing_targeted_announcements_conn.empty()) {
+  if (it == bgconn_dev.end()) return;
+
+  it->second.last_seen_ms = bluetooth::common::time_get_os_boottime_ms();
+  if (is_standby(it->second)) {
+    LOG_DEBUG("Standby device %s seen", addr.ToString().c_str());
+    schedule_accept_list_rotation();
+  }
+
+  if (it->second.doing_targeted_announcements_conn.empty()) {
     return;
   }
 
@@ -202,7 +375,7 @@ void target_announcements_filtering_set(bool enable) {
   /* Safe to call as if there is no support for filtering, this call will be
    * ignored. */
   bluetooth::shim::set_target_announcements_filter(enable);
-  BTM_BleTargetAnnouncementObserve(enable,
+  BTM_BleTargetAnnouncementObserve(enable || observing_standby_devices,
                                    target_announcement_observe_results_cb);
 }
 
@@ -251,6 +424,7 @@ bool background_connect_targeted_announcement_add(tAPP_ID app_id,
   if (disable_accept_list) {
     BTM_AcceptlistRemove(address);
     bgconn_dev[address].is_in_accept_list = false;
+    schedule_accept_list_rotation();
   }
 
   bgconn_dev[address].doing_targeted_announcements_conn.insert(app_id);
@@ -300,6 +474,12 @@ bool background_connect_add(uint8_t app_id, const RawAddress& address) {
     // the device is not in the acceptlist
     if (is_targeted_announcement_enabled) {
       LOG_DEBUG("Targeted announcement enabled, do not add to AcceptList");
+    } else if (is_accept_list_full()) {
+      LOG_INFO("Accept list full, device %s for app %d in standby",
+               address.ToString().c_str(), static_cast<int>(app_id));
+      bgconn_dev[address].doing_bg_conn.insert(app_id);
+      update_standby_observation();
+      return true;
     } else {
       if (!BTM_AcceptlistAdd(address)) {
         LOG_WARN("Failed to add device %s to accept list for app %d",
@@ -328,6 +508,8 @@ bool remove_unconditional(const RawAddress& address) {
 
   BTM_AcceptlistRemove(address);
   bgconn_dev.erase(it);
+  schedule_accept_list_rotation();
+  update_standby_observation();
   return true;
 }
 
@@ -371,21 +553,27 @@ bool background_connect_remove(uint8_t app_id, const RawAddress& address) {
         /* Keep using filtering */
         LOG_DEBUG(" Keep using target announcement filtering");
       } else if (!it->second.doing_bg_conn.empty()) {
-        if (!BTM_AcceptlistAdd(address)) {
+        if (is_accept_list_full()) {
+          LOG_INFO("Accept list full, device %s in standby",
+                   address.ToString().c_str());
+        } else if (!BTM_AcceptlistAdd(address)) {
           LOG_WARN("Could not re add device to accept list");
         } else {
           bgconn_dev[address].is_in_accept_list = true;
         }
+        update_standby_observation();
       }
     }
     return true;
   }
 
   bgconn_dev.erase(it);
+  update_standby_observation();
 
   // no more apps interested - remove from accept list and delete record
   if (accept_list_enabled) {
     BTM_AcceptlistRemove(address);
+    schedule_accept_list_rotation();
     return true;
   }
 
@@ -420,6 +608,8 @@ void on_app_deregistered(uint8_t app_id) {
     BTM_AcceptlistRemove(it->first);
     it = bgconn_dev.erase(it);
   }
+  schedule_accept_list_rotation();
+  update_standby_observation();
 }
 
 static void remove_all_clients_with_pending_connections(
@@ -436,6 +626,10 @@ static void remove_all_clients_with_pending_connections(
 void on_connection_complete(const RawAddress& address) {
   LOG_INFO("Le connection completed to device:%s", address.ToString().c_str());
 
+  auto it = bgconn_dev.find(address);
+  if (it != bgconn_dev.end()) {
+    it->second.last_seen_ms = bluetooth::common::time_get_os_boottime_ms();
+  }
   remove_all_clients_with_pending_connections(address);
 }
 
@@ -447,6 +641,7 @@ void on_connection_timed_out_from_shim(const RawAddress& address) {
  * to true, as there is no need to wipe controller acceptlist in this case. */
 void reset(bool after_reset) {
   bgconn_dev.clear();
+  observing_standby_devices = false;
   if (!after_reset) {
     target_announcements_filtering_set(false);
     BTM_AcceptlistClear();
@@ -493,6 +688,12 @@ bool direct_connect_add(uint8_t app_id, const RawAddress& address) {
   bool params_changed = BTM_SetLeConnectionModeToFast();
 
   if (!in_acceptlist) {
+    // direct connections take precedence over the background connections
+    if (is_accept_list_full() && !accept_list_evict_least_recently_seen()) {
+      LOG_WARN("Accept list full of direct connections");
+      if (params_changed) BTM_SetLeConnectionModeToSlow();
+      return false;
+    }
     if (!BTM_AcceptlistAdd(address)) {
       // if we can't add to acceptlist, turn parameters back to slow.
       LOG_WARN("Unable to add le device to acceptlist");
@@ -568,6 +769,7 @@ bool direct_connect_remove(uint8_t app_id, const RawAddress& address) {
   } else {
     it->second.is_in_accept_list = false;
   }
+  schedule_accept_list_rotation();
 
   return true;
 }
@@ -580,6 +782,10 @@ void dump(int fd) {
   }
 
   dprintf(fd, "\tdevices attempting connection: %d", (int)bgconn_dev.size());
+  dprintf(fd, "\n\taccept list entries: %zu of %zu, devices in standby: %d",
+          num_of_accept_list_entries(), accept_list_budget(),
+          num_of_standby_devices());
+  uint64_t now_ms = bluetooth::common::time_get_os_boottime_ms();
   for (const auto& entry : bgconn_dev) {
     dprintf(fd, "\n\t * %s: ", entry.first.ToString().c_str());
 
@@ -603,7 +809,13 @@ void dump(int fd) {
       }
     }
     dprintf(fd, "\n\t\t is in the allow list: %s",
-            entry.second.is_in_accept_list ? "true" : "false");
+            entry.second.is_in_accept_list
+                ? "true"
+                : (is_standby(entry.second) ? "false (standby)" : "false"));
+    if (entry.second.last_seen_ms != 0) {
+      dprintf(fd, "\n\t\t last seen: %" PRIu64 " ms ago",
+              now_ms - entry.second.last_seen_ms);
+    }
   }
   dprintf(fd, "\n");
 }
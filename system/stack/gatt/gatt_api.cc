@@ -27,7 +27,10 @@
 #include <base/strings/string_number_conversions.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "bt_target.h"
 #include "device/include/controller.h"
@@ -125,18 +128,22 @@ static bool is_gatt_attr_type(const Uuid& uuid) {
   return false;
 }
 
-/** Update the the last service info for the service list info */
+/** Update the the last service info and the indexes for the service list
+ * info */
 static void gatt_update_last_srv_info() {
   gatt_cb.last_service_handle = 0;
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    gatt_cb.last_service_handle = el.s_hdl;
+  if (!gatt_cb.srv_list_info->empty()) {
+    gatt_cb.last_service_handle = gatt_cb.srv_list_info->back().s_hdl;
   }
+
+  gatt_sr_update_srv_index();
 }
 
 /** Update database hash and client status */
 static void gatt_update_for_database_change() {
-  gatt_cb.database_hash = gatts_calculate_database_hash(gatt_cb.srv_list_info);
+  /* recalculated on the next read */
+  gatt_cb.database_hash_dirty = true;
 
   uint8_t i = 0;
   for (i = 0; i < GATT_MAX_PHY_CHANNEL; i++) {
@@ -299,6 +306,7 @@ tGATT_STATUS GATTS_AddService(tGATT_IF gatt_if, btgatt_db_element_t* service,
   tGATT_SRV_LIST_ELEM& elem = *rit;
   elem.gatt_if = gatt_if;
   elem.s_hdl = list.asgn_range.s_handle;
+  gatts_invalidate_service_info(elem.s_hdl);
   elem.e_hdl = list.asgn_range.e_handle;
   elem.p_db = &list.svc_db;
   elem.is_primary = list.asgn_range.is_primary;
@@ -419,6 +427,7 @@ void GATTS_StopService(uint16_t service_handle) {
     SDP_DeleteRecord(it->sdp_handle);
   }
 
+  gatts_invalidate_service_info(it->s_hdl);
   gatt_cb.srv_list_info->erase(it);
   gatt_update_last_srv_info();
 }
@@ -619,6 +628,108 @@ tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
   return cmd_sent;
 }
 
+/*******************************************************************************
+ *
+ * Function         GATTS_HandleValueNotificationMulti
+ *
+ * Description      This function sends the same handle value notification to
+ *                  several clients. The notification PDU is built once for
+ *                  all the links which carry the same amount of the value,
+ *                  and copied for each of these links.
+ *
+ * Parameter        conn_ids: connection identifiers.
+ *                  attr_handle: Attribute handle of this handle value
+ *                               notification.
+ *                  val_len: Length of the notified attribute value.
+ *                  p_val: Pointer to the notified attribute value data.
+ *
+ * Returns          The status of the notification on each connection, in the
+ *                  order of conn_ids.
+ *
+ ******************************************************************************/
+std::vector<tGATT_STATUS> GATTS_HandleValueNotificationMulti(
+    const std::vector<uint16_t>& conn_ids, uint16_t attr_handle,
+    uint16_t val_len, uint8_t* p_val) {
+  struct link {
+    tGATT_TCB* p_tcb;
+    uint16_t cid;
+    uint16_t pdu_size;
+  };
+  struct shared_pdu {
+    BT_HDR* p_buf;
+    tGATT_TCB* p_tcb; /* first link which uses the PDU */
+    size_t users;
+  };
+
+  std::vector<tGATT_STATUS> status(conn_ids.size(), GATT_SUCCESS);
+  std::vector<link> links(conn_ids.size());
+  /* the notification PDUs by size: the value is truncated to the MTU */
+  std::map<uint16_t, shared_pdu> pdus;
+
+  VLOG(1) << __func__ << ": attr_handle=" << loghex(attr_handle)
+          << ", connections=" << conn_ids.size();
+
+  if (!GATT_HANDLE_IS_VALID(attr_handle) || val_len > GATT_MAX_ATTR_LEN) {
+    status.assign(conn_ids.size(), GATT_ILLEGAL_PARAMETER);
+    return status;
+  }
+
+  for (size_t i = 0; i < conn_ids.size(); i++) {
+    tGATT_REG* p_reg = gatt_get_regcb(GATT_GET_GATT_IF(conn_ids[i]));
+    tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(GATT_GET_TCB_IDX(conn_ids[i]));
+    if ((p_reg == NULL) || (p_tcb == NULL)) {
+      LOG(ERROR) << __func__ << ": Unknown conn_id=" << loghex(conn_ids[i]);
+      status[i] = (tGATT_STATUS)GATT_INVALID_CONN_ID;
+      continue;
+    }
+
+    links[i].p_tcb = p_tcb;
+    links[i].cid = gatt_tcb_get_att_cid(*p_tcb, p_reg->eatt_support);
+    /* opcode and handle, followed by the value */
+    uint16_t payload_size =
+        gatt_tcb_get_payload_size_tx(*p_tcb, links[i].cid);
+    links[i].pdu_size = std::min<uint16_t>(payload_size, val_len + 3);
+    shared_pdu& pdu = pdus[links[i].pdu_size];
+    if (pdu.users++ == 0) pdu.p_tcb = p_tcb;
+  }
+
+  if (pdus.empty()) return status;
+
+  tGATT_SR_MSG gatt_sr_msg;
+  memset(&gatt_sr_msg, 0, sizeof(gatt_sr_msg));
+  gatt_sr_msg.attr_value.handle = attr_handle;
+  gatt_sr_msg.attr_value.len = val_len;
+  memcpy(gatt_sr_msg.attr_value.value, p_val, val_len);
+  gatt_sr_msg.attr_value.auth_req = GATT_AUTH_REQ_NONE;
+
+  for (auto& [pdu_size, pdu] : pdus) {
+    pdu.p_buf = attp_build_sr_msg(*pdu.p_tcb, GATT_HANDLE_VALUE_NOTIF,
+                                  &gatt_sr_msg, pdu_size);
+  }
+
+  for (size_t i = 0; i < conn_ids.size(); i++) {
+    if (status[i] != GATT_SUCCESS) continue;
+
+    shared_pdu& pdu = pdus[links[i].pdu_size];
+    if (pdu.p_buf == NULL) {
+      status[i] = GATT_NO_RESOURCES;
+      continue;
+    }
+
+    /* L2CAP takes ownership of the buffer: the last link gets the original */
+    BT_HDR* p_buf = pdu.p_buf;
+    if (--pdu.users > 0) {
+      size_t buf_size = sizeof(BT_HDR) + p_buf->offset + p_buf->len;
+      p_buf = (BT_HDR*)osi_malloc(buf_size);
+      memcpy(p_buf, pdu.p_buf, buf_size);
+    }
+
+    status[i] = attp_send_sr_msg(*links[i].p_tcb, links[i].cid, p_buf);
+  }
+
+  return status;
+}
+
 /*******************************************************************************
  *
  * Function         GATTS_SendRsp
@@ -793,6 +904,31 @@ tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
                         Uuid::kEmpty);
 }
 
+/*******************************************************************************
+ *
+ * Function         GATTC_GetBearerCount
+ *
+ * Description      This function is called to get the number of ATT bearers
+ *                  on which the client procedures of a connection can run in
+ *                  parallel.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          1 + the number of EATT bearers if the client registered
+ *                  with EATT support, 1 otherwise, 0 if conn_id is unknown.
+ *
+ ******************************************************************************/
+uint8_t GATTC_GetBearerCount(uint16_t conn_id) {
+  tGATT_IF gatt_if = GATT_GET_GATT_IF(conn_id);
+  uint8_t tcb_idx = GATT_GET_TCB_IDX(conn_id);
+  tGATT_TCB* p_tcb = gatt_get_tcb_by_idx(tcb_idx);
+  tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
+
+  if (p_tcb == NULL || p_reg == NULL) return 0;
+  if (!p_reg->eatt_support) return 1;
+  return 1 + p_tcb->eatt;
+}
+
 /*******************************************************************************
  *
  * Function         GATTC_Read
@@ -845,13 +981,15 @@ tGATT_STATUS GATTC_Read(uint16_t conn_id, tGATT_READ_TYPE type,
       p_clcb->e_handle = p_read->service.e_handle;
       p_clcb->uuid = p_read->service.uuid;
       break;
-    case GATT_READ_MULTIPLE: {
+    case GATT_READ_MULTIPLE:
+    case GATT_READ_MULTIPLE_VAR_LEN: {
       p_clcb->s_handle = 0;
       /* copy multiple handles in CB */
       tGATT_READ_MULTI* p_read_multi =
           (tGATT_READ_MULTI*)osi_malloc(sizeof(tGATT_READ_MULTI));
       p_clcb->p_attr_buf = (uint8_t*)p_read_multi;
       memcpy(p_read_multi, &p_read->read_multiple, sizeof(tGATT_READ_MULTI));
+      p_read_multi->variable_len = (type == GATT_READ_MULTIPLE_VAR_LEN);
       break;
     }
     case GATT_READ_BY_HANDLE:
@@ -1245,6 +1383,47 @@ void GATT_StartIf(tGATT_IF gatt_if) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         GATT_SetConnectionProfile
+ *
+ * Description      This function sets the LE connection parameter profile
+ *                  applied to the links used by an application, unless a
+ *                  connection request asks for another one.
+ *
+ * Parameters       gatt_if: applicaiton interface
+ *                  profile: connection parameter profile
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void GATT_SetConnectionProfile(tGATT_IF gatt_if, tGATT_CONN_PROFILE profile) {
+  tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
+  if (!p_reg) {
+    LOG_ERROR("Unable to find registered app gatt_if=%d", +gatt_if);
+    return;
+  }
+
+  LOG_INFO("gatt_if=%d profile=%s", +gatt_if,
+           gatt_conn_profile_text(profile).c_str());
+  p_reg->conn_profile = profile;
+}
+
+/*******************************************************************************
+ *
+ * Function         GATT_DumpConnectionStatistics
+ *
+ * Description      This function dumps the connection parameter profiles and
+ *                  the time from connection to first GATT operation of the
+ *                  recent LE connections.
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void GATT_DumpConnectionStatistics(int fd) { gatt_dump_connection_records(fd); }
+
 /*******************************************************************************
  *
  * Function         GATT_Connect
@@ -1272,6 +1451,15 @@ bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
 bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
                   tBTM_BLE_CONN_TYPE connection_type, tBT_TRANSPORT transport,
                   bool opportunistic, uint8_t initiating_phys) {
+  return GATT_Connect(gatt_if, bd_addr, connection_type, transport,
+                      opportunistic, initiating_phys,
+                      GATT_CONN_PROFILE_DEFAULT);
+}
+
+bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
+                  tBTM_BLE_CONN_TYPE connection_type, tBT_TRANSPORT transport,
+                  bool opportunistic, uint8_t initiating_phys,
+                  tGATT_CONN_PROFILE conn_profile) {
   /* Make sure app is registered */
   tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
   if (!p_reg) {
@@ -1292,6 +1480,13 @@ bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
     return true;
   }
 
+  if (conn_profile == GATT_CONN_PROFILE_DEFAULT) {
+    conn_profile = p_reg->conn_profile;
+  }
+  if (transport != BT_TRANSPORT_BR_EDR) {
+    gatt_request_conn_profile(bd_addr, conn_profile);
+  }
+
   bool ret;
   if (is_direct) {
     LOG_DEBUG("Starting direct connect gatt_if=%u address=%s", gatt_if,
@@ -1355,6 +1550,8 @@ bool GATT_CancelConnect(tGATT_IF gatt_if, const RawAddress& bd_addr,
   LOG(INFO) << __func__ << ": gatt_if:" << +gatt_if << ", address: " << bd_addr
             << ", direct:" << is_direct;
 
+  gatt_request_conn_profile(bd_addr, GATT_CONN_PROFILE_DEFAULT);
+
   tGATT_REG* p_reg;
   if (gatt_if) {
     p_reg = gatt_get_regcb(gatt_if);
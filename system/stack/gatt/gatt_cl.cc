@@ -26,9 +26,13 @@
 
 #include <string.h>
 
+#include <array>
+#include <string>
+
 #include "bt_target.h"
 #include "bt_utils.h"
 #include "gatt_int.h"
+#include "gd/metrics/latency_histogram.h"
 #include "l2c_api.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
@@ -1158,6 +1162,8 @@ bool gatt_cl_send_next_cmd_inq(tGATT_TCB& tcb) {
 
     cmd.to_send = false;
     cmd.p_cmd = NULL;
+    cmd.sent_time = std::chrono::steady_clock::now();
+    gatt_trace_request_sent(tcb, cmd.cid, cmd.op_code);
 
     if (cmd.op_code == GATT_CMD_WRITE || cmd.op_code == GATT_SIGN_CMD_WRITE) {
       /* dequeue the request if is write command or sign write */
@@ -1180,6 +1186,19 @@ bool gatt_cl_send_next_cmd_inq(tGATT_TCB& tcb) {
   return false;
 }
 
+/** Round trip time of the ATT requests, from sending the request to receiving
+ * its response, by request opcode */
+static bluetooth::metrics::LatencyHistogram& gatt_transaction_latency(
+    uint8_t op_code) {
+  static std::array<bluetooth::metrics::LatencyHistogram*, 256> histograms{};
+  if (histograms[op_code] == nullptr) {
+    histograms[op_code] = &bluetooth::metrics::LatencyHistogram::Get(
+        std::string("att_transaction.") +
+        reinterpret_cast<const char*>(gatt_dbg_op_name(op_code)));
+  }
+  return *histograms[op_code];
+}
+
 /** This function is called to handle the server response to client */
 void gatt_client_handle_server_rsp(tGATT_TCB& tcb, uint16_t cid,
                                    uint8_t op_code, uint16_t len,
@@ -1202,13 +1221,18 @@ void gatt_client_handle_server_rsp(tGATT_TCB& tcb, uint16_t cid,
   }
 
   uint8_t cmd_code = 0;
-  tGATT_CLCB* p_clcb = gatt_cmd_dequeue(tcb, cid, &cmd_code);
+  std::chrono::steady_clock::time_point sent_time;
+  tGATT_CLCB* p_clcb = gatt_cmd_dequeue(tcb, cid, &cmd_code, &sent_time);
   if (!p_clcb) {
     LOG_WARN("ATT - clcb already not in use, ignoring response");
     gatt_cl_send_next_cmd_inq(tcb);
     return;
   }
 
+  gatt_transaction_latency(cmd_code).Record(std::chrono::steady_clock::now() -
+                                            sent_time);
+  gatt_trace_response_received(tcb, cid, cmd_code);
+
   uint8_t rsp_code = gatt_cmd_to_rsp_code(cmd_code);
   if (!p_clcb) {
     LOG_WARN("ATT - clcb already not in use, ignoring response");
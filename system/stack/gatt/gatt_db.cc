@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "bt_target.h"
 #include "bt_trace.h"
 #include "bt_utils.h"
@@ -123,8 +125,8 @@ static tGATT_STATUS gatts_check_attr_readability(const tGATT_ATTR& attr,
     return GATT_INSUF_KEY_SIZE;
   }
 
-  if (read_long && attr.uuid.Is16Bit()) {
-    switch (attr.uuid.As16Bit()) {
+  if (read_long && attr.p_uuid->Is16Bit()) {
+    switch (attr.p_uuid->As16Bit()) {
       case GATT_UUID_PRI_SERVICE:
       case GATT_UUID_SEC_SERVICE:
       case GATT_UUID_CHAR_DECLARE:
@@ -168,7 +170,7 @@ static tGATT_STATUS read_attr_value(tGATT_ATTR& attr16, uint16_t offset,
                                     tGATT_SEC_FLAG sec_flag, uint8_t key_size) {
   uint8_t* p = *p_data;
 
-  VLOG(1) << __func__ << " uuid=" << attr16.uuid
+  VLOG(1) << __func__ << " uuid=" << *attr16.p_uuid
           << StringPrintf(" perm=0x%02x offset=%d read_long=%d",
                           attr16.permission, offset, read_long);
 
@@ -176,12 +178,12 @@ static tGATT_STATUS read_attr_value(tGATT_ATTR& attr16, uint16_t offset,
                                                      sec_flag, key_size);
   if (status != GATT_SUCCESS) return status;
 
-  if (!attr16.uuid.Is16Bit()) {
+  if (!attr16.p_uuid->Is16Bit()) {
     /* characteristic description or characteristic value */
     return GATT_PENDING;
   }
 
-  uint16_t uuid16 = attr16.uuid.As16Bit();
+  uint16_t uuid16 = attr16.p_uuid->As16Bit();
 
   if (uuid16 == GATT_UUID_PRI_SERVICE || uuid16 == GATT_UUID_SEC_SERVICE) {
     *p_len = gatt_build_uuid_to_stream_len(attr16.p_value->uuid);
@@ -194,7 +196,7 @@ static tGATT_STATUS read_attr_value(tGATT_ATTR& attr16, uint16_t offset,
 
   if (uuid16 == GATT_UUID_CHAR_DECLARE) {
     tGATT_ATTR* val_attr = &attr16 + 1;
-    uint8_t val_len = val_attr->uuid.GetShortestRepresentationSize();
+    uint8_t val_len = val_attr->p_uuid->GetShortestRepresentationSize();
     *p_len = (val_len == Uuid::kNumBytes16) ? 5 : 19;
 
     if (mtu < *p_len) return GATT_NO_RESOURCES;
@@ -203,10 +205,11 @@ static tGATT_STATUS read_attr_value(tGATT_ATTR& attr16, uint16_t offset,
     UINT16_TO_STREAM(p, attr16.p_value->char_decl.char_val_handle);
 
     if (val_len == Uuid::kNumBytes16) {
-      UINT16_TO_STREAM(p, val_attr->uuid.As16Bit());
+      UINT16_TO_STREAM(p, val_attr->p_uuid->As16Bit());
     } else {
       /* if 32 bit UUID, convert to 128 bit */
-      ARRAY_TO_STREAM(p, val_attr->uuid.To128BitLE(), (int)Uuid::kNumBytes128);
+      ARRAY_TO_STREAM(p, val_attr->p_uuid->To128BitLE(),
+                      (int)Uuid::kNumBytes128);
     }
     *p_data = p;
     return GATT_SUCCESS;
@@ -278,9 +281,12 @@ tGATT_STATUS gatts_db_read_attr_value_by_type(
   uint16_t len = 0;
   uint8_t* p = (uint8_t*)(p_rsp + 1) + p_rsp->len + L2CAP_MIN_OFFSET;
 
-  if (p_db) {
+  /* no attribute has this type unless it was interned */
+  const Uuid* p_type = gatt_find_interned_uuid(type);
+
+  if (p_db && p_type) {
     for (tGATT_ATTR& attr : p_db->attr_list) {
-      if (attr.handle >= s_handle && type == attr.uuid) {
+      if (attr.handle >= s_handle && attr.p_uuid == p_type) {
         if (*p_len <= 2) {
           status = GATT_NO_RESOURCES;
           break;
@@ -444,12 +450,14 @@ uint16_t gatts_add_char_descr(tGATT_SVC_DB& db, tGATT_PERM perm,
 tGATT_ATTR* find_attr_by_handle(tGATT_SVC_DB* p_db, uint16_t handle) {
   if (!p_db) return nullptr;
 
-  for (auto& attr : p_db->attr_list) {
-    if (attr.handle == handle) return &attr;
-    if (attr.handle > handle) return nullptr;
-  }
+  /* the attributes are allocated with increasing handles */
+  auto it = std::lower_bound(p_db->attr_list.begin(), p_db->attr_list.end(),
+                             handle, [](const tGATT_ATTR& attr, uint16_t hdl) {
+                               return attr.handle < hdl;
+                             });
+  if (it == p_db->attr_list.end() || it->handle != handle) return nullptr;
 
-  return nullptr;
+  return &*it;
 }
 
 /*******************************************************************************
@@ -617,10 +625,10 @@ tGATT_STATUS gatts_write_attr_perm_check(tGATT_SVC_DB* p_db, uint8_t op_code,
   {
     uint16_t max_size = 0;
 
-    if (p_attr->uuid.IsEmpty()) {
+    if (p_attr->p_uuid->IsEmpty()) {
       status = GATT_INVALID_PDU;
-    } else if (p_attr->uuid.Is16Bit()) {
-      switch (p_attr->uuid.As16Bit()) {
+    } else if (p_attr->p_uuid->Is16Bit()) {
+      switch (p_attr->p_uuid->As16Bit()) {
         case GATT_UUID_CHAR_PRESENT_FORMAT: /* should be readable only */
         case GATT_UUID_CHAR_EXT_PROP:       /* should be readable only */
         case GATT_UUID_CHAR_AGG_FORMAT:     /* should be readable only */
@@ -647,9 +655,9 @@ tGATT_STATUS gatts_write_attr_perm_check(tGATT_SVC_DB* p_db, uint8_t op_code,
     }
 
     /* these attribute does not allow write blob */
-    if (p_attr->uuid.Is16Bit() &&
-        (p_attr->uuid.As16Bit() == GATT_UUID_CHAR_CLIENT_CONFIG ||
-         p_attr->uuid.As16Bit() == GATT_UUID_CHAR_SRVR_CONFIG)) {
+    if (p_attr->p_uuid->Is16Bit() &&
+        (p_attr->p_uuid->As16Bit() == GATT_UUID_CHAR_CLIENT_CONFIG ||
+         p_attr->p_uuid->As16Bit() == GATT_UUID_CHAR_SRVR_CONFIG)) {
       if (op_code == GATT_REQ_PREPARE_WRITE && offset != 0) {
         /* does not allow write blob */
         status = GATT_NOT_LONG;
@@ -689,7 +697,7 @@ static tGATT_ATTR& allocate_attr_in_db(tGATT_SVC_DB& db, const Uuid& uuid,
   db.attr_list.emplace_back();
   tGATT_ATTR& attr = db.attr_list.back();
   attr.handle = db.next_handle++;
-  attr.uuid = uuid;
+  attr.p_uuid = gatt_intern_uuid(uuid);
   attr.permission = perm;
   return attr;
 }
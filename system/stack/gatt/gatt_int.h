@@ -23,9 +23,12 @@
 #include <base/strings/stringprintf.h>
 #include <string.h>
 
+#include <chrono>
 #include <deque>
 #include <list>
+#include <map>
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -84,6 +87,11 @@ inline std::string gatt_security_action_text(const tGATT_SEC_ACTION& action) {
 
 #define GATT_HDR_SIZE 3 /* 1B opcode + 2B handle */
 
+/* Limits of the values the server assembles from the Prepare Write requests
+ * of one connection: total length, and number of attribute values */
+#define GATT_PREP_WRITE_Q_MAX_LEN (8 * GATT_MAX_ATTR_LEN)
+#define GATT_PREP_WRITE_Q_MAX_VALUES 32
+
 /* wait for ATT cmd response timeout value */
 #define GATT_WAIT_FOR_RSP_TIMEOUT_MS (30 * 1000)
 #define GATT_WAIT_FOR_DISC_RSP_TIMEOUT_MS (5 * 1000)
@@ -169,13 +177,15 @@ typedef union {
 #define GATT_ATTR_UUID_TYPE_32 2
 typedef uint8_t tGATT_ATTR_UUID_TYPE;
 
-/* 16 bits UUID Attribute in server database
+/* Attribute in server database. The attribute types are interned with
+ * gatt_intern_uuid(): a database holds few distinct types, and the attributes
+ * of a type are compared by pointer when scanned.
 */
 typedef struct {
   std::unique_ptr<tGATT_ATTR_VALUE> p_value;
-  tGATT_PERM permission;
+  const bluetooth::Uuid* p_uuid;
   uint16_t handle;
-  bluetooth::Uuid uuid;
+  tGATT_PERM permission;
   bt_gatt_db_attribute_type_t gatt_type;
 } tGATT_ATTR;
 
@@ -200,6 +210,8 @@ typedef struct {
   uint8_t listening{0}; /* if adv for all has been enabled */
   bool eatt_support{false};
   std::string name;
+  /* LE connection parameter profile of the links used by the app */
+  tGATT_CONN_PROFILE conn_profile{GATT_CONN_PROFILE_DEFAULT};
 } tGATT_REG;
 
 struct tGATT_CLCB;
@@ -211,6 +223,8 @@ typedef struct {
   uint8_t op_code;
   bool to_send;
   uint16_t cid;
+  /* set once the command is sent to the server */
+  std::chrono::steady_clock::time_point sent_time;
 } tGATT_CMD_Q;
 
 #if GATT_MAX_SR_PROFILES <= 8
@@ -234,6 +248,15 @@ typedef struct {
   uint16_t cid;
 } tGATT_SR_CMD;
 
+/* Attribute value assembled from the consecutive Prepare Write requests of a
+ * long write, when gatt_cb.sr_assemble_prep_writes is set */
+typedef struct {
+  uint16_t handle;
+  uint16_t offset; /* offset of the first fragment */
+  bt_gatt_db_attribute_type_t gatt_type;
+  std::vector<uint8_t> value;
+} tGATT_PREP_WRITE;
+
 typedef enum : uint8_t {
   GATT_CH_CLOSE = 0,
   GATT_CH_CLOSING = 1,
@@ -257,6 +280,17 @@ inline std::string gatt_channel_state_text(const tGATT_CH_STATE& state) {
       return base::StringPrintf("UNKNOWN[%hhu]", state);
   }
 }
+
+inline std::string gatt_conn_profile_text(const tGATT_CONN_PROFILE& profile) {
+  switch (profile) {
+    CASE_RETURN_TEXT(GATT_CONN_PROFILE_DEFAULT);
+    CASE_RETURN_TEXT(GATT_CONN_PROFILE_LOW_POWER);
+    CASE_RETURN_TEXT(GATT_CONN_PROFILE_BULK);
+    CASE_RETURN_TEXT(GATT_CONN_PROFILE_LATENCY_CRITICAL);
+    default:
+      return base::StringPrintf("UNKNOWN[%hhu]", profile);
+  }
+}
 #undef CASE_RETURN_TEXT
 
 // If you change these values make sure to look at b/262219144 before.
@@ -297,6 +331,14 @@ typedef struct {
   bool is_primary;
 } tGATT_SRV_LIST_ELEM;
 
+/* Entry of the handle index of the started services: an attribute, and the
+ * service which owns it */
+typedef struct {
+  uint16_t handle;
+  tGATT_ATTR* p_attr;
+  std::list<tGATT_SRV_LIST_ELEM>::iterator srv;
+} tGATT_SRV_ATTR_REF;
+
 typedef struct {
   std::deque<tGATT_CLCB*> pending_enc_clcb; /* pending encryption channel q */
   tGATT_SEC_ACTION sec_act;
@@ -323,6 +365,8 @@ typedef struct {
   alarm_t* conf_timer; /* peer confirm to indication timer */
 
   uint8_t prep_cnt[GATT_MAX_APPS];
+  /* prepared writes held by the stack until Execute Write */
+  std::vector<tGATT_PREP_WRITE> prep_write_q;
   uint8_t ind_count;
 
   std::deque<tGATT_CMD_Q> cl_cmd_q;
@@ -336,6 +380,11 @@ typedef struct {
   /* Use for server. if false, should handle database out of sync. */
   bool is_robust_cache_change_aware;
 
+  /* Connection parameter profile applied to the LE link, and time of the link
+   * up until the first client operation, or 0 once it was sent */
+  tGATT_CONN_PROFILE conn_profile;
+  uint64_t connected_ms;
+
   bool in_use;
   uint8_t tcb_idx;
 } tGATT_TCB;
@@ -408,6 +457,14 @@ typedef struct {
   std::list<tGATT_HDL_LIST_ELEM>* hdl_list_info;
   std::list<tGATT_SRV_LIST_ELEM>* srv_list_info;
 
+  /* Indexes of srv_list_info, rebuilt by gatt_sr_update_srv_index() whenever
+   * a service is started or stopped: the services and their attributes sorted
+   * by handle, and the attribute handles of each attribute type */
+  std::vector<std::list<tGATT_SRV_LIST_ELEM>::iterator> srv_hdl_index;
+  std::vector<tGATT_SRV_ATTR_REF> srv_attr_index;
+  std::unordered_map<const bluetooth::Uuid*, std::vector<uint16_t>>
+      srv_type_index;
+
   fixed_queue_t* srv_chg_clt_q; /* service change clients queue */
   tGATT_REG cl_rcb[GATT_MAX_APPS];
 
@@ -441,12 +498,24 @@ typedef struct {
   uint8_t gatt_cl_supported_feat_mask;
 
   uint16_t handle_of_database_hash;
+  /* read with gatts_get_database_hash(), which recalculates it when
+   * database_hash_dirty is set */
   Octet16 database_hash;
+  bool database_hash_dirty;
+  /* database hash input serialized from each started service, by service
+   * start handle */
+  std::map<uint16_t, std::vector<uint8_t>> database_info;
 
   tGATT_APPL_INFO cb_info;
 
   tGATT_HDL_CFG hdl_cfg;
   bool over_br_enabled;
+  /* assemble the Prepare Write requests in the stack, and give each value to
+   * the application as one write on Execute Write */
+  bool sr_assemble_prep_writes;
+
+  /* connection parameter profiles asked by pending LE connection requests */
+  std::map<RawAddress, tGATT_CONN_PROFILE> conn_profile_requests;
 } tGATT_CB;
 
 #define GATT_SIZE_OF_SRV_CHG_HNDL_RANGE 4
@@ -467,6 +536,11 @@ extern bool gatt_connect(const RawAddress& rem_bda, tGATT_TCB* p_tcb,
                          tBT_TRANSPORT transport, uint8_t initiating_phys,
                          tGATT_IF gatt_if);
 extern void gatt_data_process(tGATT_TCB& p_tcb, uint16_t cid, BT_HDR* p_buf);
+extern void gatt_request_conn_profile(const RawAddress& bd_addr,
+                                      tGATT_CONN_PROFILE profile);
+extern void gatt_apply_conn_profile(tGATT_TCB& tcb);
+extern void gatt_record_first_operation(tGATT_TCB& tcb, uint8_t op_code);
+extern void gatt_dump_connection_records(int fd);
 extern void gatt_update_app_use_link_flag(tGATT_IF gatt_if, tGATT_TCB* p_tcb,
                                           bool is_add, bool check_acl_link);
 
@@ -511,6 +585,9 @@ extern uint32_t gatt_add_sdp_record(const bluetooth::Uuid& uuid,
 extern bool gatt_parse_uuid_from_cmd(bluetooth::Uuid* p_uuid, uint16_t len,
                                      uint8_t** p_data);
 extern uint8_t gatt_build_uuid_to_stream_len(const bluetooth::Uuid& uuid);
+extern const bluetooth::Uuid* gatt_intern_uuid(const bluetooth::Uuid& uuid);
+extern const bluetooth::Uuid* gatt_find_interned_uuid(
+    const bluetooth::Uuid& uuid);
 extern uint8_t gatt_build_uuid_to_stream(uint8_t** p_dst,
                                          const bluetooth::Uuid& uuid);
 extern void gatt_sr_get_sec_info(const RawAddress& rem_bda,
@@ -555,8 +632,14 @@ extern bool gatt_auto_connect_dev_remove(tGATT_IF gatt_if,
                                          const RawAddress& bd_addr);
 
 /* server function */
+extern void gatt_sr_update_srv_index(void);
 extern std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_i_rcb_by_handle(
     uint16_t handle);
+extern std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_first_srv(
+    uint16_t handle);
+extern const tGATT_SRV_ATTR_REF* gatt_sr_find_attr_by_handle(uint16_t handle);
+extern const std::vector<uint16_t>* gatt_sr_find_handles_by_type(
+    const bluetooth::Uuid& type);
 extern tGATT_STATUS gatt_sr_process_app_rsp(tGATT_TCB& tcb, tGATT_IF gatt_if,
                                             uint32_t trans_id, uint8_t op_code,
                                             tGATT_STATUS status,
@@ -631,10 +714,15 @@ extern void gatt_end_operation(tGATT_CLCB* p_clcb, tGATT_STATUS status,
 extern void gatt_act_discovery(tGATT_CLCB* p_clcb);
 extern void gatt_act_read(tGATT_CLCB* p_clcb, uint16_t offset);
 extern void gatt_act_write(tGATT_CLCB* p_clcb, uint8_t sec_act);
-extern tGATT_CLCB* gatt_cmd_dequeue(tGATT_TCB& tcb, uint16_t cid,
-                                    uint8_t* p_opcode);
+extern tGATT_CLCB* gatt_cmd_dequeue(
+    tGATT_TCB& tcb, uint16_t cid, uint8_t* p_opcode,
+    std::chrono::steady_clock::time_point* p_sent_time = nullptr);
 extern void gatt_cmd_enq(tGATT_TCB& tcb, tGATT_CLCB* p_clcb, bool to_send,
                          uint8_t op_code, BT_HDR* p_buf);
+extern void gatt_trace_request_sent(const tGATT_TCB& tcb, uint16_t cid,
+                                    uint8_t op_code);
+extern void gatt_trace_response_received(const tGATT_TCB& tcb, uint16_t cid,
+                                         uint8_t op_code);
 extern void gatt_client_handle_server_rsp(tGATT_TCB& tcb, uint16_t cid,
                                           uint8_t op_code, uint16_t len,
                                           uint8_t* p_data);
@@ -684,5 +772,7 @@ extern bluetooth::Uuid* gatts_get_service_uuid(tGATT_SVC_DB* p_db);
 /* gatt_sr_hash.cc */
 extern Octet16 gatts_calculate_database_hash(
     std::list<tGATT_SRV_LIST_ELEM>* lst_ptr);
+extern const Octet16& gatts_get_database_hash();
+extern void gatts_invalidate_service_info(uint16_t s_hdl);
 
 #endif
@@ -24,10 +24,16 @@
 
 #include <base/logging.h>
 
+#include <cinttypes>
+#include <deque>
+#include <mutex>
+
 #include "bt_target.h"
 #include "bt_utils.h"
 #include "btif/include/btif_storage.h"
+#include "common/time_util.h"
 #include "connection_manager.h"
+#include "device/include/controller.h"
 #include "device/include/interop.h"
 #include "gd/common/init_flags.h"
 #include "internal_include/stack_config.h"
@@ -90,6 +96,38 @@ static const tL2CAP_APPL_INFO dyn_info = {gatt_l2cif_connect_ind_cback,
 
 tGATT_CB gatt_cb;
 
+/* LE connection parameters of a connection parameter profile, in the units of
+ * the HCI LE Connection Update command */
+typedef struct {
+  uint16_t min_interval;
+  uint16_t max_interval;
+  uint16_t latency;
+  uint16_t timeout;
+  bool data_length_and_2m_phy;
+} tGATT_CONN_PROFILE_PARAMS;
+
+static const tGATT_CONN_PROFILE_PARAMS gatt_conn_profile_params[] = {
+    /* GATT_CONN_PROFILE_LOW_POWER: 100-125 ms */
+    {80, 100, 2, 500, false},
+    /* GATT_CONN_PROFILE_BULK: 15-30 ms */
+    {12, 24, 0, 500, true},
+    /* GATT_CONN_PROFILE_LATENCY_CRITICAL: 7.5-15 ms */
+    {6, 12, 0, 500, true},
+};
+
+#define GATT_CONN_RECORDS_MAX 16
+
+typedef struct {
+  RawAddress bda;
+  tGATT_CONN_PROFILE profile;
+  uint8_t op_code;
+  uint64_t first_op_ms;
+} tGATT_CONN_RECORD;
+
+/* most recent connections first, also read by dumpsys from another thread */
+static std::deque<tGATT_CONN_RECORD> gatt_conn_records;
+static std::mutex gatt_conn_records_mutex;
+
 /*******************************************************************************
  *
  * Function         gatt_init
@@ -125,6 +163,8 @@ void gatt_init(void) {
 
   gatt_cb.over_br_enabled =
       osi_property_get_bool("bluetooth.gatt.over_bredr.enabled", true);
+  gatt_cb.sr_assemble_prep_writes = osi_property_get_bool(
+      "bluetooth.gatt.server.assemble_prepared_writes.enabled", false);
   /* Now, register with L2CAP for ATT PSM over BR/EDR */
   if (gatt_cb.over_br_enabled &&
       !L2CA_Register2(BT_PSM_ATT, dyn_info, false /* enable_snoop */, nullptr,
@@ -188,6 +228,8 @@ void gatt_free(void) {
   gatt_cb.srv_list_info->clear();
   delete gatt_cb.srv_list_info;
   gatt_cb.srv_list_info = nullptr;
+  gatt_cb.database_info.clear();
+  gatt_sr_update_srv_index();
 
   EattExtension::GetInstance()->Stop();
 }
@@ -338,6 +380,122 @@ bool gatt_update_app_hold_link_status(tGATT_IF gatt_if, tGATT_TCB* p_tcb,
   return true;
 }
 
+/*******************************************************************************
+ *
+ * Function         gatt_request_conn_profile
+ *
+ * Description      Record the connection parameter profile asked by an LE
+ *                  connection request to a device, applied once the link is
+ *                  up. GATT_CONN_PROFILE_DEFAULT drops the pending requests.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_request_conn_profile(const RawAddress& bd_addr,
+                               tGATT_CONN_PROFILE profile) {
+  if (profile == GATT_CONN_PROFILE_DEFAULT) {
+    gatt_cb.conn_profile_requests.erase(bd_addr);
+    return;
+  }
+
+  tGATT_CONN_PROFILE& requested = gatt_cb.conn_profile_requests[bd_addr];
+  requested = std::max(requested, profile);
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_apply_conn_profile
+ *
+ * Description      Update the parameters of an LE link to the most demanding
+ *                  connection parameter profile of the pending connection
+ *                  requests and of the apps holding the link, and negotiate
+ *                  the Data Length Extension and the 2M PHY for the bulk and
+ *                  latency critical profiles.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_apply_conn_profile(tGATT_TCB& tcb) {
+  tGATT_CONN_PROFILE profile = GATT_CONN_PROFILE_DEFAULT;
+
+  auto it = gatt_cb.conn_profile_requests.find(tcb.peer_bda);
+  if (it != gatt_cb.conn_profile_requests.end()) {
+    profile = it->second;
+    gatt_cb.conn_profile_requests.erase(it);
+  }
+
+  for (tGATT_IF gatt_if : tcb.app_hold_link) {
+    tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
+    if (p_reg) profile = std::max(profile, p_reg->conn_profile);
+  }
+
+  /* the parameters are not relaxed while the link is up */
+  if (profile <= tcb.conn_profile) return;
+  tcb.conn_profile = profile;
+
+  const tGATT_CONN_PROFILE_PARAMS& params =
+      gatt_conn_profile_params[profile - GATT_CONN_PROFILE_LOW_POWER];
+  LOG_INFO("Applying %s to %s, interval %hu-%hu, latency %hu",
+           gatt_conn_profile_text(profile).c_str(),
+           PRIVATE_ADDRESS(tcb.peer_bda), params.min_interval,
+           params.max_interval, params.latency);
+
+  L2CA_UpdateBleConnParams(tcb.peer_bda, params.min_interval,
+                           params.max_interval, params.latency, params.timeout,
+                           0, 0);
+  if (!params.data_length_and_2m_phy) return;
+
+  if (controller_get_interface()->supports_ble_packet_extension()) {
+    BTM_SetBleDataLength(tcb.peer_bda, BTM_BLE_DATA_SIZE_MAX);
+  }
+  if (controller_get_interface()->supports_ble_2m_phy()) {
+    BTM_BleSetPhy(tcb.peer_bda, PHY_LE_2M, PHY_LE_2M, 0);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_record_first_operation
+ *
+ * Description      Record for dumpsys the time from the LE link up to the
+ *                  first client operation on it.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_record_first_operation(tGATT_TCB& tcb, uint8_t op_code) {
+  if (tcb.connected_ms == 0) return;
+
+  uint64_t first_op_ms =
+      bluetooth::common::time_get_os_boottime_ms() - tcb.connected_ms;
+  tcb.connected_ms = 0;
+  LOG_DEBUG("First operation 0x%02x to %s after %" PRIu64 " ms", op_code,
+            PRIVATE_ADDRESS(tcb.peer_bda), first_op_ms);
+
+  std::lock_guard<std::mutex> lock(gatt_conn_records_mutex);
+  gatt_conn_records.push_front(tGATT_CONN_RECORD{
+      .bda = tcb.peer_bda,
+      .profile = tcb.conn_profile,
+      .op_code = op_code,
+      .first_op_ms = first_op_ms,
+  });
+  if (gatt_conn_records.size() > GATT_CONN_RECORDS_MAX) {
+    gatt_conn_records.pop_back();
+  }
+}
+
+/** Dump the recent LE connections */
+void gatt_dump_connection_records(int fd) {
+  std::lock_guard<std::mutex> lock(gatt_conn_records_mutex);
+  dprintf(fd, "\nGATT LE connections (most recent first):\n");
+  for (const auto& record : gatt_conn_records) {
+    dprintf(fd, "  %s: %s, first operation 0x%02x after %" PRIu64 " ms\n",
+            record.bda.ToString().c_str(),
+            gatt_conn_profile_text(record.profile).c_str(), record.op_code,
+            record.first_op_ms);
+  }
+}
+
 /*******************************************************************************
  *
  * Function         gatt_update_app_use_link_flag
@@ -430,6 +588,9 @@ bool gatt_act_connect(tGATT_REG* p_reg, const RawAddress& bd_addr,
       return false;
     }
 
+    if (st == GATT_CH_OPEN && transport == BT_TRANSPORT_LE) {
+      gatt_apply_conn_profile(*p_tcb);
+    }
     return true;
   }
 
@@ -824,6 +985,11 @@ static void gatt_send_conn_cback(tGATT_TCB* p_tcb) {
   /* Remove the direct connection */
   connection_manager::on_connection_complete(p_tcb->peer_bda);
 
+  if (p_tcb->transport == BT_TRANSPORT_LE) {
+    p_tcb->connected_ms = bluetooth::common::time_get_os_boottime_ms();
+    gatt_apply_conn_profile(*p_tcb);
+  }
+
   if (p_tcb->att_lcid == L2CAP_ATT_CID) {
     if (!p_tcb->app_hold_link.empty()) {
       /* disable idle timeout if one or more clients are holding the link
@@ -23,6 +23,8 @@
  ******************************************************************************/
 #include <string.h>
 
+#include <algorithm>
+
 #include "bt_target.h"
 #include "gatt_int.h"
 #include "l2c_api.h"
@@ -332,6 +334,86 @@ tGATT_STATUS gatt_sr_process_app_rsp(tGATT_TCB& tcb, tGATT_IF gatt_if,
   return ret_code;
 }
 
+/*******************************************************************************
+ *
+ * Function         gatts_exec_assembled_writes
+ *
+ * Description      Execute or cancel the attribute values assembled by
+ *                  gatts_queue_prep_write(). Each value is given to the
+ *                  application of its service as one write request, and the
+ *                  Execute Write response is sent once all of them are
+ *                  answered.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void gatts_exec_assembled_writes(tGATT_TCB& tcb, uint16_t cid,
+                                        uint8_t op_code, uint8_t flag) {
+  std::vector<tGATT_PREP_WRITE> prep_writes;
+  prep_writes.swap(tcb.prep_write_q);
+
+  if (flag == GATT_PREP_WRITE_CANCEL) {
+    BT_HDR* p_msg =
+        attp_build_sr_msg(tcb, GATT_RSP_EXEC_WRITE, NULL,
+                          gatt_tcb_get_payload_size_tx(tcb, cid));
+    if (p_msg) attp_send_sr_msg(tcb, cid, p_msg);
+    return;
+  }
+
+  /* the values are only validated on execution, see Core Spec 3.4.6.1 */
+  for (const tGATT_PREP_WRITE& prep : prep_writes) {
+    tGATT_STATUS status = GATT_SUCCESS;
+    if (prep.offset > GATT_MAX_ATTR_LEN) {
+      status = GATT_INVALID_OFFSET;
+    } else if (prep.offset + prep.value.size() > GATT_MAX_ATTR_LEN) {
+      status = GATT_INVALID_ATTR_LEN;
+    } else if (gatt_sr_find_i_rcb_by_handle(prep.handle) ==
+               gatt_cb.srv_list_info->end()) {
+      status = GATT_INVALID_HANDLE;
+    }
+
+    if (status != GATT_SUCCESS) {
+      gatt_send_error_rsp(tcb, cid, status, op_code, prep.handle, false);
+      return;
+    }
+  }
+
+  uint32_t trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, 0);
+  if (trans_id == 0) {
+    LOG(ERROR) << __func__ << ": max pending command, send error";
+    gatt_send_error_rsp(tcb, cid, GATT_ERROR, op_code, 0, false);
+    return;
+  }
+
+  /* count every answer to wait for before sending the first request */
+  gatt_sr_reset_cback_cnt(tcb, cid);
+  for (const tGATT_PREP_WRITE& prep : prep_writes) {
+    tGATT_SRV_LIST_ELEM& el = *gatt_sr_find_i_rcb_by_handle(prep.handle);
+    gatt_sr_update_cback_cnt(tcb, cid, el.gatt_if, true, false);
+  }
+
+  for (const tGATT_PREP_WRITE& prep : prep_writes) {
+    tGATT_SRV_LIST_ELEM& el = *gatt_sr_find_i_rcb_by_handle(prep.handle);
+    tGATTS_DATA sr_data;
+    memset(&sr_data, 0, sizeof(tGATTS_DATA));
+
+    sr_data.write_req.handle = prep.handle;
+    sr_data.write_req.offset = prep.offset;
+    sr_data.write_req.len = prep.value.size();
+    if (!prep.value.empty()) {
+      memcpy(sr_data.write_req.value, prep.value.data(), prep.value.size());
+    }
+    sr_data.write_req.need_rsp = true;
+    sr_data.write_req.gatt_type = prep.gatt_type;
+
+    uint8_t req_type = (prep.gatt_type == BTGATT_DB_DESCRIPTOR)
+                           ? GATTS_REQ_TYPE_WRITE_DESCRIPTOR
+                           : GATTS_REQ_TYPE_WRITE_CHARACTERISTIC;
+    gatt_sr_send_req_callback(GATT_CREATE_CONN_ID(tcb.tcb_idx, el.gatt_if),
+                              trans_id, req_type, &sr_data);
+  }
+}
+
 /*******************************************************************************
  *
  * Function         gatt_process_exec_write_req
@@ -374,6 +456,11 @@ void gatt_process_exec_write_req(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code,
   /* mask the flag */
   flag &= GATT_PREP_WRITE_EXEC;
 
+  if (!tcb.prep_write_q.empty()) {
+    gatts_exec_assembled_writes(tcb, cid, op_code, flag);
+    return;
+  }
+
   /* no prep write is queued */
   if (!gatt_sr_is_prep_cnt_zero(tcb)) {
     trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, 0);
@@ -522,11 +609,10 @@ static tGATT_STATUS gatt_build_primary_service_rsp(
 
   uint16_t payload_size = gatt_tcb_get_payload_size_tx(tcb, cid);
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl < s_hdl || el.s_hdl > e_hdl ||
-        el.type != GATT_UUID_PRI_SERVICE) {
-      continue;
-    }
+  for (auto it = gatt_sr_find_first_srv(s_hdl);
+       it != gatt_cb.srv_list_info->end() && it->s_hdl <= e_hdl; it++) {
+    tGATT_SRV_LIST_ELEM& el = *it;
+    if (el.s_hdl < s_hdl || el.type != GATT_UUID_PRI_SERVICE) continue;
 
     Uuid* p_uuid = gatts_get_service_uuid(el.p_db);
     if (!p_uuid) continue;
@@ -592,12 +678,16 @@ static tGATT_STATUS gatt_build_find_info_rsp(tGATT_SRV_LIST_ELEM& el,
 
   uint8_t* p = (uint8_t*)(p_msg + 1) + L2CAP_MIN_OFFSET + p_msg->len;
 
-  for (auto& attr : el.p_db->attr_list) {
+  auto it = std::lower_bound(el.p_db->attr_list.begin(),
+                             el.p_db->attr_list.end(), s_hdl,
+                             [](const tGATT_ATTR& attr, uint16_t hdl) {
+                               return attr.handle < hdl;
+                             });
+  for (; it != el.p_db->attr_list.end(); it++) {
+    tGATT_ATTR& attr = *it;
     if (attr.handle > e_hdl) break;
 
-    if (attr.handle < s_hdl) continue;
-
-    uint8_t uuid_len = attr.uuid.GetShortestRepresentationSize();
+    uint8_t uuid_len = attr.p_uuid->GetShortestRepresentationSize();
     if (p_msg->offset == 0)
       p_msg->offset = (uuid_len == Uuid::kNumBytes16) ? GATT_INFO_TYPE_PAIR_16
                                                       : GATT_INFO_TYPE_PAIR_128;
@@ -607,15 +697,15 @@ static tGATT_STATUS gatt_build_find_info_rsp(tGATT_SRV_LIST_ELEM& el,
     if (p_msg->offset == GATT_INFO_TYPE_PAIR_16 &&
         uuid_len == Uuid::kNumBytes16) {
       UINT16_TO_STREAM(p, attr.handle);
-      UINT16_TO_STREAM(p, attr.uuid.As16Bit());
+      UINT16_TO_STREAM(p, attr.p_uuid->As16Bit());
     } else if (p_msg->offset == GATT_INFO_TYPE_PAIR_128 &&
                uuid_len == Uuid::kNumBytes128) {
       UINT16_TO_STREAM(p, attr.handle);
-      ARRAY_TO_STREAM(p, attr.uuid.To128BitLE(), (int)Uuid::kNumBytes128);
+      ARRAY_TO_STREAM(p, attr.p_uuid->To128BitLE(), (int)Uuid::kNumBytes128);
     } else if (p_msg->offset == GATT_INFO_TYPE_PAIR_128 &&
                uuid_len == Uuid::kNumBytes32) {
       UINT16_TO_STREAM(p, attr.handle);
-      ARRAY_TO_STREAM(p, attr.uuid.To128BitLE(), (int)Uuid::kNumBytes128);
+      ARRAY_TO_STREAM(p, attr.p_uuid->To128BitLE(), (int)Uuid::kNumBytes128);
     } else {
       LOG(ERROR) << "format mismatch";
       return GATT_NO_RESOURCES;
@@ -764,13 +854,12 @@ static void gatts_process_find_info(tGATT_TCB& tcb, uint16_t cid,
 
   buf_len = payload_size - 2;
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl <= e_hdl && el.e_hdl >= s_hdl) {
-      reason = gatt_build_find_info_rsp(el, p_msg, buf_len, s_hdl, e_hdl);
-      if (reason == GATT_NO_RESOURCES) {
-        reason = GATT_SUCCESS;
-        break;
-      }
+  for (auto it = gatt_sr_find_first_srv(s_hdl);
+       it != gatt_cb.srv_list_info->end() && it->s_hdl <= e_hdl; it++) {
+    reason = gatt_build_find_info_rsp(*it, p_msg, buf_len, s_hdl, e_hdl);
+    if (reason == GATT_NO_RESOURCES) {
+      reason = GATT_SUCCESS;
+      break;
     }
   }
 
@@ -896,11 +985,17 @@ static void gatts_process_read_by_type_req(tGATT_TCB& tcb, uint16_t cid,
   uint16_t buf_len = payload_size - 2;
 
   reason = GATT_NOT_FOUND;
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl <= e_hdl && el.e_hdl >= s_hdl) {
-      tGATT_SEC_FLAG sec_flag;
-      uint8_t key_size;
-      gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
+  /* only visit the services which hold attributes of the requested type */
+  const std::vector<uint16_t>* p_handles = gatt_sr_find_handles_by_type(uuid);
+  if (p_handles) {
+    tGATT_SEC_FLAG sec_flag;
+    uint8_t key_size;
+    gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
+
+    auto hdl_it = std::lower_bound(p_handles->begin(), p_handles->end(), s_hdl);
+    while (hdl_it != p_handles->end()) {
+      tGATT_SRV_LIST_ELEM& el = *gatt_sr_find_i_rcb_by_handle(*hdl_it);
+      if (el.s_hdl > e_hdl) break;
 
       tGATT_STATUS ret = gatts_db_read_attr_value_by_type(
           tcb, cid, el.p_db, op_code, p_msg, s_hdl, e_hdl, uuid, &buf_len,
@@ -914,6 +1009,9 @@ static void gatts_process_read_by_type_req(tGATT_TCB& tcb, uint16_t cid,
         s_hdl = err_hdl;
         break;
       }
+
+      /* skip to the attributes of the next service */
+      hdl_it = std::upper_bound(hdl_it, p_handles->end(), el.e_hdl);
     }
   }
   *p = (uint8_t)p_msg->offset;
@@ -933,6 +1031,66 @@ static void gatts_process_read_by_type_req(tGATT_TCB& tcb, uint16_t cid,
   attp_send_sr_msg(tcb, cid, p_msg);
 }
 
+/**
+ * This function is called to append a Prepare Write request to the value
+ * assembled for its attribute, when gatt_cb.sr_assemble_prep_writes is set. The
+ * request is answered by the stack, and the application only sees the whole
+ * value on Execute Write.
+ */
+static void gatts_queue_prep_write(tGATT_TCB& tcb, uint16_t cid,
+                                   uint16_t handle, uint16_t offset,
+                                   const uint8_t* p_value, uint16_t len,
+                                   bt_gatt_db_attribute_type_t gatt_type) {
+  if (gatt_type != BTGATT_DB_CHARACTERISTIC &&
+      gatt_type != BTGATT_DB_DESCRIPTOR) {
+    LOG(ERROR) << __func__
+               << ": Attempt to write attribute that's not tied with"
+                  " characteristic or descriptor value.";
+    gatt_send_error_rsp(tcb, cid, GATT_ERROR, GATT_REQ_PREPARE_WRITE, handle,
+                        false);
+    return;
+  }
+
+  /* the fragments of a long write follow each other */
+  bool is_next_fragment = false;
+  if (!tcb.prep_write_q.empty()) {
+    const tGATT_PREP_WRITE& last = tcb.prep_write_q.back();
+    is_next_fragment = last.handle == handle &&
+                       last.offset + last.value.size() == offset;
+  }
+
+  size_t queued_len = 0;
+  for (const tGATT_PREP_WRITE& prep : tcb.prep_write_q) {
+    queued_len += prep.value.size();
+  }
+  if (queued_len + len > GATT_PREP_WRITE_Q_MAX_LEN ||
+      (!is_next_fragment &&
+       tcb.prep_write_q.size() >= GATT_PREP_WRITE_Q_MAX_VALUES)) {
+    LOG(ERROR) << __func__ << ": prepare queue full, len=" << queued_len;
+    gatt_send_error_rsp(tcb, cid, GATT_PREPARE_Q_FULL, GATT_REQ_PREPARE_WRITE,
+                        handle, false);
+    return;
+  }
+
+  if (!is_next_fragment) {
+    tcb.prep_write_q.push_back({handle, offset, gatt_type, {}});
+  }
+  std::vector<uint8_t>& value = tcb.prep_write_q.back().value;
+  value.insert(value.end(), p_value, p_value + len);
+
+  /* the response echoes the request */
+  tGATT_SR_MSG msg;
+  memset(&msg, 0, sizeof(tGATT_SR_MSG));
+  msg.attr_value.handle = handle;
+  msg.attr_value.offset = offset;
+  msg.attr_value.len = len;
+  if (len != 0) memcpy(msg.attr_value.value, p_value, len);
+
+  BT_HDR* p_msg = attp_build_sr_msg(tcb, GATT_RSP_PREPARE_WRITE, &msg,
+                                    gatt_tcb_get_payload_size_tx(tcb, cid));
+  if (p_msg) attp_send_sr_msg(tcb, cid, p_msg);
+}
+
 /**
  * This function is called to process the write request from client.
  */
@@ -988,6 +1146,14 @@ static void gatts_process_write_req(tGATT_TCB& tcb, uint16_t cid,
                                        sr_data.write_req.offset, p, len,
                                        sec_flag, key_size);
 
+  if (status == GATT_SUCCESS && op_code == GATT_REQ_PREPARE_WRITE &&
+      gatt_cb.sr_assemble_prep_writes) {
+    gatts_queue_prep_write(tcb, cid, handle, sr_data.write_req.offset,
+                           sr_data.write_req.value, sr_data.write_req.len,
+                           gatt_type);
+    return;
+  }
+
   if (status == GATT_SUCCESS) {
     trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, handle);
     if (trans_id != 0) {
@@ -1114,34 +1280,28 @@ void gatts_process_attribute_req(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code,
   }
 #endif
 
-  if (GATT_HANDLE_IS_VALID(handle)) {
-    for (auto& el : *gatt_cb.srv_list_info) {
-      if (el.s_hdl <= handle && el.e_hdl >= handle) {
-        for (const auto& attr : el.p_db->attr_list) {
-          if (attr.handle == handle) {
-            switch (op_code) {
-              case GATT_REQ_READ: /* read char/char descriptor value */
-              case GATT_REQ_READ_BLOB:
-                gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
-                break;
-
-              case GATT_REQ_WRITE: /* write char/char descriptor value */
-              case GATT_CMD_WRITE:
-              case GATT_SIGN_CMD_WRITE:
-              case GATT_REQ_PREPARE_WRITE:
-                gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
-                                        attr.gatt_type);
-                break;
-              default:
-                break;
-            }
-            status = GATT_SUCCESS;
-            break;
-          }
-        }
+  const tGATT_SRV_ATTR_REF* p_ref = nullptr;
+  if (GATT_HANDLE_IS_VALID(handle)) p_ref = gatt_sr_find_attr_by_handle(handle);
+
+  if (p_ref) {
+    tGATT_SRV_LIST_ELEM& el = *p_ref->srv;
+    switch (op_code) {
+      case GATT_REQ_READ: /* read char/char descriptor value */
+      case GATT_REQ_READ_BLOB:
+        gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
+        break;
+
+      case GATT_REQ_WRITE: /* write char/char descriptor value */
+      case GATT_CMD_WRITE:
+      case GATT_SIGN_CMD_WRITE:
+      case GATT_REQ_PREPARE_WRITE:
+        gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
+                                p_ref->p_attr->gatt_type);
+        break;
+      default:
         break;
-      }
     }
+    status = GATT_SUCCESS;
   }
 
   if (status != GATT_SUCCESS && op_code != GATT_CMD_WRITE &&
@@ -1251,13 +1411,12 @@ void gatts_process_value_conf(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code) {
   if (continue_processing) {
     tGATTS_DATA gatts_data;
     gatts_data.handle = handle;
-    for (auto& el : *gatt_cb.srv_list_info) {
-      if (el.s_hdl <= handle && el.e_hdl >= handle) {
-        uint32_t trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, handle);
-        uint16_t conn_id = GATT_CREATE_CONN_ID(tcb.tcb_idx, el.gatt_if);
-        gatt_sr_send_req_callback(conn_id, trans_id, GATTS_REQ_TYPE_CONF,
-                                  &gatts_data);
-      }
+    auto it = gatt_sr_find_i_rcb_by_handle(handle);
+    if (it != gatt_cb.srv_list_info->end()) {
+      uint32_t trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, handle);
+      uint16_t conn_id = GATT_CREATE_CONN_ID(tcb.tcb_idx, it->gatt_if);
+      gatt_sr_send_req_callback(conn_id, trans_id, GATTS_REQ_TYPE_CONF,
+                                &gatts_data);
     }
   }
 }
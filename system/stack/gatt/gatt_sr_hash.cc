@@ -27,105 +27,140 @@
 
 using bluetooth::Uuid;
 
-static size_t calculate_database_info_size(std::list<tGATT_SRV_LIST_ELEM>* lst_ptr) {
+static size_t calculate_service_info_size(tGATT_SRV_LIST_ELEM* p_srv) {
   size_t len = 0;
-  auto srv_it = lst_ptr->begin();
-  for (; srv_it != lst_ptr->end(); srv_it++) {
-    auto attr_list = &srv_it->p_db->attr_list;
-    auto attr_it = attr_list->begin();
-    for (; attr_it != attr_list->end(); attr_it++) {
-      if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_PRI_SERVICE) ||
-          attr_it->uuid == Uuid::From16Bit(GATT_UUID_SEC_SERVICE)) {
-        // Service declaration (Handle + Type + Value)
-        len += 4 + gatt_build_uuid_to_stream_len(attr_it->p_value->uuid);
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_INCLUDE_SERVICE)){
-        // Included service declaration (Handle + Type + Value)
-        len += 8 + gatt_build_uuid_to_stream_len(attr_it->p_value->incl_handle.service_type);
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_DECLARE)) {
-        // Characteristic declaration (Handle + Type + Value)
-        len += 7 + gatt_build_uuid_to_stream_len((++attr_it)->uuid);
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_DESCRIPTION) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_CLIENT_CONFIG) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_SRVR_CONFIG) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_PRESENT_FORMAT) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_AGG_FORMAT)) {
-        // Descriptor (Handle + Type)
-        len += 4;
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_EXT_PROP)) {
-        // Descriptor for ext property (Handle + Type + Value)
-        len += 6;
-      }
+  auto attr_list = &p_srv->p_db->attr_list;
+  auto attr_it = attr_list->begin();
+  for (; attr_it != attr_list->end(); attr_it++) {
+    if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_PRI_SERVICE) ||
+        *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_SEC_SERVICE)) {
+      // Service declaration (Handle + Type + Value)
+      len += 4 + gatt_build_uuid_to_stream_len(attr_it->p_value->uuid);
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_INCLUDE_SERVICE)){
+      // Included service declaration (Handle + Type + Value)
+      len += 8 + gatt_build_uuid_to_stream_len(attr_it->p_value->incl_handle.service_type);
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_DECLARE)) {
+      // Characteristic declaration (Handle + Type + Value)
+      len += 7 + gatt_build_uuid_to_stream_len(*(++attr_it)->p_uuid);
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_DESCRIPTION) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_CLIENT_CONFIG) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_SRVR_CONFIG) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_PRESENT_FORMAT) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_AGG_FORMAT)) {
+      // Descriptor (Handle + Type)
+      len += 4;
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_EXT_PROP)) {
+      // Descriptor for ext property (Handle + Type + Value)
+      len += 6;
     }
   }
   return len;
 }
 
-static void fill_database_info(std::list<tGATT_SRV_LIST_ELEM>* lst_ptr, uint8_t* p_data) {
-  auto srv_it = lst_ptr->begin();
-  for (; srv_it != lst_ptr->end(); srv_it++) {
-    auto attr_list = &srv_it->p_db->attr_list;
-    auto attr_it = attr_list->begin();
-    for (; attr_it != attr_list->end(); attr_it++) {
-      if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_PRI_SERVICE) ||
-          attr_it->uuid == Uuid::From16Bit(GATT_UUID_SEC_SERVICE)) {
-        // Service declaration
-        UINT16_TO_STREAM(p_data, attr_it->handle);
-
-        if (srv_it->is_primary) {
-          UINT16_TO_STREAM(p_data, GATT_UUID_PRI_SERVICE);
-        } else {
-          UINT16_TO_STREAM(p_data, GATT_UUID_SEC_SERVICE);
-        }
-
-        gatt_build_uuid_to_stream(&p_data, attr_it->p_value->uuid);
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_INCLUDE_SERVICE)){
-        // Included service declaration
-        UINT16_TO_STREAM(p_data, attr_it->handle);
-        UINT16_TO_STREAM(p_data, GATT_UUID_INCLUDE_SERVICE);
-        UINT16_TO_STREAM(p_data, attr_it->p_value->incl_handle.s_handle);
-        UINT16_TO_STREAM(p_data, attr_it->p_value->incl_handle.e_handle);
-
-        gatt_build_uuid_to_stream(&p_data, attr_it->p_value->incl_handle.service_type);
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_DECLARE)) {
-        // Characteristic declaration
-        UINT16_TO_STREAM(p_data, attr_it->handle);
-        UINT16_TO_STREAM(p_data, GATT_UUID_CHAR_DECLARE);
-        UINT8_TO_STREAM(p_data, attr_it->p_value->char_decl.property);
-        UINT16_TO_STREAM(p_data, attr_it->p_value->char_decl.char_val_handle);
-
-        // Increment 1 to fetch characteristic uuid from value declaration attribute
-        gatt_build_uuid_to_stream(&p_data, (++attr_it)->uuid);
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_DESCRIPTION) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_CLIENT_CONFIG) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_SRVR_CONFIG) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_PRESENT_FORMAT) ||
-                 attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_AGG_FORMAT)) {
-        // Descriptor
-        UINT16_TO_STREAM(p_data, attr_it->handle);
-        UINT16_TO_STREAM(p_data, attr_it->uuid.As16Bit());
-      } else if (attr_it->uuid == Uuid::From16Bit(GATT_UUID_CHAR_EXT_PROP)) {
-        // Descriptor
-        UINT16_TO_STREAM(p_data, attr_it->handle);
-        UINT16_TO_STREAM(p_data, attr_it->uuid.As16Bit());
-        UINT16_TO_STREAM(p_data, attr_it->p_value
-                                     ? attr_it->p_value->char_ext_prop
-                                     : 0x0000);
+static void fill_service_info(tGATT_SRV_LIST_ELEM* p_srv, uint8_t* p_data) {
+  auto attr_list = &p_srv->p_db->attr_list;
+  auto attr_it = attr_list->begin();
+  for (; attr_it != attr_list->end(); attr_it++) {
+    if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_PRI_SERVICE) ||
+        *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_SEC_SERVICE)) {
+      // Service declaration
+      UINT16_TO_STREAM(p_data, attr_it->handle);
+
+      if (p_srv->is_primary) {
+        UINT16_TO_STREAM(p_data, GATT_UUID_PRI_SERVICE);
+      } else {
+        UINT16_TO_STREAM(p_data, GATT_UUID_SEC_SERVICE);
       }
+
+      gatt_build_uuid_to_stream(&p_data, attr_it->p_value->uuid);
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_INCLUDE_SERVICE)){
+      // Included service declaration
+      UINT16_TO_STREAM(p_data, attr_it->handle);
+      UINT16_TO_STREAM(p_data, GATT_UUID_INCLUDE_SERVICE);
+      UINT16_TO_STREAM(p_data, attr_it->p_value->incl_handle.s_handle);
+      UINT16_TO_STREAM(p_data, attr_it->p_value->incl_handle.e_handle);
+
+      gatt_build_uuid_to_stream(&p_data, attr_it->p_value->incl_handle.service_type);
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_DECLARE)) {
+      // Characteristic declaration
+      UINT16_TO_STREAM(p_data, attr_it->handle);
+      UINT16_TO_STREAM(p_data, GATT_UUID_CHAR_DECLARE);
+      UINT8_TO_STREAM(p_data, attr_it->p_value->char_decl.property);
+      UINT16_TO_STREAM(p_data, attr_it->p_value->char_decl.char_val_handle);
+
+      // Increment 1 to fetch characteristic uuid from value declaration attribute
+      gatt_build_uuid_to_stream(&p_data, *(++attr_it)->p_uuid);
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_DESCRIPTION) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_CLIENT_CONFIG) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_SRVR_CONFIG) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_PRESENT_FORMAT) ||
+               *attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_AGG_FORMAT)) {
+      // Descriptor
+      UINT16_TO_STREAM(p_data, attr_it->handle);
+      UINT16_TO_STREAM(p_data, attr_it->p_uuid->As16Bit());
+    } else if (*attr_it->p_uuid == Uuid::From16Bit(GATT_UUID_CHAR_EXT_PROP)) {
+      // Descriptor
+      UINT16_TO_STREAM(p_data, attr_it->handle);
+      UINT16_TO_STREAM(p_data, attr_it->p_uuid->As16Bit());
+      UINT16_TO_STREAM(p_data, attr_it->p_value
+                                   ? attr_it->p_value->char_ext_prop
+                                   : 0x0000);
     }
   }
 }
 
-Octet16 gatts_calculate_database_hash(std::list<tGATT_SRV_LIST_ELEM>* lst_ptr) {
-  int len = calculate_database_info_size(lst_ptr);
-
-  std::vector<uint8_t> serialized(len);
-  fill_database_info(lst_ptr, serialized.data());
+/* Serializes the database info of one service, the part of the database hash
+ * input which comes from this service */
+static std::vector<uint8_t> serialize_service_info(tGATT_SRV_LIST_ELEM& el) {
+  std::vector<uint8_t> info(calculate_service_info_size(&el));
+  fill_service_info(&el, info.data());
+  return info;
+}
 
+static Octet16 calculate_hash(std::vector<uint8_t>& serialized) {
+  /* The database hash key is all zeros, its key schedule is kept */
+  static const crypto_toolbox::AesCmacKey db_hash_key(Octet16{0});
   std::reverse(serialized.begin(), serialized.end());
-  Octet16 db_hash = crypto_toolbox::aes_cmac(Octet16{0}, serialized.data(),
-                                  serialized.size());
+  Octet16 db_hash = db_hash_key.Cmac(serialized.data(), serialized.size());
   LOG(INFO) << __func__ << ": hash="
            << base::HexEncode(db_hash.data(), db_hash.size());
 
   return db_hash;
 }
+
+Octet16 gatts_calculate_database_hash(std::list<tGATT_SRV_LIST_ELEM>* lst_ptr) {
+  std::vector<uint8_t> serialized;
+  for (tGATT_SRV_LIST_ELEM& el : *lst_ptr) {
+    std::vector<uint8_t> info = serialize_service_info(el);
+    serialized.insert(serialized.end(), info.begin(), info.end());
+  }
+
+  return calculate_hash(serialized);
+}
+
+/* Returns the hash of the started services. After a database change the hash
+ * is recalculated here, on its first read, and only the services started since
+ * the previous calculation are serialized again. */
+const Octet16& gatts_get_database_hash() {
+  if (!gatt_cb.database_hash_dirty) return gatt_cb.database_hash;
+
+  std::vector<uint8_t> serialized;
+  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
+    auto it = gatt_cb.database_info.find(el.s_hdl);
+    if (it == gatt_cb.database_info.end()) {
+      it = gatt_cb.database_info.emplace(el.s_hdl, serialize_service_info(el))
+               .first;
+    }
+    serialized.insert(serialized.end(), it->second.begin(), it->second.end());
+  }
+
+  gatt_cb.database_hash = calculate_hash(serialized);
+  gatt_cb.database_hash_dirty = false;
+  return gatt_cb.database_hash;
+}
+
+/* Drops the cached database info of the service starting at |s_hdl|, when
+ * it is started or stopped */
+void gatts_invalidate_service_info(uint16_t s_hdl) {
+  gatt_cb.database_info.erase(s_hdl);
+}
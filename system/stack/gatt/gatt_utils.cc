@@ -26,10 +26,13 @@
 #include <base/logging.h>
 #include <base/strings/stringprintf.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
+#include <unordered_set>
 
 #include "bt_target.h"  // Must be first to define build configuration
+#include "gd/os/trace.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "stack/btm/btm_sec.h"
@@ -460,6 +463,27 @@ tGATT_TCB* gatt_allocate_tcb_by_bdaddr(const RawAddress& bda,
   return NULL;
 }
 
+/* UUIDs of the attribute types of the server database. They are never
+ * removed: the set of types is bounded by what the applications register, and
+ * the nodes of an unordered_set keep their address. */
+static std::unordered_set<Uuid>& interned_uuids() {
+  static std::unordered_set<Uuid> uuids;
+  return uuids;
+}
+
+/** Returns the address of the interned copy of |uuid|, interning it first if
+ * needed. Equal UUIDs always share one copy. */
+const Uuid* gatt_intern_uuid(const Uuid& uuid) {
+  return &*interned_uuids().insert(uuid).first;
+}
+
+/** Returns the interned copy of |uuid|, or nullptr if no attribute of the
+ * database has ever had this type. */
+const Uuid* gatt_find_interned_uuid(const Uuid& uuid) {
+  auto it = interned_uuids().find(uuid);
+  return it == interned_uuids().end() ? nullptr : &*it;
+}
+
 /** gatt_build_uuid_to_stream will convert 32bit UUIDs to 128bit. This function
  * will return lenght required to build uuid, either |UUID:kNumBytes16| or
  * |UUID::kNumBytes128| */
@@ -735,25 +759,117 @@ void  gatt_ind_ack_timeout(void* data) {
    */
   attp_send_cl_confirmation_msg(*p_tcb, L2CAP_ATT_CID);
 }
+/*******************************************************************************
+ *
+ * Function         gatt_sr_update_srv_index
+ *
+ * Description      Rebuild the handle and type indexes of the started
+ *                  services, after a service is started or stopped.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_sr_update_srv_index(void) {
+  gatt_cb.srv_hdl_index.clear();
+  gatt_cb.srv_attr_index.clear();
+  gatt_cb.srv_type_index.clear();
+
+  if (!gatt_cb.srv_list_info) return;
+
+  /* srv_list_info is kept sorted by start handle */
+  for (auto it = gatt_cb.srv_list_info->begin();
+       it != gatt_cb.srv_list_info->end(); it++) {
+    gatt_cb.srv_hdl_index.push_back(it);
+    if (!it->p_db) continue;
+
+    for (tGATT_ATTR& attr : it->p_db->attr_list) {
+      gatt_cb.srv_attr_index.push_back({attr.handle, &attr, it});
+      gatt_cb.srv_type_index[attr.p_uuid].push_back(attr.handle);
+    }
+  }
+}
+
 /*******************************************************************************
  *
  * Description      Search for a service that owns a specific handle.
  *
- * Returns          GATT_MAX_SR_PROFILES if not found. Otherwise the index of
- *                  the service.
+ * Returns          srv_list_info end if not found. Otherwise the service.
  *
  ******************************************************************************/
 std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_i_rcb_by_handle(
     uint16_t handle) {
-  auto it = gatt_cb.srv_list_info->begin();
+  auto it = gatt_sr_find_first_srv(handle);
 
-  for (; it != gatt_cb.srv_list_info->end(); it++) {
-    if (it->s_hdl <= handle && it->e_hdl >= handle) {
-      return it;
-    }
-  }
+  if (it != gatt_cb.srv_list_info->end() && it->s_hdl <= handle) return it;
 
-  return it;
+  return gatt_cb.srv_list_info->end();
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_find_first_srv
+ *
+ * Description      Search for the first service which ends at or after a
+ *                  specific handle.
+ *
+ * Returns          srv_list_info end if not found. Otherwise the service.
+ *
+ ******************************************************************************/
+std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_first_srv(
+    uint16_t handle) {
+  auto it = std::lower_bound(
+      gatt_cb.srv_hdl_index.begin(), gatt_cb.srv_hdl_index.end(), handle,
+      [](const std::list<tGATT_SRV_LIST_ELEM>::iterator& srv, uint16_t hdl) {
+        return srv->e_hdl < hdl;
+      });
+
+  if (it == gatt_cb.srv_hdl_index.end()) return gatt_cb.srv_list_info->end();
+
+  return *it;
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_find_attr_by_handle
+ *
+ * Description      Search for the attribute of a started service with a
+ *                  specific handle.
+ *
+ * Returns          NULL if not found. Otherwise the attribute and its service.
+ *
+ ******************************************************************************/
+const tGATT_SRV_ATTR_REF* gatt_sr_find_attr_by_handle(uint16_t handle) {
+  auto it = std::lower_bound(
+      gatt_cb.srv_attr_index.begin(), gatt_cb.srv_attr_index.end(), handle,
+      [](const tGATT_SRV_ATTR_REF& ref, uint16_t hdl) {
+        return ref.handle < hdl;
+      });
+
+  if (it == gatt_cb.srv_attr_index.end() || it->handle != handle)
+    return nullptr;
+
+  return &*it;
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_find_handles_by_type
+ *
+ * Description      Search for the attributes of the started services with a
+ *                  specific type.
+ *
+ * Returns          NULL if not found. Otherwise the sorted attribute handles.
+ *
+ ******************************************************************************/
+const std::vector<uint16_t>* gatt_sr_find_handles_by_type(const Uuid& type) {
+  const Uuid* p_type = gatt_find_interned_uuid(type);
+  if (!p_type) return nullptr;
+
+  auto it = gatt_cb.srv_type_index.find(p_type);
+
+  if (it == gatt_cb.srv_type_index.end()) return nullptr;
+
+  return &it->second;
 }
 
 /*******************************************************************************
@@ -1084,6 +1200,16 @@ uint16_t gatt_tcb_get_att_cid(tGATT_TCB& tcb, bool eatt_support) {
     if (channel) {
       return channel->cid_;
     }
+
+    /* Every bearer is busy: queue behind the fewest commands, so that a slow
+     * request does not hold back all the others */
+    if (!tcb.cl_cmd_q.empty()) {
+      channel = EattExtension::GetInstance()
+                    ->GetLeastLoadedChannelForClientRequest(tcb.peer_bda);
+      if (channel && channel->cl_cmd_q_.size() < tcb.cl_cmd_q.size()) {
+        return channel->cid_;
+      }
+    }
   }
   return tcb.att_lcid;
 }
@@ -1482,6 +1608,35 @@ bool gatt_cancel_open(tGATT_IF gatt_if, const RawAddress& bda) {
   return true;
 }
 
+/* A bearer has a single request in flight, so the requests are told apart in
+ * the trace by their link and channel */
+static std::string gatt_request_trace_name(uint8_t op_code) {
+  return std::string("ATT ") +
+         reinterpret_cast<const char*>(gatt_dbg_op_name(op_code));
+}
+
+static int32_t gatt_request_trace_cookie(const tGATT_TCB& tcb, uint16_t cid) {
+  return (static_cast<int32_t>(tcb.tcb_idx) << 16) | cid;
+}
+
+/** Begin the trace span of an ATT request, which lasts until its response */
+void gatt_trace_request_sent(const tGATT_TCB& tcb, uint16_t cid,
+                             uint8_t op_code) {
+  /* Commands get no response */
+  if (op_code == GATT_CMD_WRITE || op_code == GATT_SIGN_CMD_WRITE) return;
+  if (!bluetooth::os::IsTracing()) return;
+  bluetooth::os::TraceAsyncBegin(gatt_request_trace_name(op_code),
+                                 gatt_request_trace_cookie(tcb, cid));
+}
+
+/** End the trace span of the ATT request |op_code| */
+void gatt_trace_response_received(const tGATT_TCB& tcb, uint16_t cid,
+                                  uint8_t op_code) {
+  if (!bluetooth::os::IsTracing()) return;
+  bluetooth::os::TraceAsyncEnd(gatt_request_trace_name(op_code),
+                               gatt_request_trace_cookie(tcb, cid));
+}
+
 /** Enqueue this command */
 void gatt_cmd_enq(tGATT_TCB& tcb, tGATT_CLCB* p_clcb, bool to_send,
                   uint8_t op_code, BT_HDR* p_buf) {
@@ -1491,6 +1646,10 @@ void gatt_cmd_enq(tGATT_TCB& tcb, tGATT_CLCB* p_clcb, bool to_send,
   cmd.p_cmd = p_buf;
   cmd.p_clcb = p_clcb;
   cmd.cid = p_clcb->cid;
+  if (!to_send) {
+    cmd.sent_time = std::chrono::steady_clock::now();
+    gatt_trace_request_sent(tcb, cmd.cid, op_code);
+  }
 
   if (p_clcb->cid == tcb.att_lcid) {
     tcb.cl_cmd_q.push_back(cmd);
@@ -1499,11 +1658,16 @@ void gatt_cmd_enq(tGATT_TCB& tcb, tGATT_CLCB* p_clcb, bool to_send,
         EattExtension::GetInstance()->FindEattChannelByCid(tcb.peer_bda, cmd.cid);
     CHECK(channel);
     channel->cl_cmd_q_.push_back(cmd);
+    channel->cl_cmd_count_++;
+    channel->cl_cmd_q_max_depth_ =
+        std::max(channel->cl_cmd_q_max_depth_, channel->cl_cmd_q_.size());
   }
 }
 
 /** dequeue the command in the client CCB command queue */
-tGATT_CLCB* gatt_cmd_dequeue(tGATT_TCB& tcb, uint16_t cid, uint8_t* p_op_code) {
+tGATT_CLCB* gatt_cmd_dequeue(
+    tGATT_TCB& tcb, uint16_t cid, uint8_t* p_op_code,
+    std::chrono::steady_clock::time_point* p_sent_time) {
   std::deque<tGATT_CMD_Q>* cl_cmd_q_p;
 
   if (cid == tcb.att_lcid) {
@@ -1520,6 +1684,7 @@ tGATT_CLCB* gatt_cmd_dequeue(tGATT_TCB& tcb, uint16_t cid, uint8_t* p_op_code) {
   tGATT_CMD_Q cmd = cl_cmd_q_p->front();
   tGATT_CLCB* p_clcb = cmd.p_clcb;
   *p_op_code = cmd.op_code;
+  if (p_sent_time) *p_sent_time = cmd.sent_time;
 
   /* Note: If GATT client deregistered while the ATT request was on the way to
    * peer, device p_clcb will be null.
@@ -110,7 +110,7 @@
 #define HCIC_PARAM_SIZE_SET_DEFAULT_PERIODIC_ADVERTISING_SYNC_TRANSFER_PARAMS 8
 
 void btsnd_hcic_ble_set_local_used_feat(uint8_t feat_set[8]) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SET_USED_FEAT_CMD;
@@ -123,7 +123,7 @@ void btsnd_hcic_ble_set_local_used_feat(uint8_t feat_set[8]) {
 }
 
 void btsnd_hcic_ble_set_random_addr(const RawAddress& random_bda) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_RANDOM_ADDR_CMD;
@@ -144,7 +144,7 @@ void btsnd_hcic_ble_write_adv_params(uint16_t adv_int_min, uint16_t adv_int_max,
                                      const RawAddress& direct_bda,
                                      uint8_t channel_map,
                                      uint8_t adv_filter_policy) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_WRITE_ADV_PARAMS;
@@ -165,7 +165,7 @@ void btsnd_hcic_ble_write_adv_params(uint16_t adv_int_min, uint16_t adv_int_max,
   btu_hcif_send_cmd(LOCAL_BR_EDR_CONTROLLER_ID, p);
 }
 void btsnd_hcic_ble_read_adv_chnl_tx_power(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_READ_CMD;
@@ -178,7 +178,7 @@ void btsnd_hcic_ble_read_adv_chnl_tx_power(void) {
 }
 
 void btsnd_hcic_ble_set_adv_data(uint8_t data_len, uint8_t* p_data) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_WRITE_ADV_DATA + 1;
@@ -200,7 +200,7 @@ void btsnd_hcic_ble_set_adv_data(uint8_t data_len, uint8_t* p_data) {
   btu_hcif_send_cmd(LOCAL_BR_EDR_CONTROLLER_ID, p);
 }
 void btsnd_hcic_ble_set_scan_rsp_data(uint8_t data_len, uint8_t* p_scan_rsp) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_WRITE_SCAN_RSP + 1;
@@ -224,7 +224,7 @@ void btsnd_hcic_ble_set_scan_rsp_data(uint8_t data_len, uint8_t* p_scan_rsp) {
 }
 
 void btsnd_hcic_ble_set_adv_enable(uint8_t adv_enable) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_ADV_ENABLE;
@@ -240,7 +240,7 @@ void btsnd_hcic_ble_set_adv_enable(uint8_t adv_enable) {
 void btsnd_hcic_ble_set_scan_params(uint8_t scan_type, uint16_t scan_int,
                                     uint16_t scan_win, uint8_t addr_type_own,
                                     uint8_t scan_filter_policy) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_WRITE_SCAN_PARAM;
@@ -259,7 +259,7 @@ void btsnd_hcic_ble_set_scan_params(uint8_t scan_type, uint16_t scan_int,
 }
 
 void btsnd_hcic_ble_set_scan_enable(uint8_t scan_enable, uint8_t duplicate) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_WRITE_SCAN_ENABLE;
@@ -283,7 +283,7 @@ void btsnd_hcic_ble_create_ll_conn(uint16_t scan_int, uint16_t scan_win,
                                    uint16_t conn_int_min, uint16_t conn_int_max,
                                    uint16_t conn_latency, uint16_t conn_timeout,
                                    uint16_t min_ce_len, uint16_t max_ce_len) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_CREATE_LL_CONN;
@@ -312,7 +312,7 @@ void btsnd_hcic_ble_create_ll_conn(uint16_t scan_int, uint16_t scan_win,
 }
 
 void btsnd_hcic_ble_create_conn_cancel(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_CREATE_CONN_CANCEL;
@@ -362,7 +362,7 @@ void btsnd_hcic_ble_upd_ll_conn_params(uint16_t handle, uint16_t conn_int_min,
                                        uint16_t conn_timeout,
                                        uint16_t min_ce_len,
                                        uint16_t max_ce_len) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_UPD_LL_CONN_PARAMS;
@@ -385,7 +385,7 @@ void btsnd_hcic_ble_upd_ll_conn_params(uint16_t handle, uint16_t conn_int_min,
 
 void btsnd_hcic_ble_set_host_chnl_class(
     uint8_t chnl_map[HCIC_BLE_CHNL_MAP_SIZE]) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SET_HOST_CHNL_CLASS;
@@ -400,7 +400,7 @@ void btsnd_hcic_ble_set_host_chnl_class(
 }
 
 void btsnd_hcic_ble_read_chnl_map(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_READ_CHNL_MAP;
@@ -415,7 +415,7 @@ void btsnd_hcic_ble_read_chnl_map(uint16_t handle) {
 }
 
 void btsnd_hcic_ble_read_remote_feat(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_READ_REMOTE_FEAT;
@@ -444,7 +444,7 @@ void btsnd_hcic_ble_rand(base::Callback<void(BT_OCTET8)> cb) {
 void btsnd_hcic_ble_start_enc(uint16_t handle,
                               uint8_t rand[HCIC_BLE_RAND_DI_SIZE],
                               uint16_t ediv, const Octet16& ltk) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_START_ENC;
@@ -462,7 +462,7 @@ void btsnd_hcic_ble_start_enc(uint16_t handle,
 }
 
 void btsnd_hcic_ble_ltk_req_reply(uint16_t handle, const Octet16& ltk) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_LTK_REQ_REPLY;
@@ -478,7 +478,7 @@ void btsnd_hcic_ble_ltk_req_reply(uint16_t handle, const Octet16& ltk) {
 }
 
 void btsnd_hcic_ble_ltk_req_neg_reply(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_LTK_REQ_NEG_REPLY;
@@ -493,7 +493,7 @@ void btsnd_hcic_ble_ltk_req_neg_reply(uint16_t handle) {
 }
 
 void btsnd_hcic_ble_receiver_test(uint8_t rx_freq) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM1;
@@ -509,7 +509,7 @@ void btsnd_hcic_ble_receiver_test(uint8_t rx_freq) {
 
 void btsnd_hcic_ble_transmitter_test(uint8_t tx_freq, uint8_t test_data_len,
                                      uint8_t payload) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM3;
@@ -526,7 +526,7 @@ void btsnd_hcic_ble_transmitter_test(uint8_t tx_freq, uint8_t test_data_len,
 }
 
 void btsnd_hcic_ble_test_end(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_READ_CMD;
@@ -539,7 +539,7 @@ void btsnd_hcic_ble_test_end(void) {
 }
 
 void btsnd_hcic_ble_read_host_supported(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_READ_CMD;
@@ -557,7 +557,7 @@ void btsnd_hcic_ble_rc_param_req_reply(uint16_t handle, uint16_t conn_int_min,
                                        uint16_t conn_timeout,
                                        uint16_t min_ce_len,
                                        uint16_t max_ce_len) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_RC_PARAM_REQ_REPLY;
@@ -578,7 +578,7 @@ void btsnd_hcic_ble_rc_param_req_reply(uint16_t handle, uint16_t conn_int_min,
 }
 
 void btsnd_hcic_ble_rc_param_req_neg_reply(uint16_t handle, uint8_t reason) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_RC_PARAM_REQ_NEG_REPLY;
@@ -595,7 +595,7 @@ void btsnd_hcic_ble_rc_param_req_neg_reply(uint16_t handle, uint8_t reason) {
 
 void btsnd_hcic_ble_read_resolvable_addr_peer(uint8_t addr_type_peer,
                                               const RawAddress& bda_peer) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_READ_RESOLVABLE_ADDR_PEER;
@@ -611,7 +611,7 @@ void btsnd_hcic_ble_read_resolvable_addr_peer(uint8_t addr_type_peer,
 
 void btsnd_hcic_ble_read_resolvable_addr_local(uint8_t addr_type_peer,
                                                const RawAddress& bda_peer) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_READ_RESOLVABLE_ADDR_LOCAL;
@@ -626,7 +626,7 @@ void btsnd_hcic_ble_read_resolvable_addr_local(uint8_t addr_type_peer,
 }
 
 void btsnd_hcic_ble_set_addr_resolution_enable(uint8_t addr_resolution_enable) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_SET_ADDR_RESOLUTION_ENABLE;
@@ -640,7 +640,7 @@ void btsnd_hcic_ble_set_addr_resolution_enable(uint8_t addr_resolution_enable) {
 }
 
 void btsnd_hcic_ble_set_rand_priv_addr_timeout(uint16_t rpa_timout) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_SET_RAND_PRIV_ADDR_TIMOUT;
@@ -655,7 +655,7 @@ void btsnd_hcic_ble_set_rand_priv_addr_timeout(uint16_t rpa_timout) {
 
 void btsnd_hcic_ble_set_data_length(uint16_t conn_handle, uint16_t tx_octets,
                                     uint16_t tx_time) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_SET_DATA_LENGTH;
@@ -673,7 +673,7 @@ void btsnd_hcic_ble_set_data_length(uint16_t conn_handle, uint16_t tx_octets,
 
 void btsnd_hcic_ble_enh_rx_test(uint8_t rx_chan, uint8_t phy,
                                 uint8_t mod_index) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_ENH_RX_TEST;
@@ -691,7 +691,7 @@ void btsnd_hcic_ble_enh_rx_test(uint8_t rx_chan, uint8_t phy,
 
 void btsnd_hcic_ble_enh_tx_test(uint8_t tx_chan, uint8_t data_len,
                                 uint8_t payload, uint8_t phy) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_BLE_ENH_TX_TEST;
@@ -711,7 +711,7 @@ void btsnd_hcic_ble_set_extended_scan_params(uint8_t own_address_type,
                                              uint8_t scanning_filter_policy,
                                              uint8_t scanning_phys,
                                              scanning_phy_cfg* phy_cfg) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   int phy_cnt =
@@ -741,7 +741,7 @@ void btsnd_hcic_ble_set_extended_scan_enable(uint8_t enable,
                                              uint8_t filter_duplicates,
                                              uint16_t duration,
                                              uint16_t period) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   const int param_len = 6;
@@ -765,7 +765,7 @@ void btsnd_hcic_ble_ext_create_conn(uint8_t init_filter_policy,
                                     const RawAddress& bda_peer,
                                     uint8_t initiating_phys,
                                     EXT_CONN_PHY_CFG* phy_cfg) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   int phy_cnt =
@@ -877,7 +877,7 @@ void btsnd_hcic_remove_cig(uint8_t cig_id,
 }
 
 void btsnd_hcic_accept_cis_req(uint16_t conn_handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   const int param_len = 2;
@@ -906,7 +906,7 @@ void btsnd_hcic_rej_cis_req(uint16_t conn_handle, uint8_t reason,
 }
 
 void btsnd_hcic_req_peer_sca(uint16_t conn_handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   const int param_len = 2;
@@ -926,7 +926,7 @@ void btsnd_hcic_create_big(uint8_t big_handle, uint8_t adv_handle,
                            uint8_t rtn, uint8_t phy, uint8_t packing,
                            uint8_t framing, uint8_t enc,
                            std::array<uint8_t, 16> bcst_code) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   const int param_len = 31;
@@ -955,7 +955,7 @@ void btsnd_hcic_create_big(uint8_t big_handle, uint8_t adv_handle,
 }
 
 void btsnd_hcic_term_big(uint8_t big_handle, uint8_t reason) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   const int param_len = 2;
@@ -975,7 +975,7 @@ void btsnd_hcic_big_create_sync(uint8_t big_handle, uint16_t sync_handle,
                                 uint8_t enc, std::array<uint8_t, 16> bcst_code,
                                 uint8_t mse, uint16_t big_sync_timeout,
                                 std::vector<uint8_t> bis) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
   uint8_t num_bis = bis.size();
 
@@ -1070,7 +1070,7 @@ void btsnd_hcic_ble_periodic_advertising_create_sync(
     uint8_t options, uint8_t adv_sid, uint8_t adv_addr_type,
     const RawAddress& adv_addr, uint16_t skip_num, uint16_t sync_timeout,
     uint8_t sync_cte_type) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len =
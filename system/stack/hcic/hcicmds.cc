@@ -483,7 +483,7 @@ void bte_main_hci_send(BT_HDR* p_msg, uint16_t event);
 
 static void btsnd_hcic_inquiry(const LAP inq_lap, uint8_t duration,
                                uint8_t response_cnt) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_INQUIRY;
@@ -500,7 +500,7 @@ static void btsnd_hcic_inquiry(const LAP inq_lap, uint8_t duration,
 }
 
 static void btsnd_hcic_inq_cancel(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_INQ_CANCEL;
@@ -514,7 +514,7 @@ static void btsnd_hcic_inq_cancel(void) {
 void btsnd_hcic_per_inq_mode(uint16_t max_period, uint16_t min_period,
                              const LAP inq_lap, uint8_t duration,
                              uint8_t response_cnt) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_PER_INQ_MODE;
@@ -533,7 +533,7 @@ void btsnd_hcic_per_inq_mode(uint16_t max_period, uint16_t min_period,
 }
 
 void btsnd_hcic_exit_per_inq(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_EXIT_PER_INQ;
@@ -547,7 +547,7 @@ void btsnd_hcic_exit_per_inq(void) {
 void btsnd_hcic_create_conn(const RawAddress& dest, uint16_t packet_types,
                             uint8_t page_scan_rep_mode, uint8_t page_scan_mode,
                             uint16_t clock_offset, uint8_t allow_switch) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CREATE_CONN;
@@ -565,7 +565,7 @@ void btsnd_hcic_create_conn(const RawAddress& dest, uint16_t packet_types,
 }
 
 static void btsnd_hcic_disconnect(uint16_t handle, uint8_t reason) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_DISCONNECT;
@@ -580,7 +580,7 @@ static void btsnd_hcic_disconnect(uint16_t handle, uint8_t reason) {
 }
 
 void btsnd_hcic_add_SCO_conn(uint16_t handle, uint16_t packet_types) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_ADD_SCO_CONN;
@@ -596,7 +596,7 @@ void btsnd_hcic_add_SCO_conn(uint16_t handle, uint16_t packet_types) {
 }
 
 void btsnd_hcic_create_conn_cancel(const RawAddress& dest) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CREATE_CONN_CANCEL;
@@ -611,7 +611,7 @@ void btsnd_hcic_create_conn_cancel(const RawAddress& dest) {
 }
 
 void btsnd_hcic_accept_conn(const RawAddress& dest, uint8_t role) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_ACCEPT_CONN;
@@ -626,7 +626,7 @@ void btsnd_hcic_accept_conn(const RawAddress& dest, uint8_t role) {
 }
 
 void btsnd_hcic_reject_conn(const RawAddress& dest, uint8_t reason) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_REJECT_CONN;
@@ -643,7 +643,7 @@ void btsnd_hcic_reject_conn(const RawAddress& dest, uint8_t reason) {
 
 void btsnd_hcic_link_key_req_reply(const RawAddress& bd_addr,
                                    const LinkKey& link_key) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_LINK_KEY_REQ_REPLY;
@@ -659,7 +659,7 @@ void btsnd_hcic_link_key_req_reply(const RawAddress& bd_addr,
 }
 
 void btsnd_hcic_link_key_neg_reply(const RawAddress& bd_addr) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_LINK_KEY_NEG_REPLY;
@@ -675,7 +675,7 @@ void btsnd_hcic_link_key_neg_reply(const RawAddress& bd_addr) {
 
 void btsnd_hcic_pin_code_req_reply(const RawAddress& bd_addr,
                                    uint8_t pin_code_len, PIN_CODE pin_code) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
   int i;
 
@@ -696,7 +696,7 @@ void btsnd_hcic_pin_code_req_reply(const RawAddress& bd_addr,
 }
 
 void btsnd_hcic_pin_code_neg_reply(const RawAddress& bd_addr) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_PIN_CODE_NEG_REPLY;
@@ -711,7 +711,7 @@ void btsnd_hcic_pin_code_neg_reply(const RawAddress& bd_addr) {
 }
 
 void btsnd_hcic_change_conn_type(uint16_t handle, uint16_t packet_types) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CHANGE_CONN_TYPE;
@@ -727,7 +727,7 @@ void btsnd_hcic_change_conn_type(uint16_t handle, uint16_t packet_types) {
 }
 
 void btsnd_hcic_auth_request(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -742,7 +742,7 @@ void btsnd_hcic_auth_request(uint16_t handle) {
 }
 
 void btsnd_hcic_set_conn_encrypt(uint16_t handle, bool enable) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SET_CONN_ENCRYPT;
@@ -760,7 +760,7 @@ void btsnd_hcic_set_conn_encrypt(uint16_t handle, bool enable) {
 void btsnd_hcic_rmt_name_req(const RawAddress& bd_addr,
                              uint8_t page_scan_rep_mode, uint8_t page_scan_mode,
                              uint16_t clock_offset) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_RMT_NAME_REQ;
@@ -778,7 +778,7 @@ void btsnd_hcic_rmt_name_req(const RawAddress& bd_addr,
 }
 
 void btsnd_hcic_rmt_name_req_cancel(const RawAddress& bd_addr) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_RMT_NAME_REQ_CANCEL;
@@ -793,7 +793,7 @@ void btsnd_hcic_rmt_name_req_cancel(const RawAddress& bd_addr) {
 }
 
 void btsnd_hcic_rmt_features_req(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -808,7 +808,7 @@ void btsnd_hcic_rmt_features_req(uint16_t handle) {
 }
 
 void btsnd_hcic_rmt_ext_features(uint16_t handle, uint8_t page_num) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_RMT_EXT_FEATURES;
@@ -824,7 +824,7 @@ void btsnd_hcic_rmt_ext_features(uint16_t handle, uint8_t page_num) {
 }
 
 void btsnd_hcic_rmt_ver_req(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -839,7 +839,7 @@ void btsnd_hcic_rmt_ver_req(uint16_t handle) {
 }
 
 void btsnd_hcic_read_rmt_clk_offset(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -854,7 +854,7 @@ void btsnd_hcic_read_rmt_clk_offset(uint16_t handle) {
 }
 
 void btsnd_hcic_read_lmp_handle(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -872,7 +872,7 @@ void btsnd_hcic_setup_esco_conn(uint16_t handle, uint32_t transmit_bandwidth,
                                 uint32_t receive_bandwidth,
                                 uint16_t max_latency, uint16_t voice,
                                 uint8_t retrans_effort, uint16_t packet_types) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SETUP_ESCO;
@@ -898,7 +898,7 @@ void btsnd_hcic_accept_esco_conn(const RawAddress& bd_addr,
                                  uint16_t max_latency, uint16_t content_fmt,
                                  uint8_t retrans_effort,
                                  uint16_t packet_types) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_ACCEPT_ESCO;
@@ -919,7 +919,7 @@ void btsnd_hcic_accept_esco_conn(const RawAddress& bd_addr,
 }
 
 void btsnd_hcic_reject_esco_conn(const RawAddress& bd_addr, uint8_t reason) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_REJECT_ESCO;
@@ -936,7 +936,7 @@ void btsnd_hcic_reject_esco_conn(const RawAddress& bd_addr, uint8_t reason) {
 
 void btsnd_hcic_hold_mode(uint16_t handle, uint16_t max_hold_period,
                           uint16_t min_hold_period) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_HOLD_MODE;
@@ -955,7 +955,7 @@ void btsnd_hcic_hold_mode(uint16_t handle, uint16_t max_hold_period,
 void btsnd_hcic_sniff_mode(uint16_t handle, uint16_t max_sniff_period,
                            uint16_t min_sniff_period, uint16_t sniff_attempt,
                            uint16_t sniff_timeout) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SNIFF_MODE;
@@ -974,7 +974,7 @@ void btsnd_hcic_sniff_mode(uint16_t handle, uint16_t max_sniff_period,
 }
 
 void btsnd_hcic_exit_sniff_mode(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -990,7 +990,7 @@ void btsnd_hcic_exit_sniff_mode(uint16_t handle) {
 
 void btsnd_hcic_park_mode(uint16_t handle, uint16_t beacon_max_interval,
                           uint16_t beacon_min_interval) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_PARK_MODE;
@@ -1007,7 +1007,7 @@ void btsnd_hcic_park_mode(uint16_t handle, uint16_t beacon_max_interval,
 }
 
 void btsnd_hcic_exit_park_mode(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -1024,7 +1024,7 @@ void btsnd_hcic_exit_park_mode(uint16_t handle) {
 void btsnd_hcic_qos_setup(uint16_t handle, uint8_t flags, uint8_t service_type,
                           uint32_t token_rate, uint32_t peak, uint32_t latency,
                           uint32_t delay_var) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_QOS_SETUP;
@@ -1045,7 +1045,7 @@ void btsnd_hcic_qos_setup(uint16_t handle, uint8_t flags, uint8_t service_type,
 }
 
 static void btsnd_hcic_switch_role(const RawAddress& bd_addr, uint8_t role) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SWITCH_ROLE;
@@ -1061,7 +1061,7 @@ static void btsnd_hcic_switch_role(const RawAddress& bd_addr, uint8_t role) {
 }
 
 void btsnd_hcic_write_policy_set(uint16_t handle, uint16_t settings) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_POLICY_SET;
@@ -1076,7 +1076,7 @@ void btsnd_hcic_write_policy_set(uint16_t handle, uint16_t settings) {
 }
 
 void btsnd_hcic_write_def_policy_set(uint16_t settings) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_DEF_POLICY_SET;
@@ -1091,7 +1091,7 @@ void btsnd_hcic_write_def_policy_set(uint16_t settings) {
 
 void btsnd_hcic_set_event_filter(uint8_t filt_type, uint8_t filt_cond_type,
                                  uint8_t* filt_cond, uint8_t filt_cond_len) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->offset = 0;
@@ -1131,7 +1131,7 @@ void btsnd_hcic_set_event_filter(uint8_t filt_type, uint8_t filt_cond_type,
 }
 
 void btsnd_hcic_write_pin_type(uint8_t type) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM1;
@@ -1147,7 +1147,7 @@ void btsnd_hcic_write_pin_type(uint8_t type) {
 
 void btsnd_hcic_delete_stored_key(const RawAddress& bd_addr,
                                   bool delete_all_flag) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_DELETE_STORED_KEY;
@@ -1163,7 +1163,7 @@ void btsnd_hcic_delete_stored_key(const RawAddress& bd_addr,
 }
 
 void btsnd_hcic_change_name(BD_NAME name) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
   uint16_t len = strlen((char*)name) + 1;
 
@@ -1183,7 +1183,7 @@ void btsnd_hcic_change_name(BD_NAME name) {
 }
 
 void btsnd_hcic_read_name(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_READ_CMD;
@@ -1196,7 +1196,7 @@ void btsnd_hcic_read_name(void) {
 }
 
 void btsnd_hcic_write_page_tout(uint16_t timeout) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM2;
@@ -1211,7 +1211,7 @@ void btsnd_hcic_write_page_tout(uint16_t timeout) {
 }
 
 void btsnd_hcic_write_scan_enable(uint8_t flag) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM1;
@@ -1226,7 +1226,7 @@ void btsnd_hcic_write_scan_enable(uint8_t flag) {
 }
 
 void btsnd_hcic_write_pagescan_cfg(uint16_t interval, uint16_t window) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PAGESCAN_CFG;
@@ -1242,7 +1242,7 @@ void btsnd_hcic_write_pagescan_cfg(uint16_t interval, uint16_t window) {
 }
 
 void btsnd_hcic_write_inqscan_cfg(uint16_t interval, uint16_t window) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_INQSCAN_CFG;
@@ -1258,7 +1258,7 @@ void btsnd_hcic_write_inqscan_cfg(uint16_t interval, uint16_t window) {
 }
 
 void btsnd_hcic_write_auth_enable(uint8_t flag) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM1;
@@ -1273,7 +1273,7 @@ void btsnd_hcic_write_auth_enable(uint8_t flag) {
 }
 
 void btsnd_hcic_write_dev_class(DEV_CLASS dev_class) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM3;
@@ -1288,7 +1288,7 @@ void btsnd_hcic_write_dev_class(DEV_CLASS dev_class) {
 }
 
 void btsnd_hcic_write_voice_settings(uint16_t flags) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM2;
@@ -1303,7 +1303,7 @@ void btsnd_hcic_write_voice_settings(uint16_t flags) {
 }
 
 void btsnd_hcic_write_auto_flush_tout(uint16_t handle, uint16_t tout) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_AUTOMATIC_FLUSH_TIMEOUT;
@@ -1319,7 +1319,7 @@ void btsnd_hcic_write_auto_flush_tout(uint16_t handle, uint16_t tout) {
 }
 
 void btsnd_hcic_read_tx_power(uint16_t handle, uint8_t type) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_READ_TX_POWER;
@@ -1336,7 +1336,7 @@ void btsnd_hcic_read_tx_power(uint16_t handle, uint8_t type) {
 
 void btsnd_hcic_host_num_xmitted_pkts(uint8_t num_handles, uint16_t* handle,
                                       uint16_t* num_pkts) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + 1 + (num_handles * 4);
@@ -1356,7 +1356,7 @@ void btsnd_hcic_host_num_xmitted_pkts(uint8_t num_handles, uint16_t* handle,
 }
 
 void btsnd_hcic_write_link_super_tout(uint16_t handle, uint16_t timeout) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_LINK_SUPER_TOUT;
@@ -1372,7 +1372,7 @@ void btsnd_hcic_write_link_super_tout(uint16_t handle, uint16_t timeout) {
 }
 
 void btsnd_hcic_write_cur_iac_lap(uint8_t num_cur_iac, LAP* const iac_lap) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + 1 + (LAP_LEN * num_cur_iac);
@@ -1394,7 +1394,7 @@ void btsnd_hcic_write_cur_iac_lap(uint8_t num_cur_iac, LAP* const iac_lap) {
 void btsnd_hcic_sniff_sub_rate(uint16_t handle, uint16_t max_lat,
                                uint16_t min_remote_lat,
                                uint16_t min_local_lat) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SNIFF_SUB_RATE;
@@ -1429,7 +1429,7 @@ void btsnd_hcic_write_ext_inquiry_response(void* buffer, uint8_t fec_req) {
 
 void btsnd_hcic_io_cap_req_reply(const RawAddress& bd_addr, uint8_t capability,
                                  uint8_t oob_present, uint8_t auth_req) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_IO_CAP_RESP;
@@ -1448,7 +1448,7 @@ void btsnd_hcic_io_cap_req_reply(const RawAddress& bd_addr, uint8_t capability,
 
 void btsnd_hcic_enhanced_set_up_synchronous_connection(
     uint16_t conn_handle, enh_esco_params_t* p_params) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_ENH_SET_ESCO_CONN;
@@ -1497,7 +1497,7 @@ void btsnd_hcic_enhanced_set_up_synchronous_connection(
 
 void btsnd_hcic_enhanced_accept_synchronous_connection(
     const RawAddress& bd_addr, enh_esco_params_t* p_params) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_ENH_ACC_ESCO_CONN;
@@ -1546,7 +1546,7 @@ void btsnd_hcic_enhanced_accept_synchronous_connection(
 
 void btsnd_hcic_io_cap_req_neg_reply(const RawAddress& bd_addr,
                                      uint8_t err_code) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_IO_CAP_NEG_REPLY;
@@ -1562,7 +1562,7 @@ void btsnd_hcic_io_cap_req_neg_reply(const RawAddress& bd_addr,
 }
 
 void btsnd_hcic_read_local_oob_data(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_R_LOCAL_OOB;
@@ -1575,7 +1575,7 @@ void btsnd_hcic_read_local_oob_data(void) {
 }
 
 void btsnd_hcic_user_conf_reply(const RawAddress& bd_addr, bool is_yes) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_UCONF_REPLY;
@@ -1597,7 +1597,7 @@ void btsnd_hcic_user_conf_reply(const RawAddress& bd_addr, bool is_yes) {
 }
 
 void btsnd_hcic_user_passkey_reply(const RawAddress& bd_addr, uint32_t value) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_U_PKEY_REPLY;
@@ -1613,7 +1613,7 @@ void btsnd_hcic_user_passkey_reply(const RawAddress& bd_addr, uint32_t value) {
 }
 
 void btsnd_hcic_user_passkey_neg_reply(const RawAddress& bd_addr) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_U_PKEY_NEG_REPLY;
@@ -1629,7 +1629,7 @@ void btsnd_hcic_user_passkey_neg_reply(const RawAddress& bd_addr) {
 
 void btsnd_hcic_rem_oob_reply(const RawAddress& bd_addr, const Octet16& c,
                               const Octet16& r) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_REM_OOB_REPLY;
@@ -1646,7 +1646,7 @@ void btsnd_hcic_rem_oob_reply(const RawAddress& bd_addr, const Octet16& c,
 }
 
 void btsnd_hcic_rem_oob_neg_reply(const RawAddress& bd_addr) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_REM_OOB_NEG_REPLY;
@@ -1661,7 +1661,7 @@ void btsnd_hcic_rem_oob_neg_reply(const RawAddress& bd_addr) {
 }
 
 void btsnd_hcic_read_inq_tx_power(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_R_TX_POWER;
@@ -1674,7 +1674,7 @@ void btsnd_hcic_read_inq_tx_power(void) {
 }
 
 void btsnd_hcic_send_keypress_notif(const RawAddress& bd_addr, uint8_t notif) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_SEND_KEYPRESS_NOTIF;
@@ -1692,7 +1692,7 @@ void btsnd_hcic_send_keypress_notif(const RawAddress& bd_addr, uint8_t notif) {
 /**** end of Simple Pairing Commands ****/
 
 void btsnd_hcic_enhanced_flush(uint16_t handle, uint8_t packet_type) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_ENHANCED_FLUSH;
@@ -1711,7 +1711,7 @@ void btsnd_hcic_enhanced_flush(uint16_t handle, uint8_t packet_type) {
  *************************/
 
 void btsnd_hcic_get_link_quality(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -1726,7 +1726,7 @@ void btsnd_hcic_get_link_quality(uint16_t handle) {
 }
 
 void btsnd_hcic_read_rssi(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -1765,7 +1765,7 @@ void btsnd_hcic_read_encryption_key_size(uint16_t handle, ReadEncKeySizeCb cb) {
 }
 
 void btsnd_hcic_read_failed_contact_counter(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -1780,7 +1780,7 @@ void btsnd_hcic_read_failed_contact_counter(uint16_t handle) {
 }
 
 void btsnd_hcic_read_automatic_flush_timeout(uint16_t handle) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CMD_HANDLE;
@@ -1795,7 +1795,7 @@ void btsnd_hcic_read_automatic_flush_timeout(uint16_t handle) {
 }
 
 void btsnd_hcic_enable_test_mode(void) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_READ_CMD;
@@ -1808,7 +1808,7 @@ void btsnd_hcic_enable_test_mode(void) {
 }
 
 void btsnd_hcic_write_inqscan_type(uint8_t type) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM1;
@@ -1823,7 +1823,7 @@ void btsnd_hcic_write_inqscan_type(uint8_t type) {
 }
 
 void btsnd_hcic_write_inquiry_mode(uint8_t mode) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM1;
@@ -1838,7 +1838,7 @@ void btsnd_hcic_write_inquiry_mode(uint8_t mode) {
 }
 
 void btsnd_hcic_write_pagescan_type(uint8_t type) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
 
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_WRITE_PARAM1;
@@ -1879,7 +1879,7 @@ void btsnd_hcic_vendor_spec_cmd(void* buffer, uint16_t opcode, uint8_t len,
 void btsnd_hcic_configure_data_path(uint8_t data_path_direction,
                                     uint8_t data_path_id,
                                     std::vector<uint8_t> vendor_config) {
-  BT_HDR* p = (BT_HDR*)osi_malloc(HCI_CMD_BUF_SIZE);
+  BT_HDR* p = (BT_HDR*)osi_buffer_alloc(HCI_CMD_BUF_SIZE);
   uint8_t* pp = (uint8_t*)(p + 1);
   uint8_t size = static_cast<uint8_t>(vendor_config.size());
   p->len = HCIC_PREAMBLE_SIZE + HCIC_PARAM_SIZE_CONFIGURE_DATA_PATH + size;
@@ -71,6 +71,15 @@ class A2dpCodecConfig {
   // Gets the current priority of the codec.
   btav_a2dp_codec_priority_t codecPriority() const { return codec_priority_; }
 
+  // Gets the relative CPU cost of running the codec on the host, the cost of
+  // SBC being 1. It breaks the ties between codecs of the same priority.
+  uint8_t softwareCpuCost() const;
+
+  // Checks whether the codec can be run by the Bluetooth SoC or DSP instead
+  // of the host. Offloaded codecs get a higher default priority than the
+  // others.
+  bool isOffloadSupported() const;
+
   // gets current OTA codec specific config to |p_a2dp_offload->codec_info|.
   // Returns true if the current codec config is valid and copied,
   // otherwise false.
@@ -487,6 +496,19 @@ typedef uint32_t (*a2dp_source_read_callback_t)(uint8_t* p_buf, uint32_t len);
 typedef bool (*a2dp_source_enqueue_callback_t)(BT_HDR* p_buf, size_t frames_n,
                                                uint32_t num_bytes);
 
+// Maximum number of packet buffers in a |tA2DP_ENCODER_PACKET_POOL|.
+#define A2DP_ENCODER_PACKET_POOL_SIZE 4
+
+// Packet buffers provided by the caller of |send_frames_batch|.
+// The encoder takes the buffers it fills from the end of |packets| and hands
+// them to the enqueue callback. The buffers it doesn't use are left in
+// |packets|, so that the caller can reuse them on the next tick.
+typedef struct {
+  BT_HDR* packets[A2DP_ENCODER_PACKET_POOL_SIZE];
+  size_t count;        // The number of buffers in |packets|
+  size_t buffer_size;  // The size of each buffer, including the BT_HDR
+} tA2DP_ENCODER_PACKET_POOL;
+
 //
 // A2DP encoder callbacks interface.
 //
@@ -522,6 +544,14 @@ typedef struct {
 
   // Set transmit queue length for the A2DP encoder.
   void (*set_transmit_queue_length)(size_t transmit_queue_length);
+
+  // Prepare and send A2DP encoded frames, as |send_frames| does, reading the
+  // PCM data of all the frames due at |timestamp_us| in a single call to the
+  // read callback. The packets are encoded into buffers taken from |pool|.
+  // Encoders that don't support it set it to nullptr, and |send_frames| is
+  // used instead.
+  void (*send_frames_batch)(uint64_t timestamp_us,
+                            tA2DP_ENCODER_PACKET_POOL* pool);
 } tA2DP_ENCODER_INTERFACE;
 
 // Prototype for a callback to receive decoded audio data from a
@@ -65,6 +65,12 @@ int a2dp_sbc_get_effective_frame_size();
 // |timestamp_us| is the current timestamp (in microseconds).
 void a2dp_sbc_send_frames(uint64_t timestamp_us);
 
+// Prepare and send A2DP SBC encoded frames, reading the PCM data of all the
+// frames in one call and encoding them into buffers taken from |pool|.
+// |timestamp_us| is the current timestamp (in microseconds).
+void a2dp_sbc_send_frames_batch(uint64_t timestamp_us,
+                                tA2DP_ENCODER_PACKET_POOL* pool);
+
 // Get SBC bitrate
 // Returns |uint32_t| bitrate in bits per second
 uint32_t a2dp_sbc_get_bitrate();
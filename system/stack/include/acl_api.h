@@ -258,6 +258,11 @@ uint16_t acl_get_supported_packet_types();
 bool acl_set_peer_le_features_from_handle(uint16_t hci_handle,
                                           const uint8_t* p);
 
+/* Record the transmit data length and PHY of an LE link, from the data length
+ * change and PHY update events */
+void acl_ble_set_tx_data_length(uint16_t hci_handle, uint16_t tx_octets);
+void acl_ble_set_tx_phy(uint16_t hci_handle, uint8_t tx_phy);
+
 tBTM_STATUS btm_read_power_mode_state(const RawAddress& remote_bda,
                                       tBTM_PM_STATE* pmState);
 
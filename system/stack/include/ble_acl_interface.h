@@ -19,6 +19,7 @@
 #include <cstdint>
 
 #include "stack/include/bt_types.h"
+#include "stack/include/gatt_api.h"
 #include "stack/include/hci_error_code.h"
 #include "types/raw_address.h"
 
@@ -46,3 +47,5 @@ void acl_ble_data_length_change_event(uint16_t handle, uint16_t max_tx_octets,
                                       uint16_t max_tx_time,
                                       uint16_t max_rx_octets,
                                       uint16_t max_rx_time);
+void acl_ble_phy_update_event(tGATT_STATUS status, uint16_t handle,
+                              uint8_t tx_phy, uint8_t rx_phy);
@@ -611,6 +611,18 @@ void BTM_EScoConnRsp(uint16_t sco_inx, uint8_t hci_status,
  ******************************************************************************/
 uint8_t BTM_GetNumScoLinks(void);
 
+/*******************************************************************************
+ *
+ * Function         BTM_DumpScoStatistics
+ *
+ * Description      This function dumps the packet loss and underrun counters
+ *                  of the SCO data routed over HCI.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void BTM_DumpScoStatistics(int fd);
+
 /*****************************************************************************
  *  SECURITY MANAGEMENT FUNCTIONS
  ****************************************************************************/
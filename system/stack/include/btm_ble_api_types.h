@@ -506,10 +506,6 @@ typedef void(tBTM_BLE_ENERGY_INFO_CBACK)(tBTM_BLE_TX_TIME_MS tx_time,
                                          tBTM_BLE_ENERGY_USED energy_used,
                                          tHCI_STATUS status);
 
-typedef struct {
-  tBTM_BLE_ENERGY_INFO_CBACK* p_ener_cback;
-} tBTM_BLE_ENERGY_INFO_CB;
-
 typedef void(tBTM_BLE_CTRL_FEATURES_CBACK)(tHCI_STATUS status);
 
 /* BLE encryption keys */
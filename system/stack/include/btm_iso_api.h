@@ -165,6 +165,19 @@ class IsoManager {
   virtual void SendIsoData(uint16_t conn_handle, const uint8_t* data,
                            uint16_t data_len);
 
+  /**
+   * Sends the iso data of several streams for the same SDU interval, e.g. the
+   * left and right CIS of a CIG, to the controller. All the SDUs get the same
+   * time stamp, and none of them is sent unless there are enough credits for
+   * all of them.
+   *
+   * @param sdus SDUs to send. The ownership of their data is not being
+   * transferred.
+   * @param num_sdus number of SDUs, at most kIsoMaxSdusPerBatch
+   */
+  virtual void SendIsoDataBatch(const iso_manager::iso_sdu* sdus,
+                                uint8_t num_sdus);
+
   /**
    * Creates the Broadcast Isochronous Group
    *
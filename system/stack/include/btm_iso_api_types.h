@@ -82,6 +82,17 @@ struct cig_create_params {
   std::vector<EXT_CIS_CFG> cis_cfgs;
 };
 
+/* Max number of SDUs given to IsoManager::SendIsoDataBatch(), that is the max
+ * number of CIS in a CIG or BIS in a BIG.
+ */
+constexpr uint8_t kIsoMaxSdusPerBatch = 0x1F;
+
+struct iso_sdu {
+  uint16_t conn_handle;
+  const uint8_t* data;
+  uint16_t data_len;
+};
+
 struct cig_remove_cmpl_evt {
   uint8_t status;
   uint8_t cig_id;
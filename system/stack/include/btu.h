@@ -68,6 +68,10 @@ bt_status_t do_in_main_thread(const base::Location& from_here,
 bt_status_t do_in_main_thread_delayed(const base::Location& from_here,
                                       base::OnceClosure task,
                                       const base::TimeDelta& delay);
+// Runs |task| right away when the main thread shares the calling Gd thread
+// and has nothing queued, posts it to the main thread otherwise
+bt_status_t do_in_main_thread_or_run(const base::Location& from_here,
+                                     base::OnceClosure task);
 
 bool is_on_main_thread();
 using BtMainClosure = std::function<void()>;
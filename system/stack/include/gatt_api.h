@@ -22,6 +22,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "bt_target.h"
 #include "btm_ble_api.h"
@@ -869,6 +870,28 @@ extern tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
                                                   uint16_t val_len,
                                                   uint8_t* p_val);
 
+/*******************************************************************************
+ *
+ * Function         GATTS_HandleValueNotificationMulti
+ *
+ * Description      This function sends the same handle value notification to
+ *                  several clients, building the notification PDU once for
+ *                  all the links with the same MTU.
+ *
+ * Parameter        conn_ids: connection identifiers.
+ *                  attr_handle: Attribute handle of this handle value
+ *                               notification.
+ *                  val_len: Length of the notified attribute value.
+ *                  p_val: Pointer to the notified attribute value data.
+ *
+ * Returns          The status of the notification on each connection, in the
+ *                  order of conn_ids.
+ *
+ ******************************************************************************/
+extern std::vector<tGATT_STATUS> GATTS_HandleValueNotificationMulti(
+    const std::vector<uint16_t>& conn_ids, uint16_t attr_handle,
+    uint16_t val_len, uint8_t* p_val);
+
 /*******************************************************************************
  *
  * Function         GATTS_SendRsp
@@ -927,6 +950,22 @@ extern tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
 extern tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
                                    uint16_t start_handle, uint16_t end_handle);
 
+/*******************************************************************************
+ *
+ * Function         GATTC_GetBearerCount
+ *
+ * Description      This function is called to get the number of ATT bearers
+ *                  on which the client procedures of a connection can run in
+ *                  parallel.
+ *
+ * Parameters       conn_id: connection identifier.
+ *
+ * Returns          1 + the number of EATT bearers if the client registered
+ *                  with EATT support, 1 otherwise, 0 if conn_id is unknown.
+ *
+ ******************************************************************************/
+extern uint8_t GATTC_GetBearerCount(uint16_t conn_id);
+
 /*******************************************************************************
  *
  * Function         GATTC_Read
@@ -1062,6 +1101,47 @@ extern void GATT_Deregister(tGATT_IF gatt_if);
  ******************************************************************************/
 extern void GATT_StartIf(tGATT_IF gatt_if);
 
+/* LE connection parameter profiles, applied once the link is up. When several
+ * apps use the link, the profile with the highest value is applied. */
+typedef enum : uint8_t {
+  GATT_CONN_PROFILE_DEFAULT = 0, /* keep the parameters of the link */
+  GATT_CONN_PROFILE_LOW_POWER = 1,
+  GATT_CONN_PROFILE_BULK = 2,
+  GATT_CONN_PROFILE_LATENCY_CRITICAL = 3,
+} tGATT_CONN_PROFILE;
+
+/*******************************************************************************
+ *
+ * Function         GATT_SetConnectionProfile
+ *
+ * Description      This function sets the LE connection parameter profile
+ *                  applied to the links used by an application, unless a
+ *                  connection request asks for another one.
+ *
+ * Parameters       gatt_if: applicaiton interface
+ *                  profile: connection parameter profile
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+extern void GATT_SetConnectionProfile(tGATT_IF gatt_if,
+                                      tGATT_CONN_PROFILE profile);
+
+/*******************************************************************************
+ *
+ * Function         GATT_DumpConnectionStatistics
+ *
+ * Description      This function dumps the connection parameter profiles and
+ *                  the time from connection to first GATT operation of the
+ *                  recent LE connections.
+ *
+ * Parameters       fd: file descriptor to dump to.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+extern void GATT_DumpConnectionStatistics(int fd);
+
 /*******************************************************************************
  *
  * Function         GATT_Connect
@@ -1077,6 +1157,8 @@ extern void GATT_StartIf(tGATT_IF gatt_if);
  *                  opportunistic: will not keep device connected if other apps
  *                      disconnect, will not update connected apps counter, when
  *                      disconnected won't cause physical disconnection.
+ *                  conn_profile: LE connection parameter profile for this
+ *                      request, instead of the profile of the application.
  *
  * Returns          true if connection started; else false
  *
@@ -1088,6 +1170,11 @@ extern bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
                          tBTM_BLE_CONN_TYPE connection_type,
                          tBT_TRANSPORT transport, bool opportunistic,
                          uint8_t initiating_phys);
+extern bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
+                         tBTM_BLE_CONN_TYPE connection_type,
+                         tBT_TRANSPORT transport, bool opportunistic,
+                         uint8_t initiating_phys,
+                         tGATT_CONN_PROFILE conn_profile);
 
 /*******************************************************************************
  *
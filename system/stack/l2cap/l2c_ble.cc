@@ -1267,6 +1267,9 @@ void l2c_ble_link_adjust_allocation(void) {
         }
       }
 
+      /* A link moved to the round-robin may already have data queued */
+      if (p_lcb->link_xmit_quota == 0) l2cb.set_rr_link_ready(p_lcb);
+
       L2CAP_TRACE_EVENT(
           "l2c_ble_link_adjust_allocation LCB %d   Priority: %d  XmitQuota: %d",
           yy, p_lcb->acl_priority, p_lcb->link_xmit_quota);
@@ -208,6 +208,23 @@ typedef enum : uint16_t {
 #define LE_DYNAMIC_PSM_END 0x00FF
 #define LE_DYNAMIC_PSM_RANGE (LE_DYNAMIC_PSM_END - LE_DYNAMIC_PSM_START + 1)
 
+/* Sizes of the tables finding an LCB from its HCI handle, indexed by the 12
+ * bits of the handle, and from its remote address, a hash with chaining */
+#define L2C_LCB_HANDLE_TABLE_SIZE 0x1000
+#define L2C_LCB_ADDR_HASH_SIZE 32
+
+/* Channel control blocks are allocated in chunks as channels are opened, up to
+ * l2cb.max_ccbs. A CCB never moves, and its index in the pool gives its local
+ * CID. */
+#define L2C_CCB_CHUNK_SIZE 16
+#define L2C_MAX_CCB_CHUNKS 64
+#define L2C_MAX_CCBS (L2C_CCB_CHUNK_SIZE * L2C_MAX_CCB_CHUNKS)
+
+/* LE dynamic CIDs end at 0x007F, LE channels take the CCBs of the lower
+ * indices */
+#define L2C_LE_DYNAMIC_CID_END 0x007F
+#define L2C_MAX_LE_CCBS (L2C_LE_DYNAMIC_CID_END - L2CAP_BASE_APPL_CID + 1)
+
 /* Return values for l2cu_process_peer_cfg_req() */
 #define L2CAP_PEER_CFG_UNACCEPTABLE 0
 #define L2CAP_PEER_CFG_OK 1
@@ -378,6 +395,7 @@ typedef struct t_l2c_ccb {
     } dropped;
   } metrics;
 
+  uint16_t pool_index; /* Index in the CCB pool, set when the pool grows */
 } tL2C_CCB;
 
 /***********************************************************************
@@ -449,6 +467,8 @@ typedef struct t_l2c_linkcb {
   tL2C_CCB* p_pending_ccb;  /* ccb of waiting channel during link disconnect */
   alarm_t* info_resp_timer; /* Timer entry for info resp timeout evt */
   RawAddress remote_bd_addr; /* The BD address of the remote */
+  uint8_t addr_hash_next; /* 1 + index of the next LCB in the same bucket of
+                             l2cb.lcb_by_addr, 0 for none */
 
  private:
   tHCI_ROLE link_role_{HCI_ROLE_CENTRAL}; /* Central or peripheral */
@@ -597,7 +617,34 @@ typedef struct {
   bool is_cong_cback_context;
 
   tL2C_LCB lcb_pool[MAX_L2CAP_LINKS];    /* Link Control Block pool */
-  tL2C_CCB ccb_pool[MAX_L2CAP_CHANNELS]; /* Channel Control Block pool */
+  /* 1 + index in lcb_pool of the LCB with a handle, 0 for none */
+  uint8_t lcb_by_handle[L2C_LCB_HANDLE_TABLE_SIZE];
+  /* 1 + index in lcb_pool of the first LCB of each bucket of addresses */
+  uint8_t lcb_by_addr[L2C_LCB_ADDR_HASH_SIZE];
+  /* Bit i set while lcb_pool[i] may have data for the round-robin service */
+  uint32_t rr_ready_links;
+  uint32_t rr_link_bit(const tL2C_LCB* p_lcb) const {
+    return 1u << (p_lcb - lcb_pool);
+  }
+  void set_rr_link_ready(const tL2C_LCB* p_lcb) {
+    rr_ready_links |= rr_link_bit(p_lcb);
+  }
+  void clear_rr_link_ready(const tL2C_LCB* p_lcb) {
+    rr_ready_links &= ~rr_link_bit(p_lcb);
+  }
+  bool is_rr_link_ready(const tL2C_LCB* p_lcb) const {
+    return (rr_ready_links & rr_link_bit(p_lcb)) != 0;
+  }
+  /* Channel Control Block pool, num_ccbs CCBs allocated in chunks */
+  tL2C_CCB* ccb_chunks[L2C_MAX_CCB_CHUNKS];
+  uint16_t num_ccbs;       /* Number of CCBs allocated so far */
+  uint16_t max_ccbs;       /* Number of CCBs the pool may grow to */
+  uint16_t num_used_ccbs;  /* Number of CCBs in use */
+  uint16_t peak_used_ccbs; /* Highest num_used_ccbs since l2c_init() */
+  tL2C_CCB* ccb_at(uint16_t index) const {
+    if (index >= num_ccbs) return nullptr;
+    return &ccb_chunks[index / L2C_CCB_CHUNK_SIZE][index % L2C_CCB_CHUNK_SIZE];
+  }
   tL2C_RCB rcb_pool[MAX_L2CAP_CLIENTS];  /* Registration info pool */
 
   tL2C_CCB* p_free_ccb_first; /* Pointer to first free CCB */
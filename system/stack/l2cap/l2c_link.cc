@@ -692,6 +692,9 @@ void l2c_link_adjust_allocation(void) {
         }
       }
 
+      /* A link moved to the round-robin may already have data queued */
+      if (p_lcb->link_xmit_quota == 0) l2cb.set_rr_link_ready(p_lcb);
+
       LOG_DEBUG(
           "l2c_link_adjust_allocation LCB %d   Priority: %d  XmitQuota: %d", yy,
           p_lcb->acl_priority, p_lcb->link_xmit_quota);
@@ -729,8 +732,8 @@ void l2c_link_adjust_allocation(void) {
  ******************************************************************************/
 void l2c_link_adjust_chnl_allocation(void) {
   /* assign buffer quota to each channel based on its data rate requirement */
-  for (uint8_t xx = 0; xx < MAX_L2CAP_CHANNELS; xx++) {
-    tL2C_CCB* p_ccb = l2cb.ccb_pool + xx;
+  for (uint16_t xx = 0; xx < l2cb.num_ccbs; xx++) {
+    tL2C_CCB* p_ccb = l2cb.ccb_at(xx);
 
     if (!p_ccb->in_use) continue;
 
@@ -897,6 +900,13 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
     }
   }
 
+  /* The caller may have just queued data for this link. Mark it ready before
+   * any early return, so that the round robin serves it later.
+   */
+  if (p_lcb != NULL && p_lcb->link_xmit_quota == 0) {
+    l2cb.set_rr_link_ready(p_lcb);
+  }
+
   /* If this is called from uncongested callback context break recursive
    *calling.
    ** This LCB will be served when receiving number of completed packet event.
@@ -913,55 +923,79 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
     LOG_DEBUG("Round robin");
     if (p_lcb == NULL) {
       p_lcb = l2cb.lcb_pool;
-    } else if (!single_write) {
-      p_lcb++;
+    } else {
+      if (!single_write) p_lcb++;
     }
 
-    /* Loop through, starting at the next */
-    for (int xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
-      /* Check for wraparound */
-      if (p_lcb == &l2cb.lcb_pool[MAX_L2CAP_LINKS]) p_lcb = &l2cb.lcb_pool[0];
-
-      /* If controller window is full, nothing to do */
-      if (((l2cb.controller_xmit_window == 0 ||
-            (l2cb.round_robin_unacked >= l2cb.round_robin_quota)) &&
-           (p_lcb->transport == BT_TRANSPORT_BR_EDR)) ||
-          (p_lcb->transport == BT_TRANSPORT_LE &&
-           (l2cb.ble_round_robin_unacked >= l2cb.ble_round_robin_quota ||
-            l2cb.controller_le_xmit_window == 0))) {
-        LOG_DEBUG("Skipping lcb %d due to controller window full", xx);
-        continue;
-      }
+    /* Loop through the links which may have data, starting at the next, one
+     * packet per link and per pass, until the controller window is full or
+     * no link sent anything during a whole pass */
+    bool sent_in_pass = true;
+    while (sent_in_pass && l2cb.rr_ready_links != 0) {
+      sent_in_pass = false;
+      for (int xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+        /* Check for wraparound */
+        if (p_lcb == &l2cb.lcb_pool[MAX_L2CAP_LINKS])
+          p_lcb = &l2cb.lcb_pool[0];
+
+        if (!l2cb.is_rr_link_ready(p_lcb)) continue;
+
+        /* If controller window is full, nothing to do */
+        if (((l2cb.controller_xmit_window == 0 ||
+              (l2cb.round_robin_unacked >= l2cb.round_robin_quota)) &&
+             (p_lcb->transport == BT_TRANSPORT_BR_EDR)) ||
+            (p_lcb->transport == BT_TRANSPORT_LE &&
+             (l2cb.ble_round_robin_unacked >= l2cb.ble_round_robin_quota ||
+              l2cb.controller_le_xmit_window == 0))) {
+          LOG_DEBUG("Skipping lcb %d due to controller window full", xx);
+          continue;
+        }
 
-      if ((!p_lcb->in_use) || (p_lcb->partial_segment_being_sent) ||
-          (p_lcb->link_state != LST_CONNECTED) ||
-          (p_lcb->link_xmit_quota != 0) || (l2c_link_check_power_mode(p_lcb))) {
-        LOG_DEBUG("Skipping lcb %d due to quota", xx);
-        continue;
-      }
+        if ((!p_lcb->in_use) || (p_lcb->link_xmit_quota != 0)) {
+          /* Served directly, or released */
+          l2cb.clear_rr_link_ready(p_lcb);
+          continue;
+        }
 
-      /* See if we can send anything from the Link Queue */
-      if (!list_is_empty(p_lcb->link_xmit_data_q)) {
-        LOG_DEBUG("Sending to lower layer");
-        p_buf = (BT_HDR*)list_front(p_lcb->link_xmit_data_q);
-        list_remove(p_lcb->link_xmit_data_q, p_buf);
-        l2c_link_send_to_lower(p_lcb, p_buf);
-      } else if (single_write) {
-        /* If only doing one write, break out */
-        LOG_DEBUG("single_write is true, skipping");
-        break;
-      }
-      /* If nothing on the link queue, check the channel queue */
-      else {
-        LOG_DEBUG("Check next buffer");
-        p_buf = l2cu_get_next_buffer_to_send(p_lcb);
-        if (p_buf != NULL) {
-          LOG_DEBUG("Sending next buffer");
+        if ((p_lcb->partial_segment_being_sent) ||
+            (p_lcb->link_state != LST_CONNECTED) ||
+            (l2c_link_check_power_mode(p_lcb))) {
+          LOG_DEBUG("Skipping lcb %d due to link state", xx);
+          continue;
+        }
+
+        /* See if we can send anything from the Link Queue */
+        if (!list_is_empty(p_lcb->link_xmit_data_q)) {
+          LOG_DEBUG("Sending to lower layer");
+          p_buf = (BT_HDR*)list_front(p_lcb->link_xmit_data_q);
+          list_remove(p_lcb->link_xmit_data_q, p_buf);
           l2c_link_send_to_lower(p_lcb, p_buf);
+          sent_in_pass = true;
+        } else if (single_write) {
+          /* If only doing one write, break out */
+          LOG_DEBUG("single_write is true, skipping");
+          break;
+        }
+        /* If nothing on the link queue, check the channel queue */
+        else {
+          LOG_DEBUG("Check next buffer");
+          p_buf = l2cu_get_next_buffer_to_send(p_lcb);
+          if (p_buf != NULL) {
+            LOG_DEBUG("Sending next buffer");
+            l2c_link_send_to_lower(p_lcb, p_buf);
+            sent_in_pass = true;
+          } else {
+            /* Nothing left on this link until more data is queued */
+            l2cb.clear_rr_link_ready(p_lcb);
+          }
         }
       }
+
+      if (single_write) break;
     }
 
+    if (p_lcb == &l2cb.lcb_pool[MAX_L2CAP_LINKS]) p_lcb = &l2cb.lcb_pool[0];
+
     /* If we finished without using up our quota, no need for a safety check */
     if ((l2cb.controller_xmit_window > 0) &&
         (l2cb.round_robin_unacked < l2cb.round_robin_quota) &&
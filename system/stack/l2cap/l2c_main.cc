@@ -26,7 +26,11 @@
 
 #include <string.h>
 
+#include <algorithm>
+
 #include "bt_target.h"
+#include "gd/os/system_properties.h"
+#include "gd/os/trace.h"
 #include "hcimsgs.h"  // HCID_GET_
 #include "main/shim/shim.h"
 #include "osi/include/allocator.h"
@@ -37,6 +41,8 @@
 #include "stack/include/l2cdefs.h"
 #include "stack/l2cap/l2c_int.h"
 
+constexpr char kPropertyMaxChannels[] = "bluetooth.l2cap.max_channels";
+
 /******************************************************************************/
 /*            L O C A L    F U N C T I O N     P R O T O T Y P E S            */
 /******************************************************************************/
@@ -58,6 +64,7 @@ tL2C_CB l2cb;
  *
  ******************************************************************************/
 void l2c_rcv_acl_data(BT_HDR* p_msg) {
+  bluetooth::os::ScopedTrace trace("L2CAP receive");
   uint8_t* p = (uint8_t*)(p_msg + 1) + p_msg->offset;
 
   /* Extract the handle */
@@ -880,24 +887,23 @@ void l2c_init(void) {
     return;
   }
 
-  int16_t xx;
-
   memset(&l2cb, 0, sizeof(tL2C_CB));
 
   /* the LE PSM is increased by 1 before being used */
   l2cb.le_dyn_psm = LE_DYNAMIC_PSM_START - 1;
 
-  /* Put all the channel control blocks on the free queue */
-  for (xx = 0; xx < MAX_L2CAP_CHANNELS - 1; xx++) {
-    l2cb.ccb_pool[xx].p_next_ccb = &l2cb.ccb_pool[xx + 1];
-  }
+  /* The channel control blocks are allocated as channels are opened, the
+   * products with many peers may raise the limit. The pool grows by whole
+   * chunks, so the limit is rounded up to one. */
+  uint32_t max_ccbs = bluetooth::os::GetSystemPropertyUint32(
+      kPropertyMaxChannels, MAX_L2CAP_CHANNELS);
+  max_ccbs = std::clamp<uint32_t>(max_ccbs, L2C_CCB_CHUNK_SIZE, L2C_MAX_CCBS);
+  l2cb.max_ccbs = (max_ccbs + L2C_CCB_CHUNK_SIZE - 1) / L2C_CCB_CHUNK_SIZE *
+                  L2C_CCB_CHUNK_SIZE;
 
   /* it will be set to L2CAP_PKT_START_NON_FLUSHABLE if controller supports */
   l2cb.non_flushable_pbf = L2CAP_PKT_START << L2CAP_PKT_TYPE_SHIFT;
 
-  l2cb.p_free_ccb_first = &l2cb.ccb_pool[0];
-  l2cb.p_free_ccb_last = &l2cb.ccb_pool[MAX_L2CAP_CHANNELS - 1];
-
   /* Set the default idle timeout */
   l2cb.idle_timeout = L2CAP_LINK_INACTIVITY_TOUT;
 
@@ -932,6 +938,13 @@ void l2c_free(void) {
 
   list_free(l2cb.rcv_pending_q);
   l2cb.rcv_pending_q = NULL;
+
+  for (uint16_t xx = 0; xx < L2C_MAX_CCB_CHUNKS; xx++) {
+    osi_free_and_reset((void**)&l2cb.ccb_chunks[xx]);
+  }
+  l2cb.num_ccbs = 0;
+  l2cb.p_free_ccb_first = NULL;
+  l2cb.p_free_ccb_last = NULL;
 }
 
 void l2c_receive_hold_timer_timeout(UNUSED_ATTR void* data) {
@@ -970,6 +983,7 @@ void l2c_lcb_timer_timeout(void* data) {
  *
  ******************************************************************************/
 uint8_t l2c_data_write(uint16_t cid, BT_HDR* p_data, uint16_t flags) {
+  bluetooth::os::ScopedTrace trace("L2CAP send");
   /* Find the channel control block. We don't know the link it is on. */
   tL2C_CCB* p_ccb = l2cu_find_ccb_by_cid(NULL, cid);
   if (!p_ccb) {
@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "device/include/controller.h"
 #include "main/shim/l2c_api.h"
 #include "main/shim/shim.h"
@@ -45,6 +47,40 @@
 
 tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb); // TODO Move
 
+static_assert(MAX_L2CAP_LINKS < 0xff,
+              "LCB tables store 1 + the index of the LCB in a uint8_t");
+static_assert(MAX_L2CAP_LINKS <= 32,
+              "l2cb.rr_ready_links holds one bit per LCB in a uint32_t");
+
+/* Bucket of l2cb.lcb_by_addr of a remote address */
+static uint8_t* l2cu_lcb_addr_bucket(const RawAddress& bd_addr) {
+  return &l2cb.lcb_by_addr[std::hash<RawAddress>{}(bd_addr) %
+                           L2C_LCB_ADDR_HASH_SIZE];
+}
+
+/* Entry of l2cb.lcb_by_handle of an HCI handle */
+static uint8_t* l2cu_lcb_handle_entry(uint16_t handle) {
+  return &l2cb.lcb_by_handle[handle % L2C_LCB_HANDLE_TABLE_SIZE];
+}
+
+static uint8_t l2cu_lcb_table_index(const tL2C_LCB* p_lcb) {
+  return (uint8_t)(p_lcb - l2cb.lcb_pool) + 1;
+}
+
+/* Remove an LCB from the bucket of its remote address */
+static void l2cu_unindex_lcb_addr(tL2C_LCB* p_lcb) {
+  uint8_t index = l2cu_lcb_table_index(p_lcb);
+  uint8_t* p_next = l2cu_lcb_addr_bucket(p_lcb->remote_bd_addr);
+  while (*p_next != 0) {
+    if (*p_next == index) {
+      *p_next = p_lcb->addr_hash_next;
+      p_lcb->addr_hash_next = 0;
+      return;
+    }
+    p_next = &l2cb.lcb_pool[*p_next - 1].addr_hash_next;
+  }
+}
+
 /*******************************************************************************
  *
  * Function         l2cu_allocate_lcb
@@ -66,6 +102,9 @@ tL2C_LCB* l2cu_allocate_lcb(const RawAddress& p_bd_addr, bool is_bonding,
       memset(p_lcb, 0, sizeof(tL2C_LCB));
 
       p_lcb->remote_bd_addr = p_bd_addr;
+      uint8_t* p_bucket = l2cu_lcb_addr_bucket(p_bd_addr);
+      p_lcb->addr_hash_next = *p_bucket;
+      *p_bucket = l2cu_lcb_table_index(p_lcb);
 
       p_lcb->in_use = true;
       p_lcb->with_active_local_clients = false;
@@ -105,8 +144,11 @@ void l2cu_set_lcb_handle(struct t_l2c_linkcb& p_lcb, uint16_t handle) {
   if (p_lcb.Handle() != HCI_INVALID_HANDLE) {
     LOG_WARN("Should not replace active handle:%hu with new handle:%hu",
              p_lcb.Handle(), handle);
+    uint8_t* p_entry = l2cu_lcb_handle_entry(p_lcb.Handle());
+    if (*p_entry == l2cu_lcb_table_index(&p_lcb)) *p_entry = 0;
   }
   p_lcb.SetHandle(handle);
+  *l2cu_lcb_handle_entry(handle) = l2cu_lcb_table_index(&p_lcb);
 }
 
 /*******************************************************************************
@@ -154,6 +196,11 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
   p_lcb->in_use = false;
   p_lcb->ResetBonding();
 
+  l2cu_unindex_lcb_addr(p_lcb);
+  l2cb.clear_rr_link_ready(p_lcb);
+  uint8_t* p_handle_entry = l2cu_lcb_handle_entry(p_lcb->Handle());
+  if (*p_handle_entry == l2cu_lcb_table_index(p_lcb)) *p_handle_entry = 0;
+
   /* Stop and free timers */
   alarm_free(p_lcb->l2c_lcb_timer);
   p_lcb->l2c_lcb_timer = NULL;
@@ -239,14 +286,15 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_bd_addr(const RawAddress& p_bd_addr,
                                    tBT_TRANSPORT transport) {
-  int xx;
-  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  uint8_t index = *l2cu_lcb_addr_bucket(p_bd_addr);
 
-  for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+  while (index != 0) {
+    tL2C_LCB* p_lcb = &l2cb.lcb_pool[index - 1];
     if ((p_lcb->in_use) && p_lcb->transport == transport &&
         (p_lcb->remote_bd_addr == p_bd_addr)) {
       return (p_lcb);
     }
+    index = p_lcb->addr_hash_next;
   }
 
   /* If here, no match found */
@@ -297,7 +345,7 @@ bool l2c_is_cmd_rejected(uint8_t cmd_code, uint8_t signal_id, tL2C_LCB* p_lcb) {
  ******************************************************************************/
 BT_HDR* l2cu_build_header(tL2C_LCB* p_lcb, uint16_t len, uint8_t cmd,
                           uint8_t signal_id) {
-  BT_HDR* p_buf = (BT_HDR*)osi_malloc(L2CAP_CMD_BUF_SIZE);
+  BT_HDR* p_buf = (BT_HDR*)osi_buffer_alloc(L2CAP_CMD_BUF_SIZE);
   uint8_t* p;
 
   p_buf->offset = L2CAP_SEND_CMD_OFFSET;
@@ -1339,6 +1387,63 @@ void l2cu_change_pri_ccb(tL2C_CCB* p_ccb, tL2CAP_CHNL_PRIORITY priority) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         l2cu_grow_ccb_pool
+ *
+ * Description      This function allocates one more chunk of Channel Control
+ *                  Blocks and appends them to the free queue.
+ *
+ * Returns          true if the pool grew, false if it reached l2cb.max_ccbs
+ *
+ ******************************************************************************/
+static bool l2cu_grow_ccb_pool() {
+  if (l2cb.num_ccbs + L2C_CCB_CHUNK_SIZE > l2cb.max_ccbs) return false;
+
+  uint16_t first_index = l2cb.num_ccbs;
+  tL2C_CCB* p_chunk =
+      (tL2C_CCB*)osi_calloc(sizeof(tL2C_CCB) * L2C_CCB_CHUNK_SIZE);
+  l2cb.ccb_chunks[first_index / L2C_CCB_CHUNK_SIZE] = p_chunk;
+  l2cb.num_ccbs += L2C_CCB_CHUNK_SIZE;
+
+  for (uint16_t xx = 0; xx < L2C_CCB_CHUNK_SIZE; xx++) {
+    p_chunk[xx].pool_index = first_index + xx;
+    if (xx + 1 < L2C_CCB_CHUNK_SIZE) p_chunk[xx].p_next_ccb = &p_chunk[xx + 1];
+  }
+
+  if (l2cb.p_free_ccb_first == nullptr) {
+    l2cb.p_free_ccb_first = p_chunk;
+  } else {
+    l2cb.p_free_ccb_last->p_next_ccb = p_chunk;
+  }
+  l2cb.p_free_ccb_last = &p_chunk[L2C_CCB_CHUNK_SIZE - 1];
+
+  LOG_INFO("CCB pool grew to %u of at most %u", l2cb.num_ccbs, l2cb.max_ccbs);
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         l2cu_find_free_ccb
+ *
+ * Description      This function finds the first free Channel Control Block,
+ *                  growing the pool if none is free. LE channels only take
+ *                  the CCBs whose CID is in the LE dynamic range.
+ *
+ * Returns          pointer to CCB, or NULL if none
+ *
+ ******************************************************************************/
+static tL2C_CCB* l2cu_find_free_ccb(bool is_le) {
+  do {
+    for (tL2C_CCB* p_ccb = l2cb.p_free_ccb_first; p_ccb != nullptr;
+         p_ccb = p_ccb->p_next_ccb) {
+      if (!is_le || p_ccb->pool_index < L2C_MAX_LE_CCBS) return p_ccb;
+    }
+    if (is_le && l2cb.num_ccbs >= L2C_MAX_LE_CCBS) return nullptr;
+  } while (l2cu_grow_ccb_pool());
+  return nullptr;
+}
+
 /*******************************************************************************
  *
  * Function         l2cu_allocate_ccb
@@ -1352,48 +1457,55 @@ void l2cu_change_pri_ccb(tL2C_CCB* p_ccb, tL2CAP_CHNL_PRIORITY priority) {
  ******************************************************************************/
 tL2C_CCB* l2cu_allocate_ccb(tL2C_LCB* p_lcb, uint16_t cid) {
   LOG_DEBUG("is_dynamic = %d, cid 0x%04x", p_lcb != nullptr, cid);
-  if (!l2cb.p_free_ccb_first) {
-    LOG_ERROR("First free ccb is null for cid 0x%04x", cid);
-    return nullptr;
-  }
   tL2C_CCB* p_ccb;
   /* If a CID was passed in, use that, else take the first free one */
   if (cid == 0) {
-    p_ccb = l2cb.p_free_ccb_first;
+    p_ccb = l2cu_find_free_ccb(p_lcb != nullptr &&
+                               p_lcb->transport == BT_TRANSPORT_LE);
+    if (p_ccb == nullptr) {
+      LOG_ERROR("No free ccb, %u in use of at most %u", l2cb.num_used_ccbs,
+                l2cb.max_ccbs);
+      return nullptr;
+    }
+  } else {
+    p_ccb = l2cb.ccb_at(cid - L2CAP_BASE_APPL_CID);
+    if (p_ccb == nullptr || p_ccb->in_use) {
+      LOG_ERROR("Could not find CCB for CID 0x%04x in the free list", cid);
+      return nullptr;
+    }
+  }
+
+  if (p_ccb == l2cb.p_free_ccb_first) {
     l2cb.p_free_ccb_first = p_ccb->p_next_ccb;
   } else {
     tL2C_CCB* p_prev = nullptr;
+    for (p_prev = l2cb.p_free_ccb_first; p_prev != nullptr;
+         p_prev = p_prev->p_next_ccb) {
+      if (p_prev->p_next_ccb == p_ccb) {
+        p_prev->p_next_ccb = p_ccb->p_next_ccb;
 
-    p_ccb = &l2cb.ccb_pool[cid - L2CAP_BASE_APPL_CID];
-
-    if (p_ccb == l2cb.p_free_ccb_first) {
-      l2cb.p_free_ccb_first = p_ccb->p_next_ccb;
-    } else {
-      for (p_prev = l2cb.p_free_ccb_first; p_prev != nullptr;
-           p_prev = p_prev->p_next_ccb) {
-        if (p_prev->p_next_ccb == p_ccb) {
-          p_prev->p_next_ccb = p_ccb->p_next_ccb;
-
-          if (p_ccb == l2cb.p_free_ccb_last) {
-            l2cb.p_free_ccb_last = p_prev;
-          }
-
-          break;
+        if (p_ccb == l2cb.p_free_ccb_last) {
+          l2cb.p_free_ccb_last = p_prev;
         }
+
+        break;
       }
-      if (p_prev == nullptr) {
-        LOG_ERROR("Could not find CCB for CID 0x%04x in the free list", cid);
-        return nullptr;
-      }
+    }
+    if (p_prev == nullptr) {
+      LOG_ERROR("Could not find CCB for CID 0x%04x in the free list", cid);
+      return nullptr;
     }
   }
 
+  l2cb.num_used_ccbs++;
+  l2cb.peak_used_ccbs = std::max(l2cb.peak_used_ccbs, l2cb.num_used_ccbs);
+
   p_ccb->p_next_ccb = p_ccb->p_prev_ccb = nullptr;
 
   p_ccb->in_use = true;
 
   /* Get a CID for the connection */
-  p_ccb->local_cid = L2CAP_BASE_APPL_CID + (uint16_t)(p_ccb - l2cb.ccb_pool);
+  p_ccb->local_cid = L2CAP_BASE_APPL_CID + p_ccb->pool_index;
 
   p_ccb->p_lcb = p_lcb;
   p_ccb->p_rcb = nullptr;
@@ -1592,6 +1704,7 @@ void l2cu_release_ccb(tL2C_CCB* p_ccb) {
 
   /* Flag as not in use */
   p_ccb->in_use = false;
+  l2cb.num_used_ccbs--;
   // Clear Remote CID and Local Id
   p_ccb->remote_cid = 0;
   p_ccb->local_id = 0;
@@ -3288,10 +3401,19 @@ void l2cu_send_peer_ble_credit_based_disconn_req(tL2C_CCB* p_ccb) {
  *
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle) {
-  int xx;
-  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  /* LCBs waiting for their connection are not indexed by handle */
+  if (handle == HCI_INVALID_HANDLE) {
+    tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+    for (int xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+      if ((p_lcb->in_use) && (p_lcb->Handle() == handle)) return (p_lcb);
+    }
+    return (NULL);
+  }
 
-  for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+  uint8_t index = *l2cu_lcb_handle_entry(handle);
+
+  if (index != 0) {
+    tL2C_LCB* p_lcb = &l2cb.lcb_pool[index - 1];
     if ((p_lcb->in_use) && (p_lcb->Handle() == handle)) {
       return (p_lcb);
     }
@@ -3318,9 +3440,8 @@ tL2C_CCB* l2cu_find_ccb_by_cid(tL2C_LCB* p_lcb, uint16_t local_cid) {
     /* find the associated CCB by "index" */
     local_cid -= L2CAP_BASE_APPL_CID;
 
-    if (local_cid >= MAX_L2CAP_CHANNELS) return NULL;
-
-    p_ccb = l2cb.ccb_pool + local_cid;
+    p_ccb = l2cb.ccb_at(local_cid);
+    if (p_ccb == NULL) return NULL;
 
     /* make sure the CCB is in use */
     if (!p_ccb->in_use) {
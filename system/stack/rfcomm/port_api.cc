@@ -687,7 +687,9 @@ int PORT_ReadData(uint16_t handle, char* p_data, uint16_t max_len,
                   uint16_t* p_len) {
   tPORT* p_port;
   BT_HDR* p_buf;
+  char* p_dest;
   uint16_t count;
+  uint16_t copy_len;
 
   RFCOMM_TRACE_API("PORT_ReadData() handle:%d max_len:%d", handle, max_len);
 
@@ -719,47 +721,36 @@ int PORT_ReadData(uint16_t handle, char* p_data, uint16_t max_len,
   }
 
   count = 0;
+  p_dest = p_data;
+
+  /* Gather as many queued buffers as fit in a single pass, so that bulk */
+  /* readers do not pay for the lock and the credit check per buffer */
+  mutex_global_lock();
 
   while (max_len) {
     p_buf = (BT_HDR*)fixed_queue_try_peek_first(p_port->rx.queue);
     if (p_buf == NULL) break;
 
-    if (p_buf->len > max_len) {
-      memcpy(p_data, (uint8_t*)(p_buf + 1) + p_buf->offset, max_len);
-      p_buf->offset += max_len;
-      p_buf->len -= max_len;
-
-      *p_len += max_len;
-
-      mutex_global_lock();
+    copy_len = (p_buf->len > max_len) ? max_len : p_buf->len;
+    memcpy(p_dest, (uint8_t*)(p_buf + 1) + p_buf->offset, copy_len);
 
-      p_port->rx.queue_size -= max_len;
-
-      mutex_global_unlock();
+    *p_len += copy_len;
+    max_len -= copy_len;
+    p_dest += copy_len;
+    p_port->rx.queue_size -= copy_len;
 
+    if (copy_len < p_buf->len) {
+      p_buf->offset += copy_len;
+      p_buf->len -= copy_len;
       break;
-    } else {
-      memcpy(p_data, (uint8_t*)(p_buf + 1) + p_buf->offset, p_buf->len);
-
-      *p_len += p_buf->len;
-      max_len -= p_buf->len;
-
-      mutex_global_lock();
-
-      p_port->rx.queue_size -= p_buf->len;
-
-      if (max_len) {
-        p_data += p_buf->len;
-      }
-
-      osi_free(fixed_queue_try_dequeue(p_port->rx.queue));
-
-      mutex_global_unlock();
-
-      count++;
     }
+
+    osi_free(fixed_queue_try_dequeue(p_port->rx.queue));
+    count++;
   }
 
+  mutex_global_unlock();
+
   if (*p_len == 1) {
     RFCOMM_TRACE_EVENT("PORT_ReadData queue:%d returned:%d %x",
                        p_port->rx.queue_size, *p_len, (p_data[0]));
@@ -851,6 +842,7 @@ int PORT_WriteDataCO(uint16_t handle, int* p_len) {
   uint32_t event = 0;
   int rc = 0;
   uint16_t length;
+  uint16_t fill_len;
 
   RFCOMM_TRACE_API("PORT_WriteDataCO() handle:%d", handle);
   *p_len = 0;
@@ -888,42 +880,43 @@ int PORT_WriteDataCO(uint16_t handle, int* p_len) {
   length = RFCOMM_DATA_BUF_SIZE -
            (uint16_t)(sizeof(BT_HDR) + L2CAP_MIN_OFFSET + RFCOMM_DATA_OVERHEAD);
 
-  /* If there are buffers scheduled for transmission check if requested */
-  /* data fits into the end of the queue */
+  if (p_port->peer_mtu < length) length = p_port->peer_mtu;
+
+  /* If there are buffers scheduled for transmission fill the end of the */
+  /* queue first, so that the frames sent to the peer are as large as */
+  /* the peer MTU allows */
   mutex_global_lock();
 
   p_buf = (BT_HDR*)fixed_queue_try_peek_last(p_port->tx.queue);
-  if ((p_buf != NULL) &&
-      (((int)p_buf->len + available) <= (int)p_port->peer_mtu) &&
-      (((int)p_buf->len + available) <= (int)length)) {
+  if ((p_buf != NULL) && (p_buf->len < length)) {
+    fill_len = length - p_buf->len;
+    if (available < (int)fill_len) fill_len = (uint16_t)available;
+
     // if(recv(fd, (uint8_t *)(p_buf + 1) + p_buf->offset + p_buf->len,
-    // available, 0) != available)
+    // fill_len, 0) != fill_len)
     if (!p_port->p_data_co_callback(
             handle, (uint8_t*)(p_buf + 1) + p_buf->offset + p_buf->len,
-            available, DATA_CO_CALLBACK_TYPE_OUTGOING))
+            fill_len, DATA_CO_CALLBACK_TYPE_OUTGOING))
 
     {
       error(
           "p_data_co_callback DATA_CO_CALLBACK_TYPE_OUTGOING failed, "
-          "available:%d",
-          available);
+          "fill_len:%d",
+          fill_len);
       mutex_global_unlock();
       return (PORT_UNKNOWN_ERROR);
     }
-    // memcpy ((uint8_t *)(p_buf + 1) + p_buf->offset + p_buf->len, p_data,
-    // max_len);
-    p_port->tx.queue_size += (uint16_t)available;
-
-    *p_len = available;
-    p_buf->len += (uint16_t)available;
+    p_port->tx.queue_size += fill_len;
 
-    mutex_global_unlock();
-
-    return (PORT_SUCCESS);
+    *p_len = fill_len;
+    p_buf->len += fill_len;
+    available -= (int)fill_len;
   }
 
   mutex_global_unlock();
 
+  if (available == 0) return (PORT_SUCCESS);
+
   // int max_read = length < p_port->peer_mtu ? length : p_port->peer_mtu;
 
   // max_read = available < max_read ? available : max_read;
@@ -946,7 +939,6 @@ int PORT_WriteDataCO(uint16_t handle, int* p_len) {
     p_buf->offset = L2CAP_MIN_OFFSET + RFCOMM_MIN_OFFSET;
     p_buf->layer_specific = handle;
 
-    if (p_port->peer_mtu < length) length = p_port->peer_mtu;
     if (available < (int)length) length = (uint16_t)available;
     p_buf->len = length;
     p_buf->event = BT_EVT_TO_BTU_SP_DATA;
@@ -1009,6 +1001,7 @@ int PORT_WriteData(uint16_t handle, const char* p_data, uint16_t max_len,
   uint32_t event = 0;
   int rc = 0;
   uint16_t length;
+  uint16_t fill_len;
 
   RFCOMM_TRACE_API("PORT_WriteData() max_len:%d", max_len);
 
@@ -1039,26 +1032,32 @@ int PORT_WriteData(uint16_t handle, const char* p_data, uint16_t max_len,
   length = RFCOMM_DATA_BUF_SIZE -
            (uint16_t)(sizeof(BT_HDR) + L2CAP_MIN_OFFSET + RFCOMM_DATA_OVERHEAD);
 
-  /* If there are buffers scheduled for transmission check if requested */
-  /* data fits into the end of the queue */
+  if (p_port->peer_mtu < length) length = p_port->peer_mtu;
+
+  /* If there are buffers scheduled for transmission fill the end of the */
+  /* queue first, so that the frames sent to the peer are as large as */
+  /* the peer MTU allows */
   mutex_global_lock();
 
   p_buf = (BT_HDR*)fixed_queue_try_peek_last(p_port->tx.queue);
-  if ((p_buf != NULL) && ((p_buf->len + max_len) <= p_port->peer_mtu) &&
-      ((p_buf->len + max_len) <= length)) {
-    memcpy((uint8_t*)(p_buf + 1) + p_buf->offset + p_buf->len, p_data, max_len);
-    p_port->tx.queue_size += max_len;
-
-    *p_len = max_len;
-    p_buf->len += max_len;
-
-    mutex_global_unlock();
-
-    return (PORT_SUCCESS);
+  if ((p_buf != NULL) && (p_buf->len < length)) {
+    fill_len = length - p_buf->len;
+    if (max_len < fill_len) fill_len = max_len;
+
+    memcpy((uint8_t*)(p_buf + 1) + p_buf->offset + p_buf->len, p_data,
+           fill_len);
+    p_port->tx.queue_size += fill_len;
+
+    *p_len = fill_len;
+    p_buf->len += fill_len;
+    max_len -= fill_len;
+    p_data += fill_len;
   }
 
   mutex_global_unlock();
 
+  if (!max_len) return (PORT_SUCCESS);
+
   while (max_len) {
     /* if we're over buffer high water mark, we're done */
     if ((p_port->tx.queue_size > PORT_TX_HIGH_WM) ||
@@ -1070,7 +1069,6 @@ int PORT_WriteData(uint16_t handle, const char* p_data, uint16_t max_len,
     p_buf->offset = L2CAP_MIN_OFFSET + RFCOMM_MIN_OFFSET;
     p_buf->layer_specific = handle;
 
-    if (p_port->peer_mtu < length) length = p_port->peer_mtu;
     if (max_len < length) length = max_len;
     p_buf->len = length;
     p_buf->event = BT_EVT_TO_BTU_SP_DATA;
@@ -467,9 +467,14 @@ void port_flow_control_peer(tPORT* p_port, bool enable, uint16_t count) {
 
       /* If credit count is less than low credit watermark, and user */
       /* did not force flow control, send a credit update */
+      /* When the user drains the rx queue as fast as the peer fills it, */
+      /* send the update once half of the credits are consumed, so that */
+      /* bulk transfers do not stall waiting for credits */
       /* There might be a special case when we just adjusted rx_max */
-      if ((p_port->credit_rx <= p_port->credit_rx_low) && !p_port->rx.user_fc &&
-          (p_port->credit_rx_max > p_port->credit_rx)) {
+      if (((p_port->credit_rx <= p_port->credit_rx_low) ||
+           (fixed_queue_is_empty(p_port->rx.queue) &&
+            (p_port->credit_rx <= p_port->credit_rx_max / 2))) &&
+          !p_port->rx.user_fc && (p_port->credit_rx_max > p_port->credit_rx)) {
         rfc_send_credit(p_port->rfc.p_mcb, p_port->dlci,
                         (uint8_t)(p_port->credit_rx_max - p_port->credit_rx));
 
@@ -24,6 +24,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <cstdint>
 
 #include "bt_target.h"
@@ -34,12 +35,43 @@
 #include "stack/sdp/sdpint.h"
 #include "types/bluetooth/uuid.h"
 
+using bluetooth::Uuid;
+
 /******************************************************************************/
 /*            L O C A L    F U N C T I O N     P R O T O T Y P E S            */
 /******************************************************************************/
 static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
                              const uint8_t* p_his_uuid, uint16_t his_len,
                              int nest_level);
+static bool find_uuid_in_rec(const tSDP_RECORD* p_rec, const tUID_ENT* p_uuid);
+static void sdp_db_index_uuids(tSDP_RECORD* p_rec);
+
+/*******************************************************************************
+ *
+ * Function         uuid_from_array
+ *
+ * Description      This function converts a 2, 4 or 16 byte UUID, as found in
+ *                  a data element, to its 128-bit form.
+ *
+ * Returns          true if the UUID length is valid, else false
+ *
+ ******************************************************************************/
+static bool uuid_from_array(const uint8_t* p_uuid, uint32_t len, Uuid* p_out) {
+  switch (len) {
+    case Uuid::kNumBytes16:
+      *p_out = Uuid::From16Bit((p_uuid[0] << 8) | p_uuid[1]);
+      return true;
+    case Uuid::kNumBytes32:
+      *p_out = Uuid::From32Bit((p_uuid[0] << 24) | (p_uuid[1] << 16) |
+                               (p_uuid[2] << 8) | p_uuid[3]);
+      return true;
+    case Uuid::kNumBytes128:
+      *p_out = Uuid::From128BitBE(p_uuid);
+      return true;
+    default:
+      return false;
+  }
+}
 
 /*******************************************************************************
  *
@@ -54,10 +86,17 @@ static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
  ******************************************************************************/
 const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
                                          const tSDP_UUID_SEQ* p_seq) {
-  uint16_t xx, yy;
-  const tSDP_ATTRIBUTE* p_attr;
+  uint16_t yy;
+  Uuid uuids[MAX_UUIDS_PER_SEQ];
   tSDP_RECORD* p_end = &sdp_cb.server_db.record[sdp_cb.server_db.num_records];
 
+  /* A UUID of invalid length is in no record */
+  for (yy = 0; yy < p_seq->num_uids; yy++) {
+    if (!uuid_from_array(p_seq->uuid_entry[yy].value, p_seq->uuid_entry[yy].len,
+                         &uuids[yy]))
+      return (NULL);
+  }
+
   /* If NULL, start at the beginning, else start at the first specified record
    */
   if (!p_rec)
@@ -69,22 +108,13 @@ const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
   /* the record contains all the passed UUIDs in it.                */
   for (; p_rec < p_end; p_rec++) {
     for (yy = 0; yy < p_seq->num_uids; yy++) {
-      p_attr = &p_rec->attribute[0];
-      for (xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
-        if (p_attr->type == UUID_DESC_TYPE) {
-          if (sdpu_compare_uuid_arrays(p_attr->value_ptr, p_attr->len,
-                                       &p_seq->uuid_entry[yy].value[0],
-                                       p_seq->uuid_entry[yy].len))
-            break;
-        } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
-          if (find_uuid_in_seq(p_attr->value_ptr, p_attr->len,
-                               &p_seq->uuid_entry[yy].value[0],
-                               p_seq->uuid_entry[yy].len, 0))
-            break;
-        }
+      if (p_rec->uuids_overflow) {
+        if (!find_uuid_in_rec(p_rec, &p_seq->uuid_entry[yy])) break;
+      } else {
+        const Uuid* p_uuids_end = &p_rec->uuids[p_rec->num_uuids];
+        if (std::find(p_rec->uuids, p_uuids_end, uuids[yy]) == p_uuids_end)
+          break;
       }
-      /* If any UUID was not found,  on to the next record */
-      if (xx == p_rec->num_attributes) break;
     }
 
     /* If every UUID was found in the record, return the record */
@@ -95,6 +125,33 @@ const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
   return (NULL);
 }
 
+/*******************************************************************************
+ *
+ * Function         find_uuid_in_rec
+ *
+ * Description      This function searches the attributes of a record for a
+ *                  UUID, for the records whose UUIDs are not all indexed.
+ *
+ * Returns          true if found, else false
+ *
+ ******************************************************************************/
+static bool find_uuid_in_rec(const tSDP_RECORD* p_rec, const tUID_ENT* p_uuid) {
+  const tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
+
+  for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
+    if (p_attr->type == UUID_DESC_TYPE) {
+      if (sdpu_compare_uuid_arrays(p_attr->value_ptr, p_attr->len,
+                                   p_uuid->value, p_uuid->len))
+        return (true);
+    } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
+      if (find_uuid_in_seq(p_attr->value_ptr, p_attr->len, p_uuid->value,
+                           p_uuid->len, 0))
+        return (true);
+    }
+  }
+  return (false);
+}
+
 /*******************************************************************************
  *
  * Function         find_uuid_in_seq
@@ -135,6 +192,89 @@ static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
   return (false);
 }
 
+/*******************************************************************************
+ *
+ * Function         add_uuid_to_index
+ *
+ * Description      This function adds a UUID to the UUIDs of a record, unless
+ *                  it is already there.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void add_uuid_to_index(tSDP_RECORD* p_rec, const uint8_t* p_uuid,
+                              uint32_t len) {
+  Uuid uuid;
+
+  if (!uuid_from_array(p_uuid, len, &uuid)) return;
+  if (std::find(p_rec->uuids, &p_rec->uuids[p_rec->num_uuids], uuid) !=
+      &p_rec->uuids[p_rec->num_uuids])
+    return;
+
+  if (p_rec->num_uuids == SDP_MAX_REC_UUIDS) {
+    p_rec->uuids_overflow = true;
+    return;
+  }
+  p_rec->uuids[p_rec->num_uuids++] = uuid;
+}
+
+/*******************************************************************************
+ *
+ * Function         add_seq_uuids_to_index
+ *
+ * Description      This function adds the UUIDs of a data element sequence to
+ *                  the UUIDs of a record, with the same nesting limit as
+ *                  find_uuid_in_seq.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void add_seq_uuids_to_index(tSDP_RECORD* p_rec, uint8_t* p,
+                                   uint32_t seq_len, int nest_level) {
+  uint8_t* p_end = p + seq_len;
+  uint8_t type;
+  uint32_t len;
+
+  if (nest_level > 3) return;
+
+  while (p < p_end) {
+    type = *p++;
+    p = sdpu_get_len_from_type(p, p_end, type, &len);
+    if (p == NULL || (p + len) > p_end) break;
+    type = type >> 3;
+    if (type == UUID_DESC_TYPE)
+      add_uuid_to_index(p_rec, p, len);
+    else if (type == DATA_ELE_SEQ_DESC_TYPE)
+      add_seq_uuids_to_index(p_rec, p, len, nest_level + 1);
+    p = p + len;
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_index_uuids
+ *
+ * Description      This function rebuilds the set of UUIDs of a record that
+ *                  sdp_db_service_search looks for, after its attributes
+ *                  changed.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_index_uuids(tSDP_RECORD* p_rec) {
+  const tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
+
+  p_rec->num_uuids = 0;
+  p_rec->uuids_overflow = false;
+
+  for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
+    if (p_attr->type == UUID_DESC_TYPE)
+      add_uuid_to_index(p_rec, p_attr->value_ptr, p_attr->len);
+    else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE)
+      add_seq_uuids_to_index(p_rec, p_attr->value_ptr, p_attr->len, 0);
+  }
+}
+
 /*******************************************************************************
  *
  * Function         sdp_db_find_record
@@ -173,19 +313,199 @@ tSDP_RECORD* sdp_db_find_record(uint32_t handle) {
 const tSDP_ATTRIBUTE* sdp_db_find_attr_in_rec(const tSDP_RECORD* p_rec,
                                               uint16_t start_attr,
                                               uint16_t end_attr) {
-  const tSDP_ATTRIBUTE* p_at;
-  uint16_t xx;
+  const tSDP_ATTRIBUTE* p_end = &p_rec->attribute[p_rec->num_attributes];
 
-  /* Note that the attributes in a record are assumed to be in sorted order */
-  for (xx = 0, p_at = &p_rec->attribute[0]; xx < p_rec->num_attributes;
-       xx++, p_at++) {
-    if ((p_at->id >= start_attr) && (p_at->id <= end_attr)) return (p_at);
-  }
+  /* The attributes in a record are kept sorted by SDP_AddAttribute, so the
+   * first one in the range is found by a binary search */
+  const tSDP_ATTRIBUTE* p_at = std::lower_bound(
+      &p_rec->attribute[0], p_end, start_attr,
+      [](const tSDP_ATTRIBUTE& attr, uint16_t id) { return attr.id < id; });
+
+  if ((p_at != p_end) && (p_at->id <= end_attr)) return (p_at);
 
   /* No matching attribute found */
   return (NULL);
 }
 
+/*******************************************************************************
+ *
+ * Function         attr_list_cache_matches
+ *
+ * Description      This function checks if a cached response was built for
+ *                  the given UUID and attribute sequences.
+ *
+ * Returns          true if it was, else false
+ *
+ ******************************************************************************/
+static bool attr_list_cache_matches(const tSDP_ATTR_LIST_CACHE* p_entry,
+                                    const tSDP_UUID_SEQ* uid_seq,
+                                    const tSDP_ATTR_SEQ* attr_seq) {
+  if (p_entry->p_list == NULL ||
+      p_entry->uid_seq.num_uids != uid_seq->num_uids ||
+      p_entry->attr_seq.num_attr != attr_seq->num_attr)
+    return (false);
+
+  for (uint16_t xx = 0; xx < uid_seq->num_uids; xx++) {
+    const tUID_ENT* p_uuid = &uid_seq->uuid_entry[xx];
+    if (p_entry->uid_seq.uuid_entry[xx].len != p_uuid->len ||
+        memcmp(p_entry->uid_seq.uuid_entry[xx].value, p_uuid->value,
+               p_uuid->len) != 0)
+      return (false);
+  }
+  for (uint16_t xx = 0; xx < attr_seq->num_attr; xx++) {
+    if (p_entry->attr_seq.attr_entry[xx].start !=
+            attr_seq->attr_entry[xx].start ||
+        p_entry->attr_seq.attr_entry[xx].end != attr_seq->attr_entry[xx].end)
+      return (false);
+  }
+  return (true);
+}
+
+/*******************************************************************************
+ *
+ * Function         build_attr_list
+ *
+ * Description      This function serializes the attribute lists of all the
+ *                  records matching a ServiceSearchAttribute request.
+ *
+ *                  The records of an AVRCP Target are not serialized, because
+ *                  the server adjusts their version to each peer.
+ *
+ * Returns          Pointer to the allocated lists, or NULL if they can not be
+ *                  cached.
+ *
+ ******************************************************************************/
+static uint8_t* build_attr_list(const tSDP_UUID_SEQ* uid_seq,
+                                const tSDP_ATTR_SEQ* attr_seq,
+                                uint16_t* p_list_len) {
+  const tSDP_RECORD* p_rec;
+  const tSDP_ATTRIBUTE* p_attr;
+  uint32_t len = 0;
+
+  /* Get the length of the sequences first */
+  for (p_rec = sdp_db_service_search(NULL, uid_seq); p_rec;
+       p_rec = sdp_db_service_search(p_rec, uid_seq)) {
+    p_attr = sdp_db_find_attr_in_rec(p_rec, ATTR_ID_SERVICE_CLASS_ID_LIST,
+                                     ATTR_ID_SERVICE_CLASS_ID_LIST);
+    if (p_attr && sdpu_is_service_id_avrc_target(p_attr)) return (NULL);
+
+    uint16_t seq_len = sdpu_get_attrib_seq_len(p_rec, attr_seq);
+    if (seq_len != 0) len += 3 + seq_len;
+  }
+
+  /* The lists are preceded by a 2 or 3 byte sequence header */
+  uint32_t hdr_len = (len > 255) ? 3 : 2;
+  if (len + hdr_len > UINT16_MAX) return (NULL);
+
+  uint8_t* p_list = (uint8_t*)osi_malloc(len + hdr_len);
+  uint8_t* p = p_list;
+
+  if (len > 255) {
+    UINT8_TO_BE_STREAM(p, (DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD);
+    UINT16_TO_BE_STREAM(p, len);
+  } else {
+    UINT8_TO_BE_STREAM(p, (DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_BYTE);
+    UINT8_TO_BE_STREAM(p, len);
+  }
+
+  for (p_rec = sdp_db_service_search(NULL, uid_seq); p_rec;
+       p_rec = sdp_db_service_search(p_rec, uid_seq)) {
+    uint16_t seq_len = sdpu_get_attrib_seq_len(p_rec, attr_seq);
+    if (seq_len == 0) continue;
+
+    uint8_t* p_seq_end = p + 3 + seq_len;
+    UINT8_TO_BE_STREAM(p, (DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD);
+    UINT16_TO_BE_STREAM(p, seq_len);
+
+    /* Add every attribute of each range, as the server does */
+    for (uint16_t xx = 0; xx < attr_seq->num_attr; xx++) {
+      uint16_t start_id = attr_seq->attr_entry[xx].start;
+      uint16_t end_id = attr_seq->attr_entry[xx].end;
+      while ((p_attr = sdp_db_find_attr_in_rec(p_rec, start_id, end_id)) !=
+             NULL) {
+        if (p + sdpu_get_attrib_entry_len(p_attr) > p_seq_end) break;
+        p = sdpu_build_attrib_entry(p, p_attr);
+        if (p_attr->id >= end_id) break;
+        start_id = p_attr->id + 1;
+      }
+    }
+
+    if (p != p_seq_end) {
+      SDP_TRACE_WARNING("%s: unexpected sequence length", __func__);
+      osi_free(p_list);
+      return (NULL);
+    }
+  }
+
+  *p_list_len = (uint16_t)(len + hdr_len);
+  return (p_list);
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_get_attr_list
+ *
+ * Description      This function returns the serialized attribute lists of
+ *                  the response to a ServiceSearchAttribute request, with
+ *                  their sequence header. The common requests are served from
+ *                  a cache of the last responses, cleared when the database
+ *                  is modified.
+ *
+ * Returns          Pointer to the lists, valid until the database is
+ *                  modified, or NULL if the response can not be cached.
+ *
+ ******************************************************************************/
+const uint8_t* sdp_db_get_attr_list(const tSDP_UUID_SEQ* uid_seq,
+                                    const tSDP_ATTR_SEQ* attr_seq,
+                                    uint16_t* p_list_len) {
+  tSDP_DB* p_db = &sdp_cb.server_db;
+  tSDP_ATTR_LIST_CACHE* p_entry;
+
+  for (uint8_t xx = 0; xx < SDP_MAX_CACHED_ATTR_LISTS; xx++) {
+    p_entry = &p_db->attr_list_cache[xx];
+    if (attr_list_cache_matches(p_entry, uid_seq, attr_seq)) {
+      *p_list_len = p_entry->list_len;
+      return (p_entry->p_list);
+    }
+  }
+
+  uint16_t list_len;
+  uint8_t* p_list = build_attr_list(uid_seq, attr_seq, &list_len);
+  if (p_list == NULL) return (NULL);
+
+  /* Replace the oldest response */
+  p_entry = &p_db->attr_list_cache[p_db->next_attr_list_cache];
+  p_db->next_attr_list_cache =
+      (p_db->next_attr_list_cache + 1) % SDP_MAX_CACHED_ATTR_LISTS;
+
+  osi_free(p_entry->p_list);
+  p_entry->uid_seq = *uid_seq;
+  p_entry->attr_seq = *attr_seq;
+  p_entry->list_len = list_len;
+  p_entry->p_list = p_list;
+
+  *p_list_len = list_len;
+  return (p_list);
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_clear_attr_list_cache
+ *
+ * Description      This function clears the cached ServiceSearchAttribute
+ *                  responses, when the database is modified.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void sdp_db_clear_attr_list_cache(void) {
+  tSDP_DB* p_db = &sdp_cb.server_db;
+
+  for (uint8_t xx = 0; xx < SDP_MAX_CACHED_ATTR_LISTS; xx++)
+    osi_free_and_reset((void**)&p_db->attr_list_cache[xx].p_list);
+  p_db->next_attr_list_cache = 0;
+}
+
 /*******************************************************************************
  *
  * Function         sdp_compose_proto_list
@@ -256,6 +576,7 @@ uint32_t SDP_CreateRecord(void) {
 
   /* First, check if there is a free record */
   if (p_db->num_records < SDP_MAX_RECORDS) {
+    sdp_db_clear_attr_list_cache();
     memset(&p_db->record[p_db->num_records], 0, sizeof(tSDP_RECORD));
 
     /* We will use a handle of the first unreserved handle plus last record
@@ -298,6 +619,8 @@ bool SDP_DeleteRecord(uint32_t handle) {
   uint16_t xx, yy, zz;
   tSDP_RECORD* p_rec = &sdp_cb.server_db.record[0];
 
+  sdp_db_clear_attr_list_cache();
+
   if (handle == 0 || sdp_cb.server_db.num_records == 0) {
     /* Delete all records in the database */
     sdp_cb.server_db.num_records = 0;
@@ -407,6 +730,8 @@ bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
     if (p_rec->record_handle == handle) {
       tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
 
+      sdp_db_clear_attr_list_cache();
+
       // error out early, no need to look up
       if (p_rec->free_pad_ptr >= SDP_MAX_PAD_LEN) {
         SDP_TRACE_ERROR("the free pad for SDP record with handle %d is "
@@ -463,9 +788,11 @@ bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
             "SDP_AddAttribute fail, length exceed maximum: ID %d: attr_len:%d ",
             attr_id, attr_len);
         p_attr->id = p_attr->type = p_attr->len = 0;
+        sdp_db_index_uuids(p_rec);
         return (false);
       }
       p_rec->num_attributes++;
+      sdp_db_index_uuids(p_rec);
       return (true);
     }
   }
@@ -787,6 +1114,7 @@ bool SDP_DeleteAttribute(uint32_t handle, uint16_t attr_id) {
       tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
 
       SDP_TRACE_API("Deleting attr_id 0x%04x for handle 0x%x", attr_id, handle);
+      sdp_db_clear_attr_list_cache();
       /* Found it. Now, find the attribute */
       for (uint16_t attribute_index = 0; attribute_index < p_rec->num_attributes; attribute_index++, p_attr++) {
         if (p_attr->id == attr_id) {
@@ -816,6 +1144,7 @@ bool SDP_DeleteAttribute(uint32_t handle, uint16_t attr_id) {
             }
             p_rec->free_pad_ptr -= len;
           }
+          sdp_db_index_uuids(p_rec);
           return (true);
         }
       }
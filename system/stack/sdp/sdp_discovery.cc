@@ -24,6 +24,9 @@
 
 #define LOG_TAG "sdp_discovery"
 
+#include <string.h>
+
+#include <algorithm>
 #include <cstdint>
 
 #include "bt_target.h"
@@ -48,6 +51,11 @@ static void process_service_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
                                      uint8_t* p_reply_end);
 static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
                                             uint8_t* p_reply_end);
+static void process_db_state_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
+                                 uint8_t* p_reply_end);
+static tSDP_REASON save_attr_list(tCONN_CB* p_ccb);
+static tSDP_DISC_CACHE* sdp_disc_find_cache(const tCONN_CB& ccb);
+static void sdp_disc_store_cache(const tCONN_CB& ccb);
 static uint8_t* save_attr_seq(tCONN_CB* p_ccb, uint8_t* p, uint8_t* p_msg_end);
 static tSDP_DISC_REC* add_record(tSDP_DISCOVERY_DB* p_db,
                                  const RawAddress& p_bda);
@@ -198,6 +206,58 @@ static void sdp_snd_service_search_req(tCONN_CB* p_ccb, uint8_t cont_len,
                      sdp_conn_timer_timeout, p_ccb);
 }
 
+/*******************************************************************************
+ *
+ * Function         sdp_snd_db_state_req
+ *
+ * Description      Send a request for the ServiceDatabaseState attribute of
+ *                  the SDP server record to the SDP server.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_snd_db_state_req(tCONN_CB* p_ccb) {
+  uint8_t *p, *p_start, *p_param_len;
+  BT_HDR* p_cmd = (BT_HDR*)osi_malloc(SDP_DATA_BUF_SIZE);
+  uint16_t bytes_left = SDP_DATA_BUF_SIZE - sizeof(BT_HDR) - L2CAP_MIN_OFFSET;
+  Uuid uuid = Uuid::From16Bit(UUID_SERVCLASS_SERVICE_DISCOVERY_SERVER);
+  uint16_t attr_id = ATTR_ID_SERVICE_DATABASE_STATE;
+
+  /* Prepare the buffer for sending the packet to L2CAP */
+  p_cmd->offset = L2CAP_MIN_OFFSET;
+  p = p_start = (uint8_t*)(p_cmd + 1) + L2CAP_MIN_OFFSET;
+
+  /* Build a service search attribute request packet */
+  UINT8_TO_BE_STREAM(p, SDP_PDU_SERVICE_SEARCH_ATTR_REQ);
+  UINT16_TO_BE_STREAM(p, p_ccb->transaction_id);
+  p_ccb->transaction_id++;
+
+  /* Skip the length, we need to add it at the end */
+  p_param_len = p;
+  p += 2;
+
+  p = sdpu_build_uuid_seq(p, 1, &uuid, bytes_left);
+  UINT16_TO_BE_STREAM(p, sdp_cb.max_attr_list_size);
+  p = sdpu_build_attrib_seq(p, &attr_id, 1);
+
+  /* No continuation state */
+  UINT8_TO_BE_STREAM(p, 0);
+
+  /* Go back and put the parameter length into the buffer */
+  UINT16_TO_BE_STREAM(p_param_len, (uint16_t)(p - p_param_len - 2));
+
+  p_ccb->disc_state = SDP_DISC_WAIT_DB_STATE;
+
+  /* Set the length of the SDP data in the buffer */
+  p_cmd->len = (uint16_t)(p - p_start);
+
+  L2CA_DataWrite(p_ccb->connection_id, p_cmd);
+
+  /* Start inactivity timer */
+  alarm_set_on_mloop(p_ccb->sdp_conn_timer, SDP_INACT_TIMEOUT_MS,
+                     sdp_conn_timer_timeout, p_ccb);
+}
+
 /*******************************************************************************
  *
  * Function         sdp_disc_connected
@@ -210,6 +270,14 @@ static void sdp_snd_service_search_req(tCONN_CB* p_ccb, uint8_t cont_len,
  ******************************************************************************/
 void sdp_disc_connected(tCONN_CB* p_ccb) {
   if (p_ccb->is_attr_search) {
+    /* Unless the peer is known to have no ServiceDatabaseState, read it first
+     * to know if a cached response can be used */
+    const tSDP_DISC_CACHE* p_entry = sdp_disc_find_cache(*p_ccb);
+    if (p_entry == NULL || p_entry->has_db_state) {
+      sdp_snd_db_state_req(p_ccb);
+      return;
+    }
+
     p_ccb->disc_state = SDP_DISC_WAIT_SEARCH_ATTR;
 
     process_service_search_attr_rsp(p_ccb, NULL, NULL);
@@ -272,6 +340,17 @@ void sdp_disc_server_rsp(tCONN_CB* p_ccb, BT_HDR* p_msg) {
       if (p_ccb->disc_state == SDP_DISC_WAIT_SEARCH_ATTR) {
         process_service_search_attr_rsp(p_ccb, p, p_end);
         invalid_pdu = false;
+      } else if (p_ccb->disc_state == SDP_DISC_WAIT_DB_STATE) {
+        process_db_state_rsp(p_ccb, p, p_end);
+        invalid_pdu = false;
+      }
+      break;
+
+    case SDP_PDU_ERROR_RESPONSE:
+      /* The ServiceDatabaseState is optional, go on without it */
+      if (p_ccb->disc_state == SDP_DISC_WAIT_DB_STATE) {
+        process_db_state_rsp(p_ccb, NULL, NULL);
+        invalid_pdu = false;
       }
       break;
   }
@@ -544,9 +623,7 @@ static void process_service_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
  ******************************************************************************/
 static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
                                             uint8_t* p_reply_end) {
-  uint8_t *p, *p_start, *p_end, *p_param_len;
-  uint8_t type;
-  uint32_t seq_len;
+  uint8_t *p_start, *p_param_len;
   uint16_t param_len, lists_byte_count = 0;
   bool cont_request_needed = false;
 
@@ -666,10 +743,33 @@ static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
 /* We now have the full response, which is a sequence of sequences */
 /*******************************************************************/
 
+  tSDP_REASON reason = save_attr_list(p_ccb);
+  if (reason == SDP_SUCCESS && p_ccb->db_state_read)
+    sdp_disc_store_cache(*p_ccb);
+
+  /* Since we got everything we need, disconnect the call */
+  sdp_disconnect(p_ccb, reason);
+}
+
+/*******************************************************************************
+ *
+ * Function         save_attr_list
+ *
+ * Description      This function saves the full response to a service search
+ *                  attribute request, held in the rsp_list, to the discovery
+ *                  database.
+ *
+ * Returns          SDP_SUCCESS, or the reason of the failure
+ *
+ ******************************************************************************/
+static tSDP_REASON save_attr_list(tCONN_CB* p_ccb) {
+  uint8_t *p, *p_end;
+  uint8_t type;
+  uint32_t seq_len;
+
   if (!sdp_copy_raw_data(p_ccb, true)) {
     LOG_ERROR("sdp_copy_raw_data failed");
-    sdp_disconnect(p_ccb, SDP_ILLEGAL_PARAMETER);
-    return;
+    return SDP_ILLEGAL_PARAMETER;
   }
 
   p = &p_ccb->rsp_list[0];
@@ -679,33 +779,252 @@ static void process_service_search_attr_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
 
   if ((type >> 3) != DATA_ELE_SEQ_DESC_TYPE) {
     LOG_WARN("Wrong element in attr_rsp type:0x%02x", type);
-    sdp_disconnect(p_ccb, SDP_ILLEGAL_PARAMETER);
-    return;
+    return SDP_ILLEGAL_PARAMETER;
   }
   p = sdpu_get_len_from_type(p, p + p_ccb->list_len, type, &seq_len);
   if (p == NULL || (p + seq_len) > (p + p_ccb->list_len)) {
     LOG_WARN("Illegal search attribute length");
-    sdp_disconnect(p_ccb, SDP_ILLEGAL_PARAMETER);
-    return;
+    return SDP_ILLEGAL_PARAMETER;
   }
   p_end = &p_ccb->rsp_list[p_ccb->list_len];
 
-  if ((p + seq_len) != p_end) {
-    sdp_disconnect(p_ccb, SDP_INVALID_CONT_STATE);
-    return;
-  }
+  if ((p + seq_len) != p_end) return SDP_INVALID_CONT_STATE;
 
   while (p < p_end) {
     p = save_attr_seq(p_ccb, p, &p_ccb->rsp_list[p_ccb->list_len]);
-    if (!p) {
-      sdp_disconnect(p_ccb, SDP_DB_FULL);
-      return;
-    }
+    if (!p) return SDP_DB_FULL;
   }
 
-  /* Since we got everything we need, disconnect the call */
   sdpu_log_attribute_metrics(p_ccb->device_address, p_ccb->p_db);
-  sdp_disconnect(p_ccb, SDP_SUCCESS);
+  return SDP_SUCCESS;
+}
+
+/*******************************************************************************
+ *
+ * Function         get_db_state
+ *
+ * Description      This function extracts the ServiceDatabaseState from the
+ *                  response to the request of sdp_snd_db_state_req.
+ *
+ * Returns          true if the response holds a ServiceDatabaseState
+ *
+ ******************************************************************************/
+static bool get_db_state(uint8_t* p_reply, uint8_t* p_reply_end,
+                         uint32_t* p_db_state) {
+  uint16_t lists_byte_count;
+  uint32_t seq_len;
+  uint8_t type;
+
+  /* Skip transaction ID and length */
+  if (p_reply + 4 + sizeof(lists_byte_count) > p_reply_end) return false;
+  p_reply += 4;
+  BE_STREAM_TO_UINT16(lists_byte_count, p_reply);
+
+  /* The response is expected to be complete, without continuation */
+  uint8_t* p_end = p_reply + lists_byte_count;
+  if (p_end + 1 > p_reply_end || *p_end != 0) return false;
+
+  /* The attribute list of the SDP server record, in a sequence of lists */
+  for (int level = 0; level < 2; level++) {
+    if (p_reply >= p_end) return false;
+    type = *p_reply++;
+    if ((type >> 3) != DATA_ELE_SEQ_DESC_TYPE) return false;
+    p_reply = sdpu_get_len_from_type(p_reply, p_end, type, &seq_len);
+    if (p_reply == NULL || (p_reply + seq_len) > p_end) return false;
+    p_end = p_reply + seq_len;
+  }
+
+  /* The attribute ID, followed by the 32-bit state */
+  if (p_reply + 8 > p_end ||
+      p_reply[0] != ((UINT_DESC_TYPE << 3) | SIZE_TWO_BYTES) ||
+      ((p_reply[1] << 8) | p_reply[2]) != ATTR_ID_SERVICE_DATABASE_STATE ||
+      p_reply[3] != ((UINT_DESC_TYPE << 3) | SIZE_FOUR_BYTES))
+    return false;
+  p_reply += 4;
+  BE_STREAM_TO_UINT32(*p_db_state, p_reply);
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         process_db_state_rsp
+ *
+ * Description      This function is called when the SDP server responded to
+ *                  the request for its ServiceDatabaseState, with p_reply
+ *                  NULL if it sent an error. The cached response of the peer
+ *                  is used if the state did not change, otherwise the service
+ *                  search attribute request is sent.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void process_db_state_rsp(tCONN_CB* p_ccb, uint8_t* p_reply,
+                                 uint8_t* p_reply_end) {
+  const tSDP_DISC_CACHE* p_entry = sdp_disc_find_cache(*p_ccb);
+
+  p_ccb->db_state_read = true;
+  p_ccb->has_db_state =
+      p_reply && get_db_state(p_reply, p_reply_end, &p_ccb->db_state);
+
+  if (p_ccb->has_db_state && p_entry && p_entry->p_list &&
+      p_entry->db_state == p_ccb->db_state) {
+    SDP_TRACE_DEBUG("%s: using the cached response of peer %s", __func__,
+                    p_ccb->device_address.ToString().c_str());
+    osi_free(p_ccb->rsp_list);
+    p_ccb->rsp_list = (uint8_t*)osi_malloc(SDP_MAX_LIST_BYTE_COUNT);
+    memcpy(p_ccb->rsp_list, p_entry->p_list, p_entry->list_len);
+    p_ccb->list_len = p_entry->list_len;
+    sdp_disconnect(p_ccb, save_attr_list(p_ccb));
+    return;
+  }
+
+  p_ccb->disc_state = SDP_DISC_WAIT_SEARCH_ATTR;
+  process_service_search_attr_rsp(p_ccb, NULL, NULL);
+}
+
+/*******************************************************************************
+ *
+ * Function         is_same_search
+ *
+ * Description      This function checks if the UUID and attribute filters of
+ *                  a discovery database are the given ones.
+ *
+ * Returns          true if they are, else false
+ *
+ ******************************************************************************/
+static bool is_same_search(const tSDP_DISCOVERY_DB* p_db,
+                           uint16_t num_uuid_filters, const Uuid* uuid_filters,
+                           uint16_t num_attr_filters,
+                           const uint16_t* attr_filters) {
+  if (p_db->num_uuid_filters != num_uuid_filters ||
+      p_db->num_attr_filters != num_attr_filters)
+    return false;
+
+  for (uint16_t xx = 0; xx < num_uuid_filters; xx++) {
+    if (p_db->uuid_filters[xx] != uuid_filters[xx]) return false;
+  }
+  for (uint16_t xx = 0; xx < num_attr_filters; xx++) {
+    if (p_db->attr_filters[xx] != attr_filters[xx]) return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_disc_find_cache
+ *
+ * Description      This function finds the cached response of the peer to the
+ *                  same service search attribute request.
+ *
+ * Returns          Pointer to the entry, or NULL if not found.
+ *
+ ******************************************************************************/
+static tSDP_DISC_CACHE* sdp_disc_find_cache(const tCONN_CB& ccb) {
+  for (uint8_t xx = 0; xx < SDP_MAX_DISC_CACHE; xx++) {
+    tSDP_DISC_CACHE* p_entry = &sdp_cb.disc_cache[xx];
+    if (p_entry->in_use && p_entry->bd_addr == ccb.device_address &&
+        is_same_search(ccb.p_db, p_entry->num_uuid_filters,
+                       p_entry->uuid_filters, p_entry->num_attr_filters,
+                       p_entry->attr_filters))
+      return p_entry;
+  }
+  return NULL;
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_disc_store_cache
+ *
+ * Description      This function caches the response of the peer to a service
+ *                  search attribute request, with its ServiceDatabaseState.
+ *                  Only the absence of state is recorded for the peers
+ *                  without one.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_disc_store_cache(const tCONN_CB& ccb) {
+  tSDP_DISC_CACHE* p_entry = sdp_disc_find_cache(ccb);
+
+  /* Replace the oldest entry */
+  if (p_entry == NULL) {
+    p_entry = &sdp_cb.disc_cache[sdp_cb.next_disc_cache];
+    sdp_cb.next_disc_cache = (sdp_cb.next_disc_cache + 1) % SDP_MAX_DISC_CACHE;
+  }
+
+  osi_free_and_reset((void**)&p_entry->p_list);
+  p_entry->in_use = true;
+  p_entry->bd_addr = ccb.device_address;
+  p_entry->num_uuid_filters = ccb.p_db->num_uuid_filters;
+  std::copy(ccb.p_db->uuid_filters,
+            ccb.p_db->uuid_filters + ccb.p_db->num_uuid_filters,
+            p_entry->uuid_filters);
+  p_entry->num_attr_filters = ccb.p_db->num_attr_filters;
+  std::copy(ccb.p_db->attr_filters,
+            ccb.p_db->attr_filters + ccb.p_db->num_attr_filters,
+            p_entry->attr_filters);
+  p_entry->has_db_state = ccb.has_db_state;
+  p_entry->db_state = ccb.db_state;
+  p_entry->list_len = 0;
+
+  if (ccb.has_db_state) {
+    p_entry->p_list = (uint8_t*)osi_malloc(ccb.list_len);
+    memcpy(p_entry->p_list, ccb.rsp_list, ccb.list_len);
+    p_entry->list_len = ccb.list_len;
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_disc_complete_pend_ccbs
+ *
+ * Description      This function completes the service search attribute
+ *                  requests pending for the connection of a completed one,
+ *                  when they are identical. They are served with its
+ *                  response instead of querying the peer again.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void sdp_disc_complete_pend_ccbs(tCONN_CB& ccb) {
+  uint16_t xx;
+  tCONN_CB* p_ccb;
+
+  if (!ccb.is_attr_search || ccb.rsp_list == NULL) return;
+
+  for (xx = 0, p_ccb = sdp_cb.ccb; xx < SDP_MAX_CONNECTIONS; xx++, p_ccb++) {
+    if ((p_ccb->con_state == SDP_STATE_CONN_PEND) &&
+        (p_ccb->connection_id == ccb.connection_id) &&
+        (p_ccb->con_flags & SDP_FLAGS_IS_ORIG) && p_ccb->is_attr_search &&
+        p_ccb->device_address == ccb.device_address &&
+        p_ccb->p_db != ccb.p_db &&
+        is_same_search(p_ccb->p_db, ccb.p_db->num_uuid_filters,
+                       ccb.p_db->uuid_filters, ccb.p_db->num_attr_filters,
+                       ccb.p_db->attr_filters)) {
+      p_ccb->rsp_list = (uint8_t*)osi_malloc(SDP_MAX_LIST_BYTE_COUNT);
+      memcpy(p_ccb->rsp_list, ccb.rsp_list, ccb.list_len);
+      p_ccb->list_len = ccb.list_len;
+      sdpu_callback(*p_ccb, save_attr_list(p_ccb));
+      sdpu_release_ccb(*p_ccb);
+    }
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_disc_clear_cache
+ *
+ * Description      This function clears the cached peer responses.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void sdp_disc_clear_cache(void) {
+  for (uint8_t xx = 0; xx < SDP_MAX_DISC_CACHE; xx++) {
+    osi_free_and_reset((void**)&sdp_cb.disc_cache[xx].p_list);
+    sdp_cb.disc_cache[xx].in_use = false;
+  }
+  sdp_cb.next_disc_cache = 0;
 }
 
 /*******************************************************************************
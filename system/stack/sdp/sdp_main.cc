@@ -103,6 +103,8 @@ void sdp_free(void) {
     alarm_free(sdp_cb.ccb[i].sdp_conn_timer);
     sdp_cb.ccb[i].sdp_conn_timer = NULL;
   }
+  sdp_db_clear_attr_list_cache();
+  sdp_disc_clear_cache();
 }
 
 /*******************************************************************************
@@ -388,6 +390,7 @@ void sdp_disconnect(tCONN_CB* p_ccb, tSDP_REASON reason) {
   /* Check if we have a connection ID */
   if (ccb.connection_id != 0) {
     ccb.disconnect_reason = reason;
+    if (SDP_SUCCESS == reason) sdp_disc_complete_pend_ccbs(ccb);
     if (SDP_SUCCESS == reason && sdpu_process_pend_ccb_same_cid(*p_ccb)) {
       sdpu_callback(ccb, reason);
       sdpu_release_ccb(ccb);
@@ -27,6 +27,7 @@
 #include <log/log.h>
 #include <string.h>  // memcpy
 
+#include <algorithm>
 #include <cstdint>
 
 #include "btif/include/btif_config.h"
@@ -58,6 +59,10 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
                                             uint16_t param_len, uint8_t* p_req,
                                             uint8_t* p_req_end);
 
+static void send_service_search_attr_rsp(tCONN_CB* p_ccb, uint16_t trans_num,
+                                         const uint8_t* p_list,
+                                         uint16_t len_to_send);
+
 /******************************************************************************/
 /*                E R R O R   T E X T   S T R I N G S                         */
 /*                                                                            */
@@ -562,8 +567,8 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
   int16_t rem_len;
   uint16_t len_to_send, cont_offset;
   tSDP_UUID_SEQ uid_seq;
-  uint8_t *p_rsp, *p_rsp_start, *p_rsp_param_len;
-  uint16_t rsp_param_len, xx;
+  uint8_t* p_rsp;
+  uint16_t xx;
   const tSDP_RECORD* p_rec;
   tSDP_ATTR_SEQ attr_seq, attr_seq_sav;
   const tSDP_ATTRIBUTE* p_attr;
@@ -604,16 +609,61 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
     return;
   }
 
-  /* Free and reallocate buffer */
-  osi_free(p_ccb->rsp_list);
-  p_ccb->rsp_list = (uint8_t*)osi_malloc(max_list_len);
-
   /* Check if this is a continuation request */
   if (p_req + 1 > p_req_end) {
     sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
                             SDP_TEXT_BAD_CONT_LEN);
     return;
   }
+
+  /* The first request copied the whole response from the cache, the
+   * continuation requests only slice it */
+  if (*p_req && p_ccb->rsp_list_complete) {
+    if (*p_req++ != SDP_CONTINUATION_LEN ||
+        (p_req + sizeof(uint16_t) > p_req_end)) {
+      sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
+                              SDP_TEXT_BAD_CONT_LEN);
+      return;
+    }
+    BE_STREAM_TO_UINT16(cont_offset, p_req);
+
+    if (cont_offset != p_ccb->cont_offset || cont_offset >= p_ccb->list_len) {
+      sdpu_build_n_send_error(p_ccb, trans_num, SDP_INVALID_CONT_STATE,
+                              SDP_TEXT_BAD_CONT_INX);
+      return;
+    }
+    len_to_send =
+        std::min<uint16_t>(p_ccb->list_len - cont_offset, max_list_len);
+    send_service_search_attr_rsp(p_ccb, trans_num,
+                                 &p_ccb->rsp_list[cont_offset], len_to_send);
+    return;
+  }
+  p_ccb->rsp_list_complete = false;
+
+  if (!*p_req) {
+    uint16_t list_len;
+    const uint8_t* p_list =
+        sdp_db_get_attr_list(&uid_seq, &attr_seq, &list_len);
+    if (p_list) {
+      /* Keep a copy, the cache may be cleared before the continuation */
+      osi_free(p_ccb->rsp_list);
+      p_ccb->rsp_list = (uint8_t*)osi_malloc(list_len);
+      memcpy(p_ccb->rsp_list, p_list, list_len);
+      p_ccb->list_len = list_len;
+      p_ccb->cont_offset = 0;
+      p_ccb->rsp_list_complete = true;
+
+      len_to_send = std::min(list_len, max_list_len);
+      send_service_search_attr_rsp(p_ccb, trans_num, p_ccb->rsp_list,
+                                   len_to_send);
+      return;
+    }
+  }
+
+  /* Free and reallocate buffer */
+  osi_free(p_ccb->rsp_list);
+  p_ccb->rsp_list = (uint8_t*)osi_malloc(max_list_len);
+
   if (*p_req) {
     if (*p_req++ != SDP_CONTINUATION_LEN ||
         (p_req + sizeof(uint16_t) > p_req_end)) {
@@ -817,6 +867,27 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
     }
   }
 
+  send_service_search_attr_rsp(p_ccb, trans_num, &p_ccb->rsp_list[cont_offset],
+                               len_to_send);
+}
+
+/*******************************************************************************
+ *
+ * Function         send_service_search_attr_rsp
+ *
+ * Description      This function sends the next part of the attribute lists
+ *                  of a ServiceSearchAttribute response, with a continuation
+ *                  state if some of the list_len bytes remain to be sent.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void send_service_search_attr_rsp(tCONN_CB* p_ccb, uint16_t trans_num,
+                                         const uint8_t* p_list,
+                                         uint16_t len_to_send) {
+  uint8_t *p_rsp, *p_rsp_start, *p_rsp_param_len;
+  uint16_t rsp_param_len;
+
   /* Get a buffer to use to build the response */
   BT_HDR* p_buf = (BT_HDR*)osi_malloc(SDP_DATA_BUF_SIZE);
   p_buf->offset = L2CAP_MIN_OFFSET;
@@ -834,15 +905,13 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
   UINT16_TO_BE_STREAM(p_rsp, len_to_send);
 
   /* copy from rsp_list to the actual buffer to be sent */
-  memcpy(p_rsp, &p_ccb->rsp_list[cont_offset], len_to_send);
+  memcpy(p_rsp, p_list, len_to_send);
   p_rsp += len_to_send;
 
   p_ccb->cont_offset += len_to_send;
 
   /* If anything left to send, continuation needed */
   if (p_ccb->cont_offset < p_ccb->list_len) {
-    is_cont = true;
-
     UINT8_TO_BE_STREAM(p_rsp, SDP_CONTINUATION_LEN);
     UINT16_TO_BE_STREAM(p_rsp, p_ccb->cont_offset);
   } else
@@ -55,6 +55,15 @@
 #define MAX_UUIDS_PER_SEQ 16
 #define MAX_ATTR_PER_SEQ 16
 
+/* Max UUIDs indexed per record of the SDP database */
+#define SDP_MAX_REC_UUIDS 16
+
+/* Number of ServiceSearchAttribute responses cached by the SDP server */
+#define SDP_MAX_CACHED_ATTR_LISTS 4
+
+/* Number of peer ServiceSearchAttribute responses cached by the SDP client */
+#define SDP_MAX_DISC_CACHE 8
+
 /* Max length we support for any attribute */
 #ifdef SDP_MAX_ATTR_LEN
 #define MAX_ATTR_LEN SDP_MAX_ATTR_LEN
@@ -97,16 +106,35 @@ typedef struct {
   uint32_t record_handle;
   uint32_t free_pad_ptr;
   uint16_t num_attributes;
-  tSDP_ATTRIBUTE attribute[SDP_MAX_REC_ATTR];
+  tSDP_ATTRIBUTE attribute[SDP_MAX_REC_ATTR]; /* Sorted by attribute ID */
   uint8_t attr_pad[SDP_MAX_PAD_LEN];
+
+  /* The UUIDs found in the attributes, in 128-bit form. If they do not all
+  ** fit, uuids_overflow is set and the attributes are searched instead */
+  uint16_t num_uuids;
+  bool uuids_overflow;
+  bluetooth::Uuid uuids[SDP_MAX_REC_UUIDS];
 } tSDP_RECORD;
 
+/* Attribute lists of the response to a ServiceSearchAttribute request,
+** serialized with their data element sequence header */
+typedef struct {
+  tSDP_UUID_SEQ uid_seq;
+  tSDP_ATTR_SEQ attr_seq;
+  uint16_t list_len;
+  uint8_t* p_list; /* NULL if the entry is unused */
+} tSDP_ATTR_LIST_CACHE;
+
 /* Define the SDP database */
 typedef struct {
   uint32_t
       di_primary_handle; /* Device ID Primary record or NULL if nonexistent */
   uint16_t num_records;
   tSDP_RECORD record[SDP_MAX_RECORDS];
+
+  /* Responses cleared whenever the database is modified */
+  tSDP_ATTR_LIST_CACHE attr_list_cache[SDP_MAX_CACHED_ATTR_LISTS];
+  uint8_t next_attr_list_cache; /* Entry replaced by the next response */
 } tSDP_DB;
 
 /* Continuation information for the SDP server response */
@@ -159,6 +187,7 @@ struct tCONN_CB {
 #define SDP_DISC_WAIT_HANDLES 1
 #define SDP_DISC_WAIT_ATTR 2
 #define SDP_DISC_WAIT_SEARCH_ATTR 3
+#define SDP_DISC_WAIT_DB_STATE 4
 #define SDP_DISC_WAIT_CANCEL 5
 
   uint8_t disc_state;
@@ -167,12 +196,35 @@ struct tCONN_CB {
   uint16_t cont_offset;     /* Continuation state data in the server response */
   tSDP_CONT_INFO cont_info; /* structure to hold continuation information for
                                the server response */
+  bool rsp_list_complete;   /* rsp_list holds the whole list_len bytes of a
+                               cached ServiceSearchAttribute response */
+
+  bool db_state_read; /* The ServiceDatabaseState of the peer was read */
+  bool has_db_state;  /* The peer has a ServiceDatabaseState */
+  uint32_t db_state;
   tCONN_CB() = default;
 
  private:
   tCONN_CB(const tCONN_CB&) = delete;
 };
 
+/* Response of a peer to a ServiceSearchAttribute request, reused by the
+** next identical requests while the ServiceDatabaseState of the peer does not
+** change. The peers without a ServiceDatabaseState get an entry without
+** response, so that it is not read again */
+typedef struct {
+  bool in_use;
+  RawAddress bd_addr;
+  uint16_t num_uuid_filters;
+  bluetooth::Uuid uuid_filters[SDP_MAX_UUID_FILTERS];
+  uint16_t num_attr_filters;
+  uint16_t attr_filters[SDP_MAX_ATTR_FILTERS];
+  bool has_db_state;
+  uint32_t db_state;
+  uint16_t list_len;
+  uint8_t* p_list;
+} tSDP_DISC_CACHE;
+
 /*  The main SDP control block */
 typedef struct {
   tL2CAP_CFG_INFO l2cap_my_cfg; /* My L2CAP config     */
@@ -182,6 +234,8 @@ typedef struct {
   uint16_t max_attr_list_size;  /* Max attribute list size to use   */
   uint16_t max_recs_per_search; /* Max records we want per seaarch  */
   uint8_t trace_level;
+  tSDP_DISC_CACHE disc_cache[SDP_MAX_DISC_CACHE];
+  uint8_t next_disc_cache; /* Entry replaced by the next peer response */
 } tSDP_CB;
 
 /* Global SDP data */
@@ -254,6 +308,10 @@ extern tSDP_RECORD* sdp_db_find_record(uint32_t handle);
 extern const tSDP_ATTRIBUTE* sdp_db_find_attr_in_rec(const tSDP_RECORD* p_rec,
                                                      uint16_t start_attr,
                                                      uint16_t end_attr);
+extern const uint8_t* sdp_db_get_attr_list(const tSDP_UUID_SEQ* uid_seq,
+                                           const tSDP_ATTR_SEQ* attr_seq,
+                                           uint16_t* p_list_len);
+extern void sdp_db_clear_attr_list_cache(void);
 
 /* Functions provided by sdp_server.cc
  */
@@ -263,5 +321,7 @@ extern void sdp_server_handle_client_req(tCONN_CB* p_ccb, BT_HDR* p_msg);
  */
 extern void sdp_disc_connected(tCONN_CB* p_ccb);
 extern void sdp_disc_server_rsp(tCONN_CB* p_ccb, BT_HDR* p_msg);
+extern void sdp_disc_complete_pend_ccbs(tCONN_CB& ccb);
+extern void sdp_disc_clear_cache(void);
 
 #endif
@@ -0,0 +1,526 @@
+/******************************************************************************
+ *
+ *  Copyright 2023 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *
+ *  This file contains the P-256 point multiplication on 64-bit limbs, in the
+ *  Montgomery domain. The secret scalar only selects table entries through
+ *  masks, so its bits do not change the sequence of operations or memory
+ *  accesses:
+ *   - any point is multiplied with fixed 4-bit windows, 4 doublings and one
+ *     addition of a table entry per window;
+ *   - the generator is multiplied with a 4-teeth comb over a precomputed
+ *     table, one doubling and one mixed addition per bit of a quarter of the
+ *     scalar.
+ *
+ ******************************************************************************/
+#include <string.h>
+
+#include "p_256_ecc_pp.h"
+
+namespace {
+
+// Field elements modulo p, or scalars, in little endian 64-bit limbs
+typedef uint64_t felem[4];
+
+// Jacobian point, at infinity when z is zero
+struct jac_point {
+  felem x;
+  felem y;
+  felem z;
+};
+
+// Affine point
+struct aff_point {
+  felem x;
+  felem y;
+};
+
+// p = 2^256 - 2^224 + 2^192 + 2^96 - 1
+const felem kP = {0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000,
+                  0xffffffff00000001};
+// R^2 mod p, with R = 2^256, to convert to the Montgomery domain
+const felem kRR = {0x0000000000000003, 0xfffffffbffffffff, 0xfffffffffffffffe,
+                   0x00000004fffffffd};
+// R mod p, i.e. 1 in the Montgomery domain
+const felem kOne = {0x0000000000000001, 0xffffffff00000000,
+                    0xffffffffffffffff, 0x00000000fffffffe};
+
+// Returns a + b + carry in |r|, and the carry out
+inline uint64_t addc(uint64_t a, uint64_t b, uint64_t carry, uint64_t* r) {
+  uint64_t s = a + carry;
+  uint64_t c = s < carry;
+  s += b;
+  c += s < b;
+  *r = s;
+  return c;
+}
+
+// Returns a - b - borrow in |r|, and the borrow out
+inline uint64_t subb(uint64_t a, uint64_t b, uint64_t borrow, uint64_t* r) {
+  uint64_t d = a - b;
+  uint64_t bo = a < b;
+  *r = d - borrow;
+  bo |= d < borrow;
+  return bo;
+}
+
+// Returns the high half of a * b, and the low half in |lo|
+inline uint64_t mul64(uint64_t a, uint64_t b, uint64_t* lo) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 m = (unsigned __int128)a * b;
+  *lo = (uint64_t)m;
+  return (uint64_t)(m >> 64);
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t ll = a_lo * b_lo;
+  uint64_t lh = a_lo * b_hi;
+  uint64_t hl = a_hi * b_lo;
+  uint64_t hh = a_hi * b_hi;
+  uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+  *lo = (mid << 32) | (uint32_t)ll;
+  return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+// All ones if |a| is zero, otherwise zero
+inline uint64_t is_zero_mask(uint64_t a) {
+  return ((~a & (a - 1)) >> 63) * ~(uint64_t)0;
+}
+
+inline uint64_t felem_is_zero_mask(const felem a) {
+  return is_zero_mask(a[0] | a[1] | a[2] | a[3]);
+}
+
+// r = a if mask is all ones, unchanged if mask is zero
+inline void felem_cmov(felem r, const felem a, uint64_t mask) {
+  for (int i = 0; i < 4; i++) r[i] ^= mask & (r[i] ^ a[i]);
+}
+
+void point_cmov(jac_point* r, const jac_point* a, uint64_t mask) {
+  felem_cmov(r->x, a->x, mask);
+  felem_cmov(r->y, a->y, mask);
+  felem_cmov(r->z, a->z, mask);
+}
+
+// r = t - p if t + carry * 2^256 >= p, otherwise t. t + carry * 2^256 must
+// be less than 2p.
+void felem_reduce_once(felem r, const felem t, uint64_t carry) {
+  felem d;
+  uint64_t borrow = 0;
+  for (int i = 0; i < 4; i++) borrow = subb(t[i], kP[i], borrow, &d[i]);
+  // t is kept when it is less than p, i.e. when there is no carry and the
+  // subtraction borrows
+  uint64_t keep = ~(uint64_t)0 * ((carry ^ 1) & borrow);
+  for (int i = 0; i < 4; i++) r[i] = (t[i] & keep) | (d[i] & ~keep);
+}
+
+void felem_add(felem r, const felem a, const felem b) {
+  felem t;
+  uint64_t carry = 0;
+  for (int i = 0; i < 4; i++) carry = addc(a[i], b[i], carry, &t[i]);
+  felem_reduce_once(r, t, carry);
+}
+
+void felem_sub(felem r, const felem a, const felem b) {
+  uint64_t borrow = 0;
+  for (int i = 0; i < 4; i++) borrow = subb(a[i], b[i], borrow, &r[i]);
+  // Add p back if the subtraction borrowed
+  uint64_t mask = ~(uint64_t)0 * borrow;
+  uint64_t carry = 0;
+  for (int i = 0; i < 4; i++) carry = addc(r[i], kP[i] & mask, carry, &r[i]);
+}
+
+// r = a * b / R mod p, with a < 2^256 and b < p
+void felem_mul(felem r, const felem a, const felem b) {
+  felem t = {0, 0, 0, 0};
+  uint64_t t4 = 0;
+  for (int i = 0; i < 4; i++) {
+    uint64_t lo, hi, c;
+    uint64_t carry = 0;
+    // t += a * b[i]
+    for (int j = 0; j < 4; j++) {
+      hi = mul64(a[j], b[i], &lo);
+      c = addc(t[j], lo, 0, &t[j]);
+      c += addc(t[j], carry, 0, &t[j]);
+      carry = hi + c;
+    }
+    uint64_t t5 = addc(t4, carry, 0, &t4);
+
+    // t = (t + m * p) / 2^64, with m = t[0] since -1 / p = 1 mod 2^64
+    uint64_t m = t[0];
+    carry = 0;
+    for (int j = 0; j < 4; j++) {
+      hi = mul64(m, kP[j], &lo);
+      c = addc(t[j], lo, 0, &lo);
+      c += addc(lo, carry, 0, &lo);
+      carry = hi + c;
+      if (j > 0) t[j - 1] = lo;
+    }
+    t4 = t5 + addc(t4, carry, 0, &t[3]);
+  }
+  felem_reduce_once(r, t, t4);
+}
+
+void felem_sqr(felem r, const felem a) { felem_mul(r, a, a); }
+
+void felem_sqr_n(felem r, const felem a, int n) {
+  felem_sqr(r, a);
+  for (int i = 1; i < n; i++) felem_sqr(r, r);
+}
+
+// r = 1 / a mod p, as a^(p - 2), in the Montgomery domain. e[k] below is
+// a^(2^k - 1).
+void felem_inv(felem r, const felem a) {
+  felem e2, e3, e6, e12, e15, e30, e32, t;
+  felem_sqr(t, a);
+  felem_mul(e2, t, a);
+  felem_sqr(t, e2);
+  felem_mul(e3, t, a);
+  felem_sqr_n(t, e3, 3);
+  felem_mul(e6, t, e3);
+  felem_sqr_n(t, e6, 6);
+  felem_mul(e12, t, e6);
+  felem_sqr_n(t, e12, 3);
+  felem_mul(e15, t, e3);
+  felem_sqr_n(t, e15, 15);
+  felem_mul(e30, t, e15);
+  felem_sqr_n(t, e30, 2);
+  felem_mul(e32, t, e2);
+
+  // p - 2 = ffffffff 00000001 00000000 00000000 00000000 ffffffff ffffffff
+  //         fffffffd
+  felem_sqr_n(t, e32, 32);
+  felem_mul(t, t, a);
+  felem_sqr_n(t, t, 128);
+  felem_mul(t, t, e32);
+  felem_sqr_n(t, t, 32);
+  felem_mul(t, t, e32);
+  felem_sqr_n(t, t, 30);
+  felem_mul(t, t, e30);
+  felem_sqr_n(t, t, 2);
+  felem_mul(r, t, a);
+}
+
+void felem_from_words(felem r, const uint32_t* w) {
+  for (int i = 0; i < 4; i++)
+    r[i] = (uint64_t)w[2 * i] | ((uint64_t)w[2 * i + 1] << 32);
+}
+
+void felem_to_words(uint32_t* w, const felem a) {
+  for (int i = 0; i < 4; i++) {
+    w[2 * i] = (uint32_t)a[i];
+    w[2 * i + 1] = (uint32_t)(a[i] >> 32);
+  }
+}
+
+void felem_to_mont(felem r, const uint32_t* w) {
+  felem a;
+  felem_from_words(a, w);
+  felem_mul(r, a, kRR);
+}
+
+void felem_from_mont(uint32_t* w, const felem a) {
+  const felem one = {1, 0, 0, 0};
+  felem r;
+  felem_mul(r, a, one);
+  felem_to_words(w, r);
+}
+
+// r = 2p, for a = -3 (dbl-2001-b)
+void point_double(jac_point* r, const jac_point* p) {
+  felem delta, gamma, beta, alpha, t1, t2;
+  felem_sqr(delta, p->z);
+  felem_sqr(gamma, p->y);
+  felem_mul(beta, p->x, gamma);
+
+  // alpha = 3 * (x - delta) * (x + delta)
+  felem_sub(t1, p->x, delta);
+  felem_add(t2, p->x, delta);
+  felem_mul(alpha, t1, t2);
+  felem_add(t1, alpha, alpha);
+  felem_add(alpha, t1, alpha);
+
+  // z3 = (y + z)^2 - gamma - delta
+  felem_add(t1, p->y, p->z);
+  felem_sqr(t1, t1);
+  felem_sub(t1, t1, gamma);
+  felem_sub(r->z, t1, delta);
+
+  // x3 = alpha^2 - 8 * beta
+  felem_add(beta, beta, beta);
+  felem_add(beta, beta, beta);
+  felem_add(t2, beta, beta);
+  felem_sqr(t1, alpha);
+  felem_sub(r->x, t1, t2);
+
+  // y3 = alpha * (4 * beta - x3) - 8 * gamma^2
+  felem_sub(t1, beta, r->x);
+  felem_mul(t1, alpha, t1);
+  felem_sqr(gamma, gamma);
+  felem_add(gamma, gamma, gamma);
+  felem_add(gamma, gamma, gamma);
+  felem_add(gamma, gamma, gamma);
+  felem_sub(r->y, t1, gamma);
+}
+
+// r = p + q (add-2007-bl). When p or q is at infinity the other one is
+// selected with masks. Adding a point to itself is the only case that
+// branches: the windowed multiplications never reach it with scalars smaller
+// than the order of the curve.
+void point_add(jac_point* r, const jac_point* p, const jac_point* q) {
+  felem z1z1, z2z2, u1, u2, s1, s2, h, i, j, rr, v, t;
+  jac_point out;
+
+  felem_sqr(z1z1, p->z);
+  felem_sqr(z2z2, q->z);
+  felem_mul(u1, p->x, z2z2);
+  felem_mul(u2, q->x, z1z1);
+  felem_mul(s1, p->y, q->z);
+  felem_mul(s1, s1, z2z2);
+  felem_mul(s2, q->y, p->z);
+  felem_mul(s2, s2, z1z1);
+
+  felem_sub(h, u2, u1);
+  felem_sub(rr, s2, s1);
+  felem_add(rr, rr, rr);
+
+  uint64_t p_inf = felem_is_zero_mask(p->z);
+  uint64_t q_inf = felem_is_zero_mask(q->z);
+  if (felem_is_zero_mask(h) & felem_is_zero_mask(rr) & ~p_inf & ~q_inf) {
+    point_double(r, p);
+    return;
+  }
+
+  felem_add(i, h, h);
+  felem_sqr(i, i);
+  felem_mul(j, h, i);
+  felem_mul(v, u1, i);
+
+  // x3 = r^2 - j - 2 * v
+  felem_sqr(out.x, rr);
+  felem_sub(out.x, out.x, j);
+  felem_sub(out.x, out.x, v);
+  felem_sub(out.x, out.x, v);
+
+  // y3 = r * (v - x3) - 2 * s1 * j
+  felem_sub(t, v, out.x);
+  felem_mul(t, rr, t);
+  felem_mul(s1, s1, j);
+  felem_add(s1, s1, s1);
+  felem_sub(out.y, t, s1);
+
+  // z3 = ((z1 + z2)^2 - z1z1 - z2z2) * h
+  felem_add(t, p->z, q->z);
+  felem_sqr(t, t);
+  felem_sub(t, t, z1z1);
+  felem_sub(t, t, z2z2);
+  felem_mul(out.z, t, h);
+
+  point_cmov(&out, q, p_inf);
+  point_cmov(&out, p, q_inf);
+  memcpy(r, &out, sizeof(out));
+}
+
+// r = p + q (madd-2007-bl), with q affine and not at infinity. When p is at
+// infinity q is selected with masks. Adding a point to itself branches as in
+// point_add().
+void point_add_affine(jac_point* r, const jac_point* p, const aff_point* q) {
+  felem z1z1, u2, s2, h, hh, i, j, rr, v, t;
+  jac_point out;
+
+  felem_sqr(z1z1, p->z);
+  felem_mul(u2, q->x, z1z1);
+  felem_mul(s2, q->y, p->z);
+  felem_mul(s2, s2, z1z1);
+
+  felem_sub(h, u2, p->x);
+  felem_sub(rr, s2, p->y);
+  felem_add(rr, rr, rr);
+
+  uint64_t p_inf = felem_is_zero_mask(p->z);
+  if (felem_is_zero_mask(h) & felem_is_zero_mask(rr) & ~p_inf) {
+    point_double(r, p);
+    return;
+  }
+
+  felem_sqr(hh, h);
+  felem_add(i, hh, hh);
+  felem_add(i, i, i);
+  felem_mul(j, h, i);
+  felem_mul(v, p->x, i);
+
+  // x3 = r^2 - j - 2 * v
+  felem_sqr(out.x, rr);
+  felem_sub(out.x, out.x, j);
+  felem_sub(out.x, out.x, v);
+  felem_sub(out.x, out.x, v);
+
+  // y3 = r * (v - x3) - 2 * y1 * j
+  felem_sub(t, v, out.x);
+  felem_mul(t, rr, t);
+  felem_mul(j, p->y, j);
+  felem_add(j, j, j);
+  felem_sub(out.y, t, j);
+
+  // z3 = (z1 + h)^2 - z1z1 - hh
+  felem_add(t, p->z, h);
+  felem_sqr(t, t);
+  felem_sub(t, t, z1z1);
+  felem_sub(out.z, t, hh);
+
+  jac_point q_jac;
+  memcpy(q_jac.x, q->x, sizeof(felem));
+  memcpy(q_jac.y, q->y, sizeof(felem));
+  memcpy(q_jac.z, kOne, sizeof(felem));
+  point_cmov(&out, &q_jac, p_inf);
+  memcpy(r, &out, sizeof(out));
+}
+
+// Returns the digit of |n| made of |count| bits, |stride| bits apart, from
+// bit |pos|
+uint32_t scalar_digit(const uint32_t* n, int pos, int stride, int count) {
+  uint32_t digit = 0;
+  for (int i = 0; i < count; i++) {
+    int bit = pos + i * stride;
+    digit |= ((n[bit / 32] >> (bit % 32)) & 1) << i;
+  }
+  return digit;
+}
+
+// Loads entry |digit| of |table|, which holds the multiples 1 to 15, by
+// reading all of them. Loads entry 1 for digit 0.
+void table_select(jac_point* r, const jac_point* table, uint32_t digit) {
+  memcpy(r, &table[0], sizeof(*r));
+  for (uint32_t i = 2; i <= 15; i++) {
+    uint64_t mask = is_zero_mask(i ^ digit);
+    point_cmov(r, &table[i - 1], mask);
+  }
+}
+
+void table_select_affine(aff_point* r, const aff_point* table,
+                         uint32_t digit) {
+  memcpy(r, &table[0], sizeof(*r));
+  for (uint32_t i = 2; i <= 15; i++) {
+    uint64_t mask = is_zero_mask(i ^ digit);
+    felem_cmov(r->x, table[i - 1].x, mask);
+    felem_cmov(r->y, table[i - 1].y, mask);
+  }
+}
+
+void point_to_affine(aff_point* r, const jac_point* p) {
+  felem zinv, zinv2;
+  felem_inv(zinv, p->z);
+  felem_sqr(zinv2, zinv);
+  felem_mul(r->x, p->x, zinv2);
+  felem_mul(zinv2, zinv2, zinv);
+  felem_mul(r->y, p->y, zinv2);
+}
+
+// Comb table of the generator: entry b - 1 is the sum of 2^(64 i) G over
+// the bits i set in b, for b from 1 to 15
+struct comb_table {
+  aff_point points[15];
+};
+
+const comb_table* get_comb_table() {
+  static const comb_table* table = [] {
+    comb_table* t = new comb_table;
+    jac_point teeth[4];
+    p_256_init_curve();
+    felem_to_mont(teeth[0].x, curve_p256.G.x);
+    felem_to_mont(teeth[0].y, curve_p256.G.y);
+    memcpy(teeth[0].z, kOne, sizeof(felem));
+    for (int i = 1; i < 4; i++) {
+      memcpy(&teeth[i], &teeth[i - 1], sizeof(jac_point));
+      for (int j = 0; j < 64; j++) point_double(&teeth[i], &teeth[i]);
+    }
+    jac_point sums[15];
+    for (int b = 1; b <= 15; b++) {
+      int low = b & -b;
+      int tooth = __builtin_ctz(b);
+      if (b == low) {
+        memcpy(&sums[b - 1], &teeth[tooth], sizeof(jac_point));
+      } else {
+        point_add(&sums[b - 1], &sums[b - low - 1], &teeth[tooth]);
+      }
+      point_to_affine(&t->points[b - 1], &sums[b - 1]);
+    }
+    return t;
+  }();
+  return table;
+}
+
+void mult_generator(jac_point* r, const uint32_t* n) {
+  const comb_table* table = get_comb_table();
+  jac_point sum;
+  aff_point entry;
+
+  memset(r, 0, sizeof(*r));
+  for (int pos = 63; pos >= 0; pos--) {
+    point_double(r, r);
+    uint32_t digit = scalar_digit(n, pos, 64, 4);
+    table_select_affine(&entry, table->points, digit);
+    point_add_affine(&sum, r, &entry);
+    point_cmov(r, &sum, ~is_zero_mask(digit));
+  }
+}
+
+void mult_point(jac_point* r, const jac_point* p, const uint32_t* n) {
+  jac_point table[15];
+  jac_point sum;
+  jac_point entry;
+
+  memcpy(&table[0], p, sizeof(*p));
+  point_double(&table[1], p);
+  for (int i = 2; i < 15; i++) point_add(&table[i], &table[i - 1], p);
+
+  memset(r, 0, sizeof(*r));
+  for (int pos = 252; pos >= 0; pos -= 4) {
+    for (int i = 0; i < 4; i++) point_double(r, r);
+    uint32_t digit = scalar_digit(n, pos, 1, 4);
+    table_select(&entry, table, digit);
+    point_add(&sum, r, &entry);
+    point_cmov(r, &sum, ~is_zero_mask(digit));
+  }
+}
+
+}  // namespace
+
+void ECC_PointMult_Mont64(Point* q, const Point* p, const uint32_t* n) {
+  jac_point r;
+
+  if (memcmp(p->x, curve_p256.G.x, sizeof(p->x)) == 0 &&
+      memcmp(p->y, curve_p256.G.y, sizeof(p->y)) == 0) {
+    mult_generator(&r, n);
+  } else {
+    jac_point base;
+    felem_to_mont(base.x, p->x);
+    felem_to_mont(base.y, p->y);
+    memcpy(base.z, kOne, sizeof(felem));
+    mult_point(&r, &base, n);
+  }
+
+  aff_point out;
+  point_to_affine(&out, &r);
+  felem_from_mont(q->x, out.x);
+  felem_from_mont(q->y, out.y);
+  multiprecision_init(q->z);
+  q->z[0] = 1;
+}
@@ -31,6 +31,8 @@
 elliptic_curve_t curve;
 elliptic_curve_t curve_p256;
 
+static tECC_IMPL point_mult_impl = ECC_IMPL_MONT64;
+
 static void p_256_init_point(Point* q) { memset(q, 0, sizeof(Point)); }
 
 static void p_256_copy_point(Point* q, Point* p) {
@@ -240,6 +242,16 @@ void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n) {
   multiprecision_mersenns_mult_mod(q->y, q->y, q->z);
 }
 
+void ECC_SetPointMultImpl(tECC_IMPL impl) { point_mult_impl = impl; }
+
+void ECC_PointMult(Point* q, Point* p, uint32_t* n) {
+  if (point_mult_impl == ECC_IMPL_REFERENCE) {
+    ECC_PointMult_Bin_NAF(q, p, n);
+  } else {
+    ECC_PointMult_Mont64(q, p, n);
+  }
+}
+
 bool ECC_ValidatePoint(const Point& pt) {
   p_256_init_curve();
 
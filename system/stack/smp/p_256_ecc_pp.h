@@ -58,8 +58,25 @@ extern elliptic_curve_t curve_p256;
 
 bool ECC_ValidatePoint(const Point& p);
 
+// Implementations of the point multiplication
+typedef enum {
+  // ECC_PointMult_Bin_NAF(), the reference implementation
+  ECC_IMPL_REFERENCE,
+  // ECC_PointMult_Mont64(), in constant time on 64-bit limbs
+  ECC_IMPL_MONT64,
+} tECC_IMPL;
+
+// Selects the implementation of ECC_PointMult(), ECC_IMPL_MONT64 by default
+void ECC_SetPointMultImpl(tECC_IMPL impl);
+
+// q = n * p, with q and p in affine coordinates
+void ECC_PointMult(Point* q, Point* p, uint32_t* n);
+
+// Binary Non-Adjacent Form point multiplication. Overwrites p->z and n.
 void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n);
 
-#define ECC_PointMult(q, p, n) ECC_PointMult_Bin_NAF(q, p, n)
+// Fixed window point multiplication, with a precomputed comb for the
+// generator, in constant time with respect to n
+void ECC_PointMult_Mont64(Point* q, const Point* p, const uint32_t* n);
 
 void p_256_init_curve();
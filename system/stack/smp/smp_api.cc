@@ -34,6 +34,7 @@
 #include "l2c_api.h"
 #include "l2cdefs.h"
 #include "main/shim/shim.h"
+#include "osi/include/properties.h"
 #include "p_256_ecc_pp.h"
 #include "smp_int.h"
 #include "stack/btm/btm_dev.h"
@@ -70,6 +71,13 @@ void SMP_Init(void) {
   smp_l2cap_if_init();
   /* initialization of P-256 parameters */
   p_256_init_curve();
+  /* The reference point multiplication can be selected for comparison */
+  ECC_SetPointMultImpl(
+      osi_property_get_bool("bluetooth.smp.ecc_reference.enabled", false)
+          ? ECC_IMPL_REFERENCE
+          : ECC_IMPL_MONT64);
+  /* The local key pair of the next pairing is computed in the background */
+  smp_start_key_thread();
 
   /* Initialize failure case for certification */
   smp_cb.cert_failure = static_cast<tSMP_STATUS>(
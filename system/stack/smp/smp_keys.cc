@@ -26,13 +26,16 @@
 
 #include <algorithm>
 #include <cstring>
+#include <optional>
 
 #include "bt_target.h"
 #include "bt_utils.h"
 #include "btm_ble_api.h"
 #include "btm_ble_int.h"
+#include "common/message_loop_thread.h"
 #include "device/include/controller.h"
 #include "osi/include/osi.h"
+#include "osi/include/properties.h"
 #include "p_256_ecc_pp.h"
 #include "smp_int.h"
 #include "stack/btm/btm_dev.h"
@@ -40,6 +43,7 @@
 #include "stack/crypto_toolbox/crypto_toolbox.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/bt_octets.h"
+#include "stack/include/btu.h"
 #include "types/raw_address.h"
 
 extern tBTM_CB btm_cb;  // TODO Remove
@@ -54,9 +58,24 @@ using crypto_toolbox::aes_128;
 static void smp_process_stk(tSMP_CB* p_cb, Octet16* p);
 static Octet16 smp_calculate_legacy_short_term_key(tSMP_CB* p_cb);
 static void smp_process_private_key(tSMP_CB* p_cb);
+static void smp_local_public_key_created(tSMP_CB* p_cb);
 
 #define SMP_PASSKEY_MASK 0xfff00000
 
+/* Local key pair computed in the background for the next pairing, so that the
+ * pairing neither waits for the random octets of the controller nor for the
+ * point multiplication */
+typedef struct {
+  BT_OCTET32 private_key;
+  tSMP_PUBLIC_KEY public_key;
+} tSMP_KEY_PAIR;
+
+static bluetooth::common::MessageLoopThread* smp_key_thread = nullptr;
+static std::optional<tSMP_KEY_PAIR> smp_next_key_pair;
+static bool smp_next_key_pair_pending = false;
+/* Private key being filled by the controller, while pending */
+static tSMP_KEY_PAIR smp_pending_key_pair;
+
 // If there is data saved here, then use its info instead
 // This needs to be cleared on a successfult pairing using the oob data
 static tSMP_LOC_OOB_DATA saved_local_oob_data = {};
@@ -576,14 +595,107 @@ Octet16 smp_calculate_legacy_short_term_key(tSMP_CB* p_cb) {
   return aes_128(p_cb->tk, text);
 }
 
+/* Fill |key| with random octets of the controller from |offset|, 8 octets per
+ * command, then run |done| */
+static void smp_fill_controller_rand(uint8_t* key, size_t offset,
+                                     base::Closure done) {
+  if (offset >= BT_OCTET32_LEN) {
+    done.Run();
+    return;
+  }
+  btsnd_hcic_ble_rand(Bind(
+      [](uint8_t* key, size_t offset, base::Closure done, BT_OCTET8 rand) {
+        memcpy(key + offset, rand, BT_OCTET8_LEN);
+        smp_fill_controller_rand(key, offset + BT_OCTET8_LEN, done);
+      },
+      key, offset, done));
+}
+
+static void smp_compute_public_key(const BT_OCTET32 private_key,
+                                   tSMP_PUBLIC_KEY* public_key) {
+  Point point;
+  BT_OCTET32 key;
+
+  memcpy(key, private_key, BT_OCTET32_LEN);
+  ECC_PointMult(&point, &(curve_p256.G), (uint32_t*)key);
+  memcpy(public_key->x, point.x, BT_OCTET32_LEN);
+  memcpy(public_key->y, point.y, BT_OCTET32_LEN);
+}
+
+/*******************************************************************************
+ *
+ * Function         smp_start_key_thread
+ *
+ * Description      This function starts the thread computing the local key
+ *                  pair of the next pairing, unless disabled.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void smp_start_key_thread(void) {
+  /* a computation interrupted by a stack restart never completes */
+  smp_next_key_pair_pending = false;
+  if (smp_key_thread != nullptr ||
+      !osi_property_get_bool("bluetooth.smp.precompute_key_pair.enabled",
+                             true)) {
+    return;
+  }
+  smp_key_thread = new bluetooth::common::MessageLoopThread("bt_smp_key");
+  smp_key_thread->StartUp();
+}
+
+/*******************************************************************************
+ *
+ * Function         smp_precompute_key_pair
+ *
+ * Description      This function gets random octets from the controller and
+ *                  computes the next local key pair on the key thread. The
+ *                  key pair is used by the next call to
+ *                  smp_create_private_key, once only.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void smp_precompute_key_pair(void) {
+  if (smp_key_thread == nullptr || !smp_key_thread->IsRunning() ||
+      smp_next_key_pair.has_value() || smp_next_key_pair_pending) {
+    return;
+  }
+  smp_next_key_pair_pending = true;
+
+  smp_fill_controller_rand(
+      smp_pending_key_pair.private_key, 0, base::Bind([]() {
+        tSMP_KEY_PAIR key_pair = smp_pending_key_pair;
+        memset(&smp_pending_key_pair, 0, sizeof(smp_pending_key_pair));
+        bool posted = smp_key_thread->DoInThread(
+            FROM_HERE, base::BindOnce(
+                           [](tSMP_KEY_PAIR key_pair) {
+                             smp_compute_public_key(key_pair.private_key,
+                                                    &key_pair.public_key);
+                             do_in_main_thread(
+                                 FROM_HERE, base::BindOnce(
+                                                [](tSMP_KEY_PAIR key_pair) {
+                                                  smp_next_key_pair = key_pair;
+                                                  smp_next_key_pair_pending =
+                                                      false;
+                                                },
+                                                key_pair));
+                           },
+                           key_pair));
+        if (!posted) smp_next_key_pair_pending = false;
+      }));
+}
+
 /*******************************************************************************
  *
  * Function         smp_create_private_key
  *
  * Description      This function is called to create private key used to
  *                  calculate public key and DHKey.
- *                  The function starts private key creation requesting
- *                  for the controller to generate [0-7] octets of private key.
+ *                  The function uses the key pair computed in the background
+ *                  if there is one, otherwise it starts private key creation
+ *                  requesting for the controller to generate [0-7] octets of
+ *                  private key.
  *
  * Returns          void
  *
@@ -613,28 +725,17 @@ void smp_create_private_key(tSMP_CB* p_cb, tSMP_INT_DATA* p_data) {
     LOG_WARN("OOB Association Model with no saved data present");
   }
 
-  btsnd_hcic_ble_rand(Bind(
-      [](tSMP_CB* p_cb, BT_OCTET8 rand) {
-        memcpy((void*)p_cb->private_key, rand, BT_OCTET8_LEN);
-        btsnd_hcic_ble_rand(Bind(
-            [](tSMP_CB* p_cb, BT_OCTET8 rand) {
-              memcpy((void*)&p_cb->private_key[8], rand, BT_OCTET8_LEN);
-              btsnd_hcic_ble_rand(Bind(
-                  [](tSMP_CB* p_cb, BT_OCTET8 rand) {
-                    memcpy((void*)&p_cb->private_key[16], rand, BT_OCTET8_LEN);
-                    btsnd_hcic_ble_rand(Bind(
-                        [](tSMP_CB* p_cb, BT_OCTET8 rand) {
-                          memcpy((void*)&p_cb->private_key[24], rand,
-                                 BT_OCTET8_LEN);
-                          smp_process_private_key(p_cb);
-                        },
-                        p_cb));
-                  },
-                  p_cb));
-            },
-            p_cb));
-      },
-      p_cb));
+  if (smp_next_key_pair.has_value()) {
+    memcpy(p_cb->private_key, smp_next_key_pair->private_key, BT_OCTET32_LEN);
+    p_cb->loc_publ_key = smp_next_key_pair->public_key;
+    memset(&smp_next_key_pair.value(), 0, sizeof(tSMP_KEY_PAIR));
+    smp_next_key_pair.reset();
+    smp_local_public_key_created(p_cb);
+    return;
+  }
+
+  smp_fill_controller_rand(p_cb->private_key, 0,
+                           Bind(&smp_process_private_key, p_cb));
 }
 
 /*******************************************************************************
@@ -707,16 +808,15 @@ void smp_use_oob_private_key(tSMP_CB* p_cb, tSMP_INT_DATA* p_data) {
  *
  ******************************************************************************/
 void smp_process_private_key(tSMP_CB* p_cb) {
-  Point public_key;
-  BT_OCTET32 private_key;
-
   SMP_TRACE_DEBUG("%s", __func__);
 
-  memcpy(private_key, p_cb->private_key, BT_OCTET32_LEN);
-  ECC_PointMult(&public_key, &(curve_p256.G), (uint32_t*)private_key);
-  memcpy(p_cb->loc_publ_key.x, public_key.x, BT_OCTET32_LEN);
-  memcpy(p_cb->loc_publ_key.y, public_key.y, BT_OCTET32_LEN);
+  smp_compute_public_key(p_cb->private_key, &p_cb->loc_publ_key);
+  smp_local_public_key_created(p_cb);
+}
 
+/* Notify SM that the local key pair is available, and start computing the one
+ * of the next pairing */
+static void smp_local_public_key_created(tSMP_CB* p_cb) {
   smp_debug_print_nbyte_little_endian(p_cb->private_key, "private",
                                       BT_OCTET32_LEN);
   smp_debug_print_nbyte_little_endian(p_cb->loc_publ_key.x, "local public(x)",
@@ -725,6 +825,7 @@ void smp_process_private_key(tSMP_CB* p_cb) {
                                       BT_OCTET32_LEN);
   p_cb->flags |= SMP_PAIR_FLAG_HAVE_LOCAL_PUBL_KEY;
   smp_sm_event(p_cb, SMP_LOC_PUBL_KEY_CRTD_EVT, NULL);
+  smp_precompute_key_pair();
 }
 
 /*******************************************************************************
@@ -31,6 +31,7 @@
 #include "common/init_flags.h"
 #include "common/testing/log_capture.h"
 #include "common/time_util.h"
+#include "internal_include/bt_target.h"
 #include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/test/AllocationTestHarness.h"
@@ -204,6 +205,51 @@ TEST_F(A2dpSbcTest, a2dp_enqueue_cb_is_invoked) {
   promise.get_future().wait();
 }
 
+TEST_F(A2dpSbcTest, a2dp_send_frames_batch_reads_once) {
+  static uint32_t reads_count;
+  static uint32_t read_bytes;
+  auto read_cb = +[](uint8_t* p_buf, uint32_t len) -> uint32_t {
+    reads_count++;
+    read_bytes += len;
+    memset(p_buf, 0, len);
+    return len;
+  };
+  auto enqueue_cb = +[](BT_HDR* p_buf, size_t frames_n, uint32_t len) -> bool {
+    osi_free(p_buf);
+    return true;
+  };
+  auto fill_pool = [](tA2DP_ENCODER_PACKET_POOL* pool) {
+    pool->buffer_size = BT_DEFAULT_BUFFER_SIZE;
+    while (pool->count < A2DP_ENCODER_PACKET_POOL_SIZE) {
+      pool->packets[pool->count++] =
+          static_cast<BT_HDR*>(osi_malloc(pool->buffer_size));
+    }
+  };
+  ASSERT_NE(encoder_iface_->send_frames_batch, nullptr);
+  InitializeEncoder(true, read_cb, enqueue_cb);
+
+  tA2DP_ENCODER_PACKET_POOL pool = {};
+  fill_pool(&pool);
+  uint64_t timestamp_us = bluetooth::common::time_gettimeofday_us();
+  encoder_iface_->send_frames_batch(timestamp_us, &pool);
+  usleep(kA2dpTickUs);
+
+  // All the frames of the tick are read at once, into buffers of the pool
+  fill_pool(&pool);
+  reads_count = 0;
+  read_bytes = 0;
+  timestamp_us = bluetooth::common::time_gettimeofday_us();
+  encoder_iface_->send_frames_batch(timestamp_us, &pool);
+  ASSERT_EQ(reads_count, 1u);
+  ASSERT_GT(read_bytes, kSbcReadSize);
+  ASSERT_EQ(read_bytes % kSbcReadSize, 0u);
+  ASSERT_LT(pool.count, (size_t)A2DP_ENCODER_PACKET_POOL_SIZE);
+
+  while (pool.count > 0) {
+    osi_free(pool.packets[--pool.count]);
+  }
+}
+
 TEST_F(A2dpSbcTest, decoded_data_cb_not_invoked_when_empty_packet) {
   auto data_cb = +[](uint8_t* p_buf, uint32_t len) { FAIL(); };
   InitializeDecoder(data_cb);
@@ -32,6 +32,7 @@
 #include "internal_include/stack_config.h"
 #include "osi/include/allocator.h"
 #include "osi/include/osi.h"
+#include "stack/btm/btm_ble_int.h"
 #include "stack/btm/btm_dev.h"
 #include "stack/btm/btm_int_types.h"
 #include "stack/btm/btm_sco.h"
@@ -39,8 +40,10 @@
 #include "stack/btm/security_device_record.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/acl_hci_link_interface.h"
+#include "stack/include/btm_api.h"
 #include "stack/include/btm_client_interface.h"
 #include "stack/include/hcidefs.h"
+#include "stack/include/inq_hci_link_interface.h"
 #include "stack/include/sec_hci_link_interface.h"
 #include "stack/l2cap/l2c_int.h"
 #include "test/mock/mock_osi_list.h"
@@ -397,6 +400,259 @@ TEST_F(StackBtmWithInitFreeTest, BTM_SetEncryption) {
   wipe_secrets_and_remove(device_record);
 }
 
+TEST_F(StackBtmWithInitFreeTest, btm_find_dev_index) {
+  const RawAddress bd_addr = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  const RawAddress pseudo_addr =
+      RawAddress({0x22, 0x33, 0x44, 0x55, 0x66, 0x77});
+  const RawAddress other_addr =
+      RawAddress({0x33, 0x44, 0x55, 0x66, 0x77, 0x88});
+
+  tBTM_SEC_DEV_REC* other_record = btm_sec_allocate_dev_rec();
+  other_record->bd_addr = other_addr;
+  other_record->hci_handle = HCI_INVALID_HANDLE;
+  other_record->ble_hci_handle = HCI_INVALID_HANDLE;
+
+  tBTM_SEC_DEV_REC* device_record = btm_sec_allocate_dev_rec();
+  device_record->bd_addr = bd_addr;
+  device_record->ble.pseudo_addr = pseudo_addr;
+  device_record->hci_handle = 0x0001;
+  device_record->ble_hci_handle = HCI_INVALID_HANDLE;
+
+  // Records updated without btm_sec_index_dev_rec are found by the scan, and
+  // indexed from then on
+  ASSERT_EQ(device_record, btm_find_dev(bd_addr));
+  ASSERT_EQ(device_record, btm_find_dev(bd_addr));
+  ASSERT_EQ(device_record, btm_find_dev(pseudo_addr));
+  ASSERT_EQ(device_record, btm_find_dev_by_handle(0x0001));
+  ASSERT_EQ(other_record, btm_find_dev(other_addr));
+
+  // Stale entries are not trusted
+  device_record->hci_handle = HCI_INVALID_HANDLE;
+  device_record->ble_hci_handle = 0x0002;
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0001));
+  ASSERT_EQ(device_record, btm_find_dev_by_handle(0x0002));
+  other_record->hci_handle = 0x0001;
+  btm_sec_index_dev_rec(other_record);
+  ASSERT_EQ(other_record, btm_find_dev_by_handle(0x0001));
+
+  device_record->bd_addr = other_addr;
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr));
+  ASSERT_EQ(other_record, btm_find_dev(other_addr));
+  device_record->bd_addr = bd_addr;
+
+  // Removed records are dropped from the indexes
+  wipe_secrets_and_remove(device_record);
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr));
+  ASSERT_EQ(nullptr, btm_find_dev(pseudo_addr));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0002));
+  ASSERT_EQ(other_record, btm_find_dev(other_addr));
+
+  wipe_secrets_and_remove(other_record);
+}
+
+TEST_F(StackBtmWithInitFreeTest, btm_inq_db_index) {
+  std::vector<RawAddress> addrs;
+  for (uint8_t i = 0; i < BTM_INQ_DB_SIZE + 2; i++) {
+    addrs.push_back(RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, i}));
+  }
+
+  for (uint8_t i = 0; i < BTM_INQ_DB_SIZE; i++) {
+    ASSERT_EQ(nullptr, btm_inq_db_find(addrs[i]));
+    tINQ_DB_ENT* p_ent = btm_inq_db_new(addrs[i]);
+    ASSERT_NE(nullptr, p_ent);
+    p_ent->time_of_resp = 1000 + i;
+    ASSERT_EQ(p_ent, btm_inq_db_find(addrs[i]));
+  }
+
+  // A new response makes the first entry the most recent one: the full
+  // database evicts the second entry, then the third
+  btm_inq_db_find(addrs[0])->time_of_resp = 2000;
+  btm_inq_db_new(addrs[BTM_INQ_DB_SIZE])->time_of_resp = 2001;
+  ASSERT_NE(nullptr, btm_inq_db_find(addrs[0]));
+  ASSERT_EQ(nullptr, btm_inq_db_find(addrs[1]));
+  btm_inq_db_new(addrs[BTM_INQ_DB_SIZE + 1])->time_of_resp = 2002;
+  ASSERT_EQ(nullptr, btm_inq_db_find(addrs[2]));
+  ASSERT_NE(nullptr, btm_inq_db_find(addrs[3]));
+  ASSERT_NE(nullptr, btm_inq_db_find(addrs[BTM_INQ_DB_SIZE]));
+
+  // Removed entries are reused before any eviction
+  tINQ_DB_ENT* p_ent = btm_inq_db_find(addrs[5]);
+  ASSERT_EQ(BTM_SUCCESS, BTM_ClearInqDb(&addrs[5]));
+  ASSERT_EQ(nullptr, btm_inq_db_find(addrs[5]));
+  ASSERT_EQ(p_ent, btm_inq_db_new(addrs[1]));
+  ASSERT_NE(nullptr, btm_inq_db_find(addrs[3]));
+
+  size_t count = 0;
+  for (tBTM_INQ_INFO* p_inq = BTM_InqDbFirst(); p_inq != nullptr;
+       p_inq = BTM_InqDbNext(p_inq)) {
+    ASSERT_NE(nullptr, BTM_InqDbRead(p_inq->results.remote_bd_addr));
+    count++;
+  }
+  ASSERT_EQ(static_cast<size_t>(BTM_INQ_DB_SIZE), count);
+
+  ASSERT_EQ(BTM_SUCCESS, BTM_ClearInqDb(nullptr));
+  ASSERT_EQ(nullptr, BTM_InqDbFirst());
+  ASSERT_EQ(nullptr, btm_inq_db_find(addrs[0]));
+}
+
+TEST_F(StackBtmWithInitFreeTest, btm_rmt_name_cache) {
+  RawAddress bd_addr = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
+  RawAddress other_addr = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x77});
+  tBTM_REMOTE_DEV_NAME rem_name;
+  ASSERT_FALSE(btm_rmt_name_cache_read(bd_addr, &rem_name));
+
+  // Only the complete local name of the EIR is stored
+  const uint8_t eir[] = {
+      0x05, HCI_EIR_SHORTENED_LOCAL_NAME_TYPE, 'S', 'h', 'o', 'r',
+      0x05, HCI_EIR_COMPLETE_LOCAL_NAME_TYPE,  'F', 'u', 'l', 'l',
+      0x00,
+  };
+  btm_rmt_name_cache_update_from_eir(bd_addr, eir, sizeof(eir));
+  ASSERT_TRUE(btm_rmt_name_cache_read(bd_addr, &rem_name));
+  ASSERT_EQ(bd_addr, rem_name.bd_addr);
+  ASSERT_EQ(BTM_SUCCESS, rem_name.status);
+  ASSERT_EQ(4, rem_name.length);
+  ASSERT_STREQ("Full", (const char*)rem_name.remote_bd_name);
+  ASSERT_FALSE(btm_rmt_name_cache_read(other_addr, &rem_name));
+
+  // Concurrent requests for the same device are sent once
+  mock_function_count_map.clear();
+  SendRemoteNameRequest(bd_addr);
+  SendRemoteNameRequest(bd_addr);
+  ASSERT_EQ(1, mock_function_count_map["btsnd_hcic_rmt_name_req"]);
+  SendRemoteNameRequest(other_addr);
+  ASSERT_EQ(2, mock_function_count_map["btsnd_hcic_rmt_name_req"]);
+
+  // The completed request updates the name, and the next one is sent again
+  const char name[] = "Remote Name";
+  btm_process_remote_name(&bd_addr, (const uint8_t*)name, sizeof(name),
+                          HCI_SUCCESS);
+  ASSERT_TRUE(btm_rmt_name_cache_read(bd_addr, &rem_name));
+  ASSERT_EQ(sizeof(name) - 1, rem_name.length);
+  ASSERT_STREQ(name, (const char*)rem_name.remote_bd_name);
+  SendRemoteNameRequest(bd_addr);
+  ASSERT_EQ(3, mock_function_count_map["btsnd_hcic_rmt_name_req"]);
+
+  // A failed request without address releases all the pending ones
+  btm_process_remote_name(nullptr, nullptr, 0, HCI_ERR_PAGE_TIMEOUT);
+  SendRemoteNameRequest(other_addr);
+  ASSERT_EQ(4, mock_function_count_map["btsnd_hcic_rmt_name_req"]);
+
+  // The full cache drops the oldest name
+  btm_cb.rmt_name_cache[bd_addr].time_ms -= 1000;
+  for (uint8_t i = 0; btm_cb.rmt_name_cache.size() < BTM_RMT_NAME_CACHE_SIZE;
+       i++) {
+    btm_rmt_name_cache_update(RawAddress({0x22, 0x22, 0x22, 0x22, 0x22, i}),
+                              (const uint8_t*)name, sizeof(name));
+  }
+  btm_rmt_name_cache_update(other_addr, (const uint8_t*)name, sizeof(name));
+  ASSERT_EQ(static_cast<size_t>(BTM_RMT_NAME_CACHE_SIZE),
+            btm_cb.rmt_name_cache.size());
+  ASSERT_FALSE(btm_rmt_name_cache_read(bd_addr, &rem_name));
+  ASSERT_TRUE(btm_rmt_name_cache_read(other_addr, &rem_name));
+
+  // Expired names are dropped
+  btm_cb.rmt_name_cache[other_addr].time_ms -= BTM_RMT_NAME_CACHE_TIMEOUT_MS;
+  ASSERT_FALSE(btm_rmt_name_cache_read(other_addr, &rem_name));
+}
+
+// Builds the RPA of |irk| with the prand 0x4x_xxxx of |seed|
+static RawAddress make_rpa(const Octet16& irk, uint8_t seed) {
+  uint8_t rand[3] = {seed, 0x5a, static_cast<uint8_t>(0x40 | (seed & 0x3f))};
+  Octet16 x = crypto_toolbox::aes_128(irk, rand, 3);
+  return RawAddress({rand[2], rand[1], rand[0], x[2], x[1], x[0]});
+}
+
+TEST_F(StackBtmWithInitFreeTest, btm_ble_resolve_random_addr) {
+  std::vector<tBTM_SEC_DEV_REC*> records;
+  for (uint8_t i = 0; i < 3; i++) {
+    tBTM_SEC_DEV_REC* p_dev_rec = btm_sec_allocate_dev_rec();
+    p_dev_rec->bd_addr = RawAddress({0xc0, 0x11, 0x22, 0x33, 0x44, i});
+    p_dev_rec->device_type = BT_DEVICE_TYPE_BLE;
+    p_dev_rec->ble.key_type = BTM_LE_KEY_PID;
+    p_dev_rec->ble.keys.irk = Octet16{i, 0xaa};
+    p_dev_rec->hci_handle = HCI_INVALID_HANDLE;
+    p_dev_rec->ble_hci_handle = HCI_INVALID_HANDLE;
+    records.push_back(p_dev_rec);
+  }
+  const Octet16 unknown_irk{0x55, 0xaa};
+  const RawAddress rpa = make_rpa(records[2]->ble.keys.irk, 0x01);
+  const RawAddress unknown_rpa = make_rpa(unknown_irk, 0x02);
+
+  // The resolutions are kept, including the ones to no record
+  ASSERT_EQ(records[2], btm_ble_resolve_random_addr(rpa));
+  ASSERT_EQ(3u, btm_cb.rpa_irk_index.size());
+  ASSERT_EQ(nullptr, btm_ble_resolve_random_addr(unknown_rpa));
+  ASSERT_EQ(2u, btm_cb.rpa_cache.size());
+  ASSERT_EQ(records[2], btm_ble_resolve_random_addr(rpa));
+  ASSERT_EQ(records[2]->bd_addr, btm_cb.rpa_cache[rpa].bd_addr);
+
+  // A new IRK resolves the RPAs which were not resolved
+  records[1]->ble.keys.irk = unknown_irk;
+  btm_ble_rpa_index_invalidate();
+  ASSERT_EQ(records[1], btm_ble_resolve_random_addr(unknown_rpa));
+
+  // Records changed without invalidating the index are not trusted
+  records[1]->ble.keys.irk = records[2]->ble.keys.irk;
+  records[2]->ble.key_type = BTM_LE_KEY_NONE;
+  ASSERT_EQ(records[1], btm_ble_resolve_random_addr(rpa));
+  ASSERT_EQ(nullptr, btm_ble_resolve_random_addr(unknown_rpa));
+
+  // Expired resolutions are computed again
+  btm_cb.rpa_cache[rpa].time_ms -= BTM_BLE_RPA_CACHE_TIMEOUT_MS;
+  ASSERT_EQ(2u, btm_cb.rpa_irk_index.size());
+  ASSERT_EQ(records[1], btm_ble_resolve_random_addr(rpa));
+
+  for (tBTM_SEC_DEV_REC* p_dev_rec : records) {
+    wipe_secrets_and_remove(p_dev_rec);
+  }
+  ASSERT_EQ(nullptr, btm_ble_resolve_random_addr(rpa));
+}
+
+void btm_route_sco_data(BT_HDR* p_msg);
+
+namespace {
+// Builds a received SCO packet of |handle| with |packet_status| and
+// |length| bytes of data
+BT_HDR* make_rx_sco_packet(uint16_t handle, uint8_t packet_status,
+                           uint8_t length) {
+  BT_HDR* p_msg = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + 3 + length);
+  p_msg->len = 3 + length;
+  uint8_t* p = p_msg->data;
+  UINT16_TO_STREAM(p, handle | (packet_status << 12));
+  UINT8_TO_STREAM(p, length);
+  return p_msg;
+}
+}  // namespace
+
+TEST_F(StackBtmWithInitFreeTest, btm_route_sco_data_statistics) {
+  tSCO_CONN* p_sco = btm_cb.sco_cb.get_sco_connection_from_index(0);
+  p_sco->state = SCO_ST_CONNECTED;
+  p_sco->hci_handle = 0x123;
+
+  btm_route_sco_data(make_rx_sco_packet(0x123, 0x0, 60));
+  btm_route_sco_data(make_rx_sco_packet(0x123, 0x1, 60));
+  btm_route_sco_data(make_rx_sco_packet(0x123, 0x2, 60));
+  btm_route_sco_data(make_rx_sco_packet(0x123, 0x3, 60));
+  // Another link, and a packet shorter than its header
+  btm_route_sco_data(make_rx_sco_packet(0x456, 0x0, 60));
+  BT_HDR* p_short = make_rx_sco_packet(0x123, 0x0, 0);
+  p_short->len = 2;
+  btm_route_sco_data(p_short);
+
+  const tSCO_HCI_STATS& stats = btm_cb.sco_cb.hci_stats;
+  ASSERT_EQ(4u, stats.rx_packets);
+  ASSERT_EQ(1u, stats.rx_erroneous);
+  ASSERT_EQ(1u, stats.rx_no_data);
+  ASSERT_EQ(1u, stats.rx_partially_lost);
+  ASSERT_EQ(2u, stats.rx_dropped);
+  // No audio server is connected, so nothing is sent
+  ASSERT_EQ(0u, stats.tx_packets);
+  ASSERT_EQ(5u, stats.tx_underruns);
+
+  p_sco->state = SCO_ST_UNUSED;
+}
+
 TEST_F(StackBtmTest, sco_state_text) {
   std::vector<std::pair<tSCO_STATE, std::string>> states = {
       std::make_pair(SCO_ST_UNUSED, "SCO_ST_UNUSED"),
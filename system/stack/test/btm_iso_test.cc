@@ -1999,6 +1999,82 @@ TEST_F(IsoManagerTest, SendIsoDataNoCredits) {
   }
 }
 
+TEST_F(IsoManagerTest, SendIsoDataBatchSharesTimestamp) {
+  IsoManager::GetInstance()->CreateCig(
+      volatile_test_cig_create_cmpl_evt_.cig_id, kDefaultCigParams);
+
+  bluetooth::hci::iso_manager::cis_establish_params params;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    params.conn_pairs.push_back({handle, 1});
+  }
+  IsoManager::GetInstance()->EstablishCis(params);
+
+  std::vector<uint8_t> data_vec(108, 0);
+  std::vector<bluetooth::hci::iso_manager::iso_sdu> sdus;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    IsoManager::GetInstance()->SetupIsoDataPath(handle,
+                                                kDefaultIsoDataPathParams);
+    sdus.push_back({handle, data_vec.data(), (uint16_t)data_vec.size()});
+  }
+
+  std::vector<uint16_t> sent_handles;
+  std::vector<uint32_t> sent_ts;
+  EXPECT_CALL(bte_interface_, HciSend)
+      .Times(sdus.size())
+      .WillRepeatedly([&](BT_HDR* p_msg, uint16_t event) {
+        uint8_t* p = p_msg->data;
+        uint16_t msg_handle;
+        uint32_t ts;
+
+        ASSERT_TRUE(p_msg->layer_specific & BT_ISO_HDR_CONTAINS_TS);
+        STREAM_TO_UINT16(msg_handle, p);
+        STREAM_SKIP_UINT16(p);  // skip iso load length
+        STREAM_TO_UINT32(ts, p);
+        sent_handles.push_back(msg_handle);
+        sent_ts.push_back(ts);
+      });
+  IsoManager::GetInstance()->SendIsoDataBatch(sdus.data(), sdus.size());
+
+  ASSERT_EQ(sent_handles, volatile_test_cig_create_cmpl_evt_.conn_handles);
+  ASSERT_EQ(sent_ts.size(), sdus.size());
+  for (auto ts : sent_ts) ASSERT_EQ(ts, sent_ts.front());
+}
+
+TEST_F(IsoManagerTest, SendIsoDataBatchNoCredits) {
+  uint8_t num_buffers = controller_interface_.GetIsoBufferCount();
+  std::vector<uint8_t> data_vec(108, 0);
+
+  IsoManager::GetInstance()->CreateCig(
+      volatile_test_cig_create_cmpl_evt_.cig_id, kDefaultCigParams);
+
+  bluetooth::hci::iso_manager::cis_establish_params params;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    params.conn_pairs.push_back({handle, 1});
+  }
+  IsoManager::GetInstance()->EstablishCis(params);
+
+  std::vector<bluetooth::hci::iso_manager::iso_sdu> sdus;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    IsoManager::GetInstance()->SetupIsoDataPath(handle,
+                                                kDefaultIsoDataPathParams);
+    sdus.push_back({handle, data_vec.data(), (uint16_t)data_vec.size()});
+  }
+
+  /* Leave a single credit, which is not enough for the whole batch. None of
+   * its SDUs should be propagated down to the HCI.
+   */
+  EXPECT_CALL(bte_interface_, HciSend)
+      .Times(num_buffers - 1)
+      .RetiresOnSaturation();
+  for (uint8_t i = 0; i < num_buffers - 1; i++) {
+    IsoManager::GetInstance()->SendIsoData(sdus[0].conn_handle,
+                                           data_vec.data(), data_vec.size());
+  }
+
+  EXPECT_CALL(bte_interface_, HciSend).Times(0);
+  IsoManager::GetInstance()->SendIsoDataBatch(sdus.data(), sdus.size());
+}
+
 TEST_F(IsoManagerTest, SendIsoDataCreditsReturned) {
   uint8_t num_buffers = controller_interface_.GetIsoBufferCount();
   std::vector<uint8_t> data_vec(108, 0);
@@ -96,6 +96,11 @@ EattChannel* EattExtension::GetChannelAvailableForClientRequest(
   return pimpl_->GetChannelAvailableForClientRequest(bd_addr);
 }
 
+EattChannel* EattExtension::GetLeastLoadedChannelForClientRequest(
+    const RawAddress& bd_addr) {
+  return pimpl_->GetLeastLoadedChannelForClientRequest(bd_addr);
+}
+
 /* Start stop GATT indication timer per CID */
 void EattExtension::StartIndicationConfirmationTimer(const RawAddress& bd_addr,
                                                      uint16_t cid) {
@@ -153,6 +153,52 @@ TEST(CryptoToolboxTest, bt_spec_example_d_1_4_test) {
   EXPECT_EQ(output, aes_cmac_k_m);
 }
 
+// BT Spec 5.0 | Vol 3, Part H D.1.1 to D.1.4, with one key schedule
+TEST(CryptoToolboxTest, aes_cmac_key_test) {
+  Octet16 k{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+            0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+
+  uint8_t m[] = {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d,
+                 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57,
+                 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf,
+                 0x8e, 0x51, 0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+                 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f,
+                 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b,
+                 0xe6, 0x6c, 0x37, 0x10};
+
+  // CMAC of the first 0, 16, 40 and 64 bytes of m
+  std::vector<std::pair<uint16_t, Octet16>> aes_cmac_k_m{
+      {0,
+       {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12,
+        0x9b, 0x75, 0x67, 0x46}},
+      {16,
+       {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d,
+        0xd0, 0x4a, 0x28, 0x7c}},
+      {40,
+       {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61,
+        0x14, 0x97, 0xc8, 0x27}},
+      {64,
+       {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17,
+        0x79, 0x36, 0x3c, 0xfe}},
+  };
+
+  // algorithm expect all input to be in little endian format, so reverse
+  std::reverse(std::begin(k), std::end(k));
+  std::reverse(std::begin(m), std::end(m));
+
+  const AesCmacKey key(k);
+  for (auto& [length, expected] : aes_cmac_k_m) {
+    std::reverse(std::begin(expected), std::end(expected));
+    const uint8_t* message = m + sizeof(m) - length;
+
+    EXPECT_EQ(key.Cmac(message, length), expected);
+    EXPECT_EQ(aes_cmac(k, message, length), expected);
+  }
+
+  Octet16 zero{};
+  EXPECT_EQ(key.Encrypt(zero), aes_128(k, zero));
+}
+
 // BT Spec 5.0 | Vol 3, Part H D.2
 TEST(CryptoToolboxTest, bt_spec_example_d_2_test) {
   std::vector<uint8_t> u{0x20, 0xb0, 0x03, 0xd2, 0xf2, 0x97, 0xbe, 0x2c,
@@ -461,6 +461,42 @@ TEST_F(EattTest, DisonnectByPeerSucceed) {
   ASSERT_TRUE(channel == nullptr);
 }
 
+TEST_F(EattTest, ClientRequestsSpreadOverChannels) {
+  ConnectDeviceEattSupported(3);
+
+  EattChannel* channels[3];
+  for (int i = 0; i < 3; i++) {
+    channels[i] =
+        eatt_instance_->FindEattChannelByCid(test_address, connected_cids_[i]);
+    ASSERT_NE(channels[i], nullptr);
+  }
+
+  /* Of the idle channels, the one which served the fewest commands */
+  channels[0]->cl_cmd_count_ = 2;
+  channels[1]->cl_cmd_count_ = 1;
+  channels[2]->cl_cmd_count_ = 3;
+  ASSERT_EQ(eatt_instance_->GetChannelAvailableForClientRequest(test_address),
+            channels[1]);
+
+  channels[1]->cl_cmd_q_.push_back({});
+  ASSERT_EQ(eatt_instance_->GetChannelAvailableForClientRequest(test_address),
+            channels[0]);
+
+  /* When no channel is idle, the one with the fewest commands queued */
+  channels[0]->cl_cmd_q_.push_back({});
+  channels[0]->cl_cmd_q_.push_back({});
+  channels[2]->cl_cmd_q_.push_back({});
+  channels[2]->cl_cmd_q_.push_back({});
+  channels[2]->cl_cmd_q_.push_back({});
+  ASSERT_EQ(eatt_instance_->GetChannelAvailableForClientRequest(test_address),
+            nullptr);
+  ASSERT_EQ(
+      eatt_instance_->GetLeastLoadedChannelForClientRequest(test_address),
+      channels[1]);
+
+  DisconnectEattDevice(connected_cids_);
+}
+
 TEST_F(EattTest, ReconfigAllSucceed) {
   ConnectDeviceEattSupported(3);
 
@@ -57,7 +57,11 @@ class GattApiTest : public ::testing::Test {
     logging::SetMinLogLevel(-2);
   }
 
-  void TearDown() override { list_free(btm_cb.sec_dev_rec); }
+  void TearDown() override {
+    btm_cb.sec_dev_rec_by_addr.clear();
+    btm_cb.sec_dev_rec_by_handle.clear();
+    list_free(btm_cb.sec_dev_rec);
+  }
 };
 
 static const RawAddress SAMPLE_PUBLIC_BDA = {
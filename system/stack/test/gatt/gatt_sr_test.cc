@@ -593,3 +593,199 @@ TEST_F(GattSrRobustCachingTest,
 
   ASSERT_FALSE(should_ignore);
 }
+
+/* Server Handle Index Test */
+class GattSrIndexTest : public GattSrTest {
+ protected:
+  void SetUp() override {
+    GattSrTest::SetUp();
+    // Two services with unused handles at their end, and a gap between them
+    AddService(db_[0], 0x0001, 0x0008, {0x2800, 0x2803, 0x2a00, 0x2902});
+    AddService(db_[1], 0x0010, 0x0018, {0x2800, 0x2803, 0x2a01, 0x2803});
+    gatt_cb.srv_list_info = &srv_list_;
+    gatt_sr_update_srv_index();
+  }
+
+  void TearDown() override {
+    gatt_cb.srv_list_info = nullptr;
+    gatt_sr_update_srv_index();
+    GattSrTest::TearDown();
+  }
+
+  void AddService(tGATT_SVC_DB& db, uint16_t s_hdl, uint16_t e_hdl,
+                  std::vector<uint16_t> types) {
+    uint16_t handle = s_hdl;
+    for (uint16_t type : types) {
+      db.attr_list.emplace_back();
+      db.attr_list.back().handle = handle++;
+      db.attr_list.back().p_uuid = gatt_intern_uuid(Uuid::From16Bit(type));
+      db.attr_list.back().gatt_type = kGattCharacteristicType;
+    }
+
+    srv_list_.emplace_back();
+    tGATT_SRV_LIST_ELEM& el = srv_list_.back();
+    el.p_db = &db;
+    el.s_hdl = s_hdl;
+    el.e_hdl = e_hdl;
+    el.gatt_if = el_.gatt_if;
+  }
+
+  tGATT_SVC_DB db_[2];
+  std::list<tGATT_SRV_LIST_ELEM> srv_list_;
+};
+
+TEST_F(GattSrIndexTest, gatt_sr_find_i_rcb_by_handle) {
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0001), srv_list_.begin());
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0008), srv_list_.begin());
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0010), std::next(srv_list_.begin()));
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0018), std::next(srv_list_.begin()));
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0009), srv_list_.end());
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0019), srv_list_.end());
+
+  ASSERT_EQ(gatt_sr_find_first_srv(0x0000), srv_list_.begin());
+  ASSERT_EQ(gatt_sr_find_first_srv(0x0009), std::next(srv_list_.begin()));
+  ASSERT_EQ(gatt_sr_find_first_srv(0x0019), srv_list_.end());
+}
+
+TEST_F(GattSrIndexTest, gatt_sr_find_attr_by_handle) {
+  const tGATT_SRV_ATTR_REF* p_ref = gatt_sr_find_attr_by_handle(0x0012);
+  ASSERT_NE(p_ref, nullptr);
+  ASSERT_EQ(p_ref->p_attr, &db_[1].attr_list[2]);
+  ASSERT_EQ(p_ref->srv, std::next(srv_list_.begin()));
+
+  // Handles of the services without attribute
+  ASSERT_EQ(gatt_sr_find_attr_by_handle(0x0005), nullptr);
+  ASSERT_EQ(gatt_sr_find_attr_by_handle(0x0009), nullptr);
+}
+
+TEST_F(GattSrIndexTest, gatt_sr_find_handles_by_type) {
+  const std::vector<uint16_t>* p_handles =
+      gatt_sr_find_handles_by_type(Uuid::From16Bit(0x2803));
+  ASSERT_NE(p_handles, nullptr);
+  ASSERT_EQ(*p_handles, std::vector<uint16_t>({0x0002, 0x0011, 0x0013}));
+
+  ASSERT_EQ(gatt_sr_find_handles_by_type(Uuid::From16Bit(0x2a02)), nullptr);
+}
+
+TEST_F(GattSrIndexTest, gatt_intern_uuid) {
+  const Uuid* p_uuid = gatt_intern_uuid(Uuid::From16Bit(0x2803));
+  ASSERT_EQ(*p_uuid, Uuid::From16Bit(0x2803));
+  ASSERT_EQ(gatt_intern_uuid(Uuid::From16Bit(0x2803)), p_uuid);
+  ASSERT_EQ(gatt_find_interned_uuid(Uuid::From16Bit(0x2803)), p_uuid);
+  ASSERT_EQ(db_[0].attr_list[1].p_uuid, db_[1].attr_list[1].p_uuid);
+
+  ASSERT_EQ(gatt_find_interned_uuid(Uuid::FromString(
+                "9f4b2a1c-6d3e-4b8a-a1c2-3e4f5a6b7c8d")),
+            nullptr);
+}
+
+TEST_F(GattSrIndexTest, gatt_sr_update_srv_index_after_stop) {
+  srv_list_.pop_front();
+  gatt_sr_update_srv_index();
+
+  ASSERT_EQ(gatt_sr_find_i_rcb_by_handle(0x0001), srv_list_.end());
+  ASSERT_EQ(gatt_sr_find_attr_by_handle(0x0002), nullptr);
+  ASSERT_EQ(*gatt_sr_find_handles_by_type(Uuid::From16Bit(0x2803)),
+            std::vector<uint16_t>({0x0011, 0x0013}));
+}
+
+TEST_F(GattSrIndexTest, gatts_process_attribute_req_write) {
+  uint8_t p_data[4] = {0x12, 0x00, 0x11, 0x22};
+  gatts_process_attribute_req(tcb_, L2CAP_ATT_CID, GATT_CMD_WRITE,
+                              sizeof(p_data), p_data);
+
+  CHECK(test_state_.gatts_write_attr_perm_check.access_count_ == 1);
+  CHECK(test_state_.application_request_callback.type_ ==
+        GATTS_REQ_TYPE_WRITE_CHARACTERISTIC);
+  CHECK(test_state_.application_request_callback.data_.write_req.handle ==
+        0x0012);
+  CHECK(test_state_.application_request_callback.data_.write_req.len == 2);
+}
+
+TEST_F(GattSrIndexTest, gatts_process_attribute_req_invalid_handle) {
+  uint8_t p_data[2] = {0x05, 0x00};
+  gatts_process_attribute_req(tcb_, L2CAP_ATT_CID, GATT_REQ_READ,
+                              sizeof(p_data), p_data);
+
+  CHECK(test_state_.attp_build_sr_msg.op_code_ == GATT_RSP_ERROR);
+  CHECK(test_state_.gatts_write_attr_perm_check.access_count_ == 0);
+}
+
+/* Server Assembled Prepare Write Test */
+class GattSrAssembledWriteTest : public GattSrIndexTest {
+ protected:
+  void SetUp() override {
+    GattSrIndexTest::SetUp();
+    gatt_cb.sr_assemble_prep_writes = true;
+  }
+
+  void TearDown() override {
+    gatt_cb.sr_assemble_prep_writes = false;
+    GattSrIndexTest::TearDown();
+  }
+
+  // The request starts with the little endian value offset
+  void PrepareWrite(uint16_t handle, std::vector<uint8_t> request) {
+    gatts_process_write_req(tcb_, L2CAP_ATT_CID, el_, handle,
+                            GATT_REQ_PREPARE_WRITE, request.size(),
+                            request.data(), kGattCharacteristicType);
+  }
+
+  void ExecuteWrite(uint8_t flag) {
+    gatt_process_exec_write_req(tcb_, L2CAP_ATT_CID, GATT_REQ_EXEC_WRITE,
+                                sizeof(flag), &flag);
+  }
+};
+
+TEST_F(GattSrAssembledWriteTest, prepare_write_is_answered_by_stack) {
+  uint8_t p_data[4] = {0x00, 0x00, 0x11, 0x22};
+  gatts_process_write_req(tcb_, L2CAP_ATT_CID, el_, 0x0012,
+                          GATT_REQ_PREPARE_WRITE, sizeof(p_data), p_data,
+                          kGattCharacteristicType);
+
+  CHECK(test_state_.attp_build_sr_msg.op_code_ == GATT_RSP_PREPARE_WRITE);
+  CHECK(test_state_.application_request_callback.type_ == 0xff);
+  CHECK(tcb_.prep_write_q.size() == 1);
+  CHECK(tcb_.prep_write_q[0].value == std::vector<uint8_t>({0x11, 0x22}));
+}
+
+TEST_F(GattSrAssembledWriteTest, execute_write_gives_one_value) {
+  PrepareWrite(0x0012, {0x00, 0x00, 0x01, 0x02});
+  PrepareWrite(0x0012, {0x02, 0x00, 0x03, 0x04});
+  PrepareWrite(0x0012, {0x04, 0x00, 0x05});
+  CHECK(tcb_.prep_write_q.size() == 1);
+
+  ExecuteWrite(GATT_PREP_WRITE_EXEC);
+
+  tGATT_WRITE_REQ& write_req =
+      test_state_.application_request_callback.data_.write_req;
+  CHECK(test_state_.application_request_callback.type_ ==
+        GATTS_REQ_TYPE_WRITE_CHARACTERISTIC);
+  CHECK(write_req.handle == 0x0012);
+  CHECK(write_req.offset == 0);
+  CHECK(write_req.len == 5);
+  CHECK(write_req.value[4] == 0x05);
+  CHECK(write_req.need_rsp);
+  CHECK(!write_req.is_prep);
+  CHECK(tcb_.prep_write_q.empty());
+}
+
+TEST_F(GattSrAssembledWriteTest, execute_write_cancel) {
+  PrepareWrite(0x0012, {0x00, 0x00, 0x01, 0x02});
+
+  ExecuteWrite(GATT_PREP_WRITE_CANCEL);
+
+  CHECK(test_state_.attp_build_sr_msg.op_code_ == GATT_RSP_EXEC_WRITE);
+  CHECK(test_state_.application_request_callback.type_ == 0xff);
+  CHECK(tcb_.prep_write_q.empty());
+}
+
+TEST_F(GattSrAssembledWriteTest, execute_write_invalid_offset) {
+  // Offset 0x0201, beyond GATT_MAX_ATTR_LEN
+  PrepareWrite(0x0012, {0x01, 0x02, 0x01});
+
+  ExecuteWrite(GATT_PREP_WRITE_EXEC);
+
+  CHECK(test_state_.attp_build_sr_msg.op_code_ == GATT_RSP_ERROR);
+  CHECK(test_state_.application_request_callback.type_ == 0xff);
+}
@@ -21,11 +21,15 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/message_loop_thread.h"
 #include "common/strings.h"
+#include "osi/include/allocator.h"
 #include "stack/gatt/gatt_int.h"
+#include "stack/include/bt_hdr.h"
 #include "stack/include/gatt_api.h"
+#include "test/mock/mock_stack_l2cap_api.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
 
@@ -139,3 +143,59 @@ TEST_F(StackGattTest, GATT_Register_Deregister) {
 
   gatt_free();
 }
+
+TEST_F(StackGattTest, GATTS_HandleValueNotificationMulti) {
+  gatt_init();
+
+  tGATT_IF gatt_if = GATT_Register(bluetooth::Uuid::GetRandom(), "name",
+                                   &gatt_callbacks, false);
+
+  // Two links with the default MTU, and one with a larger MTU
+  const uint16_t payload_sizes[] = {23, 100, 23};
+  std::vector<uint16_t> conn_ids;
+  for (uint8_t i = 0; i < 3; i++) {
+    tGATT_TCB& tcb = gatt_cb.tcb[i];
+    tcb.in_use = true;
+    tcb.tcb_idx = i;
+    tcb.peer_bda = RawAddress::kEmpty;
+    tcb.peer_bda.address[5] = i + 1;
+    tcb.att_lcid = L2CAP_ATT_CID;
+    tcb.payload_size = payload_sizes[i];
+    conn_ids.push_back(GATT_CREATE_CONN_ID(i, gatt_if));
+  }
+  // Unknown connection
+  conn_ids.push_back(GATT_CREATE_CONN_ID(3, gatt_if));
+
+  std::map<RawAddress, std::vector<uint8_t>> sent;
+  test::mock::stack_l2cap_api::L2CA_SendFixedChnlData.body =
+      [&sent](uint16_t fixed_cid, const RawAddress& rem_bda, BT_HDR* p_buf) {
+        uint8_t* p = (uint8_t*)(p_buf + 1) + p_buf->offset;
+        sent[rem_bda] = std::vector<uint8_t>(p, p + p_buf->len);
+        osi_free(p_buf);
+        return (uint16_t)L2CAP_DW_SUCCESS;
+      };
+
+  std::vector<uint8_t> value(40);
+  for (size_t i = 0; i < value.size(); i++) value[i] = i;
+  std::vector<tGATT_STATUS> status = GATTS_HandleValueNotificationMulti(
+      conn_ids, 0x0012, value.size(), value.data());
+
+  ASSERT_EQ(status, std::vector<tGATT_STATUS>({GATT_SUCCESS, GATT_SUCCESS,
+                                               GATT_SUCCESS,
+                                               GATT_INVALID_CONN_ID}));
+  ASSERT_EQ(sent.size(), 3u);
+
+  // The value is truncated to the MTU of each link
+  std::vector<uint8_t> short_pdu = {GATT_HANDLE_VALUE_NOTIF, 0x12, 0x00};
+  short_pdu.insert(short_pdu.end(), value.begin(), value.begin() + 20);
+  std::vector<uint8_t> long_pdu = {GATT_HANDLE_VALUE_NOTIF, 0x12, 0x00};
+  long_pdu.insert(long_pdu.end(), value.begin(), value.end());
+  ASSERT_EQ(sent[gatt_cb.tcb[0].peer_bda], short_pdu);
+  ASSERT_EQ(sent[gatt_cb.tcb[1].peer_bda], long_pdu);
+  ASSERT_EQ(sent[gatt_cb.tcb[2].peer_bda], short_pdu);
+
+  test::mock::stack_l2cap_api::L2CA_SendFixedChnlData = {};
+  for (uint8_t i = 0; i < 3; i++) gatt_cb.tcb[i].in_use = false;
+  GATT_Deregister(gatt_if);
+  gatt_free();
+}
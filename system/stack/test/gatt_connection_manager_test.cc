@@ -8,10 +8,12 @@
 #include <memory>
 
 #include "common/init_flags.h"
+#include "device/include/controller.h"
 #include "osi/include/alarm.h"
 #include "osi/test/alarm_mock.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/test/common/mock_btm_api_layer.h"
+#include "test/common/main_handler.h"
 
 using testing::_;
 using testing::DoAll;
@@ -48,6 +50,7 @@ std::unique_ptr<AcceptlistMock> localAcceptlistMock;
 
 RawAddress address1{{0x01, 0x01, 0x01, 0x01, 0x01, 0x01}};
 RawAddress address2{{0x22, 0x22, 0x02, 0x22, 0x33, 0x22}};
+RawAddress address3{{0x33, 0x33, 0x03, 0x33, 0x44, 0x33}};
 
 constexpr tAPP_ID CLIENT1 = 1;
 constexpr tAPP_ID CLIENT2 = 2;
@@ -95,6 +98,16 @@ uint16_t BTM_GetHCIConnHandle(RawAddress const&, unsigned char) {
   return 0xFFFF;
 };
 
+// Size of the controller accept list, 0 when unknown
+uint8_t accept_list_size = 0;
+uint8_t get_ble_acceptlist_size(void) { return accept_list_size; }
+
+const controller_t* controller_get_interface() {
+  static controller_t controller = {};
+  controller.get_ble_acceptlist_size = get_ble_acceptlist_size;
+  return &controller;
+}
+
 namespace connection_manager {
 class BleConnectionManager : public testing::Test {
   void SetUp() override {
@@ -106,6 +119,7 @@ class BleConnectionManager : public testing::Test {
     connection_manager::reset(true);
     AlarmMock::Reset();
     localAcceptlistMock.reset();
+    accept_list_size = 0;
   }
 };
 
@@ -367,4 +381,74 @@ TEST_F(BleConnectionManager, test_re_add_background_connect_to_allow_list) {
   EXPECT_TRUE(background_connect_remove(CLIENT1, address1));
   Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
 }
+
+/** Verify that the background connections exceeding the accept list wait in
+ * standby, and replace the devices seen less recently when they advertise. */
+TEST_F(BleConnectionManager, test_background_connect_accept_list_full) {
+  accept_list_size = 2;
+  main_thread_start_up();
+
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(address1))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(address2))
+      .WillOnce(Return(true));
+  EXPECT_TRUE(background_connect_add(CLIENT1, address1));
+  EXPECT_TRUE(background_connect_add(CLIENT1, address2));
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+
+  // The third device waits for room, while the advertisements are observed
+  tBTM_INQ_RESULTS_CB* observe_cb = nullptr;
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(_)).Times(0);
+  EXPECT_CALL(*localAcceptlistMock, EnableTargetedAnnouncements(true, _))
+      .WillOnce(SaveArg<1>(&observe_cb));
+  EXPECT_TRUE(background_connect_add(CLIENT1, address3));
+  EXPECT_EQ(get_apps_connecting_to(address3).count(CLIENT1), 1UL);
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+  ASSERT_NE(observe_cb, nullptr);
+
+  // Seeing the first device does not change the accept list
+  tBTM_INQ_RESULTS inq_results{};
+  inq_results.remote_bd_addr = address1;
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(_)).Times(0);
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(_)).Times(0);
+  observe_cb(&inq_results, nullptr, 0);
+  sync_main_handler();
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+
+  // Seeing the third device swaps it with the device not seen
+  inq_results.remote_bd_addr = address3;
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(address2)).Times(1);
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(address3))
+      .WillOnce(Return(true));
+  observe_cb(&inq_results, nullptr, 0);
+  observe_cb(&inq_results, nullptr, 0);
+  sync_main_handler();
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+
+  // A direct connection moves the device seen least recently to standby
+  inq_results.remote_bd_addr = address3;
+  observe_cb(&inq_results, nullptr, 0);
+  sync_main_handler();
+  EXPECT_CALL(*localAcceptlistMock, SetLeConnectionModeToFast()).Times(1);
+  EXPECT_CALL(*AlarmMock::Get(), AlarmNew(_)).Times(1);
+  EXPECT_CALL(*AlarmMock::Get(), AlarmSetOnMloop(_, _, _, _)).Times(1);
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(address1)).Times(1);
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(address2))
+      .WillOnce(Return(true));
+  EXPECT_TRUE(direct_connect_add(CLIENT2, address2));
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+
+  // A removed device leaves room for a device in standby, and the
+  // observation stops when no device is left in standby
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistRemove(address3)).Times(1);
+  EXPECT_CALL(*localAcceptlistMock, AcceptlistAdd(address1))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*localAcceptlistMock, EnableTargetedAnnouncements(false, _))
+      .Times(1);
+  EXPECT_TRUE(background_connect_remove(CLIENT1, address3));
+  sync_main_handler();
+  Mock::VerifyAndClearExpectations(localAcceptlistMock.get());
+
+  main_thread_shut_down();
+}
 }  // namespace connection_manager
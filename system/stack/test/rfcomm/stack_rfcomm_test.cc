@@ -20,9 +20,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+
 #include "mock_btm_layer.h"
 #include "mock_l2cap_layer.h"
 #include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
 #include "stack/include/bt_hdr.h"
@@ -62,6 +65,7 @@ void PrintTo(tL2CAP_CFG_INFO* value, ::std::ostream* os) {
 namespace {
 
 using testing::_;
+using testing::AnyNumber;
 using testing::DoAll;
 using testing::Return;
 using testing::Test;
@@ -497,6 +501,90 @@ TEST_F(StackRfcommTest, DISABLED_SingleServerConnectionHelloWorld) {
                                         "\r!dlroW olleH", 4, acl_handle, lcid));
 }
 
+TEST_F(StackRfcommTest, SingleServerConnectionBulkReceive) {
+  // Stream frames through a server port, and read all the frames queued for
+  // each round at once, as bulk readers do. The L2CAP and multiplexer
+  // handshakes of the helpers above are not what the stack does anymore, so
+  // the port is opened on a multiplexer set up by hand, and the frames are
+  // handed to the port layer as the multiplexer would.
+  static const uint16_t acl_handle = 0x0009;
+  static const uint16_t lcid = 0x0054;
+  static const uint16_t test_uuid = 0x1112;
+  static const uint8_t test_scn = 8;
+  static const uint16_t test_mtu = 1600;
+  static const uint16_t frame_size = 1000;
+  static const int num_rounds = 200;
+  uint16_t server_handle = 0;
+  ASSERT_EQ(RFCOMM_CreateConnectionWithSecurity(test_uuid, test_scn, true,
+                                                test_mtu, RawAddress::kAny,
+                                                &server_handle, nullptr, 0),
+            PORT_SUCCESS);
+
+  uint8_t dlci = GetDlci(false, test_scn);
+  tRFC_MCB mcb{};
+  mcb.cmd_q = fixed_queue_new(SIZE_MAX);
+  mcb.lcid = lcid;
+  mcb.state = RFC_MX_STATE_CONNECTED;
+  mcb.is_initiator = false;
+  mcb.flow = PORT_FC_CREDIT;
+  mcb.port_handles[dlci] = server_handle;
+  tPORT* p_port = &rfc_cb.port.port[server_handle - 1];
+  p_port->rfc.p_mcb = &mcb;
+  p_port->rfc.state = RFC_STATE_OPENED;
+  p_port->state = PORT_CONNECTION_STATE_OPENED;
+  port_select_mtu(p_port);
+  // As granted in the parameter negotiation
+  p_port->credit_rx = RFCOMM_K_MAX;
+  ASSERT_EQ(p_port->credit_rx_max, 10);
+
+  // The port grants 7 of its 10 credits when connected. Since the reads
+  // drain the queue, the consumed credits are returned as soon as half of
+  // the credits are used up, i.e. after 2 frames and then every 5 frames.
+  BT_HDR* credit_packet = AllocateWrappedOutgoingL2capAclPacket(
+      CreateQuickDataPacket(dlci, false, lcid, acl_handle, 5,
+                            std::vector<uint8_t>()));
+  std::vector<char> buffer(5 * frame_size);
+  size_t total_bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < num_rounds; round++) {
+    int num_frames = (round == 0) ? 2 : 5;
+    for (int i = 0; i < num_frames; i++) {
+      BT_HDR* data_packet =
+          static_cast<BT_HDR*>(osi_malloc(BT_HDR_SIZE + frame_size));
+      data_packet->offset = 0;
+      data_packet->len = frame_size;
+      memset(data_packet->data, 'a' + i, frame_size);
+      PORT_DataInd(&mcb, dlci, data_packet);
+    }
+    EXPECT_CALL(l2cap_interface_, DataWrite(lcid, BtHdrEqual(credit_packet)))
+        .WillOnce([](uint16_t, BT_HDR* p_data) -> uint8_t {
+          osi_free(p_data);
+          return L2CAP_DW_SUCCESS;
+        });
+    uint16_t length = 0;
+    ASSERT_EQ(PORT_ReadData(server_handle, buffer.data(), buffer.size(),
+                            &length),
+              PORT_SUCCESS);
+    ASSERT_EQ(length, num_frames * frame_size);
+    for (int i = 0; i < num_frames; i++) {
+      ASSERT_EQ(buffer[i * frame_size], 'a' + i);
+      ASSERT_EQ(buffer[(i + 1) * frame_size - 1], 'a' + i);
+    }
+    ASSERT_EQ(p_port->credit_rx, p_port->credit_rx_max);
+    total_bytes += length;
+  }
+  auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  LOG(INFO) << "Received " << total_bytes << " bytes in " << elapsed_us
+            << " us, " << total_bytes / std::max<int64_t>(elapsed_us, 1)
+            << " MB/s";
+  osi_free(credit_packet);
+
+  p_port->rfc.p_mcb = nullptr;
+  fixed_queue_free(mcb.cmd_q, osi_free);
+}
+
 TEST_F(StackRfcommTest, DISABLED_MultiServerPortSameDeviceHelloWorld) {
   // Prepare a server channel at kTestChannelNumber0
   static const uint16_t acl_handle = 0x0009;
@@ -19,12 +19,16 @@
 #include <stdlib.h>
 
 #include <cstddef>
+#include <cstring>
+#include <vector>
 
 #include "stack/include/sdp_api.h"
 #include "stack/sdp/sdpint.h"
 #include "test/mock/mock_osi_allocator.h"
 #include "test/mock/mock_stack_l2cap_api.h"
 
+using bluetooth::Uuid;
+
 #ifndef BT_DEFAULT_BUFFER_SIZE
 #define BT_DEFAULT_BUFFER_SIZE (4096 + 16)
 #endif
@@ -172,3 +176,230 @@ TEST_F(StackSdpMainTest, sdp_service_search_request_queuing_race_condition) {
 
   sdp_disconnect(p_ccb2, SDP_SUCCESS);
 }
+
+TEST_F(StackSdpMainTest, sdp_db_service_search_uuid_index) {
+  uint16_t spp_uuid = UUID_SERVCLASS_SERIAL_PORT;
+  uint16_t opp_uuid = UUID_SERVCLASS_OBEX_OBJECT_PUSH;
+  tSDP_PROTOCOL_ELEM proto[2] = {};
+  proto[0].protocol_uuid = UUID_PROTOCOL_L2CAP;
+  proto[1].protocol_uuid = UUID_PROTOCOL_RFCOMM;
+  proto[1].num_params = 1;
+  proto[1].params[0] = 3;
+
+  uint32_t spp_handle = SDP_CreateRecord();
+  uint32_t opp_handle = SDP_CreateRecord();
+  ASSERT_TRUE(SDP_AddServiceClassIdList(spp_handle, 1, &spp_uuid));
+  ASSERT_TRUE(SDP_AddProtocolList(spp_handle, 2, proto));
+  ASSERT_TRUE(SDP_AddServiceClassIdList(opp_handle, 1, &opp_uuid));
+  ASSERT_TRUE(SDP_AddProtocolList(opp_handle, 2, proto));
+  const tSDP_RECORD* p_spp = sdp_db_find_record(spp_handle);
+  const tSDP_RECORD* p_opp = sdp_db_find_record(opp_handle);
+
+  // The nested RFCOMM UUID matches in its 128-bit form
+  const uint8_t rfcomm_uuid[] = {0x00, 0x00, 0x00, 0x03, 0x00, 0x00,
+                                 0x10, 0x00, 0x80, 0x00, 0x00, 0x80,
+                                 0x5F, 0x9B, 0x34, 0xFB};
+  tSDP_UUID_SEQ seq = {};
+  seq.num_uids = 1;
+  seq.uuid_entry[0].len = sizeof(rfcomm_uuid);
+  memcpy(seq.uuid_entry[0].value, rfcomm_uuid, sizeof(rfcomm_uuid));
+  EXPECT_EQ(sdp_db_service_search(nullptr, &seq), p_spp);
+  EXPECT_EQ(sdp_db_service_search(p_spp, &seq), p_opp);
+  EXPECT_EQ(sdp_db_service_search(p_opp, &seq), nullptr);
+
+  // Every UUID must be in the record
+  seq.num_uids = 2;
+  seq.uuid_entry[1].len = 2;
+  seq.uuid_entry[1].value[0] = opp_uuid >> 8;
+  seq.uuid_entry[1].value[1] = opp_uuid & 0xff;
+  EXPECT_EQ(sdp_db_service_search(nullptr, &seq), p_opp);
+
+  ASSERT_TRUE(SDP_DeleteAttribute(opp_handle, ATTR_ID_SERVICE_CLASS_ID_LIST));
+  EXPECT_EQ(sdp_db_service_search(nullptr, &seq), nullptr);
+
+  const tSDP_ATTRIBUTE* p_attr = sdp_db_find_attr_in_rec(
+      p_spp, ATTR_ID_SERVICE_CLASS_ID_LIST, ATTR_ID_PROTOCOL_DESC_LIST);
+  ASSERT_NE(p_attr, nullptr);
+  EXPECT_EQ(p_attr->id, ATTR_ID_SERVICE_CLASS_ID_LIST);
+  p_attr = sdp_db_find_attr_in_rec(p_spp, ATTR_ID_PROTOCOL_DESC_LIST, 0xffff);
+  ASSERT_NE(p_attr, nullptr);
+  EXPECT_EQ(p_attr->id, ATTR_ID_PROTOCOL_DESC_LIST);
+  EXPECT_EQ(sdp_db_find_attr_in_rec(p_spp, 0x0002, 0x0003), nullptr);
+
+  SDP_DeleteRecord(0);
+}
+
+TEST_F(StackSdpMainTest, sdp_db_get_attr_list) {
+  uint16_t spp_uuid = UUID_SERVCLASS_SERIAL_PORT;
+  uint16_t avrc_uuid = UUID_SERVCLASS_AV_REM_CTRL_TARGET;
+  tSDP_PROTOCOL_ELEM proto[2] = {};
+  proto[0].protocol_uuid = UUID_PROTOCOL_L2CAP;
+  proto[1].protocol_uuid = UUID_PROTOCOL_RFCOMM;
+  proto[1].num_params = 1;
+  proto[1].params[0] = 3;
+
+  uint32_t handle = SDP_CreateRecord();
+  ASSERT_TRUE(SDP_AddServiceClassIdList(handle, 1, &spp_uuid));
+  ASSERT_TRUE(SDP_AddProtocolList(handle, 2, proto));
+
+  tSDP_UUID_SEQ uid_seq = {};
+  uid_seq.num_uids = 1;
+  uid_seq.uuid_entry[0].len = 2;
+  uid_seq.uuid_entry[0].value[0] = spp_uuid >> 8;
+  uid_seq.uuid_entry[0].value[1] = spp_uuid & 0xff;
+  tSDP_ATTR_SEQ attr_seq = {};
+  attr_seq.num_attr = 1;
+  attr_seq.attr_entry[0].start = 0x0000;
+  attr_seq.attr_entry[0].end = 0xffff;
+
+  // Record handle, service class and protocol list in one record sequence
+  uint16_t list_len;
+  const uint8_t* p_list = sdp_db_get_attr_list(&uid_seq, &attr_seq, &list_len);
+  ASSERT_NE(p_list, nullptr);
+  ASSERT_EQ(list_len, 38);
+  const uint8_t header[] = {0x35, 36, 0x36, 0x00, 33, 0x09, 0x00, 0x00};
+  EXPECT_EQ(memcmp(p_list, header, sizeof(header)), 0);
+  EXPECT_EQ(sdp_db_get_attr_list(&uid_seq, &attr_seq, &list_len), p_list);
+
+  // The cached response is rebuilt after the record is modified
+  char name[] = "SPP";
+  ASSERT_TRUE(SDP_AddAttribute(handle, ATTR_ID_SERVICE_NAME,
+                               TEXT_STR_DESC_TYPE, sizeof(name),
+                               (uint8_t*)name));
+  ASSERT_NE(sdp_db_get_attr_list(&uid_seq, &attr_seq, &list_len), nullptr);
+  EXPECT_EQ(list_len, 38 + 9);
+
+  // The AVRCP Target records are adjusted to each peer, and not cached
+  handle = SDP_CreateRecord();
+  ASSERT_TRUE(SDP_AddServiceClassIdList(handle, 1, &avrc_uuid));
+  uid_seq.uuid_entry[0].value[0] = avrc_uuid >> 8;
+  uid_seq.uuid_entry[0].value[1] = avrc_uuid & 0xff;
+  EXPECT_EQ(sdp_db_get_attr_list(&uid_seq, &attr_seq, &list_len), nullptr);
+
+  SDP_DeleteRecord(0);
+}
+
+namespace {
+
+// ServiceSearchAttribute response holding the attribute `list`
+BT_HDR* make_search_attr_rsp(const std::vector<uint8_t>& list) {
+  BT_HDR* p_msg = (BT_HDR*)malloc(sizeof(BT_HDR) + list.size() + 8);
+  uint8_t* p = (uint8_t*)(p_msg + 1);
+  uint16_t param_len = list.size() + 3;
+
+  p_msg->offset = 0;
+  *p++ = SDP_PDU_SERVICE_SEARCH_ATTR_RSP;
+  *p++ = 0x00;  // Transaction ID
+  *p++ = 0x00;
+  *p++ = param_len >> 8;
+  *p++ = param_len & 0xff;
+  *p++ = list.size() >> 8;
+  *p++ = list.size() & 0xff;
+  memcpy(p, list.data(), list.size());
+  p += list.size();
+  *p++ = 0x00;  // No continuation
+  p_msg->len = p - (uint8_t*)(p_msg + 1);
+  return p_msg;
+}
+
+void server_rsp(tCONN_CB* p_ccb, const std::vector<uint8_t>& list) {
+  BT_HDR* p_msg = make_search_attr_rsp(list);
+  sdp_disc_server_rsp(p_ccb, p_msg);
+  free(p_msg);
+}
+
+// SDP server record with a ServiceDatabaseState of 0x12345678
+const std::vector<uint8_t> kDbStateList = {0x35, 0x0a, 0x35, 0x08,
+                                           0x09, 0x02, 0x01, 0x0a,
+                                           0x12, 0x34, 0x56, 0x78};
+// Serial port record, with its service class ID list
+const std::vector<uint8_t> kSppList = {0x35, 0x0a, 0x35, 0x08, 0x09, 0x00,
+                                       0x01, 0x35, 0x03, 0x19, 0x11, 0x01};
+
+int data_write_count = 0;
+int disc_cmpl_count = 0;
+tSDP_RESULT disc_cmpl_result;
+
+void disc_cmpl_cb(tSDP_RESULT result) {
+  disc_cmpl_count++;
+  disc_cmpl_result = result;
+}
+
+}  // namespace
+
+TEST_F(StackSdpMainTest, sdp_service_search_attr_request_cached) {
+  Uuid uuid = Uuid::From16Bit(UUID_SERVCLASS_SERIAL_PORT);
+  tL2CAP_CFG_INFO cfg;
+  data_write_count = 0;
+  disc_cmpl_count = 0;
+  test::mock::stack_l2cap_api::L2CA_DataWrite.body = [](uint16_t cid,
+                                                        BT_HDR* p_data) {
+    data_write_count++;
+    osi_free_and_reset((void**)&p_data);
+    return 0;
+  };
+
+  // The first search reads the state, then the attributes
+  SDP_InitDiscoveryDb(sdp_db, BT_DEFAULT_BUFFER_SIZE, 1, &uuid, 0, nullptr);
+  ASSERT_TRUE(SDP_ServiceSearchAttributeRequest(addr, sdp_db, disc_cmpl_cb));
+  tCONN_CB* p_ccb = sdpu_find_ccb_by_cid(L2CA_ConnectReq2_cid);
+  ASSERT_NE(p_ccb, nullptr);
+  sdp_cb.reg_info.pL2CA_ConfigCfm_Cb(p_ccb->connection_id, 0, &cfg);
+  ASSERT_EQ(p_ccb->disc_state, SDP_DISC_WAIT_DB_STATE);
+  server_rsp(p_ccb, kDbStateList);
+  ASSERT_EQ(p_ccb->disc_state, SDP_DISC_WAIT_SEARCH_ATTR);
+  server_rsp(p_ccb, kSppList);
+  sdp_cb.reg_info.pL2CA_DisconnectCfm_Cb(p_ccb->connection_id, 0);
+  ASSERT_EQ(disc_cmpl_count, 1);
+  ASSERT_EQ(disc_cmpl_result, SDP_SUCCESS);
+  ASSERT_NE(sdp_db->p_first_rec, nullptr);
+  ASSERT_EQ(data_write_count, 2);
+
+  // The next identical search only reads the unchanged state
+  SDP_InitDiscoveryDb(sdp_db, BT_DEFAULT_BUFFER_SIZE, 1, &uuid, 0, nullptr);
+  ASSERT_TRUE(SDP_ServiceSearchAttributeRequest(addr, sdp_db, disc_cmpl_cb));
+  p_ccb = sdpu_find_ccb_by_cid(L2CA_ConnectReq2_cid);
+  ASSERT_NE(p_ccb, nullptr);
+  sdp_cb.reg_info.pL2CA_ConfigCfm_Cb(p_ccb->connection_id, 0, &cfg);
+  server_rsp(p_ccb, kDbStateList);
+  sdp_cb.reg_info.pL2CA_DisconnectCfm_Cb(p_ccb->connection_id, 0);
+  ASSERT_EQ(disc_cmpl_count, 2);
+  ASSERT_EQ(disc_cmpl_result, SDP_SUCCESS);
+  ASSERT_NE(sdp_db->p_first_rec, nullptr);
+  ASSERT_EQ(data_write_count, 3);
+
+  sdp_disc_clear_cache();
+}
+
+TEST_F(StackSdpMainTest, sdp_service_search_attr_request_collapsed) {
+  Uuid uuid = Uuid::From16Bit(UUID_SERVCLASS_SERIAL_PORT);
+  tSDP_DISCOVERY_DB* sdp_db2 =
+      (tSDP_DISCOVERY_DB*)osi_malloc(BT_DEFAULT_BUFFER_SIZE);
+  tL2CAP_CFG_INFO cfg;
+  disc_cmpl_count = 0;
+
+  SDP_InitDiscoveryDb(sdp_db, BT_DEFAULT_BUFFER_SIZE, 1, &uuid, 0, nullptr);
+  SDP_InitDiscoveryDb(sdp_db2, BT_DEFAULT_BUFFER_SIZE, 1, &uuid, 0, nullptr);
+  ASSERT_TRUE(SDP_ServiceSearchAttributeRequest(addr, sdp_db, disc_cmpl_cb));
+  const int cid = L2CA_ConnectReq2_cid;
+  tCONN_CB* p_ccb1 = find_ccb(cid, SDP_STATE_CONN_SETUP);
+  ASSERT_NE(p_ccb1, nullptr);
+  ASSERT_TRUE(SDP_ServiceSearchAttributeRequest(addr, sdp_db2, disc_cmpl_cb));
+  tCONN_CB* p_ccb2 = find_ccb(cid, SDP_STATE_CONN_PEND);
+  ASSERT_NE(p_ccb2, nullptr);
+
+  // The pending search is served with the response to the first one
+  sdp_cb.reg_info.pL2CA_ConfigCfm_Cb(p_ccb1->connection_id, 0, &cfg);
+  server_rsp(p_ccb1, kDbStateList);
+  server_rsp(p_ccb1, kSppList);
+  ASSERT_EQ(p_ccb2->con_state, SDP_STATE_IDLE);
+  ASSERT_EQ(disc_cmpl_count, 1);
+  ASSERT_NE(sdp_db2->p_first_rec, nullptr);
+
+  sdp_cb.reg_info.pL2CA_DisconnectCfm_Cb(p_ccb1->connection_id, 0);
+  ASSERT_EQ(disc_cmpl_count, 2);
+  ASSERT_NE(sdp_db->p_first_rec, nullptr);
+
+  sdp_disc_clear_cache();
+  osi_free(sdp_db2);
+}
@@ -1000,6 +1000,49 @@ TEST_F(A2dpCodecConfigTest, createCodec) {
   }
 }
 
+TEST_F(A2dpCodecConfigTest, softwareCpuCost) {
+  for (int i = BTAV_A2DP_CODEC_INDEX_MIN; i < BTAV_A2DP_CODEC_INDEX_MAX; i++) {
+    btav_a2dp_codec_index_t codec_index =
+        static_cast<btav_a2dp_codec_index_t>(i);
+
+    // Ignore codecs that are not supported on the device
+    if (!has_codec_support(codec_index)) {
+      continue;
+    }
+
+    A2dpCodecConfig* codec_config = A2dpCodecConfig::createCodec(codec_index);
+    ASSERT_NE(codec_config, nullptr);
+    EXPECT_GE(codec_config->softwareCpuCost(), 1);
+    EXPECT_NE(codec_config->softwareCpuCost(), UINT8_MAX);
+    EXPECT_FALSE(codec_config->isOffloadSupported());
+    delete codec_config;
+  }
+}
+
+TEST_F(A2dpCodecConfigTest, init_same_priority_prefers_lower_cpu_cost) {
+  if (!has_codec_support(BTAV_A2DP_CODEC_INDEX_SOURCE_AAC)) {
+    return;
+  }
+
+  std::vector<btav_a2dp_codec_config_t> codec_priorities;
+  for (auto codec_index :
+       {BTAV_A2DP_CODEC_INDEX_SOURCE_SBC, BTAV_A2DP_CODEC_INDEX_SOURCE_AAC}) {
+    btav_a2dp_codec_config_t codec_config = {};
+    codec_config.codec_type = codec_index;
+    codec_config.codec_priority = static_cast<btav_a2dp_codec_priority_t>(2000);
+    codec_priorities.push_back(codec_config);
+  }
+  A2dpCodecs codecs(codec_priorities);
+  EXPECT_TRUE(codecs.init());
+
+  // SBC is cheaper to run than AAC, so it wins the tie
+  const std::list<A2dpCodecConfig*> orderedSourceCodecs =
+      codecs.orderedSourceCodecs();
+  ASSERT_FALSE(orderedSourceCodecs.empty());
+  EXPECT_EQ(orderedSourceCodecs.front()->codecIndex(),
+            BTAV_A2DP_CODEC_INDEX_SOURCE_SBC);
+}
+
 TEST_F(A2dpCodecConfigTest, setCodecConfig) {
   uint8_t codec_info_result[AVDT_CODEC_SIZE];
   btav_a2dp_codec_index_t peer_codec_index;
@@ -87,3 +87,47 @@ TEST(GattDatabaseTest, matchExampleInBtSpecV52) {
 
   ASSERT_EQ(result_hash, expected_hash);
 }
+
+TEST(GattDatabaseTest, cachedHashMatchesFullCalculation) {
+  tGATT_SVC_DB local_db[2];
+  std::list<tGATT_SRV_LIST_ELEM> srv_list_info;
+  gatt_cb.srv_list_info = &srv_list_info;
+
+  add_item_to_list(srv_list_info, &local_db[0], true);
+  srv_list_info.back().s_hdl = 0x0001;
+  gatts_init_service_db(local_db[0], Uuid::From16Bit(0x1800), true, 0x0001, 3);
+  gatts_add_characteristic(local_db[0], GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A00));
+  gatts_invalidate_service_info(0x0001);
+  gatt_cb.database_hash_dirty = true;
+
+  Octet16 first_hash = gatts_get_database_hash();
+  ASSERT_EQ(first_hash, gatts_calculate_database_hash(&srv_list_info));
+  ASSERT_FALSE(gatt_cb.database_hash_dirty);
+  ASSERT_EQ(gatt_cb.database_info.size(), 1u);
+
+  // Start a second service: only its info is serialized again
+  add_item_to_list(srv_list_info, &local_db[1], false);
+  srv_list_info.back().s_hdl = 0x0004;
+  gatts_init_service_db(local_db[1], Uuid::From16Bit(0x180F), false, 0x0004, 3);
+  gatts_add_characteristic(local_db[1], GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A19));
+  gatts_invalidate_service_info(0x0004);
+  gatt_cb.database_hash_dirty = true;
+
+  Octet16 second_hash = gatts_get_database_hash();
+  ASSERT_NE(second_hash, first_hash);
+  ASSERT_EQ(second_hash, gatts_calculate_database_hash(&srv_list_info));
+  ASSERT_EQ(gatt_cb.database_info.size(), 2u);
+
+  // Stop the second service
+  gatts_invalidate_service_info(0x0004);
+  srv_list_info.pop_back();
+  gatt_cb.database_hash_dirty = true;
+
+  ASSERT_EQ(gatts_get_database_hash(), first_hash);
+  ASSERT_EQ(gatt_cb.database_info.size(), 1u);
+
+  gatt_cb.srv_list_info = nullptr;
+  gatt_cb.database_info.clear();
+}
@@ -16,6 +16,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "common/init_flags.h"
 #include "device/include/controller.h"
 #include "internal_include/bt_trace.h"
@@ -81,6 +83,65 @@ TEST_F(StackL2capTest, l2cble_process_data_length_change_event) {
   ASSERT_EQ(0x001b, l2cb.lcb_pool[0].tx_data_len);
 }
 
+TEST_F(StackL2capTest, l2cu_find_lcb_by_handle) {
+  l2cb.lcb_pool[1].in_use = true;
+  l2cu_set_lcb_handle(l2cb.lcb_pool[1], 0x0042);
+  ASSERT_EQ(&l2cb.lcb_pool[1], l2cu_find_lcb_by_handle(0x0042));
+  // Same entry of the handle table, different handle
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x1042));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0043));
+
+  l2cu_set_lcb_handle(l2cb.lcb_pool[1], 0x0043);
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0042));
+  ASSERT_EQ(&l2cb.lcb_pool[1], l2cu_find_lcb_by_handle(0x0043));
+
+  l2cb.lcb_pool[1].in_use = false;
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0043));
+}
+
+TEST_F(StackL2capTest, ccb_pool_grows_by_chunks) {
+  l2cb.max_ccbs = 2 * L2C_CCB_CHUNK_SIZE;
+  ASSERT_EQ(0, l2cb.num_ccbs);
+
+  std::vector<tL2C_CCB*> ccbs;
+  for (int i = 0; i < L2C_CCB_CHUNK_SIZE + 1; i++) {
+    tL2C_CCB* p_ccb = l2cu_allocate_ccb(nullptr, 0);
+    ASSERT_NE(nullptr, p_ccb);
+    ASSERT_EQ(L2CAP_BASE_APPL_CID + i, p_ccb->local_cid);
+    ccbs.push_back(p_ccb);
+  }
+  ASSERT_EQ(2 * L2C_CCB_CHUNK_SIZE, l2cb.num_ccbs);
+  ASSERT_EQ(L2C_CCB_CHUNK_SIZE + 1, l2cb.num_used_ccbs);
+
+  // The CCBs of the first chunk did not move when the pool grew
+  ASSERT_EQ(ccbs[0], l2cu_find_ccb_by_cid(nullptr, L2CAP_BASE_APPL_CID));
+  ASSERT_EQ(ccbs.back(), l2cu_find_ccb_by_cid(nullptr, ccbs.back()->local_cid));
+  ASSERT_EQ(nullptr, l2cu_find_ccb_by_cid(
+                         nullptr, L2CAP_BASE_APPL_CID + l2cb.num_ccbs));
+
+  for (tL2C_CCB* p_ccb : ccbs) l2cu_release_ccb(p_ccb);
+  ASSERT_EQ(0, l2cb.num_used_ccbs);
+  ASSERT_EQ(L2C_CCB_CHUNK_SIZE + 1, l2cb.peak_used_ccbs);
+}
+
+TEST_F(StackL2capTest, ccb_pool_keeps_le_channels_in_le_cid_range) {
+  l2cb.max_ccbs = 2 * L2C_MAX_LE_CCBS;
+  std::vector<tL2C_CCB*> ccbs;
+  for (int i = 0; i < L2C_MAX_LE_CCBS; i++) {
+    ccbs.push_back(l2cu_allocate_ccb(nullptr, 0));
+    ASSERT_NE(nullptr, ccbs.back());
+  }
+
+  // The pool may still grow, but not with CIDs LE links can use
+  l2cb.lcb_pool[0].transport = BT_TRANSPORT_LE;
+  ASSERT_EQ(nullptr, l2cu_allocate_ccb(&l2cb.lcb_pool[0], 0));
+  ccbs.push_back(l2cu_allocate_ccb(nullptr, 0));
+  ASSERT_NE(nullptr, ccbs.back());
+  ASSERT_EQ(L2C_LE_DYNAMIC_CID_END + 1, ccbs.back()->local_cid);
+
+  for (tL2C_CCB* p_ccb : ccbs) l2cu_release_ccb(p_ccb);
+}
+
 class StackL2capChannelTest : public StackL2capTest {
  protected:
   void SetUp() override { StackL2capTest::SetUp(); }
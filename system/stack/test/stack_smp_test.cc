@@ -18,6 +18,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <string>
 
@@ -412,4 +413,84 @@ TEST(SmpEccValidationTest, test_invalid_points) {
 
   EXPECT_FALSE(ECC_ValidatePoint(p));
 }
+
+// Test ECC point multiplication
+class SmpEccPointMultTest : public ::testing::TestWithParam<tECC_IMPL> {
+ protected:
+  void SetUp() override {
+    p_256_init_curve();
+    ECC_SetPointMultImpl(GetParam());
+  }
+  void TearDown() override { ECC_SetPointMultImpl(ECC_IMPL_MONT64); }
+};
+
+TEST_P(SmpEccPointMultTest, test_sample_data) {
+  // Test data from Bluetooth Core Specification
+  // Version 5.0 | Vol 2, Part G | 7.1.2
+  const uint32_t private_a[KEY_LENGTH_DWORDS_P256] = {
+      0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b,
+      0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+  const uint32_t private_b[KEY_LENGTH_DWORDS_P256] = {
+      0xf47fc5fd, 0x6b4fdd49, 0xf19d7cfb, 0x59cb9ac2,
+      0xeed4e72a, 0x900afcfb, 0x32f6bb9a, 0x55188b3d};
+  const uint32_t public_a_x[KEY_LENGTH_DWORDS_P256] = {
+      0x0e359de6, 0xcc030148, 0xacf4fddb, 0xeff49111,
+      0xe9f9a5b9, 0x5e2c83a7, 0xf297be2c, 0x20b003d2};
+  const uint32_t public_a_y[KEY_LENGTH_DWORDS_P256] = {
+      0x1589d28b, 0x741c8ed0, 0x8fed3024, 0x766345c2,
+      0x5a52155c, 0x63329abf, 0x652aeb6d, 0xdc809c49};
+  const uint32_t dhkey[KEY_LENGTH_DWORDS_P256] = {
+      0x73bfa698, 0x868d34f3, 0xb4f866f1, 0x99796b13,
+      0x0a397d9b, 0x341010a6, 0x57c8ad05, 0xec0234a3};
+
+  Point base = curve_p256.G;
+  Point public_a;
+  uint32_t n[KEY_LENGTH_DWORDS_P256];
+  memcpy(n, private_a, sizeof(n));
+  ECC_PointMult(&public_a, &base, n);
+  EXPECT_EQ(memcmp(public_a.x, public_a_x, sizeof(public_a_x)), 0);
+  EXPECT_EQ(memcmp(public_a.y, public_a_y, sizeof(public_a_y)), 0);
+
+  Point shared;
+  memcpy(n, private_b, sizeof(n));
+  ECC_PointMult(&shared, &public_a, n);
+  EXPECT_EQ(memcmp(shared.x, dhkey, sizeof(dhkey)), 0);
+  EXPECT_TRUE(ECC_ValidatePoint(shared));
+}
+
+INSTANTIATE_TEST_SUITE_P(SmpEccPointMultTests, SmpEccPointMultTest,
+                         ::testing::Values(ECC_IMPL_REFERENCE,
+                                           ECC_IMPL_MONT64));
+
+TEST(SmpEccPointMultImplTest, test_mont64_matches_reference) {
+  p_256_init_curve();
+  uint32_t seed = 1;
+  Point p = curve_p256.G;
+  for (int i = 0; i < 64; i++) {
+    uint32_t n[KEY_LENGTH_DWORDS_P256];
+    for (int j = 0; j < KEY_LENGTH_DWORDS_P256; j++) {
+      seed = seed * 1103515245 + 12345;
+      n[j] = seed;
+    }
+    // Small scalars, and scalars with leading zero bits
+    if (i < 4) {
+      multiprecision_init(n);
+      n[0] = i + 1;
+    } else if (i % 2) {
+      n[7] >>= i % 32;
+    }
+
+    // The generator, or the previous result
+    Point base = (i % 4 == 0) ? curve_p256.G : p;
+    Point expected;
+    Point actual;
+    uint32_t n_copy[KEY_LENGTH_DWORDS_P256];
+    memcpy(n_copy, n, sizeof(n));
+    ECC_PointMult_Mont64(&actual, &base, n);
+    ECC_PointMult_Bin_NAF(&expected, &base, n_copy);
+    ASSERT_EQ(memcmp(actual.x, expected.x, sizeof(actual.x)), 0) << i;
+    ASSERT_EQ(memcmp(actual.y, expected.y, sizeof(actual.y)), 0) << i;
+    p = actual;
+  }
+}
 }  // namespace testing
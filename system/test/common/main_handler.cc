@@ -52,6 +52,11 @@ bt_status_t do_in_main_thread_delayed(const base::Location& from_here,
   return BT_STATUS_SUCCESS;
 }
 
+bt_status_t do_in_main_thread_or_run(const base::Location& from_here,
+                                     base::OnceClosure task) {
+  return do_in_main_thread(from_here, std::move(task));
+}
+
 void post_on_bt_main(BtMainClosure closure) {
   ASSERT(do_in_main_thread(
              FROM_HERE, base::Bind(do_post_on_bt_main, std::move(closure))) ==
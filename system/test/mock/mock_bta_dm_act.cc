@@ -73,6 +73,7 @@ struct bta_dm_disable bta_dm_disable;
 struct bta_dm_disc_result bta_dm_disc_result;
 struct bta_dm_disc_rmt_name bta_dm_disc_rmt_name;
 struct bta_dm_discover bta_dm_discover;
+struct bta_dm_dump_discovery_records bta_dm_dump_discovery_records;
 struct bta_dm_eir_update_cust_uuid bta_dm_eir_update_cust_uuid;
 struct bta_dm_eir_update_uuid bta_dm_eir_update_uuid;
 struct bta_dm_enable bta_dm_enable;
@@ -258,6 +259,10 @@ void bta_dm_discover(tBTA_DM_MSG* p_data) {
   mock_function_count_map[__func__]++;
   test::mock::bta_dm_act::bta_dm_discover(p_data);
 }
+void bta_dm_dump_discovery_records(int fd) {
+  mock_function_count_map[__func__]++;
+  test::mock::bta_dm_act::bta_dm_dump_discovery_records(fd);
+}
 void bta_dm_eir_update_cust_uuid(const tBTA_CUSTOM_UUID& curr, bool adding) {
   mock_function_count_map[__func__]++;
   test::mock::bta_dm_act::bta_dm_eir_update_cust_uuid(curr, adding);
@@ -476,6 +476,15 @@ struct bta_dm_discover {
 };
 extern struct bta_dm_discover bta_dm_discover;
 
+// Name: bta_dm_dump_discovery_records
+// Params: int fd
+// Return: void
+struct bta_dm_dump_discovery_records {
+  std::function<void(int fd)> body{[](int fd) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct bta_dm_dump_discovery_records bta_dm_dump_discovery_records;
+
 // Name: bta_dm_eir_update_cust_uuid
 // Params: const tBTA_CUSTOM_UUID& curr, bool adding
 // Return: void
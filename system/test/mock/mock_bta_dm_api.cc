@@ -59,6 +59,8 @@ struct BTA_DmBondCancel BTA_DmBondCancel;
 struct BTA_DmCloseACL BTA_DmCloseACL;
 struct BTA_DmConfirm BTA_DmConfirm;
 struct BTA_DmDiscover BTA_DmDiscover;
+struct BTA_DmDumpDiscoveryStatistics BTA_DmDumpDiscoveryStatistics;
+struct BTA_DmDumpPowerModeStatistics BTA_DmDumpPowerModeStatistics;
 struct BTA_DmGetConnectionState BTA_DmGetConnectionState;
 struct BTA_DmLocalOob BTA_DmLocalOob;
 struct BTA_DmPinReply BTA_DmPinReply;
@@ -167,6 +169,14 @@ void BTA_DmDiscover(const RawAddress& bd_addr, tBTA_DM_SEARCH_CBACK* p_cback,
   mock_function_count_map[__func__]++;
   test::mock::bta_dm_api::BTA_DmDiscover(bd_addr, p_cback, transport);
 }
+void BTA_DmDumpDiscoveryStatistics(int fd) {
+  mock_function_count_map[__func__]++;
+  test::mock::bta_dm_api::BTA_DmDumpDiscoveryStatistics(fd);
+}
+void BTA_DmDumpPowerModeStatistics(int fd) {
+  mock_function_count_map[__func__]++;
+  test::mock::bta_dm_api::BTA_DmDumpPowerModeStatistics(fd);
+}
 bool BTA_DmGetConnectionState(const RawAddress& bd_addr) {
   mock_function_count_map[__func__]++;
   return test::mock::bta_dm_api::BTA_DmGetConnectionState(bd_addr);
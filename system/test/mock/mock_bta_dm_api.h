@@ -293,6 +293,24 @@ struct BTA_DmDiscover {
 };
 extern struct BTA_DmDiscover BTA_DmDiscover;
 
+// Name: BTA_DmDumpDiscoveryStatistics
+// Params: int fd
+// Return: void
+struct BTA_DmDumpDiscoveryStatistics {
+  std::function<void(int fd)> body{[](int fd) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct BTA_DmDumpDiscoveryStatistics BTA_DmDumpDiscoveryStatistics;
+
+// Name: BTA_DmDumpPowerModeStatistics
+// Params: int fd
+// Return: void
+struct BTA_DmDumpPowerModeStatistics {
+  std::function<void(int fd)> body{[](int fd) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct BTA_DmDumpPowerModeStatistics BTA_DmDumpPowerModeStatistics;
+
 // Name: BTA_DmGetConnectionState
 // Params: const RawAddress& bd_addr
 // Return: bool
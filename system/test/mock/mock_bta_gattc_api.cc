@@ -136,7 +136,8 @@ void BTA_GATTC_ReadCharacteristic(uint16_t conn_id, uint16_t handle,
   mock_function_count_map[__func__]++;
 }
 void BTA_GATTC_ReadMultiple(uint16_t conn_id, tBTA_GATTC_MULTI* p_read_multi,
-                            tGATT_AUTH_REQ auth_req) {
+                            tGATT_AUTH_REQ auth_req, bool variable_len,
+                            GATT_READ_MULTI_OP_CB callback, void* cb_data) {
   mock_function_count_map[__func__]++;
 }
 void BTA_GATTC_ReadUsingCharUuid(uint16_t conn_id, const bluetooth::Uuid& uuid,
@@ -148,6 +149,13 @@ void BTA_GATTC_ReadUsingCharUuid(uint16_t conn_id, const bluetooth::Uuid& uuid,
 void BTA_GATTC_Refresh(const RawAddress& remote_bda) {
   mock_function_count_map[__func__]++;
 }
+void BTA_GATTC_SetConnectionProfile(tGATT_IF client_if,
+                                    tGATT_CONN_PROFILE profile) {
+  mock_function_count_map[__func__]++;
+}
+void BTA_GATTC_DumpDiscoveryStatistics(int fd) {
+  mock_function_count_map[__func__]++;
+}
 void BTA_GATTC_SendIndConfirm(uint16_t conn_id, uint16_t cid) {
   mock_function_count_map[__func__]++;
 }
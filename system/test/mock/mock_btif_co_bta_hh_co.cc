@@ -53,6 +53,11 @@ void bta_hh_co_data(uint8_t dev_handle, uint8_t* p_rpt, uint16_t len,
                     uint8_t app_id) {
   mock_function_count_map[__func__]++;
 }
+void bta_hh_co_input_report(uint8_t dev_handle, uint8_t rpt_id,
+                            const uint8_t* p_data, uint16_t len,
+                            uint64_t rx_time_us) {
+  mock_function_count_map[__func__]++;
+}
 void bta_hh_co_destroy(int fd) { mock_function_count_map[__func__]++; }
 void bta_hh_co_get_rpt_rsp(uint8_t dev_handle, uint8_t status, uint8_t* p_rpt,
                            uint16_t len) {
@@ -18,8 +18,11 @@
  * Generated mock file from original source file
  */
 
+#include "btif/include/stack_manager.h"
 #include "osi/include/future.h"
 
 static future_t* hack_future;
 
 future_t* stack_manager_get_hack_future() { return hack_future; }
+
+void stack_manager_init_profile(stack_profile_t profile) {}
@@ -121,6 +121,10 @@ bt_status_t btif_storage_load_bonded_devices(void) {
   mock_function_count_map[__func__]++;
   return BT_STATUS_SUCCESS;
 }
+bt_status_t btif_storage_load_bonded_and_le_devices(void) {
+  mock_function_count_map[__func__]++;
+  return BT_STATUS_SUCCESS;
+}
 bt_status_t btif_storage_load_bonded_hid_info(void) {
   mock_function_count_map[__func__]++;
   return BT_STATUS_SUCCESS;
@@ -208,6 +208,17 @@ bool MessageLoopThread::EnableRealTimeScheduling() {
   return true;
 }
 
+bool MessageLoopThread::ApplyThreadPolicy(
+    const os::ThreadPolicy& default_policy) {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+
+  if (!IsRunning()) {
+    LOG(ERROR) << __func__ << ": thread " << *this << " is not running";
+    return false;
+  }
+  return true;
+}
+
 base::WeakPtr<MessageLoopThread> MessageLoopThread::GetWeakPtr() {
   std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
   return weak_ptr_factory_.GetWeakPtr();
@@ -72,6 +72,7 @@ neighbor::InquiryModule* GetInquiry() { return nullptr; }
 neighbor::NameModule* GetName() { return nullptr; }
 neighbor::PageModule* GetPage() { return nullptr; }
 os::Handler* GetGdShimHandler() { return hci::testing::mock_gd_shim_handler_; }
+os::Thread* GetGdShimThread() { return nullptr; }
 security::SecurityModule* GetSecurityModule() { return nullptr; }
 storage::StorageModule* GetStorage() { return nullptr; }
 metrics::CounterMetrics* GetCounterMetrics() { return nullptr; }
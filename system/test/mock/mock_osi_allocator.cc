@@ -38,6 +38,8 @@ namespace mock {
 namespace osi_allocator {
 
 // Function state capture and return values, if needed
+struct osi_buffer_alloc osi_buffer_alloc;
+struct osi_buffer_pool_init osi_buffer_pool_init;
 struct osi_calloc osi_calloc;
 struct osi_free osi_free;
 struct osi_free_and_reset osi_free_and_reset;
@@ -50,6 +52,14 @@ struct osi_strndup osi_strndup;
 }  // namespace test
 
 // Mocked functions, if any
+void* osi_buffer_alloc(size_t size) {
+  mock_function_count_map[__func__]++;
+  return test::mock::osi_allocator::osi_buffer_alloc(size);
+}
+void osi_buffer_pool_init(bool enabled) {
+  mock_function_count_map[__func__]++;
+  test::mock::osi_allocator::osi_buffer_pool_init(enabled);
+}
 void* osi_calloc(size_t size) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_allocator::osi_calloc(size);
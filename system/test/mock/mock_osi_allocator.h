@@ -49,6 +49,26 @@ namespace mock {
 namespace osi_allocator {
 
 // Shared state between mocked functions and tests
+// Name: osi_buffer_alloc
+// Params: size_t size
+// Return: void*
+struct osi_buffer_alloc {
+  void* return_value{};
+  std::function<void*(size_t size)> body{
+      [this](size_t size) { return return_value; }};
+  void* operator()(size_t size) { return body(size); };
+};
+extern struct osi_buffer_alloc osi_buffer_alloc;
+
+// Name: osi_buffer_pool_init
+// Params: bool enabled
+// Return: void
+struct osi_buffer_pool_init {
+  std::function<void(bool enabled)> body{[](bool enabled) {}};
+  void operator()(bool enabled) { body(enabled); };
+};
+extern struct osi_buffer_pool_init osi_buffer_pool_init;
+
 // Name: osi_calloc
 // Params: size_t size
 // Return: void*
@@ -352,6 +352,14 @@ void A2dpCodecConfig::setCodecPriority(
 void A2dpCodecConfig::setDefaultCodecPriority() {
   mock_function_count_map[__func__]++;
 }
+uint8_t A2dpCodecConfig::softwareCpuCost() const {
+  mock_function_count_map[__func__]++;
+  return 0;
+}
+bool A2dpCodecConfig::isOffloadSupported() const {
+  mock_function_count_map[__func__]++;
+  return false;
+}
 void A2dpCodecs::debug_codec_dump(int fd) {
   mock_function_count_map[__func__]++;
 }
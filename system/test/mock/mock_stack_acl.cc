@@ -71,6 +71,8 @@ struct acl_peer_supports_sniff_subrating acl_peer_supports_sniff_subrating;
 struct acl_refresh_remote_address acl_refresh_remote_address;
 struct acl_set_peer_le_features_from_handle
     acl_set_peer_le_features_from_handle;
+struct acl_ble_set_tx_data_length acl_ble_set_tx_data_length;
+struct acl_ble_set_tx_phy acl_ble_set_tx_phy;
 struct sco_peer_supports_esco_2m_phy sco_peer_supports_esco_2m_phy;
 struct sco_peer_supports_esco_3m_phy sco_peer_supports_esco_3m_phy;
 struct acl_create_classic_connection acl_create_classic_connection;
@@ -281,6 +283,14 @@ bool acl_set_peer_le_features_from_handle(uint16_t hci_handle,
   return test::mock::stack_acl::acl_set_peer_le_features_from_handle(hci_handle,
                                                                      p);
 }
+void acl_ble_set_tx_data_length(uint16_t hci_handle, uint16_t tx_octets) {
+  mock_function_count_map[__func__]++;
+  test::mock::stack_acl::acl_ble_set_tx_data_length(hci_handle, tx_octets);
+}
+void acl_ble_set_tx_phy(uint16_t hci_handle, uint8_t tx_phy) {
+  mock_function_count_map[__func__]++;
+  test::mock::stack_acl::acl_ble_set_tx_phy(hci_handle, tx_phy);
+}
 bool sco_peer_supports_esco_2m_phy(const RawAddress& remote_bda) {
   mock_function_count_map[__func__]++;
   return test::mock::stack_acl::sco_peer_supports_esco_2m_phy(remote_bda);
@@ -300,6 +300,28 @@ struct acl_set_peer_le_features_from_handle {
 };
 extern struct acl_set_peer_le_features_from_handle
     acl_set_peer_le_features_from_handle;
+// Name: acl_ble_set_tx_data_length
+// Params: uint16_t hci_handle, uint16_t tx_octets
+// Returns: void
+struct acl_ble_set_tx_data_length {
+  std::function<void(uint16_t hci_handle, uint16_t tx_octets)> body{
+      [](uint16_t hci_handle, uint16_t tx_octets) { ; }};
+  void operator()(uint16_t hci_handle, uint16_t tx_octets) {
+    body(hci_handle, tx_octets);
+  };
+};
+extern struct acl_ble_set_tx_data_length acl_ble_set_tx_data_length;
+// Name: acl_ble_set_tx_phy
+// Params: uint16_t hci_handle, uint8_t tx_phy
+// Returns: void
+struct acl_ble_set_tx_phy {
+  std::function<void(uint16_t hci_handle, uint8_t tx_phy)> body{
+      [](uint16_t hci_handle, uint8_t tx_phy) { ; }};
+  void operator()(uint16_t hci_handle, uint8_t tx_phy) {
+    body(hci_handle, tx_phy);
+  };
+};
+extern struct acl_ble_set_tx_phy acl_ble_set_tx_phy;
 // Name: sco_peer_supports_esco_2m_phy
 // Params: const RawAddress& remote_bda
 // Returns: bool
@@ -32,6 +32,7 @@ extern std::map<std::string, int> mock_function_count_map;
 #include "stack/btm/btm_sec.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/include/acl_api.h"
+#include "stack/include/gatt_api.h"
 #include "stack/include/l2cap_hci_link_interface.h"
 #include "types/ble_address_with_type.h"
 #include "types/hci_role.h"
@@ -82,3 +83,8 @@ void acl_ble_data_length_change_event(uint16_t handle, uint16_t max_tx_octets,
                                       uint16_t max_rx_time) {
   mock_function_count_map[__func__]++;
 }
+
+void acl_ble_phy_update_event(tGATT_STATUS status, uint16_t handle,
+                              uint8_t tx_phy, uint8_t rx_phy) {
+  mock_function_count_map[__func__]++;
+}
@@ -122,6 +122,22 @@ tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda) {
   mock_function_count_map[__func__]++;
   return nullptr;
 }
+void btm_inq_db_remove(tINQ_DB_ENT* p_ent) {
+  mock_function_count_map[__func__]++;
+}
+void btm_rmt_name_cache_update(const RawAddress& bda, const uint8_t* p_name,
+                               uint16_t len) {
+  mock_function_count_map[__func__]++;
+}
+void btm_rmt_name_cache_update_from_eir(const RawAddress& bda,
+                                        const uint8_t* p_eir, size_t eir_len) {
+  mock_function_count_map[__func__]++;
+}
+bool btm_rmt_name_cache_read(const RawAddress& bda,
+                             tBTM_REMOTE_DEV_NAME* p_name) {
+  mock_function_count_map[__func__]++;
+  return false;
+}
 uint16_t BTM_IsInquiryActive(void) {
   mock_function_count_map[__func__]++;
   return 0;
@@ -76,6 +76,7 @@ uint8_t BTM_GetNumScoLinks(void) {
   mock_function_count_map[__func__]++;
   return 0;
 }
+void BTM_DumpScoStatistics(int fd) { mock_function_count_map[__func__]++; }
 void BTM_EScoConnRsp(uint16_t sco_inx, uint8_t hci_status,
                      enh_esco_params_t* p_parms) {
   mock_function_count_map[__func__]++;
@@ -48,3 +48,7 @@ tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
   mock_function_count_map[__func__]++;
   return GATT_SUCCESS;
 }
+uint8_t GATTC_GetBearerCount(uint16_t conn_id) {
+  mock_function_count_map[__func__]++;
+  return 1;
+}
@@ -42,6 +42,7 @@ namespace stack_gatt_api {
 // Function state capture and return values, if needed
 struct GATTC_ConfigureMTU GATTC_ConfigureMTU;
 struct GATTC_Discover GATTC_Discover;
+struct GATTC_GetBearerCount GATTC_GetBearerCount;
 struct GATTC_ExecuteWrite GATTC_ExecuteWrite;
 struct GATTC_Read GATTC_Read;
 struct GATTC_SendHandleValueConfirm GATTC_SendHandleValueConfirm;
@@ -76,6 +77,7 @@ namespace stack_gatt_api {
 
 tGATT_STATUS GATTC_ConfigureMTU::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_Discover::return_value = GATT_SUCCESS;
+uint8_t GATTC_GetBearerCount::return_value = 1;
 tGATT_STATUS GATTC_ExecuteWrite::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_Read::return_value = GATT_SUCCESS;
 tGATT_STATUS GATTC_SendHandleValueConfirm::return_value = GATT_SUCCESS;
@@ -111,6 +113,10 @@ tGATT_STATUS GATTC_Discover(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
   return test::mock::stack_gatt_api::GATTC_Discover(conn_id, disc_type,
                                                     start_handle, end_handle);
 }
+uint8_t GATTC_GetBearerCount(uint16_t conn_id) {
+  mock_function_count_map[__func__]++;
+  return test::mock::stack_gatt_api::GATTC_GetBearerCount(conn_id);
+}
 tGATT_STATUS GATTC_ExecuteWrite(uint16_t conn_id, bool is_execute) {
   mock_function_count_map[__func__]++;
   return test::mock::stack_gatt_api::GATTC_ExecuteWrite(conn_id, is_execute);
@@ -236,5 +242,20 @@ bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
   return test::mock::stack_gatt_api::GATT_Connect(
       gatt_if, bd_addr, connection_type, transport, opportunistic, 0);
 }
+bool GATT_Connect(tGATT_IF gatt_if, const RawAddress& bd_addr,
+                  tBTM_BLE_CONN_TYPE connection_type, tBT_TRANSPORT transport,
+                  bool opportunistic, uint8_t initiating_phys,
+                  tGATT_CONN_PROFILE conn_profile) {
+  mock_function_count_map[__func__]++;
+  return test::mock::stack_gatt_api::GATT_Connect(
+      gatt_if, bd_addr, connection_type, transport, opportunistic,
+      initiating_phys);
+}
+void GATT_SetConnectionProfile(tGATT_IF gatt_if, tGATT_CONN_PROFILE profile) {
+  mock_function_count_map[__func__]++;
+}
+void GATT_DumpConnectionStatistics(int fd) {
+  mock_function_count_map[__func__]++;
+}
 
 // END mockcify generation
@@ -95,6 +95,17 @@ struct GATTC_Discover {
 };
 extern struct GATTC_Discover GATTC_Discover;
 
+// Name: GATTC_GetBearerCount
+// Params: uint16_t conn_id
+// Return: uint8_t
+struct GATTC_GetBearerCount {
+  static uint8_t return_value;
+  std::function<uint8_t(uint16_t conn_id)> body{
+      [](uint16_t conn_id) { return return_value; }};
+  uint8_t operator()(uint16_t conn_id) { return body(conn_id); };
+};
+extern struct GATTC_GetBearerCount GATTC_GetBearerCount;
+
 // Name: GATTC_ExecuteWrite
 // Params: uint16_t conn_id, bool is_execute
 // Return: tGATT_STATUS
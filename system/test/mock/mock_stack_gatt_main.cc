@@ -109,3 +109,16 @@ void gatt_update_app_use_link_flag(tGATT_IF gatt_if, tGATT_TCB* p_tcb,
                                    bool is_add, bool check_acl_link) {
   mock_function_count_map[__func__]++;
 }
+void gatt_request_conn_profile(const RawAddress& bd_addr,
+                               tGATT_CONN_PROFILE profile) {
+  mock_function_count_map[__func__]++;
+}
+void gatt_apply_conn_profile(tGATT_TCB& tcb) {
+  mock_function_count_map[__func__]++;
+}
+void gatt_record_first_operation(tGATT_TCB& tcb, uint8_t op_code) {
+  mock_function_count_map[__func__]++;
+}
+void gatt_dump_connection_records(int fd) {
+  mock_function_count_map[__func__]++;
+}
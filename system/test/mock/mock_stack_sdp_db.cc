@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:14
+ *   Functions generated:16
  */
 
 #include <map>
@@ -98,6 +98,15 @@ const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
   mock_function_count_map[__func__]++;
   return nullptr;
 }
+const uint8_t* sdp_db_get_attr_list(const tSDP_UUID_SEQ* uid_seq,
+                                    const tSDP_ATTR_SEQ* attr_seq,
+                                    uint16_t* p_list_len) {
+  mock_function_count_map[__func__]++;
+  return nullptr;
+}
+void sdp_db_clear_attr_list_cache(void) {
+  mock_function_count_map[__func__]++;
+}
 uint32_t SDP_CreateRecord(void) {
   mock_function_count_map[__func__]++;
   return 0;
@@ -42,6 +42,10 @@ bool UIPC_Send(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id,
   mock_function_count_map[__func__]++;
   return false;
 }
+bool UIPC_SendFd(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, int fd) {
+  mock_function_count_map[__func__]++;
+  return false;
+}
 int uipc_start_main_server_thread(tUIPC_STATE& uipc) {
   mock_function_count_map[__func__]++;
   return 0;
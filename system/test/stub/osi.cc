@@ -309,6 +309,13 @@ void* osi_malloc(size_t size) {
   mock_function_count_map[__func__]++;
   return nullptr;
 }
+void* osi_buffer_alloc(size_t size) {
+  mock_function_count_map[__func__]++;
+  return nullptr;
+}
+void osi_buffer_pool_init(bool enabled) {
+  mock_function_count_map[__func__]++;
+}
 
 bool fixed_queue_is_empty(fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
@@ -119,6 +119,15 @@ void UIPC_Close(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id);
 bool UIPC_Send(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint16_t msg_evt,
                const uint8_t* p_buf, uint16_t msglen);
 
+/**
+ * Pass a file descriptor over UIPC, with a single byte of data
+ *
+ * @param ch_id Channel ID
+ * @param fd File descriptor to pass, still owned by the caller
+ * @return true on success, otherwise false
+ */
+bool UIPC_SendFd(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, int fd);
+
 /**
  * Read a message from UIPC
  *
@@ -593,6 +593,51 @@ bool UIPC_Send(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id,
   return false;
 }
 
+/*******************************************************************************
+ **
+ ** Function         UIPC_SendFd
+ **
+ ** Description      Called to pass a file descriptor over UIPC, along with a
+ **                  single byte of data.
+ **
+ ** Returns          true in case of success, false in case of failure.
+ **
+ ******************************************************************************/
+bool UIPC_SendFd(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, int fd) {
+  LOG_DEBUG("UIPC_SendFd : ch_id:%d fd:%d", ch_id, fd);
+
+  std::lock_guard<std::recursive_mutex> lock(uipc.mutex);
+
+  uint8_t data = 0;
+  struct iovec iov;
+  iov.iov_base = &data;
+  iov.iov_len = sizeof(data);
+  union {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof(int))];
+  } control = {};
+  struct msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  ssize_t ret;
+  OSI_NO_INTR(ret = sendmsg(uipc.ch[ch_id].fd, &msg, MSG_NOSIGNAL));
+  if (ret < 0) {
+    LOG_ERROR("failed to send fd (%s)", strerror(errno));
+    return false;
+  }
+
+  return true;
+}
+
 /*******************************************************************************
  **
  ** Function         UIPC_Read
@@ -43,8 +43,9 @@ static void WriteHeader(std::ostream& output, uint32_t linktype) {
   output.write((char*)&linktype, 4);
 }
 
-static void WriteRecordHeader(std::ostream& output, uint32_t length) {
-  auto time = std::chrono::system_clock::now().time_since_epoch();
+static void WriteRecordHeader(std::ostream& output, uint32_t length,
+                              std::chrono::system_clock::time_point timestamp) {
+  auto time = timestamp.time_since_epoch();
 
   // https://tools.ietf.org/id/draft-gharris-opsawg-pcap-00.html#name-packet-record
   uint32_t seconds = time / 1s;
@@ -16,6 +16,8 @@
 
 #include "acl_connection.h"
 
+#include "model/setup/simulation_clock.h"
+
 namespace rootcanal {
 AclConnection::AclConnection(AddressWithType address,
                              AddressWithType own_address,
@@ -26,7 +28,7 @@ AclConnection::AclConnection(AddressWithType address,
       resolved_address_(resolved_address),
       type_(phy_type),
       role_(role),
-      last_packet_timestamp_(std::chrono::steady_clock::now()),
+      last_packet_timestamp_(SimulationClock::Now()),
       timeout_(std::chrono::seconds(1)) {}
 
 void AclConnection::Encrypt() { encrypted_ = true; };
@@ -62,13 +64,13 @@ bluetooth::hci::Role AclConnection::GetRole() const { return role_; };
 void AclConnection::SetRole(bluetooth::hci::Role role) { role_ = role; }
 
 void AclConnection::ResetLinkTimer() {
-  last_packet_timestamp_ = std::chrono::steady_clock::now();
+  last_packet_timestamp_ = SimulationClock::Now();
 }
 
 std::chrono::steady_clock::duration AclConnection::TimeUntilNearExpiring()
     const {
   return (last_packet_timestamp_ + timeout_ / 2) -
-         std::chrono::steady_clock::now();
+         SimulationClock::Now();
 }
 
 bool AclConnection::IsNearExpiring() const {
@@ -76,7 +78,7 @@ bool AclConnection::IsNearExpiring() const {
 }
 
 std::chrono::steady_clock::duration AclConnection::TimeUntilExpired() const {
-  return (last_packet_timestamp_ + timeout_) - std::chrono::steady_clock::now();
+  return (last_packet_timestamp_ + timeout_) - SimulationClock::Now();
 }
 
 bool AclConnection::HasExpired() const {
@@ -322,6 +322,16 @@ ControllerProperties::ControllerProperties(const std::string& file_name)
 
   ParseUintVector(root, "le_vendor_capabilities", le_vendor_capabilities);
 
+  uint8_t acl_airtime_model = 0;
+  ParseUint(root, "acl_airtime_model", acl_airtime_model);
+  this->acl_airtime_model = acl_airtime_model != 0;
+  ParseUint(root, "acl_phy_rate_kbps", acl_phy_rate_kbps);
+  ParseUint(root, "acl_connection_interval_ms", acl_connection_interval_ms);
+  ParseUint(root, "acl_packets_per_event", acl_packets_per_event);
+  ParseUint(root, "acl_packet_loss_percent", acl_packet_loss_percent);
+  ParseUint(root, "acl_jitter_ms", acl_jitter_ms);
+  ParseUint(root, "acl_airtime_seed", acl_airtime_seed);
+
   this->hci_version = static_cast<HciVersion>(hci_version);
   this->lmp_version = static_cast<LmpVersion>(lmp_version);
 
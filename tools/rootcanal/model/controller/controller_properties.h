@@ -112,6 +112,27 @@ struct ControllerProperties {
   // Provide parameters returned by vendor specific commands.
   std::vector<uint8_t> le_vendor_capabilities{};
 
+  // Airtime model of the ACL links.
+  // When disabled, ACL packets are sent to the peer as soon as they are
+  // received from the Host, and acknowledged right away with a
+  // Number Of Completed Packets event. When enabled, the packets of each
+  // link are queued and sent in connection events of
+  // acl_connection_interval_ms, plus a random jitter of up to
+  // acl_jitter_ms. An event carries at most acl_packets_per_event packets,
+  // and at most as many bytes as the PHY rate allows in the interval.
+  // A packet is lost with a probability of acl_packet_loss_percent; it is
+  // then retransmitted in the next event. The packets sent in an event are
+  // reported in one Number Of Completed Packets event, so the Host credits
+  // follow the simulated airtime. The random values are drawn from a
+  // generator seeded with acl_airtime_seed, which makes runs reproducible.
+  bool acl_airtime_model{false};
+  uint32_t acl_phy_rate_kbps{1000};
+  uint16_t acl_connection_interval_ms{30};
+  uint8_t acl_packets_per_event{4};
+  uint8_t acl_packet_loss_percent{0};
+  uint16_t acl_jitter_ms{0};
+  uint32_t acl_airtime_seed{0};
+
   bool SupportsLMPFeature(bluetooth::hci::LMPFeaturesPage0Bits bit) const {
     return (lmp_features[0] & static_cast<uint64_t>(bit)) != 0;
   }
@@ -70,6 +70,15 @@ class DualModeController : public Device {
   virtual void TimerTick() override;
   virtual void Close() override;
 
+  virtual std::vector<std::pair<Address, std::array<uint8_t, 16>>>
+  GetLinkKeys() const override {
+    return link_layer_controller_.GetLinkKeys();
+  }
+  virtual void WriteLinkKey(const Address& peer,
+                            const std::array<uint8_t, 16>& key) override {
+    link_layer_controller_.WriteLinkKey(peer, key);
+  }
+
   // Route commands and data from the stack.
   void HandleAcl(std::shared_ptr<std::vector<uint8_t>> acl_packet);
   void HandleCommand(std::shared_ptr<std::vector<uint8_t>> command_packet);
@@ -18,6 +18,7 @@
 
 #include "link_layer_controller.h"
 #include "log.h"
+#include "model/setup/simulation_clock.h"
 
 using namespace bluetooth::hci;
 using namespace std::literals;
@@ -244,7 +245,7 @@ ErrorCode LinkLayerController::LeSetAdvertisingEnable(bool advertising_enable) {
       // The Link Layer shall exit the Advertising state no later than 1.28 s
       // after the Advertising state was entered.
       legacy_advertiser_.timeout =
-          std::chrono::steady_clock::now() + adv_direct_ind_high_timeout;
+          SimulationClock::Now() + adv_direct_ind_high_timeout;
       [[fallthrough]];
 
     case AdvertisingType::ADV_DIRECT_IND_LOW: {
@@ -268,7 +269,7 @@ ErrorCode LinkLayerController::LeSetAdvertisingEnable(bool advertising_enable) {
   }
 
   legacy_advertiser_.advertising_enable = true;
-  legacy_advertiser_.next_event = std::chrono::steady_clock::now() +
+  legacy_advertiser_.next_event = SimulationClock::Now() +
                                   legacy_advertiser_.advertising_interval;
   return ErrorCode::SUCCESS;
 }
@@ -1143,7 +1144,7 @@ ErrorCode LinkLayerController::LeSetExtendedAdvertisingEnable(
 
     advertiser.num_completed_extended_advertising_events = 0;
     advertiser.advertising_enable = true;
-    advertiser.next_event = std::chrono::steady_clock::now() +
+    advertiser.next_event = SimulationClock::Now() +
                             advertiser.primary_advertising_interval;
   }
 
@@ -1278,7 +1279,7 @@ uint16_t ExtendedAdvertiser::GetRawAdvertisingEventProperties(
 // =============================================================================
 
 void LinkLayerController::LeAdvertising() {
-  chrono::time_point now = std::chrono::steady_clock::now();
+  chrono::time_point now = SimulationClock::Now();
 
   // Legacy Advertising Timeout
 
@@ -23,6 +23,7 @@
 
 #include "crypto_toolbox/crypto_toolbox.h"
 #include "log.h"
+#include "model/setup/simulation_clock.h"
 #include "packet/raw_builder.h"
 
 using std::vector;
@@ -132,17 +133,30 @@ bool LinkLayerController::FilterAcceptListBusy() {
   return false;
 }
 
-bool LinkLayerController::LeFilterAcceptListContainsDevice(
-    FilterAcceptListAddressType address_type, Address address) {
-  for (auto const& entry : le_filter_accept_list_) {
-    if (entry.address_type == address_type &&
-        (address_type == FilterAcceptListAddressType::ANONYMOUS_ADVERTISERS ||
-         entry.address == address)) {
-      return true;
+static uint64_t FilterAcceptListKey(FilterAcceptListAddressType address_type,
+                                    Address address) {
+  uint64_t key = static_cast<uint64_t>(address_type) << 48;
+  // The address is ignored for anonymous advertisers.
+  if (address_type != FilterAcceptListAddressType::ANONYMOUS_ADVERTISERS) {
+    for (size_t i = 0; i < Address::kLength; i++) {
+      key |= static_cast<uint64_t>(address.address[i]) << (8 * i);
     }
   }
+  return key;
+}
 
-  return false;
+void LinkLayerController::UpdateFilterAcceptListIndex() {
+  le_filter_accept_list_index_.clear();
+  for (auto const& entry : le_filter_accept_list_) {
+    le_filter_accept_list_index_.insert(
+        FilterAcceptListKey(entry.address_type, entry.address));
+  }
+}
+
+bool LinkLayerController::LeFilterAcceptListContainsDevice(
+    FilterAcceptListAddressType address_type, Address address) {
+  return le_filter_accept_list_index_.count(
+             FilterAcceptListKey(address_type, address)) > 0;
 }
 
 bool LinkLayerController::LeFilterAcceptListContainsDevice(
@@ -199,17 +213,37 @@ std::optional<AddressWithType> LinkLayerController::ResolvePrivateAddress(
     return {};
   }
 
+  auto& cache =
+      le_resolved_address_cache_[irk == IrkSelection::Local ? 0 : 1];
+  auto cached = cache.find(address.GetAddress());
+  if (cached != cache.end()) {
+    return cached->second;
+  }
+
+  std::optional<AddressWithType> resolved_address{};
   for (auto const& entry : le_resolving_list_) {
     std::array<uint8_t, LinkLayerController::kIrkSize> const& used_irk =
         irk == IrkSelection::Local ? entry.local_irk : entry.peer_irk;
 
     if (address.IsRpaThatMatchesIrk(used_irk)) {
-      return PeerIdentityAddress(entry.peer_identity_address,
-                                 entry.peer_identity_address_type);
+      resolved_address = PeerIdentityAddress(entry.peer_identity_address,
+                                             entry.peer_identity_address_type);
+      break;
     }
   }
 
-  return {};
+  // Addresses are rotated by remote devices, drop the stale
+  // entries rather than growing the cache without bound.
+  if (cache.size() >= kMaxResolvedAddressCacheSize) {
+    cache.clear();
+  }
+  cache.emplace(address.GetAddress(), resolved_address);
+  return resolved_address;
+}
+
+void LinkLayerController::InvalidateResolvedAddressCache() {
+  le_resolved_address_cache_[0].clear();
+  le_resolved_address_cache_[1].clear();
 }
 
 static Address generate_rpa(
@@ -369,6 +403,7 @@ ErrorCode LinkLayerController::LeAddDeviceToResolvingList(
   le_resolving_list_.emplace_back(
       ResolvingListEntry{peer_identity_address_type, peer_identity_address,
                          peer_irk, local_irk, PrivacyMode::NETWORK});
+  InvalidateResolvedAddressCache();
   return ErrorCode::SUCCESS;
 }
 
@@ -393,6 +428,7 @@ ErrorCode LinkLayerController::LeRemoveDeviceFromResolvingList(
     if (it->peer_identity_address_type == peer_identity_address_type &&
         it->peer_identity_address == peer_identity_address) {
       le_resolving_list_.erase(it);
+      InvalidateResolvedAddressCache();
       return ErrorCode::SUCCESS;
     }
   }
@@ -420,6 +456,7 @@ ErrorCode LinkLayerController::LeClearResolvingList() {
   }
 
   le_resolving_list_.clear();
+  InvalidateResolvedAddressCache();
   return ErrorCode::SUCCESS;
 }
 
@@ -438,6 +475,7 @@ ErrorCode LinkLayerController::LeSetAddressResolutionEnable(bool enable) {
   }
 
   le_resolving_list_enabled_ = enable;
+  InvalidateResolvedAddressCache();
   return ErrorCode::SUCCESS;
 }
 
@@ -494,6 +532,7 @@ ErrorCode LinkLayerController::LeClearFilterAcceptList() {
   }
 
   le_filter_accept_list_.clear();
+  UpdateFilterAcceptListIndex();
   return ErrorCode::SUCCESS;
 }
 
@@ -525,6 +564,7 @@ ErrorCode LinkLayerController::LeAddDeviceToFilterAcceptList(
 
   le_filter_accept_list_.emplace_back(
       FilterAcceptListEntry{address_type, address});
+  UpdateFilterAcceptListIndex();
   return ErrorCode::SUCCESS;
 }
 
@@ -554,6 +594,7 @@ ErrorCode LinkLayerController::LeRemoveDeviceFromFilterAcceptList(
         (address_type == FilterAcceptListAddressType::ANONYMOUS_ADVERTISERS ||
          it->address == address)) {
       le_filter_accept_list_.erase(it);
+      UpdateFilterAcceptListIndex();
       return ErrorCode::SUCCESS;
     }
   }
@@ -847,7 +888,7 @@ ErrorCode LinkLayerController::LeSetExtendedScanEnable(
   scanner_.duration = duration_ms;
   scanner_.period = period_ms;
 
-  auto now = std::chrono::steady_clock::now();
+  auto now = SimulationClock::Now();
 
   // At the end of a single scan (Duration non-zero but Period zero), an
   // HCI_LE_Scan_Timeout event shall be generated.
@@ -1362,6 +1403,7 @@ LinkLayerController::LinkLayerController(const Address& address,
                                          const ControllerProperties& properties)
     : address_(address),
       properties_(properties),
+      airtime_rng_(properties.acl_airtime_seed),
       lm_(nullptr, link_manager_destroy) {
   ops_ = {
       .user_pointer = this,
@@ -1421,7 +1463,9 @@ LinkLayerController::LinkLayerController(const Address& address,
 #else
 LinkLayerController::LinkLayerController(const Address& address,
                                          const ControllerProperties& properties)
-    : address_(address), properties_(properties) {}
+    : address_(address),
+      properties_(properties),
+      airtime_rng_(properties.acl_airtime_seed) {}
 #endif
 
 void LinkLayerController::SendLeLinkLayerPacket(
@@ -1539,15 +1583,17 @@ ErrorCode LinkLayerController::SendAclToRemote(
   AddressWithType destination = connections_.GetAddress(handle);
   Phy::Type phy = connections_.GetPhyType(handle);
 
-  ScheduleTask(kNoDelayMs, [this, handle]() {
-    std::vector<bluetooth::hci::CompletedPackets> completed_packets;
-    bluetooth::hci::CompletedPackets cp;
-    cp.connection_handle_ = handle;
-    cp.host_num_of_completed_packets_ = kNumCommandPackets;
-    completed_packets.push_back(cp);
-    send_event_(bluetooth::hci::NumberOfCompletedPacketsBuilder::Create(
-        completed_packets));
-  });
+  if (!properties_.acl_airtime_model) {
+    ScheduleTask(kNoDelayMs, [this, handle]() {
+      std::vector<bluetooth::hci::CompletedPackets> completed_packets;
+      bluetooth::hci::CompletedPackets cp;
+      cp.connection_handle_ = handle;
+      cp.host_num_of_completed_packets_ = kNumCommandPackets;
+      completed_packets.push_back(cp);
+      send_event_(bluetooth::hci::NumberOfCompletedPacketsBuilder::Create(
+          completed_packets));
+    });
+  }
 
   auto acl_payload = acl_packet.GetPayload();
 
@@ -1567,6 +1613,11 @@ ErrorCode LinkLayerController::SendAclToRemote(
                                                 destination.GetAddress(),
                                                 std::move(raw_builder_ptr));
 
+  if (properties_.acl_airtime_model) {
+    QueueAclForAirtime(handle, phy, std::move(acl));
+    return ErrorCode::SUCCESS;
+  }
+
   switch (phy) {
     case Phy::Type::BR_EDR:
       SendLinkLayerPacket(std::move(acl));
@@ -1578,6 +1629,82 @@ ErrorCode LinkLayerController::SendAclToRemote(
   return ErrorCode::SUCCESS;
 }
 
+void LinkLayerController::QueueAclForAirtime(
+    uint16_t handle, Phy::Type phy_type,
+    std::unique_ptr<model::packets::LinkLayerPacketBuilder> packet) {
+  AclTxQueue& queue = acl_tx_queues_[handle];
+  queue.phy_type = phy_type;
+  queue.packets.push_back(std::move(packet));
+  if (queue.connection_event_task == kInvalidTaskId) {
+    ScheduleAclConnectionEvent(handle);
+  }
+}
+
+void LinkLayerController::ScheduleAclConnectionEvent(uint16_t handle) {
+  std::chrono::milliseconds delay(properties_.acl_connection_interval_ms);
+  if (properties_.acl_jitter_ms > 0) {
+    std::uniform_int_distribution<uint16_t> jitter(0,
+                                                   properties_.acl_jitter_ms);
+    delay += std::chrono::milliseconds(jitter(airtime_rng_));
+  }
+  acl_tx_queues_[handle].connection_event_task =
+      ScheduleTask(delay, [this, handle]() { AclConnectionEvent(handle); });
+}
+
+void LinkLayerController::AclConnectionEvent(uint16_t handle) {
+  auto it = acl_tx_queues_.find(handle);
+  if (it == acl_tx_queues_.end()) {
+    return;
+  }
+  AclTxQueue& queue = it->second;
+  queue.connection_event_task = kInvalidTaskId;
+  if (!connections_.HasHandle(handle)) {
+    // The link was disconnected, the Host does not expect credits for it.
+    acl_tx_queues_.erase(it);
+    return;
+  }
+
+  // Airtime available in the event, in bits.
+  uint64_t available_bits =
+      static_cast<uint64_t>(properties_.acl_phy_rate_kbps) *
+      properties_.acl_connection_interval_ms;
+  uint64_t used_bits = 0;
+  uint16_t sent_packets = 0;
+  std::uniform_int_distribution<int> percent(0, 99);
+
+  while (!queue.packets.empty() &&
+         sent_packets < properties_.acl_packets_per_event) {
+    auto packet = queue.packets.front();
+    uint64_t packet_bits = 8 * static_cast<uint64_t>(packet->size());
+    // Always send at least one packet per event, however long it is.
+    if (sent_packets > 0 && used_bits + packet_bits > available_bits) {
+      break;
+    }
+    used_bits += packet_bits;
+    if (percent(airtime_rng_) < properties_.acl_packet_loss_percent) {
+      // Not acknowledged, retransmitted in the next event.
+      break;
+    }
+    queue.packets.pop_front();
+    send_to_remote_(packet, queue.phy_type);
+    sent_packets++;
+  }
+
+  if (sent_packets > 0) {
+    std::vector<bluetooth::hci::CompletedPackets> completed_packets;
+    bluetooth::hci::CompletedPackets cp;
+    cp.connection_handle_ = handle;
+    cp.host_num_of_completed_packets_ = sent_packets;
+    completed_packets.push_back(cp);
+    send_event_(bluetooth::hci::NumberOfCompletedPacketsBuilder::Create(
+        completed_packets));
+  }
+
+  if (!queue.packets.empty()) {
+    ScheduleAclConnectionEvent(handle);
+  }
+}
+
 ErrorCode LinkLayerController::SendScoToRemote(
     bluetooth::hci::ScoView sco_packet) {
   uint16_t handle = sco_packet.GetHandle();
@@ -4520,7 +4647,7 @@ void LinkLayerController::LeScanning() {
     return;
   }
 
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = SimulationClock::Now();
 
   // Extended Scanning Timeout
 
@@ -6113,18 +6240,26 @@ void LinkLayerController::Reset() {
   resolvable_private_address_timeout_ = std::chrono::seconds(0x0384);
   page_scan_repetition_mode_ = PageScanRepetitionMode::R0;
   connections_ = AclConnectionHandler();
+  for (auto& [handle, queue] : acl_tx_queues_) {
+    if (queue.connection_event_task != kInvalidTaskId) {
+      CancelScheduledTask(queue.connection_event_task);
+    }
+  }
+  acl_tx_queues_.clear();
   oob_id_ = 1;
   key_id_ = 1;
   le_filter_accept_list_.clear();
+  le_filter_accept_list_index_.clear();
   le_resolving_list_.clear();
   le_resolving_list_enabled_ = false;
+  InvalidateResolvedAddressCache();
   legacy_advertising_in_use_ = false;
   extended_advertising_in_use_ = false;
   legacy_advertiser_ = LegacyAdvertiser{};
   extended_advertisers_.clear();
   scanner_ = Scanner{};
   initiator_ = Initiator{};
-  last_inquiry_ = steady_clock::now();
+  last_inquiry_ = SimulationClock::Now();
   inquiry_mode_ = InquiryType::STANDARD;
   inquiry_lap_ = 0;
   inquiry_max_responses_ = 0;
@@ -6184,7 +6319,7 @@ void LinkLayerController::SetInquiryMaxResponses(uint8_t max) {
 }
 
 void LinkLayerController::Inquiry() {
-  steady_clock::time_point now = steady_clock::now();
+  steady_clock::time_point now = SimulationClock::Now();
   if (duration_cast<milliseconds>(now - last_inquiry_) < milliseconds(2000)) {
     return;
   }
@@ -18,7 +18,11 @@
 
 #include <algorithm>
 #include <chrono>
+#include <deque>
 #include <map>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "hci/address.h"
@@ -140,6 +144,15 @@ class LinkLayerController {
  public:
   const Address& GetAddress() const;
 
+  // Link keys of the peers paired with this controller.
+  std::vector<std::pair<Address, std::array<uint8_t, 16>>> GetLinkKeys()
+      const {
+    return security_manager_.GetAllKeys();
+  }
+  void WriteLinkKey(const Address& peer, const std::array<uint8_t, 16>& key) {
+    security_manager_.WriteKey(peer, key);
+  }
+
   void IncomingPacket(model::packets::LinkLayerPacketView incoming);
 
   void TimerTick();
@@ -871,6 +884,23 @@ class LinkLayerController {
 
   AclConnectionHandler connections_;
 
+  // ACL packets waiting for a connection event when the airtime model is
+  // enabled, see ControllerProperties::acl_airtime_model.
+  struct AclTxQueue {
+    Phy::Type phy_type;
+    std::deque<std::shared_ptr<model::packets::LinkLayerPacketBuilder>>
+        packets;
+    AsyncTaskId connection_event_task{kInvalidTaskId};
+  };
+  std::unordered_map<uint16_t, AclTxQueue> acl_tx_queues_;
+  std::mt19937 airtime_rng_;
+
+  void QueueAclForAirtime(
+      uint16_t handle, Phy::Type phy_type,
+      std::unique_ptr<model::packets::LinkLayerPacketBuilder> packet);
+  void ScheduleAclConnectionEvent(uint16_t handle);
+  void AclConnectionEvent(uint16_t handle);
+
   // Callbacks to schedule tasks.
   std::function<AsyncTaskId(std::chrono::milliseconds, const TaskCallback&)>
       schedule_task_;
@@ -901,6 +931,12 @@ class LinkLayerController {
 
   std::vector<FilterAcceptListEntry> le_filter_accept_list_;
 
+  // Hashed index of le_filter_accept_list_, rebuilt whenever the list
+  // is modified. Advertising PDUs are checked against the filter accept
+  // list on every reception, the index keeps the lookup constant time.
+  std::unordered_set<uint64_t> le_filter_accept_list_index_;
+  void UpdateFilterAcceptListIndex();
+
   struct ResolvingListEntry {
     PeerAddressType peer_identity_address_type;
     Address peer_identity_address;
@@ -912,6 +948,15 @@ class LinkLayerController {
   std::vector<ResolvingListEntry> le_resolving_list_;
   bool le_resolving_list_enabled_{false};
 
+  // Cache of the resolution results for the RPAs received from remote
+  // devices, indexed by the IRK selection. Each resolution attempt
+  // otherwise runs one AES computation per resolving list entry.
+  // The cache is invalidated whenever the resolving list is modified.
+  static constexpr size_t kMaxResolvedAddressCacheSize = 256;
+  std::unordered_map<Address, std::optional<AddressWithType>>
+      le_resolved_address_cache_[2];
+  void InvalidateResolvedAddressCache();
+
   // Flag set when any legacy advertising command has been received
   // since the last power-on-reset.
   // From Vol 4, Part E § 3.1.1 Legacy and extended advertising,
@@ -956,21 +1001,33 @@ class LinkLayerController {
     std::optional<std::chrono::steady_clock::time_point> timeout;
     std::optional<std::chrono::steady_clock::time_point> periodical_timeout;
 
-    // Packet History
-    std::vector<model::packets::LinkLayerPacketView> history;
+    // Packet History, indexed by the hash of the packet content.
+    std::unordered_multimap<size_t, model::packets::LinkLayerPacketView>
+        history;
 
     bool IsEnabled() const { return scan_enable; }
 
+    static size_t HashPacket(model::packets::LinkLayerPacketView packet) {
+      // FNV-1a over the packet bytes.
+      size_t hash = 14695981039346656037ull;
+      for (uint8_t byte : packet) {
+        hash = (hash ^ byte) * 1099511628211ull;
+      }
+      return hash;
+    }
+
     bool IsPacketInHistory(model::packets::LinkLayerPacketView packet) const {
+      auto [begin, end] = history.equal_range(HashPacket(packet));
       return std::any_of(
-          history.begin(), history.end(),
-          [packet](model::packets::LinkLayerPacketView const& a) {
+          begin, end,
+          [packet](auto const& entry) {
+            model::packets::LinkLayerPacketView const& a = entry.second;
             return a.size() == packet.size() &&
                    std::equal(a.begin(), a.end(), packet.begin());
           });
     }
     void AddPacketToHistory(model::packets::LinkLayerPacketView packet) {
-      history.push_back(packet);
+      history.emplace(HashPacket(packet), packet);
     }
   };
 
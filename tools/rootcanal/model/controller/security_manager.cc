@@ -57,6 +57,17 @@ const std::array<uint8_t, 16>& SecurityManager::GetKey(
   return key_store_.at(addr.ToString());
 }
 
+std::vector<std::pair<Address, std::array<uint8_t, 16>>>
+SecurityManager::GetAllKeys() const {
+  std::vector<std::pair<Address, std::array<uint8_t, 16>>> keys;
+  for (auto const& [address, key] : key_store_) {
+    Address peer;
+    Address::FromString(address, peer);
+    keys.emplace_back(peer, key);
+  }
+  return keys;
+}
+
 void SecurityManager::AuthenticationRequest(const Address& addr,
                                             uint16_t handle, bool initiator) {
   authenticating_ = true;
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "hci/address.h"
@@ -72,6 +73,8 @@ class SecurityManager {
 
   const std::array<uint8_t, 16>& GetKey(const Address& addr) const;
 
+  std::vector<std::pair<Address, std::array<uint8_t, 16>>> GetAllKeys() const;
+
   void AuthenticationRequest(const Address& addr, uint16_t handle,
                              bool initiator);
   void AuthenticationRequestFinished();
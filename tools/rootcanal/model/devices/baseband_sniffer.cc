@@ -16,9 +16,10 @@
 
 #include "baseband_sniffer.h"
 
+#include <fstream>
+
 #include "log.h"
 #include "packet/raw_builder.h"
-#include "pcap.h"
 
 using std::vector;
 
@@ -26,15 +27,12 @@ namespace rootcanal {
 
 #include "bredr_bb.h"
 
-BaseBandSniffer::BaseBandSniffer(const std::string& filename) {
-  output_.open(filename, std::ios::binary);
-
-  uint32_t linktype = 255;  // http://www.tcpdump.org/linktypes.html
-                            // LINKTYPE_BLUETOOTH_BREDR_BB
+// http://www.tcpdump.org/linktypes.html LINKTYPE_BLUETOOTH_BREDR_BB
+static constexpr uint32_t kLinkTypeBluetoothBrEdrBb = 255;
 
-  pcap::WriteHeader(output_, linktype);
-  output_.flush();
-}
+BaseBandSniffer::BaseBandSniffer(const std::string& filename)
+    : writer_(std::make_shared<std::ofstream>(filename, std::ios::binary),
+              kLinkTypeBluetoothBrEdrBb) {}
 
 void BaseBandSniffer::TimerTick() {}
 
@@ -45,9 +43,7 @@ void BaseBandSniffer::AppendRecord(
   bluetooth::packet::BitInserter i(bytes);
   packet->Serialize(i);
 
-  pcap::WriteRecordHeader(output_, bytes.size());
-  output_.write((char*)bytes.data(), bytes.size());
-  output_.flush();
+  writer_.AppendRecord(std::move(bytes));
 }
 
 static uint8_t ReverseByte(uint8_t b) {
@@ -93,6 +89,10 @@ static uint32_t BuildBtPacketHeader(uint8_t uap, uint8_t lt_addr,
 
 void BaseBandSniffer::IncomingPacket(
     model::packets::LinkLayerPacketView packet) {
+  if (!writer_.IsEnabled()) {
+    return;
+  }
+
   auto packet_type = packet.GetType();
   auto address = packet.GetSourceAddress();
 
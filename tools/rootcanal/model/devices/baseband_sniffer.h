@@ -17,9 +17,10 @@
 #pragma once
 
 #include <cstdint>
-#include <fstream>
+#include <memory>
 
 #include "device.h"
+#include "model/setup/pcap_writer.h"
 
 namespace rootcanal {
 
@@ -50,9 +51,11 @@ class BaseBandSniffer : public Device {
 
   virtual void TimerTick() override;
 
+  virtual PcapWriter* GetPcapWriter() override { return &writer_; }
+
  private:
   void AppendRecord(std::unique_ptr<bredr_bb::BaseBandPacketBuilder> record);
-  std::ofstream output_;
+  PcapWriter writer_;
 };
 
 }  // namespace rootcanal
@@ -64,8 +64,9 @@ BeaconSwarm::BeaconSwarm(const vector<std::string>& args) : Beacon(args) {
 
 void BeaconSwarm::TimerTick() {
   // Rotate the advertising address.
-  uint8_t* low_order_byte = address_.data();
-  *low_order_byte += 1;
+  Address address = address_;
+  *address.data() += 1;
+  SetAddress(address);
   Beacon::TimerTick();
 }
 
@@ -24,7 +24,21 @@ std::string Device::ToString() const {
   return GetTypeString() + "@" + address_.ToString();
 }
 
+void Device::SetAddress(Address address) {
+  address_ = address;
+  if (receive_only_addressed_packets_) {
+    for (auto phy : phy_layers_) {
+      if (phy != nullptr) {
+        phy->SetReceiveAddress(address_);
+      }
+    }
+  }
+}
+
 void Device::RegisterPhyLayer(std::shared_ptr<PhyLayer> phy) {
+  if (receive_only_addressed_packets_) {
+    phy->SetReceiveAddress(address_);
+  }
   phy_layers_.push_back(phy);
 }
 
@@ -48,6 +62,17 @@ void Device::UnregisterPhyLayer(Phy::Type phy_type, uint32_t factory_id) {
   }
 }
 
+bool Device::IsRegisteredOnPhy(Phy::Type phy_type,
+                               uint32_t factory_id) const {
+  for (auto const& phy : phy_layers_) {
+    if (phy != nullptr && phy->IsFactoryId(factory_id) &&
+        phy->GetType() == phy_type) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void Device::SendLinkLayerPacket(
     std::shared_ptr<model::packets::LinkLayerPacketBuilder> to_send,
     Phy::Type phy_type) {
@@ -16,10 +16,12 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "hci/address.h"
@@ -30,6 +32,8 @@ namespace rootcanal {
 
 using ::bluetooth::hci::Address;
 
+class PcapWriter;
+
 // Represent a Bluetooth Device
 //  - Provide Get*() and Set*() functions for device attributes.
 class Device {
@@ -44,7 +48,7 @@ class Device {
   virtual std::string ToString() const;
 
   // Set the device's Bluetooth address.
-  void SetAddress(Address address) { address_ = address; }
+  void SetAddress(Address address);
 
   // Get the device's Bluetooth address.
   const Address& GetAddress() const { return address_; }
@@ -58,6 +62,8 @@ class Device {
 
   void UnregisterPhyLayer(Phy::Type phy_type, uint32_t factory_id);
 
+  bool IsRegisteredOnPhy(Phy::Type phy_type, uint32_t factory_id) const;
+
   virtual void IncomingPacket(model::packets::LinkLayerPacketView){};
 
   virtual void SendLinkLayerPacket(
@@ -69,6 +75,18 @@ class Device {
 
   virtual void Close();
 
+  // Return the writer capturing the traffic of this device, if any.
+  virtual PcapWriter* GetPcapWriter() { return nullptr; }
+
+  // BR/EDR link keys stored by the device, saved in simulation snapshots
+  // so that restored devices are already paired.
+  virtual std::vector<std::pair<Address, std::array<uint8_t, 16>>>
+  GetLinkKeys() const {
+    return {};
+  }
+  virtual void WriteLinkKey(const Address& /* peer */,
+                            const std::array<uint8_t, 16>& /* key */) {}
+
   void RegisterCloseCallback(std::function<void()>);
 
  protected:
@@ -79,6 +97,10 @@ class Device {
   // Bluetooth activities.
   Address address_;
 
+  // Set by devices that ignore every packet not sent to |address_|, so that
+  // the phy layers do not deliver them.
+  bool receive_only_addressed_packets_{false};
+
   // Callback to be invoked when this device is closed.
   std::function<void()> close_callback_;
 };
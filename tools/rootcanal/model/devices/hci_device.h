@@ -42,6 +42,8 @@ class HciDevice : public DualModeController {
 
   void Close() override;
 
+  PcapWriter* GetPcapWriter() override { return transport_->GetPcapWriter(); }
+
  private:
   std::shared_ptr<HciTransport> transport_;
 };
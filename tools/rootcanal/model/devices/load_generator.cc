@@ -0,0 +1,390 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "load_generator.h"
+
+#include <algorithm>
+
+#include "hci/hci_packets.h"
+#include "log.h"
+#include "model/setup/device_boutique.h"
+#include "model/setup/simulation_clock.h"
+#include "packet/raw_builder.h"
+
+namespace rootcanal {
+using namespace model::packets;
+using namespace std::chrono_literals;
+
+bool LoadGenerator::registered_ =
+    DeviceBoutique::Register("load_generator", &LoadGenerator::Create);
+
+// L2CAP fixed channels (Vol 3, Part A § 2.1).
+static constexpr uint16_t kAttCid = 0x0004;
+static constexpr uint16_t kLeSignalingCid = 0x0005;
+// Channel identifier of the local endpoint of the credit based channel.
+static constexpr uint16_t kLocalCid = 0x0040;
+static constexpr uint16_t kInitialCredits = 10;
+// Arbitrary handle of the generated GATT characteristic value.
+static constexpr uint16_t kNotifiedAttributeHandle = 0x0010;
+static constexpr uint16_t kResponderCisHandle = 0x0100;
+
+// LE signaling commands (Vol 3, Part A § 4).
+static constexpr uint8_t kLeCreditBasedConnectionRequest = 0x14;
+static constexpr uint8_t kLeCreditBasedConnectionResponse = 0x15;
+static constexpr uint8_t kFlowControlCredit = 0x16;
+
+static void AppendLe16(std::vector<uint8_t>& bytes, uint16_t value) {
+  bytes.push_back(value & 0xff);
+  bytes.push_back(value >> 8);
+}
+
+static uint16_t ReadLe16(const std::vector<uint8_t>& bytes, size_t offset) {
+  return bytes[offset] | (bytes[offset + 1] << 8);
+}
+
+LoadGenerator::LoadGenerator(const std::vector<std::string>& args) {
+  advertising_type_ = LegacyAdvertisingType::ADV_IND;
+  advertising_interval_ = 100ms;
+  advertising_data_ = {
+      0x0F /* Length */, 0x09 /* TYPE_NAME_COMPLETE */, 'l', 'o', 'a', 'd',
+      '-',  'g',         'e',  'n', 'e', 'r', 'a', 't', 'o', 'r',
+      0x02 /* Length */, 0x01 /* TYPE_FLAG */,
+      0x4 /* BREDR_NOT_SUPPORTED */ | 0x2 /* GENERAL_DISCOVERABLE */};
+  traffic_interval_ = 10ms;
+
+  if (args.size() >= 2) {
+    Address::FromString(args[1], address_);
+  }
+
+  if (args.size() >= 3) {
+    if (args[2] == "gatt_notify") {
+      mode_ = Mode::GATT_NOTIFY;
+    } else if (args[2] == "l2cap_bulk") {
+      mode_ = Mode::L2CAP_BULK;
+    } else if (args[2] == "l2cap_sink") {
+      mode_ = Mode::L2CAP_SINK;
+    } else if (args[2] == "iso") {
+      mode_ = Mode::ISO;
+    } else {
+      LOG_WARN("Unknown load generator mode %s", args[2].c_str());
+    }
+  }
+
+  if (args.size() >= 4) {
+    traffic_interval_ = std::chrono::milliseconds(std::stoi(args[3]));
+  }
+
+  if (args.size() >= 5) {
+    payload_size_ = std::stoi(args[4]);
+  }
+
+  if (args.size() >= 6) {
+    psm_ = std::stoi(args[5], nullptr, 0);
+  }
+}
+
+std::string LoadGenerator::ToString() const {
+  return Device::ToString() + " sent " + std::to_string(sent_packets_) +
+         " packets, received " + std::to_string(received_bytes_) + " bytes";
+}
+
+void LoadGenerator::TimerTick() {
+  if (!peer_.has_value()) {
+    Beacon::TimerTick();
+    return;
+  }
+
+  std::chrono::steady_clock::time_point now = SimulationClock::Now();
+  if ((now - traffic_last_) >= traffic_interval_) {
+    traffic_last_ = now;
+    GenerateTraffic();
+  }
+}
+
+void LoadGenerator::GenerateTraffic() {
+  switch (mode_) {
+    case Mode::GATT_NOTIFY: {
+      // ATT_HANDLE_VALUE_NTF (Vol 3, Part F § 3.4.7.1).
+      std::vector<uint8_t> pdu{0x1b};
+      AppendLe16(pdu, kNotifiedAttributeHandle);
+      pdu.resize(pdu.size() + payload_size_,
+                 static_cast<uint8_t>(sent_packets_));
+      SendL2cap(kAttCid, pdu);
+      break;
+    }
+
+    case Mode::L2CAP_BULK: {
+      if (!remote_cid_.has_value()) {
+        if (!channel_requested_) {
+          channel_requested_ = true;
+          std::vector<uint8_t> command{kLeCreditBasedConnectionRequest, 1};
+          AppendLe16(command, 10);
+          AppendLe16(command, psm_);
+          AppendLe16(command, kLocalCid);
+          AppendLe16(command, std::max<uint16_t>(payload_size_, 23));
+          AppendLe16(command, std::max<uint16_t>(payload_size_ + 2, 23));
+          AppendLe16(command, kInitialCredits);
+          SendL2cap(kLeSignalingCid, command);
+        }
+        return;
+      }
+      if (credits_ == 0) {
+        return;
+      }
+      // Single K-frame SDU (Vol 3, Part A § 3.4).
+      credits_--;
+      std::vector<uint8_t> sdu;
+      AppendLe16(sdu, payload_size_);
+      sdu.resize(sdu.size() + payload_size_,
+                 static_cast<uint8_t>(sent_packets_));
+      SendL2cap(remote_cid_.value(), sdu);
+      break;
+    }
+
+    case Mode::L2CAP_SINK: {
+      if (!remote_cid_.has_value() || pending_credits_ == 0) {
+        return;
+      }
+      // Consume one SDU per interval.
+      pending_credits_--;
+      std::vector<uint8_t> command{kFlowControlCredit, 2};
+      AppendLe16(command, 4);
+      AppendLe16(command, kLocalCid);
+      AppendLe16(command, 1);
+      SendL2cap(kLeSignalingCid, command);
+      break;
+    }
+
+    case Mode::ISO: {
+      if (!cis_handle_.has_value()) {
+        return;
+      }
+      std::vector<uint8_t> sdu(payload_size_,
+                               static_cast<uint8_t>(sent_packets_));
+      SendLinkLayerPacket(
+          IsoStartBuilder::Create(
+              address_, peer_.value(), cis_handle_.value(), Complete::COMPLETE,
+              0, std::make_unique<bluetooth::packet::RawBuilder>(sdu)),
+          Phy::Type::LOW_ENERGY);
+      sent_packets_++;
+      break;
+    }
+  }
+}
+
+void LoadGenerator::SendL2cap(uint16_t cid,
+                              const std::vector<uint8_t>& payload) {
+  std::vector<uint8_t> pdu;
+  AppendLe16(pdu, payload.size());
+  AppendLe16(pdu, cid);
+  pdu.insert(pdu.end(), payload.begin(), payload.end());
+
+  // The ACL payload is an HCI ACL packet. The handle is ignored, the
+  // receiving controller looks the connection up by source address.
+  auto acl = std::make_unique<bluetooth::packet::RawBuilder>();
+  acl->AddOctets2(0x2000 /* PB flag: first automatically flushable */);
+  acl->AddOctets2(pdu.size());
+  acl->AddOctets(pdu);
+  SendLinkLayerPacket(
+      AclBuilder::Create(address_, peer_.value(), std::move(acl)),
+      Phy::Type::LOW_ENERGY);
+  sent_packets_++;
+}
+
+void LoadGenerator::IncomingPacket(LinkLayerPacketView packet) {
+  if (packet.GetDestinationAddress() != address_) {
+    return;
+  }
+
+  if (!peer_.has_value()) {
+    if (packet.GetType() == PacketType::LE_CONNECT) {
+      IncomingLeConnect(packet);
+    } else {
+      Beacon::IncomingPacket(packet);
+    }
+    return;
+  }
+
+  if (packet.GetSourceAddress() != peer_.value()) {
+    return;
+  }
+
+  switch (packet.GetType()) {
+    case PacketType::ACL:
+      IncomingAcl(packet);
+      break;
+    case PacketType::ISO_CONNECTION_REQUEST:
+      IncomingIsoConnectionRequest(packet);
+      break;
+    case PacketType::ISO:
+      received_bytes_ += packet.size();
+      break;
+    case PacketType::LE_READ_REMOTE_FEATURES:
+      SendLinkLayerPacket(
+          LeReadRemoteFeaturesResponseBuilder::Create(
+              address_, peer_.value(), 0 /* features */,
+              static_cast<uint8_t>(bluetooth::hci::ErrorCode::SUCCESS)),
+          Phy::Type::LOW_ENERGY);
+      break;
+    case PacketType::READ_REMOTE_VERSION_INFORMATION:
+      SendLinkLayerPacket(
+          ReadRemoteVersionInformationResponseBuilder::Create(
+              address_, peer_.value(), 0x0b /* 5.2 */, 0 /* subversion */,
+              0xffff /* manufacturer name */),
+          Phy::Type::LOW_ENERGY);
+      break;
+    case PacketType::DISCONNECT:
+      Disconnected();
+      break;
+    default:
+      break;
+  }
+}
+
+void LoadGenerator::IncomingLeConnect(LinkLayerPacketView packet) {
+  auto connect = LeConnectView::Create(packet);
+  ASSERT(connect.IsValid());
+
+  peer_ = packet.GetSourceAddress();
+  traffic_last_ = SimulationClock::Now();
+  LOG_INFO("%s connected to %s", ToString().c_str(),
+           peer_->ToString().c_str());
+
+  SendLinkLayerPacket(
+      LeConnectCompleteBuilder::Create(
+          address_, peer_.value(), connect.GetInitiatingAddressType(),
+          AddressType::PUBLIC, connect.GetLeConnectionIntervalMax(),
+          connect.GetLeConnectionLatency(),
+          connect.GetLeConnectionSupervisionTimeout()),
+      Phy::Type::LOW_ENERGY);
+}
+
+void LoadGenerator::IncomingAcl(LinkLayerPacketView packet) {
+  auto acl = AclView::Create(packet);
+  ASSERT(acl.IsValid());
+  auto payload = acl.GetPayload();
+  std::vector<uint8_t> bytes(payload.begin(), payload.end());
+  if (bytes.size() < 4) {
+    return;
+  }
+  received_bytes_ += bytes.size() - 4;
+
+  // Continuing fragments carry no L2CAP header.
+  uint8_t packet_boundary_flag = (bytes[1] >> 4) & 0x3;
+  if (packet_boundary_flag == 0x1 || bytes.size() < 8) {
+    return;
+  }
+
+  uint16_t cid = ReadLe16(bytes, 6);
+  std::vector<uint8_t> l2cap_payload(bytes.begin() + 8, bytes.end());
+  if (cid == kLeSignalingCid) {
+    IncomingSignaling(l2cap_payload);
+  } else if (cid == kAttCid) {
+    IncomingAtt(l2cap_payload);
+  } else if (cid == kLocalCid && mode_ == Mode::L2CAP_SINK) {
+    pending_credits_++;
+  }
+}
+
+void LoadGenerator::IncomingSignaling(const std::vector<uint8_t>& command) {
+  if (command.size() < 4) {
+    return;
+  }
+  uint8_t code = command[0];
+  uint8_t identifier = command[1];
+
+  if (code == kLeCreditBasedConnectionRequest && command.size() >= 14) {
+    uint16_t source_cid = ReadLe16(command, 6);
+    bool accept = mode_ == Mode::L2CAP_SINK && !remote_cid_.has_value();
+    std::vector<uint8_t> response{kLeCreditBasedConnectionResponse,
+                                  identifier};
+    AppendLe16(response, 10);
+    AppendLe16(response, accept ? kLocalCid : 0);
+    AppendLe16(response, 512);
+    AppendLe16(response, 251);
+    AppendLe16(response, accept ? kInitialCredits : 0);
+    // 0x0002: SPSM not supported.
+    AppendLe16(response, accept ? 0x0000 : 0x0002);
+    SendL2cap(kLeSignalingCid, response);
+    if (accept) {
+      remote_cid_ = source_cid;
+    }
+  } else if (code == kLeCreditBasedConnectionResponse &&
+             command.size() >= 14 && mode_ == Mode::L2CAP_BULK) {
+    uint16_t result = ReadLe16(command, 12);
+    if (result == 0) {
+      remote_cid_ = ReadLe16(command, 4);
+      credits_ = ReadLe16(command, 10);
+    } else {
+      LOG_WARN("%s channel to psm 0x%04x refused with result 0x%04x",
+               ToString().c_str(), psm_, result);
+    }
+  } else if (code == kFlowControlCredit && command.size() >= 8) {
+    if (remote_cid_.has_value() && ReadLe16(command, 4) == remote_cid_) {
+      credits_ += ReadLe16(command, 6);
+    }
+  }
+}
+
+void LoadGenerator::IncomingAtt(const std::vector<uint8_t>& pdu) {
+  if (pdu.empty()) {
+    return;
+  }
+
+  // The device has no GATT database: reply to every request with
+  // ATT_ERROR_RSP Request Not Supported (Vol 3, Part F § 3.4.1.1), so that
+  // the host does not wait for the transaction timeout.
+  uint8_t opcode = pdu[0];
+  bool is_request = opcode == 0x02 || opcode == 0x04 || opcode == 0x06 ||
+                    opcode == 0x08 || opcode == 0x0a || opcode == 0x0c ||
+                    opcode == 0x0e || opcode == 0x10 || opcode == 0x12 ||
+                    opcode == 0x16 || opcode == 0x18 || opcode == 0x20;
+  if (is_request) {
+    SendL2cap(kAttCid, {0x01, opcode, 0x00, 0x00, 0x06});
+  }
+}
+
+void LoadGenerator::IncomingIsoConnectionRequest(LinkLayerPacketView packet) {
+  auto request = IsoConnectionRequestView::Create(packet);
+  ASSERT(request.IsValid());
+
+  bool accept = mode_ == Mode::ISO && !cis_handle_.has_value();
+  auto status = accept ? bluetooth::hci::ErrorCode::SUCCESS
+                       : bluetooth::hci::ErrorCode::
+                             CONNECTION_REJECTED_LIMITED_RESOURCES;
+  SendLinkLayerPacket(
+      IsoConnectionResponseBuilder::Create(
+          address_, peer_.value(), static_cast<uint8_t>(status),
+          request.GetRequesterCisHandle(), request.GetRequesterAclHandle(),
+          kResponderCisHandle),
+      Phy::Type::LOW_ENERGY);
+  if (accept) {
+    cis_handle_ = request.GetRequesterCisHandle();
+  }
+}
+
+void LoadGenerator::Disconnected() {
+  LOG_INFO("%s disconnected from %s", ToString().c_str(),
+           peer_->ToString().c_str());
+  peer_ = {};
+  remote_cid_ = {};
+  channel_requested_ = false;
+  credits_ = 0;
+  pending_credits_ = 0;
+  cis_handle_ = {};
+}
+
+}  // namespace rootcanal
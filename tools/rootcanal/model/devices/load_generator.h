@@ -0,0 +1,94 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "beacon.h"
+
+namespace rootcanal {
+
+// Connectable LE peer generating synthetic traffic towards the host, for
+// stack stress tests and benchmarks. The device advertises until a central
+// connects, then runs one of the traffic modes:
+//  - gatt_notify: sends a GATT notification every interval.
+//  - l2cap_bulk: opens an LE credit based channel to |psm| and sends an
+//    SDU every interval, as long as the host grants credits.
+//  - l2cap_sink: accepts LE credit based channels and returns one credit
+//    every interval, consuming the data at a fixed rate like an A2DP sink.
+//  - iso: accepts CIS requests and sends an SDU every interval.
+//
+// Arguments: address mode [interval_ms] [payload_size] [psm]
+class LoadGenerator : public Beacon {
+ public:
+  LoadGenerator(const std::vector<std::string>& args);
+  virtual ~LoadGenerator() = default;
+
+  static std::shared_ptr<Device> Create(const std::vector<std::string>& args) {
+    return std::make_shared<LoadGenerator>(args);
+  }
+
+  virtual std::string GetTypeString() const override {
+    return "load_generator";
+  }
+
+  virtual std::string ToString() const override;
+
+  virtual void TimerTick() override;
+  virtual void IncomingPacket(
+      model::packets::LinkLayerPacketView packet) override;
+
+ private:
+  enum class Mode { GATT_NOTIFY, L2CAP_BULK, L2CAP_SINK, ISO };
+
+  void IncomingLeConnect(model::packets::LinkLayerPacketView packet);
+  void IncomingAcl(model::packets::LinkLayerPacketView packet);
+  void IncomingSignaling(const std::vector<uint8_t>& command);
+  void IncomingAtt(const std::vector<uint8_t>& pdu);
+  void IncomingIsoConnectionRequest(model::packets::LinkLayerPacketView packet);
+  void GenerateTraffic();
+  void SendL2cap(uint16_t cid, const std::vector<uint8_t>& payload);
+  void Disconnected();
+
+  Mode mode_{Mode::GATT_NOTIFY};
+  std::chrono::steady_clock::duration traffic_interval_{};
+  std::chrono::steady_clock::time_point traffic_last_{};
+  uint16_t payload_size_{20};
+  uint16_t psm_{0x0080};
+
+  // Connected central, if any.
+  std::optional<Address> peer_{};
+
+  // LE credit based channel state.
+  std::optional<uint16_t> remote_cid_{};
+  bool channel_requested_{false};
+  uint16_t credits_{0};
+  uint16_t pending_credits_{0};
+
+  // Connected CIS handle of the central, if any.
+  std::optional<uint16_t> cis_handle_{};
+
+  uint64_t sent_packets_{0};
+  uint64_t received_bytes_{0};
+
+  static bool registered_;
+};
+
+}  // namespace rootcanal
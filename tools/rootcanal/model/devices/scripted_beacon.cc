@@ -24,6 +24,7 @@
 #include "log.h"
 #include "model/devices/scripted_beacon_ble_payload.pb.h"
 #include "model/setup/device_boutique.h"
+#include "model/setup/simulation_clock.h"
 
 #ifdef _WIN32
 #define F_OK 00
@@ -92,7 +93,7 @@ ScriptedBeacon::ScriptedBeacon(const vector<std::string>& args) : Beacon(args) {
 }
 
 bool has_time_elapsed(steady_clock::time_point time_point) {
-  return steady_clock::now() > time_point;
+  return SimulationClock::Now() > time_point;
 }
 
 void ScriptedBeacon::populate_event(PlaybackEvent* event,
@@ -126,16 +127,16 @@ void ScriptedBeacon::TimerTick() {
       Beacon::TimerTick();
       break;
     case PlaybackEvent::SCANNED_ONCE:
-      next_check_time_ =
-          steady_clock::now() + steady_clock::duration(std::chrono::seconds(1));
+      next_check_time_ = SimulationClock::Now() +
+                         steady_clock::duration(std::chrono::seconds(1));
       set_state(PlaybackEvent::WAITING_FOR_FILE);
       break;
     case PlaybackEvent::WAITING_FOR_FILE:
       if (!has_time_elapsed(next_check_time_)) {
         return;
       }
-      next_check_time_ =
-          steady_clock::now() + steady_clock::duration(std::chrono::seconds(1));
+      next_check_time_ = SimulationClock::Now() +
+                         steady_clock::duration(std::chrono::seconds(1));
       if (access(config_file_.c_str(), F_OK) == -1) {
         return;
       }
@@ -160,7 +161,7 @@ void ScriptedBeacon::TimerTick() {
         set_state(PlaybackEvent::PLAYBACK_STARTED);
         LOG_INFO("Starting Ble advertisement playback from file: %s",
                  config_file_.c_str());
-        next_ad_.ad_time = steady_clock::now();
+        next_ad_.ad_time = SimulationClock::Now();
         get_next_advertisement();
         input.close();
       }
@@ -19,6 +19,7 @@
 #include <string.h>  // for strerror, size_t
 #include <unistd.h>  // for ssize_t
 
+#include <algorithm>    // for copy
 #include <cerrno>       // for errno, EAGAIN, ECONNRESET
 #include <cstdint>      // for uint8_t
 #include <functional>   // for function
@@ -33,6 +34,14 @@
 
 namespace rootcanal {
 
+// Size of the chunks read from the socket, enough for several ACL or ISO
+// packets of the maximum size supported by the controller.
+static constexpr size_t kReadBufferSize = 64 * 1024;
+
+// Maximum number of chunks read by a single call to OnDataReady(), to bound
+// the time spent there when the peer keeps sending.
+static constexpr int kMaxReadsPerCall = 16;
+
 H4DataChannelPacketizer::H4DataChannelPacketizer(
     std::shared_ptr<AsyncDataChannel> socket, PacketReadCallback command_cb,
     PacketReadCallback event_cb, PacketReadCallback acl_cb,
@@ -40,21 +49,22 @@ H4DataChannelPacketizer::H4DataChannelPacketizer(
     ClientDisconnectCallback disconnect_cb)
     : uart_socket_(socket),
       h4_parser_(command_cb, event_cb, acl_cb, sco_cb, iso_cb, true),
+      read_buffer_(kReadBufferSize),
       disconnect_cb_(std::move(disconnect_cb)) {}
 
 size_t H4DataChannelPacketizer::Send(uint8_t type, const uint8_t* data,
                                      size_t length) {
-  ssize_t ret = uart_socket_->Send(&type, sizeof(type));
-  if (ret == -1) {
-    LOG_ERROR("Error writing to UART (%s)", strerror(errno));
-  }
-  size_t to_be_written = ret;
+  // Send the type and the packet with a single write.
+  send_buffer_.resize(sizeof(type) + length);
+  send_buffer_[0] = type;
+  std::copy(data, data + length, send_buffer_.begin() + sizeof(type));
 
-  ret = uart_socket_->Send(data, length);
+  ssize_t ret = uart_socket_->Send(send_buffer_.data(), send_buffer_.size());
   if (ret == -1) {
     LOG_ERROR("Error writing to UART (%s)", strerror(errno));
+    ret = 0;
   }
-  to_be_written += ret;
+  size_t to_be_written = ret;
 
   if (to_be_written != length + sizeof(type)) {
     LOG_ERROR("%d / %d bytes written - something went wrong...",
@@ -66,30 +76,33 @@ size_t H4DataChannelPacketizer::Send(uint8_t type, const uint8_t* data,
 
 void H4DataChannelPacketizer::OnDataReady(
     std::shared_ptr<AsyncDataChannel> socket) {
-  ssize_t bytes_to_read = h4_parser_.BytesRequested();
-  std::vector<uint8_t> buffer(bytes_to_read);
-
-  ssize_t bytes_read = socket->Recv(buffer.data(), bytes_to_read);
-  if (bytes_read == 0) {
-    LOG_INFO("remote disconnected!");
-    disconnected_ = true;
-    disconnect_cb_();
-    return;
-  } else if (bytes_read < 0) {
-    if (errno == EAGAIN) {
-      // No data, try again later.
-      return;
-    } else if (errno == ECONNRESET) {
-      // They probably rejected our packet
+  for (int i = 0; i < kMaxReadsPerCall && !disconnected_; i++) {
+    ssize_t bytes_read = socket->Recv(read_buffer_.data(), read_buffer_.size());
+    if (bytes_read == 0) {
+      LOG_INFO("remote disconnected!");
       disconnected_ = true;
       disconnect_cb_();
       return;
-    } else {
-      LOG_ALWAYS_FATAL("Read error in %u: %s", h4_parser_.CurrentState(),
-                       strerror(errno));
+    } else if (bytes_read < 0) {
+      if (errno == EAGAIN) {
+        // No data, try again later.
+        return;
+      } else if (errno == ECONNRESET) {
+        // They probably rejected our packet
+        disconnected_ = true;
+        disconnect_cb_();
+        return;
+      } else {
+        LOG_ALWAYS_FATAL("Read error in %u: %s", h4_parser_.CurrentState(),
+                         strerror(errno));
+      }
+    }
+    h4_parser_.ConsumeChunk(read_buffer_.data(), bytes_read);
+    if (static_cast<size_t>(bytes_read) < read_buffer_.size()) {
+      // The socket is drained.
+      return;
     }
   }
-  h4_parser_.Consume(buffer.data(), bytes_read);
 }
 
 }  // namespace rootcanal
@@ -20,6 +20,7 @@
 #include <stdint.h>  // for uint8_t
 
 #include <memory>  // for shared_ptr
+#include <vector>  // for vector
 
 #include "h4_parser.h"     // for ClientDisconnectCallback, H4Parser
 #include "hci_protocol.h"  // for PacketReadCallback, AsyncDataChannel, HciProtocol
@@ -30,7 +31,8 @@ namespace rootcanal {
 using android::net::AsyncDataChannel;
 
 // A socket based H4DataChannelPacketizer. Call OnDataReady whenever
-// data can be read from the socket.
+// data can be read from the socket. Each call drains the socket in large
+// chunks, so several packets are parsed per call.
 class H4DataChannelPacketizer : public HciProtocol {
  public:
   H4DataChannelPacketizer(std::shared_ptr<AsyncDataChannel> socket,
@@ -48,6 +50,10 @@ class H4DataChannelPacketizer : public HciProtocol {
   std::shared_ptr<AsyncDataChannel> uart_socket_;
   H4Parser h4_parser_;
 
+  // Reused for every read and every send, to avoid an allocation per call.
+  std::vector<uint8_t> read_buffer_;
+  std::vector<uint8_t> send_buffer_;
+
   ClientDisconnectCallback disconnect_cb_;
   bool disconnected_{false};
 };
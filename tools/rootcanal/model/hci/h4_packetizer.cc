@@ -27,6 +27,9 @@
 
 namespace rootcanal {
 
+// Size of the chunks read from the file descriptor.
+static constexpr size_t kReadBufferSize = 64 * 1024;
+
 H4Packetizer::H4Packetizer(int fd, PacketReadCallback command_cb,
                            PacketReadCallback event_cb,
                            PacketReadCallback acl_cb, PacketReadCallback sco_cb,
@@ -34,6 +37,7 @@ H4Packetizer::H4Packetizer(int fd, PacketReadCallback command_cb,
                            ClientDisconnectCallback disconnect_cb)
     : uart_fd_(fd),
       h4_parser_(command_cb, event_cb, acl_cb, sco_cb, iso_cb),
+      read_buffer_(kReadBufferSize),
       disconnect_cb_(std::move(disconnect_cb)) {}
 
 size_t H4Packetizer::Send(uint8_t type, const uint8_t* data, size_t length) {
@@ -55,12 +59,9 @@ size_t H4Packetizer::Send(uint8_t type, const uint8_t* data, size_t length) {
 
 void H4Packetizer::OnDataReady(int fd) {
   if (disconnected_) return;
-  ssize_t bytes_to_read = h4_parser_.BytesRequested();
-  std::vector<uint8_t> buffer(bytes_to_read);
-
   ssize_t bytes_read;
   do {
-    bytes_read = read(fd, buffer.data(), bytes_to_read);
+    bytes_read = read(fd, read_buffer_.data(), read_buffer_.size());
   } while (bytes_read == -1 && errno == EINTR);
 
   if (bytes_read == 0) {
@@ -82,7 +83,7 @@ void H4Packetizer::OnDataReady(int fd) {
                        strerror(errno));
     }
   }
-  h4_parser_.Consume(buffer.data(), bytes_read);
+  h4_parser_.ConsumeChunk(read_buffer_.data(), bytes_read);
 }
 
 }  // namespace rootcanal
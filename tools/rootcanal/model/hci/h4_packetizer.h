@@ -25,7 +25,8 @@
 namespace rootcanal {
 
 // A socket based H4Packetizer. Call OnDataReady whenever
-// data can be read from file descriptor fd.
+// data can be read from file descriptor fd. Each call reads a chunk that
+// may hold several packets.
 //
 // This is only supported on unix.
 class H4Packetizer : public HciProtocol {
@@ -43,6 +44,9 @@ class H4Packetizer : public HciProtocol {
   int uart_fd_;
   H4Parser h4_parser_;
 
+  // Reused for every read, see OnDataReady.
+  std::vector<uint8_t> read_buffer_;
+
   ClientDisconnectCallback disconnect_cb_;
   bool disconnected_{false};
 };
@@ -16,6 +16,7 @@
 
 #include "model/hci/h4_parser.h"  // for H4Parser, PacketType, H4Pars...
 
+#include <algorithm>   // for min
 #include <array>
 #include <cstddef>     // for size_t
 #include <cstdint>     // for uint8_t, int32_t
@@ -212,4 +213,20 @@ bool H4Parser::Consume(const uint8_t* buffer, int32_t bytes_read) {
   }
   return true;
 }
+
+bool H4Parser::ConsumeChunk(const uint8_t* buffer, size_t bytes) {
+  if (bytes == 0) {
+    LOG_INFO("remote disconnected, or unhandled error?");
+    return false;
+  }
+  while (bytes > 0) {
+    size_t bytes_to_consume = std::min(BytesRequested(), bytes);
+    if (!Consume(buffer, static_cast<int32_t>(bytes_to_consume))) {
+      return false;
+    }
+    buffer += bytes_to_consume;
+    bytes -= bytes_to_consume;
+  }
+  return true;
+}
 }  // namespace rootcanal
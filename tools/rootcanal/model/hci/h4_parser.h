@@ -41,6 +41,10 @@ using ClientDisconnectCallback = std::function<void()>;
 // std::vector fill_this_vector_with_at_most_nr_bytes(nr_bytes);
 // h4.Consume(fill_this_vector_with_at_most_nr_bytes.data(), nr_bytes.size());
 //
+// or, when reading larger chunks from the transport:
+//
+// h4.ConsumeChunk(chunk.data(), bytes_read);
+//
 // The parser will invoke the proper callbacks once a packet has been parsed.
 // The parser keeps internal state and is not thread safe.
 class H4Parser {
@@ -54,6 +58,12 @@ class H4Parser {
   // Consumes the given number of bytes, returns true on success.
   bool Consume(const uint8_t* buffer, int32_t bytes);
 
+  // Consumes a chunk of any size, that may hold several packets and end in
+  // the middle of one. The bytes of each state are copied at once, and the
+  // packet buffer keeps its capacity from one packet to the next. Returns
+  // true on success.
+  bool ConsumeChunk(const uint8_t* buffer, size_t bytes);
+
   // The maximum number of bytes the parser can consume in the current state.
   size_t BytesRequested();
 
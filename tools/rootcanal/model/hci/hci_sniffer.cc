@@ -16,8 +16,6 @@
 
 #include "hci_sniffer.h"
 
-#include "pcap.h"
-
 namespace rootcanal {
 
 HciSniffer::HciSniffer(std::shared_ptr<HciTransport> transport,
@@ -27,31 +25,30 @@ HciSniffer::HciSniffer(std::shared_ptr<HciTransport> transport,
 }
 
 void HciSniffer::SetOutputStream(std::shared_ptr<std::ostream> outputStream) {
-  output_ = outputStream;
-  if (output_) {
+  writer_.reset();
+  if (outputStream) {
     uint32_t linktype = 201;  // http://www.tcpdump.org/linktypes.html
                               // LINKTYPE_BLUETOOTH_HCI_H4_WITH_PHDR
 
-    pcap::WriteHeader(*output_, linktype);
+    writer_ = std::make_unique<PcapWriter>(outputStream, linktype);
   }
 }
 
 void HciSniffer::AppendRecord(PacketDirection packet_direction,
                               PacketType packet_type,
                               const std::vector<uint8_t>& packet) {
-  if (output_ == nullptr) {
+  if (writer_ == nullptr || !writer_->IsEnabled()) {
     return;
   }
-  pcap::WriteRecordHeader(*output_, 4 + 1 + packet.size());
 
   // http://www.tcpdump.org/linktypes.html LINKTYPE_BLUETOOTH_HCI_H4_WITH_PHDR
-  char direction[4] = {0, 0, 0, static_cast<char>(packet_direction)};
-  uint8_t idc = static_cast<uint8_t>(packet_type);
-
-  output_->write(direction, sizeof(direction));
-  output_->write((char*)&idc, 1);
-  output_->write((char*)packet.data(), packet.size());
-  output_->flush();
+  std::vector<uint8_t> record;
+  record.reserve(4 + 1 + packet.size());
+  record.insert(record.end(),
+                {0, 0, 0, static_cast<uint8_t>(packet_direction),
+                 static_cast<uint8_t>(packet_type)});
+  record.insert(record.end(), packet.begin(), packet.end());
+  writer_->AppendRecord(std::move(record));
 }
 
 void HciSniffer::RegisterCallbacks(PacketCallback command_callback,
@@ -88,7 +85,9 @@ void HciSniffer::TimerTick() { transport_->TimerTick(); }
 
 void HciSniffer::Close() {
   transport_->Close();
-  output_->flush();
+  if (writer_) {
+    writer_->Flush();
+  }
 }
 
 void HciSniffer::SendEvent(const std::vector<uint8_t>& packet) {
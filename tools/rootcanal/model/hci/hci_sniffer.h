@@ -23,6 +23,7 @@
 
 #include "model/hci/h4.h"
 #include "model/hci/hci_transport.h"
+#include "model/setup/pcap_writer.h"
 
 namespace rootcanal {
 
@@ -66,11 +67,13 @@ class HciSniffer : public HciTransport {
 
   void Close() override;
 
+  PcapWriter* GetPcapWriter() override { return writer_.get(); }
+
  private:
   void AppendRecord(PacketDirection direction, PacketType type,
                     const std::vector<uint8_t>& packet);
 
-  std::shared_ptr<std::ostream> output_;
+  std::unique_ptr<PcapWriter> writer_;
   std::shared_ptr<HciTransport> transport_;
 };
 
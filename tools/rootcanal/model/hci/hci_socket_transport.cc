@@ -20,6 +20,10 @@
 
 namespace rootcanal {
 
+// Maximum number of buffers kept in the pool. Packets are handled by the
+// controller one at a time, so only a few buffers are in use at once.
+static constexpr size_t kMaxPooledBuffers = 8;
+
 HciSocketTransport::HciSocketTransport(std::shared_ptr<AsyncDataChannel> socket)
     : socket_(socket) {}
 
@@ -28,35 +32,41 @@ void HciSocketTransport::RegisterCallbacks(PacketCallback command_callback,
                                            PacketCallback sco_callback,
                                            PacketCallback iso_callback,
                                            CloseCallback close_callback) {
-  // TODO: Avoid the copy here by using new buffer in H4DataChannel
   h4_ = H4DataChannelPacketizer(
       socket_,
-      [command_callback](const std::vector<uint8_t>& raw_command) {
-        std::shared_ptr<std::vector<uint8_t>> packet_copy =
-            std::make_shared<std::vector<uint8_t>>(raw_command);
-        command_callback(packet_copy);
+      [this, command_callback](const std::vector<uint8_t>& raw_command) {
+        command_callback(CopyToPooledBuffer(raw_command));
       },
       [](const std::vector<uint8_t>&) {
         LOG_ALWAYS_FATAL("Unexpected Event in HciSocketTransport!");
       },
-      [acl_callback](const std::vector<uint8_t>& raw_acl) {
-        std::shared_ptr<std::vector<uint8_t>> packet_copy =
-            std::make_shared<std::vector<uint8_t>>(raw_acl);
-        acl_callback(packet_copy);
+      [this, acl_callback](const std::vector<uint8_t>& raw_acl) {
+        acl_callback(CopyToPooledBuffer(raw_acl));
       },
-      [sco_callback](const std::vector<uint8_t>& raw_sco) {
-        std::shared_ptr<std::vector<uint8_t>> packet_copy =
-            std::make_shared<std::vector<uint8_t>>(raw_sco);
-        sco_callback(packet_copy);
+      [this, sco_callback](const std::vector<uint8_t>& raw_sco) {
+        sco_callback(CopyToPooledBuffer(raw_sco));
       },
-      [iso_callback](const std::vector<uint8_t>& raw_iso) {
-        std::shared_ptr<std::vector<uint8_t>> packet_copy =
-            std::make_shared<std::vector<uint8_t>>(raw_iso);
-        iso_callback(packet_copy);
+      [this, iso_callback](const std::vector<uint8_t>& raw_iso) {
+        iso_callback(CopyToPooledBuffer(raw_iso));
       },
       close_callback);
 }
 
+std::shared_ptr<std::vector<uint8_t>> HciSocketTransport::CopyToPooledBuffer(
+    const std::vector<uint8_t>& packet) {
+  for (auto& buffer : buffer_pool_) {
+    if (buffer.use_count() == 1) {
+      buffer->assign(packet.begin(), packet.end());
+      return buffer;
+    }
+  }
+  auto buffer = std::make_shared<std::vector<uint8_t>>(packet);
+  if (buffer_pool_.size() < kMaxPooledBuffers) {
+    buffer_pool_.push_back(buffer);
+  }
+  return buffer;
+}
+
 void HciSocketTransport::TimerTick() { h4_.OnDataReady(socket_); }
 
 void HciSocketTransport::SendHci(PacketType packet_type,
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>  // for shared_ptr, make_...
+#include <vector>  // for vector
 
 #include "model/hci/h4_data_channel_packetizer.h"  // for H4DataChannelP...
 #include "model/hci/hci_transport.h"               // for HciTransport
@@ -57,6 +58,14 @@ class HciSocketTransport : public HciTransport {
  private:
   void SendHci(PacketType packet_type, const std::vector<uint8_t>& packet);
 
+  // Returns a copy of |packet| in a buffer of the pool. A buffer is reused
+  // once the controller does not reference it anymore, so that its
+  // allocation is reused by the following packets.
+  std::shared_ptr<std::vector<uint8_t>> CopyToPooledBuffer(
+      const std::vector<uint8_t>& packet);
+
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> buffer_pool_;
+
   std::shared_ptr<AsyncDataChannel> socket_;
   H4DataChannelPacketizer h4_{socket_,
                               [](const std::vector<uint8_t>&) {},
@@ -22,6 +22,8 @@
 
 namespace rootcanal {
 
+class PcapWriter;
+
 using PacketCallback =
     std::function<void(const std::shared_ptr<std::vector<uint8_t>>)>;
 using CloseCallback = std::function<void()>;
@@ -47,6 +49,9 @@ class HciTransport {
   virtual void TimerTick() = 0;
 
   virtual void Close() = 0;
+
+  // Return the writer capturing the traffic of this transport, if any.
+  virtual PcapWriter* GetPcapWriter() { return nullptr; }
 };
 
 }  // namespace rootcanal
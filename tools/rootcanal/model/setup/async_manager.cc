@@ -25,9 +25,19 @@
 
 #include "fcntl.h"
 #include "log.h"
-#include "sys/select.h"
+#include "simulation_clock.h"
 #include "unistd.h"
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define ASYNC_MANAGER_USE_EPOLL
+#elif defined(__APPLE__)
+#include <sys/event.h>
+#define ASYNC_MANAGER_USE_KQUEUE
+#else
+#include "sys/select.h"
+#endif
+
 namespace rootcanal {
 // Implementation of AsyncManager is divided between two classes, three if
 // AsyncManager itself is taken into account, but its only responsability
@@ -38,15 +48,20 @@ namespace rootcanal {
 // objects of this class may coexist simultaneosly as they share no state.
 // After construction of this objects nothing happens beyond some very simple
 // member initialization. When the first FD is set up for watching the object
-// starts a new thread which watches the given (and later provided) FDs using
-// select() inside a loop. A special FD (a pipe) is also watched which is
-// used to notify the thread of internal changes on the object state (like
-// the addition of new FDs to watch on). Every access to internal state is
-// synchronized using a single internal mutex. The thread is only stopped on
-// destruction of the object, by modifying a flag, which is the only member
-// variable accessed without acquiring the lock (because the notification to
-// the thread is done later by writing to a pipe which means the thread will
-// be notified regardless of what phase of the loop it is in that moment)
+// creates a poller (epoll on Linux, kqueue on macOS) and starts a new thread
+// which waits on it inside a loop. FDs are registered with the poller once,
+// when they start being watched, and removed from it when they stop being
+// watched, so the cost of a wait does not grow with the number of watched
+// FDs. On other platforms the thread falls back to select(), rebuilding the
+// set of FDs on each iteration. A special FD (a pipe) is also watched which
+// is used to notify the thread of internal changes on the object state (like
+// the call to stop it, or the addition of new FDs to watch on when select()
+// is used). Every access to internal state is synchronized using a single
+// internal mutex. The thread is only stopped on destruction of the object, by
+// modifying a flag, which is the only member variable accessed without
+// acquiring the lock (because the notification to the thread is done later by
+// writing to a pipe which means the thread will be notified regardless of
+// what phase of the loop it is in that moment)
 
 // The scheduling of asynchronous tasks, periodic or not, is handled by the
 // AsyncTaskManager class. Like the one for FDs, this class shares no internal
@@ -54,8 +69,11 @@ namespace rootcanal {
 // this class, also nothing interesting happens upon construction, but only
 // after a Task has been scheduled and access to internal state is synchronized
 // using a single internal mutex. When the first task is scheduled a thread
-// is started which monitors a queue of tasks. The queue is peeked to see
-// when the next task should be carried out and then the thread performs a
+// is started which monitors a queue of tasks. The queue is a binary min-heap
+// ordered by due time; cancelled tasks are only flagged and are dropped when
+// they reach the top of the heap, so scheduling and cancelling a task are
+// both O(log n) at most. The top of the heap is peeked to see when the next
+// task should be carried out and then the thread performs a
 // (absolute) timed wait on a condition variable. The wait ends because of a
 // time out or a notify on the cond var, the former means a task is due
 // for execution while the later means there has been a change in internal
@@ -71,6 +89,9 @@ namespace rootcanal {
 // resumes execution believing that it needs to continue and waits on the
 // cond var possibly forever if there are no tasks scheduled, efectively
 // causing a deadlock).
+// Task times are SimulationClock times. When the simulation runs in virtual
+// time the thread does not wait for the next task: once every task due at
+// the current time has run, it moves the clock to the time of the next one.
 
 // This number also states the maximum number of scheduled tasks we can handle
 // at a given time
@@ -91,33 +112,44 @@ static inline AsyncTaskId NextAsyncTaskId(const AsyncTaskId id) {
 // no need to treat that case.
 static const int kNotificationBufferSize = 10;
 
+#if defined(ASYNC_MANAGER_USE_EPOLL) || defined(ASYNC_MANAGER_USE_KQUEUE)
+// Maximum number of ready FDs returned by a single wait on the poller. FDs
+// that are still ready are returned again by the next wait.
+static const int kMaxEventsPerWait = 64;
+#endif
+
 // Async File Descriptor Watcher Implementation:
 class AsyncManager::AsyncFdWatcher {
  public:
   int WatchFdForNonBlockingReads(
       int file_descriptor, const ReadCallback& on_read_fd_ready_callback) {
-    // add file descriptor and callback
-    {
-      std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-      watched_shared_fds_[file_descriptor] = on_read_fd_ready_callback;
-    }
-
-    // start the thread if not started yet
+    // start the thread if not started yet, this also creates the poller
     int started = tryStartThread();
     if (started != 0) {
       LOG_ERROR("%s: Unable to start thread", __func__);
       return started;
     }
 
-    // notify the thread so that it knows of the new FD
-    notifyThread();
+    // add file descriptor and callback
+    {
+      std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
+      watched_shared_fds_[file_descriptor] = on_read_fd_ready_callback;
+      if (registerFileDescriptor(file_descriptor) != 0) {
+        LOG_ERROR("%s: Unable to watch fd %d: %s", __func__, file_descriptor,
+                  strerror(errno));
+        watched_shared_fds_.erase(file_descriptor);
+        return -1;
+      }
+    }
 
     return 0;
   }
 
   void StopWatchingFileDescriptor(int file_descriptor) {
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-    watched_shared_fds_.erase(file_descriptor);
+    if (watched_shared_fds_.erase(file_descriptor) != 0) {
+      unregisterFileDescriptor(file_descriptor);
+    }
   }
 
   AsyncFdWatcher() = default;
@@ -135,6 +167,7 @@ class AsyncManager::AsyncFdWatcher {
 
     if (std::this_thread::get_id() != thread_.get_id()) {
       thread_.join();
+      closeCommunicationChannel();
     } else {
       LOG_WARN("%s: Starting thread stop from inside the reading thread itself",
                __func__);
@@ -157,7 +190,8 @@ class AsyncManager::AsyncFdWatcher {
     }
     // set up the communication channel
     int pipe_fds[2];
-    if (pipe2(pipe_fds, O_NONBLOCK)) {
+    if (pipe(pipe_fds) || fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK) ||
+        fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK)) {
       LOG_ERROR(
           "%s:Unable to establish a communication channel to the reading "
           "thread",
@@ -167,6 +201,12 @@ class AsyncManager::AsyncFdWatcher {
     notification_listen_fd_ = pipe_fds[0];
     notification_write_fd_ = pipe_fds[1];
 
+    if (createPoller() != 0) {
+      LOG_ERROR("%s: Unable to create the poller: %s", __func__,
+                strerror(errno));
+      return -1;
+    }
+
     thread_ = std::thread([this]() { ThreadRoutine(); });
     if (!thread_.joinable()) {
       LOG_ERROR("%s: Unable to start reading thread", __func__);
@@ -175,6 +215,15 @@ class AsyncManager::AsyncFdWatcher {
     return 0;
   }
 
+  void closeCommunicationChannel() {
+    close(notification_listen_fd_);
+    close(notification_write_fd_);
+#if defined(ASYNC_MANAGER_USE_EPOLL) || defined(ASYNC_MANAGER_USE_KQUEUE)
+    close(poller_fd_);
+    poller_fd_ = -1;
+#endif
+  }
+
   int notifyThread() {
     char buffer = '0';
     if (TEMP_FAILURE_RETRY(write(notification_write_fd_, &buffer, 1)) < 0) {
@@ -184,6 +233,113 @@ class AsyncManager::AsyncFdWatcher {
     return 0;
   }
 
+  // read everything there is in the comm channel
+  void consumeThreadNotifications() {
+    char buffer[kNotificationBufferSize];
+    while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
+                                   kNotificationBufferSize)) ==
+           kNotificationBufferSize) {
+    }
+  }
+
+#if defined(ASYNC_MANAGER_USE_EPOLL)
+  int createPoller() {
+    poller_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (poller_fd_ < 0) {
+      return -1;
+    }
+    return registerFileDescriptor(notification_listen_fd_);
+  }
+
+  // Level triggered, so that a FD whose data is not entirely consumed by its
+  // callback is reported again, as it was with select().
+  int registerFileDescriptor(int file_descriptor) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = file_descriptor;
+    if (epoll_ctl(poller_fd_, EPOLL_CTL_ADD, file_descriptor, &event) == 0) {
+      return 0;
+    }
+    // the FD is watched again with a different callback
+    if (errno == EEXIST) {
+      return epoll_ctl(poller_fd_, EPOLL_CTL_MOD, file_descriptor, &event);
+    }
+    return -1;
+  }
+
+  // The FD may have been closed already, in which case the kernel already
+  // removed it from the poller and the error is ignored.
+  void unregisterFileDescriptor(int file_descriptor) {
+    epoll_ctl(poller_fd_, EPOLL_CTL_DEL, file_descriptor, nullptr);
+  }
+
+  int waitForReadyFileDescriptors(std::vector<int>& ready_fds) {
+    epoll_event events[kMaxEventsPerWait];
+    int retval = epoll_wait(poller_fd_, events, kMaxEventsPerWait, -1);
+    if (retval < 0) {
+      return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < retval; i++) {
+      if (events[i].data.fd == notification_listen_fd_) {
+        consumeThreadNotifications();
+      } else {
+        ready_fds.push_back(events[i].data.fd);
+      }
+    }
+    return 0;
+  }
+#elif defined(ASYNC_MANAGER_USE_KQUEUE)
+  int createPoller() {
+    poller_fd_ = kqueue();
+    if (poller_fd_ < 0) {
+      return -1;
+    }
+    fcntl(poller_fd_, F_SETFD, FD_CLOEXEC);
+    return registerFileDescriptor(notification_listen_fd_);
+  }
+
+  // EV_ADD on a FD that is already registered only updates it.
+  int registerFileDescriptor(int file_descriptor) {
+    struct kevent change;
+    EV_SET(&change, file_descriptor, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+    return kevent(poller_fd_, &change, 1, nullptr, 0, nullptr) < 0 ? -1 : 0;
+  }
+
+  // The FD may have been closed already, in which case the kernel already
+  // removed it from the poller and the error is ignored.
+  void unregisterFileDescriptor(int file_descriptor) {
+    struct kevent change;
+    EV_SET(&change, file_descriptor, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    kevent(poller_fd_, &change, 1, nullptr, 0, nullptr);
+  }
+
+  int waitForReadyFileDescriptors(std::vector<int>& ready_fds) {
+    struct kevent events[kMaxEventsPerWait];
+    int retval =
+        kevent(poller_fd_, nullptr, 0, events, kMaxEventsPerWait, nullptr);
+    if (retval < 0) {
+      return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < retval; i++) {
+      int fd = static_cast<int>(events[i].ident);
+      if (fd == notification_listen_fd_) {
+        consumeThreadNotifications();
+      } else {
+        ready_fds.push_back(fd);
+      }
+    }
+    return 0;
+  }
+#else
+  int createPoller() { return 0; }
+
+  // notify the thread so that it knows of the new FD
+  int registerFileDescriptor(int /* file_descriptor */) {
+    return notifyThread();
+  }
+
+  void unregisterFileDescriptor(int /* file_descriptor */) {}
+
   int setUpFileDescriptorSet(fd_set& read_fds) {
     // add comm channel to the set
     FD_SET(notification_listen_fd_, &read_fds);
@@ -200,42 +356,49 @@ class AsyncManager::AsyncFdWatcher {
     return nfds;
   }
 
-  // check the comm channel and read everything there
-  bool consumeThreadNotifications(fd_set& read_fds) {
+  int waitForReadyFileDescriptors(std::vector<int>& ready_fds) {
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    int nfds = setUpFileDescriptorSet(read_fds);
+
+    int retval = select(nfds + 1, &read_fds, NULL, NULL, NULL);
+    if (retval <= 0) {  // there was some error or a timeout
+      return -1;
+    }
     if (FD_ISSET(notification_listen_fd_, &read_fds)) {
-      char buffer[kNotificationBufferSize];
-      while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
-                                     kNotificationBufferSize)) ==
-             kNotificationBufferSize) {
-      }
-      return true;
+      consumeThreadNotifications();
     }
-    return false;
-  }
-
-  // check all file descriptors and call callbacks if necesary
-  void runAppropriateCallbacks(fd_set& read_fds) {
-    std::vector<decltype(watched_shared_fds_)::value_type> fds;
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
     for (auto& fdc : watched_shared_fds_) {
       if (FD_ISSET(fdc.first, &read_fds)) {
-        fds.push_back(fdc);
+        ready_fds.push_back(fdc.first);
       }
     }
-    for (auto& p : fds) {
-      p.second(p.first);
+    return 0;
+  }
+#endif
+
+  // call the callbacks of the ready file descriptors that are still watched
+  void runAppropriateCallbacks(const std::vector<int>& ready_fds) {
+    std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
+    for (int fd : ready_fds) {
+      auto it = watched_shared_fds_.find(fd);
+      if (it == watched_shared_fds_.end()) {
+        continue;  // stopped being watched by a previous callback
+      }
+      // The callback may stop watching its own FD, keep it alive meanwhile
+      ReadCallback callback = it->second;
+      callback(fd);
     }
   }
 
   void ThreadRoutine() {
+    std::vector<int> ready_fds;
     while (running_) {
-      fd_set read_fds;
-      FD_ZERO(&read_fds);
-      int nfds = setUpFileDescriptorSet(read_fds);
+      ready_fds.clear();
 
       // wait until there is data available to read on some FD
-      int retval = select(nfds + 1, &read_fds, NULL, NULL, NULL);
-      if (retval <= 0) {  // there was some error or a timeout
+      if (waitForReadyFileDescriptors(ready_fds) != 0) {
         LOG_ERROR(
             "%s: There was an error while waiting for data on the file "
             "descriptors: %s",
@@ -243,14 +406,12 @@ class AsyncManager::AsyncFdWatcher {
         continue;
       }
 
-      consumeThreadNotifications(read_fds);
-
       // Do not read if there was a call to stop running
       if (!running_) {
         break;
       }
 
-      runAppropriateCallbacks(read_fds);
+      runAppropriateCallbacks(ready_fds);
     }
   }
 
@@ -263,6 +424,11 @@ class AsyncManager::AsyncFdWatcher {
   // A pair of FD to send information to the reading thread
   int notification_listen_fd_{};
   int notification_write_fd_{};
+
+#if defined(ASYNC_MANAGER_USE_EPOLL) || defined(ASYNC_MANAGER_USE_KQUEUE)
+  // The epoll or kqueue instance the watched FDs are registered with
+  int poller_fd_{-1};
+#endif
 };
 
 // Async task manager implementation
@@ -273,7 +439,7 @@ class AsyncManager::AsyncTaskManager {
   AsyncTaskId ExecAsync(AsyncUserId user_id, std::chrono::milliseconds delay,
                         const TaskCallback& callback) {
     return scheduleTask(std::make_shared<Task>(
-        std::chrono::steady_clock::now() + delay, callback, user_id));
+        SimulationClock::Now() + delay, callback, user_id));
   }
 
   AsyncTaskId ExecAsyncPeriodically(AsyncUserId user_id,
@@ -281,7 +447,7 @@ class AsyncManager::AsyncTaskManager {
                                     std::chrono::milliseconds period,
                                     const TaskCallback& callback) {
     return scheduleTask(std::make_shared<Task>(
-        std::chrono::steady_clock::now() + delay, period, callback, user_id));
+        SimulationClock::Now() + delay, period, callback, user_id));
   }
 
   bool CancelAsyncTask(AsyncTaskId async_task_id) {
@@ -368,18 +534,21 @@ class AsyncManager::AsyncTaskManager {
     TaskCallback callback;
     AsyncTaskId task_id;
     AsyncUserId user_id;
+    bool cancelled{false};  // Still in the queue, dropped when popped
   };
 
-  // A comparator class to put shared pointers to tasks in an ordered set
+  // A comparator class to keep shared pointers to tasks in a min-heap, the
+  // standard heap algorithms build max-heaps so the order is reversed
   struct task_p_comparator {
     bool operator()(const std::shared_ptr<Task>& t1,
                     const std::shared_ptr<Task>& t2) const {
-      return *t1 < *t2;
+      return *t2 < *t1;
     }
   };
 
   bool cancel_task_with_lock_held(AsyncTaskId async_task_id) {
-    if (tasks_by_id_.count(async_task_id) == 0) {
+    auto it = tasks_by_id_.find(async_task_id);
+    if (it == tasks_by_id_.end()) {
       return false;
     }
 
@@ -388,19 +557,39 @@ class AsyncManager::AsyncTaskManager {
     // - This is called from thread_, this means a running
     //   scheduled task is actually unregistering. All bets are off.
     // - Another thread is calling us, let's make sure the task is not active.
+    std::shared_ptr<Task> task = it->second;
     if (thread_.get_id() != std::this_thread::get_id()) {
-      auto task = tasks_by_id_[async_task_id];
       const std::lock_guard<std::mutex> lock(task->in_callback);
-      task_queue_.erase(task);
+      task->cancelled = true;
       tasks_by_id_.erase(async_task_id);
     } else {
-      task_queue_.erase(tasks_by_id_[async_task_id]);
+      task->cancelled = true;
       tasks_by_id_.erase(async_task_id);
     }
 
     return true;
   }
 
+  void pushTaskWithLockHeld(const std::shared_ptr<Task>& task) {
+    task_queue_.push_back(task);
+    std::push_heap(task_queue_.begin(), task_queue_.end(), task_p_comparator());
+  }
+
+  std::shared_ptr<Task> popTaskWithLockHeld() {
+    std::pop_heap(task_queue_.begin(), task_queue_.end(), task_p_comparator());
+    std::shared_ptr<Task> task = std::move(task_queue_.back());
+    task_queue_.pop_back();
+    return task;
+  }
+
+  // Drops the cancelled tasks from the top of the heap, so that the top is
+  // the next task to run
+  void dropCancelledTasksWithLockHeld() {
+    while (!task_queue_.empty() && task_queue_.front()->cancelled) {
+      popTaskWithLockHeld();
+    }
+  }
+
   AsyncTaskId scheduleTask(const std::shared_ptr<Task>& task) {
     {
       std::unique_lock<std::mutex> guard(internal_mutex_);
@@ -414,7 +603,7 @@ class AsyncManager::AsyncTaskManager {
       // add task to the queue and map
       tasks_by_id_[lastTaskId_] = task;
       tasks_by_user_id_[task->user_id].insert(task->task_id);
-      task_queue_.insert(task);
+      pushTaskWithLockHeld(task);
     }
     // start thread if necessary
     int started = tryStartThread();
@@ -456,16 +645,16 @@ class AsyncManager::AsyncTaskManager {
       bool run_it = false;
       {
         std::unique_lock<std::mutex> guard(internal_mutex_);
+        dropCancelledTasksWithLockHeld();
         if (!task_queue_.empty()) {
-          task_p = *(task_queue_.begin());
-          if (task_p->time < std::chrono::steady_clock::now()) {
+          if (task_queue_.front()->time <= SimulationClock::Now()) {
             run_it = true;
+            task_p = popTaskWithLockHeld();
             callback = task_p->callback;
-            task_queue_.erase(task_p);  // need to remove and add again if
-                                        // periodic to update order
+            // push again if periodic to update order
             if (task_p->isPeriodic()) {
               task_p->time += task_p->period;
-              task_queue_.insert(task_p);
+              pushTaskWithLockHeld(task_p);
             } else {
               tasks_by_user_id_[task_p->user_id].erase(task_p->task_id);
               tasks_by_id_.erase(task_p->task_id);
@@ -482,13 +671,20 @@ class AsyncManager::AsyncTaskManager {
         // check for termination right before waiting
         if (!running_) break;
         // wait until time for the next task (if any)
+        dropCancelledTasksWithLockHeld();
         if (task_queue_.size() > 0) {
           // Make a copy of the time_point because wait_until takes a reference
           // to it and may read it after waiting, by which time the task may
           // have been freed (e.g. via CancelAsyncTask).
           std::chrono::steady_clock::time_point time =
-              (*task_queue_.begin())->time;
-          internal_cond_var_.wait_until(guard, time);
+              task_queue_.front()->time;
+          if (SimulationClock::IsVirtualTime()) {
+            // Every task due now has run, fast-forward to the next one.
+            SimulationClock::AdvanceTo(time);
+            continue;
+          }
+          internal_cond_var_.wait_until(guard,
+                                        SimulationClock::ToSteadyTime(time));
         } else {
           internal_cond_var_.wait(guard);
         }
@@ -505,7 +701,8 @@ class AsyncManager::AsyncTaskManager {
   AsyncUserId lastUserId_{1};
   std::map<AsyncTaskId, std::shared_ptr<Task>> tasks_by_id_;
   std::map<AsyncUserId, std::set<AsyncTaskId>> tasks_by_user_id_;
-  std::set<std::shared_ptr<Task>, task_p_comparator> task_queue_;
+  // Min-heap on the due time of the tasks, see task_p_comparator
+  std::vector<std::shared_ptr<Task>> task_queue_;
 };
 
 // Async Manager Implementation:
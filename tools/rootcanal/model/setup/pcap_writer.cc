@@ -0,0 +1,199 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcap_writer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <sstream>
+
+#include "log.h"
+#include "pcap.h"
+
+namespace rootcanal {
+
+PcapWriter::PcapWriter(std::shared_ptr<std::ostream> output,
+                       uint32_t linktype, size_t capacity)
+    : output_(std::move(output)), linktype_(linktype), ring_(capacity) {
+  if (output_) {
+    pcap::WriteHeader(*output_, linktype_);
+    output_->flush();
+  }
+  writer_ = std::thread([this]() { WriterRoutine(); });
+}
+
+PcapWriter::~PcapWriter() {
+  {
+    std::unique_lock<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  records_cond_var_.notify_one();
+  writer_.join();
+  if (stream_fd_ >= 0) {
+    close(stream_fd_);
+  }
+}
+
+void PcapWriter::AppendRecord(std::vector<uint8_t> record) {
+  if (!enabled_) {
+    return;
+  }
+
+  auto timestamp = std::chrono::system_clock::now();
+  {
+    std::unique_lock<std::mutex> guard(mutex_);
+    if (ring_size_ == ring_.size()) {
+      dropped_records_++;
+      return;
+    }
+    Record& slot = ring_[(ring_head_ + ring_size_) % ring_.size()];
+    slot.timestamp = timestamp;
+    slot.data = std::move(record);
+    ring_size_++;
+  }
+  records_cond_var_.notify_one();
+}
+
+bool PcapWriter::StreamTo(const std::string& path) {
+  if (!path.empty() && mkfifo(path.c_str(), 0600) != 0 && errno != EEXIST) {
+    LOG_WARN("Failed to create the named pipe %s: %s", path.c_str(),
+             strerror(errno));
+    return false;
+  }
+  std::unique_lock<std::mutex> guard(mutex_);
+  stream_path_ = path;
+  return true;
+}
+
+void PcapWriter::Flush() {
+  std::unique_lock<std::mutex> guard(mutex_);
+  drained_cond_var_.wait(guard,
+                         [this]() { return ring_size_ == 0 && !writing_; });
+}
+
+void PcapWriter::WriterRoutine() {
+  // Writing to a named pipe whose reader went away raises SIGPIPE,
+  // keep it on this thread and handle EPIPE instead.
+  sigset_t sigpipe;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+
+  std::vector<Record> records;
+  std::unique_lock<std::mutex> guard(mutex_);
+  while (true) {
+    records_cond_var_.wait(guard,
+                           [this]() { return stopping_ || ring_size_ > 0; });
+    if (ring_size_ == 0) {
+      return;
+    }
+
+    records.clear();
+    for (; ring_size_ > 0; ring_size_--) {
+      records.push_back(std::move(ring_[ring_head_]));
+      ring_head_ = (ring_head_ + 1) % ring_.size();
+    }
+    std::string stream_path = stream_path_;
+    writing_ = true;
+
+    guard.unlock();
+    WriteRecords(records, stream_path);
+    guard.lock();
+
+    writing_ = false;
+    drained_cond_var_.notify_all();
+  }
+}
+
+void PcapWriter::WriteRecords(const std::vector<Record>& records,
+                              const std::string& stream_path) {
+  std::ostringstream buffer;
+  for (auto const& record : records) {
+    pcap::WriteRecordHeader(buffer, record.data.size(), record.timestamp);
+    buffer.write((char*)record.data.data(), record.data.size());
+  }
+
+  std::string bytes = buffer.str();
+  if (output_) {
+    output_->write(bytes.data(), bytes.size());
+    output_->flush();
+  }
+  WriteToStream(bytes, stream_path);
+}
+
+static bool WriteAll(int fd, const std::string& bytes) {
+  size_t offset = 0;
+  while (offset < bytes.size()) {
+    ssize_t written =
+        write(fd, bytes.data() + offset, bytes.size() - offset);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    offset += written;
+  }
+  return true;
+}
+
+void PcapWriter::WriteToStream(const std::string& bytes,
+                               const std::string& stream_path) {
+  if (stream_fd_ >= 0 && stream_path != opened_stream_path_) {
+    close(stream_fd_);
+    stream_fd_ = -1;
+  }
+  if (stream_path.empty()) {
+    return;
+  }
+
+  if (stream_fd_ < 0) {
+    // Opening the write end of a named pipe in non blocking mode fails
+    // with ENXIO until a reader is attached.
+    int fd = open(stream_path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    // Once attached, block the writer thread rather than the reader
+    // getting truncated records.
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+    std::ostringstream header;
+    pcap::WriteHeader(header, linktype_);
+    if (!WriteAll(fd, header.str())) {
+      close(fd);
+      return;
+    }
+    LOG_INFO("Streaming the capture to %s", stream_path.c_str());
+    stream_fd_ = fd;
+    opened_stream_path_ = stream_path;
+  }
+
+  if (!WriteAll(stream_fd_, bytes)) {
+    LOG_INFO("Stopped streaming the capture to %s: %s", stream_path.c_str(),
+             strerror(errno));
+    close(stream_fd_);
+    stream_fd_ = -1;
+  }
+}
+
+}  // namespace rootcanal
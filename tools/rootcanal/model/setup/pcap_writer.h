@@ -0,0 +1,103 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rootcanal {
+
+// Writes pcap records from a dedicated thread.
+//
+// Records are queued in a bounded ring by AppendRecord() and written to the
+// output stream by the writer thread, so that capturing does not slow down
+// the packet delivery path. Records are dropped when the ring is full.
+// The records can also be streamed live to a named pipe, e.g. for
+// `wireshark -k -i <path>`.
+class PcapWriter {
+ public:
+  static constexpr size_t kDefaultCapacity = 4096;
+
+  PcapWriter(std::shared_ptr<std::ostream> output, uint32_t linktype,
+             size_t capacity = kDefaultCapacity);
+  ~PcapWriter();
+
+  PcapWriter(const PcapWriter&) = delete;
+  PcapWriter& operator=(const PcapWriter&) = delete;
+
+  // Records appended while the capture is disabled are discarded.
+  void SetEnabled(bool enabled) { enabled_ = enabled; }
+  bool IsEnabled() const { return enabled_; }
+
+  // Queue a record, timestamped with the current time. The record
+  // content follows the pcap record header and depends on the linktype.
+  void AppendRecord(std::vector<uint8_t> record);
+
+  // Stream the records to the named pipe |path|, created if it does not
+  // exist. The pipe is opened once a reader is attached; records written
+  // before then are not streamed. An empty path stops the streaming.
+  bool StreamTo(const std::string& path);
+
+  // Wait until every queued record has been written.
+  void Flush();
+
+  uint64_t GetDroppedRecordCount() const { return dropped_records_; }
+
+ private:
+  struct Record {
+    std::chrono::system_clock::time_point timestamp;
+    std::vector<uint8_t> data;
+  };
+
+  void WriterRoutine();
+  void WriteRecords(const std::vector<Record>& records,
+                    const std::string& stream_path);
+  void WriteToStream(const std::string& bytes, const std::string& stream_path);
+
+  std::shared_ptr<std::ostream> output_;
+  const uint32_t linktype_;
+
+  std::atomic<bool> enabled_{true};
+  std::atomic<uint64_t> dropped_records_{0};
+
+  std::mutex mutex_;
+  std::condition_variable records_cond_var_;
+  std::condition_variable drained_cond_var_;
+  std::vector<Record> ring_;
+  size_t ring_head_{0};
+  size_t ring_size_{0};
+  bool writing_{false};
+  bool stopping_{false};
+  std::string stream_path_;
+
+  // Only accessed from the writer thread.
+  int stream_fd_{-1};
+  std::string opened_stream_path_;
+
+  std::thread writer_;
+};
+
+}  // namespace rootcanal
@@ -37,6 +37,11 @@ class PhyLayer {
 
   virtual void Receive(model::packets::LinkLayerPacketView packet) = 0;
 
+  // Only deliver to the device the packets sent to |address|, broadcast
+  // packets and packets sent to other addresses are dropped by the phy.
+  // Phy layers deliver every packet until this is called.
+  virtual void SetReceiveAddress(bluetooth::hci::Address address) = 0;
+
   virtual void TimerTick() = 0;
 
   virtual bool IsFactoryId(uint32_t factory_id) = 0;
@@ -20,6 +20,8 @@
 
 namespace rootcanal {
 
+thread_local size_t PhyLayerFactory::current_shard_ = 0;
+
 PhyLayerFactory::PhyLayerFactory(Phy::Type phy_type, uint32_t factory_id)
     : phy_type_(phy_type), factory_id_(factory_id) {}
 
@@ -34,18 +36,64 @@ std::shared_ptr<PhyLayer> PhyLayerFactory::GetPhyLayer(
   std::shared_ptr<PhyLayer> new_phy = std::make_shared<PhyLayerImpl>(
       phy_type_, next_id_++, device_receive, device_id, this);
   phy_layers_.push_back(new_phy);
+  promiscuous_phy_layers_.push_back(new_phy);
   return new_phy;
 }
 
 void PhyLayerFactory::UnregisterPhyLayer(uint32_t id) {
+  std::lock_guard<std::mutex> guard(receive_addresses_mutex_);
   for (auto phy : phy_layers_) {
     if (phy->GetId() == id) {
       phy_layers_.remove(phy);
+      promiscuous_phy_layers_.remove(phy);
+      auto address = receive_addresses_.find(id);
+      if (address != receive_addresses_.end()) {
+        auto range = addressed_phy_layers_.equal_range(address->second);
+        for (auto it = range.first; it != range.second; it++) {
+          if (it->second == phy) {
+            addressed_phy_layers_.erase(it);
+            break;
+          }
+        }
+        receive_addresses_.erase(address);
+      }
       return;
     }
   }
 }
 
+void PhyLayerFactory::SetPhyLayerReceiveAddress(
+    uint32_t id, bluetooth::hci::Address address) {
+  std::lock_guard<std::mutex> guard(receive_addresses_mutex_);
+  std::shared_ptr<PhyLayer> phy;
+  for (auto& p : phy_layers_) {
+    if (p->GetId() == id) {
+      phy = p;
+      break;
+    }
+  }
+  if (phy == nullptr) {
+    return;
+  }
+
+  // Remove the phy layer from its previous place in the index.
+  auto previous = receive_addresses_.find(id);
+  if (previous == receive_addresses_.end()) {
+    promiscuous_phy_layers_.remove(phy);
+  } else {
+    auto range = addressed_phy_layers_.equal_range(previous->second);
+    for (auto it = range.first; it != range.second; it++) {
+      if (it->second == phy) {
+        addressed_phy_layers_.erase(it);
+        break;
+      }
+    }
+  }
+
+  receive_addresses_[id] = address;
+  addressed_phy_layers_.emplace(address, phy);
+}
+
 void PhyLayerFactory::UnregisterAllPhyLayers() {
   while (!phy_layers_.empty()) {
     if (phy_layers_.begin() != phy_layers_.end()) {
@@ -73,14 +121,54 @@ void PhyLayerFactory::Send(
 }
 
 void PhyLayerFactory::Send(model::packets::LinkLayerPacketView packet,
-                           uint32_t id, [[maybe_unused]] uint32_t device_id) {
-  for (const auto& phy : phy_layers_) {
+                           uint32_t id, uint32_t device_id) {
+  if (defer_delivery_) {
+    deferred_packets_[current_shard_].push_back({packet, id, device_id});
+    return;
+  }
+
+  for (const auto& phy : promiscuous_phy_layers_) {
     if (id != phy->GetId()) {
       phy->Receive(packet);
     }
   }
+
+  // Broadcast packets are not delivered to the addressed phy layers.
+  auto destination = packet.GetDestinationAddress();
+  if (destination == bluetooth::hci::Address::kEmpty) {
+    return;
+  }
+  // Copy the receivers, a device may change its address while receiving.
+  std::vector<std::shared_ptr<PhyLayer>> receivers;
+  auto range = addressed_phy_layers_.equal_range(destination);
+  for (auto it = range.first; it != range.second; it++) {
+    if (id != it->second->GetId()) {
+      receivers.push_back(it->second);
+    }
+  }
+  for (const auto& phy : receivers) {
+    phy->Receive(packet);
+  }
 }
 
+void PhyLayerFactory::DeferDelivery(size_t num_shards) {
+  deferred_packets_.resize(num_shards);
+  defer_delivery_ = true;
+}
+
+void PhyLayerFactory::DeliverDeferredPackets() {
+  defer_delivery_ = false;
+  auto deferred_packets = std::move(deferred_packets_);
+  deferred_packets_.clear();
+  for (auto& shard_packets : deferred_packets) {
+    for (auto& deferred : shard_packets) {
+      Send(deferred.packet, deferred.phy_id, deferred.device_id);
+    }
+  }
+}
+
+void PhyLayerFactory::SetCurrentShard(size_t shard) { current_shard_ = shard; }
+
 void PhyLayerFactory::TimerTick() {
   for (auto& phy : phy_layers_) {
     phy->TimerTick();
@@ -125,6 +213,10 @@ void PhyLayerImpl::Send(model::packets::LinkLayerPacketView packet) {
   factory_->Send(packet, GetId(), GetDeviceId());
 }
 
+void PhyLayerImpl::SetReceiveAddress(bluetooth::hci::Address address) {
+  factory_->SetPhyLayerReceiveAddress(GetId(), address);
+}
+
 void PhyLayerImpl::Unregister() { factory_->UnregisterPhyLayer(GetId()); }
 
 bool PhyLayerImpl::IsFactoryId(uint32_t id) {
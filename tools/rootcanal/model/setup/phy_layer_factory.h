@@ -17,7 +17,10 @@
 #pragma once
 
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "include/phy.h"
@@ -49,6 +52,20 @@ class PhyLayerFactory {
 
   virtual void TimerTick();
 
+  // Queues the packets sent from now on instead of delivering them, with
+  // one queue per shard of devices. Used while the device ticks run on
+  // several threads, see TestModel::SetTickWorkers().
+  void DeferDelivery(size_t num_shards);
+
+  // Stops queueing and delivers the queued packets, shard after shard, in
+  // the order in which they were sent. Packets sent in reply are delivered
+  // right away.
+  void DeliverDeferredPackets();
+
+  // Selects the queue used for the packets sent from the calling thread
+  // while the delivery is deferred.
+  static void SetCurrentShard(size_t shard);
+
   virtual std::string ToString() const;
 
  protected:
@@ -61,6 +78,27 @@ class PhyLayerFactory {
   std::list<std::shared_ptr<PhyLayer>> phy_layers_;
 
  private:
+  void SetPhyLayerReceiveAddress(uint32_t id, bluetooth::hci::Address address);
+
+  // Phy layers that receive every packet.
+  std::list<std::shared_ptr<PhyLayer>> promiscuous_phy_layers_;
+  // Phy layers that only receive the packets sent to their address, indexed
+  // by that address so that sending a unicast packet does not visit them all.
+  std::unordered_multimap<bluetooth::hci::Address, std::shared_ptr<PhyLayer>>
+      addressed_phy_layers_;
+  std::map<uint32_t, bluetooth::hci::Address> receive_addresses_;
+  // Set while the device ticks run on several threads.
+  bool defer_delivery_{false};
+  struct DeferredPacket {
+    model::packets::LinkLayerPacketView packet;
+    uint32_t phy_id;
+    uint32_t device_id;
+  };
+  std::vector<std::vector<DeferredPacket>> deferred_packets_;
+  static thread_local size_t current_shard_;
+  // Devices may change their receive address from their tick.
+  std::mutex receive_addresses_mutex_;
+
   Phy::Type phy_type_;
   uint32_t next_id_{1};
   const uint32_t factory_id_;
@@ -78,6 +116,7 @@ class PhyLayerImpl : public PhyLayer {
       std::shared_ptr<model::packets::LinkLayerPacketBuilder> packet) override;
   void Send(model::packets::LinkLayerPacketView packet) override;
   void Receive(model::packets::LinkLayerPacketView packet) override;
+  void SetReceiveAddress(bluetooth::hci::Address address) override;
   void Unregister() override;
   bool IsFactoryId(uint32_t factory_id) override;
   void TimerTick() override;
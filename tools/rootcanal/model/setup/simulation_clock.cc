@@ -0,0 +1,73 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simulation_clock.h"
+
+#include <mutex>
+
+namespace rootcanal {
+
+namespace {
+std::mutex clock_mutex;
+bool virtual_time = false;
+// Current time when the virtual time mode is enabled.
+SimulationClock::time_point virtual_now{};
+// Added to the steady clock when the virtual time mode is disabled, it
+// accounts for the time skipped while the mode was enabled.
+std::chrono::steady_clock::duration steady_offset{};
+}  // namespace
+
+SimulationClock::time_point SimulationClock::Now() {
+  std::lock_guard<std::mutex> guard(clock_mutex);
+  if (virtual_time) {
+    return virtual_now;
+  }
+  return std::chrono::steady_clock::now() + steady_offset;
+}
+
+bool SimulationClock::IsVirtualTime() {
+  std::lock_guard<std::mutex> guard(clock_mutex);
+  return virtual_time;
+}
+
+void SimulationClock::SetVirtualTime(bool enabled) {
+  std::lock_guard<std::mutex> guard(clock_mutex);
+  if (enabled == virtual_time) {
+    return;
+  }
+  auto steady_now = std::chrono::steady_clock::now();
+  if (enabled) {
+    virtual_now = steady_now + steady_offset;
+  } else {
+    steady_offset = virtual_now - steady_now;
+  }
+  virtual_time = enabled;
+}
+
+void SimulationClock::AdvanceTo(time_point time) {
+  std::lock_guard<std::mutex> guard(clock_mutex);
+  if (virtual_time && time > virtual_now) {
+    virtual_now = time;
+  }
+}
+
+std::chrono::steady_clock::time_point SimulationClock::ToSteadyTime(
+    time_point time) {
+  std::lock_guard<std::mutex> guard(clock_mutex);
+  return time - steady_offset;
+}
+
+}  // namespace rootcanal
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace rootcanal {
+
+// Time seen by the simulation: the devices, and the tasks scheduled on the
+// AsyncManager. By default it follows the steady clock. In virtual time
+// mode it only moves when AdvanceTo() is called, which the AsyncManager does
+// to jump to the next scheduled task once every task due at the current time
+// has run. The clock never goes backwards, including when the mode changes.
+class SimulationClock {
+ public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  static time_point Now();
+
+  static bool IsVirtualTime();
+
+  // Enables or disables the virtual time mode, starting from the current
+  // simulation time in both cases.
+  static void SetVirtualTime(bool enabled);
+
+  // Moves the virtual time forward to |time|, does nothing if the virtual
+  // time mode is disabled or if |time| is in the past.
+  static void AdvanceTo(time_point time);
+
+  // Converts a simulation time to the steady clock time at which it happens
+  // when the virtual time mode is disabled.
+  static std::chrono::steady_clock::time_point ToSteadyTime(time_point time);
+};
+
+}  // namespace rootcanal
@@ -45,7 +45,13 @@ TestCommandHandler::TestCommandHandler(TestModel& test_model)
   SET_HANDLER("del_device_from_phy", DelDeviceFromPhy);
   SET_HANDLER("list", List);
   SET_HANDLER("set_device_address", SetDeviceAddress);
+  SET_HANDLER("set_device_capture", SetDeviceCapture);
+  SET_HANDLER("stream_device_capture", StreamDeviceCapture);
+  SET_HANDLER("save_snapshot", SaveSnapshot);
+  SET_HANDLER("restore_snapshot", RestoreSnapshot);
   SET_HANDLER("set_timer_period", SetTimerPeriod);
+  SET_HANDLER("set_tick_workers", SetTickWorkers);
+  SET_HANDLER("set_virtual_time", SetVirtualTime);
   SET_HANDLER("start_timer", StartTimer);
   SET_HANDLER("stop_timer", StopTimer);
   SET_HANDLER("reset", Reset);
@@ -134,7 +140,7 @@ void TestCommandHandler::Add(const vector<std::string>& args) {
   }
 
   LOG_INFO("Add %s", new_dev->ToString().c_str());
-  size_t dev_index = model_.Add(new_dev);
+  size_t dev_index = model_.Add(new_dev, args);
   response_string_ =
       std::to_string(dev_index) + std::string(":") + new_dev->ToString();
   send_response_(response_string_);
@@ -261,6 +267,67 @@ void TestCommandHandler::SetDeviceAddress(const vector<std::string>& args) {
   send_response_(response_string_);
 }
 
+void TestCommandHandler::SetDeviceCapture(const vector<std::string>& args) {
+  if (args.size() != 2 || (args[1] != "on" && args[1] != "off")) {
+    response_string_ =
+        "TestCommandHandler 'set_device_capture' takes two arguments:"
+        " device_id and on or off";
+    send_response_(response_string_);
+    return;
+  }
+  size_t device_id = std::stoi(args[0]);
+  model_.SetDeviceCapture(device_id, args[1] == "on");
+  response_string_ = "set_device_capture " + args[0];
+  response_string_ += " ";
+  response_string_ += args[1];
+  send_response_(response_string_);
+}
+
+void TestCommandHandler::StreamDeviceCapture(const vector<std::string>& args) {
+  if (args.size() != 2) {
+    response_string_ =
+        "TestCommandHandler 'stream_device_capture' takes two arguments:"
+        " device_id and the path of the named pipe";
+    send_response_(response_string_);
+    return;
+  }
+  size_t device_id = std::stoi(args[0]);
+  model_.StreamDeviceCapture(device_id, args[1]);
+  response_string_ = "stream_device_capture " + args[0];
+  response_string_ += " ";
+  response_string_ += args[1];
+  send_response_(response_string_);
+}
+
+void TestCommandHandler::SaveSnapshot(const vector<std::string>& args) {
+  if (args.size() != 1) {
+    response_string_ =
+        "TestCommandHandler 'save_snapshot' takes one argument: the path of"
+        " the snapshot file";
+    send_response_(response_string_);
+    return;
+  }
+  response_string_ = model_.SaveSnapshot(args[0]) ? "save_snapshot "
+                                                  : "save_snapshot failed ";
+  response_string_ += args[0];
+  send_response_(response_string_);
+}
+
+void TestCommandHandler::RestoreSnapshot(const vector<std::string>& args) {
+  if (args.size() != 1) {
+    response_string_ =
+        "TestCommandHandler 'restore_snapshot' takes one argument: the path"
+        " of the snapshot file";
+    send_response_(response_string_);
+    return;
+  }
+  response_string_ = model_.RestoreSnapshot(args[0])
+                         ? "restore_snapshot "
+                         : "restore_snapshot failed ";
+  response_string_ += args[0];
+  send_response_(response_string_);
+}
+
 void TestCommandHandler::SetTimerPeriod(const vector<std::string>& args) {
   if (args.size() != 1) {
     LOG_INFO("SetTimerPeriod takes 1 argument");
@@ -277,6 +344,33 @@ void TestCommandHandler::SetTimerPeriod(const vector<std::string>& args) {
   send_response_(response_string_);
 }
 
+void TestCommandHandler::SetTickWorkers(const vector<std::string>& args) {
+  if (args.size() != 1) {
+    LOG_INFO("SetTickWorkers takes 1 argument");
+    response_string_ = "set_tick_workers takes 1 argument";
+    send_response_(response_string_);
+    return;
+  }
+  size_t num_workers = std::stoi(args[0]);
+  model_.SetTickWorkers(num_workers);
+  response_string_ = "set tick workers to ";
+  response_string_ += args[0];
+  send_response_(response_string_);
+}
+
+void TestCommandHandler::SetVirtualTime(const vector<std::string>& args) {
+  if (args.size() != 1 || (args[0] != "on" && args[0] != "off")) {
+    LOG_INFO("SetVirtualTime takes 1 argument: on or off");
+    response_string_ = "set_virtual_time takes 1 argument: on or off";
+    send_response_(response_string_);
+    return;
+  }
+  model_.SetVirtualTime(args[0] == "on");
+  response_string_ = "set virtual time ";
+  response_string_ += args[0];
+  send_response_(response_string_);
+}
+
 void TestCommandHandler::StartTimer(const vector<std::string>& args) {
   if (args.size() > 0) {
     LOG_INFO("Unused args: arg[0] = %s", args[0].c_str());
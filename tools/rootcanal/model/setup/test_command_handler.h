@@ -78,9 +78,23 @@ class TestCommandHandler {
   // Change the device's MAC address
   void SetDeviceAddress(const std::vector<std::string>& args);
 
+  // Packet capture of sniffers and HCI devices
+  void SetDeviceCapture(const std::vector<std::string>& args);
+
+  void StreamDeviceCapture(const std::vector<std::string>& args);
+
+  // Save and restore the simulated devices, their phys and link keys
+  void SaveSnapshot(const std::vector<std::string>& args);
+
+  void RestoreSnapshot(const std::vector<std::string>& args);
+
   // Timer management functions
   void SetTimerPeriod(const std::vector<std::string>& args);
 
+  void SetTickWorkers(const std::vector<std::string>& args);
+
+  void SetVirtualTime(const std::vector<std::string>& args);
+
   void StartTimer(const std::vector<std::string>& args);
 
   void StopTimer(const std::vector<std::string>& args);
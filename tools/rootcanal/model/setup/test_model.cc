@@ -18,14 +18,19 @@
 
 #include <stdlib.h>  // for size_t
 
+#include <fstream>      // for ifstream, ofstream
 #include <iomanip>      // for operator<<, setfill
 #include <iostream>     // for basic_ostream
 #include <memory>       // for shared_ptr, make...
+#include <sstream>      // for istringstream
 #include <type_traits>  // for remove_extent_t
 #include <utility>      // for move
 
-#include "include/phy.h"  // for Phy, Phy::Type
-#include "log.h"          // for LOG_WARN, LOG_INFO
+#include "device_boutique.h"   // for DeviceBoutique
+#include "include/phy.h"       // for Phy, Phy::Type
+#include "log.h"               // for LOG_WARN, LOG_INFO
+#include "pcap_writer.h"       // for PcapWriter
+#include "simulation_clock.h"  // for SimulationClock
 
 namespace rootcanal {
 
@@ -81,8 +86,11 @@ void TestModel::StopTimer() {
   timer_tick_task_ = kInvalidTaskId;
 }
 
-size_t TestModel::Add(std::shared_ptr<Device> new_dev) {
+size_t TestModel::Add(std::shared_ptr<Device> new_dev,
+                      std::vector<std::string> creation_args) {
+  WriteRestoredLinkKeys(*new_dev);
   devices_.push_back(std::move(new_dev));
+  device_creation_args_.push_back(std::move(creation_args));
   return devices_.size() - 1;
 }
 
@@ -192,6 +200,7 @@ size_t TestModel::AddHciConnection(std::shared_ptr<HciDevice> dev) {
       bluetooth_address_prefix_[0],
   }};
   dev->SetAddress(bluetooth_address);
+  WriteRestoredLinkKeys(*dev);
 
   LOG_INFO("Initialized device with address %s",
            bluetooth_address.ToString().c_str());
@@ -233,6 +242,179 @@ void TestModel::SetDeviceAddress(size_t index, Address address) {
   devices_[index]->SetAddress(std::move(address));
 }
 
+void TestModel::SetDeviceCapture(size_t index, bool enabled) {
+  if (index >= devices_.size() || devices_[index] == nullptr) {
+    LOG_WARN("Can't find device %zu", index);
+    return;
+  }
+  PcapWriter* writer = devices_[index]->GetPcapWriter();
+  if (writer == nullptr) {
+    LOG_WARN("Device %zu does not capture packets", index);
+    return;
+  }
+  writer->SetEnabled(enabled);
+}
+
+void TestModel::StreamDeviceCapture(size_t index, const std::string& path) {
+  if (index >= devices_.size() || devices_[index] == nullptr) {
+    LOG_WARN("Can't find device %zu", index);
+    return;
+  }
+  PcapWriter* writer = devices_[index]->GetPcapWriter();
+  if (writer == nullptr) {
+    LOG_WARN("Device %zu does not capture packets", index);
+    return;
+  }
+  writer->StreamTo(path);
+}
+
+static std::string LinkKeyToString(const std::array<uint8_t, 16>& key) {
+  std::ostringstream output;
+  output << std::hex << std::setfill('0');
+  for (uint8_t byte : key) {
+    output << std::setw(2) << static_cast<int>(byte);
+  }
+  return output.str();
+}
+
+static bool LinkKeyFromString(const std::string& str,
+                              std::array<uint8_t, 16>& key) {
+  if (str.size() != 2 * key.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < key.size(); i++) {
+    char* end = nullptr;
+    std::string byte = str.substr(2 * i, 2);
+    key[i] = static_cast<uint8_t>(strtoul(byte.c_str(), &end, 16));
+    if (*end != '\0') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestModel::SaveSnapshot(const std::string& path) {
+  std::ofstream output(path);
+  if (!output.is_open()) {
+    LOG_WARN("Can't open snapshot file %s", path.c_str());
+    return false;
+  }
+
+  // Snapshot format, one record per line:
+  //   device <address> <creation args>
+  //   device_phy <snapshot device index> <phy index>
+  //   link_key <device address> <peer address> <key>
+  size_t snapshot_index = 0;
+  for (size_t i = 0; i < devices_.size(); i++) {
+    auto const& device = devices_[i];
+    if (device == nullptr || device_creation_args_[i].empty()) {
+      continue;
+    }
+    output << "device " << device->GetAddress().ToString();
+    for (auto const& arg : device_creation_args_[i]) {
+      output << " " << arg;
+    }
+    output << std::endl;
+    for (size_t phy_index = 0; phy_index < phys_.size(); phy_index++) {
+      if (device->IsRegisteredOnPhy(phys_[phy_index]->GetType(), phy_index)) {
+        output << "device_phy " << snapshot_index << " " << phy_index
+               << std::endl;
+      }
+    }
+    snapshot_index++;
+  }
+
+  for (auto const& device : devices_) {
+    if (device == nullptr) {
+      continue;
+    }
+    for (auto const& [peer, key] : device->GetLinkKeys()) {
+      output << "link_key " << device->GetAddress().ToString() << " "
+             << peer.ToString() << " " << LinkKeyToString(key) << std::endl;
+    }
+  }
+
+  LOG_INFO("Saved %zu devices to snapshot %s", snapshot_index, path.c_str());
+  return output.good();
+}
+
+bool TestModel::RestoreSnapshot(const std::string& path) {
+  std::ifstream input(path);
+  if (!input.is_open()) {
+    LOG_WARN("Can't open snapshot file %s", path.c_str());
+    return false;
+  }
+
+  // Device indexes in the model, by snapshot device index.
+  std::vector<size_t> device_indexes;
+  std::string line;
+  while (std::getline(input, line)) {
+    std::istringstream record(line);
+    std::string type;
+    record >> type;
+
+    if (type == "device") {
+      std::string address_str;
+      record >> address_str;
+      std::vector<std::string> args;
+      for (std::string arg; record >> arg;) {
+        args.push_back(arg);
+      }
+      Address address;
+      std::shared_ptr<Device> device;
+      if (Address::FromString(address_str, address) && !args.empty()) {
+        device = DeviceBoutique::Create(args);
+      }
+      if (device == nullptr) {
+        LOG_WARN("Invalid snapshot record: %s", line.c_str());
+        return false;
+      }
+      device->SetAddress(address);
+      device_indexes.push_back(Add(device, std::move(args)));
+    } else if (type == "device_phy") {
+      size_t snapshot_index = 0;
+      size_t phy_index = 0;
+      if (!(record >> snapshot_index >> phy_index) ||
+          snapshot_index >= device_indexes.size()) {
+        LOG_WARN("Invalid snapshot record: %s", line.c_str());
+        return false;
+      }
+      AddDeviceToPhy(device_indexes[snapshot_index], phy_index);
+    } else if (type == "link_key") {
+      std::string device_str, peer_str, key_str;
+      record >> device_str >> peer_str >> key_str;
+      Address device_address;
+      LinkKey link_key;
+      if (!Address::FromString(device_str, device_address) ||
+          !Address::FromString(peer_str, link_key.peer) ||
+          !LinkKeyFromString(key_str, link_key.key)) {
+        LOG_WARN("Invalid snapshot record: %s", line.c_str());
+        return false;
+      }
+      restored_link_keys_.emplace(device_address, link_key);
+      for (auto const& device : devices_) {
+        if (device != nullptr && device->GetAddress() == device_address) {
+          device->WriteLinkKey(link_key.peer, link_key.key);
+        }
+      }
+    } else if (!type.empty()) {
+      LOG_WARN("Invalid snapshot record: %s", line.c_str());
+      return false;
+    }
+  }
+
+  LOG_INFO("Restored %zu devices from snapshot %s", device_indexes.size(),
+           path.c_str());
+  return true;
+}
+
+void TestModel::WriteRestoredLinkKeys(Device& device) {
+  auto [begin, end] = restored_link_keys_.equal_range(device.GetAddress());
+  for (auto it = begin; it != end; it++) {
+    device.WriteLinkKey(it->second.peer, it->second.key);
+  }
+}
+
 const std::string& TestModel::List() {
   list_string_ = "";
   list_string_ += " Devices: \r\n";
@@ -252,11 +434,49 @@ const std::string& TestModel::List() {
   return list_string_;
 }
 
+void TestModel::SetTickWorkers(size_t num_workers) {
+  schedule_task_(model_user_id_, std::chrono::milliseconds(0),
+                 [this, num_workers]() {
+                   tick_workers_.reset();
+                   if (num_workers > 0) {
+                     tick_workers_ =
+                         std::make_unique<TickWorkerPool>(num_workers);
+                   }
+                 });
+}
+
+void TestModel::SetVirtualTime(bool enabled) {
+  LOG_INFO("%s virtual time", enabled ? "Enabling" : "Disabling");
+  SimulationClock::SetVirtualTime(enabled);
+}
+
 void TestModel::TimerTick() {
-  for (size_t i = 0; i < devices_.size(); i++) {
-    if (devices_[i] != nullptr) {
-      devices_[i]->TimerTick();
+  if (tick_workers_ == nullptr) {
+    for (size_t i = 0; i < devices_.size(); i++) {
+      if (devices_[i] != nullptr) {
+        devices_[i]->TimerTick();
+      }
     }
+    return;
+  }
+
+  size_t num_shards = tick_workers_->GetNumWorkers();
+  size_t num_devices = devices_.size();
+  for (auto& phy : phys_) {
+    phy->DeferDelivery(num_shards);
+  }
+  tick_workers_->Run([this, num_shards, num_devices](size_t shard) {
+    PhyLayerFactory::SetCurrentShard(shard);
+    size_t begin = num_devices * shard / num_shards;
+    size_t end = num_devices * (shard + 1) / num_shards;
+    for (size_t i = begin; i < end; i++) {
+      if (devices_[i] != nullptr) {
+        devices_[i]->TimerTick();
+      }
+    }
+  });
+  for (auto& phy : phys_) {
+    phy->DeliverDeferredPackets();
   }
 }
 
@@ -270,6 +490,8 @@ void TestModel::Reset() {
       }
     }
     devices_.clear();
+    device_creation_args_.clear();
+    restored_link_keys_.clear();
   });
 }
 
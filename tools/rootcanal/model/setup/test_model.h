@@ -18,10 +18,12 @@
 
 #include <stddef.h>  // for size_t
 
+#include <array>       // for array
 #include <chrono>      // for milliseconds
 #include <functional>  // for function
 #include <memory>      // for shared_ptr
 #include <string>      // for string
+#include <unordered_map>  // for unordered_multimap
 #include <vector>      // for vector
 
 #include "hci/address.h"                       // for Address
@@ -29,6 +31,7 @@
 #include "model/setup/async_manager.h"         // for AsyncUserId, AsyncTaskId
 #include "phy.h"                               // for Phy, Phy::Type
 #include "phy_layer_factory.h"                 // for PhyLayerFactory
+#include "tick_worker_pool.h"                  // for TickWorkerPool
 
 namespace rootcanal {
 class Device;
@@ -58,8 +61,11 @@ class TestModel {
 
   // Commands:
 
-  // Add a device, return its index
-  size_t Add(std::shared_ptr<Device> device);
+  // Add a device, return its index. |creation_args| are the arguments the
+  // device was created from by the DeviceBoutique, if any; only the devices
+  // with creation arguments are saved in snapshots.
+  size_t Add(std::shared_ptr<Device> device,
+             std::vector<std::string> creation_args = {});
 
   // Remove devices by index
   void Del(size_t device_index);
@@ -93,12 +99,43 @@ class TestModel {
   // Set the device's Bluetooth address
   void SetDeviceAddress(size_t device_index, Address device_address);
 
+  // Enable or disable the packet capture of the device. Only sniffers and
+  // HCI devices with a sniffer capture packets; the phy captured by a
+  // baseband sniffer is selected by the phys it is added to.
+  void SetDeviceCapture(size_t device_index, bool enabled);
+
+  // Stream the packet capture of the device to the named pipe |path|.
+  void StreamDeviceCapture(size_t device_index, const std::string& path);
+
   // Let devices know about the passage of time
   void TimerTick();
   void StartTimer();
   void StopTimer();
   void SetTimerPeriod(std::chrono::milliseconds new_period);
 
+  // Tick the devices on |num_workers| threads, each ticking a contiguous
+  // shard of the devices. The packets sent during the tick are delivered
+  // once every shard is done, in device order, so the simulation does not
+  // depend on the number of workers. 0 ticks the devices on the timer
+  // thread and delivers the packets as they are sent.
+  void SetTickWorkers(size_t num_workers);
+
+  // Run the simulation in virtual time: the clock jumps to the next
+  // scheduled task (the next timer tick at the latest) once every task due
+  // at the current time has run, instead of following the wall clock.
+  void SetVirtualTime(bool enabled);
+
+  // Save the devices created from test commands, with their address and
+  // phys, and the link keys of every device to |path|.
+  bool SaveSnapshot(const std::string& path);
+
+  // Create the devices of a snapshot again, on the same phys, and write
+  // back the link keys. The link keys of devices that are not in the
+  // snapshot, e.g. HCI devices, are written when a device with the same
+  // address is connected. Connections are not saved: restored devices are
+  // paired, and reconnect without pairing again.
+  bool RestoreSnapshot(const std::string& path);
+
   // List the devices that the test knows about
   const std::string& List();
 
@@ -108,6 +145,7 @@ class TestModel {
  private:
   std::vector<std::unique_ptr<PhyLayerFactory>> phys_;
   std::vector<std::shared_ptr<Device>> devices_;
+  std::vector<std::vector<std::string>> device_creation_args_;
   std::string list_string_;
 
   // Prefix used to generate public device addresses for hosts
@@ -130,6 +168,15 @@ class TestModel {
   AsyncUserId model_user_id_;
   AsyncTaskId timer_tick_task_{kInvalidTaskId};
   std::chrono::milliseconds timer_period_{};
+  std::unique_ptr<TickWorkerPool> tick_workers_;
+
+  // Link keys restored from a snapshot, indexed by device address.
+  struct LinkKey {
+    Address peer;
+    std::array<uint8_t, 16> key;
+  };
+  std::unordered_multimap<Address, LinkKey> restored_link_keys_;
+  void WriteRestoredLinkKeys(Device& device);
 };
 
 }  // namespace rootcanal
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tick_worker_pool.h"
+
+namespace rootcanal {
+
+TickWorkerPool::TickWorkerPool(size_t num_workers) {
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back([this, i]() { WorkerRoutine(i); });
+  }
+}
+
+TickWorkerPool::~TickWorkerPool() {
+  {
+    std::unique_lock<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  start_cond_var_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void TickWorkerPool::Run(const std::function<void(size_t)>& run_shard) {
+  std::unique_lock<std::mutex> guard(mutex_);
+  run_shard_ = &run_shard;
+  running_shards_ = workers_.size();
+  generation_++;
+  start_cond_var_.notify_all();
+  done_cond_var_.wait(guard, [this]() { return running_shards_ == 0; });
+  run_shard_ = nullptr;
+}
+
+void TickWorkerPool::WorkerRoutine(size_t shard) {
+  uint64_t generation = 0;
+  std::unique_lock<std::mutex> guard(mutex_);
+  while (true) {
+    start_cond_var_.wait(guard, [this, generation]() {
+      return stopping_ || generation_ != generation;
+    });
+    if (stopping_) {
+      return;
+    }
+    generation = generation_;
+
+    const std::function<void(size_t)>* run_shard = run_shard_;
+    guard.unlock();
+    (*run_shard)(shard);
+    guard.lock();
+
+    if (--running_shards_ == 0) {
+      done_cond_var_.notify_one();
+    }
+  }
+}
+
+}  // namespace rootcanal
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rootcanal {
+
+// Runs the shards of a simulation tick on a fixed set of worker threads.
+// Shard i always runs on worker i, and Run() only returns once every shard
+// has completed, which is the barrier between two ticks.
+class TickWorkerPool {
+ public:
+  explicit TickWorkerPool(size_t num_workers);
+  ~TickWorkerPool();
+
+  TickWorkerPool(const TickWorkerPool&) = delete;
+  TickWorkerPool& operator=(const TickWorkerPool&) = delete;
+
+  size_t GetNumWorkers() const { return workers_.size(); }
+
+  // Calls run_shard(i) on worker i for every worker, and waits for all of
+  // the calls to return.
+  void Run(const std::function<void(size_t)>& run_shard);
+
+ private:
+  void WorkerRoutine(size_t shard);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cond_var_;
+  std::condition_variable done_cond_var_;
+  const std::function<void(size_t)>* run_shard_{nullptr};
+  // Incremented for every call to Run(), lets the workers tell a new tick
+  // from a spurious wake up.
+  uint64_t generation_{0};
+  size_t running_shards_{0};
+  bool stopping_{false};
+};
+
+}  // namespace rootcanal
@@ -225,6 +225,36 @@ class TestChannelShell(cmd.Cmd):
     """
         self._test_channel.send_command('set_timer_period', args.split())
 
+    def do_set_device_capture(self, args):
+        """Arguments: device_id on|off Enable or disable the packet capture of a sniffer or HCI device.
+    """
+        self._test_channel.send_command('set_device_capture', args.split())
+
+    def do_stream_device_capture(self, args):
+        """Arguments: device_id path Stream the packet capture of a device to a named pipe, e.g. for wireshark -k -i path.
+    """
+        self._test_channel.send_command('stream_device_capture', args.split())
+
+    def do_save_snapshot(self, args):
+        """Arguments: path Save the devices added with add, their phys and the link keys of every device to a file.
+    """
+        self._test_channel.send_command('save_snapshot', args.split())
+
+    def do_restore_snapshot(self, args):
+        """Arguments: path Create the devices of a snapshot again and restore the saved link keys.
+    """
+        self._test_channel.send_command('restore_snapshot', args.split())
+
+    def do_set_tick_workers(self, args):
+        """Arguments: num_workers Tick the devices on num_workers threads, 0 ticks them on the timer thread.
+    """
+        self._test_channel.send_command('set_tick_workers', args.split())
+
+    def do_set_virtual_time(self, args):
+        """Arguments: on|off Jump the simulation time to the next scheduled event instead of following the wall clock.
+    """
+        self._test_channel.send_command('set_virtual_time', args.split())
+
     def do_start_timer(self, args):
         """Arguments: None. Start the timer.
     """
@@ -26,6 +26,7 @@
 #include <time.h>         // for NULL, size_t
 #include <unistd.h>       // for close, write, read
 
+#include <atomic>              // for atomic_bool
 #include <condition_variable>  // for condition_variable
 #include <cstdint>             // for uint16_t
 #include <cstring>             // for memset, strcmp, strcpy, strlen
@@ -34,6 +35,9 @@
 #include <string>              // for string
 #include <thread>
 #include <tuple>  // for tuple
+#include <vector>
+
+#include "model/setup/simulation_clock.h"
 
 namespace rootcanal {
 
@@ -489,4 +493,42 @@ TEST_F(AsyncManagerTest, TestCancelAsyncTasksFromUser) {
   ASSERT_FALSE(async_manager_.CancelAsyncTask(task5_id));
 }
 
+TEST_F(AsyncManagerTest, TestTasksRunInTimeOrder) {
+  AsyncUserId user1 = async_manager_.GetNextUserId();
+  static const int num_tasks = 10;
+  std::mutex order_mutex;
+  std::vector<int> order;
+  AsyncTaskId task_ids[num_tasks];
+  // Scheduled latest first, the task with index 5 is cancelled.
+  for (int i = num_tasks - 1; i >= 0; i--) {
+    task_ids[i] = async_manager_.ExecAsync(
+        user1, std::chrono::milliseconds(10 + 5 * i),
+        [&order_mutex, &order, i]() {
+          std::unique_lock<std::mutex> guard(order_mutex);
+          order.push_back(i);
+        });
+  }
+  ASSERT_TRUE(async_manager_.CancelAsyncTask(task_ids[5]));
+  while (true) {
+    std::unique_lock<std::mutex> guard(order_mutex);
+    if (order.size() == num_tasks - 1) break;
+  }
+  ASSERT_EQ(order, std::vector<int>({0, 1, 2, 3, 4, 6, 7, 8, 9}));
+}
+
+TEST_F(AsyncManagerTest, TestVirtualTimeFastForwards) {
+  AsyncUserId user1 = async_manager_.GetNextUserId();
+  std::atomic_bool task_ran{false};
+  SimulationClock::SetVirtualTime(true);
+  auto start = std::chrono::steady_clock::now();
+  auto virtual_start = SimulationClock::Now();
+  async_manager_.ExecAsync(user1, std::chrono::seconds(60),
+                           [&task_ran]() { task_ran = true; });
+  while (!task_ran)
+    ;
+  SimulationClock::SetVirtualTime(false);
+  ASSERT_GE(SimulationClock::Now() - virtual_start, std::chrono::seconds(60));
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+}
+
 }  // namespace rootcanal
@@ -182,4 +182,34 @@ TEST_F(H4ParserTest, Recovery) {
   }
 }
 
+TEST_F(H4ParserTest, ConsumeChunkWithSeveralPackets) {
+  // Two ACL packets and the start of an HCI command, in a single chunk.
+  PacketData acl1({0x01, 0x00, 0x03, 0x00, 0xa1, 0xa2, 0xa3});
+  PacketData acl2({0x02, 0x00, 0x01, 0x00, 0xb1});
+  PacketData chunk;
+  chunk.push_back((uint8_t)PacketType::ACL);
+  chunk.insert(chunk.end(), acl1.begin(), acl1.end());
+  chunk.push_back((uint8_t)PacketType::ACL);
+  chunk.insert(chunk.end(), acl2.begin(), acl2.end());
+  chunk.push_back((uint8_t)PacketType::COMMAND);
+  chunk.push_back(0x03);
+
+  std::vector<PacketData> packets;
+  H4Parser parser(
+      [&](auto p) { packets.push_back(p); }, [](auto) {},
+      [&](auto p) { packets.push_back(p); }, [](auto) {}, [](auto) {});
+  ASSERT_TRUE(parser.ConsumeChunk(chunk.data(), chunk.size()));
+  ASSERT_EQ(packets.size(), 2u);
+  ASSERT_EQ(packets[0], acl1);
+  ASSERT_EQ(packets[1], acl2);
+  ASSERT_EQ(parser.CurrentState(), H4Parser::State::HCI_PREAMBLE);
+
+  // The rest of the command comes in the next chunk.
+  PacketData rest({0x0c, 0x00});
+  ASSERT_TRUE(parser.ConsumeChunk(rest.data(), rest.size()));
+  ASSERT_EQ(packets.size(), 3u);
+  ASSERT_EQ(packets[2], PacketData({0x03, 0x0c, 0x00}));
+  ASSERT_EQ(parser.CurrentState(), H4Parser::State::HCI_TYPE);
+}
+
 }  // namespace rootcanal
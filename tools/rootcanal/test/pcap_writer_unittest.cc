@@ -0,0 +1,56 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "model/setup/pcap_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+namespace rootcanal {
+
+static constexpr size_t kFileHeaderSize = 24;
+static constexpr size_t kRecordHeaderSize = 16;
+
+TEST(PcapWriterTest, WritesQueuedRecords) {
+  auto output = std::make_shared<std::stringstream>();
+  PcapWriter writer(output, 201);
+
+  writer.AppendRecord({0, 0, 0, 1, 1, 0x03, 0x0c, 0x00});
+  writer.AppendRecord({0, 0, 0, 0, 4, 0x0e});
+  writer.Flush();
+
+  std::string bytes = output->str();
+  ASSERT_EQ(bytes.size(), kFileHeaderSize + 2 * kRecordHeaderSize + 8 + 6);
+  ASSERT_EQ(bytes.substr(kFileHeaderSize + kRecordHeaderSize, 8),
+            std::string("\x00\x00\x00\x01\x01\x03\x0c\x00", 8));
+  ASSERT_EQ(writer.GetDroppedRecordCount(), 0u);
+}
+
+TEST(PcapWriterTest, DiscardsRecordsWhenDisabled) {
+  auto output = std::make_shared<std::stringstream>();
+  PcapWriter writer(output, 201);
+
+  writer.SetEnabled(false);
+  writer.AppendRecord({0, 0, 0, 1, 1, 0x03, 0x0c, 0x00});
+  writer.SetEnabled(true);
+  writer.AppendRecord({0, 0, 0, 0, 4, 0x0e});
+  writer.Flush();
+
+  ASSERT_EQ(output->str().size(), kFileHeaderSize + kRecordHeaderSize + 6);
+}
+
+}  // namespace rootcanal